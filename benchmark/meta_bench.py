@@ -0,0 +1,271 @@
+#! /usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+''' The scalability benchmark of the metadata service: N vineyardd instances
+    are launched against a single etcd, and every instance creates, persists
+    and deletes its share of small objects, e.g.,
+
+        python3 benchmark/meta_bench.py --instances 4 --objects 1000000
+
+    The results are reported in JSON:
+
+    - the client-side latencies of creating, persisting and deleting batches
+      of objects, i.e., RequestToPersist and RequestToDelete,
+    - the watch-sync time: from an object being persisted on an instance to
+      it being visible in the local metadata of another instance,
+    - the server-side metrics of every instance: the latency of etcd commits,
+      the operations and bytes of etcd transactions, the latency of bringing
+      the local metadata up-to-date (requestValues), the time of applying
+      the changes of the daemon watch, and the size of the local metadata.
+
+    The vineyardd and etcd executables are resolved in the same way as
+    `test/runner.py`.
+'''
+
+import argparse
+import contextlib
+import json
+import os
+import sys
+import threading
+import time
+
+import vineyard
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                '..', 'test'))
+import runner  # noqa: E402
+
+BENCH_IPC_SOCKET = '/tmp/vineyard.bench.%s.sock' % time.time()
+
+
+def summarize(latencies):
+    ''' The percentiles of latencies, in microseconds.
+    '''
+    if not latencies:
+        return {'count': 0}
+    latencies = sorted(latencies)
+
+    def percentile(p):
+        return latencies[min(int(p * len(latencies)), len(latencies) - 1)] * 1e6
+
+    return {
+        'count': len(latencies),
+        'mean': sum(latencies) / len(latencies) * 1e6,
+        'p50': percentile(0.5),
+        'p99': percentile(0.99),
+        'p999': percentile(0.999),
+        'max': latencies[-1] * 1e6,
+    }
+
+
+def make_meta(index, fields):
+    meta = vineyard.ObjectMeta()
+    meta['typename'] = 'vineyard::bench::Meta'
+    meta['nbytes'] = 0
+    meta['index_'] = index
+    for field in range(fields):
+        meta['field_%d' % field] = 'value-%d' % field
+    return meta
+
+
+def snapshot(client):
+    ''' The metadata related fields of the instance status.
+    '''
+    status = client.status
+    metrics = status.metrics
+    requests = metrics.get('requests', {})
+    return {
+        'instance_id': status.instance_id,
+        'meta_nodes': status.meta_nodes,
+        'meta_memory_usage': status.meta_memory_usage,
+        'etcd_commits_us': metrics.get('etcd_commits'),
+        'etcd_txn_ops': metrics.get('etcd_txn_ops'),
+        'etcd_txn_bytes': metrics.get('etcd_txn_bytes'),
+        'meta_requests_us': metrics.get('meta_requests'),
+        'meta_watch_ops': metrics.get('meta_watch_ops'),
+        'meta_watch_applies_us': metrics.get('meta_watch_applies'),
+        'persist_requests_us': requests.get('persist_request'),
+        'delete_requests_us': requests.get('del_data_request'),
+    }
+
+
+def run_parallel(clients, fn):
+    ''' Run `fn(index, client)` on every instance concurrently.
+    '''
+    errors = []
+
+    def target(index, client):
+        try:
+            fn(index, client)
+        except Exception as e:  # pylint: disable=broad-except
+            errors.append(e)
+
+    threads = [threading.Thread(target=target, args=(index, client))
+               for index, client in enumerate(clients)]
+    start = time.perf_counter()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    elapsed = time.perf_counter() - start
+    if errors:
+        raise errors[0]
+    return elapsed
+
+
+def bench_create(args, clients, objects):
+    create, persist = [[] for _ in clients], [[] for _ in clients]
+    per_instance = args.objects // len(clients)
+
+    def fn(index, client):
+        for begin in range(0, per_instance, args.batch):
+            end = min(begin + args.batch, per_instance)
+            metas = [make_meta(i, args.fields) for i in range(begin, end)]
+            start = time.perf_counter()
+            ids = client.create_metadata(metas)
+            create[index].append(time.perf_counter() - start)
+            start = time.perf_counter()
+            client.persist(ids)
+            persist[index].append(time.perf_counter() - start)
+            objects[index].extend(ids)
+
+    elapsed = run_parallel(clients, fn)
+    return {
+        'objects': per_instance * len(clients),
+        'seconds': elapsed,
+        'objects_per_second': per_instance * len(clients) / elapsed,
+        'create_batch_us': summarize(sum(create, [])),
+        'persist_batch_us': summarize(sum(persist, [])),
+    }
+
+
+def bench_watch_sync(args, clients, objects):
+    ''' Persist on an instance and poll the local metadata of the next one.
+    '''
+    if len(clients) < 2:
+        return {'count': 0}
+    latencies, timeouts = [], 0
+    for sample in range(args.sync_samples):
+        writer = clients[sample % len(clients)]
+        reader = clients[(sample + 1) % len(clients)]
+        object_id = writer.create_metadata(make_meta(sample, args.fields))
+        start = time.perf_counter()
+        writer.persist(object_id)
+        objects[sample % len(clients)].append(object_id)
+        while True:
+            try:
+                reader.get_meta(object_id)
+                latencies.append(time.perf_counter() - start)
+                break
+            except Exception:  # pylint: disable=broad-except
+                if time.perf_counter() - start > args.sync_timeout:
+                    timeouts += 1
+                    break
+    result = summarize(latencies)
+    result['timeouts'] = timeouts
+    return result
+
+
+def bench_delete(args, clients, objects):
+    delete = [[] for _ in clients]
+
+    def fn(index, client):
+        ids = objects[index]
+        for begin in range(0, len(ids), args.batch):
+            start = time.perf_counter()
+            client.delete(ids[begin:begin + args.batch], force=False, deep=True)
+            delete[index].append(time.perf_counter() - start)
+        objects[index] = []
+
+    total = sum(len(ids) for ids in objects)
+    elapsed = run_parallel(clients, fn)
+    return {
+        'objects': total,
+        'seconds': elapsed,
+        'objects_per_second': total / elapsed if elapsed > 0 else 0,
+        'delete_batch_us': summarize(sum(delete, [])),
+    }
+
+
+def run_benchmark(args, etcd_endpoints):
+    etcd_prefix = 'vineyard_bench_%s' % time.time()
+    with runner.start_multiple_vineyardd(etcd_endpoints, etcd_prefix,
+                                         size=args.size,
+                                         default_ipc_socket=BENCH_IPC_SOCKET,
+                                         instance_size=args.instances):
+        # wait until all instances have joined the cluster
+        time.sleep(5)
+        clients = [vineyard.connect('%s.%d' % (BENCH_IPC_SOCKET, index))
+                   for index in range(args.instances)]
+        objects = [[] for _ in clients]
+        results = {
+            'config': {
+                'instances': args.instances,
+                'objects': args.objects,
+                'batch': args.batch,
+                'fields': args.fields,
+            },
+        }
+        results['create'] = bench_create(args, clients, objects)
+        results['watch_sync_us'] = bench_watch_sync(args, clients, objects)
+        results['after_create'] = [snapshot(client) for client in clients]
+        results['delete'] = bench_delete(args, clients, objects)
+        results['after_delete'] = [snapshot(client) for client in clients]
+        return results
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Metadata scalability benchmark of vineyard against etcd')
+    parser.add_argument('--instances', type=int, default=3,
+                        help='the number of vineyardd instances')
+    parser.add_argument('--objects', type=int, default=1000000,
+                        help='the number of objects, over all instances')
+    parser.add_argument('--batch', type=int, default=1000,
+                        help='the number of objects per request')
+    parser.add_argument('--fields', type=int, default=4,
+                        help='the number of extra fields per object')
+    parser.add_argument('--sync_samples', type=int, default=200,
+                        help='the number of samples of the watch-sync time')
+    parser.add_argument('--sync_timeout', type=float, default=30,
+                        help='seconds to wait for an object to be synced')
+    parser.add_argument('--size', type=int, default=256 * 1024 * 1024,
+                        help='the shared memory of every instance')
+    parser.add_argument('--etcd_endpoint', type=str, default=None,
+                        help='use the running etcd rather than launching one')
+    parser.add_argument('--output', type=str, default=None,
+                        help='write the JSON results to the file')
+    args = parser.parse_args()
+
+    with contextlib.ExitStack() as stack:
+        if args.etcd_endpoint is None:
+            _, etcd_endpoints = stack.enter_context(runner.start_etcd())
+        else:
+            etcd_endpoints = args.etcd_endpoint
+        results = run_benchmark(args, etcd_endpoints)
+
+    if args.output is None:
+        print(json.dumps(results, indent=2))
+    else:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2)
+
+
+if __name__ == '__main__':
+    main()
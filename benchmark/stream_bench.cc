@@ -0,0 +1,598 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * stream_bench measures the hand-off of chunks through the byte streams and
+ * the dataframe streams of a running vineyardd, e.g.,
+ *
+ *   ./stream_bench --ipc_socket=/var/run/vineyard.sock --kinds=byte \
+ *       --chunk_sizes=65536,1048576 --depths=1,16 --pairs=1,4 --fan_in=8
+ *
+ * Every combination of the kind, the chunk size, the depth of streams (i.e.,
+ * how many chunks the producer can write ahead of the consumer) and the
+ * topology is run, where the topology is either `pairs` streams each with a
+ * producer and a consumer, or `fan_in` streams written by their producers
+ * and consumed by a single thread through the stream notifiers. The results
+ * are reported in JSON, including
+ *
+ * - the throughput in GB/s,
+ * - the latency from a chunk being written to it being received,
+ * - the time that the producers and consumers are blocked by the stream,
+ * - how many distinct chunks the consumers see, i.e., how many chunks are
+ *   allocated rather than reused, and the peak of the memory usage.
+ */
+
+#include <poll.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/io/api.h"
+#include "boost/algorithm/string.hpp"
+#include "glog/logging.h"
+
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/dataframe_stream.h"
+#include "client/client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+struct Options {
+  std::string ipc_socket;
+  std::string output;
+  std::vector<std::string> kinds{"byte", "dataframe"};
+  std::vector<size_t> chunk_sizes{4096, 65536, 1024 * 1024, 8 * 1024 * 1024};
+  // 0 means the default depth of the vineyard server
+  std::vector<size_t> depths{0, 1, 16};
+  std::vector<size_t> pairs{1, 4};
+  std::vector<size_t> fan_in{4};
+  // the bytes written by every producer
+  size_t bytes = 256 * 1024 * 1024;
+};
+
+struct Scenario {
+  std::string kind;
+  size_t chunk_size = 0;
+  size_t depth = 0;
+  // `streams` producers, consumed by as many threads, or by a single thread
+  // when `fan_in`
+  size_t streams = 1;
+  bool fan_in = false;
+};
+
+/** The write times of the chunks that haven't been received. */
+struct Channel {
+  std::mutex mutex;
+  std::deque<clock_type::time_point> written;
+
+  void Write() {
+    std::lock_guard<std::mutex> guard(mutex);
+    written.emplace_back(clock_type::now());
+  }
+
+  int64_t Receive() {
+    auto now = clock_type::now();
+    std::lock_guard<std::mutex> guard(mutex);
+    if (written.empty()) {
+      return 0;
+    }
+    auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       now - written.front())
+                       .count();
+    written.pop_front();
+    return latency;
+  }
+};
+
+/** The statistics of a side, i.e., a producer or a consumer. */
+struct Side {
+  int64_t blocked = 0;  // in nanoseconds
+  size_t chunks = 0;
+  size_t bytes = 0;
+  std::vector<int64_t> latencies;
+  std::unordered_set<const uint8_t*> addresses;
+};
+
+struct Result {
+  Scenario scenario;
+  double seconds = 0;
+  Side producers, consumers;
+  size_t peak_memory = 0;
+};
+
+bool parseList(std::string const& value, std::vector<std::string>& items) {
+  boost::algorithm::split(items, value, boost::is_any_of(","));
+  items.erase(std::remove(items.begin(), items.end(), ""), items.end());
+  return !items.empty();
+}
+
+bool parseSizes(std::string const& value, std::vector<size_t>& sizes) {
+  std::vector<std::string> items;
+  if (!parseList(value, items)) {
+    return false;
+  }
+  sizes.clear();
+  for (auto const& item : items) {
+    sizes.emplace_back(std::stoull(item));
+  }
+  return true;
+}
+
+void usage() {
+  std::cerr << "usage: ./stream_bench [--ipc_socket=<path>] "
+               "[--kinds=byte,dataframe]\n"
+               "                      [--chunk_sizes=4096,...] "
+               "[--depths=0,1,16]\n"
+               "                      [--pairs=1,4] [--fan_in=4] "
+               "[--bytes=<per producer>]\n"
+               "                      [--output=<file>]\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  if (const char* env_p = std::getenv("VINEYARD_IPC_SOCKET")) {
+    options.ipc_socket = env_p;
+  }
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto pos = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || pos == std::string::npos) {
+      return false;
+    }
+    std::string key = arg.substr(2, pos - 2), value = arg.substr(pos + 1);
+    try {
+      bool parsed = true;
+      if (key == "ipc_socket") {
+        options.ipc_socket = value;
+      } else if (key == "output") {
+        options.output = value;
+      } else if (key == "kinds") {
+        parsed = parseList(value, options.kinds);
+      } else if (key == "chunk_sizes") {
+        parsed = parseSizes(value, options.chunk_sizes);
+      } else if (key == "depths") {
+        parsed = parseSizes(value, options.depths);
+      } else if (key == "pairs") {
+        parsed = parseSizes(value, options.pairs);
+      } else if (key == "fan_in") {
+        // empty to disable the fan-in scenarios
+        options.fan_in.clear();
+        parsed = value.empty() || parseSizes(value, options.fan_in);
+      } else if (key == "bytes") {
+        options.bytes = std::stoull(value);
+      } else {
+        parsed = false;
+      }
+      if (!parsed) {
+        return false;
+      }
+    } catch (std::exception const&) {
+      return false;
+    }
+  }
+  for (auto const& kind : options.kinds) {
+    if (kind != "byte" && kind != "dataframe") {
+      return false;
+    }
+  }
+  return !options.ipc_socket.empty();
+}
+
+int64_t nanosSince(clock_type::time_point const& start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             clock_type::now() - start)
+      .count();
+}
+
+void merge(Side& into, Side& side) {
+  into.blocked += side.blocked;
+  into.chunks += side.chunks;
+  into.bytes += side.bytes;
+  into.latencies.insert(into.latencies.end(), side.latencies.begin(),
+                        side.latencies.end());
+  into.addresses.insert(side.addresses.begin(), side.addresses.end());
+}
+
+/** A batch with a single int64 column that is about `chunk_size` bytes. */
+Status makeBatch(size_t const chunk_size,
+                 std::shared_ptr<arrow::RecordBatch>& batch) {
+  arrow::Int64Builder builder;
+  size_t rows = std::max<size_t>(chunk_size / sizeof(int64_t), 1);
+  RETURN_ON_ARROW_ERROR(builder.Reserve(rows));
+  for (size_t i = 0; i < rows; ++i) {
+    builder.UnsafeAppend(static_cast<int64_t>(i));
+  }
+  std::shared_ptr<arrow::Array> array;
+  RETURN_ON_ARROW_ERROR(builder.Finish(&array));
+  batch = arrow::RecordBatch::Make(
+      arrow::schema({arrow::field("value", arrow::int64())}), rows, {array});
+  return Status::OK();
+}
+
+Status createStream(Client& client, Scenario const& scenario, ObjectID& id) {
+  std::shared_ptr<Object> stream;
+  if (scenario.kind == "byte") {
+    ByteStreamBuilder builder(client);
+    builder.SetParam("kind", "bench");
+    builder.SetDepth(scenario.depth);
+    stream = builder.Seal(client);
+  } else {
+    DataframeStreamBuilder builder(client);
+    builder.SetParam("kind", "bench");
+    builder.SetDepth(scenario.depth);
+    stream = builder.Seal(client);
+  }
+  RETURN_ON_ASSERT(stream != nullptr, "Failed to create the stream");
+  id = stream->id();
+  return Status::OK();
+}
+
+Status produce(std::string const& ipc_socket, Scenario const& scenario,
+               size_t const bytes,
+               std::shared_ptr<arrow::RecordBatch> const& batch,
+               ObjectID const id, Channel& channel, Side& side) {
+  Client client;
+  RETURN_ON_ERROR(client.Connect(ipc_socket));
+  size_t chunks = std::max<size_t>(bytes / scenario.chunk_size, 1);
+  if (scenario.kind == "byte") {
+    auto stream = client.GetObject<ByteStream>(id);
+    RETURN_ON_ASSERT(stream != nullptr, "Failed to get the stream");
+    auto writer = stream->OpenWriter(client);
+    for (size_t i = 0; i < chunks; ++i) {
+      std::unique_ptr<arrow::MutableBuffer> buffer;
+      auto start = clock_type::now();
+      // blocked until the stream has the credit and the memory
+      RETURN_ON_ERROR(writer->GetNext(scenario.chunk_size, buffer));
+      side.blocked += nanosSince(start);
+      memset(buffer->mutable_data(), 0xab, buffer->size());
+      channel.Write();
+      side.bytes += buffer->size();
+      side.chunks += 1;
+    }
+    return writer->Finish();
+  } else {
+    auto stream = client.GetObject<DataframeStream>(id);
+    RETURN_ON_ASSERT(stream != nullptr, "Failed to get the stream");
+    auto writer = stream->OpenWriter(client);
+    auto chunk = batch;
+    for (size_t i = 0; i < chunks; ++i) {
+      auto start = clock_type::now();
+      // includes serializing the batch into the chunk
+      RETURN_ON_ERROR(writer->WriteBatch(chunk));
+      side.blocked += nanosSince(start);
+      channel.Write();
+      side.bytes += scenario.chunk_size;
+      side.chunks += 1;
+    }
+    return writer->Finish();
+  }
+}
+
+void received(std::unique_ptr<arrow::Buffer> const& buffer, Channel& channel,
+              Side& side) {
+  side.latencies.emplace_back(channel.Receive());
+  side.addresses.emplace(buffer->data());
+  side.bytes += buffer->size();
+  side.chunks += 1;
+}
+
+Status consume(Client& client, Scenario const& scenario, ObjectID const id,
+               Channel& channel, Side& side) {
+  if (scenario.kind == "byte") {
+    auto stream = client.GetObject<ByteStream>(id);
+    RETURN_ON_ASSERT(stream != nullptr, "Failed to get the stream");
+    auto reader = stream->OpenReader(client);
+    while (true) {
+      std::unique_ptr<arrow::Buffer> buffer;
+      auto start = clock_type::now();
+      auto status = reader->GetNext(buffer);
+      side.blocked += nanosSince(start);
+      if (status.IsStreamDrained()) {
+        return Status::OK();
+      }
+      RETURN_ON_ERROR(status);
+      received(buffer, channel, side);
+    }
+  } else {
+    auto stream = client.GetObject<DataframeStream>(id);
+    RETURN_ON_ASSERT(stream != nullptr, "Failed to get the stream");
+    auto reader = stream->OpenReader(client);
+    while (true) {
+      std::shared_ptr<arrow::RecordBatch> batch;
+      auto start = clock_type::now();
+      auto status = reader->ReadBatch(batch);
+      side.blocked += nanosSince(start);
+      if (status.IsStreamDrained()) {
+        return Status::OK();
+      }
+      RETURN_ON_ERROR(status);
+      RETURN_ON_ASSERT(batch != nullptr && batch->num_columns() == 1);
+      side.latencies.emplace_back(channel.Receive());
+      side.addresses.emplace(batch->column(0)->data()->buffers[1]->data());
+      side.bytes += scenario.chunk_size;
+      side.chunks += 1;
+    }
+  }
+}
+
+/**
+ * A single thread consumes all streams through their notifiers. The chunks
+ * of dataframe streams are received as they are, without being read as
+ * batches.
+ */
+Status consumeAll(Client& client, std::vector<ObjectID> const& ids,
+                  std::vector<std::unique_ptr<Channel>>& channels,
+                  Side& side) {
+  std::vector<struct pollfd> fds(ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    RETURN_ON_ERROR(client.OpenStreamNotifier(ids[i], fds[i].fd));
+    fds[i].events = POLLIN;
+  }
+  size_t drained = 0;
+  while (drained < ids.size()) {
+    auto start = clock_type::now();
+    int ready = poll(fds.data(), fds.size(), -1);
+    side.blocked += nanosSince(start);
+    if (ready < 0 && errno != EINTR) {
+      return Status::IOError("Failed to poll the stream notifiers: " +
+                             std::string(strerror(errno)));
+    }
+    for (size_t i = 0; i < ids.size() && ready > 0; ++i) {
+      if (fds[i].fd < 0 || !(fds[i].revents & POLLIN)) {
+        continue;
+      }
+      while (true) {
+        std::unique_ptr<arrow::Buffer> buffer;
+        auto status = client.TryPullNextStreamChunk(ids[i], buffer);
+        if (status.ok()) {
+          received(buffer, *channels[i], side);
+          continue;
+        }
+        if (status.IsStreamDrained()) {
+          // ignored by poll
+          fds[i].fd = -1;
+          drained += 1;
+        } else if (!status.IsStreamNotReady()) {
+          return status;
+        }
+        break;
+      }
+    }
+  }
+  return Status::OK();
+}
+
+Status runScenario(Options const& options, Scenario const& scenario,
+                   std::shared_ptr<arrow::RecordBatch> const& batch,
+                   Result& result) {
+  Client client;
+  RETURN_ON_ERROR(client.Connect(options.ipc_socket));
+  std::vector<ObjectID> ids(scenario.streams);
+  std::vector<std::unique_ptr<Channel>> channels;
+  for (size_t i = 0; i < scenario.streams; ++i) {
+    RETURN_ON_ERROR(createStream(client, scenario, ids[i]));
+    channels.emplace_back(new Channel());
+  }
+  std::shared_ptr<InstanceStatus> status;
+  RETURN_ON_ERROR(client.InstanceStatus(status));
+  size_t baseline = status->memory_usage;
+
+  // samples the memory usage of the server during the run
+  std::atomic<bool> running{true};
+  std::atomic<size_t> peak{baseline};
+  std::thread monitor([&]() {
+    Client monitor_client;
+    if (!monitor_client.Connect(options.ipc_socket).ok()) {
+      return;
+    }
+    while (running) {
+      std::shared_ptr<InstanceStatus> sample;
+      if (monitor_client.InstanceStatus(sample).ok() &&
+          sample->memory_usage > peak) {
+        peak = sample->memory_usage;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  });
+
+  size_t consumer_count = scenario.fan_in ? 1 : scenario.streams;
+  std::vector<Side> producers(scenario.streams), consumers(consumer_count);
+  std::vector<Status> statuses(scenario.streams + consumer_count);
+  std::vector<std::thread> threads;
+  auto start = clock_type::now();
+  if (scenario.fan_in) {
+    threads.emplace_back([&]() {
+      Client consumer_client;
+      statuses[0] = consumer_client.Connect(options.ipc_socket);
+      if (statuses[0].ok()) {
+        statuses[0] = consumeAll(consumer_client, ids, channels, consumers[0]);
+      }
+    });
+  } else {
+    for (size_t i = 0; i < scenario.streams; ++i) {
+      threads.emplace_back([&, i]() {
+        Client consumer_client;
+        statuses[i] = consumer_client.Connect(options.ipc_socket);
+        if (statuses[i].ok()) {
+          statuses[i] = consume(consumer_client, scenario, ids[i],
+                                *channels[i], consumers[i]);
+        }
+      });
+    }
+  }
+  for (size_t i = 0; i < scenario.streams; ++i) {
+    threads.emplace_back([&, i]() {
+      statuses[consumer_count + i] =
+          produce(options.ipc_socket, scenario, options.bytes, batch, ids[i],
+                  *channels[i], producers[i]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  result.seconds = nanosSince(start) / 1e9;
+  running = false;
+  monitor.join();
+
+  // the chunks are released with the streams
+  VINEYARD_SUPPRESS(client.DelData(ids, true, true));
+  for (auto const& s : statuses) {
+    RETURN_ON_ERROR(s);
+  }
+
+  result.scenario = scenario;
+  for (auto& side : producers) {
+    merge(result.producers, side);
+  }
+  for (auto& side : consumers) {
+    merge(result.consumers, side);
+  }
+  std::sort(result.consumers.latencies.begin(),
+            result.consumers.latencies.end());
+  result.peak_memory = peak > baseline ? peak - baseline : 0;
+  return Status::OK();
+}
+
+int64_t percentile(std::vector<int64_t> const& sorted, double const p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(p * sorted.size());
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void writeJSON(std::ostream& os, std::vector<Result> const& results) {
+  auto micros = [](int64_t nanos) { return nanos / 1e3; };
+  auto writeSide = [&](Side const& side, size_t const threads,
+                       double const seconds) {
+    os << "{\"chunks\": " << side.chunks << ", \"bytes\": " << side.bytes
+       << ", \"blocked_seconds\": " << side.blocked / 1e9
+       << ", \"blocked_ratio\": "
+       << (seconds > 0 ? side.blocked / 1e9 / (seconds * threads) : 0) << "}";
+  };
+  os << std::fixed << std::setprecision(3);
+  os << "{\n  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto const& result = results[i];
+    auto const& scenario = result.scenario;
+    auto const& consumers = result.consumers;
+    size_t consumer_count = scenario.fan_in ? 1 : scenario.streams;
+    os << (i == 0 ? "\n" : ",\n") << "    {\"kind\": \"" << scenario.kind
+       << "\", \"topology\": \"" << (scenario.fan_in ? "fan_in" : "pairs")
+       << "\", \"streams\": " << scenario.streams
+       << ", \"chunk_size\": " << scenario.chunk_size
+       << ", \"depth\": " << scenario.depth
+       << ", \"seconds\": " << result.seconds << ", \"gb_per_second\": "
+       << (result.seconds > 0 ? consumers.bytes / result.seconds / 1e9 : 0)
+       << ",\n     \"chunk_latency_us\": {\"p50\": "
+       << micros(percentile(consumers.latencies, 0.5))
+       << ", \"p99\": " << micros(percentile(consumers.latencies, 0.99))
+       << ", \"p999\": " << micros(percentile(consumers.latencies, 0.999))
+       << ", \"max\": "
+       << micros(consumers.latencies.empty() ? 0 : consumers.latencies.back())
+       << "},\n     \"producers\": ";
+    writeSide(result.producers, scenario.streams, result.seconds);
+    os << ",\n     \"consumers\": ";
+    writeSide(consumers, consumer_count, result.seconds);
+    os << ",\n     \"distinct_chunks\": " << consumers.addresses.size()
+       << ", \"reused_ratio\": "
+       << (consumers.chunks > 0
+               ? 1.0 - static_cast<double>(consumers.addresses.size()) /
+                           consumers.chunks
+               : 0)
+       << ", \"peak_memory_bytes\": " << result.peak_memory << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    usage();
+    return 1;
+  }
+
+  std::vector<Scenario> scenarios;
+  for (auto const& kind : options.kinds) {
+    for (size_t chunk_size : options.chunk_sizes) {
+      for (size_t depth : options.depths) {
+        Scenario scenario;
+        scenario.kind = kind;
+        scenario.chunk_size = std::max<size_t>(chunk_size, 1);
+        scenario.depth = depth;
+        for (size_t streams : options.pairs) {
+          scenario.streams = std::max<size_t>(streams, 1);
+          scenario.fan_in = false;
+          scenarios.emplace_back(scenario);
+        }
+        for (size_t streams : options.fan_in) {
+          scenario.streams = std::max<size_t>(streams, 1);
+          scenario.fan_in = true;
+          scenarios.emplace_back(scenario);
+        }
+      }
+    }
+  }
+
+  std::vector<Result> results;
+  for (auto const& scenario : scenarios) {
+    std::shared_ptr<arrow::RecordBatch> batch;
+    if (scenario.kind == "dataframe") {
+      VINEYARD_CHECK_OK(makeBatch(scenario.chunk_size, batch));
+    }
+    Result result;
+    auto status = runScenario(options, scenario, batch, result);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to run the " << scenario.kind << " stream with "
+                 << scenario.streams << " streams of chunk size "
+                 << scenario.chunk_size << ": " << status.ToString();
+      continue;
+    }
+    results.emplace_back(std::move(result));
+  }
+
+  if (options.output.empty()) {
+    writeJSON(std::cout, results);
+  } else {
+    std::ofstream os(options.output);
+    writeJSON(os, results);
+    if (!os) {
+      LOG(ERROR) << "Failed to write the results to " << options.output;
+      return 1;
+    }
+  }
+  return 0;
+}
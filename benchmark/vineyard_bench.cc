@@ -0,0 +1,697 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/**
+ * vineyard_bench drives a running vineyardd through the IPC and RPC clients
+ * and reports the latency percentiles and the throughput of the requests in
+ * JSON, e.g.,
+ *
+ *   ./vineyard_bench --ipc_socket=/var/run/vineyard.sock --threads=8 \
+ *       --filter=create_blob,get_name --output=bench.json
+ *
+ * Every thread has its own connections. The RPC benchmarks are run against
+ * the RPC endpoint of the vineyardd (or `--rpc_endpoint`), and are skipped
+ * if it isn't reachable.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "boost/algorithm/string.hpp"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "client/rpc_client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+namespace {
+
+constexpr const char* kCompositeTypeName = "vineyard::bench::Composite";
+constexpr const char* kItemTypeName = "vineyard::bench::Item";
+
+struct Options {
+  std::string ipc_socket;
+  std::string rpc_endpoint;
+  std::string output;
+  // the benchmarks to run, all if empty
+  std::vector<std::string> filter;
+  size_t threads = 4;
+  size_t iterations = 1000;
+  size_t warmup = 100;
+  std::vector<size_t> sizes{64, 4096, 65536, 1024 * 1024, 16 * 1024 * 1024};
+  std::vector<size_t> members{1, 16, 256};
+  std::vector<size_t> batches{1, 64, 1024};
+  size_t list_size = 10000;
+};
+
+/** The connections and the scratch state of a thread. */
+struct Worker {
+  size_t index = 0;
+  Client ipc;
+  RPCClient rpc;
+  std::unique_ptr<BlobWriter> writer;
+  ObjectID object_id = InvalidObjectID();
+  ObjectMeta fetched;
+  std::vector<ObjectID> garbage;
+};
+
+/**
+ * The timed `run` of an iteration is surrounded by the untimed `prepare` and
+ * `after`, `finish` cleans up after all iterations of the thread.
+ */
+struct Workload {
+  std::function<Status(Worker&, size_t)> prepare;
+  std::function<Status(Worker&, size_t)> run;
+  std::function<Status(Worker&, size_t)> after;
+  std::function<Status(Worker&)> finish;
+};
+
+struct Result {
+  std::string name;
+  std::vector<std::pair<std::string, size_t>> params;
+  size_t threads = 0;
+  double seconds = 0;
+  // in nanoseconds
+  std::vector<int64_t> latencies;
+};
+
+bool parseSizes(std::string const& value, std::vector<size_t>& sizes) {
+  std::vector<std::string> items;
+  boost::algorithm::split(items, value, boost::is_any_of(","));
+  sizes.clear();
+  for (auto const& item : items) {
+    if (item.empty()) {
+      continue;
+    }
+    try {
+      sizes.emplace_back(std::stoull(item));
+    } catch (std::exception const&) {
+      return false;
+    }
+  }
+  return !sizes.empty();
+}
+
+void usage() {
+  std::cerr
+      << "usage: ./vineyard_bench [--ipc_socket=<path>] [--rpc_endpoint="
+         "<host:port>]\n"
+         "                        [--threads=4] [--iterations=1000] "
+         "[--warmup=100]\n"
+         "                        [--sizes=64,4096,...] [--members=1,16,256]\n"
+         "                        [--batches=1,64,1024] [--list_size=10000]\n"
+         "                        [--filter=<benchmark>,...] "
+         "[--output=<file>]\n"
+         "benchmarks: create_blob, get_object, get_buffers, persist, "
+         "put_name,\n"
+         "            get_name, list_data, rpc_get_object, rpc_get_blobs,\n"
+         "            rpc_persist, rpc_put_name, rpc_get_name, rpc_list_data\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+  if (const char* env_p = std::getenv("VINEYARD_IPC_SOCKET")) {
+    options.ipc_socket = env_p;
+  }
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto pos = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || pos == std::string::npos) {
+      return false;
+    }
+    std::string key = arg.substr(2, pos - 2), value = arg.substr(pos + 1);
+    try {
+      if (key == "ipc_socket") {
+        options.ipc_socket = value;
+      } else if (key == "rpc_endpoint") {
+        options.rpc_endpoint = value;
+      } else if (key == "output") {
+        options.output = value;
+      } else if (key == "filter") {
+        boost::algorithm::split(options.filter, value, boost::is_any_of(","));
+      } else if (key == "threads") {
+        options.threads = std::max<size_t>(std::stoull(value), 1);
+      } else if (key == "iterations") {
+        options.iterations = std::max<size_t>(std::stoull(value), 1);
+      } else if (key == "warmup") {
+        options.warmup = std::stoull(value);
+      } else if (key == "list_size") {
+        options.list_size = std::max<size_t>(std::stoull(value), 1);
+      } else if (key == "sizes") {
+        if (!parseSizes(value, options.sizes)) {
+          return false;
+        }
+      } else if (key == "members") {
+        if (!parseSizes(value, options.members)) {
+          return false;
+        }
+      } else if (key == "batches") {
+        if (!parseSizes(value, options.batches)) {
+          return false;
+        }
+      } else {
+        return false;
+      }
+    } catch (std::exception const&) {
+      return false;
+    }
+  }
+  return !options.ipc_socket.empty();
+}
+
+bool selected(Options const& options, std::string const& name) {
+  return options.filter.empty() ||
+         std::find(options.filter.begin(), options.filter.end(), name) !=
+             options.filter.end();
+}
+
+int64_t nanosSince(std::chrono::steady_clock::time_point const& start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/** Run `iterations` iterations of the workload on every worker. */
+Status runIterations(std::vector<std::unique_ptr<Worker>>& workers,
+                     Workload const& workload, size_t const iterations,
+                     std::vector<std::vector<int64_t>>* latencies) {
+  std::vector<Status> statuses(workers.size());
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < workers.size(); ++t) {
+    threads.emplace_back([&, t]() {
+      Worker& worker = *workers[t];
+      for (size_t i = 0; i < iterations; ++i) {
+        if (workload.prepare) {
+          statuses[t] = workload.prepare(worker, i);
+          if (!statuses[t].ok()) {
+            return;
+          }
+        }
+        auto start = std::chrono::steady_clock::now();
+        statuses[t] = workload.run(worker, i);
+        int64_t elapsed = nanosSince(start);
+        if (!statuses[t].ok()) {
+          return;
+        }
+        if (latencies) {
+          (*latencies)[t].emplace_back(elapsed);
+        }
+        if (workload.after) {
+          statuses[t] = workload.after(worker, i);
+          if (!statuses[t].ok()) {
+            return;
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto const& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+  return Status::OK();
+}
+
+Status runWorkload(Options const& options,
+                   std::vector<std::unique_ptr<Worker>>& workers,
+                   Workload const& workload, Result& result) {
+  auto finish = [&]() {
+    Status status;
+    if (workload.finish) {
+      for (auto& worker : workers) {
+        auto s = workload.finish(*worker);
+        if (!s.ok() && status.ok()) {
+          status = s;
+        }
+      }
+    }
+    return status;
+  };
+
+  auto status = runIterations(workers, workload, options.warmup, nullptr);
+  std::vector<std::vector<int64_t>> latencies(workers.size());
+  auto start = std::chrono::steady_clock::now();
+  if (status.ok()) {
+    status = runIterations(workers, workload, options.iterations, &latencies);
+  }
+  result.seconds = nanosSince(start) / 1e9;
+  auto finished = finish();
+  RETURN_ON_ERROR(status);
+  RETURN_ON_ERROR(finished);
+
+  result.threads = workers.size();
+  for (auto const& thread_latencies : latencies) {
+    result.latencies.insert(result.latencies.end(), thread_latencies.begin(),
+                            thread_latencies.end());
+  }
+  std::sort(result.latencies.begin(), result.latencies.end());
+  return Status::OK();
+}
+
+/** Create `count` blobs of `size` bytes. */
+Status createBlobs(Client& client, size_t const count, size_t const size,
+                   std::vector<ObjectID>& ids) {
+  for (size_t i = 0; i < count; ++i) {
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client.CreateBlob(size, writer));
+    auto blob = writer->Seal(client);
+    RETURN_ON_ASSERT(blob != nullptr);
+    ids.emplace_back(blob->id());
+  }
+  return Status::OK();
+}
+
+/**
+ * Create an object of the given blobs as its members, which is persisted
+ * thus it is visible through the RPC endpoints as well.
+ */
+Status createComposite(ClientBase& client, std::vector<ObjectID> const& blobs,
+                       ObjectID& id) {
+  ObjectMeta meta;
+  meta.SetTypeName(kCompositeTypeName);
+  meta.SetNBytes(0);
+  meta.AddKeyValue("__members_-size", std::to_string(blobs.size()));
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    meta.AddMember("__members_-" + std::to_string(i), blobs[i]);
+  }
+  RETURN_ON_ERROR(client.CreateMetaData(meta, id));
+  return client.Persist(id);
+}
+
+Status createItem(ClientBase& client, ObjectID& id) {
+  ObjectMeta meta;
+  meta.SetTypeName(kItemTypeName);
+  meta.SetNBytes(0);
+  return client.CreateMetaData(meta, id);
+}
+
+ClientBase& clientOf(Worker& worker, bool const rpc) {
+  if (rpc) {
+    return worker.rpc;
+  }
+  return worker.ipc;
+}
+
+std::string nameOf(Worker const& worker, size_t const iteration) {
+  return "vineyard-bench-" + std::to_string(worker.index) + "-" +
+         std::to_string(iteration);
+}
+
+class Benchmarks {
+ public:
+  explicit Benchmarks(Options const& options) : options_(options) {}
+
+  Status Run(std::vector<Result>& results) {
+    RETURN_ON_ERROR(connect());
+    for (size_t size : options_.sizes) {
+      run("create_blob", {{"size", size}}, [&]() { return createBlob(size); },
+          results);
+    }
+    for (size_t members : options_.members) {
+      run("get_object", {{"members", members}},
+          [&]() { return getObject(members, false); }, results);
+    }
+    for (size_t batch : options_.batches) {
+      run("get_buffers", {{"batch", batch}},
+          [&]() { return getBuffers(batch); }, results);
+    }
+    run("persist", {}, [&]() { return persist(false); }, results);
+    run("put_name", {}, [&]() { return putName(false); }, results);
+    run("get_name", {}, [&]() { return getName(false); }, results);
+    run("list_data", {{"objects", options_.list_size}},
+        [&]() { return listData(false); }, results);
+
+    if (!rpc_available_) {
+      return Status::OK();
+    }
+    for (size_t members : options_.members) {
+      run("rpc_get_object", {{"members", members}},
+          [&]() { return getObject(members, true); }, results);
+    }
+    for (size_t batch : options_.batches) {
+      run("rpc_get_blobs", {{"batch", batch}},
+          [&]() { return getRemoteBlobs(batch); }, results);
+    }
+    run("rpc_persist", {}, [&]() { return persist(true); }, results);
+    run("rpc_put_name", {}, [&]() { return putName(true); }, results);
+    run("rpc_get_name", {}, [&]() { return getName(true); }, results);
+    run("rpc_list_data", {{"objects", options_.list_size}},
+        [&]() { return listData(true); }, results);
+    return Status::OK();
+  }
+
+  Status Cleanup() {
+    if (!workers_.empty() && !garbage_.empty()) {
+      RETURN_ON_ERROR(workers_[0]->ipc.DelData(garbage_, true, true));
+      garbage_.clear();
+    }
+    return Status::OK();
+  }
+
+ private:
+  Status connect() {
+    for (size_t t = 0; t < options_.threads; ++t) {
+      std::unique_ptr<Worker> worker(new Worker());
+      worker->index = t;
+      RETURN_ON_ERROR(worker->ipc.Connect(options_.ipc_socket));
+      workers_.emplace_back(std::move(worker));
+    }
+    std::string endpoint = options_.rpc_endpoint.empty()
+                               ? workers_[0]->ipc.RPCEndpoint()
+                               : options_.rpc_endpoint;
+    rpc_available_ = !endpoint.empty();
+    for (auto& worker : workers_) {
+      if (!rpc_available_) {
+        break;
+      }
+      auto status = worker->rpc.Connect(endpoint);
+      if (!status.ok()) {
+        LOG(WARNING) << "The RPC benchmarks are skipped, since failed to "
+                     << "connect to " << endpoint << ": " << status.ToString();
+        rpc_available_ = false;
+      }
+    }
+    return Status::OK();
+  }
+
+  void run(std::string const& name,
+           std::vector<std::pair<std::string, size_t>> const& params,
+           std::function<Workload()> const& make,
+           std::vector<Result>& results) {
+    if (!selected(options_, name)) {
+      return;
+    }
+    Result result;
+    result.name = name;
+    result.params = params;
+    setup_ = Status::OK();
+    Workload workload = make();
+    auto status = setup_;
+    if (status.ok()) {
+      status = runWorkload(options_, workers_, workload, result);
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to run " << name << ": " << status.ToString();
+      return;
+    }
+    LOG(INFO) << "Finished " << name << " in " << result.seconds << "s";
+    results.emplace_back(std::move(result));
+  }
+
+  // the object shared by all workers, the setup error is reported by `run`
+  ObjectID setupComposite(size_t const members) {
+    std::vector<ObjectID> blobs;
+    ObjectID id = InvalidObjectID();
+    setup_ = createBlobs(workers_[0]->ipc, members, 64, blobs);
+    if (setup_.ok()) {
+      setup_ = createComposite(workers_[0]->ipc, blobs, id);
+    }
+    garbage_.insert(garbage_.end(), blobs.begin(), blobs.end());
+    if (id != InvalidObjectID()) {
+      garbage_.emplace_back(id);
+    }
+    return id;
+  }
+
+  Workload createBlob(size_t const size) {
+    Workload workload;
+    workload.run = [size](Worker& worker, size_t) {
+      return worker.ipc.CreateBlob(size, worker.writer);
+    };
+    workload.after = [](Worker& worker, size_t) {
+      auto blob = worker.writer->Seal(worker.ipc);
+      RETURN_ON_ASSERT(blob != nullptr);
+      worker.garbage.emplace_back(blob->id());
+      // bounds the memory that held by the benchmark
+      if (worker.garbage.size() >= 64) {
+        RETURN_ON_ERROR(worker.ipc.DelData(worker.garbage, true, true));
+        worker.garbage.clear();
+      }
+      return Status::OK();
+    };
+    workload.finish = [](Worker& worker) {
+      auto status = Status::OK();
+      if (!worker.garbage.empty()) {
+        status = worker.ipc.DelData(worker.garbage, true, true);
+        worker.garbage.clear();
+      }
+      return status;
+    };
+    return workload;
+  }
+
+  // the object can't be constructed since its type isn't registered, the
+  // metadata (including the payloads of blobs) is what `GetObject` resolves
+  Workload getObject(size_t const members, bool const rpc) {
+    ObjectID id = setupComposite(members);
+    Workload workload;
+    workload.run = [id, rpc](Worker& worker, size_t) {
+      ObjectMeta meta;
+      if (rpc) {
+        return worker.rpc.GetMetaData(id, meta, false);
+      }
+      return worker.ipc.GetMetaData(id, meta, false);
+    };
+    return workload;
+  }
+
+  Workload getBuffers(size_t const batch) {
+    std::vector<ObjectID> blobs;
+    setup_ = createBlobs(workers_[0]->ipc, batch, 64, blobs);
+    garbage_.insert(garbage_.end(), blobs.begin(), blobs.end());
+    Workload workload;
+    workload.run = [blobs](Worker& worker, size_t) {
+      auto objects = worker.ipc.GetObjects(blobs);
+      RETURN_ON_ASSERT(objects.size() == blobs.size());
+      return Status::OK();
+    };
+    return workload;
+  }
+
+  Workload getRemoteBlobs(size_t const batch) {
+    ObjectID id = setupComposite(batch);
+    Workload workload;
+    // the fetched blobs are kept in the metadata, thus it's fetched again
+    workload.prepare = [id](Worker& worker, size_t) {
+      worker.fetched = ObjectMeta();
+      return worker.rpc.GetMetaData(id, worker.fetched, false);
+    };
+    workload.run = [](Worker& worker, size_t) {
+      return worker.rpc.GetRemoteBlobs(worker.fetched);
+    };
+    return workload;
+  }
+
+  Workload persist(bool const rpc) {
+    Workload workload;
+    workload.prepare = [](Worker& worker, size_t) {
+      return createItem(worker.ipc, worker.object_id);
+    };
+    workload.run = [rpc](Worker& worker, size_t) {
+      return clientOf(worker, rpc).Persist(worker.object_id);
+    };
+    workload.after = [](Worker& worker, size_t) {
+      worker.garbage.emplace_back(worker.object_id);
+      return Status::OK();
+    };
+    workload.finish = [](Worker& worker) {
+      auto status = worker.ipc.DelData(worker.garbage, true, true);
+      worker.garbage.clear();
+      worker.object_id = InvalidObjectID();
+      return status;
+    };
+    return workload;
+  }
+
+  Workload putName(bool const rpc) {
+    Workload workload;
+    workload.prepare = [](Worker& worker, size_t) {
+      if (worker.object_id == InvalidObjectID()) {
+        RETURN_ON_ERROR(createItem(worker.ipc, worker.object_id));
+        RETURN_ON_ERROR(worker.ipc.Persist(worker.object_id));
+      }
+      return Status::OK();
+    };
+    workload.run = [rpc](Worker& worker, size_t i) {
+      return clientOf(worker, rpc).PutName(worker.object_id, nameOf(worker, i));
+    };
+    workload.finish = [this](Worker& worker) { return dropNames(worker); };
+    return workload;
+  }
+
+  Workload getName(bool const rpc) {
+    Workload workload;
+    workload.prepare = [this](Worker& worker, size_t) {
+      if (worker.object_id == InvalidObjectID()) {
+        RETURN_ON_ERROR(createItem(worker.ipc, worker.object_id));
+        RETURN_ON_ERROR(worker.ipc.Persist(worker.object_id));
+        size_t count = options_.warmup + options_.iterations;
+        for (size_t i = 0; i < count; ++i) {
+          RETURN_ON_ERROR(
+              worker.ipc.PutName(worker.object_id, nameOf(worker, i)));
+        }
+      }
+      return Status::OK();
+    };
+    workload.run = [rpc](Worker& worker, size_t i) {
+      ObjectID id = InvalidObjectID();
+      RETURN_ON_ERROR(clientOf(worker, rpc).GetName(nameOf(worker, i), id));
+      RETURN_ON_ASSERT(id == worker.object_id);
+      return Status::OK();
+    };
+    workload.finish = [this](Worker& worker) { return dropNames(worker); };
+    return workload;
+  }
+
+  Status dropNames(Worker& worker) {
+    size_t count = options_.warmup + options_.iterations;
+    for (size_t i = 0; i < count; ++i) {
+      VINEYARD_SUPPRESS(worker.ipc.DropName(nameOf(worker, i)));
+    }
+    if (worker.object_id != InvalidObjectID()) {
+      garbage_.emplace_back(worker.object_id);
+      worker.object_id = InvalidObjectID();
+    }
+    return Status::OK();
+  }
+
+  Workload listData(bool const rpc) {
+    if (listed_.empty()) {
+      for (size_t i = 0; i < options_.list_size && setup_.ok(); ++i) {
+        ObjectID id = InvalidObjectID();
+        setup_ = createItem(workers_[0]->ipc, id);
+        if (setup_.ok()) {
+          listed_.emplace_back(id);
+        }
+      }
+      // persisted to be listed through the RPC endpoints as well
+      if (setup_.ok()) {
+        setup_ = workers_[0]->ipc.Persist(listed_);
+      }
+      garbage_.insert(garbage_.end(), listed_.begin(), listed_.end());
+    }
+    size_t limit = options_.list_size;
+    Workload workload;
+    workload.run = [rpc, limit](Worker& worker, size_t) {
+      std::unordered_map<ObjectID, ptree> metas;
+      return clientOf(worker, rpc).ListData(kItemTypeName, false, limit,
+                                            metas);
+    };
+    return workload;
+  }
+
+  Options const& options_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  bool rpc_available_ = false;
+  Status setup_;
+  // objects created by the setup of benchmarks
+  std::vector<ObjectID> garbage_;
+  std::vector<ObjectID> listed_;
+};
+
+int64_t percentile(std::vector<int64_t> const& sorted, double const p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = static_cast<size_t>(p * sorted.size());
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void writeJSON(std::ostream& os, Options const& options,
+               std::vector<Result> const& results) {
+  auto micros = [](int64_t nanos) { return nanos / 1e3; };
+  os << std::fixed << std::setprecision(3);
+  os << "{\n  \"config\": {\"threads\": " << options.threads
+     << ", \"iterations\": " << options.iterations
+     << ", \"warmup\": " << options.warmup << "},\n";
+  os << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto const& result = results[i];
+    int64_t total = 0;
+    for (auto latency : result.latencies) {
+      total += latency;
+    }
+    size_t ops = result.latencies.size();
+    os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name
+       << "\", \"params\": {";
+    for (size_t j = 0; j < result.params.size(); ++j) {
+      os << (j == 0 ? "" : ", ") << "\"" << result.params[j].first
+         << "\": " << result.params[j].second;
+    }
+    os << "}, \"threads\": " << result.threads << ", \"ops\": " << ops
+       << ", \"seconds\": " << result.seconds << ", \"ops_per_second\": "
+       << (result.seconds > 0 ? ops / result.seconds : 0)
+       << ", \"latency_us\": {\"mean\": "
+       << (ops > 0 ? micros(total) / ops : 0)
+       << ", \"p50\": " << micros(percentile(result.latencies, 0.5))
+       << ", \"p99\": " << micros(percentile(result.latencies, 0.99))
+       << ", \"p999\": " << micros(percentile(result.latencies, 0.999))
+       << ", \"max\": "
+       << micros(result.latencies.empty() ? 0 : result.latencies.back())
+       << "}}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    usage();
+    return 1;
+  }
+
+  std::vector<Result> results;
+  Benchmarks benchmarks(options);
+  auto status = benchmarks.Run(results);
+  auto cleanup = benchmarks.Cleanup();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to run the benchmarks: " << status.ToString();
+    return 1;
+  }
+  if (!cleanup.ok()) {
+    LOG(WARNING) << "Failed to clean up the benchmarks: "
+                 << cleanup.ToString();
+  }
+
+  if (options.output.empty()) {
+    writeJSON(std::cout, options, results);
+  } else {
+    std::ofstream os(options.output);
+    writeJSON(os, options, results);
+    if (!os) {
+      LOG(ERROR) << "Failed to write the results to " << options.output;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef MODULES_BASIC_DS_ARRAY_H_
 #define MODULES_BASIC_DS_ARRAY_H_
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -162,6 +164,130 @@ class ResizableArrayBuilder : public ArrayBaseBuilder<T> {
   std::vector<T> vec_;
 };
 
+/**
+ * @brief GrowableArrayBuilder builds arrays whose final size is unknown in
+ * advance, like `ResizableArrayBuilder`, but the elements are appended to a
+ * region reserved in the vineyard server (see `BlobArena`) rather than a
+ * local `std::vector`, thus the array is sealed in place without copying.
+ *
+ * The region grows by doubling, which copies the elements once into the new
+ * region, like `std::vector`, and the growth can be avoided by reserving the
+ * expected capacity. The unused tail of the region is released after the
+ * sealed array has been deleted.
+ *
+ * @tparam T The type for the elements, which must be trivially copyable.
+ */
+template <typename T>
+class GrowableArrayBuilder : public ArrayBaseBuilder<T> {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "The elements of growable arrays must be trivially copyable");
+
+ public:
+  /**
+   * @brief The capacity of the first region, in bytes.
+   */
+  static constexpr size_t kMinimumCapacity = 4096;
+
+  explicit GrowableArrayBuilder(Client& client, size_t size = 0)
+      : ArrayBaseBuilder<T>(client), client_(client) {
+    resize(size);
+  }
+
+  ~GrowableArrayBuilder() {
+    if (arena_ != nullptr) {
+      // releases the reserved region, as nothing has been allocated from it
+      VINEYARD_SUPPRESS(arena_->Seal(client_));
+    }
+  }
+
+  T& operator[](size_t idx) { return data_[idx]; }
+
+  void push_back(T const& v) {
+    grow(size_ + 1);
+    data_[size_++] = v;
+  }
+
+  template <class... Args>
+  void emplace_back(Args&&... args) {
+    grow(size_ + 1);
+    new (data_ + size_++) T(std::forward<Args>(args)...);
+  }
+
+  size_t const size() const { return size_; }
+
+  size_t const capacity() const { return capacity_; }
+
+  void reserve(size_t size) {
+    if (size > capacity_) {
+      VINEYARD_CHECK_OK(reallocate(size));
+    }
+  }
+
+  void resize(size_t size) { resize(size, T()); }
+
+  void resize(size_t size, T const& value) {
+    grow(size);
+    for (size_t index = size_; index < size; ++index) {
+      data_[index] = value;
+    }
+    size_ = size;
+  }
+
+  bool empty() const { return size_ == 0; }
+
+  T* data() noexcept { return data_; }
+
+  const T* data() const noexcept { return data_; }
+
+  Status Build(Client& client) override {
+    std::unique_ptr<BlobWriter> buffer_writer;
+    if (size_ == 0) {
+      RETURN_ON_ERROR(client.CreateBlob(0, buffer_writer));
+    } else {
+      // the elements are already in place at the beginning of the region
+      RETURN_ON_ERROR(arena_->Allocate(size_ * sizeof(T), buffer_writer));
+    }
+    if (arena_ != nullptr) {
+      RETURN_ON_ERROR(arena_->Seal(client));
+      arena_.reset();
+    }
+    this->set_size_(size_);
+    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+    return Status::OK();
+  }
+
+ private:
+  void grow(size_t size) {
+    if (size > capacity_) {
+      VINEYARD_CHECK_OK(reallocate(std::max(size, capacity_ * 2)));
+    }
+  }
+
+  Status reallocate(size_t capacity) {
+    size_t bytes = std::max(kMinimumCapacity, capacity * sizeof(T));
+    std::unique_ptr<BlobArena> arena;
+    RETURN_ON_ERROR(client_.CreateBlobArena(bytes, arena));
+    T* data = reinterpret_cast<T*>(arena->Unallocated());
+    if (arena_ != nullptr) {
+      memcpy(data, data_, size_ * sizeof(T));
+      RETURN_ON_ERROR(arena_->Seal(client_));
+    }
+    arena_ = std::move(arena);
+    data_ = data;
+    capacity_ = bytes / sizeof(T);
+    return Status::OK();
+  }
+
+  Client& client_;
+  std::unique_ptr<BlobArena> arena_;
+  T* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
+template <typename T>
+constexpr size_t GrowableArrayBuilder<T>::kMinimumCapacity;
+
 }  // namespace vineyard
 
 #endif  // MODULES_BASIC_DS_ARRAY_H_
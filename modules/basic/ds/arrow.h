@@ -17,32 +17,32 @@ limitations under the License.
 #define MODULES_BASIC_DS_ARROW_H_
 
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "basic/ds/arrow.vineyard.h"
+#include "basic/ds/arrow_memory_pool.h"
 #include "basic/ds/arrow_utils.h"
+#include "basic/ds/encoded_array.h"
 #include "client/client.h"
 #include "client/ds/blob.h"
 
 namespace vineyard {
 
 #ifndef BUILD_NULL_BITMAP
-#define BUILD_NULL_BITMAP(builder, array)                                \
-  {                                                                      \
-    if (array->null_bitmap() && array->null_count() > 0) {               \
-      std::unique_ptr<BlobWriter> bitmap_buffer_writer;                  \
-      RETURN_ON_ERROR(client.CreateBlob(array->null_bitmap()->size(),    \
-                                        bitmap_buffer_writer));          \
-      memcpy(bitmap_buffer_writer->data(), array->null_bitmap()->data(), \
-             array->null_bitmap()->size());                              \
-      builder->set_null_bitmap_(                                         \
-          std::shared_ptr<BlobWriter>(std::move(bitmap_buffer_writer))); \
-    } else {                                                             \
-      builder->set_null_bitmap_(Blob::MakeEmpty(client));                \
-    }                                                                    \
+#define BUILD_NULL_BITMAP(builder, array)                                  \
+  {                                                                        \
+    if (array->null_bitmap() && array->null_count() > 0) {                 \
+      std::shared_ptr<ObjectBase> bitmap_buffer_writer;                    \
+      RETURN_ON_ERROR(                                                     \
+          BuildBlob(client, array->null_bitmap(), bitmap_buffer_writer));  \
+      builder->set_null_bitmap_(bitmap_buffer_writer);                     \
+    } else {                                                               \
+      builder->set_null_bitmap_(Blob::MakeEmpty(client));                  \
+    }                                                                      \
   }
 #endif
 
@@ -62,15 +62,13 @@ class NumericArrayBuilder : public NumericArrayBaseBuilder<T> {
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::shared_ptr<ObjectBase> buffer_writer;
+    RETURN_ON_ERROR(BuildBlob(client, array_->values(), buffer_writer));
 
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+    this->set_buffer_(buffer_writer);
     BUILD_NULL_BITMAP(this, array_);
     return Status::OK();
   }
@@ -93,16 +91,14 @@ class FixedSizeBinaryArrayBuilder : public FixedSizeBinaryArrayBaseBuilder {
   std::shared_ptr<arrow::FixedSizeBinaryArray> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::shared_ptr<ObjectBase> buffer_writer;
+    RETURN_ON_ERROR(BuildBlob(client, array_->values(), buffer_writer));
 
     this->set_byte_width_(array_->byte_width());
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+    this->set_buffer_(buffer_writer);
     BUILD_NULL_BITMAP(this, array_);
     return Status::OK();
   }
@@ -147,24 +143,15 @@ class StringArrayBuilder : public StringArrayBaseBuilder {
 
   Status Build(Client& client) override {
     {
-      std::unique_ptr<BlobWriter> buffer_writer;
+      std::shared_ptr<ObjectBase> buffer_writer;
       RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_offsets()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_offsets()->data(),
-             array_->value_offsets()->size());
-
-      this->set_buffer_offsets_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+          BuildBlob(client, array_->value_offsets(), buffer_writer));
+      this->set_buffer_offsets_(buffer_writer);
     }
     {
-      std::unique_ptr<BlobWriter> buffer_writer;
-      RETURN_ON_ERROR(
-          client.CreateBlob(array_->value_data()->size(), buffer_writer));
-      memcpy(buffer_writer->data(), array_->value_data()->data(),
-             array_->value_data()->size());
-
-      this->set_buffer_data_(
-          std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+      std::shared_ptr<ObjectBase> buffer_writer;
+      RETURN_ON_ERROR(BuildBlob(client, array_->value_data(), buffer_writer));
+      this->set_buffer_data_(buffer_writer);
     }
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
@@ -192,15 +179,13 @@ class BooleanArrayBuilder : public BooleanArrayBaseBuilder {
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
-    std::unique_ptr<BlobWriter> buffer_writer;
-    RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
-    memcpy(buffer_writer->data(), array_->values()->data(),
-           array_->values()->size());
+    std::shared_ptr<ObjectBase> buffer_writer;
+    RETURN_ON_ERROR(BuildBlob(client, array_->values(), buffer_writer));
 
     this->set_length_(array_->length());
     this->set_null_count_(array_->null_count());
     this->set_offset_(array_->offset());
-    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+    this->set_buffer_(buffer_writer);
     BUILD_NULL_BITMAP(this, array_);
     return Status::OK();
   }
@@ -209,6 +194,40 @@ class BooleanArrayBuilder : public BooleanArrayBaseBuilder {
   std::shared_ptr<ArrayType> array_;
 };
 
+namespace detail {
+
+inline std::shared_ptr<ObjectBuilder> BuildArray(
+    Client& client, std::shared_ptr<arrow::Array> array);
+
+}  // namespace detail
+
+/**
+ * @brief DictionaryArrayBuilder is designed for constructing dictionary-encoded
+ * Arrow arrays, the indices and the dictionary are kept encoded
+ *
+ */
+class DictionaryArrayBuilder : public DictionaryArrayBaseBuilder {
+ public:
+  using ArrayType = arrow::DictionaryArray;
+
+  DictionaryArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
+      : DictionaryArrayBaseBuilder(client), array_(array) {}
+
+  std::shared_ptr<ArrayType> GetArray() { return array_; }
+
+  Status Build(Client& client) override {
+    auto type =
+        std::dynamic_pointer_cast<arrow::DictionaryType>(array_->type());
+    this->set_ordered_(type->ordered());
+    this->set_indices_(detail::BuildArray(client, array_->indices()));
+    this->set_dictionary_(detail::BuildArray(client, array_->dictionary()));
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<ArrayType> array_;
+};
+
 #undef BUILD_NULL_BITMAP
 
 namespace detail {
@@ -230,6 +249,11 @@ inline std::shared_ptr<ObjectBuilder> BuildArray(
   return std::make_shared<StringArrayBuilder>(client, arr);
 }
 
+inline std::shared_ptr<ObjectBuilder> BuildArray(
+    Client& client, std::shared_ptr<arrow::DictionaryArray> arr) {
+  return std::make_shared<DictionaryArrayBuilder>(client, arr);
+}
+
 inline std::shared_ptr<ObjectBuilder> BuildArray(
     Client& client, std::shared_ptr<arrow::Array> array) {
   if (auto arr =
@@ -292,11 +316,57 @@ inline std::shared_ptr<ObjectBuilder> BuildArray(
   if (auto arr = std::dynamic_pointer_cast<arrow::NullArray>(array)) {
     return std::make_shared<NullArrayBuilder>(client, arr);
   }
+  if (auto arr = std::dynamic_pointer_cast<arrow::DictionaryArray>(array)) {
+    return std::make_shared<DictionaryArrayBuilder>(client, arr);
+  }
   VINEYARD_ASSERT(nullptr != nullptr,
                   "Unsupported array type: " + array->type()->ToString());
   return nullptr;
 }
 
+template <typename T>
+inline std::shared_ptr<ObjectBuilder> BuildEncodedArray(
+    Client& client, std::shared_ptr<arrow::Array> const& array,
+    ArrayEncoding const encoding) {
+  return std::make_shared<EncodedArrayBuilder<T>>(
+      client,
+      std::dynamic_pointer_cast<typename ConvertToArrowType<T>::ArrayType>(
+          array),
+      encoding);
+}
+
+/**
+ * Build the array with the given encoding, only the integer arrays are
+ * encoded, and other arrays are kept as is.
+ */
+inline std::shared_ptr<ObjectBuilder> BuildArray(
+    Client& client, std::shared_ptr<arrow::Array> array,
+    ArrayEncoding const encoding) {
+  if (encoding == ArrayEncoding::kPlain) {
+    return BuildArray(client, array);
+  }
+  switch (array->type()->id()) {
+  case arrow::Type::INT8:
+    return BuildEncodedArray<int8_t>(client, array, encoding);
+  case arrow::Type::UINT8:
+    return BuildEncodedArray<uint8_t>(client, array, encoding);
+  case arrow::Type::INT16:
+    return BuildEncodedArray<int16_t>(client, array, encoding);
+  case arrow::Type::UINT16:
+    return BuildEncodedArray<uint16_t>(client, array, encoding);
+  case arrow::Type::INT32:
+    return BuildEncodedArray<int32_t>(client, array, encoding);
+  case arrow::Type::UINT32:
+    return BuildEncodedArray<uint32_t>(client, array, encoding);
+  case arrow::Type::INT64:
+    return BuildEncodedArray<int64_t>(client, array, encoding);
+  case arrow::Type::UINT64:
+    return BuildEncodedArray<uint64_t>(client, array, encoding);
+  default:
+    return BuildArray(client, array);
+  }
+}
+
 }  // namespace detail
 
 /**
@@ -345,19 +415,34 @@ class RecordBatchBuilder : public RecordBatchBaseBuilder {
   RecordBatchBuilder(Client& client, std::shared_ptr<arrow::RecordBatch> batch)
       : RecordBatchBaseBuilder(client), batch_(batch) {}
 
+  /**
+   * @brief Build the batch with the given encodings of columns, the columns
+   * that are absent from the encodings are kept plain.
+   */
+  RecordBatchBuilder(Client& client, std::shared_ptr<arrow::RecordBatch> batch,
+                     std::map<int, ArrayEncoding> const& encodings)
+      : RecordBatchBaseBuilder(client), batch_(batch), encodings_(encodings) {}
+
   Status Build(Client& client) override {
     this->set_column_num_(batch_->num_columns());
     this->set_row_num_(batch_->num_rows());
     this->set_schema_(
         std::make_shared<SchemaProxyBuilder>(client, batch_->schema()));
     for (int64_t idx = 0; idx < batch_->num_columns(); ++idx) {
-      this->add_columns_(detail::BuildArray(client, batch_->column(idx)));
+      auto encoding = encodings_.find(idx);
+      if (encoding == encodings_.end()) {
+        this->add_columns_(detail::BuildArray(client, batch_->column(idx)));
+      } else {
+        this->add_columns_(detail::BuildArray(client, batch_->column(idx),
+                                              encoding->second));
+      }
     }
     return Status::OK();
   }
 
  private:
   std::shared_ptr<arrow::RecordBatch> batch_;
+  std::map<int, ArrayEncoding> encodings_;
 };
 
 /**
@@ -428,6 +513,34 @@ class TableBuilder : public TableBaseBuilder {
   TableBuilder(Client& client, std::shared_ptr<arrow::Table> table)
       : TableBaseBuilder(client), table_(table) {}
 
+  /**
+   * @brief Encode the column with the given encoding when sealing the table.
+   *
+   * Only integer columns are encoded (see `EncodedArray`), the encoding of
+   * other columns is ignored.
+   */
+  Status SetColumnEncoding(int const index, ArrayEncoding const encoding) {
+    if (index < 0 || index >= table_->num_columns()) {
+      return Status::Invalid("Column index out of range: " +
+                             std::to_string(index));
+    }
+    encodings_[index] = encoding;
+    return Status::OK();
+  }
+
+  /**
+   * @brief Encode the column of the given name with the given encoding when
+   * sealing the table.
+   */
+  Status SetColumnEncoding(std::string const& name,
+                           ArrayEncoding const encoding) {
+    int index = table_->schema()->GetFieldIndex(name);
+    if (index == -1) {
+      return Status::Invalid("Column not found: " + name);
+    }
+    return SetColumnEncoding(index, encoding);
+  }
+
  public:
   Status Build(Client& client) override {
     std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
@@ -436,7 +549,8 @@ class TableBuilder : public TableBaseBuilder {
     this->set_num_rows_(table_->num_rows());
     this->set_num_columns_(table_->num_columns());
     for (auto const& batch : batches) {
-      this->add_batches_(std::make_shared<RecordBatchBuilder>(client, batch));
+      this->add_batches_(
+          std::make_shared<RecordBatchBuilder>(client, batch, encodings_));
     }
     this->set_schema_(
         std::make_shared<SchemaProxyBuilder>(client, table_->schema()));
@@ -445,6 +559,7 @@ class TableBuilder : public TableBaseBuilder {
 
  private:
   std::shared_ptr<arrow::Table> table_;
+  std::map<int, ArrayEncoding> encodings_;
 };
 
 /**
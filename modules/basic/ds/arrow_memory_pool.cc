@@ -0,0 +1,340 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/arrow_memory_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+namespace detail {
+
+// the address returned for zero-size allocations
+alignas(64) static uint8_t zero_size_area[1];
+
+static std::mutex& pools_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+static std::unordered_set<VineyardMemoryPool*>& pools() {
+  static std::unordered_set<VineyardMemoryPool*> pools;
+  return pools;
+}
+
+struct SealedBlobEntry {
+  const SealedBlobScope* scope;
+  Client* client;
+  std::shared_ptr<Blob> blob;
+};
+
+static std::mutex& sealed_blobs_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// the sealed blobs of all scopes, indexed by their start address
+static std::unordered_multimap<const uint8_t*, SealedBlobEntry>&
+sealed_blobs() {
+  static std::unordered_multimap<const uint8_t*, SealedBlobEntry> blobs;
+  return blobs;
+}
+
+}  // namespace detail
+
+VineyardMemoryPool::VineyardMemoryPool(Client& client) : client_(client) {
+  std::lock_guard<std::mutex> lock(detail::pools_mutex());
+  detail::pools().emplace(this);
+}
+
+VineyardMemoryPool::~VineyardMemoryPool() {
+  {
+    std::lock_guard<std::mutex> lock(detail::pools_mutex());
+    detail::pools().erase(this);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto const& item : blobs_) {
+    release(item.second);
+  }
+  blobs_.clear();
+  adopted_.clear();
+}
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 11000000
+arrow::Status VineyardMemoryPool::Allocate(int64_t size, int64_t alignment,
+                                           uint8_t** out) {
+  ARROW_RETURN_NOT_OK(allocate(size, out));
+  if (reinterpret_cast<uintptr_t>(*out) % alignment != 0) {
+    Free(*out, size, alignment);
+    return arrow::Status::Invalid("Unsupported alignment for vineyard blobs: ",
+                                  alignment);
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status VineyardMemoryPool::Reallocate(int64_t old_size,
+                                             int64_t new_size,
+                                             int64_t alignment,
+                                             uint8_t** ptr) {
+#else
+arrow::Status VineyardMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  return allocate(size, out);
+}
+
+arrow::Status VineyardMemoryPool::Reallocate(int64_t old_size,
+                                             int64_t new_size, uint8_t** ptr) {
+#endif
+  if (*ptr != detail::zero_size_area) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = blobs_.find(*ptr);
+    if (iter != blobs_.end() &&
+        static_cast<int64_t>(iter->second->size()) >= new_size) {
+      // shrinking, or growing within the blob
+      return arrow::Status::OK();
+    }
+  }
+  uint8_t* data = nullptr;
+  ARROW_RETURN_NOT_OK(allocate(new_size, &data));
+  if (old_size > 0 && new_size > 0) {
+    memcpy(data, *ptr, std::min(old_size, new_size));
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 11000000
+  Free(*ptr, old_size, alignment);
+#else
+  Free(*ptr, old_size);
+#endif
+  *ptr = data;
+  return arrow::Status::OK();
+}
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 11000000
+void VineyardMemoryPool::Free(uint8_t* buffer, int64_t size,
+                              int64_t alignment) {
+#else
+void VineyardMemoryPool::Free(uint8_t* buffer, int64_t size) {
+#endif
+  if (buffer == detail::zero_size_area) {
+    return;
+  }
+  std::shared_ptr<BlobWriter> blob;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (adopted_.erase(buffer)) {
+      // the blob has been taken over by a vineyard object
+      return;
+    }
+    auto iter = blobs_.find(buffer);
+    if (iter == blobs_.end()) {
+      LOG(ERROR) << "Freeing a buffer that isn't allocated by this pool";
+      return;
+    }
+    blob = iter->second;
+    bytes_allocated_ -= blob->size();
+    blobs_.erase(iter);
+  }
+  release(blob);
+}
+
+int64_t VineyardMemoryPool::bytes_allocated() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_allocated_;
+}
+
+int64_t VineyardMemoryPool::max_memory() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return max_memory_;
+}
+
+int64_t VineyardMemoryPool::total_bytes_allocated() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return total_bytes_allocated_;
+}
+
+int64_t VineyardMemoryPool::num_allocations() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_allocations_;
+}
+
+std::string VineyardMemoryPool::backend_name() const { return "vineyard"; }
+
+std::shared_ptr<BlobWriter> VineyardMemoryPool::Adopt(const uint8_t* data,
+                                                      int64_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = blobs_.find(data);
+  if (iter == blobs_.end() ||
+      static_cast<int64_t>(iter->second->size()) < size) {
+    return nullptr;
+  }
+  std::shared_ptr<BlobWriter> blob = iter->second;
+  bytes_allocated_ -= blob->size();
+  blobs_.erase(iter);
+  adopted_.emplace(data);
+  return blob;
+}
+
+std::shared_ptr<BlobWriter> VineyardMemoryPool::Adopt(
+    Client& client, std::shared_ptr<arrow::Buffer> const& buffer) {
+  if (buffer == nullptr || buffer->size() == 0) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(detail::pools_mutex());
+  for (VineyardMemoryPool* pool : detail::pools()) {
+    if (&pool->client_ != &client) {
+      continue;
+    }
+    auto blob = pool->Adopt(buffer->data(), buffer->size());
+    if (blob != nullptr) {
+      return blob;
+    }
+  }
+  return nullptr;
+}
+
+arrow::Status VineyardMemoryPool::allocate(int64_t size, uint8_t** out) {
+  if (size < 0) {
+    return arrow::Status::Invalid("Negative allocation size requested: ",
+                                  size);
+  }
+  if (size == 0) {
+    *out = detail::zero_size_area;
+    return arrow::Status::OK();
+  }
+  std::unique_ptr<BlobWriter> blob;
+  auto status = client_.CreateBlob(size, blob);
+  if (!status.ok()) {
+    return arrow::Status::OutOfMemory("Failed to allocate vineyard blob of ",
+                                      size, " bytes: ", status.ToString());
+  }
+  *out = reinterpret_cast<uint8_t*>(blob->data());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  bytes_allocated_ += blob->size();
+  max_memory_ = std::max(max_memory_, bytes_allocated_);
+  total_bytes_allocated_ += blob->size();
+  num_allocations_ += 1;
+  blobs_.emplace(*out, std::shared_ptr<BlobWriter>(std::move(blob)));
+  return arrow::Status::OK();
+}
+
+void VineyardMemoryPool::release(std::shared_ptr<BlobWriter> const& blob) {
+  if (!client_.Connected()) {
+    // the unsealed blobs will be reclaimed by vineyardd on disconnection
+    return;
+  }
+  // unsealed blobs cannot be deleted, seal it first
+  auto object = blob->Seal(client_);
+  if (object != nullptr) {
+    VINEYARD_SUPPRESS(client_.DelData(object->id(), true, false));
+  }
+}
+
+SealedBlobScope::SealedBlobScope(Client& client, ObjectMeta const& meta)
+    : client_(client) {
+  collect(meta);
+  std::lock_guard<std::mutex> lock(detail::sealed_blobs_mutex());
+  for (auto const& blob : blobs_) {
+    detail::sealed_blobs().emplace(
+        reinterpret_cast<const uint8_t*>(blob->data()),
+        detail::SealedBlobEntry{this, &client_, blob});
+  }
+}
+
+SealedBlobScope::~SealedBlobScope() {
+  std::lock_guard<std::mutex> lock(detail::sealed_blobs_mutex());
+  auto& blobs = detail::sealed_blobs();
+  for (auto const& blob : blobs_) {
+    auto range =
+        blobs.equal_range(reinterpret_cast<const uint8_t*>(blob->data()));
+    for (auto iter = range.first; iter != range.second;) {
+      if (iter->second.scope == this) {
+        iter = blobs.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+}
+
+std::shared_ptr<Blob> SealedBlobScope::Find(
+    Client& client, std::shared_ptr<arrow::Buffer> const& buffer) {
+  if (buffer == nullptr || buffer->size() == 0) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(detail::sealed_blobs_mutex());
+  auto range = detail::sealed_blobs().equal_range(buffer->data());
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    auto const& entry = iter->second;
+    if (entry.client == &client &&
+        static_cast<int64_t>(entry.blob->size()) >= buffer->size()) {
+      return entry.blob;
+    }
+  }
+  return nullptr;
+}
+
+void SealedBlobScope::collect(ObjectMeta const& meta) {
+  for (auto const& kv : meta) {
+    // the members are the subtrees that have a typename
+    if (kv.second.find("typename") == kv.second.not_found()) {
+      continue;
+    }
+    ObjectMeta member = meta.GetMemberMeta(kv.first);
+    if (!member.IsLocal()) {
+      continue;
+    }
+    if (member.GetTypeName() != type_name<Blob>()) {
+      collect(member);
+      continue;
+    }
+    auto blob = std::dynamic_pointer_cast<Blob>(meta.GetMember(kv.first));
+    if (blob != nullptr && blob->size() > 0 && blob->Buffer() != nullptr) {
+      blobs_.emplace_back(blob);
+    }
+  }
+}
+
+Status BuildBlob(Client& client, std::shared_ptr<arrow::Buffer> const& buffer,
+                 std::shared_ptr<ObjectBase>& blob) {
+  auto sealed = SealedBlobScope::Find(client, buffer);
+  if (sealed != nullptr) {
+    blob = sealed;
+    return Status::OK();
+  }
+  std::shared_ptr<BlobWriter> writer;
+  RETURN_ON_ERROR(BuildBlob(client, buffer, writer));
+  blob = writer;
+  return Status::OK();
+}
+
+Status BuildBlob(Client& client, std::shared_ptr<arrow::Buffer> const& buffer,
+                 std::shared_ptr<BlobWriter>& blob) {
+  blob = VineyardMemoryPool::Adopt(client, buffer);
+  if (blob != nullptr) {
+    return Status::OK();
+  }
+  std::unique_ptr<BlobWriter> buffer_writer;
+  RETURN_ON_ERROR(client.CreateBlob(buffer->size(), buffer_writer));
+  memcpy(buffer_writer->data(), buffer->data(), buffer->size());
+  blob = std::shared_ptr<BlobWriter>(std::move(buffer_writer));
+  return Status::OK();
+}
+
+}  // namespace vineyard
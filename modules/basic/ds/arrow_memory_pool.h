@@ -0,0 +1,171 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_ARROW_MEMORY_POOL_H_
+#define MODULES_BASIC_DS_ARROW_MEMORY_POOL_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/memory_pool.h"
+#include "arrow/util/config.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+namespace vineyard {
+
+/**
+ * @brief VineyardMemoryPool is an arrow memory pool that allocates every
+ * buffer as an (unsealed) vineyard blob, with which arrow builders, kernels
+ * and readers write their results into vineyard's shared memory directly.
+ *
+ * When building vineyard arrays and tables from such arrow buffers, the
+ * array builders in "basic/ds/arrow.h" adopt the blobs behind the buffers,
+ * rather than allocating new blobs and copying the data.
+ *
+ * The pool must outlive the arrow buffers that allocated from it.
+ */
+class VineyardMemoryPool : public arrow::MemoryPool {
+ public:
+  explicit VineyardMemoryPool(Client& client);
+
+  ~VineyardMemoryPool() override;
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 11000000
+  arrow::Status Allocate(int64_t size, int64_t alignment,
+                         uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size,
+                           int64_t alignment, uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size, int64_t alignment) override;
+#else
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size,
+                           uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size) override;
+#endif
+
+  int64_t bytes_allocated() const override;
+
+  int64_t max_memory() const override;
+
+  int64_t total_bytes_allocated() const;
+
+  int64_t num_allocations() const;
+
+  std::string backend_name() const;
+
+  Client& GetClient() { return client_; }
+
+  /**
+   * @brief Take over the blob that starts at the given address and has been
+   * allocated from this pool, returns nullptr if there's no such blob, or the
+   * blob is smaller than `size`.
+   *
+   * The adopted blob will be sealed along with the object that uses it, and
+   * won't be released when arrow frees the buffer.
+   */
+  std::shared_ptr<BlobWriter> Adopt(const uint8_t* data, int64_t size);
+
+  /**
+   * @brief Take over the blob behind the arrow buffer from the
+   * VineyardMemoryPool of the given client that allocates it, returns nullptr
+   * if the buffer is not allocated by any such pool.
+   */
+  static std::shared_ptr<BlobWriter> Adopt(
+      Client& client, std::shared_ptr<arrow::Buffer> const& buffer);
+
+ private:
+  arrow::Status allocate(int64_t size, uint8_t** out);
+
+  void release(std::shared_ptr<BlobWriter> const& blob);
+
+  Client& client_;
+
+  mutable std::mutex mutex_;
+  // the allocated blobs, indexed by their start address
+  std::unordered_map<const uint8_t*, std::shared_ptr<BlobWriter>> blobs_;
+  // the start address of adopted blobs that haven't been freed by arrow yet
+  std::unordered_set<const uint8_t*> adopted_;
+  int64_t bytes_allocated_ = 0;
+  int64_t max_memory_ = 0;
+  int64_t total_bytes_allocated_ = 0;
+  int64_t num_allocations_ = 0;
+};
+
+/**
+ * @brief SealedBlobScope makes the sealed blobs of a vineyard object (and of
+ * its members, recursively) adoptable by `BuildBlob` in the lifetime of the
+ * scope, thus the arrow arrays that are read from the object without copying
+ * (e.g., `Table::GetTable()`), and the slices of them, can be rebuilt as
+ * vineyard arrays that refer to the sealed blobs as members, rather than
+ * copying the payloads to new blobs.
+ *
+ * The blobs that are not local to the client are skipped.
+ */
+class SealedBlobScope {
+ public:
+  SealedBlobScope(Client& client, ObjectMeta const& meta);
+
+  ~SealedBlobScope();
+
+  SealedBlobScope(SealedBlobScope const&) = delete;
+  SealedBlobScope& operator=(SealedBlobScope const&) = delete;
+
+  size_t size() const { return blobs_.size(); }
+
+  /**
+   * @brief The sealed blob that starts at the address of the buffer and is
+   * not smaller than the buffer, in the scopes of the given client, returns
+   * nullptr if there's no such blob.
+   */
+  static std::shared_ptr<Blob> Find(
+      Client& client, std::shared_ptr<arrow::Buffer> const& buffer);
+
+ private:
+  void collect(ObjectMeta const& meta);
+
+  Client& client_;
+  std::vector<std::shared_ptr<Blob>> blobs_;
+};
+
+/**
+ * @brief Make a blob for the arrow buffer: the blob is adopted from the
+ * VineyardMemoryPool that allocates the buffer without copying, otherwise a
+ * new blob will be created and the content of the buffer will be copied.
+ */
+Status BuildBlob(Client& client, std::shared_ptr<arrow::Buffer> const& buffer,
+                 std::shared_ptr<BlobWriter>& blob);
+
+/**
+ * @brief Make a blob for the arrow buffer as `BuildBlob` above, unless the
+ * buffer is the payload of a sealed blob in a `SealedBlobScope`, which will be
+ * referred to as it is.
+ */
+Status BuildBlob(Client& client, std::shared_ptr<arrow::Buffer> const& buffer,
+                 std::shared_ptr<ObjectBase>& blob);
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_ARROW_MEMORY_POOL_H_
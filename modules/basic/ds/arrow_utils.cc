@@ -216,6 +216,79 @@ Status DeserializeTable(std::shared_ptr<arrow::Buffer> buffer,
   return Status::OK();
 }
 
+template <typename T>
+static Status CastDictionaryIndicesImpl(
+    const std::shared_ptr<arrow::Array>& indices,
+    std::shared_ptr<arrow::Array>& out) {
+  typename ConvertToArrowType<T>::BuilderType builder;
+  RETURN_ON_ARROW_ERROR(builder.Reserve(indices->length()));
+  for (int64_t i = 0; i < indices->length(); ++i) {
+    if (indices->IsNull(i)) {
+      builder.UnsafeAppendNull();
+    } else {
+      builder.UnsafeAppend(static_cast<T>(GetDictionaryIndex(*indices, i)));
+    }
+  }
+  RETURN_ON_ARROW_ERROR(builder.Finish(&out));
+  return Status::OK();
+}
+
+Status CastDictionaryIndices(const std::shared_ptr<arrow::Array>& array,
+                             const std::shared_ptr<arrow::DataType>& type,
+                             std::shared_ptr<arrow::Array>& out) {
+  auto dict_array = std::dynamic_pointer_cast<arrow::DictionaryArray>(array);
+  auto dict_type = std::dynamic_pointer_cast<arrow::DictionaryType>(type);
+  if (dict_array == nullptr || dict_type == nullptr) {
+    return Status::Invalid("Expect dictionary arrays and types");
+  }
+  if (!dict_array->dictionary()->type()->Equals(dict_type->value_type())) {
+    return Status::Invalid("Mismatched dictionary value type: " +
+                           dict_array->dictionary()->type()->ToString());
+  }
+  auto const& indices = dict_array->indices();
+  std::shared_ptr<arrow::Array> new_indices;
+  switch (dict_type->index_type()->id()) {
+  case arrow::Type::INT8:
+    RETURN_ON_ERROR(CastDictionaryIndicesImpl<int8_t>(indices, new_indices));
+    break;
+  case arrow::Type::INT16:
+    RETURN_ON_ERROR(CastDictionaryIndicesImpl<int16_t>(indices, new_indices));
+    break;
+  case arrow::Type::INT32:
+    RETURN_ON_ERROR(CastDictionaryIndicesImpl<int32_t>(indices, new_indices));
+    break;
+  case arrow::Type::INT64:
+    RETURN_ON_ERROR(CastDictionaryIndicesImpl<int64_t>(indices, new_indices));
+    break;
+  default:
+    return Status::NotImplemented("Unsupported dictionary index type: " +
+                                  dict_type->index_type()->ToString());
+  }
+  out = std::make_shared<arrow::DictionaryArray>(type, new_indices,
+                                                 dict_array->dictionary());
+  return Status::OK();
+}
+
+Status UnifyDictionaries(const std::shared_ptr<arrow::Table>& table,
+                         std::shared_ptr<arrow::Table>& out) {
+  bool has_dictionary = false;
+  for (auto const& field : table->schema()->fields()) {
+    has_dictionary |= field->type()->id() == arrow::Type::DICTIONARY;
+  }
+  if (!has_dictionary) {
+    out = table;
+    return Status::OK();
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION < 1000000
+  return Status::NotImplemented(
+      "Unifying dictionaries requires apache-arrow 1.0.0 or later");
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      out, arrow::DictionaryUnifier::UnifyTable(*table));
+  return Status::OK();
+#endif
+}
+
 TableAppender::TableAppender(std::shared_ptr<arrow::Schema> schema) {
   for (const auto& field : schema->fields()) {
     std::shared_ptr<arrow::DataType> type = field->type();
@@ -273,4 +346,115 @@ Status TableAppender::Flush(
   return Status::OK();
 }
 
+ColumnarTableAppender::ColumnarTableAppender(
+    std::shared_ptr<arrow::Schema> schema)
+    : schema_(schema) {
+  for (const auto& field : schema->fields()) {
+    std::shared_ptr<arrow::DataType> type = field->type();
+#define REGISTER_COLUMN_APPENDER(arrow_type)                            \
+  range_funcs_.push_back(ColumnAppendHelper<arrow_type>::append_range); \
+  indices_funcs_.push_back(ColumnAppendHelper<arrow_type>::append_indices)
+    if (type == arrow::uint64()) {
+      REGISTER_COLUMN_APPENDER(arrow::UInt64Type);
+    } else if (type == arrow::int64()) {
+      REGISTER_COLUMN_APPENDER(arrow::Int64Type);
+    } else if (type == arrow::uint32()) {
+      REGISTER_COLUMN_APPENDER(arrow::UInt32Type);
+    } else if (type == arrow::int32()) {
+      REGISTER_COLUMN_APPENDER(arrow::Int32Type);
+    } else if (type == arrow::float32()) {
+      REGISTER_COLUMN_APPENDER(arrow::FloatType);
+    } else if (type == arrow::float64()) {
+      REGISTER_COLUMN_APPENDER(arrow::DoubleType);
+    } else if (type == arrow::binary()) {
+      REGISTER_COLUMN_APPENDER(arrow::BinaryType);
+    } else if (type == arrow::utf8()) {
+      REGISTER_COLUMN_APPENDER(arrow::BinaryType);
+    } else if (type == arrow::null()) {
+      REGISTER_COLUMN_APPENDER(arrow::NullType);
+    } else if (type->id() == arrow::Type::TIMESTAMP) {
+      REGISTER_COLUMN_APPENDER(arrow::TimestampType);
+    } else if (type->id() == arrow::Type::DICTIONARY &&
+               std::dynamic_pointer_cast<arrow::DictionaryType>(type)
+                   ->value_type()
+                   ->Equals(arrow::utf8())) {
+      REGISTER_COLUMN_APPENDER(arrow::DictionaryType);
+    } else {
+      LOG(FATAL) << "Datatype [" << type->ToString() << "] not implemented...";
+    }
+#undef REGISTER_COLUMN_APPENDER
+  }
+  col_num_ = range_funcs_.size();
+}
+
+Status ColumnarTableAppender::Apply(
+    std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+    std::shared_ptr<arrow::RecordBatch> const& batch, int64_t offset,
+    int64_t length,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out) {
+  if (length == 0) {
+    return Status::OK();
+  }
+  for (size_t i = 0; i < col_num_; ++i) {
+    RETURN_ON_ERROR(range_funcs_[i](builder->GetField(i), batch->column(i),
+                                    offset, length));
+  }
+  return flushIfFull(builder, batches_out);
+}
+
+Status ColumnarTableAppender::Apply(
+    std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+    std::shared_ptr<arrow::RecordBatch> const& batch,
+    std::vector<int64_t> const& indices,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out) {
+  if (indices.empty()) {
+    return Status::OK();
+  }
+  for (size_t i = 0; i < col_num_; ++i) {
+    RETURN_ON_ERROR(indices_funcs_[i](builder->GetField(i), batch->column(i),
+                                      indices.data(), indices.size()));
+  }
+  return flushIfFull(builder, batches_out);
+}
+
+Status ColumnarTableAppender::Flush(
+    std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out) {
+  // If there's no batch, we need an empty batch to make an empty table
+  if (builder->GetField(0)->length() != 0 || batches_out.size() == 0) {
+    RETURN_ON_ERROR(flush(builder, batches_out));
+  }
+  return Status::OK();
+}
+
+Status ColumnarTableAppender::flushIfFull(
+    std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out) {
+  if (builder->GetField(0)->length() >= builder->initial_capacity()) {
+    RETURN_ON_ERROR(flush(builder, batches_out));
+  }
+  return Status::OK();
+}
+
+Status ColumnarTableAppender::flush(
+    std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out) {
+  std::shared_ptr<arrow::RecordBatch> batch;
+  RETURN_ON_ARROW_ERROR(builder->Flush(&batch));
+  if (!batch->schema()->Equals(*schema_)) {
+    // the dictionary builders may narrow the index type
+    std::vector<std::shared_ptr<arrow::Array>> columns = batch->columns();
+    for (size_t i = 0; i < columns.size(); ++i) {
+      auto const& type = schema_->field(i)->type();
+      if (type->id() == arrow::Type::DICTIONARY &&
+          !columns[i]->type()->Equals(type)) {
+        RETURN_ON_ERROR(CastDictionaryIndices(columns[i], type, columns[i]));
+      }
+    }
+    batch = arrow::RecordBatch::Make(schema_, batch->num_rows(), columns);
+  }
+  batches_out.emplace_back(std::move(batch));
+  return Status::OK();
+}
+
 }  // namespace vineyard
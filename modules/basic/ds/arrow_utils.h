@@ -25,8 +25,10 @@ limitations under the License.
 #include "arrow/array/builder_binary.h"
 #include "arrow/array/builder_primitive.h"
 #include "arrow/buffer.h"
+#include "arrow/builder.h"
 #include "arrow/table.h"
 #include "arrow/table_builder.h"
+#include "arrow/type_traits.h"
 #include "arrow/util/config.h"
 #include "glog/logging.h"
 
@@ -110,6 +112,9 @@ CONVERT_TO_ARROW_TYPE(std::string, arrow::StringArray, arrow::StringBuilder,
 CONVERT_TO_ARROW_TYPE(arrow::TimestampType, arrow::TimestampArray,
                       arrow::TimestampBuilder,
                       arrow::timestamp(arrow::TimeUnit::MILLI))
+CONVERT_TO_ARROW_TYPE(arrow::DictionaryType, arrow::DictionaryArray,
+                      arrow::StringDictionaryBuilder,
+                      arrow::dictionary(arrow::int32(), arrow::utf8()))
 
 std::shared_ptr<arrow::DataType> FromAnyType(AnyType type);
 
@@ -267,6 +272,50 @@ Status SerializeTable(std::shared_ptr<arrow::Table> table,
 Status DeserializeTable(std::shared_ptr<arrow::Buffer> buffer,
                         std::shared_ptr<arrow::Table>* table);
 
+/**
+ * @brief Get the i-th index of the indices of a dictionary array.
+ */
+inline int64_t GetDictionaryIndex(const arrow::Array& indices, int64_t i) {
+  switch (indices.type_id()) {
+  case arrow::Type::INT8:
+    return static_cast<const arrow::Int8Array&>(indices).Value(i);
+  case arrow::Type::UINT8:
+    return static_cast<const arrow::UInt8Array&>(indices).Value(i);
+  case arrow::Type::INT16:
+    return static_cast<const arrow::Int16Array&>(indices).Value(i);
+  case arrow::Type::UINT16:
+    return static_cast<const arrow::UInt16Array&>(indices).Value(i);
+  case arrow::Type::INT32:
+    return static_cast<const arrow::Int32Array&>(indices).Value(i);
+  case arrow::Type::UINT32:
+    return static_cast<const arrow::UInt32Array&>(indices).Value(i);
+  case arrow::Type::INT64:
+    return static_cast<const arrow::Int64Array&>(indices).Value(i);
+  case arrow::Type::UINT64:
+    return static_cast<const arrow::UInt64Array&>(indices).Value(i);
+  default:
+    LOG(FATAL) << "Invalid dictionary index type: "
+               << indices.type()->ToString();
+    return -1;
+  }
+}
+
+/**
+ * @brief Re-encode the indices of the dictionary array to the index type of
+ * the given dictionary type, e.g., arrow's dictionary builders choose the
+ * narrowest index type that fits the dictionary.
+ */
+Status CastDictionaryIndices(const std::shared_ptr<arrow::Array>& array,
+                             const std::shared_ptr<arrow::DataType>& type,
+                             std::shared_ptr<arrow::Array>& out);
+
+/**
+ * @brief Unify the dictionaries of the chunks of every dictionary-encoded
+ * column of the table, that is required by combining the chunks.
+ */
+Status UnifyDictionaries(const std::shared_ptr<arrow::Table>& table,
+                         std::shared_ptr<arrow::Table>& out);
+
 struct EmptyTableBuilder {
   static Status Build(const std::shared_ptr<arrow::Schema>& schema,
                       std::shared_ptr<arrow::Table>& table) {
@@ -300,6 +349,18 @@ struct EmptyTableBuilder {
       } else if (type == arrow::null()) {
         arrow::NullBuilder builder;
         RETURN_ON_ARROW_ERROR(builder.Finish(&dummy));
+      } else if (type->id() == arrow::Type::DICTIONARY) {
+        auto dict_type = std::dynamic_pointer_cast<arrow::DictionaryType>(type);
+        std::unique_ptr<arrow::ArrayBuilder> builder;
+        std::shared_ptr<arrow::Array> indices, dictionary;
+        RETURN_ON_ARROW_ERROR(arrow::MakeBuilder(
+            arrow::default_memory_pool(), dict_type->index_type(), &builder));
+        RETURN_ON_ARROW_ERROR(builder->Finish(&indices));
+        RETURN_ON_ARROW_ERROR(arrow::MakeBuilder(
+            arrow::default_memory_pool(), dict_type->value_type(), &builder));
+        RETURN_ON_ARROW_ERROR(builder->Finish(&dictionary));
+        dummy = std::make_shared<arrow::DictionaryArray>(type, indices,
+                                                         dictionary);
       } else {
         return Status::NotImplemented("Unsupported type: " + type->ToString());
       }
@@ -434,6 +495,225 @@ class TableAppender {
   size_t col_num_;
 };
 
+/**
+ * @brief ColumnAppendHelper appends a range, or a selection of rows of an
+ * arrow array to the builder in bulk, without dispatching for every value.
+ *
+ * @tparam T The arrow type of the array.
+ */
+template <typename T>
+struct ColumnAppendHelper {
+  using ArrayType = typename arrow::TypeTraits<T>::ArrayType;
+  using BuilderType = typename arrow::TypeTraits<T>::BuilderType;
+
+  static Status append_range(arrow::ArrayBuilder* builder,
+                             std::shared_ptr<arrow::Array> const& array,
+                             int64_t offset, int64_t length) {
+    auto typed_builder = static_cast<BuilderType*>(builder);
+    auto typed_array = static_cast<const ArrayType*>(array.get());
+    auto values = typed_array->raw_values() + offset;
+    if (typed_array->null_count() == 0) {
+      RETURN_ON_ARROW_ERROR(typed_builder->AppendValues(values, length));
+    } else {
+      std::vector<uint8_t> valid_bytes(length);
+      for (int64_t i = 0; i < length; ++i) {
+        valid_bytes[i] = typed_array->IsValid(offset + i);
+      }
+      RETURN_ON_ARROW_ERROR(
+          typed_builder->AppendValues(values, length, valid_bytes.data()));
+    }
+    return Status::OK();
+  }
+
+  static Status append_indices(arrow::ArrayBuilder* builder,
+                               std::shared_ptr<arrow::Array> const& array,
+                               const int64_t* indices, size_t size) {
+    auto typed_builder = static_cast<BuilderType*>(builder);
+    auto typed_array = static_cast<const ArrayType*>(array.get());
+    auto values = typed_array->raw_values();
+    RETURN_ON_ARROW_ERROR(typed_builder->Reserve(size));
+    if (typed_array->null_count() == 0) {
+      for (size_t i = 0; i < size; ++i) {
+        typed_builder->UnsafeAppend(values[indices[i]]);
+      }
+    } else {
+      for (size_t i = 0; i < size; ++i) {
+        if (typed_array->IsNull(indices[i])) {
+          typed_builder->UnsafeAppendNull();
+        } else {
+          typed_builder->UnsafeAppend(values[indices[i]]);
+        }
+      }
+    }
+    return Status::OK();
+  }
+};
+
+template <>
+struct ColumnAppendHelper<arrow::BinaryType> {
+  static Status append_range(arrow::ArrayBuilder* builder,
+                             std::shared_ptr<arrow::Array> const& array,
+                             int64_t offset, int64_t length) {
+    auto typed_builder = static_cast<arrow::BinaryBuilder*>(builder);
+    auto typed_array = static_cast<const arrow::BinaryArray*>(array.get());
+    RETURN_ON_ARROW_ERROR(typed_builder->Reserve(length));
+    RETURN_ON_ARROW_ERROR(
+        typed_builder->ReserveData(typed_array->value_offset(offset + length) -
+                                   typed_array->value_offset(offset)));
+    for (int64_t i = offset; i < offset + length; ++i) {
+      append(typed_builder, typed_array, i);
+    }
+    return Status::OK();
+  }
+
+  static Status append_indices(arrow::ArrayBuilder* builder,
+                               std::shared_ptr<arrow::Array> const& array,
+                               const int64_t* indices, size_t size) {
+    auto typed_builder = static_cast<arrow::BinaryBuilder*>(builder);
+    auto typed_array = static_cast<const arrow::BinaryArray*>(array.get());
+    int64_t data_size = 0;
+    for (size_t i = 0; i < size; ++i) {
+      data_size += typed_array->value_length(indices[i]);
+    }
+    RETURN_ON_ARROW_ERROR(typed_builder->Reserve(size));
+    RETURN_ON_ARROW_ERROR(typed_builder->ReserveData(data_size));
+    for (size_t i = 0; i < size; ++i) {
+      append(typed_builder, typed_array, indices[i]);
+    }
+    return Status::OK();
+  }
+
+ private:
+  static inline void append(arrow::BinaryBuilder* builder,
+                            const arrow::BinaryArray* array, int64_t index) {
+    if (array->IsNull(index)) {
+      builder->UnsafeAppendNull();
+    } else {
+      int32_t length = 0;
+      const uint8_t* value = array->GetValue(index, &length);
+      builder->UnsafeAppend(value, length);
+    }
+  }
+};
+
+template <>
+struct ColumnAppendHelper<arrow::DictionaryType> {
+  static Status append_range(arrow::ArrayBuilder* builder,
+                             std::shared_ptr<arrow::Array> const& array,
+                             int64_t offset, int64_t length) {
+    auto typed_builder = static_cast<arrow::StringDictionaryBuilder*>(builder);
+    auto typed_array = static_cast<const arrow::DictionaryArray*>(array.get());
+    RETURN_ON_ARROW_ERROR(typed_builder->Reserve(length));
+    for (int64_t i = offset; i < offset + length; ++i) {
+      RETURN_ON_ERROR(append(typed_builder, typed_array, i));
+    }
+    return Status::OK();
+  }
+
+  static Status append_indices(arrow::ArrayBuilder* builder,
+                               std::shared_ptr<arrow::Array> const& array,
+                               const int64_t* indices, size_t size) {
+    auto typed_builder = static_cast<arrow::StringDictionaryBuilder*>(builder);
+    auto typed_array = static_cast<const arrow::DictionaryArray*>(array.get());
+    RETURN_ON_ARROW_ERROR(typed_builder->Reserve(size));
+    for (size_t i = 0; i < size; ++i) {
+      RETURN_ON_ERROR(append(typed_builder, typed_array, indices[i]));
+    }
+    return Status::OK();
+  }
+
+ private:
+  // the values are re-encoded by the memo table of the dictionary builder,
+  // then the column keeps dictionary-encoded.
+  static inline Status append(arrow::StringDictionaryBuilder* builder,
+                              const arrow::DictionaryArray* array,
+                              int64_t index) {
+    if (array->IsNull(index)) {
+      RETURN_ON_ARROW_ERROR(builder->AppendNull());
+    } else {
+      auto dictionary =
+          static_cast<const arrow::BinaryArray*>(array->dictionary().get());
+      RETURN_ON_ARROW_ERROR(builder->Append(dictionary->GetView(
+          GetDictionaryIndex(*array->indices(), index))));
+    }
+    return Status::OK();
+  }
+};
+
+template <>
+struct ColumnAppendHelper<arrow::NullType> {
+  static Status append_range(arrow::ArrayBuilder* builder,
+                             std::shared_ptr<arrow::Array> const& array,
+                             int64_t offset, int64_t length) {
+    RETURN_ON_ARROW_ERROR(
+        static_cast<arrow::NullBuilder*>(builder)->AppendNulls(length));
+    return Status::OK();
+  }
+
+  static Status append_indices(arrow::ArrayBuilder* builder,
+                               std::shared_ptr<arrow::Array> const& array,
+                               const int64_t* indices, size_t size) {
+    RETURN_ON_ARROW_ERROR(
+        static_cast<arrow::NullBuilder*>(builder)->AppendNulls(size));
+    return Status::OK();
+  }
+};
+
+typedef Status (*column_range_appender_func)(
+    arrow::ArrayBuilder*, std::shared_ptr<arrow::Array> const&, int64_t,
+    int64_t);
+
+typedef Status (*column_indices_appender_func)(
+    arrow::ArrayBuilder*, std::shared_ptr<arrow::Array> const&,
+    const int64_t*, size_t);
+
+/**
+ * @brief ColumnarTableAppender appends rows of record batches column by
+ * column: a contiguous range of rows, or a selection of rows, is appended to
+ * each column in bulk, rather than being appended cell by cell as in
+ * TableAppender.
+ *
+ */
+class ColumnarTableAppender {
+ public:
+  explicit ColumnarTableAppender(std::shared_ptr<arrow::Schema> schema);
+
+  /**
+   * @brief Append the rows [offset, offset + length) of the batch, the
+   * builder will be flushed to `batches_out` once it reaches its initial
+   * capacity.
+   */
+  Status Apply(std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+               std::shared_ptr<arrow::RecordBatch> const& batch,
+               int64_t offset, int64_t length,
+               std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out);
+
+  /**
+   * @brief Append the rows of the batch at the given indices, in the order of
+   * the indices.
+   */
+  Status Apply(std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+               std::shared_ptr<arrow::RecordBatch> const& batch,
+               std::vector<int64_t> const& indices,
+               std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out);
+
+  Status Flush(std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+               std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out);
+
+ private:
+  Status flushIfFull(
+      std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+      std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out);
+
+  Status flush(std::unique_ptr<arrow::RecordBatchBuilder>& builder,
+               std::vector<std::shared_ptr<arrow::RecordBatch>>& batches_out);
+
+  std::shared_ptr<arrow::Schema> schema_;
+  std::vector<column_range_appender_func> range_funcs_;
+  std::vector<column_indices_appender_func> indices_funcs_;
+  size_t col_num_;
+};
+
 }  // namespace vineyard
 
 #endif  // MODULES_BASIC_DS_ARROW_UTILS_H_
@@ -0,0 +1,121 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_BLOOM_FILTER_H_
+#define MODULES_BASIC_DS_BLOOM_FILTER_H_
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "basic/ds/array.h"
+#include "basic/ds/bloom_filter.vineyard.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief BloomFilterBuilder is used for constructing blocked bloom filters
+ * that supported by vineyard.
+ *
+ * The blocks are allocated in the blob at the construction of the builder, and
+ * the keys are inserted into the blob directly.
+ *
+ * @tparam K The type for the key.
+ * @tparam std::hash<K> The hash function for the key.
+ */
+template <typename K, typename H = std::hash<K>>
+class BloomFilterBuilder : public BloomFilterBaseBuilder<K, H> {
+ public:
+  /**
+   * @brief Initialize the builder for about `expected_size` keys, with
+   * `bits_per_key` bits for each key. The default 10 bits per key gives a
+   * false positive rate of about 1% when the expected size is reached.
+   *
+   */
+  BloomFilterBuilder(Client& client, size_t expected_size,
+                     size_t bits_per_key = 10)
+      : BloomFilterBaseBuilder<K, H>(client) {
+    size_t const bits = expected_size * bits_per_key;
+    block_num_ = std::max(static_cast<size_t>(1),
+                          (bits + bloom_block::kBits - 1) / bloom_block::kBits);
+    blocks_builder_ = std::make_shared<ArrayBuilder<uint32_t>>(
+        client, block_num_ * bloom_block::kWords);
+    memset(blocks_builder_->data(), 0,
+           blocks_builder_->size() * sizeof(uint32_t));
+  }
+
+  /**
+   * @brief Insert the key into the bloom filter.
+   *
+   */
+  void insert(const K& key) { insert_hash(H()(key)); }
+
+  /**
+   * @brief Insert the key of the given hash (by `H`) into the bloom filter.
+   *
+   */
+  void insert_hash(size_t const hash) {
+    uint64_t const mixed = bloom_block::mix(hash);
+    bloom_block::insert(
+        blocks_builder_->data() +
+            bloom_block::index(mixed, block_num_) * bloom_block::kWords,
+        mixed);
+    element_num_ += 1;
+  }
+
+  /**
+   * @brief Check whether the key may have been inserted.
+   *
+   */
+  bool contains(const K& key) const {
+    uint64_t const mixed = bloom_block::mix(H()(key));
+    return bloom_block::contains(
+        blocks_builder_->data() +
+            bloom_block::index(mixed, block_num_) * bloom_block::kWords,
+        mixed);
+  }
+
+  /**
+   * @brief Get the number of keys that have been inserted.
+   *
+   */
+  size_t size() const { return element_num_; }
+
+  /**
+   * @brief Build the bloom filter object.
+   *
+   */
+  Status Build(Client& client) override {
+    this->set_num_blocks_(block_num_);
+    this->set_num_elements_(element_num_);
+    this->set_blocks_(std::static_pointer_cast<ObjectBase>(blocks_builder_));
+    return Status::OK();
+  }
+
+ private:
+  size_t block_num_;
+  size_t element_num_ = 0;
+  std::shared_ptr<ArrayBuilder<uint32_t>> blocks_builder_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_BLOOM_FILTER_H_
@@ -0,0 +1,311 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/chunked_table.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/arrow_utils.h"
+
+namespace vineyard {
+
+constexpr int64_t ChunkedTableWriter::kDefaultChunkRows;
+
+namespace {
+
+std::string versionName(std::string const& name, size_t const version) {
+  return name + "/" + std::to_string(version);
+}
+
+/**
+ * A table of the sealed chunks, which are shared rather than rebuilt.
+ */
+class ChunksTableBuilder : public TableBaseBuilder {
+ public:
+  ChunksTableBuilder(Client& client,
+                     std::shared_ptr<arrow::Schema> const& schema,
+                     std::vector<std::shared_ptr<RecordBatch>> const& chunks)
+      : TableBaseBuilder(client), schema_(schema), chunks_(chunks) {}
+
+  Status Build(Client& client) override {
+    size_t num_rows = 0;
+    for (auto const& chunk : chunks_) {
+      num_rows += chunk->num_rows();
+      this->add_batches_(chunk);
+    }
+    this->set_batch_num_(chunks_.size());
+    this->set_num_rows_(num_rows);
+    this->set_num_columns_(schema_->num_fields());
+    this->set_schema_(std::make_shared<SchemaProxyBuilder>(client, schema_));
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<arrow::Schema> schema_;
+  std::vector<std::shared_ptr<RecordBatch>> chunks_;
+};
+
+}  // namespace
+
+ChunkedTableWriter::ChunkedTableWriter(
+    Client& client, std::string const& name,
+    std::shared_ptr<arrow::Schema> const& schema, int64_t const chunk_rows)
+    : client_(client),
+      name_(name),
+      schema_(schema),
+      chunk_rows_(std::max<int64_t>(1, chunk_rows)) {
+  compactor_ = std::thread([this]() { compactLoop(); });
+}
+
+ChunkedTableWriter::~ChunkedTableWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  compaction_cv_.notify_all();
+  if (compactor_.joinable()) {
+    compactor_.join();
+  }
+}
+
+Status ChunkedTableWriter::Append(
+    std::shared_ptr<arrow::RecordBatch> const& batch) {
+  if (finished_) {
+    return Status::Invalid("The chunked table has been finished");
+  }
+  if (!batch->schema()->Equals(*schema_)) {
+    return Status::Invalid("The schema of the appended rows doesn't match: " +
+                           batch->schema()->ToString());
+  }
+  if (batch->num_rows() == 0) {
+    return Status::OK();
+  }
+  pending_.emplace_back(batch);
+  pending_rows_ += batch->num_rows();
+  if (pending_rows_ < chunk_rows_) {
+    return Status::OK();
+  }
+
+  std::shared_ptr<arrow::RecordBatch> combined;
+  RETURN_ON_ERROR(CombineRecordBatches(pending_, &combined));
+  pending_.clear();
+  int64_t offset = 0;
+  while (combined->num_rows() - offset >= chunk_rows_) {
+    RETURN_ON_ERROR(sealChunk(combined->Slice(offset, chunk_rows_)));
+    offset += chunk_rows_;
+  }
+  pending_rows_ = combined->num_rows() - offset;
+  if (pending_rows_ > 0) {
+    pending_.emplace_back(combined->Slice(offset));
+  }
+  return Status::OK();
+}
+
+Status ChunkedTableWriter::Flush() {
+  if (pending_rows_ == 0) {
+    return Status::OK();
+  }
+  std::shared_ptr<arrow::RecordBatch> combined;
+  RETURN_ON_ERROR(CombineRecordBatches(pending_, &combined));
+  pending_.clear();
+  pending_rows_ = 0;
+  return sealChunk(combined);
+}
+
+Status ChunkedTableWriter::Finish(ObjectID& table_id) {
+  if (finished_) {
+    return Status::Invalid("The chunked table has been finished");
+  }
+  RETURN_ON_ERROR(Flush());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  compaction_cv_.notify_all();
+  if (compactor_.joinable()) {
+    compactor_.join();
+  }
+  RETURN_ON_ERROR(compaction_status_);
+
+  // merge the small chunks that are left by the background thread
+  while (true) {
+    size_t begin = 0;
+    std::vector<std::shared_ptr<RecordBatch>> run;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!nextCompaction(begin, run)) {
+        break;
+      }
+    }
+    RETURN_ON_ERROR(compact(begin, run));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  RETURN_ON_ERROR(publish(true, table_id));
+  finished_ = true;
+  return Status::OK();
+}
+
+size_t ChunkedTableWriter::version() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return version_;
+}
+
+Status ChunkedTableWriter::sealChunk(
+    std::shared_ptr<arrow::RecordBatch> const& batch) {
+  RecordBatchBuilder builder(client_, batch);
+  auto chunk = std::dynamic_pointer_cast<RecordBatch>(builder.Seal(client_));
+  if (chunk == nullptr) {
+    return Status::Invalid("Failed to seal the chunk");
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  chunks_.emplace_back(chunk);
+  ObjectID table_id = InvalidObjectID();
+  RETURN_ON_ERROR(publish(false, table_id));
+  if (batch->num_rows() < chunk_rows_) {
+    compaction_cv_.notify_one();
+  }
+  return Status::OK();
+}
+
+Status ChunkedTableWriter::publish(bool const final, ObjectID& table_id) {
+  ChunksTableBuilder builder(client_, schema_, chunks_);
+  auto table = builder.Seal(client_);
+  if (table == nullptr) {
+    return Status::Invalid("Failed to seal the version of the chunked table");
+  }
+  table_id = table->id();
+  // the final table is put before its version, thus the readers know the
+  // table has been finished once they have read the version
+  if (final) {
+    RETURN_ON_ERROR(client_.PutName(table_id, name_));
+  }
+  RETURN_ON_ERROR(client_.PutName(table_id, versionName(name_, version_ + 1)));
+  version_ += 1;
+  return Status::OK();
+}
+
+bool ChunkedTableWriter::nextCompaction(
+    size_t& begin, std::vector<std::shared_ptr<RecordBatch>>& run) const {
+  // a chunk is small if it is less than half full
+  auto small = [this](std::shared_ptr<RecordBatch> const& chunk) {
+    return static_cast<int64_t>(chunk->num_rows()) * 2 < chunk_rows_;
+  };
+  size_t index = 0;
+  while (index < chunks_.size()) {
+    if (!small(chunks_[index])) {
+      index += 1;
+      continue;
+    }
+    size_t end = index;
+    int64_t rows = 0;
+    while (end < chunks_.size() && small(chunks_[end]) &&
+           rows + static_cast<int64_t>(chunks_[end]->num_rows()) <=
+               chunk_rows_) {
+      rows += chunks_[end]->num_rows();
+      end += 1;
+    }
+    if (end - index >= 2) {
+      begin = index;
+      run.assign(chunks_.begin() + index, chunks_.begin() + end);
+      return true;
+    }
+    index = std::max(end, index + 1);
+  }
+  return false;
+}
+
+Status ChunkedTableWriter::compact(
+    size_t const begin, std::vector<std::shared_ptr<RecordBatch>> const& run) {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (auto const& chunk : run) {
+    batches.emplace_back(chunk->GetRecordBatch());
+  }
+  std::shared_ptr<arrow::RecordBatch> merged;
+  RETURN_ON_ERROR(CombineRecordBatches(batches, &merged));
+  RecordBatchBuilder builder(client_, merged);
+  auto chunk = std::dynamic_pointer_cast<RecordBatch>(builder.Seal(client_));
+  if (chunk == nullptr) {
+    return Status::Invalid("Failed to seal the merged chunk");
+  }
+
+  // the chunks are only appended meanwhile, thus the run stays in place
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto first = chunks_.begin() + begin;
+  RETURN_ON_ASSERT(std::equal(run.begin(), run.end(), first));
+  first = chunks_.erase(first, first + run.size());
+  chunks_.insert(first, chunk);
+  ObjectID table_id = InvalidObjectID();
+  return publish(false, table_id);
+}
+
+void ChunkedTableWriter::compactLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    size_t begin = 0;
+    std::vector<std::shared_ptr<RecordBatch>> run;
+    compaction_cv_.wait(lock, [&]() {
+      return stopped_ || nextCompaction(begin, run);
+    });
+    if (stopped_) {
+      return;
+    }
+    lock.unlock();
+    auto status = compact(begin, run);
+    lock.lock();
+    if (!status.ok()) {
+      compaction_status_ = status;
+      return;
+    }
+  }
+}
+
+Status ChunkedTableReader::ReadBatch(
+    std::shared_ptr<arrow::RecordBatch>& batch) {
+  while (true) {
+    if (table_ != nullptr &&
+        rows_read_ < static_cast<int64_t>(table_->num_rows())) {
+      // the chunks may have been merged, thus locate the rows by offsets
+      int64_t offset = 0;
+      for (auto const& chunk : table_->batches()) {
+        int64_t rows = chunk->num_rows();
+        if (rows_read_ < offset + rows) {
+          batch = chunk->GetRecordBatch()->Slice(rows_read_ - offset);
+          rows_read_ = offset + rows;
+          return Status::OK();
+        }
+        offset += rows;
+      }
+    }
+    if (table_ != nullptr) {
+      ObjectID final_id = InvalidObjectID();
+      if (client_.GetName(name_, final_id, false).ok() &&
+          final_id == table_->id()) {
+        return Status::StreamDrained();
+      }
+    }
+    ObjectID version_id = InvalidObjectID();
+    RETURN_ON_ERROR(
+        client_.GetName(versionName(name_, version_ + 1), version_id, true));
+    RETURN_ON_ERROR(client_.GetObject(version_id, table_));
+    version_ += 1;
+  }
+}
+
+}  // namespace vineyard
@@ -0,0 +1,157 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_CHUNKED_TABLE_H_
+#define MODULES_BASIC_DS_CHUNKED_TABLE_H_
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/api.h"
+
+#include "basic/ds/arrow.h"
+#include "client/client.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief ChunkedTableWriter builds a table from the rows that are appended
+ * continuously, without buffering the whole table in the process.
+ *
+ * The rows are sealed as record batches of `chunk_rows` rows once enough
+ * rows have been appended (or when flushed), and every change of the sealed
+ * chunks is published as a new version of the table: the k-th version is a
+ * `vineyard::Table` of all chunks that have been sealed so far, put under the
+ * name `<name>/<k>` (starting from 1). The versions share the chunks, thus
+ * publishing a version costs only metadata.
+ *
+ * The small chunks, which are sealed by `Flush()`, are merged into chunks of
+ * up to `chunk_rows` rows in a background thread, thus the later versions
+ * (and the final table) aren't fragmented by frequent flushes. The order of
+ * the rows is kept by the merging.
+ *
+ * The final table is put under `<name>` (and as the last version) by
+ * `Finish()`. The intermediate versions are kept for the readers that lag
+ * behind, and are left to the owner of the name to delete.
+ */
+class ChunkedTableWriter {
+ public:
+  static constexpr int64_t kDefaultChunkRows = 64 * 1024;
+
+  ChunkedTableWriter(Client& client, std::string const& name,
+                     std::shared_ptr<arrow::Schema> const& schema,
+                     int64_t const chunk_rows = kDefaultChunkRows);
+
+  ~ChunkedTableWriter();
+
+  /**
+   * @brief Append the rows, which are sealed once a chunk is full.
+   */
+  Status Append(std::shared_ptr<arrow::RecordBatch> const& batch);
+
+  /**
+   * @brief Seal the rows that have been appended, even if they don't fill a
+   * chunk, thus the readers can see them.
+   */
+  Status Flush();
+
+  /**
+   * @brief Flush, merge the small chunks, and publish the final table.
+   *
+   * @param table_id The final table.
+   */
+  Status Finish(ObjectID& table_id);
+
+  /**
+   * @brief The number of versions that have been published.
+   */
+  size_t version() const;
+
+ private:
+  Status sealChunk(std::shared_ptr<arrow::RecordBatch> const& batch);
+
+  // seal and put the table of the current chunks, with the mutex held
+  Status publish(bool const final, ObjectID& table_id);
+
+  // find a run of small chunks to merge, with the mutex held
+  bool nextCompaction(size_t& begin,
+                      std::vector<std::shared_ptr<RecordBatch>>& run) const;
+
+  // merge the run of chunks that starts at begin
+  Status compact(size_t const begin,
+                 std::vector<std::shared_ptr<RecordBatch>> const& run);
+
+  void compactLoop();
+
+  Client& client_;
+  std::string name_;
+  std::shared_ptr<arrow::Schema> schema_;
+  int64_t chunk_rows_;
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> pending_;
+  int64_t pending_rows_ = 0;
+
+  mutable std::mutex mutex_;
+  std::condition_variable compaction_cv_;
+  std::vector<std::shared_ptr<RecordBatch>> chunks_;
+  size_t version_ = 0;
+  bool finished_ = false;
+  bool stopped_ = false;
+  Status compaction_status_;
+  std::thread compactor_;
+};
+
+/**
+ * @brief ChunkedTableReader reads the rows of a table that is being written
+ * by a `ChunkedTableWriter` incrementally, as the versions are published.
+ */
+class ChunkedTableReader {
+ public:
+  ChunkedTableReader(Client& client, std::string const& name)
+      : client_(client), name_(name) {}
+
+  /**
+   * @brief Read the rows that haven't been read, waits for the writer to
+   * publish more rows if all published rows have been read.
+   *
+   * The batch is a zero-copy slice of the chunks.
+   *
+   * @return `Status::StreamDrained()` after all rows of the final table
+   * have been read.
+   */
+  Status ReadBatch(std::shared_ptr<arrow::RecordBatch>& batch);
+
+  /**
+   * @brief The number of rows that have been read.
+   */
+  int64_t rows_read() const { return rows_read_; }
+
+ private:
+  Client& client_;
+  std::string name_;
+  size_t version_ = 0;
+  int64_t rows_read_ = 0;
+  std::shared_ptr<Table> table_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_CHUNKED_TABLE_H_
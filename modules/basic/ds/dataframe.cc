@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "basic/ds/dataframe.h"
 
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace vineyard {
 
 class DataFrameBuilder;
@@ -40,6 +45,53 @@ const std::pair<size_t, size_t> DataFrame::shape() const {
   }
 }
 
+Status DataFrame::Project(Client& client, ObjectID const id,
+                          std::vector<std::string> const& columns,
+                          std::shared_ptr<DataFrame>& dataframe) {
+  std::shared_ptr<Object> object;
+  RETURN_ON_ERROR(
+      client.GetProjectedObject(id, DataFrame::Projection(columns), object));
+  dataframe = std::dynamic_pointer_cast<DataFrame>(object);
+  return Status::OK();
+}
+
+meta_projection_t DataFrame::Projection(
+    std::vector<std::string> const& columns) {
+  return [columns](ptree& tree) -> Status {
+    auto const type = tree.get<std::string>("typename", "");
+    if (type != type_name<DataFrame>()) {
+      return Status::Invalid("The object is not a dataframe: " + type);
+    }
+    size_t const size = tree.get<size_t>("__values_-size");
+    std::map<std::string, size_t> indices;
+    for (size_t idx = 0; idx < size; ++idx) {
+      indices.emplace(
+          tree.get<std::string>("__values_-key-" + std::to_string(idx)), idx);
+    }
+    std::vector<ptree> values;
+    for (auto const& column : columns) {
+      auto index = indices.find(column);
+      if (index == indices.end()) {
+        return Status::Invalid("Column '" + column +
+                               "' doesn't exist in the dataframe");
+      }
+      values.emplace_back(tree.get_child("__values_-value-" +
+                                         std::to_string(index->second)));
+    }
+    for (size_t idx = 0; idx < size; ++idx) {
+      tree.erase("__values_-key-" + std::to_string(idx));
+      tree.erase("__values_-value-" + std::to_string(idx));
+    }
+    for (size_t idx = 0; idx < columns.size(); ++idx) {
+      tree.put("__values_-key-" + std::to_string(idx), columns[idx]);
+      tree.add_child("__values_-value-" + std::to_string(idx), values[idx]);
+    }
+    tree.put("__values_-size", columns.size());
+    put_container(tree, "columns_", columns);
+    return Status::OK();
+  };
+}
+
 const std::pair<size_t, size_t> DataFrameBuilder::partition_index() const {
   return std::make_pair(this->partition_index_row_,
                         this->partition_index_column_);
@@ -0,0 +1,214 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_ENCODED_ARRAY_H_
+#define MODULES_BASIC_DS_ENCODED_ARRAY_H_
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/array.h"
+#include "basic/ds/arrow_memory_pool.h"
+#include "basic/ds/encoded_array.vineyard.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief EncodedArrayBuilder is designed for building encoded integer arrays
+ * from arrow arrays.
+ *
+ * The values are split into blocks of `block_codec::kBlockSize` values, and
+ * every block is encoded with the given encoding, or the smallest encoding
+ * for the block when the encoding is `ArrayEncoding::kAuto`.
+ *
+ * @tparam T The integer type of values.
+ */
+template <typename T>
+class EncodedArrayBuilder : public EncodedArrayBaseBuilder<T> {
+ public:
+  using ArrayType = typename ConvertToArrowType<T>::ArrayType;
+  using block_t = encoded_block_t;
+
+  EncodedArrayBuilder(Client& client, std::shared_ptr<ArrayType> array,
+                      ArrayEncoding encoding = ArrayEncoding::kAuto)
+      : EncodedArrayBaseBuilder<T>(client),
+        array_(array),
+        encoding_(encoding) {}
+
+  std::shared_ptr<ArrayType> GetArray() { return array_; }
+
+  Status Build(Client& client) override {
+    // the values before the offset are encoded as well, to share the null
+    // bitmap with the source array.
+    size_t const total = array_->offset() + array_->length();
+    const T* values = array_->raw_values() - array_->offset();
+
+    std::vector<block_t> blocks;
+    std::vector<uint8_t> payload;
+    for (size_t begin = 0; begin < total; begin += block_codec::kBlockSize) {
+      size_t const length =
+          std::min<size_t>(block_codec::kBlockSize, total - begin);
+      blocks.emplace_back(encodeBlock(values + begin, length, payload));
+    }
+    payload.resize(payload.size() + block_codec::kPadding, 0);
+
+    std::unique_ptr<BlobWriter> payload_writer;
+    RETURN_ON_ERROR(client.CreateBlob(payload.size(), payload_writer));
+    memcpy(payload_writer->data(), payload.data(), payload.size());
+
+    this->set_length_(array_->length());
+    this->set_null_count_(array_->null_count());
+    this->set_offset_(array_->offset());
+    this->set_blocks_(std::make_shared<ArrayBuilder<block_t>>(client, blocks));
+    this->set_payload_(std::shared_ptr<BlobWriter>(std::move(payload_writer)));
+    if (array_->null_bitmap() && array_->null_count() > 0) {
+      std::shared_ptr<BlobWriter> bitmap_writer;
+      RETURN_ON_ERROR(BuildBlob(client, array_->null_bitmap(), bitmap_writer));
+      this->set_null_bitmap_(bitmap_writer);
+    } else {
+      this->set_null_bitmap_(Blob::MakeEmpty(client));
+    }
+    return Status::OK();
+  }
+
+ private:
+  block_t encodeBlock(const T* values, size_t const length,
+                      std::vector<uint8_t>& payload) {
+    block_t block;
+    memset(&block, 0, sizeof(block_t));
+    block.length = static_cast<uint32_t>(length);
+
+    words_.resize(length);
+    size_t runs = 1;
+    T min = values[0], max = values[0];
+    for (size_t i = 0; i < length; ++i) {
+      words_[i] = static_cast<uint64_t>(values[i]);
+      min = std::min(min, values[i]);
+      max = std::max(max, values[i]);
+      if (i > 0 && values[i] != values[i - 1]) {
+        ++runs;
+      }
+    }
+    uint64_t const min_value = static_cast<uint64_t>(min);
+    uint32_t const for_width = block_codec::bit_width(
+        static_cast<uint64_t>(max) - static_cast<uint64_t>(min));
+
+    // the deltas are compared as signed integers
+    deltas_.resize(length > 0 ? length - 1 : 0);
+    int64_t min_delta = std::numeric_limits<int64_t>::max();
+    for (size_t i = 1; i < length; ++i) {
+      deltas_[i - 1] = words_[i] - words_[i - 1];
+      min_delta = std::min(min_delta, static_cast<int64_t>(deltas_[i - 1]));
+    }
+    uint64_t max_offset = 0;
+    for (auto& delta : deltas_) {
+      delta -= static_cast<uint64_t>(min_delta);
+      max_offset = std::max(max_offset, delta);
+    }
+    uint32_t const delta_width = block_codec::bit_width(max_offset);
+
+    size_t const rle_size =
+        (runs * sizeof(uint16_t) + 7) / 8 * 8 + runs * sizeof(uint64_t);
+    size_t const for_size = block_codec::packed_size(length, for_width);
+    size_t const delta_size =
+        block_codec::packed_size(deltas_.size(), delta_width);
+    size_t const plain_size = length * sizeof(T);
+
+    ArrayEncoding encoding = encoding_;
+    if (encoding == ArrayEncoding::kAuto) {
+      // prefers the encodings with faster random access on ties
+      encoding = ArrayEncoding::kPlain;
+      size_t best = plain_size;
+      if (for_size < best) {
+        encoding = ArrayEncoding::kFOR;
+        best = for_size;
+      }
+      if (rle_size < best) {
+        encoding = ArrayEncoding::kRLE;
+        best = rle_size;
+      }
+      if (delta_size < best) {
+        encoding = ArrayEncoding::kDelta;
+        best = delta_size;
+      }
+    }
+
+    // the payload of every block is aligned to 8 bytes
+    payload.resize((payload.size() + 7) / 8 * 8, 0);
+    block.offset = payload.size();
+    block.encoding = static_cast<uint8_t>(encoding);
+    switch (encoding) {
+    case ArrayEncoding::kRLE: {
+      block.delta = runs;
+      payload.resize(payload.size() + rle_size, 0);
+      uint16_t* ends = reinterpret_cast<uint16_t*>(payload.data() +
+                                                   block.offset);
+      uint8_t* run_values = payload.data() + block.offset +
+                            (runs * sizeof(uint16_t) + 7) / 8 * 8;
+      size_t run = 0;
+      for (size_t i = 1; i <= length; ++i) {
+        if (i == length || values[i] != values[i - 1]) {
+          ends[run] = static_cast<uint16_t>(i);
+          memcpy(run_values + run * sizeof(uint64_t), &words_[i - 1],
+                 sizeof(uint64_t));
+          ++run;
+        }
+      }
+      break;
+    }
+    case ArrayEncoding::kFOR: {
+      block.base = min_value;
+      block.bit_width = static_cast<uint8_t>(for_width);
+      for (auto& word : words_) {
+        word -= min_value;
+      }
+      block_codec::pack(words_.data(), length, for_width, payload);
+      break;
+    }
+    case ArrayEncoding::kDelta: {
+      block.base = words_[0];
+      block.delta = static_cast<uint64_t>(min_delta);
+      block.bit_width = static_cast<uint8_t>(delta_width);
+      block_codec::pack(deltas_.data(), deltas_.size(), delta_width, payload);
+      break;
+    }
+    default: {
+      block.encoding = static_cast<uint8_t>(ArrayEncoding::kPlain);
+      size_t const begin = payload.size();
+      payload.resize(begin + plain_size);
+      memcpy(payload.data() + begin, values, plain_size);
+    }
+    }
+    return block;
+  }
+
+  std::shared_ptr<ArrayType> array_;
+  ArrayEncoding encoding_;
+
+  std::vector<uint64_t> words_, deltas_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_ENCODED_ARRAY_H_
@@ -0,0 +1,245 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/exchange.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/c/bridge.h"
+
+namespace vineyard {
+
+namespace {
+
+/**
+ * The arrow buffer that holds a reference of the vineyard object, the
+ * payloads of which are wrapped by the arrow buffer in vineyard.
+ */
+class ObjectOwnedBuffer : public arrow::Buffer {
+ public:
+  ObjectOwnedBuffer(std::shared_ptr<arrow::Buffer> const& buffer,
+                    std::shared_ptr<Object> const& owner)
+      : arrow::Buffer(buffer->data(), buffer->size()),
+        buffer_(buffer),
+        owner_(owner) {}
+
+ private:
+  std::shared_ptr<arrow::Buffer> buffer_;
+  std::shared_ptr<Object> owner_;
+};
+
+std::shared_ptr<arrow::ArrayData> retainArrayData(
+    std::shared_ptr<arrow::ArrayData> const& data,
+    std::shared_ptr<Object> const& owner) {
+  if (data == nullptr) {
+    return nullptr;
+  }
+  auto retained = std::make_shared<arrow::ArrayData>(*data);
+  for (auto& buffer : retained->buffers) {
+    if (buffer != nullptr) {
+      buffer = std::make_shared<ObjectOwnedBuffer>(buffer, owner);
+    }
+  }
+  for (auto& child : retained->child_data) {
+    child = retainArrayData(child, owner);
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 1000000
+  retained->dictionary = retainArrayData(retained->dictionary, owner);
+#endif
+  return retained;
+}
+
+Status resolveArray(std::shared_ptr<Object> const& object,
+                    std::shared_ptr<arrow::Array>& array) {
+  if (auto arr = std::dynamic_pointer_cast<PrimitiveArray>(object)) {
+    array = arr->ToArray();
+  } else if (auto arr = std::dynamic_pointer_cast<BooleanArray>(object)) {
+    array = arr->GetArray();
+  } else if (auto arr =
+                 std::dynamic_pointer_cast<FixedSizeBinaryArray>(object)) {
+    array = arr->GetArray();
+  } else if (auto arr = std::dynamic_pointer_cast<StringArray>(object)) {
+    array = arr->GetArray();
+  } else if (auto arr = std::dynamic_pointer_cast<NullArray>(object)) {
+    array = arr->GetArray();
+  } else if (auto arr = std::dynamic_pointer_cast<DictionaryArray>(object)) {
+    array = arr->GetArray();
+  } else {
+    return Status::Invalid("Cannot export '" + object->meta().GetTypeName() +
+                           "' as an arrow array");
+  }
+  array = arrow::MakeArray(retainArrayData(array->data(), object));
+  return Status::OK();
+}
+
+std::shared_ptr<arrow::RecordBatch> retainRecordBatch(
+    std::shared_ptr<arrow::RecordBatch> const& batch,
+    std::shared_ptr<Object> const& owner) {
+  std::vector<std::shared_ptr<arrow::ArrayData>> columns;
+  for (int index = 0; index < batch->num_columns(); ++index) {
+    columns.emplace_back(retainArrayData(batch->column_data(index), owner));
+  }
+  return arrow::RecordBatch::Make(batch->schema(), batch->num_rows(),
+                                  std::move(columns));
+}
+
+Status resolveSchema(std::shared_ptr<Object> const& object,
+                     std::shared_ptr<arrow::Schema>& schema) {
+  if (auto batch = std::dynamic_pointer_cast<RecordBatch>(object)) {
+    schema = batch->schema();
+  } else if (auto table = std::dynamic_pointer_cast<Table>(object)) {
+    schema = table->schema();
+  } else {
+    return Status::Invalid("Cannot export the schema of '" +
+                           object->meta().GetTypeName() + "'");
+  }
+  return Status::OK();
+}
+
+Status resolveDLDataType(AnyType const type, DLDataType& dtype) {
+  dtype.lanes = 1;
+  switch (type) {
+  case AnyType::Int32:
+    dtype.code = kDLInt;
+    dtype.bits = 32;
+    return Status::OK();
+  case AnyType::UInt32:
+    dtype.code = kDLUInt;
+    dtype.bits = 32;
+    return Status::OK();
+  case AnyType::Int64:
+    dtype.code = kDLInt;
+    dtype.bits = 64;
+    return Status::OK();
+  case AnyType::UInt64:
+    dtype.code = kDLUInt;
+    dtype.bits = 64;
+    return Status::OK();
+  case AnyType::Float:
+    dtype.code = kDLFloat;
+    dtype.bits = 32;
+    return Status::OK();
+  case AnyType::Double:
+    dtype.code = kDLFloat;
+    dtype.bits = 64;
+    return Status::OK();
+  default:
+    return Status::Invalid("Cannot export tensors of type " +
+                           std::to_string(static_cast<int>(type)) +
+                           " as DLPack tensors");
+  }
+}
+
+/**
+ * The context of exported DLPack tensors, which holds the shape and strides,
+ * and keeps the vineyard object alive.
+ */
+struct DLPackContext {
+  std::shared_ptr<ITensor> tensor;
+  std::vector<int64_t> shape;
+  std::vector<int64_t> strides;
+  DLManagedTensor managed;
+};
+
+void deleteDLPackContext(DLManagedTensor* self) {
+  delete static_cast<DLPackContext*>(self->manager_ctx);
+}
+
+}  // namespace
+
+Status ExportArrowArray(std::shared_ptr<Object> const& object,
+                        struct ArrowArray* array, struct ArrowSchema* schema) {
+  if (auto batch = std::dynamic_pointer_cast<RecordBatch>(object)) {
+    RETURN_ON_ARROW_ERROR(arrow::ExportRecordBatch(
+        *retainRecordBatch(batch->GetRecordBatch(), object), array, schema));
+    return Status::OK();
+  }
+  std::shared_ptr<arrow::Array> arrow_array;
+  RETURN_ON_ERROR(resolveArray(object, arrow_array));
+  RETURN_ON_ARROW_ERROR(arrow::ExportArray(*arrow_array, array, schema));
+  return Status::OK();
+}
+
+Status ExportArrowSchema(std::shared_ptr<Object> const& object,
+                         struct ArrowSchema* schema) {
+  std::shared_ptr<arrow::Schema> arrow_schema;
+  RETURN_ON_ERROR(resolveSchema(object, arrow_schema));
+  RETURN_ON_ARROW_ERROR(arrow::ExportSchema(*arrow_schema, schema));
+  return Status::OK();
+}
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 2000000
+Status ExportArrowArrayStream(std::shared_ptr<Object> const& object,
+                              struct ArrowArrayStream* stream) {
+  std::shared_ptr<arrow::Schema> schema;
+  RETURN_ON_ERROR(resolveSchema(object, schema));
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  if (auto batch = std::dynamic_pointer_cast<RecordBatch>(object)) {
+    batches.emplace_back(retainRecordBatch(batch->GetRecordBatch(), object));
+  } else if (auto table = std::dynamic_pointer_cast<Table>(object)) {
+    for (auto const& batch : table->batches()) {
+      batches.emplace_back(retainRecordBatch(batch->GetRecordBatch(), object));
+    }
+  }
+  std::shared_ptr<arrow::RecordBatchReader> reader;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      reader, arrow::RecordBatchReader::Make(std::move(batches), schema));
+  RETURN_ON_ARROW_ERROR(arrow::ExportRecordBatchReader(reader, stream));
+  return Status::OK();
+}
+#endif
+
+Status ExportDLPack(std::shared_ptr<Object> const& object,
+                    DLManagedTensor** tensor) {
+  auto itensor = std::dynamic_pointer_cast<ITensor>(object);
+  if (itensor == nullptr) {
+    return Status::Invalid("Cannot export '" + object->meta().GetTypeName() +
+                           "' as a DLPack tensor");
+  }
+  DLDataType dtype;
+  RETURN_ON_ERROR(resolveDLDataType(itensor->value_type(), dtype));
+
+  std::unique_ptr<DLPackContext> context(new DLPackContext());
+  context->tensor = itensor;
+  context->shape = itensor->shape();
+  // the strides of DLPack are in number of elements, rather than bytes
+  if (!context->shape.empty()) {
+    for (int64_t const stride : itensor->strides()) {
+      context->strides.emplace_back(stride / (dtype.bits / 8));
+    }
+  }
+
+  DLManagedTensor& managed = context->managed;
+  // the payload is mapped as read-only
+  managed.dl_tensor.data =
+      const_cast<uint8_t*>(itensor->buffer() ? itensor->buffer()->data()
+                                             : nullptr);
+  managed.dl_tensor.device.device_type = kDLCPU;
+  managed.dl_tensor.device.device_id = 0;
+  managed.dl_tensor.ndim = static_cast<int32_t>(context->shape.size());
+  managed.dl_tensor.dtype = dtype;
+  managed.dl_tensor.shape = context->shape.data();
+  managed.dl_tensor.strides = context->strides.data();
+  managed.dl_tensor.byte_offset = 0;
+  managed.manager_ctx = context.get();
+  managed.deleter = deleteDLPackContext;
+  *tensor = &context.release()->managed;
+  return Status::OK();
+}
+
+}  // namespace vineyard
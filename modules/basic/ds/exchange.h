@@ -0,0 +1,83 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_EXCHANGE_H_
+#define MODULES_BASIC_DS_EXCHANGE_H_
+
+#include <memory>
+
+#include "arrow/c/abi.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/dlpack.h"
+#include "basic/ds/tensor.h"
+#include "client/ds/i_object.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief Export an array (e.g., `NumericArray`, `StringArray`), or a
+ * `RecordBatch` (as a struct array) through the Arrow C data interface,
+ * without copying the payloads.
+ *
+ * The exported structures hold a reference of the vineyard object until they
+ * are released by the consumer. The payloads reside in the memory that has
+ * been mapped to the client, thus the client must outlive the consumer.
+ *
+ * @param object The array or record batch to export.
+ * @param array The exported array.
+ * @param schema The exported type (for arrays) or schema (for record batches),
+ * can be nullptr if not needed.
+ *
+ * @return Status that indicates whether the export has succeeded.
+ */
+Status ExportArrowArray(std::shared_ptr<Object> const& object,
+                        struct ArrowArray* array, struct ArrowSchema* schema);
+
+/**
+ * @brief Export the schema of a `RecordBatch` or a `Table` through the Arrow
+ * C data interface.
+ */
+Status ExportArrowSchema(std::shared_ptr<Object> const& object,
+                         struct ArrowSchema* schema);
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 2000000
+/**
+ * @brief Export a `RecordBatch` or a `Table` as a stream of record batches
+ * through the Arrow C stream interface, see also `ExportArrowArray`.
+ */
+Status ExportArrowArrayStream(std::shared_ptr<Object> const& object,
+                              struct ArrowArrayStream* stream);
+#endif
+
+/**
+ * @brief Export a `Tensor<T>` as a DLPack tensor on CPU without copying the
+ * payload. The tensor must be treated as read-only by the consumer.
+ *
+ * The exported tensor holds a reference of the vineyard object until its
+ * `deleter` is invoked by the consumer, the client must outlive the consumer.
+ *
+ * @param object The tensor to export.
+ * @param tensor The exported tensor.
+ *
+ * @return Status that indicates whether the export has succeeded.
+ */
+Status ExportDLPack(std::shared_ptr<Object> const& object,
+                    DLManagedTensor** tensor);
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_EXCHANGE_H_
@@ -20,7 +20,9 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "flat_hash_map/flat_hash_map.hpp"
 
@@ -177,6 +179,320 @@ class HashmapBuilder : public HashmapBaseBuilder<K, V, H, E> {
   ska::flat_hash_map<K, V, H, E> hashmap_;
 };
 
+/**
+ * @brief ParallelHashmapBuilder constructs the same hashmap as
+ * HashmapBuilder from a batch of key-value pairs, using multiple threads.
+ *
+ * The slots are partitioned into contiguous ranges by the home slot of the
+ * keys, each partition is sorted and laid out by its own thread, and the
+ * entries are placed into the blob of the sealed bucket array directly,
+ * without building an intermediate `ska::flat_hash_map` first.
+ *
+ * The entries are placed in the order of their home slots, which is a valid
+ * robin hood layout for the lookups of Hashmap. For duplicated keys the first
+ * occurrence in the input wins, as `emplace` in HashmapBuilder.
+ *
+ * @tparam K The type for the key.
+ * @tparam V The type for the value.
+ * @tparam std::hash<K> The hash function for the key.
+ * @tparam std::equal_to<K> The compare function for the key.
+ */
+template <typename K, typename V, typename H = std::hash<K>,
+          typename E = std::equal_to<K>>
+class ParallelHashmapBuilder : public HashmapBaseBuilder<K, V, H, E> {
+  using T = std::pair<K, V>;
+  using entry_t = typename Hashmap<K, V, H, E>::Entry;
+
+ public:
+  /**
+   * @brief Initialize the builder from the key-value pairs, the concurrency
+   * defaults to the number of hardware threads.
+   */
+  explicit ParallelHashmapBuilder(Client& client, std::vector<T>&& entries,
+                                  size_t concurrency = 0)
+      : HashmapBaseBuilder<K, V, H, E>(client),
+        entries_(std::move(entries)),
+        concurrency_(concurrency) {
+    if (concurrency_ == 0) {
+      concurrency_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // the threads don't pay off for small hashmaps
+    concurrency_ = std::max(
+        static_cast<size_t>(1),
+        std::min(concurrency_, entries_.size() / kMinItemsPerThread));
+  }
+
+  /**
+   * @brief Get the number of key-value pairs to insert, including duplicated
+   * keys.
+   */
+  size_t size() const { return entries_.size(); }
+
+  /**
+   * @brief Build the hashmap object.
+   *
+   */
+  Status Build(Client& client) override {
+    size_t const n = entries_.size();
+    // small partitions make the sorting cheap, as a pass of radix sort
+    size_t const num_partitions =
+        std::max(concurrency_ * kPartitionsPerThread,
+                 n / kItemsPerPartition + 1);
+
+    std::vector<size_t> hashes(n);
+    parallel_for(n, [&](size_t, size_t begin, size_t end) {
+      H hasher;
+      for (size_t i = begin; i < end; ++i) {
+        hashes[i] = hasher(entries_[i].first);
+      }
+    });
+
+    // load factor 0.5, the same as the default of ska::flat_hash_map
+    size_t num_buckets = std::max(n * 2, static_cast<size_t>(4));
+    std::vector<slot_t> slots(n);
+    std::vector<size_t> offsets(num_partitions + 1);
+    size_t num_elements = 0, occupied = 0;
+    int max_distance = 0;
+    while (true) {
+      num_buckets = next_prime(num_buckets);
+      partition(hashes, num_buckets, num_partitions, slots, offsets);
+      layout(slots, offsets, num_buckets, num_partitions, num_elements,
+             occupied, max_distance);
+      size_t const overflow =
+          occupied > num_buckets ? occupied - num_buckets : 0;
+      if (max_distance < kMaxDistance && overflow + 1 < kMaxDistance) {
+        break;
+      }
+      // the clusters are too long to be encoded in the entries, or to be
+      // probed efficiently
+      if (num_buckets > std::max(n, static_cast<size_t>(1024)) * kMaxGrowth) {
+        return Status::Invalid(
+            "Failed to build the hashmap: too many keys collide in the hash "
+            "function");
+      }
+      num_buckets *= 2;
+    }
+    std::vector<size_t>().swap(hashes);
+
+    size_t const overflow = occupied > num_buckets ? occupied - num_buckets : 0;
+    int8_t const max_lookups = static_cast<int8_t>(
+        std::max({static_cast<size_t>(ska::detailv3::min_lookups),
+                  static_cast<size_t>(ska::detailv3::log2(num_buckets)),
+                  static_cast<size_t>(max_distance + 1), overflow + 1}));
+    size_t const entry_size = num_buckets + max_lookups;
+    auto entries_builder =
+        std::make_shared<ArrayBuilder<entry_t>>(client, entry_size);
+    entry_t* entries = entries_builder->data();
+
+    parallel_for(entry_size, [&](size_t, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        entries[i].distance_from_desired = -1;
+      }
+    });
+    entries[entry_size - 1].distance_from_desired = entry_t::special_end_value;
+    parallel_for(num_partitions, [&](size_t, size_t begin, size_t end) {
+      for (size_t i = offsets[begin]; i < offsets[end]; ++i) {
+        const slot_t& slot = slots[i];
+        if (slot.index == kRemoved) {
+          continue;
+        }
+        entries[slot.position].emplace(
+            static_cast<int8_t>(slot.position - slot.home),
+            std::move(entries_[slot.index]));
+      }
+    });
+    entries_.clear();
+    entries_.shrink_to_fit();
+
+    this->set_num_slots_minus_one_(num_buckets - 1);
+    this->set_max_lookups_(max_lookups);
+    this->set_num_elements_(num_elements);
+    this->set_entries_(std::static_pointer_cast<ObjectBase>(entries_builder));
+    return Status::OK();
+  }
+
+ private:
+  struct slot_t {
+    size_t home;
+    size_t index;
+    size_t position;
+  };
+
+  enum : size_t {
+    kMinItemsPerThread = 1024 * 64,
+    kPartitionsPerThread = 4,
+    kItemsPerPartition = 64,
+    kMaxGrowth = 64,
+    kRemoved = static_cast<size_t>(-1),
+  };
+  enum : int { kMaxDistance = 127 };
+
+  /**
+   * The lookups of Hashmap take the home slot as `hash % num_buckets`, a prime
+   * number of buckets spreads the poor hashes (e.g., the identity hash of
+   * integers) as `ska::prime_number_hash_policy` does.
+   */
+  static size_t next_prime(size_t n) {
+    auto is_prime = [](size_t value) {
+      for (size_t divisor = 3; divisor <= value / divisor; divisor += 2) {
+        if (value % divisor == 0) {
+          return false;
+        }
+      }
+      return true;
+    };
+    n |= 1;
+    while (!is_prime(n)) {
+      n += 2;
+    }
+    return n;
+  }
+
+  /**
+   * Run `func(thread_index, begin, end)` on `concurrency_` threads, each of
+   * them takes a contiguous range of [0, n).
+   */
+  template <typename F>
+  void parallel_for(size_t n, const F& func) const {
+    size_t const thread_num = std::max(
+        static_cast<size_t>(1), std::min(concurrency_, n));
+    size_t const chunk = (n + thread_num - 1) / thread_num;
+    if (thread_num == 1) {
+      func(0, 0, n);
+      return;
+    }
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_num; ++t) {
+      size_t const begin = std::min(n, t * chunk);
+      size_t const end = std::min(n, begin + chunk);
+      threads.emplace_back([&func, t, begin, end]() { func(t, begin, end); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  /**
+   * Scatter the items into partitions of contiguous home slots, the items of
+   * the i-th partition are placed in `slots[offsets[i], offsets[i + 1])`.
+   */
+  void partition(const std::vector<size_t>& hashes, size_t num_buckets,
+                 size_t num_partitions, std::vector<slot_t>& slots,
+                 std::vector<size_t>& offsets) const {
+    size_t const n = hashes.size();
+    size_t const range = (num_buckets + num_partitions - 1) / num_partitions;
+    size_t const thread_num = std::max(
+        static_cast<size_t>(1), std::min(concurrency_, n));
+    std::vector<std::vector<size_t>> counts(
+        thread_num, std::vector<size_t>(num_partitions, 0));
+    parallel_for(n, [&](size_t t, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        counts[t][hashes[i] % num_buckets / range] += 1;
+      }
+    });
+    // counts[t][p] becomes the first position of thread t in partition p
+    size_t offset = 0;
+    for (size_t p = 0; p < num_partitions; ++p) {
+      offsets[p] = offset;
+      for (size_t t = 0; t < thread_num; ++t) {
+        size_t const count = counts[t][p];
+        counts[t][p] = offset;
+        offset += count;
+      }
+    }
+    offsets[num_partitions] = offset;
+    parallel_for(n, [&](size_t t, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        size_t const home = hashes[i] % num_buckets;
+        slots[counts[t][home / range]++] = slot_t{home, i, 0};
+      }
+    });
+  }
+
+  /**
+   * Sort the items in each partition by their home slots, drop the duplicated
+   * keys, and assign the positions of the entries.
+   */
+  void layout(std::vector<slot_t>& slots, const std::vector<size_t>& offsets,
+              size_t num_buckets, size_t num_partitions, size_t& num_elements,
+              size_t& occupied, int& max_distance) const {
+    std::vector<size_t> elements(num_partitions, 0);
+    std::vector<int> distances(num_partitions, 0);
+    parallel_for(num_partitions, [&](size_t, size_t begin, size_t end) {
+      E equal;
+      for (size_t p = begin; p < end; ++p) {
+        auto first = slots.begin() + offsets[p];
+        auto last = slots.begin() + offsets[p + 1];
+        std::sort(first, last, [](const slot_t& lhs, const slot_t& rhs) {
+          return lhs.home < rhs.home ||
+                 (lhs.home == rhs.home && lhs.index < rhs.index);
+        });
+        size_t next = p * ((num_buckets + num_partitions - 1) / num_partitions);
+        for (auto group = first; group != last;) {
+          auto group_end = group;
+          while (group_end != last && group_end->home == group->home) {
+            ++group_end;
+          }
+          for (auto it = group; it != group_end; ++it) {
+            for (auto prev = group; prev != it; ++prev) {
+              if (prev->index != kRemoved &&
+                  equal(entries_[prev->index].first,
+                        entries_[it->index].first)) {
+                it->index = kRemoved;
+                break;
+              }
+            }
+            if (it->index != kRemoved) {
+              it->position = std::max(next, it->home);
+              next = it->position + 1;
+              distances[p] = std::max(
+                  distances[p], static_cast<int>(std::min(
+                                    it->position - it->home,
+                                    static_cast<size_t>(kMaxDistance))));
+              elements[p] += 1;
+            }
+          }
+          group = group_end;
+        }
+      }
+    });
+
+    // resolve the clusters that spill over into the following partitions
+    num_elements = 0;
+    max_distance = 0;
+    size_t next = 0;
+    for (size_t p = 0; p < num_partitions; ++p) {
+      num_elements += elements[p];
+      max_distance = std::max(max_distance, distances[p]);
+      for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+        slot_t& slot = slots[i];
+        if (slot.index == kRemoved) {
+          continue;
+        }
+        if (slot.position >= next) {
+          // the shift has been absorbed, the rest are untouched
+          break;
+        }
+        slot.position = next++;
+        max_distance = std::max(
+            max_distance,
+            static_cast<int>(std::min(slot.position - slot.home,
+                                      static_cast<size_t>(kMaxDistance))));
+      }
+      for (size_t i = offsets[p + 1]; i > offsets[p]; --i) {
+        if (slots[i - 1].index != kRemoved) {
+          next = std::max(next, slots[i - 1].position + 1);
+          break;
+        }
+      }
+    }
+    occupied = next;
+  }
+
+  std::vector<T> entries_;
+  size_t concurrency_;
+};
+
 }  // namespace vineyard
 
 #endif  // MODULES_BASIC_DS_HASHMAP_H_
@@ -51,6 +51,11 @@ class ObjectSet : public Registered<ObjectSet> {
     return objects_.at(instance_id);
   }
 
+  const std::unordered_map<InstanceID, std::vector<std::shared_ptr<Object>>>&
+  Objects() const {
+    return objects_;
+  }
+
   void Construct(const ObjectMeta& meta) override {
     std::string __type_name = type_name<ObjectSet>();
     CHECK(meta.GetTypeName() == __type_name);
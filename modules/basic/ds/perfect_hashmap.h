@@ -0,0 +1,212 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_PERFECT_HASHMAP_H_
+#define MODULES_BASIC_DS_PERFECT_HASHMAP_H_
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flat_hash_map/flat_hash_map.hpp"
+
+#include "basic/ds/array.h"
+#include "basic/ds/hashmap.h"
+#include "basic/ds/perfect_hashmap.vineyard.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief PerfectHashmapBuilder is used for constructing perfect hashmaps that
+ * supported by vineyard, from the mappings of a `HashmapBuilder` (or a
+ * `ska::flat_hash_map`).
+ *
+ * @tparam K The type for the key.
+ * @tparam V The type for the value.
+ * @tparam std::hash<K> The hash function for the key.
+ * @tparam std::equal_to<K> The compare function for the key.
+ */
+template <typename K, typename V, typename H = std::hash<K>,
+          typename E = std::equal_to<K>>
+class PerfectHashmapBuilder : public PerfectHashmapBaseBuilder<K, V, H, E> {
+ public:
+  using T = std::pair<K, V>;
+
+  explicit PerfectHashmapBuilder(Client& client,
+                                 HashmapBuilder<K, V, H, E> const& builder)
+      : PerfectHashmapBaseBuilder<K, V, H, E>(client),
+        entries_(builder.begin(), builder.end()) {}
+
+  explicit PerfectHashmapBuilder(Client& client,
+                                 ska::flat_hash_map<K, V, H, E> const& hashmap)
+      : PerfectHashmapBaseBuilder<K, V, H, E>(client),
+        entries_(hashmap.begin(), hashmap.end()) {}
+
+  /**
+   * @brief Get the size of the hashmap.
+   *
+   */
+  size_t size() const { return entries_.size(); }
+
+  /**
+   * @brief Build the hashmap object.
+   *
+   * The buckets are displaced from the largest one, by searching the first
+   * pilot that places all keys of the bucket into free positions. Fails if
+   * different keys have the same hash value, as no pilot separates them.
+   */
+  Status Build(Client& client) override {
+    size_t const n = entries_.size();
+    size_t const table_size = perfect_hash::table_size(n);
+    size_t const num_buckets =
+        std::max<size_t>(1, (n + perfect_hash::kBucketSize - 1) /
+                                perfect_hash::kBucketSize);
+
+    // group the hashes by bucket
+    H hasher;
+    std::vector<uint64_t> hashes(n);
+    std::vector<size_t> bucket_offsets(num_buckets + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+      hashes[i] = perfect_hash::mix(hasher(entries_[i].first));
+      bucket_offsets[perfect_hash::bucket(hashes[i], num_buckets) + 1] += 1;
+    }
+    for (size_t b = 0; b < num_buckets; ++b) {
+      bucket_offsets[b + 1] += bucket_offsets[b];
+    }
+    // the items and their hashes in the order of buckets
+    std::vector<size_t> bucket_items(n);
+    std::vector<uint64_t> bucket_hashes(n);
+    {
+      std::vector<size_t> cursor(bucket_offsets.begin(),
+                                 bucket_offsets.end() - 1);
+      for (size_t i = 0; i < n; ++i) {
+        size_t const loc =
+            cursor[perfect_hash::bucket(hashes[i], num_buckets)]++;
+        bucket_items[loc] = i;
+        bucket_hashes[loc] = hashes[i];
+      }
+    }
+    std::vector<uint64_t>().swap(hashes);
+
+    // larger buckets first, when there are more free positions
+    std::vector<size_t> buckets(num_buckets);
+    for (size_t b = 0; b < num_buckets; ++b) {
+      buckets[b] = b;
+    }
+    std::stable_sort(buckets.begin(), buckets.end(),
+                     [&bucket_offsets](size_t lhs, size_t rhs) {
+                       return bucket_offsets[lhs + 1] - bucket_offsets[lhs] >
+                              bucket_offsets[rhs + 1] - bucket_offsets[rhs];
+                     });
+
+    auto pilots_builder =
+        std::make_shared<ArrayBuilder<uint32_t>>(client, num_buckets);
+    auto remap_builder =
+        std::make_shared<ArrayBuilder<uint64_t>>(client, table_size - n);
+    auto entries_builder = std::make_shared<ArrayBuilder<T>>(client, n);
+    uint32_t* pilots = pilots_builder->data();
+    uint64_t* remap = remap_builder->data();
+    T* entries = entries_builder->data();
+    std::fill(pilots, pilots + num_buckets, 0);
+    std::fill(remap, remap + (table_size - n), 0);
+
+    std::vector<bool> taken(table_size, false);
+    // the items that are placed beyond n
+    std::vector<size_t> overflow(table_size - n);
+    std::vector<size_t> positions;
+    for (size_t const b : buckets) {
+      size_t const begin = bucket_offsets[b], end = bucket_offsets[b + 1];
+      if (begin == end) {
+        break;  // the remaining buckets are empty as well
+      }
+      for (size_t i = begin; i < end; ++i) {
+        for (size_t j = begin; j < i; ++j) {
+          if (bucket_hashes[i] == bucket_hashes[j]) {
+            return Status::Invalid(
+                "Failed to build the perfect hashmap: different keys have "
+                "the same hash value");
+          }
+        }
+      }
+      uint64_t pilot = 0;
+      for (; pilot <= std::numeric_limits<uint32_t>::max(); ++pilot) {
+        positions.clear();
+        for (size_t i = begin; i < end; ++i) {
+          size_t const pos = perfect_hash::position(
+              bucket_hashes[i], static_cast<uint32_t>(pilot), table_size);
+          if (taken[pos] || std::find(positions.begin(), positions.end(),
+                                      pos) != positions.end()) {
+            break;
+          }
+          positions.emplace_back(pos);
+        }
+        if (positions.size() == end - begin) {
+          break;
+        }
+      }
+      if (pilot > std::numeric_limits<uint32_t>::max()) {
+        return Status::Invalid(
+            "Failed to build the perfect hashmap: no pilot found for the "
+            "bucket " +
+            std::to_string(b));
+      }
+      pilots[b] = static_cast<uint32_t>(pilot);
+      for (size_t i = begin; i < end; ++i) {
+        size_t const pos = positions[i - begin];
+        taken[pos] = true;
+        if (pos < n) {
+          entries[pos] = entries_[bucket_items[i]];
+        } else {
+          overflow[pos - n] = bucket_items[i];
+        }
+      }
+    }
+
+    // move the overflowed items to the free positions, as many as them
+    size_t free_pos = 0;
+    for (size_t pos = n; pos < table_size; ++pos) {
+      if (!taken[pos]) {
+        continue;
+      }
+      while (taken[free_pos]) {
+        ++free_pos;
+      }
+      remap[pos - n] = free_pos;
+      entries[free_pos] = entries_[overflow[pos - n]];
+      ++free_pos;
+    }
+
+    this->set_num_elements_(n);
+    this->set_num_buckets_(num_buckets);
+    this->set_pilots_(std::static_pointer_cast<ObjectBase>(pilots_builder));
+    this->set_remap_(std::static_pointer_cast<ObjectBase>(remap_builder));
+    this->set_entries_(std::static_pointer_cast<ObjectBase>(entries_builder));
+    return Status::OK();
+  }
+
+ private:
+  std::vector<T> entries_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_PERFECT_HASHMAP_H_
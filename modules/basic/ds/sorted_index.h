@@ -0,0 +1,165 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_SORTED_INDEX_H_
+#define MODULES_BASIC_DS_SORTED_INDEX_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/array.h"
+#include "basic/ds/arrow.h"
+#include "basic/ds/sorted_index.vineyard.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief SortedIndexBuilder is used for constructing sorted indexes that
+ * supported by vineyard, over the values of a numeric array.
+ *
+ * The positions that the sorted index reports are the indices of the values
+ * in the array, the null values (and NaNs) are not indexed.
+ *
+ * @tparam T The type for the keys.
+ */
+template <typename T>
+class SortedIndexBuilder : public SortedIndexBaseBuilder<T> {
+ public:
+  /**
+   * @brief Initialize the builder with the given values.
+   *
+   */
+  SortedIndexBuilder(Client& client, const T* values, size_t size)
+      : SortedIndexBaseBuilder<T>(client) {
+    entries_.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+      append(values[i], i);
+    }
+  }
+
+  /**
+   * @brief Initialize the builder with the values of a std::vector.
+   *
+   */
+  SortedIndexBuilder(Client& client, std::vector<T> const& values)
+      : SortedIndexBuilder(client, values.data(), values.size()) {}
+
+  /**
+   * @brief Initialize the builder with the values of a vineyard array.
+   *
+   */
+  SortedIndexBuilder(Client& client, Array<T> const& values)
+      : SortedIndexBuilder(client, values.data(), values.size()) {}
+
+  /**
+   * @brief Initialize the builder with the non-null values of a vineyard
+   * numeric array, e.g., a column of the dataframe or the record batch.
+   *
+   */
+  SortedIndexBuilder(Client& client, NumericArray<T> const& values)
+      : SortedIndexBaseBuilder<T>(client) {
+    auto array = values.GetArray();
+    const T* data = array->raw_values();
+    entries_.reserve(array->length() - array->null_count());
+    for (int64_t i = 0; i < array->length(); ++i) {
+      if (array->IsValid(i)) {
+        append(data[i], i);
+      }
+    }
+  }
+
+  /**
+   * @brief Get the number of keys to index.
+   *
+   */
+  size_t size() const { return entries_.size(); }
+
+  /**
+   * @brief Build the sorted index object.
+   *
+   */
+  Status Build(Client& client) override {
+    using index_t = SortedIndex<T>;
+    std::sort(entries_.begin(), entries_.end());
+
+    size_t const size = entries_.size();
+    size_t const num_blocks =
+        (size + index_t::kBlockSize - 1) / index_t::kBlockSize;
+    auto keys_builder = std::make_shared<ArrayBuilder<T>>(client, size);
+    auto positions_builder =
+        std::make_shared<ArrayBuilder<int64_t>>(client, size);
+    for (size_t i = 0; i < size; ++i) {
+      (*keys_builder)[i] = entries_[i].first;
+      (*positions_builder)[i] = entries_[i].second;
+    }
+    entries_.clear();
+    entries_.shrink_to_fit();
+
+    // the slot 0 of the summary is unused, for the 1-based indices of nodes
+    auto tree_builder =
+        std::make_shared<ArrayBuilder<T>>(client, num_blocks + 1);
+    auto tree_blocks_builder =
+        std::make_shared<ArrayBuilder<uint64_t>>(client, num_blocks + 1);
+    size_t block = 0;
+    fillEytzinger(keys_builder->data(), tree_builder->data(),
+                  tree_blocks_builder->data(), num_blocks, 1, block);
+
+    this->set_num_elements_(size);
+    this->set_num_blocks_(num_blocks);
+    this->set_keys_(std::static_pointer_cast<ObjectBase>(keys_builder));
+    this->set_positions_(
+        std::static_pointer_cast<ObjectBase>(positions_builder));
+    this->set_tree_(std::static_pointer_cast<ObjectBase>(tree_builder));
+    this->set_tree_blocks_(
+        std::static_pointer_cast<ObjectBase>(tree_blocks_builder));
+    return Status::OK();
+  }
+
+ private:
+  void append(T const& value, int64_t position) {
+    // NaN is not comparable
+    if (value == value) {
+      entries_.emplace_back(value, position);
+    }
+  }
+
+  /**
+   * @brief Fill the first keys of blocks into the summary, by the in-order
+   * traversal of the complete binary search tree.
+   */
+  static void fillEytzinger(const T* keys, T* tree, uint64_t* tree_blocks,
+                            size_t num_blocks, size_t node, size_t& block) {
+    if (node > num_blocks) {
+      return;
+    }
+    fillEytzinger(keys, tree, tree_blocks, num_blocks, 2 * node, block);
+    tree[node] = keys[block * SortedIndex<T>::kBlockSize];
+    tree_blocks[node] = block;
+    block += 1;
+    fillEytzinger(keys, tree, tree_blocks, num_blocks, 2 * node + 1, block);
+  }
+
+  std::vector<std::pair<T, int64_t>> entries_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_SORTED_INDEX_H_
@@ -0,0 +1,212 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_SPARSE_TENSOR_H_
+#define MODULES_BASIC_DS_SPARSE_TENSOR_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/sparse_tensor.vineyard.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+
+namespace vineyard {
+
+/**
+ * @brief CSRTensorBuilder is used for building CSR sparse tensors.
+ *
+ * @tparam T The type for the values.
+ */
+template <typename T>
+class CSRTensorBuilder : public CSRTensorBaseBuilder<T> {
+ public:
+  /**
+   * @brief Initialize the CSRTensorBuilder with the shape and number of
+   * non-zeros, the row offsets, column indices and values are expected to be
+   * filled by the caller.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param shape The shape of the tensor, i.e., `{rows, columns}`.
+   * @param nnz The number of the non-zeros.
+   */
+  CSRTensorBuilder(Client& client, std::vector<int64_t> const& shape,
+                   size_t const nnz)
+      : CSRTensorBaseBuilder<T>(client) {
+    VINEYARD_ASSERT(shape.size() == 2, "CSR tensor must be 2-dimensional");
+    this->set_value_type_(AnyType(AnyTypeEnum<T>::value));
+    this->set_shape_(shape);
+    this->set_nnz_(nnz);
+    VINEYARD_CHECK_OK(
+        client.CreateBlob((shape[0] + 1) * sizeof(int64_t), indptr_writer_));
+    VINEYARD_CHECK_OK(
+        client.CreateBlob(nnz * sizeof(int64_t), indices_writer_));
+    VINEYARD_CHECK_OK(client.CreateBlob(nnz * sizeof(T), values_writer_));
+    indptr_ = reinterpret_cast<int64_t*>(indptr_writer_->data());
+    indices_ = reinterpret_cast<int64_t*>(indices_writer_->data());
+    values_ = reinterpret_cast<T*>(values_writer_->data());
+    indptr_[0] = 0;
+  }
+
+  /**
+   * @brief Initialize the CSRTensorBuilder from the coordinates of the
+   * non-zeros, which can be unordered.
+   *
+   * The row offsets are built by counting the non-zeros of each row and a
+   * prefix sum, then the non-zeros are scattered into their rows, keeping
+   * their relative order in the same row.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param shape The shape of the tensor, i.e., `{rows, columns}`.
+   * @param rows The row indices of the non-zeros.
+   * @param columns The column indices of the non-zeros.
+   * @param values The values of the non-zeros.
+   */
+  CSRTensorBuilder(Client& client, std::vector<int64_t> const& shape,
+                   std::vector<int64_t> const& rows,
+                   std::vector<int64_t> const& columns,
+                   std::vector<T> const& values)
+      : CSRTensorBuilder(client, shape, values.size()) {
+    VINEYARD_ASSERT(rows.size() == values.size() &&
+                    columns.size() == values.size());
+    std::fill(indptr_, indptr_ + shape[0] + 1, 0);
+    for (auto row : rows) {
+      ++indptr_[row + 1];
+    }
+    for (int64_t i = 0; i < shape[0]; ++i) {
+      indptr_[i + 1] += indptr_[i];
+    }
+    std::vector<int64_t> cursors(indptr_, indptr_ + shape[0]);
+    for (size_t k = 0; k < values.size(); ++k) {
+      int64_t position = cursors[rows[k]]++;
+      indices_[position] = columns[k];
+      values_[position] = values[k];
+    }
+  }
+
+  std::vector<int64_t> const& shape() const { return this->shape_; }
+
+  size_t nnz() const { return this->nnz_; }
+
+  /**
+   * @brief Get the pointer to the row offsets, which has `shape()[0] + 1`
+   * elements.
+   */
+  int64_t* indptr() const { return indptr_; }
+
+  /**
+   * @brief Get the pointer to the column indices, which has `nnz()`
+   * elements.
+   */
+  int64_t* indices() const { return indices_; }
+
+  /**
+   * @brief Get the pointer to the values, which has `nnz()` elements.
+   */
+  T* values() const { return values_; }
+
+  /**
+   * @brief Build the CSR tensor.
+   *
+   * @param client The client connected to the vineyard server.
+   */
+  Status Build(Client& client) override {
+    RETURN_ON_ASSERT(static_cast<size_t>(indptr_[this->shape_[0]]) ==
+                         this->nnz_,
+                     "The row offsets don't match the number of non-zeros");
+    this->set_indptr_(std::shared_ptr<BlobWriter>(std::move(indptr_writer_)));
+    this->set_indices_(
+        std::shared_ptr<BlobWriter>(std::move(indices_writer_)));
+    this->set_values_(std::shared_ptr<BlobWriter>(std::move(values_writer_)));
+    return Status::OK();
+  }
+
+ private:
+  std::unique_ptr<BlobWriter> indptr_writer_, indices_writer_, values_writer_;
+  int64_t* indptr_;
+  int64_t* indices_;
+  T* values_;
+};
+
+/**
+ * @brief COOTensorBuilder is used for building COO sparse tensors.
+ *
+ * @tparam T The type for the values.
+ */
+template <typename T>
+class COOTensorBuilder : public COOTensorBaseBuilder<T> {
+ public:
+  /**
+   * @brief Initialize the COOTensorBuilder with the shape and number of
+   * non-zeros, the coordinates and values are expected to be filled by the
+   * caller.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param shape The shape of the tensor.
+   * @param nnz The number of the non-zeros.
+   */
+  COOTensorBuilder(Client& client, std::vector<int64_t> const& shape,
+                   size_t const nnz)
+      : COOTensorBaseBuilder<T>(client) {
+    this->set_value_type_(AnyType(AnyTypeEnum<T>::value));
+    this->set_shape_(shape);
+    this->set_nnz_(nnz);
+    VINEYARD_CHECK_OK(client.CreateBlob(nnz * shape.size() * sizeof(int64_t),
+                                        indices_writer_));
+    VINEYARD_CHECK_OK(client.CreateBlob(nnz * sizeof(T), values_writer_));
+    indices_ = reinterpret_cast<int64_t*>(indices_writer_->data());
+    values_ = reinterpret_cast<T*>(values_writer_->data());
+  }
+
+  std::vector<int64_t> const& shape() const { return this->shape_; }
+
+  size_t nnz() const { return this->nnz_; }
+
+  /**
+   * @brief Get the pointer to the coordinates, which is a `nnz() x ndim`
+   * matrix in row-major order.
+   */
+  int64_t* indices() const { return indices_; }
+
+  /**
+   * @brief Get the pointer to the values, which has `nnz()` elements.
+   */
+  T* values() const { return values_; }
+
+  /**
+   * @brief Build the COO tensor.
+   *
+   * @param client The client connected to the vineyard server.
+   */
+  Status Build(Client& client) override {
+    this->set_indices_(
+        std::shared_ptr<BlobWriter>(std::move(indices_writer_)));
+    this->set_values_(std::shared_ptr<BlobWriter>(std::move(values_writer_)));
+    return Status::OK();
+  }
+
+ private:
+  std::unique_ptr<BlobWriter> indices_writer_, values_writer_;
+  int64_t* indices_;
+  T* values_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_SPARSE_TENSOR_H_
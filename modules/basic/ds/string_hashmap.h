@@ -0,0 +1,174 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_STRING_HASHMAP_H_
+#define MODULES_BASIC_DS_STRING_HASHMAP_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/array.h"
+#include "basic/ds/string_hashmap.vineyard.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief StringHashmapBuilder is used for constructing string-keyed hashmaps
+ * that supported by vineyard.
+ *
+ * The keys are appended to the offsets and data buffers when emplaced, and
+ * the table of hash codes is maintained incrementally, thus the buffers are
+ * sealed as they are, without rehashing the keys again.
+ *
+ * @tparam V The type for the value.
+ */
+template <typename V>
+class StringHashmapBuilder : public StringHashmapBaseBuilder<V> {
+  using slot_t = string_hash_table::slot_t;
+
+ public:
+  explicit StringHashmapBuilder(Client& client)
+      : StringHashmapBaseBuilder<V>(client) {
+    offsets_.emplace_back(0);
+    slots_.resize(string_hash_table::capacity_for(0),
+                  slot_t{0, string_hash_table::kEmpty});
+  }
+
+  /**
+   * @brief Reserve the space for `size` keys of `nbytes` bytes in total.
+   *
+   */
+  void reserve(size_t size, size_t nbytes = 0) {
+    offsets_.reserve(size + 1);
+    values_.reserve(size);
+    chars_.reserve(nbytes);
+    if (string_hash_table::capacity_for(size) > slots_.size()) {
+      rehash(string_hash_table::capacity_for(size));
+    }
+  }
+
+  /**
+   * @brief Insert the mapping if the key doesn't exist yet.
+   *
+   * @return Whether the mapping has been inserted.
+   */
+  bool emplace(const char* key, size_t size, const V& value) {
+    if (values_.size() >= string_hash_table::kMaxElements) {
+      overflow_ = true;
+      return false;
+    }
+    uint32_t const index = static_cast<uint32_t>(values_.size());
+    chars_.insert(chars_.end(), key, key + size);
+    offsets_.emplace_back(chars_.size());
+    if (string_hash_table::emplace(slots_.data(), slots_.size() - 1,
+                                   offsets_.data(), chars_.data(),
+                                   index) != index) {
+      // the key exists, rollback
+      offsets_.pop_back();
+      chars_.resize(offsets_.back());
+      return false;
+    }
+    values_.emplace_back(value);
+    if (values_.size() > slots_.size() / 4 * 3) {
+      rehash(slots_.size() * 2);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Insert the mapping if the key doesn't exist yet, the key could be
+   * any string type that has `data()` and `size()`.
+   *
+   */
+  template <typename S>
+  bool emplace(const S& key, const V& value) {
+    return emplace(key.data(), key.size(), value);
+  }
+
+  /**
+   * @brief Find the value by key, return nullptr if the key doesn't exist.
+   *
+   */
+  template <typename S>
+  V* find(const S& key) {
+    int64_t const index = string_hash_table::find(
+        slots_.data(), slots_.size() - 1, offsets_.data(), chars_.data(),
+        key.data(), key.size(),
+        string_hash_table::hash(key.data(), key.size()));
+    return index == -1 ? nullptr : values_.data() + index;
+  }
+
+  /**
+   * @brief Get the size of the hashmap.
+   *
+   */
+  size_t size() const { return values_.size(); }
+
+  /**
+   * @brief Check whether the hashmap is empty.
+   *
+   */
+  bool empty() const { return values_.empty(); }
+
+  /**
+   * @brief Build the hashmap object.
+   *
+   */
+  Status Build(Client& client) override {
+    if (overflow_) {
+      return Status::Invalid(
+          "Too many keys for the string hashmap, the maximum is " +
+          std::to_string(string_hash_table::kMaxElements));
+    }
+    this->set_num_slots_(slots_.size());
+    this->set_num_elements_(values_.size());
+    this->set_slots_(std::static_pointer_cast<ObjectBase>(
+        std::make_shared<ArrayBuilder<slot_t>>(client, slots_)));
+    this->set_offsets_(std::static_pointer_cast<ObjectBase>(
+        std::make_shared<ArrayBuilder<int64_t>>(client, offsets_)));
+    this->set_chars_(std::static_pointer_cast<ObjectBase>(
+        std::make_shared<ArrayBuilder<char>>(client, chars_)));
+    this->set_values_(std::static_pointer_cast<ObjectBase>(
+        std::make_shared<ArrayBuilder<V>>(client, values_)));
+    return Status::OK();
+  }
+
+ private:
+  void rehash(size_t capacity) {
+    std::vector<slot_t> slots(capacity, slot_t{0, string_hash_table::kEmpty});
+    for (const slot_t& slot : slots_) {
+      if (slot.index != string_hash_table::kEmpty) {
+        string_hash_table::insert(slots.data(), capacity - 1, slot.hash,
+                                  slot.index);
+      }
+    }
+    slots_.swap(slots);
+  }
+
+  std::vector<int64_t> offsets_;
+  std::vector<char> chars_;
+  std::vector<V> values_;
+  std::vector<slot_t> slots_;
+  bool overflow_ = false;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_STRING_HASHMAP_H_
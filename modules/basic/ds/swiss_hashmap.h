@@ -0,0 +1,175 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_SWISS_HASHMAP_H_
+#define MODULES_BASIC_DS_SWISS_HASHMAP_H_
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "flat_hash_map/flat_hash_map.hpp"
+
+#include "basic/ds/array.h"
+#include "basic/ds/hashmap.h"
+#include "basic/ds/swiss_hashmap.vineyard.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief SwissHashmapBuilder is used for constructing swiss table hashmaps
+ * that supported by vineyard, either from the mappings emplaced into it, or
+ * by converting a `HashmapBuilder`.
+ *
+ * @tparam K The type for the key.
+ * @tparam V The type for the value.
+ * @tparam std::hash<K> The hash function for the key.
+ * @tparam std::equal_to<K> The compare function for the key.
+ */
+template <typename K, typename V, typename H = std::hash<K>,
+          typename E = std::equal_to<K>>
+class SwissHashmapBuilder : public SwissHashmapBaseBuilder<K, V, H, E> {
+ public:
+  using T = std::pair<K, V>;
+
+  explicit SwissHashmapBuilder(Client& client)
+      : SwissHashmapBaseBuilder<K, V, H, E>(client) {}
+
+  explicit SwissHashmapBuilder(Client& client,
+                               ska::flat_hash_map<K, V, H, E>&& hashmap)
+      : SwissHashmapBaseBuilder<K, V, H, E>(client),
+        hashmap_(std::move(hashmap)) {}
+
+  /**
+   * @brief Initialize the SwissHashmapBuilder with the mappings of the given
+   * HashmapBuilder.
+   *
+   */
+  explicit SwissHashmapBuilder(Client& client,
+                               HashmapBuilder<K, V, H, E> const& builder)
+      : SwissHashmapBaseBuilder<K, V, H, E>(client) {
+    hashmap_.reserve(builder.size());
+    hashmap_.insert(builder.begin(), builder.end());
+  }
+
+  /**
+   * @brief Get the mapping value of the given key.
+   *
+   */
+  inline V& operator[](const K& key) { return hashmap_[key]; }
+
+  /**
+   * @brief Get the mapping value of the given key.
+   *
+   */
+  inline V& operator[](K&& key) { return hashmap_[std::move(key)]; }
+
+  template <class... Args>
+  inline void emplace(Args&&... args) {
+    hashmap_.emplace(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Get the size of the hashmap.
+   *
+   */
+  size_t size() const { return hashmap_.size(); }
+
+  /**
+   * @brief Reserve the size for the hashmap.
+   *
+   */
+  void reserve(size_t size) { hashmap_.reserve(size); }
+
+  /**
+   * @brief Check whether the hashmap is empty.
+   *
+   */
+  bool empty() const { return hashmap_.empty(); }
+
+  /**
+   * @brief Return the const beginning iterator.
+   *
+   */
+  typename ska::flat_hash_map<K, V, H, E>::const_iterator begin() const {
+    return hashmap_.begin();
+  }
+
+  /**
+   * @brief Return the const ending iterator.
+   *
+   */
+  typename ska::flat_hash_map<K, V, H, E>::const_iterator end() const {
+    return hashmap_.end();
+  }
+
+  /**
+   * @brief Build the hashmap object, the slots are filled by inserting the
+   * mappings with the same probing sequence of `SwissHashmap::find`.
+   *
+   */
+  Status Build(Client& client) override {
+    // keeps the load factor not greater than 7/8
+    size_t num_groups = 1;
+    while (num_groups * swiss_group::kWidth * 7 / 8 < hashmap_.size()) {
+      num_groups <<= 1;
+    }
+    size_t const capacity = num_groups * swiss_group::kWidth;
+    size_t const group_mask = num_groups - 1;
+
+    auto ctrl_builder =
+        std::make_shared<ArrayBuilder<int8_t>>(client, capacity);
+    auto slots_builder = std::make_shared<ArrayBuilder<T>>(client, capacity);
+    int8_t* ctrl = ctrl_builder->data();
+    T* slots = slots_builder->data();
+    memset(ctrl, swiss_group::kEmpty, capacity);
+    memset(static_cast<void*>(slots), 0, capacity * sizeof(T));
+
+    H hasher;
+    for (auto const& kv : hashmap_) {
+      size_t const hash = swiss_group::mix(hasher(kv.first));
+      size_t group = swiss_group::h1(hash) & group_mask;
+      for (size_t probe = 1;; ++probe) {
+        size_t const offset = group * swiss_group::kWidth;
+        uint32_t const empty = swiss_group(ctrl + offset).match_empty();
+        if (empty != 0) {
+          size_t const index = offset + __builtin_ctz(empty);
+          ctrl[index] = swiss_group::h2(hash);
+          slots[index] = kv;
+          break;
+        }
+        group = (group + probe) & group_mask;
+      }
+    }
+
+    this->set_num_groups_(num_groups);
+    this->set_num_elements_(hashmap_.size());
+    this->set_ctrl_(std::static_pointer_cast<ObjectBase>(ctrl_builder));
+    this->set_slots_(std::static_pointer_cast<ObjectBase>(slots_builder));
+    return Status::OK();
+  }
+
+ private:
+  ska::flat_hash_map<K, V, H, E> hashmap_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_SWISS_HASHMAP_H_
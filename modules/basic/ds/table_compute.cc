@@ -0,0 +1,224 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/table_compute.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/util/config.h"
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 1000000
+#include "arrow/compute/api.h"
+#endif
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_utils.h"
+#include "client/ds/object_meta.h"
+
+namespace vineyard {
+
+constexpr const char* TableComputeWorker::kRequestTypeName;
+constexpr const char* TableComputeWorker::kErrorTypeName;
+
+namespace {
+
+// the worker puts the result (or the error) under the name, where the
+// submitter is waiting for it
+std::string resultName(ObjectID const request_id) {
+  return "__table_compute_" + VYObjectIDToString(request_id);
+}
+
+bool isComparison(std::string const& op) {
+  return op == "equal" || op == "not_equal" || op == "less" ||
+         op == "less_equal" || op == "greater" || op == "greater_equal";
+}
+
+}  // namespace
+
+Status ProjectTable(std::shared_ptr<arrow::Table> const& table,
+                    std::vector<std::string> const& columns,
+                    std::vector<TablePredicate> const& predicates,
+                    std::shared_ptr<arrow::Table>& result) {
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 1000000
+  std::shared_ptr<arrow::Table> selected = table;
+  if (!predicates.empty()) {
+    arrow::Datum mask;
+    for (auto const& predicate : predicates) {
+      if (!isComparison(predicate.op)) {
+        return Status::Invalid("Unsupported comparison: " + predicate.op);
+      }
+      auto column = table->GetColumnByName(predicate.column);
+      if (column == nullptr) {
+        return Status::Invalid("Column not found: " + predicate.column);
+      }
+      std::shared_ptr<arrow::Scalar> literal;
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+          literal, arrow::Scalar::Parse(column->type(), predicate.value));
+      arrow::Datum matched;
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+          matched, arrow::compute::CallFunction(
+                       predicate.op, {arrow::Datum(column), literal}));
+      if (mask.kind() == arrow::Datum::NONE) {
+        mask = matched;
+      } else {
+        RETURN_ON_ARROW_ERROR_AND_ASSIGN(mask,
+                                         arrow::compute::And(mask, matched));
+      }
+    }
+    arrow::Datum filtered;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        filtered, arrow::compute::Filter(arrow::Datum(table), mask));
+    selected = filtered.table();
+  }
+  if (columns.empty()) {
+    result = selected;
+    return Status::OK();
+  }
+  std::vector<int> indices;
+  for (auto const& name : columns) {
+    int index = selected->schema()->GetFieldIndex(name);
+    if (index == -1) {
+      return Status::Invalid("Column not found: " + name);
+    }
+    indices.emplace_back(index);
+  }
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(result, selected->SelectColumns(indices));
+  return Status::OK();
+#else
+  return Status::NotImplemented(
+      "Projecting and filtering tables requires arrow >= 1.0");
+#endif
+}
+
+Status SubmitTableCompute(ClientBase& client, ObjectID const table_id,
+                          std::vector<std::string> const& columns,
+                          std::vector<TablePredicate> const& predicates,
+                          ObjectID& result_id) {
+  ObjectMeta request;
+  request.SetTypeName(TableComputeWorker::kRequestTypeName);
+  request.AddKeyValue("table", table_id);
+  request.AddKeyValue("columns", columns);
+  std::vector<std::string> filter_columns, filter_ops, filter_values;
+  for (auto const& predicate : predicates) {
+    filter_columns.emplace_back(predicate.column);
+    filter_ops.emplace_back(predicate.op);
+    filter_values.emplace_back(predicate.value);
+  }
+  request.AddKeyValue("filter_columns", filter_columns);
+  request.AddKeyValue("filter_ops", filter_ops);
+  request.AddKeyValue("filter_values", filter_values);
+  ObjectID request_id = InvalidObjectID();
+  RETURN_ON_ERROR(client.CreateMetaData(request, request_id));
+
+  std::string name = resultName(request_id);
+  ObjectID reply_id = InvalidObjectID();
+  auto status = client.GetName(name, reply_id, true);
+  VINEYARD_SUPPRESS(client.DropName(name));
+  VINEYARD_SUPPRESS(client.DelData(request_id));
+  RETURN_ON_ERROR(status);
+
+  ObjectMeta reply;
+  RETURN_ON_ERROR(client.GetMetaData(reply_id, reply));
+  if (reply.GetTypeName() == TableComputeWorker::kErrorTypeName) {
+    std::string message = reply.GetKeyValue("message");
+    VINEYARD_SUPPRESS(client.DelData(reply_id));
+    return Status::Invalid(message);
+  }
+  result_id = reply_id;
+  return Status::OK();
+}
+
+TableComputeWorker::~TableComputeWorker() { VINEYARD_SUPPRESS(Stop()); }
+
+Status TableComputeWorker::Start() {
+  if (subscription_id_ != 0) {
+    return Status::OK();
+  }
+  return client_.Subscribe(kRequestTypeName, false, false, subscription_id_);
+}
+
+Status TableComputeWorker::Poll(bool const wait, size_t& served) {
+  served = 0;
+  if (subscription_id_ == 0) {
+    return Status::Invalid("The table compute worker hasn't been started");
+  }
+  std::vector<ObjectEvent> events;
+  RETURN_ON_ERROR(client_.GetObjectEvents(events, wait));
+  for (auto const& event : events) {
+    if (event.subscription_id != subscription_id_) {
+      continue;
+    }
+    ObjectID result_id = InvalidObjectID();
+    auto status = serve(event.id, result_id);
+    if (!status.ok()) {
+      // tell the submitter rather than letting it wait forever
+      ObjectMeta error;
+      error.SetTypeName(kErrorTypeName);
+      error.AddKeyValue("message", status.ToString());
+      RETURN_ON_ERROR(client_.CreateMetaData(error, result_id));
+    }
+    RETURN_ON_ERROR(client_.PutName(result_id, resultName(event.id)));
+    served += 1;
+  }
+  return Status::OK();
+}
+
+Status TableComputeWorker::Stop() {
+  if (subscription_id_ == 0) {
+    return Status::OK();
+  }
+  auto status = client_.Unsubscribe(subscription_id_);
+  subscription_id_ = 0;
+  return status;
+}
+
+Status TableComputeWorker::serve(ObjectID const request_id,
+                                 ObjectID& result_id) {
+  ObjectMeta request;
+  RETURN_ON_ERROR(client_.GetMetaData(request_id, request));
+  ObjectID table_id = request.GetKeyValue<ObjectID>("table");
+  std::vector<std::string> columns, filter_columns, filter_ops, filter_values;
+  request.GetKeyValue("columns", columns);
+  request.GetKeyValue("filter_columns", filter_columns);
+  request.GetKeyValue("filter_ops", filter_ops);
+  request.GetKeyValue("filter_values", filter_values);
+  if (filter_ops.size() != filter_columns.size() ||
+      filter_values.size() != filter_columns.size()) {
+    return Status::Invalid("Malformed table compute request");
+  }
+  std::vector<TablePredicate> predicates(filter_columns.size());
+  for (size_t index = 0; index < predicates.size(); ++index) {
+    predicates[index].column = filter_columns[index];
+    predicates[index].op = filter_ops[index];
+    predicates[index].value = filter_values[index];
+  }
+
+  std::shared_ptr<Table> table;
+  RETURN_ON_ERROR(client_.GetObject(table_id, table));
+  std::shared_ptr<arrow::Table> result;
+  RETURN_ON_ERROR(
+      ProjectTable(table->GetTable(), columns, predicates, result));
+  TableBuilder builder(client_, result);
+  auto sealed = builder.Seal(client_);
+  if (sealed == nullptr) {
+    return Status::Invalid("Failed to seal the result table");
+  }
+  result_id = sealed->id();
+  return Status::OK();
+}
+
+}  // namespace vineyard
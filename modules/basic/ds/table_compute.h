@@ -0,0 +1,121 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_TABLE_COMPUTE_H_
+#define MODULES_BASIC_DS_TABLE_COMPUTE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/table.h"
+
+#include "client/client.h"
+#include "client/client_base.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief A comparison between a column and a literal, e.g., `age > 30`.
+ *
+ * The `op` is the name of an Arrow compute comparison function, i.e., one
+ * of "equal", "not_equal", "less", "less_equal", "greater" and
+ * "greater_equal". The `value` is parsed as the type of the column.
+ */
+struct TablePredicate {
+  std::string column;
+  std::string op;
+  std::string value;
+};
+
+/**
+ * @brief Select the rows that satisfy all predicates and then the columns of
+ * the table, with the Arrow compute kernels.
+ *
+ * @param table The input table.
+ * @param columns The names of the columns to keep, in order, empty means all.
+ * @param predicates The conjunction of the predicates, empty means all rows.
+ * @param result The projected and filtered table.
+ *
+ * @return Status that indicates whether the computation has succeeded.
+ */
+Status ProjectTable(std::shared_ptr<arrow::Table> const& table,
+                    std::vector<std::string> const& columns,
+                    std::vector<TablePredicate> const& predicates,
+                    std::shared_ptr<arrow::Table>& result);
+
+/**
+ * @brief Ask the compute worker that is co-located with the connected
+ * vineyardd (see `TableComputeWorker`) to project and filter a sealed
+ * `Table`, and wait for the result, i.e., only the selected data needs to be
+ * fetched by (remote) clients.
+ *
+ * The request is a metadata-only object, and the worker seals the result as
+ * a new `Table` in the same vineyardd, which is owned by the caller.
+ *
+ * @param client The IPC or RPC client.
+ * @param table_id The sealed table.
+ * @param result_id The derived table.
+ *
+ * @return Status that indicates whether the computation has succeeded.
+ */
+Status SubmitTableCompute(ClientBase& client, ObjectID const table_id,
+                          std::vector<std::string> const& columns,
+                          std::vector<TablePredicate> const& predicates,
+                          ObjectID& result_id);
+
+/**
+ * @brief TableComputeWorker serves the requests of `SubmitTableCompute` next
+ * to vineyardd, e.g., in a sidecar process: it subscribes the requests, and
+ * reads the tables by the zero-copy IPC client.
+ */
+class TableComputeWorker {
+ public:
+  explicit TableComputeWorker(Client& client) : client_(client) {}
+
+  ~TableComputeWorker();
+
+  /**
+   * @brief Subscribe the requests, the requests submitted before are not
+   * served.
+   */
+  Status Start();
+
+  /**
+   * @brief Serve the requests that have arrived, or block until at least one
+   * arrives if `wait`.
+   *
+   * @param served How many requests have been served.
+   */
+  Status Poll(bool const wait, size_t& served);
+
+  Status Stop();
+
+  static constexpr const char* kRequestTypeName =
+      "vineyard::TableComputeRequest";
+  static constexpr const char* kErrorTypeName = "vineyard::TableComputeError";
+
+ private:
+  Status serve(ObjectID const request_id, ObjectID& result_id);
+
+  Client& client_;
+  uint64_t subscription_id_ = 0;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_TABLE_COMPUTE_H_
@@ -15,14 +15,122 @@ limitations under the License.
 
 #include "basic/ds/tensor.h"
 
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace vineyard {
 
+void GlobalTensor::PostConstruct(const ObjectMeta& meta) {
+  partition_index_status_ = buildPartitionIndex();
+}
+
 std::vector<int64_t> const& GlobalTensor::shape() const { return shape_; }
 
 std::vector<int64_t> const& GlobalTensor::partition_shape() const {
   return partition_shape_;
 }
 
+std::vector<int64_t> const& GlobalTensor::partition_offsets(
+    size_t const axis) const {
+  return partition_offsets_.at(axis);
+}
+
+std::shared_ptr<ITensor> GlobalTensor::PartitionAt(
+    std::vector<int64_t> const& partition_index) const {
+  if (!partition_index_status_.ok() ||
+      partition_index.size() != partition_shape_.size()) {
+    return nullptr;
+  }
+  for (size_t axis = 0; axis < partition_index.size(); ++axis) {
+    if (partition_index[axis] < 0 ||
+        partition_index[axis] >= partition_shape_[axis]) {
+      return nullptr;
+    }
+  }
+  return partition_grid_[flattenPartitionIndex(partition_index)];
+}
+
+Status GlobalTensor::Slice(const InstanceID instance_id,
+                           std::vector<int64_t> const& begin,
+                           std::vector<int64_t> const& end,
+                           std::vector<GlobalTensorChunk>& chunks) const {
+  RETURN_ON_ERROR(partition_index_status_);
+  size_t const ndim = shape_.size();
+  if (begin.size() != ndim || end.size() != ndim) {
+    return Status::Invalid("The region doesn't match the shape of tensor");
+  }
+  // the range of partitions that overlap with the region on each axis
+  std::vector<int64_t> first(ndim), last(ndim);
+  for (size_t axis = 0; axis < ndim; ++axis) {
+    if (begin[axis] < 0 || begin[axis] > end[axis] ||
+        end[axis] > shape_[axis]) {
+      return Status::Invalid("The region is out of the range of tensor");
+    }
+    if (begin[axis] == end[axis]) {
+      return Status::OK();
+    }
+    auto const& offsets = partition_offsets_[axis];
+    first[axis] = std::upper_bound(offsets.begin(), offsets.end(),
+                                   begin[axis]) -
+                  offsets.begin() - 1;
+    last[axis] =
+        std::lower_bound(offsets.begin(), offsets.end(), end[axis]) -
+        offsets.begin();
+  }
+
+  std::vector<int64_t> index = first;
+  while (true) {
+    auto const& partition = partition_grid_[flattenPartitionIndex(index)];
+    if (partition != nullptr &&
+        (instance_id == UnspecifiedInstanceID() ||
+         partition->meta().GetInstanceId() == instance_id)) {
+      GlobalTensorChunk chunk;
+      chunk.instance_id = partition->meta().GetInstanceId();
+      chunk.partition = partition;
+      chunk.strides = partition->strides();
+      bool empty = false;
+      int64_t data_offset = 0;
+      for (size_t axis = 0; axis < ndim; ++axis) {
+        auto const& offsets = partition_offsets_[axis];
+        int64_t const lower = std::max(begin[axis], offsets[index[axis]]);
+        int64_t const upper = std::min(end[axis], offsets[index[axis] + 1]);
+        chunk.offset.push_back(lower - offsets[index[axis]]);
+        chunk.global_offset.push_back(lower);
+        chunk.shape.push_back(upper - lower);
+        data_offset += chunk.offset.back() * chunk.strides[axis];
+        empty = empty || upper <= lower;
+      }
+      if (!empty) {
+        if (partition->IsLocal()) {
+          chunk.data = partition->buffer()->data() + data_offset;
+        }
+        chunks.emplace_back(std::move(chunk));
+      }
+    }
+    // move to the next partition in the row-major order
+    size_t axis = ndim;
+    while (axis > 0) {
+      --axis;
+      if (++index[axis] < last[axis]) {
+        break;
+      }
+      index[axis] = first[axis];
+      if (axis == 0) {
+        return Status::OK();
+      }
+    }
+  }
+}
+
+Status GlobalTensor::LocalSlice(Client& client,
+                                std::vector<int64_t> const& begin,
+                                std::vector<int64_t> const& end,
+                                std::vector<GlobalTensorChunk>& chunks) const {
+  return Slice(client.instance_id(), begin, end, chunks);
+}
+
 const std::vector<std::shared_ptr<Object>>& GlobalTensor::LocalPartitions(
     Client& client) const {
   return partitions_.ObjectsAt(client.instance_id());
@@ -67,6 +175,85 @@ std::shared_ptr<Object> GlobalTensorBuilder::_Seal(Client& client) {
   return object;
 }
 
+Status GlobalTensor::buildPartitionIndex() {
+  size_t const ndim = shape_.size();
+  if (ndim == 0 || partition_shape_.size() != ndim) {
+    return Status::Invalid(
+        "The partition shape doesn't match the shape of global tensor");
+  }
+  size_t num_partitions = 1;
+  for (auto const& partitions : partition_shape_) {
+    if (partitions <= 0) {
+      return Status::Invalid("Invalid partition shape of global tensor");
+    }
+    num_partitions *= partitions;
+  }
+  partition_grid_.resize(num_partitions);
+
+  // the extent of every partition on each axis, -1 means unknown
+  std::vector<std::vector<int64_t>> extents(ndim);
+  for (size_t axis = 0; axis < ndim; ++axis) {
+    extents[axis].resize(partition_shape_[axis], -1);
+  }
+  for (auto const& item : partitions_.Objects()) {
+    for (auto const& object : item.second) {
+      auto partition = std::dynamic_pointer_cast<ITensor>(object);
+      if (partition == nullptr) {
+        continue;
+      }
+      std::vector<int64_t> index = partition->partition_index();
+      if (index.empty() && num_partitions == 1) {
+        index.resize(ndim, 0);
+      }
+      if (index.size() != ndim || partition->shape().size() != ndim) {
+        return Status::Invalid(
+            "The partition doesn't match the shape of global tensor: " +
+            VYObjectIDToString(partition->id()));
+      }
+      for (size_t axis = 0; axis < ndim; ++axis) {
+        if (index[axis] < 0 || index[axis] >= partition_shape_[axis]) {
+          return Status::Invalid("The partition index is out of range: " +
+                                 VYObjectIDToString(partition->id()));
+        }
+        extents[axis][index[axis]] = partition->shape()[axis];
+      }
+      partition_grid_[flattenPartitionIndex(index)] = partition;
+    }
+  }
+
+  // the partitions that are absent are assumed to be evenly split
+  partition_offsets_.resize(ndim);
+  for (size_t axis = 0; axis < ndim; ++axis) {
+    int64_t const chunk_size =
+        (shape_[axis] + partition_shape_[axis] - 1) / partition_shape_[axis];
+    auto& offsets = partition_offsets_[axis];
+    offsets.resize(partition_shape_[axis] + 1, 0);
+    for (int64_t k = 0; k < partition_shape_[axis]; ++k) {
+      int64_t extent = extents[axis][k];
+      if (extent == -1) {
+        extent = std::max(
+            int64_t{0}, std::min(chunk_size, shape_[axis] - offsets[k]));
+      }
+      offsets[k + 1] = offsets[k] + extent;
+    }
+    if (offsets.back() != shape_[axis]) {
+      return Status::Invalid(
+          "The partitions don't cover the shape of global tensor on axis " +
+          std::to_string(axis));
+    }
+  }
+  return Status::OK();
+}
+
+size_t GlobalTensor::flattenPartitionIndex(
+    std::vector<int64_t> const& partition_index) const {
+  size_t index = 0;
+  for (size_t axis = 0; axis < partition_index.size(); ++axis) {
+    index = index * partition_shape_[axis] + partition_index[axis];
+  }
+  return index;
+}
+
 Status GlobalTensorBuilder::Build(Client& client) {
   this->set_partitions_(partitions_builder_.Seal(client));
   return Status::OK();
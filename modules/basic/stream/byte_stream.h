@@ -50,11 +50,21 @@ class ByteStreamBuilder : public ByteStreamBaseBuilder {
     }
   }
 
+  /**
+   * @brief The max number of chunks that the writer can write ahead of the
+   * readers, 0 means the default depth of the vineyard server, see also
+   * `ClientBase::CreateStream`.
+   */
+  void SetDepth(size_t const depth) { depth_ = depth; }
+
   std::shared_ptr<Object> Seal(Client& client) {
     auto bstream = ByteStreamBaseBuilder::Seal(client);
-    VINEYARD_CHECK_OK(client.CreateStream(bstream->id()));
+    VINEYARD_CHECK_OK(client.CreateStream(bstream->id(), depth_));
     return std::static_pointer_cast<Object>(bstream);
   }
+
+ private:
+  size_t depth_ = 0;
 };
 
 }  // namespace vineyard
@@ -39,8 +39,10 @@ class ParallelStream : public Registered<ParallelStream> {
     this->id_ = meta.GetId();
 
     meta.GetKeyValue("size_", this->size_);
+    IndexedKey stream_key("stream_");
+    streams_.reserve(this->size_);
     for (size_t idx = 0; idx < this->size_; ++idx) {
-      streams_.emplace_back(meta.GetMember("stream_" + std::to_string(idx)));
+      streams_.emplace_back(meta.GetMember(stream_key(idx)));
     }
   }
 
@@ -85,8 +87,9 @@ class ParallelStreamBuilder : public ObjectBuilder {
     __value->size_ = streams_.size();
     __value->meta_.AddKeyValue("size_", __value->size_);
 
+    IndexedKey stream_key("stream_");
     for (size_t idx = 0; idx < streams_.size(); ++idx) {
-      __value->meta_.AddMember("stream_" + std::to_string(idx), streams_[idx]);
+      __value->meta_.AddMember(stream_key(idx), streams_[idx]);
     }
     __value->meta_.SetNBytes(0);
 
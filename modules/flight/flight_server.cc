@@ -0,0 +1,363 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "flight/flight_server.h"
+
+#include <cctype>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/util/config.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/dataframe.h"
+#include "basic/stream/dataframe_stream.h"
+#include "client/ds/object_meta.h"
+#include "common/util/typename.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+namespace flight = arrow::flight;
+
+namespace {
+
+arrow::Status toArrowStatus(Status const& status) {
+  if (status.ok()) {
+    return arrow::Status::OK();
+  }
+  if (status.IsObjectNotExists()) {
+    return arrow::Status::KeyError(status.ToString());
+  }
+  if (status.IsInvalid()) {
+    return arrow::Status::Invalid(status.ToString());
+  }
+  return arrow::Status::IOError(status.ToString());
+}
+
+#define RETURN_ON_VINEYARD_ERROR(expr) \
+  do {                                 \
+    auto _status = (expr);             \
+    if (!_status.ok()) {               \
+      return toArrowStatus(_status);   \
+    }                                  \
+  } while (0)
+
+std::shared_ptr<arrow::RecordBatch> toRecordBatch(DataFrame const& dataframe) {
+  size_t num_columns = dataframe.Columns().size();
+  int64_t num_rows = dataframe.shape().first;
+  std::vector<std::shared_ptr<arrow::Array>> columns(num_columns);
+  std::vector<std::shared_ptr<arrow::Field>> fields(num_columns);
+  for (size_t i = 0; i < num_columns; ++i) {
+    auto const& name = dataframe.Columns()[i];
+    auto column = dataframe.Column(name);
+    auto type = FromAnyType(column->value_type());
+    // the column buffers reside in the shared memory
+    columns[i] = arrow::MakeArray(
+        arrow::ArrayData::Make(type, num_rows, {nullptr, column->buffer()}));
+    fields[i] = arrow::field(name, type);
+  }
+  return arrow::RecordBatch::Make(arrow::schema(fields), num_rows, columns);
+}
+
+/**
+ * The batches of a sealed object, which is kept alive until the reader is
+ * released, as the batches are backed by its blobs.
+ */
+class ObjectBatchReader : public arrow::RecordBatchReader {
+ public:
+  ObjectBatchReader(std::shared_ptr<Object> const& object,
+                    std::shared_ptr<arrow::Schema> const& schema,
+                    std::vector<std::shared_ptr<arrow::RecordBatch>>&& batches)
+      : object_(object), schema_(schema), batches_(std::move(batches)) {}
+
+  std::shared_ptr<arrow::Schema> schema() const override { return schema_; }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+    if (index_ < batches_.size()) {
+      *batch = batches_[index_++];
+    } else {
+      batch->reset();
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  std::shared_ptr<Object> object_;
+  std::shared_ptr<arrow::Schema> schema_;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches_;
+  size_t index_ = 0;
+};
+
+/**
+ * The chunks of a dataframe stream, which are read without copying: the
+ * flight stream has written the previous batch to the wire when it asks for
+ * the next one, thus the chunk can be released.
+ */
+class StreamBatchReader : public arrow::RecordBatchReader {
+ public:
+  explicit StreamBatchReader(std::unique_ptr<DataframeStreamReader>&& reader)
+      : reader_(std::move(reader)) {}
+
+  Status Open() {
+    auto status = reader_->ReadBatch(first_);
+    if (status.IsStreamDrained()) {
+      schema_ = arrow::schema({});
+      return Status::OK();
+    }
+    RETURN_ON_ERROR(status);
+    schema_ = first_->schema();
+    return Status::OK();
+  }
+
+  std::shared_ptr<arrow::Schema> schema() const override { return schema_; }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+    if (first_ != nullptr) {
+      *batch = std::move(first_);
+      first_.reset();
+      return arrow::Status::OK();
+    }
+    auto status = reader_->ReadBatch(*batch);
+    if (status.IsStreamDrained()) {
+      batch->reset();
+      return arrow::Status::OK();
+    }
+    return toArrowStatus(status);
+  }
+
+ private:
+  std::unique_ptr<DataframeStreamReader> reader_;
+  std::shared_ptr<arrow::Schema> schema_;
+  std::shared_ptr<arrow::RecordBatch> first_;
+};
+
+Status openObjectReader(Client& client, ObjectID const id,
+                        std::shared_ptr<arrow::RecordBatchReader>& reader) {
+  std::shared_ptr<Object> object;
+  RETURN_ON_ERROR(client.GetObject(id, object));
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  std::shared_ptr<arrow::Schema> schema;
+  if (auto table = std::dynamic_pointer_cast<Table>(object)) {
+    schema = table->schema();
+    for (auto const& batch : table->batches()) {
+      batches.emplace_back(batch->GetRecordBatch());
+    }
+  } else if (auto batch = std::dynamic_pointer_cast<RecordBatch>(object)) {
+    batches.emplace_back(batch->GetRecordBatch());
+    schema = batches.back()->schema();
+  } else if (auto dataframe = std::dynamic_pointer_cast<DataFrame>(object)) {
+    batches.emplace_back(toRecordBatch(*dataframe));
+    schema = batches.back()->schema();
+  } else if (auto stream = std::dynamic_pointer_cast<DataframeStream>(object)) {
+    auto stream_reader =
+        std::make_shared<StreamBatchReader>(stream->OpenReader(client));
+    RETURN_ON_ERROR(stream_reader->Open());
+    reader = stream_reader;
+    return Status::OK();
+  } else {
+    return Status::Invalid("Object " + VYObjectIDToString(id) + " of type " +
+                           object->meta().GetTypeName() +
+                           " cannot be served as a flight");
+  }
+  reader = std::make_shared<ObjectBatchReader>(object, schema,
+                                               std::move(batches));
+  return Status::OK();
+}
+
+bool isObjectID(std::string const& key) {
+  if (key.size() != 16) {
+    return false;
+  }
+  for (char c : key) {
+    if (!std::isxdigit(static_cast<unsigned char>(c))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status makeLocation(std::map<InstanceID, ptree> const& cluster,
+                    InstanceID const instance_id, int const port,
+                    flight::Location& location) {
+  auto iter = cluster.find(instance_id);
+  if (iter == cluster.end()) {
+    return Status::Invalid("Instance not found: " +
+                           std::to_string(instance_id));
+  }
+  std::string host = iter->second.get<std::string>("hostname", "localhost");
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 8000000
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(location,
+                                   flight::Location::ForGrpcTcp(host, port));
+#else
+  RETURN_ON_ARROW_ERROR(flight::Location::ForGrpcTcp(host, port, &location));
+#endif
+  return Status::OK();
+}
+
+std::string const kFlightTypePattern =
+    "vineyard::(Table|RecordBatch|DataFrame|GlobalDataFrame|DataframeStream)";
+
+}  // namespace
+
+Status FlightServer::Listen(std::string const& host) {
+  flight::Location location;
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 8000000
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(location,
+                                   flight::Location::ForGrpcTcp(host, port_));
+#else
+  RETURN_ON_ARROW_ERROR(flight::Location::ForGrpcTcp(host, port_, &location));
+#endif
+  flight::FlightServerOptions options(location);
+  RETURN_ON_ARROW_ERROR(Init(options));
+  return Status::OK();
+}
+
+arrow::Status FlightServer::ListFlights(
+    const flight::ServerCallContext& context, const flight::Criteria* criteria,
+    std::unique_ptr<flight::FlightListing>* listings) {
+  std::vector<flight::FlightInfo> flights;
+  std::string cursor;
+  do {
+    std::unordered_map<ObjectID, ptree> page;
+    RETURN_ON_VINEYARD_ERROR(
+        client_.ListData(kFlightTypePattern, true, 1000, cursor, page));
+    for (auto const& item : page) {
+      std::unique_ptr<flight::FlightInfo> info;
+      auto descriptor =
+          flight::FlightDescriptor::Path({VYObjectIDToString(item.first)});
+      // the objects that live in other instances are listed by their own
+      // flight servers
+      if (makeFlightInfo(descriptor, item.first, info).ok()) {
+        flights.emplace_back(std::move(*info));
+      }
+    }
+  } while (!cursor.empty());
+  listings->reset(new flight::SimpleFlightListing(std::move(flights)));
+  return arrow::Status::OK();
+}
+
+arrow::Status FlightServer::GetFlightInfo(
+    const flight::ServerCallContext& context,
+    const flight::FlightDescriptor& request,
+    std::unique_ptr<flight::FlightInfo>* info) {
+  ObjectID id = InvalidObjectID();
+  RETURN_ON_VINEYARD_ERROR(resolve(request, id));
+  RETURN_ON_VINEYARD_ERROR(makeFlightInfo(request, id, *info));
+  return arrow::Status::OK();
+}
+
+arrow::Status FlightServer::DoGet(
+    const flight::ServerCallContext& context, const flight::Ticket& request,
+    std::unique_ptr<flight::FlightDataStream>* stream) {
+  if (!isObjectID(request.ticket)) {
+    return arrow::Status::Invalid("Invalid ticket: " + request.ticket);
+  }
+  std::shared_ptr<arrow::RecordBatchReader> reader;
+  RETURN_ON_VINEYARD_ERROR(openObjectReader(
+      client_, VYObjectIDFromString(request.ticket), reader));
+  stream->reset(new flight::RecordBatchStream(reader));
+  return arrow::Status::OK();
+}
+
+Status FlightServer::resolve(flight::FlightDescriptor const& descriptor,
+                             ObjectID& id) {
+  if (descriptor.type != flight::FlightDescriptor::PATH ||
+      descriptor.path.size() != 1) {
+    return Status::Invalid(
+        "The flight descriptor must be the path of an object id or a name");
+  }
+  auto const& key = descriptor.path[0];
+  if (isObjectID(key)) {
+    id = VYObjectIDFromString(key);
+    return Status::OK();
+  }
+  return client_.GetName(key, id);
+}
+
+Status FlightServer::makeFlightInfo(
+    flight::FlightDescriptor const& descriptor, ObjectID const id,
+    std::unique_ptr<flight::FlightInfo>& info) {
+  ObjectMeta meta;
+  RETURN_ON_ERROR(client_.GetMetaData(id, meta, true));
+  std::map<InstanceID, ptree> cluster;
+  RETURN_ON_ERROR(client_.ClusterInfo(cluster));
+  std::shared_ptr<arrow::Schema> schema;
+  int64_t total_records = -1;
+  std::vector<flight::FlightEndpoint> endpoints;
+  if (meta.GetTypeName() == type_name<GlobalDataFrame>()) {
+    // an endpoint per partition, at where the partition lives
+    auto partitions = meta.GetMemberMeta("objects_");
+    size_t num_partitions = partitions.GetKeyValue<size_t>("num_of_objects");
+    for (size_t index = 0; index < num_partitions; ++index) {
+      auto partition =
+          partitions.GetMemberMeta("object_" + std::to_string(index));
+      flight::FlightEndpoint endpoint;
+      endpoint.ticket.ticket = VYObjectIDToString(partition.GetId());
+      flight::Location partition_location;
+      RETURN_ON_ERROR(makeLocation(cluster, partition.GetInstanceId(), port_,
+                                   partition_location));
+      endpoint.locations.emplace_back(partition_location);
+      endpoints.emplace_back(std::move(endpoint));
+      if (schema == nullptr &&
+          partition.GetInstanceId() == client_.instance_id()) {
+        std::shared_ptr<arrow::RecordBatchReader> reader;
+        RETURN_ON_ERROR(openObjectReader(client_, partition.GetId(), reader));
+        schema = reader->schema();
+      }
+    }
+    if (schema == nullptr) {
+      // none of the partitions is local, the consumers get the schema from
+      // the streams
+      schema = arrow::schema({});
+    }
+  } else {
+    if (meta.GetTypeName() != type_name<DataframeStream>()) {
+      std::shared_ptr<arrow::RecordBatchReader> reader;
+      RETURN_ON_ERROR(openObjectReader(client_, id, reader));
+      schema = reader->schema();
+      if (meta.Haskey("num_rows_")) {
+        total_records = meta.GetKeyValue<int64_t>("num_rows_");
+      } else if (meta.Haskey("row_num_")) {
+        total_records = meta.GetKeyValue<int64_t>("row_num_");
+      }
+    } else {
+      // the schema is known only after the first chunk has been consumed
+      schema = arrow::schema({});
+    }
+    flight::FlightEndpoint endpoint;
+    endpoint.ticket.ticket = VYObjectIDToString(id);
+    flight::Location self_location;
+    RETURN_ON_ERROR(
+        makeLocation(cluster, client_.instance_id(), port_, self_location));
+    endpoint.locations.emplace_back(self_location);
+    endpoints.emplace_back(std::move(endpoint));
+  }
+  auto result = flight::FlightInfo::Make(*schema, descriptor, endpoints,
+                                         total_records, -1);
+  if (!result.ok()) {
+    return Status::ArrowError(result.status());
+  }
+  info.reset(new flight::FlightInfo(std::move(result).ValueOrDie()));
+  return Status::OK();
+}
+
+}  // namespace vineyard
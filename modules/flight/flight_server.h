@@ -0,0 +1,90 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_FLIGHT_FLIGHT_SERVER_H_
+#define MODULES_FLIGHT_FLIGHT_SERVER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/flight/api.h"
+
+#include "client/client.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief FlightServer exposes the objects of the co-located vineyardd to
+ * Arrow Flight clients (e.g., Spark, DuckDB, pyarrow), which don't speak the
+ * vineyard protocol.
+ *
+ * The server reads the objects through the IPC client, thus the record
+ * batches are serialized to the wire straight from the shared memory blobs,
+ * without an exported copy. The flights are:
+ *
+ *  - `Table`, `RecordBatch` and `DataFrame`: a single endpoint,
+ *  - `DataframeStream`: a single endpoint that streams the chunks as they
+ *    are written, which can be consumed once,
+ *  - `GlobalDataFrame`: an endpoint per partition, located at the flight
+ *    server of the instance where the partition lives, thus the consumers
+ *    can read the partitions in parallel and locally. The flight servers of
+ *    the cluster are expected to listen on the same port.
+ *
+ * The flight descriptor is a path of one component: the object id (16 hex
+ * digits, as in the tickets), or a name that has been put to vineyard.
+ */
+class FlightServer : public arrow::flight::FlightServerBase {
+ public:
+  FlightServer(Client& client, int const port)
+      : client_(client), port_(port) {}
+
+  /**
+   * @brief Listen on the host and the port, then `Serve` (of
+   * `FlightServerBase`) blocks until the server is shutdown.
+   */
+  Status Listen(std::string const& host);
+
+  arrow::Status ListFlights(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::Criteria* criteria,
+      std::unique_ptr<arrow::flight::FlightListing>* listings) override;
+
+  arrow::Status GetFlightInfo(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::FlightDescriptor& request,
+      std::unique_ptr<arrow::flight::FlightInfo>* info) override;
+
+  arrow::Status DoGet(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::Ticket& request,
+      std::unique_ptr<arrow::flight::FlightDataStream>* stream) override;
+
+ private:
+  Status resolve(arrow::flight::FlightDescriptor const& descriptor,
+                 ObjectID& id);
+
+  Status makeFlightInfo(arrow::flight::FlightDescriptor const& descriptor,
+                        ObjectID const id,
+                        std::unique_ptr<arrow::flight::FlightInfo>& info);
+
+  Client& client_;
+  int port_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_FLIGHT_FLIGHT_SERVER_H_
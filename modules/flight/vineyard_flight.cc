@@ -0,0 +1,54 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <signal.h>
+
+#include <gflags/gflags.h>
+
+#include "client/client.h"
+#include "common/util/flags.h"
+#include "common/util/logging.h"
+#include "flight/flight_server.h"
+
+DEFINE_string(ipc_socket, "", "ipc socket of the co-located vineyard server");
+DEFINE_string(flight_host, "0.0.0.0", "host that the flight server binds");
+DEFINE_int32(flight_port, 9601,
+             "port of the flight server, which should be the same on all "
+             "instances of the cluster");
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char* argv[]) {
+  sigset(SIGINT, SIG_DFL);
+  FLAGS_stderrthreshold = 0;
+  flags::SetUsageMessage("Usage: vineyard_flight [options]");
+  flags::ParseCommandLineFlags(&argc, &argv, true);
+  logging::InitGoogleLogging("vineyard_flight");
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(FLAGS_ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << FLAGS_ipc_socket;
+
+  FlightServer server(client, FLAGS_flight_port);
+  VINEYARD_CHECK_OK(server.Listen(FLAGS_flight_host));
+  LOG(INFO) << "Serving arrow flight at " << FLAGS_flight_host << ":"
+            << FLAGS_flight_port;
+  auto status = server.Serve();
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to serve the arrow flight: " << status.ToString();
+    return 1;
+  }
+  return 0;
+}
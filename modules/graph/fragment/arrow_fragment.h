@@ -17,10 +17,15 @@ limitations under the License.
 #define MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_H_
 
 #include <algorithm>
+#include <cstring>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -44,6 +49,7 @@ limitations under the License.
 #include "graph/utils/context_protocols.h"
 #include "graph/utils/error.h"
 #include "graph/utils/selector_utils.h"
+#include "graph/utils/thread_group.h"
 #include "graph/utils/transform_utils.h"
 #include "graph/vertex_map/arrow_vertex_map.h"
 
@@ -59,6 +65,12 @@ namespace vineyard {
 template <typename OID_T, typename VID_T>
 class ArrowFragmentBuilder;
 
+template <typename OID_T, typename VID_T>
+class ArrowFragmentProjection;
+
+template <typename OID_T, typename VID_T>
+class ArrowFragmentProjectionBuilder;
+
 inline std::string generate_name_with_suffix(
     const std::string& prefix, property_graph_types::LABEL_ID_TYPE label) {
   return prefix + "_" + std::to_string(label);
@@ -154,6 +166,9 @@ inline const void* get_arrow_array_ptr(std::shared_ptr<arrow::Array> array) {
   } else if (array->type()->Equals(arrow::utf8())) {
     return reinterpret_cast<const void*>(
         std::dynamic_pointer_cast<arrow::StringArray>(array).get());
+  } else if (array->type()->id() == arrow::Type::DICTIONARY) {
+    return reinterpret_cast<const void*>(
+        std::dynamic_pointer_cast<arrow::DictionaryArray>(array).get());
   } else {
     LOG(FATAL) << "Array type - " << array->type()->ToString()
                << " is not supported yet...";
@@ -177,6 +192,10 @@ class ArrowFragment
   using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
   using adj_list_t = property_graph_utils::AdjList<vid_t, eid_t>;
   using raw_adj_list_t = property_graph_utils::RawAdjList<vid_t, eid_t>;
+  using compact_adj_list_t =
+      property_graph_utils::CompactAdjList<vid_t, eid_t>;
+  using merged_nbr_unit_t = property_graph_utils::MergedNbrUnit<vid_t, eid_t>;
+  using merged_adj_list_t = property_graph_utils::MergedAdjList<vid_t, eid_t>;
   using vertex_map_t = ArrowVertexMap<internal_oid_t, vid_t>;
   using vertex_t = grape::Vertex<vid_t>;
 
@@ -260,7 +279,7 @@ class ArrowFragment
     this->vertex_label_num_ = meta.GetKeyValue<label_id_t>("vertex_label_num");
     this->edge_label_num_ = meta.GetKeyValue<label_id_t>("edge_label_num");
 
-    this->schema_.FromJSONString(meta.GetKeyValue("schema"));
+    this->schema_.FromCachedJSONString(meta.GetKeyValue("schema"));
 
     vid_parser_.Init(fnum_, vertex_label_num_);
 
@@ -294,6 +313,80 @@ class ArrowFragment
     }
     CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, oe_offsets_lists_, vertex_label_num_,
                                   edge_label_num_, "oe_offsets_lists");
+
+    this->compact_edges_ = meta.Haskey("compact_edges") &&
+                           (meta.GetKeyValue<int>("compact_edges") != 0);
+    if (compact_edges_) {
+      if (directed_) {
+        CONSTRUCT_ARRAY_VECTOR_VECTOR(uint8_t, compact_ie_lists_,
+                                      vertex_label_num_, edge_label_num_,
+                                      "compact_ie_lists");
+        CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, compact_ie_offsets_lists_,
+                                      vertex_label_num_, edge_label_num_,
+                                      "compact_ie_offsets_lists");
+      }
+      CONSTRUCT_ARRAY_VECTOR_VECTOR(uint8_t, compact_oe_lists_,
+                                    vertex_label_num_, edge_label_num_,
+                                    "compact_oe_lists");
+      CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, compact_oe_offsets_lists_,
+                                    vertex_label_num_, edge_label_num_,
+                                    "compact_oe_offsets_lists");
+    }
+    this->delta_edges_ = meta.Haskey("delta_edges") &&
+                         (meta.GetKeyValue<int>("delta_edges") != 0);
+    if (delta_edges_) {
+      CONSTRUCT_TABLE_VECTOR(delta_edge_tables_, edge_label_num_,
+                             "delta_edge_tables");
+      if (directed_) {
+        CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, delta_ie_vertices_lists_,
+                                      vertex_label_num_, edge_label_num_,
+                                      "delta_ie_vertices");
+        CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, delta_ie_offsets_lists_,
+                                      vertex_label_num_, edge_label_num_,
+                                      "delta_ie_offsets");
+        CONSTRUCT_BINARY_ARRAY_VECTOR_VECTOR(delta_ie_lists_,
+                                             vertex_label_num_,
+                                             edge_label_num_, "delta_ie_lists");
+      }
+      CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, delta_oe_vertices_lists_,
+                                    vertex_label_num_, edge_label_num_,
+                                    "delta_oe_vertices");
+      CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, delta_oe_offsets_lists_,
+                                    vertex_label_num_, edge_label_num_,
+                                    "delta_oe_offsets");
+      CONSTRUCT_BINARY_ARRAY_VECTOR_VECTOR(delta_oe_lists_, vertex_label_num_,
+                                           edge_label_num_, "delta_oe_lists");
+    }
+    this->merged_edges_ = meta.Haskey("merged_edges") &&
+                          (meta.GetKeyValue<int>("merged_edges") != 0);
+    if (merged_edges_) {
+      if (directed_) {
+        constructMergedLists(meta, "merged_ie", merged_ie_lists_,
+                             merged_ie_offsets_lists_);
+      }
+      constructMergedLists(meta, "merged_oe", merged_oe_lists_,
+                           merged_oe_offsets_lists_);
+    }
+    this->degree_statistics_ =
+        meta.Haskey("degree_statistics") &&
+        (meta.GetKeyValue<int>("degree_statistics") != 0);
+    if (degree_statistics_) {
+      CONSTRUCT_ARRAY_VECTOR(uint32_t, out_degree_lists_, vertex_label_num_,
+                             "out_degrees");
+      CONSTRUCT_ARRAY_VECTOR(int64_t, out_degree_histograms_,
+                             vertex_label_num_, "out_degree_histogram");
+      if (directed_) {
+        CONSTRUCT_ARRAY_VECTOR(uint32_t, in_degree_lists_, vertex_label_num_,
+                               "in_degrees");
+        CONSTRUCT_ARRAY_VECTOR(int64_t, in_degree_histograms_,
+                               vertex_label_num_, "in_degree_histogram");
+      }
+    }
+
+    this->numa_replicas_ = meta.Haskey("numa_replicas")
+                               ? meta.GetKeyValue<int>("numa_replicas")
+                               : 0;
+
     vm_ptr_ = std::make_shared<vertex_map_t>();
     vm_ptr_->Construct(meta.GetMemberMeta("vertex_map"));
 
@@ -427,11 +520,105 @@ class ArrowFragment
   }
 
   int GetLocalOutDegree(const vertex_t& v, label_id_t e_label) const {
-    return GetOutgoingAdjList(v, e_label).Size();
+    const int64_t* offset_array = nullptr;
+    const nbr_unit_t* oe = nullptr;
+    outgoingTopology(vertex_label(v), e_label, offset_array, oe);
+    int64_t v_offset = vertex_offset(v);
+    return offset_array[v_offset + 1] - offset_array[v_offset];
   }
 
   int GetLocalInDegree(const vertex_t& v, label_id_t e_label) const {
-    return GetIncomingAdjList(v, e_label).Size();
+    const int64_t* offset_array = nullptr;
+    const nbr_unit_t* ie = nullptr;
+    incomingTopology(vertex_label(v), e_label, offset_array, ie);
+    int64_t v_offset = vertex_offset(v);
+    return offset_array[v_offset + 1] - offset_array[v_offset];
+  }
+
+  /**
+   * @brief Whether the fragment has the degree statistics that are computed
+   * when it is sealed, see also `ArrowFragmentBuilder::set_degree_statistics`.
+   *
+   * The statistics are kept by `AddEdges` and `AddVertexColumns`, where the
+   * delta edges are not counted (as `GetLocalOutDegree`), and are dropped by
+   * `CompactEdges`.
+   */
+  bool has_degree_statistics() const { return degree_statistics_; }
+
+  /**
+   * @brief The out degree of the inner vertex over all edge labels, which is
+   * O(1) with the degree statistics, and O(edge_label_num) otherwise.
+   */
+  int64_t GetLocalOutDegree(const vertex_t& v) const {
+    if (degree_statistics_) {
+      return out_degrees_ptr_lists_[vertex_label(v)][vertex_offset(v)];
+    }
+    int64_t degree = 0;
+    for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+      degree += GetLocalOutDegree(v, e_label);
+    }
+    return degree;
+  }
+
+  /**
+   * @brief The in degree of the inner vertex over all edge labels, see also
+   * `GetLocalOutDegree(v)`.
+   */
+  int64_t GetLocalInDegree(const vertex_t& v) const {
+    if (degree_statistics_) {
+      return in_degrees_ptr_lists_[vertex_label(v)][vertex_offset(v)];
+    }
+    int64_t degree = 0;
+    for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+      degree += GetLocalInDegree(v, e_label);
+    }
+    return degree;
+  }
+
+  /**
+   * @brief The number of buckets of the degree histograms: the bucket 0
+   * counts the inner vertices of degree 0, and the bucket `b` counts the
+   * ones of degree in `[2^(b-1), 2^b)`.
+   */
+  static constexpr int degree_histogram_buckets = 33;
+
+  /**
+   * @brief The histogram of the out degrees (over all edge labels) of the
+   * inner vertices of the label, which has `degree_histogram_buckets`
+   * buckets, nullptr without the degree statistics.
+   */
+  const int64_t* out_degree_histogram(label_id_t v_label) const {
+    if (!degree_statistics_) {
+      return nullptr;
+    }
+    return out_degree_histograms_[v_label]->raw_values();
+  }
+
+  /**
+   * @brief The histogram of the in degrees, see also `out_degree_histogram`.
+   */
+  const int64_t* in_degree_histogram(label_id_t v_label) const {
+    if (!degree_statistics_) {
+      return nullptr;
+    }
+    return (directed_ ? in_degree_histograms_ : out_degree_histograms_)[v_label]
+        ->raw_values();
+  }
+
+  /**
+   * @brief The number of the outgoing edges of the label from the inner
+   * vertices of the vertex label, excluding the delta edges.
+   */
+  int64_t GetLocalOutEdgeNum(label_id_t v_label, label_id_t e_label) const {
+    return oe_offsets_ptr_lists_[v_label][e_label][ivnums_[v_label]];
+  }
+
+  /**
+   * @brief The number of the incoming edges of the label to the inner
+   * vertices of the vertex label, excluding the delta edges.
+   */
+  int64_t GetLocalInEdgeNum(label_id_t v_label, label_id_t e_label) const {
+    return ie_offsets_ptr_lists_[v_label][e_label][ivnums_[v_label]];
   }
 
   // FIXME: grape message buffer compatibility
@@ -539,8 +726,9 @@ class ArrowFragment
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
-    const int64_t* offset_array = ie_offsets_ptr_lists_[v_label][e_label];
-    const nbr_unit_t* ie = ie_ptr_lists_[v_label][e_label];
+    const int64_t* offset_array = nullptr;
+    const nbr_unit_t* ie = nullptr;
+    incomingTopology(v_label, e_label, offset_array, ie);
     return adj_list_t(&ie[offset_array[v_offset]],
                       &ie[offset_array[v_offset + 1]],
                       flatten_edge_tables_columns_[e_label]);
@@ -551,8 +739,9 @@ class ArrowFragment
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
-    const int64_t* offset_array = ie_offsets_ptr_lists_[v_label][e_label];
-    const nbr_unit_t* ie = ie_ptr_lists_[v_label][e_label];
+    const int64_t* offset_array = nullptr;
+    const nbr_unit_t* ie = nullptr;
+    incomingTopology(v_label, e_label, offset_array, ie);
     return raw_adj_list_t(&ie[offset_array[v_offset]],
                           &ie[offset_array[v_offset + 1]]);
   }
@@ -562,8 +751,9 @@ class ArrowFragment
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
-    const int64_t* offset_array = oe_offsets_ptr_lists_[v_label][e_label];
-    const nbr_unit_t* oe = oe_ptr_lists_[v_label][e_label];
+    const int64_t* offset_array = nullptr;
+    const nbr_unit_t* oe = nullptr;
+    outgoingTopology(v_label, e_label, offset_array, oe);
     return adj_list_t(&oe[offset_array[v_offset]],
                       &oe[offset_array[v_offset + 1]],
                       flatten_edge_tables_columns_[e_label]);
@@ -574,34 +764,142 @@ class ArrowFragment
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
-    const int64_t* offset_array = oe_offsets_ptr_lists_[v_label][e_label];
-    const nbr_unit_t* oe = oe_ptr_lists_[v_label][e_label];
+    const int64_t* offset_array = nullptr;
+    const nbr_unit_t* oe = nullptr;
+    outgoingTopology(v_label, e_label, offset_array, oe);
     return raw_adj_list_t(&oe[offset_array[v_offset]],
                           &oe[offset_array[v_offset + 1]]);
   }
 
+  /**
+   * @brief Whether the adjacency lists are stored in the compact encoding,
+   * where the sorted neighbors are delta-varint encoded and the eids are
+   * stored with a fixed width. The adjacency lists of such fragments can
+   * only be accessed by `GetIncomingCompactAdjList` and
+   * `GetOutgoingCompactAdjList`, rather than the `NbrUnit`-based ones.
+   */
+  bool compact_edges() const { return compact_edges_; }
+
+  inline compact_adj_list_t GetIncomingCompactAdjList(
+      const vertex_t& v, label_id_t e_label) const {
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = nullptr;
+    const nbr_unit_t* nbrs = nullptr;
+    incomingTopology(v_label, e_label, offset_array, nbrs);
+    const int64_t* byte_offsets =
+        compact_ie_offsets_ptr_lists_[v_label][e_label];
+    const uint8_t* ie = compact_ie_ptr_lists_[v_label][e_label];
+    return compact_adj_list_t(
+        ie + byte_offsets[v_offset], ie + byte_offsets[tvnums_[v_label]],
+        offset_array[v_offset + 1] - offset_array[v_offset],
+        compact_eid_widths_[e_label], flatten_edge_tables_columns_[e_label]);
+  }
+
+  inline compact_adj_list_t GetOutgoingCompactAdjList(
+      const vertex_t& v, label_id_t e_label) const {
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = nullptr;
+    const nbr_unit_t* nbrs = nullptr;
+    outgoingTopology(v_label, e_label, offset_array, nbrs);
+    const int64_t* byte_offsets =
+        compact_oe_offsets_ptr_lists_[v_label][e_label];
+    const uint8_t* oe = compact_oe_ptr_lists_[v_label][e_label];
+    return compact_adj_list_t(
+        oe + byte_offsets[v_offset], oe + byte_offsets[tvnums_[v_label]],
+        offset_array[v_offset + 1] - offset_array[v_offset],
+        compact_eid_widths_[e_label], flatten_edge_tables_columns_[e_label]);
+  }
+
+  /**
+   * @brief Whether the fragment has the merged adjacency lists, where the
+   * edges of all edge labels of a vertex are in one contiguous range, ordered
+   * by the edge labels, see also `GetOutgoingMergedAdjList`.
+   *
+   * The merged lists are kept by `AddEdges` and `AddVertexColumns`, where the
+   * delta edges are not included, and are dropped by `CompactEdges`.
+   */
+  bool merged_edges() const { return merged_edges_; }
+
+  inline merged_adj_list_t GetIncomingMergedAdjList(const vertex_t& v) const {
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = merged_ie_offsets_ptr_lists_[v_label];
+    const merged_nbr_unit_t* ie = merged_ie_ptr_lists_[v_label];
+    return merged_adj_list_t(&ie[offset_array[v_offset]],
+                             &ie[offset_array[v_offset + 1]],
+                             flatten_edge_tables_columns_.data());
+  }
+
+  inline merged_adj_list_t GetOutgoingMergedAdjList(const vertex_t& v) const {
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = merged_oe_offsets_ptr_lists_[v_label];
+    const merged_nbr_unit_t* oe = merged_oe_ptr_lists_[v_label];
+    return merged_adj_list_t(&oe[offset_array[v_offset]],
+                             &oe[offset_array[v_offset + 1]],
+                             flatten_edge_tables_columns_.data());
+  }
+
+  /**
+   * @brief Whether the fragment has the edges added by `AddEdges` that are
+   * not merged into the CSR by `CompactEdges` yet. Such edges are accessed by
+   * `GetIncomingDeltaAdjList` and `GetOutgoingDeltaAdjList`, and are not
+   * counted by `GetLocalInDegree` and `GetLocalOutDegree`.
+   */
+  bool has_delta_edges() const { return delta_edges_; }
+
+  std::shared_ptr<arrow::Table> delta_edge_data_table(label_id_t i) const {
+    return delta_edge_tables_[i];
+  }
+
+  /**
+   * @brief Get the incoming delta edges of the vertex, whose eids are the
+   * row indices of `delta_edge_data_table`.
+   */
+  inline adj_list_t GetIncomingDeltaAdjList(const vertex_t& v,
+                                            label_id_t e_label) const {
+    if (!directed_) {
+      return GetOutgoingDeltaAdjList(v, e_label);
+    }
+    return getDeltaAdjList(v, e_label, delta_ie_vertices_lists_,
+                           delta_ie_offsets_lists_, delta_ie_lists_);
+  }
+
+  inline adj_list_t GetOutgoingDeltaAdjList(const vertex_t& v,
+                                            label_id_t e_label) const {
+    return getDeltaAdjList(v, e_label, delta_oe_vertices_lists_,
+                           delta_oe_offsets_lists_, delta_oe_lists_);
+  }
+
+  /**
+   * @brief The destination fragments of the incoming edges of an inner vertex.
+   *
+   * The destination lists of a pair of vertex label and edge label are built
+   * on the first use, the same for `OEDests` and `IOEDests`.
+   */
   inline grape::DestList IEDests(const vertex_t& v, label_id_t e_label) const {
     int64_t offset = vid_parser_.GetOffset(v.GetValue());
-    auto v_label = vertex_label(v);
-
-    return grape::DestList(idoffset_[v_label][e_label][offset],
-                           idoffset_[v_label][e_label][offset + 1]);
+    auto const& offsets = destFidOffsets(kInDests, vertex_label(v), e_label);
+    return grape::DestList(offsets[offset], offsets[offset + 1]);
   }
 
   inline grape::DestList OEDests(const vertex_t& v, label_id_t e_label) const {
     int64_t offset = vid_parser_.GetOffset(v.GetValue());
-    auto v_label = vertex_label(v);
-
-    return grape::DestList(odoffset_[v_label][e_label][offset],
-                           odoffset_[v_label][e_label][offset + 1]);
+    auto const& offsets = destFidOffsets(kOutDests, vertex_label(v), e_label);
+    return grape::DestList(offsets[offset], offsets[offset + 1]);
   }
 
   inline grape::DestList IOEDests(const vertex_t& v, label_id_t e_label) const {
     int64_t offset = vid_parser_.GetOffset(v.GetValue());
-    auto v_label = vertex_label(v);
-
-    return grape::DestList(iodoffset_[v_label][e_label][offset],
-                           iodoffset_[v_label][e_label][offset + 1]);
+    auto const& offsets =
+        destFidOffsets(kInOutDests, vertex_label(v), e_label);
+    return grape::DestList(offsets[offset], offsets[offset + 1]);
   }
 
   bool directed() const { return directed_; }
@@ -610,16 +908,11 @@ class ArrowFragment
 
   const PropertyGraphSchema& schema() const { return schema_; }
 
+  /**
+   * @brief Nothing needs to be prepared, the destination lists used by the
+   * message strategies are built on the first use, see also `IEDests`.
+   */
   void PrepareToRunApp(grape::MessageStrategy strategy, bool need_split_edges) {
-    if (strategy == grape::MessageStrategy::kAlongEdgeToOuterVertex) {
-      initDestFidList(true, true, iodst_, iodoffset_);
-    } else if (strategy ==
-               grape::MessageStrategy::kAlongIncomingEdgeToOuterVertex) {
-      initDestFidList(true, false, idst_, idoffset_);
-    } else if (strategy ==
-               grape::MessageStrategy::kAlongOutgoingEdgeToOuterVertex) {
-      initDestFidList(false, true, odst_, odoffset_);
-    }
   }
 
 #define ASSIGNE_IDENTICAL_VEC_META(prefix, num)               \
@@ -759,6 +1052,24 @@ class ArrowFragment
                                    edge_label_num_);
     ASSIGNE_IDENTICAL_VEC_VEC_META("oe_offsets_lists", vertex_label_num_,
                                    edge_label_num_);
+    if (compact_edges_) {
+      new_meta.AddKeyValue("compact_edges", 1);
+      if (directed_) {
+        ASSIGNE_IDENTICAL_VEC_VEC_META("compact_ie_lists", vertex_label_num_,
+                                       edge_label_num_);
+        ASSIGNE_IDENTICAL_VEC_VEC_META("compact_ie_offsets_lists",
+                                       vertex_label_num_, edge_label_num_);
+      }
+      ASSIGNE_IDENTICAL_VEC_VEC_META("compact_oe_lists", vertex_label_num_,
+                                     edge_label_num_);
+      ASSIGNE_IDENTICAL_VEC_VEC_META("compact_oe_offsets_lists",
+                                     vertex_label_num_, edge_label_num_);
+    }
+
+    if (delta_edges_) {
+      copyDeltaEdgesMeta(old_meta, new_meta, nbytes);
+    }
+    copyTopologyReplicasMeta(old_meta, new_meta, nbytes);
 
     new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
 
@@ -769,6 +1080,237 @@ class ArrowFragment
     return ret;
   }
 
+  /**
+   * @brief Add the edges to a new version of the fragment, which shares the
+   * vertices, the CSR and the vertex map with this fragment.
+   *
+   * The new edges are merged with the existing delta edges (if any) into a
+   * delta segment, rather than rebuilding the CSR, thus the cost is
+   * proportional to the number of delta edges rather than the whole graph.
+   * The delta segment is merged into the CSR by `CompactEdges`.
+   *
+   * @param edge_tables The edges of each edge label, where the first two
+   * columns are the gids of the source and destination vertices, followed by
+   * the edge properties, i.e., the same as the edge tables accepted by
+   * `BasicArrowFragmentBuilder::Init`. The endpoints must be inner vertices
+   * or existing outer vertices of this fragment, and at least one of them is
+   * an inner vertex.
+   */
+  boost::leaf::result<vineyard::ObjectID> AddEdges(
+      vineyard::Client& client,
+      const std::map<label_id_t, std::shared_ptr<arrow::Table>>& edge_tables) {
+    for (auto const& pair : edge_tables) {
+      if (pair.first < 0 || pair.first >= edge_label_num_) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "Invalid edge label: " + std::to_string(pair.first));
+      }
+    }
+    vineyard::ObjectMeta old_meta, new_meta;
+    VY_OK_OR_RAISE(client.GetMetaData(this->id_, old_meta));
+    size_t nbytes = 0;
+    copyFragmentMeta(old_meta, new_meta, nbytes, true);
+    new_meta.AddKeyValue("delta_edges", 1);
+
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      auto iter = edge_tables.find(j);
+      if (iter == edge_tables.end() && delta_edges_) {
+        // the delta segment of the edge label is unchanged
+        std::vector<std::string> names{
+            generate_name_with_suffix("delta_edge_tables", j)};
+        for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+          for (auto const& prefix : {"delta_ie", "delta_oe"}) {
+            if (!directed_ && prefix == std::string("delta_ie")) {
+              continue;
+            }
+            for (auto const& suffix : {"_vertices", "_offsets", "_lists"}) {
+              names.push_back(generate_name_with_suffix(
+                  std::string(prefix) + suffix, i, j));
+            }
+          }
+        }
+        for (auto const& name : names) {
+          new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+          nbytes += old_meta.GetMemberMeta(name).GetNBytes();
+        }
+        continue;
+      }
+
+      // the delta edges of each vertex label, as (vertex offset, nbr) pairs
+      std::vector<delta_edges_t> oe_deltas(vertex_label_num_),
+          ie_deltas(vertex_label_num_);
+      std::vector<std::shared_ptr<arrow::Table>> delta_tables;
+      eid_t eid_begin = 0;
+      if (delta_edges_) {
+        collectDeltaEdges(j, delta_oe_vertices_lists_, delta_oe_offsets_lists_,
+                          delta_oe_lists_, oe_deltas);
+        if (directed_) {
+          collectDeltaEdges(j, delta_ie_vertices_lists_,
+                            delta_ie_offsets_lists_, delta_ie_lists_,
+                            ie_deltas);
+        }
+        delta_tables.push_back(delta_edge_tables_[j]);
+        eid_begin = delta_edge_tables_[j]->num_rows();
+      }
+      if (iter != edge_tables.end()) {
+        BOOST_LEAF_AUTO(table, mapDeltaEdges(j, iter->second, eid_begin,
+                                             oe_deltas, ie_deltas));
+        delta_tables.push_back(table);
+      }
+      if (delta_tables.empty()) {
+        delta_tables.push_back(edge_tables_[j]->Slice(0, 0));
+      }
+      BOOST_LEAF_AUTO(delta_table, concatenateTables(delta_tables));
+      vineyard::TableBuilder table_builder(client, delta_table);
+      auto table = table_builder.Seal(client);
+      new_meta.AddMember(generate_name_with_suffix("delta_edge_tables", j),
+                         table->meta());
+      nbytes += table->nbytes();
+
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        if (directed_) {
+          BOOST_LEAF_CHECK(sealDeltaEdges(client, "delta_ie", i, j,
+                                          ie_deltas[i], new_meta, nbytes));
+        }
+        BOOST_LEAF_CHECK(sealDeltaEdges(client, "delta_oe", i, j, oe_deltas[i],
+                                        new_meta, nbytes));
+      }
+    }
+
+    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+    new_meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID ret;
+    VY_OK_OR_RAISE(client.CreateMetaData(new_meta, ret));
+    return ret;
+  }
+
+  /**
+   * @brief Merge the delta edges into the CSR, and returns a new version of
+   * the fragment without delta edges, where the eids of the delta edges
+   * follow the eids of the existing edges.
+   *
+   * The fragment itself is left unchanged, thus the compaction can be run by
+   * a background thread while the fragment is still being queried.
+   */
+  boost::leaf::result<vineyard::ObjectID> CompactEdges(
+      vineyard::Client& client) {
+    if (!delta_edges_) {
+      return this->id_;
+    }
+    if (compact_edges_) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "Merging delta edges into the compact adjacency lists "
+                      "is not supported");
+    }
+    vineyard::ObjectMeta old_meta, new_meta;
+    VY_OK_OR_RAISE(client.GetMetaData(this->id_, old_meta));
+    size_t nbytes = 0;
+    copyFragmentMeta(old_meta, new_meta, nbytes, false);
+
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      std::vector<std::shared_ptr<arrow::Table>> tables{edge_tables_[j],
+                                                        delta_edge_tables_[j]};
+      BOOST_LEAF_AUTO(edge_table, concatenateTables(tables));
+      vineyard::TableBuilder table_builder(client, edge_table);
+      auto table = table_builder.Seal(client);
+      new_meta.AddMember(generate_name_with_suffix("edge_tables", j),
+                         table->meta());
+      nbytes += table->nbytes();
+
+      eid_t eid_begin = edge_tables_[j]->num_rows();
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        if (directed_) {
+          BOOST_LEAF_CHECK(mergeDeltaEdges(
+              client, "ie", i, j, eid_begin, ie_ptr_lists_[i][j],
+              ie_offsets_ptr_lists_[i][j], delta_ie_vertices_lists_[i][j],
+              delta_ie_offsets_lists_[i][j], delta_ie_lists_[i][j], new_meta,
+              nbytes));
+        }
+        BOOST_LEAF_CHECK(mergeDeltaEdges(
+            client, "oe", i, j, eid_begin, oe_ptr_lists_[i][j],
+            oe_offsets_ptr_lists_[i][j], delta_oe_vertices_lists_[i][j],
+            delta_oe_offsets_lists_[i][j], delta_oe_lists_[i][j], new_meta,
+            nbytes));
+      }
+    }
+
+    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+    new_meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID ret;
+    VY_OK_OR_RAISE(client.CreateMetaData(new_meta, ret));
+    return ret;
+  }
+
+  /**
+   * @brief Replicate the read-only topology, i.e., the offsets and the
+   * `NbrUnit` lists of the CSR, on every NUMA node as separate blobs, and
+   * returns a new version of the fragment with the replicas.
+   *
+   * The accessors of the adjacency lists and the local degrees then read the
+   * replica on the NUMA node of the calling thread (which is detected once
+   * per thread, thus the threads are expected to be pinned), and fall back
+   * to the original CSR on the other threads. The replicas cost the memory
+   * of a copy of the CSR on every NUMA node.
+   *
+   * The replicas are kept by `AddEdges` and `AddVertexColumns`, and are
+   * dropped by `CompactEdges`, which rebuilds the CSR.
+   *
+   * @param numa_nodes The number of NUMA nodes to replicate onto, -1 means
+   * all NUMA nodes of the host. Nothing is replicated on a single node.
+   */
+  boost::leaf::result<vineyard::ObjectID> ReplicateTopology(
+      vineyard::Client& client, int numa_nodes = -1) {
+    if (numa_nodes < 0) {
+      numa_nodes = GetNumaNodeCount();
+    }
+    if (numa_nodes <= 1) {
+      return this->id_;
+    }
+    vineyard::ObjectMeta old_meta, new_meta;
+    VY_OK_OR_RAISE(client.GetMetaData(this->id_, old_meta));
+    size_t nbytes = 0;
+    copyFragmentMeta(old_meta, new_meta, nbytes, true, false);
+    if (delta_edges_) {
+      copyDeltaEdgesMeta(old_meta, new_meta, nbytes);
+    }
+
+    new_meta.AddKeyValue("numa_replicas", numa_nodes);
+    for (int node = 0; node < numa_nodes; ++node) {
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        for (label_id_t j = 0; j < edge_label_num_; ++j) {
+          if (directed_) {
+            BOOST_LEAF_CHECK(replicateBuffer(
+                client, node, "ie_lists", i, j, ie_lists_[i][j]->values(),
+                new_meta, nbytes));
+            BOOST_LEAF_CHECK(replicateBuffer(
+                client, node, "ie_offsets_lists", i, j,
+                ie_offsets_lists_[i][j]->values(), new_meta, nbytes));
+          }
+          BOOST_LEAF_CHECK(replicateBuffer(client, node, "oe_lists", i, j,
+                                           oe_lists_[i][j]->values(),
+                                           new_meta, nbytes));
+          BOOST_LEAF_CHECK(replicateBuffer(
+              client, node, "oe_offsets_lists", i, j,
+              oe_offsets_lists_[i][j]->values(), new_meta, nbytes));
+        }
+      }
+    }
+
+    new_meta.AddMember("vertex_map", old_meta.GetMemberMeta("vertex_map"));
+    new_meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID ret;
+    VY_OK_OR_RAISE(client.CreateMetaData(new_meta, ret));
+    return ret;
+  }
+
+  /**
+   * @brief The number of NUMA nodes that the topology is replicated onto,
+   * see also `ReplicateTopology`.
+   */
+  int numa_replicas() const { return numa_replicas_; }
+
 #if defined(ENABLE_SELECTOR)
   void to_nd_array(grape::InArchive& arc, const grape::CommSpec& comm_spec,
                    const std::string& selector, const std::string& begin,
@@ -868,26 +1410,606 @@ class ArrowFragment
             CHECK(parse_property_id(tokens[2], cur_prop_id));
             CHECK_LT(cur_prop_id, graph_prop_num);
 
-            if (comm_spec.fid() == 0) {
-              arc << ArrowDataTypeToInt(
-                  vertex_property_type(label_id, cur_prop_id));
-            }
-            old_size = arc.GetSize();
-            serialize_vertex_property(arc, this, range, label_id, cur_prop_id);
-          }
+            if (comm_spec.fid() == 0) {
+              arc << ArrowDataTypeToInt(
+                  vertex_property_type(label_id, cur_prop_id));
+            }
+            old_size = arc.GetSize();
+            serialize_vertex_property(arc, this, range, label_id, cur_prop_id);
+          }
+        }
+
+        gather_archives(arc, comm_spec, old_size);
+      }
+    } else if (schema_type == SchemaType::kEdgePropertySchema) {
+      LOG(INFO) << "outputing graph edges not supported...";
+    } else {
+      LOG(INFO) << "selector schema invalid: " << selectors;
+    }
+  }
+#endif
+
+ private:
+  using delta_edges_t = std::vector<std::pair<int64_t, nbr_unit_t>>;
+
+  struct topology_replica_t {
+    std::vector<std::vector<const nbr_unit_t*>> ie_ptr_lists, oe_ptr_lists;
+    std::vector<std::vector<const int64_t*>> ie_offsets_ptr_lists,
+        oe_offsets_ptr_lists;
+  };
+
+  // copy the metadata that is left unchanged by `AddEdges` (when
+  // `with_edges`) or `CompactEdges`, except the vertex map
+  void copyFragmentMeta(const vineyard::ObjectMeta& old_meta,
+                        vineyard::ObjectMeta& new_meta, size_t& nbytes,
+                        bool with_edges, bool with_replicas = true) const {
+    new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
+    for (auto const& key :
+         {"fid", "fnum", "directed", "oid_type", "vid_type",
+          "vertex_label_num", "edge_label_num", "schema"}) {
+      new_meta.AddKeyValue(key, old_meta.GetKeyValue(key));
+    }
+    auto copy_labels = [&](const std::string& kind, label_id_t label_num) {
+      for (label_id_t i = 0; i < label_num; ++i) {
+        std::string suffix = "_" + std::to_string(i);
+        std::string label_key = kind + "_label_name" + suffix;
+        std::string num_key = kind + "_property_num" + suffix;
+        new_meta.AddKeyValue(label_key, old_meta.GetKeyValue(label_key));
+        new_meta.AddKeyValue(num_key, old_meta.GetKeyValue(num_key));
+        prop_id_t prop_num = old_meta.GetKeyValue<prop_id_t>(num_key);
+        for (prop_id_t k = 0; k < prop_num; ++k) {
+          std::string name_key =
+              kind + "_property_name" + suffix + "_" + std::to_string(k);
+          std::string type_key =
+              kind + "_property_type" + suffix + "_" + std::to_string(k);
+          new_meta.AddKeyValue(name_key, old_meta.GetKeyValue(name_key));
+          new_meta.AddKeyValue(type_key, old_meta.GetKeyValue(type_key));
+        }
+      }
+    };
+    copy_labels("vertex", vertex_label_num_);
+    copy_labels("edge", edge_label_num_);
+
+    for (auto const& name : {"ivnums", "ovnums", "tvnums"}) {
+      new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+      nbytes += old_meta.GetMemberMeta(name).GetNBytes();
+    }
+    ASSIGNE_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
+    ASSIGNE_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
+    ASSIGNE_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
+    if (!with_edges) {
+      return;
+    }
+
+    ASSIGNE_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    if (directed_) {
+      ASSIGNE_IDENTICAL_VEC_VEC_META("ie_lists", vertex_label_num_,
+                                     edge_label_num_);
+      ASSIGNE_IDENTICAL_VEC_VEC_META("ie_offsets_lists", vertex_label_num_,
+                                     edge_label_num_);
+    }
+    ASSIGNE_IDENTICAL_VEC_VEC_META("oe_lists", vertex_label_num_,
+                                   edge_label_num_);
+    ASSIGNE_IDENTICAL_VEC_VEC_META("oe_offsets_lists", vertex_label_num_,
+                                   edge_label_num_);
+    if (compact_edges_) {
+      new_meta.AddKeyValue("compact_edges", 1);
+      if (directed_) {
+        ASSIGNE_IDENTICAL_VEC_VEC_META("compact_ie_lists", vertex_label_num_,
+                                       edge_label_num_);
+        ASSIGNE_IDENTICAL_VEC_VEC_META("compact_ie_offsets_lists",
+                                       vertex_label_num_, edge_label_num_);
+      }
+      ASSIGNE_IDENTICAL_VEC_VEC_META("compact_oe_lists", vertex_label_num_,
+                                     edge_label_num_);
+      ASSIGNE_IDENTICAL_VEC_VEC_META("compact_oe_offsets_lists",
+                                     vertex_label_num_, edge_label_num_);
+    }
+    if (merged_edges_) {
+      new_meta.AddKeyValue("merged_edges", 1);
+      for (auto const& prefix : {"merged_ie", "merged_oe"}) {
+        if (!directed_ && std::string(prefix) == "merged_ie") {
+          continue;
+        }
+        ASSIGNE_IDENTICAL_VEC_META(std::string(prefix) + "_lists",
+                                   vertex_label_num_);
+        ASSIGNE_IDENTICAL_VEC_META(std::string(prefix) + "_offsets_lists",
+                                   vertex_label_num_);
+      }
+    }
+    if (degree_statistics_) {
+      copyDegreeStatisticsMeta(old_meta, new_meta, nbytes);
+    }
+    if (with_replicas) {
+      copyTopologyReplicasMeta(old_meta, new_meta, nbytes);
+    }
+  }
+
+  void copyTopologyReplicasMeta(const vineyard::ObjectMeta& old_meta,
+                                vineyard::ObjectMeta& new_meta,
+                                size_t& nbytes) const {
+    if (numa_replicas_ == 0) {
+      return;
+    }
+    new_meta.AddKeyValue("numa_replicas", numa_replicas_);
+    for (int node = 0; node < numa_replicas_; ++node) {
+      for (auto const& prefix : {"ie_lists", "ie_offsets_lists", "oe_lists",
+                                 "oe_offsets_lists"}) {
+        for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+          for (label_id_t j = 0; j < edge_label_num_; ++j) {
+            std::string name = replicaName(node, prefix, i, j);
+            // the empty lists are not replicated
+            if (old_meta.Haskey(name)) {
+              new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+              nbytes += old_meta.GetMemberMeta(name).GetNBytes();
+            }
+          }
+        }
+      }
+    }
+  }
+
+  static std::string replicaName(int node, const std::string& prefix,
+                                 label_id_t v_label, label_id_t e_label) {
+    return generate_name_with_suffix(
+        "numa_" + std::to_string(node) + "_" + prefix, v_label, e_label);
+  }
+
+  // copy the buffer to a blob on the NUMA node, as the replica of it
+  boost::leaf::result<void> replicateBuffer(
+      vineyard::Client& client, int node, const std::string& prefix,
+      label_id_t v_label, label_id_t e_label,
+      std::shared_ptr<arrow::Buffer> const& buffer,
+      vineyard::ObjectMeta& new_meta, size_t& nbytes) const {
+    if (buffer == nullptr || buffer->size() == 0) {
+      return {};
+    }
+    std::unique_ptr<vineyard::BlobWriter> writer;
+    VY_OK_OR_RAISE(client.CreateBlob(buffer->size(), writer, node));
+    memcpy(writer->data(), buffer->data(), buffer->size());
+    auto blob = writer->Seal(client);
+    new_meta.AddMember(replicaName(node, prefix, v_label, e_label),
+                       blob->meta());
+    nbytes += blob->nbytes();
+    return {};
+  }
+
+  // the NUMA node of the calling thread, which is detected once per thread
+  static int currentNumaNode() {
+    static thread_local int node = GetCurrentNumaNode();
+    return node;
+  }
+
+  // the replica of the topology on the NUMA node of the calling thread, or
+  // nullptr if there isn't one
+  inline const topology_replica_t* localTopology() const {
+    if (numa_topologies_.empty()) {
+      return nullptr;
+    }
+    int node = currentNumaNode();
+    if (node < 0 || static_cast<size_t>(node) >= numa_topologies_.size()) {
+      return nullptr;
+    }
+    return &numa_topologies_[node];
+  }
+
+  inline void outgoingTopology(label_id_t v_label, label_id_t e_label,
+                               const int64_t*& offsets,
+                               const nbr_unit_t*& nbrs) const {
+    const topology_replica_t* topology = localTopology();
+    if (topology != nullptr) {
+      offsets = topology->oe_offsets_ptr_lists[v_label][e_label];
+      nbrs = topology->oe_ptr_lists[v_label][e_label];
+    } else {
+      offsets = oe_offsets_ptr_lists_[v_label][e_label];
+      nbrs = oe_ptr_lists_[v_label][e_label];
+    }
+  }
+
+  inline void incomingTopology(label_id_t v_label, label_id_t e_label,
+                               const int64_t*& offsets,
+                               const nbr_unit_t*& nbrs) const {
+    const topology_replica_t* topology = localTopology();
+    if (topology != nullptr) {
+      offsets = topology->ie_offsets_ptr_lists[v_label][e_label];
+      nbrs = topology->ie_ptr_lists[v_label][e_label];
+    } else {
+      offsets = ie_offsets_ptr_lists_[v_label][e_label];
+      nbrs = ie_ptr_lists_[v_label][e_label];
+    }
+  }
+
+  // the pointer of the replica, or of the original list if the list is
+  // empty and hence not replicated
+  template <typename T>
+  const T* replicaPointer(int node, const std::string& prefix,
+                          label_id_t v_label, label_id_t e_label,
+                          const T* original) {
+    std::string name = replicaName(node, prefix, v_label, e_label);
+    if (!this->meta_.Haskey(name)) {
+      return original;
+    }
+    auto blob =
+        std::dynamic_pointer_cast<vineyard::Blob>(this->meta_.GetMember(name));
+    if (blob == nullptr || blob->data() == nullptr) {
+      return original;
+    }
+    numa_blobs_.emplace_back(blob);
+    return reinterpret_cast<const T*>(blob->data());
+  }
+
+  void initTopologyReplicas() {
+    numa_topologies_.clear();
+    numa_blobs_.clear();
+    numa_topologies_.resize(numa_replicas_);
+    for (int node = 0; node < numa_replicas_; ++node) {
+      auto& topology = numa_topologies_[node];
+      topology.oe_ptr_lists.resize(vertex_label_num_);
+      topology.oe_offsets_ptr_lists.resize(vertex_label_num_);
+      topology.ie_ptr_lists.resize(vertex_label_num_);
+      topology.ie_offsets_ptr_lists.resize(vertex_label_num_);
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        topology.oe_ptr_lists[i].resize(edge_label_num_);
+        topology.oe_offsets_ptr_lists[i].resize(edge_label_num_);
+        topology.ie_ptr_lists[i].resize(edge_label_num_);
+        topology.ie_offsets_ptr_lists[i].resize(edge_label_num_);
+        for (label_id_t j = 0; j < edge_label_num_; ++j) {
+          topology.oe_ptr_lists[i][j] =
+              replicaPointer(node, "oe_lists", i, j, oe_ptr_lists_[i][j]);
+          topology.oe_offsets_ptr_lists[i][j] = replicaPointer(
+              node, "oe_offsets_lists", i, j, oe_offsets_ptr_lists_[i][j]);
+          if (directed_) {
+            topology.ie_ptr_lists[i][j] =
+                replicaPointer(node, "ie_lists", i, j, ie_ptr_lists_[i][j]);
+            topology.ie_offsets_ptr_lists[i][j] = replicaPointer(
+                node, "ie_offsets_lists", i, j, ie_offsets_ptr_lists_[i][j]);
+          } else {
+            topology.ie_ptr_lists[i][j] = topology.oe_ptr_lists[i][j];
+            topology.ie_offsets_ptr_lists[i][j] =
+                topology.oe_offsets_ptr_lists[i][j];
+          }
+        }
+      }
+    }
+  }
+
+  void constructMergedLists(
+      const vineyard::ObjectMeta& meta, const std::string& prefix,
+      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>& lists,
+      std::vector<std::shared_ptr<arrow::Int64Array>>& offsets_lists) {
+    lists.resize(vertex_label_num_);
+    offsets_lists.resize(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      vineyard::FixedSizeBinaryArray list;
+      list.Construct(
+          meta.GetMemberMeta(generate_name_with_suffix(prefix + "_lists", i)));
+      lists[i] = list.GetArray();
+      vineyard::NumericArray<int64_t> offsets;
+      offsets.Construct(meta.GetMemberMeta(
+          generate_name_with_suffix(prefix + "_offsets_lists", i)));
+      offsets_lists[i] = offsets.GetArray();
+    }
+  }
+
+  void copyDegreeStatisticsMeta(const vineyard::ObjectMeta& old_meta,
+                                vineyard::ObjectMeta& new_meta,
+                                size_t& nbytes) const {
+    new_meta.AddKeyValue("degree_statistics", 1);
+    ASSIGNE_IDENTICAL_VEC_META("out_degrees", vertex_label_num_);
+    ASSIGNE_IDENTICAL_VEC_META("out_degree_histogram", vertex_label_num_);
+    if (directed_) {
+      ASSIGNE_IDENTICAL_VEC_META("in_degrees", vertex_label_num_);
+      ASSIGNE_IDENTICAL_VEC_META("in_degree_histogram", vertex_label_num_);
+    }
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        for (auto const& prefix : {"out_edge_num", "in_edge_num"}) {
+          std::string key = generate_name_with_suffix(prefix, i, j);
+          new_meta.AddKeyValue(key, old_meta.GetKeyValue(key));
+        }
+      }
+    }
+  }
+
+  void copyDeltaEdgesMeta(const vineyard::ObjectMeta& old_meta,
+                          vineyard::ObjectMeta& new_meta,
+                          size_t& nbytes) const {
+    new_meta.AddKeyValue("delta_edges", 1);
+    ASSIGNE_IDENTICAL_VEC_META("delta_edge_tables", edge_label_num_);
+    if (directed_) {
+      ASSIGNE_IDENTICAL_VEC_VEC_META("delta_ie_vertices", vertex_label_num_,
+                                     edge_label_num_);
+      ASSIGNE_IDENTICAL_VEC_VEC_META("delta_ie_offsets", vertex_label_num_,
+                                     edge_label_num_);
+      ASSIGNE_IDENTICAL_VEC_VEC_META("delta_ie_lists", vertex_label_num_,
+                                     edge_label_num_);
+    }
+    ASSIGNE_IDENTICAL_VEC_VEC_META("delta_oe_vertices", vertex_label_num_,
+                                   edge_label_num_);
+    ASSIGNE_IDENTICAL_VEC_VEC_META("delta_oe_offsets", vertex_label_num_,
+                                   edge_label_num_);
+    ASSIGNE_IDENTICAL_VEC_VEC_META("delta_oe_lists", vertex_label_num_,
+                                   edge_label_num_);
+  }
+
+  // the delta segment only keeps the vertices that have delta edges, sorted
+  // by their offsets
+  adj_list_t getDeltaAdjList(
+      const vertex_t& v, label_id_t e_label,
+      const std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>&
+          vertices_lists,
+      const std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>&
+          offsets_lists,
+      const std::vector<
+          std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>>& lists)
+      const {
+    if (!delta_edges_) {
+      return adj_list_t();
+    }
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    auto const& vertices = vertices_lists[v_label][e_label];
+    const int64_t* begin = vertices->raw_values();
+    const int64_t* end = begin + vertices->length();
+    const int64_t* iter = std::lower_bound(begin, end, v_offset);
+    if (iter == end || *iter != v_offset) {
+      return adj_list_t();
+    }
+    const int64_t* offsets = offsets_lists[v_label][e_label]->raw_values();
+    const nbr_unit_t* nbrs = reinterpret_cast<const nbr_unit_t*>(
+        lists[v_label][e_label]->GetValue(0));
+    return adj_list_t(&nbrs[offsets[iter - begin]],
+                      &nbrs[offsets[iter - begin + 1]],
+                      flatten_delta_edge_tables_columns_[e_label]);
+  }
+
+  void collectDeltaEdges(
+      label_id_t e_label,
+      const std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>&
+          vertices_lists,
+      const std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>&
+          offsets_lists,
+      const std::vector<
+          std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>>& lists,
+      std::vector<delta_edges_t>& deltas) const {
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      auto const& vertices = vertices_lists[i][e_label];
+      const int64_t* offsets = offsets_lists[i][e_label]->raw_values();
+      const nbr_unit_t* nbrs =
+          reinterpret_cast<const nbr_unit_t*>(lists[i][e_label]->GetValue(0));
+      for (int64_t k = 0; k < vertices->length(); ++k) {
+        for (int64_t e = offsets[k]; e < offsets[k + 1]; ++e) {
+          deltas[i].emplace_back(vertices->Value(k), nbrs[e]);
+        }
+      }
+    }
+  }
+
+  bool deltaGid2Lid(vid_t const gid, vid_t& lid) const {
+    label_id_t label = vid_parser_.GetLabelId(gid);
+    if (label >= vertex_label_num_) {
+      return false;
+    }
+    if (vid_parser_.GetFid(gid) == fid_) {
+      if (vid_parser_.GetOffset(gid) >= static_cast<int64_t>(ivnums_[label])) {
+        return false;
+      }
+      lid = vid_parser_.GetLid(gid);
+      return true;
+    }
+    vertex_t v;
+    if (OuterVertexGid2Vertex(gid, v)) {
+      lid = v.GetValue();
+      return true;
+    }
+    return false;
+  }
+
+  // map the endpoints of new edges to local ids, and returns the table of
+  // edge properties
+  auto mapDeltaEdges(label_id_t e_label,
+                     const std::shared_ptr<arrow::Table>& edge_table,
+                     eid_t eid_begin, std::vector<delta_edges_t>& oe_deltas,
+                     std::vector<delta_edges_t>& ie_deltas) const
+      -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
+    auto const& schema = edge_tables_[e_label]->schema();
+    if (edge_table->num_columns() != schema->num_fields() + 2) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "The new edges don't match the properties of edge "
+                      "label " +
+                          std::to_string(e_label));
+    }
+    std::shared_ptr<arrow::Table> table;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(
+        edge_table->CombineChunks(arrow::default_memory_pool(), &table));
+#else
+    ARROW_OK_ASSIGN_OR_RAISE(
+        table, edge_table->CombineChunks(arrow::default_memory_pool()));
+#endif
+    if (table->num_rows() > 0) {
+      auto vid_type = ConvertToArrowType<vid_t>::TypeValue();
+      CHECK_OR_RAISE(table->column(0)->type()->Equals(vid_type) &&
+                     table->column(1)->type()->Equals(vid_type));
+      auto src_list =
+          std::dynamic_pointer_cast<vid_array_t>(table->column(0)->chunk(0));
+      auto dst_list =
+          std::dynamic_pointer_cast<vid_array_t>(table->column(1)->chunk(0));
+      for (int64_t k = 0; k < table->num_rows(); ++k) {
+        vid_t src_gid = src_list->Value(k), dst_gid = dst_list->Value(k);
+        vid_t src_lid, dst_lid;
+        if (!deltaGid2Lid(src_gid, src_lid) ||
+            !deltaGid2Lid(dst_gid, dst_lid)) {
+          RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                          "Adding edges between vertices that are not in "
+                          "the fragment requires rebuilding the fragment");
+        }
+        if (vid_parser_.GetFid(src_gid) != fid_ &&
+            vid_parser_.GetFid(dst_gid) != fid_) {
+          RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                          "The new edge doesn't belong to the fragment");
+        }
+        eid_t eid = eid_begin + static_cast<eid_t>(k);
+        oe_deltas[vid_parser_.GetLabelId(src_lid)].emplace_back(
+            vid_parser_.GetOffset(src_lid), nbr_unit_t(dst_lid, eid));
+        if (directed_) {
+          ie_deltas[vid_parser_.GetLabelId(dst_lid)].emplace_back(
+              vid_parser_.GetOffset(dst_lid), nbr_unit_t(src_lid, eid));
+        } else {
+          oe_deltas[vid_parser_.GetLabelId(dst_lid)].emplace_back(
+              vid_parser_.GetOffset(dst_lid), nbr_unit_t(src_lid, eid));
+        }
+      }
+    }
+
+    std::shared_ptr<arrow::Table> tmp_table;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(table->RemoveColumn(0, &tmp_table));
+    ARROW_OK_OR_RAISE(tmp_table->RemoveColumn(0, &table));
+    ARROW_OK_OR_RAISE(table->RenameColumns(schema->field_names(), &table));
+#else
+    ARROW_OK_ASSIGN_OR_RAISE(tmp_table, table->RemoveColumn(0));
+    ARROW_OK_ASSIGN_OR_RAISE(table, tmp_table->RemoveColumn(0));
+    ARROW_OK_ASSIGN_OR_RAISE(table,
+                             table->RenameColumns(schema->field_names()));
+#endif
+    return table;
+  }
+
+  auto concatenateTables(
+      const std::vector<std::shared_ptr<arrow::Table>>& tables) const
+      -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
+    std::shared_ptr<arrow::Table> table;
+    ARROW_OK_ASSIGN_OR_RAISE(table, arrow::ConcatenateTables(tables));
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(
+        table->CombineChunks(arrow::default_memory_pool(), &table));
+#else
+    ARROW_OK_ASSIGN_OR_RAISE(
+        table, table->CombineChunks(arrow::default_memory_pool()));
+#endif
+    return table;
+  }
+
+  boost::leaf::result<void> sealDeltaEdges(vineyard::Client& client,
+                                           const std::string& prefix,
+                                           label_id_t v_label,
+                                           label_id_t e_label,
+                                           delta_edges_t& deltas,
+                                           vineyard::ObjectMeta& new_meta,
+                                           size_t& nbytes) const {
+    std::sort(deltas.begin(), deltas.end(),
+              [](const std::pair<int64_t, nbr_unit_t>& lhs,
+                 const std::pair<int64_t, nbr_unit_t>& rhs) {
+                return lhs.first < rhs.first ||
+                       (lhs.first == rhs.first &&
+                        lhs.second.vid < rhs.second.vid);
+              });
+    arrow::Int64Builder vertices_builder, offsets_builder;
+    vineyard::PodArrayBuilder<nbr_unit_t> nbrs_builder;
+    ARROW_OK_OR_RAISE(nbrs_builder.Resize(deltas.size()));
+    ARROW_OK_OR_RAISE(offsets_builder.Append(0));
+    for (size_t k = 0; k < deltas.size(); ++k) {
+      if (k == 0 || deltas[k].first != deltas[k - 1].first) {
+        if (k != 0) {
+          ARROW_OK_OR_RAISE(offsets_builder.Append(k));
         }
+        ARROW_OK_OR_RAISE(vertices_builder.Append(deltas[k].first));
+      }
+      *nbrs_builder.MutablePointer(k) = deltas[k].second;
+    }
+    if (!deltas.empty()) {
+      ARROW_OK_OR_RAISE(offsets_builder.Append(deltas.size()));
+    }
+    ARROW_OK_OR_RAISE(nbrs_builder.Advance(deltas.size()));
+
+    std::shared_ptr<arrow::Int64Array> vertices, offsets;
+    std::shared_ptr<arrow::FixedSizeBinaryArray> nbrs;
+    ARROW_OK_OR_RAISE(vertices_builder.Finish(&vertices));
+    ARROW_OK_OR_RAISE(offsets_builder.Finish(&offsets));
+    ARROW_OK_OR_RAISE(nbrs_builder.Finish(&nbrs));
+
+    vineyard::NumericArrayBuilder<int64_t> vertices_array(client, vertices);
+    vineyard::NumericArrayBuilder<int64_t> offsets_array(client, offsets);
+    vineyard::FixedSizeBinaryArrayBuilder nbrs_array(client, nbrs);
+    for (auto& pair : std::vector<std::pair<std::string, ObjectBuilder*>>{
+             {"_vertices", &vertices_array},
+             {"_offsets", &offsets_array},
+             {"_lists", &nbrs_array}}) {
+      auto array = pair.second->Seal(client);
+      new_meta.AddMember(
+          generate_name_with_suffix(prefix + pair.first, v_label, e_label),
+          array->meta());
+      nbytes += array->nbytes();
+    }
+    return {};
+  }
 
-        gather_archives(arc, comm_spec, old_size);
+  // merge the delta edges of every vertex into the base adjacency list, and
+  // keep the neighbors sorted
+  boost::leaf::result<void> mergeDeltaEdges(
+      vineyard::Client& client, const std::string& prefix, label_id_t v_label,
+      label_id_t e_label, eid_t eid_begin, const nbr_unit_t* base_nbrs,
+      const int64_t* base_offsets,
+      const std::shared_ptr<arrow::Int64Array>& delta_vertices,
+      const std::shared_ptr<arrow::Int64Array>& delta_offsets_array,
+      const std::shared_ptr<arrow::FixedSizeBinaryArray>& delta_lists,
+      vineyard::ObjectMeta& new_meta, size_t& nbytes) const {
+    int64_t tvnum = tvnums_[v_label];
+    const int64_t* delta_offsets = delta_offsets_array->raw_values();
+    const nbr_unit_t* delta_nbrs =
+        reinterpret_cast<const nbr_unit_t*>(delta_lists->GetValue(0));
+    int64_t edge_num =
+        base_offsets[tvnum] + delta_offsets[delta_vertices->length()];
+
+    vineyard::PodArrayBuilder<nbr_unit_t> nbrs_builder;
+    arrow::Int64Builder offsets_builder;
+    ARROW_OK_OR_RAISE(nbrs_builder.Resize(edge_num));
+    ARROW_OK_OR_RAISE(offsets_builder.Resize(tvnum + 1));
+    int64_t cursor = 0, k = 0;
+    for (int64_t u = 0; u < tvnum; ++u) {
+      offsets_builder[u] = cursor;
+      nbr_unit_t* begin = nbrs_builder.MutablePointer(cursor);
+      nbr_unit_t* middle = std::copy(base_nbrs + base_offsets[u],
+                                     base_nbrs + base_offsets[u + 1], begin);
+      nbr_unit_t* end = middle;
+      if (k < delta_vertices->length() && delta_vertices->Value(k) == u) {
+        for (int64_t e = delta_offsets[k]; e < delta_offsets[k + 1]; ++e) {
+          *end++ = nbr_unit_t(delta_nbrs[e].vid, delta_nbrs[e].eid + eid_begin);
+        }
+        std::inplace_merge(begin, middle, end,
+                           [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
+                             return lhs.vid < rhs.vid;
+                           });
+        ++k;
       }
-    } else if (schema_type == SchemaType::kEdgePropertySchema) {
-      LOG(INFO) << "outputing graph edges not supported...";
-    } else {
-      LOG(INFO) << "selector schema invalid: " << selectors;
+      cursor += end - begin;
     }
+    offsets_builder[tvnum] = cursor;
+    ARROW_OK_OR_RAISE(nbrs_builder.Advance(edge_num));
+    ARROW_OK_OR_RAISE(offsets_builder.Advance(tvnum + 1));
+
+    std::shared_ptr<arrow::FixedSizeBinaryArray> nbrs;
+    std::shared_ptr<arrow::Int64Array> offsets;
+    ARROW_OK_OR_RAISE(nbrs_builder.Finish(&nbrs));
+    ARROW_OK_OR_RAISE(offsets_builder.Finish(&offsets));
+
+    vineyard::FixedSizeBinaryArrayBuilder nbrs_array(client, nbrs);
+    vineyard::NumericArrayBuilder<int64_t> offsets_array(client, offsets);
+    auto lists = nbrs_array.Seal(client);
+    new_meta.AddMember(
+        generate_name_with_suffix(prefix + "_lists", v_label, e_label),
+        lists->meta());
+    nbytes += lists->nbytes();
+    auto offset_lists = offsets_array.Seal(client);
+    new_meta.AddMember(
+        generate_name_with_suffix(prefix + "_offsets_lists", v_label, e_label),
+        offset_lists->meta());
+    nbytes += offset_lists->nbytes();
+    return {};
   }
-#endif
 
- private:
   void initPointers() {
     edge_tables_columns_.resize(edge_label_num_);
     flatten_edge_tables_columns_.resize(edge_label_num_);
@@ -905,6 +2027,25 @@ class ArrowFragment
       flatten_edge_tables_columns_[i] = &edge_tables_columns_[i][0];
     }
 
+    if (delta_edges_) {
+      delta_edge_tables_columns_.resize(edge_label_num_);
+      flatten_delta_edge_tables_columns_.resize(edge_label_num_);
+      for (label_id_t i = 0; i < edge_label_num_; ++i) {
+        prop_id_t prop_num =
+            static_cast<prop_id_t>(delta_edge_tables_[i]->num_columns());
+        delta_edge_tables_columns_[i].resize(prop_num);
+        if (delta_edge_tables_[i]->num_rows() == 0) {
+          continue;
+        }
+        for (prop_id_t j = 0; j < prop_num; ++j) {
+          delta_edge_tables_columns_[i][j] =
+              get_arrow_array_ptr(delta_edge_tables_[i]->column(j)->chunk(0));
+        }
+        flatten_delta_edge_tables_columns_[i] =
+            &delta_edge_tables_columns_[i][0];
+      }
+    }
+
     vertex_tables_columns_.resize(vertex_label_num_);
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
       prop_id_t prop_num =
@@ -922,13 +2063,16 @@ class ArrowFragment
     oe_ptr_lists_.resize(vertex_label_num_);
     oe_offsets_ptr_lists_.resize(vertex_label_num_);
 
-    idst_.resize(vertex_label_num_);
-    odst_.resize(vertex_label_num_);
-    iodst_.resize(vertex_label_num_);
-
-    idoffset_.resize(vertex_label_num_);
-    odoffset_.resize(vertex_label_num_);
-    iodoffset_.resize(vertex_label_num_);
+    size_t dest_list_num = static_cast<size_t>(kDestKindNum) *
+                           vertex_label_num_ * edge_label_num_;
+    dest_fid_lists_.clear();
+    dest_fid_lists_.resize(dest_list_num);
+    dest_fid_offsets_.clear();
+    dest_fid_offsets_.resize(dest_list_num);
+    dest_fid_flags_.clear();
+    for (size_t i = 0; i < dest_list_num; ++i) {
+      dest_fid_flags_.emplace_back(std::make_shared<std::once_flag>());
+    }
 
     ovgid_lists_ptr_.resize(vertex_label_num_);
     ovg2l_maps_ptr_.resize(vertex_label_num_);
@@ -939,14 +2083,6 @@ class ArrowFragment
       oe_ptr_lists_[i].resize(edge_label_num_);
       oe_offsets_ptr_lists_[i].resize(edge_label_num_);
 
-      idst_[i].resize(edge_label_num_);
-      odst_[i].resize(edge_label_num_);
-      iodst_[i].resize(edge_label_num_);
-
-      idoffset_[i].resize(edge_label_num_);
-      odoffset_[i].resize(edge_label_num_);
-      iodoffset_[i].resize(edge_label_num_);
-
       for (label_id_t j = 0; j < edge_label_num_; ++j) {
         oe_ptr_lists_[i][j] =
             reinterpret_cast<const nbr_unit_t*>(oe_lists_[i][j]->GetValue(0));
@@ -970,60 +2106,178 @@ class ArrowFragment
       ie_ptr_lists_ = oe_ptr_lists_;
       ie_offsets_ptr_lists_ = oe_offsets_ptr_lists_;
     }
+
+    if (compact_edges_) {
+      initCompactPointers();
+    }
+
+    if (merged_edges_) {
+      merged_oe_ptr_lists_.resize(vertex_label_num_);
+      merged_oe_offsets_ptr_lists_.resize(vertex_label_num_);
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        merged_oe_ptr_lists_[i] = reinterpret_cast<const merged_nbr_unit_t*>(
+            merged_oe_lists_[i]->GetValue(0));
+        merged_oe_offsets_ptr_lists_[i] =
+            merged_oe_offsets_lists_[i]->raw_values();
+      }
+      if (directed_) {
+        merged_ie_ptr_lists_.resize(vertex_label_num_);
+        merged_ie_offsets_ptr_lists_.resize(vertex_label_num_);
+        for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+          merged_ie_ptr_lists_[i] = reinterpret_cast<const merged_nbr_unit_t*>(
+              merged_ie_lists_[i]->GetValue(0));
+          merged_ie_offsets_ptr_lists_[i] =
+              merged_ie_offsets_lists_[i]->raw_values();
+        }
+      } else {
+        merged_ie_ptr_lists_ = merged_oe_ptr_lists_;
+        merged_ie_offsets_ptr_lists_ = merged_oe_offsets_ptr_lists_;
+      }
+    }
+
+    if (degree_statistics_) {
+      out_degrees_ptr_lists_.resize(vertex_label_num_);
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        out_degrees_ptr_lists_[i] = out_degree_lists_[i]->raw_values();
+      }
+      if (directed_) {
+        in_degrees_ptr_lists_.resize(vertex_label_num_);
+        for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+          in_degrees_ptr_lists_[i] = in_degree_lists_[i]->raw_values();
+        }
+      } else {
+        in_degrees_ptr_lists_ = out_degrees_ptr_lists_;
+      }
+    }
+
+    initTopologyReplicas();
   }
 
-  void initDestFidList(
-      bool in_edge, bool out_edge,
-      std::vector<std::vector<std::vector<fid_t>>>& fid_lists,
-      std::vector<std::vector<std::vector<fid_t*>>>& fid_lists_offset) {
-    for (auto v_label_id = 0; v_label_id < vertex_label_num_; v_label_id++) {
-      auto ivnum_ = ivnums_[v_label_id];
-      auto inner_vertices = InnerVertices(v_label_id);
+  void initCompactPointers() {
+    // the eids of an edge label are in [0, edge_num)
+    compact_eid_widths_.resize(edge_label_num_);
+    for (label_id_t i = 0; i < edge_label_num_; ++i) {
+      compact_eid_widths_[i] = varint::fixed_width(edge_tables_[i]->num_rows());
+    }
 
-      for (auto e_label_id = 0; e_label_id < edge_label_num_; e_label_id++) {
-        std::vector<int> id_num(ivnum_, 0);
-        std::set<fid_t> dstset;
-        vertex_t v = inner_vertices.begin();
-        auto& fid_list = fid_lists[v_label_id][e_label_id];
-        auto& fid_list_offset = fid_lists_offset[v_label_id][e_label_id];
+    compact_oe_ptr_lists_.resize(vertex_label_num_);
+    compact_oe_offsets_ptr_lists_.resize(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      compact_oe_ptr_lists_[i].resize(edge_label_num_);
+      compact_oe_offsets_ptr_lists_[i].resize(edge_label_num_);
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        compact_oe_ptr_lists_[i][j] = compact_oe_lists_[i][j]->raw_values();
+        compact_oe_offsets_ptr_lists_[i][j] =
+            compact_oe_offsets_lists_[i][j]->raw_values();
+      }
+    }
 
-        if (!fid_list_offset.empty()) {
-          return;
+    if (directed_) {
+      compact_ie_ptr_lists_.resize(vertex_label_num_);
+      compact_ie_offsets_ptr_lists_.resize(vertex_label_num_);
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        compact_ie_ptr_lists_[i].resize(edge_label_num_);
+        compact_ie_offsets_ptr_lists_[i].resize(edge_label_num_);
+        for (label_id_t j = 0; j < edge_label_num_; ++j) {
+          compact_ie_ptr_lists_[i][j] = compact_ie_lists_[i][j]->raw_values();
+          compact_ie_offsets_ptr_lists_[i][j] =
+              compact_ie_offsets_lists_[i][j]->raw_values();
         }
-        fid_list_offset.resize(ivnum_ + 1, NULL);
-        for (vid_t i = 0; i < ivnum_; ++i) {
-          dstset.clear();
-          if (in_edge) {
-            auto es = GetIncomingAdjList(v, e_label_id);
-            for (auto& e : es) {
-              fid_t f = GetFragId(e.neighbor());
-              if (f != fid_) {
-                dstset.insert(f);
+      }
+    } else {
+      compact_ie_ptr_lists_ = compact_oe_ptr_lists_;
+      compact_ie_offsets_ptr_lists_ = compact_oe_offsets_ptr_lists_;
+    }
+  }
+
+  template <typename ADJ_LIST_T>
+  void collectDestFids(const ADJ_LIST_T& es, std::set<fid_t>& dstset) const {
+    for (auto& e : es) {
+      fid_t f = GetFragId(e.neighbor());
+      if (f != fid_) {
+        dstset.insert(f);
+      }
+    }
+  }
+
+  enum DestKind { kInDests = 0, kOutDests = 1, kInOutDests = 2 };
+  static constexpr int kDestKindNum = 3;
+
+  const std::vector<fid_t*>& destFidOffsets(DestKind kind, label_id_t v_label,
+                                            label_id_t e_label) const {
+    size_t index =
+        (static_cast<size_t>(kind) * vertex_label_num_ + v_label) *
+            edge_label_num_ +
+        e_label;
+    std::call_once(*dest_fid_flags_[index], [this, kind, v_label, e_label,
+                                             index]() {
+      initDestFidList(kind, v_label, e_label, dest_fid_lists_[index],
+                      dest_fid_offsets_[index]);
+    });
+    return dest_fid_offsets_[index];
+  }
+
+  void initDestFidList(DestKind kind, label_id_t v_label, label_id_t e_label,
+                       std::vector<fid_t>& fid_list,
+                       std::vector<fid_t*>& fid_list_offset) const {
+    bool in_edge = kind != kOutDests, out_edge = kind != kInDests;
+    vid_t ivnum = ivnums_[v_label];
+    vid_t first = InnerVertices(v_label).begin().GetValue();
+
+    // the fids of chunks of vertices are collected in parallel, and
+    // concatenated in order
+    const size_t chunk = 4096;
+    size_t chunk_num = (static_cast<size_t>(ivnum) + chunk - 1) / chunk;
+    std::vector<std::vector<fid_t>> chunk_fids(chunk_num);
+    std::vector<int> id_num(ivnum, 0);
+    int concurrency =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    ThreadPool::Default().ParallelFor(
+        chunk_num,
+        [&](size_t, size_t x, size_t y) {
+          std::set<fid_t> dstset;
+          for (size_t c = x; c < y; ++c) {
+            vid_t end = static_cast<vid_t>(
+                std::min(static_cast<size_t>(ivnum), (c + 1) * chunk));
+            for (vid_t i = static_cast<vid_t>(c * chunk); i < end; ++i) {
+              vertex_t v(first + i);
+              dstset.clear();
+              if (in_edge) {
+                if (compact_edges_) {
+                  collectDestFids(GetIncomingCompactAdjList(v, e_label),
+                                  dstset);
+                } else {
+                  collectDestFids(GetIncomingAdjList(v, e_label), dstset);
+                }
               }
-            }
-          }
-          if (out_edge) {
-            auto es = GetOutgoingAdjList(v, e_label_id);
-            for (auto& e : es) {
-              fid_t f = GetFragId(e.neighbor());
-              if (f != fid_) {
-                dstset.insert(f);
+              if (out_edge) {
+                if (compact_edges_) {
+                  collectDestFids(GetOutgoingCompactAdjList(v, e_label),
+                                  dstset);
+                } else {
+                  collectDestFids(GetOutgoingAdjList(v, e_label), dstset);
+                }
               }
+              id_num[i] = dstset.size();
+              chunk_fids[c].insert(chunk_fids[c].end(), dstset.begin(),
+                                   dstset.end());
             }
           }
-          id_num[i] = dstset.size();
-          for (auto fid : dstset) {
-            fid_list.push_back(fid);
-          }
-          ++v;
-        }
+        },
+        concurrency, 1);
 
-        fid_list.shrink_to_fit();
-        fid_list_offset[0] = fid_list.data();
-        for (vid_t i = 0; i < ivnum_; ++i) {
-          fid_list_offset[i + 1] = fid_list_offset[i] + id_num[i];
-        }
-      }
+    size_t total = 0;
+    for (auto const& fids : chunk_fids) {
+      total += fids.size();
+    }
+    fid_list.reserve(total);
+    for (auto const& fids : chunk_fids) {
+      fid_list.insert(fid_list.end(), fids.begin(), fids.end());
+    }
+    fid_list_offset.resize(ivnum + 1, NULL);
+    fid_list_offset[0] = fid_list.data();
+    for (vid_t i = 0; i < ivnum; ++i) {
+      fid_list_offset[i + 1] = fid_list_offset[i] + id_num[i];
     }
   }
 
@@ -1055,9 +2309,61 @@ class ArrowFragment
   std::vector<std::vector<const int64_t*>> ie_offsets_ptr_lists_,
       oe_offsets_ptr_lists_;
 
-  std::vector<std::vector<std::vector<fid_t>>> idst_, odst_, iodst_;
-  std::vector<std::vector<std::vector<fid_t*>>> idoffset_, odoffset_,
-      iodoffset_;
+  // the compact adjacency lists, and the byte offsets of vertices in them
+  bool compact_edges_ = false;
+  std::vector<std::vector<std::shared_ptr<arrow::UInt8Array>>>
+      compact_ie_lists_, compact_oe_lists_;
+  std::vector<std::vector<const uint8_t*>> compact_ie_ptr_lists_,
+      compact_oe_ptr_lists_;
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+      compact_ie_offsets_lists_, compact_oe_offsets_lists_;
+  std::vector<std::vector<const int64_t*>> compact_ie_offsets_ptr_lists_,
+      compact_oe_offsets_ptr_lists_;
+  std::vector<size_t> compact_eid_widths_;
+
+  // the edges added by `AddEdges`, where only the vertices that have delta
+  // edges are kept in the delta CSR
+  bool delta_edges_ = false;
+  std::vector<std::shared_ptr<arrow::Table>> delta_edge_tables_;
+  std::vector<std::vector<const void*>> delta_edge_tables_columns_;
+  std::vector<const void**> flatten_delta_edge_tables_columns_;
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+      delta_ie_vertices_lists_, delta_oe_vertices_lists_;
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+      delta_ie_offsets_lists_, delta_oe_offsets_lists_;
+  std::vector<std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>>
+      delta_ie_lists_, delta_oe_lists_;
+
+  // the merged adjacency lists of all edge labels, for every vertex label
+  bool merged_edges_ = false;
+  std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> merged_ie_lists_,
+      merged_oe_lists_;
+  std::vector<const merged_nbr_unit_t*> merged_ie_ptr_lists_,
+      merged_oe_ptr_lists_;
+  std::vector<std::shared_ptr<arrow::Int64Array>> merged_ie_offsets_lists_,
+      merged_oe_offsets_lists_;
+  std::vector<const int64_t*> merged_ie_offsets_ptr_lists_,
+      merged_oe_offsets_ptr_lists_;
+
+  // the degrees of the inner vertices over all edge labels, and the
+  // histograms of them, for every vertex label
+  bool degree_statistics_ = false;
+  std::vector<std::shared_ptr<arrow::UInt32Array>> in_degree_lists_,
+      out_degree_lists_;
+  std::vector<const uint32_t*> in_degrees_ptr_lists_, out_degrees_ptr_lists_;
+  std::vector<std::shared_ptr<arrow::Int64Array>> in_degree_histograms_,
+      out_degree_histograms_;
+
+  // the replicas of the CSR on every NUMA node, see also `ReplicateTopology`
+  int numa_replicas_ = 0;
+  std::vector<topology_replica_t> numa_topologies_;
+  std::vector<std::shared_ptr<vineyard::Blob>> numa_blobs_;
+
+  // the destination fids of the inner vertices, for every kind of the
+  // destination lists, vertex label and edge label, built on the first use
+  mutable std::vector<std::vector<fid_t>> dest_fid_lists_;
+  mutable std::vector<std::vector<fid_t*>> dest_fid_offsets_;
+  std::vector<std::shared_ptr<std::once_flag>> dest_fid_flags_;
 
   std::shared_ptr<vertex_map_t> vm_ptr_;
 
@@ -1071,6 +2377,12 @@ class ArrowFragment
   template <typename _OID_T, typename _VID_T, typename VDATA_T,
             typename EDATA_T>
   friend class gs::ArrowProjectedFragment;
+
+  template <typename _OID_T, typename _VID_T>
+  friend class ArrowFragmentProjection;
+
+  template <typename _OID_T, typename _VID_T>
+  friend class ArrowFragmentProjectionBuilder;
 };
 
 template <typename OID_T, typename VID_T>
@@ -1117,6 +2429,52 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     }
   }
 
+  /**
+   * @brief Store the adjacency lists in the compact encoding, the compact
+   * lists should be set besides the `NbrUnit`-based lists, which could be
+   * empty.
+   */
+  void set_compact_edges(bool compact_edges) { compact_edges_ = compact_edges; }
+
+  /**
+   * @brief Compute the degree statistics of the inner vertices when the
+   * fragment is sealed, see also `ArrowFragment::has_degree_statistics()`.
+   *
+   * The degrees (over all edge labels) and their histograms are sealed as
+   * members of the fragment, and the number of edges of every pair of vertex
+   * label and edge label is kept in the metadata as `out_edge_num_<i>_<j>`
+   * and `in_edge_num_<i>_<j>`, which can be read without the blobs.
+   */
+  void set_degree_statistics(bool degree_statistics) {
+    degree_statistics_ = degree_statistics;
+  }
+
+  /**
+   * @brief Store the merged adjacency lists besides the lists of every edge
+   * label, see also `ArrowFragment::merged_edges()`.
+   */
+  void set_merged_edges(bool merged_edges) { merged_edges_ = merged_edges; }
+
+  void set_merged_in_edge_list(
+      label_id_t v_label,
+      std::shared_ptr<vineyard::FixedSizeBinaryArray> in_edge_list,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> in_edge_offsets) {
+    merged_ie_lists_.resize(vertex_label_num_);
+    merged_ie_offsets_lists_.resize(vertex_label_num_);
+    merged_ie_lists_[v_label] = in_edge_list;
+    merged_ie_offsets_lists_[v_label] = in_edge_offsets;
+  }
+
+  void set_merged_out_edge_list(
+      label_id_t v_label,
+      std::shared_ptr<vineyard::FixedSizeBinaryArray> out_edge_list,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> out_edge_offsets) {
+    merged_oe_lists_.resize(vertex_label_num_);
+    merged_oe_offsets_lists_.resize(vertex_label_num_);
+    merged_oe_lists_[v_label] = out_edge_list;
+    merged_oe_offsets_lists_[v_label] = out_edge_offsets;
+  }
+
   void set_ivnums(const vineyard::Array<vid_t>& ivnums) { ivnums_ = ivnums; }
 
   void set_ovnums(const vineyard::Array<vid_t>& ovnums) { ovnums_ = ovnums; }
@@ -1185,6 +2543,30 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     oe_offsets_lists_[v_label][e_label] = out_edge_offsets;
   }
 
+  void set_compact_in_edge_list(
+      label_id_t v_label, label_id_t e_label,
+      std::shared_ptr<vineyard::NumericArray<uint8_t>> in_edge_list,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> in_edge_offsets) {
+    compact_ie_lists_.resize(vertex_label_num_);
+    compact_ie_offsets_lists_.resize(vertex_label_num_);
+    compact_ie_lists_[v_label].resize(edge_label_num_);
+    compact_ie_offsets_lists_[v_label].resize(edge_label_num_);
+    compact_ie_lists_[v_label][e_label] = in_edge_list;
+    compact_ie_offsets_lists_[v_label][e_label] = in_edge_offsets;
+  }
+
+  void set_compact_out_edge_list(
+      label_id_t v_label, label_id_t e_label,
+      std::shared_ptr<vineyard::NumericArray<uint8_t>> out_edge_list,
+      std::shared_ptr<vineyard::NumericArray<int64_t>> out_edge_offsets) {
+    compact_oe_lists_.resize(vertex_label_num_);
+    compact_oe_offsets_lists_.resize(vertex_label_num_);
+    compact_oe_lists_[v_label].resize(edge_label_num_);
+    compact_oe_offsets_lists_[v_label].resize(edge_label_num_);
+    compact_oe_lists_[v_label][e_label] = out_edge_list;
+    compact_oe_offsets_lists_[v_label][e_label] = out_edge_offsets;
+  }
+
   void set_vertex_map(std::shared_ptr<vertex_map_t> vm_ptr) {
     vm_ptr_ = vm_ptr;
   }
@@ -1267,6 +2649,18 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     ASSIGN_ARRAY_VECTOR_VECTOR(oe_lists_, frag->oe_lists_);
     ASSIGN_ARRAY_VECTOR_VECTOR(oe_offsets_lists_, frag->oe_offsets_lists_);
 
+    frag->compact_edges_ = compact_edges_;
+    if (compact_edges_) {
+      if (directed_) {
+        ASSIGN_ARRAY_VECTOR_VECTOR(compact_ie_lists_, frag->compact_ie_lists_);
+        ASSIGN_ARRAY_VECTOR_VECTOR(compact_ie_offsets_lists_,
+                                   frag->compact_ie_offsets_lists_);
+      }
+      ASSIGN_ARRAY_VECTOR_VECTOR(compact_oe_lists_, frag->compact_oe_lists_);
+      ASSIGN_ARRAY_VECTOR_VECTOR(compact_oe_offsets_lists_,
+                                 frag->compact_oe_offsets_lists_);
+    }
+
     frag->meta_.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
 
     frag->meta_.AddKeyValue("fid", fid_);
@@ -1343,6 +2737,69 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
                           edge_label_num_);
     GENERATE_VEC_VEC_META("oe_offsets_lists", oe_offsets_lists_,
                           vertex_label_num_, edge_label_num_);
+    if (compact_edges_) {
+      frag->meta_.AddKeyValue("compact_edges", 1);
+      if (directed_) {
+        GENERATE_VEC_VEC_META("compact_ie_lists", compact_ie_lists_,
+                              vertex_label_num_, edge_label_num_);
+        GENERATE_VEC_VEC_META("compact_ie_offsets_lists",
+                              compact_ie_offsets_lists_, vertex_label_num_,
+                              edge_label_num_);
+      }
+      GENERATE_VEC_VEC_META("compact_oe_lists", compact_oe_lists_,
+                            vertex_label_num_, edge_label_num_);
+      GENERATE_VEC_VEC_META("compact_oe_offsets_lists",
+                            compact_oe_offsets_lists_, vertex_label_num_,
+                            edge_label_num_);
+    }
+    if (merged_edges_) {
+      frag->meta_.AddKeyValue("merged_edges", 1);
+      if (directed_) {
+        GENERATE_VEC_META("merged_ie_lists", merged_ie_lists_,
+                          vertex_label_num_);
+        GENERATE_VEC_META("merged_ie_offsets_lists", merged_ie_offsets_lists_,
+                          vertex_label_num_);
+      }
+      GENERATE_VEC_META("merged_oe_lists", merged_oe_lists_,
+                        vertex_label_num_);
+      GENERATE_VEC_META("merged_oe_offsets_lists", merged_oe_offsets_lists_,
+                        vertex_label_num_);
+    }
+    if (degree_statistics_) {
+      frag->meta_.AddKeyValue("degree_statistics", 1);
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        for (label_id_t j = 0; j < edge_label_num_; ++j) {
+          const int64_t* oe_offsets =
+              frag->oe_offsets_lists_[i][j]->raw_values();
+          const int64_t* ie_offsets =
+              directed_ ? frag->ie_offsets_lists_[i][j]->raw_values()
+                        : oe_offsets;
+          frag->meta_.AddKeyValue(
+              generate_name_with_suffix("out_edge_num", i, j),
+              oe_offsets[ivnums_[i]]);
+          frag->meta_.AddKeyValue(
+              generate_name_with_suffix("in_edge_num", i, j),
+              ie_offsets[ivnums_[i]]);
+        }
+        std::shared_ptr<vineyard::Object> degrees, histogram;
+        sealDegrees(client, frag->oe_offsets_lists_, i, degrees, histogram);
+        frag->meta_.AddMember(generate_name_with_suffix("out_degrees", i),
+                              degrees->meta());
+        frag->meta_.AddMember(
+            generate_name_with_suffix("out_degree_histogram", i),
+            histogram->meta());
+        nbytes += degrees->nbytes() + histogram->nbytes();
+        if (directed_) {
+          sealDegrees(client, frag->ie_offsets_lists_, i, degrees, histogram);
+          frag->meta_.AddMember(generate_name_with_suffix("in_degrees", i),
+                                degrees->meta());
+          frag->meta_.AddMember(
+              generate_name_with_suffix("in_degree_histogram", i),
+              histogram->meta());
+          nbytes += degrees->nbytes() + histogram->nbytes();
+        }
+      }
+    }
 
     frag->meta_.AddMember("vertex_map", vm_ptr_->meta());
 
@@ -1363,6 +2820,70 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
 #undef GENERATE_VEC_VEC_META
 
  private:
+  // the degrees of the inner vertices of the label over all edge labels, and
+  // the histogram of them
+  void sealDegrees(
+      vineyard::Client& client,
+      const std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>&
+          offsets_lists,
+      label_id_t v_label, std::shared_ptr<vineyard::Object>& degrees,
+      std::shared_ptr<vineyard::Object>& histogram) {
+    using fragment_t = ArrowFragment<oid_t, vid_t>;
+    int64_t ivnum = ivnums_[v_label];
+    std::vector<uint32_t> degree_list(ivnum, 0);
+    int concurrency =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int bucket_num = fragment_t::degree_histogram_buckets;
+    std::vector<std::vector<int64_t>> buckets(
+        concurrency, std::vector<int64_t>(bucket_num, 0));
+    ThreadPool::Default().ParallelFor(
+        ivnum,
+        [&](size_t lane, size_t begin, size_t end) {
+          for (size_t k = begin; k < end; ++k) {
+            int64_t degree = 0;
+            for (label_id_t j = 0; j < edge_label_num_; ++j) {
+              const int64_t* offsets = offsets_lists[v_label][j]->raw_values();
+              degree += offsets[k + 1] - offsets[k];
+            }
+            // saturated, which is hardly reached by the inner vertices
+            degree = std::min<int64_t>(
+                degree, std::numeric_limits<uint32_t>::max());
+            degree_list[k] = static_cast<uint32_t>(degree);
+            int bucket = 0;
+            while (degree != 0) {
+              degree >>= 1;
+              ++bucket;
+            }
+            buckets[lane][bucket] += 1;
+          }
+        },
+        concurrency);
+    for (int lane = 1; lane < concurrency; ++lane) {
+      for (int b = 0; b < bucket_num; ++b) {
+        buckets[0][b] += buckets[lane][b];
+      }
+    }
+
+    std::shared_ptr<arrow::UInt32Array> degree_array;
+    {
+      arrow::UInt32Builder builder;
+      ARROW_CHECK_OK(builder.AppendValues(degree_list));
+      ARROW_CHECK_OK(builder.Finish(&degree_array));
+    }
+    std::shared_ptr<arrow::Int64Array> histogram_array;
+    {
+      arrow::Int64Builder builder;
+      ARROW_CHECK_OK(builder.AppendValues(buckets[0]));
+      ARROW_CHECK_OK(builder.Finish(&histogram_array));
+    }
+    vineyard::NumericArrayBuilder<uint32_t> degree_builder(client,
+                                                           degree_array);
+    degrees = degree_builder.Seal(client);
+    vineyard::NumericArrayBuilder<int64_t> histogram_builder(client,
+                                                             histogram_array);
+    histogram = histogram_builder.Seal(client);
+  }
+
   fid_t fid_, fnum_;
   bool directed_;
   label_id_t vertex_label_num_;
@@ -1381,6 +2902,19 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
   std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>>
       ie_offsets_lists_, oe_offsets_lists_;
 
+  bool compact_edges_ = false;
+  bool degree_statistics_ = false;
+  std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<uint8_t>>>>
+      compact_ie_lists_, compact_oe_lists_;
+  std::vector<std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>>
+      compact_ie_offsets_lists_, compact_oe_offsets_lists_;
+
+  bool merged_edges_ = false;
+  std::vector<std::shared_ptr<vineyard::FixedSizeBinaryArray>>
+      merged_ie_lists_, merged_oe_lists_;
+  std::vector<std::shared_ptr<vineyard::NumericArray<int64_t>>>
+      merged_ie_offsets_lists_, merged_oe_offsets_lists_;
+
   std::shared_ptr<vertex_map_t> vm_ptr_;
   PropertyGraphSchema schema_;
 };
@@ -1388,32 +2922,18 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
 template <typename ITER_T, typename FUNC_T>
 void parallel_for(const ITER_T& begin, const ITER_T& end, const FUNC_T& func,
                   int thread_num, size_t chunk = 0) {
-  std::vector<std::thread> threads(thread_num);
   size_t num = end - begin;
-  if (chunk == 0) {
-    chunk = (num + thread_num - 1) / thread_num;
-  }
-  std::atomic<size_t> cur(0);
-  for (int i = 0; i < thread_num; ++i) {
-    threads[i] = std::thread([&]() {
-      while (true) {
-        size_t x = cur.fetch_add(chunk);
-        if (x >= num) {
-          break;
-        }
-        size_t y = std::min(x + chunk, num);
+  ThreadPool::Default().ParallelFor(
+      num,
+      [&](size_t, size_t x, size_t y) {
         ITER_T a = begin + x;
         ITER_T b = begin + y;
         while (a != b) {
           func(a);
           ++a;
         }
-      }
-    });
-  }
-  for (auto& thrd : threads) {
-    thrd.join();
-  }
+      },
+      thread_num, chunk);
 }
 
 inline void parallel_prefix_sum(const int* input, int64_t* output,
@@ -1432,13 +2952,14 @@ inline void parallel_prefix_sum(const int* input, int64_t* output,
     }
   };
 
-  std::vector<std::thread> threads_prefix;
-  for (int i = 0; i < thread_num; ++i) {
-    threads_prefix.emplace_back(block_prefix, i);
-  }
-  for (auto& thrd : threads_prefix) {
-    thrd.join();
-  }
+  ThreadPool::Default().ParallelFor(
+      thread_num,
+      [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          block_prefix(static_cast<int>(i));
+        }
+      },
+      thread_num, 1);
 
   std::vector<int64_t> block_sum(thread_num);
   {
@@ -1458,13 +2979,14 @@ inline void parallel_prefix_sum(const int* input, int64_t* output,
     }
   };
 
-  std::vector<std::thread> threads_sum;
-  for (int i = 1; i < thread_num; ++i) {
-    threads_sum.emplace_back(block_add, i);
-  }
-  for (auto& thrd : threads_sum) {
-    thrd.join();
-  }
+  ThreadPool::Default().ParallelFor(
+      thread_num - 1,
+      [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          block_add(static_cast<int>(i) + 1);
+        }
+      },
+      thread_num - 1, 1);
 }
 
 template <typename OID_T, typename VID_T>
@@ -1476,6 +2998,7 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
   using label_id_t = property_graph_types::LABEL_ID_TYPE;
   using vertex_map_t = ArrowVertexMap<internal_oid_t, vid_t>;
   using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
+  using merged_nbr_unit_t = property_graph_utils::MergedNbrUnit<vid_t, eid_t>;
   using vid_array_t = typename vineyard::ConvertToArrowType<vid_t>::ArrayType;
 
  public:
@@ -1483,11 +3006,29 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
                                      std::shared_ptr<vertex_map_t> vm_ptr)
       : ArrowFragmentBuilder<oid_t, vid_t>(client), vm_ptr_(vm_ptr) {}
 
+  /**
+   * @brief Permute the edges (and their properties) of every edge label into
+   * the order of the outgoing CSR in `Init`, i.e., sorted by the sources and
+   * then the destinations, thus the properties are scanned sequentially along
+   * the adjacency lists. For directed graphs the eid of an edge equals its
+   * position in the outgoing CSR.
+   *
+   * @param sort_edges Whether to permute the edges.
+   * @param dedup_edges Whether to keep only the first one of the edges of the
+   * same label between the same pair of vertices, requires `sort_edges`.
+   */
+  void set_sort_edges(bool sort_edges, bool dedup_edges = false) {
+    sort_edges_ = sort_edges;
+    dedup_edges_ = sort_edges && dedup_edges;
+  }
+
   vineyard::Status Build(vineyard::Client& client) override {
     this->set_fid(fid_);
     this->set_fnum(fnum_);
     this->set_directed(directed_);
     this->set_label_num(vertex_label_num_, edge_label_num_);
+    this->set_compact_edges(compact_edges_);
+    this->set_merged_edges(merged_edges_);
     this->set_property_graph_schema(schema_);
     {
       vineyard::ArrayBuilder<vid_t> ivnums_builder(client, ivnums_);
@@ -1564,18 +3105,85 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
       }
     }
 
+    if (compact_edges_) {
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        for (label_id_t j = 0; j < edge_label_num_; ++j) {
+          if (directed_) {
+            vineyard::NumericArrayBuilder<uint8_t> ie_builder(
+                client, compact_ie_lists_[i][j]);
+            vineyard::NumericArrayBuilder<int64_t> ieo(
+                client, compact_ie_offsets_lists_[i][j]);
+            this->set_compact_in_edge_list(
+                i, j,
+                std::dynamic_pointer_cast<vineyard::NumericArray<uint8_t>>(
+                    ie_builder.Seal(client)),
+                std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
+                    ieo.Seal(client)));
+          }
+          vineyard::NumericArrayBuilder<uint8_t> oe_builder(
+              client, compact_oe_lists_[i][j]);
+          vineyard::NumericArrayBuilder<int64_t> oeo(
+              client, compact_oe_offsets_lists_[i][j]);
+          this->set_compact_out_edge_list(
+              i, j,
+              std::dynamic_pointer_cast<vineyard::NumericArray<uint8_t>>(
+                  oe_builder.Seal(client)),
+              std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
+                  oeo.Seal(client)));
+        }
+      }
+    }
+
+    if (merged_edges_) {
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        if (directed_) {
+          vineyard::FixedSizeBinaryArrayBuilder ie_builder(client,
+                                                           merged_ie_lists_[i]);
+          vineyard::NumericArrayBuilder<int64_t> ieo(
+              client, merged_ie_offsets_lists_[i]);
+          this->set_merged_in_edge_list(
+              i,
+              std::dynamic_pointer_cast<vineyard::FixedSizeBinaryArray>(
+                  ie_builder.Seal(client)),
+              std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
+                  ieo.Seal(client)));
+        }
+        vineyard::FixedSizeBinaryArrayBuilder oe_builder(client,
+                                                         merged_oe_lists_[i]);
+        vineyard::NumericArrayBuilder<int64_t> oeo(client,
+                                                   merged_oe_offsets_lists_[i]);
+        this->set_merged_out_edge_list(
+            i,
+            std::dynamic_pointer_cast<vineyard::FixedSizeBinaryArray>(
+                oe_builder.Seal(client)),
+            std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
+                oeo.Seal(client)));
+      }
+    }
+
     this->set_vertex_map(vm_ptr_);
     return vineyard::Status::OK();
   }
 
+  /**
+   * @brief Initialize the fragment from the vertex and edge tables.
+   *
+   * @param compact_edges Whether to store the adjacency lists in the compact
+   * encoding, see also `ArrowFragment::compact_edges()`.
+   * @param merged_edges Whether to store the merged adjacency lists of all
+   * edge labels as well, see also `ArrowFragment::merged_edges()`.
+   */
   boost::leaf::result<void> Init(
       fid_t fid, fid_t fnum,
       std::vector<std::shared_ptr<arrow::Table>>&& vertex_tables,
       std::vector<std::shared_ptr<arrow::Table>>&& edge_tables,
-      bool directed = true, int concurrency = 1) {
+      bool directed = true, int concurrency = 1, bool compact_edges = false,
+      bool merged_edges = false) {
     fid_ = fid;
     fnum_ = fnum;
     directed_ = directed;
+    compact_edges_ = compact_edges;
+    merged_edges_ = merged_edges;
     vertex_label_num_ = vertex_tables.size();
     edge_label_num_ = edge_tables.size();
 
@@ -1583,6 +3191,13 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
 
     BOOST_LEAF_CHECK(initVertices(std::move(vertex_tables)));
     BOOST_LEAF_CHECK(initEdges(std::move(edge_tables), concurrency));
+    if (merged_edges_) {
+      // before the NbrUnit-based lists are released by the compaction
+      BOOST_LEAF_CHECK(mergeEdges(concurrency));
+    }
+    if (compact_edges_) {
+      BOOST_LEAF_CHECK(compactEdges(concurrency));
+    }
     return {};
   }
 
@@ -1765,6 +3380,10 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
 #endif
 
       edge_tables[i].reset();
+      if (sort_edges_) {
+        BOOST_LEAF_CHECK(sortEdges(edge_src_[i], edge_dst_[i], edge_tables_[i],
+                                   concurrency));
+      }
     }
 
     oe_lists_.resize(vertex_label_num_);
@@ -1917,7 +3536,8 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
           nbr_unit_t* end = builder.MutablePointer(offsets_ptr[i + 1]);
           std::sort(begin, end,
                     [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
-                      return lhs.vid < rhs.vid;
+                      return lhs.vid < rhs.vid ||
+                             (lhs.vid == rhs.vid && lhs.eid < rhs.eid);
                     });
         }
       } else {
@@ -1928,7 +3548,8 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
               nbr_unit_t* end = builder.MutablePointer(offsets_ptr[i + 1]);
               std::sort(begin, end,
                         [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
-                          return lhs.vid < rhs.vid;
+                          return lhs.vid < rhs.vid ||
+                                 (lhs.vid == rhs.vid && lhs.eid < rhs.eid);
                         });
             },
             concurrency);
@@ -2072,7 +3693,8 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
           nbr_unit_t* end = builder.MutablePointer(offsets_ptr[i + 1]);
           std::sort(begin, end,
                     [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
-                      return lhs.vid < rhs.vid;
+                      return lhs.vid < rhs.vid ||
+                             (lhs.vid == rhs.vid && lhs.eid < rhs.eid);
                     });
         }
       } else {
@@ -2083,7 +3705,8 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
               nbr_unit_t* end = builder.MutablePointer(offsets_ptr[i + 1]);
               std::sort(begin, end,
                         [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
-                          return lhs.vid < rhs.vid;
+                          return lhs.vid < rhs.vid ||
+                                 (lhs.vid == rhs.vid && lhs.eid < rhs.eid);
                         });
             },
             concurrency);
@@ -2095,6 +3718,305 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
     return {};
   }
 
+  // permute the edges into the order of (src, dst), see `set_sort_edges`
+  boost::leaf::result<void> sortEdges(std::shared_ptr<vid_array_t>& src,
+                                      std::shared_ptr<vid_array_t>& dst,
+                                      std::shared_ptr<arrow::Table>& table,
+                                      int concurrency) {
+    int64_t num = src->length();
+    if (num == 0) {
+      return {};
+    }
+    const vid_t* src_ptr = src->raw_values();
+    const vid_t* dst_ptr = dst->raw_values();
+    auto less = [src_ptr, dst_ptr](int64_t lhs, int64_t rhs) {
+      return src_ptr[lhs] < src_ptr[rhs] ||
+             (src_ptr[lhs] == src_ptr[rhs] && dst_ptr[lhs] < dst_ptr[rhs]);
+    };
+    std::vector<int64_t> indices(num);
+    std::iota(indices.begin(), indices.end(), static_cast<int64_t>(0));
+
+    // stable-sort the blocks in parallel, then merge them pairwise, thus the
+    // multi-edges keep the loading order
+    int64_t block_num = std::max(1, concurrency);
+    int64_t block_size = (num + block_num - 1) / block_num;
+    parallel_for(
+        static_cast<int64_t>(0), block_num,
+        [&](int64_t block) {
+          int64_t begin = std::min(block * block_size, num);
+          int64_t end = std::min(begin + block_size, num);
+          std::stable_sort(indices.begin() + begin, indices.begin() + end,
+                           less);
+        },
+        concurrency);
+    for (int64_t width = block_size; width < num; width *= 2) {
+      parallel_for(
+          static_cast<int64_t>(0), (num + 2 * width - 1) / (2 * width),
+          [&](int64_t pair) {
+            int64_t begin = pair * 2 * width;
+            int64_t middle = std::min(begin + width, num);
+            int64_t end = std::min(begin + 2 * width, num);
+            std::inplace_merge(indices.begin() + begin,
+                               indices.begin() + middle,
+                               indices.begin() + end, less);
+          },
+          concurrency);
+    }
+    if (dedup_edges_) {
+      indices.erase(std::unique(indices.begin(), indices.end(),
+                                [src_ptr, dst_ptr](int64_t lhs, int64_t rhs) {
+                                  return src_ptr[lhs] == src_ptr[rhs] &&
+                                         dst_ptr[lhs] == dst_ptr[rhs];
+                                }),
+                    indices.end());
+    }
+
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (int i = 0; i < table->num_columns(); ++i) {
+      BOOST_LEAF_AUTO(column, takeColumn(table->column(i)->chunk(0), indices,
+                                         concurrency));
+      columns.emplace_back(column);
+    }
+    table = arrow::Table::Make(table->schema(), columns, indices.size());
+    BOOST_LEAF_AUTO(sorted_src, takeColumn(src, indices, concurrency));
+    BOOST_LEAF_AUTO(sorted_dst, takeColumn(dst, indices, concurrency));
+    src = std::dynamic_pointer_cast<vid_array_t>(sorted_src);
+    dst = std::dynamic_pointer_cast<vid_array_t>(sorted_dst);
+    return {};
+  }
+
+  template <typename T>
+  boost::leaf::result<std::shared_ptr<arrow::Array>> takeNumericColumn(
+      const std::shared_ptr<arrow::Array>& array,
+      const std::vector<int64_t>& indices, int concurrency) {
+    auto typed_array =
+        std::dynamic_pointer_cast<typename ConvertToArrowType<T>::ArrayType>(
+            array);
+    const T* values = typed_array->raw_values();
+    typename ConvertToArrowType<T>::BuilderType builder;
+    int64_t num = indices.size();
+    ARROW_OK_OR_RAISE(builder.Resize(num));
+    parallel_for(
+        static_cast<int64_t>(0), num,
+        [&](int64_t i) { builder[i] = values[indices[i]]; }, concurrency);
+    ARROW_OK_OR_RAISE(builder.Advance(num));
+    std::shared_ptr<arrow::Array> out;
+    ARROW_OK_OR_RAISE(builder.Finish(&out));
+    return out;
+  }
+
+  template <typename ARRAY_T, typename BUILDER_T>
+  boost::leaf::result<std::shared_ptr<arrow::Array>> takeStringColumn(
+      const std::shared_ptr<arrow::Array>& array,
+      const std::vector<int64_t>& indices) {
+    auto typed_array = std::dynamic_pointer_cast<ARRAY_T>(array);
+    BUILDER_T builder;
+    ARROW_OK_OR_RAISE(builder.Reserve(indices.size()));
+    for (int64_t index : indices) {
+      ARROW_OK_OR_RAISE(builder.Append(typed_array->GetView(index)));
+    }
+    std::shared_ptr<arrow::Array> out;
+    ARROW_OK_OR_RAISE(builder.Finish(&out));
+    return out;
+  }
+
+  // the values of the array at the indices, the nulls are not kept
+  boost::leaf::result<std::shared_ptr<arrow::Array>> takeColumn(
+      const std::shared_ptr<arrow::Array>& array,
+      const std::vector<int64_t>& indices, int concurrency) {
+    switch (array->type()->id()) {
+    case arrow::Type::INT32:
+      return takeNumericColumn<int32_t>(array, indices, concurrency);
+    case arrow::Type::UINT32:
+      return takeNumericColumn<uint32_t>(array, indices, concurrency);
+    case arrow::Type::INT64:
+      return takeNumericColumn<int64_t>(array, indices, concurrency);
+    case arrow::Type::UINT64:
+      return takeNumericColumn<uint64_t>(array, indices, concurrency);
+    case arrow::Type::FLOAT:
+      return takeNumericColumn<float>(array, indices, concurrency);
+    case arrow::Type::DOUBLE:
+      return takeNumericColumn<double>(array, indices, concurrency);
+    case arrow::Type::STRING:
+      return takeStringColumn<arrow::StringArray, arrow::StringBuilder>(
+          array, indices);
+    case arrow::Type::LARGE_STRING:
+      return takeStringColumn<arrow::LargeStringArray,
+                              arrow::LargeStringBuilder>(array, indices);
+    default:
+      RETURN_GS_ERROR(ErrorCode::kDataTypeError,
+                      "Unsupported type of edge property for sorting edges: " +
+                          array->type()->ToString());
+    }
+  }
+
+  // merge the CSR of all edge labels for every vertex label
+  boost::leaf::result<void> mergeEdges(int concurrency) {
+    if (edge_label_num_ > (1 << property_graph_utils::merged_label_bits)) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "Too many edge labels for the merged adjacency lists: " +
+                          std::to_string(edge_label_num_));
+    }
+    for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+      if (static_cast<uint64_t>(edge_tables_[e_label]->num_rows()) >
+          merged_nbr_unit_t::eid_mask) {
+        RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                        "Too many edges for the merged adjacency lists");
+      }
+    }
+    merged_oe_lists_.resize(vertex_label_num_);
+    merged_oe_offsets_lists_.resize(vertex_label_num_);
+    if (directed_) {
+      merged_ie_lists_.resize(vertex_label_num_);
+      merged_ie_offsets_lists_.resize(vertex_label_num_);
+    }
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      BOOST_LEAF_CHECK(generate_merged_csr(
+          oe_lists_[v_label], oe_offsets_lists_[v_label],
+          merged_oe_lists_[v_label], merged_oe_offsets_lists_[v_label],
+          concurrency));
+      if (directed_) {
+        BOOST_LEAF_CHECK(generate_merged_csr(
+            ie_lists_[v_label], ie_offsets_lists_[v_label],
+            merged_ie_lists_[v_label], merged_ie_offsets_lists_[v_label],
+            concurrency));
+      }
+    }
+    return {};
+  }
+
+  boost::leaf::result<void> generate_merged_csr(
+      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> const& edges,
+      std::vector<std::shared_ptr<arrow::Int64Array>> const& edge_offsets,
+      std::shared_ptr<arrow::FixedSizeBinaryArray>& merged_edges,
+      std::shared_ptr<arrow::Int64Array>& merged_offsets, int concurrency) {
+    int64_t vnum =
+        edge_offsets.empty() ? 0 : edge_offsets[0]->length() - 1;
+    std::vector<int64_t> offsets(vnum + 1, 0);
+    parallel_for(
+        static_cast<int64_t>(0), vnum,
+        [&offsets, &edge_offsets](int64_t i) {
+          for (auto const& edge_offset : edge_offsets) {
+            const int64_t* values = edge_offset->raw_values();
+            offsets[i + 1] += values[i + 1] - values[i];
+          }
+        },
+        concurrency);
+    for (int64_t i = 0; i < vnum; ++i) {
+      offsets[i + 1] += offsets[i];
+    }
+
+    vineyard::PodArrayBuilder<merged_nbr_unit_t> builder;
+    ARROW_OK_OR_RAISE(builder.Resize(offsets[vnum]));
+    if (offsets[vnum] > 0) {
+      parallel_for(
+          static_cast<int64_t>(0), vnum,
+          [&offsets, &edges, &edge_offsets, &builder](int64_t i) {
+            merged_nbr_unit_t* out = builder.MutablePointer(offsets[i]);
+            for (size_t e_label = 0; e_label < edges.size(); ++e_label) {
+              const nbr_unit_t* nbrs =
+                  reinterpret_cast<const nbr_unit_t*>(
+                      edges[e_label]->GetValue(0));
+              const int64_t* values = edge_offsets[e_label]->raw_values();
+              for (int64_t k = values[i]; k < values[i + 1]; ++k) {
+                *out++ = merged_nbr_unit_t(nbrs[k].vid, nbrs[k].eid,
+                                           static_cast<int>(e_label));
+              }
+            }
+          },
+          concurrency);
+    }
+    ARROW_OK_OR_RAISE(builder.Advance(offsets[vnum]));
+    ARROW_OK_OR_RAISE(builder.Finish(&merged_edges));
+
+    arrow::Int64Builder offsets_builder;
+    ARROW_OK_OR_RAISE(offsets_builder.AppendValues(offsets));
+    ARROW_OK_OR_RAISE(offsets_builder.Finish(&merged_offsets));
+    return {};
+  }
+
+  // encode the CSR to compact adjacency lists, and release the NbrUnit-based
+  // lists
+  boost::leaf::result<void> compactEdges(int concurrency) {
+    compact_oe_lists_.resize(vertex_label_num_);
+    compact_oe_offsets_lists_.resize(vertex_label_num_);
+    if (directed_) {
+      compact_ie_lists_.resize(vertex_label_num_);
+      compact_ie_offsets_lists_.resize(vertex_label_num_);
+    }
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      compact_oe_lists_[v_label].resize(edge_label_num_);
+      compact_oe_offsets_lists_[v_label].resize(edge_label_num_);
+      if (directed_) {
+        compact_ie_lists_[v_label].resize(edge_label_num_);
+        compact_ie_offsets_lists_[v_label].resize(edge_label_num_);
+      }
+      for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+        // the eids of an edge label are in [0, edge_num)
+        size_t eid_width =
+            varint::fixed_width(edge_tables_[e_label]->num_rows());
+        BOOST_LEAF_CHECK(generate_compact_csr(
+            oe_lists_[v_label][e_label], oe_offsets_lists_[v_label][e_label],
+            eid_width, compact_oe_lists_[v_label][e_label],
+            compact_oe_offsets_lists_[v_label][e_label], concurrency));
+        if (directed_) {
+          BOOST_LEAF_CHECK(generate_compact_csr(
+              ie_lists_[v_label][e_label], ie_offsets_lists_[v_label][e_label],
+              eid_width, compact_ie_lists_[v_label][e_label],
+              compact_ie_offsets_lists_[v_label][e_label], concurrency));
+        }
+      }
+    }
+    return {};
+  }
+
+  boost::leaf::result<void> generate_compact_csr(
+      std::shared_ptr<arrow::FixedSizeBinaryArray>& edges,
+      std::shared_ptr<arrow::Int64Array> const& edge_offsets,
+      size_t const eid_width, std::shared_ptr<arrow::UInt8Array>& compact_edges,
+      std::shared_ptr<arrow::Int64Array>& compact_offsets, int concurrency) {
+    const nbr_unit_t* nbrs =
+        reinterpret_cast<const nbr_unit_t*>(edges->GetValue(0));
+    const int64_t* offsets = edge_offsets->raw_values();
+    int64_t vnum = edge_offsets->length() - 1;
+
+    std::vector<int64_t> byte_offsets(vnum + 1, 0);
+    parallel_for(
+        static_cast<int64_t>(0), vnum,
+        [&byte_offsets, nbrs, offsets, eid_width](int64_t i) {
+          byte_offsets[i + 1] = property_graph_utils::compact_adj_list_size(
+              nbrs + offsets[i], nbrs + offsets[i + 1], eid_width);
+        },
+        concurrency);
+    for (int64_t i = 0; i < vnum; ++i) {
+      byte_offsets[i + 1] += byte_offsets[i];
+    }
+
+    typename ConvertToArrowType<uint8_t>::BuilderType builder;
+    ARROW_OK_OR_RAISE(builder.Resize(byte_offsets[vnum]));
+    if (byte_offsets[vnum] > 0) {
+      uint8_t* data = &builder[0];
+      parallel_for(
+          static_cast<int64_t>(0), vnum,
+          [&byte_offsets, nbrs, offsets, eid_width, data](int64_t i) {
+            property_graph_utils::encode_compact_adj_list(
+                nbrs + offsets[i], nbrs + offsets[i + 1], eid_width,
+                data + byte_offsets[i]);
+          },
+          concurrency);
+    }
+    ARROW_OK_OR_RAISE(builder.Advance(byte_offsets[vnum]));
+    ARROW_OK_OR_RAISE(builder.Finish(&compact_edges));
+
+    arrow::Int64Builder offsets_builder;
+    ARROW_OK_OR_RAISE(offsets_builder.AppendValues(byte_offsets));
+    ARROW_OK_OR_RAISE(offsets_builder.Finish(&compact_offsets));
+
+    vineyard::PodArrayBuilder<nbr_unit_t> empty_builder;
+    ARROW_OK_OR_RAISE(empty_builder.Finish(&edges));
+    return {};
+  }
+
   fid_t fid_, fnum_;
   bool directed_;
   label_id_t vertex_label_num_;
@@ -2116,6 +4038,21 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
   std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
       ie_offsets_lists_, oe_offsets_lists_;
 
+  bool compact_edges_ = false;
+  std::vector<std::vector<std::shared_ptr<arrow::UInt8Array>>>
+      compact_ie_lists_, compact_oe_lists_;
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+      compact_ie_offsets_lists_, compact_oe_offsets_lists_;
+
+  bool sort_edges_ = false;
+  bool dedup_edges_ = false;
+
+  bool merged_edges_ = false;
+  std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> merged_ie_lists_,
+      merged_oe_lists_;
+  std::vector<std::shared_ptr<arrow::Int64Array>> merged_ie_offsets_lists_,
+      merged_oe_offsets_lists_;
+
   std::shared_ptr<vertex_map_t> vm_ptr_;
 
   vineyard::IdParser<vid_t> vid_parser_;
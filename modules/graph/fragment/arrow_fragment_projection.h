@@ -0,0 +1,382 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_PROJECTION_H_
+#define MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_PROJECTION_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "boost/leaf/all.hpp"
+
+#include "basic/ds/array.h"
+#include "basic/ds/arrow.h"
+#include "client/client.h"
+#include "common/util/uuid.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/fragment/property_graph_types.h"
+#include "graph/utils/error.h"
+
+namespace vineyard {
+
+template <typename OID_T, typename VID_T>
+class ArrowFragmentProjectionBuilder;
+
+/**
+ * @brief ArrowFragmentProjection is the materialized projection of an
+ * `ArrowFragment` to a simple graph of one vertex label and one edge label,
+ * with (optionally) one vertex property and one edge property.
+ *
+ * Only the derived arrays are stored, i.e., the ranges of the neighbors of the
+ * projected vertex label in the adjacency lists of every vertex, and the
+ * adjacency lists themselves are shared with the fragment. The projections
+ * are named by the fragment id and the projection spec, see also
+ * `ProjectFragment`, thus are reused by later runs and by other processes.
+ */
+template <typename OID_T, typename VID_T>
+class ArrowFragmentProjection
+    : public vineyard::Registered<ArrowFragmentProjection<OID_T, VID_T>> {
+ public:
+  using fragment_t = ArrowFragment<OID_T, VID_T>;
+  using vid_t = VID_T;
+  using label_id_t = property_graph_types::LABEL_ID_TYPE;
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+  using vertex_t = typename fragment_t::vertex_t;
+  using vertex_range_t = typename fragment_t::vertex_range_t;
+  using adj_list_t = typename fragment_t::adj_list_t;
+
+  static std::shared_ptr<vineyard::Object> Create() __attribute__((used)) {
+    return std::static_pointer_cast<vineyard::Object>(
+        std::make_shared<ArrowFragmentProjection<OID_T, VID_T>>());
+  }
+
+  void Construct(const vineyard::ObjectMeta& meta) override {
+    this->meta_ = meta;
+    this->id_ = meta.GetId();
+
+    fragment_ = std::make_shared<fragment_t>();
+    fragment_->Construct(meta.GetMemberMeta("fragment"));
+    v_label_ = meta.GetKeyValue<label_id_t>("v_label");
+    v_prop_ = meta.GetKeyValue<prop_id_t>("v_prop");
+    e_label_ = meta.GetKeyValue<label_id_t>("e_label");
+    e_prop_ = meta.GetKeyValue<prop_id_t>("e_prop");
+
+    oe_offsets_begin_ = constructArray(meta, "oe_offsets_begin");
+    oe_offsets_end_ = constructArray(meta, "oe_offsets_end");
+    if (fragment_->directed()) {
+      ie_offsets_begin_ = constructArray(meta, "ie_offsets_begin");
+      ie_offsets_end_ = constructArray(meta, "ie_offsets_end");
+    } else {
+      ie_offsets_begin_ = oe_offsets_begin_;
+      ie_offsets_end_ = oe_offsets_end_;
+    }
+    oe_begin_ptr_ = oe_offsets_begin_->raw_values();
+    oe_end_ptr_ = oe_offsets_end_->raw_values();
+    ie_begin_ptr_ = ie_offsets_begin_->raw_values();
+    ie_end_ptr_ = ie_offsets_end_->raw_values();
+  }
+
+  std::shared_ptr<fragment_t> fragment() const { return fragment_; }
+
+  label_id_t vertex_label() const { return v_label_; }
+
+  prop_id_t vertex_prop() const { return v_prop_; }
+
+  label_id_t edge_label() const { return e_label_; }
+
+  prop_id_t edge_prop() const { return e_prop_; }
+
+  vertex_range_t Vertices() const { return fragment_->Vertices(v_label_); }
+
+  vertex_range_t InnerVertices() const {
+    return fragment_->InnerVertices(v_label_);
+  }
+
+  vertex_range_t OuterVertices() const {
+    return fragment_->OuterVertices(v_label_);
+  }
+
+  /**
+   * @brief The value of the projected vertex property, only valid when the
+   * vertex property is projected, i.e., `vertex_prop()` is not -1.
+   */
+  template <typename T>
+  T GetData(const vertex_t& v) const {
+    return fragment_->template GetData<T>(v, v_prop_);
+  }
+
+  /**
+   * @brief The outgoing edges of the projected edge label from `v` to the
+   * vertices of the projected vertex label, the `v` must be a vertex of the
+   * projected vertex label.
+   */
+  inline adj_list_t GetOutgoingAdjList(const vertex_t& v) const {
+    int64_t v_offset = fragment_->vid_parser_.GetOffset(v.GetValue());
+    const auto* oe = fragment_->oe_ptr_lists_[v_label_][e_label_];
+    return adj_list_t(&oe[oe_begin_ptr_[v_offset]], &oe[oe_end_ptr_[v_offset]],
+                      fragment_->flatten_edge_tables_columns_[e_label_]);
+  }
+
+  inline adj_list_t GetIncomingAdjList(const vertex_t& v) const {
+    int64_t v_offset = fragment_->vid_parser_.GetOffset(v.GetValue());
+    const auto* ie = fragment_->ie_ptr_lists_[v_label_][e_label_];
+    return adj_list_t(&ie[ie_begin_ptr_[v_offset]], &ie[ie_end_ptr_[v_offset]],
+                      fragment_->flatten_edge_tables_columns_[e_label_]);
+  }
+
+  inline int GetLocalOutDegree(const vertex_t& v) const {
+    int64_t v_offset = fragment_->vid_parser_.GetOffset(v.GetValue());
+    return oe_end_ptr_[v_offset] - oe_begin_ptr_[v_offset];
+  }
+
+  inline int GetLocalInDegree(const vertex_t& v) const {
+    int64_t v_offset = fragment_->vid_parser_.GetOffset(v.GetValue());
+    return ie_end_ptr_[v_offset] - ie_begin_ptr_[v_offset];
+  }
+
+ private:
+  std::shared_ptr<arrow::Int64Array> constructArray(
+      const vineyard::ObjectMeta& meta, const std::string& name) {
+    vineyard::NumericArray<int64_t> array;
+    array.Construct(meta.GetMemberMeta(name));
+    return array.GetArray();
+  }
+
+  std::shared_ptr<fragment_t> fragment_;
+  label_id_t v_label_;
+  prop_id_t v_prop_;
+  label_id_t e_label_;
+  prop_id_t e_prop_;
+
+  // the ranges of the neighbors of the projected vertex label, in the
+  // adjacency lists of every vertex (including the outer vertices)
+  std::shared_ptr<arrow::Int64Array> ie_offsets_begin_, ie_offsets_end_;
+  std::shared_ptr<arrow::Int64Array> oe_offsets_begin_, oe_offsets_end_;
+  const int64_t *ie_begin_ptr_, *ie_end_ptr_;
+  const int64_t *oe_begin_ptr_, *oe_end_ptr_;
+
+  friend class ArrowFragmentProjectionBuilder<OID_T, VID_T>;
+};
+
+template <typename OID_T, typename VID_T>
+class ArrowFragmentProjectionBuilder : public vineyard::ObjectBuilder {
+  using fragment_t = ArrowFragment<OID_T, VID_T>;
+  using vid_t = VID_T;
+  using label_id_t = property_graph_types::LABEL_ID_TYPE;
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+  using nbr_unit_t = typename fragment_t::nbr_unit_t;
+
+ public:
+  ArrowFragmentProjectionBuilder(std::shared_ptr<fragment_t> fragment,
+                                 label_id_t v_label, prop_id_t v_prop,
+                                 label_id_t e_label, prop_id_t e_prop)
+      : fragment_(fragment),
+        v_label_(v_label),
+        v_prop_(v_prop),
+        e_label_(e_label),
+        e_prop_(e_prop) {}
+
+  /**
+   * @brief Compute the ranges of the neighbors of the projected vertex label,
+   * using `concurrency` threads.
+   */
+  boost::leaf::result<void> Init(int concurrency = 1) {
+    if (fragment_->compact_edges()) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "Fragments with compact edges cannot be projected");
+    }
+    if (fragment_->has_delta_edges()) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "Fragments with delta edges cannot be projected, the "
+                      "delta edges should be compacted first");
+    }
+    if (v_label_ < 0 || v_label_ >= fragment_->vertex_label_num() ||
+        e_label_ < 0 || e_label_ >= fragment_->edge_label_num()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Invalid label of the projection");
+    }
+    if (v_prop_ < -1 || v_prop_ >= fragment_->vertex_property_num(v_label_) ||
+        e_prop_ < -1 || e_prop_ >= fragment_->edge_property_num(e_label_)) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Invalid property of the projection");
+    }
+
+    BOOST_LEAF_CHECK(generateRanges(
+        fragment_->oe_ptr_lists_[v_label_][e_label_],
+        fragment_->oe_offsets_ptr_lists_[v_label_][e_label_],
+        oe_offsets_begin_, oe_offsets_end_, concurrency));
+    if (fragment_->directed()) {
+      BOOST_LEAF_CHECK(generateRanges(
+          fragment_->ie_ptr_lists_[v_label_][e_label_],
+          fragment_->ie_offsets_ptr_lists_[v_label_][e_label_],
+          ie_offsets_begin_, ie_offsets_end_, concurrency));
+    }
+    return {};
+  }
+
+  vineyard::Status Build(vineyard::Client& client) override {
+    return vineyard::Status::OK();
+  }
+
+  std::shared_ptr<vineyard::Object> _Seal(vineyard::Client& client) override {
+    // ensure the builder hasn't been sealed yet.
+    ENSURE_NOT_SEALED(this);
+
+    VINEYARD_CHECK_OK(this->Build(client));
+
+    auto projection = std::make_shared<ArrowFragmentProjection<OID_T, VID_T>>();
+    projection->meta_.SetTypeName(
+        type_name<ArrowFragmentProjection<OID_T, VID_T>>());
+    projection->meta_.AddMember("fragment", fragment_->meta());
+    projection->meta_.AddKeyValue("v_label", v_label_);
+    projection->meta_.AddKeyValue("v_prop", v_prop_);
+    projection->meta_.AddKeyValue("e_label", e_label_);
+    projection->meta_.AddKeyValue("e_prop", e_prop_);
+
+    size_t nbytes = 0;
+    auto seal_array = [&](const std::string& name,
+                          std::shared_ptr<arrow::Int64Array> const& array) {
+      vineyard::NumericArrayBuilder<int64_t> builder(client, array);
+      auto sealed = builder.Seal(client);
+      projection->meta_.AddMember(name, sealed->meta());
+      nbytes += sealed->nbytes();
+    };
+    seal_array("oe_offsets_begin", oe_offsets_begin_);
+    seal_array("oe_offsets_end", oe_offsets_end_);
+    if (fragment_->directed()) {
+      seal_array("ie_offsets_begin", ie_offsets_begin_);
+      seal_array("ie_offsets_end", ie_offsets_end_);
+    }
+    projection->meta_.SetNBytes(nbytes);
+
+    VINEYARD_CHECK_OK(
+        client.CreateMetaData(projection->meta_, projection->id_));
+    // mark the builder as sealed
+    this->set_sealed(true);
+
+    return std::static_pointer_cast<vineyard::Object>(projection);
+  }
+
+ private:
+  // the neighbors are sorted by the local ids, where the vertex label is
+  // in the highest bits, thus those of a vertex label are contiguous
+  boost::leaf::result<void> generateRanges(
+      const nbr_unit_t* nbrs, const int64_t* offsets,
+      std::shared_ptr<arrow::Int64Array>& begins,
+      std::shared_ptr<arrow::Int64Array>& ends, int concurrency) {
+    const auto& vid_parser = fragment_->vid_parser_;
+    label_id_t v_label = v_label_;
+    int64_t tvnum = fragment_->GetVerticesNum(v_label_);
+
+    arrow::Int64Builder begins_builder, ends_builder;
+    ARROW_OK_OR_RAISE(begins_builder.Resize(tvnum));
+    ARROW_OK_OR_RAISE(ends_builder.Resize(tvnum));
+    parallel_for(
+        static_cast<int64_t>(0), tvnum,
+        [&](int64_t i) {
+          const nbr_unit_t* begin = nbrs + offsets[i];
+          const nbr_unit_t* end = nbrs + offsets[i + 1];
+          const nbr_unit_t* lower = std::lower_bound(
+              begin, end, v_label,
+              [&vid_parser](const nbr_unit_t& nbr, label_id_t label) {
+                return vid_parser.GetLabelId(nbr.vid) < label;
+              });
+          const nbr_unit_t* upper = std::upper_bound(
+              lower, end, v_label,
+              [&vid_parser](label_id_t label, const nbr_unit_t& nbr) {
+                return label < vid_parser.GetLabelId(nbr.vid);
+              });
+          begins_builder[i] = lower - nbrs;
+          ends_builder[i] = upper - nbrs;
+        },
+        concurrency);
+    ARROW_OK_OR_RAISE(begins_builder.Advance(tvnum));
+    ARROW_OK_OR_RAISE(ends_builder.Advance(tvnum));
+    ARROW_OK_OR_RAISE(begins_builder.Finish(&begins));
+    ARROW_OK_OR_RAISE(ends_builder.Finish(&ends));
+    return {};
+  }
+
+  std::shared_ptr<fragment_t> fragment_;
+  label_id_t v_label_;
+  prop_id_t v_prop_;
+  label_id_t e_label_;
+  prop_id_t e_prop_;
+
+  std::shared_ptr<arrow::Int64Array> ie_offsets_begin_, ie_offsets_end_;
+  std::shared_ptr<arrow::Int64Array> oe_offsets_begin_, oe_offsets_end_;
+};
+
+/**
+ * @brief The name of the projection of the fragment to the spec.
+ */
+inline std::string ProjectionName(const ObjectID fragment_id,
+                                  property_graph_types::LABEL_ID_TYPE v_label,
+                                  property_graph_types::PROP_ID_TYPE v_prop,
+                                  property_graph_types::LABEL_ID_TYPE e_label,
+                                  property_graph_types::PROP_ID_TYPE e_prop) {
+  return "__projection_" + VYObjectIDToString(fragment_id) + "_" +
+         std::to_string(v_label) + "_" + std::to_string(v_prop) + "_" +
+         std::to_string(e_label) + "_" + std::to_string(e_prop);
+}
+
+/**
+ * @brief Project the fragment to the spec, the projection that has been
+ * materialized for the fragment and the spec before, by this or other
+ * processes, is reused. Otherwise the projection is sealed and named for
+ * later runs.
+ *
+ * The projections are not dropped with the fragment, they should be deleted
+ * (and their names dropped) before the fragment itself.
+ */
+template <typename OID_T, typename VID_T>
+boost::leaf::result<std::shared_ptr<ArrowFragmentProjection<OID_T, VID_T>>>
+ProjectFragment(vineyard::Client& client,
+                std::shared_ptr<ArrowFragment<OID_T, VID_T>> fragment,
+                property_graph_types::LABEL_ID_TYPE v_label,
+                property_graph_types::PROP_ID_TYPE v_prop,
+                property_graph_types::LABEL_ID_TYPE e_label,
+                property_graph_types::PROP_ID_TYPE e_prop,
+                int concurrency = 1) {
+  using projection_t = ArrowFragmentProjection<OID_T, VID_T>;
+  std::string name =
+      ProjectionName(fragment->id(), v_label, v_prop, e_label, e_prop);
+
+  ObjectID projection_id = InvalidObjectID();
+  if (client.GetName(name, projection_id, false).ok()) {
+    std::shared_ptr<projection_t> projection;
+    if (client.GetObject(projection_id, projection).ok()) {
+      return projection;
+    }
+    // the named projection has been deleted
+    VY_OK_OR_RAISE(client.DropName(name));
+  }
+
+  ArrowFragmentProjectionBuilder<OID_T, VID_T> builder(fragment, v_label,
+                                                       v_prop, e_label, e_prop);
+  BOOST_LEAF_CHECK(builder.Init(concurrency));
+  auto projection =
+      std::dynamic_pointer_cast<projection_t>(builder.Seal(client));
+  VY_OK_OR_RAISE(client.PutName(projection->id(), name));
+  return projection;
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_PROJECTION_H_
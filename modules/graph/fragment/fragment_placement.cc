@@ -0,0 +1,177 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "graph/fragment/fragment_placement.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "common/util/boost.h"
+
+namespace vineyard {
+
+namespace {
+
+// the weights of bytes that are local to the instance, the host and the zone
+constexpr double kInstanceLocality = 1.0;
+constexpr double kHostLocality = 0.5;
+constexpr double kZoneLocality = 0.25;
+
+}  // namespace
+
+Status FragmentPlacement::Refresh() {
+  std::map<InstanceID, ptree> cluster;
+  RETURN_ON_ERROR(client_.ClusterInfo(cluster));
+  instances_.clear();
+  for (auto const& item : cluster) {
+    InstanceInfo info;
+    info.instance_id = item.first;
+    info.hostname = item.second.get<std::string>("hostname", "");
+    info.zone = item.second.get<std::string>("zone", "");
+    info.memory_usage = item.second.get<size_t>("memory_usage", 0);
+    info.memory_limit = item.second.get<size_t>("memory_limit", 0);
+    info.numa_nodes = std::max(1, item.second.get<int>("numa_nodes", 1));
+    instances_.emplace(item.first, info);
+  }
+  if (instances_.empty()) {
+    return Status::Invalid("No vineyard instance found in the cluster");
+  }
+  return Status::OK();
+}
+
+Status FragmentPlacement::PlaceFragments(
+    const std::vector<size_t>& fragment_sizes,
+    std::vector<InstanceID>& locations) const {
+  if (instances_.empty()) {
+    return Status::Invalid("The cluster info hasn't been fetched, call "
+                           "Refresh() first");
+  }
+  // the larger fragments are placed first
+  std::vector<size_t> order(fragment_sizes.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return fragment_sizes[lhs] > fragment_sizes[rhs];
+  });
+
+  std::map<InstanceID, size_t> assigned_bytes;
+  std::map<InstanceID, size_t> assigned_num;
+  std::unordered_map<std::string, size_t> host_num;
+  locations.assign(fragment_sizes.size(), UnspecifiedInstanceID());
+  for (size_t index : order) {
+    size_t size = fragment_sizes[index];
+    const InstanceInfo* best = nullptr;
+    std::tuple<bool, double, size_t, size_t> best_key;
+    for (auto const& item : instances_) {
+      const InstanceInfo& info = item.second;
+      size_t used = assigned_bytes[info.instance_id];
+      size_t headroom = info.headroom() > used ? info.headroom() - used : 0;
+      // fits in memory, fewer fragments per NUMA node, fewer fragments on
+      // the host, then more free memory
+      auto key = std::make_tuple(
+          headroom >= size,
+          -static_cast<double>(assigned_num[info.instance_id]) /
+              info.numa_nodes,
+          std::numeric_limits<size_t>::max() - host_num[info.hostname],
+          headroom);
+      if (best == nullptr || key > best_key) {
+        best = &info;
+        best_key = key;
+      }
+    }
+    locations[index] = best->instance_id;
+    assigned_bytes[best->instance_id] += size;
+    assigned_num[best->instance_id] += 1;
+    host_num[best->hostname] += 1;
+  }
+  return Status::OK();
+}
+
+Status FragmentPlacement::RankInstances(ArrowFragmentGroup& group,
+                                        const std::vector<fid_t>& fids,
+                                        std::vector<InstanceID>& ranked) const {
+  if (instances_.empty()) {
+    return Status::Invalid("The cluster info hasn't been fetched, call "
+                           "Refresh() first");
+  }
+  auto const& fragments = group.Fragments();
+  auto const& locations = group.FragmentLocations();
+  std::map<InstanceID, size_t> local_bytes;
+  size_t total_bytes = 0;
+  for (fid_t fid : fids) {
+    auto fragment = fragments.find(fid);
+    auto location = locations.find(fid);
+    if (fragment == fragments.end() || location == locations.end()) {
+      return Status::Invalid("Fragment " + std::to_string(fid) +
+                             " is not in the fragment group");
+    }
+    ObjectMeta meta;
+    RETURN_ON_ERROR(client_.GetMetaData(fragment->second, meta, true));
+    local_bytes[location->second] += meta.GetNBytes();
+    total_bytes += meta.GetNBytes();
+  }
+
+  std::vector<std::tuple<bool, double, size_t, InstanceID>> scores;
+  for (auto const& candidate : instances_) {
+    const InstanceInfo& info = candidate.second;
+    double score = 0;
+    size_t fetched_bytes = total_bytes;
+    for (auto const& item : local_bytes) {
+      auto owner = instances_.find(item.first);
+      if (item.first == info.instance_id) {
+        score += kInstanceLocality * item.second;
+        fetched_bytes -= item.second;
+      } else if (owner == instances_.end()) {
+        continue;
+      } else if (owner->second.hostname == info.hostname) {
+        score += kHostLocality * item.second;
+      } else if (!info.zone.empty() && owner->second.zone == info.zone) {
+        score += kZoneLocality * item.second;
+      }
+    }
+    scores.emplace_back(info.headroom() >= fetched_bytes, score,
+                        info.headroom(), info.instance_id);
+  }
+  std::sort(scores.begin(), scores.end(),
+            [](const std::tuple<bool, double, size_t, InstanceID>& lhs,
+               const std::tuple<bool, double, size_t, InstanceID>& rhs) {
+              return std::make_tuple(std::get<0>(lhs), std::get<1>(lhs),
+                                     std::get<2>(lhs)) >
+                     std::make_tuple(std::get<0>(rhs), std::get<1>(rhs),
+                                     std::get<2>(rhs));
+            });
+  ranked.clear();
+  for (auto const& score : scores) {
+    ranked.emplace_back(std::get<3>(score));
+  }
+  return Status::OK();
+}
+
+Status FragmentPlacement::BestInstance(ArrowFragmentGroup& group,
+                                       const std::vector<fid_t>& fids,
+                                       InstanceID& instance_id) const {
+  std::vector<InstanceID> ranked;
+  RETURN_ON_ERROR(RankInstances(group, fids, ranked));
+  instance_id = ranked.front();
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,98 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_FRAGMENT_FRAGMENT_PLACEMENT_H_
+#define MODULES_GRAPH_FRAGMENT_FRAGMENT_PLACEMENT_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/status.h"
+
+#include "graph/fragment/arrow_fragment_group.h"
+#include "graph/fragment/property_graph_types.h"
+
+namespace vineyard {
+
+/**
+ * @brief FragmentPlacement decides where the fragments of a graph should
+ * live, and where the computation on a set of fragments should run, based on
+ * the topology and the memory of the vineyard instances in the cluster.
+ *
+ * The topology is the hostname and the optional `--zone` of every vineyardd,
+ * and the memory usage is refreshed along with the heartbeat of instances,
+ * see also `ClientBase::ClusterInfo()`.
+ */
+class FragmentPlacement {
+ public:
+  struct InstanceInfo {
+    InstanceID instance_id;
+    std::string hostname;
+    std::string zone;
+    size_t memory_usage = 0;
+    size_t memory_limit = 0;
+    int numa_nodes = 1;
+
+    size_t headroom() const {
+      return memory_limit > memory_usage ? memory_limit - memory_usage : 0;
+    }
+  };
+
+  explicit FragmentPlacement(Client& client) : client_(client) {}
+
+  /**
+   * @brief Fetch the latest cluster info from the vineyard server.
+   */
+  Status Refresh();
+
+  const std::map<InstanceID, InstanceInfo>& Instances() const {
+    return instances_;
+  }
+
+  /**
+   * @brief Assign the fragments of the given sizes (in bytes) to instances,
+   * the fragments are spread over the NUMA nodes and hosts as evenly as
+   * possible, and go to the instances with more free memory first.
+   */
+  Status PlaceFragments(const std::vector<size_t>& fragment_sizes,
+                        std::vector<InstanceID>& locations) const;
+
+  /**
+   * @brief Rank the instances by the locality to the given fragments of the
+   * group: the bytes on the same instance count fully, the bytes on the same
+   * host and in the same zone count partially, and the instances that can't
+   * hold the bytes to fetch from elsewhere are ranked last.
+   */
+  Status RankInstances(ArrowFragmentGroup& group,
+                       const std::vector<fid_t>& fids,
+                       std::vector<InstanceID>& ranked) const;
+
+  /**
+   * @brief The best instance to run the computation on the given fragments.
+   */
+  Status BestInstance(ArrowFragmentGroup& group,
+                      const std::vector<fid_t>& fids,
+                      InstanceID& instance_id) const;
+
+ private:
+  Client& client_;
+  std::map<InstanceID, InstanceInfo> instances_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_FRAGMENT_PLACEMENT_H_
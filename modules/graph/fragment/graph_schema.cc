@@ -17,8 +17,11 @@ limitations under the License.
 
 #include <cctype>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "arrow/api.h"
@@ -79,6 +82,45 @@ PropertyType PropertyTypeFromString(const std::string& type) {
   return arrow::null();
 }
 
+/**
+ * The index of the named item, which is looked up in the pre-built index,
+ * and falls back to the linear scan if the index is stale, as the items
+ * are public and may be changed in place.
+ */
+template <typename T, typename NAME_FUNC_T>
+int64_t index_of(std::vector<T> const& items,
+                 std::unordered_map<std::string, size_t> const& index,
+                 std::string const& name, NAME_FUNC_T name_of) {
+  auto iter = index.find(name);
+  if (iter != index.end() && iter->second < items.size() &&
+      name_of(items[iter->second]) == name) {
+    return iter->second;
+  }
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (name_of(items[i]) == name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// the cached schemas are rarely more than a few, thus a small bound suffices
+// to keep a long-lived process from accumulating the stale ones
+constexpr size_t kMaxCachedSchemas = 64;
+
+std::mutex& schema_cache_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::unordered_map<std::string, std::shared_ptr<const PropertyGraphSchema>>&
+schema_cache() {
+  static std::unordered_map<std::string,
+                            std::shared_ptr<const PropertyGraphSchema>>
+      cache;
+  return cache;
+}
+
 }  // namespace detail
 
 using boost::property_tree::ptree;
@@ -99,6 +141,7 @@ void Entry::PropertyDef::FromJSON(const ptree& root) {
 }
 
 void Entry::AddProperty(const std::string& name, PropertyType type) {
+  prop_index[name] = props.size();
   props.emplace_back(PropertyDef{
       .id = static_cast<int>(props.size()), .name = name, .type = type});
 }
@@ -115,12 +158,10 @@ void Entry::AddRelation(const std::string& src, const std::string& dst) {
 }
 
 Entry::PropertyId Entry::GetPropertyId(const std::string& name) const {
-  for (const auto& prop : props) {
-    if (prop.name == name) {
-      return prop.id;
-    }
-  }
-  return -1;
+  auto index = detail::index_of(
+      props, prop_index, name,
+      [](PropertyDef const& prop) -> std::string const& { return prop.name; });
+  return index == -1 ? -1 : props[index].id;
 }
 
 std::string Entry::GetPropertyName(PropertyId prop_id) const {
@@ -193,6 +234,7 @@ void Entry::FromJSON(const ptree& root) {
   for (const auto& kv : prop_array) {
     PropertyDef prop;
     prop.FromJSON(kv.second);
+    prop_index[prop.name] = props.size();
     props.emplace_back(prop);
   }
   // indexes
@@ -260,12 +302,10 @@ std::string PropertyGraphSchema::GetEdgePropertyName(LabelId label_id,
 
 PropertyGraphSchema::LabelId PropertyGraphSchema::GetVertexLabelId(
     const std::string& name) const {
-  for (const auto& entry : vertex_entries_) {
-    if (entry.label == name) {
-      return entry.id;
-    }
-  }
-  return -1;
+  auto index = detail::index_of(
+      vertex_entries_, vertex_label_index_, name,
+      [](Entry const& entry) -> std::string const& { return entry.label; });
+  return index == -1 ? -1 : vertex_entries_[index].id;
 }
 
 std::string PropertyGraphSchema::GetVertexLabelName(LabelId label_id) const {
@@ -274,12 +314,10 @@ std::string PropertyGraphSchema::GetVertexLabelName(LabelId label_id) const {
 
 PropertyGraphSchema::LabelId PropertyGraphSchema::GetEdgeLabelId(
     const std::string& name) const {
-  for (const auto& entry : edge_entries_) {
-    if (entry.label == name) {
-      return entry.id;
-    }
-  }
-  return -1;
+  auto index = detail::index_of(
+      edge_entries_, edge_label_index_, name,
+      [](Entry const& entry) -> std::string const& { return entry.label; });
+  return index == -1 ? -1 : edge_entries_[index].id;
 }
 
 std::string PropertyGraphSchema::GetEdgeLabelName(LabelId label_id) const {
@@ -289,12 +327,14 @@ std::string PropertyGraphSchema::GetEdgeLabelName(LabelId label_id) const {
 Entry* PropertyGraphSchema::CreateEntry(const std::string& name,
                                         const std::string& type) {
   if (type == "VERTEX") {
+    vertex_label_index_[name] = vertex_entries_.size();
     vertex_entries_.emplace_back(
         Entry{.id = static_cast<int>(vertex_entries_.size()),
               .label = name,
               .type = type});
     return &*vertex_entries_.rbegin();
   } else {
+    edge_label_index_[name] = edge_entries_.size();
     edge_entries_.emplace_back(
         Entry{.id = static_cast<int>(edge_entries_.size()),
               .label = name,
@@ -369,8 +409,10 @@ void PropertyGraphSchema::FromJSON(ptree const& root) {
     Entry entry;
     entry.FromJSON(kv.second);
     if (entry.type == "VERTEX") {
+      vertex_label_index_[entry.label] = vertex_entries_.size();
       vertex_entries_.push_back(std::move(entry));
     } else {
+      edge_label_index_[entry.label] = edge_entries_.size();
       edge_entries_.push_back(std::move(entry));
     }
   }
@@ -391,6 +433,28 @@ void PropertyGraphSchema::FromJSONString(std::string const& schema) {
   FromJSON(root);
 }
 
+void PropertyGraphSchema::FromCachedJSONString(std::string const& schema) {
+  {
+    std::lock_guard<std::mutex> lock(detail::schema_cache_mutex());
+    auto& cache = detail::schema_cache();
+    auto iter = cache.find(schema);
+    if (iter != cache.end()) {
+      *this = *iter->second;
+      return;
+    }
+  }
+  auto parsed = std::make_shared<PropertyGraphSchema>();
+  parsed->FromJSONString(schema);
+  *this = *parsed;
+
+  std::lock_guard<std::mutex> lock(detail::schema_cache_mutex());
+  auto& cache = detail::schema_cache();
+  if (cache.size() >= detail::kMaxCachedSchemas) {
+    cache.clear();
+  }
+  cache.emplace(schema, std::move(parsed));
+}
+
 void PropertyGraphSchema::DumpToFile(std::string const& path) {
   std::ofstream json_file;
   json_file.open(path);
@@ -536,6 +600,28 @@ void MaxGraphSchema::FromJSONString(std::string const& schema) {
   FromJSON(root);
 }
 
+void PropertyGraphSchema::FromCachedJSONString(std::string const& schema) {
+  {
+    std::lock_guard<std::mutex> lock(detail::schema_cache_mutex());
+    auto& cache = detail::schema_cache();
+    auto iter = cache.find(schema);
+    if (iter != cache.end()) {
+      *this = *iter->second;
+      return;
+    }
+  }
+  auto parsed = std::make_shared<PropertyGraphSchema>();
+  parsed->FromJSONString(schema);
+  *this = *parsed;
+
+  std::lock_guard<std::mutex> lock(detail::schema_cache_mutex());
+  auto& cache = detail::schema_cache();
+  if (cache.size() >= detail::kMaxCachedSchemas) {
+    cache.clear();
+  }
+  cache.emplace(schema, std::move(parsed));
+}
+
 void MaxGraphSchema::DumpToFile(std::string const& path) {
   std::ofstream json_file;
   json_file.open(path);
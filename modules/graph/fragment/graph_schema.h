@@ -59,6 +59,9 @@ class Entry {
   std::vector<int> mapping;          // old prop id -> new prop id
   std::vector<int> reverse_mapping;  // new prop id -> old prop id
 
+  // prop name -> index in props, maintained by AddProperty and FromJSON
+  std::unordered_map<std::string, size_t> prop_index;
+
   void AddProperty(const std::string& name, PropertyType type);
   void AddPrimaryKeys(size_t key_count,
                       const std::vector<std::string>& key_name_list);
@@ -97,8 +100,10 @@ class PropertyGraphSchema {
 
   void AddEntry(const Entry& entry) {
     if (entry.type == "VERTEX") {
+      vertex_label_index_[entry.label] = vertex_entries_.size();
       vertex_entries_.push_back(entry);
     } else {
+      edge_label_index_[entry.label] = edge_entries_.size();
       edge_entries_.push_back(entry);
     }
   }
@@ -127,6 +132,14 @@ class PropertyGraphSchema {
   std::string ToJSONString() const;
   void FromJSONString(std::string const& schema);
 
+  /**
+   * @brief The same as FromJSONString, but the parsed schema is cached in the
+   * process and keyed by the JSON string, thus opening the fragments that
+   * share the same schema (e.g., the fragments of a graph, or the same
+   * fragment for many times) parses the schema only once.
+   */
+  void FromCachedJSONString(std::string const& schema);
+
   void set_fnum(size_t fnum) { fnum_ = fnum; }
   size_t fnum() const { return fnum_; }
 
@@ -154,6 +167,10 @@ class PropertyGraphSchema {
   size_t fnum_;
   std::vector<Entry> vertex_entries_;
   std::vector<Entry> edge_entries_;
+
+  // label name -> index in the entries
+  std::unordered_map<std::string, size_t> vertex_label_index_;
+  std::unordered_map<std::string, size_t> edge_label_index_;
 };
 
 // In Analytical engine, assume label ids of vertex entries are continuous
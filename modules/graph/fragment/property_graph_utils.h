@@ -26,6 +26,8 @@ limitations under the License.
 
 #include "graph/fragment/property_graph_types.h"
 #include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/edge_data_gather.h"
+#include "graph/utils/varint_encoding.h"
 
 namespace vineyard {
 
@@ -128,6 +130,50 @@ class EdgeDataColumn {
 
   const DATA_T& operator[](const NBR_T& nbr) const { return data_[nbr.eid]; }
 
+  /**
+   * @brief Gather the values of the edges in `[begin, end)` to `out`, which
+   * has at least `end - begin` elements.
+   */
+  void Gather(const NBR_T* begin, const NBR_T* end, DATA_T* out) const {
+    gather::gather(data_, begin, end, out);
+  }
+
+  /**
+   * @brief Gather the values of the edges in the adjacency list to `out`,
+   * which has at least `adj_list.Size()` elements.
+   */
+  template <typename ADJ_LIST_T>
+  void Gather(const ADJ_LIST_T& adj_list, DATA_T* out) const {
+    gather::gather(data_, adj_list.begin_unit(), adj_list.end_unit(), out);
+  }
+
+  /**
+   * @brief The sum of the values of the edges in the adjacency list, 0 for
+   * the empty list.
+   */
+  template <typename ADJ_LIST_T>
+  DATA_T Sum(const ADJ_LIST_T& adj_list) const {
+    return gather::sum(data_, adj_list.begin_unit(), adj_list.end_unit());
+  }
+
+  /**
+   * @brief The minimum of the values of the edges in the adjacency list,
+   * `std::numeric_limits<DATA_T>::max()` for the empty list.
+   */
+  template <typename ADJ_LIST_T>
+  DATA_T Min(const ADJ_LIST_T& adj_list) const {
+    return gather::min(data_, adj_list.begin_unit(), adj_list.end_unit());
+  }
+
+  /**
+   * @brief The maximum of the values of the edges in the adjacency list,
+   * `std::numeric_limits<DATA_T>::lowest()` for the empty list.
+   */
+  template <typename ADJ_LIST_T>
+  DATA_T Max(const ADJ_LIST_T& adj_list) const {
+    return gather::max(data_, adj_list.begin_unit(), adj_list.end_unit());
+  }
+
  private:
   const DATA_T* data_;
 };
@@ -140,17 +186,29 @@ class EdgeDataColumn<std::string, NBR_T> {
   explicit EdgeDataColumn(std::shared_ptr<arrow::Array> array) {
     if (array->type()->Equals(arrow::utf8())) {
       array_ = std::dynamic_pointer_cast<arrow::StringArray>(array);
+    } else if (array->type()->id() == arrow::Type::DICTIONARY) {
+      // dictionary-encoded strings are decoded on access
+      auto dict_array =
+          std::dynamic_pointer_cast<arrow::DictionaryArray>(array);
+      array_ = std::dynamic_pointer_cast<arrow::StringArray>(
+          dict_array->dictionary());
+      indices_ = dict_array->indices();
     } else {
       array_ = nullptr;
     }
   }
 
   std::string operator[](const NBR_T& nbr) const {
+    if (indices_ != nullptr) {
+      return std::string(
+          array_->GetView(vineyard::GetDictionaryIndex(*indices_, nbr.eid)));
+    }
     return array_->GetView(nbr.eid);
   }
 
  private:
   std::shared_ptr<arrow::StringArray> array_;
+  std::shared_ptr<arrow::Array> indices_;
 };
 
 template <typename DATA_T, typename VID_T>
@@ -192,6 +250,13 @@ class VertexDataColumn<std::string, VID_T> {
       : range_(range) {
     if (array->type()->Equals(arrow::utf8())) {
       array_ = std::dynamic_pointer_cast<arrow::StringArray>(array);
+    } else if (array->type()->id() == arrow::Type::DICTIONARY) {
+      // dictionary-encoded strings are decoded on access
+      auto dict_array =
+          std::dynamic_pointer_cast<arrow::DictionaryArray>(array);
+      array_ = std::dynamic_pointer_cast<arrow::StringArray>(
+          dict_array->dictionary());
+      indices_ = dict_array->indices();
     } else {
       array_ = nullptr;
     }
@@ -203,12 +268,18 @@ class VertexDataColumn<std::string, VID_T> {
   }
 
   std::string operator[](const grape::Vertex<VID_T>& v) const {
-    return array_->GetView(v.GetValue() - range_.begin().GetValue());
+    int64_t offset = v.GetValue() - range_.begin().GetValue();
+    if (indices_ != nullptr) {
+      return std::string(
+          array_->GetView(vineyard::GetDictionaryIndex(*indices_, offset)));
+    }
+    return array_->GetView(offset);
   }
 
  private:
   grape::VertexRange<VID_T> range_;
   std::shared_ptr<arrow::StringArray> array_;
+  std::shared_ptr<arrow::Array> indices_;
 };
 
 template <typename T>
@@ -476,6 +547,155 @@ class AdjList {
   const void** edata_arrays_;
 };
 
+/**
+ * The neighbor units of the merged adjacency lists, where the edges of all
+ * edge labels of a vertex are in one contiguous range, ordered by the labels.
+ * The edge label is tagged in the highest `merged_label_bits` bits of the
+ * eid, thus the unit is as large as `NbrUnit`.
+ */
+static constexpr int merged_label_bits = 8;
+
+template <typename VID_T, typename EID_T>
+struct MergedNbrUnit {
+  static constexpr int eid_bits = sizeof(EID_T) * 8 - merged_label_bits;
+  static constexpr EID_T eid_mask = (static_cast<EID_T>(1) << eid_bits) - 1;
+
+  VID_T vid;
+  EID_T tagged_eid;
+  MergedNbrUnit() = default;
+  MergedNbrUnit(VID_T v, EID_T e, int label)
+      : vid(v), tagged_eid((static_cast<EID_T>(label) << eid_bits) | e) {}
+
+  int label() const { return static_cast<int>(tagged_eid >> eid_bits); }
+
+  EID_T eid() const { return tagged_eid & eid_mask; }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(vid);
+  }
+};
+
+template <typename VID_T, typename EID_T>
+struct MergedNbr {
+ private:
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+
+ public:
+  MergedNbr() : nbr_(NULL), edata_arrays_(nullptr) {}
+  MergedNbr(const MergedNbrUnit<VID_T, EID_T>* nbr,
+            const void** const* edata_arrays)
+      : nbr_(nbr), edata_arrays_(edata_arrays) {}
+  MergedNbr(const MergedNbr& rhs)
+      : nbr_(rhs.nbr_), edata_arrays_(rhs.edata_arrays_) {}
+
+  MergedNbr& operator=(const MergedNbr& rhs) {
+    nbr_ = rhs.nbr_;
+    edata_arrays_ = rhs.edata_arrays_;
+    return *this;
+  }
+
+  grape::Vertex<VID_T> neighbor() const {
+    return grape::Vertex<VID_T>(nbr_->vid);
+  }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(nbr_->vid);
+  }
+
+  int edge_label() const { return nbr_->label(); }
+
+  EID_T edge_id() const { return nbr_->eid(); }
+
+  /**
+   * @brief The property of the edge, in the properties of its edge label.
+   */
+  template <typename T>
+  T get_data(prop_id_t prop_id) const {
+    return ValueGetter<T>::Value(edata_arrays_[nbr_->label()][prop_id],
+                                 nbr_->eid());
+  }
+
+  std::string get_str(prop_id_t prop_id) const {
+    return get_data<std::string>(prop_id);
+  }
+
+  double get_double(prop_id_t prop_id) const {
+    return get_data<double>(prop_id);
+  }
+
+  int64_t get_int(prop_id_t prop_id) const {
+    return get_data<int64_t>(prop_id);
+  }
+
+  inline const MergedNbr& operator++() const {
+    ++nbr_;
+    return *this;
+  }
+
+  inline MergedNbr operator++(int) const {
+    MergedNbr ret(*this);
+    ++ret;
+    return ret;
+  }
+
+  inline bool operator==(const MergedNbr& rhs) const {
+    return nbr_ == rhs.nbr_;
+  }
+  inline bool operator!=(const MergedNbr& rhs) const {
+    return nbr_ != rhs.nbr_;
+  }
+
+  inline bool operator<(const MergedNbr& rhs) const { return nbr_ < rhs.nbr_; }
+
+  inline const MergedNbr& operator*() const { return *this; }
+
+ private:
+  const mutable MergedNbrUnit<VID_T, EID_T>* nbr_;
+  // the flatten edge table columns of every edge label
+  const void** const* edata_arrays_;
+};
+
+/**
+ * MergedAdjList is the adjacency list of a vertex over all edge labels, see
+ * also `ArrowFragment::GetOutgoingMergedAdjList()`.
+ */
+template <typename VID_T, typename EID_T>
+class MergedAdjList {
+ public:
+  MergedAdjList() : begin_(NULL), end_(NULL), edata_arrays_(nullptr) {}
+  MergedAdjList(const MergedNbrUnit<VID_T, EID_T>* begin,
+                const MergedNbrUnit<VID_T, EID_T>* end,
+                const void** const* edata_arrays)
+      : begin_(begin), end_(end), edata_arrays_(edata_arrays) {}
+
+  inline MergedNbr<VID_T, EID_T> begin() const {
+    return MergedNbr<VID_T, EID_T>(begin_, edata_arrays_);
+  }
+
+  inline MergedNbr<VID_T, EID_T> end() const {
+    return MergedNbr<VID_T, EID_T>(end_, edata_arrays_);
+  }
+
+  inline size_t Size() const { return end_ - begin_; }
+
+  inline bool Empty() const { return end_ == begin_; }
+
+  inline bool NotEmpty() const { return end_ != begin_; }
+
+  size_t size() const { return end_ - begin_; }
+
+  inline const MergedNbrUnit<VID_T, EID_T>* begin_unit() const {
+    return begin_;
+  }
+
+  inline const MergedNbrUnit<VID_T, EID_T>* end_unit() const { return end_; }
+
+ private:
+  const MergedNbrUnit<VID_T, EID_T>* begin_;
+  const MergedNbrUnit<VID_T, EID_T>* end_;
+  const void** const* edata_arrays_;
+};
+
 /**
  * OffsetAdjList will offset the outer vertices' lid, makes it between "ivnum"
  * and "tvnum" instead of "ivnum ~ tvnum - outer vertex index"
@@ -528,6 +748,199 @@ class OffsetAdjList {
   const VID_T* ivnums_;
 };
 
+/**
+ * The compact adjacency list of a vertex with degree `d` is laid out as
+ *
+ *   | control bytes: ceil(d / 4) | eids: d * eid_width | vid deltas |
+ *
+ * where the sorted neighbors are delta-varint encoded (see
+ * `graph/utils/varint_encoding.h`), and the eids are stored in the same order
+ * with the fixed width that fits all eids of the edge label.
+ */
+template <typename VID_T, typename EID_T>
+inline size_t compact_adj_list_size(const NbrUnit<VID_T, EID_T>* begin,
+                                    const NbrUnit<VID_T, EID_T>* end,
+                                    size_t const eid_width) {
+  size_t degree = end - begin;
+  size_t size = varint::control_bytes(degree) + degree * eid_width;
+  uint64_t last = 0;
+  for (auto nbr = begin; nbr != end; ++nbr) {
+    size += 1 << varint::delta_code(static_cast<uint64_t>(nbr->vid) - last);
+    last = static_cast<uint64_t>(nbr->vid);
+  }
+  return size;
+}
+
+/**
+ * @brief Encode the adjacency list whose neighbors are sorted by vid.
+ */
+template <typename VID_T, typename EID_T>
+inline void encode_compact_adj_list(const NbrUnit<VID_T, EID_T>* begin,
+                                    const NbrUnit<VID_T, EID_T>* end,
+                                    size_t const eid_width, uint8_t* out) {
+  size_t degree = end - begin;
+  if (degree == 0) {
+    return;
+  }
+  uint8_t* control = out;
+  uint8_t* eids = control + varint::control_bytes(degree);
+  uint8_t* data = eids + degree * eid_width;
+  memset(control, 0, varint::control_bytes(degree));
+  uint64_t last = 0;
+  for (size_t k = 0; k < degree; ++k) {
+    uint64_t delta = static_cast<uint64_t>(begin[k].vid) - last;
+    uint8_t code = varint::delta_code(delta);
+    control[k >> 2] |= code << ((k & 3) << 1);
+    memcpy(data, &delta, 1 << code);
+    data += 1 << code;
+    last = static_cast<uint64_t>(begin[k].vid);
+    varint::store_fixed(eids + k * eid_width, begin[k].eid, eid_width);
+  }
+}
+
+/**
+ * @brief CompactNbr decodes the neighbors of a compact adjacency list on the
+ * fly, the edge properties are still accessed through the eid.
+ */
+template <typename VID_T, typename EID_T>
+struct CompactNbr {
+ private:
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+
+ public:
+  CompactNbr() {}
+  CompactNbr(const uint8_t* list, size_t const degree, size_t const eid_width,
+             size_t const index, const void** edata_arrays)
+      : control_(list),
+        eids_(list + varint::control_bytes(degree)),
+        data_(eids_ + degree * eid_width),
+        degree_(degree),
+        eid_width_(eid_width),
+        index_(index),
+        edata_arrays_(edata_arrays) {
+    if (index_ < degree_) {
+      vid_ = static_cast<VID_T>(varint::decode_delta(control_, index_, data_));
+    }
+  }
+
+  grape::Vertex<VID_T> neighbor() const { return grape::Vertex<VID_T>(vid_); }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(vid_);
+  }
+
+  EID_T edge_id() const {
+    return static_cast<EID_T>(
+        varint::load_fixed(eids_ + index_ * eid_width_, eid_width_));
+  }
+
+  template <typename T>
+  T get_data(prop_id_t prop_id) const {
+    return ValueGetter<T>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  std::string get_str(prop_id_t prop_id) const {
+    return ValueGetter<std::string>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  double get_double(prop_id_t prop_id) const {
+    return ValueGetter<double>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  int64_t get_int(prop_id_t prop_id) const {
+    return ValueGetter<int64_t>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  inline const CompactNbr& operator++() const {
+    if (++index_ < degree_) {
+      vid_ += static_cast<VID_T>(varint::decode_delta(control_, index_, data_));
+    }
+    return *this;
+  }
+
+  inline CompactNbr operator++(int) const {
+    CompactNbr ret(*this);
+    ++(*this);
+    return ret;
+  }
+
+  inline bool operator==(const CompactNbr& rhs) const {
+    return index_ == rhs.index_ && control_ == rhs.control_;
+  }
+  inline bool operator!=(const CompactNbr& rhs) const {
+    return index_ != rhs.index_ || control_ != rhs.control_;
+  }
+
+  inline bool operator<(const CompactNbr& rhs) const {
+    return index_ < rhs.index_;
+  }
+
+  inline const CompactNbr& operator*() const { return *this; }
+
+ private:
+  const uint8_t* control_ = nullptr;
+  const uint8_t* eids_ = nullptr;
+  mutable const uint8_t* data_ = nullptr;
+  size_t degree_ = 0;
+  size_t eid_width_ = 0;
+  mutable size_t index_ = 0;
+  mutable VID_T vid_ = 0;
+  const void** edata_arrays_ = nullptr;
+};
+
+/**
+ * @brief CompactAdjList is the adjacency list of fragments that are built
+ * with compact edges, which is a forward-only range of `CompactNbr`.
+ */
+template <typename VID_T, typename EID_T>
+class CompactAdjList {
+ public:
+  CompactAdjList() {}
+  CompactAdjList(const uint8_t* list, const uint8_t* list_end,
+                 size_t const degree, size_t const eid_width,
+                 const void** edata_arrays)
+      : list_(list),
+        list_end_(list_end),
+        degree_(degree),
+        eid_width_(eid_width),
+        edata_arrays_(edata_arrays) {}
+
+  inline CompactNbr<VID_T, EID_T> begin() const {
+    return CompactNbr<VID_T, EID_T>(list_, degree_, eid_width_, 0,
+                                    edata_arrays_);
+  }
+
+  inline CompactNbr<VID_T, EID_T> end() const {
+    return CompactNbr<VID_T, EID_T>(list_, degree_, eid_width_, degree_,
+                                    edata_arrays_);
+  }
+
+  /**
+   * @brief Decode all neighbors to `out`, which has `Size()` elements, in
+   * bulk rather than one by one.
+   */
+  inline void DecodeNeighbors(VID_T* out) const {
+    const uint8_t* data =
+        list_ + varint::control_bytes(degree_) + degree_ * eid_width_;
+    varint::decode_values(list_, data, list_end_, degree_, out);
+  }
+
+  inline size_t Size() const { return degree_; }
+
+  inline bool Empty() const { return degree_ == 0; }
+
+  inline bool NotEmpty() const { return degree_ != 0; }
+
+  size_t size() const { return degree_; }
+
+ private:
+  const uint8_t* list_ = nullptr;
+  const uint8_t* list_end_ = nullptr;
+  size_t degree_ = 0;
+  size_t eid_width_ = 0;
+  const void** edata_arrays_ = nullptr;
+};
+
 }  // namespace property_graph_utils
 
 inline std::string generate_type_name(
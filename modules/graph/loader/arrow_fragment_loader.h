@@ -16,20 +16,26 @@ limitations under the License.
 #ifndef MODULES_GRAPH_LOADER_ARROW_FRAGMENT_LOADER_H_
 #define MODULES_GRAPH_LOADER_ARROW_FRAGMENT_LOADER_H_
 
+#include <sys/resource.h>
+
 #include <algorithm>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "arrow/array/concatenate.h"
 #include "arrow/util/config.h"
 #include "arrow/util/key_value_metadata.h"
 
 #include "grape/worker/comm_spec.h"
 
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_memory_pool.h"
 #include "basic/stream/dataframe_stream.h"
 #include "basic/stream/parallel_stream.h"
 #include "client/client.h"
@@ -44,6 +50,7 @@ limitations under the License.
 #include "graph/loader/basic_arrow_fragment_loader.h"
 #include "graph/utils/error.h"
 #include "graph/utils/partitioner.h"
+#include "graph/utils/thread_group.h"
 #include "graph/vertex_map/arrow_vertex_map.h"
 
 #define HASH_PARTITION
@@ -98,6 +105,7 @@ class ArrowFragmentLoader {
   using label_id_t = property_graph_types::LABEL_ID_TYPE;
   using internal_oid_t = typename InternalType<oid_t>::type;
   using oid_array_t = typename vineyard::ConvertToArrowType<oid_t>::ArrayType;
+  using vid_array_t = typename vineyard::ConvertToArrowType<vid_t>::ArrayType;
   using vertex_map_t = ArrowVertexMap<internal_oid_t, vid_t>;
   // These consts represent which column in the arrow table represents oid.
   const int id_column = 0;
@@ -147,11 +155,10 @@ class ArrowFragmentLoader {
         comm_spec_(comm_spec),
         vertex_label_num_(vstreams.size()),
         edge_label_num_(estreams.size()),
+        vstreams_(vstreams),
+        estreams_(estreams),
         directed_(directed),
-        basic_arrow_fragment_loader_(comm_spec) {
-    partial_v_tables_ = gatherVTables(client, vstreams);
-    partial_e_tables_ = gatherETables(client, estreams);
-  }
+        basic_arrow_fragment_loader_(comm_spec) {}
 
   ArrowFragmentLoader(
       vineyard::Client& client, const grape::CommSpec& comm_spec,
@@ -184,9 +191,144 @@ class ArrowFragmentLoader {
 
   ~ArrowFragmentLoader() = default;
 
+  /**
+   * @brief Store the adjacency lists of the loaded fragment in the compact
+   * encoding, see also `ArrowFragment::compact_edges()`.
+   */
+  void set_compact_edges(bool compact_edges) { compact_edges_ = compact_edges; }
+
+  /**
+   * @brief Compute the degree statistics of the loaded fragment when it is
+   * sealed, see also `ArrowFragment::has_degree_statistics()`.
+   */
+  void set_degree_statistics(bool degree_statistics) {
+    degree_statistics_ = degree_statistics;
+  }
+
+  /**
+   * @brief Store the merged adjacency lists of all edge labels in the loaded
+   * fragment as well, see also `ArrowFragment::merged_edges()`.
+   */
+  void set_merged_edges(bool merged_edges) { merged_edges_ = merged_edges; }
+
+  /**
+   * @brief Permute the edges of the loaded fragment into the order of the
+   * CSR, and optionally drop the multi-edges, see also
+   * `BasicArrowFragmentBuilder::set_sort_edges()`.
+   */
+  void set_sort_edges(bool sort_edges, bool dedup_edges = false) {
+    sort_edges_ = sort_edges;
+    dedup_edges_ = dedup_edges;
+  }
+
+  /**
+   * @brief Reorder the inner vertices of the loaded fragment by the given
+   * strategy to improve the locality, see also `VertexReorderStrategy`.
+   */
+  void set_vertex_reorder(VertexReorderStrategy strategy) {
+    vertex_reorder_ = strategy;
+  }
+
+  /**
+   * @brief Exchange the shuffled rows between the workers on the same host
+   * through vineyardd, see also
+   * `BasicArrowFragmentLoader::EnableSharedMemoryShuffle()`. It must be set on
+   * all workers together.
+   */
+  void set_shared_memory_shuffle(bool shared_memory_shuffle) {
+    shared_memory_shuffle_ = shared_memory_shuffle;
+  }
+
+  /**
+   * @brief Compress the rows shuffled over the network with the given codec,
+   * e.g., "lz4" or "zstd", an empty codec disables the compression. It must
+   * be set on all workers together.
+   */
+  void set_shuffle_compression(std::string const& codec) {
+    shuffle_compression_ = codec;
+  }
+
+  /**
+   * @brief Load the fragment from the streams incrementally: each worker reads
+   * at most `budget` bytes of record batches (plus one batch) from its part of
+   * the streams at a time, which is shuffled and accumulated before the next
+   * batches are read, rather than reading the whole tables in advance. The
+   * vertex map is built from the accumulated vertices before the edges are
+   * streamed. A zero budget disables the streaming load.
+   *
+   * It only applies to the loaders that are constructed from streams, and must
+   * be set on all workers together.
+   */
+  void set_stream_memory_budget(size_t budget) {
+    stream_memory_budget_ = budget;
+  }
+
+  /**
+   * @brief Balance the edges rather than the vertices of fragments: the
+   * segments of the segmented partitioner are cut by the degrees of vertices
+   * (plus one for the vertex itself), which are counted in a pre-pass over
+   * the edge files. It doesn't apply to the hash partitioner, and must be set
+   * on all workers together.
+   */
+  void set_edge_balanced_partition(bool edge_balanced_partition) {
+    edge_balanced_partition_ = edge_balanced_partition;
+  }
+
+  /**
+   * @brief Read the part of each file with `concurrency` threads on every
+   * worker, by cutting the part into as many sub-parts. It only applies to the
+   * loaders that are constructed from files, and must be set on all workers
+   * together, as the boundaries of the parts depend on it.
+   */
+  void set_io_concurrency(int concurrency) {
+    io_concurrency_ = std::max(concurrency, 1);
+  }
+
+  /**
+   * @brief Build a partitioned vertex map, where every worker only keeps the
+   * oids of its own fragment, plus the mirrors of the outer vertices, rather
+   * than the oids of all fragments. The remote vertices of edges are resolved
+   * by their owners in batches during the load.
+   *
+   * It requires numeric oids, doesn't work with the vertex reordering or the
+   * streaming load, and must be set on all workers together.
+   */
+  void set_partitioned_vertex_map(bool partitioned_vertex_map) {
+    partitioned_vertex_map_ = partitioned_vertex_map;
+  }
+
+  /**
+   * @brief The elapsed seconds of a phase of the load on this worker, and the
+   * peak resident memory (in bytes) of the worker process at the end of it.
+   */
+  struct PhaseStat {
+    std::string name;
+    double seconds;
+    size_t peak_rss;
+  };
+
+  /**
+   * @brief The phases of the last `LoadFragment()`, in the order of execution,
+   * i.e., "read", "shuffle_vertices", "vertex_map", "shuffle_edges", "csr"
+   * and "seal" (the "stream" phase of the streaming load covers everything
+   * before the "csr").
+   */
+  const std::vector<PhaseStat>& phase_stats() const { return phase_stats_; }
+
   boost::leaf::result<vineyard::ObjectID> LoadFragment() {
+    phase_stats_.clear();
+    phase_begin_ = GetCurrentTime();
     BOOST_LEAF_CHECK(initPartitioner());
+    if (!vstreams_.empty() && stream_memory_budget_ > 0) {
+      if (partitioned_vertex_map_) {
+        RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                        "The partitioned vertex map can't be streamed");
+      }
+      BOOST_LEAF_AUTO(frag_id, shuffleAndBuildFromStreams());
+      return frag_id;
+    }
     BOOST_LEAF_CHECK(initBasicLoader());
+    markPhase("read");
     BOOST_LEAF_AUTO(frag_id, shuffleAndBuild());
     return frag_id;
   }
@@ -233,14 +375,70 @@ class ArrowFragmentLoader {
       }
     }
 
-    partitioner_.Init(comm_spec_.fnum(), oid_list);
+    if (edge_balanced_partition_) {
+      BOOST_LEAF_AUTO(weights, countVertexWeights(oid_list));
+      partitioner_.Init(comm_spec_.fnum(), oid_list, weights);
+    } else {
+      partitioner_.Init(comm_spec_.fnum(), oid_list);
+    }
 #endif
     return {};
   }
 
+  // Count the degree of every vertex in the oid list over the edges of all
+  // workers, the edge tables of this worker are kept for `initBasicLoader`.
+  boost::leaf::result<std::vector<uint64_t>> countVertexWeights(
+      const std::vector<oid_t>& oid_list) {
+    auto load_e_procedure = [&]() {
+      return loadEdgeTables(efiles_, comm_spec_.worker_id(),
+                            comm_spec_.worker_num());
+    };
+    BOOST_LEAF_AUTO(tmp_e, sync_gs_error(comm_spec_, load_e_procedure));
+    partial_e_tables_ = tmp_e;
+
+    ska::flat_hash_map<oid_t, size_t> oid_index;
+    oid_index.reserve(oid_list.size());
+    for (size_t i = 0; i < oid_list.size(); ++i) {
+      oid_index.emplace(oid_list[i], i);
+    }
+    std::vector<uint64_t> weights(oid_list.size(), 0);
+    for (auto& sub_tables : partial_e_tables_) {
+      for (auto& table : sub_tables) {
+        for (int column : {src_column, dst_column}) {
+          for (auto const& chunk : table->column(column)->chunks()) {
+            auto array = std::dynamic_pointer_cast<oid_array_t>(chunk);
+            for (int64_t i = 0; i < array->length(); ++i) {
+              auto iter = oid_index.find(oid_t(array->GetView(i)));
+              if (iter != oid_index.end()) {
+                weights[iter->second] += 1;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    // in batches, as the count of MPI is an int
+    size_t const batch_size = static_cast<size_t>(1) << 28;
+    for (size_t begin = 0; begin < weights.size(); begin += batch_size) {
+      int count =
+          static_cast<int>(std::min(batch_size, weights.size() - begin));
+      MPI_Allreduce(MPI_IN_PLACE, weights.data() + begin, count, MPI_UINT64_T,
+                    MPI_SUM, comm_spec_.comm());
+    }
+    for (auto& weight : weights) {
+      weight += 1;
+    }
+    return weights;
+  }
+
   boost::leaf::result<void> initBasicLoader() {
     std::vector<std::shared_ptr<arrow::Table>> partial_v_tables;
     std::vector<std::vector<std::shared_ptr<arrow::Table>>> partial_e_tables;
+    if (!vstreams_.empty() && partial_v_tables_.empty()) {
+      partial_v_tables_ = gatherVTables(client_, vstreams_);
+      partial_e_tables_ = gatherETables(client_, estreams_);
+    }
     if (!partial_v_tables_.empty() && !partial_e_tables_.empty()) {
       partial_v_tables = partial_v_tables_;
       partial_e_tables = partial_e_tables_;
@@ -261,39 +459,310 @@ class ArrowFragmentLoader {
         };
         BOOST_LEAF_AUTO(tmp_v, sync_gs_error(comm_spec_, load_v_procedure));
         partial_v_tables = tmp_v;
-        auto load_e_procedure = [&]() {
-          return loadEdgeTables(efiles_, comm_spec_.worker_id(),
-                                comm_spec_.worker_num());
-        };
-        BOOST_LEAF_AUTO(tmp_e, sync_gs_error(comm_spec_, load_e_procedure));
-        partial_e_tables = tmp_e;
+        if (!partial_e_tables_.empty()) {
+          // read by the pre-pass of the edge-balanced partitioner
+          partial_e_tables = std::move(partial_e_tables_);
+          partial_e_tables_.clear();
+        } else {
+          auto load_e_procedure = [&]() {
+            return loadEdgeTables(efiles_, comm_spec_.worker_id(),
+                                  comm_spec_.worker_num());
+          };
+          BOOST_LEAF_AUTO(tmp_e, sync_gs_error(comm_spec_, load_e_procedure));
+          partial_e_tables = tmp_e;
+        }
       }
     }
     basic_arrow_fragment_loader_.Init(partial_v_tables, partial_e_tables);
-    basic_arrow_fragment_loader_.SetPartitioner(partitioner_);
+    configureBasicLoader();
 
     return {};
   }
 
+  void configureBasicLoader() {
+    basic_arrow_fragment_loader_.SetPartitioner(partitioner_);
+    basic_arrow_fragment_loader_.SetOidMemoryPool(client_);
+    if (shared_memory_shuffle_ && comm_spec_.local_num() > 1) {
+      basic_arrow_fragment_loader_.EnableSharedMemoryShuffle(client_);
+    }
+    basic_arrow_fragment_loader_.SetShuffleCompression(shuffle_compression_);
+  }
+
   boost::leaf::result<vineyard::ObjectID> shuffleAndBuild() {
+    if (partitioned_vertex_map_) {
+      return shuffleAndBuildPartitioned(
+          std::is_arithmetic<internal_oid_t>());
+    }
     // When vfiles_ is empty, it means we build vertex table from efile
     BOOST_LEAF_AUTO(
         local_v_tables,
         basic_arrow_fragment_loader_.ShuffleVertexTables(vfiles_.empty()));
-    auto oid_lists = basic_arrow_fragment_loader_.GetOidLists();
+    markPhase("shuffle_vertices");
+    auto vm_ptr = buildVertexMap(basic_arrow_fragment_loader_.GetOidLists());
+    markPhase("vertex_map");
+    auto mapper = [&vm_ptr](fid_t fid, label_id_t label,
+                            const std::vector<internal_oid_t>& oids,
+                            std::vector<vid_t>& gids) {
+      CHECK(vm_ptr->GetGids(fid, label, oids, gids));
+      return true;
+    };
+    BOOST_LEAF_AUTO(local_e_tables,
+                    basic_arrow_fragment_loader_.ShuffleEdgeTables(mapper));
+    markPhase("shuffle_edges");
+    return buildFragment(vm_ptr, std::move(local_v_tables),
+                         std::move(local_e_tables));
+  }
 
-    BasicArrowVertexMapBuilder<typename InternalType<oid_t>::type, vid_t>
-        vm_builder(client_, comm_spec_.fnum(), vertex_label_num_, oid_lists);
+  boost::leaf::result<vineyard::ObjectID> shuffleAndBuildPartitioned(
+      std::false_type) {
+    RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                    "The partitioned vertex map requires numeric oids");
+  }
+
+  /**
+   * The load with a partitioned vertex map, see also
+   * `set_partitioned_vertex_map()`.
+   */
+  boost::leaf::result<vineyard::ObjectID> shuffleAndBuildPartitioned(
+      std::true_type) {
+    if (vertex_reorder_ != VertexReorderStrategy::kNone) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "The partitioned vertex map can't be reordered");
+    }
+    fid_t const local_fid = comm_spec_.fid();
+    basic_arrow_fragment_loader_.SetGatherOidLists(false);
+    BOOST_LEAF_AUTO(
+        local_v_tables,
+        basic_arrow_fragment_loader_.ShuffleVertexTables(vfiles_.empty()));
+    markPhase("shuffle_vertices");
+
+    BasicArrowVertexMapBuilder<internal_oid_t, vid_t> vm_builder(
+        client_, comm_spec_.fnum(), vertex_label_num_,
+        basic_arrow_fragment_loader_.GetOidLists());
+    vm_builder.SetPartitioned(local_fid,
+                              basic_arrow_fragment_loader_.GetVertexNums());
+    auto build_procedure = [&]() -> boost::leaf::result<bool> {
+      VY_OK_OR_RAISE(vm_builder.BuildLocal(client_));
+      return true;
+    };
+    BOOST_LEAF_CHECK(sync_gs_error(comm_spec_, build_procedure));
+    markPhase("vertex_map");
+
+    // the gids of the remote vertices of the edges read by this worker
+    BOOST_LEAF_AUTO(remote_o2g,
+                    basic_arrow_fragment_loader_.ResolveRemoteOids(
+                        [&vm_builder](label_id_t label,
+                                      const std::vector<internal_oid_t>& oids,
+                                      std::vector<vid_t>& gids) {
+                          vm_builder.GetLocalGids(label, oids, gids);
+                        }));
+    auto mapper = [&](fid_t fid, label_id_t label,
+                      const std::vector<internal_oid_t>& oids,
+                      std::vector<vid_t>& gids) {
+      gids.resize(oids.size());
+      bool all_found = true;
+      for (size_t i = 0; i < oids.size(); ++i) {
+        if (fid == local_fid) {
+          all_found &= vm_builder.GetLocalGid(label, oids[i], gids[i]);
+        } else {
+          auto iter = remote_o2g[label].find(oids[i]);
+          if (iter == remote_o2g[label].end()) {
+            all_found = false;
+          } else {
+            gids[i] = iter->second;
+          }
+        }
+      }
+      return all_found;
+    };
+    BOOST_LEAF_AUTO(local_e_tables,
+                    basic_arrow_fragment_loader_.ShuffleEdgeTables(
+                        typename basic_loader_t::batch_oid_mapper_t(mapper)));
+    remote_o2g.clear();
+
+    std::vector<std::shared_ptr<oid_array_t>> mirror_oids;
+    std::vector<std::shared_ptr<vid_array_t>> mirror_gids;
+    BOOST_LEAF_CHECK(basic_arrow_fragment_loader_.GatherMirrors(
+        local_e_tables, mirror_oids, mirror_gids));
+    vm_builder.SetMirrors(mirror_oids, mirror_gids);
     auto vm = vm_builder.Seal(client_);
     auto vm_ptr =
         std::dynamic_pointer_cast<vertex_map_t>(client_.GetObject(vm->id()));
-    auto mapper = [&vm_ptr](fid_t fid, label_id_t label, internal_oid_t oid,
-                            vid_t& gid) {
-      CHECK(vm_ptr->GetGid(fid, label, oid, gid));
+    // the resolution of remote oids, and the mirrors of outer vertices
+    markPhase("shuffle_edges");
+    return buildFragment(vm_ptr, std::move(local_v_tables),
+                         std::move(local_e_tables));
+  }
+
+  /**
+   * The streaming load, see also `set_stream_memory_budget()`.
+   */
+  boost::leaf::result<vineyard::ObjectID> shuffleAndBuildFromStreams() {
+    configureBasicLoader();
+
+    std::vector<StreamSource> vsources(vstreams_.size());
+    std::vector<std::vector<StreamSource>> esources(estreams_.size());
+    auto open_procedure = [&]() -> boost::leaf::result<bool> {
+      for (size_t i = 0; i < vstreams_.size(); ++i) {
+        VY_OK_OR_RAISE(openStreamSource(vstreams_[i], vsources[i]));
+      }
+      for (size_t i = 0; i < estreams_.size(); ++i) {
+        esources[i].resize(estreams_[i].size());
+        for (size_t j = 0; j < estreams_[i].size(); ++j) {
+          VY_OK_OR_RAISE(openStreamSource(estreams_[i][j], esources[i][j]));
+        }
+      }
       return true;
     };
-    BOOST_LEAF_AUTO(local_e_tables,
-                    basic_arrow_fragment_loader_.ShuffleEdgeTables(mapper));
+    BOOST_LEAF_CHECK(sync_gs_error(comm_spec_, open_procedure));
+
+    // shuffle the vertices window by window
+    std::vector<std::vector<std::shared_ptr<arrow::Table>>> v_windows(
+        vertex_label_num_);
+    std::vector<std::vector<std::vector<std::shared_ptr<oid_array_t>>>>
+        oid_windows(vertex_label_num_,
+                    std::vector<std::vector<std::shared_ptr<oid_array_t>>>(
+                        comm_spec_.fnum()));
+    bool remaining = true;
+    while (remaining) {
+      auto read_procedure = [&]()
+          -> boost::leaf::result<std::vector<std::shared_ptr<arrow::Table>>> {
+        size_t budget = stream_memory_budget_;
+        std::vector<std::shared_ptr<arrow::Table>> tables(vertex_label_num_);
+        for (label_id_t label = 0; label < vertex_label_num_; ++label) {
+          BOOST_LEAF_AUTO(window, readStreamWindow(vsources[label], budget));
+          tables[label] = decorateVertexTable(window, label);
+        }
+        return tables;
+      };
+      BOOST_LEAF_AUTO(tables, sync_gs_error(comm_spec_, read_procedure));
+      remaining = streamsRemaining(sourcesRemaining(vsources));
+
+      basic_arrow_fragment_loader_.Init(tables, {});
+      BOOST_LEAF_AUTO(local_tables,
+                      basic_arrow_fragment_loader_.ShuffleVertexTables(false));
+      auto& oid_lists = basic_arrow_fragment_loader_.GetOidLists();
+      for (label_id_t label = 0; label < vertex_label_num_; ++label) {
+        v_windows[label].emplace_back(local_tables[label]);
+        for (fid_t fid = 0; fid < comm_spec_.fnum(); ++fid) {
+          oid_windows[label][fid].emplace_back(oid_lists[label][fid]);
+        }
+      }
+    }
+
+    std::vector<std::shared_ptr<arrow::Table>> local_v_tables(
+        vertex_label_num_);
+    std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_lists(
+        vertex_label_num_,
+        std::vector<std::shared_ptr<oid_array_t>>(comm_spec_.fnum()));
+    for (label_id_t label = 0; label < vertex_label_num_; ++label) {
+      BOOST_LEAF_AUTO(table, concatenateWindows(v_windows[label]));
+      local_v_tables[label] = table;
+      v_windows[label].clear();
+      for (fid_t fid = 0; fid < comm_spec_.fnum(); ++fid) {
+        BOOST_LEAF_AUTO(oids, concatenateOids(oid_windows[label][fid]));
+        oid_lists[label][fid] = oids;
+        oid_windows[label][fid].clear();
+      }
+    }
+    auto vm_ptr = buildVertexMap(oid_lists);
+    auto mapper = [&vm_ptr](fid_t fid, label_id_t label,
+                            const std::vector<internal_oid_t>& oids,
+                            std::vector<vid_t>& gids) {
+      CHECK(vm_ptr->GetGids(fid, label, oids, gids));
+      return true;
+    };
+
+    // shuffle the edges window by window
+    std::vector<std::vector<std::shared_ptr<arrow::Table>>> e_windows(
+        edge_label_num_);
+    remaining = true;
+    while (remaining) {
+      auto read_procedure = [&]() -> boost::leaf::result<
+                                      std::vector<std::vector<
+                                          std::shared_ptr<arrow::Table>>>> {
+        size_t budget = stream_memory_budget_;
+        std::vector<std::vector<std::shared_ptr<arrow::Table>>> tables(
+            edge_label_num_);
+        for (label_id_t label = 0; label < edge_label_num_; ++label) {
+          for (auto& source : esources[label]) {
+            BOOST_LEAF_AUTO(window, readStreamWindow(source, budget));
+            tables[label].emplace_back(
+                decorateEdgeTable(window, label, esources[label].size()));
+          }
+        }
+        return tables;
+      };
+      BOOST_LEAF_AUTO(tables, sync_gs_error(comm_spec_, read_procedure));
+      bool local_remaining = false;
+      for (auto const& sources : esources) {
+        local_remaining |= sourcesRemaining(sources);
+      }
+      remaining = streamsRemaining(local_remaining);
+
+      basic_arrow_fragment_loader_.Init(
+          std::vector<std::shared_ptr<arrow::Table>>(vertex_label_num_),
+          tables);
+      BOOST_LEAF_AUTO(local_tables,
+                      basic_arrow_fragment_loader_.ShuffleEdgeTables(mapper));
+      for (label_id_t label = 0; label < edge_label_num_; ++label) {
+        e_windows[label].emplace_back(local_tables[label]);
+      }
+    }
+
+    std::vector<std::shared_ptr<arrow::Table>> local_e_tables(edge_label_num_);
+    for (label_id_t label = 0; label < edge_label_num_; ++label) {
+      BOOST_LEAF_AUTO(table, concatenateWindows(e_windows[label]));
+      local_e_tables[label] = table;
+      e_windows[label].clear();
+    }
+
+    // the reordering reads the oid lists from the basic loader
+    basic_arrow_fragment_loader_.GetOidLists() = oid_lists;
+    markPhase("stream");
+    return buildFragment(vm_ptr, std::move(local_v_tables),
+                         std::move(local_e_tables));
+  }
+
+  void markPhase(const std::string& name) {
+    double now = GetCurrentTime();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    size_t peak_rss = static_cast<size_t>(usage.ru_maxrss);
+#else
+    size_t peak_rss = static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+    phase_stats_.push_back(PhaseStat{name, now - phase_begin_, peak_rss});
+    phase_begin_ = now;
+  }
+
+  std::shared_ptr<vertex_map_t> buildVertexMap(
+      std::vector<std::vector<std::shared_ptr<oid_array_t>>> const&
+          oid_lists) {
+    BasicArrowVertexMapBuilder<typename InternalType<oid_t>::type, vid_t>
+        vm_builder(client_, comm_spec_.fnum(), vertex_label_num_, oid_lists);
+    vm_builder.set_partitioner(partitioner_);
+    if (comm_spec_.local_num() > 1) {
+      // every vineyardd keeps a single copy of the members of vertex maps
+      vm_builder.ShareWithLocalWorkers(comm_spec_);
+    }
+    auto vm = vm_builder.Seal(client_);
+    return std::dynamic_pointer_cast<vertex_map_t>(
+        client_.GetObject(vm->id()));
+  }
+
+  boost::leaf::result<vineyard::ObjectID> buildFragment(
+      std::shared_ptr<vertex_map_t> vm_ptr,
+      std::vector<std::shared_ptr<arrow::Table>> local_v_tables,
+      std::vector<std::shared_ptr<arrow::Table>> local_e_tables) {
+    if (vertex_reorder_ != VertexReorderStrategy::kNone) {
+      BOOST_LEAF_CHECK(basic_arrow_fragment_loader_.ReorderVertices(
+          vertex_reorder_, local_v_tables, local_e_tables));
+      // rebuild the vertex map, as the vids of vertices have changed
+      VINEYARD_SUPPRESS(client_.DelData(vm_ptr->id()));
+      vm_ptr = buildVertexMap(basic_arrow_fragment_loader_.GetOidLists());
+    }
     BasicArrowFragmentBuilder<oid_t, vid_t> frag_builder(client_, vm_ptr);
     PropertyGraphSchema schema;
 
@@ -368,16 +837,23 @@ class ArrowFragmentLoader {
     }
 
     frag_builder.SetPropertyGraphSchema(std::move(schema));
+    frag_builder.set_sort_edges(sort_edges_, dedup_edges_);
 
     int thread_num =
         (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
         comm_spec_.local_num();
     BOOST_LEAF_CHECK(frag_builder.Init(
         comm_spec_.fid(), comm_spec_.fnum(), std::move(local_v_tables),
-        std::move(local_e_tables), directed_, thread_num));
+        std::move(local_e_tables), directed_, thread_num, compact_edges_,
+        merged_edges_));
+    markPhase("csr");
+    frag_builder.set_degree_statistics(degree_statistics_);
     auto frag = std::dynamic_pointer_cast<ArrowFragment<oid_t, vid_t>>(
         frag_builder.Seal(client_));
+    // the fragment has copied the shuffled tables
+    basic_arrow_fragment_loader_.ReleaseSharedBatches();
     VINEYARD_CHECK_OK(client_.Persist(frag->id()));
+    markPhase("seal");
     return frag->id();
   }
 
@@ -445,11 +921,7 @@ class ArrowFragmentLoader {
                      io_deleter_);
       auto read_procedure =
           [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
-        VY_OK_OR_RAISE(io_adaptor->SetPartialRead(index, total_parts));
-        VY_OK_OR_RAISE(io_adaptor->Open());
-        std::shared_ptr<arrow::Table> table;
-        VY_OK_OR_RAISE(io_adaptor->ReadTable(&table));
-        return table;
+        return readTablePart(io_adaptor.get(), index, total_parts);
       };
 
       BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, read_procedure));
@@ -505,11 +977,7 @@ class ArrowFragmentLoader {
                          io_deleter_);
           auto read_procedure =
               [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
-            VY_OK_OR_RAISE(io_adaptor->SetPartialRead(index, total_parts));
-            VY_OK_OR_RAISE(io_adaptor->Open());
-            std::shared_ptr<arrow::Table> table;
-            VY_OK_OR_RAISE(io_adaptor->ReadTable(&table));
-            return table;
+            return readTablePart(io_adaptor.get(), index, total_parts);
           };
           BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, read_procedure));
 
@@ -639,11 +1107,7 @@ class ArrowFragmentLoader {
 
           auto read_procedure =
               [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
-            VY_OK_OR_RAISE(io_adaptor->SetPartialRead(index, total_parts));
-            VY_OK_OR_RAISE(io_adaptor->Open());
-            std::shared_ptr<arrow::Table> table;
-            VY_OK_OR_RAISE(io_adaptor->ReadTable(&table));
-            return table;
+            return readTablePart(io_adaptor.get(), index, total_parts);
           };
 
           BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, read_procedure));
@@ -748,10 +1212,10 @@ class ArrowFragmentLoader {
     return std::make_pair(vtables, etables);
   }
 
-  Status readTableFromVineyard(vineyard::Client& client,
-
-                               const ObjectID object_id,
-                               std::shared_ptr<arrow::Table>& table) {
+  // the dataframe stream of this worker in the parallel stream
+  Status openDataframeStream(
+      vineyard::Client& client, const ObjectID object_id,
+      std::shared_ptr<vineyard::DataframeStream>& dataframe_stream) {
     auto pstream = client.GetObject<vineyard::ParallelStream>(object_id);
     RETURN_ON_ASSERT(pstream != nullptr,
                      "Object not exists: " + VYObjectIDToString(object_id));
@@ -762,16 +1226,219 @@ class ArrowFragmentLoader {
         "read " + std::to_string(index) + " from " +
             std::to_string(total_parts) + ", but totally has " +
             std::to_string(pstream->GetStreamSize()));
-    auto dataframe_stream =
-        pstream->GetStream<vineyard::DataframeStream>(index);
+    dataframe_stream = pstream->GetStream<vineyard::DataframeStream>(index);
     RETURN_ON_ASSERT(dataframe_stream != nullptr,
                      "The stream must be a dataframe stream");
+    return Status::OK();
+  }
+
+  /**
+   * Read the part of this worker from the input in vineyard, which is either a
+   * parallel stream of dataframe streams, or a vineyard table that is local
+   * to the workers, whose rows are divided among the workers as zero-copy
+   * slices.
+   *
+   * The blobs of the input tables are adoptable (see `SealedBlobScope`) in
+   * the lifetime of the loader, thus the columns that are not moved by the
+   * shuffles are referred to by the fragment as they are, rather than being
+   * copied to new blobs.
+   */
+  Status readTableFromVineyard(vineyard::Client& client,
+                               const ObjectID object_id,
+                               std::shared_ptr<arrow::Table>& table) {
+    ObjectMeta meta;
+    RETURN_ON_ERROR(client.GetMetaData(object_id, meta, true));
+    if (meta.GetTypeName() == type_name<vineyard::Table>()) {
+      RETURN_ON_ASSERT(meta.IsLocal(),
+                       "The input table must be local to the workers: " +
+                           VYObjectIDToString(object_id));
+      std::shared_ptr<vineyard::Table> input;
+      RETURN_ON_ERROR(client.GetObject(object_id, input));
+      auto whole = input->GetTable();
+      int64_t num_rows = whole->num_rows();
+      int64_t worker_id = comm_spec_.worker_id();
+      int64_t worker_num = comm_spec_.worker_num();
+      int64_t begin = num_rows * worker_id / worker_num;
+      int64_t end = num_rows * (worker_id + 1) / worker_num;
+      table = whole->Slice(begin, end - begin);
+      input_blob_scopes_.emplace_back(
+          std::make_shared<SealedBlobScope>(client, input->meta()));
+      VLOG(10) << "table from vineyard: " << table->schema()->ToString()
+               << ", adopts " << input_blob_scopes_.back()->size()
+               << " blobs";
+      return Status::OK();
+    }
+    std::shared_ptr<vineyard::DataframeStream> dataframe_stream;
+    RETURN_ON_ERROR(openDataframeStream(client, object_id, dataframe_stream));
     auto reader = dataframe_stream->OpenReader(client);
     RETURN_ON_ERROR(reader->ReadTable(table));
     VLOG(10) << "table from stream: " << table->schema()->ToString();
     return Status::OK();
   }
 
+  /**
+   * The part of a parallel stream of this worker, which is read window by
+   * window in the streaming load.
+   */
+  struct StreamSource {
+    std::unique_ptr<vineyard::DataframeStreamReader> reader;
+    std::unordered_map<std::string, std::string> params;
+    std::shared_ptr<arrow::Schema> schema;
+    bool drained = false;
+  };
+
+  Status openStreamSource(const ObjectID object_id, StreamSource& source) {
+    std::shared_ptr<vineyard::DataframeStream> dataframe_stream;
+    RETURN_ON_ERROR(openDataframeStream(client_, object_id, dataframe_stream));
+    source.reader = dataframe_stream->OpenReader(client_);
+    source.params = dataframe_stream->GetParams();
+    return Status::OK();
+  }
+
+  /**
+   * Read the batches from the source until the `budget` bytes are exhausted,
+   * at least one batch is read to know the schema of the stream. The window
+   * is an empty table once the source has been drained.
+   */
+  boost::leaf::result<std::shared_ptr<arrow::Table>> readStreamWindow(
+      StreamSource& source, size_t& budget) {
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    while (!source.drained && (budget > 0 || source.schema == nullptr)) {
+      std::shared_ptr<arrow::RecordBatch> batch;
+      // the batches outlive their chunks
+      if (!source.reader->ReadBatch(batch, true).ok()) {
+        source.drained = true;
+        break;
+      }
+      size_t size = 0;
+      VY_OK_OR_RAISE(GetRecordBatchStreamSize(*batch, &size));
+      budget -= std::min(budget, size);
+      if (source.schema == nullptr) {
+        source.schema = batch->schema();
+      }
+      batches.emplace_back(batch);
+    }
+    if (source.schema == nullptr) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Failed to infer the schema from an empty stream");
+    }
+    std::shared_ptr<arrow::Table> table;
+    if (batches.empty()) {
+      VY_OK_OR_RAISE(EmptyTableBuilder::Build(source.schema, table));
+    } else {
+      VY_OK_OR_RAISE(RecordBatchesToTable(batches, &table));
+    }
+    // as `DataframeStreamReader::ReadTable()`
+    std::shared_ptr<arrow::KeyValueMetadata> metadata;
+    if (table->schema()->metadata() != nullptr) {
+      metadata = table->schema()->metadata()->Copy();
+    } else {
+      metadata.reset(new arrow::KeyValueMetadata());
+    }
+    for (auto const& kv : source.params) {
+      metadata->Append(kv.first, kv.second);
+    }
+    return table->ReplaceSchemaMetadata(metadata);
+  }
+
+  static bool sourcesRemaining(std::vector<StreamSource> const& sources) {
+    for (auto const& source : sources) {
+      if (!source.drained) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // whether any worker has remaining batches in its sources
+  bool streamsRemaining(bool const local_remaining) {
+    int remaining = local_remaining ? 1 : 0;
+    MPI_Allreduce(MPI_IN_PLACE, &remaining, 1, MPI_INT, MPI_MAX,
+                  comm_spec_.comm());
+    return remaining != 0;
+  }
+
+  boost::leaf::result<std::shared_ptr<arrow::Table>> readTablePart(
+      vineyard::LocalIOAdaptor* io_adaptor, int index, int total_parts) {
+    std::shared_ptr<arrow::Table> table;
+    if (io_concurrency_ <= 1) {
+      VY_OK_OR_RAISE(io_adaptor->SetPartialRead(index, total_parts));
+      VY_OK_OR_RAISE(io_adaptor->Open());
+      VY_OK_OR_RAISE(io_adaptor->ReadTable(&table));
+      return table;
+    }
+
+    VY_OK_OR_RAISE(
+        io_adaptor->SetPartialRead(index, total_parts, io_concurrency_));
+    VY_OK_OR_RAISE(io_adaptor->Open());
+    int sub_parts = io_adaptor->sub_parts();
+    std::vector<std::shared_ptr<arrow::Table>> parts(sub_parts);
+    std::vector<vineyard::Status> statuses(sub_parts);
+    ThreadPool::Default().ParallelFor(
+        sub_parts,
+        [&](size_t, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            statuses[i] = io_adaptor->ReadSubPartTable(&parts[i], i);
+          }
+        },
+        sub_parts, 1);
+    for (auto const& status : statuses) {
+      VY_OK_OR_RAISE(status);
+    }
+
+    // the sub-parts are parsed independently, and may infer different types
+    // for the same column.
+    std::vector<std::shared_ptr<arrow::Table>> tables;
+    std::vector<std::shared_ptr<arrow::Schema>> schemas;
+    for (auto const& part : parts) {
+      if (part != nullptr) {
+        tables.push_back(part);
+        schemas.push_back(part->schema());
+      }
+    }
+    if (tables.empty()) {
+      return table;
+    }
+    if (tables.size() > 1) {
+      BOOST_LEAF_AUTO(normalized_schema, TypeLoosen(schemas));
+      for (auto& part : tables) {
+        BOOST_LEAF_AUTO(casted, CastTableToSchema(part, normalized_schema));
+        part = casted;
+      }
+    }
+    return basic_arrow_fragment_loader_.ConcatenateTables(tables);
+  }
+
+  boost::leaf::result<std::shared_ptr<arrow::Table>> concatenateWindows(
+      std::vector<std::shared_ptr<arrow::Table>>& windows) {
+    auto table = basic_arrow_fragment_loader_.ConcatenateTables(windows);
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(
+        table->CombineChunks(arrow::default_memory_pool(), &table));
+#else
+    ARROW_OK_ASSIGN_OR_RAISE(
+        table, table->CombineChunks(arrow::default_memory_pool()));
+#endif
+    return table;
+  }
+
+  boost::leaf::result<std::shared_ptr<oid_array_t>> concatenateOids(
+      std::vector<std::shared_ptr<oid_array_t>> const& windows) {
+    if (windows.size() == 1) {
+      return windows[0];
+    }
+    arrow::ArrayVector arrays(windows.begin(), windows.end());
+    std::shared_ptr<arrow::Array> array;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(
+        arrow::Concatenate(arrays, arrow::default_memory_pool(), &array));
+#else
+    ARROW_OK_ASSIGN_OR_RAISE(
+        array, arrow::Concatenate(arrays, arrow::default_memory_pool()));
+#endif
+    return std::dynamic_pointer_cast<oid_array_t>(array);
+  }
+
   std::vector<std::shared_ptr<arrow::Table>> gatherVTables(
       vineyard::Client& client, const std::vector<ObjectID>& vstreams) {
     std::vector<std::shared_ptr<arrow::Table>> tables;
@@ -780,21 +1447,7 @@ class ArrowFragmentLoader {
       std::shared_ptr<arrow::Table> table;
       auto status = readTableFromVineyard(client, vstream, table);
       if (status.ok()) {
-        std::shared_ptr<arrow::KeyValueMetadata> meta;
-        if (table->schema()->metadata() != nullptr) {
-          meta = table->schema()->metadata()->Copy();
-        } else {
-          meta.reset(new arrow::KeyValueMetadata());
-        }
-        meta->Append("type", "VERTEX");
-        meta->Append(basic_loader_t::ID_COLUMN, std::to_string(id_column));
-        tables.emplace_back(table->ReplaceSchemaMetadata(meta));
-
-        int label_meta_index = meta->FindKey(LABEL_TAG);
-        VINEYARD_ASSERT(
-            label_meta_index != -1,
-            "Metadata of input vertex files should contain label name");
-        vertex_label_to_index_[meta->value(label_meta_index)] = label_id;
+        tables.emplace_back(decorateVertexTable(table, label_id));
       } else {
         LOG(ERROR) << "Failed to read vertex stream: " << status.ToString();
       }
@@ -802,6 +1455,24 @@ class ArrowFragmentLoader {
     return tables;
   }
 
+  std::shared_ptr<arrow::Table> decorateVertexTable(
+      const std::shared_ptr<arrow::Table>& table, label_id_t label_id) {
+    std::shared_ptr<arrow::KeyValueMetadata> meta;
+    if (table->schema()->metadata() != nullptr) {
+      meta = table->schema()->metadata()->Copy();
+    } else {
+      meta.reset(new arrow::KeyValueMetadata());
+    }
+    meta->Append("type", "VERTEX");
+    meta->Append(basic_loader_t::ID_COLUMN, std::to_string(id_column));
+
+    int label_meta_index = meta->FindKey(LABEL_TAG);
+    VINEYARD_ASSERT(label_meta_index != -1,
+                    "Metadata of input vertex files should contain label name");
+    vertex_label_to_index_[meta->value(label_meta_index)] = label_id;
+    return table->ReplaceSchemaMetadata(meta);
+  }
+
   std::vector<std::vector<std::shared_ptr<arrow::Table>>> gatherETables(
       vineyard::Client& client,
       const std::vector<std::vector<ObjectID>>& estreams) {
@@ -813,47 +1484,8 @@ class ArrowFragmentLoader {
         std::shared_ptr<arrow::Table> table;
         auto status = readTableFromVineyard(client, estream, table);
         if (status.ok()) {
-          std::shared_ptr<arrow::KeyValueMetadata> meta;
-          if (table->schema()->metadata() != nullptr) {
-            meta = table->schema()->metadata()->Copy();
-          } else {
-            meta.reset(new arrow::KeyValueMetadata());
-          }
-          meta->Append("type", "EDGE");
-          meta->Append(basic_loader_t::SRC_COLUMN, std::to_string(src_column));
-          meta->Append(basic_loader_t::DST_COLUMN, std::to_string(dst_column));
-          meta->Append("sub_label_num", std::to_string(esubstreams.size()));
-
-          int label_meta_index = meta->FindKey(LABEL_TAG);
-          VINEYARD_ASSERT(
-              label_meta_index != -1,
-              "Metadata of input edge files should contain label name");
-          std::string edge_label_name = meta->value(label_meta_index);
-
-          int src_label_meta_index = meta->FindKey(SRC_LABEL_TAG);
-          VINEYARD_ASSERT(
-              src_label_meta_index != -1,
-              "Metadata of input edge files should contain src_label name");
-          std::string src_label_name = meta->value(src_label_meta_index);
-
-          int dst_label_meta_index = meta->FindKey(DST_LABEL_TAG);
-          VINEYARD_ASSERT(
-              dst_label_meta_index != -1,
-              "Metadata of input edge files should contain dst_label name");
-          std::string dst_label_name = meta->value(dst_label_meta_index);
-
-          meta->Append(
-              basic_loader_t::SRC_LABEL_ID,
-              std::to_string(vertex_label_to_index_.at(src_label_name)));
-          meta->Append(
-              basic_loader_t::DST_LABEL_ID,
-              std::to_string(vertex_label_to_index_.at(dst_label_name)));
-
-          edge_vertex_label_[edge_label_name].insert(
-              std::make_pair(src_label_name, dst_label_name));
-          edge_label_to_index_[edge_label_name] = label_id;
-
-          subtables.emplace_back(table->ReplaceSchemaMetadata(meta));
+          subtables.emplace_back(
+              decorateEdgeTable(table, label_id, esubstreams.size()));
         } else {
           LOG(ERROR) << "Failed to read edge stream: " << status.ToString();
         }
@@ -865,6 +1497,49 @@ class ArrowFragmentLoader {
     return tables;
   }
 
+  std::shared_ptr<arrow::Table> decorateEdgeTable(
+      const std::shared_ptr<arrow::Table>& table, label_id_t label_id,
+      size_t sub_label_num) {
+    std::shared_ptr<arrow::KeyValueMetadata> meta;
+    if (table->schema()->metadata() != nullptr) {
+      meta = table->schema()->metadata()->Copy();
+    } else {
+      meta.reset(new arrow::KeyValueMetadata());
+    }
+    meta->Append("type", "EDGE");
+    meta->Append(basic_loader_t::SRC_COLUMN, std::to_string(src_column));
+    meta->Append(basic_loader_t::DST_COLUMN, std::to_string(dst_column));
+    meta->Append("sub_label_num", std::to_string(sub_label_num));
+
+    int label_meta_index = meta->FindKey(LABEL_TAG);
+    VINEYARD_ASSERT(label_meta_index != -1,
+                    "Metadata of input edge files should contain label name");
+    std::string edge_label_name = meta->value(label_meta_index);
+
+    int src_label_meta_index = meta->FindKey(SRC_LABEL_TAG);
+    VINEYARD_ASSERT(
+        src_label_meta_index != -1,
+        "Metadata of input edge files should contain src_label name");
+    std::string src_label_name = meta->value(src_label_meta_index);
+
+    int dst_label_meta_index = meta->FindKey(DST_LABEL_TAG);
+    VINEYARD_ASSERT(
+        dst_label_meta_index != -1,
+        "Metadata of input edge files should contain dst_label name");
+    std::string dst_label_name = meta->value(dst_label_meta_index);
+
+    meta->Append(basic_loader_t::SRC_LABEL_ID,
+                 std::to_string(vertex_label_to_index_.at(src_label_name)));
+    meta->Append(basic_loader_t::DST_LABEL_ID,
+                 std::to_string(vertex_label_to_index_.at(dst_label_name)));
+
+    edge_vertex_label_[edge_label_name].insert(
+        std::make_pair(src_label_name, dst_label_name));
+    edge_label_to_index_[edge_label_name] = label_id;
+
+    return table->ReplaceSchemaMetadata(meta);
+  }
+
   arrow::Status swapColumn(std::shared_ptr<arrow::Table> in, int lhs_index,
                            int rhs_index, std::shared_ptr<arrow::Table>* out) {
     if (lhs_index == rhs_index) {
@@ -1056,9 +1731,27 @@ class ArrowFragmentLoader {
   label_id_t vertex_label_num_, edge_label_num_;
   std::vector<std::shared_ptr<arrow::Table>> partial_v_tables_;
   std::vector<std::vector<std::shared_ptr<arrow::Table>>> partial_e_tables_;
+  std::vector<ObjectID> vstreams_;
+  std::vector<std::vector<ObjectID>> estreams_;
+  // the blobs of the input tables in vineyard, see `readTableFromVineyard`
+  std::vector<std::shared_ptr<SealedBlobScope>> input_blob_scopes_;
   partitioner_t partitioner_;
 
   bool directed_;
+  bool compact_edges_ = false;
+  bool degree_statistics_ = false;
+  bool merged_edges_ = false;
+  bool sort_edges_ = false;
+  bool dedup_edges_ = false;
+  VertexReorderStrategy vertex_reorder_ = VertexReorderStrategy::kNone;
+  bool shared_memory_shuffle_ = false;
+  std::string shuffle_compression_;
+  size_t stream_memory_budget_ = 0;
+  int io_concurrency_ = 1;
+  bool edge_balanced_partition_ = false;
+  bool partitioned_vertex_map_ = false;
+  std::vector<PhaseStat> phase_stats_;
+  double phase_begin_ = 0;
   basic_loader_t basic_arrow_fragment_loader_;
   std::function<void(vineyard::LocalIOAdaptor*)> io_deleter_ =
       [](vineyard::LocalIOAdaptor* adaptor) {
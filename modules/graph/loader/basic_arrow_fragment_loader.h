@@ -16,16 +16,22 @@ limitations under the License.
 #ifndef MODULES_GRAPH_LOADER_BASIC_ARROW_FRAGMENT_LOADER_H_
 #define MODULES_GRAPH_LOADER_BASIC_ARROW_FRAGMENT_LOADER_H_
 
+#include <algorithm>
 #include <atomic>
+#include <limits>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "arrow/util/config.h"
+#include "basic/ds/arrow_memory_pool.h"
 #include "client/client.h"
+#include "flat_hash_map/flat_hash_map.hpp"
 #include "grape/worker/comm_spec.h"
 #include "io/io/local_io_adaptor.h"
 
@@ -34,6 +40,8 @@ limitations under the License.
 #include "graph/utils/partitioner.h"
 #include "graph/utils/table_shuffler.h"
 #include "graph/utils/table_shuffler_beta.h"
+#include "graph/utils/thread_group.h"
+#include "graph/utils/vertex_reorder.h"
 #include "graph/vertex_map/arrow_vertex_map.h"
 
 namespace vineyard {
@@ -91,8 +99,19 @@ class BasicArrowFragmentLoader {
   using oid_array_t = typename vineyard::ConvertToArrowType<oid_t>::ArrayType;
   using internal_oid_t = typename InternalType<oid_t>::type;
   using partitioner_t = PARTITIONER_T;
+  using vid_array_t = typename vineyard::ConvertToArrowType<vid_t>::ArrayType;
 
  public:
+  // maps a batch of oids of the same fragment and label to gids
+  using batch_oid_mapper_t =
+      std::function<bool(fid_t, label_id_t, const std::vector<internal_oid_t>&,
+                         std::vector<vid_t>&)>;
+  // maps a batch of oids of the local fragment to gids, where the gids of the
+  // missing oids are `std::numeric_limits<vid_t>::max()`
+  using local_oid_mapper_t =
+      std::function<void(label_id_t, const std::vector<internal_oid_t>&,
+                         std::vector<vid_t>&)>;
+
   constexpr static const char* ID_COLUMN = "id_column";
   constexpr static const char* SRC_COLUMN = "src_column";
   constexpr static const char* DST_COLUMN = "dst_column";
@@ -106,6 +125,49 @@ class BasicArrowFragmentLoader {
     partitioner_ = partitioner;
   }
 
+  /**
+   * @brief Exchange the shuffled rows between the workers that connect to the
+   * same vineyardd as vineyard record batches, rather than MPI messages.
+   *
+   * The received record batches are kept in vineyardd until
+   * `ReleaseSharedBatches` is invoked, after the local tables have been
+   * consumed.
+   */
+  void EnableSharedMemoryShuffle(Client& client) { client_ = &client; }
+
+  /**
+   * @brief Compress the shuffled rows with the given codec, see also
+   * `beta::ShuffleTableByOffsetListsPipelined()`.
+   */
+  void SetShuffleCompression(std::string const& codec) {
+    shuffle_compression_ = codec;
+  }
+
+  /**
+   * @brief Gather the oid arrays of all workers in `ShuffleVertexTables`
+   * (the default), otherwise only the oid arrays of the local fragment are
+   * kept in `GetOidLists()`, and the others are left empty.
+   */
+  void SetGatherOidLists(bool gather_oid_lists) {
+    gather_oid_lists_ = gather_oid_lists;
+  }
+
+  /**
+   * @brief Receive the oid arrays gathered from the other workers into unsealed
+   * vineyard blobs, which are adopted by the vertex map when it seals the oid
+   * arrays, rather than being copied again.
+   */
+  void SetOidMemoryPool(Client& client) {
+    oid_pool_ = std::make_unique<VineyardMemoryPool>(client);
+  }
+
+  void ReleaseSharedBatches() {
+    if (client_ != nullptr && !shared_batches_.empty()) {
+      VINEYARD_SUPPRESS(client_->DelData(shared_batches_));
+    }
+    shared_batches_.clear();
+  }
+
   void Init(const std::vector<std::shared_ptr<arrow::Table>>& vertex_tables,
             const std::vector<std::vector<std::shared_ptr<arrow::Table>>>&
                 edge_tables) {
@@ -114,12 +176,18 @@ class BasicArrowFragmentLoader {
     v_label_num_ = vertex_tables.size();
     e_label_num_ = edge_tables.size();
     oid_lists_.resize(v_label_num_);
+    vnums_.resize(v_label_num_);
   }
 
   std::vector<std::vector<std::shared_ptr<oid_array_t>>>& GetOidLists() {
     return oid_lists_;
   }
 
+  // the number of vertices of every fragment, label/fid
+  const std::vector<std::vector<int64_t>>& GetVertexNums() const {
+    return vnums_;
+  }
+
   auto ShuffleVertexTables(bool deduplicate_oid)
       -> boost::leaf::result<std::vector<std::shared_ptr<arrow::Table>>> {
     std::vector<std::shared_ptr<arrow::Table>> local_v_tables(v_label_num_);
@@ -156,7 +224,8 @@ class BasicArrowFragmentLoader {
 #else
         {
           auto r = beta::ShufflePropertyVertexTable<partitioner_t>(
-              comm_spec_, partitioner_, vertex_table);
+              comm_spec_, partitioner_, vertex_table, client_,
+              &shared_batches_, shuffle_compression_);
           BOOST_LEAF_CHECK(r);
           tmp_table = r.value();
         }
@@ -206,26 +275,46 @@ class BasicArrowFragmentLoader {
             tmp_table->column(id_column_idx)->chunk(0));
 
         std::vector<std::shared_ptr<oid_array_t>> oids_group_by_worker;
-        {
-          auto st = FragmentAllGatherArray<oid_t>(comm_spec_, local_oid_array,
-                                                  oids_group_by_worker);
+        if (gather_oid_lists_) {
+          auto st = FragmentAllGatherArray<oid_t>(
+              comm_spec_, local_oid_array, oids_group_by_worker,
+              oid_pool_ == nullptr ? arrow::default_memory_pool()
+                                   : oid_pool_.get());
           if (!st) {
             LOG(FATAL) << "An error occurred during the gather oid array "
                           "procedure. "
                        << st.message();
           }
+        } else {
+          oids_group_by_worker.resize(comm_spec_.worker_num());
+          oids_group_by_worker[comm_spec_.worker_id()] = local_oid_array;
         }
 
         // Deduplicate oids. this procedure is necessary when the oids are
         // inferred from efile
         if (deduplicate_oid) {
           for (size_t i = 0; i < oids_group_by_worker.size(); i++) {
+            if (oids_group_by_worker[i] == nullptr) {
+              continue;
+            }
             OidSet<oid_t> oid_set;
             BOOST_LEAF_CHECK(oid_set.BatchInsert(oids_group_by_worker[i]));
             BOOST_LEAF_AUTO(deduplicated_oid_array, oid_set.ToArrowArray());
             oids_group_by_worker[i] = deduplicated_oid_array;
           }
         }
+
+        auto& vnums = vnums_[v_label];
+        vnums.resize(comm_spec_.worker_num());
+        if (gather_oid_lists_) {
+          for (size_t i = 0; i < oids_group_by_worker.size(); i++) {
+            vnums[i] = oids_group_by_worker[i]->length();
+          }
+        } else {
+          int64_t vnum = oids_group_by_worker[comm_spec_.worker_id()]->length();
+          MPI_Allgather(&vnum, 1, MPI_INT64_T, vnums.data(), 1, MPI_INT64_T,
+                        comm_spec_.comm());
+        }
         oid_lists_[v_label] = oids_group_by_worker;
         return tmp_table;
       };
@@ -239,6 +328,21 @@ class BasicArrowFragmentLoader {
   auto ShuffleEdgeTables(
       std::function<bool(fid_t, label_id_t, internal_oid_t, vid_t&)> mapper)
       -> boost::leaf::result<std::vector<std::shared_ptr<arrow::Table>>> {
+    return ShuffleEdgeTables(batch_oid_mapper_t(
+        [mapper](fid_t fid, label_id_t label,
+                 const std::vector<internal_oid_t>& oids,
+                 std::vector<vid_t>& gids) {
+          gids.resize(oids.size());
+          bool all_found = true;
+          for (size_t i = 0; i < oids.size(); ++i) {
+            all_found &= mapper(fid, label, oids[i], gids[i]);
+          }
+          return all_found;
+        }));
+  }
+
+  auto ShuffleEdgeTables(batch_oid_mapper_t mapper)
+      -> boost::leaf::result<std::vector<std::shared_ptr<arrow::Table>>> {
     std::vector<std::shared_ptr<arrow::Table>> local_e_tables(e_label_num_);
     vineyard::IdParser<vid_t> id_parser;
     std::shared_ptr<arrow::Field> src_gid_field =
@@ -346,7 +450,8 @@ class BasicArrowFragmentLoader {
         }
 #else
         auto r = beta::ShufflePropertyEdgeTable<vid_t>(
-            comm_spec_, id_parser, src_column_idx, dst_column_idx, table);
+            comm_spec_, id_parser, src_column_idx, dst_column_idx, table,
+            client_, &shared_batches_, shuffle_compression_);
         BOOST_LEAF_CHECK(r);
         table_out = r.value();
 #endif
@@ -359,6 +464,325 @@ class BasicArrowFragmentLoader {
     return local_e_tables;
   }
 
+  /**
+   * @brief Resolve the gids of the remote vertices that the (unshuffled) edge
+   * tables refer to, by asking the owners of the vertices in batches, for the
+   * vertex maps that only have the oids of the local fragment. It is a
+   * collective operation, which must be invoked by all workers after the
+   * vertex tables are shuffled.
+   *
+   * Only the numeric oids are supported, and the result is label/oid->gid.
+   */
+  auto ResolveRemoteOids(const local_oid_mapper_t& local_mapper)
+      -> boost::leaf::result<
+          std::vector<ska::flat_hash_map<internal_oid_t, vid_t>>> {
+    static_assert(std::is_arithmetic<internal_oid_t>::value,
+                  "Only the numeric oids can be resolved in batches");
+    fid_t const fnum = comm_spec_.fnum();
+    fid_t const local_fid = comm_spec_.fid();
+    int const worker_num = comm_spec_.worker_num();
+    vid_t const missing = std::numeric_limits<vid_t>::max();
+
+    // label/fid/oids
+    std::vector<std::vector<ska::flat_hash_set<internal_oid_t>>> remote_oids(
+        v_label_num_, std::vector<ska::flat_hash_set<internal_oid_t>>(fnum));
+    auto collect_procedure = [&]() -> boost::leaf::result<bool> {
+      std::vector<fid_t> fids;
+      for (auto& edge_table_list : edge_tables_) {
+        for (auto& edge_table : edge_table_list) {
+          auto metadata = edge_table->schema()->metadata();
+          for (auto const& keys : {std::make_pair(SRC_COLUMN, SRC_LABEL_ID),
+                                   std::make_pair(DST_COLUMN, DST_LABEL_ID)}) {
+            auto meta_idx_column = metadata->FindKey(keys.first);
+            auto meta_idx_label = metadata->FindKey(keys.second);
+            CHECK_OR_RAISE(meta_idx_column != -1);
+            CHECK_OR_RAISE(meta_idx_label != -1);
+            auto column = edge_table->column(
+                std::stoi(metadata->value(meta_idx_column)));
+            auto label_id = static_cast<label_id_t>(
+                std::stoi(metadata->value(meta_idx_label)));
+            CHECK_OR_RAISE(label_id >= 0 && label_id < v_label_num_);
+            if (!column->type()->Equals(
+                    vineyard::ConvertToArrowType<oid_t>::TypeValue())) {
+              RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                              "OID_T is not same with arrow::Column(" +
+                                  column->type()->ToString() + ")");
+            }
+            for (auto const& chunk : column->chunks()) {
+              auto oids = std::dynamic_pointer_cast<oid_array_t>(chunk);
+              fids.resize(oids->length());
+              partitioner_.GetPartitionIds(*oids, fids.data());
+              for (int64_t k = 0; k < oids->length(); ++k) {
+                if (fids[k] != local_fid) {
+                  remote_oids[label_id][fids[k]].insert(oids->GetView(k));
+                }
+              }
+            }
+          }
+        }
+      }
+      return true;
+    };
+    BOOST_LEAF_CHECK(sync_gs_error(comm_spec_, collect_procedure));
+
+    std::vector<ska::flat_hash_map<internal_oid_t, vid_t>> resolved(
+        v_label_num_);
+    bool all_resolved = true;
+    for (label_id_t v_label = 0; v_label < v_label_num_; v_label++) {
+      std::vector<int> send_counts(worker_num), recv_counts;
+      std::vector<internal_oid_t> send_oids, recv_oids;
+      for (int worker = 0; worker < worker_num; ++worker) {
+        fid_t fid = comm_spec_.WorkerToFrag(worker);
+        auto const& oids = remote_oids[v_label][fid];
+        send_oids.insert(send_oids.end(), oids.begin(), oids.end());
+        send_counts[worker] = static_cast<int>(oids.size());
+      }
+      remote_oids[v_label].clear();
+      exchangeCounts(send_counts, recv_counts);
+      exchangeBuffers(send_oids, send_counts, recv_oids, recv_counts);
+
+      // the oids asked by other workers, and their gids in the local fragment
+      std::vector<vid_t> recv_gids, send_gids;
+      local_mapper(v_label, recv_oids, recv_gids);
+      recv_gids.resize(recv_oids.size(), missing);
+      exchangeBuffers(recv_gids, recv_counts, send_gids, send_counts);
+
+      auto& o2g = resolved[v_label];
+      o2g.reserve(send_oids.size());
+      for (size_t k = 0; k < send_oids.size(); ++k) {
+        if (send_gids[k] == missing) {
+          all_resolved = false;
+        } else {
+          o2g.emplace(send_oids[k], send_gids[k]);
+        }
+      }
+    }
+
+    // raise after the collective operations, to not block other workers
+    auto check_procedure = [&]() -> boost::leaf::result<bool> {
+      if (!all_resolved) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "Some vertices referred by the edges don't exist");
+      }
+      return true;
+    };
+    BOOST_LEAF_CHECK(sync_gs_error(comm_spec_, check_procedure));
+    return resolved;
+  }
+
+  /**
+   * @brief Fetch the oids of the outer vertices of the shuffled edge tables
+   * from their owners, which are the mirrors of the partitioned vertex map,
+   * see also `SetGatherOidLists()`. It is a collective operation, and the
+   * mirrors of each label are sorted by the gids.
+   */
+  boost::leaf::result<void> GatherMirrors(
+      const std::vector<std::shared_ptr<arrow::Table>>& local_e_tables,
+      std::vector<std::shared_ptr<oid_array_t>>& mirror_oids,
+      std::vector<std::shared_ptr<vid_array_t>>& mirror_gids) {
+    static_assert(std::is_arithmetic<internal_oid_t>::value,
+                  "Only the numeric oids can be gathered in batches");
+    fid_t const fnum = comm_spec_.fnum();
+    fid_t const local_fid = comm_spec_.fid();
+    int const worker_num = comm_spec_.worker_num();
+    vineyard::IdParser<vid_t> id_parser;
+    id_parser.Init(fnum, v_label_num_);
+
+    // label/fid/gids
+    std::vector<std::vector<ska::flat_hash_set<vid_t>>> remote_gids(
+        v_label_num_, std::vector<ska::flat_hash_set<vid_t>>(fnum));
+    auto collect = [&](vid_t const gid) {
+      fid_t fid = id_parser.GetFid(gid);
+      if (fid != local_fid) {
+        remote_gids[id_parser.GetLabelId(gid)][fid].insert(gid);
+      }
+    };
+    for (auto& table : local_e_tables) {
+      forEachEdge(table, [&](vid_t const src, vid_t const dst) {
+        collect(src);
+        collect(dst);
+      });
+    }
+
+    mirror_oids.resize(v_label_num_);
+    mirror_gids.resize(v_label_num_);
+    bool all_resolved = true;
+    for (label_id_t v_label = 0; v_label < v_label_num_; v_label++) {
+      std::vector<int> send_counts(worker_num), recv_counts;
+      std::vector<vid_t> send_gids, recv_gids;
+      for (int worker = 0; worker < worker_num; ++worker) {
+        fid_t fid = comm_spec_.WorkerToFrag(worker);
+        auto const& gids = remote_gids[v_label][fid];
+        send_gids.insert(send_gids.end(), gids.begin(), gids.end());
+        send_counts[worker] = static_cast<int>(gids.size());
+      }
+      remote_gids[v_label].clear();
+      exchangeCounts(send_counts, recv_counts);
+      exchangeBuffers(send_gids, send_counts, recv_gids, recv_counts);
+
+      // the inner vertices asked by other workers
+      auto const& local_oids = oid_lists_[v_label][comm_spec_.worker_id()];
+      std::vector<internal_oid_t> recv_oids(recv_gids.size()), send_oids;
+      for (size_t k = 0; k < recv_gids.size(); ++k) {
+        int64_t offset = id_parser.GetOffset(recv_gids[k]);
+        if (offset < local_oids->length()) {
+          recv_oids[k] = local_oids->GetView(offset);
+        } else {
+          all_resolved = false;
+        }
+      }
+      exchangeBuffers(recv_oids, recv_counts, send_oids, send_counts);
+
+      std::vector<int64_t> order(send_gids.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+        return send_gids[a] < send_gids[b];
+      });
+      typename ConvertToArrowType<oid_t>::BuilderType oid_builder;
+      typename ConvertToArrowType<vid_t>::BuilderType gid_builder;
+      ARROW_OK_OR_RAISE(oid_builder.Reserve(order.size()));
+      ARROW_OK_OR_RAISE(gid_builder.Reserve(order.size()));
+      for (int64_t index : order) {
+        oid_builder.UnsafeAppend(send_oids[index]);
+        gid_builder.UnsafeAppend(send_gids[index]);
+      }
+      ARROW_OK_OR_RAISE(oid_builder.Finish(&mirror_oids[v_label]));
+      ARROW_OK_OR_RAISE(gid_builder.Finish(&mirror_gids[v_label]));
+    }
+
+    auto check_procedure = [&]() -> boost::leaf::result<bool> {
+      if (!all_resolved) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "Some outer vertices don't exist in their fragments");
+      }
+      return true;
+    };
+    BOOST_LEAF_CHECK(sync_gs_error(comm_spec_, check_procedure));
+    return {};
+  }
+
+  /**
+   * @brief Reorder the inner vertices of each label by the given strategy,
+   * the local vertex tables, the oid lists (see `GetOidLists`) and the gids
+   * in the local edge tables (of all workers) are rewritten accordingly.
+   *
+   * It is a collective operation, which must be invoked by all workers after
+   * `ShuffleEdgeTables`, and the vertex map must be rebuilt from the
+   * reordered oid lists.
+   */
+  boost::leaf::result<void> ReorderVertices(
+      VertexReorderStrategy strategy,
+      std::vector<std::shared_ptr<arrow::Table>>& local_v_tables,
+      std::vector<std::shared_ptr<arrow::Table>>& local_e_tables) {
+    if (strategy == VertexReorderStrategy::kNone) {
+      return {};
+    }
+    fid_t const fid = comm_spec_.fid();
+    fid_t const fnum = comm_spec_.fnum();
+    vineyard::IdParser<vid_t> id_parser;
+    id_parser.Init(fnum, v_label_num_);
+
+    using orders_t = std::vector<std::shared_ptr<arrow::Int64Array>>;
+    auto order_procedure = [&]() -> boost::leaf::result<orders_t> {
+      std::vector<std::vector<int64_t>> degrees(v_label_num_);
+      for (label_id_t v_label = 0; v_label < v_label_num_; ++v_label) {
+        int64_t ivnum = oid_lists_[v_label][fid]->length();
+        if (local_v_tables[v_label]->num_rows() != ivnum) {
+          RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                          "Reordering vertices requires the vertex table "
+                          "matches the oids of label " +
+                              std::to_string(v_label));
+        }
+        degrees[v_label].resize(ivnum, 0);
+      }
+      // the edges between the inner vertices of the same label
+      std::vector<std::vector<std::pair<int64_t, int64_t>>> local_edges(
+          v_label_num_);
+      for (auto& table : local_e_tables) {
+        forEachEdge(table, [&](vid_t const src, vid_t const dst) {
+          bool src_inner = id_parser.GetFid(src) == fid;
+          bool dst_inner = id_parser.GetFid(dst) == fid;
+          label_id_t src_label = id_parser.GetLabelId(src);
+          label_id_t dst_label = id_parser.GetLabelId(dst);
+          if (src_inner) {
+            degrees[src_label][id_parser.GetOffset(src)] += 1;
+          }
+          if (dst_inner) {
+            degrees[dst_label][id_parser.GetOffset(dst)] += 1;
+          }
+          if (strategy == VertexReorderStrategy::kRCM && src_inner &&
+              dst_inner && src_label == dst_label) {
+            local_edges[src_label].emplace_back(id_parser.GetOffset(src),
+                                                id_parser.GetOffset(dst));
+          }
+        });
+      }
+
+      orders_t orders(v_label_num_);
+      for (label_id_t v_label = 0; v_label < v_label_num_; ++v_label) {
+        std::vector<int64_t> order;
+        if (strategy == VertexReorderStrategy::kDegree) {
+          order = DegreeOrder(degrees[v_label]);
+        } else {
+          std::vector<int64_t> offsets, neighbors;
+          BuildSymmetricCSR(degrees[v_label].size(), local_edges[v_label],
+                            offsets, neighbors);
+          local_edges[v_label].clear();
+          local_edges[v_label].shrink_to_fit();
+          order = ReverseCuthillMcKeeOrder(offsets, neighbors,
+                                           degrees[v_label]);
+        }
+        arrow::Int64Builder builder;
+        ARROW_OK_OR_RAISE(builder.AppendValues(order));
+        ARROW_OK_OR_RAISE(builder.Finish(&orders[v_label]));
+      }
+      return orders;
+    };
+    BOOST_LEAF_AUTO(local_orders, sync_gs_error(comm_spec_, order_procedure));
+
+    // the new offsets of vertices of every fragment, i.e., v_label/fid/offset
+    std::vector<std::vector<std::vector<int64_t>>> new_offsets(v_label_num_);
+    for (label_id_t v_label = 0; v_label < v_label_num_; v_label++) {
+      orders_t orders;
+      VY_OK_OR_RAISE(FragmentAllGatherArray<int64_t>(
+          comm_spec_, local_orders[v_label], orders));
+      new_offsets[v_label].resize(fnum);
+      for (fid_t i = 0; i < fnum; ++i) {
+        const int64_t* values = orders[i]->raw_values();
+        std::vector<int64_t> order(values, values + orders[i]->length());
+        BOOST_LEAF_AUTO(oids, permuteOids(oid_lists_[v_label][i], order));
+        oid_lists_[v_label][i] = oids;
+        if (i == fid) {
+          BOOST_LEAF_AUTO(table, permuteRows(local_v_tables[v_label], order));
+          local_v_tables[v_label] = table;
+        }
+        new_offsets[v_label][i] = InverseOrder(order);
+      }
+    }
+
+    auto remap = [&](vid_t const gid) {
+      fid_t gid_fid = id_parser.GetFid(gid);
+      label_id_t gid_label = id_parser.GetLabelId(gid);
+      return id_parser.GenerateId(
+          gid_fid, gid_label,
+          new_offsets[gid_label][gid_fid][id_parser.GetOffset(gid)]);
+    };
+    for (auto& table : local_e_tables) {
+      for (int column_idx : {0, 1}) {
+        BOOST_LEAF_AUTO(gids, remapGids(table->column(column_idx), remap));
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+        ARROW_OK_OR_RAISE(table->SetColumn(
+            column_idx, table->schema()->field(column_idx), gids, &table));
+#else
+        ARROW_OK_ASSIGN_OR_RAISE(
+            table, table->SetColumn(column_idx,
+                                    table->schema()->field(column_idx), gids));
+#endif
+      }
+    }
+    return {};
+  }
+
   std::shared_ptr<arrow::Table> ConcatenateTables(
       std::vector<std::shared_ptr<arrow::Table>>& tables) {
     if (tables.size() == 1) {
@@ -379,11 +803,127 @@ class BasicArrowFragmentLoader {
   }
 
  private:
+  // the number of elements to send to each worker, and to receive from
+  void exchangeCounts(const std::vector<int>& send_counts,
+                      std::vector<int>& recv_counts) {
+    recv_counts.resize(comm_spec_.worker_num());
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1,
+                 MPI_INT, comm_spec_.comm());
+  }
+
+  // exchange the trivially copyable elements, grouped by the workers
+  template <typename T>
+  void exchangeBuffers(const std::vector<T>& send,
+                       const std::vector<int>& send_counts,
+                       std::vector<T>& recv,
+                       const std::vector<int>& recv_counts) {
+    int const worker_num = comm_spec_.worker_num();
+    std::vector<int> send_offsets(worker_num, 0), recv_offsets(worker_num, 0);
+    for (int worker = 1; worker < worker_num; ++worker) {
+      send_offsets[worker] = send_offsets[worker - 1] + send_counts[worker - 1];
+      recv_offsets[worker] = recv_offsets[worker - 1] + recv_counts[worker - 1];
+    }
+    recv.resize(recv_offsets[worker_num - 1] + recv_counts[worker_num - 1]);
+    MPI_Datatype type;
+    MPI_Type_contiguous(sizeof(T), MPI_CHAR, &type);
+    MPI_Type_commit(&type);
+    MPI_Alltoallv(send.data(), send_counts.data(), send_offsets.data(), type,
+                  recv.data(), recv_counts.data(), recv_offsets.data(), type,
+                  comm_spec_.comm());
+    MPI_Type_free(&type);
+  }
+
+  // iterate the (src, dst) gid pairs of the edge table, where the chunks of
+  // the two columns are not necessarily aligned
+  template <typename FUNC_T>
+  void forEachEdge(const std::shared_ptr<arrow::Table>& table,
+                   const FUNC_T& func) {
+    auto src_column = table->column(0);
+    auto dst_column = table->column(1);
+    int src_chunk = -1, dst_chunk = -1;
+    int64_t src_index = 0, dst_index = 0, src_length = 0, dst_length = 0;
+    const vid_t *src_values = nullptr, *dst_values = nullptr;
+    for (int64_t k = 0; k < table->num_rows(); ++k) {
+      while (src_index == src_length) {
+        auto chunk = std::dynamic_pointer_cast<vid_array_t>(
+            src_column->chunk(++src_chunk));
+        src_values = chunk->raw_values();
+        src_length = chunk->length();
+        src_index = 0;
+      }
+      while (dst_index == dst_length) {
+        auto chunk = std::dynamic_pointer_cast<vid_array_t>(
+            dst_column->chunk(++dst_chunk));
+        dst_values = chunk->raw_values();
+        dst_length = chunk->length();
+        dst_index = 0;
+      }
+      func(src_values[src_index++], dst_values[dst_index++]);
+    }
+  }
+
+  template <typename FUNC_T>
+  auto remapGids(const std::shared_ptr<arrow::ChunkedArray>& gids_in,
+                 const FUNC_T& remap)
+      -> boost::leaf::result<std::shared_ptr<arrow::ChunkedArray>> {
+    std::vector<std::shared_ptr<arrow::Array>> chunks_out(
+        gids_in->num_chunks());
+    for (int chunk_i = 0; chunk_i < gids_in->num_chunks(); ++chunk_i) {
+      auto chunk = std::dynamic_pointer_cast<vid_array_t>(
+          gids_in->chunk(chunk_i));
+      typename ConvertToArrowType<vid_t>::BuilderType builder;
+      ARROW_OK_OR_RAISE(builder.Resize(chunk->length()));
+      for (int64_t k = 0; k < chunk->length(); ++k) {
+        builder[k] = remap(chunk->Value(k));
+      }
+      ARROW_OK_OR_RAISE(builder.Advance(chunk->length()));
+      ARROW_OK_OR_RAISE(builder.Finish(&chunks_out[chunk_i]));
+    }
+    return std::make_shared<arrow::ChunkedArray>(chunks_out,
+                                                 gids_in->type());
+  }
+
+  auto permuteOids(const std::shared_ptr<oid_array_t>& oids,
+                   const std::vector<int64_t>& order)
+      -> boost::leaf::result<std::shared_ptr<oid_array_t>> {
+    typename vineyard::ConvertToArrowType<oid_t>::BuilderType builder;
+    ARROW_OK_OR_RAISE(builder.Reserve(order.size()));
+    for (int64_t index : order) {
+      ARROW_OK_OR_RAISE(builder.Append(oids->GetView(index)));
+    }
+    std::shared_ptr<oid_array_t> oids_out;
+    ARROW_OK_OR_RAISE(builder.Finish(&oids_out));
+    return oids_out;
+  }
+
+  auto permuteRows(const std::shared_ptr<arrow::Table>& table,
+                   const std::vector<int64_t>& order)
+      -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
+    if (table->num_rows() == 0) {
+      return table;
+    }
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    std::shared_ptr<arrow::RecordBatch> batch;
+    VY_OK_OR_RAISE(TableToRecordBatches(table, &batches));
+    VY_OK_OR_RAISE(CombineRecordBatches(batches, &batch));
+
+    std::unique_ptr<arrow::RecordBatchBuilder> builder;
+    ARROW_OK_OR_RAISE(arrow::RecordBatchBuilder::Make(
+        table->schema(), arrow::default_memory_pool(), 4096, &builder));
+    ColumnarTableAppender appender(table->schema());
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches_out;
+    VY_OK_OR_RAISE(appender.Apply(builder, batch, order, batches_out));
+    VY_OK_OR_RAISE(appender.Flush(builder, batches_out));
+
+    std::shared_ptr<arrow::Table> table_out;
+    VY_OK_OR_RAISE(RecordBatchesToTable(batches_out, &table_out));
+    return table_out->ReplaceSchemaMetadata(table->schema()->metadata());
+  }
+
   auto parseOidChunkedArray(
       label_id_t label_id,
       const std::shared_ptr<arrow::ChunkedArray>& oid_arrays_in,
-      std::function<bool(fid_t, label_id_t, internal_oid_t, vid_t&)>&
-          oid2gid_mapper)
+      batch_oid_mapper_t& oid2gid_mapper)
       -> boost::leaf::result<std::shared_ptr<arrow::ChunkedArray>> {
     size_t chunk_num = oid_arrays_in->num_chunks();
     std::vector<std::shared_ptr<arrow::Array>> chunks_out(chunk_num);
@@ -408,55 +948,77 @@ class BasicArrowFragmentLoader {
     int thread_num =
         (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
         comm_spec_.local_num();
-    std::vector<std::thread> parse_threads(thread_num);
-
-    std::atomic<size_t> cur(0);
+    std::vector<std::vector<std::vector<internal_oid_t>>> lane_fid_oids(
+        thread_num);
+    std::vector<std::vector<std::vector<size_t>>> lane_fid_positions(
+        thread_num);
+    std::vector<std::vector<vid_t>> lane_gids(thread_num);
     std::vector<arrow::Status> statuses(thread_num, arrow::Status::OK());
-    for (int i = 0; i < thread_num; ++i) {
-      parse_threads[i] = std::thread(
-          [&](int tid) {
-            while (true) {
-              auto got = cur.fetch_add(1);
-              if (got >= chunk_num) {
-                break;
-              }
-              std::shared_ptr<oid_array_t> oid_array =
-                  std::dynamic_pointer_cast<oid_array_t>(
-                      oid_arrays_in->chunk(got));
-              typename ConvertToArrowType<vid_t>::BuilderType builder;
-              size_t size = oid_array->length();
-
-              arrow::Status status = builder.Resize(size);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
-              }
+    ThreadPool::Default().ParallelFor(
+        chunk_num,
+        [&](size_t tid, size_t begin, size_t end) {
+          // the oids of each fragment, and their positions in the chunk, to
+          // be mapped in batches
+          fid_t const fnum = comm_spec_.fnum();
+          auto& fid_oids = lane_fid_oids[tid];
+          auto& fid_positions = lane_fid_positions[tid];
+          auto& gids = lane_gids[tid];
+          std::vector<fid_t> fids;
+          fid_oids.resize(fnum);
+          fid_positions.resize(fnum);
+          for (size_t got = begin; got < end; ++got) {
+            if (!statuses[tid].ok()) {
+              return;
+            }
+            std::shared_ptr<oid_array_t> oid_array =
+                std::dynamic_pointer_cast<oid_array_t>(
+                    oid_arrays_in->chunk(got));
+            typename ConvertToArrowType<vid_t>::BuilderType builder;
+            size_t size = oid_array->length();
 
-              for (size_t k = 0; k != size; ++k) {
-                internal_oid_t oid = oid_array->GetView(k);
-                fid_t fid = partitioner_.GetPartitionId(oid_t(oid));
-                if (!oid2gid_mapper(fid, label_id, oid, builder[k])) {
-                  LOG(ERROR) << "Mapping vertex " << oid << " failed.";
-                }
-              }
+            arrow::Status status = builder.Resize(size);
+            if (!status.ok()) {
+              statuses[tid] = status;
+              return;
+            }
 
-              status = builder.Advance(size);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
+            for (fid_t fid = 0; fid < fnum; ++fid) {
+              fid_oids[fid].clear();
+              fid_positions[fid].clear();
+            }
+            fids.resize(size);
+            partitioner_.GetPartitionIds(*oid_array, fids.data());
+            for (size_t k = 0; k != size; ++k) {
+              fid_oids[fids[k]].emplace_back(oid_array->GetView(k));
+              fid_positions[fids[k]].emplace_back(k);
+            }
+            for (fid_t fid = 0; fid < fnum; ++fid) {
+              if (fid_oids[fid].empty()) {
+                continue;
               }
-              status = builder.Finish(&chunks_out[got]);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
+              if (!oid2gid_mapper(fid, label_id, fid_oids[fid], gids)) {
+                LOG(ERROR) << "Mapping vertices of fragment " << fid
+                           << " failed.";
+              }
+              auto const& positions = fid_positions[fid];
+              for (size_t k = 0; k != positions.size(); ++k) {
+                builder[positions[k]] = gids[k];
               }
             }
-          },
-          i);
-    }
-    for (auto& thrd : parse_threads) {
-      thrd.join();
-    }
+
+            status = builder.Advance(size);
+            if (!status.ok()) {
+              statuses[tid] = status;
+              return;
+            }
+            status = builder.Finish(&chunks_out[got]);
+            if (!status.ok()) {
+              statuses[tid] = status;
+              return;
+            }
+          }
+        },
+        thread_num, 1);
     for (auto& status : statuses) {
       if (!status.ok()) {
         RETURN_GS_ERROR(ErrorCode::kArrowError, status.ToString());
@@ -473,10 +1035,18 @@ class BasicArrowFragmentLoader {
   std::vector<std::shared_ptr<arrow::Table>> vertex_tables_;
   std::vector<std::vector<std::shared_ptr<arrow::Table>>> edge_tables_;
 
+  // must outlive the oid arrays that are allocated from it
+  std::unique_ptr<VineyardMemoryPool> oid_pool_;
   std::vector<std::vector<std::shared_ptr<oid_array_t>>>
       oid_lists_;  // v_label/fid/oid_array
+  std::vector<std::vector<int64_t>> vnums_;  // v_label/fid
+  bool gather_oid_lists_ = true;
 
   partitioner_t partitioner_;
+
+  Client* client_ = nullptr;
+  std::vector<ObjectID> shared_batches_;
+  std::string shuffle_compression_;
 };
 }  // namespace vineyard
 #endif  // MODULES_GRAPH_LOADER_BASIC_ARROW_FRAGMENT_LOADER_H_
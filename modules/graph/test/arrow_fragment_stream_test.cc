@@ -14,6 +14,7 @@ limitations under the License.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 
 #include <fstream>
 #include <string>
@@ -88,7 +89,7 @@ int main(int argc, char** argv) {
     printf(
         "usage: ./arrow_fragment_stream_test <ipc_socket> "
         "<e_label_num> <estreams...> "
-        "<v_label_num> <vstreams...> [directed]\n");
+        "<v_label_num> <vstreams...> [directed] [stream_memory_budget]\n");
     return 1;
   }
   int index = 1;
@@ -112,7 +113,13 @@ int main(int argc, char** argv) {
 
   int directed = 1;
   if (argc > index) {
-    directed = atoi(argv[index]);
+    directed = atoi(argv[index++]);
+  }
+
+  // load the streams window by window if a budget (in bytes) is given
+  size_t stream_memory_budget = 0;
+  if (argc > index) {
+    stream_memory_budget = strtoull(argv[index++], nullptr, 10);
   }
 
   vineyard::Client client;
@@ -130,6 +137,7 @@ int main(int argc, char** argv) {
         std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
                                              property_graph_types::VID_TYPE>>(
             client, comm_spec, vstreams, estreams, directed != 0);
+    loader->set_stream_memory_budget(stream_memory_budget);
     vineyard::ObjectID fragment_group_id = boost::leaf::try_handle_all(
         [&loader]() { return loader->LoadFragmentAsFragmentGroup(); },
         [](const GSError& e) {
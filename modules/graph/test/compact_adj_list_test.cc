@@ -0,0 +1,86 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/varint_encoding.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = uint64_t;
+using eid_t = uint64_t;
+using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
+using adj_list_t = property_graph_utils::CompactAdjList<vid_t, eid_t>;
+
+void check_adj_list(std::vector<nbr_unit_t> const& nbrs,
+                    size_t const eid_width) {
+  size_t size = property_graph_utils::compact_adj_list_size(
+      nbrs.data(), nbrs.data() + nbrs.size(), eid_width);
+  std::vector<uint8_t> buffer(std::max<size_t>(size, 1));
+  property_graph_utils::encode_compact_adj_list(
+      nbrs.data(), nbrs.data() + nbrs.size(), eid_width, buffer.data());
+
+  adj_list_t adj_list(buffer.data(), buffer.data() + size, nbrs.size(),
+                      eid_width, nullptr);
+  CHECK_EQ(adj_list.Size(), nbrs.size());
+  CHECK_EQ(adj_list.Empty(), nbrs.empty());
+
+  size_t index = 0;
+  for (auto& nbr : adj_list) {
+    CHECK_LT(index, nbrs.size());
+    CHECK_EQ(nbr.neighbor().GetValue(), nbrs[index].vid);
+    CHECK_EQ(nbr.edge_id(), nbrs[index].eid);
+    ++index;
+  }
+  CHECK_EQ(index, nbrs.size());
+
+  std::vector<vid_t> decoded(nbrs.size());
+  adj_list.DecodeNeighbors(decoded.data());
+  for (size_t k = 0; k < nbrs.size(); ++k) {
+    CHECK_EQ(decoded[k], nbrs[k].vid);
+  }
+}
+
+int main(int argc, char** argv) {
+  std::mt19937_64 rng(20201014);
+
+  // deltas of all widths, includes the duplicated neighbors (zero deltas)
+  for (size_t degree : {0, 1, 3, 4, 5, 17, 1000}) {
+    for (int shift : {0, 8, 24, 40, 63}) {
+      std::vector<nbr_unit_t> nbrs(degree);
+      eid_t max_eid = 0;
+      for (size_t k = 0; k < degree; ++k) {
+        nbrs[k].vid = rng() >> (63 - shift);
+        nbrs[k].eid = rng() % (degree * 7 + 1);
+        max_eid = std::max(max_eid, nbrs[k].eid);
+      }
+      std::sort(nbrs.begin(), nbrs.end(),
+                [](nbr_unit_t const& lhs, nbr_unit_t const& rhs) {
+                  return lhs.vid < rhs.vid;
+                });
+      check_adj_list(nbrs, varint::fixed_width(max_eid + 1));
+    }
+  }
+
+  LOG(INFO) << "Passed compact adjacency list tests...";
+  return 0;
+}
@@ -0,0 +1,93 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/utils/edge_data_gather.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// the layout of `property_graph_utils::NbrUnit`.
+template <typename VID_T, typename EID_T>
+struct nbr_unit_t {
+  VID_T vid;
+  EID_T eid;
+};
+
+template <typename T, typename NBR_T>
+void check_gather(std::vector<T> const& data, std::vector<NBR_T> const& nbrs) {
+  const NBR_T* begin = nbrs.data();
+  const NBR_T* end = nbrs.data() + nbrs.size();
+
+  std::vector<T> out(nbrs.size() + 1);
+  gather::gather(data.data(), begin, end, out.data());
+  T expected_min = std::numeric_limits<T>::max();
+  T expected_max = std::numeric_limits<T>::lowest();
+  for (size_t k = 0; k < nbrs.size(); ++k) {
+    CHECK_EQ(out[k], data[nbrs[k].eid]);
+    expected_min = std::min(expected_min, data[nbrs[k].eid]);
+    expected_max = std::max(expected_max, data[nbrs[k].eid]);
+  }
+  CHECK_EQ(gather::min(data.data(), begin, end), expected_min);
+  CHECK_EQ(gather::max(data.data(), begin, end), expected_max);
+
+  // the values are integral, hence the sum is exact for floating-points too.
+  T expected_sum = 0;
+  for (auto const& nbr : nbrs) {
+    expected_sum += data[nbr.eid];
+  }
+  CHECK_EQ(gather::sum(data.data(), begin, end), expected_sum);
+}
+
+template <typename T, typename VID_T, typename EID_T>
+void test_gather(std::mt19937& gen) {
+  std::vector<T> data(1000);
+  std::uniform_int_distribution<int> value_dist(-1000, 1000);
+  for (auto& value : data) {
+    value = static_cast<T>(value_dist(gen));
+  }
+  std::uniform_int_distribution<size_t> eid_dist(0, data.size() - 1);
+  for (size_t size : {0, 1, 3, 4, 7, 8, 9, 31, 255, 256, 257, 1000}) {
+    std::vector<nbr_unit_t<VID_T, EID_T>> nbrs(size);
+    for (size_t k = 0; k < size; ++k) {
+      nbrs[k].vid = static_cast<VID_T>(k);
+      nbrs[k].eid = static_cast<EID_T>(eid_dist(gen));
+    }
+    check_gather(data, nbrs);
+  }
+}
+
+int main(int argc, char** argv) {
+  std::mt19937 gen(20200916);
+
+  test_gather<double, uint64_t, uint64_t>(gen);
+  test_gather<float, uint64_t, uint64_t>(gen);
+  test_gather<int64_t, uint64_t, uint64_t>(gen);
+  test_gather<int32_t, uint64_t, uint64_t>(gen);
+  test_gather<uint32_t, uint64_t, uint64_t>(gen);
+  // not eligible for the SIMD gathers
+  test_gather<double, uint32_t, uint32_t>(gen);
+  test_gather<int16_t, uint64_t, uint64_t>(gen);
+
+  LOG(INFO) << "Passed edge data gather tests...";
+  return 0;
+}
@@ -0,0 +1,154 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/fragment/arrow_fragment_projection.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+
+using ProjectionType = ArrowFragmentProjection<property_graph_types::OID_TYPE,
+                                               property_graph_types::VID_TYPE>;
+
+void check_projection(std::shared_ptr<GraphType> graph,
+                      std::shared_ptr<ProjectionType> projection) {
+  LabelType v_label = projection->vertex_label();
+  LabelType e_label = projection->edge_label();
+  for (auto v : projection->InnerVertices()) {
+    int out_degree = 0;
+    auto projected_oe = projection->GetOutgoingAdjList(v);
+    auto iter = projected_oe.begin();
+    for (auto& e : graph->GetOutgoingAdjList(v, e_label)) {
+      if (graph->vertex_label(e.neighbor()) != v_label) {
+        continue;
+      }
+      CHECK(iter != projected_oe.end());
+      CHECK_EQ((*iter).neighbor().GetValue(), e.neighbor().GetValue());
+      CHECK_EQ((*iter).edge_id(), e.edge_id());
+      ++iter;
+      ++out_degree;
+    }
+    CHECK(iter == projected_oe.end());
+    CHECK_EQ(projection->GetLocalOutDegree(v), out_degree);
+
+    int in_degree = 0;
+    for (auto& e : graph->GetIncomingAdjList(v, e_label)) {
+      if (graph->vertex_label(e.neighbor()) == v_label) {
+        ++in_degree;
+      }
+    }
+    CHECK_EQ(projection->GetLocalInDegree(v), in_degree);
+    CHECK_EQ(projection->GetIncomingAdjList(v).Size(),
+             static_cast<size_t>(in_degree));
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./fragment_projection_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader =
+        std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                             property_graph_types::VID_TYPE>>(
+            client, comm_spec, efiles, vfiles, directed != 0);
+    vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+
+    std::shared_ptr<GraphType> graph =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    auto project = [&client, &graph]() {
+      return boost::leaf::try_handle_all(
+          [&client, &graph]() {
+            return ProjectFragment(client, graph, 0, -1, 0, -1);
+          },
+          [](const GSError& e) {
+            LOG(FATAL) << e.error_msg;
+            return std::shared_ptr<ProjectionType>(nullptr);
+          },
+          [](const boost::leaf::error_info& unmatched) {
+            LOG(FATAL) << "Unmatched error " << unmatched;
+            return std::shared_ptr<ProjectionType>(nullptr);
+          });
+    };
+    auto projection = project();
+    check_projection(graph, projection);
+    // the materialized projection is reused
+    CHECK_EQ(project()->id(), projection->id());
+    LOG(INFO) << "[frag-" << graph->fid() << "]: checked the projection";
+
+    VINEYARD_CHECK_OK(
+        client.DropName(ProjectionName(graph->id(), 0, -1, 0, -1)));
+    // the fragment is kept
+    VINEYARD_CHECK_OK(client.DelData(projection->id(), false, false));
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed fragment projection tests...";
+  return 0;
+}
@@ -0,0 +1,78 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <string>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "graph/fragment/graph_schema.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+void check_schema(PropertyGraphSchema const& schema) {
+  CHECK_EQ(schema.fnum(), 4);
+  CHECK_EQ(schema.GetVertexLabelId("person"), 0);
+  CHECK_EQ(schema.GetVertexLabelId("software"), 1);
+  CHECK_EQ(schema.GetVertexLabelId("knows"), -1);
+  CHECK_EQ(schema.GetEdgeLabelId("knows"), 0);
+  CHECK_EQ(schema.GetEdgeLabelId("person"), -1);
+  CHECK_EQ(schema.GetVertexPropertyId(0, "name"), 0);
+  CHECK_EQ(schema.GetVertexPropertyId(0, "age"), 1);
+  CHECK_EQ(schema.GetVertexPropertyId(0, "lang"), -1);
+  CHECK_EQ(schema.GetVertexPropertyId(1, "lang"), 1);
+  CHECK_EQ(schema.GetEdgePropertyId(0, "weight"), 0);
+  CHECK(schema.GetVertexPropertyType(0, 1)->Equals(arrow::int64()));
+}
+
+int main(int argc, char** argv) {
+  PropertyGraphSchema schema;
+  schema.set_fnum(4);
+  Entry* person = schema.CreateEntry("person", "VERTEX");
+  person->AddProperty("name", arrow::utf8());
+  person->AddProperty("age", arrow::int64());
+  Entry* software = schema.CreateEntry("software", "VERTEX");
+  software->AddProperty("name", arrow::utf8());
+  software->AddProperty("lang", arrow::utf8());
+  Entry* knows = schema.CreateEntry("knows", "EDGE");
+  knows->AddProperty("weight", arrow::float64());
+  check_schema(schema);
+
+  std::string json = schema.ToJSONString();
+  PropertyGraphSchema parsed;
+  parsed.FromJSONString(json);
+  check_schema(parsed);
+
+  // parsed for the first time, then from the cache
+  for (int round = 0; round < 2; ++round) {
+    PropertyGraphSchema cached;
+    cached.FromCachedJSONString(json);
+    check_schema(cached);
+    CHECK_EQ(cached.ToJSONString(), json);
+  }
+
+  // the lookups still work when the entries are changed in place
+  schema.GetMutableEntry("person", "VERTEX").props[1].name = "birthday";
+  CHECK_EQ(schema.GetVertexPropertyId(0, "age"), -1);
+  CHECK_EQ(schema.GetVertexPropertyId(0, "birthday"), 1);
+  schema.GetMutableEntry("person", "VERTEX").AddProperty("city",
+                                                         arrow::utf8());
+  CHECK_EQ(schema.GetVertexPropertyId(0, "city"), 2);
+
+  LOG(INFO) << "Passed graph schema tests...";
+  return 0;
+}
@@ -0,0 +1,125 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+
+void check_merged_edges(std::shared_ptr<GraphType> graph) {
+  CHECK(graph->merged_edges());
+  LabelType e_label_num = graph->edge_label_num();
+  LabelType v_label_num = graph->vertex_label_num();
+  for (LabelType v_label = 0; v_label != v_label_num; ++v_label) {
+    for (auto v : graph->InnerVertices(v_label)) {
+      auto oe = graph->GetOutgoingMergedAdjList(v);
+      auto iter = oe.begin();
+      for (LabelType e_label = 0; e_label != e_label_num; ++e_label) {
+        for (auto& e : graph->GetOutgoingAdjList(v, e_label)) {
+          CHECK(iter != oe.end());
+          CHECK_EQ((*iter).edge_label(), e_label);
+          CHECK_EQ((*iter).neighbor().GetValue(), e.neighbor().GetValue());
+          CHECK_EQ((*iter).edge_id(), e.edge_id());
+          ++iter;
+        }
+      }
+      CHECK(iter == oe.end());
+
+      size_t in_degree = 0;
+      for (LabelType e_label = 0; e_label != e_label_num; ++e_label) {
+        in_degree += graph->GetLocalInDegree(v, e_label);
+      }
+      CHECK_EQ(graph->GetIncomingMergedAdjList(v).Size(), in_degree);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./merged_adj_list_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader =
+        std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                             property_graph_types::VID_TYPE>>(
+            client, comm_spec, efiles, vfiles, directed != 0);
+    loader->set_merged_edges(true);
+    vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+
+    std::shared_ptr<GraphType> graph =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    check_merged_edges(graph);
+    LOG(INFO) << "[frag-" << graph->fid()
+              << "]: checked the merged adjacency lists";
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed merged adjacency list tests...";
+  return 0;
+}
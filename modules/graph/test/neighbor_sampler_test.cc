@@ -0,0 +1,97 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/utils/neighbor_sampler.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+void test_alias_table(std::vector<double> const& weights) {
+  size_t n = weights.size();
+  std::vector<float> prob(n);
+  std::vector<uint32_t> alias(n);
+  sampler::AliasTable::Build(weights.data(), n, prob.data(), alias.data());
+
+  double total = 0;
+  for (double weight : weights) {
+    total += std::max(weight, 0.0);
+  }
+  // the probability of every item that is encoded in the table
+  std::vector<double> expected(n, 0.0);
+  for (size_t k = 0; k < n; ++k) {
+    CHECK_LT(alias[k], n);
+    expected[k] += prob[k] / n;
+    expected[alias[k]] += (1.0 - prob[k]) / n;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    double weight = total > 0 ? std::max(weights[k], 0.0) / total : 1.0 / n;
+    CHECK_LT(std::abs(expected[k] - weight), 1e-6);
+  }
+
+  sampler::Random rng(n);
+  std::vector<size_t> counts(n, 0);
+  size_t draws = 100000;
+  for (size_t i = 0; i < draws; ++i) {
+    counts[sampler::AliasTable::Draw(prob.data(), alias.data(), n, rng)] += 1;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    double weight = total > 0 ? std::max(weights[k], 0.0) / total : 1.0 / n;
+    if (weight == 0) {
+      CHECK_EQ(counts[k], 0);
+    } else {
+      CHECK_LT(std::abs(static_cast<double>(counts[k]) / draws - weight), 0.01);
+    }
+  }
+}
+
+void test_choose() {
+  sampler::Random rng(20201014);
+  std::vector<size_t> out;
+  for (size_t n : {1, 2, 7, 64, 1000}) {
+    for (size_t k : {0, 1, 2, 5, 64}) {
+      if (k > n) {
+        continue;
+      }
+      sampler::choose(n, k, rng, out);
+      CHECK_EQ(out.size(), k);
+      std::set<size_t> distinct(out.begin(), out.end());
+      CHECK_EQ(distinct.size(), k);
+      for (size_t item : out) {
+        CHECK_LT(item, n);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  test_alias_table({1.0});
+  test_alias_table({1.0, 1.0, 1.0, 1.0});
+  test_alias_table({1.0, 2.0, 3.0, 4.0});
+  test_alias_table({0.0, 5.0, 0.0, 1.0, -1.0});
+  test_alias_table({0.0, 0.0, 0.0});
+  test_alias_table({100.0, 0.01, 0.01, 0.01, 3.0, 7.5});
+  test_choose();
+
+  LOG(INFO) << "Passed neighbor sampler tests...";
+  return 0;
+}
@@ -0,0 +1,172 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+
+void check_same_topology(std::shared_ptr<GraphType> expected,
+                         std::shared_ptr<GraphType> graph) {
+  LabelType e_label_num = graph->edge_label_num();
+  LabelType v_label_num = graph->vertex_label_num();
+  for (LabelType v_label = 0; v_label != v_label_num; ++v_label) {
+    for (auto v : graph->InnerVertices(v_label)) {
+      for (LabelType e_label = 0; e_label != e_label_num; ++e_label) {
+        CHECK_EQ(graph->GetLocalOutDegree(v, e_label),
+                 expected->GetLocalOutDegree(v, e_label));
+        CHECK_EQ(graph->GetLocalInDegree(v, e_label),
+                 expected->GetLocalInDegree(v, e_label));
+        auto oes = graph->GetOutgoingAdjList(v, e_label);
+        auto expected_oes = expected->GetOutgoingAdjList(v, e_label);
+        CHECK_EQ(oes.Size(), expected_oes.Size());
+        auto iter = expected_oes.begin();
+        for (auto& e : oes) {
+          CHECK_EQ(e.neighbor().GetValue(), (*iter).neighbor().GetValue());
+          CHECK_EQ(e.edge_id(), (*iter).edge_id());
+          ++iter;
+        }
+        auto ies = graph->GetIncomingAdjList(v, e_label);
+        auto expected_ies = expected->GetIncomingAdjList(v, e_label);
+        CHECK_EQ(ies.Size(), expected_ies.Size());
+        iter = expected_ies.begin();
+        for (auto& e : ies) {
+          CHECK_EQ(e.neighbor().GetValue(), (*iter).neighbor().GetValue());
+          CHECK_EQ(e.edge_id(), (*iter).edge_id());
+          ++iter;
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./numa_replica_test <ipc_socket> <e_label_num> "
+        "<efiles...> <v_label_num> <vfiles...> [directed]\n");
+    return 1;
+  }
+
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+
+  int edge_label_num = atoi(argv[index++]);
+  std::vector<std::string> efiles;
+  for (int i = 0; i < edge_label_num; ++i) {
+    efiles.push_back(argv[index++]);
+  }
+
+  int vertex_label_num = atoi(argv[index++]);
+  std::vector<std::string> vfiles;
+  for (int i = 0; i < vertex_label_num; ++i) {
+    vfiles.push_back(argv[index++]);
+  }
+
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    auto loader =
+        std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                             property_graph_types::VID_TYPE>>(
+            client, comm_spec, efiles, vfiles, directed != 0);
+    vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+
+    std::shared_ptr<GraphType> graph =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    CHECK_EQ(graph->numa_replicas(), 0);
+
+    // replicating on a single node is a no-op
+    auto single_id = boost::leaf::try_handle_all(
+        [&graph, &client]() { return graph->ReplicateTopology(client, 1); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+    CHECK_EQ(single_id, fragment_id);
+
+    // the blobs are placed without NUMA nodes if the arenas are disabled,
+    // but are replicated anyway
+    auto replicated_id = boost::leaf::try_handle_all(
+        [&graph, &client]() { return graph->ReplicateTopology(client, 2); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+    std::shared_ptr<GraphType> replicated =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(replicated_id));
+    CHECK_EQ(replicated->numa_replicas(), 2);
+    check_same_topology(graph, replicated);
+
+    // the replica is picked by the NUMA node of every thread
+    std::vector<std::thread> threads;
+    for (int k = 0; k < 4; ++k) {
+      threads.emplace_back(
+          [&graph, &replicated]() { check_same_topology(graph, replicated); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    LOG(INFO) << "[frag-" << graph->fid()
+              << "]: checked the replicated topology";
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed numa replica tests...";
+  return 0;
+}
@@ -0,0 +1,141 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "graph/utils/predicate_scan.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+bool selected(std::vector<uint64_t> const& bitmap, size_t i) {
+  return (bitmap[i / 64] >> (i % 64)) & 1;
+}
+
+template <typename T>
+void test_range(std::mt19937& gen) {
+  std::uniform_int_distribution<int> value_dist(0, 100);
+  for (size_t size : {0, 1, 63, 64, 65, 127, 128, 1000}) {
+    std::vector<T> data(size);
+    for (auto& value : data) {
+      value = static_cast<T>(value_dist(gen));
+    }
+    std::vector<uint64_t> bitmap(scan::bitmap_words(size));
+    T lower = static_cast<T>(20), upper = static_cast<T>(70);
+    scan::range(data.data(), size, lower, upper, bitmap.data());
+    size_t expected_count = 0;
+    for (size_t i = 0; i < size; ++i) {
+      bool expected = lower <= data[i] && data[i] <= upper;
+      CHECK_EQ(selected(bitmap, i), expected);
+      expected_count += expected;
+    }
+    CHECK_EQ(scan::count(bitmap.data(), size), expected_count);
+
+    std::vector<size_t> indices, ranged_indices;
+    scan::for_each_selected(bitmap.data(), size,
+                            [&](size_t i) { indices.push_back(i); });
+    scan::for_each_selected_range(bitmap.data(), size,
+                                  [&](size_t begin, size_t end) {
+                                    CHECK_LT(begin, end);
+                                    for (size_t i = begin; i < end; ++i) {
+                                      ranged_indices.push_back(i);
+                                    }
+                                  });
+    CHECK_EQ(indices.size(), expected_count);
+    CHECK(indices == ranged_indices);
+
+    if (size > 0) {
+      scan::equal(data.data(), size, data[0], bitmap.data());
+      for (size_t i = 0; i < size; ++i) {
+        CHECK_EQ(selected(bitmap, i), data[i] == data[0]);
+      }
+    }
+  }
+}
+
+void test_strings(std::mt19937& gen) {
+  std::vector<std::string> words = {"apple", "banana", "cherry", "durian"};
+  arrow::StringBuilder dictionary_builder;
+  for (auto const& word : words) {
+    CHECK_ARROW_ERROR(dictionary_builder.Append(word));
+  }
+  std::shared_ptr<arrow::Array> dictionary;
+  CHECK_ARROW_ERROR(dictionary_builder.Finish(&dictionary));
+
+  size_t size = 300;
+  std::uniform_int_distribution<int32_t> index_dist(0, words.size() - 1);
+  std::vector<int32_t> values(size);
+  arrow::Int32Builder indices_builder;
+  arrow::StringBuilder strings_builder;
+  for (auto& value : values) {
+    value = index_dist(gen);
+    CHECK_ARROW_ERROR(indices_builder.Append(value));
+    CHECK_ARROW_ERROR(strings_builder.Append(words[value]));
+  }
+  std::shared_ptr<arrow::Array> indices, strings;
+  CHECK_ARROW_ERROR(indices_builder.Finish(&indices));
+  CHECK_ARROW_ERROR(strings_builder.Finish(&strings));
+  auto dict_array = std::make_shared<arrow::DictionaryArray>(
+      arrow::dictionary(arrow::int32(), arrow::utf8()), indices, dictionary);
+
+  // scans from an offset, with both encodings
+  int64_t offset = 10;
+  size_t n = size - offset;
+  std::vector<uint64_t> bitmap(scan::bitmap_words(n));
+  std::vector<std::shared_ptr<arrow::Array>> arrays = {strings, dict_array};
+  for (auto const& array : arrays) {
+    CHECK(scan::string_equal(*array, offset, n, "banana", bitmap.data()));
+    for (size_t k = 0; k < n; ++k) {
+      CHECK_EQ(selected(bitmap, k), values[offset + k] == 1);
+    }
+    CHECK(scan::string_equal(*array, offset, n, "grape", bitmap.data()));
+    CHECK_EQ(scan::count(bitmap.data(), n), 0);
+    CHECK(scan::string_range(*array, offset, n, "b", "d", bitmap.data()));
+    for (size_t k = 0; k < n; ++k) {
+      bool expected = values[offset + k] == 1 || values[offset + k] == 2;
+      CHECK_EQ(selected(bitmap, k), expected);
+    }
+    CHECK(scan::string_range(*array, offset, n, "c", "", bitmap.data()));
+    for (size_t k = 0; k < n; ++k) {
+      CHECK_EQ(selected(bitmap, k), values[offset + k] >= 2);
+    }
+  }
+  CHECK(!scan::string_equal(*indices, 0, size, "apple", bitmap.data()));
+}
+
+int main(int argc, char** argv) {
+  std::mt19937 gen(20201014);
+
+  test_range<int32_t>(gen);
+  test_range<uint32_t>(gen);
+  test_range<int64_t>(gen);
+  test_range<uint64_t>(gen);
+  test_range<float>(gen);
+  test_range<double>(gen);
+  // not eligible for the SIMD scans
+  test_range<int16_t>(gen);
+  test_strings(gen);
+
+  LOG(INFO) << "Passed predicate scan tests...";
+  return 0;
+}
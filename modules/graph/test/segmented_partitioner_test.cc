@@ -0,0 +1,163 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "graph/utils/partitioner.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+template <typename OID_T>
+void CheckSegments(fid_t fnum, const std::vector<OID_T>& oid_list) {
+  SegmentedPartitioner<OID_T> partitioner;
+  partitioner.Init(fnum, oid_list);
+  size_t frag_vnum = (oid_list.size() + fnum - 1) / fnum;
+  for (size_t i = 0; i < oid_list.size(); ++i) {
+    CHECK_EQ(partitioner.GetPartitionId(oid_list[i]),
+             static_cast<fid_t>(i / frag_vnum));
+  }
+
+  SegmentedPartitioner<OID_T> copied;
+  copied = partitioner;
+  for (size_t i = 0; i < oid_list.size(); ++i) {
+    CHECK_EQ(copied.GetPartitionId(oid_list[i]),
+             static_cast<fid_t>(i / frag_vnum));
+  }
+}
+
+template <typename OID_T>
+void CheckWeightedSegments(fid_t fnum, const std::vector<OID_T>& oid_list,
+                           const std::vector<uint64_t>& weights) {
+  SegmentedPartitioner<OID_T> partitioner;
+  partitioner.Init(fnum, oid_list, weights);
+  uint64_t total = 0, max_weight = 0;
+  for (auto weight : weights) {
+    total += weight;
+    max_weight = std::max(max_weight, weight);
+  }
+  // the segments are consecutive, and the weights are balanced
+  std::vector<uint64_t> loads(fnum, 0);
+  fid_t last = 0;
+  for (size_t i = 0; i < oid_list.size(); ++i) {
+    fid_t fid = partitioner.GetPartitionId(oid_list[i]);
+    CHECK_LT(fid, fnum);
+    CHECK_GE(fid, last);
+    last = fid;
+    loads[fid] += weights[i];
+  }
+  for (auto load : loads) {
+    CHECK_LE(load, (total + fnum - 1) / fnum + max_weight);
+  }
+}
+
+// the batch partitioning over arrow arrays agrees with the scalar one
+template <typename PARTITIONER_T, typename OID_T>
+void CheckBatchPartition(const PARTITIONER_T& partitioner,
+                         const std::vector<OID_T>& oid_list) {
+  typename ConvertToArrowType<OID_T>::BuilderType builder;
+  CHECK(builder.AppendValues(oid_list).ok());
+  std::shared_ptr<typename ConvertToArrowType<OID_T>::ArrayType> array;
+  CHECK(builder.Finish(&array).ok());
+  std::vector<fid_t> fids(oid_list.size());
+  partitioner.GetPartitionIds(*array, fids.data());
+  for (size_t i = 0; i < oid_list.size(); ++i) {
+    CHECK_EQ(fids[i], partitioner.GetPartitionId(oid_list[i]));
+  }
+}
+
+int main(int argc, char** argv) {
+  std::mt19937 gen(42);
+
+  // sorted oids, with gaps
+  std::vector<int64_t> sorted;
+  for (int64_t i = 0; i < 10007; ++i) {
+    sorted.push_back(i * 3 - 5000);
+  }
+  for (fid_t fnum : {1, 2, 7, 64}) {
+    CheckSegments<int64_t>(fnum, sorted);
+  }
+
+  // disjoint segments in any order, and unordered inside the segments
+  std::vector<int64_t> segmented;
+  for (int64_t segment : {3, 0, 2, 1}) {
+    std::vector<int64_t> oids;
+    for (int64_t i = 0; i < 1000; ++i) {
+      oids.push_back(segment * 1000 + i);
+    }
+    std::shuffle(oids.begin(), oids.end(), gen);
+    segmented.insert(segmented.end(), oids.begin(), oids.end());
+  }
+  CheckSegments<int64_t>(4, segmented);
+
+  // overlapping segments falls back to the hash map
+  std::vector<int64_t> shuffled = sorted;
+  std::shuffle(shuffled.begin(), shuffled.end(), gen);
+  for (fid_t fnum : {1, 3, 16}) {
+    CheckSegments<int64_t>(fnum, shuffled);
+  }
+
+  std::vector<std::string> strings;
+  for (int i = 0; i < 1000; ++i) {
+    strings.push_back("v" + std::to_string(i));
+  }
+  CheckSegments<std::string>(5, strings);
+  std::shuffle(strings.begin(), strings.end(), gen);
+  CheckSegments<std::string>(5, strings);
+
+  // power-law degrees
+  std::vector<uint64_t> weights(sorted.size());
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  for (auto& weight : weights) {
+    weight = 1 + static_cast<uint64_t>(1.0 / std::pow(dist(gen) + 1e-4, 1.5));
+  }
+  for (fid_t fnum : {1, 2, 7, 64}) {
+    CheckWeightedSegments<int64_t>(fnum, sorted, weights);
+  }
+
+  for (fid_t fnum : {1, 4, 7}) {
+    HashPartitioner<int64_t> hash_partitioner;
+    hash_partitioner.Init(fnum);
+    CheckBatchPartition(hash_partitioner, shuffled);
+    HashPartitioner<std::string> string_hash_partitioner;
+    string_hash_partitioner.Init(fnum);
+    CheckBatchPartition(string_hash_partitioner, strings);
+    string_hash_partitioner.Init(fnum, true);
+    CheckBatchPartition(string_hash_partitioner, strings);
+
+    SegmentedPartitioner<int64_t> segmented_partitioner;
+    segmented_partitioner.Init(fnum, sorted);
+    CheckBatchPartition(segmented_partitioner, sorted);
+    segmented_partitioner.Init(fnum, shuffled);
+    CheckBatchPartition(segmented_partitioner, shuffled);
+    std::vector<std::string> sorted_strings = strings;
+    std::sort(sorted_strings.begin(), sorted_strings.end());
+    SegmentedPartitioner<std::string> string_segmented_partitioner;
+    string_segmented_partitioner.Init(fnum, sorted_strings);
+    CheckBatchPartition(string_segmented_partitioner, sorted_strings);
+  }
+
+  LOG(INFO) << "Passed segmented partitioner tests...";
+  return 0;
+}
@@ -0,0 +1,78 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <atomic>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/utils/thread_group.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  ThreadPool pool(4);
+
+  // every item is visited exactly once, for various chunk sizes, including
+  // the nested loops issued from the workers
+  for (size_t chunk : {0, 1, 7, 100000}) {
+    std::vector<std::atomic<int>> visited(10007);
+    pool.ParallelFor(
+        visited.size(),
+        [&](size_t, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            visited[i].fetch_add(1);
+          }
+          if (begin == 0) {
+            std::atomic<size_t> nested(0);
+            pool.ParallelFor(
+                100, [&](size_t, size_t b, size_t e) { nested += e - b; }, 4);
+            CHECK_EQ(nested.load(), 100);
+          }
+        },
+        6, chunk);
+    for (auto& count : visited) {
+      CHECK_EQ(count.load(), 1);
+    }
+  }
+
+  // the lanes are not run concurrently, thus can index per-thread states
+  {
+    int const concurrency = 8;
+    std::vector<std::atomic<int>> running(concurrency);
+    std::vector<size_t> sums(concurrency, 0);
+    ThreadPool::Default().ParallelFor(
+        100000,
+        [&](size_t lane, size_t begin, size_t end) {
+          CHECK_LT(lane, concurrency);
+          CHECK_EQ(running[lane].fetch_add(1), 0);
+          for (size_t i = begin; i < end; ++i) {
+            sums[lane] += i;
+          }
+          running[lane].fetch_sub(1);
+        },
+        concurrency, 16);
+    size_t total = 0;
+    for (auto sum : sums) {
+      total += sum;
+    }
+    CHECK_EQ(total, static_cast<size_t>(100000) * 99999 / 2);
+  }
+
+  LOG(INFO) << "Passed thread pool tests...";
+  return 0;
+}
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include <stdio.h>
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 #include <string>
@@ -151,7 +152,78 @@ int main(int argc, char** argv) {
     }
   }
 
+  for (vineyard::fid_t i = 0; i < fnum; ++i) {
+    for (int j = 0; j < vertex_label_num; ++j) {
+      std::vector<int64_t> oids = vm_ptr->GetOids(i, j);
+      std::vector<uint64_t> gids;
+      CHECK(vm_ptr->GetGids(i, j, oids, gids));
+      CHECK_EQ(gids.size(), oids.size());
+      for (size_t k = 0; k < oids.size(); ++k) {
+        CHECK_EQ(gids[k], id_parser.GenerateId(i, j, k));
+        // probes all fragments, pruned by the bloom filters
+        uint64_t gid;
+        CHECK(vm_ptr->GetGid(j, oids[k], gid));
+        CHECK_EQ(gid, gids[k]);
+      }
+      std::vector<uint64_t> label_gids;
+      CHECK(vm_ptr->GetGids(j, oids, label_gids));
+      CHECK(label_gids == gids);
+
+      auto oid_array = vm_ptr->GetOidArray(i, j);
+      CHECK_EQ(static_cast<size_t>(oid_array->length()), oids.size());
+      CHECK(std::equal(oids.begin(), oids.end(), oid_array->raw_values()));
+      std::vector<int64_t> bulk_oids(gids.size());
+      CHECK(vm_ptr->GetOids(gids.data(), gids.size(), bulk_oids.data()));
+      CHECK(bulk_oids == oids);
+    }
+  }
+
   LOG(INFO) << "Passed arrow vertex map test...";
 
+  {
+    // the fragment of an oid is computed by the sealed partitioner
+    HashPartitioner<int64_t> partitioner;
+    partitioner.Init(fnum);
+    std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>> oid_lists(
+        1, std::vector<std::shared_ptr<arrow::Int64Array>>(fnum));
+    for (vineyard::fid_t i = 0; i < fnum; ++i) {
+      arrow::Int64Builder builder;
+      for (int64_t oid = i; oid < 1000; oid += fnum) {
+        CHECK_ARROW_ERROR(builder.Append(oid));
+      }
+      CHECK_ARROW_ERROR(builder.Finish(&oid_lists[0][i]));
+    }
+    BasicArrowVertexMapBuilder<int64_t, uint64_t> vm_builder(client, fnum, 1,
+                                                             oid_lists);
+    vm_builder.set_partitioner(partitioner);
+    auto partitioned_vm =
+        std::dynamic_pointer_cast<ArrowVertexMap<int64_t, uint64_t>>(
+            client.GetObject(vm_builder.Seal(client)->id()));
+
+    std::vector<int64_t> oids;
+    for (int64_t oid = 999; oid >= 0; --oid) {
+      oids.push_back(oid);
+    }
+    vineyard::IdParser<uint64_t> partitioned_id_parser;
+    partitioned_id_parser.Init(fnum, 1);
+    std::vector<uint64_t> gids;
+    CHECK(partitioned_vm->GetGids(0, oids, gids));
+    for (size_t k = 0; k < oids.size(); ++k) {
+      uint64_t gid;
+      CHECK(partitioned_vm->GetGid(0, oids[k], gid));
+      CHECK_EQ(gid, gids[k]);
+      CHECK_EQ(partitioned_id_parser.GetFid(gid),
+               partitioner.GetPartitionId(oids[k]));
+      int64_t oid;
+      CHECK(partitioned_vm->GetOid(gid, oid));
+      CHECK_EQ(oid, oids[k]);
+    }
+    uint64_t gid;
+    CHECK(!partitioned_vm->GetGid(0, 1000, gid));
+    VINEYARD_CHECK_OK(client.DelData(partitioned_vm->id()));
+  }
+
+  LOG(INFO) << "Passed arrow vertex map partitioner test...";
+
   return 0;
 }
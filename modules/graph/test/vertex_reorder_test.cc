@@ -0,0 +1,96 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/utils/vertex_reorder.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+void check_permutation(std::vector<int64_t> const& order, size_t const n) {
+  CHECK_EQ(order.size(), n);
+  std::vector<int64_t> sorted(order);
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < n; ++i) {
+    CHECK_EQ(sorted[i], static_cast<int64_t>(i));
+  }
+  auto inverse = InverseOrder(order);
+  for (size_t i = 0; i < n; ++i) {
+    CHECK_EQ(inverse[order[i]], static_cast<int64_t>(i));
+  }
+}
+
+int64_t bandwidth(std::vector<std::pair<int64_t, int64_t>> const& edges,
+                  std::vector<int64_t> const& new_offsets) {
+  int64_t width = 0;
+  for (auto const& edge : edges) {
+    width = std::max(width, std::abs(new_offsets[edge.first] -
+                                     new_offsets[edge.second]));
+  }
+  return width;
+}
+
+int main(int argc, char** argv) {
+  VertexReorderStrategy strategy;
+  CHECK(ParseVertexReorderStrategy("rcm", strategy));
+  CHECK(strategy == VertexReorderStrategy::kRCM);
+  CHECK(!ParseVertexReorderStrategy("gorder", strategy));
+
+  // degree ordering is stable, and puts the hub vertices first
+  {
+    std::vector<int64_t> degrees{1, 5, 0, 5, 3};
+    auto order = DegreeOrder(degrees);
+    check_permutation(order, degrees.size());
+    CHECK_EQ(order[0], 1);
+    CHECK_EQ(order[1], 3);
+    CHECK_EQ(order[2], 4);
+    CHECK_EQ(order[4], 2);
+  }
+
+  // a path that is labeled in a scattered order, together with an isolated
+  // vertex: RCM recovers the bandwidth of 1
+  {
+    size_t const n = 101;
+    std::vector<int64_t> labels(n - 1);
+    for (size_t i = 0; i < n - 1; ++i) {
+      labels[i] = static_cast<int64_t>((i * 37) % (n - 1));
+    }
+    std::vector<std::pair<int64_t, int64_t>> edges;
+    for (size_t i = 0; i + 2 < n; ++i) {
+      edges.emplace_back(labels[i], labels[i + 1]);
+    }
+    std::vector<int64_t> offsets, neighbors, degrees(n);
+    BuildSymmetricCSR(n, edges, offsets, neighbors);
+    for (size_t v = 0; v < n; ++v) {
+      degrees[v] = offsets[v + 1] - offsets[v];
+    }
+    CHECK_EQ(neighbors.size(), edges.size() * 2);
+    CHECK_GT(bandwidth(edges, InverseOrder(DegreeOrder(degrees))), 1);
+
+    auto order = ReverseCuthillMcKeeOrder(offsets, neighbors, degrees);
+    check_permutation(order, n);
+    CHECK_EQ(bandwidth(edges, InverseOrder(order)), 1);
+  }
+
+  LOG(INFO) << "Passed vertex reorder tests...";
+  return 0;
+}
@@ -0,0 +1,391 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/boost.h"
+#include "common/util/flags.h"
+#include "common/util/functions.h"
+#include "common/util/logging.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+DEFINE_string(ipc_socket, "/var/run/vineyard.sock",
+              "The IPC socket of the vineyard server");
+DEFINE_int32(rmat_scale, 16,
+             "The synthetic RMAT graph has 2^scale vertices, when no input "
+             "files are given");
+DEFINE_int32(rmat_edge_factor, 16,
+             "The synthetic RMAT graph has edge_factor * 2^scale edges");
+DEFINE_uint64(rmat_seed, 42, "The seed of the synthetic RMAT graph");
+DEFINE_string(work_dir, "/tmp",
+              "The directory that the synthetic graph is generated into");
+DEFINE_bool(directed, true, "Whether the graph is directed");
+DEFINE_uint64(lookups, 1 << 20,
+              "The number of vertex map lookups on every worker");
+DEFINE_int32(rounds, 3, "The number of rounds of every traversal benchmark");
+DEFINE_string(output, "",
+              "The file that the results (in JSON) are written to, the "
+              "results are written to stdout if not specified");
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+using PropType = typename GraphType::prop_id_t;
+using VertexType = typename GraphType::vertex_t;
+
+namespace {
+
+// the same graph is generated by all workers, and the files are moved into
+// place atomically, as the workers on a host (or on a shared file system)
+// may generate it at the same time.
+void GenerateRMAT(const std::string& vfile, const std::string& efile,
+                  int scale, int edge_factor, uint64_t seed) {
+  const double a = 0.57, b = 0.19, c = 0.19;
+  const int64_t vnum = static_cast<int64_t>(1) << scale;
+  const int64_t edge_num = vnum * edge_factor;
+  const uint64_t mask = static_cast<uint64_t>(vnum) - 1;
+  // the bijection breaks the locality of the high degree vertices
+  auto scramble = [mask](uint64_t id) {
+    return static_cast<int64_t>((id * 0x9E3779B97F4A7C15ULL) & mask);
+  };
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+  std::string suffix = ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream fout(vfile + suffix);
+    fout << "id,rank\n";
+    for (int64_t i = 0; i < vnum; ++i) {
+      fout << i << ',' << dist(gen) << '\n';
+    }
+  }
+  {
+    std::ofstream fout(efile + suffix);
+    fout << "src,dst,weight\n";
+    for (int64_t i = 0; i < edge_num; ++i) {
+      uint64_t src = 0, dst = 0;
+      for (int level = 0; level < scale; ++level) {
+        double r = dist(gen);
+        src <<= 1;
+        dst <<= 1;
+        if (r < a) {
+        } else if (r < a + b) {
+          dst |= 1;
+        } else if (r < a + b + c) {
+          src |= 1;
+        } else {
+          src |= 1;
+          dst |= 1;
+        }
+      }
+      fout << scramble(src) << ',' << scramble(dst) << ',' << dist(gen)
+           << '\n';
+    }
+  }
+  CHECK_EQ(std::rename((vfile + suffix).c_str(), vfile.c_str()), 0);
+  CHECK_EQ(std::rename((efile + suffix).c_str(), efile.c_str()), 0);
+}
+
+bool FileExists(const std::string& path) {
+  return access(path.c_str(), F_OK) == 0;
+}
+
+PropType FindDoubleProperty(std::shared_ptr<arrow::Schema> schema) {
+  for (int i = 0; i < schema->num_fields(); ++i) {
+    if (schema->field(i)->type()->Equals(arrow::float64())) {
+      return static_cast<PropType>(i);
+    }
+  }
+  return -1;
+}
+
+struct Measure {
+  uint64_t count = 0;
+  double seconds = 0;
+  double checksum = 0;
+};
+
+// runs the scan for `rounds` rounds, and keeps the fastest one
+template <typename FUNC_T>
+Measure Repeat(int rounds, const FUNC_T& func) {
+  Measure best;
+  for (int round = 0; round < std::max(rounds, 1); ++round) {
+    Measure measure;
+    double t = -GetCurrentTime();
+    func(measure);
+    t += GetCurrentTime();
+    measure.seconds = t;
+    if (round == 0 || measure.seconds < best.seconds) {
+      best = measure;
+    }
+  }
+  return best;
+}
+
+Measure ScanAdjList(const std::shared_ptr<GraphType>& graph, int rounds) {
+  return Repeat(rounds, [&](Measure& measure) {
+    uint64_t sum = 0;
+    for (LabelType v_label = 0; v_label < graph->vertex_label_num();
+         ++v_label) {
+      for (LabelType e_label = 0; e_label < graph->edge_label_num();
+           ++e_label) {
+        for (auto v : graph->InnerVertices(v_label)) {
+          auto oe = graph->GetOutgoingAdjList(v, e_label);
+          for (auto& e : oe) {
+            sum += e.neighbor().GetValue();
+          }
+          measure.count += oe.Size();
+        }
+      }
+    }
+    measure.checksum = static_cast<double>(sum);
+  });
+}
+
+Measure ScanEdgeProperty(const std::shared_ptr<GraphType>& graph,
+                         int rounds) {
+  return Repeat(rounds, [&](Measure& measure) {
+    for (LabelType e_label = 0; e_label < graph->edge_label_num(); ++e_label) {
+      PropType prop =
+          FindDoubleProperty(graph->edge_data_table(e_label)->schema());
+      if (prop == -1) {
+        continue;
+      }
+      for (LabelType v_label = 0; v_label < graph->vertex_label_num();
+           ++v_label) {
+        for (auto v : graph->InnerVertices(v_label)) {
+          for (auto& e : graph->GetOutgoingAdjList(v, e_label)) {
+            measure.checksum += e.get_data<double>(prop);
+            measure.count += 1;
+          }
+        }
+      }
+    }
+  });
+}
+
+Measure ScanVertexProperty(const std::shared_ptr<GraphType>& graph,
+                           int rounds) {
+  return Repeat(rounds, [&](Measure& measure) {
+    for (LabelType v_label = 0; v_label < graph->vertex_label_num();
+         ++v_label) {
+      PropType prop =
+          FindDoubleProperty(graph->vertex_data_table(v_label)->schema());
+      if (prop == -1) {
+        continue;
+      }
+      for (auto v : graph->InnerVertices(v_label)) {
+        measure.checksum += graph->GetData<double>(v, prop);
+        measure.count += 1;
+      }
+    }
+  });
+}
+
+// the oids of both inner and outer vertices are looked up, i.e., oid -> gid
+// (by the vertex map) -> oid
+Measure LookupVertexMap(const std::shared_ptr<GraphType>& graph,
+                        uint64_t lookups, int rounds, uint64_t seed) {
+  std::vector<std::pair<LabelType, property_graph_types::OID_TYPE>> oids;
+  for (LabelType v_label = 0; v_label < graph->vertex_label_num(); ++v_label) {
+    for (auto v : graph->InnerVertices(v_label)) {
+      oids.emplace_back(v_label, graph->GetId(v));
+    }
+    for (auto v : graph->OuterVertices(v_label)) {
+      oids.emplace_back(v_label, graph->GetId(v));
+    }
+  }
+  if (oids.empty()) {
+    return Measure();
+  }
+  std::mt19937_64 gen(seed);
+  std::uniform_int_distribution<size_t> dist(0, oids.size() - 1);
+  std::vector<size_t> samples(lookups);
+  for (auto& sample : samples) {
+    sample = dist(gen);
+  }
+  return Repeat(rounds, [&](Measure& measure) {
+    VertexType v;
+    int64_t sum = 0;
+    for (auto sample : samples) {
+      auto const& oid = oids[sample];
+      CHECK(graph->GetVertex(oid.first, oid.second, v));
+      sum += graph->GetId(v);
+    }
+    measure.count = samples.size();
+    measure.checksum = static_cast<double>(sum);
+  });
+}
+
+// the counts are summed, and the time (and memory) is the maximum over all
+// workers
+ptree Report(const grape::CommSpec& comm_spec, const Measure& measure) {
+  uint64_t count = measure.count;
+  double seconds = measure.seconds, checksum = measure.checksum;
+  MPI_Allreduce(MPI_IN_PLACE, &count, 1, MPI_UINT64_T, MPI_SUM,
+                comm_spec.comm());
+  MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX,
+                comm_spec.comm());
+  MPI_Allreduce(MPI_IN_PLACE, &checksum, 1, MPI_DOUBLE, MPI_SUM,
+                comm_spec.comm());
+  ptree result;
+  result.put("count", count);
+  result.put("seconds", seconds);
+  result.put("per_second", seconds > 0 ? count / seconds : 0);
+  result.put("checksum", checksum);
+  return result;
+}
+
+ptree ReportPhases(const grape::CommSpec& comm_spec,
+                   const std::vector<LoaderType::PhaseStat>& phases) {
+  ptree result;
+  for (auto const& phase : phases) {
+    double seconds = phase.seconds;
+    uint64_t peak_rss = phase.peak_rss;
+    MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX,
+                  comm_spec.comm());
+    MPI_Allreduce(MPI_IN_PLACE, &peak_rss, 1, MPI_UINT64_T, MPI_MAX,
+                  comm_spec.comm());
+    ptree item;
+    item.put("name", phase.name);
+    item.put("seconds", seconds);
+    item.put("peak_rss", peak_rss);
+    result.push_back(std::make_pair("", item));
+  }
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  flags::SetUsageMessage(
+      "Usage: vineyard_graph_bench [--ipc_socket <socket>] [--rmat_scale "
+      "<scale>] [--output <file>] [<e_label_num> <efiles...> <v_label_num> "
+      "<vfiles...>]");
+  flags::ParseCommandLineFlags(&argc, &argv, true);
+  logging::InitGoogleLogging("vineyard_graph_bench");
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    vineyard::Client client;
+    VINEYARD_CHECK_OK(client.Connect(FLAGS_ipc_socket));
+
+    ptree root, input;
+    std::vector<std::string> efiles, vfiles;
+    if (argc > 1) {
+      // the input files, e.g., the output of the LDBC datagen
+      int index = 1;
+      int edge_label_num = atoi(argv[index++]);
+      for (int i = 0; i < edge_label_num && index < argc; ++i) {
+        efiles.push_back(argv[index++]);
+      }
+      int vertex_label_num = index < argc ? atoi(argv[index++]) : 0;
+      for (int i = 0; i < vertex_label_num && index < argc; ++i) {
+        vfiles.push_back(argv[index++]);
+      }
+      input.put("kind", "files");
+    } else {
+      std::string prefix = FLAGS_work_dir + "/rmat_" +
+                           std::to_string(FLAGS_rmat_scale) + "_" +
+                           std::to_string(FLAGS_rmat_edge_factor) + "_" +
+                           std::to_string(FLAGS_rmat_seed);
+      std::string vfile = prefix + "_v.csv", efile = prefix + "_e.csv";
+      if (comm_spec.local_id() == 0 &&
+          !(FileExists(vfile) && FileExists(efile))) {
+        LOG(INFO) << "Generating the RMAT graph to " << prefix << " ...";
+        GenerateRMAT(vfile, efile, FLAGS_rmat_scale, FLAGS_rmat_edge_factor,
+                     FLAGS_rmat_seed);
+      }
+      MPI_Barrier(comm_spec.comm());
+      vfiles.push_back(vfile + "#label=v");
+      efiles.push_back(efile + "#label=e&src_label=v&dst_label=v");
+      input.put("kind", "rmat");
+      input.put("scale", FLAGS_rmat_scale);
+      input.put("edge_factor", FLAGS_rmat_edge_factor);
+      input.put("seed", FLAGS_rmat_seed);
+    }
+    input.put("directed", FLAGS_directed);
+    root.put("workers", comm_spec.worker_num());
+    root.add_child("input", input);
+
+    MPI_Barrier(comm_spec.comm());
+    double t = -GetCurrentTime();
+    auto loader = std::make_unique<LoaderType>(client, comm_spec, efiles,
+                                               vfiles, FLAGS_directed);
+    vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return 0;
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return 0;
+        });
+    MPI_Barrier(comm_spec.comm());
+    t += GetCurrentTime();
+
+    ptree load;
+    load.put("seconds", t);
+    load.add_child("phases", ReportPhases(comm_spec, loader->phase_stats()));
+    root.add_child("load", load);
+    loader.reset();
+
+    std::shared_ptr<GraphType> graph =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    root.add_child("adj_list_scan",
+                   Report(comm_spec, ScanAdjList(graph, FLAGS_rounds)));
+    root.add_child("edge_property_scan",
+                   Report(comm_spec, ScanEdgeProperty(graph, FLAGS_rounds)));
+    root.add_child("vertex_property_scan",
+                   Report(comm_spec, ScanVertexProperty(graph, FLAGS_rounds)));
+    root.add_child(
+        "vertex_map_lookup",
+        Report(comm_spec,
+               LookupVertexMap(graph, FLAGS_lookups, FLAGS_rounds,
+                               FLAGS_rmat_seed + comm_spec.worker_id())));
+
+    if (comm_spec.worker_id() == 0) {
+      if (FLAGS_output.empty()) {
+        bpt::write_json(std::cout, root, true);
+      } else {
+        std::ofstream fout(FLAGS_output);
+        bpt::write_json(fout, root, true);
+      }
+    }
+    MPI_Barrier(comm_spec.comm());
+  }
+  grape::FinalizeMPIComm();
+  return 0;
+}
@@ -0,0 +1,214 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_CONTEXT_EXPORT_H_
+#define MODULES_GRAPH_UTILS_CONTEXT_EXPORT_H_
+
+#include <mpi.h>
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/leaf/all.hpp>
+
+#include "grape/worker/comm_spec.h"
+
+#include "basic/ds/dataframe.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+#include "graph/utils/error.h"
+#include "graph/utils/thread_group.h"
+#include "graph/utils/transform_utils.h"
+
+namespace vineyard {
+
+namespace detail {
+
+/**
+ * A 1-D tensor of `get(v)` of every vertex in the range, which is written in
+ * the blob of the tensor in place, in parallel.
+ */
+template <typename T, typename VERTEX_T, typename FUNC_T>
+std::shared_ptr<ITensorBuilder> vertices_to_tensor(
+    Client& client, const std::vector<VERTEX_T>& range, const FUNC_T& get,
+    size_t partition_index) {
+  static_assert(std::is_arithmetic<T>::value,
+                "Only numeric results can be exported as tensors");
+  auto builder = std::make_shared<TensorBuilder<T>>(
+      client, std::vector<int64_t>{static_cast<int64_t>(range.size())},
+      std::vector<int64_t>{static_cast<int64_t>(partition_index)});
+  T* data = builder->data();
+  ThreadPool::Default().ParallelFor(
+      range.size(),
+      [&](size_t, size_t x, size_t y) {
+        for (size_t i = x; i < y; ++i) {
+          data[i] = get(range[i]);
+        }
+      },
+      transform_concurrency());
+  return builder;
+}
+
+}  // namespace detail
+
+/**
+ * @brief VertexColumnsExporter writes the per-vertex results of a fragment
+ * (e.g., the contexts of apps) into vineyard as columns, instead of
+ * serializing them to `grape::InArchive`s that are gathered to the
+ * coordinator.
+ *
+ * Every column is a 1-D `Tensor` whose blob is written in place in
+ * parallel, and the columns of a fragment are sealed as a `DataFrame`, which
+ * can be stitched with the ones of other fragments as a `GlobalDataFrame` by
+ * `SealGlobal()`. Consumers (e.g., pandas) hence read the results zero-copy.
+ *
+ * Only numeric columns can be exported, as the columns of dataframes are
+ * tensors.
+ */
+template <typename FRAG_T>
+class VertexColumnsExporter {
+  using vertex_t = typename FRAG_T::vertex_t;
+  using oid_t = typename FRAG_T::oid_t;
+  using label_id_t = typename FRAG_T::label_id_t;
+  using prop_id_t = typename FRAG_T::prop_id_t;
+
+ public:
+  VertexColumnsExporter(Client& client, const FRAG_T* frag,
+                        const std::vector<vertex_t>& range)
+      : client_(client), frag_(frag), range_(range), builder_(client) {
+    builder_.set_partition_index(frag->fid(), 0);
+  }
+
+  /**
+   * @brief Export `get(v)` of the vertices as the column.
+   */
+  template <typename T, typename FUNC_T>
+  void AddColumn(const std::string& name, const FUNC_T& get) {
+    builder_.AddColumn(name, detail::vertices_to_tensor<T>(
+                                 client_, range_, get, frag_->fid()));
+  }
+
+  /**
+   * @brief Export the oids of the vertices as the column.
+   */
+  boost::leaf::result<void> AddVertexId(const std::string& name) {
+    if (!std::is_arithmetic<oid_t>::value) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "Only numeric oids can be exported as columns");
+    }
+    addVertexId(name, std::is_arithmetic<oid_t>{});
+    return {};
+  }
+
+  /**
+   * @brief Export the property of the vertices as the column.
+   */
+  boost::leaf::result<void> AddVertexProperty(const std::string& name,
+                                              label_id_t label_id,
+                                              prop_id_t prop_id) {
+    auto type = frag_->vertex_property_type(label_id, prop_id);
+    if (type->Equals(arrow::int32())) {
+      addVertexProperty<int32_t>(name, prop_id);
+    } else if (type->Equals(arrow::int64())) {
+      addVertexProperty<int64_t>(name, prop_id);
+    } else if (type->Equals(arrow::uint32())) {
+      addVertexProperty<uint32_t>(name, prop_id);
+    } else if (type->Equals(arrow::uint64())) {
+      addVertexProperty<uint64_t>(name, prop_id);
+    } else if (type->Equals(arrow::float32())) {
+      addVertexProperty<float>(name, prop_id);
+    } else if (type->Equals(arrow::float64())) {
+      addVertexProperty<double>(name, prop_id);
+    } else {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "property type not support - " + type->ToString());
+    }
+    return {};
+  }
+
+  /**
+   * @brief Seal the columns as the (persisted) dataframe of this fragment.
+   */
+  boost::leaf::result<ObjectID> Seal() {
+    auto dataframe = builder_.Seal(client_);
+    if (dataframe == nullptr) {
+      RETURN_GS_ERROR(ErrorCode::kVineyardError,
+                      "Failed to seal the dataframe of the results");
+    }
+    VY_OK_OR_RAISE(client_.Persist(dataframe->id()));
+    return dataframe->id();
+  }
+
+  /**
+   * @brief Seal the columns as the dataframe of this fragment, and stitch
+   * the dataframes of all workers as a global dataframe, collectively by
+   * all workers of the `comm_spec`.
+   *
+   * @return The global dataframe, which is known to all workers.
+   */
+  boost::leaf::result<ObjectID> SealGlobal(const grape::CommSpec& comm_spec) {
+    BOOST_LEAF_AUTO(partition_id, Seal());
+    InstanceID instance_id = client_.instance_id();
+    int worker_num = comm_spec.worker_num();
+    std::vector<ObjectID> partition_ids(worker_num);
+    std::vector<InstanceID> instance_ids(worker_num);
+    MPI_Allgather(&partition_id, 1, MPI_UINT64_T, partition_ids.data(), 1,
+                  MPI_UINT64_T, comm_spec.comm());
+    MPI_Allgather(&instance_id, 1, MPI_UINT64_T, instance_ids.data(), 1,
+                  MPI_UINT64_T, comm_spec.comm());
+    ObjectID result_id = InvalidObjectID();
+    if (comm_spec.worker_id() == 0) {
+      GlobalDataFrameBuilder global_builder(client_);
+      global_builder.set_partition_shape(worker_num, 1);
+      for (int index = 0; index < worker_num; ++index) {
+        global_builder.AddPartition(instance_ids[index], partition_ids[index]);
+      }
+      auto global = global_builder.Seal(client_);
+      VY_OK_OR_RAISE(client_.Persist(global->id()));
+      result_id = global->id();
+    }
+    MPI_Bcast(&result_id, 1, MPI_UINT64_T, 0, comm_spec.comm());
+    return result_id;
+  }
+
+ private:
+  void addVertexId(const std::string& name, std::true_type) {
+    const FRAG_T* frag = frag_;
+    AddColumn<oid_t>(name,
+                     [frag](const vertex_t& v) { return frag->GetId(v); });
+  }
+
+  void addVertexId(const std::string&, std::false_type) {}
+
+  template <typename T>
+  void addVertexProperty(const std::string& name, prop_id_t prop_id) {
+    const FRAG_T* frag = frag_;
+    AddColumn<T>(name, [frag, prop_id](const vertex_t& v) {
+      return frag->template GetData<T>(v, prop_id);
+    });
+  }
+
+  Client& client_;
+  const FRAG_T* frag_;
+  const std::vector<vertex_t>& range_;
+  DataFrameBuilder builder_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_CONTEXT_EXPORT_H_
@@ -0,0 +1,327 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_DATAFRAME_SHUFFLER_H_
+#define MODULES_GRAPH_UTILS_DATAFRAME_SHUFFLER_H_
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/leaf/all.hpp>
+
+#include "arrow/api.h"
+
+#include "grape/worker/comm_spec.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/dataframe.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+#include "graph/utils/error.h"
+#include "graph/utils/table_shuffler_beta.h"
+
+namespace vineyard {
+
+namespace beta {
+
+namespace detail {
+
+/**
+ * The schema of the dataframe from its metadata, thus the workers that have
+ * no local partitions know it as well.
+ */
+inline boost::leaf::result<std::shared_ptr<arrow::Schema>> dataframe_schema(
+    ObjectMeta const& meta) {
+  std::vector<std::string> columns;
+  meta.GetKeyValue("columns_", columns);
+  size_t size = meta.GetKeyValue<size_t>("__values_-size");
+  std::map<std::string, AnyType> types;
+  for (size_t index = 0; index < size; ++index) {
+    auto key = meta.GetKeyValue("__values_-key-" + std::to_string(index));
+    auto value = meta.GetMemberMeta("__values_-value-" + std::to_string(index));
+    types[key] = value.GetKeyValue<AnyType>("value_type_");
+  }
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (auto const& column : columns) {
+    auto type = FromAnyType(types[column]);
+    if (type->id() == arrow::Type::NA) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "Only numeric columns can be repartitioned: " + column);
+    }
+    fields.emplace_back(arrow::field(column, type));
+  }
+  return arrow::schema(fields);
+}
+
+/**
+ * The columns of the dataframe as a record batch, the buffers point into the
+ * blobs of the dataframe.
+ */
+inline std::shared_ptr<arrow::RecordBatch> dataframe_to_batch(
+    std::shared_ptr<arrow::Schema> const& schema, DataFrame const& dataframe) {
+  int64_t num_rows = dataframe.shape().first;
+  std::vector<std::shared_ptr<arrow::Array>> columns;
+  for (auto const& field : schema->fields()) {
+    auto column = dataframe.Column(field->name());
+    columns.emplace_back(arrow::MakeArray(arrow::ArrayData::Make(
+        field->type(), num_rows, {nullptr, column->buffer()})));
+  }
+  return arrow::RecordBatch::Make(schema, num_rows, columns);
+}
+
+inline uint64_t mix_hash(uint64_t value) {
+  // fibonacci hashing, the integer keys are often sequential
+  return (value * 0x9E3779B97F4A7C15ULL) >> 17;
+}
+
+template <typename T>
+inline void assign_typed_rows(std::shared_ptr<arrow::Array> const& column,
+                              std::vector<double> const& bounds,
+                              int const worker_num,
+                              std::vector<std::vector<int64_t>>& offsets) {
+  using array_type = typename ConvertToArrowType<T>::ArrayType;
+  auto array = std::static_pointer_cast<array_type>(column);
+  const T* values = array->raw_values();
+  for (int64_t row = 0; row < array->length(); ++row) {
+    size_t dst = 0;
+    if (bounds.empty()) {
+      uint64_t bits = 0;
+      std::memcpy(&bits, &values[row], sizeof(T));
+      dst = mix_hash(bits) % worker_num;
+    } else {
+      dst = std::upper_bound(bounds.begin(), bounds.end(),
+                             static_cast<double>(values[row])) -
+            bounds.begin();
+    }
+    offsets[dst].push_back(row);
+  }
+}
+
+inline boost::leaf::result<void> assign_rows(
+    std::shared_ptr<arrow::Array> const& column,
+    std::vector<double> const& bounds, int const worker_num,
+    std::vector<std::vector<int64_t>>& offsets) {
+  offsets.resize(worker_num);
+  switch (column->type_id()) {
+  case arrow::Type::INT32:
+    assign_typed_rows<int32_t>(column, bounds, worker_num, offsets);
+    break;
+  case arrow::Type::UINT32:
+    assign_typed_rows<uint32_t>(column, bounds, worker_num, offsets);
+    break;
+  case arrow::Type::INT64:
+    assign_typed_rows<int64_t>(column, bounds, worker_num, offsets);
+    break;
+  case arrow::Type::UINT64:
+    assign_typed_rows<uint64_t>(column, bounds, worker_num, offsets);
+    break;
+  case arrow::Type::FLOAT:
+    assign_typed_rows<float>(column, bounds, worker_num, offsets);
+    break;
+  case arrow::Type::DOUBLE:
+    assign_typed_rows<double>(column, bounds, worker_num, offsets);
+    break;
+  default:
+    RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                    "Unsupported type of the partition key: " +
+                        column->type()->ToString());
+  }
+  return {};
+}
+
+template <typename T>
+inline std::shared_ptr<ITensorBuilder> build_typed_column(
+    Client& client,
+    std::vector<std::shared_ptr<arrow::RecordBatch>> const& batches,
+    int const column, int64_t const num_rows) {
+  using array_type = typename ConvertToArrowType<T>::ArrayType;
+  auto builder = std::make_shared<TensorBuilder<T>>(
+      client, std::vector<int64_t>{num_rows});
+  T* data = builder->data();
+  for (auto const& batch : batches) {
+    auto array = std::static_pointer_cast<array_type>(batch->column(column));
+    std::memcpy(data, array->raw_values(), array->length() * sizeof(T));
+    data += array->length();
+  }
+  return builder;
+}
+
+inline boost::leaf::result<std::shared_ptr<ITensorBuilder>> build_column(
+    Client& client, std::shared_ptr<arrow::DataType> const& type,
+    std::vector<std::shared_ptr<arrow::RecordBatch>> const& batches,
+    int const column, int64_t const num_rows) {
+  switch (type->id()) {
+  case arrow::Type::INT32:
+    return build_typed_column<int32_t>(client, batches, column, num_rows);
+  case arrow::Type::UINT32:
+    return build_typed_column<uint32_t>(client, batches, column, num_rows);
+  case arrow::Type::INT64:
+    return build_typed_column<int64_t>(client, batches, column, num_rows);
+  case arrow::Type::UINT64:
+    return build_typed_column<uint64_t>(client, batches, column, num_rows);
+  case arrow::Type::FLOAT:
+    return build_typed_column<float>(client, batches, column, num_rows);
+  case arrow::Type::DOUBLE:
+    return build_typed_column<double>(client, batches, column, num_rows);
+  default:
+    RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                    "Unsupported column type: " + type->ToString());
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Repartition a `GlobalDataFrame` by the key column into a new one
+ * that has a partition per worker, collectively by all workers of the
+ * `comm_spec`, each of which connects to the vineyardd where its partitions
+ * are expected to be.
+ *
+ * Each worker reads its local partitions zero-copy (the local partitions of
+ * an instance are split among the workers that connect to it), and the rows
+ * are moved by `ShuffleTableByOffsetListsPipelined`, i.e., streamed in
+ * chunks over MPI, or sealed as record batches for the peers that connect
+ * to the same vineyardd. The received rows are written into the blobs of the
+ * receiver's vineyardd directly, and the partitions are sealed and persisted
+ * as a new `GlobalDataFrame` of the partition shape (worker_num, 1).
+ *
+ * @param key The partition key, which must be a numeric column.
+ * @param bounds Partition by the ranges of the key if given, the rows whose
+ * key is less than `bounds[0]` go to the worker 0, then in
+ * [`bounds[0]`, `bounds[1]`) go to the worker 1, and so on, it must be
+ * sorted and of size `worker_num - 1`. The rows are partitioned by the hash
+ * of the key if empty.
+ * @param compression The codec of the shuffled chunks, see also
+ * `ShuffleTableByOffsetListsPipelined`.
+ *
+ * @return The new global dataframe, on all workers.
+ */
+inline boost::leaf::result<ObjectID> RepartitionGlobalDataFrame(
+    Client& client, const grape::CommSpec& comm_spec, ObjectID const global_id,
+    std::string const& key, std::vector<double> const& bounds = {},
+    std::string const& compression = "") {
+  int worker_id = comm_spec.worker_id();
+  int worker_num = comm_spec.worker_num();
+  if (!bounds.empty() &&
+      (bounds.size() != static_cast<size_t>(worker_num - 1) ||
+       !std::is_sorted(bounds.begin(), bounds.end()))) {
+    RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                    "The range bounds must be sorted, one less than workers");
+  }
+
+  ObjectMeta global_meta;
+  VY_OK_OR_RAISE(client.GetMetaData(global_id, global_meta, true));
+  auto partitions = global_meta.GetMemberMeta("objects_");
+  size_t num_partitions = partitions.GetKeyValue<size_t>("num_of_objects");
+  if (num_partitions == 0) {
+    RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                    "The global dataframe has no partitions");
+  }
+  BOOST_LEAF_AUTO(schema, detail::dataframe_schema(partitions.GetMemberMeta(
+                              "object_0")));
+  int key_index = schema->GetFieldIndex(key);
+  if (key_index == -1) {
+    RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                    "The partition key is not found: " + key);
+  }
+
+  // the local partitions, of this worker among the workers of the instance
+  std::vector<std::shared_ptr<DataFrame>> dataframes;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches_out;
+  size_t local_index = 0;
+  for (size_t index = 0; index < num_partitions; ++index) {
+    auto partition =
+        partitions.GetMemberMeta("object_" + std::to_string(index));
+    if (partition.GetInstanceId() != client.instance_id()) {
+      continue;
+    }
+    if (local_index++ % comm_spec.local_num() != comm_spec.local_id()) {
+      continue;
+    }
+    std::shared_ptr<DataFrame> dataframe;
+    VY_OK_OR_RAISE(client.GetObject(partition.GetId(), dataframe));
+    batches_out.emplace_back(detail::dataframe_to_batch(schema, *dataframe));
+    dataframes.emplace_back(dataframe);
+  }
+
+  std::vector<std::vector<std::vector<int64_t>>> offset_lists(
+      batches_out.size());
+  for (size_t index = 0; index < batches_out.size(); ++index) {
+    BOOST_LEAF_CHECK(detail::assign_rows(batches_out[index]->column(key_index),
+                                         bounds, worker_num,
+                                         offset_lists[index]));
+  }
+
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
+  std::vector<ObjectID> shared_batches;
+  ShuffleTableByOffsetListsPipelined(schema, batches_out, offset_lists,
+                                     batches_in, comm_spec, &client,
+                                     &shared_batches, compression);
+
+  // write the received rows into the local vineyardd
+  int64_t num_rows = 0;
+  for (auto const& batch : batches_in) {
+    num_rows += batch->num_rows();
+  }
+  DataFrameBuilder builder(client);
+  builder.set_partition_index(worker_id, 0);
+  for (int column = 0; column < schema->num_fields(); ++column) {
+    BOOST_LEAF_AUTO(tensor,
+                    detail::build_column(client, schema->field(column)->type(),
+                                         batches_in, column, num_rows));
+    builder.AddColumn(schema->field(column)->name(), tensor);
+  }
+  batches_in.clear();
+  if (!shared_batches.empty()) {
+    VY_OK_OR_RAISE(client.DelData(shared_batches, true, true));
+  }
+  auto dataframe = builder.Seal(client);
+  VY_OK_OR_RAISE(client.Persist(dataframe->id()));
+
+  // seal the global dataframe on the worker 0
+  ObjectID partition_id = dataframe->id();
+  InstanceID instance_id = client.instance_id();
+  std::vector<ObjectID> partition_ids(worker_num);
+  std::vector<InstanceID> instance_ids(worker_num);
+  MPI_Allgather(&partition_id, 1, MPI_UINT64_T, partition_ids.data(), 1,
+                MPI_UINT64_T, comm_spec.comm());
+  MPI_Allgather(&instance_id, 1, MPI_UINT64_T, instance_ids.data(), 1,
+                MPI_UINT64_T, comm_spec.comm());
+  ObjectID result_id = InvalidObjectID();
+  if (worker_id == 0) {
+    GlobalDataFrameBuilder global_builder(client);
+    global_builder.set_partition_shape(worker_num, 1);
+    for (int index = 0; index < worker_num; ++index) {
+      global_builder.AddPartition(instance_ids[index], partition_ids[index]);
+    }
+    auto global = global_builder.Seal(client);
+    VY_OK_OR_RAISE(client.Persist(global->id()));
+    result_id = global->id();
+  }
+  MPI_Bcast(&result_id, 1, MPI_UINT64_T, 0, comm_spec.comm());
+  return result_id;
+}
+
+}  // namespace beta
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_DATAFRAME_SHUFFLER_H_
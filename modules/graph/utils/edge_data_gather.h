@@ -0,0 +1,225 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_EDGE_DATA_GATHER_H_
+#define MODULES_GRAPH_UTILS_EDGE_DATA_GATHER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace vineyard {
+
+/**
+ * Batched accesses to an edge property column through the neighbor units of
+ * an adjacency list, i.e., `data[nbr.eid]` for every `nbr` in `[begin, end)`.
+ *
+ * When the neighbor unit is the `{vid, eid}` pair of 64-bit integers (the
+ * default `NbrUnit<uint64_t, uint64_t>`) and the property is a 4-byte or
+ * 8-byte arithmetic type, the edge ids are de-interleaved from the neighbor
+ * units and the values are fetched with the AVX2 (4 lanes) or AVX-512 (8
+ * lanes) gather instructions, if the target supports them. Otherwise the
+ * values are fetched one by one.
+ *
+ * The reductions gather the values to a small stack buffer block by block
+ * and reduce the buffer with plain loops that the compiler vectorizes. Note
+ * that the summation of floating-point values is hence not performed in the
+ * order of the neighbors.
+ */
+namespace gather {
+
+namespace detail {
+
+template <typename T, typename NBR_T>
+struct simd_gatherable {
+  static constexpr bool value =
+      std::is_arithmetic<T>::value && (sizeof(T) == 4 || sizeof(T) == 8) &&
+      std::is_standard_layout<NBR_T>::value && sizeof(NBR_T) == 16 &&
+      sizeof(NBR_T::eid) == 8 && offsetof(NBR_T, eid) == 8;
+};
+
+template <typename T, typename NBR_T>
+inline size_t gather_scalar(const T* data, const NBR_T* begin,
+                            const NBR_T* end, T* out) {
+  size_t n = end - begin;
+  for (size_t k = 0; k < n; ++k) {
+    out[k] = data[begin[k].eid];
+  }
+  return n;
+}
+
+#if defined(__AVX512F__)
+// loads the edge ids of 8 neighbor units, i.e., the odd 64-bit words.
+inline __m512i load_eids(const void* units) {
+  const __m512i lo = _mm512_loadu_si512(units);
+  const __m512i hi =
+      _mm512_loadu_si512(reinterpret_cast<const __m512i*>(units) + 1);
+  const __m512i odd = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+  return _mm512_permutex2var_epi64(lo, odd, hi);
+}
+
+template <typename T, typename NBR_T>
+inline size_t gather_simd(const T* data, const NBR_T* begin, const NBR_T* end,
+                          T* out) {
+  constexpr size_t lanes = 8;
+  size_t n = (end - begin) / lanes * lanes;
+  for (size_t k = 0; k < n; k += lanes) {
+    const __m512i eids = load_eids(begin + k);
+    if (sizeof(T) == 8) {
+      _mm512_storeu_si512(out + k, _mm512_i64gather_epi64(eids, data, 8));
+    } else {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k),
+                          _mm512_i64gather_epi32(eids, data, 4));
+    }
+  }
+  return n;
+}
+#elif defined(__AVX2__)
+// loads the edge ids of 4 neighbor units, i.e., the odd 64-bit words.
+inline __m256i load_eids(const void* units) {
+  const __m256i lo =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(units));
+  const __m256i hi =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(units) + 1);
+  // [e0, e2, e1, e3] -> [e0, e1, e2, e3]
+  return _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(lo, hi), 0xD8);
+}
+
+template <typename T, typename NBR_T>
+inline size_t gather_simd(const T* data, const NBR_T* begin, const NBR_T* end,
+                          T* out) {
+  constexpr size_t lanes = 4;
+  size_t n = (end - begin) / lanes * lanes;
+  for (size_t k = 0; k < n; k += lanes) {
+    const __m256i eids = load_eids(begin + k);
+    if (sizeof(T) == 8) {
+      _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(out + k),
+          _mm256_i64gather_epi64(reinterpret_cast<const long long*>(data),
+                                 eids, 8));
+    } else {
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(out + k),
+          _mm256_i64gather_epi32(reinterpret_cast<const int*>(data), eids, 4));
+    }
+  }
+  return n;
+}
+#else
+template <typename T, typename NBR_T>
+inline size_t gather_simd(const T*, const NBR_T*, const NBR_T*, T*) {
+  return 0;
+}
+#endif
+
+template <typename T, typename NBR_T>
+inline typename std::enable_if<simd_gatherable<T, NBR_T>::value>::type
+gather_impl(const T* data, const NBR_T* begin, const NBR_T* end, T* out) {
+  size_t n = gather_simd(data, begin, end, out);
+  gather_scalar(data, begin + n, end, out + n);
+}
+
+template <typename T, typename NBR_T>
+inline typename std::enable_if<!simd_gatherable<T, NBR_T>::value>::type
+gather_impl(const T* data, const NBR_T* begin, const NBR_T* end, T* out) {
+  gather_scalar(data, begin, end, out);
+}
+
+// the number of values gathered to the stack buffer at a time by the
+// reductions.
+static constexpr size_t block_size = 256;
+
+template <typename T, typename NBR_T, typename FUNC_T>
+inline T reduce(const T* data, const NBR_T* begin, const NBR_T* end, T init,
+                const FUNC_T& func) {
+  T buffer[block_size];
+  T result = init;
+  while (begin < end) {
+    size_t n = std::min<size_t>(end - begin, block_size);
+    gather_impl(data, begin, begin + n, buffer);
+    result = func(result, buffer, n);
+    begin += n;
+  }
+  return result;
+}
+
+}  // namespace detail
+
+/**
+ * @brief Gather `data[nbr.eid]` of the neighbor units in `[begin, end)` to
+ * `out`, which has at least `end - begin` elements.
+ */
+template <typename T, typename NBR_T>
+inline void gather(const T* data, const NBR_T* begin, const NBR_T* end,
+                   T* out) {
+  detail::gather_impl(data, begin, end, out);
+}
+
+/**
+ * @brief The sum of `data[nbr.eid]` of the neighbor units in `[begin, end)`,
+ * 0 if the range is empty.
+ */
+template <typename T, typename NBR_T>
+inline T sum(const T* data, const NBR_T* begin, const NBR_T* end) {
+  return detail::reduce(data, begin, end, static_cast<T>(0),
+                        [](T result, const T* values, size_t n) {
+                          for (size_t k = 0; k < n; ++k) {
+                            result += values[k];
+                          }
+                          return result;
+                        });
+}
+
+/**
+ * @brief The minimum of `data[nbr.eid]` of the neighbor units in
+ * `[begin, end)`, `std::numeric_limits<T>::max()` if the range is empty.
+ */
+template <typename T, typename NBR_T>
+inline T min(const T* data, const NBR_T* begin, const NBR_T* end) {
+  return detail::reduce(data, begin, end, std::numeric_limits<T>::max(),
+                        [](T result, const T* values, size_t n) {
+                          for (size_t k = 0; k < n; ++k) {
+                            result = values[k] < result ? values[k] : result;
+                          }
+                          return result;
+                        });
+}
+
+/**
+ * @brief The maximum of `data[nbr.eid]` of the neighbor units in
+ * `[begin, end)`, `std::numeric_limits<T>::lowest()` if the range is empty.
+ */
+template <typename T, typename NBR_T>
+inline T max(const T* data, const NBR_T* begin, const NBR_T* end) {
+  return detail::reduce(data, begin, end, std::numeric_limits<T>::lowest(),
+                        [](T result, const T* values, size_t n) {
+                          for (size_t k = 0; k < n; ++k) {
+                            result = values[k] > result ? values[k] : result;
+                          }
+                          return result;
+                        });
+}
+
+}  // namespace gather
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_EDGE_DATA_GATHER_H_
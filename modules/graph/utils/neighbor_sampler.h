@@ -0,0 +1,530 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_NEIGHBOR_SAMPLER_H_
+#define MODULES_GRAPH_UTILS_NEIGHBOR_SAMPLER_H_
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/api.h"
+#include "boost/leaf/all.hpp"
+#include "grape/worker/comm_spec.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_utils.h"
+#include "client/client.h"
+
+#include "graph/fragment/property_graph_types.h"
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/error.h"
+#include "graph/utils/thread_group.h"
+
+namespace vineyard {
+
+namespace sampler {
+
+namespace detail {
+
+inline uint64_t mix(uint64_t x) {
+  // splitmix64
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace detail
+
+/**
+ * @brief A small and fast random generator (xorshift64*), the samplers seed
+ * one per vertex, thus the samples don't depend on the number of threads.
+ */
+class Random {
+ public:
+  explicit Random(uint64_t seed) : state_(detail::mix(seed) | 1) {}
+
+  uint64_t Next() {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return state_ * 0x2545f4914f6cdd1dULL;
+  }
+
+  // in [0, n)
+  size_t Uniform(size_t n) { return static_cast<size_t>(Real() * n); }
+
+  // in [0, 1)
+  double Real() { return (Next() >> 11) * (1.0 / (1ULL << 53)); }
+
+ private:
+  uint64_t state_;
+};
+
+/**
+ * @brief The alias tables of Walker's alias method, which draw an item of a
+ * weighted list in O(1). The table of a list of `n` items is the `n`
+ * probabilities and `n` aliases, which are stored in the slices of the flat
+ * arrays of all lists.
+ */
+struct AliasTable {
+  /**
+   * @brief Build the table of `weights[0, n)` to `prob[0, n)` and
+   * `alias[0, n)`. The negative weights are taken as zeros, and the lists of
+   * all zeros are drawn uniformly.
+   */
+  template <typename T>
+  static void Build(const T* weights, size_t n, float* prob, uint32_t* alias) {
+    double total = 0;
+    for (size_t k = 0; k < n; ++k) {
+      total += std::max(static_cast<double>(weights[k]), 0.0);
+    }
+    if (!(total > 0)) {
+      for (size_t k = 0; k < n; ++k) {
+        prob[k] = 1.0f;
+        alias[k] = static_cast<uint32_t>(k);
+      }
+      return;
+    }
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    for (size_t k = 0; k < n; ++k) {
+      scaled[k] = std::max(static_cast<double>(weights[k]), 0.0) * n / total;
+      (scaled[k] < 1.0 ? small : large).emplace_back(static_cast<uint32_t>(k));
+    }
+    while (!small.empty() && !large.empty()) {
+      uint32_t s = small.back(), l = large.back();
+      small.pop_back();
+      prob[s] = static_cast<float>(scaled[s]);
+      alias[s] = l;
+      scaled[l] -= 1.0 - scaled[s];
+      if (scaled[l] < 1.0) {
+        large.pop_back();
+        small.emplace_back(l);
+      }
+    }
+    // the rest are 1.0, up to the rounding errors
+    for (uint32_t k : small) {
+      prob[k] = 1.0f;
+      alias[k] = k;
+    }
+    for (uint32_t k : large) {
+      prob[k] = 1.0f;
+      alias[k] = k;
+    }
+  }
+
+  static size_t Draw(const float* prob, const uint32_t* alias, size_t n,
+                     Random& rng) {
+    size_t k = rng.Uniform(n);
+    return rng.Real() < prob[k] ? k : alias[k];
+  }
+};
+
+/**
+ * @brief Draw `k` distinct items of `[0, n)` to `out` by Floyd's algorithm,
+ * where `k <= n`.
+ */
+inline void choose(size_t n, size_t k, Random& rng, std::vector<size_t>& out) {
+  out.clear();
+  for (size_t j = n - k; j < n; ++j) {
+    size_t t = rng.Uniform(j + 1);
+    if (std::find(out.begin(), out.end(), t) == out.end()) {
+      out.emplace_back(t);
+    } else {
+      out.emplace_back(j);
+    }
+  }
+}
+
+}  // namespace sampler
+
+/**
+ * @brief NeighborSampler samples fixed-fanout neighborhoods of vertices over
+ * the outgoing edges of an edge label of `ArrowFragment`, e.g., for the
+ * mini-batches of GNN training.
+ *
+ * The neighbors are drawn
+ *
+ *  - uniformly without replacement, when the sampler has no weight, or
+ *  - by the weights in an edge property column with replacement, from the
+ *    alias tables that are built by `Init()` for every vertex label.
+ *
+ * The vertices whose degree is not larger than the fanout keep all their
+ * neighbors. The samples are determined by the seed, the hop and the vertex,
+ * regardless of the number of threads and workers.
+ *
+ * The vertices are identified by gids, see also `ArrowFragment::Gid2Oid()`.
+ * Fragments whose edges are compacted (`compact_edges()`) are not supported.
+ */
+template <typename FRAG_T>
+class NeighborSampler {
+  using fragment_t = FRAG_T;
+  using vid_t = typename fragment_t::vid_t;
+  using vertex_t = typename fragment_t::vertex_t;
+  using nbr_unit_t = typename fragment_t::nbr_unit_t;
+  using label_id_t = typename fragment_t::label_id_t;
+  using prop_id_t = typename fragment_t::prop_id_t;
+  using vid_builder_t =
+      typename vineyard::ConvertToArrowType<vid_t>::BuilderType;
+
+ public:
+  /**
+   * @param weight The edge property of the weights, -1 for drawing the
+   * neighbors uniformly.
+   */
+  NeighborSampler(const fragment_t& frag, label_id_t e_label,
+                  prop_id_t weight = -1)
+      : frag_(frag), e_label_(e_label), weight_(weight) {
+    id_parser_.Init(frag.fnum(), frag.vertex_label_num());
+  }
+
+  boost::leaf::result<void> Init() {
+    if (frag_.compact_edges()) {
+      RETURN_GS_ERROR(ErrorCode::kUnsupportedOperationError,
+                      "Sampling the compacted edges is not supported");
+    }
+    if (e_label_ < 0 || e_label_ >= frag_.edge_label_num()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Invalid edge label: " + std::to_string(e_label_));
+    }
+    label_id_t v_label_num = frag_.vertex_label_num();
+    bases_.assign(v_label_num, nullptr);
+    probs_.assign(v_label_num, std::vector<float>());
+    aliases_.assign(v_label_num, std::vector<uint32_t>());
+    for (label_id_t v_label = 0; v_label < v_label_num; ++v_label) {
+      auto inner_vertices = frag_.InnerVertices(v_label);
+      if (inner_vertices.size() > 0) {
+        // the outgoing edges of the inner vertices are contiguous
+        bases_[v_label] =
+            frag_.GetOutgoingAdjList(*inner_vertices.begin(), e_label_)
+                .begin_unit();
+      }
+    }
+    if (weight_ < 0) {
+      return {};
+    }
+    if (weight_ >= frag_.edge_property_num(e_label_)) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Invalid edge property: " + std::to_string(weight_));
+    }
+    auto type = frag_.edge_property_type(e_label_, weight_);
+    if (type->Equals(arrow::float64())) {
+      initAliasTables<double>();
+    } else if (type->Equals(arrow::float32())) {
+      initAliasTables<float>();
+    } else if (type->Equals(arrow::int64())) {
+      initAliasTables<int64_t>();
+    } else if (type->Equals(arrow::int32())) {
+      initAliasTables<int32_t>();
+    } else if (type->Equals(arrow::uint64())) {
+      initAliasTables<uint64_t>();
+    } else if (type->Equals(arrow::uint32())) {
+      initAliasTables<uint32_t>();
+    } else {
+      RETURN_GS_ERROR(ErrorCode::kDataTypeError,
+                      "The weights must be numeric, but got " +
+                          type->ToString());
+    }
+    return {};
+  }
+
+  /**
+   * @brief Sample the neighbors of the inner vertices `gids`, where the
+   * neighbors of `gids[i]` are `nbrs[offsets[i], offsets[i + 1])`, and the
+   * vertices that are not inner vertices of the fragment have no neighbors.
+   */
+  void Sample(const std::vector<vid_t>& gids, size_t fanout, uint64_t seed,
+              std::vector<int64_t>& offsets, std::vector<vid_t>& nbrs,
+              int concurrency = std::thread::hardware_concurrency()) const {
+    offsets.assign(gids.size() + 1, 0);
+    ThreadPool::Default().ParallelFor(
+        gids.size(),
+        [&](size_t, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            vertex_t v;
+            if (innerVertex(gids[i], v)) {
+              offsets[i + 1] = static_cast<int64_t>(std::min(
+                  fanout, frag_.GetOutgoingAdjList(v, e_label_).Size()));
+            }
+          }
+        },
+        concurrency, kChunkSize);
+    for (size_t i = 0; i < gids.size(); ++i) {
+      offsets[i + 1] += offsets[i];
+    }
+    nbrs.resize(offsets.back());
+    ThreadPool::Default().ParallelFor(
+        gids.size(),
+        [&](size_t, size_t begin, size_t end) {
+          std::vector<size_t> chosen;
+          for (size_t i = begin; i < end; ++i) {
+            if (offsets[i + 1] != offsets[i]) {
+              sampleVertex(gids[i], seed, &nbrs[offsets[i]],
+                           offsets[i + 1] - offsets[i], chosen);
+            }
+          }
+        },
+        concurrency, kChunkSize);
+  }
+
+  /**
+   * @brief Sample the k-hop neighborhood of the seeds, where the frontier of
+   * every hop is the distinct neighbors sampled by the previous hop, and the
+   * vertices of other fragments are sampled by their owners in a batch per
+   * hop.
+   *
+   * It is a collective operation on all workers of the comm spec, every
+   * worker passes its own seeds (which could be empty), and gets the sampled
+   * edges of its seeds as the table of columns `hop` (int32), `src` and
+   * `dst` (the gids).
+   */
+  boost::leaf::result<std::shared_ptr<arrow::Table>> SampleKHop(
+      const grape::CommSpec& comm_spec, const std::vector<vid_t>& seeds,
+      const std::vector<size_t>& fanouts, uint64_t seed,
+      int concurrency = std::thread::hardware_concurrency()) const {
+    int const worker_num = comm_spec.worker_num();
+    arrow::Int32Builder hop_builder;
+    vid_builder_t src_builder, dst_builder;
+
+    std::vector<vid_t> frontier(seeds);
+    for (size_t hop = 0; hop < fanouts.size(); ++hop) {
+      std::sort(frontier.begin(), frontier.end());
+      frontier.erase(std::unique(frontier.begin(), frontier.end()),
+                     frontier.end());
+
+      // the requests, grouped by the owners
+      std::vector<std::vector<vid_t>> grouped(worker_num);
+      for (vid_t gid : frontier) {
+        grouped[comm_spec.FragToWorker(id_parser_.GetFid(gid))].emplace_back(
+            gid);
+      }
+      std::vector<vid_t> requests;
+      std::vector<int> send_counts(worker_num), recv_counts;
+      for (int worker = 0; worker < worker_num; ++worker) {
+        requests.insert(requests.end(), grouped[worker].begin(),
+                        grouped[worker].end());
+        send_counts[worker] = static_cast<int>(grouped[worker].size());
+      }
+      std::vector<vid_t> received;
+      exchangeCounts(comm_spec, send_counts, recv_counts);
+      exchangeBuffers(comm_spec, requests, send_counts, received, recv_counts);
+
+      // sample for the requests, and reply the degrees and the neighbors
+      std::vector<int64_t> offsets;
+      std::vector<vid_t> nbrs;
+      Sample(received, fanouts[hop], hopSeed(seed, hop), offsets, nbrs,
+             concurrency);
+      std::vector<int64_t> degrees(received.size());
+      for (size_t i = 0; i < received.size(); ++i) {
+        degrees[i] = offsets[i + 1] - offsets[i];
+      }
+      std::vector<int> nbr_send_counts(worker_num, 0), nbr_recv_counts;
+      for (int worker = 0, index = 0; worker < worker_num; ++worker) {
+        for (int k = 0; k < recv_counts[worker]; ++k, ++index) {
+          nbr_send_counts[worker] += static_cast<int>(degrees[index]);
+        }
+      }
+      std::vector<int64_t> replied_degrees;
+      std::vector<vid_t> replied_nbrs;
+      exchangeBuffers(comm_spec, degrees, recv_counts, replied_degrees,
+                      send_counts);
+      exchangeCounts(comm_spec, nbr_send_counts, nbr_recv_counts);
+      exchangeBuffers(comm_spec, nbrs, nbr_send_counts, replied_nbrs,
+                      nbr_recv_counts);
+
+      // the replies are in the order of the requests
+      frontier.clear();
+      size_t cursor = 0;
+      for (size_t i = 0; i < requests.size(); ++i) {
+        for (int64_t k = 0; k < replied_degrees[i]; ++k, ++cursor) {
+          ARROW_OK_OR_RAISE(hop_builder.Append(static_cast<int32_t>(hop)));
+          ARROW_OK_OR_RAISE(src_builder.Append(requests[i]));
+          ARROW_OK_OR_RAISE(dst_builder.Append(replied_nbrs[cursor]));
+          frontier.emplace_back(replied_nbrs[cursor]);
+        }
+      }
+    }
+
+    std::shared_ptr<arrow::Array> hop_array, src_array, dst_array;
+    ARROW_OK_OR_RAISE(hop_builder.Finish(&hop_array));
+    ARROW_OK_OR_RAISE(src_builder.Finish(&src_array));
+    ARROW_OK_OR_RAISE(dst_builder.Finish(&dst_array));
+    auto schema = arrow::schema(
+        {arrow::field("hop", arrow::int32()),
+         arrow::field("src", vineyard::ConvertToArrowType<vid_t>::TypeValue()),
+         arrow::field("dst",
+                      vineyard::ConvertToArrowType<vid_t>::TypeValue())});
+    return arrow::Table::Make(schema, {hop_array, src_array, dst_array});
+  }
+
+  /**
+   * @brief Sample the k-hop neighborhood as `SampleKHop()`, and put the
+   * table of sampled edges into vineyard.
+   */
+  boost::leaf::result<ObjectID> SampleKHopToVineyard(
+      Client& client, const grape::CommSpec& comm_spec,
+      const std::vector<vid_t>& seeds, const std::vector<size_t>& fanouts,
+      uint64_t seed,
+      int concurrency = std::thread::hardware_concurrency()) const {
+    BOOST_LEAF_AUTO(table,
+                    SampleKHop(comm_spec, seeds, fanouts, seed, concurrency));
+    TableBuilder builder(client, table);
+    return builder.Seal(client)->id();
+  }
+
+ private:
+  static constexpr size_t kChunkSize = 1024;
+
+  static uint64_t hopSeed(uint64_t seed, size_t hop) {
+    return sampler::detail::mix(seed + hop);
+  }
+
+  bool innerVertex(vid_t gid, vertex_t& v) const {
+    if (id_parser_.GetFid(gid) != frag_.fid()) {
+      return false;
+    }
+    return frag_.InnerVertexGid2Vertex(gid, v) && frag_.IsInnerVertex(v);
+  }
+
+  template <typename T>
+  void initAliasTables() {
+    auto column = frag_.edge_data_table(e_label_)->column(weight_);
+    const T* weights =
+        column->num_chunks() == 0
+            ? nullptr
+            : std::dynamic_pointer_cast<
+                  typename vineyard::ConvertToArrowType<T>::ArrayType>(
+                  column->chunk(0))
+                  ->raw_values();
+    for (label_id_t v_label = 0; v_label < frag_.vertex_label_num();
+         ++v_label) {
+      auto inner_vertices = frag_.InnerVertices(v_label);
+      if (inner_vertices.size() == 0) {
+        continue;
+      }
+      vertex_t last(inner_vertices.begin_value() + inner_vertices.size() - 1);
+      size_t edge_num =
+          frag_.GetOutgoingAdjList(last, e_label_).end_unit() - bases_[v_label];
+      probs_[v_label].resize(edge_num);
+      aliases_[v_label].resize(edge_num);
+      auto& prob = probs_[v_label];
+      auto& alias = aliases_[v_label];
+      vid_t first = inner_vertices.begin_value();
+      ThreadPool::Default().ParallelFor(
+          inner_vertices.size(),
+          [&](size_t, size_t begin, size_t end) {
+            std::vector<T> buffer;
+            for (size_t i = begin; i < end; ++i) {
+              auto es = frag_.GetOutgoingAdjList(vertex_t(first + i), e_label_);
+              size_t offset = es.begin_unit() - bases_[v_label];
+              buffer.resize(es.Size());
+              for (size_t k = 0; k < es.Size(); ++k) {
+                buffer[k] = weights[es.begin_unit()[k].eid];
+              }
+              sampler::AliasTable::Build(buffer.data(), buffer.size(),
+                                         &prob[offset], &alias[offset]);
+            }
+          },
+          std::thread::hardware_concurrency(), kChunkSize);
+    }
+  }
+
+  void sampleVertex(vid_t gid, uint64_t seed, vid_t* out, size_t count,
+                    std::vector<size_t>& chosen) const {
+    vertex_t v;
+    frag_.InnerVertexGid2Vertex(gid, v);
+    auto es = frag_.GetOutgoingAdjList(v, e_label_);
+    const nbr_unit_t* units = es.begin_unit();
+    size_t degree = es.Size();
+    auto emit = [&](size_t k, size_t index) {
+      out[k] = frag_.Vertex2Gid(vertex_t(units[index].vid));
+    };
+    if (count == degree) {
+      for (size_t k = 0; k < degree; ++k) {
+        emit(k, k);
+      }
+      return;
+    }
+    sampler::Random rng(seed ^ sampler::detail::mix(gid));
+    if (weight_ < 0) {
+      sampler::choose(degree, count, rng, chosen);
+      for (size_t k = 0; k < count; ++k) {
+        emit(k, chosen[k]);
+      }
+    } else {
+      label_id_t v_label = frag_.vertex_label(v);
+      size_t offset = units - bases_[v_label];
+      const float* prob = probs_[v_label].data() + offset;
+      const uint32_t* alias = aliases_[v_label].data() + offset;
+      for (size_t k = 0; k < count; ++k) {
+        emit(k, sampler::AliasTable::Draw(prob, alias, degree, rng));
+      }
+    }
+  }
+
+  // the number of elements to send to each worker, and to receive from
+  static void exchangeCounts(const grape::CommSpec& comm_spec,
+                             const std::vector<int>& send_counts,
+                             std::vector<int>& recv_counts) {
+    recv_counts.resize(comm_spec.worker_num());
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1,
+                 MPI_INT, comm_spec.comm());
+  }
+
+  // exchange the trivially copyable elements, grouped by the workers
+  template <typename T>
+  static void exchangeBuffers(const grape::CommSpec& comm_spec,
+                              const std::vector<T>& send,
+                              const std::vector<int>& send_counts,
+                              std::vector<T>& recv,
+                              const std::vector<int>& recv_counts) {
+    int const worker_num = comm_spec.worker_num();
+    std::vector<int> send_offsets(worker_num, 0), recv_offsets(worker_num, 0);
+    for (int worker = 1; worker < worker_num; ++worker) {
+      send_offsets[worker] = send_offsets[worker - 1] + send_counts[worker - 1];
+      recv_offsets[worker] = recv_offsets[worker - 1] + recv_counts[worker - 1];
+    }
+    recv.resize(recv_offsets[worker_num - 1] + recv_counts[worker_num - 1]);
+    MPI_Datatype type;
+    MPI_Type_contiguous(sizeof(T), MPI_CHAR, &type);
+    MPI_Type_commit(&type);
+    MPI_Alltoallv(send.data(), send_counts.data(), send_offsets.data(), type,
+                  recv.data(), recv_counts.data(), recv_offsets.data(), type,
+                  comm_spec.comm());
+    MPI_Type_free(&type);
+  }
+
+  const fragment_t& frag_;
+  label_id_t e_label_;
+  prop_id_t weight_;
+  vineyard::IdParser<vid_t> id_parser_;
+
+  // the first outgoing edge of the inner vertices, and the alias tables of
+  // the edges, for every vertex label
+  std::vector<const nbr_unit_t*> bases_;
+  std::vector<std::vector<float>> probs_;
+  std::vector<std::vector<uint32_t>> aliases_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_NEIGHBOR_SAMPLER_H_
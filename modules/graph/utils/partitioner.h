@@ -16,8 +16,12 @@ limitations under the License.
 #ifndef MODULES_GRAPH_UTILS_PARTITIONER_H_
 #define MODULES_GRAPH_UTILS_PARTITIONER_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <functional>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -30,6 +34,85 @@ limitations under the License.
 
 namespace vineyard {
 
+namespace detail {
+
+inline uint64_t wyread8(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+
+inline uint64_t wyread4(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+inline void wymum(uint64_t* a, uint64_t* b) {
+  __uint128_t r = *a;
+  r *= *b;
+  *a = static_cast<uint64_t>(r);
+  *b = static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t wymix(uint64_t a, uint64_t b) {
+  wymum(&a, &b);
+  return a ^ b;
+}
+
+/**
+ * @brief The wyhash (final version) of the bytes, which reads the bytes in
+ * 8-byte words without any temporary copies and is much faster than
+ * `std::hash<std::string>` on short keys.
+ */
+inline uint64_t wyhash(const void* key, size_t len, uint64_t seed = 0) {
+  static constexpr uint64_t secret[4] = {
+      0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+      0x589965cc75374cc3ull};
+  const uint8_t* p = static_cast<const uint8_t*>(key);
+  seed ^= wymix(seed ^ secret[0], secret[1]);
+  uint64_t a, b;
+  if (len <= 16) {
+    if (len >= 4) {
+      a = (wyread4(p) << 32) | wyread4(p + ((len >> 3) << 2));
+      b = (wyread4(p + len - 4) << 32) |
+          wyread4(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = (static_cast<uint64_t>(p[0]) << 16) |
+          (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = wymix(wyread8(p) ^ secret[1], wyread8(p + 8) ^ seed);
+        see1 = wymix(wyread8(p + 16) ^ secret[2], wyread8(p + 24) ^ see1);
+        see2 = wymix(wyread8(p + 32) ^ secret[3], wyread8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = wymix(wyread8(p) ^ secret[1], wyread8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = wyread8(p + i - 16);
+    b = wyread8(p + i - 8);
+  }
+  a ^= secret[1];
+  b ^= seed;
+  wymum(&a, &b);
+  return wymix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+}  // namespace detail
+
 // TODO(lxj): check if identical to the file in libgrape-lite
 template <typename OID_T>
 class HashPartitioner {
@@ -40,10 +123,32 @@ class HashPartitioner {
 
   void Init(fid_t fnum) { fnum_ = fnum; }
 
+  fid_t fnum() const { return fnum_; }
+
   inline fid_t GetPartitionId(const OID_T& oid) const {
     return static_cast<fid_t>(static_cast<uint64_t>(oid) % fnum_);
   }
 
+  /**
+   * @brief Partition the oids in an arrow array in a batch, reading the value
+   * buffer directly.
+   */
+  template <typename ARRAY_T>
+  void GetPartitionIds(const ARRAY_T& array, fid_t* out) const {
+    const auto* values = array.raw_values();
+    int64_t length = array.length();
+    if ((fnum_ & (fnum_ - 1)) == 0) {
+      uint64_t mask = fnum_ - 1;
+      for (int64_t i = 0; i < length; ++i) {
+        out[i] = static_cast<fid_t>(static_cast<uint64_t>(values[i]) & mask);
+      }
+    } else {
+      for (int64_t i = 0; i < length; ++i) {
+        out[i] = static_cast<fid_t>(static_cast<uint64_t>(values[i]) % fnum_);
+      }
+    }
+  }
+
   HashPartitioner& operator=(const HashPartitioner& other) {
     if (this == &other) {
       return *this;
@@ -69,20 +174,66 @@ class HashPartitioner<std::string> {
  public:
   using oid_t = std::string;
 
-  HashPartitioner() : fnum_(1) {}
+  HashPartitioner() : fnum_(1), wyhash_(false) {}
+
+  /**
+   * @brief Initialize the partitioner.
+   *
+   * @param wyhash Hash the oids with wyhash rather than
+   * `std::hash<std::string>`. wyhash is faster, but the assignment differs
+   * from the one of libgrape-lite and of the fragments loaded before, thus
+   * it is off by default.
+   */
+  void Init(fid_t fnum, bool wyhash = false) {
+    fnum_ = fnum;
+    wyhash_ = wyhash;
+  }
 
-  void Init(fid_t fnum) { fnum_ = fnum; }
+  fid_t fnum() const { return fnum_; }
+
+  bool wyhash() const { return wyhash_; }
 
   inline fid_t GetPartitionId(const oid_t& oid) const {
+    if (wyhash_) {
+      return static_cast<fid_t>(detail::wyhash(oid.data(), oid.size()) %
+                                fnum_);
+    }
     return static_cast<fid_t>(
         static_cast<uint64_t>(std::hash<std::string>()(oid)) % fnum_);
   }
 
+  /**
+   * @brief Partition the oids in an arrow string array in a batch, hashing
+   * the views of the value buffer. Without wyhash the views are copied into
+   * one reused buffer for `std::hash<std::string>`.
+   */
+  template <typename ARRAY_T>
+  void GetPartitionIds(const ARRAY_T& array, fid_t* out) const {
+    int64_t length = array.length();
+    if (wyhash_) {
+      for (int64_t i = 0; i < length; ++i) {
+        auto view = array.GetView(i);
+        out[i] = static_cast<fid_t>(detail::wyhash(view.data(), view.size()) %
+                                    fnum_);
+      }
+      return;
+    }
+    std::hash<std::string> hasher;
+    std::string buffer;
+    for (int64_t i = 0; i < length; ++i) {
+      auto view = array.GetView(i);
+      buffer.assign(view.data(), view.size());
+      out[i] = static_cast<fid_t>(static_cast<uint64_t>(hasher(buffer)) %
+                                  fnum_);
+    }
+  }
+
   HashPartitioner& operator=(const HashPartitioner& other) {
     if (this == &other) {
       return *this;
     }
     fnum_ = other.fnum_;
+    wyhash_ = other.wyhash_;
     return *this;
   }
 
@@ -91,11 +242,13 @@ class HashPartitioner<std::string> {
       return *this;
     }
     fnum_ = other.fnum_;
+    wyhash_ = other.wyhash_;
     return *this;
   }
 
  private:
   fid_t fnum_;
+  bool wyhash_;
 };
 
 #ifdef EXPERIMENTAL_ON
@@ -108,6 +261,8 @@ class HashPartitioner<folly::dynamic> {
 
   void Init(fid_t fnum) { fnum_ = fnum; }
 
+  fid_t fnum() const { return fnum_; }
+
   inline fid_t GetPartitionId(const oid_t& oid) const {
     size_t hash_value;
     if (oid.isInt()) {
@@ -141,6 +296,41 @@ class HashPartitioner<folly::dynamic> {
 };
 #endif  // EXPERIMENTAL_ON
 
+namespace detail {
+
+// the oids that can be partitioned by the sorted split points of segments
+template <typename OID_T>
+struct is_range_partitionable
+    : std::integral_constant<bool, std::is_arithmetic<OID_T>::value> {};
+
+template <>
+struct is_range_partitionable<std::string> : std::true_type {};
+
+// compares the views in arrow arrays with the oids, without converting the
+// string views to `std::string`
+struct oid_view_less {
+  template <typename T>
+  bool operator()(const T& view, const T& oid) const {
+    return view < oid;
+  }
+
+  template <typename VIEW_T>
+  bool operator()(const VIEW_T& view, const std::string& oid) const {
+    return oid.compare(0, oid.size(), view.data(), view.size()) > 0;
+  }
+};
+
+}  // namespace detail
+
+/**
+ * @brief SegmentedPartitioner cuts the oid list into `fnum` consecutive
+ * segments, of the same number of vertices, or of balanced weights.
+ *
+ * When the oids are sortable and the value ranges of the segments don't
+ * overlap, e.g., the oid list is sorted, only the split points between the
+ * segments are kept, and `GetPartitionId` is a binary search over them.
+ * Otherwise, it falls back to a hash map from every oid to its fragment.
+ */
 template <typename OID_T>
 class SegmentedPartitioner {
  public:
@@ -149,23 +339,90 @@ class SegmentedPartitioner {
   SegmentedPartitioner() : fnum_(1) {}
 
   void Init(fid_t fnum, const std::vector<OID_T>& oid_list) {
-    fnum_ = fnum;
     size_t vnum = oid_list.size();
-    size_t frag_vnum = (vnum + fnum_ - 1) / fnum_;
-    o2f_.reserve(vnum);
-    for (size_t i = 0; i < vnum; ++i) {
-      fid_t fid = static_cast<fid_t>(i / frag_vnum);
-      o2f_.emplace(oid_list[i], fid);
+    size_t frag_vnum = (vnum + fnum - 1) / fnum;
+    std::vector<size_t> cuts(fnum + 1);
+    for (fid_t fid = 0; fid <= fnum; ++fid) {
+      cuts[fid] = std::min(static_cast<size_t>(fid) * frag_vnum, vnum);
+    }
+    initSegments(fnum, oid_list, cuts);
+  }
+
+  /**
+   * @brief Cut the oid list into segments of balanced total weights rather
+   * than of the same number of vertices, e.g., the degree of the vertices to
+   * balance the edges of fragments.
+   */
+  void Init(fid_t fnum, const std::vector<OID_T>& oid_list,
+            const std::vector<uint64_t>& weights) {
+    size_t vnum = oid_list.size();
+    uint64_t total = 0;
+    for (auto weight : weights) {
+      total += weight;
     }
+    std::vector<size_t> cuts(fnum + 1, vnum);
+    cuts[0] = 0;
+    uint64_t accumulated = 0;
+    fid_t fid = 1;
+    for (size_t i = 0; i < vnum && fid < fnum; ++i) {
+      accumulated += weights[i];
+      // cut after the vertex that reaches the share of the fragment
+      while (fid < fnum && accumulated * fnum >= total * fid) {
+        cuts[fid++] = i + 1;
+      }
+    }
+    initSegments(fnum, oid_list, cuts);
   }
 
-  inline fid_t GetPartitionId(const OID_T& oid) const { return o2f_.at(oid); }
+  fid_t fnum() const { return fnum_; }
+
+  /**
+   * @brief The sorted split points between the segments, where the oids in
+   * `[splits[k - 1], splits[k])` belong to the fragment `split_fids[k]`. Both
+   * are empty if the partitioner falls back to the hash map.
+   */
+  const std::vector<OID_T>& splits() const { return splits_; }
+
+  const std::vector<fid_t>& split_fids() const { return split_fids_; }
+
+  inline fid_t GetPartitionId(const OID_T& oid) const {
+    if (!split_fids_.empty()) {
+      size_t index = std::upper_bound(splits_.begin(), splits_.end(), oid) -
+                     splits_.begin();
+      return split_fids_[index];
+    }
+    return o2f_.at(oid);
+  }
+
+  /**
+   * @brief Partition the oids in an arrow array in a batch, the views of the
+   * array are searched in the split points directly.
+   */
+  template <typename ARRAY_T>
+  void GetPartitionIds(const ARRAY_T& array, fid_t* out) const {
+    int64_t length = array.length();
+    if (split_fids_.empty()) {
+      for (int64_t i = 0; i < length; ++i) {
+        out[i] = o2f_.at(OID_T(array.GetView(i)));
+      }
+      return;
+    }
+    for (int64_t i = 0; i < length; ++i) {
+      auto view = array.GetView(i);
+      size_t index = std::upper_bound(splits_.begin(), splits_.end(), view,
+                                      detail::oid_view_less{}) -
+                     splits_.begin();
+      out[i] = split_fids_[index];
+    }
+  }
 
   SegmentedPartitioner& operator=(const SegmentedPartitioner& other) {
     if (this == &other) {
       return *this;
     }
     fnum_ = other.fnum_;
+    splits_ = other.splits_;
+    split_fids_ = other.split_fids_;
     o2f_ = other.o2f_;
     return *this;
   }
@@ -175,12 +432,83 @@ class SegmentedPartitioner {
       return *this;
     }
     fnum_ = other.fnum_;
+    splits_ = std::move(other.splits_);
+    split_fids_ = std::move(other.split_fids_);
     o2f_ = std::move(other.o2f_);
     return *this;
   }
 
  private:
+  void initSegments(fid_t fnum, const std::vector<OID_T>& oid_list,
+                    const std::vector<size_t>& cuts) {
+    fnum_ = fnum;
+    splits_.clear();
+    split_fids_.clear();
+    o2f_.clear();
+    if (initRanges(oid_list, cuts, detail::is_range_partitionable<OID_T>{})) {
+      return;
+    }
+    o2f_.reserve(oid_list.size());
+    for (fid_t fid = 0; fid < fnum_; ++fid) {
+      for (size_t i = cuts[fid]; i < cuts[fid + 1]; ++i) {
+        o2f_.emplace(oid_list[i], fid);
+      }
+    }
+  }
+
+  bool initRanges(const std::vector<OID_T>&, const std::vector<size_t>&,
+                  std::false_type) {
+    return false;
+  }
+
+  bool initRanges(const std::vector<OID_T>& oid_list,
+                  const std::vector<size_t>& cuts, std::true_type) {
+    if (oid_list.empty()) {
+      return false;
+    }
+    // the positions of the minimum and maximum oid of every segment
+    struct segment_t {
+      size_t min, max;
+      fid_t fid;
+    };
+    std::vector<segment_t> segments;
+    for (fid_t fid = 0; fid < fnum_; ++fid) {
+      size_t begin = cuts[fid], end = cuts[fid + 1];
+      if (begin == end) {
+        continue;
+      }
+      segment_t segment{begin, begin, fid};
+      for (size_t i = begin + 1; i < end; ++i) {
+        if (oid_list[i] < oid_list[segment.min]) {
+          segment.min = i;
+        } else if (oid_list[segment.max] < oid_list[i]) {
+          segment.max = i;
+        }
+      }
+      segments.push_back(segment);
+    }
+    std::sort(segments.begin(), segments.end(),
+              [&oid_list](const segment_t& lhs, const segment_t& rhs) {
+                return oid_list[lhs.min] < oid_list[rhs.min];
+              });
+    for (size_t i = 1; i < segments.size(); ++i) {
+      if (!(oid_list[segments[i - 1].max] < oid_list[segments[i].min])) {
+        return false;
+      }
+    }
+    split_fids_.push_back(segments[0].fid);
+    for (size_t i = 1; i < segments.size(); ++i) {
+      splits_.push_back(oid_list[segments[i].min]);
+      split_fids_.push_back(segments[i].fid);
+    }
+    return true;
+  }
+
   fid_t fnum_;
+  // the minimum oid of every segment but the first, in ascending order, and
+  // the fragment of the oids that fall in between.
+  std::vector<OID_T> splits_;
+  std::vector<fid_t> split_fids_;
   ska::flat_hash_map<OID_T, fid_t> o2f_;
 };
 
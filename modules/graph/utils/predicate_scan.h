@@ -0,0 +1,440 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_PREDICATE_SCAN_H_
+#define MODULES_GRAPH_UTILS_PREDICATE_SCAN_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "arrow/api.h"
+
+namespace vineyard {
+
+/**
+ * Predicate scans over the columns of vertex tables, which evaluate a
+ * predicate on a contiguous run of values and produce a selection bitmap,
+ * i.e., the bit `i % 64` of the word `i / 64` is set if the i-th value is
+ * selected. The bitmap of `n` values has `bitmap_words(n)` words.
+ *
+ * The range predicates of numeric values are inclusive on both sides, and
+ * are evaluated 64 values at a time with the AVX2 (`int32_t`, `int64_t`,
+ * `float` and `double`) or AVX-512 (plus `uint32_t` and `uint64_t`) compare
+ * instructions, if the target supports them. Otherwise, and for the tails,
+ * the values are compared one by one. The NaNs are never selected.
+ *
+ * The dictionary-encoded strings are compared by their indices: the
+ * predicate is evaluated once per dictionary entry, and the indices are then
+ * compared as integers.
+ */
+namespace scan {
+
+inline size_t bitmap_words(size_t n) { return (n + 63) / 64; }
+
+namespace detail {
+
+template <typename T>
+inline uint64_t range_word_scalar(const T* data, size_t n, T lower, T upper) {
+  uint64_t word = 0;
+  for (size_t k = 0; k < n; ++k) {
+    word |= static_cast<uint64_t>(lower <= data[k] && data[k] <= upper) << k;
+  }
+  return word;
+}
+
+// the selection of 64 values
+template <typename T>
+inline uint64_t range_word(const T* data, T lower, T upper) {
+  return range_word_scalar(data, 64, lower, upper);
+}
+
+#if defined(__AVX512F__)
+inline uint64_t range_word(const int32_t* data, int32_t lower,
+                           int32_t upper) {
+  const __m512i lo = _mm512_set1_epi32(lower), hi = _mm512_set1_epi32(upper);
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 16) {
+    const __m512i x = _mm512_loadu_si512(data + k);
+    const __mmask16 mask = _mm512_cmp_epi32_mask(x, lo, _MM_CMPINT_NLT) &
+                           _mm512_cmp_epi32_mask(x, hi, _MM_CMPINT_LE);
+    word |= static_cast<uint64_t>(mask) << k;
+  }
+  return word;
+}
+
+inline uint64_t range_word(const uint32_t* data, uint32_t lower,
+                           uint32_t upper) {
+  const __m512i lo = _mm512_set1_epi32(static_cast<int32_t>(lower)),
+                hi = _mm512_set1_epi32(static_cast<int32_t>(upper));
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 16) {
+    const __m512i x = _mm512_loadu_si512(data + k);
+    const __mmask16 mask = _mm512_cmp_epu32_mask(x, lo, _MM_CMPINT_NLT) &
+                           _mm512_cmp_epu32_mask(x, hi, _MM_CMPINT_LE);
+    word |= static_cast<uint64_t>(mask) << k;
+  }
+  return word;
+}
+
+inline uint64_t range_word(const int64_t* data, int64_t lower,
+                           int64_t upper) {
+  const __m512i lo = _mm512_set1_epi64(lower), hi = _mm512_set1_epi64(upper);
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 8) {
+    const __m512i x = _mm512_loadu_si512(data + k);
+    const __mmask8 mask = _mm512_cmp_epi64_mask(x, lo, _MM_CMPINT_NLT) &
+                          _mm512_cmp_epi64_mask(x, hi, _MM_CMPINT_LE);
+    word |= static_cast<uint64_t>(mask) << k;
+  }
+  return word;
+}
+
+inline uint64_t range_word(const uint64_t* data, uint64_t lower,
+                           uint64_t upper) {
+  const __m512i lo = _mm512_set1_epi64(static_cast<int64_t>(lower)),
+                hi = _mm512_set1_epi64(static_cast<int64_t>(upper));
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 8) {
+    const __m512i x = _mm512_loadu_si512(data + k);
+    const __mmask8 mask = _mm512_cmp_epu64_mask(x, lo, _MM_CMPINT_NLT) &
+                          _mm512_cmp_epu64_mask(x, hi, _MM_CMPINT_LE);
+    word |= static_cast<uint64_t>(mask) << k;
+  }
+  return word;
+}
+
+inline uint64_t range_word(const float* data, float lower, float upper) {
+  const __m512 lo = _mm512_set1_ps(lower), hi = _mm512_set1_ps(upper);
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 16) {
+    const __m512 x = _mm512_loadu_ps(data + k);
+    const __mmask16 mask = _mm512_cmp_ps_mask(x, lo, _CMP_GE_OQ) &
+                           _mm512_cmp_ps_mask(x, hi, _CMP_LE_OQ);
+    word |= static_cast<uint64_t>(mask) << k;
+  }
+  return word;
+}
+
+inline uint64_t range_word(const double* data, double lower, double upper) {
+  const __m512d lo = _mm512_set1_pd(lower), hi = _mm512_set1_pd(upper);
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 8) {
+    const __m512d x = _mm512_loadu_pd(data + k);
+    const __mmask8 mask = _mm512_cmp_pd_mask(x, lo, _CMP_GE_OQ) &
+                          _mm512_cmp_pd_mask(x, hi, _CMP_LE_OQ);
+    word |= static_cast<uint64_t>(mask) << k;
+  }
+  return word;
+}
+#elif defined(__AVX2__)
+// the integers are selected unless `lower > x || x > upper`
+inline uint64_t range_word(const int32_t* data, int32_t lower,
+                           int32_t upper) {
+  const __m256i lo = _mm256_set1_epi32(lower), hi = _mm256_set1_epi32(upper);
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 8) {
+    const __m256i x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + k));
+    const __m256i out =
+        _mm256_or_si256(_mm256_cmpgt_epi32(lo, x), _mm256_cmpgt_epi32(x, hi));
+    uint64_t mask = _mm256_movemask_ps(_mm256_castsi256_ps(out)) ^ 0xFF;
+    word |= mask << k;
+  }
+  return word;
+}
+
+inline uint64_t range_word(const int64_t* data, int64_t lower,
+                           int64_t upper) {
+  const __m256i lo = _mm256_set1_epi64x(lower),
+                hi = _mm256_set1_epi64x(upper);
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 4) {
+    const __m256i x =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + k));
+    const __m256i out =
+        _mm256_or_si256(_mm256_cmpgt_epi64(lo, x), _mm256_cmpgt_epi64(x, hi));
+    uint64_t mask = _mm256_movemask_pd(_mm256_castsi256_pd(out)) ^ 0xF;
+    word |= mask << k;
+  }
+  return word;
+}
+
+inline uint64_t range_word(const float* data, float lower, float upper) {
+  const __m256 lo = _mm256_set1_ps(lower), hi = _mm256_set1_ps(upper);
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 8) {
+    const __m256 x = _mm256_loadu_ps(data + k);
+    const __m256 in = _mm256_and_ps(_mm256_cmp_ps(x, lo, _CMP_GE_OQ),
+                                    _mm256_cmp_ps(x, hi, _CMP_LE_OQ));
+    word |= static_cast<uint64_t>(_mm256_movemask_ps(in)) << k;
+  }
+  return word;
+}
+
+inline uint64_t range_word(const double* data, double lower, double upper) {
+  const __m256d lo = _mm256_set1_pd(lower), hi = _mm256_set1_pd(upper);
+  uint64_t word = 0;
+  for (size_t k = 0; k < 64; k += 4) {
+    const __m256d x = _mm256_loadu_pd(data + k);
+    const __m256d in = _mm256_and_pd(_mm256_cmp_pd(x, lo, _CMP_GE_OQ),
+                                     _mm256_cmp_pd(x, hi, _CMP_LE_OQ));
+    word |= static_cast<uint64_t>(_mm256_movemask_pd(in)) << k;
+  }
+  return word;
+}
+#endif
+
+template <typename T>
+inline void range_impl(const T* data, size_t n, T lower, T upper,
+                       uint64_t* bitmap) {
+  size_t full = n / 64;
+  for (size_t w = 0; w < full; ++w) {
+    bitmap[w] = range_word(data + w * 64, lower, upper);
+  }
+  if (n % 64 != 0) {
+    bitmap[full] = range_word_scalar(data + full * 64, n % 64, lower, upper);
+  }
+}
+
+// evaluates `func(index)` on the integral indices of the dictionary array.
+template <typename FUNC_T>
+inline bool visit_indices(const arrow::Array& indices, const FUNC_T& func) {
+  switch (indices.type_id()) {
+  case arrow::Type::INT8:
+    func(static_cast<const arrow::Int8Array&>(indices).raw_values());
+    return true;
+  case arrow::Type::UINT8:
+    func(static_cast<const arrow::UInt8Array&>(indices).raw_values());
+    return true;
+  case arrow::Type::INT16:
+    func(static_cast<const arrow::Int16Array&>(indices).raw_values());
+    return true;
+  case arrow::Type::UINT16:
+    func(static_cast<const arrow::UInt16Array&>(indices).raw_values());
+    return true;
+  case arrow::Type::INT32:
+    func(static_cast<const arrow::Int32Array&>(indices).raw_values());
+    return true;
+  case arrow::Type::UINT32:
+    func(static_cast<const arrow::UInt32Array&>(indices).raw_values());
+    return true;
+  case arrow::Type::INT64:
+    func(static_cast<const arrow::Int64Array&>(indices).raw_values());
+    return true;
+  case arrow::Type::UINT64:
+    func(static_cast<const arrow::UInt64Array&>(indices).raw_values());
+    return true;
+  default:
+    return false;
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Select the values of `data[0, n)` in `[lower, upper]`.
+ */
+template <typename T>
+inline void range(const T* data, size_t n, T lower, T upper,
+                  uint64_t* bitmap) {
+  detail::range_impl(data, n, lower, upper, bitmap);
+}
+
+/**
+ * @brief Select the values of `data[0, n)` that equal to `value`.
+ */
+template <typename T>
+inline void equal(const T* data, size_t n, T value, uint64_t* bitmap) {
+  detail::range_impl(data, n, value, value, bitmap);
+}
+
+/**
+ * @brief Select the values of `array[offset, offset + n)` in `[lower, end)`,
+ * where the array is either a `utf8` array or a dictionary array of `utf8`
+ * values, and an empty bound means unbounded.
+ *
+ * @return false if the type of the array isn't supported.
+ */
+inline bool string_range(const arrow::Array& array, int64_t offset, size_t n,
+                         const std::string& lower, const std::string& end,
+                         uint64_t* bitmap) {
+  auto selected = [&](arrow::util::string_view value) {
+    return (lower.empty() || value >= lower) && (end.empty() || value < end);
+  };
+  std::fill(bitmap, bitmap + bitmap_words(n), 0);
+  if (array.type_id() == arrow::Type::STRING) {
+    auto const& strings = static_cast<const arrow::StringArray&>(array);
+    for (size_t k = 0; k < n; ++k) {
+      if (selected(strings.GetView(offset + k))) {
+        bitmap[k / 64] |= static_cast<uint64_t>(1) << (k % 64);
+      }
+    }
+    return true;
+  }
+  if (array.type_id() != arrow::Type::DICTIONARY) {
+    return false;
+  }
+  auto const& dict_array = static_cast<const arrow::DictionaryArray&>(array);
+  auto dictionary =
+      std::dynamic_pointer_cast<arrow::StringArray>(dict_array.dictionary());
+  if (dictionary == nullptr) {
+    return false;
+  }
+  // evaluates the predicate once for every entry of the dictionary
+  std::vector<uint8_t> entries(dictionary->length());
+  for (int64_t i = 0; i < dictionary->length(); ++i) {
+    entries[i] = selected(dictionary->GetView(i));
+  }
+  return detail::visit_indices(*dict_array.indices(), [&](auto indices) {
+    indices += offset;
+    for (size_t k = 0; k < n; ++k) {
+      bitmap[k / 64] |= static_cast<uint64_t>(entries[indices[k]]) << (k % 64);
+    }
+  });
+}
+
+/**
+ * @brief Select the values of `array[offset, offset + n)` that equal to
+ * `value`, where the array is either a `utf8` array or a dictionary array of
+ * `utf8` values. The indices of the dictionary array are compared with the
+ * index of the value in the dictionary by `equal`.
+ *
+ * @return false if the type of the array isn't supported.
+ */
+inline bool string_equal(const arrow::Array& array, int64_t offset, size_t n,
+                         const std::string& value, uint64_t* bitmap) {
+  if (array.type_id() != arrow::Type::DICTIONARY) {
+    if (array.type_id() != arrow::Type::STRING) {
+      return false;
+    }
+    auto const& strings = static_cast<const arrow::StringArray&>(array);
+    std::fill(bitmap, bitmap + bitmap_words(n), 0);
+    for (size_t k = 0; k < n; ++k) {
+      if (strings.GetView(offset + k) == value) {
+        bitmap[k / 64] |= static_cast<uint64_t>(1) << (k % 64);
+      }
+    }
+    return true;
+  }
+  auto const& dict_array = static_cast<const arrow::DictionaryArray&>(array);
+  auto dictionary =
+      std::dynamic_pointer_cast<arrow::StringArray>(dict_array.dictionary());
+  if (dictionary == nullptr) {
+    return false;
+  }
+  int64_t index = -1;
+  for (int64_t i = 0; i < dictionary->length(); ++i) {
+    if (dictionary->GetView(i) == value) {
+      index = i;
+      break;
+    }
+  }
+  if (index == -1) {
+    std::fill(bitmap, bitmap + bitmap_words(n), 0);
+    return true;
+  }
+  return detail::visit_indices(*dict_array.indices(), [&](auto indices) {
+    using index_t = typename std::remove_const<
+        typename std::remove_pointer<decltype(indices)>::type>::type;
+    equal<index_t>(indices + offset, n, static_cast<index_t>(index), bitmap);
+  });
+}
+
+/**
+ * @brief Clear the bits of the null values of `array[offset, offset + n)`.
+ */
+inline void clear_nulls(const arrow::Array& array, int64_t offset, size_t n,
+                        uint64_t* bitmap) {
+  if (array.null_count() == 0) {
+    return;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    if (array.IsNull(offset + k)) {
+      bitmap[k / 64] &= ~(static_cast<uint64_t>(1) << (k % 64));
+    }
+  }
+}
+
+/**
+ * @brief The number of the selected values.
+ */
+inline size_t count(const uint64_t* bitmap, size_t n) {
+  size_t num = 0;
+  for (size_t w = 0; w < bitmap_words(n); ++w) {
+    num += __builtin_popcountll(bitmap[w]);
+  }
+  return num;
+}
+
+/**
+ * @brief Call `func(i)` for the selected values in order.
+ */
+template <typename FUNC_T>
+inline void for_each_selected(const uint64_t* bitmap, size_t n,
+                              const FUNC_T& func) {
+  for (size_t w = 0; w < bitmap_words(n); ++w) {
+    uint64_t word = bitmap[w];
+    while (word != 0) {
+      func(w * 64 + __builtin_ctzll(word));
+      word &= word - 1;
+    }
+  }
+}
+
+/**
+ * @brief Call `func(begin, end)` for the maximal runs of the selected values
+ * in order, which is cheaper than `for_each_selected` for selective ranges.
+ */
+template <typename FUNC_T>
+inline void for_each_selected_range(const uint64_t* bitmap, size_t n,
+                                    const FUNC_T& func) {
+  size_t begin = 0;
+  bool in_run = false;
+  for (size_t w = 0; w < bitmap_words(n); ++w) {
+    uint64_t word = bitmap[w];
+    if (word == (in_run ? ~static_cast<uint64_t>(0) : 0)) {
+      continue;
+    }
+    for (size_t k = 0; k < 64 && w * 64 + k < n; ++k) {
+      bool bit = (word >> k) & 1;
+      if (bit != in_run) {
+        if (in_run) {
+          func(begin, w * 64 + k);
+        } else {
+          begin = w * 64 + k;
+        }
+        in_run = bit;
+      }
+    }
+  }
+  if (in_run) {
+    func(begin, n);
+  }
+}
+
+}  // namespace scan
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_PREDICATE_SCAN_H_
@@ -20,6 +20,7 @@ limitations under the License.
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -34,6 +35,7 @@ limitations under the License.
 #include "grape/worker/comm_spec.h"
 
 #include "graph/fragment/property_graph_types.h"
+#include "graph/utils/thread_group.h"
 
 namespace vineyard {
 
@@ -258,6 +260,11 @@ inline bool parse_add_column_selectors(
   return true;
 }
 
+/**
+ * @brief Gather the archives (from the offset `from`) of all workers to the
+ * archive of the worker of fragment 0, the archives of the other workers are
+ * received concurrently, into their own offsets of the archive.
+ */
 inline void gather_archives(grape::InArchive& arc,
                             const grape::CommSpec& comm_spec, size_t from = 0) {
   if (comm_spec.fid() == 0) {
@@ -271,13 +278,23 @@ inline void gather_archives(grape::InArchive& arc,
     }
     size_t old_length = arc.GetSize();
     arc.Resize(old_length + total_length);
-    char* ptr = arc.GetBuffer() + static_cast<ptrdiff_t>(old_length);
-
-    for (grape::fid_t i = 1; i < comm_spec.fnum(); ++i) {
-      grape::recv_buffer<char>(ptr, static_cast<size_t>(gathered_length[i]),
-                               comm_spec.FragToWorker(i), comm_spec.comm(), 0);
-      ptr += static_cast<ptrdiff_t>(gathered_length[i]);
+    std::vector<size_t> offsets(comm_spec.fnum(), old_length);
+    for (grape::fid_t i = 2; i < comm_spec.fnum(); ++i) {
+      offsets[i] = offsets[i - 1] + static_cast<size_t>(gathered_length[i - 1]);
     }
+
+    char* base = arc.GetBuffer();
+    ThreadPool::Default().ParallelFor(
+        comm_spec.fnum() - 1,
+        [&](size_t, size_t begin, size_t end) {
+          for (size_t i = begin + 1; i < end + 1; ++i) {
+            grape::recv_buffer<char>(
+                base + static_cast<ptrdiff_t>(offsets[i]),
+                static_cast<size_t>(gathered_length[i]),
+                comm_spec.FragToWorker(i), comm_spec.comm(), 0);
+          }
+        },
+        static_cast<int>(std::thread::hardware_concurrency()), 1);
   } else {
     auto local_length = static_cast<int64_t>(arc.GetSize() - from);
     MPI_Gather(&local_length, 1, MPI_INT64_T, NULL, 1, MPI_INT64_T,
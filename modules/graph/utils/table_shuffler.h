@@ -18,9 +18,12 @@ limitations under the License.
 
 #include <mpi.h>
 
+#include <algorithm>
+#include <functional>
 #include <future>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -95,18 +98,22 @@ inline void SendArrowBuffer(const std::shared_ptr<arrow::Buffer>& buffer,
   }
 }
 
-inline Status RecvArrowBuffer(std::shared_ptr<arrow::Buffer>& buffer,
-                              int src_worker_id, MPI_Comm comm, int tag = 0) {
-  int64_t size;
-  MPI_Recv(&size, 1, MPI_INT64_T, src_worker_id, tag, comm, MPI_STATUS_IGNORE);
-
+inline Status AllocateArrowBuffer(int64_t size, arrow::MemoryPool* pool,
+                                  std::shared_ptr<arrow::Buffer>& buffer) {
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
-  RETURN_ON_ARROW_ERROR(
-      arrow::AllocateBuffer(arrow::default_memory_pool(), size, &buffer));
+  RETURN_ON_ARROW_ERROR(arrow::AllocateBuffer(pool, size, &buffer));
 #else
-  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
-      buffer, arrow::AllocateBuffer(size, arrow::default_memory_pool()));
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(buffer, arrow::AllocateBuffer(size, pool));
 #endif
+  return Status::OK();
+}
+
+inline Status RecvArrowBuffer(
+    std::shared_ptr<arrow::Buffer>& buffer, int src_worker_id, MPI_Comm comm,
+    int tag = 0, arrow::MemoryPool* pool = arrow::default_memory_pool()) {
+  int64_t size;
+  MPI_Recv(&size, 1, MPI_INT64_T, src_worker_id, tag, comm, MPI_STATUS_IGNORE);
+  RETURN_ON_ERROR(AllocateArrowBuffer(size, pool, buffer));
 
   if (size != 0) {
     recv_buffer<uint8_t>(buffer->mutable_data(), size, src_worker_id, comm,
@@ -125,26 +132,57 @@ inline Status send_numeric_array(
   return Status::OK();
 }
 
+/**
+ * The offsets and the data of string arrays are sent as they are, and the
+ * arrays that have nulls are sent as serialized record batches.
+ */
 template <>
 inline Status send_numeric_array<std::string>(
     const std::shared_ptr<arrow::StringArray>& array, int dst_worker_id,
     MPI_Comm comm, int tag) {
-  auto batch =
-      ArrayToRecordBatch(std::dynamic_pointer_cast<arrow::Array>(array));
-  std::shared_ptr<arrow::Buffer> buffer;
-  RETURN_ON_ERROR(SerializeRecordBatches({batch}, &buffer));
-  SendArrowBuffer(buffer, dst_worker_id, comm, tag);
+  int64_t length = array->length();
+  int32_t first = length == 0 ? 0 : array->value_offset(0);
+  int64_t header[3] = {length, 0, array->null_count() == 0};
+  if (length != 0) {
+    header[1] = array->value_offset(length) - first;
+  }
+  MPI_Send(header, 3, MPI_INT64_T, dst_worker_id, tag, comm);
+  if (!header[2]) {
+    auto batch =
+        ArrayToRecordBatch(std::dynamic_pointer_cast<arrow::Array>(array));
+    std::shared_ptr<arrow::Buffer> buffer;
+    RETURN_ON_ERROR(SerializeRecordBatches({batch}, &buffer));
+    SendArrowBuffer(buffer, dst_worker_id, comm, tag);
+    return Status::OK();
+  }
+  if (length == 0) {
+    return Status::OK();
+  }
+  if (first == 0) {
+    send_buffer<int32_t>(array->raw_value_offsets(), length + 1, dst_worker_id,
+                         comm, tag);
+  } else {
+    // the offsets of sliced arrays are rebased to zero
+    std::vector<int32_t> offsets(length + 1);
+    for (int64_t i = 0; i <= length; ++i) {
+      offsets[i] = array->value_offset(i) - first;
+    }
+    send_buffer<int32_t>(offsets.data(), length + 1, dst_worker_id, comm, tag);
+  }
+  send_buffer<uint8_t>(array->value_data()->data() + first, header[1],
+                       dst_worker_id, comm, tag);
   return Status::OK();
 }
 
 template <typename T>
 inline Status recv_numeric_array(
     std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>& array,
-    int src_worker_id, MPI_Comm comm, int tag = 0) {
+    int src_worker_id, MPI_Comm comm, int tag = 0,
+    arrow::MemoryPool* pool = arrow::default_memory_pool()) {
   size_t len;
   MPI_Recv(&len, sizeof(size_t), MPI_CHAR, src_worker_id, tag, comm,
            MPI_STATUS_IGNORE);
-  typename ConvertToArrowType<T>::BuilderType builder;
+  typename ConvertToArrowType<T>::BuilderType builder(pool);
   RETURN_ON_ARROW_ERROR(builder.Resize(len));
   recv_buffer<T>(&builder[0], len, src_worker_id, comm, tag);
   RETURN_ON_ARROW_ERROR(builder.Advance(len));
@@ -152,10 +190,35 @@ inline Status recv_numeric_array(
   return Status::OK();
 }
 
+/**
+ * The received offsets and data are adopted by the string array without
+ * parsing, and when they are allocated from a `VineyardMemoryPool`, they are
+ * further adopted by the vineyard `StringArray` that is built from the array.
+ */
 template <>
 inline Status recv_numeric_array<std::string>(
     std::shared_ptr<typename ConvertToArrowType<std::string>::ArrayType>& array,
-    int src_worker_id, MPI_Comm comm, int tag) {
+    int src_worker_id, MPI_Comm comm, int tag, arrow::MemoryPool* pool) {
+  int64_t header[3];
+  MPI_Recv(header, 3, MPI_INT64_T, src_worker_id, tag, comm,
+           MPI_STATUS_IGNORE);
+  if (header[2]) {
+    int64_t length = header[0];
+    std::shared_ptr<arrow::Buffer> offsets, data;
+    RETURN_ON_ERROR(
+        AllocateArrowBuffer((length + 1) * sizeof(int32_t), pool, offsets));
+    RETURN_ON_ERROR(AllocateArrowBuffer(header[1], pool, data));
+    if (length == 0) {
+      reinterpret_cast<int32_t*>(offsets->mutable_data())[0] = 0;
+    } else {
+      recv_buffer<int32_t>(reinterpret_cast<int32_t*>(offsets->mutable_data()),
+                           length + 1, src_worker_id, comm, tag);
+      recv_buffer<uint8_t>(data->mutable_data(), header[1], src_worker_id,
+                           comm, tag);
+    }
+    array = std::make_shared<arrow::StringArray>(length, offsets, data);
+    return Status::OK();
+  }
   std::shared_ptr<arrow::Buffer> buffer;
   RETURN_ON_ERROR(RecvArrowBuffer(buffer, src_worker_id, comm, tag));
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
@@ -167,12 +230,108 @@ inline Status recv_numeric_array<std::string>(
   return Status::OK();
 }
 
+/**
+ * @brief Gather the numeric arrays of all workers, indexed by the fragments.
+ *
+ * The lengths are exchanged first, thus the buffers of all remote arrays are
+ * allocated from the pool before any data arrives, and the data is received
+ * into them by non-blocking operations that are all posted at once, rather
+ * than a ring of blocking sends and receives that serializes the transfers.
+ * When the pool is a `VineyardMemoryPool`, the buffers are vineyard blobs and
+ * will be adopted by the vineyard arrays that are built from them, without
+ * copying.
+ *
+ * The null bitmaps are not gathered, as in `send_numeric_array`.
+ */
 template <typename T>
-Status FragmentAllGatherArray(
+Status FragmentAllGatherNumericArray(
+    const grape::CommSpec& comm_spec,
+    std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> data_in,
+    std::vector<std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>>&
+        data_out,
+    arrow::MemoryPool* pool = arrow::default_memory_pool()) {
+  static_assert(std::is_arithmetic<T>::value,
+                "Only numeric arrays can be gathered into the buffers");
+  using array_t = typename ConvertToArrowType<T>::ArrayType;
+  int worker_id = comm_spec.worker_id();
+  int worker_num = comm_spec.worker_num();
+  MPI_Comm comm = comm_spec.comm();
+
+  int64_t length = data_in->length();
+  std::vector<int64_t> lengths(worker_num);
+  MPI_Allgather(&length, 1, MPI_INT64_T, lengths.data(), 1, MPI_INT64_T,
+                comm);
+
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers(worker_num);
+  for (int i = 0; i < worker_num; ++i) {
+    if (i != worker_id) {
+      RETURN_ON_ERROR(
+          AllocateArrowBuffer(lengths[i] * sizeof(T), pool, buffers[i]));
+    }
+  }
+
+  // the transfers are cut into chunks, as the counts of MPI are ints
+  std::vector<MPI_Request> requests;
+  auto chunks = [](int64_t len, const std::function<void(size_t, int)>& f) {
+    for (int64_t offset = 0; offset < len; offset += chunk_size) {
+      int64_t count = std::min<int64_t>(chunk_size, len - offset);
+      f(static_cast<size_t>(offset), static_cast<int>(count * sizeof(T)));
+    }
+  };
+  for (int step = 1; step < worker_num; ++step) {
+    int src_worker_id = (worker_id + step) % worker_num;
+    T* recv_ptr = reinterpret_cast<T*>(buffers[src_worker_id]->mutable_data());
+    chunks(lengths[src_worker_id], [&](size_t offset, int bytes) {
+      requests.emplace_back();
+      MPI_Irecv(recv_ptr + offset, bytes, MPI_CHAR, src_worker_id, 0, comm,
+                &requests.back());
+    });
+  }
+  const T* send_ptr = data_in->raw_values();
+  for (int step = 1; step < worker_num; ++step) {
+    int dst_worker_id = (worker_id + worker_num - step) % worker_num;
+    chunks(length, [&](size_t offset, int bytes) {
+      requests.emplace_back();
+      MPI_Isend(send_ptr + offset, bytes, MPI_CHAR, dst_worker_id, 0, comm,
+                &requests.back());
+    });
+  }
+  if (MPI_Waitall(static_cast<int>(requests.size()), requests.data(),
+                  MPI_STATUSES_IGNORE) != MPI_SUCCESS) {
+    return Status::IOError("Failed to gather the arrays of all workers");
+  }
+
+  data_out.resize(comm_spec.fnum());
+  for (int i = 0; i < worker_num; ++i) {
+    fid_t fid = comm_spec.WorkerToFrag(i);
+    if (i == worker_id) {
+      data_out[fid] = data_in;
+    } else {
+      data_out[fid] = std::make_shared<array_t>(lengths[i], buffers[i]);
+    }
+  }
+  return Status::OK();
+}
+
+namespace detail {
+
+template <typename T>
+Status fragment_all_gather_array(
+    const grape::CommSpec& comm_spec,
+    std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> data_in,
+    std::vector<std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>>&
+        data_out,
+    arrow::MemoryPool* pool, std::true_type) {
+  return FragmentAllGatherNumericArray<T>(comm_spec, data_in, data_out, pool);
+}
+
+template <typename T>
+Status fragment_all_gather_array(
     const grape::CommSpec& comm_spec,
     std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> data_in,
     std::vector<std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>>&
-        data_out) {
+        data_out,
+    arrow::MemoryPool* pool, std::false_type) {
   int worker_id = comm_spec.worker_id();
   int worker_num = comm_spec.worker_num();
 
@@ -191,7 +350,8 @@ Status FragmentAllGatherArray(
     int src_worker_id = (worker_id + 1) % worker_num;
     while (src_worker_id != worker_id) {
       fid_t src_fid = comm_spec.WorkerToFrag(src_worker_id);
-      recv_numeric_array<T>(data_out[src_fid], src_worker_id, comm_spec.comm());
+      RETURN_ON_ERROR(recv_numeric_array<T>(data_out[src_fid], src_worker_id,
+                                            comm_spec.comm(), 0, pool));
       src_worker_id = (src_worker_id + 1) % worker_num;
     }
     data_out[comm_spec.fid()] = data_in;
@@ -212,6 +372,25 @@ Status FragmentAllGatherArray(
   return Status::OK();
 }
 
+}  // namespace detail
+
+/**
+ * @brief Gather the arrays of all workers, indexed by the fragments. The
+ * numeric arrays are gathered by `FragmentAllGatherNumericArray`, and the
+ * others by a ring of sends and receives.
+ */
+template <typename T>
+Status FragmentAllGatherArray(
+    const grape::CommSpec& comm_spec,
+    std::shared_ptr<typename ConvertToArrowType<T>::ArrayType> data_in,
+    std::vector<std::shared_ptr<typename ConvertToArrowType<T>::ArrayType>>&
+        data_out,
+    arrow::MemoryPool* pool = arrow::default_memory_pool()) {
+  return detail::fragment_all_gather_array<T>(
+      comm_spec, data_in, data_out, pool,
+      std::integral_constant<bool, std::is_arithmetic<T>::value>{});
+}
+
 template <typename PARTITIONER_T>
 Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
                                   const PARTITIONER_T& partitioner,
@@ -231,9 +410,10 @@ Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
         table_in->schema(), arrow::default_memory_pool(), 4096, &builder));
     divided_table_builders.emplace_back(std::move(builder));
   }
-  TableAppender appender(table_in->schema());
+  ColumnarTableAppender appender(table_in->schema());
   arrow::TableBatchReader tbreader(*table_in);
   std::shared_ptr<arrow::RecordBatch> batch;
+  std::vector<std::vector<int64_t>> divided_indices(fnum);
 
   while (true) {
     RETURN_ON_ARROW_ERROR(tbreader.ReadNext(&batch));
@@ -241,12 +421,17 @@ Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
       break;
     }
     auto id_col = std::dynamic_pointer_cast<oid_array_type>(batch->column(0));
-    size_t row_num = batch->num_rows();
-    for (size_t i = 0; i < row_num; ++i) {
+    int64_t row_num = batch->num_rows();
+    for (int64_t i = 0; i < row_num; ++i) {
       internal_oid_t rs = id_col->GetView(i);
       fid_t fid = partitioner.GetPartitionId(oid_t(rs));
-      RETURN_ON_ERROR(appender.Apply(divided_table_builders[fid], batch, i,
+      divided_indices[fid].push_back(i);
+    }
+    for (fid_t fid = 0; fid < fnum; ++fid) {
+      RETURN_ON_ERROR(appender.Apply(divided_table_builders[fid], batch,
+                                     divided_indices[fid],
                                      divided_records[fid]));
+      divided_indices[fid].clear();
     }
   }
 
@@ -316,6 +501,7 @@ Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
   }
   std::shared_ptr<arrow::Table> tmp_table;
   RETURN_ON_ERROR(RecordBatchesToTable(batches, &tmp_table));
+  RETURN_ON_ERROR(UnifyDictionaries(tmp_table, tmp_table));
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
   RETURN_ON_ARROW_ERROR(
       tmp_table->CombineChunks(arrow::default_memory_pool(), &table_out));
@@ -336,7 +522,7 @@ Status ShufflePropertyEdgeTable(const grape::CommSpec& comm_spec,
   std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>>
       divided_record_batches(fnum);
 
-  TableAppender appender(table_in->schema());
+  ColumnarTableAppender appender(table_in->schema());
   std::vector<std::unique_ptr<arrow::RecordBatchBuilder>>
       divided_table_builders;
 
@@ -350,9 +536,11 @@ Status ShufflePropertyEdgeTable(const grape::CommSpec& comm_spec,
   std::vector<std::shared_ptr<arrow::RecordBatch>> tmp_batch_vec;
   std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
 
+  std::vector<std::vector<int64_t>> divided_indices(fnum);
+
   RETURN_ON_ERROR(TableToRecordBatches(table_in, &record_batches));
   for (const auto& rb : record_batches) {
-    size_t row_num = rb->num_rows();
+    int64_t row_num = rb->num_rows();
     auto src_col = std::dynamic_pointer_cast<
         typename ConvertToArrowType<VID_TYPE>::ArrayType>(
         rb->column(src_col_id));
@@ -360,27 +548,24 @@ Status ShufflePropertyEdgeTable(const grape::CommSpec& comm_spec,
         typename ConvertToArrowType<VID_TYPE>::ArrayType>(
         rb->column(dst_col_id));
 
-    for (size_t i = 0; i < row_num; ++i) {
+    for (int64_t i = 0; i < row_num; ++i) {
       VID_TYPE src_gid = src_col->Value(i);
       VID_TYPE dst_gid = dst_col->Value(i);
       fid_t src_fid = id_parser.GetFid(src_gid);
       fid_t dst_fid = id_parser.GetFid(dst_gid);
-      RETURN_ON_ERROR(appender.Apply(divided_table_builders[src_fid], rb, i,
-                                     tmp_batch_vec));
+      divided_indices[src_fid].push_back(i);
+      if (src_fid != dst_fid) {
+        divided_indices[dst_fid].push_back(i);
+      }
+    }
+    for (fid_t fid = 0; fid < fnum; ++fid) {
+      RETURN_ON_ERROR(appender.Apply(divided_table_builders[fid], rb,
+                                     divided_indices[fid], tmp_batch_vec));
       if (!tmp_batch_vec.empty()) {
-        divided_record_batches[src_fid].emplace_back(
-            std::move(tmp_batch_vec[0]));
+        divided_record_batches[fid].emplace_back(std::move(tmp_batch_vec[0]));
         tmp_batch_vec.clear();
       }
-      if (src_fid != dst_fid) {
-        RETURN_ON_ERROR(appender.Apply(divided_table_builders[dst_fid], rb, i,
-                                       tmp_batch_vec));
-        if (!tmp_batch_vec.empty()) {
-          divided_record_batches[dst_fid].emplace_back(
-              std::move(tmp_batch_vec[0]));
-          tmp_batch_vec.clear();
-        }
-      }
+      divided_indices[fid].clear();
     }
   }
 
@@ -461,6 +646,7 @@ Status ShufflePropertyEdgeTable(const grape::CommSpec& comm_spec,
   } else {
     std::shared_ptr<arrow::Table> tmp_table;
     RETURN_ON_ERROR(RecordBatchesToTable(batches, &tmp_table));
+    RETURN_ON_ERROR(UnifyDictionaries(tmp_table, tmp_table));
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
     RETURN_ON_ARROW_ERROR(
         tmp_table->CombineChunks(arrow::default_memory_pool(), &table_out));
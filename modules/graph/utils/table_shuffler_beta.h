@@ -20,7 +20,10 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -39,7 +42,10 @@ limitations under the License.
 #include "grape/utils/concurrent_queue.h"
 #include "grape/worker/comm_spec.h"
 
+#include "basic/ds/arrow.h"
 #include "basic/ds/arrow_utils.h"
+#include "client/client.h"
+#include "common/util/compression.h"
 #include "graph/utils/error.h"
 
 namespace grape {
@@ -499,10 +505,310 @@ void ShuffleTableByOffsetLists(
   MPI_Barrier(comm_spec.comm());
 }
 
+/**
+ * The maximum number of rows of a chunk in the pipelined shuffle.
+ */
+static constexpr int64_t kShuffleChunkRows = 64 * 1024;
+
+/**
+ * The maximum number of serialized chunks that are queued or in flight on each
+ * direction of the pipelined shuffle.
+ */
+static constexpr size_t kShuffleInflightChunks = 16;
+
+/**
+ * The serialized chunks that are smaller than this size are sent raw without
+ * trying the compression.
+ */
+static constexpr size_t kShuffleCompressMinBytes = 16 * 1024;
+
+/**
+ * The compressed chunk is sent only if it saves at least 1 / 8 of the bytes,
+ * otherwise the raw chunk is sent, e.g., for the incompressible data.
+ */
+static constexpr size_t kShuffleCompressMinSavingShift = 3;
+
+namespace detail {
+
+// the kinds of chunks in the pipelined shuffle, i.e., the leading byte
+enum ShuffleChunkKind : uint8_t {
+  kRawRows = 0,
+  kSharedBatch = 1,
+  kCompressedRows = 2,
+};
+
+/**
+ * Replace the serialized rows in `arc` (after the leading kind byte) with the
+ * compressed ones if the compression is worthwhile.
+ */
+inline void compress_shuffle_chunk(std::string const& codec,
+                                   grape::InArchive& arc,
+                                   std::string& compressed) {
+  size_t raw_size = arc.GetSize() - sizeof(uint8_t);
+  if (codec.empty() || raw_size < kShuffleCompressMinBytes) {
+    return;
+  }
+  const uint8_t* raw =
+      reinterpret_cast<const uint8_t*>(arc.GetBuffer()) + sizeof(uint8_t);
+  if (!Compress(codec, raw, raw_size, compressed).ok() ||
+      compressed.size() >
+          raw_size - (raw_size >> kShuffleCompressMinSavingShift)) {
+    return;
+  }
+  arc.Clear();
+  arc << static_cast<uint8_t>(kCompressedRows)
+      << static_cast<uint64_t>(raw_size);
+  arc.AddBytes(compressed.data(), compressed.size());
+}
+
+}  // namespace detail
+
+/**
+ * @brief Shuffle the selected rows of the record batches like
+ * `ShuffleTableByOffsetLists`, but streams the rows to each peer as chunks of
+ * at most `chunk_rows` rows.
+ *
+ * The chunks are serialized, sent with non-blocking sends and deserialized on
+ * arrival concurrently, and the number of pending chunks in each direction is
+ * bounded by `kShuffleInflightChunks`, so the peak memory holds a few chunks
+ * rather than the serialized copy of the whole table, and the network works
+ * while the remaining rows are being serialized. An empty message marks the
+ * end of the stream to each peer.
+ *
+ * When the `client` is given, the rows to the peers that connect to the same
+ * vineyardd are sealed as vineyard record batches instead, only the object ids
+ * go through MPI, and the receivers map the record batches zero-copy. The
+ * received objects are appended to `shared_batches`, and the caller must
+ * delete them once the shuffled record batches are no longer used. It must be
+ * enabled (or disabled) on all workers together.
+ *
+ * When the `compression` codec (see `Compress()`) is given, the serialized
+ * chunks that are large enough are compressed by the serializing threads, and
+ * sent compressed only if it saves enough bytes. It must be the same on all
+ * workers.
+ *
+ * The received record batches are appended to `record_batches_in` in the order
+ * of arrival, together with the rows that stay in the local fragment.
+ */
+inline void ShuffleTableByOffsetListsPipelined(
+    std::shared_ptr<arrow::Schema> schema,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_out,
+    const std::vector<std::vector<std::vector<int64_t>>>& offset_lists,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_in,
+    const grape::CommSpec& comm_spec, Client* client = nullptr,
+    std::vector<ObjectID>* shared_batches = nullptr,
+    std::string const& compression = "",
+    int64_t chunk_rows = kShuffleChunkRows) {
+  int worker_id = comm_spec.worker_id();
+  int worker_num = comm_spec.worker_num();
+  size_t record_batches_out_num = record_batches_out.size();
+  chunk_rows = std::max<int64_t>(1, chunk_rows);
+
+  // the peers that connect to the same vineyardd as this worker
+  std::vector<bool> shared_peers(worker_num, false);
+  if (client != nullptr) {
+    CHECK(shared_batches != nullptr);
+    InstanceID instance_id = client->instance_id();
+    std::vector<InstanceID> instance_ids(worker_num);
+    MPI_Allgather(&instance_id, 1, MPI_UINT64_T, instance_ids.data(), 1,
+                  MPI_UINT64_T, comm_spec.comm());
+    for (int i = 0; i != worker_num; ++i) {
+      shared_peers[i] = i != worker_id && instance_ids[i] == instance_id;
+    }
+  }
+
+  int thread_num =
+      (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
+      comm_spec.local_num();
+  int deserialize_thread_num = std::max(1, (thread_num - 2) / 2);
+  int serialize_thread_num =
+      std::max(1, thread_num - 2 - deserialize_thread_num);
+  std::vector<std::thread> serialize_threads(serialize_thread_num);
+  std::vector<std::thread> deserialize_threads(deserialize_thread_num);
+
+  grape::BlockingQueue<std::pair<grape::fid_t, grape::InArchive>> msg_out;
+  grape::BlockingQueue<grape::OutArchive> msg_in;
+
+  msg_out.SetProducerNum(serialize_thread_num);
+  msg_out.SetLimit(kShuffleInflightChunks);
+  msg_in.SetProducerNum(1);
+  msg_in.SetLimit(kShuffleInflightChunks);
+
+  std::mutex record_batches_in_mutex;
+  auto append_record_batch = [&](std::shared_ptr<arrow::RecordBatch>&& rb) {
+    std::lock_guard<std::mutex> lock(record_batches_in_mutex);
+    record_batches_in.emplace_back(std::move(rb));
+  };
+  auto append_shared_batch = [&](std::shared_ptr<arrow::RecordBatch>&& rb,
+                                 ObjectID id) {
+    std::lock_guard<std::mutex> lock(record_batches_in_mutex);
+    record_batches_in.emplace_back(std::move(rb));
+    shared_batches->emplace_back(id);
+  };
+
+  std::thread send_thread([&]() {
+    // the archives are kept alive in the slots until their sends complete.
+    std::vector<std::pair<grape::fid_t, grape::InArchive>> slots(
+        kShuffleInflightChunks);
+    std::vector<MPI_Request> requests(kShuffleInflightChunks,
+                                      MPI_REQUEST_NULL);
+    size_t used_slots = 0;
+    while (true) {
+      int slot;
+      if (used_slots < kShuffleInflightChunks) {
+        slot = static_cast<int>(used_slots++);
+      } else {
+        MPI_Waitany(static_cast<int>(requests.size()), requests.data(), &slot,
+                    MPI_STATUS_IGNORE);
+      }
+      if (!msg_out.Get(slots[slot])) {
+        break;
+      }
+      auto& arc = slots[slot].second;
+      CHECK_LE(arc.GetSize(),
+               static_cast<size_t>(std::numeric_limits<int>::max()));
+      MPI_Isend(arc.GetBuffer(), static_cast<int>(arc.GetSize()), MPI_CHAR,
+                comm_spec.FragToWorker(slots[slot].first), 0, comm_spec.comm(),
+                &requests[slot]);
+    }
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(),
+                MPI_STATUSES_IGNORE);
+    for (int i = 1; i != worker_num; ++i) {
+      int dst_worker_id = (worker_id + i) % worker_num;
+      MPI_Send(NULL, 0, MPI_CHAR, dst_worker_id, 0, comm_spec.comm());
+    }
+  });
+
+  std::thread recv_thread([&]() {
+    int remaining_peers = worker_num - 1;
+    while (remaining_peers != 0) {
+      MPI_Status status;
+      MPI_Probe(MPI_ANY_SOURCE, 0, comm_spec.comm(), &status);
+      int length = 0;
+      MPI_Get_count(&status, MPI_CHAR, &length);
+      if (length == 0) {
+        MPI_Recv(NULL, 0, MPI_CHAR, status.MPI_SOURCE, 0, comm_spec.comm(),
+                 MPI_STATUS_IGNORE);
+        --remaining_peers;
+        continue;
+      }
+      grape::OutArchive arc(length);
+      MPI_Recv(arc.GetBuffer(), length, MPI_CHAR, status.MPI_SOURCE, 0,
+               comm_spec.comm(), MPI_STATUS_IGNORE);
+      msg_in.Put(std::move(arc));
+    }
+    msg_in.DecProducerNum();
+  });
+
+  std::atomic<size_t> cur_batch_out(0);
+  for (int i = 0; i != serialize_thread_num; ++i) {
+    serialize_threads[i] = std::thread([&]() {
+      std::vector<int64_t> chunk_offsets;
+      std::string compressed;
+      while (true) {
+        size_t got_batch = cur_batch_out.fetch_add(1);
+        if (got_batch >= record_batches_out_num) {
+          break;
+        }
+        auto cur_rb = record_batches_out[got_batch];
+        auto& cur_offset_lists = offset_lists[got_batch];
+
+        for (int i = 1; i != worker_num; ++i) {
+          int dst_worker_id = (worker_id + i) % worker_num;
+          grape::fid_t dst_fid = comm_spec.WorkerToFrag(dst_worker_id);
+          auto& offsets = cur_offset_lists[dst_fid];
+          if (shared_peers[dst_worker_id]) {
+            if (offsets.empty()) {
+              continue;
+            }
+            std::shared_ptr<arrow::RecordBatch> rb;
+            SelectRows(cur_rb, offsets, rb);
+            RecordBatchBuilder builder(*client, rb);
+            std::pair<grape::fid_t, grape::InArchive> item;
+            item.first = dst_fid;
+            item.second << static_cast<uint8_t>(detail::kSharedBatch)
+                        << builder.Seal(*client)->id();
+            msg_out.Put(std::move(item));
+            continue;
+          }
+          for (size_t begin = 0; begin < offsets.size(); begin += chunk_rows) {
+            size_t end = std::min(offsets.size(), begin + chunk_rows);
+            chunk_offsets.assign(offsets.begin() + begin,
+                                 offsets.begin() + end);
+            std::pair<grape::fid_t, grape::InArchive> item;
+            item.first = dst_fid;
+            item.second << static_cast<uint8_t>(detail::kRawRows);
+            SerializeSelectedRows(item.second, cur_rb, chunk_offsets);
+            detail::compress_shuffle_chunk(compression, item.second,
+                                           compressed);
+            msg_out.Put(std::move(item));
+          }
+        }
+
+        std::shared_ptr<arrow::RecordBatch> rb;
+        SelectRows(cur_rb, cur_offset_lists[comm_spec.fid()], rb);
+        append_record_batch(std::move(rb));
+      }
+      msg_out.DecProducerNum();
+    });
+  }
+
+  for (int i = 0; i != deserialize_thread_num; ++i) {
+    deserialize_threads[i] = std::thread([&]() {
+      grape::OutArchive arc;
+      while (msg_in.Get(arc)) {
+        uint8_t kind = detail::kRawRows;
+        arc >> kind;
+        if (kind == detail::kSharedBatch) {
+          ObjectID id = InvalidObjectID();
+          arc >> id;
+          auto batch = std::dynamic_pointer_cast<RecordBatch>(
+              client->GetObject(id));
+          CHECK(batch != nullptr);
+          auto rb = batch->GetRecordBatch();
+          append_shared_batch(
+              arrow::RecordBatch::Make(schema, rb->num_rows(), rb->columns()),
+              id);
+        } else if (kind == detail::kCompressedRows) {
+          uint64_t raw_size = 0;
+          arc >> raw_size;
+          size_t compressed_size = arc.GetSize();
+          grape::OutArchive raw(raw_size);
+          VINEYARD_CHECK_OK(Decompress(
+              compression,
+              reinterpret_cast<const uint8_t*>(arc.GetBytes(compressed_size)),
+              compressed_size, reinterpret_cast<uint8_t*>(raw.GetBuffer()),
+              raw_size));
+          std::shared_ptr<arrow::RecordBatch> rb;
+          DeserializeSelectedRows(raw, schema, rb);
+          append_record_batch(std::move(rb));
+        } else {
+          std::shared_ptr<arrow::RecordBatch> rb;
+          DeserializeSelectedRows(arc, schema, rb);
+          append_record_batch(std::move(rb));
+        }
+      }
+    });
+  }
+
+  send_thread.join();
+  recv_thread.join();
+  for (auto& thrd : serialize_threads) {
+    thrd.join();
+  }
+  for (auto& thrd : deserialize_threads) {
+    thrd.join();
+  }
+
+  MPI_Barrier(comm_spec.comm());
+}
+
 template <typename VID_TYPE>
 boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
     const grape::CommSpec& comm_spec, IdParser<VID_TYPE>& id_parser,
-    int src_col_id, int dst_col_id, std::shared_ptr<arrow::Table>& table_in) {
+    int src_col_id, int dst_col_id, std::shared_ptr<arrow::Table>& table_in,
+    Client* client = nullptr, std::vector<ObjectID>* shared_batches = nullptr,
+    std::string const& compression = "") {
   BOOST_LEAF_CHECK(SchemaConsistent(*table_in->schema(), comm_spec));
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
@@ -562,8 +868,9 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
 
-  ShuffleTableByOffsetLists(table_in->schema(), record_batches, offset_lists,
-                            batches_in, comm_spec);
+  ShuffleTableByOffsetListsPipelined(table_in->schema(), record_batches,
+                                     offset_lists, batches_in, comm_spec,
+                                     client, shared_batches, compression);
 
   batches_in.erase(std::remove_if(batches_in.begin(), batches_in.end(),
                                   [](std::shared_ptr<arrow::RecordBatch>& e) {
@@ -592,9 +899,10 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
 template <typename PARTITIONER_T>
 boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
     const grape::CommSpec& comm_spec, const PARTITIONER_T& partitioner,
-    std::shared_ptr<arrow::Table>& table_in) {
+    std::shared_ptr<arrow::Table>& table_in, Client* client = nullptr,
+    std::vector<ObjectID>* shared_batches = nullptr,
+    std::string const& compression = "") {
   using oid_t = typename PARTITIONER_T::oid_t;
-  using internal_oid_t = typename InternalType<oid_t>::type;
   using oid_array_type = typename ConvertToArrowType<oid_t>::ArrayType;
 
   BOOST_LEAF_CHECK(SchemaConsistent(*table_in->schema(), comm_spec));
@@ -613,6 +921,7 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
 
   for (int i = 0; i < thread_num; ++i) {
     scan_threads[i] = std::thread([&]() {
+      std::vector<grape::fid_t> fids;
       while (true) {
         size_t got = cur.fetch_add(1);
         if (got >= record_batch_num) {
@@ -627,10 +936,10 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
         std::shared_ptr<oid_array_type> id_col =
             std::dynamic_pointer_cast<oid_array_type>(cur_batch->column(0));
 
+        fids.resize(row_num);
+        partitioner.GetPartitionIds(*id_col, fids.data());
         for (int64_t row_id = 0; row_id < row_num; ++row_id) {
-          internal_oid_t rs = id_col->GetView(row_id);
-          grape::fid_t fid = partitioner.GetPartitionId(oid_t(rs));
-          offset_list[fid].push_back(row_id);
+          offset_list[fids[row_id]].push_back(row_id);
         }
       }
     });
@@ -641,8 +950,9 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
 
-  ShuffleTableByOffsetLists(table_in->schema(), record_batches, offset_lists,
-                            batches_in, comm_spec);
+  ShuffleTableByOffsetListsPipelined(table_in->schema(), record_batches,
+                                     offset_lists, batches_in, comm_spec,
+                                     client, shared_batches, compression);
 
   batches_in.erase(std::remove_if(batches_in.begin(), batches_in.end(),
                                   [](std::shared_ptr<arrow::RecordBatch>& e) {
@@ -15,13 +15,29 @@ limitations under the License.
 
 #ifndef MODULES_GRAPH_UTILS_THREAD_GROUP_H_
 #define MODULES_GRAPH_UTILS_THREAD_GROUP_H_
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
 #include <future>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include "common/util/functions.h"
 #include "common/util/status.h"
 #include "graph/utils/error.h"
 
@@ -71,5 +87,256 @@ class ThreadGroup {
   tid_t tid_;
   std::map<tid_t, std::future<return_t>> tasks_;
 };
+
+/**
+ * @brief ThreadPool is a pool of persistent workers for the data-parallel
+ * loops in graph construction, which avoids creating and joining threads in
+ * every loop.
+ *
+ * A loop over `[0, num)` is cut into chunks, and split into `concurrency`
+ * lanes of contiguous chunks. The calling thread works on the first lane
+ * and the workers take the others; a thread that runs out of its lane steals
+ * chunks from the tails of other lanes, the lanes of the threads on the same
+ * NUMA node first, thus skewed chunks are balanced across threads. Workers
+ * are pinned to the NUMA nodes in round-robin when NUMA is available.
+ *
+ * As the calling thread can finish the whole loop by itself, loops can be
+ * nested, or issued from multiple threads concurrently.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(
+      int thread_num = static_cast<int>(std::thread::hardware_concurrency())) {
+    thread_num = std::max(thread_num, 1);
+    std::vector<std::vector<int>> node_cpus = numaNodeCpus();
+    for (int i = 0; i < thread_num; ++i) {
+      int node = -1;
+      if (!node_cpus.empty()) {
+        node = i % static_cast<int>(node_cpus.size());
+      }
+      workers_.emplace_back([this, node]() { workerLoop(node); });
+      if (node != -1) {
+        pinToCpus(workers_.back(), node_cpus[node]);
+      }
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stopped_ = true;
+    }
+    cond_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @brief The pool shared by the builders and loaders in the process, with
+   * one worker per hardware thread.
+   */
+  static ThreadPool& Default() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  int thread_num() const { return static_cast<int>(workers_.size()); }
+
+  /**
+   * @brief Run `func(lane, begin, end)` over the chunks of `[0, num)`, and
+   * block until all chunks are done.
+   *
+   * The `lane` is in `[0, concurrency)`, and a lane is run by only one thread
+   * at a time, thus it can be used to index per-thread states.
+   *
+   * @param num The number of the items.
+   * @param func The function on the range `[begin, end)` of items.
+   * @param concurrency The number of threads, including the calling thread.
+   * @param chunk The number of items in a chunk, 0 means cutting every lane
+   * into 8 chunks for stealing.
+   */
+  template <typename FUNC_T>
+  void ParallelFor(size_t num, const FUNC_T& func, int concurrency,
+                   size_t chunk = 0) {
+    if (num == 0) {
+      return;
+    }
+    size_t lane_num = std::max(
+        static_cast<size_t>(1),
+        std::min(static_cast<size_t>(std::min(concurrency, thread_num() + 1)),
+                 num));
+    if (chunk == 0) {
+      chunk = std::max(static_cast<size_t>(1), num / (lane_num * 8));
+    }
+    if (lane_num == 1) {
+      for (size_t begin = 0; begin < num; begin += chunk) {
+        func(0, begin, std::min(begin + chunk, num));
+      }
+      return;
+    }
+
+    auto job = std::make_shared<Job>(lane_num);
+    job->func = [&func](size_t lane, size_t begin, size_t end) {
+      func(lane, begin, end);
+    };
+    job->chunk = chunk;
+    job->remaining = num;
+    size_t lane_size = (num + lane_num - 1) / lane_num;
+    for (size_t i = 0; i < lane_num; ++i) {
+      job->lanes[i].begin = std::min(i * lane_size, num);
+      job->lanes[i].end = std::min((i + 1) * lane_size, num);
+    }
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      for (size_t i = 1; i < lane_num; ++i) {
+        queue_.emplace_back(job, i);
+      }
+    }
+    cond_.notify_all();
+
+    runLane(*job, 0, GetCurrentNumaNode());
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done.wait(lock, [&job]() { return job->remaining == 0; });
+  }
+
+ private:
+  struct Lane {
+    std::mutex mutex;
+    size_t begin = 0, end = 0;
+    // the NUMA node of the thread that runs the lane
+    std::atomic<int> node{-2};
+  };
+
+  struct Job {
+    explicit Job(size_t lane_num) : lanes(lane_num) {}
+
+    std::function<void(size_t, size_t, size_t)> func;
+    size_t chunk = 1;
+    std::vector<Lane> lanes;
+
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining = 0;
+  };
+
+  void workerLoop(int const node) {
+    while (true) {
+      std::pair<std::shared_ptr<Job>, size_t> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this]() { return stopped_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        task = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      runLane(*task.first, task.second, node);
+    }
+  }
+
+  void runLane(Job& job, size_t const lane, int const node) {
+    job.lanes[lane].node = node;
+    size_t begin = 0, end = 0;
+    // the chunks in the own lane, from the head
+    while (true) {
+      {
+        Lane& own = job.lanes[lane];
+        std::lock_guard<std::mutex> guard(own.mutex);
+        if (own.begin >= own.end) {
+          break;
+        }
+        begin = own.begin;
+        end = std::min(begin + job.chunk, own.end);
+        own.begin = end;
+      }
+      runChunk(job, lane, begin, end);
+    }
+    // steal from the tails of other lanes, the same NUMA node first
+    for (int round = 0; round < 2; ++round) {
+      for (size_t k = 1; k < job.lanes.size(); ++k) {
+        Lane& victim = job.lanes[(lane + k) % job.lanes.size()];
+        if ((round == 0) != (victim.node == node)) {
+          continue;
+        }
+        while (true) {
+          {
+            std::lock_guard<std::mutex> guard(victim.mutex);
+            if (victim.begin >= victim.end) {
+              break;
+            }
+            end = victim.end;
+            begin = end - std::min(job.chunk, end - victim.begin);
+            victim.end = begin;
+          }
+          runChunk(job, lane, begin, end);
+        }
+      }
+    }
+  }
+
+  void runChunk(Job& job, size_t const lane, size_t const begin,
+                size_t const end) {
+    job.func(lane, begin, end);
+    std::lock_guard<std::mutex> guard(job.mutex);
+    job.remaining -= end - begin;
+    if (job.remaining == 0) {
+      job.done.notify_all();
+    }
+  }
+
+  static std::vector<std::vector<int>> numaNodeCpus() {
+    std::vector<std::vector<int>> node_cpus;
+    int const nodes = GetNumaNodeCount();
+    if (nodes <= 1) {
+      return node_cpus;
+    }
+    for (int node = 0; node < nodes; ++node) {
+      // the cpulist is in the form of "0-3,8-11"
+      std::ifstream file("/sys/devices/system/node/node" +
+                         std::to_string(node) + "/cpulist");
+      std::vector<int> cpus;
+      std::string range;
+      while (std::getline(file, range, ',')) {
+        int lower = 0, upper = 0;
+        char dash = 0;
+        std::istringstream ss(range);
+        if (!(ss >> lower)) {
+          continue;
+        }
+        upper = (ss >> dash >> upper) ? upper : lower;
+        for (int cpu = lower; cpu <= upper; ++cpu) {
+          cpus.push_back(cpu);
+        }
+      }
+      if (cpus.empty()) {
+        return std::vector<std::vector<int>>();
+      }
+      node_cpus.emplace_back(std::move(cpus));
+    }
+    return node_cpus;
+  }
+
+  static void pinToCpus(std::thread& thread, std::vector<int> const& cpus) {
+#if defined(__linux__)
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (int cpu : cpus) {
+      CPU_SET(cpu, &cpuset);
+    }
+    // a failure is harmless, the worker just runs without affinity
+    pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t),
+                           &cpuset);
+#endif
+  }
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::pair<std::shared_ptr<Job>, size_t>> queue_;
+  bool stopped_ = false;
+};
 }  // namespace vineyard
 #endif  // MODULES_GRAPH_UTILS_THREAD_GROUP_H_
@@ -16,12 +16,26 @@ limitations under the License.
 #ifndef MODULES_GRAPH_UTILS_TRANSFORM_UTILS_H_
 #define MODULES_GRAPH_UTILS_TRANSFORM_UTILS_H_
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <boost/lexical_cast.hpp>
 
+#include "arrow/api.h"
+#include "grape/serialization/in_archive.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "graph/utils/predicate_scan.h"
+#include "graph/utils/thread_group.h"
+
 namespace vineyard {
 
 template <typename OID_T>
@@ -37,100 +51,338 @@ class String2Oid {
   std::string s_oid_;
 };
 
-template <typename FRAG_T>
-std::vector<typename FRAG_T::vertex_t> select_vertices(const FRAG_T* frag,
-                                                       const std::string& begin,
-                                                       const std::string& end) {
+namespace detail {
+
+// the number of vertices in a chunk of the parallel selectors and serializers
+constexpr size_t kTransformChunkSize = 64 * 1024;
+
+inline int transform_concurrency() {
+  return static_cast<int>(std::thread::hardware_concurrency());
+}
+
+template <typename T>
+void concatenate_chunks(std::vector<std::vector<T>>& chunks,
+                        std::vector<T>& out) {
+  std::vector<size_t> offsets(chunks.size() + 1, 0);
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    offsets[i + 1] = offsets[i] + chunks[i].size();
+  }
+  out.resize(offsets.back());
+  ThreadPool::Default().ParallelFor(
+      chunks.size(),
+      [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          std::copy(chunks[i].begin(), chunks[i].end(),
+                    out.begin() + offsets[i]);
+          std::vector<T>().swap(chunks[i]);
+        }
+      },
+      transform_concurrency(), 1);
+}
+
+/**
+ * The vertices in the range whose oids are in `[begin, end)`, in order, an
+ * empty bound means unbounded.
+ */
+template <typename FRAG_T, typename RANGE_T>
+std::vector<typename FRAG_T::vertex_t> select_vertices_in_range(
+    const FRAG_T* frag, const RANGE_T& range, const std::string& begin,
+    const std::string& end) {
   using vertex_t = typename FRAG_T::vertex_t;
   using oid_t = typename FRAG_T::oid_t;
+  size_t num = range.size();
+  auto first = range.begin_value();
   std::vector<vertex_t> ret;
-  auto range = frag->InnerVertices();
   if (begin == "" && end == "") {
-    for (auto v : range) {
-      ret.emplace_back(v);
-    }
-  } else if (begin == "" && end != "") {
-    oid_t end_id = String2Oid<oid_t>(end).Value();
-    for (auto v : range) {
-      if (frag->GetId(v) < end_id) {
-        ret.emplace_back(v);
+    ret.resize(num);
+    ThreadPool::Default().ParallelFor(
+        num,
+        [&](size_t, size_t x, size_t y) {
+          for (size_t i = x; i < y; ++i) {
+            ret[i] = vertex_t(first + i);
+          }
+        },
+        transform_concurrency());
+    return ret;
+  }
+
+  bool has_begin = begin != "", has_end = end != "";
+  oid_t begin_id = has_begin ? String2Oid<oid_t>(begin).Value() : oid_t();
+  oid_t end_id = has_end ? String2Oid<oid_t>(end).Value() : oid_t();
+  size_t chunk_num = (num + kTransformChunkSize - 1) / kTransformChunkSize;
+  std::vector<std::vector<vertex_t>> chunks(chunk_num);
+  ThreadPool::Default().ParallelFor(
+      chunk_num,
+      [&](size_t, size_t x, size_t y) {
+        for (size_t chunk = x; chunk < y; ++chunk) {
+          size_t from = chunk * kTransformChunkSize;
+          size_t to = std::min(from + kTransformChunkSize, num);
+          for (size_t i = from; i < to; ++i) {
+            vertex_t v(first + i);
+            oid_t id = frag->GetId(v);
+            if ((!has_begin || id >= begin_id) && (!has_end || id < end_id)) {
+              chunks[chunk].emplace_back(v);
+            }
+          }
+        }
+      },
+      transform_concurrency(), 1);
+  concatenate_chunks(chunks, ret);
+  return ret;
+}
+
+/**
+ * The inclusive bounds of the numeric values in `[begin, end)`, an empty
+ * bound means unbounded, returns false if no value is in the range.
+ */
+template <typename T>
+bool inclusive_bounds(const std::string& begin, const std::string& end,
+                      T& lower, T& upper) {
+  using limits = std::numeric_limits<T>;
+  lower = limits::has_infinity ? -limits::infinity() : limits::lowest();
+  upper = limits::has_infinity ? limits::infinity() : limits::max();
+  if (begin != "") {
+    lower = String2Oid<T>(begin).Value();
+  }
+  if (end != "") {
+    T end_value = String2Oid<T>(end).Value();
+    if (std::is_integral<T>::value) {
+      if (end_value == limits::lowest()) {
+        return false;
       }
-    }
-  } else if (begin != "" && end == "") {
-    oid_t begin_id = String2Oid<oid_t>(begin).Value();
-    for (auto v : range) {
-      if (frag->GetId(v) >= begin_id) {
-        ret.emplace_back(v);
+      upper = end_value - 1;
+    } else {
+      upper = std::nextafter(end_value, lower);
+      if (!(upper < end_value)) {
+        return false;
       }
     }
-  } else if (begin != "" && end != "") {
-    oid_t begin_id = String2Oid<oid_t>(begin).Value();
-    oid_t end_id = String2Oid<oid_t>(end).Value();
-    for (auto v : range) {
-      oid_t id = frag->GetId(v);
-      if (id >= begin_id && id < end_id) {
-        ret.emplace_back(v);
-      }
+  }
+  return lower <= upper;
+}
+
+template <typename T>
+void scan_numeric_values(const arrow::Array& array, int64_t offset, size_t n,
+                         const std::string& begin, const std::string& end,
+                         uint64_t* bitmap) {
+  T lower, upper;
+  if (!inclusive_bounds(begin, end, lower, upper)) {
+    std::fill(bitmap, bitmap + scan::bitmap_words(n), 0);
+    return;
+  }
+  auto const& values =
+      static_cast<const typename ConvertToArrowType<T>::ArrayType&>(array);
+  scan::range(values.raw_values() + offset, n, lower, upper, bitmap);
+}
+
+/**
+ * Select the values of `array[offset, offset + n)` in `[begin, end)` into the
+ * bitmap by the predicate scans, the nulls are never selected.
+ */
+inline void scan_values(const arrow::Array& array, int64_t offset, size_t n,
+                        const std::string& begin, const std::string& end,
+                        uint64_t* bitmap) {
+  switch (array.type_id()) {
+  case arrow::Type::INT32:
+    scan_numeric_values<int32_t>(array, offset, n, begin, end, bitmap);
+    break;
+  case arrow::Type::INT64:
+    scan_numeric_values<int64_t>(array, offset, n, begin, end, bitmap);
+    break;
+  case arrow::Type::UINT32:
+    scan_numeric_values<uint32_t>(array, offset, n, begin, end, bitmap);
+    break;
+  case arrow::Type::UINT64:
+    scan_numeric_values<uint64_t>(array, offset, n, begin, end, bitmap);
+    break;
+  case arrow::Type::FLOAT:
+    scan_numeric_values<float>(array, offset, n, begin, end, bitmap);
+    break;
+  case arrow::Type::DOUBLE:
+    scan_numeric_values<double>(array, offset, n, begin, end, bitmap);
+    break;
+  default:
+    if (begin != "" && begin == end) {
+      // the equality predicate that compares the dictionary indices
+      CHECK(scan::string_equal(array, offset, n, begin, bitmap))
+          << "property type not support - " << array.type()->ToString();
+      break;
     }
+    CHECK(scan::string_range(array, offset, n, begin, end, bitmap))
+        << "property type not support - " << array.type()->ToString();
   }
-  return ret;
+  scan::clear_nulls(array, offset, n, bitmap);
+}
+
+/**
+ * Append `get(v)` of every vertex in the range to the archive, in order, with
+ * the same bytes as appending them one by one.
+ *
+ * Fixed-size values are written into the archive in place, and other values
+ * (e.g., strings) are written into per-chunk archives first, which are then
+ * copied into the archive.
+ */
+template <typename T, typename VERTEX_T, typename FUNC_T>
+void serialize_vertices(grape::InArchive& arc,
+                        const std::vector<VERTEX_T>& range,
+                        const FUNC_T& get) {
+  size_t num = range.size();
+  size_t old_size = arc.GetSize();
+  if (std::is_arithmetic<T>::value) {
+    arc.Resize(old_size + num * sizeof(T));
+    char* base = arc.GetBuffer() + static_cast<ptrdiff_t>(old_size);
+    ThreadPool::Default().ParallelFor(
+        num,
+        [&](size_t, size_t x, size_t y) {
+          for (size_t i = x; i < y; ++i) {
+            T value = get(range[i]);
+            memcpy(base + i * sizeof(T), &value, sizeof(T));
+          }
+        },
+        transform_concurrency());
+    return;
+  }
+
+  size_t chunk_num = (num + kTransformChunkSize - 1) / kTransformChunkSize;
+  std::vector<grape::InArchive> chunks(chunk_num);
+  ThreadPool::Default().ParallelFor(
+      chunk_num,
+      [&](size_t, size_t x, size_t y) {
+        for (size_t chunk = x; chunk < y; ++chunk) {
+          size_t from = chunk * kTransformChunkSize;
+          size_t to = std::min(from + kTransformChunkSize, num);
+          for (size_t i = from; i < to; ++i) {
+            chunks[chunk] << get(range[i]);
+          }
+        }
+      },
+      transform_concurrency(), 1);
+  std::vector<size_t> offsets(chunk_num + 1, old_size);
+  for (size_t i = 0; i < chunk_num; ++i) {
+    offsets[i + 1] = offsets[i] + chunks[i].GetSize();
+  }
+  arc.Resize(offsets.back());
+  ThreadPool::Default().ParallelFor(
+      chunk_num,
+      [&](size_t, size_t x, size_t y) {
+        for (size_t i = x; i < y; ++i) {
+          memcpy(arc.GetBuffer() + static_cast<ptrdiff_t>(offsets[i]),
+                 chunks[i].GetBuffer(), chunks[i].GetSize());
+          chunks[i].Clear();
+        }
+      },
+      transform_concurrency(), 1);
+}
+
+/**
+ * Build `get(v)` of every vertex in the range as an arrow chunked array, the
+ * chunks are built in parallel without being concatenated.
+ */
+template <typename T, typename VERTEX_T, typename FUNC_T>
+std::shared_ptr<arrow::ChunkedArray> vertices_to_arrow(
+    const std::vector<VERTEX_T>& range, const FUNC_T& get) {
+  size_t num = range.size();
+  size_t chunk_num = (num + kTransformChunkSize - 1) / kTransformChunkSize;
+  std::vector<std::shared_ptr<arrow::Array>> chunks(chunk_num);
+  ThreadPool::Default().ParallelFor(
+      chunk_num,
+      [&](size_t, size_t x, size_t y) {
+        for (size_t chunk = x; chunk < y; ++chunk) {
+          size_t from = chunk * kTransformChunkSize;
+          size_t to = std::min(from + kTransformChunkSize, num);
+          typename ConvertToArrowType<T>::BuilderType builder;
+          CHECK_ARROW_ERROR(builder.Reserve(to - from));
+          for (size_t i = from; i < to; ++i) {
+            CHECK_ARROW_ERROR(builder.Append(get(range[i])));
+          }
+          CHECK_ARROW_ERROR(builder.Finish(&chunks[chunk]));
+        }
+      },
+      transform_concurrency(), 1);
+  return std::make_shared<arrow::ChunkedArray>(
+      chunks, ConvertToArrowType<T>::TypeValue());
+}
+
+}  // namespace detail
+
+template <typename FRAG_T>
+std::vector<typename FRAG_T::vertex_t> select_vertices(const FRAG_T* frag,
+                                                       const std::string& begin,
+                                                       const std::string& end) {
+  return detail::select_vertices_in_range(frag, frag->InnerVertices(), begin,
+                                          end);
 }
 
 template <typename FRAG_T>
 std::vector<typename FRAG_T::vertex_t> select_labeled_vertices(
     const FRAG_T* frag, typename FRAG_T::label_id_t label_id,
     const std::string& begin, const std::string& end) {
-  using vertex_t = typename FRAG_T::vertex_t;
-  using oid_t = typename FRAG_T::oid_t;
+  return detail::select_vertices_in_range(frag, frag->InnerVertices(label_id),
+                                          begin, end);
+}
 
-  std::vector<vertex_t> ret;
+/**
+ * @brief The inner vertices of the label whose property is in `[begin, end)`,
+ * in order, an empty bound means unbounded. For string properties, `begin ==
+ * end` selects the vertices whose property equals to it.
+ *
+ * The property column of the vertex table is scanned by the predicate scans
+ * in "graph/utils/predicate_scan.h" chunk by chunk, rather than accessing
+ * the vertices one by one.
+ */
+template <typename FRAG_T>
+std::vector<typename FRAG_T::vertex_t> select_vertices_by_property(
+    const FRAG_T* frag, typename FRAG_T::label_id_t label_id,
+    typename FRAG_T::prop_id_t prop_id, const std::string& begin,
+    const std::string& end) {
+  using vertex_t = typename FRAG_T::vertex_t;
   auto range = frag->InnerVertices(label_id);
-  if (begin == "" && end == "") {
-    for (auto v : range) {
-      ret.emplace_back(v);
-    }
-  } else if (begin == "" && end != "") {
-    oid_t end_id = String2Oid<oid_t>(end).Value();
-    for (auto v : range) {
-      if (frag->GetId(v) < end_id) {
-        ret.emplace_back(v);
-      }
-    }
-  } else if (begin != "" && end == "") {
-    oid_t begin_id = String2Oid<oid_t>(begin).Value();
-    for (auto v : range) {
-      if (frag->GetId(v) >= begin_id) {
-        ret.emplace_back(v);
-      }
-    }
-  } else if (begin != "" && end != "") {
-    oid_t begin_id = String2Oid<oid_t>(begin).Value();
-    oid_t end_id = String2Oid<oid_t>(end).Value();
-    for (auto v : range) {
-      oid_t id = frag->GetId(v);
-      if (id >= begin_id && id < end_id) {
-        ret.emplace_back(v);
-      }
-    }
+  auto table = frag->vertex_data_table(label_id);
+  std::vector<vertex_t> ret;
+  size_t num = range.size();
+  if (num == 0 || table->num_rows() == 0) {
+    return ret;
   }
+  auto array = table->column(prop_id)->chunk(0);
+  auto first = range.begin_value();
+  constexpr size_t chunk_size = detail::kTransformChunkSize;
+  size_t chunk_num = (num + chunk_size - 1) / chunk_size;
+  std::vector<std::vector<vertex_t>> chunks(chunk_num);
+  ThreadPool::Default().ParallelFor(
+      chunk_num,
+      [&](size_t, size_t x, size_t y) {
+        std::vector<uint64_t> bitmap(scan::bitmap_words(chunk_size));
+        for (size_t chunk = x; chunk < y; ++chunk) {
+          size_t from = chunk * chunk_size;
+          size_t n = std::min(chunk_size, num - from);
+          detail::scan_values(*array, from, n, begin, end, bitmap.data());
+          chunks[chunk].reserve(scan::count(bitmap.data(), n));
+          scan::for_each_selected(bitmap.data(), n, [&](size_t i) {
+            chunks[chunk].emplace_back(vertex_t(first + from + i));
+          });
+        }
+      },
+      detail::transform_concurrency(), 1);
+  detail::concatenate_chunks(chunks, ret);
   return ret;
 }
 
 template <typename FRAG_T>
 void serialize_vertex_id(grape::InArchive& arc, const FRAG_T* frag,
                          const std::vector<typename FRAG_T::vertex_t>& range) {
-  for (auto v : range) {
-    arc << frag->GetId(v);
-  }
+  using vertex_t = typename FRAG_T::vertex_t;
+  detail::serialize_vertices<typename FRAG_T::oid_t>(
+      arc, range, [frag](const vertex_t& v) { return frag->GetId(v); });
 }
 
 template <typename FRAG_T>
 void serialize_vertex_data(
     grape::InArchive& arc, const FRAG_T* frag,
     const std::vector<typename FRAG_T::vertex_t>& range) {
-  for (auto v : range) {
-    arc << frag->GetData(v);
-  }
+  using vertex_t = typename FRAG_T::vertex_t;
+  using data_t = typename std::decay<decltype(frag->GetData(range[0]))>::type;
+  detail::serialize_vertices<data_t>(
+      arc, range, [frag](const vertex_t& v) { return frag->GetData(v); });
 }
 
 template <typename FRAG_T, typename DATA_T>
@@ -138,11 +390,12 @@ void serialize_vertex_property_impl(
     grape::InArchive& arc, const FRAG_T* frag,
     const std::vector<typename FRAG_T::vertex_t>& range,
     typename FRAG_T::prop_id_t prop_id) {
-  for (auto v : range) {
-    arc << frag->template GetData<DATA_T>(v, prop_id);
-  }
+  using vertex_t = typename FRAG_T::vertex_t;
+  detail::serialize_vertices<DATA_T>(
+      arc, range, [frag, prop_id](const vertex_t& v) {
+        return frag->template GetData<DATA_T>(v, prop_id);
+      });
 }
-
 template <typename FRAG_T>
 void serialize_vertex_property(
     grape::InArchive& arc, const FRAG_T* frag,
@@ -166,6 +419,61 @@ void serialize_vertex_property(
   }
 }
 
+/**
+ * @brief The oids of the vertices as an arrow chunked array, which skips the
+ * `grape::InArchive`.
+ */
+template <typename FRAG_T>
+std::shared_ptr<arrow::ChunkedArray> vertex_id_to_arrow(
+    const FRAG_T* frag, const std::vector<typename FRAG_T::vertex_t>& range) {
+  using vertex_t = typename FRAG_T::vertex_t;
+  return detail::vertices_to_arrow<typename FRAG_T::oid_t>(
+      range, [frag](const vertex_t& v) { return frag->GetId(v); });
+}
+
+template <typename FRAG_T, typename DATA_T>
+std::shared_ptr<arrow::ChunkedArray> vertex_property_to_arrow_impl(
+    const FRAG_T* frag, const std::vector<typename FRAG_T::vertex_t>& range,
+    typename FRAG_T::prop_id_t prop_id) {
+  using vertex_t = typename FRAG_T::vertex_t;
+  return detail::vertices_to_arrow<DATA_T>(
+      range, [frag, prop_id](const vertex_t& v) {
+        return frag->template GetData<DATA_T>(v, prop_id);
+      });
+}
+
+/**
+ * @brief The property of the vertices as an arrow chunked array, which skips
+ * the `grape::InArchive`.
+ */
+template <typename FRAG_T>
+std::shared_ptr<arrow::ChunkedArray> vertex_property_to_arrow(
+    const FRAG_T* frag, const std::vector<typename FRAG_T::vertex_t>& range,
+    typename FRAG_T::label_id_t label_id, typename FRAG_T::prop_id_t prop_id) {
+  auto type = frag->vertex_property_type(label_id, prop_id);
+  if (type->Equals(arrow::int32())) {
+    return vertex_property_to_arrow_impl<FRAG_T, int32_t>(frag, range, prop_id);
+  } else if (type->Equals(arrow::int64())) {
+    return vertex_property_to_arrow_impl<FRAG_T, int64_t>(frag, range, prop_id);
+  } else if (type->Equals(arrow::uint32())) {
+    return vertex_property_to_arrow_impl<FRAG_T, uint32_t>(frag, range,
+                                                           prop_id);
+  } else if (type->Equals(arrow::uint64())) {
+    return vertex_property_to_arrow_impl<FRAG_T, uint64_t>(frag, range,
+                                                           prop_id);
+  } else if (type->Equals(arrow::float32())) {
+    return vertex_property_to_arrow_impl<FRAG_T, float>(frag, range, prop_id);
+  } else if (type->Equals(arrow::float64())) {
+    return vertex_property_to_arrow_impl<FRAG_T, double>(frag, range, prop_id);
+  } else if (type->Equals(arrow::utf8())) {
+    return vertex_property_to_arrow_impl<FRAG_T, std::string>(frag, range,
+                                                              prop_id);
+  } else {
+    LOG(FATAL) << "property type not support - " << type->ToString();
+    return nullptr;
+  }
+}
+
 inline void parse_range(const std::string& range, std::string& begin,
                         std::string& end) {
   // format: "{begin: a, end: b}" or "{begin: a}" or "{end: b}" or "{}"
@@ -0,0 +1,206 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_VARINT_ENCODING_H_
+#define MODULES_GRAPH_UTILS_VARINT_ENCODING_H_
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace vineyard {
+
+/**
+ * The delta-varint encoding of a non-decreasing sequence of integers, in the
+ * layout of StreamVByte (extended to 64-bit values):
+ *
+ *   | control bytes: ceil(n / 4) | data bytes |
+ *
+ * The deltas between the adjacent values (the first value is the delta to
+ * 0) are stored as 1, 2, 4 or 8 little-endian bytes in the data bytes, and
+ * the length of the k-th delta is the `2^code`, where the 2-bit code is
+ * located in the bits `[2 * (k % 4), 2 * (k % 4) + 2)` of the `k / 4`-th
+ * control byte. Separating the lengths from the data makes the data bytes of
+ * consecutive values decodable with a single shuffle.
+ */
+namespace varint {
+
+inline size_t control_bytes(size_t const n) { return (n + 3) / 4; }
+
+inline uint8_t delta_code(uint64_t const delta) {
+  if (delta < (1ULL << 8)) {
+    return 0;
+  } else if (delta < (1ULL << 16)) {
+    return 1;
+  } else if (delta < (1ULL << 32)) {
+    return 2;
+  } else {
+    return 3;
+  }
+}
+
+/**
+ * @brief Get the size of the data bytes of the encoded sequence.
+ */
+template <typename T>
+inline size_t data_bytes(const T* values, size_t const n) {
+  size_t size = 0;
+  uint64_t last = 0;
+  for (size_t k = 0; k < n; ++k) {
+    size += 1 << delta_code(static_cast<uint64_t>(values[k]) - last);
+    last = static_cast<uint64_t>(values[k]);
+  }
+  return size;
+}
+
+/**
+ * @brief Encode the non-decreasing values into the control bytes and the data
+ * bytes.
+ *
+ * @return The number of the data bytes written.
+ */
+template <typename T>
+inline size_t encode_deltas(const T* values, size_t const n, uint8_t* control,
+                            uint8_t* data) {
+  if (n == 0) {
+    return 0;
+  }
+  memset(control, 0, control_bytes(n));
+  uint8_t* cursor = data;
+  uint64_t last = 0;
+  for (size_t k = 0; k < n; ++k) {
+    uint64_t delta = static_cast<uint64_t>(values[k]) - last;
+    uint8_t code = delta_code(delta);
+    control[k >> 2] |= code << ((k & 3) << 1);
+    memcpy(cursor, &delta, 1 << code);
+    cursor += 1 << code;
+    last = static_cast<uint64_t>(values[k]);
+  }
+  return cursor - data;
+}
+
+/**
+ * @brief Decode the k-th delta, and move the data cursor forward.
+ */
+inline uint64_t decode_delta(const uint8_t* control, size_t const k,
+                             const uint8_t*& data) {
+  uint8_t code = (control[k >> 2] >> ((k & 3) << 1)) & 3;
+  uint64_t delta = 0;
+  memcpy(&delta, data, 1 << code);
+  data += 1 << code;
+  return delta;
+}
+
+#if defined(__SSSE3__)
+namespace detail {
+
+// the shuffle masks that spread the deltas of two adjacent values (indexed by
+// their 4-bit codes) to two 64-bit lanes.
+struct PairShuffleTable {
+  PairShuffleTable() {
+    for (int code = 0; code < 16; ++code) {
+      int first = 1 << (code & 3), second = 1 << (code >> 2);
+      for (int i = 0; i < 8; ++i) {
+        masks[code][i] = i < first ? i : 0x80;
+        masks[code][8 + i] = i < second ? first + i : 0x80;
+      }
+      lengths[code] = first + second;
+    }
+  }
+
+  alignas(16) uint8_t masks[16][16];
+  uint8_t lengths[16];
+};
+
+inline const PairShuffleTable& pair_shuffle_table() {
+  static const PairShuffleTable table;
+  return table;
+}
+
+}  // namespace detail
+#endif
+
+/**
+ * @brief Decode the first n values of the encoded sequence.
+ *
+ * @param control The control bytes.
+ * @param data The data bytes.
+ * @param data_end The end of the readable memory after the data bytes, the
+ * SIMD path reads 16 bytes at a time and falls back to the scalar path near
+ * the end.
+ * @param n The number of the values to decode.
+ * @param out The decoded values.
+ */
+template <typename T>
+inline void decode_values(const uint8_t* control, const uint8_t* data,
+                          const uint8_t* data_end, size_t const n, T* out) {
+  uint64_t last = 0;
+  size_t k = 0;
+#if defined(__SSSE3__)
+  auto const& table = detail::pair_shuffle_table();
+  for (; k + 2 <= n && data + 16 <= data_end; k += 2) {
+    uint8_t code = (control[k >> 2] >> ((k & 3) << 1)) & 15;
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i mask =
+        _mm_load_si128(reinterpret_cast<const __m128i*>(table.masks[code]));
+    alignas(16) uint64_t deltas[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(deltas),
+                    _mm_shuffle_epi8(bytes, mask));
+    data += table.lengths[code];
+    last += deltas[0];
+    out[k] = static_cast<T>(last);
+    last += deltas[1];
+    out[k + 1] = static_cast<T>(last);
+  }
+#else
+  (void) data_end;
+#endif
+  for (; k < n; ++k) {
+    last += decode_delta(control, k, data);
+    out[k] = static_cast<T>(last);
+  }
+}
+
+/**
+ * @brief Get the number of bytes that is enough to hold integers in
+ * `[0, bound)`, in 1 to 8 bytes.
+ */
+inline size_t fixed_width(uint64_t const bound) {
+  size_t width = 1;
+  while (width < 8 && bound > (1ULL << (width * 8))) {
+    width += 1;
+  }
+  return width;
+}
+
+inline uint64_t load_fixed(const uint8_t* data, size_t const width) {
+  uint64_t value = 0;
+  memcpy(&value, data, width);
+  return value;
+}
+
+inline void store_fixed(uint8_t* data, uint64_t const value,
+                        size_t const width) {
+  memcpy(data, &value, width);
+}
+
+}  // namespace varint
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_VARINT_ENCODING_H_
@@ -0,0 +1,160 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_VERTEX_REORDER_H_
+#define MODULES_GRAPH_UTILS_VERTEX_REORDER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vineyard {
+
+/**
+ * @brief The strategies to reorder the inner vertices of each label when
+ * building fragments, to improve the locality of the vertex data and the
+ * adjacency lists.
+ *
+ * - kNone: keep the vertices in the loading order.
+ * - kDegree: sort the vertices by their degrees, in descending order, so the
+ *   hub vertices are packed together.
+ * - kRCM: the reverse Cuthill-McKee ordering, which places the neighbors
+ *   close to each other, and reduces the bandwidth of the adjacency matrix.
+ */
+enum class VertexReorderStrategy {
+  kNone = 0,
+  kDegree = 1,
+  kRCM = 2,
+};
+
+inline bool ParseVertexReorderStrategy(const std::string& name,
+                                       VertexReorderStrategy& strategy) {
+  if (name.empty() || name == "none") {
+    strategy = VertexReorderStrategy::kNone;
+  } else if (name == "degree") {
+    strategy = VertexReorderStrategy::kDegree;
+  } else if (name == "rcm") {
+    strategy = VertexReorderStrategy::kRCM;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Get the new order of vertices, i.e., `order[new_offset]` is the
+ * old offset, with the vertices of higher degrees first.
+ */
+inline std::vector<int64_t> DegreeOrder(const std::vector<int64_t>& degrees) {
+  std::vector<int64_t> order(degrees.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&degrees](int64_t const lhs, int64_t const rhs) {
+                     return degrees[lhs] > degrees[rhs];
+                   });
+  return order;
+}
+
+/**
+ * @brief Get the reverse Cuthill-McKee order of vertices, in the same form
+ * of `DegreeOrder`.
+ *
+ * @param offsets The CSR offsets of the symmetric local adjacency, which has
+ * `n + 1` elements.
+ * @param neighbors The neighbors in CSR.
+ * @param degrees The degrees of vertices, used to pick the starting vertices
+ * and the visiting order of neighbors, which may include the edges that are
+ * not in the local adjacency.
+ */
+inline std::vector<int64_t> ReverseCuthillMcKeeOrder(
+    const std::vector<int64_t>& offsets, const std::vector<int64_t>& neighbors,
+    const std::vector<int64_t>& degrees) {
+  size_t n = degrees.size();
+  std::vector<int64_t> order;
+  order.reserve(n);
+  std::vector<bool> visited(n, false);
+  auto by_degree = [&degrees](int64_t const lhs, int64_t const rhs) {
+    return degrees[lhs] < degrees[rhs] ||
+           (degrees[lhs] == degrees[rhs] && lhs < rhs);
+  };
+
+  // each connected component starts from the vertex of smallest degree
+  std::vector<int64_t> starts(n);
+  std::iota(starts.begin(), starts.end(), 0);
+  std::sort(starts.begin(), starts.end(), by_degree);
+  for (int64_t start : starts) {
+    if (visited[start]) {
+      continue;
+    }
+    visited[start] = true;
+    size_t head = order.size();
+    order.push_back(start);
+    while (head < order.size()) {
+      int64_t v = order[head++];
+      size_t frontier = order.size();
+      for (int64_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+        int64_t u = neighbors[k];
+        if (!visited[u]) {
+          visited[u] = true;
+          order.push_back(u);
+        }
+      }
+      std::sort(order.begin() + frontier, order.end(), by_degree);
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+/**
+ * @brief Build the symmetric CSR from the edges whose both endpoints are in
+ * `[0, n)`, for `ReverseCuthillMcKeeOrder`.
+ */
+inline void BuildSymmetricCSR(
+    size_t const n, const std::vector<std::pair<int64_t, int64_t>>& edges,
+    std::vector<int64_t>& offsets, std::vector<int64_t>& neighbors) {
+  offsets.assign(n + 1, 0);
+  for (auto const& edge : edges) {
+    offsets[edge.first + 1] += 1;
+    offsets[edge.second + 1] += 1;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    offsets[i + 1] += offsets[i];
+  }
+  neighbors.resize(offsets[n]);
+  std::vector<int64_t> cursors(offsets.begin(), offsets.end() - 1);
+  for (auto const& edge : edges) {
+    neighbors[cursors[edge.first]++] = edge.second;
+    neighbors[cursors[edge.second]++] = edge.first;
+  }
+}
+
+/**
+ * @brief Invert the order, i.e., get the new offset of each old offset.
+ */
+inline std::vector<int64_t> InverseOrder(const std::vector<int64_t>& order) {
+  std::vector<int64_t> inverse(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    inverse[order[i]] = static_cast<int64_t>(i);
+  }
+  return inverse;
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_VERTEX_REORDER_H_
@@ -18,20 +18,28 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "basic/ds/array.h"
 #include "basic/ds/arrow.h"
+#include "basic/ds/bloom_filter.h"
 #include "basic/ds/hashmap.h"
+#include "basic/ds/string_hashmap.h"
 #include "client/client.h"
 #include "common/util/typename.h"
+#include "grape/worker/comm_spec.h"
 
 #include "graph/fragment/property_graph_types.h"
 #include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/partitioner.h"
+#include "graph/utils/thread_group.h"
 
 namespace gs {
 
@@ -45,6 +53,123 @@ namespace vineyard {
 template <typename OID_T, typename VID_T>
 class ArrowVertexMapBuilder;
 
+namespace detail {
+
+/**
+ * @brief The partitioner that the vertices are partitioned by, which is kept
+ * in the metadata of the vertex map, thus the fragment of an oid is computed
+ * rather than probed fragment by fragment.
+ *
+ * Only the hash partitioner and the segmented partitioner of split points
+ * can be kept, otherwise the vertex map probes the fragments as before.
+ */
+template <typename OID_T>
+class VertexMapPartitioner {
+  // the split points of string oids are kept as strings
+  using key_t = typename std::conditional<
+      std::is_same<OID_T, arrow::util::string_view>::value, std::string,
+      OID_T>::type;
+
+ public:
+  template <typename PARTITIONER_OID_T>
+  void Init(HashPartitioner<PARTITIONER_OID_T> const& partitioner) {
+    kind_ = kHash;
+    fnum_ = partitioner.fnum();
+  }
+
+  void Init(HashPartitioner<std::string> const& partitioner) {
+    kind_ = kHash;
+    fnum_ = partitioner.fnum();
+    wyhash_ = partitioner.wyhash();
+  }
+
+  template <typename PARTITIONER_OID_T>
+  void Init(SegmentedPartitioner<PARTITIONER_OID_T> const& partitioner) {
+    if (partitioner.split_fids().empty()) {
+      kind_ = kNone;
+      return;
+    }
+    kind_ = kSegmented;
+    fnum_ = partitioner.fnum();
+    splits_.assign(partitioner.splits().begin(), partitioner.splits().end());
+    split_fids_ = partitioner.split_fids();
+  }
+
+  /**
+   * @brief Find the fragment of the oid by the partitioner.
+   *
+   * @return False if the partitioner is unknown.
+   */
+  bool GetPartitionId(OID_T const& oid, fid_t& fid) const {
+    if (kind_ == kHash) {
+      fid = static_cast<fid_t>(hash(oid) % fnum_);
+      return true;
+    }
+    if (kind_ == kSegmented) {
+      size_t index = std::upper_bound(splits_.begin(), splits_.end(), oid,
+                                      oid_view_less{}) -
+                     splits_.begin();
+      fid = split_fids_[index];
+      return true;
+    }
+    return false;
+  }
+
+  void AddToMeta(ObjectMeta& meta) const {
+    if (kind_ == kNone) {
+      return;
+    }
+    meta.AddKeyValue("partitioner", static_cast<int>(kind_));
+    meta.AddKeyValue("partitioner_fnum", fnum_);
+    if (kind_ == kHash && wyhash_) {
+      meta.AddKeyValue("partitioner_wyhash", 1);
+    }
+    if (kind_ == kSegmented) {
+      meta.AddKeyValue("partitioner_splits", splits_);
+      meta.AddKeyValue("partitioner_split_fids", split_fids_);
+    }
+  }
+
+  void Construct(ObjectMeta const& meta) {
+    kind_ = kNone;
+    if (!meta.Haskey("partitioner")) {
+      return;
+    }
+    kind_ = static_cast<kind_t>(meta.GetKeyValue<int>("partitioner"));
+    fnum_ = meta.GetKeyValue<fid_t>("partitioner_fnum");
+    wyhash_ = meta.Haskey("partitioner_wyhash");
+    if (kind_ == kSegmented) {
+      meta.GetKeyValue("partitioner_splits", splits_);
+      meta.GetKeyValue("partitioner_split_fids", split_fids_);
+    }
+  }
+
+ private:
+  // the same as `HashPartitioner`
+  template <typename T>
+  uint64_t hash(T const& oid) const {
+    return static_cast<uint64_t>(oid);
+  }
+
+  uint64_t hash(arrow::util::string_view const& oid) const {
+    if (wyhash_) {
+      return wyhash(oid.data(), oid.size());
+    }
+    return static_cast<uint64_t>(
+        std::hash<std::string>()(std::string(oid.data(), oid.size())));
+  }
+
+  enum kind_t { kNone = 0, kHash = 1, kSegmented = 2 };
+
+  kind_t kind_ = kNone;
+  fid_t fnum_ = 1;
+  bool wyhash_ = false;
+  std::vector<key_t> splits_;
+  std::vector<fid_t> split_fids_;
+};
+
+}  // namespace detail
+
 template <typename OID_T, typename VID_T>
 class ArrowVertexMap
     : public vineyard::Registered<ArrowVertexMap<OID_T, VID_T>> {
@@ -52,6 +177,7 @@ class ArrowVertexMap
   using vid_t = VID_T;
   using label_id_t = property_graph_types::LABEL_ID_TYPE;
   using oid_array_t = typename vineyard::ConvertToArrowType<oid_t>::ArrayType;
+  using vid_array_t = typename vineyard::ConvertToArrowType<vid_t>::ArrayType;
 
  public:
   ArrowVertexMap() {}
@@ -71,28 +197,79 @@ class ArrowVertexMap
 
     id_parser_.Init(fnum_, label_num_);
 
+    partitioned_ =
+        meta.Haskey("partitioned") && meta.GetKeyValue<bool>("partitioned");
+    if (partitioned_) {
+      local_fid_ = meta.GetKeyValue<fid_t>("local_fid");
+    }
+    partitioner_.Construct(meta);
+
     o2g_.resize(fnum_);
+    o2g_filters_.resize(fnum_);
     oid_arrays_.resize(fnum_);
+    vnums_.resize(fnum_);
+    // the vertex maps sealed before the filters are added have no filters
+    has_o2g_filters_ = true;
+    vineyard::IndexedKey vnum_key("vnum_", '_'), o2g_key("o2g_", '_'),
+        o2g_filter_key("o2g_filter_", '_'),
+        oid_arrays_key("oid_arrays_", '_');
     for (fid_t i = 0; i < fnum_; ++i) {
       o2g_[i].resize(label_num_);
+      o2g_filters_[i].resize(label_num_);
       oid_arrays_[i].resize(label_num_);
+      vnums_[i].resize(label_num_);
       for (label_id_t j = 0; j < label_num_; ++j) {
-        o2g_[i][j].Construct(meta.GetMemberMeta("o2g_" + std::to_string(i) +
-                                                "_" + std::to_string(j)));
+        if (partitioned_ && i != local_fid_) {
+          vnums_[i][j] = meta.GetKeyValue<int64_t>(vnum_key(i, j));
+          continue;
+        }
+        o2g_[i][j].Construct(meta.GetMemberMeta(o2g_key(i, j)));
+        std::string const& filter_name = o2g_filter_key(i, j);
+        if (meta.Haskey(filter_name)) {
+          o2g_filters_[i][j].Construct(meta.GetMemberMeta(filter_name));
+        } else {
+          has_o2g_filters_ = false;
+        }
 
         typename InternalType<oid_t>::vineyard_array_type array;
-        array.Construct(meta.GetMemberMeta("oid_arrays_" + std::to_string(i) +
-                                           "_" + std::to_string(j)));
+        array.Construct(meta.GetMemberMeta(oid_arrays_key(i, j)));
         oid_arrays_[i][j] = array.GetArray();
+        vnums_[i][j] = oid_arrays_[i][j]->length();
+      }
+    }
+
+    if (partitioned_) {
+      mirror_oids_.resize(label_num_);
+      mirror_gids_.resize(label_num_);
+      mirror_o2g_.resize(label_num_);
+      for (label_id_t j = 0; j < label_num_; ++j) {
+        typename InternalType<oid_t>::vineyard_array_type oids;
+        oids.Construct(meta.GetMemberMeta("mirror_oids_" + std::to_string(j)));
+        mirror_oids_[j] = oids.GetArray();
+        vineyard::NumericArray<vid_t> gids;
+        gids.Construct(meta.GetMemberMeta("mirror_gids_" + std::to_string(j)));
+        mirror_gids_[j] = gids.GetArray();
+        mirror_o2g_[j].Construct(
+            meta.GetMemberMeta("mirror_o2g_" + std::to_string(j)));
       }
     }
   }
 
+  /**
+   * @brief Whether the vertex map keeps the oids of the local fragment only,
+   * plus the mirrors of the remote vertices that the fragment refers to,
+   * rather than the oids of all fragments.
+   */
+  bool partitioned() const { return partitioned_; }
+
   bool GetOid(vid_t gid, oid_t& oid) const {
     fid_t fid = id_parser_.GetFid(gid);
     label_id_t label = id_parser_.GetLabelId(gid);
     int64_t offset = id_parser_.GetOffset(gid);
     if (fid < fnum_ && label < label_num_ && label >= 0) {
+      if (partitioned_ && fid != local_fid_) {
+        return getMirrorOid(label, gid, oid);
+      }
       auto array = oid_arrays_[fid][label];
       if (offset < array->length()) {
         oid = array->GetView(offset);
@@ -103,6 +280,9 @@ class ArrowVertexMap
   }
 
   bool GetGid(fid_t fid, label_id_t label_id, oid_t oid, vid_t& gid) const {
+    if (partitioned_ && fid != local_fid_) {
+      return getMirrorGid(label_id, oid, gid) && id_parser_.GetFid(gid) == fid;
+    }
     auto iter = o2g_[fid][label_id].find(oid);
     if (iter != o2g_[fid][label_id].end()) {
       gid = iter->second;
@@ -111,8 +291,26 @@ class ArrowVertexMap
     return false;
   }
 
+  /**
+   * @brief Find the gid of the oid in all fragments. The fragment is computed
+   * by the partitioner if the vertex map has been sealed with it, otherwise
+   * the fragments whose bloom filter rejects the oid are skipped without
+   * probing the hashmap.
+   */
   bool GetGid(label_id_t label_id, oid_t oid, vid_t& gid) const {
+    if (partitioned_) {
+      return GetGid(local_fid_, label_id, oid, gid) ||
+             getMirrorGid(label_id, oid, gid);
+    }
+    fid_t fid = 0;
+    if (partitioner_.GetPartitionId(oid, fid)) {
+      return fid < fnum_ && GetGid(fid, label_id, oid, gid);
+    }
+    size_t const hash = std::hash<oid_t>()(oid);
     for (fid_t i = 0; i < fnum_; ++i) {
+      if (has_o2g_filters_ && !o2g_filters_[i][label_id].contains_hash(hash)) {
+        continue;
+      }
       if (GetGid(i, label_id, oid, gid)) {
         return true;
       }
@@ -120,9 +318,106 @@ class ArrowVertexMap
     return false;
   }
 
+  /**
+   * @brief Map a batch of oids of the given fragment and label to gids, the
+   * lookups are batched (and prefetched) by `Hashmap::find_batch`.
+   *
+   * @return Whether all oids have been found, the gids of the oids that are
+   * not found are left unchanged.
+   */
+  bool GetGids(fid_t fid, label_id_t label_id, const std::vector<oid_t>& oids,
+               std::vector<vid_t>& gids) const {
+    if (partitioned_ && fid != local_fid_) {
+      gids.resize(oids.size());
+      bool all_found = true;
+      for (size_t i = 0; i < oids.size(); ++i) {
+        all_found &= GetGid(fid, label_id, oids[i], gids[i]);
+      }
+      return all_found;
+    }
+    using iterator_t = typename vineyard::Hashmap<oid_t, vid_t>::iterator;
+    constexpr size_t batch_size = 1024;
+    auto const& map = o2g_[fid][label_id];
+    iterator_t const end = map.end();
+    iterator_t iters[batch_size];
+    gids.resize(oids.size());
+    bool all_found = true;
+    for (size_t begin = 0; begin < oids.size(); begin += batch_size) {
+      size_t const size = std::min(batch_size, oids.size() - begin);
+      if (map.find_batch(oids.data() + begin, size, iters) != size) {
+        all_found = false;
+      }
+      for (size_t i = 0; i < size; ++i) {
+        if (iters[i] != end) {
+          gids[begin + i] = iters[i]->second;
+        }
+      }
+    }
+    return all_found;
+  }
+
+  /**
+   * @brief Map a batch of oids of the given label in all fragments to gids,
+   * the oids are grouped by the fragments that the partitioner computes,
+   * and then looked up in batches.
+   *
+   * @return Whether all oids have been found, the gids of the oids that are
+   * not found are left unchanged.
+   */
+  bool GetGids(label_id_t label_id, const std::vector<oid_t>& oids,
+               std::vector<vid_t>& gids) const {
+    gids.resize(oids.size());
+    std::vector<std::vector<size_t>> indices(fnum_);
+    bool all_found = true;
+    for (size_t i = 0; i < oids.size(); ++i) {
+      fid_t fid = 0;
+      if (!partitioned_ && partitioner_.GetPartitionId(oids[i], fid)) {
+        if (fid < fnum_) {
+          indices[fid].push_back(i);
+        } else {
+          all_found = false;
+        }
+      } else {
+        all_found &= GetGid(label_id, oids[i], gids[i]);
+      }
+    }
+    std::vector<oid_t> fragment_oids;
+    std::vector<vid_t> fragment_gids;
+    for (fid_t fid = 0; fid < fnum_; ++fid) {
+      if (indices[fid].empty()) {
+        continue;
+      }
+      fragment_oids.clear();
+      fragment_gids.clear();
+      for (size_t index : indices[fid]) {
+        fragment_oids.push_back(oids[index]);
+        fragment_gids.push_back(gids[index]);
+      }
+      all_found &= GetGids(fid, label_id, fragment_oids, fragment_gids);
+      for (size_t k = 0; k < indices[fid].size(); ++k) {
+        gids[indices[fid][k]] = fragment_gids[k];
+      }
+    }
+    return all_found;
+  }
+
+  /**
+   * @brief The oids of the fragment and label, which are the mirrored ones
+   * only for the remote fragments of a partitioned vertex map.
+   */
   std::vector<oid_t> GetOids(fid_t fid, label_id_t label_id) {
-    auto array = oid_arrays_[fid][label_id];
     std::vector<oid_t> oids;
+    if (partitioned_ && fid != local_fid_) {
+      auto const& mirror_oids = mirror_oids_[label_id];
+      const vid_t* mirror_gids = mirror_gids_[label_id]->raw_values();
+      for (int64_t i = 0; i < mirror_oids->length(); ++i) {
+        if (id_parser_.GetFid(mirror_gids[i]) == fid) {
+          oids.push_back(mirror_oids->GetView(i));
+        }
+      }
+      return oids;
+    }
+    auto array = oid_arrays_[fid][label_id];
 
     oids.resize(array->length());
     for (auto i = 0; i < array->length(); i++) {
@@ -132,13 +427,54 @@ class ArrowVertexMap
     return oids;
   }
 
+  /**
+   * @brief The sealed oid array of the fragment and label, which shares the
+   * blob and is indexed by the offsets of the gids, without copying.
+   *
+   * @return nullptr for the remote fragments of a partitioned vertex map, as
+   * only the mirrors of them are kept.
+   */
+  std::shared_ptr<oid_array_t> GetOidArray(fid_t fid,
+                                           label_id_t label_id) const {
+    if (partitioned_ && fid != local_fid_) {
+      return nullptr;
+    }
+    return oid_arrays_[fid][label_id];
+  }
+
+  /**
+   * @brief Map a batch of gids (of any fragments and labels) to oids, in
+   * parallel on the default thread pool.
+   *
+   * @return Whether all gids have been found, the oids of the gids that are
+   * not found are left unchanged.
+   */
+  bool GetOids(const vid_t* gids, size_t size, oid_t* oids,
+               int concurrency = static_cast<int>(
+                   std::thread::hardware_concurrency())) const {
+    std::atomic<bool> all_found(true);
+    ThreadPool::Default().ParallelFor(
+        size,
+        [&](size_t, size_t begin, size_t end) {
+          bool found = true;
+          for (size_t i = begin; i < end; ++i) {
+            found &= GetOid(gids[i], oids[i]);
+          }
+          if (!found) {
+            all_found.store(false, std::memory_order_relaxed);
+          }
+        },
+        concurrency);
+    return all_found.load();
+  }
+
   fid_t fnum() { return fnum_; }
 
   size_t GetTotalNodesNum() const {
     size_t num = 0;
-    for (auto& vec : oid_arrays_) {
+    for (auto& vec : vnums_) {
       for (auto& v : vec) {
-        num += v->length();
+        num += v;
       }
     }
     return num;
@@ -146,8 +482,8 @@ class ArrowVertexMap
 
   size_t GetTotalNodesNum(label_id_t label) const {
     size_t num = 0;
-    for (auto& vec : oid_arrays_) {
-      num += vec[label]->length();
+    for (auto& vec : vnums_) {
+      num += vec[label];
     }
     return num;
   }
@@ -156,17 +492,38 @@ class ArrowVertexMap
 
   vid_t GetInnerVertexSize(fid_t fid) const {
     size_t num = 0;
-    for (auto& v : oid_arrays_[fid]) {
-      num += v->length();
+    for (auto& v : vnums_[fid]) {
+      num += v;
     }
     return static_cast<vid_t>(num);
   }
 
   vid_t GetInnerVertexSize(fid_t fid, label_id_t label_id) const {
-    return static_cast<vid_t>(oid_arrays_[fid][label_id]->length());
+    return static_cast<vid_t>(vnums_[fid][label_id]);
   }
 
  private:
+  bool getMirrorOid(label_id_t label, vid_t gid, oid_t& oid) const {
+    auto const& gids = mirror_gids_[label];
+    const vid_t* begin = gids->raw_values();
+    const vid_t* end = begin + gids->length();
+    const vid_t* iter = std::lower_bound(begin, end, gid);
+    if (iter == end || *iter != gid) {
+      return false;
+    }
+    oid = mirror_oids_[label]->GetView(iter - begin);
+    return true;
+  }
+
+  bool getMirrorGid(label_id_t label, oid_t oid, vid_t& gid) const {
+    auto iter = mirror_o2g_[label].find(oid);
+    if (iter != mirror_o2g_[label].end()) {
+      gid = iter->second;
+      return true;
+    }
+    return false;
+  }
+
   fid_t fnum_;
   label_id_t label_num_;
 
@@ -175,6 +532,21 @@ class ArrowVertexMap
   // frag->label->oid
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
   std::vector<std::vector<vineyard::Hashmap<oid_t, vid_t>>> o2g_;
+  // frag->label->bloom filter of the oids, to prune the fragments in lookups
+  std::vector<std::vector<vineyard::BloomFilter<oid_t>>> o2g_filters_;
+  bool has_o2g_filters_ = false;
+  // frag->label->the number of vertices
+  std::vector<std::vector<int64_t>> vnums_;
+
+  // the partitioned vertex map only has the members of the local fragment,
+  // and the mirrors (sorted by gids) of the remote vertices of each label.
+  bool partitioned_ = false;
+  fid_t local_fid_ = 0;
+  std::vector<std::shared_ptr<oid_array_t>> mirror_oids_;
+  std::vector<std::shared_ptr<vid_array_t>> mirror_gids_;
+  std::vector<vineyard::Hashmap<oid_t, vid_t>> mirror_o2g_;
+
+  detail::VertexMapPartitioner<oid_t> partitioner_;
 
   template <typename _OID_T, typename _VID_T>
   friend class ArrowVertexMapBuilder;
@@ -220,6 +592,7 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
         oid_arrays_[i][j] = array.GetArray();
       }
     }
+    partitioner_.Construct(meta);
 
     initHashmaps();
   }
@@ -239,23 +612,54 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
   }
 
   bool GetGid(fid_t fid, label_id_t label_id, oid_t oid, vid_t& gid) const {
-    auto iter = o2g_[fid][label_id].find(oid);
-    if (iter != o2g_[fid][label_id].end()) {
-      gid = iter->second;
-      return true;
-    }
-    return false;
+    return lookup(fid, label_id, oid,
+                  string_hash_table::hash(oid.data(), oid.size()), gid);
   }
 
+  /**
+   * @brief Find the gid of the oid in all fragments, the fragment is computed
+   * by the partitioner if the vertex map has been sealed with it.
+   */
   bool GetGid(label_id_t label_id, oid_t oid, vid_t& gid) const {
+    uint32_t const hash = string_hash_table::hash(oid.data(), oid.size());
+    fid_t fid = 0;
+    if (partitioner_.GetPartitionId(oid, fid)) {
+      return fid < fnum_ && lookup(fid, label_id, oid, hash, gid);
+    }
     for (fid_t i = 0; i < fnum_; ++i) {
-      if (GetGid(i, label_id, oid, gid)) {
+      if (lookup(i, label_id, oid, hash, gid)) {
         return true;
       }
     }
     return false;
   }
 
+  bool GetGids(fid_t fid, label_id_t label_id, const std::vector<oid_t>& oids,
+               std::vector<vid_t>& gids) const {
+    gids.resize(oids.size());
+    bool all_found = true;
+    for (size_t i = 0; i < oids.size(); ++i) {
+      all_found &= GetGid(fid, label_id, oids[i], gids[i]);
+    }
+    return all_found;
+  }
+
+  /**
+   * @brief Map a batch of oids of the given label in all fragments to gids.
+   *
+   * @return Whether all oids have been found, the gids of the oids that are
+   * not found are left unchanged.
+   */
+  bool GetGids(label_id_t label_id, const std::vector<oid_t>& oids,
+               std::vector<vid_t>& gids) const {
+    gids.resize(oids.size());
+    bool all_found = true;
+    for (size_t i = 0; i < oids.size(); ++i) {
+      all_found &= GetGid(label_id, oids[i], gids[i]);
+    }
+    return all_found;
+  }
+
   std::vector<oid_t> GetOids(fid_t fid, label_id_t label_id) {
     auto array = oid_arrays_[fid][label_id];
     std::vector<oid_t> oids;
@@ -268,6 +672,42 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
     return oids;
   }
 
+  /**
+   * @brief The sealed oid array of the fragment and label, which shares the
+   * blob and is indexed by the offsets of the gids, without copying.
+   */
+  std::shared_ptr<oid_array_t> GetOidArray(fid_t fid,
+                                           label_id_t label_id) const {
+    return oid_arrays_[fid][label_id];
+  }
+
+  /**
+   * @brief Map a batch of gids (of any fragments and labels) to oids, in
+   * parallel on the default thread pool. The oids are views of the sealed
+   * oid arrays.
+   *
+   * @return Whether all gids have been found, the oids of the gids that are
+   * not found are left unchanged.
+   */
+  bool GetOids(const vid_t* gids, size_t size, oid_t* oids,
+               int concurrency = static_cast<int>(
+                   std::thread::hardware_concurrency())) const {
+    std::atomic<bool> all_found(true);
+    ThreadPool::Default().ParallelFor(
+        size,
+        [&](size_t, size_t begin, size_t end) {
+          bool found = true;
+          for (size_t i = begin; i < end; ++i) {
+            found &= GetOid(gids[i], oids[i]);
+          }
+          if (!found) {
+            all_found.store(false, std::memory_order_relaxed);
+          }
+        },
+        concurrency);
+    return all_found.load();
+  }
+
   fid_t fnum() { return fnum_; }
 
   size_t GetTotalNodesNum() const {
@@ -303,25 +743,52 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
   }
 
  private:
+  /**
+   * The oids are indexed in place: the table only keeps the hash code and the
+   * offset of each oid, and the bytes are compared in the oid arrays, rather
+   * than keeping a `string_view` and a gid per entry.
+   */
   void initHashmaps() {
     o2g_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       o2g_[i].resize(label_num_);
       for (label_id_t j = 0; j < label_num_; ++j) {
         auto array = oid_arrays_[i][j];
-        auto& map = o2g_[i][j];
-        {
-          vid_t cur_gid = id_parser_.GenerateId(i, j, 0);
-          int64_t vnum = array->length();
-          for (int64_t k = 0; k < vnum; ++k) {
-            map.emplace(array->GetView(k), cur_gid);
-            ++cur_gid;
-          }
+        auto& slots = o2g_[i][j];
+        int64_t vnum = array->length();
+        CHECK_LE(static_cast<size_t>(vnum), string_hash_table::kMaxElements);
+        slots.resize(string_hash_table::capacity_for(vnum),
+                     string_hash_table::slot_t{0, string_hash_table::kEmpty});
+        const int32_t* offsets = array->raw_value_offsets();
+        const char* data = oid_data(array);
+        for (int64_t k = 0; k < vnum; ++k) {
+          string_hash_table::emplace(slots.data(), slots.size() - 1, offsets,
+                                     data, static_cast<uint32_t>(k));
         }
       }
     }
   }
 
+  bool lookup(fid_t fid, label_id_t label_id, oid_t oid, uint32_t hash,
+              vid_t& gid) const {
+    auto& array = oid_arrays_[fid][label_id];
+    auto& slots = o2g_[fid][label_id];
+    int64_t offset = string_hash_table::find(
+        slots.data(), slots.size() - 1, array->raw_value_offsets(),
+        oid_data(array), oid.data(), oid.size(), hash);
+    if (offset != -1) {
+      gid = id_parser_.GenerateId(fid, label_id, offset);
+      return true;
+    }
+    return false;
+  }
+
+  static const char* oid_data(const std::shared_ptr<oid_array_t>& array) {
+    auto buffer = array->value_data();
+    return buffer == nullptr ? nullptr
+                             : reinterpret_cast<const char*>(buffer->data());
+  }
+
   fid_t fnum_;
   label_id_t label_num_;
 
@@ -329,7 +796,10 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
 
   // frag->label->oid
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
-  std::vector<std::vector<ska::flat_hash_map<oid_t, vid_t>>> o2g_;
+  // frag->label->slots of the oids
+  std::vector<std::vector<std::vector<string_hash_table::slot_t>>> o2g_;
+
+  detail::VertexMapPartitioner<oid_t> partitioner_;
 
   template <typename _OID_T, typename _VID_T>
   friend class ArrowVertexMapBuilder;
@@ -352,9 +822,11 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
     label_num_ = label_num;
     oid_arrays_.resize(fnum_);
     o2g_.resize(fnum_);
+    o2g_filters_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       oid_arrays_[i].resize(label_num_);
       o2g_[i].resize(label_num_);
+      o2g_filters_[i].resize(label_num_);
     }
   }
 
@@ -369,6 +841,47 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
     o2g_[fid][label] = rm;
   }
 
+  void set_o2g_filter(
+      fid_t fid, label_id_t label,
+      const std::shared_ptr<vineyard::BloomFilter<oid_t>>& filter) {
+    o2g_filters_[fid][label] = filter;
+  }
+
+  /**
+   * @brief Keep the partitioner of the vertices in the vertex map, thus the
+   * fragment of an oid is computed in `GetGid(label_id, oid, gid)` rather
+   * than probed.
+   */
+  template <typename PARTITIONER_T>
+  void set_partitioner(const PARTITIONER_T& partitioner) {
+    partitioner_.Init(partitioner);
+  }
+
+  /**
+   * @brief Seal a partitioned vertex map, which only has the members of
+   * `local_fid`, and the number of vertices (label/fid) of all fragments.
+   */
+  void set_partitioned(fid_t local_fid,
+                       const std::vector<std::vector<int64_t>>& vnums) {
+    partitioned_ = true;
+    local_fid_ = local_fid;
+    vnums_ = vnums;
+  }
+
+  void set_mirror(label_id_t label,
+                  const typename InternalType<oid_t>::vineyard_array_type& oids,
+                  const vineyard::NumericArray<vid_t>& gids,
+                  const vineyard::Hashmap<oid_t, vid_t>& o2g) {
+    if (mirror_o2g_.size() <= static_cast<size_t>(label)) {
+      mirror_oids_.resize(label + 1);
+      mirror_gids_.resize(label + 1);
+      mirror_o2g_.resize(label + 1);
+    }
+    mirror_oids_[label] = oids;
+    mirror_gids_[label] = gids;
+    mirror_o2g_[label] = o2g;
+  }
+
   std::shared_ptr<vineyard::Object> _Seal(vineyard::Client& client) {
     // ensure the builder hasn't been sealed yet.
     ENSURE_NOT_SEALED(this);
@@ -379,26 +892,74 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
     vertex_map->fnum_ = fnum_;
     vertex_map->label_num_ = label_num_;
     vertex_map->id_parser_.Init(fnum_, label_num_);
+    vertex_map->partitioned_ = partitioned_;
+    vertex_map->local_fid_ = local_fid_;
+    vertex_map->partitioner_ = partitioner_;
 
     vertex_map->oid_arrays_.resize(fnum_);
+    vertex_map->vnums_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       auto& array = vertex_map->oid_arrays_[i];
       array.resize(label_num_);
+      vertex_map->vnums_[i].resize(label_num_);
       for (label_id_t j = 0; j < label_num_; ++j) {
+        if (partitioned_ && i != local_fid_) {
+          vertex_map->vnums_[i][j] = vnums_[j][i];
+          continue;
+        }
         array[j] = oid_arrays_[i][j].GetArray();
+        vertex_map->vnums_[i][j] = array[j]->length();
       }
     }
 
     vertex_map->o2g_ = o2g_;
+    vertex_map->o2g_filters_.resize(fnum_);
+    vertex_map->has_o2g_filters_ = true;
+    for (fid_t i = 0; i < fnum_; ++i) {
+      vertex_map->o2g_filters_[i].resize(label_num_);
+      for (label_id_t j = 0; j < label_num_; ++j) {
+        if (o2g_filters_[i][j] == nullptr) {
+          vertex_map->has_o2g_filters_ = false;
+        } else {
+          vertex_map->o2g_filters_[i][j] = *o2g_filters_[i][j];
+        }
+      }
+    }
 
     vertex_map->meta_.SetTypeName(type_name<ArrowVertexMap<oid_t, vid_t>>());
 
     vertex_map->meta_.AddKeyValue("fnum", fnum_);
     vertex_map->meta_.AddKeyValue("label_num", label_num_);
+    partitioner_.AddToMeta(vertex_map->meta_);
 
     size_t nbytes = 0;
+    if (partitioned_) {
+      vertex_map->meta_.AddKeyValue("partitioned", true);
+      vertex_map->meta_.AddKeyValue("local_fid", local_fid_);
+      vertex_map->mirror_oids_.resize(label_num_);
+      vertex_map->mirror_gids_.resize(label_num_);
+      vertex_map->mirror_o2g_ = mirror_o2g_;
+      for (label_id_t j = 0; j < label_num_; ++j) {
+        vertex_map->mirror_oids_[j] = mirror_oids_[j].GetArray();
+        vertex_map->mirror_gids_[j] = mirror_gids_[j].GetArray();
+        vertex_map->meta_.AddMember("mirror_oids_" + std::to_string(j),
+                                    mirror_oids_[j].meta());
+        vertex_map->meta_.AddMember("mirror_gids_" + std::to_string(j),
+                                    mirror_gids_[j].meta());
+        vertex_map->meta_.AddMember("mirror_o2g_" + std::to_string(j),
+                                    mirror_o2g_[j].meta());
+        nbytes += mirror_oids_[j].nbytes() + mirror_gids_[j].nbytes() +
+                  mirror_o2g_[j].nbytes();
+      }
+    }
     for (fid_t i = 0; i < fnum_; ++i) {
       for (label_id_t j = 0; j < label_num_; ++j) {
+        if (partitioned_ && i != local_fid_) {
+          vertex_map->meta_.AddKeyValue(
+              "vnum_" + std::to_string(i) + "_" + std::to_string(j),
+              vnums_[j][i]);
+          continue;
+        }
         vertex_map->meta_.AddMember(
             "oid_arrays_" + std::to_string(i) + "_" + std::to_string(j),
             oid_arrays_[i][j].meta());
@@ -408,6 +969,13 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
             "o2g_" + std::to_string(i) + "_" + std::to_string(j),
             o2g_[i][j].meta());
         nbytes += o2g_[i][j].nbytes();
+
+        if (o2g_filters_[i][j] != nullptr) {
+          vertex_map->meta_.AddMember(
+              "o2g_filter_" + std::to_string(i) + "_" + std::to_string(j),
+              o2g_filters_[i][j]->meta());
+          nbytes += o2g_filters_[i][j]->nbytes();
+        }
       }
     }
 
@@ -421,6 +989,16 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
     return std::static_pointer_cast<vineyard::Object>(vertex_map);
   }
 
+ protected:
+  bool partitioned() const { return partitioned_; }
+
+  fid_t local_fid() const { return local_fid_; }
+
+  const vineyard::Hashmap<oid_t, vid_t>& o2g(fid_t fid,
+                                             label_id_t label) const {
+    return o2g_[fid][label];
+  }
+
  private:
   fid_t fnum_;
   label_id_t label_num_;
@@ -428,6 +1006,17 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
   std::vector<std::vector<typename InternalType<oid_t>::vineyard_array_type>>
       oid_arrays_;
   std::vector<std::vector<vineyard::Hashmap<oid_t, vid_t>>> o2g_;
+  std::vector<std::vector<std::shared_ptr<vineyard::BloomFilter<oid_t>>>>
+      o2g_filters_;
+
+  bool partitioned_ = false;
+  fid_t local_fid_ = 0;
+  // label/fid
+  std::vector<std::vector<int64_t>> vnums_;
+  std::vector<typename InternalType<oid_t>::vineyard_array_type> mirror_oids_;
+  std::vector<vineyard::NumericArray<vid_t>> mirror_gids_;
+  std::vector<vineyard::Hashmap<oid_t, vid_t>> mirror_o2g_;
+  detail::VertexMapPartitioner<oid_t> partitioner_;
 };
 
 template <typename VID_T>
@@ -455,6 +1044,16 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
     oid_arrays_[fid][label] = array;
   }
 
+  /**
+   * @brief Keep the partitioner of the vertices in the vertex map, thus the
+   * fragment of an oid is computed in `GetGid(label_id, oid, gid)` rather
+   * than probed.
+   */
+  template <typename PARTITIONER_T>
+  void set_partitioner(const PARTITIONER_T& partitioner) {
+    partitioner_.Init(partitioner);
+  }
+
   std::shared_ptr<vineyard::Object> _Seal(vineyard::Client& client) {
     // ensure the builder hasn't been sealed yet.
     ENSURE_NOT_SEALED(this);
@@ -466,6 +1065,7 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
     vertex_map->fnum_ = fnum_;
     vertex_map->label_num_ = label_num_;
     vertex_map->id_parser_.Init(fnum_, label_num_);
+    vertex_map->partitioner_ = partitioner_;
 
     vertex_map->oid_arrays_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
@@ -480,6 +1080,7 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
 
     vertex_map->meta_.AddKeyValue("fnum", fnum_);
     vertex_map->meta_.AddKeyValue("label_num", label_num_);
+    partitioner_.AddToMeta(vertex_map->meta_);
 
     size_t nbytes = 0;
     for (fid_t i = 0; i < fnum_; ++i) {
@@ -506,13 +1107,75 @@ class ArrowVertexMapBuilder<arrow::util::string_view, VID_T>
 
   std::vector<std::vector<typename InternalType<oid_t>::vineyard_array_type>>
       oid_arrays_;
+  detail::VertexMapPartitioner<oid_t> partitioner_;
 };
 
+namespace detail {
+
+/**
+ * @brief The workers that connect to the same vineyardd, which build disjoint
+ * subsets of the members of a vertex map, and exchange the object ids of the
+ * sealed members, rather than every worker building all of them.
+ *
+ * Without a comm spec, the group has only the current worker.
+ */
+class VertexMapBuildGroup {
+ public:
+  VertexMapBuildGroup(vineyard::Client& client,
+                      const grape::CommSpec* comm_spec) {
+    if (comm_spec == nullptr || comm_spec->worker_num() == 1) {
+      return;
+    }
+    int worker_num = comm_spec->worker_num();
+    InstanceID instance_id = client.instance_id();
+    std::vector<InstanceID> instance_ids(worker_num);
+    MPI_Allgather(&instance_id, 1, MPI_UINT64_T, instance_ids.data(), 1,
+                  MPI_UINT64_T, comm_spec->comm());
+    // colored by the first worker of the group
+    int color = 0;
+    while (instance_ids[color] != instance_id) {
+      ++color;
+    }
+    MPI_Comm_split(comm_spec->comm(), color, comm_spec->worker_id(), &comm_);
+    MPI_Comm_rank(comm_, &rank_);
+    MPI_Comm_size(comm_, &size_);
+  }
+
+  ~VertexMapBuildGroup() {
+    if (comm_ != MPI_COMM_NULL) {
+      MPI_Comm_free(&comm_);
+    }
+  }
+
+  bool Owns(size_t task) const {
+    return static_cast<int>(task % size_) == rank_;
+  }
+
+  /**
+   * @brief Every slot of the ids is filled by the owner of the task, and is
+   * zero on the other workers.
+   */
+  void Exchange(std::vector<ObjectID>& ids) const {
+    if (size_ > 1) {
+      MPI_Allreduce(MPI_IN_PLACE, ids.data(), static_cast<int>(ids.size()),
+                    MPI_UINT64_T, MPI_MAX, comm_);
+    }
+  }
+
+ private:
+  MPI_Comm comm_ = MPI_COMM_NULL;
+  int rank_ = 0;
+  int size_ = 1;
+};
+
+}  // namespace detail
+
 template <typename OID_T, typename VID_T>
 class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
   using oid_t = OID_T;
   using vid_t = VID_T;
   using oid_array_t = typename vineyard::ConvertToArrowType<oid_t>::ArrayType;
+  using vid_array_t = typename vineyard::ConvertToArrowType<vid_t>::ArrayType;
   using label_id_t = property_graph_types::LABEL_ID_TYPE;
 
  public:
@@ -527,9 +1190,92 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
     id_parser_.Init(fnum_, label_num_);
   }
 
+  /**
+   * @brief Let the workers that connect to the same vineyardd build the
+   * members of the vertex map together, and share the sealed members, which
+   * is a collective operation on all workers of the comm spec.
+   */
+  void ShareWithLocalWorkers(const grape::CommSpec& comm_spec) {
+    comm_spec_ = &comm_spec;
+  }
+
+  /**
+   * @brief Build a partitioned vertex map, where only the oid arrays of
+   * `local_fid` are required, and `vnums` (label/fid) is the number of
+   * vertices of every fragment.
+   *
+   * The local members are built by `BuildLocal`, and the mirrors of remote
+   * vertices should be set by `SetMirrors` before sealing.
+   */
+  void SetPartitioned(fid_t local_fid,
+                      const std::vector<std::vector<int64_t>>& vnums) {
+    this->set_partitioned(local_fid, vnums);
+  }
+
+  vineyard::Status BuildLocal(vineyard::Client& client) {
+    if (!this->partitioned()) {
+      return vineyard::Status::Invalid(
+          "BuildLocal() requires a partitioned vertex map");
+    }
+    if (!local_built_) {
+      this->set_fnum_label_num(fnum_, label_num_);
+      RETURN_ON_ERROR(buildMembers(client));
+      local_built_ = true;
+    }
+    return vineyard::Status::OK();
+  }
+
+  /**
+   * @brief Lookup the gids of oids in the local fragment, after the local
+   * members have been built, the gids of missing oids are `max()`.
+   */
+  void GetLocalGids(label_id_t label, const std::vector<oid_t>& oids,
+                    std::vector<vid_t>& gids) const {
+    gids.resize(oids.size());
+    for (size_t i = 0; i < oids.size(); ++i) {
+      if (!GetLocalGid(label, oids[i], gids[i])) {
+        gids[i] = std::numeric_limits<vid_t>::max();
+      }
+    }
+  }
+
+  bool GetLocalGid(label_id_t label, oid_t oid, vid_t& gid) const {
+    auto const& o2g = this->o2g(this->local_fid(), label);
+    auto iter = o2g.find(oid);
+    if (iter != o2g.end()) {
+      gid = iter->second;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief The remote vertices that the local fragment refers to, where the
+   * gids are sorted.
+   */
+  void SetMirrors(const std::vector<std::shared_ptr<oid_array_t>>& oids,
+                  const std::vector<std::shared_ptr<vid_array_t>>& gids) {
+    CHECK_EQ(oids.size(), static_cast<size_t>(label_num_));
+    CHECK_EQ(gids.size(), static_cast<size_t>(label_num_));
+    mirror_oids_ = oids;
+    mirror_gids_ = gids;
+  }
+
   vineyard::Status Build(vineyard::Client& client) override {
     this->set_fnum_label_num(fnum_, label_num_);
+    if (!this->partitioned()) {
+      return buildMembers(client);
+    }
+    if (!local_built_ || mirror_oids_.empty()) {
+      return vineyard::Status::Invalid(
+          "The partitioned vertex map requires BuildLocal() and SetMirrors() "
+          "before sealing");
+    }
+    return buildMirrors(client);
+  }
 
+ private:
+  vineyard::Status buildMembers(vineyard::Client& client) {
 #if 0
     for (fid_t i = 0; i < fnum_; ++i) {
       // TODO(luoxiaojian): parallel construct hashmap
@@ -560,67 +1306,139 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
       }
     }
 #else
+    // the partitioned vertex map builds the local members only
+    bool partitioned = this->partitioned();
+    fid_t local_fid = this->local_fid();
+    detail::VertexMapBuildGroup group(client,
+                                      partitioned ? nullptr : comm_spec_);
+    auto builds = [&](size_t task) -> bool {
+      if (partitioned) {
+        return static_cast<fid_t>(task) % fnum_ == local_fid;
+      }
+      return group.Owns(task);
+    };
     int task_num = static_cast<int>(fnum_) * static_cast<int>(label_num_);
     int thread_num = std::min(
         static_cast<int>(std::thread::hardware_concurrency()), task_num);
     std::mutex lock;
-    std::atomic<int> task_id(0);
-
-    std::vector<std::thread> threads(thread_num);
-    for (int i = 0; i < thread_num; ++i) {
-      threads[i] = std::thread([&]() {
-        while (true) {
-          int got_task_id = task_id.fetch_add(1);
-          if (got_task_id >= task_num) {
-            break;
-          }
-          fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
-          label_id_t cur_label =
-              static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
-
-          vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
-          auto array = oid_arrays_[cur_label][cur_fid];
-          {
-            vid_t cur_gid = id_parser_.GenerateId(cur_fid, cur_label, 0);
-            int64_t vnum = array->length();
-            for (int64_t k = 0; k < vnum; ++k) {
-              builder.emplace(array->GetView(k), cur_gid);
-              ++cur_gid;
+    // the oid array, the hashmap and the filter of every task
+    std::vector<ObjectID> member_ids(task_num * 3, 0);
+
+    ThreadPool::Default().ParallelFor(
+        task_num,
+        [&](size_t, size_t begin, size_t end) {
+          for (size_t got_task_id = begin; got_task_id < end; ++got_task_id) {
+            if (!builds(got_task_id)) {
+              continue;
+            }
+            fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
+            label_id_t cur_label = static_cast<label_id_t>(
+                static_cast<fid_t>(got_task_id) / fnum_);
+
+            vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
+            auto array = oid_arrays_[cur_label][cur_fid];
+            std::unique_ptr<vineyard::BloomFilterBuilder<oid_t>>
+                filter_builder;
+            {
+              std::lock_guard<std::mutex> guard(lock);
+              filter_builder.reset(new vineyard::BloomFilterBuilder<oid_t>(
+                  client, array->length()));
+            }
+            {
+              vid_t cur_gid = id_parser_.GenerateId(cur_fid, cur_label, 0);
+              int64_t vnum = array->length();
+              for (int64_t k = 0; k < vnum; ++k) {
+                builder.emplace(array->GetView(k), cur_gid);
+                filter_builder->insert(array->GetView(k));
+                ++cur_gid;
+              }
             }
-          }
 
-          {
-            std::lock_guard<std::mutex> guard(lock);
-            typename InternalType<oid_t>::vineyard_builder_type array_builder(
-                client, array);
-            this->set_oid_array(
-                cur_fid, cur_label,
-                *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
-                    array_builder.Seal(client)));
-
-            this->set_o2g(
-                cur_fid, cur_label,
-                *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
-                    builder.Seal(client)));
+            {
+              std::lock_guard<std::mutex> guard(lock);
+              typename InternalType<oid_t>::vineyard_builder_type array_builder(
+                  client, array);
+              auto oid_array =
+                  std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
+                      array_builder.Seal(client));
+              auto o2g =
+                  std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
+                      builder.Seal(client));
+              auto filter =
+                  std::dynamic_pointer_cast<vineyard::BloomFilter<oid_t>>(
+                      filter_builder->Seal(client));
+              this->set_oid_array(cur_fid, cur_label, *oid_array);
+              this->set_o2g(cur_fid, cur_label, *o2g);
+              this->set_o2g_filter(cur_fid, cur_label, filter);
+              member_ids[got_task_id * 3] = oid_array->id();
+              member_ids[got_task_id * 3 + 1] = o2g->id();
+              member_ids[got_task_id * 3 + 2] = filter->id();
+            }
           }
-        }
-      });
-    }
-    for (auto& thrd : threads) {
-      thrd.join();
+        },
+        thread_num, 1);
+
+    // the members sealed by the other workers of the group
+    group.Exchange(member_ids);
+    for (int task_id = 0; task_id < task_num && !partitioned; ++task_id) {
+      if (group.Owns(task_id)) {
+        continue;
+      }
+      fid_t cur_fid = static_cast<fid_t>(task_id) % fnum_;
+      label_id_t cur_label =
+          static_cast<label_id_t>(static_cast<fid_t>(task_id) / fnum_);
+      std::shared_ptr<vineyard::NumericArray<oid_t>> oid_array;
+      RETURN_ON_ERROR(client.GetObject(member_ids[task_id * 3], oid_array));
+      std::shared_ptr<vineyard::Hashmap<oid_t, vid_t>> o2g;
+      RETURN_ON_ERROR(client.GetObject(member_ids[task_id * 3 + 1], o2g));
+      std::shared_ptr<vineyard::BloomFilter<oid_t>> filter;
+      RETURN_ON_ERROR(client.GetObject(member_ids[task_id * 3 + 2], filter));
+      this->set_oid_array(cur_fid, cur_label, *oid_array);
+      this->set_o2g(cur_fid, cur_label, *o2g);
+      this->set_o2g_filter(cur_fid, cur_label, filter);
     }
 #endif
 
     return vineyard::Status::OK();
   }
 
- private:
+  vineyard::Status buildMirrors(vineyard::Client& client) {
+    for (label_id_t label = 0; label < label_num_; ++label) {
+      auto const& oids = mirror_oids_[label];
+      auto const& gids = mirror_gids_[label];
+      vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
+      builder.reserve(static_cast<size_t>(oids->length()));
+      for (int64_t k = 0; k < oids->length(); ++k) {
+        builder.emplace(oids->GetView(k), gids->GetView(k));
+      }
+      typename InternalType<oid_t>::vineyard_builder_type oid_builder(client,
+                                                                      oids);
+      typename InternalType<vid_t>::vineyard_builder_type gid_builder(client,
+                                                                      gids);
+      this->set_mirror(
+          label,
+          *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
+              oid_builder.Seal(client)),
+          *std::dynamic_pointer_cast<vineyard::NumericArray<vid_t>>(
+              gid_builder.Seal(client)),
+          *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
+              builder.Seal(client)));
+    }
+    return vineyard::Status::OK();
+  }
+
   fid_t fnum_;
   label_id_t label_num_;
 
   vineyard::IdParser<vid_t> id_parser_;
 
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
+
+  const grape::CommSpec* comm_spec_ = nullptr;
+
+  bool local_built_ = false;
+  std::vector<std::shared_ptr<oid_array_t>> mirror_oids_;
+  std::vector<std::shared_ptr<vid_array_t>> mirror_gids_;
 };
 
 template <typename VID_T>
@@ -643,21 +1461,52 @@ class BasicArrowVertexMapBuilder<arrow::util::string_view, VID_T>
     id_parser_.Init(fnum_, label_num_);
   }
 
+  /**
+   * @brief Let the workers that connect to the same vineyardd build the
+   * members of the vertex map together, and share the sealed members, which
+   * is a collective operation on all workers of the comm spec.
+   */
+  void ShareWithLocalWorkers(const grape::CommSpec& comm_spec) {
+    comm_spec_ = &comm_spec;
+  }
+
   vineyard::Status Build(vineyard::Client& client) override {
     this->set_fnum_label_num(fnum_, label_num_);
 
-    for (fid_t i = 0; i < fnum_; ++i) {
-      // TODO(luoxiaojian): parallel construct hashmap
-      for (label_id_t j = 0; j < label_num_; ++j) {
-        auto array = oid_arrays_[j][i];
-        typename InternalType<oid_t>::vineyard_builder_type array_builder(
-            client, array);
-        this->set_oid_array(
-            i, j,
-            *std::dynamic_pointer_cast<
-                typename InternalType<oid_t>::vineyard_array_type>(
-                array_builder.Seal(client)));
+    // the hash tables of string oids are built when the vertex map is
+    // constructed, only the oid arrays are sealed here
+    detail::VertexMapBuildGroup group(client, comm_spec_);
+    int task_num = static_cast<int>(fnum_) * static_cast<int>(label_num_);
+    std::vector<ObjectID> member_ids(task_num, 0);
+    for (int task_id = 0; task_id < task_num; ++task_id) {
+      if (!group.Owns(task_id)) {
+        continue;
       }
+      fid_t cur_fid = static_cast<fid_t>(task_id) % fnum_;
+      label_id_t cur_label =
+          static_cast<label_id_t>(static_cast<fid_t>(task_id) / fnum_);
+      typename InternalType<oid_t>::vineyard_builder_type array_builder(
+          client, oid_arrays_[cur_label][cur_fid]);
+      auto oid_array = std::dynamic_pointer_cast<
+          typename InternalType<oid_t>::vineyard_array_type>(
+          array_builder.Seal(client));
+      this->set_oid_array(cur_fid, cur_label, *oid_array);
+      member_ids[task_id] = oid_array->id();
+    }
+
+    // the oid arrays sealed by the other workers of the group
+    group.Exchange(member_ids);
+    for (int task_id = 0; task_id < task_num; ++task_id) {
+      if (group.Owns(task_id)) {
+        continue;
+      }
+      fid_t cur_fid = static_cast<fid_t>(task_id) % fnum_;
+      label_id_t cur_label =
+          static_cast<label_id_t>(static_cast<fid_t>(task_id) / fnum_);
+      std::shared_ptr<typename InternalType<oid_t>::vineyard_array_type>
+          oid_array;
+      RETURN_ON_ERROR(client.GetObject(member_ids[task_id], oid_array));
+      this->set_oid_array(cur_fid, cur_label, *oid_array);
     }
     return vineyard::Status::OK();
   }
@@ -669,6 +1518,8 @@ class BasicArrowVertexMapBuilder<arrow::util::string_view, VID_T>
   vineyard::IdParser<vid_t> id_parser_;
 
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
+
+  const grape::CommSpec* comm_spec_ = nullptr;
 };
 
 }  // namespace vineyard
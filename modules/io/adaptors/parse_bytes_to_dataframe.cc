@@ -13,14 +13,21 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "arrow/api.h"
 #include "arrow/csv/api.h"
 #include "arrow/io/api.h"
 #include "arrow/util/config.h"
+#include "arrow/util/thread_pool.h"
 
+#include "basic/ds/arrow_utils.h"
 #include "basic/stream/byte_stream.h"
 #include "basic/stream/dataframe_stream.h"
 #include "basic/stream/parallel_stream.h"
@@ -30,22 +37,26 @@ limitations under the License.
 
 using namespace vineyard;  // NOLINT(build/namespaces)
 
-void ParseTable(std::shared_ptr<arrow::Table>* table,
-                std::unique_ptr<arrow::Buffer>& buffer, char delimiter,
-                bool header_row, std::vector<std::string> col_names) {
-  // FIXME IF NO NEED TO COPY
-  std::shared_ptr<arrow::Buffer> copied_buffer;
-#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
-  CHECK_ARROW_ERROR(buffer->Copy(0, buffer->size(), &copied_buffer));
-#else
-  CHECK_ARROW_ERROR_AND_ASSIGN(copied_buffer,
-                               buffer->CopySlice(0, buffer->size()));
-#endif
-  auto buffer_reader = std::make_shared<arrow::io::BufferReader>(copied_buffer);
+// the smallest block, the records must be shorter than it
+constexpr int64_t kMinParseBlockSize = 64 * 1024;
+
+/**
+ * The chunk is cut into `concurrency` blocks at the record boundaries, which
+ * are parsed by the threads of the arrow's CPU pool in parallel, and every
+ * parsed block is a record batch, which is written as a chunk of the
+ * dataframe stream without combining the blocks.
+ */
+void ParseBatches(std::vector<std::shared_ptr<arrow::RecordBatch>>* batches,
+                  std::unique_ptr<arrow::Buffer>& buffer, char delimiter,
+                  bool header_row, std::vector<std::string> col_names,
+                  int concurrency) {
+  // the chunk is parsed in place: the parsed batches are written to the
+  // dataframe stream before the next chunk is pulled
+  std::shared_ptr<arrow::Buffer> chunk = std::move(buffer);
+  auto buffer_reader = std::make_shared<arrow::io::BufferReader>(chunk);
 
   std::shared_ptr<arrow::io::InputStream> input =
-      arrow::io::RandomAccessFile::GetStream(buffer_reader, 0,
-                                             copied_buffer->size());
+      arrow::io::RandomAccessFile::GetStream(buffer_reader, 0, chunk->size());
 
   arrow::MemoryPool* pool = arrow::default_memory_pool();
 
@@ -59,23 +70,31 @@ void ParseTable(std::shared_ptr<arrow::Table>* table,
     read_options.autogenerate_column_names = (!header_row);
   }
   parse_options.delimiter = delimiter;
+  read_options.use_threads = (concurrency > 1);
+  if (concurrency > 1) {
+    int64_t block_size = (chunk->size() + concurrency - 1) / concurrency;
+    read_options.block_size = static_cast<int32_t>(std::max(
+        kMinParseBlockSize,
+        std::min(block_size,
+                 static_cast<int64_t>(std::numeric_limits<int32_t>::max()))));
+  }
 
   std::shared_ptr<arrow::csv::TableReader> reader;
   CHECK_ARROW_ERROR_AND_ASSIGN(
       reader, arrow::csv::TableReader::Make(pool, input, read_options,
                                             parse_options, convert_options));
 
-  CHECK_ARROW_ERROR_AND_ASSIGN(*table, reader->Read());
-
-  CHECK_ARROW_ERROR((*table)->Validate());
+  std::shared_ptr<arrow::Table> table;
+  CHECK_ARROW_ERROR_AND_ASSIGN(table, reader->Read());
+  CHECK_ARROW_ERROR(table->Validate());
 
-  VLOG(2) << (*table)->num_rows() << " rows, " << (*table)->num_columns()
+  VLOG(2) << table->num_rows() << " rows, " << table->num_columns()
           << " columns";
-  VLOG(2) << (*table)->schema()->ToString();
+  VLOG(2) << table->schema()->ToString();
 
-  if (col_names.size() == 0) {
-    col_names = (*table)->ColumnNames();
-  }
+  // the chunks of the columns are the parsed blocks, thus the batches are
+  // zero-copy slices of them
+  VINEYARD_CHECK_OK(TableToRecordBatches(table, batches));
 }
 
 int main(int argc, const char** argv) {
@@ -113,6 +132,12 @@ int main(int argc, const char** argv) {
     ::boost::algorithm::trim(header_line);
     ::boost::split(col_names, header_line, ::boost::is_any_of(delimiter));
   }
+  int concurrency =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  if (params.find("parse_concurrency") != params.end()) {
+    concurrency = std::max(1, std::stoi(params["parse_concurrency"]));
+  }
+  CHECK_ARROW_ERROR(arrow::SetCpuThreadPoolCapacity(concurrency));
 
   DataframeStreamBuilder dfbuilder(client);
   dfbuilder.SetParams(params);
@@ -129,11 +154,15 @@ int main(int argc, const char** argv) {
     auto status = reader->GetNext(buffer);
     if (status.ok()) {
       LOG(INFO) << "consumer: buffer size = " << buffer->size();
-      std::shared_ptr<arrow::Table> table;
-      ParseTable(&table, buffer, delimiter[0], header_row, col_names);
-      auto st = writer->WriteTable(table);
-      if (!st.ok()) {
-        ReportStatus("error", st.ToString());
+      std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+      ParseBatches(&batches, buffer, delimiter[0], header_row, col_names,
+                   concurrency);
+      for (auto& batch : batches) {
+        auto st = writer->WriteBatch(batch);
+        if (!st.ok()) {
+          ReportStatus("error", st.ToString());
+          break;
+        }
       }
     } else {
       if (status.IsStreamDrained()) {
@@ -0,0 +1,87 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <memory>
+#include <string>
+
+#include "basic/stream/byte_stream.h"
+#include "client/client.h"
+#include "io/io/io_factory.h"
+#include "io/io/utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, const char** argv) {
+  // hdfs address format: hdfs://host:port/path#header_row=true&delimiter=,
+  if (argc < 5) {
+    printf(
+        "usage ./read_hdfs_bytes <ipc_socket> <hdfs_path> <proc_num> "
+        "<proc_index>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string hdfs_path = std::string(argv[2]);
+  int pnum = std::stoi(argv[3]);
+  int proc = std::stoi(argv[4]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::unique_ptr<IIOAdaptor> hdfs_io_adaptor =
+      IOFactory::CreateIOAdaptor(hdfs_path);
+  if (hdfs_io_adaptor == nullptr) {
+    ReportStatus("error", "Failed to create the io adaptor for " + hdfs_path);
+    return 1;
+  }
+
+  // each process reads its own range of blocks of the file
+  VINEYARD_CHECK_OK(hdfs_io_adaptor->SetPartialRead(proc, pnum));
+
+  VINEYARD_CHECK_OK(hdfs_io_adaptor->Open());
+
+  auto params = hdfs_io_adaptor->GetMeta();
+  ByteStreamBuilder builder(client);
+  builder.SetParams(params);
+  auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+  VINEYARD_CHECK_OK(client.Persist(bstream->id()));
+  LOG(INFO) << "Create byte stream: " << bstream->id() << " at " << proc;
+  ReportStatus("return", VYObjectIDToString(bstream->id()));
+
+  auto writer = bstream->OpenWriter(client);
+  writer->SetBufferSizeLimit(2 * 1024 * 1024);
+
+  std::string line;
+  while (hdfs_io_adaptor->ReadLine(line).ok()) {
+    auto st = writer->WriteLine(line);
+    if (!st.ok()) {
+      ReportStatus("error", st.ToString());
+      VINEYARD_CHECK_OK(st);
+    }
+  }
+
+  {
+    auto st = hdfs_io_adaptor->Close();
+    if (!st.ok()) {
+      ReportStatus("error", st.ToString());
+      VINEYARD_CHECK_OK(st);
+    }
+  }
+  VINEYARD_CHECK_OK(writer->Finish());
+  ReportStatus("exit", "");
+
+  return 0;
+}
@@ -55,11 +55,15 @@ int main(int argc, char** argv) {
   ReportStatus("return", VYObjectIDToString(bstream->id()));
 
   auto writer = bstream->OpenWriter(client);
-  writer->SetBufferSizeLimit(2 * 1024 * 1024);
 
-  std::string line;
-  while (kafka_io_adaptor->ReadLine(line).ok()) {
-    auto st = writer->WriteLine(line + "\n");
+  // every batch of messages goes to a chunk of the stream directly
+  auto kafka_adaptor = dynamic_cast<KafkaIOAdaptor*>(kafka_io_adaptor.get());
+  size_t message_num = 0;
+  while (true) {
+    auto st = kafka_adaptor->ConsumeBatch(*writer, message_num);
+    if (st.IsEndOfFile()) {
+      break;
+    }
     if (!st.ok()) {
       ReportStatus("error", st.ToString());
       VINEYARD_CHECK_OK(st);
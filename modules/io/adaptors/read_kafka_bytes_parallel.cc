@@ -0,0 +1,122 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/parallel_stream.h"
+#include "client/client.h"
+#include "io/io/io_factory.h"
+#include "io/io/kafka_io_adaptor.h"
+#include "io/io/utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// consume a partition into its stream, with a client of its own, as the
+// writer of a stream may block when the readers lag behind
+Status consume_partition(std::string const& ipc_socket,
+                         KafkaIOAdaptor* kafka_adaptor, int partition_index,
+                         std::shared_ptr<ByteStream> const& stream) {
+  Client client;
+  RETURN_ON_ERROR(client.Connect(ipc_socket));
+  auto writer = stream->OpenWriter(client);
+  size_t message_num = 0, total_message_num = 0;
+  while (true) {
+    auto status = kafka_adaptor->ConsumePartitionBatch(partition_index,
+                                                       *writer, message_num);
+    if (status.IsEndOfFile()) {
+      break;
+    }
+    if (!status.ok()) {
+      return status & writer->Abort();
+    }
+    total_message_num += message_num;
+  }
+  RETURN_ON_ERROR(writer->Finish());
+  RETURN_ON_ERROR(kafka_adaptor->CommitPartition(partition_index));
+  LOG(INFO) << "Consumed " << total_message_num
+            << " messages from the local partition " << partition_index;
+  return Status::OK();
+}
+
+int main(int argc, char** argv) {
+  // kafka address format: kafka://brokers/topics/group_id/partition_num
+  if (argc < 5) {
+    printf(
+        "usage ./read_kafka_bytes_parallel <ipc_socket> <kafka_address> "
+        "<proc_num> <proc_index>");
+    return 1;
+  }
+
+  std::string ipc_socket = std::string(argv[1]);
+  std::string kafka_address = "kafka://" + std::string(argv[2]);
+  int pnum = std::stoi(argv[3]);
+  int proc = std::stoi(argv[4]);
+
+  std::unique_ptr<IIOAdaptor> kafka_io_adaptor =
+      IOFactory::CreateIOAdaptor(kafka_address);
+
+  VINEYARD_CHECK_OK(kafka_io_adaptor->SetPartialRead(proc, pnum));
+
+  VINEYARD_CHECK_OK(kafka_io_adaptor->Open());
+  auto kafka_adaptor = dynamic_cast<KafkaIOAdaptor*>(kafka_io_adaptor.get());
+  int partition_num = kafka_adaptor->LocalPartitionNum();
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // a byte stream for each local partition
+  std::vector<std::shared_ptr<ByteStream>> streams;
+  ParallelStreamBuilder parallel_builder(client);
+  for (int index = 0; index < partition_num; ++index) {
+    ByteStreamBuilder builder(client);
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    VINEYARD_CHECK_OK(client.Persist(bstream->id()));
+    parallel_builder.AddStream(bstream->id());
+    streams.emplace_back(bstream);
+  }
+  auto pstream = parallel_builder.Seal(client);
+  ReportStatus("return", VYObjectIDToString(pstream->id()));
+
+  std::mutex mutex;
+  Status status;
+  std::vector<std::thread> consumers;
+  for (int index = 0; index < partition_num; ++index) {
+    consumers.emplace_back([&, index]() {
+      auto st = consume_partition(ipc_socket, kafka_adaptor, index,
+                                  streams[index]);
+      if (!st.ok()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        status &= st;
+      }
+    });
+  }
+  for (auto& consumer : consumers) {
+    consumer.join();
+  }
+  if (!status.ok()) {
+    ReportStatus("error", status.ToString());
+    VINEYARD_CHECK_OK(status);
+  }
+  ReportStatus("exit", "");
+
+  return 0;
+}
@@ -13,17 +13,24 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <memory>
 #include <string>
 
 #include "arrow/table.h"
 #include "basic/stream/byte_stream.h"
 #include "basic/stream/parallel_stream.h"
 #include "client/client.h"
+#include "io/io/async_file_reader.h"
 #include "io/io/local_io_adaptor.h"
 #include "io/io/utils.h"
 
 using namespace vineyard;  // NOLINT(build/namespaces)
 
+constexpr int64_t kChunkSize = 8 * 1024 * 1024;
+constexpr size_t kReadBlockSize = 1024 * 1024;
+constexpr size_t kReadDepth = 8;
+
 int main(int argc, const char** argv) {
   if (argc < 5) {
     printf(
@@ -60,17 +67,31 @@ int main(int argc, const char** argv) {
   ReportStatus("return", VYObjectIDToString(lstream->id()));
 
   auto writer = lstream->OpenWriter(client);
-  writer->SetBufferSizeLimit(2 * 1024 * 1024);
 
-  std::string line;
-  while (local_io_adaptor->ReadLine(line).ok()) {
-    auto st = writer->WriteLine(line);
-    if (!st.ok()) {
+  if (local_io_adaptor->compressed()) {
+    // the decompressed part isn't a byte range of the file, which is written
+    // to the stream line by line
+    writer->SetBufferSizeLimit(kChunkSize);
+    std::string line;
+    auto st = local_io_adaptor->ReadLine(line);
+    while (st.ok()) {
+      st = writer->WriteLine(line);
+      if (st.ok()) {
+        st = local_io_adaptor->ReadLine(line);
+      }
+    }
+    if (!st.IsEndOfFile()) {
       ReportStatus("error", st.ToString());
       VINEYARD_CHECK_OK(st);
     }
+    local_io_adaptor->Finalize();
+    VINEYARD_CHECK_OK(local_io_adaptor->Close());
+    VINEYARD_CHECK_OK(writer->Finish());
+    return 0;
   }
 
+  int64_t offset = 0, nbytes = 0;
+  VINEYARD_CHECK_OK(local_io_adaptor->GetPartialReadDetail(offset, nbytes));
   local_io_adaptor->Finalize();
   {
     auto st = local_io_adaptor->Close();
@@ -79,6 +100,31 @@ int main(int argc, const char** argv) {
       VINEYARD_CHECK_OK(st);
     }
   }
+
+  // the part is read into the chunks of the stream directly, with several
+  // reads in flight, each chunk ends at a line break, which is probed before
+  // the chunk is allocated, and the next chunk is read ahead meanwhile
+  AsyncFileReader reader(kReadDepth, kReadBlockSize);
+  VINEYARD_CHECK_OK(reader.Open(local_io_adaptor->location()));
+  int64_t end = offset + nbytes;
+  while (offset < end) {
+    int64_t chunk_end = std::min(offset + kChunkSize, end);
+    if (chunk_end < end) {
+      VINEYARD_CHECK_OK(reader.FindLineBreak(chunk_end - 1, end, chunk_end));
+    }
+    std::unique_ptr<arrow::MutableBuffer> chunk;
+    auto st = writer->GetNext(chunk_end - offset, chunk);
+    if (st.ok()) {
+      reader.Prefetch(chunk_end, kChunkSize);
+      st = reader.ReadAt(offset, chunk_end - offset, chunk->mutable_data());
+    }
+    if (!st.ok()) {
+      ReportStatus("error", st.ToString());
+      VINEYARD_CHECK_OK(st);
+    }
+    offset = chunk_end;
+  }
+  reader.Close();
   VINEYARD_CHECK_OK(writer->Finish());
 
   return 0;
@@ -0,0 +1,87 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/dataframe_stream.h"
+#include "client/client.h"
+#include "io/io/columnar_io_adaptor.h"
+#include "io/io/utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, const char** argv) {
+  if (argc < 5) {
+    printf(
+        "usage ./read_local_orc <ipc_socket> <efile> <proc_num> "
+        "<proc_index>");
+    return 1;
+  }
+
+  std::string ipc_socket = std::string(argv[1]);
+  std::string efile = std::string(argv[2]);
+  int proc_num = std::stoi(argv[3]);
+  int proc_index = std::stoi(argv[4]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the options, e.g., columns, filter and concurrency, follow the '#'
+  std::unique_ptr<ColumnarIOAdaptor> orc_io_adaptor(
+      new ColumnarIOAdaptor(efile));
+  VINEYARD_CHECK_OK(orc_io_adaptor->Configure("format", "orc"));
+  // the stripes are evenly assigned to the processes
+  VINEYARD_CHECK_OK(orc_io_adaptor->SetPartialRead(proc_index, proc_num));
+
+  DataframeStreamBuilder builder(client);
+  builder.SetParams(orc_io_adaptor->GetMeta());
+  auto dstream =
+      std::dynamic_pointer_cast<DataframeStream>(builder.Seal(client));
+  VINEYARD_CHECK_OK(client.Persist(dstream->id()));
+  LOG(INFO) << "Created dataframe stream " << dstream->id() << " at "
+            << proc_index;
+  ReportStatus("return", VYObjectIDToString(dstream->id()));
+
+  auto writer = dstream->OpenWriter(client);
+
+  // the stripes are decoded to arrow, and the batches are serialized into
+  // the chunks of the stream directly
+  std::shared_ptr<arrow::Table> table;
+  auto status = orc_io_adaptor->Open();
+  if (status.ok()) {
+    status = orc_io_adaptor->ReadTable(&table);
+  }
+  if (status.ok() && table->num_rows() > 0) {
+    status = writer->WriteTable(table);
+  }
+  status &= orc_io_adaptor->Close();
+  if (!status.ok()) {
+    ReportStatus("error", status.ToString());
+    VINEYARD_CHECK_OK(writer->Abort());
+    return 1;
+  }
+
+  status = writer->Finish();
+  if (status.ok()) {
+    ReportStatus("exit", "");
+  } else {
+    ReportStatus("error", status.ToString());
+  }
+  return 0;
+}
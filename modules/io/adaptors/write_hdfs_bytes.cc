@@ -0,0 +1,78 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include <memory>
+#include <string>
+
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/parallel_stream.h"
+#include "client/client.h"
+#include "io/io/io_factory.h"
+#include "io/io/utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  // hdfs address format: hdfs://host:port/path
+  if (argc < 6) {
+    printf(
+        "usage ./write_hdfs_bytes <ipc_socket> <stream_id> <hdfs_path> "
+        "<proc_num> <proc_index>");
+    return 1;
+  }
+
+  std::string ipc_socket = std::string(argv[1]);
+  ObjectID stream_id = VYObjectIDFromString(argv[2]);
+  std::string hdfs_path = std::string(argv[3]);
+  int proc_num = std::stoi(argv[4]);
+  int proc_index = std::stoi(argv[5]);
+
+  std::unique_ptr<IIOAdaptor> hdfs_io_adaptor =
+      IOFactory::CreateIOAdaptor(hdfs_path);
+  if (hdfs_io_adaptor == nullptr) {
+    ReportStatus("error", "Failed to create the io adaptor for " + hdfs_path);
+    return 1;
+  }
+  VINEYARD_CHECK_OK(hdfs_io_adaptor->Open("wb"));
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto s =
+      std::dynamic_pointer_cast<ParallelStream>(client.GetObject(stream_id));
+  LOG(INFO) << "Got parallel stream " << s->id();
+
+  VINEYARD_ASSERT(static_cast<size_t>(proc_num) == s->GetStreamSize(),
+                  "Different ProcNum(" + std::to_string(proc_num) +
+                      ") from StreamSize(" +
+                      std::to_string(s->GetStreamSize()) + ")");
+
+  auto ls = s->GetStream<ByteStream>(proc_index);
+  LOG(INFO) << "Got byte stream " << ls->id() << " at " << proc_index;
+
+  auto reader = ls->OpenReader(client);
+
+  // the chunks are written as they are, without splitting into lines
+  std::unique_ptr<arrow::Buffer> chunk;
+  while (reader->GetNext(chunk).ok()) {
+    VINEYARD_CHECK_OK(hdfs_io_adaptor->Write(
+        const_cast<uint8_t*>(chunk->data()), chunk->size()));
+  }
+  VINEYARD_CHECK_OK(hdfs_io_adaptor->Close());
+
+  return 0;
+}
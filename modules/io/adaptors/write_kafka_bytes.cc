@@ -30,7 +30,8 @@ int main(int argc, char** argv) {
   if (argc < 6) {
     printf(
         "usage ./write_kafka_bytes <ipc_socket> <stream_id> "
-        "<kafka_address> <proc_num> <proc_index>");
+        "<kafka_address> <proc_num> <proc_index> "
+        "[linger_ms] [batch_size]");
     return 1;
   }
 
@@ -42,6 +43,13 @@ int main(int argc, char** argv) {
 
   std::unique_ptr<IIOAdaptor> kafka_io_adaptor =
       IOFactory::CreateIOAdaptor(kafka_address);
+  if (argc > 6) {
+    VINEYARD_CHECK_OK(kafka_io_adaptor->Configure("linger_ms", argv[6]));
+  }
+  if (argc > 7) {
+    VINEYARD_CHECK_OK(
+        kafka_io_adaptor->Configure("produce_batch_size", argv[7]));
+  }
   VINEYARD_CHECK_OK(kafka_io_adaptor->Open("w"));
 
   Client client;
@@ -62,10 +70,14 @@ int main(int argc, char** argv) {
 
   auto reader = ls->OpenReader(client);
 
-  std::string line;
-  while (reader->ReadLine(line).ok()) {
-    VINEYARD_CHECK_OK(kafka_io_adaptor->WriteLine(line));
+  // produce the lines in chunks, without copying them out one by one
+  auto kafka_adaptor = dynamic_cast<KafkaIOAdaptor*>(kafka_io_adaptor.get());
+  std::unique_ptr<arrow::Buffer> chunk;
+  while (reader->GetNext(chunk).ok()) {
+    VINEYARD_CHECK_OK(kafka_adaptor->WriteLines(
+        reinterpret_cast<const char*>(chunk->data()), chunk->size()));
   }
+  VINEYARD_CHECK_OK(kafka_io_adaptor->Close());
 
   return 0;
 }
@@ -30,7 +30,8 @@ int main(int argc, char** argv) {
   if (argc < 6) {
     printf(
         "usage ./write_kafka_dataframe <ipc_socket> "
-        "<stream_id> <kafka_address> <proc_num> <proc_index>");
+        "<stream_id> <kafka_address> <proc_num> <proc_index> "
+        "[linger_ms] [batch_size]");
     return 1;
   }
 
@@ -42,6 +43,13 @@ int main(int argc, char** argv) {
 
   std::unique_ptr<IIOAdaptor> kafka_io_adaptor =
       IOFactory::CreateIOAdaptor(kafka_address);
+  if (argc > 6) {
+    VINEYARD_CHECK_OK(kafka_io_adaptor->Configure("linger_ms", argv[6]));
+  }
+  if (argc > 7) {
+    VINEYARD_CHECK_OK(
+        kafka_io_adaptor->Configure("produce_batch_size", argv[7]));
+  }
   VINEYARD_CHECK_OK(kafka_io_adaptor->Open("w"));
 
   Client client;
@@ -66,6 +74,7 @@ int main(int argc, char** argv) {
   while (reader->ReadLine(line).ok()) {
     VINEYARD_CHECK_OK(kafka_io_adaptor->WriteLine(line));
   }
+  VINEYARD_CHECK_OK(kafka_io_adaptor->Close());
 
   return 0;
 }
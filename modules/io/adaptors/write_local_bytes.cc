@@ -0,0 +1,194 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "boost/algorithm/string.hpp"
+
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/parallel_stream.h"
+#include "client/client.h"
+#include "io/io/aligned_file_writer.h"
+#include "io/io/local_io_adaptor.h"
+#include "io/io/utils.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+struct WriteOptions {
+  size_t concurrency = 0;
+  bool direct = false;
+  size_t buffer_size = AlignedFileWriter::kDefaultBufferSize;
+};
+
+// file_path#concurrency=8&direct=true&buffer_size=8388608
+Status parse_location(std::string const& location, std::string& path,
+                      WriteOptions& options) {
+  path = location;
+  if (path.substr(0, 7) == "file://") {
+    path = path.substr(7);
+  }
+  size_t pos = path.find_first_of('#');
+  if (pos == std::string::npos) {
+    return Status::OK();
+  }
+  std::vector<std::string> config_list;
+  std::string config_field = path.substr(pos + 1);
+  ::boost::split(config_list, config_field, ::boost::is_any_of("&#"));
+  path = path.substr(0, pos);
+  for (auto const& iter : config_list) {
+    size_t sep = iter.find('=');
+    if (sep == std::string::npos) {
+      continue;
+    }
+    std::string key = iter.substr(0, sep), value = iter.substr(sep + 1);
+    try {
+      if (key == "concurrency") {
+        options.concurrency = std::stoull(value);
+      } else if (key == "direct") {
+        options.direct = value == "true" || value == "1";
+      } else if (key == "buffer_size") {
+        options.buffer_size = std::stoull(value);
+      }
+    } catch (std::exception const&) {
+      return Status::Invalid("Invalid value for " + key + ": " + value);
+    }
+  }
+  return Status::OK();
+}
+
+// write a stream to its file, with a client of its own, as the reader of a
+// stream blocks until the next chunk is available
+Status write_stream(Client& client, std::shared_ptr<ByteStream> const& stream,
+                    std::string const& path, WriteOptions const& options) {
+  size_t t = path.find_last_of('/');
+  if (t != std::string::npos && t > 0) {
+    std::string folder_path = path.substr(0, t);
+    if (access(folder_path.c_str(), 0) != 0) {
+      RETURN_ON_ERROR(LocalIOAdaptor(path).MakeDirectory(folder_path));
+    }
+  }
+  AlignedFileWriter writer(options.buffer_size);
+  RETURN_ON_ERROR(writer.Open(path, options.direct));
+  bool direct = writer.direct();
+
+  auto reader = stream->OpenReader(client);
+  while (true) {
+    std::unique_ptr<arrow::Buffer> chunk;
+    auto status = reader->GetNext(chunk);
+    if (status.IsStreamDrained()) {
+      break;
+    }
+    if (!status.ok()) {
+      return status & writer.Close();
+    }
+    auto st = writer.Write(chunk->data(), chunk->size());
+    if (!st.ok()) {
+      return st & writer.Close();
+    }
+  }
+  RETURN_ON_ERROR(writer.Close());
+
+  double seconds = writer.elapsed_seconds();
+  double mbytes = writer.bytes_written() / 1024.0 / 1024.0;
+  LOG(INFO) << "Wrote stream " << stream->id() << " to " << path << ": "
+            << writer.bytes_written() << " bytes in " << seconds
+            << " seconds (" << (seconds > 0 ? mbytes / seconds : 0)
+            << " MB/s" << (direct ? ", O_DIRECT" : "") << ")";
+  return Status::OK();
+}
+
+int main(int argc, const char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage ./write_local_bytes <ipc_socket> <stream_id> <ofile> "
+        "<proc_num> <proc_index>");
+    return 1;
+  }
+
+  std::string ipc_socket = std::string(argv[1]);
+  ObjectID stream_id = VYObjectIDFromString(argv[2]);
+  std::string ofile;
+  WriteOptions options;
+  VINEYARD_CHECK_OK(parse_location(std::string(argv[3]), ofile, options));
+  int proc_num = std::stoi(argv[4]);
+  int proc_index = std::stoi(argv[5]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto s =
+      std::dynamic_pointer_cast<ParallelStream>(client.GetObject(stream_id));
+  LOG(INFO) << "Got parallel stream " << s->id();
+  size_t stream_size = s->GetStreamSize();
+
+  // the streams are assigned to the processes round-robin, the stream is
+  // written to <ofile> when there's a stream for each process, otherwise
+  // the i-th stream is written to <ofile>_<i>
+  std::vector<std::pair<std::shared_ptr<ByteStream>, std::string>> tasks;
+  for (size_t index = proc_index; index < stream_size; index += proc_num) {
+    std::string path = ofile;
+    if (stream_size != static_cast<size_t>(proc_num)) {
+      path += "_" + std::to_string(index);
+    }
+    tasks.emplace_back(s->GetStream<ByteStream>(index), path);
+  }
+  LOG(INFO) << "Writing " << tasks.size() << " of " << stream_size
+            << " streams at " << proc_index;
+
+  size_t concurrency = options.concurrency;
+  if (concurrency == 0) {
+    concurrency = std::max(1U, std::thread::hardware_concurrency());
+  }
+  concurrency = std::max<size_t>(std::min(concurrency, tasks.size()), 1);
+
+  std::atomic<size_t> next(0);
+  std::mutex mutex;
+  Status status;
+  std::vector<std::thread> workers;
+  for (size_t worker = 0; worker < concurrency; ++worker) {
+    workers.emplace_back([&]() {
+      Client worker_client;
+      auto st = worker_client.Connect(ipc_socket);
+      for (size_t index = next++; st.ok() && index < tasks.size();
+           index = next++) {
+        st = write_stream(worker_client, tasks[index].first,
+                          tasks[index].second, options);
+      }
+      if (!st.ok()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        status &= st;
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  if (!status.ok()) {
+    ReportStatus("error", status.ToString());
+    VINEYARD_CHECK_OK(status);
+  }
+
+  return 0;
+}
@@ -0,0 +1,78 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/dataframe_stream.h"
+#include "basic/stream/parallel_stream.h"
+#include "client/client.h"
+#include "io/io/columnar_io_adaptor.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, const char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage ./write_local_orc <ipc_socket> "
+        "<stream_id> <ofile> <proc_num> <proc_index>");
+    return 1;
+  }
+
+  std::string ipc_socket = std::string(argv[1]);
+  ObjectID stream_id = VYObjectIDFromString(argv[2]);
+  std::string ofile = std::string(argv[3]);
+  int proc_num = std::stoi(argv[4]);
+  int proc_index = std::stoi(argv[5]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto s =
+      std::dynamic_pointer_cast<ParallelStream>(client.GetObject(stream_id));
+  LOG(INFO) << "Got parallel stream " << s->id();
+
+  VINEYARD_ASSERT(static_cast<size_t>(proc_num) == s->GetStreamSize(),
+                  "Different ProcNum(" + std::to_string(proc_num) +
+                      ") from StreamSize(" +
+                      std::to_string(s->GetStreamSize()) + ")");
+
+  auto ls = s->GetStream<DataframeStream>(proc_index);
+  LOG(INFO) << "Got dataframe stream " << ls->id() << " at " << proc_index;
+
+  auto reader = ls->OpenReader(client);
+
+  // the options, e.g., compression, follow the '#'
+  std::unique_ptr<ColumnarIOAdaptor> orc_io_adaptor(
+      new ColumnarIOAdaptor(ofile));
+  VINEYARD_CHECK_OK(orc_io_adaptor->Configure("format", "orc"));
+  VINEYARD_CHECK_OK(orc_io_adaptor->Open("w"));
+
+  // the batches are written as soon as they are read, before the chunks
+  // are released
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (reader->ReadBatch(batch).ok()) {
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(RecordBatchesToTable({batch}, &table));
+    VINEYARD_CHECK_OK(orc_io_adaptor->WriteTable(table));
+  }
+
+  VINEYARD_CHECK_OK(orc_io_adaptor->Close());
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/aligned_file_writer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+constexpr size_t AlignedFileWriter::kAlignment;
+constexpr size_t AlignedFileWriter::kDefaultBufferSize;
+
+namespace {
+
+Status ioError(const std::string& action, const std::string& path, int err) {
+  return Status::IOError("Failed to " + action + " " + path +
+                         " because: " + std::strerror(err));
+}
+
+}  // namespace
+
+AlignedFileWriter::AlignedFileWriter(size_t buffer_size)
+    : buffer_size_(std::max((buffer_size + kAlignment - 1) / kAlignment *
+                                kAlignment,
+                            kAlignment)) {}
+
+AlignedFileWriter::~AlignedFileWriter() {
+  if (fd_ != -1) {
+    VINEYARD_SUPPRESS(Close());
+  }
+  free(buffer_);
+}
+
+Status AlignedFileWriter::Open(const std::string& path, bool direct) {
+  if (fd_ != -1) {
+    return Status::Invalid("The writer has already been opened: " + path_);
+  }
+  if (buffer_ == nullptr) {
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, kAlignment, buffer_size_) != 0) {
+      return Status::OutOfMemory("Failed to allocate the aligned buffer of " +
+                                 std::to_string(buffer_size_) + " bytes");
+    }
+    buffer_ = static_cast<uint8_t*>(buffer);
+  }
+  path_ = path;
+  direct_ = false;
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#if defined(O_DIRECT)
+  if (direct) {
+    fd_ = open(path.c_str(), flags | O_DIRECT, 0644);
+    if (fd_ != -1) {
+      direct_ = true;
+    } else if (errno == EINVAL) {
+      LOG(WARNING) << "O_DIRECT isn't supported for " << path
+                   << ", fallback to buffered writes";
+    } else {
+      return ioError("open", path, errno);
+    }
+  }
+#else
+  if (direct) {
+    LOG(WARNING) << "O_DIRECT isn't supported, fallback to buffered writes";
+  }
+#endif
+  if (fd_ == -1) {
+    fd_ = open(path.c_str(), flags, 0644);
+    if (fd_ == -1) {
+      return ioError("open", path, errno);
+    }
+  }
+  buffered_ = 0;
+  bytes_written_ = 0;
+  closed_ = false;
+  opened_at_ = std::chrono::steady_clock::now();
+  return Status::OK();
+}
+
+Status AlignedFileWriter::Write(const void* data, size_t size) {
+  if (fd_ == -1) {
+    return Status::Invalid("The writer hasn't been opened");
+  }
+  auto bytes = static_cast<const uint8_t*>(data);
+  // large writes bypass the buffer, unless they must be aligned
+  if (!direct_ && buffered_ == 0 && size >= buffer_size_) {
+    RETURN_ON_ERROR(writeAll(bytes, size));
+    bytes_written_ += size;
+    return Status::OK();
+  }
+  while (size > 0) {
+    size_t length = std::min(size, buffer_size_ - buffered_);
+    memcpy(buffer_ + buffered_, bytes, length);
+    buffered_ += length;
+    bytes += length;
+    size -= length;
+    if (buffered_ == buffer_size_) {
+      RETURN_ON_ERROR(flushBuffer());
+    }
+  }
+  return Status::OK();
+}
+
+Status AlignedFileWriter::Close() {
+  if (fd_ == -1) {
+    return Status::OK();
+  }
+  Status status = Status::OK();
+  if (buffered_ > 0) {
+    status = flushBuffer();
+  }
+  if (close(fd_) != 0 && status.ok()) {
+    status = ioError("close", path_, errno);
+  }
+  fd_ = -1;
+  closed_ = true;
+  closed_at_ = std::chrono::steady_clock::now();
+  return status;
+}
+
+double AlignedFileWriter::elapsed_seconds() const {
+  auto end = closed_ ? closed_at_ : std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - opened_at_).count();
+}
+
+Status AlignedFileWriter::writeAll(const uint8_t* data, size_t size) {
+  while (size > 0) {
+    ssize_t written = write(fd_, data, size);
+    if (written == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return ioError("write", path_, errno);
+    }
+    data += written;
+    size -= written;
+  }
+  return Status::OK();
+}
+
+Status AlignedFileWriter::flushBuffer() {
+  size_t aligned = buffered_;
+#if defined(O_DIRECT)
+  if (direct_) {
+    aligned = buffered_ / kAlignment * kAlignment;
+  }
+#endif
+  RETURN_ON_ERROR(writeAll(buffer_, aligned));
+#if defined(O_DIRECT)
+  if (aligned < buffered_) {
+    // the unaligned tail, which only happens at the end of the file
+    int flags = fcntl(fd_, F_GETFL);
+    if (flags == -1 || fcntl(fd_, F_SETFL, flags & ~O_DIRECT) == -1) {
+      return ioError("clear O_DIRECT of", path_, errno);
+    }
+    direct_ = false;
+    RETURN_ON_ERROR(writeAll(buffer_ + aligned, buffered_ - aligned));
+  }
+#endif
+  bytes_written_ += buffered_;
+  buffered_ = 0;
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,87 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_ALIGNED_FILE_WRITER_H_
+#define MODULES_IO_IO_ALIGNED_FILE_WRITER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief AlignedFileWriter writes a local file sequentially with large
+ * writes, the small writes are gathered into an aligned buffer of
+ * `buffer_size` bytes.
+ *
+ * With `direct`, the file is written with `O_DIRECT`, bypassing the page
+ * cache, thus dumping large streams doesn't evict the pages of other
+ * processes. The buffer is written with `O_DIRECT` whenever it is full, and
+ * the unaligned tail of the file is written without `O_DIRECT` on closing.
+ * The writer falls back to buffered writes if the file system doesn't
+ * support `O_DIRECT` (e.g., tmpfs).
+ */
+class AlignedFileWriter {
+ public:
+  static constexpr size_t kAlignment = 4096;
+  static constexpr size_t kDefaultBufferSize = 8 * 1024 * 1024;
+
+  explicit AlignedFileWriter(size_t buffer_size = kDefaultBufferSize);
+
+  ~AlignedFileWriter();
+
+  Status Open(const std::string& path, bool direct = false);
+
+  Status Write(const void* data, size_t size);
+
+  /**
+   * @brief Write the buffered bytes and close the file.
+   */
+  Status Close();
+
+  bool direct() const { return direct_; }
+
+  size_t bytes_written() const { return bytes_written_; }
+
+  /**
+   * @brief The seconds from opening to closing (or to now, if it hasn't been
+   * closed yet).
+   */
+  double elapsed_seconds() const;
+
+ private:
+  Status writeAll(const uint8_t* data, size_t size);
+
+  Status flushBuffer();
+
+  size_t buffer_size_;
+  uint8_t* buffer_ = nullptr;
+  size_t buffered_ = 0;
+
+  std::string path_;
+  int fd_ = -1;
+  bool direct_ = false;
+  size_t bytes_written_ = 0;
+  std::chrono::steady_clock::time_point opened_at_;
+  std::chrono::steady_clock::time_point closed_at_;
+  bool closed_ = false;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_ALIGNED_FILE_WRITER_H_
@@ -0,0 +1,312 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/async_file_reader.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(IO_URING_ENABLED)
+#include "liburing.h"
+#endif
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+namespace {
+
+// the size of reads when looking for the line breaks
+constexpr size_t kLineBreakProbeSize = 64 * 1024;
+
+Status ioError(const std::string& action, const std::string& path, int err) {
+  return Status::IOError("Failed to " + action + " " + path +
+                         " because: " + std::strerror(err));
+}
+
+}  // namespace
+
+AsyncFileReader::AsyncFileReader(size_t depth, size_t block_size)
+    : depth_(std::max(depth, static_cast<size_t>(1))),
+      block_size_(std::max(block_size, static_cast<size_t>(4096))),
+      ring_(nullptr, nullptr) {}
+
+AsyncFileReader::~AsyncFileReader() { Close(); }
+
+Status AsyncFileReader::Open(const std::string& path) {
+  if (fd_ != -1) {
+    return Status::Invalid("The reader has already been opened: " + path_);
+  }
+  path_ = path;
+  fd_ = open(path.c_str(), O_RDONLY);
+  if (fd_ == -1) {
+    return ioError("open", path, errno);
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    int err = errno;
+    Close();
+    return ioError("stat", path, err);
+  }
+  size_ = st.st_size;
+#if defined(POSIX_FADV_SEQUENTIAL)
+  posix_fadvise(fd_, 0, size_, POSIX_FADV_SEQUENTIAL);
+#endif
+
+#if defined(IO_URING_ENABLED)
+  std::unique_ptr<struct io_uring, void (*)(struct io_uring*)> ring(
+      new struct io_uring, [](struct io_uring* ring) {
+        io_uring_queue_exit(ring);
+        delete ring;
+      });
+  int ret = io_uring_queue_init(depth_, ring.get(), 0);
+  if (ret == 0) {
+    ring_ = std::move(ring);
+  } else {
+    // the deleter must not tear down a ring that fails to initialize
+    delete ring.release();
+    LOG(WARNING) << "Failed to initialize io_uring, fallback to threads: "
+                 << std::strerror(-ret);
+  }
+#endif
+  return Status::OK();
+}
+
+void AsyncFileReader::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  pending_cv_.notify_all();
+  for (auto& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  workers_.clear();
+  ring_.reset();
+  if (fd_ != -1) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+Status AsyncFileReader::ReadAt(int64_t offset, size_t size, uint8_t* data) {
+  if (fd_ == -1) {
+    return Status::Invalid("The reader is not opened");
+  }
+  if (offset < 0 || offset + static_cast<int64_t>(size) > size_) {
+    return Status::Invalid("Read out of the range of " + path_);
+  }
+  std::deque<Block> blocks;
+  for (size_t done = 0; done < size; done += block_size_) {
+    blocks.emplace_back(
+        Block{offset + static_cast<int64_t>(done), data + done,
+              std::min(block_size_, size - done)});
+  }
+  return readBlocks(blocks);
+}
+
+Status AsyncFileReader::FindLineBreak(int64_t offset, int64_t limit,
+                                      int64_t& next) {
+  limit = std::min(limit, size_);
+  std::vector<uint8_t> probe(kLineBreakProbeSize);
+  while (offset < limit) {
+    size_t length = std::min(kLineBreakProbeSize,
+                             static_cast<size_t>(limit - offset));
+    ssize_t nbytes = pread(fd_, probe.data(), length, offset);
+    if (nbytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return ioError("read", path_, errno);
+    }
+    if (nbytes == 0) {
+      break;
+    }
+    auto found =
+        static_cast<const uint8_t*>(memchr(probe.data(), '\n', nbytes));
+    if (found != nullptr) {
+      next = offset + (found - probe.data()) + 1;
+      return Status::OK();
+    }
+    offset += nbytes;
+  }
+  next = limit;
+  return Status::OK();
+}
+
+void AsyncFileReader::Prefetch(int64_t offset, size_t size) {
+#if defined(POSIX_FADV_WILLNEED)
+  if (fd_ != -1 && offset < size_) {
+    posix_fadvise(fd_, offset, size, POSIX_FADV_WILLNEED);
+  }
+#endif
+}
+
+Status AsyncFileReader::readBlocks(std::deque<Block>& blocks) {
+  if (ring_ != nullptr) {
+    return readBlocksWithRing(blocks);
+  }
+  return readBlocksWithThreads(blocks);
+}
+
+Status AsyncFileReader::readBlocksWithRing(std::deque<Block>& blocks) {
+#if defined(IO_URING_ENABLED)
+  std::vector<Block> inflight(depth_);
+  std::vector<size_t> free_slots;
+  for (size_t slot = 0; slot < depth_; ++slot) {
+    free_slots.emplace_back(slot);
+  }
+  Status status = Status::OK();
+  while (true) {
+    // keep the ring full, unless some read has failed
+    size_t submitted = 0;
+    while (status.ok() && !blocks.empty() && !free_slots.empty()) {
+      struct io_uring_sqe* sqe = io_uring_get_sqe(ring_.get());
+      if (sqe == nullptr) {
+        break;
+      }
+      size_t slot = free_slots.back();
+      free_slots.pop_back();
+      inflight[slot] = blocks.front();
+      blocks.pop_front();
+      io_uring_prep_read(sqe, fd_, inflight[slot].data,
+                         inflight[slot].length, inflight[slot].offset);
+      io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(slot));
+      ++submitted;
+    }
+    if (submitted > 0) {
+      int ret = io_uring_submit(ring_.get());
+      if (ret < 0 && status.ok()) {
+        status = ioError("submit reads of", path_, -ret);
+      }
+    }
+    if (free_slots.size() == depth_) {
+      break;
+    }
+
+    struct io_uring_cqe* cqe = nullptr;
+    int ret = io_uring_wait_cqe(ring_.get(), &cqe);
+    if (ret < 0) {
+      if (ret == -EINTR) {
+        continue;
+      }
+      // the in-flight reads can't be reaped anymore, drop the ring rather
+      // than letting them write into the memory after returning
+      LOG(ERROR) << "Failed to wait for io_uring: " << std::strerror(-ret);
+      ring_.reset();
+      return ioError("wait for reads of", path_, -ret);
+    }
+    size_t slot = reinterpret_cast<size_t>(io_uring_cqe_get_data(cqe));
+    int res = cqe->res;
+    io_uring_cqe_seen(ring_.get(), cqe);
+
+    Block& block = inflight[slot];
+    if (res == -EINTR || res == -EAGAIN) {
+      blocks.emplace_front(block);
+    } else if (res < 0) {
+      if (status.ok()) {
+        status = ioError("read", path_, -res);
+      }
+    } else if (res == 0) {
+      if (status.ok()) {
+        status = Status::IOError("Unexpected end of file: " + path_);
+      }
+    } else if (static_cast<size_t>(res) < block.length) {
+      // short read, read the rest again
+      blocks.emplace_front(Block{block.offset + res, block.data + res,
+                                 block.length - res});
+    }
+    free_slots.emplace_back(slot);
+  }
+  return status;
+#else
+  return readBlocksWithThreads(blocks);
+#endif
+}
+
+Status AsyncFileReader::readBlocksWithThreads(std::deque<Block>& blocks) {
+  // the workers are started on demand, e.g., after the ring has failed
+  if (workers_.empty()) {
+    stopped_ = false;
+    for (size_t i = 0; i < depth_; ++i) {
+      workers_.emplace_back(&AsyncFileReader::workerRoutine, this);
+    }
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  error_ = Status::OK();
+  unfinished_ = blocks.size();
+  for (auto& block : blocks) {
+    pending_.emplace_back(block);
+  }
+  blocks.clear();
+  pending_cv_.notify_all();
+  finished_cv_.wait(lock, [this]() { return unfinished_ == 0; });
+  return error_;
+}
+
+void AsyncFileReader::workerRoutine() {
+  while (true) {
+    Block block;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pending_cv_.wait(lock,
+                       [this]() { return stopped_ || !pending_.empty(); });
+      if (pending_.empty()) {
+        return;
+      }
+      block = pending_.front();
+      pending_.pop_front();
+    }
+    Status status = Status::OK();
+    while (block.length > 0) {
+      ssize_t nbytes = pread(fd_, block.data, block.length, block.offset);
+      if (nbytes < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        status = ioError("read", path_, errno);
+        break;
+      }
+      if (nbytes == 0) {
+        status = Status::IOError("Unexpected end of file: " + path_);
+        break;
+      }
+      block.offset += nbytes;
+      block.data += nbytes;
+      block.length -= nbytes;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!status.ok() && error_.ok()) {
+        error_ = status;
+      }
+      --unfinished_;
+    }
+    finished_cv_.notify_all();
+  }
+}
+
+}  // namespace vineyard
@@ -0,0 +1,109 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_ASYNC_FILE_READER_H_
+#define MODULES_IO_IO_ASYNC_FILE_READER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/util/status.h"
+
+struct io_uring;
+
+namespace vineyard {
+
+/**
+ * @brief AsyncFileReader reads ranges of a local file into the given memory,
+ * e.g., the chunks of a stream, with `depth` reads of `block_size` bytes in
+ * flight.
+ *
+ * The reads are submitted to io_uring when vineyard-io is built with
+ * `BUILD_VINEYARD_IO_WITH_IO_URING` and the kernel supports it, otherwise
+ * they are served by `depth` threads with `pread`.
+ */
+class AsyncFileReader {
+ public:
+  explicit AsyncFileReader(size_t depth = 4, size_t block_size = 1024 * 1024);
+
+  ~AsyncFileReader();
+
+  Status Open(const std::string& path);
+
+  void Close();
+
+  int64_t size() const { return size_; }
+
+  /**
+   * @brief Read `size` bytes at `offset` into `data`, blocks until all
+   * bytes have been read.
+   */
+  Status ReadAt(int64_t offset, size_t size, uint8_t* data);
+
+  /**
+   * @brief Find the next of the first '\n' at or after `offset`, `next` is
+   * `limit` if there's no '\n' in `[offset, limit)`.
+   */
+  Status FindLineBreak(int64_t offset, int64_t limit, int64_t& next);
+
+  /**
+   * @brief Hint the kernel to read the range ahead into the page cache,
+   * without waiting for it.
+   */
+  void Prefetch(int64_t offset, size_t size);
+
+ private:
+  struct Block {
+    int64_t offset;
+    uint8_t* data;
+    size_t length;
+  };
+
+  Status readBlocks(std::deque<Block>& blocks);
+
+  Status readBlocksWithRing(std::deque<Block>& blocks);
+
+  Status readBlocksWithThreads(std::deque<Block>& blocks);
+
+  void workerRoutine();
+
+  size_t depth_;
+  size_t block_size_;
+  std::string path_;
+  int fd_ = -1;
+  int64_t size_ = 0;
+
+  // the deleter tears down the ring, which keeps the type opaque here
+  std::unique_ptr<struct io_uring, void (*)(struct io_uring*)> ring_;
+
+  // the fallback: blocks are read by the workers with `pread`
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable pending_cv_;
+  std::condition_variable finished_cv_;
+  std::deque<Block> pending_;
+  size_t unfinished_ = 0;
+  bool stopped_ = false;
+  Status error_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_ASYNC_FILE_READER_H_
@@ -0,0 +1,1057 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/columnar_io_adaptor.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arrow/util/compression.h"
+#include "arrow/util/string_view.h"
+#include "boost/algorithm/string.hpp"
+#include "glog/logging.h"
+
+#if defined(PARQUET_ENABLED)
+#include "parquet/arrow/reader.h"
+#include "parquet/arrow/schema.h"
+#include "parquet/arrow/writer.h"
+#include "parquet/file_reader.h"
+#include "parquet/metadata.h"
+#include "parquet/properties.h"
+#include "parquet/statistics.h"
+#endif
+
+#if defined(ORC_ENABLED)
+#include "arrow/adapters/orc/adapter.h"
+#endif
+
+#include "basic/ds/arrow_utils.h"
+#include "io/io/local_io_adaptor.h"
+
+namespace vineyard {
+
+namespace {
+
+using CompareOp = ColumnarIOAdaptor::CompareOp;
+
+bool parseValue(const std::string& text, int64_t& value) {
+  try {
+    size_t pos = 0;
+    value = std::stoll(text, &pos);
+    return pos == text.size();
+  } catch (std::exception const&) { return false; }
+}
+
+bool parseValue(const std::string& text, uint64_t& value) {
+  try {
+    size_t pos = 0;
+    value = std::stoull(text, &pos);
+    return pos == text.size() && text[0] != '-';
+  } catch (std::exception const&) { return false; }
+}
+
+bool parseValue(const std::string& text, double& value) {
+  try {
+    size_t pos = 0;
+    value = std::stod(text, &pos);
+    return pos == text.size();
+  } catch (std::exception const&) { return false; }
+}
+
+bool parseValue(const std::string& text, bool& value) {
+  if (text == "true" || text == "1") {
+    value = true;
+  } else if (text == "false" || text == "0") {
+    value = false;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool parseValue(const std::string& text, arrow::util::string_view& value) {
+  value = arrow::util::string_view(text);
+  return true;
+}
+
+template <typename T>
+bool compare(CompareOp op, const T& lhs, const T& rhs) {
+  switch (op) {
+  case CompareOp::kEqual:
+    return lhs == rhs;
+  case CompareOp::kNotEqual:
+    return !(lhs == rhs);
+  case CompareOp::kLess:
+    return lhs < rhs;
+  case CompareOp::kLessEqual:
+    return !(rhs < lhs);
+  case CompareOp::kGreater:
+    return rhs < lhs;
+  case CompareOp::kGreaterEqual:
+    return !(lhs < rhs);
+  }
+  return false;
+}
+
+// whether some value in [min, max] may satisfy `value op rhs`
+template <typename T>
+bool mayMatch(CompareOp op, const T& min, const T& max, const T& rhs) {
+  switch (op) {
+  case CompareOp::kEqual:
+    return !(rhs < min) && !(max < rhs);
+  case CompareOp::kNotEqual:
+    return !(min == rhs && max == rhs);
+  case CompareOp::kLess:
+    return min < rhs;
+  case CompareOp::kLessEqual:
+    return !(rhs < min);
+  case CompareOp::kGreater:
+    return rhs < max;
+  case CompareOp::kGreaterEqual:
+    return !(max < rhs);
+  }
+  return true;
+}
+
+template <typename ArrayType, typename T>
+Status evaluateChunks(const std::string& column, CompareOp op,
+                      const std::string& text,
+                      const std::shared_ptr<arrow::ChunkedArray>& chunks,
+                      std::vector<bool>& selected) {
+  T rhs;
+  if (!parseValue(text, rhs)) {
+    return Status::Invalid("Invalid value in the filter of column '" +
+                           column + "': " + text);
+  }
+  int64_t offset = 0;
+  for (auto const& chunk : chunks->chunks()) {
+    auto array = std::static_pointer_cast<ArrayType>(chunk);
+    for (int64_t i = 0; i < array->length(); ++i) {
+      if (selected[offset + i] &&
+          (array->IsNull(i) ||
+           !compare<T>(op, static_cast<T>(array->GetView(i)), rhs))) {
+        selected[offset + i] = false;
+      }
+    }
+    offset += array->length();
+  }
+  return Status::OK();
+}
+
+Status compressionType(const std::string& name, bool for_ipc,
+                       arrow::Compression::type& type) {
+  if (name == "uncompressed" || name == "none") {
+    type = arrow::Compression::UNCOMPRESSED;
+  } else if (name == "snappy") {
+    type = arrow::Compression::SNAPPY;
+  } else if (name == "gzip") {
+    type = arrow::Compression::GZIP;
+  } else if (name == "brotli") {
+    type = arrow::Compression::BROTLI;
+  } else if (name == "zstd") {
+    type = arrow::Compression::ZSTD;
+  } else if (name == "lz4") {
+    // the IPC format requires the frame format of LZ4
+    type = for_ipc ? arrow::Compression::LZ4_FRAME : arrow::Compression::LZ4;
+  } else {
+    return Status::Invalid("Unknown compression codec: " + name);
+  }
+  return Status::OK();
+}
+
+#if defined(PARQUET_ENABLED)
+void collectLeaves(const parquet::arrow::SchemaField& field,
+                   std::vector<int>& leaves) {
+  if (field.children.empty()) {
+    leaves.emplace_back(field.column_index);
+  }
+  for (auto const& child : field.children) {
+    collectLeaves(child, leaves);
+  }
+}
+#endif
+
+}  // namespace
+
+ColumnarIOAdaptor::ColumnarIOAdaptor(const std::string& location)
+    : location_(location) {
+  // location:
+  //    file_path#columns=a,b&filter=a>=10;b==foo
+  size_t pos = location.find_first_of('#');
+  if (pos != std::string::npos) {
+    std::string config_field = location.substr(pos + 1);
+    std::vector<std::string> config_list;
+    ::boost::split(config_list, config_field, ::boost::is_any_of("&#"));
+    for (auto& iter : config_list) {
+      // the value of filters contains '='
+      size_t sep = iter.find('=');
+      if (sep == std::string::npos) {
+        continue;
+      }
+      auto status = setOption(iter.substr(0, sep), iter.substr(sep + 1));
+      if (!status.ok()) {
+        LOG(ERROR) << "Invalid option '" << iter << "': " << status.ToString();
+      }
+    }
+  }
+  size_t begin_pos = 0;
+  if (location_.substr(0, 7) == "file://") {
+    begin_pos = 7;
+  }
+  location_ = location_.substr(begin_pos, pos - begin_pos);
+  if (format_.empty()) {
+    format_ = DetectFormat(location_);
+  }
+}
+
+ColumnarIOAdaptor::~ColumnarIOAdaptor() { VINEYARD_SUPPRESS(Close()); }
+
+std::string ColumnarIOAdaptor::DetectFormat(const std::string& location) {
+  std::string path = location;
+  size_t pos = location.find_first_of('#');
+  if (pos != std::string::npos) {
+    std::vector<std::string> config_list;
+    std::string config_field = location.substr(pos + 1);
+    ::boost::split(config_list, config_field, ::boost::is_any_of("&#"));
+    for (auto const& iter : config_list) {
+      if (iter.substr(0, 7) == "format=") {
+        std::string format = ::boost::algorithm::to_lower_copy(iter.substr(7));
+        if (format == "parquet") {
+          return "parquet";
+        }
+        if (format == "orc") {
+          return "orc";
+        }
+        if (format == "arrow" || format == "ipc" || format == "feather") {
+          return "arrow";
+        }
+        return "";
+      }
+    }
+    path = location.substr(0, pos);
+  }
+  std::string extension;
+  size_t dot = path.find_last_of("./");
+  if (dot != std::string::npos && path[dot] == '.') {
+    extension = ::boost::algorithm::to_lower_copy(path.substr(dot + 1));
+  }
+  if (extension == "parquet" || extension == "parq") {
+    return "parquet";
+  }
+  if (extension == "orc") {
+    return "orc";
+  }
+  if (extension == "arrow" || extension == "ipc" || extension == "feather") {
+    return "arrow";
+  }
+  return "";
+}
+
+Status ColumnarIOAdaptor::Open() { return this->Open("r"); }
+
+Status ColumnarIOAdaptor::Open(const char* mode) {
+  if (format_ != "parquet" && format_ != "orc" && format_ != "arrow") {
+    return Status::Invalid("Unknown columnar format of " + location_);
+  }
+#if !defined(PARQUET_ENABLED)
+  if (format_ == "parquet") {
+    return Status::NotImplemented(
+        "Parquet isn't supported, please rebuild vineyard-io with "
+        "BUILD_VINEYARD_IO_PARQUET=ON");
+  }
+#endif
+#if !defined(ORC_ENABLED)
+  if (format_ == "orc") {
+    return Status::NotImplemented(
+        "ORC isn't supported, please rebuild vineyard-io with "
+        "BUILD_VINEYARD_IO_ORC=ON");
+  }
+#endif
+  if (strchr(mode, 'a') != NULL || strchr(mode, '+') != NULL) {
+    return Status::NotImplemented("Appending to " + format_ +
+                                  " files is not supported: " + location_);
+  }
+  if (strchr(mode, 'w') != NULL) {
+    size_t t = location_.find_last_of('/');
+    if (t != std::string::npos && t > 0) {
+      std::string folder_path = location_.substr(0, t);
+      if (access(folder_path.c_str(), 0) != 0) {
+        RETURN_ON_ERROR(MakeDirectory(folder_path));
+      }
+    }
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        output_, arrow::io::FileOutputStream::Open(location_));
+    return Status::OK();
+  }
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(input_,
+                                   arrow::io::ReadableFile::Open(location_));
+  if (format_ == "parquet") {
+    return openParquet();
+  }
+  if (format_ == "orc") {
+    return openOrc();
+  }
+  return openArrow();
+}
+
+Status ColumnarIOAdaptor::Close() {
+  Status status = Status::OK();
+#if defined(PARQUET_ENABLED)
+  if (parquet_writer_ != nullptr) {
+    auto s = parquet_writer_->Close();
+    if (!s.ok() && status.ok()) {
+      status = Status::ArrowError(s);
+    }
+    parquet_writer_.reset();
+  }
+  parquet_reader_.reset();
+#endif
+#if defined(ORC_ENABLED)
+  if (orc_writer_ != nullptr) {
+    auto s = orc_writer_->Close();
+    if (!s.ok() && status.ok()) {
+      status = Status::ArrowError(s);
+    }
+    orc_writer_.reset();
+  }
+  orc_reader_.reset();
+#endif
+  if (arrow_writer_ != nullptr) {
+    auto s = arrow_writer_->Close();
+    if (!s.ok() && status.ok()) {
+      status = Status::ArrowError(s);
+    }
+    arrow_writer_.reset();
+  }
+  if (output_ != nullptr) {
+    auto s = output_->Close();
+    if (!s.ok() && status.ok()) {
+      status = Status::ArrowError(s);
+    }
+    output_.reset();
+  }
+  arrow_reader_.reset();
+  if (input_ != nullptr) {
+    VINEYARD_SUPPRESS(Status::ArrowError(input_->Close()));
+    input_.reset();
+  }
+  return status;
+}
+
+Status ColumnarIOAdaptor::SetPartialRead(int index, int total_parts) {
+  if (index < 0 || total_parts <= 0 || index >= total_parts) {
+    return Status::Invalid("Invalid partial read: " + std::to_string(index) +
+                           " of " + std::to_string(total_parts));
+  }
+  partial_read_ = true;
+  index_ = index;
+  total_parts_ = total_parts;
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::Configure(const std::string& key,
+                                    const std::string& value) {
+  return setOption(key, value);
+}
+
+Status ColumnarIOAdaptor::setOption(const std::string& key,
+                                    const std::string& value) {
+  if (key == "format") {
+    format_ = DetectFormat("#format=" + value);
+    if (format_.empty()) {
+      return Status::Invalid("Unknown columnar format: " + value);
+    }
+  } else if (key == "columns") {
+    columns_.clear();
+    if (!value.empty()) {
+      ::boost::split(columns_, value, ::boost::is_any_of(","));
+    }
+    meta_.emplace("columns", value);
+  } else if (key == "filter") {
+    RETURN_ON_ERROR(parseFilter(value));
+    meta_.emplace("filter", value);
+  } else if (key == "compression") {
+    arrow::Compression::type type;
+    RETURN_ON_ERROR(compressionType(value, false, type));
+    compression_ = value;
+  } else if (key == "row_group_size") {
+    try {
+      row_group_size_ = std::max(std::stoll(value), 1LL);
+    } catch (std::exception const& e) {
+      return Status::Invalid("Invalid value for " + key + ": " + value);
+    }
+  } else if (key == "concurrency") {
+    try {
+      concurrency_ = std::max(std::stoi(value), 1);
+    } catch (std::exception const& e) {
+      return Status::Invalid("Invalid value for " + key + ": " + value);
+    }
+  } else {
+    meta_.emplace(key, value);
+  }
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::parseFilter(const std::string& filter) {
+  static const std::vector<std::pair<std::string, CompareOp>> operators = {
+      // the operators of two characters are matched first
+      {"==", CompareOp::kEqual},    {"!=", CompareOp::kNotEqual},
+      {"<=", CompareOp::kLessEqual}, {">=", CompareOp::kGreaterEqual},
+      {"<", CompareOp::kLess},      {">", CompareOp::kGreater},
+  };
+  std::vector<Predicate> predicates;
+  std::vector<std::string> terms;
+  ::boost::split(terms, filter, ::boost::is_any_of(";"));
+  for (auto const& term : terms) {
+    if (::boost::algorithm::trim_copy(term).empty()) {
+      continue;
+    }
+    size_t best = std::string::npos;
+    size_t length = 0;
+    CompareOp op = CompareOp::kEqual;
+    for (auto const& item : operators) {
+      size_t found = term.find(item.first);
+      if (found != std::string::npos &&
+          (best == std::string::npos || found < best)) {
+        best = found;
+        length = item.first.size();
+        op = item.second;
+      }
+    }
+    if (best == std::string::npos || best == 0) {
+      return Status::Invalid("Invalid predicate in the filter: " + term);
+    }
+    predicates.emplace_back(Predicate{
+        ::boost::algorithm::trim_copy(term.substr(0, best)), op,
+        ::boost::algorithm::trim_copy(term.substr(best + length))});
+  }
+  predicates_ = std::move(predicates);
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::openParquet() {
+#if defined(PARQUET_ENABLED)
+  parquet::ArrowReaderProperties properties;
+  // the columns are decoded in parallel
+  properties.set_use_threads(true);
+  parquet::arrow::FileReaderBuilder builder;
+  RETURN_ON_ARROW_ERROR(builder.Open(input_));
+  std::unique_ptr<parquet::arrow::FileReader> reader;
+  RETURN_ON_ARROW_ERROR(builder.memory_pool(arrow::default_memory_pool())
+                            ->properties(properties)
+                            ->Build(&reader));
+  parquet_reader_ = std::move(reader);
+  RETURN_ON_ARROW_ERROR(parquet_reader_->GetSchema(&schema_));
+  return Status::OK();
+#else
+  return Status::NotImplemented("Parquet isn't supported");
+#endif
+}
+
+Status ColumnarIOAdaptor::openOrc() {
+#if defined(ORC_ENABLED)
+  std::unique_ptr<arrow::adapters::orc::ORCFileReader> reader;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 6000000
+  RETURN_ON_ARROW_ERROR(arrow::adapters::orc::ORCFileReader::Open(
+      input_, arrow::default_memory_pool(), &reader));
+  orc_reader_ = std::move(reader);
+  RETURN_ON_ARROW_ERROR(orc_reader_->ReadSchema(&schema_));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      reader, arrow::adapters::orc::ORCFileReader::Open(
+                  input_, arrow::default_memory_pool()));
+  orc_reader_ = std::move(reader);
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(schema_, orc_reader_->ReadSchema());
+#endif
+  return Status::OK();
+#else
+  return Status::NotImplemented("ORC isn't supported");
+#endif
+}
+
+Status ColumnarIOAdaptor::openArrow() {
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      arrow_reader_, arrow::ipc::RecordBatchFileReader::Open(input_));
+  schema_ = arrow_reader_->schema();
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::resolveColumns(
+    const std::shared_ptr<arrow::Schema>& schema, std::vector<int>& fields) {
+  fields.clear();
+  if (columns_.empty()) {
+    for (int i = 0; i < schema->num_fields(); ++i) {
+      fields.emplace_back(i);
+    }
+  } else {
+    for (auto const& column : columns_) {
+      int index = schema->GetFieldIndex(column);
+      if (index == -1) {
+        return Status::Invalid("Column '" + column + "' doesn't exist in " +
+                               location_);
+      }
+      fields.emplace_back(index);
+    }
+  }
+  for (auto const& predicate : predicates_) {
+    int index = schema->GetFieldIndex(predicate.column);
+    if (index == -1) {
+      return Status::Invalid("Column '" + predicate.column +
+                             "' in the filter doesn't exist in " + location_);
+    }
+    fields.emplace_back(index);
+  }
+  // the columns are read in the order of the file
+  std::sort(fields.begin(), fields.end());
+  fields.erase(std::unique(fields.begin(), fields.end()), fields.end());
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::ReadTable(std::shared_ptr<arrow::Table>* table) {
+  if (input_ == nullptr) {
+    return Status::Invalid("The file hasn't been opened for reading: " +
+                           location_);
+  }
+  if (format_ == "parquet") {
+    RETURN_ON_ERROR(readParquet(table));
+  } else if (format_ == "orc") {
+    RETURN_ON_ERROR(readOrc(table));
+  } else {
+    RETURN_ON_ERROR(readArrow(table));
+  }
+  RETURN_ON_ERROR(filterRows(*table));
+  return projectColumns(*table);
+}
+
+Status ColumnarIOAdaptor::readParquet(std::shared_ptr<arrow::Table>* table) {
+#if defined(PARQUET_ENABLED)
+  std::vector<int> fields;
+  RETURN_ON_ERROR(resolveColumns(schema_, fields));
+  std::vector<int> leaves;
+  auto const& manifest = parquet_reader_->manifest();
+  std::vector<std::shared_ptr<arrow::Field>> read_fields;
+  for (int field : fields) {
+    collectLeaves(manifest.schema_fields[field], leaves);
+    read_fields.emplace_back(schema_->field(field));
+  }
+
+  int num_row_groups = parquet_reader_->num_row_groups();
+  int begin = 0, end = num_row_groups;
+  if (partial_read_) {
+    begin = static_cast<int64_t>(num_row_groups) * index_ / total_parts_;
+    end = static_cast<int64_t>(num_row_groups) * (index_ + 1) / total_parts_;
+  }
+  std::vector<int> row_groups;
+  for (int row_group = begin; row_group < end; ++row_group) {
+    if (mayMatchRowGroup(row_group)) {
+      row_groups.emplace_back(row_group);
+    }
+  }
+  VLOG(2) << "Read " << row_groups.size() << " of " << (end - begin)
+          << " row groups from " << location_;
+  if (row_groups.empty()) {
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        *table,
+        arrow::Table::FromRecordBatches(
+            arrow::schema(read_fields, schema_->metadata()), {}));
+    return Status::OK();
+  }
+  RETURN_ON_ARROW_ERROR(
+      parquet_reader_->ReadRowGroups(row_groups, leaves, table));
+  return Status::OK();
+#else
+  return Status::NotImplemented("Parquet isn't supported");
+#endif
+}
+
+Status ColumnarIOAdaptor::readArrow(std::shared_ptr<arrow::Table>* table) {
+  std::vector<int> fields;
+  RETURN_ON_ERROR(resolveColumns(schema_, fields));
+  std::vector<std::shared_ptr<arrow::Field>> read_fields;
+  for (int field : fields) {
+    read_fields.emplace_back(schema_->field(field));
+  }
+  auto read_schema = arrow::schema(read_fields, schema_->metadata());
+  bool projected = static_cast<int>(fields.size()) < schema_->num_fields();
+
+  auto reader = arrow_reader_;
+#if !defined(ARROW_VERSION) || ARROW_VERSION >= 1000000
+  if (projected) {
+    // only the buffers of the projected fields are read
+    auto options = arrow::ipc::IpcReadOptions::Defaults();
+    options.included_fields = fields;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        reader, arrow::ipc::RecordBatchFileReader::Open(input_, options));
+    projected = false;
+  }
+#endif
+
+  int num_batches = reader->num_record_batches();
+  int begin = 0, end = num_batches;
+  if (partial_read_) {
+    begin = static_cast<int64_t>(num_batches) * index_ / total_parts_;
+    end = static_cast<int64_t>(num_batches) * (index_ + 1) / total_parts_;
+  }
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (int index = begin; index < end; ++index) {
+    std::shared_ptr<arrow::RecordBatch> batch;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(batch, reader->ReadRecordBatch(index));
+    if (projected) {
+      std::vector<std::shared_ptr<arrow::Array>> columns;
+      for (int field : fields) {
+        columns.emplace_back(batch->column(field));
+      }
+      batch = arrow::RecordBatch::Make(read_schema, batch->num_rows(),
+                                       std::move(columns));
+    }
+    batches.emplace_back(batch);
+  }
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      *table, arrow::Table::FromRecordBatches(read_schema, batches));
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::readOrc(std::shared_ptr<arrow::Table>* table) {
+#if defined(ORC_ENABLED)
+  std::vector<int> fields;
+  RETURN_ON_ERROR(resolveColumns(schema_, fields));
+  std::vector<std::shared_ptr<arrow::Field>> read_fields;
+  for (int field : fields) {
+    read_fields.emplace_back(schema_->field(field));
+  }
+  auto read_schema = arrow::schema(read_fields, schema_->metadata());
+
+  int64_t num_stripes = orc_reader_->NumberOfStripes();
+  int64_t begin = 0, end = num_stripes;
+  if (partial_read_) {
+    begin = num_stripes * index_ / total_parts_;
+    end = num_stripes * (index_ + 1) / total_parts_;
+  }
+  VLOG(2) << "Read " << (end - begin) << " of " << num_stripes
+          << " stripes from " << location_;
+
+  // the ORC reader isn't thread-safe, thus every thread opens the file with a
+  // reader of its own, and the stripes are interleaved among the threads
+  int concurrency = concurrency_;
+  if (concurrency <= 0) {
+    concurrency = std::max(1U, std::thread::hardware_concurrency());
+  }
+  concurrency = static_cast<int>(
+      std::min<int64_t>(concurrency, std::max<int64_t>(end - begin, 1)));
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches(end - begin);
+  std::vector<Status> statuses(concurrency);
+  auto read_stripes = [&](int worker) -> Status {
+    auto reader = orc_reader_.get();
+    std::unique_ptr<arrow::adapters::orc::ORCFileReader> own_reader;
+    if (worker > 0) {
+      std::shared_ptr<arrow::io::ReadableFile> input;
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+          input, arrow::io::ReadableFile::Open(location_));
+#if defined(ARROW_VERSION) && ARROW_VERSION < 6000000
+      RETURN_ON_ARROW_ERROR(arrow::adapters::orc::ORCFileReader::Open(
+          input, arrow::default_memory_pool(), &own_reader));
+#else
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+          own_reader, arrow::adapters::orc::ORCFileReader::Open(
+                          input, arrow::default_memory_pool()));
+#endif
+      reader = own_reader.get();
+    }
+    for (int64_t stripe = begin + worker; stripe < end;
+         stripe += concurrency) {
+      auto& batch = batches[stripe - begin];
+#if defined(ARROW_VERSION) && ARROW_VERSION < 6000000
+      RETURN_ON_ARROW_ERROR(reader->ReadStripe(stripe, fields, &batch));
+#else
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(batch,
+                                       reader->ReadStripe(stripe, fields));
+#endif
+    }
+    return Status::OK();
+  };
+  std::vector<std::thread> threads;
+  for (int worker = 1; worker < concurrency; ++worker) {
+    threads.emplace_back(
+        [&, worker]() { statuses[worker] = read_stripes(worker); });
+  }
+  statuses[0] = read_stripes(0);
+  Status status = Status::OK();
+  for (int worker = 0; worker < concurrency; ++worker) {
+    if (worker > 0) {
+      threads[worker - 1].join();
+    }
+    status &= statuses[worker];
+  }
+  RETURN_ON_ERROR(status);
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      *table, arrow::Table::FromRecordBatches(read_schema, batches));
+  return Status::OK();
+#else
+  return Status::NotImplemented("ORC isn't supported");
+#endif
+}
+
+bool ColumnarIOAdaptor::mayMatchRowGroup(int row_group) {
+#if defined(PARQUET_ENABLED)
+  auto metadata = parquet_reader_->parquet_reader()->metadata();
+  auto row_group_metadata = metadata->RowGroup(row_group);
+  for (auto const& predicate : predicates_) {
+    int field = schema_->GetFieldIndex(predicate.column);
+    // only the columns of primitive types have a single column chunk
+    int leaf = metadata->schema()->ColumnIndex(predicate.column);
+    if (field == -1 || leaf < 0) {
+      continue;
+    }
+    auto chunk = row_group_metadata->ColumnChunk(leaf);
+    if (!chunk->is_stats_set()) {
+      continue;
+    }
+    auto statistics = chunk->statistics();
+    if (statistics == nullptr || !statistics->HasMinMax()) {
+      continue;
+    }
+    bool may_match = true;
+    // the signed types only, the statistics of unsigned integers are stored
+    // in the signed physical types
+    switch (schema_->field(field)->type()->id()) {
+    case arrow::Type::INT8:
+    case arrow::Type::INT16:
+    case arrow::Type::INT32: {
+      auto typed =
+          std::static_pointer_cast<parquet::Int32Statistics>(statistics);
+      int64_t rhs;
+      if (parseValue(predicate.value, rhs)) {
+        may_match = mayMatch<int64_t>(predicate.op, typed->min(),
+                                      typed->max(), rhs);
+      }
+      break;
+    }
+    case arrow::Type::INT64: {
+      auto typed =
+          std::static_pointer_cast<parquet::Int64Statistics>(statistics);
+      int64_t rhs;
+      if (parseValue(predicate.value, rhs)) {
+        may_match = mayMatch<int64_t>(predicate.op, typed->min(),
+                                      typed->max(), rhs);
+      }
+      break;
+    }
+    case arrow::Type::FLOAT: {
+      auto typed =
+          std::static_pointer_cast<parquet::FloatStatistics>(statistics);
+      double rhs;
+      if (parseValue(predicate.value, rhs)) {
+        may_match = mayMatch<double>(predicate.op, typed->min(), typed->max(),
+                                     rhs);
+      }
+      break;
+    }
+    case arrow::Type::DOUBLE: {
+      auto typed =
+          std::static_pointer_cast<parquet::DoubleStatistics>(statistics);
+      double rhs;
+      if (parseValue(predicate.value, rhs)) {
+        may_match = mayMatch<double>(predicate.op, typed->min(), typed->max(),
+                                     rhs);
+      }
+      break;
+    }
+    case arrow::Type::STRING: {
+      auto typed =
+          std::static_pointer_cast<parquet::ByteArrayStatistics>(statistics);
+      std::string min(reinterpret_cast<const char*>(typed->min().ptr),
+                      typed->min().len);
+      std::string max(reinterpret_cast<const char*>(typed->max().ptr),
+                      typed->max().len);
+      may_match = mayMatch<std::string>(predicate.op, min, max,
+                                        predicate.value);
+      break;
+    }
+    default:
+      break;
+    }
+    if (!may_match) {
+      return false;
+    }
+  }
+#endif
+  return true;
+}
+
+Status ColumnarIOAdaptor::filterRows(std::shared_ptr<arrow::Table>& table) {
+  if (predicates_.empty() || table->num_rows() == 0) {
+    return Status::OK();
+  }
+  int64_t num_rows = table->num_rows();
+  std::vector<bool> selected(num_rows, true);
+  for (auto const& predicate : predicates_) {
+    int index = table->schema()->GetFieldIndex(predicate.column);
+    RETURN_ON_ERROR(evaluate(predicate, table->column(index), selected));
+  }
+
+  // the selected rows are sliced by runs, and combined then
+  std::vector<std::shared_ptr<arrow::Table>> slices;
+  int64_t begin = -1;
+  for (int64_t row = 0; row <= num_rows; ++row) {
+    if (row < num_rows && selected[row]) {
+      if (begin == -1) {
+        begin = row;
+      }
+    } else if (begin != -1) {
+      slices.emplace_back(table->Slice(begin, row - begin));
+      begin = -1;
+    }
+  }
+  if (slices.size() == 1 && slices[0]->num_rows() == num_rows) {
+    return Status::OK();
+  }
+  if (slices.empty()) {
+    table = table->Slice(0, 0);
+    return Status::OK();
+  }
+  std::shared_ptr<arrow::Table> filtered;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(filtered, arrow::ConcatenateTables(slices));
+#if defined(ARROW_VERSION) && ARROW_VERSION < 1000000
+  RETURN_ON_ARROW_ERROR(
+      filtered->CombineChunks(arrow::default_memory_pool(), &table));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      table, filtered->CombineChunks(arrow::default_memory_pool()));
+#endif
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::evaluate(
+    const Predicate& predicate,
+    const std::shared_ptr<arrow::ChunkedArray>& column,
+    std::vector<bool>& selected) {
+  auto const& name = predicate.column;
+  auto const& value = predicate.value;
+  switch (column->type()->id()) {
+  case arrow::Type::INT8:
+    return evaluateChunks<arrow::Int8Array, int64_t>(name, predicate.op, value,
+                                                     column, selected);
+  case arrow::Type::INT16:
+    return evaluateChunks<arrow::Int16Array, int64_t>(name, predicate.op,
+                                                      value, column, selected);
+  case arrow::Type::INT32:
+    return evaluateChunks<arrow::Int32Array, int64_t>(name, predicate.op,
+                                                      value, column, selected);
+  case arrow::Type::INT64:
+    return evaluateChunks<arrow::Int64Array, int64_t>(name, predicate.op,
+                                                      value, column, selected);
+  case arrow::Type::UINT8:
+    return evaluateChunks<arrow::UInt8Array, int64_t>(name, predicate.op,
+                                                      value, column, selected);
+  case arrow::Type::UINT16:
+    return evaluateChunks<arrow::UInt16Array, int64_t>(
+        name, predicate.op, value, column, selected);
+  case arrow::Type::UINT32:
+    return evaluateChunks<arrow::UInt32Array, int64_t>(
+        name, predicate.op, value, column, selected);
+  case arrow::Type::UINT64:
+    return evaluateChunks<arrow::UInt64Array, uint64_t>(
+        name, predicate.op, value, column, selected);
+  case arrow::Type::FLOAT:
+    return evaluateChunks<arrow::FloatArray, double>(name, predicate.op, value,
+                                                     column, selected);
+  case arrow::Type::DOUBLE:
+    return evaluateChunks<arrow::DoubleArray, double>(name, predicate.op,
+                                                      value, column, selected);
+  case arrow::Type::BOOL:
+    return evaluateChunks<arrow::BooleanArray, bool>(name, predicate.op, value,
+                                                     column, selected);
+  case arrow::Type::STRING:
+    return evaluateChunks<arrow::StringArray, arrow::util::string_view>(
+        name, predicate.op, value, column, selected);
+  case arrow::Type::LARGE_STRING:
+    return evaluateChunks<arrow::LargeStringArray, arrow::util::string_view>(
+        name, predicate.op, value, column, selected);
+  default:
+    return Status::NotImplemented("Filtering on column '" + name +
+                                  "' of type " + column->type()->ToString() +
+                                  " is not supported");
+  }
+}
+
+Status ColumnarIOAdaptor::projectColumns(
+    std::shared_ptr<arrow::Table>& table) {
+  if (columns_.empty()) {
+    return Status::OK();
+  }
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  for (auto const& column : columns_) {
+    int index = table->schema()->GetFieldIndex(column);
+    fields.emplace_back(table->schema()->field(index));
+    columns.emplace_back(table->column(index));
+  }
+  table = arrow::Table::Make(arrow::schema(fields, table->schema()->metadata()),
+                             columns, table->num_rows());
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::WriteTable(
+    const std::shared_ptr<arrow::Table>& table) {
+  if (output_ == nullptr) {
+    return Status::Invalid("The file hasn't been opened for writing: " +
+                           location_);
+  }
+  if (parquet_writer_ == nullptr && orc_writer_ == nullptr &&
+      arrow_writer_ == nullptr) {
+    RETURN_ON_ERROR(createWriter(table->schema()));
+  }
+#if defined(PARQUET_ENABLED)
+  if (parquet_writer_ != nullptr) {
+    RETURN_ON_ARROW_ERROR(parquet_writer_->WriteTable(*table, row_group_size_));
+    return Status::OK();
+  }
+#endif
+#if defined(ORC_ENABLED)
+  if (orc_writer_ != nullptr) {
+    RETURN_ON_ARROW_ERROR(orc_writer_->Write(*table));
+    return Status::OK();
+  }
+#endif
+  RETURN_ON_ARROW_ERROR(arrow_writer_->WriteTable(*table));
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::createWriter(
+    const std::shared_ptr<arrow::Schema>& schema) {
+  if (format_ == "parquet") {
+#if defined(PARQUET_ENABLED)
+    parquet::WriterProperties::Builder builder;
+    if (!compression_.empty()) {
+      arrow::Compression::type type;
+      RETURN_ON_ERROR(compressionType(compression_, false, type));
+      builder.compression(type);
+    }
+    std::unique_ptr<parquet::arrow::FileWriter> writer;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 11000000
+    RETURN_ON_ARROW_ERROR(parquet::arrow::FileWriter::Open(
+        *schema, arrow::default_memory_pool(), output_, builder.build(),
+        parquet::default_arrow_writer_properties(), &writer));
+#else
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        writer,
+        parquet::arrow::FileWriter::Open(
+            *schema, arrow::default_memory_pool(), output_, builder.build(),
+            parquet::default_arrow_writer_properties()));
+#endif
+    parquet_writer_ = std::move(writer);
+    return Status::OK();
+#else
+    return Status::NotImplemented("Parquet isn't supported");
+#endif
+  }
+  if (format_ == "orc") {
+#if defined(ORC_ENABLED) && \
+    (!defined(ARROW_VERSION) || ARROW_VERSION >= 4000000)
+    std::unique_ptr<arrow::adapters::orc::ORCFileWriter> writer;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 6000000
+    if (!compression_.empty() && compression_ != "uncompressed" &&
+        compression_ != "none") {
+      return Status::NotImplemented(
+          "Compressed ORC files require arrow >= 6.0.0");
+    }
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        writer, arrow::adapters::orc::ORCFileWriter::Open(output_.get()));
+#else
+    auto options = arrow::adapters::orc::WriteOptions();
+    if (!compression_.empty()) {
+      arrow::Compression::type type;
+      RETURN_ON_ERROR(compressionType(compression_, false, type));
+      options.compression = type;
+    }
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        writer,
+        arrow::adapters::orc::ORCFileWriter::Open(output_.get(), options));
+#endif
+    orc_writer_ = std::move(writer);
+    return Status::OK();
+#else
+    return Status::NotImplemented("Writing ORC files requires arrow >= 4.0.0");
+#endif
+  }
+
+#if defined(ARROW_VERSION) && ARROW_VERSION < 2000000
+  if (!compression_.empty() && compression_ != "uncompressed" &&
+      compression_ != "none") {
+    return Status::NotImplemented(
+        "Compressed arrow files require arrow >= 2.0.0");
+  }
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      arrow_writer_,
+      arrow::ipc::RecordBatchFileWriter::Open(output_.get(), schema));
+#else
+  auto options = arrow::ipc::IpcWriteOptions::Defaults();
+  if (!compression_.empty()) {
+    arrow::Compression::type type;
+    RETURN_ON_ERROR(compressionType(compression_, true, type));
+    if (type != arrow::Compression::UNCOMPRESSED) {
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(options.codec,
+                                       arrow::util::Codec::Create(type));
+    }
+  }
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      arrow_writer_, arrow::ipc::MakeFileWriter(output_, schema, options));
+#endif
+  return Status::OK();
+}
+
+Status ColumnarIOAdaptor::ReadLine(std::string& line) {
+  return Status::NotImplemented("Reading lines from " + format_ +
+                                " files is not supported");
+}
+
+Status ColumnarIOAdaptor::WriteLine(const std::string& line) {
+  return Status::NotImplemented("Writing lines to " + format_ +
+                                " files is not supported");
+}
+
+Status ColumnarIOAdaptor::Read(void* buffer, size_t size) {
+  return Status::NotImplemented("Reading bytes from " + format_ +
+                                " files is not supported");
+}
+
+Status ColumnarIOAdaptor::Write(void* buffer, size_t size) {
+  return Status::NotImplemented("Writing bytes to " + format_ +
+                                " files is not supported");
+}
+
+Status ColumnarIOAdaptor::ListDirectory(const std::string& path,
+                                        std::vector<std::string>& files) {
+  return LocalIOAdaptor(path).ListDirectory(path, files);
+}
+
+Status ColumnarIOAdaptor::MakeDirectory(const std::string& path) {
+  return LocalIOAdaptor(path).MakeDirectory(path);
+}
+
+bool ColumnarIOAdaptor::IsExist(const std::string& path) {
+  return access(path.c_str(), 0) == 0;
+}
+
+}  // namespace vineyard
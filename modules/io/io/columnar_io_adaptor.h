@@ -0,0 +1,219 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_COLUMNAR_IO_ADAPTOR_H_
+#define MODULES_IO_IO_COLUMNAR_IO_ADAPTOR_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/io/api.h"
+#include "arrow/ipc/api.h"
+
+#include "common/util/status.h"
+#include "io/io/i_io_adaptor.h"
+
+namespace parquet {
+namespace arrow {
+class FileReader;
+class FileWriter;
+}  // namespace arrow
+}  // namespace parquet
+
+namespace arrow {
+namespace adapters {
+namespace orc {
+class ORCFileReader;
+class ORCFileWriter;
+}  // namespace orc
+}  // namespace adapters
+}  // namespace arrow
+
+namespace vineyard {
+
+/** ColumnarIOAdaptor reads and writes local files of columnar formats as
+ * arrow tables, i.e., Parquet ("parquet"), ORC ("orc"), and the Arrow IPC file
+ * format ("arrow"), which is also the format of Feather (V2) files.
+ *
+ * The format is given by the "format" option, or detected from the extension
+ * of the file, i.e., ".parquet" and ".parq" for Parquet, ".orc" for ORC,
+ * ".arrow", ".ipc" and ".feather" for Arrow IPC. Parquet and ORC are only
+ * available when vineyard-io is built with `BUILD_VINEYARD_IO_PARQUET` and
+ * `BUILD_VINEYARD_IO_ORC` respectively.
+ *
+ * The options are given in the location, or by `Configure`, e.g.,
+ *
+ *    file_path#columns=a,b&filter=a>=10;b==foo
+ *
+ * - columns: the columns to read, all columns by default.
+ * - filter: predicates of the form `<column><op><value>`, in conjunction,
+ *   separated by ';', where op is one of `==`, `!=`, `<`, `<=`, `>` and `>=`.
+ *   The row groups of Parquet files are pruned by the min/max statistics of
+ *   the column chunks before reading, and the rows read are filtered then.
+ *   Rows where the column is null never match.
+ * - compression: the codec when writing, e.g., "snappy", "zstd", "lz4" or
+ *   "uncompressed".
+ * - row_group_size: the number of rows of a row group when writing Parquet.
+ * - concurrency: the number of threads that read the stripes of ORC files,
+ *   the number of cores by default.
+ */
+class ColumnarIOAdaptor : public IIOAdaptor {
+ public:
+  /** The comparison operators of the predicates in the filter. */
+  enum class CompareOp {
+    kEqual,
+    kNotEqual,
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+  };
+
+  /** Constructor.
+   * @param location the location of file.
+   */
+  explicit ColumnarIOAdaptor(const std::string& location);
+
+  /** Default destructor. */
+  ~ColumnarIOAdaptor();
+
+  /** The columnar format of the location, by the "format" option or the
+   * extension of the file, or empty if it isn't a columnar file.
+   */
+  static std::string DetectFormat(const std::string& location);
+
+  Status Open() override;
+
+  Status Open(const char* mode) override;
+
+  Status Close() override;
+
+  /** Read the part of the file given index and total_parts, the row groups
+   * (Parquet), the stripes (ORC) or the record batches (Arrow IPC) are evenly
+   * assigned to the parts.
+   */
+  Status SetPartialRead(int index, int total_parts) override;
+
+  Status Configure(const std::string& key, const std::string& value) override;
+
+  Status ReadLine(std::string& line) override;
+
+  Status WriteLine(const std::string& line) override;
+
+  Status Read(void* buffer, size_t size) override;
+
+  Status Write(void* buffer, size_t size) override;
+
+  /** Read the (part of) table, with the projected columns and the rows
+   * matching the filter.
+   */
+  Status ReadTable(std::shared_ptr<arrow::Table>* table) override;
+
+  /** Append the table to the file opened for writing, the schema of the
+   * file is the schema of the first table.
+   */
+  Status WriteTable(const std::shared_ptr<arrow::Table>& table);
+
+  Status ListDirectory(const std::string& path,
+                       std::vector<std::string>& files) override;
+
+  Status MakeDirectory(const std::string& path) override;
+
+  bool IsExist(const std::string& path) override;
+
+  std::unordered_multimap<std::string, std::string> GetMeta() override {
+    return meta_;
+  }
+
+ private:
+  struct Predicate {
+    std::string column;
+    CompareOp op;
+    std::string value;
+  };
+
+  Status setOption(const std::string& key, const std::string& value);
+
+  Status parseFilter(const std::string& filter);
+
+  Status openParquet();
+
+  Status openArrow();
+
+  Status openOrc();
+
+  /** The columns to read: the projected columns, and the columns of the
+   * predicates.
+   */
+  Status resolveColumns(const std::shared_ptr<arrow::Schema>& schema,
+                        std::vector<int>& fields);
+
+  Status readParquet(std::shared_ptr<arrow::Table>* table);
+
+  Status readArrow(std::shared_ptr<arrow::Table>* table);
+
+  /** The stripes are read by `concurrency_` threads, each of which reads
+   * with a reader of its own.
+   */
+  Status readOrc(std::shared_ptr<arrow::Table>* table);
+
+  /** Whether the row group may contain rows matching the filter, by the
+   * statistics of its column chunks.
+   */
+  bool mayMatchRowGroup(int row_group);
+
+  Status filterRows(std::shared_ptr<arrow::Table>& table);
+
+  Status evaluate(const Predicate& predicate,
+                  const std::shared_ptr<arrow::ChunkedArray>& column,
+                  std::vector<bool>& selected);
+
+  /** Drop the columns that are only read for the predicates. */
+  Status projectColumns(std::shared_ptr<arrow::Table>& table);
+
+  Status createWriter(const std::shared_ptr<arrow::Schema>& schema);
+
+  std::string location_;
+  std::string format_;
+  std::unordered_multimap<std::string, std::string> meta_;
+
+  bool partial_read_ = false;
+  int index_ = 0;
+  int total_parts_ = 1;
+
+  std::vector<std::string> columns_;
+  std::vector<Predicate> predicates_;
+  std::string compression_;
+  int64_t row_group_size_ = 64 * 1024;
+  int concurrency_ = 0;
+
+  std::shared_ptr<arrow::io::ReadableFile> input_;
+  std::shared_ptr<parquet::arrow::FileReader> parquet_reader_;
+  std::shared_ptr<arrow::ipc::RecordBatchFileReader> arrow_reader_;
+  std::shared_ptr<arrow::adapters::orc::ORCFileReader> orc_reader_;
+  std::shared_ptr<arrow::Schema> schema_;
+
+  std::shared_ptr<arrow::io::FileOutputStream> output_;
+  std::shared_ptr<parquet::arrow::FileWriter> parquet_writer_;
+  std::shared_ptr<arrow::ipc::RecordBatchWriter> arrow_writer_;
+  std::shared_ptr<arrow::adapters::orc::ORCFileWriter> orc_writer_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_COLUMNAR_IO_ADAPTOR_H_
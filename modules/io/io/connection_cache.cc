@@ -0,0 +1,135 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/connection_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+constexpr size_t ConnectionCache::kDefaultMaxLeases;
+constexpr int64_t ConnectionCache::kDefaultIdleTimeoutMs;
+
+ConnectionCache::ConnectionCache() : state_(std::make_shared<State>()) {}
+
+ConnectionCache& ConnectionCache::Default() {
+  static ConnectionCache cache;
+  return cache;
+}
+
+std::shared_ptr<void> ConnectionCache::Acquire(const std::string& key,
+                                               const Creator& create) {
+  auto state = state_;
+  std::unique_lock<std::mutex> lock(state->mutex);
+  evictIdle(*state);
+  std::shared_ptr<Entry> entry;
+  while (true) {
+    auto& slot = state->entries[key];
+    if (slot == nullptr) {
+      slot = std::make_shared<Entry>();
+    }
+    entry = slot;
+    state->cv.wait(lock, [&]() {
+      return !entry->creating && entry->leases < state->max_leases;
+    });
+    // the entry may have been evicted (or failed to create) meanwhile
+    auto iter = state->entries.find(key);
+    if (iter != state->entries.end() && iter->second == entry) {
+      break;
+    }
+  }
+  entry->leases += 1;
+
+  if (entry->connection == nullptr) {
+    entry->creating = true;
+    lock.unlock();
+    std::shared_ptr<void> connection = create();
+    lock.lock();
+    entry->creating = false;
+    if (connection == nullptr) {
+      entry->leases -= 1;
+      auto iter = state->entries.find(key);
+      if (entry->leases == 0 && iter != state->entries.end() &&
+          iter->second == entry) {
+        state->entries.erase(iter);
+      }
+      state->cv.notify_all();
+      return nullptr;
+    }
+    VLOG(2) << "Created the connection for the IO adaptors";
+    entry->connection = connection;
+    state->cv.notify_all();
+  }
+
+  auto connection = entry->connection;
+  std::weak_ptr<State> weak_state = state;
+  return std::shared_ptr<void>(
+      connection.get(), [weak_state, entry, connection](void*) {
+        auto state = weak_state.lock();
+        if (state == nullptr) {
+          return;
+        }
+        std::lock_guard<std::mutex> lock(state->mutex);
+        entry->leases -= 1;
+        entry->last_used = std::chrono::steady_clock::now();
+        state->cv.notify_all();
+      });
+}
+
+void ConnectionCache::SetLimits(size_t max_leases, int64_t idle_timeout_ms) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->max_leases = std::max<size_t>(max_leases, 1);
+  state_->idle_timeout_ms = std::max<int64_t>(idle_timeout_ms, 0);
+  state_->cv.notify_all();
+}
+
+size_t ConnectionCache::EvictIdle() {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return evictIdle(*state_);
+}
+
+void ConnectionCache::Clear() {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->entries.clear();
+  state_->cv.notify_all();
+}
+
+size_t ConnectionCache::size() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->entries.size();
+}
+
+size_t ConnectionCache::evictIdle(State& state) {
+  auto deadline = std::chrono::steady_clock::now() -
+                  std::chrono::milliseconds(state.idle_timeout_ms);
+  size_t evicted = 0;
+  for (auto iter = state.entries.begin(); iter != state.entries.end();) {
+    auto const& entry = iter->second;
+    if (entry->leases == 0 && !entry->creating &&
+        entry->connection != nullptr && entry->last_used <= deadline) {
+      iter = state.entries.erase(iter);
+      evicted += 1;
+    } else {
+      ++iter;
+    }
+  }
+  return evicted;
+}
+
+}  // namespace vineyard
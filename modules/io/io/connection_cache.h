@@ -0,0 +1,112 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_CONNECTION_CACHE_H_
+#define MODULES_IO_IO_CONNECTION_CACHE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vineyard {
+
+/**
+ * ConnectionCache shares the connections of the backends of IO adaptors,
+ * e.g., the clients of object stores, among the adaptors of a process, thus
+ * the handshakes (auth, TLS, metadata) aren't repeated for every file.
+ *
+ * The connections are keyed by their endpoints and credentials, and are
+ * leased to the adaptors:
+ *
+ *  - At most `max_leases` leases of a connection are held at the same time,
+ *    the further acquirers wait for the leases to be released, which bounds
+ *    the concurrency per endpoint.
+ *  - The connections that haven't been leased for `idle_timeout_ms` are
+ *    evicted (when acquiring), and are destroyed once the last lease has been
+ *    released.
+ *
+ * The connection of a key is created only once, by the first acquirer, the
+ * others wait for it.
+ */
+class ConnectionCache {
+ public:
+  static constexpr size_t kDefaultMaxLeases = 64;
+  static constexpr int64_t kDefaultIdleTimeoutMs = 60 * 1000;
+
+  using Creator = std::function<std::shared_ptr<void>()>;
+
+  ConnectionCache();
+
+  /**
+   * @brief The process-wide cache, which is used by `IOFactory`.
+   */
+  static ConnectionCache& Default();
+
+  /**
+   * @brief Lease the connection of the key, which is created by `create`
+   * if it isn't cached. The lease is released when the returned pointer (and
+   * its copies) are destroyed.
+   *
+   * @return nullptr if the connection cannot be created.
+   */
+  std::shared_ptr<void> Acquire(const std::string& key, const Creator& create);
+
+  void SetLimits(size_t max_leases, int64_t idle_timeout_ms);
+
+  /**
+   * @brief Evict the idle connections.
+   *
+   * @return The number of evicted connections.
+   */
+  size_t EvictIdle();
+
+  /**
+   * @brief Evict all connections, the leased ones are destroyed once their
+   * leases have been released.
+   */
+  void Clear();
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<void> connection;
+    size_t leases = 0;
+    bool creating = false;
+    std::chrono::steady_clock::time_point last_used;
+  };
+
+  // shared with the leases, which may outlive the cache
+  struct State {
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+    size_t max_leases = kDefaultMaxLeases;
+    int64_t idle_timeout_ms = kDefaultIdleTimeoutMs;
+  };
+
+  // with the mutex held
+  static size_t evictIdle(State& state);
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_CONNECTION_CACHE_H_
@@ -0,0 +1,716 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/decompressed_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/util/compression.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+
+namespace vineyard {
+
+namespace {
+
+// the frames are grouped into units of at least this many compressed bytes
+constexpr size_t kUnitSize = 4 * 1024 * 1024;
+
+// the size of pieces of the decompressed bytes
+constexpr size_t kPieceSize = 1024 * 1024;
+
+// the decompressed bytes of a unit that are buffered ahead of the reader
+constexpr size_t kUnitBufferLimit = 4 * kPieceSize;
+
+// the size of reads when walking the headers of frames
+constexpr size_t kScanWindow = 64 * 1024;
+
+constexpr uint32_t kZstdMagic = 0xFD2FB528U;
+constexpr uint32_t kZstdSkippableMagic = 0x184D2A50U;
+constexpr uint32_t kZstdSeekTableMagic = 0x184D2A5EU;
+constexpr uint32_t kZstdSeekableMagic = 0x8F92EAB1U;
+constexpr size_t kZstdSeekTableFooterSize = 9;
+
+inline uint32_t readLE16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+inline uint32_t readLE24(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16);
+}
+
+inline uint32_t readLE32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) |
+         (static_cast<uint32_t>(p[3]) << 24);
+}
+
+/**
+ * Reads the headers of frames through a window of the object, to avoid a
+ * fetch for every few bytes.
+ */
+class ScanCursor {
+ public:
+  ScanCursor(IRangeFetcher* fetcher, const std::string& name, size_t size)
+      : fetcher_(fetcher), name_(name), size_(size) {}
+
+  Status Read(size_t offset, size_t length, const uint8_t*& data) {
+    if (offset + length > size_) {
+      return Status::Invalid("Unexpected end of " + name_ + " at " +
+                             std::to_string(offset));
+    }
+    if (offset < window_offset_ ||
+        offset + length > window_offset_ + window_.size()) {
+      size_t nbytes = std::min(std::max(length, kScanWindow), size_ - offset);
+      RETURN_ON_ERROR(fetcher_->Fetch(name_, offset, nbytes, window_));
+      if (window_.size() != nbytes) {
+        return Status::IOError("Incomplete range of " + name_ + " at " +
+                               std::to_string(offset));
+      }
+      window_offset_ = offset;
+    }
+    data = reinterpret_cast<const uint8_t*>(window_.data()) +
+           (offset - window_offset_);
+    return Status::OK();
+  }
+
+ private:
+  IRangeFetcher* fetcher_;
+  const std::string& name_;
+  size_t size_;
+  std::string window_;
+  size_t window_offset_ = 0;
+};
+
+Status makeCodec(const std::string& codec,
+                 std::unique_ptr<arrow::util::Codec>& decoder) {
+  arrow::Compression::type type;
+  if (codec == "gzip") {
+    type = arrow::Compression::GZIP;
+  } else if (codec == "zstd") {
+    type = arrow::Compression::ZSTD;
+  } else {
+    return Status::Invalid("Unknown compression codec: " + codec);
+  }
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(decoder, arrow::util::Codec::Create(type));
+  return Status::OK();
+}
+
+bool endsWith(const std::string& name, const std::string& suffix) {
+  return name.size() >= suffix.size() &&
+         name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+DecompressedReader::DecompressedReader(std::shared_ptr<IRangeFetcher> fetcher,
+                                       const std::string& codec,
+                                       size_t concurrency, size_t fetch_size,
+                                       bool scan_frames)
+    : fetcher_(fetcher),
+      codec_(codec == "none" ? "" : codec),
+      concurrency_(std::max(concurrency, static_cast<size_t>(1))),
+      fetch_size_(std::max(fetch_size, static_cast<size_t>(4096))),
+      scan_frames_(scan_frames),
+      window_(2 * concurrency_) {}
+
+DecompressedReader::~DecompressedReader() { Stop(); }
+
+std::string DecompressedReader::DetectCodec(const std::string& name) {
+  if (endsWith(name, ".gz")) {
+    return "gzip";
+  }
+  if (endsWith(name, ".zst") || endsWith(name, ".zstd")) {
+    return "zstd";
+  }
+  return "";
+}
+
+Status DecompressedReader::SetPartialRead(const int index,
+                                          const int total_parts) {
+  if (index < 0 || total_parts <= 0 || index >= total_parts) {
+    return Status::Invalid("Invalid partial read: " + std::to_string(index) +
+                           " of " + std::to_string(total_parts));
+  }
+  if (!workers_.empty()) {
+    return Status::Invalid("Set partial read after start have no effect");
+  }
+  partial_read_ = true;
+  index_ = index;
+  total_parts_ = total_parts;
+  return Status::OK();
+}
+
+Status DecompressedReader::Start(
+    const std::vector<std::pair<std::string, size_t>>& objects) {
+  if (!workers_.empty()) {
+    return Status::Invalid("The decompressed reader has already been started");
+  }
+  if (!codec_.empty() && codec_ != "auto" && codec_ != "gzip" &&
+      codec_ != "zstd") {
+    return Status::Invalid("Unknown compression codec: " + codec_);
+  }
+  objects_.clear();
+  codecs_.clear();
+  units_.clear();
+  for (auto const& object : objects) {
+    objects_.emplace_back(object.first);
+    codecs_.emplace_back(
+        codec_ == "auto" ? DetectCodec(object.first) : codec_);
+    RETURN_ON_ERROR(
+        collectUnits(objects_.size() - 1, object.first, object.second));
+  }
+
+  begin_unit_ = 0;
+  end_unit_ = units_.size();
+  if (partial_read_) {
+    std::vector<size_t> offsets;
+    size_t total = 0;
+    for (auto const& unit : units_) {
+      offsets.emplace_back(total);
+      total += unit.length;
+    }
+    // the first unit at or after index / total_parts of the compressed bytes
+    auto boundary = [&](size_t index) -> size_t {
+      size_t parts = static_cast<size_t>(total_parts_);
+      size_t bound = total / parts * index + total % parts * index / parts;
+      return std::lower_bound(offsets.begin(), offsets.end(), bound) -
+             offsets.begin();
+    };
+    begin_unit_ = index_ == 0 ? 0 : boundary(index_);
+    if (index_ + 1 < total_parts_) {
+      end_unit_ = boundary(index_ + 1);
+    }
+    if (units_.size() < static_cast<size_t>(total_parts_)) {
+      LOG(WARNING) << "There are only " << units_.size()
+                   << " independent units of compressed data for "
+                   << total_parts_ << " parts, some parts will be empty";
+    }
+  }
+  VLOG(2) << "Decompress " << objects_.size() << " objects in "
+          << units_.size() << " units, reading [" << begin_unit_ << ", "
+          << end_unit_ << "), concurrency: " << concurrency_;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    outputs_.clear();
+    next_unit_ = begin_unit_;
+    consume_unit_ = begin_unit_;
+    stopped_ = false;
+    error_ = Status::OK();
+  }
+  current_.clear();
+  current_pos_ = 0;
+  current_starts_object_ = false;
+  last_object_ = std::numeric_limits<size_t>::max();
+  finished_ = false;
+
+  size_t worker_num = std::min(concurrency_, units_.size() - begin_unit_);
+  for (size_t i = 0; i < worker_num; ++i) {
+    workers_.emplace_back(&DecompressedReader::decompressRoutine, this);
+  }
+
+  // the line that crosses the start of the part belongs to the previous part
+  if (partial_read_ && index_ > 0 && begin_unit_ < units_.size() &&
+      !units_[begin_unit_].starts_object) {
+    RETURN_ON_ERROR(skipLine());
+  }
+  return Status::OK();
+}
+
+void DecompressedReader::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  consumed_cv_.notify_all();
+  produced_cv_.notify_all();
+  for (auto& thrd : workers_) {
+    if (thrd.joinable()) {
+      thrd.join();
+    }
+  }
+  workers_.clear();
+  outputs_.clear();
+}
+
+Status DecompressedReader::ReadLine(std::string& line, bool with_line_break) {
+  line.clear();
+  bool pending = false;
+  while (true) {
+    if (current_pos_ >= current_.size()) {
+      auto status = nextPiece();
+      if (status.IsEndOfFile() && pending) {
+        return Status::OK();
+      }
+      RETURN_ON_ERROR(status);
+      // the end of an object terminates the line
+      if (pending && current_starts_object_) {
+        return Status::OK();
+      }
+      continue;
+    }
+    const char* begin = current_.data() + current_pos_;
+    size_t remaining = current_.size() - current_pos_;
+    auto end = static_cast<const char*>(memchr(begin, '\n', remaining));
+    if (end != nullptr) {
+      line.append(begin, end - begin + (with_line_break ? 1 : 0));
+      current_pos_ += end - begin + 1;
+      return Status::OK();
+    }
+    line.append(begin, remaining);
+    current_pos_ = current_.size();
+    pending = true;
+  }
+}
+
+Status DecompressedReader::Read(void* buffer, size_t size,
+                                size_t& read_size) {
+  read_size = 0;
+  while (read_size < size) {
+    if (current_pos_ >= current_.size()) {
+      auto status = nextPiece();
+      if (status.IsEndOfFile() && read_size > 0) {
+        break;
+      }
+      RETURN_ON_ERROR(status);
+      continue;
+    }
+    size_t nbytes =
+        std::min(size - read_size, current_.size() - current_pos_);
+    memcpy(static_cast<char*>(buffer) + read_size,
+           current_.data() + current_pos_, nbytes);
+    current_pos_ += nbytes;
+    read_size += nbytes;
+  }
+  return Status::OK();
+}
+
+Status DecompressedReader::ReadPart(std::string& part) {
+  if (current_pos_ >= current_.size()) {
+    RETURN_ON_ERROR(nextPiece());
+  }
+  if (current_pos_ == 0) {
+    part.swap(current_);
+  } else {
+    part = current_.substr(current_pos_);
+  }
+  current_.clear();
+  current_pos_ = 0;
+  return Status::OK();
+}
+
+Status DecompressedReader::collectUnits(size_t object, const std::string& name,
+                                        size_t size) {
+  const std::string& codec = codecs_[object];
+  std::vector<size_t> frames;
+  Status status = Status::OK();
+  if (codec == "zstd") {
+    status = findZstdSeekTable(name, size, frames);
+    if (status.ok() && frames.empty() && scan_frames_) {
+      status = scanZstdFrames(name, size, frames);
+    }
+  } else if (codec == "gzip" && scan_frames_) {
+    status = scanBgzfMembers(name, size, frames);
+  } else if (codec.empty()) {
+    // the raw bytes can be cut anywhere
+    for (size_t offset = 0; offset < size; offset += kUnitSize) {
+      frames.emplace_back(offset);
+    }
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to locate the frames of " << name
+                 << ", decompress it serially: " << status.ToString();
+    frames.clear();
+  }
+  if (frames.empty() || frames.front() != 0) {
+    frames.insert(frames.begin(), 0);
+  }
+
+  size_t begin = 0;
+  for (size_t frame : frames) {
+    if (frame >= size) {
+      break;
+    }
+    if (frame - begin >= kUnitSize) {
+      units_.emplace_back(Unit{object, begin, frame - begin, begin == 0});
+      begin = frame;
+    }
+  }
+  if (size > begin) {
+    units_.emplace_back(Unit{object, begin, size - begin, begin == 0});
+  }
+  return Status::OK();
+}
+
+Status DecompressedReader::findZstdSeekTable(const std::string& name,
+                                             size_t size,
+                                             std::vector<size_t>& frames) {
+  // see also:
+  // https://github.com/facebook/zstd/blob/dev/contrib/seekable_format
+  if (size < 8 + kZstdSeekTableFooterSize) {
+    return Status::OK();
+  }
+  ScanCursor cursor(fetcher_.get(), name, size);
+  const uint8_t* footer = nullptr;
+  RETURN_ON_ERROR(cursor.Read(size - kZstdSeekTableFooterSize,
+                              kZstdSeekTableFooterSize, footer));
+  if (readLE32(footer + 5) != kZstdSeekableMagic) {
+    return Status::OK();
+  }
+  size_t frame_num = readLE32(footer);
+  size_t entry_size = (footer[4] & 0x80) ? 12 : 8;
+  size_t table_size = 8 + frame_num * entry_size + kZstdSeekTableFooterSize;
+  if (table_size > size) {
+    return Status::Invalid("Invalid seek table of " + name);
+  }
+  const uint8_t* table = nullptr;
+  RETURN_ON_ERROR(cursor.Read(size - table_size, table_size, table));
+  if (readLE32(table) != kZstdSeekTableMagic) {
+    return Status::Invalid("Invalid seek table of " + name);
+  }
+  size_t offset = 0;
+  for (size_t i = 0; i < frame_num; ++i) {
+    frames.emplace_back(offset);
+    offset += readLE32(table + 8 + i * entry_size);
+  }
+  if (offset != size - table_size) {
+    frames.clear();
+    return Status::Invalid("The seek table doesn't match the frames of " +
+                           name);
+  }
+  return Status::OK();
+}
+
+Status DecompressedReader::scanZstdFrames(const std::string& name,
+                                          size_t size,
+                                          std::vector<size_t>& frames) {
+  // see also the "doc/zstd_compression_format.md" of
+  // https://github.com/facebook/zstd
+  static const size_t kDictionaryIdSizes[] = {0, 1, 2, 4};
+  ScanCursor cursor(fetcher_.get(), name, size);
+  const uint8_t* data = nullptr;
+  size_t offset = 0;
+  while (offset < size) {
+    frames.emplace_back(offset);
+    RETURN_ON_ERROR(cursor.Read(offset, 4, data));
+    uint32_t magic = readLE32(data);
+    if ((magic & 0xFFFFFFF0U) == kZstdSkippableMagic) {
+      RETURN_ON_ERROR(cursor.Read(offset + 4, 4, data));
+      offset += 8 + readLE32(data);
+      continue;
+    }
+    if (magic != kZstdMagic) {
+      return Status::Invalid("Not a zstd frame at " + std::to_string(offset));
+    }
+    RETURN_ON_ERROR(cursor.Read(offset + 4, 1, data));
+    uint8_t descriptor = data[0];
+    bool single_segment = (descriptor >> 5) & 1;
+    bool checksum = (descriptor >> 2) & 1;
+    size_t content_size_flag = descriptor >> 6;
+    size_t content_size_size = content_size_flag == 0
+                                   ? (single_segment ? 1 : 0)
+                                   : (1 << content_size_flag);
+    offset += 4 + 1 + (single_segment ? 0 : 1) +
+              kDictionaryIdSizes[descriptor & 3] + content_size_size;
+    bool last_block = false;
+    while (!last_block) {
+      RETURN_ON_ERROR(cursor.Read(offset, 3, data));
+      uint32_t header = readLE24(data);
+      last_block = header & 1;
+      uint32_t block_type = (header >> 1) & 3;
+      uint32_t block_size = header >> 3;
+      if (block_type == 3) {
+        return Status::Invalid("Invalid zstd block at " +
+                               std::to_string(offset));
+      }
+      // the RLE blocks have a single byte
+      offset += 3 + (block_type == 1 ? 1 : block_size);
+    }
+    if (checksum) {
+      offset += 4;
+    }
+  }
+  if (offset != size) {
+    return Status::Invalid("Truncated zstd frame at " +
+                           std::to_string(frames.back()));
+  }
+  return Status::OK();
+}
+
+Status DecompressedReader::scanBgzfMembers(const std::string& name,
+                                           size_t size,
+                                           std::vector<size_t>& frames) {
+  // the member size is in the "BC" extra subfield, see also the section 4.1
+  // of https://samtools.github.io/hts-specs/SAMv1.pdf
+  ScanCursor cursor(fetcher_.get(), name, size);
+  const uint8_t* data = nullptr;
+  size_t offset = 0;
+  while (offset + 12 <= size) {
+    RETURN_ON_ERROR(cursor.Read(offset, 12, data));
+    if (data[0] != 0x1f || data[1] != 0x8b || data[2] != 8 ||
+        !(data[3] & 0x04)) {
+      break;
+    }
+    size_t extra_length = readLE16(data + 10);
+    RETURN_ON_ERROR(cursor.Read(offset + 12, extra_length, data));
+    size_t member_size = 0;
+    for (size_t pos = 0; pos + 4 <= extra_length;) {
+      size_t subfield_length = readLE16(data + pos + 2);
+      if (data[pos] == 'B' && data[pos + 1] == 'C' && subfield_length == 2 &&
+          pos + 6 <= extra_length) {
+        member_size = readLE16(data + pos + 4) + 1;
+        break;
+      }
+      pos += 4 + subfield_length;
+    }
+    if (member_size == 0) {
+      break;
+    }
+    frames.emplace_back(offset);
+    offset += member_size;
+  }
+  // the rest, if any, isn't blocked, and is decompressed as a whole
+  if (offset < size) {
+    if (offset == 0) {
+      VLOG(2) << name << " is not a blocked gzip file, decompress it serially";
+    }
+    frames.emplace_back(offset);
+  }
+  return Status::OK();
+}
+
+void DecompressedReader::decompressRoutine() {
+  while (true) {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // at most `window_` units are decompressed ahead of the reader, and
+      // the units after the part are only needed for its last line
+      consumed_cv_.wait(lock, [this]() {
+        return stopped_ || !error_.ok() || next_unit_ >= units_.size() ||
+               (next_unit_ < consume_unit_ + window_ &&
+                (next_unit_ < end_unit_ || consume_unit_ >= end_unit_));
+      });
+      if (stopped_ || !error_.ok() || next_unit_ >= units_.size()) {
+        return;
+      }
+      index = next_unit_++;
+      outputs_[index];
+    }
+    auto status = decompressUnit(index);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!status.ok() && !stopped_ && error_.ok()) {
+        const Unit& unit = units_[index];
+        LOG(ERROR) << "Failed to decompress " << objects_[unit.object]
+                   << " at " << unit.offset << ": " << status.ToString();
+        error_ = status;
+      }
+      outputs_[index].finished = true;
+    }
+    produced_cv_.notify_all();
+  }
+}
+
+Status DecompressedReader::decompressUnit(size_t index) {
+  const Unit& unit = units_[index];
+  const std::string& name = objects_[unit.object];
+  const std::string& codec = codecs_[unit.object];
+
+  // the next range of compressed bytes is fetched during the decompression
+  size_t fetched = 0;
+  auto fetch = [this, &unit, &name](size_t offset,
+                                    std::string* content) -> Status {
+    size_t length = std::min(fetch_size_, unit.length - offset);
+    RETURN_ON_ERROR(
+        fetcher_->Fetch(name, unit.offset + offset, length, *content));
+    if (content->size() != length) {
+      return Status::IOError("Incomplete range of " + name + " at " +
+                             std::to_string(unit.offset + offset));
+    }
+    return Status::OK();
+  };
+  std::string input, next_input;
+  std::future<Status> ahead;
+  auto nextInput = [&]() -> Status {
+    if (ahead.valid()) {
+      RETURN_ON_ERROR(ahead.get());
+      input.swap(next_input);
+    } else {
+      RETURN_ON_ERROR(fetch(fetched, &input));
+    }
+    fetched += input.size();
+    if (fetched < unit.length) {
+      ahead = std::async(std::launch::async, fetch, fetched, &next_input);
+    }
+    return Status::OK();
+  };
+
+  if (codec.empty()) {
+    while (fetched < unit.length) {
+      RETURN_ON_ERROR(nextInput());
+      RETURN_ON_ERROR(pushPiece(index, input));
+    }
+    return Status::OK();
+  }
+
+  std::unique_ptr<arrow::util::Codec> decoder;
+  RETURN_ON_ERROR(makeCodec(codec, decoder));
+  std::shared_ptr<arrow::util::Decompressor> decompressor;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(decompressor, decoder->MakeDecompressor());
+
+  size_t input_pos = 0;
+  std::string piece(kPieceSize, '\0');
+  size_t written = 0;
+  while (true) {
+    if (input_pos == input.size() && fetched < unit.length) {
+      RETURN_ON_ERROR(nextInput());
+      input_pos = 0;
+    }
+    bool has_input = input_pos < input.size();
+    if (decompressor->IsFinished()) {
+      if (!has_input) {
+        break;
+      }
+      // the next member of gzip, or the next frame of zstd
+      RETURN_ON_ARROW_ERROR(decompressor->Reset());
+    }
+    arrow::util::Decompressor::DecompressResult decompressed;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+        decompressed, decompressor->Decompress(
+                    input.size() - input_pos,
+                    reinterpret_cast<const uint8_t*>(input.data()) + input_pos,
+                    piece.size() - written,
+                    reinterpret_cast<uint8_t*>(&piece[0]) + written));
+    input_pos += decompressed.bytes_read;
+    written += decompressed.bytes_written;
+    if (written == piece.size()) {
+      RETURN_ON_ERROR(pushPiece(index, piece));
+      piece.assign(kPieceSize, '\0');
+      written = 0;
+    } else if (decompressed.bytes_read == 0 &&
+               decompressed.bytes_written == 0) {
+      if (has_input) {
+        return Status::IOError("Corrupted compressed data in " + name);
+      }
+      // no more output can be produced from the input
+      break;
+    }
+  }
+  if (!decompressor->IsFinished()) {
+    return Status::IOError("Truncated compressed data in " + name);
+  }
+  if (written > 0) {
+    piece.resize(written);
+    RETURN_ON_ERROR(pushPiece(index, piece));
+  }
+  return Status::OK();
+}
+
+Status DecompressedReader::pushPiece(size_t index, std::string& piece) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Output& output = outputs_[index];
+    consumed_cv_.wait(lock, [this, &output]() {
+      return stopped_ || !error_.ok() || output.buffered < kUnitBufferLimit;
+    });
+    if (stopped_) {
+      return Status::Invalid("The decompressed reader has been stopped");
+    }
+    RETURN_ON_ERROR(error_);
+    output.buffered += piece.size();
+    output.pieces.emplace_back(std::move(piece));
+  }
+  produced_cv_.notify_all();
+  return Status::OK();
+}
+
+Status DecompressedReader::nextPiece() {
+  if (finished_) {
+    return Status::EndOfFile();
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (consume_unit_ >= units_.size()) {
+      finished_ = true;
+      return Status::EndOfFile();
+    }
+    produced_cv_.wait(lock, [this]() {
+      if (stopped_ || !error_.ok()) {
+        return true;
+      }
+      auto iter = outputs_.find(consume_unit_);
+      return iter != outputs_.end() &&
+             (!iter->second.pieces.empty() || iter->second.finished);
+    });
+    RETURN_ON_ERROR(error_);
+    if (stopped_) {
+      return Status::Invalid("The decompressed reader has been stopped");
+    }
+    auto iter = outputs_.find(consume_unit_);
+    Output& output = iter->second;
+    if (output.pieces.empty()) {
+      outputs_.erase(iter);
+      ++consume_unit_;
+      consumed_cv_.notify_all();
+      continue;
+    }
+    size_t object = units_[consume_unit_].object;
+    bool starts_object = object != last_object_;
+    // the last line of the part never spans into the next object
+    if (consume_unit_ >= end_unit_ && starts_object) {
+      finished_ = true;
+      return Status::EndOfFile();
+    }
+    current_ = std::move(output.pieces.front());
+    output.pieces.pop_front();
+    output.buffered -= current_.size();
+    current_pos_ = 0;
+    current_starts_object_ = starts_object;
+    last_object_ = object;
+    if (consume_unit_ >= end_unit_) {
+      // the rest of the line that crosses into the next part
+      auto end =
+          static_cast<const char*>(memchr(current_.data(), '\n',
+                                          current_.size()));
+      if (end != nullptr) {
+        current_.resize(end - current_.data() + 1);
+        finished_ = true;
+      }
+    }
+    break;
+  }
+  lock.unlock();
+  consumed_cv_.notify_all();
+  return Status::OK();
+}
+
+Status DecompressedReader::skipLine() {
+  std::string line;
+  auto status = ReadLine(line);
+  if (status.IsEndOfFile()) {
+    return Status::OK();
+  }
+  return status;
+}
+
+}  // namespace vineyard
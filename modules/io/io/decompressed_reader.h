@@ -0,0 +1,177 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_DECOMPRESSED_READER_H_
+#define MODULES_IO_IO_DECOMPRESSED_READER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/util/status.h"
+#include "io/io/read_ahead_buffer.h"
+
+namespace vineyard {
+
+/**
+ * @brief DecompressedReader reads the decompressed content of gzip or zstd
+ * compressed objects, which are fetched by the `IRangeFetcher`, e.g., local
+ * files or objects on OSS. The codec of each object is given, or detected
+ * from the extension of its name ("auto"), objects that aren't compressed
+ * are read as they are.
+ *
+ * The objects are cut into units at the boundaries of independent frames,
+ * i.e., the frames of zstd, and the members of BGZF (the blocked gzip of
+ * `bgzip`). The units are decompressed by `concurrency` threads and consumed
+ * in order. The frames are located by the seek table of the zstd seekable
+ * format, or, when `scan_frames` is true (which is cheap for local files),
+ * by walking the headers of frames. A gzip file of a single member can only
+ * be decompressed serially, where the compressed input is fetched ahead of
+ * the decompression, like pigz.
+ *
+ * Lines never span two objects: the end of an object terminates the line.
+ */
+class DecompressedReader {
+ public:
+  DecompressedReader(std::shared_ptr<IRangeFetcher> fetcher,
+                     const std::string& codec, size_t concurrency,
+                     size_t fetch_size = 1024 * 1024, bool scan_frames = true);
+
+  ~DecompressedReader();
+
+  /**
+   * @brief The codec of the object by its extension, i.e., "gzip" for
+   * ".gz", "zstd" for ".zst" and ".zstd", or empty if it isn't compressed.
+   */
+  static std::string DetectCodec(const std::string& name);
+
+  /**
+   * @brief Read the part of the objects given index and total_parts, must be
+   * set before `Start`.
+   *
+   * The units are assigned to parts by their compressed offsets, thus the
+   * objects can only be split at the boundaries of frames. Like the partial
+   * read of local files, a part starts at the next of the first '\n' after
+   * its first unit starts, and ends after the first '\n' after the next part
+   * starts.
+   */
+  Status SetPartialRead(const int index, const int total_parts);
+
+  /**
+   * @brief Start reading the objects, given as pairs of the object name
+   * and the object size.
+   */
+  Status Start(const std::vector<std::pair<std::string, size_t>>& objects);
+
+  void Stop();
+
+  /**
+   * @brief Read a line, the trailing '\n' is kept when `with_line_break`
+   * is true.
+   */
+  Status ReadLine(std::string& line, bool with_line_break = false);
+
+  /**
+   * @brief Read at most `size` bytes, `read_size` is the number of bytes
+   * that have been read. Returns EndOfFile if there's nothing left.
+   */
+  Status Read(void* buffer, size_t size, size_t& read_size);
+
+  /**
+   * @brief Take the rest of the current piece of decompressed bytes, or the
+   * next piece as a whole.
+   */
+  Status ReadPart(std::string& part);
+
+ private:
+  struct Unit {
+    size_t object;
+    size_t offset;
+    size_t length;
+    bool starts_object;
+  };
+
+  struct Output {
+    std::deque<std::string> pieces;
+    size_t buffered = 0;
+    bool finished = false;
+  };
+
+  Status collectUnits(size_t object, const std::string& name, size_t size);
+
+  Status findZstdSeekTable(const std::string& name, size_t size,
+                           std::vector<size_t>& frames);
+
+  Status scanZstdFrames(const std::string& name, size_t size,
+                        std::vector<size_t>& frames);
+
+  Status scanBgzfMembers(const std::string& name, size_t size,
+                         std::vector<size_t>& frames);
+
+  void decompressRoutine();
+
+  Status decompressUnit(size_t index);
+
+  Status pushPiece(size_t index, std::string& piece);
+
+  Status nextPiece();
+
+  Status skipLine();
+
+  std::shared_ptr<IRangeFetcher> fetcher_;
+  std::string codec_;
+  size_t concurrency_;
+  size_t fetch_size_;
+  bool scan_frames_;
+  size_t window_;
+
+  bool partial_read_ = false;
+  int index_ = 0;
+  int total_parts_ = 1;
+
+  std::vector<std::string> objects_;
+  std::vector<std::string> codecs_;
+  std::vector<Unit> units_;
+  // the units of the part are [begin_unit_, end_unit_)
+  size_t begin_unit_ = 0;
+  size_t end_unit_ = 0;
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable produced_cv_;
+  std::condition_variable consumed_cv_;
+  std::map<size_t, Output> outputs_;
+  size_t next_unit_ = 0;
+  size_t consume_unit_ = 0;
+  bool stopped_ = false;
+  Status error_;
+
+  std::string current_;
+  size_t current_pos_ = 0;
+  bool current_starts_object_ = false;
+  size_t last_object_ = 0;
+  // the rest of the part has been taken
+  bool finished_ = false;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_DECOMPRESSED_READER_H_
@@ -0,0 +1,488 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/hdfs_io_adaptor.h"
+
+#ifdef HDFS_ENABLED
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "boost/algorithm/string.hpp"
+#include "glog/logging.h"
+#include "network/uri.hpp"
+#include "network/uri/uri_io.hpp"
+
+namespace vineyard {
+
+namespace {
+
+// the size of reads when looking for the line breaks
+constexpr tSize kLineBreakProbeSize = 64 * 1024;
+
+// the size of each `hdfsWrite`, which takes the length as `tSize` (int32_t)
+constexpr size_t kMaxWriteSize = 1 << 30;
+
+Status hdfsError(const std::string& action, const std::string& path) {
+  return Status::IOError("Failed to " + action + " " + path +
+                         " on HDFS because: " + std::strerror(errno));
+}
+
+}  // namespace
+
+HDFSIOAdaptor::HDFSIOAdaptor(const std::string& location)
+    : location_(location) {
+  // in csv format location:
+  //    hdfs://host:port/file_path#header_row=true/false&delimiter=,
+  std::string uri = location;
+  size_t pos = location.find_first_of('#');
+  if (pos != std::string::npos) {
+    uri = location.substr(0, pos);
+    std::string config_field = location.substr(pos + 1);
+    std::vector<std::string> config_list;
+    ::boost::split(config_list, config_field, ::boost::is_any_of("&#"));
+    for (auto& iter : config_list) {
+      std::vector<std::string> kv_pair;
+      ::boost::split(kv_pair, iter, ::boost::is_any_of("="));
+      if (kv_pair.size() < 2) {
+        continue;
+      }
+      if (kv_pair[0] == "delimiter") {
+        ::boost::algorithm::trim_if(kv_pair[1],
+                                    boost::algorithm::is_any_of("\"\'"));
+        if (kv_pair[1].size() > 1 && kv_pair[1][0] == '\\' &&
+            kv_pair[1][1] == 't') {
+          delimiter_ = '\t';
+        } else if (!kv_pair[1].empty()) {
+          delimiter_ = kv_pair[1][0];
+        }
+        meta_.emplace("delimiter", std::string(1, delimiter_));
+      } else if (kv_pair[0] == "header_row") {
+        header_row_ = (kv_pair[1] == "true");
+        meta_.emplace("header_row", std::to_string(header_row_));
+      } else if (boost::starts_with(kv_pair[0], "dfs.")) {
+        client_conf_[kv_pair[0]] = kv_pair[1];
+      } else {
+        meta_.emplace(kv_pair[0], kv_pair[1]);
+      }
+    }
+  }
+
+  network::uri instance(uri);
+  host_ = instance.host().to_string();
+  std::string port = instance.port().to_string();
+  port_ = port.empty() ? 0 : std::stoi(port);
+  path_ = instance.path().to_string();
+  VLOG(2) << "HDFS host: " << host_ << ", port: " << port_
+          << ", path: " << path_;
+}
+
+HDFSIOAdaptor::~HDFSIOAdaptor() {
+  VINEYARD_SUPPRESS(Close());
+  if (fs_ != nullptr) {
+    hdfsDisconnect(fs_);
+    fs_ = nullptr;
+  }
+}
+
+Status HDFSIOAdaptor::connect() {
+  if (fs_ != nullptr) {
+    return Status::OK();
+  }
+  struct hdfsBuilder* builder = hdfsNewBuilder();
+  // "default" picks the namenode from the "fs.defaultFS" of the config
+  hdfsBuilderSetNameNode(builder, host_.empty() ? "default" : host_.c_str());
+  if (port_ != 0) {
+    hdfsBuilderSetNameNodePort(builder, port_);
+  }
+  for (auto const& kv : client_conf_) {
+    hdfsBuilderConfSetStr(builder, kv.first.c_str(), kv.second.c_str());
+  }
+  // the builder is freed by `hdfsBuilderConnect`
+  fs_ = hdfsBuilderConnect(builder);
+  if (fs_ == nullptr) {
+    return hdfsError("connect to the namenode of", location_);
+  }
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::Open() { return this->Open("r"); }
+
+Status HDFSIOAdaptor::Open(const char* mode) {
+  if (file_ != nullptr) {
+    return Status::Invalid("The file has already been opened: " + location_);
+  }
+  RETURN_ON_ERROR(connect());
+
+  if (strchr(mode, 'w') != NULL || strchr(mode, 'a') != NULL) {
+    int flags = O_WRONLY;
+    if (strchr(mode, 'a') != NULL && hdfsExists(fs_, path_.c_str()) == 0) {
+      flags |= O_APPEND;
+    }
+    file_ = hdfsOpenFile(fs_, path_.c_str(), flags, 0, 0, 0);
+    if (file_ == nullptr) {
+      return hdfsError("open", path_);
+    }
+    writing_ = true;
+    return Status::OK();
+  }
+
+  hdfsFileInfo* info = hdfsGetPathInfo(fs_, path_.c_str());
+  if (info == nullptr) {
+    return hdfsError("stat", path_);
+  }
+  file_size_ = info->mSize;
+  block_size_ = info->mBlockSize;
+  hdfsFreeFileInfo(info, 1);
+
+  file_ = hdfsOpenFile(fs_, path_.c_str(), O_RDONLY, 0, 0, 0);
+  if (file_ == nullptr) {
+    return hdfsError("open", path_);
+  }
+  writing_ = false;
+  begin_ = 0;
+  end_ = file_size_;
+  position_ = 0;
+  buffer_.clear();
+  buffer_pos_ = 0;
+
+  if (enable_partial_read_) {
+    RETURN_ON_ERROR(setPartialReadImpl());
+  } else if (header_row_) {
+    RETURN_ON_ERROR(ReadLine(header_line_));
+    ::boost::algorithm::trim(header_line_);
+    meta_.emplace("header_line", header_line_);
+  }
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::Close() {
+  if (file_ == nullptr) {
+    return Status::OK();
+  }
+  int ret = hdfsCloseFile(fs_, file_);
+  file_ = nullptr;
+  if (ret != 0) {
+    return hdfsError("close", path_);
+  }
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::SetPartialRead(const int index, const int total_parts) {
+  if (index < 0 || total_parts <= 0 || index >= total_parts) {
+    LOG(ERROR) << "error during set_partial_read with [" << index << ", "
+               << total_parts << "]";
+    return Status::IOError();
+  }
+  if (file_ != nullptr) {
+    LOG(WARNING) << "WARNING!! Set partial read after open have no effect,"
+                    "You probably want to set partial before open!";
+    return Status::IOError();
+  }
+  enable_partial_read_ = true;
+  index_ = index;
+  total_parts_ = total_parts;
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::GetPartialReadDetail(int64_t& offset, int64_t& nbytes) {
+  if (!enable_partial_read_) {
+    LOG(ERROR) << "Partial read is disabled, you probably want to"
+                  " set partial read first.";
+    return Status::IOError();
+  }
+  if (file_ == nullptr) {
+    LOG(ERROR) << "File not open, you probably want to open file first.";
+    return Status::IOError();
+  }
+  offset = begin_;
+  nbytes = end_ - begin_;
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::setPartialReadImpl() {
+  int64_t start = 0;
+  if (header_row_) {
+    RETURN_ON_ERROR(findLineBreak(0, start));
+    header_line_.resize(start);
+    position_ = 0;
+    end_ = start;
+    RETURN_ON_ERROR(Read(&header_line_[0], header_line_.size()));
+    ::boost::algorithm::trim(header_line_);
+    meta_.emplace("header_line", header_line_);
+  }
+
+  int64_t block_num =
+      block_size_ > 0 ? (file_size_ + block_size_ - 1) / block_size_ : 0;
+  // every boundary is computed independently, and is monotonic with the
+  // index, thus the parts of all readers cover the file without overlap
+  auto boundary = [&](int part, int64_t& offset) -> Status {
+    if (part == 0) {
+      offset = start;
+      return Status::OK();
+    }
+    if (part == total_parts_) {
+      offset = file_size_;
+      return Status::OK();
+    }
+    int64_t breakpoint;
+    if (block_num >= total_parts_) {
+      breakpoint = part * block_num / total_parts_ * block_size_;
+    } else {
+      breakpoint = start + part * (file_size_ - start) / total_parts_;
+    }
+    breakpoint = std::min(std::max(breakpoint, start), file_size_);
+    if (breakpoint == start || breakpoint == file_size_) {
+      offset = breakpoint;
+      return Status::OK();
+    }
+    // move breakpoint to the next of the nearest character '\n'
+    return findLineBreak(breakpoint - 1, offset);
+  };
+  RETURN_ON_ERROR(boundary(index_, begin_));
+  RETURN_ON_ERROR(boundary(index_ + 1, end_));
+  end_ = std::max(begin_, end_);
+  position_ = begin_;
+  buffer_.clear();
+  buffer_pos_ = 0;
+  VLOG(2) << "partial read [" << index_ << "/" << total_parts_ << "] of "
+          << path_ << ": offset = " << begin_ << ", nbytes = " << end_ - begin_
+          << ", block size = " << block_size_;
+  return collectHosts(begin_, end_ - begin_);
+}
+
+Status HDFSIOAdaptor::findLineBreak(int64_t offset, int64_t& next) {
+  std::vector<char> probe(kLineBreakProbeSize);
+  while (offset < file_size_) {
+    tSize nbytes = hdfsPread(fs_, file_, offset, probe.data(),
+                             kLineBreakProbeSize);
+    if (nbytes < 0) {
+      return hdfsError("read", path_);
+    }
+    if (nbytes == 0) {
+      break;
+    }
+    auto found = static_cast<const char*>(memchr(probe.data(), '\n', nbytes));
+    if (found != nullptr) {
+      next = offset + (found - probe.data()) + 1;
+      return Status::OK();
+    }
+    offset += nbytes;
+  }
+  next = file_size_;
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::collectHosts(int64_t offset, int64_t length) {
+  if (length <= 0) {
+    return Status::OK();
+  }
+  char*** hosts = hdfsGetHosts(fs_, path_.c_str(), offset, length);
+  if (hosts == nullptr) {
+    LOG(WARNING) << "Failed to get the locations of blocks of " << path_
+                 << ": " << std::strerror(errno);
+    return Status::OK();
+  }
+  // the hosts that hold more blocks of the part come first
+  std::unordered_map<std::string, int> counts;
+  for (size_t block = 0; hosts[block] != nullptr; ++block) {
+    for (size_t replica = 0; hosts[block][replica] != nullptr; ++replica) {
+      counts[hosts[block][replica]] += 1;
+    }
+  }
+  hdfsFreeHosts(hosts);
+  std::vector<std::pair<std::string, int>> sorted(counts.begin(),
+                                                  counts.end());
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::pair<std::string, int>& lhs,
+               const std::pair<std::string, int>& rhs) {
+              return lhs.second > rhs.second ||
+                     (lhs.second == rhs.second && lhs.first < rhs.first);
+            });
+  std::vector<std::string> names;
+  for (auto const& item : sorted) {
+    names.emplace_back(item.first);
+  }
+  std::string joined = boost::algorithm::join(names, ",");
+  meta_.emplace("hdfs_hosts", joined);
+
+  char hostname[256] = {0};
+  if (gethostname(hostname, sizeof(hostname) - 1) == 0 &&
+      counts.find(hostname) == counts.end()) {
+    VLOG(2) << "The part [" << index_ << "/" << total_parts_ << "] of "
+            << path_ << " is not local to " << hostname
+            << ", its blocks are on: " << joined;
+  }
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::Configure(const std::string& key,
+                                const std::string& value) {
+  if (key == "buffer_size") {
+    buffer_capacity_ = std::max(std::stoull(value), 1ull);
+  } else if (boost::starts_with(key, "dfs.")) {
+    if (fs_ != nullptr) {
+      return Status::Invalid("Configure " + key +
+                             " after connected have no effect.");
+    }
+    client_conf_[key] = value;
+  }
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::fillBuffer() {
+  if (position_ >= end_) {
+    return Status::EndOfFile();
+  }
+  size_t size =
+      std::min(buffer_capacity_, static_cast<size_t>(end_ - position_));
+  size = std::min(size,
+                  static_cast<size_t>(std::numeric_limits<tSize>::max()));
+  buffer_.resize(size);
+  size_t filled = 0;
+  while (filled < size) {
+    tSize nbytes = hdfsPread(fs_, file_, position_ + filled, &buffer_[filled],
+                             size - filled);
+    if (nbytes < 0) {
+      return hdfsError("read", path_);
+    }
+    if (nbytes == 0) {
+      break;
+    }
+    filled += nbytes;
+  }
+  buffer_.resize(filled);
+  buffer_pos_ = 0;
+  position_ += filled;
+  if (filled == 0) {
+    // the file has been truncated since opened
+    end_ = position_;
+    return Status::EndOfFile();
+  }
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::ReadLine(std::string& line) {
+  if (file_ == nullptr || writing_) {
+    return Status::Invalid("The file is not opened for read: " + location_);
+  }
+  line.clear();
+  while (true) {
+    if (buffer_pos_ >= buffer_.size()) {
+      auto status = fillBuffer();
+      if (status.IsEndOfFile() && !line.empty()) {
+        return Status::OK();
+      }
+      RETURN_ON_ERROR(status);
+    }
+    const char* begin = buffer_.data() + buffer_pos_;
+    size_t remaining = buffer_.size() - buffer_pos_;
+    auto found = static_cast<const char*>(memchr(begin, '\n', remaining));
+    if (found != nullptr) {
+      line.append(begin, found - begin + 1);
+      buffer_pos_ += found - begin + 1;
+      return Status::OK();
+    }
+    line.append(begin, remaining);
+    buffer_pos_ = buffer_.size();
+  }
+}
+
+Status HDFSIOAdaptor::Read(void* buffer, size_t size) {
+  if (file_ == nullptr || writing_) {
+    return Status::Invalid("The file is not opened for read: " + location_);
+  }
+  size_t read_size = 0;
+  while (read_size < size) {
+    if (buffer_pos_ >= buffer_.size()) {
+      auto status = fillBuffer();
+      if (status.IsEndOfFile() && read_size > 0) {
+        break;
+      }
+      RETURN_ON_ERROR(status);
+    }
+    size_t nbytes = std::min(size - read_size, buffer_.size() - buffer_pos_);
+    memcpy(static_cast<char*>(buffer) + read_size,
+           buffer_.data() + buffer_pos_, nbytes);
+    buffer_pos_ += nbytes;
+    read_size += nbytes;
+  }
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::WriteLine(const std::string& line) {
+  RETURN_ON_ERROR(Write(const_cast<char*>(line.data()), line.size()));
+  char line_break = '\n';
+  return Write(&line_break, 1);
+}
+
+Status HDFSIOAdaptor::Write(void* buffer, size_t size) {
+  if (file_ == nullptr || !writing_) {
+    return Status::Invalid("The file is not opened for write: " + location_);
+  }
+  auto data = static_cast<const char*>(buffer);
+  while (size > 0) {
+    tSize nbytes = hdfsWrite(fs_, file_, data, std::min(size, kMaxWriteSize));
+    if (nbytes < 0) {
+      return hdfsError("write", path_);
+    }
+    data += nbytes;
+    size -= nbytes;
+  }
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::ListDirectory(const std::string& path,
+                                    std::vector<std::string>& files) {
+  RETURN_ON_ERROR(connect());
+  int entries = 0;
+  errno = 0;
+  hdfsFileInfo* infos = hdfsListDirectory(fs_, path.c_str(), &entries);
+  if (infos == nullptr) {
+    // an empty directory
+    return errno == 0 ? Status::OK() : hdfsError("list", path);
+  }
+  for (int i = 0; i < entries; ++i) {
+    files.emplace_back(infos[i].mName);
+  }
+  hdfsFreeFileInfo(infos, entries);
+  return Status::OK();
+}
+
+Status HDFSIOAdaptor::MakeDirectory(const std::string& path) {
+  RETURN_ON_ERROR(connect());
+  if (hdfsCreateDirectory(fs_, path.c_str()) != 0) {
+    return hdfsError("create directory", path);
+  }
+  return Status::OK();
+}
+
+bool HDFSIOAdaptor::IsExist(const std::string& path) {
+  return connect().ok() && hdfsExists(fs_, path.c_str()) == 0;
+}
+
+}  // namespace vineyard
+
+#endif  // HDFS_ENABLED
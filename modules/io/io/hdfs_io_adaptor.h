@@ -0,0 +1,144 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_HDFS_IO_ADAPTOR_H_
+#define MODULES_IO_IO_HDFS_IO_ADAPTOR_H_
+
+#ifdef HDFS_ENABLED
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hdfs/hdfs.h"
+
+#include "common/util/status.h"
+#include "io/io/i_io_adaptor.h"
+
+namespace vineyard {
+
+/**
+ * @brief The I/O adaptor for files on HDFS, based on the C API of libhdfs3
+ * (which is compatible with the libhdfs of Hadoop).
+ *
+ * The location is in the format of
+ *
+ *    hdfs://<host>:<port>/<path>#header_row=true&delimiter=,
+ *
+ * The configurations in the fragment that start with "dfs." are passed to
+ * the HDFS client, e.g., "dfs.client.read.shortcircuit=false".
+ */
+class HDFSIOAdaptor : public IIOAdaptor {
+ public:
+  explicit HDFSIOAdaptor(const std::string& location);
+
+  ~HDFSIOAdaptor() override;
+
+  Status Open() override;
+
+  Status Open(const char* mode) override;
+
+  Status Close() override;
+
+  /** Read the part of file given index and total_parts.
+   *
+   * The file is cut at the boundaries of HDFS blocks, each part has a
+   * contiguous range of blocks, so that the part can be read from the
+   * datanodes that holds the blocks. If there are fewer blocks than parts the
+   * file is cut evenly by bytes. The breakpoints are then moved to the next
+   * of the nearest character '\n' after them.
+   *
+   * The hosts that hold the blocks of the part are reported in the meta as
+   * "hdfs_hosts", as the hint of data locality for scheduling the reader.
+   *
+   * @param index the index in a part of file
+   * @param total_parts total number of parts in file
+   * */
+  Status SetPartialRead(const int index, const int total_parts) override;
+
+  Status GetPartialReadDetail(int64_t& offset, int64_t& nbytes);
+
+  Status Configure(const std::string& key, const std::string& value) override;
+
+  /** Read a line, including the trailing '\n' (if any), like
+   * `LocalIOAdaptor::ReadLine`.
+   * */
+  Status ReadLine(std::string& line) override;
+
+  Status WriteLine(const std::string& line) override;
+
+  Status Read(void* buffer, size_t size) override;
+
+  Status Write(void* buffer, size_t size) override;
+
+  Status ListDirectory(const std::string& path,
+                       std::vector<std::string>& files) override;
+
+  Status MakeDirectory(const std::string& path) override;
+
+  bool IsExist(const std::string& path) override;
+
+  std::unordered_multimap<std::string, std::string> GetMeta() override {
+    return meta_;
+  }
+
+ private:
+  Status connect();
+
+  Status setPartialReadImpl();
+
+  Status findLineBreak(int64_t offset, int64_t& next);
+
+  Status collectHosts(int64_t offset, int64_t length);
+
+  Status fillBuffer();
+
+  std::string location_;
+  std::string host_;
+  int port_ = 0;
+  std::string path_;
+  std::map<std::string, std::string> client_conf_;
+
+  hdfsFS fs_ = nullptr;
+  hdfsFile file_ = nullptr;
+  bool writing_ = false;
+
+  std::unordered_multimap<std::string, std::string> meta_;
+  bool header_row_ = false;
+  char delimiter_ = ',';
+  std::string header_line_;
+
+  bool enable_partial_read_ = false;
+  int index_ = 0;
+  int total_parts_ = 1;
+
+  // the range of file to read, and the position of the next read
+  int64_t file_size_ = 0;
+  int64_t block_size_ = 0;
+  int64_t begin_ = 0;
+  int64_t end_ = 0;
+  int64_t position_ = 0;
+
+  size_t buffer_capacity_ = 4 * 1024 * 1024;
+  std::string buffer_;
+  size_t buffer_pos_ = 0;
+};
+
+}  // namespace vineyard
+
+#endif  // HDFS_ENABLED
+#endif  // MODULES_IO_IO_HDFS_IO_ADAPTOR_H_
@@ -24,6 +24,8 @@ limitations under the License.
 #include "network/uri.hpp"
 #include "network/uri/uri_io.hpp"
 
+#include "io/io/columnar_io_adaptor.h"
+#include "io/io/hdfs_io_adaptor.h"
 #include "io/io/kafka_io_adaptor.h"
 #include "io/io/local_io_adaptor.h"
 #include "io/io/oss_io_adaptor.h"
@@ -32,7 +34,15 @@ namespace vineyard {
 
 void IOFactory::Init() { LocalIOAdaptor::Init(); }
 
-void IOFactory::Finalize() { LocalIOAdaptor::Finalize(); }
+void IOFactory::Finalize() {
+  ConnectionCache::Default().Clear();
+  LocalIOAdaptor::Finalize();
+}
+
+void IOFactory::SetConnectionLimits(size_t max_leases,
+                                    int64_t idle_timeout_ms) {
+  ConnectionCache::Default().SetLimits(max_leases, idle_timeout_ms);
+}
 
 /** Create an I/O adaptor.
  * @param location the file location.
@@ -52,6 +62,10 @@ std::unique_ptr<IIOAdaptor> IOFactory::CreateIOAdaptor(
   }
 
   if (scheme == "file") {
+    if (!ColumnarIOAdaptor::DetectFormat(location).empty()) {
+      return std::unique_ptr<ColumnarIOAdaptor>(
+          new ColumnarIOAdaptor(location));
+    }
     return std::unique_ptr<LocalIOAdaptor>(new LocalIOAdaptor(location));
 #ifdef KAFKA_ENABLED
   } else if (scheme == "kafka") {
@@ -60,6 +74,10 @@ std::unique_ptr<IIOAdaptor> IOFactory::CreateIOAdaptor(
 #ifdef OSS_ENABLED
   } else if (scheme == "oss") {
     return std::unique_ptr<OSSIOAdaptor>(new OSSIOAdaptor(location));
+#endif
+#ifdef HDFS_ENABLED
+  } else if (scheme == "hdfs") {
+    return std::unique_ptr<HDFSIOAdaptor>(new HDFSIOAdaptor(location));
 #endif
   }
   LOG(ERROR) << "Unimplemented adaptor for the scheme: " << scheme;
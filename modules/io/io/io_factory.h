@@ -18,8 +18,10 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <typeinfo>
 
 #include "client/client.h"
+#include "io/io/connection_cache.h"
 #include "io/io/i_io_adaptor.h"
 
 namespace vineyard {
@@ -46,6 +48,28 @@ class IOFactory {
    */
   static std::unique_ptr<IIOAdaptor> CreateIOAdaptor(
       const std::string& location, Client* client = nullptr);
+
+  /** Lease the process-wide cached connection of type T (e.g., the client of
+   * an object store) of the key, which is created by `create` (returning a
+   * `std::shared_ptr<T>`) if it isn't cached, see also `ConnectionCache`.
+   *
+   * @param key the endpoint and credentials of the connection.
+   *
+   * @return the leased connection, or nullptr if it cannot be created.
+   */
+  template <typename T, typename FUNC_T>
+  static std::shared_ptr<T> AcquireConnection(const std::string& key,
+                                              const FUNC_T& create) {
+    return std::static_pointer_cast<T>(ConnectionCache::Default().Acquire(
+        std::string(typeid(T).name()) + "|" + key,
+        [&create]() -> std::shared_ptr<void> { return create(); }));
+  }
+
+  /** Bound the number of adaptors that share a cached connection at the same
+   * time, and evict the connections that have been idle for
+   * `idle_timeout_ms`.
+   */
+  static void SetConnectionLimits(size_t max_leases, int64_t idle_timeout_ms);
 };
 
 }  // namespace vineyard
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "io/io/kafka_io_adaptor.h"
 
+#include <cstring>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -27,6 +28,8 @@ limitations under the License.
 #include "librdkafka/rdkafka.h"
 #include "librdkafka/rdkafkacpp.h"
 
+#include "io/io/io_factory.h"
+
 namespace vineyard {
 
 KafkaIOAdaptor::KafkaIOAdaptor(const std::string& location) {
@@ -34,7 +37,11 @@ KafkaIOAdaptor::KafkaIOAdaptor(const std::string& location) {
   parseLocation(location);
 }
 
-KafkaIOAdaptor::~KafkaIOAdaptor() {}
+KafkaIOAdaptor::~KafkaIOAdaptor() {
+  if (producer_) {
+    producer_->flush(time_interval_ms_);
+  }
+}
 
 Status KafkaIOAdaptor::Open() {
   if (partial_read_) {
@@ -66,6 +73,7 @@ Status KafkaIOAdaptor::Open() {
   }
 
   message_queue_.resize(local_partition_num_);
+  uncommitted_offsets_.assign(local_partition_num_, -1);
   for (int i = 0; i < local_partition_num_; ++i) {
     consumer_ptrs_[i] = std::shared_ptr<RdKafka::KafkaConsumer>(
         RdKafka::KafkaConsumer::create(conf, rdkafka_err));
@@ -74,21 +82,14 @@ Status KafkaIOAdaptor::Open() {
                  << rdkafka_err;
     }
     std::vector<RdKafka::TopicPartition*> topic_partitions;
-    RdKafka::TopicPartition* topic_partition;
-    if (partial_read_) {
-      topic_partition = RdKafka::TopicPartition::create(
-          topic_, partial_index_ + i * total_parts_);
-    } else {
-      topic_partition = RdKafka::TopicPartition::create(topic_, i);
-    }
+    RdKafka::TopicPartition* topic_partition =
+        RdKafka::TopicPartition::create(topic_, partitionId(i));
     consumer_ptrs_[i]->assign({topic_partition});
     delete topic_partition;
     topic_partition = nullptr;
     consumer_ptrs_[i]->subscribe({topic_});
 
-    message_queue_[i] =
-        std::make_shared<PCBlockingQueue<std::vector<std::string>>>();
-    message_queue_[i]->SetLimit(16);
+    message_queue_[i] = std::make_shared<MPMCQueue<MessageBatch>>(16);
     message_queue_[i]->SetProducerNum(1);
   }
   delete conf;  // release the memory resource
@@ -103,26 +104,16 @@ Status KafkaIOAdaptor::Open() {
 Status KafkaIOAdaptor::Open(const char* mode) {
   if (strchr(mode, 'w') != NULL) {
     consumer_ = false;
-    RdKafka::Conf* conf = RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL);
-    std::string rdkafka_err;
-    if (conf->set("metadata.broker.list", brokers_, rdkafka_err) !=
-        RdKafka::Conf::CONF_OK) {
-      LOG(WARNING) << "Failed to set metadata.broker.list: " << rdkafka_err;
-    }
-    // for producer's internal queue.
-    if (conf->set("queue.buffering.max.messages",
-                  std::to_string(internal_buffer_size_),
-                  rdkafka_err) != RdKafka::Conf::CONF_OK) {
-      LOG(WARNING) << "Failed to set queue.buffering.max.messages: "
-                   << rdkafka_err;
-    }
-
-    producer_ = std::unique_ptr<RdKafka::Producer>(
-        RdKafka::Producer::create(conf, rdkafka_err));
+    // producers are thread-safe, and are shared by the adaptors of the same
+    // brokers and settings, thus the metadata handshakes aren't repeated
+    std::string key = brokers_ + "|" + std::to_string(internal_buffer_size_) +
+                      "|" + std::to_string(linger_ms_) + "|" +
+                      std::to_string(produce_batch_size_);
+    producer_ = IOFactory::AcquireConnection<RdKafka::Producer>(
+        key, [this]() { return createProducer(); });
     if (!producer_) {
-      LOG(ERROR) << "Failed to create kafka producer: " << rdkafka_err;
+      return Status::IOError("Failed to create kafka producer");
     }
-    delete conf;  // release the memory resource
     return Status::OK();
   } else {
     consumer_ = true;
@@ -139,6 +130,10 @@ Status KafkaIOAdaptor::Configure(const std::string& key,
     batch_size_per_partition_ = batch_size_ / local_partition_num_;
   } else if (key == "time_interval") {
     time_interval_ms_ = std::stoi(value) * 1000;
+  } else if (key == "linger_ms") {
+    linger_ms_ = std::stoi(value);
+  } else if (key == "produce_batch_size") {
+    produce_batch_size_ = std::stoi(value);
   }
   return Status::OK();
 }
@@ -151,68 +146,209 @@ Status KafkaIOAdaptor::SetPartialRead(const int index, const int total_parts) {
 }
 
 Status KafkaIOAdaptor::ReadLine(std::string& line) {
-  if (message_offset_ < message_list_.size()) {
-    line = message_list_[message_offset_];
-    ++message_offset_;
-    return Status::OK();
-  } else {
-    message_list_.clear();
+  if (message_offset_ >= message_list_.offsets.size()) {
     message_offset_ = 0;
-    bool end = false;
-    while (!end) {
-      end = true;
-      for (int i = 0; i < local_partition_num_; ++i) {
-        end = end & message_queue_[i]->End();
-        if (message_queue_[i]->Size()) {
-          message_queue_[i]->Get(message_list_);
-          break;
+    if (!nextBatch(message_list_)) {
+      message_list_ = MessageBatch();
+      return Status::EndOfFile();
+    }
+  }
+  size_t begin = message_list_.offsets[message_offset_];
+  size_t end = message_offset_ + 1 < message_list_.offsets.size()
+                   ? message_list_.offsets[message_offset_ + 1]
+                   : message_list_.data.size();
+  line.assign(message_list_.data, begin, end - begin - 1);
+  ++message_offset_;
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::ConsumeBatch(ByteStreamWriter& writer,
+                                    size_t& message_num) {
+  message_num = 0;
+  // continue with the batch that has been partially read by `ReadLine`
+  if (message_offset_ >= message_list_.offsets.size()) {
+    message_offset_ = 0;
+    if (!nextBatch(message_list_)) {
+      message_list_ = MessageBatch();
+      return Status::EndOfFile();
+    }
+  }
+  // keep the order with the lines that have been written to the writer
+  RETURN_ON_ERROR(writer.Flush());
+  size_t begin = message_list_.offsets[message_offset_];
+  size_t size = message_list_.data.size() - begin;
+  std::unique_ptr<arrow::MutableBuffer> buffer;
+  RETURN_ON_ERROR(writer.GetNext(size, buffer));
+  memcpy(buffer->mutable_data(), message_list_.data.data() + begin, size);
+  message_num = message_list_.offsets.size() - message_offset_;
+  message_list_ = MessageBatch();
+  message_offset_ = 0;
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::ConsumePartitionBatch(int const partition_index,
+                                             ByteStreamWriter& writer,
+                                             size_t& message_num) {
+  message_num = 0;
+  MessageBatch batch;
+  do {
+    if (!message_queue_[partition_index]->Get(batch)) {
+      return Status::EndOfFile();
+    }
+  } while (batch.offsets.empty());
+  std::unique_ptr<arrow::MutableBuffer> buffer;
+  RETURN_ON_ERROR(writer.GetNext(batch.data.size(), buffer));
+  // the chunk of the previous batch has been sealed
+  RETURN_ON_ERROR(CommitPartition(partition_index));
+  memcpy(buffer->mutable_data(), batch.data.data(), batch.data.size());
+  message_num = batch.offsets.size();
+  uncommitted_offsets_[partition_index] = batch.last_offset + 1;
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::CommitPartition(int const partition_index) {
+  int64_t offset = uncommitted_offsets_[partition_index];
+  if (offset < 0) {
+    return Status::OK();
+  }
+  RdKafka::TopicPartition* topic_partition = RdKafka::TopicPartition::create(
+      topic_, partitionId(partition_index), offset);
+  std::vector<RdKafka::TopicPartition*> topic_partitions = {topic_partition};
+  RdKafka::ErrorCode err =
+      consumer_ptrs_[partition_index]->commitSync(topic_partitions);
+  delete topic_partition;
+  if (err != RdKafka::ERR_NO_ERROR) {
+    return Status::IOError("Failed to commit the offsets to kafka: " +
+                           RdKafka::err2str(err));
+  }
+  uncommitted_offsets_[partition_index] = -1;
+  return Status::OK();
+}
+
+int KafkaIOAdaptor::partitionId(int const partition_index) const {
+  return partial_read_ ? partial_index_ + partition_index * total_parts_
+                       : partition_index;
+}
+
+bool KafkaIOAdaptor::nextBatch(MessageBatch& batch) {
+  bool end = false;
+  while (!end) {
+    end = true;
+    for (int i = 0; i < local_partition_num_; ++i) {
+      end = end & message_queue_[i]->End();
+      if (message_queue_[i]->TryPop(batch)) {
+        if (!batch.offsets.empty()) {
+          return true;
         }
       }
-      if (message_list_.size()) {
-        line = message_list_[message_offset_];
-        ++message_offset_;
-        return Status::OK();
-      }
     }
-    return Status::EndOfFile();
   }
+  return false;
 }
 
 Status KafkaIOAdaptor::WriteLine(const std::string& line) {
   if (line.empty()) {
     return Status::OK();
   }
-  RdKafka::ErrorCode err = producer_->produce(
-      topic_, RdKafka::Topic::PARTITION_UA, RdKafka::Producer::RK_MSG_COPY,
-      static_cast<void*>(const_cast<char*>(line.c_str())) /* value */,
-      line.size() /* size */, NULL, 0, 0 /* timestamp */,
-      NULL /* delivery report */);
-  if (err != RdKafka::ERR_NO_ERROR) {
-    LOG(ERROR) << "Failed to writeline to kafka: " << RdKafka::err2str(err);
-  }
-  producer_->flush(time_interval_ms_);
-  return Status::OK();
+  return produce(line.data(), line.size());
 }
 
 Status KafkaIOAdaptor::Write(void* buffer, size_t size) {
-  {
-    if (size == 0) {
-      return Status::OK();
+  if (size == 0) {
+    return Status::OK();
+  }
+  return produce(static_cast<const char*>(buffer), size);
+}
+
+std::shared_ptr<RdKafka::Producer> KafkaIOAdaptor::createProducer() {
+  RdKafka::Conf* conf = RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL);
+  std::string rdkafka_err;
+  if (conf->set("metadata.broker.list", brokers_, rdkafka_err) !=
+      RdKafka::Conf::CONF_OK) {
+    LOG(WARNING) << "Failed to set metadata.broker.list: " << rdkafka_err;
+  }
+  // for producer's internal queue.
+  if (conf->set("queue.buffering.max.messages",
+                std::to_string(internal_buffer_size_),
+                rdkafka_err) != RdKafka::Conf::CONF_OK) {
+    LOG(WARNING) << "Failed to set queue.buffering.max.messages: "
+                 << rdkafka_err;
+  }
+  // messages are batched by the producer, rather than flushed one by one
+  if (conf->set("linger.ms", std::to_string(linger_ms_), rdkafka_err) !=
+      RdKafka::Conf::CONF_OK) {
+    LOG(WARNING) << "Failed to set linger.ms: " << rdkafka_err;
+  }
+  if (conf->set("batch.num.messages", std::to_string(produce_batch_size_),
+                rdkafka_err) != RdKafka::Conf::CONF_OK) {
+    LOG(WARNING) << "Failed to set batch.num.messages: " << rdkafka_err;
+  }
+
+  std::shared_ptr<RdKafka::Producer> producer(
+      RdKafka::Producer::create(conf, rdkafka_err));
+  if (!producer) {
+    LOG(ERROR) << "Failed to create kafka producer: " << rdkafka_err;
+  }
+  delete conf;  // release the memory resource
+  return producer;
+}
+
+Status KafkaIOAdaptor::WriteLines(const char* data, size_t size) {
+  const char* end = data + size;
+  while (data < end) {
+    auto next = static_cast<const char*>(memchr(data, '\n', end - data));
+    if (next == nullptr) {
+      pending_line_.append(data, end - data);
+      break;
+    }
+    if (!pending_line_.empty()) {
+      pending_line_.append(data, next - data);
+      RETURN_ON_ERROR(produce(pending_line_.data(), pending_line_.size()));
+      pending_line_.clear();
+    } else if (next > data) {
+      RETURN_ON_ERROR(produce(data, next - data));
     }
+    data = next + 1;
+  }
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::produce(const char* data, size_t size) {
+  while (true) {
     RdKafka::ErrorCode err = producer_->produce(
         topic_, RdKafka::Topic::PARTITION_UA, RdKafka::Producer::RK_MSG_COPY,
-        buffer /* value */, size /* size */, NULL, 0, 0 /* timestamp */,
+        static_cast<void*>(const_cast<char*>(data)) /* value */,
+        size /* size */, NULL, 0, 0 /* timestamp */,
         NULL /* delivery report */);
-    if (err != RdKafka::ERR_NO_ERROR) {
+    if (err == RdKafka::ERR_NO_ERROR) {
+      producer_->poll(0);
+      return Status::OK();
+    }
+    if (err != RdKafka::ERR__QUEUE_FULL) {
       LOG(ERROR) << "Failed to output to kafka: " << RdKafka::err2str(err);
+      return Status::IOError("Failed to output to kafka: " +
+                             RdKafka::err2str(err));
+    }
+    // backpressure: wait until some batches have been delivered
+    producer_->poll(100);
+  }
+}
+
+Status KafkaIOAdaptor::Close() {
+  if (producer_) {
+    if (!pending_line_.empty()) {
+      RETURN_ON_ERROR(produce(pending_line_.data(), pending_line_.size()));
+      pending_line_.clear();
     }
     producer_->flush(time_interval_ms_);
+    if (producer_->outq_len() > 0) {
+      return Status::IOError(std::to_string(producer_->outq_len()) +
+                             " messages haven't been delivered to kafka");
+    }
   }
   return Status::OK();
 }
 
-Status KafkaIOAdaptor::Close() { return Status::OK(); }
-
 void KafkaIOAdaptor::parseLocation(const std::string& location) {
   std::string tmp_location(location);
   std::replace(tmp_location.begin(), tmp_location.end(), ';', ',');
@@ -240,7 +376,7 @@ void KafkaIOAdaptor::startFetch() {
   for (int i = 0; i < local_partition_num_; ++i) {
     std::thread t = std::thread([&, i] {
       while (!message_queue_[i]->End()) {
-        std::vector<std::string> msg;
+        MessageBatch msg;
         fetchMessage(i, msg);
         message_queue_[i]->Put(std::move(msg));
       }
@@ -251,9 +387,8 @@ void KafkaIOAdaptor::startFetch() {
   }
 }
 
-void KafkaIOAdaptor::fetchMessage(int partition_index,
-                                  std::vector<std::string>& messages) {
-  messages.reserve(batch_size_per_partition_);
+void KafkaIOAdaptor::fetchMessage(int partition_index, MessageBatch& messages) {
+  messages.offsets.reserve(batch_size_per_partition_);
   // Create a consumer dispatcher
   auto consumer_ptr_ = consumer_ptrs_[partition_index];
 
@@ -263,7 +398,6 @@ void KafkaIOAdaptor::fetchMessage(int partition_index,
   int msg_len;
   const char* msg_payload;
   int64_t timestamp;
-  std::string msg_data;
 
   auto process = [&](int partition_index, RdKafka::Message* message) -> bool {
     switch (message->err()) {
@@ -282,11 +416,13 @@ void KafkaIOAdaptor::fetchMessage(int partition_index,
       msg_payload = static_cast<char*>(message->payload());
       timestamp = message->timestamp().timestamp;
 
-      msg_data = std::string(msg_payload, msg_len);
-      if (!msg_data.empty()) {
-        messages.push_back(msg_data);
+      if (msg_len > 0) {
+        messages.offsets.push_back(messages.data.size());
+        messages.data.append(msg_payload, msg_len);
+        messages.data.push_back('\n');
         ++msg_cnt;
       }
+      messages.last_offset = message->offset();
       if (!first_msg_ts) {
         first_msg_ts = timestamp;
       }
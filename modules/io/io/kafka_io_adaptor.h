@@ -27,6 +27,7 @@ limitations under the License.
 #include "librdkafka/rdkafka.h"
 #include "librdkafka/rdkafkacpp.h"
 
+#include "basic/stream/byte_stream.h"
 #include "common/util/blocking_queue.h"
 #include "common/util/functions.h"
 #include "common/util/status.h"
@@ -53,12 +54,55 @@ class KafkaIOAdaptor : public IIOAdaptor {
 
   Status ReadLine(std::string& line) override;
 
+  /**
+   * @brief Consume the next batch of messages and write their payloads, each
+   * followed by a '\n', into one chunk of the byte stream directly, without
+   * going through the per-line buffering of the writer.
+   *
+   * `message_num` is the number of messages in the batch, returns EndOfFile
+   * when all partitions have been drained.
+   */
+  Status ConsumeBatch(ByteStreamWriter& writer, size_t& message_num);
+
+  /**
+   * @brief The number of partitions that are consumed by this adaptor, i.e.,
+   * the partitions that are assigned by `SetPartialRead`, available after
+   * `Open()`.
+   */
+  int LocalPartitionNum() const { return local_partition_num_; }
+
+  /**
+   * @brief Like `ConsumeBatch`, but consumes the batches of the given local
+   * partition only, thus each partition can be consumed into its own stream
+   * by its own thread concurrently.
+   *
+   * The offsets of the previous batch of the partition are committed to
+   * kafka, as the chunk of the previous batch has been sealed once the next
+   * chunk is requested, and the last batch is committed by `CommitPartition`
+   * after the writer has been finished.
+   */
+  Status ConsumePartitionBatch(int const partition_index,
+                               ByteStreamWriter& writer, size_t& message_num);
+
+  /**
+   * @brief Commit the offsets of the batches of the local partition that have
+   * been written by `ConsumePartitionBatch`.
+   */
+  Status CommitPartition(int const partition_index);
+
   Status SetPartialRead(const int index, const int total_parts) override;
 
   Status GetPartialReadDetail(int64_t& offset, int64_t& nbytes) {
     return Status::NotImplemented();
   }
 
+  /**
+   * Besides the "group_id", "batch_size" and "time_interval" of consumers,
+   * the producers accept (before `Open("w")`)
+   *
+   *  - "linger_ms": how long the producer waits to accumulate a batch.
+   *  - "produce_batch_size": the maximum number of messages in a batch.
+   */
   Status Configure(const std::string& key, const std::string& value) override;
 
   Status WriteLine(const std::string& line) override;
@@ -69,6 +113,12 @@ class KafkaIOAdaptor : public IIOAdaptor {
 
   Status Write(void* buffer, size_t size) override;
 
+  /**
+   * @brief Produce every line in the buffer as a message, a trailing partial
+   * line is kept and prepended to the next buffer, or produced on `Close`.
+   */
+  Status WriteLines(const char* data, size_t size);
+
   Status ListDirectory(const std::string& path,
                        std::vector<std::string>& files) override {
     return Status::NotImplemented();
@@ -85,7 +135,23 @@ class KafkaIOAdaptor : public IIOAdaptor {
 
   void startFetch();
 
-  void fetchMessage(int partition, std::vector<std::string>& messages);
+  // the payloads of a batch of messages, each followed by a '\n'
+  struct MessageBatch {
+    std::string data;
+    std::vector<size_t> offsets;
+    int64_t last_offset = -1;  // the kafka offset of the last message
+  };
+
+  // the kafka partition of the local partition
+  int partitionId(int const partition_index) const;
+
+  void fetchMessage(int partition, MessageBatch& messages);
+
+  bool nextBatch(MessageBatch& batch);
+
+  Status produce(const char* data, size_t size);
+
+  std::shared_ptr<RdKafka::Producer> createProducer();
 
   static const constexpr int internal_buffer_size_ = 1024 * 1024;
 
@@ -101,14 +167,18 @@ class KafkaIOAdaptor : public IIOAdaptor {
   int partial_index_;
   int total_parts_;
 
-  template <typename T>
-  using mq_t = std::shared_ptr<PCBlockingQueue<std::vector<T>>>;
-  std::vector<mq_t<std::string>> message_queue_;
-  std::vector<std::string> message_list_;
+  std::vector<std::shared_ptr<MPMCQueue<MessageBatch>>> message_queue_;
+  // the offset to commit of each local partition, -1 if nothing to commit
+  std::vector<int64_t> uncommitted_offsets_;
+  MessageBatch message_list_;
   std::string group_id_;
   std::string brokers_;
   std::string topic_;
-  std::unique_ptr<RdKafka::Producer> producer_;
+  int linger_ms_ = 5;
+  int produce_batch_size_ = 10000;
+  std::string pending_line_;
+  // leased from the connection cache of `IOFactory`
+  std::shared_ptr<RdKafka::Producer> producer_;
   std::map<int, std::shared_ptr<RdKafka::KafkaConsumer>> consumer_ptrs_;
 };
 }  // namespace vineyard
@@ -16,9 +16,16 @@ limitations under the License.
 #include "io/io/local_io_adaptor.h"
 
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
 #include <limits>
 #include <memory>
 #include <string>
@@ -33,14 +40,61 @@ limitations under the License.
 #include "basic/ds/arrow_utils.h"
 
 namespace vineyard {
+
+namespace {
+
+// reads the byte ranges of local files, for the decompression
+class LocalRangeFetcher : public IRangeFetcher {
+ public:
+  Status Fetch(const std::string& object, size_t offset, size_t length,
+               std::string& content) override {
+    int fd = open(object.c_str(), O_RDONLY);
+    if (fd == -1) {
+      return Status::IOError("Failed to open the " + object +
+                             " because: " + std::strerror(errno));
+    }
+    content.resize(length);
+    size_t nread = 0;
+    while (nread < length) {
+      ssize_t nbytes = pread(fd, &content[nread], length - nread,
+                             static_cast<off_t>(offset + nread));
+      if (nbytes < 0 && errno == EINTR) {
+        continue;
+      }
+      if (nbytes <= 0) {
+        break;
+      }
+      nread += nbytes;
+    }
+    int err = errno;
+    close(fd);
+    if (nread < length) {
+      content.resize(nread);
+      return Status::IOError("Failed to read the " + object + " at " +
+                             std::to_string(offset) +
+                             " because: " + std::strerror(err));
+    }
+    return Status::OK();
+  }
+};
+
+}  // namespace
+
 LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
     : file_(nullptr),
       location_(location),
       using_std_getline_(false),
+      using_mmap_(false),
+      mapped_(false),
+      fd_(-1),
+      mapped_data_(nullptr),
+      mapped_size_(0),
+      mapped_pos_(0),
       header_row_(false),
       enable_partial_read_(false),
       total_parts_(0),
-      index_(0) {
+      index_(0),
+      sub_parts_(1) {
   // in csv format location:
   //    file_path#schema=t1,t2,t3&header_row=true/false
 
@@ -72,6 +126,17 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
       } else if (kv_pair[0] == "header_row") {
         header_row_ = (kv_pair[1] == "true");
         meta_.emplace("header_row", std::to_string(header_row_));
+      } else if (kv_pair[0] == "compression" && kv_pair.size() > 1) {
+        compression_ = kv_pair[1];
+      } else if ((kv_pair[0] == "split_index" ||
+                  kv_pair[0] == "split_index_path" ||
+                  kv_pair[0] == "record_size") &&
+                 kv_pair.size() > 1) {
+        auto status = Configure(kv_pair[0], kv_pair[1]);
+        if (!status.ok()) {
+          LOG(ERROR) << "Invalid option '" << iter
+                     << "': " << status.ToString();
+        }
       } else if (kv_pair.size() > 1) {
         meta_.emplace(kv_pair[0], kv_pair[1]);
       }
@@ -86,7 +151,9 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
 }
 
 LocalIOAdaptor::~LocalIOAdaptor() {
-  if (file_ != nullptr) {
+  if (mapped_) {
+    closeMapped();
+  } else if (file_ != nullptr) {
     fclose(file_);
     file_ = nullptr;
   } else if (fs_.is_open()) {
@@ -98,46 +165,46 @@ LocalIOAdaptor::~LocalIOAdaptor() {
 Status LocalIOAdaptor::Open() { return this->Open("r"); }
 
 Status LocalIOAdaptor::Open(const char* mode) {
-  bool to_write = false;
-  std::string tag = ".gz";
-  size_t pos = location_.find(tag);
-  if (pos != location_.size() - tag.size()) {
-    if (strchr(mode, 'w') != NULL || strchr(mode, 'a') != NULL) {
-      to_write = true;
-      int t = location_.find_last_of('/');
-      if (t != -1) {
-        std::string folder_path = location_.substr(0, t);
-        if (access(folder_path.c_str(), 0) != 0) {
-          RETURN_ON_ERROR(MakeDirectory(folder_path));
-        }
-      }
+  bool to_write = strchr(mode, 'w') != NULL || strchr(mode, 'a') != NULL;
+  if (compressed()) {
+    if (to_write || strchr(mode, '+') != NULL) {
+      return Status::NotImplemented(
+          "Writing to compressed files is not supported: " + location_);
     }
-    if (using_std_getline_) {
-      if (strchr(mode, 'b') != NULL) {
-        fs_.open(location_.c_str(),
-                 std::ios::binary | std::ios::in | std::ios::out);
-      } else if (strchr(mode, 'a') != NULL) {
-        fs_.open(location_.c_str(),
-                 std::ios::out | std::ios::in | std::ios::app);
-      } else if (strchr(mode, 'w') != NULL || strchr(mode, '+') != NULL) {
-        fs_.open(location_.c_str(),
-                 std::ios::out | std::ios::in | std::ios::trunc);
-      } else if (strchr(mode, 'r') != NULL) {
-        fs_.open(location_.c_str(), std::ios::in);
+    return openDecompressed();
+  }
+  if (to_write) {
+    int t = location_.find_last_of('/');
+    if (t != -1) {
+      std::string folder_path = location_.substr(0, t);
+      if (access(folder_path.c_str(), 0) != 0) {
+        RETURN_ON_ERROR(MakeDirectory(folder_path));
       }
-    } else {
-      file_ = fopen(location_.c_str(), mode);
+    }
+  }
+  if (using_mmap_ && !to_write && strchr(mode, '+') == NULL) {
+    RETURN_ON_ERROR(openMapped());
+  } else if (using_std_getline_) {
+    if (strchr(mode, 'b') != NULL) {
+      fs_.open(location_.c_str(),
+               std::ios::binary | std::ios::in | std::ios::out);
+    } else if (strchr(mode, 'a') != NULL) {
+      fs_.open(location_.c_str(), std::ios::out | std::ios::in | std::ios::app);
+    } else if (strchr(mode, 'w') != NULL || strchr(mode, '+') != NULL) {
+      fs_.open(location_.c_str(),
+               std::ios::out | std::ios::in | std::ios::trunc);
+    } else if (strchr(mode, 'r') != NULL) {
+      fs_.open(location_.c_str(), std::ios::in);
     }
   } else {
-    return Status::NotImplemented();
+    file_ = fopen(location_.c_str(), mode);
   }
 
   if (to_write) {
     return Status::OK();
   }
 
-  if ((using_std_getline_ && !fs_) ||
-      (!using_std_getline_ && file_ == nullptr)) {
+  if (!isOpen()) {
     return Status::IOError("Failed to open the " + location_ +
                            " because: " + std::strerror(errno));
   }
@@ -163,10 +230,152 @@ Status LocalIOAdaptor::Configure(const std::string& key,
     } else if (value == "true") {
       using_std_getline_ = true;
     }
+  } else if (key == "using_mmap") {
+    using_mmap_ = (value == "true");
+  } else if (key == "compression") {
+    if (value != "auto" && value != "none" && value != "gzip" &&
+        value != "zstd") {
+      return Status::Invalid("Unknown compression codec: " + value);
+    }
+    compression_ = value;
+  } else if (key == "split_index") {
+    if (value != "auto" && value != "build" && value != "none") {
+      return Status::Invalid("Unknown mode of the split index: " + value);
+    }
+    split_index_ = value;
+  } else if (key == "split_index_path") {
+    split_index_path_ = value;
+  } else if (key == "record_size") {
+    try {
+      record_size_ = std::max(std::stoll(value), 0LL);
+    } catch (std::exception const& e) {
+      return Status::Invalid("Invalid value for " + key + ": " + value);
+    }
+  } else if (key == "decompress_concurrency") {
+    try {
+      decompress_concurrency_ = std::max(std::stoi(value), 1);
+    } catch (std::exception const& e) {
+      return Status::Invalid("Invalid value for " + key + ": " + value);
+    }
   }
   return Status::OK();
 }
 
+bool LocalIOAdaptor::isOpen() const {
+  if (mapped_ || decompressed_ != nullptr) {
+    return true;
+  }
+  return using_std_getline_ ? static_cast<bool>(fs_) : file_ != nullptr;
+}
+
+Status LocalIOAdaptor::openMapped() {
+  fd_ = open(location_.c_str(), O_RDONLY);
+  if (fd_ == -1) {
+    return Status::IOError("Failed to open the " + location_ +
+                           " because: " + std::strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) {
+    int err = errno;
+    close(fd_);
+    fd_ = -1;
+    return Status::IOError("Failed to stat the " + location_ +
+                           " because: " + std::strerror(err));
+  }
+  mapped_size_ = st.st_size;
+  mapped_pos_ = 0;
+  if (mapped_size_ > 0) {
+    void* data = mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (data == MAP_FAILED) {
+      int err = errno;
+      close(fd_);
+      fd_ = -1;
+      return Status::IOError("Failed to mmap the " + location_ +
+                             " because: " + std::strerror(err));
+    }
+    mapped_data_ = static_cast<const char*>(data);
+    // the lines are scanned once from the beginning to the end
+    madvise(data, mapped_size_, MADV_SEQUENTIAL);
+#if defined(POSIX_FADV_SEQUENTIAL)
+    // and read ahead from the page cache
+    posix_fadvise(fd_, 0, mapped_size_, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(fd_, 0, mapped_size_, POSIX_FADV_WILLNEED);
+#endif
+  }
+  mapped_ = true;
+  return Status::OK();
+}
+
+std::string LocalIOAdaptor::codec() const {
+  if (compression_ == "auto") {
+    return DecompressedReader::DetectCodec(location_);
+  }
+  return compression_ == "none" ? "" : compression_;
+}
+
+bool LocalIOAdaptor::compressed() const { return !codec().empty(); }
+
+Status LocalIOAdaptor::openDecompressed() {
+  if (header_row_) {
+    // the header is the first line of the file, rather than of the part
+    std::unique_ptr<DecompressedReader> reader;
+    RETURN_ON_ERROR(openDecompressedPart(0, 1, reader, false));
+    auto status = reader->ReadLine(header_line_);
+    if (!status.ok() && !status.IsEndOfFile()) {
+      return status;
+    }
+    ::boost::algorithm::trim(header_line_);
+    meta_.emplace("header_line", header_line_);
+    ::boost::split(original_columns_, header_line_,
+                   ::boost::is_any_of(std::string(1, delimiter_)));
+  }
+  // the sub-parts are read as a whole
+  if (enable_partial_read_) {
+    return openDecompressedPart(index_ / sub_parts_, total_parts_ / sub_parts_,
+                                decompressed_);
+  }
+  return openDecompressedPart(0, 1, decompressed_);
+}
+
+Status LocalIOAdaptor::openDecompressedPart(
+    const int index, const int total_parts,
+    std::unique_ptr<DecompressedReader>& reader, const bool skip_header) {
+  struct stat st;
+  if (stat(location_.c_str(), &st) != 0) {
+    return Status::IOError("Failed to stat the " + location_ +
+                           " because: " + std::strerror(errno));
+  }
+  reader.reset(new DecompressedReader(std::make_shared<LocalRangeFetcher>(),
+                                      codec(), decompress_concurrency_));
+  if (total_parts > 1) {
+    RETURN_ON_ERROR(reader->SetPartialRead(index, total_parts));
+  }
+  RETURN_ON_ERROR(
+      reader->Start({{location_, static_cast<size_t>(st.st_size)}}));
+  if (skip_header && header_row_ && index == 0) {
+    std::string header_line;
+    auto status = reader->ReadLine(header_line);
+    if (!status.ok() && !status.IsEndOfFile()) {
+      return status;
+    }
+  }
+  return Status::OK();
+}
+
+void LocalIOAdaptor::closeMapped() {
+  if (mapped_data_ != nullptr) {
+    munmap(const_cast<char*>(mapped_data_), mapped_size_);
+    mapped_data_ = nullptr;
+  }
+  if (fd_ != -1) {
+    close(fd_);
+    fd_ = -1;
+  }
+  mapped_size_ = 0;
+  mapped_pos_ = 0;
+  mapped_ = false;
+}
+
 Status LocalIOAdaptor::SetPartialRead(const int index, const int total_parts) {
   // make sure that the bytes of each line of the file
   // is smaller than macro FINELINE
@@ -175,7 +384,8 @@ Status LocalIOAdaptor::SetPartialRead(const int index, const int total_parts) {
                << total_parts << "]";
     return Status::IOError();
   }
-  if (fs_.is_open() || file_ != nullptr) {
+  if (fs_.is_open() || file_ != nullptr || mapped_ ||
+      decompressed_ != nullptr) {
     LOG(WARNING) << "WARNING!! Set partial read after open have no effect,"
                     "You probably want to set partial before open!";
     return Status::IOError();
@@ -183,6 +393,20 @@ Status LocalIOAdaptor::SetPartialRead(const int index, const int total_parts) {
   enable_partial_read_ = true;
   index_ = index;
   total_parts_ = total_parts;
+  sub_parts_ = 1;
+  return Status::OK();
+}
+
+Status LocalIOAdaptor::SetPartialRead(const int index, const int total_parts,
+                                      const int sub_parts) {
+  if (sub_parts <= 0 ||
+      total_parts > std::numeric_limits<int>::max() / sub_parts) {
+    LOG(ERROR) << "error during set_partial_read with [" << index << ", "
+               << total_parts << ", " << sub_parts << "]";
+    return Status::IOError();
+  }
+  RETURN_ON_ERROR(SetPartialRead(index * sub_parts, total_parts * sub_parts));
+  sub_parts_ = sub_parts;
   return Status::OK();
 }
 
@@ -192,11 +416,14 @@ Status LocalIOAdaptor::GetPartialReadDetail(int64_t& offset, int64_t& nbytes) {
                   " set partial read first.";
     return Status::IOError();
   }
-  if ((using_std_getline_ && !fs_) ||
-      (!using_std_getline_ && file_ == nullptr)) {
+  if (!isOpen()) {
     LOG(ERROR) << "File not open, you probably want to open file first.";
     return Status::IOError();
   }
+  if (decompressed_ != nullptr) {
+    return Status::Invalid(
+        "The partial read of compressed files isn't a range of bytes");
+  }
   offset = partial_read_offset_[index_];
   nbytes = partial_read_offset_[index_ + 1] - partial_read_offset_[index_];
 
@@ -205,46 +432,39 @@ Status LocalIOAdaptor::GetPartialReadDetail(int64_t& offset, int64_t& nbytes) {
 }
 
 Status LocalIOAdaptor::setPartialReadImpl() {
-  partial_read_offset_.resize(total_parts_ + 1,
-                              std::numeric_limits<int>::max());
-  partial_read_offset_[0] = 0;
-  int start_pos = 0;
-  if (header_row_) {
-    RETURN_ON_ERROR(seek(0, kFileLocationBegin));
-    RETURN_ON_ERROR(ReadLine(header_line_));
-    ::boost::algorithm::trim(header_line_);
-    meta_.emplace("header_line", header_line_);
-    ::boost::split(original_columns_, header_line_,
-                   ::boost::is_any_of(std::string(1, delimiter_)));
+  partial_read_offset_.assign(total_parts_ + 1,
+                              std::numeric_limits<int64_t>::max());
+  std::shared_ptr<const SplitIndex> split_index;
+  if (split_index_ != "none" && record_size_ == 0) {
+    RETURN_ON_ERROR(SplitIndex::Get(
+        location_,
+        split_index_path_.empty() ? location_ + ".idx" : split_index_path_,
+        split_index_ == "build", split_index));
+  }
 
-    // skip header row
-    int64_t dis = getDistanceToLineBreak(0);
-    start_pos = dis + 1;
+  int64_t start_pos = 0;
+  if (header_row_) {
+    RETURN_ON_ERROR(readHeaderRow(split_index, start_pos));
+  }
+  int64_t total_file_size = 0;
+  if (split_index != nullptr) {
+    total_file_size = split_index->size();
+  } else {
+    RETURN_ON_ERROR(seek(0, kFileLocationEnd));
+    total_file_size = tell();
   }
-  RETURN_ON_ERROR(seek(0, kFileLocationEnd));
-  int64_t total_file_size = tell();
   if (start_pos > total_file_size) {
     start_pos = total_file_size;
   }
-  int64_t part_size = (total_file_size - start_pos) / total_parts_;
-
   partial_read_offset_[0] = start_pos;
   partial_read_offset_[total_parts_] = total_file_size;
 
-  // move breakpoint to the next of nearest character '\n'
-  for (int i = 1; i < total_parts_; ++i) {
-    partial_read_offset_[i] = i * part_size + start_pos;
-
-    if (partial_read_offset_[i] < partial_read_offset_[i - 1]) {
-      partial_read_offset_[i] = partial_read_offset_[i - 1];
-    } else {
-      // traversing backwards to find the nearest character '\n',
-      int64_t dis = getDistanceToLineBreak(i);
-      partial_read_offset_[i] += (dis + 1);
-      if (partial_read_offset_[i] > total_file_size) {
-        partial_read_offset_[i] = total_file_size;
-      }
-    }
+  // only the boundaries of the parts to read (i.e., the sub-parts) are
+  // located, which are independent of each other
+  int last = std::min(index_ + sub_parts_, total_parts_ - 1);
+  for (int i = std::max(index_, 1); i <= last; ++i) {
+    RETURN_ON_ERROR(
+        locatePartialReadOffset(i, start_pos, total_file_size, split_index));
   }
 
   int64_t file_stream_pos = partial_read_offset_[index_];
@@ -252,24 +472,127 @@ Status LocalIOAdaptor::setPartialReadImpl() {
   return Status::OK();
 }
 
+Status LocalIOAdaptor::readHeaderRow(
+    std::shared_ptr<const SplitIndex> const& split_index,
+    int64_t& header_end) {
+  if (split_index != nullptr) {
+    header_line_ = split_index->header();
+    header_end = split_index->header_end();
+  } else {
+    RETURN_ON_ERROR(seek(0, kFileLocationBegin));
+    RETURN_ON_ERROR(ReadLine(header_line_));
+    RETURN_ON_ERROR(SplitIndex::ProbeLineStart(location_, 1, header_end));
+  }
+  ::boost::algorithm::trim(header_line_);
+  meta_.emplace("header_line", header_line_);
+  ::boost::split(original_columns_, header_line_,
+                 ::boost::is_any_of(std::string(1, delimiter_)));
+  return Status::OK();
+}
+
+Status LocalIOAdaptor::locatePartialReadOffset(
+    const int index, const int64_t start_pos, const int64_t total_file_size,
+    std::shared_ptr<const SplitIndex> const& split_index) {
+  int64_t& offset = partial_read_offset_[index];
+  if (record_size_ > 0) {
+    int64_t records = (total_file_size - start_pos) / record_size_;
+    offset = start_pos + records * index / total_parts_ * record_size_;
+    return Status::OK();
+  }
+
+  // the position is aligned up to the granularity, a power of two that is
+  // no larger than the parts, thus the boundaries are the same whether the
+  // split index is used or not
+  int64_t part_size = (total_file_size - start_pos) / total_parts_;
+  int64_t max_granularity =
+      std::min(part_size, SplitIndex::kDefaultGranularity);
+  int64_t granularity = 1;
+  while (granularity * 2 <= max_granularity) {
+    granularity *= 2;
+  }
+  int64_t position = start_pos + index * part_size;
+  position = (position + granularity - 1) / granularity * granularity;
+  if (position >= total_file_size) {
+    offset = total_file_size;
+  } else if (split_index != nullptr &&
+             granularity % split_index->granularity() == 0) {
+    offset = split_index->LineStartAt(position);
+  } else {
+    RETURN_ON_ERROR(SplitIndex::ProbeLineStart(location_, position, offset));
+  }
+  offset = std::min(offset, total_file_size);
+  return Status::OK();
+}
+
 Status LocalIOAdaptor::ReadTable(std::shared_ptr<arrow::Table>* table) {
-  RETURN_ON_ERROR(ReadPartialTable(table, index_));
+  if (sub_parts_ == 1) {
+    RETURN_ON_ERROR(ReadPartialTable(table, index_));
+    return Status::OK();
+  }
+  std::vector<std::shared_ptr<arrow::Table>> tables;
+  for (int sub_index = 0; sub_index < sub_parts_; ++sub_index) {
+    std::shared_ptr<arrow::Table> sub_table;
+    RETURN_ON_ERROR(ReadSubPartTable(&sub_table, sub_index));
+    if (sub_table != nullptr) {
+      tables.emplace_back(sub_table);
+    }
+  }
+  if (tables.empty()) {
+    *table = nullptr;
+  } else {
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(*table, arrow::ConcatenateTables(tables));
+  }
   return Status::OK();
 }
 
+Status LocalIOAdaptor::ReadSubPartTable(std::shared_ptr<arrow::Table>* table,
+                                        const int sub_index) {
+  if (sub_index < 0 || sub_index >= sub_parts_) {
+    return Status::Invalid("Invalid sub-part index: " +
+                           std::to_string(sub_index));
+  }
+  return ReadPartialTable(table, index_ + sub_index);
+}
+
 Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
                                         int index) {
-  std::unique_ptr<arrow::fs::LocalFileSystem> arrow_lfs(
-      new arrow::fs::LocalFileSystem());
-  std::shared_ptr<arrow::io::RandomAccessFile> file_in;
-  RETURN_ON_ARROW_ERROR_AND_ASSIGN(file_in,
-                                   arrow_lfs->OpenInputFile(location_));
-
-  int64_t offset = partial_read_offset_[index];
-  int64_t nbytes =
-      partial_read_offset_[index + 1] - partial_read_offset_[index];
-  std::shared_ptr<arrow::io::InputStream> input =
-      arrow::io::RandomAccessFile::GetStream(file_in, offset, nbytes);
+  std::shared_ptr<arrow::io::InputStream> input;
+  if (decompressed_ != nullptr) {
+    // the decompressed part is parsed as a whole, and the sub-parts are
+    // decompressed separately
+    std::unique_ptr<DecompressedReader> sub_part_reader;
+    DecompressedReader* reader = decompressed_.get();
+    if (sub_parts_ > 1) {
+      RETURN_ON_ERROR(
+          openDecompressedPart(index, total_parts_, sub_part_reader));
+      reader = sub_part_reader.get();
+    }
+    arrow::BufferBuilder builder;
+    std::string buffer;
+    while (true) {
+      auto status = reader->ReadPart(buffer);
+      if (status.IsEndOfFile()) {
+        break;
+      }
+      RETURN_ON_ERROR(status);
+      RETURN_ON_ARROW_ERROR(builder.Append(buffer.data(), buffer.size()));
+    }
+    std::shared_ptr<arrow::Buffer> buf;
+    RETURN_ON_ARROW_ERROR(builder.Finish(&buf));
+    auto file = std::make_shared<arrow::io::BufferReader>(buf);
+    input = arrow::io::RandomAccessFile::GetStream(file, 0, buf->size());
+  } else {
+    std::unique_ptr<arrow::fs::LocalFileSystem> arrow_lfs(
+        new arrow::fs::LocalFileSystem());
+    std::shared_ptr<arrow::io::RandomAccessFile> file_in;
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(file_in,
+                                     arrow_lfs->OpenInputFile(location_));
+
+    int64_t offset = partial_read_offset_[index];
+    int64_t nbytes =
+        partial_read_offset_[index + 1] - partial_read_offset_[index];
+    input = arrow::io::RandomAccessFile::GetStream(file_in, offset, nbytes);
+  }
 
   arrow::MemoryPool* pool = arrow::default_memory_pool();
 
@@ -312,27 +635,40 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
   return Status::OK();
 }
 
-int64_t LocalIOAdaptor::getDistanceToLineBreak(const int index) {
-  VINEYARD_CHECK_OK(seek(partial_read_offset_[index], kFileLocationBegin));
-  int64_t dis = 0;
-  while (true) {
-    char buffer[1];
-    // std::memset(buff, 0, sizeof(buffer));
-    auto status = Read(buffer, 1);
-    if (!status.ok() || buffer[0] == '\n') {
-      break;
-    } else {
-      dis++;
-    }
+Status LocalIOAdaptor::ReadLine(arrow::util::string_view& line) {
+  if (!mapped_) {
+    return Status::Invalid("Reading lines as views requires the mmap mode");
+  }
+  int64_t end = mapped_size_;
+  if (enable_partial_read_) {
+    end = std::min(end, partial_read_offset_[index_ + 1]);
   }
-  return dis;
+  if (mapped_pos_ >= end) {
+    return Status::EndOfFile();
+  }
+  const char* begin = mapped_data_ + mapped_pos_;
+  const void* found = memchr(begin, '\n', mapped_size_ - mapped_pos_);
+  int64_t length = found == nullptr
+                       ? mapped_size_ - mapped_pos_
+                       : static_cast<const char*>(found) - begin + 1;
+  line = arrow::util::string_view(begin, length);
+  mapped_pos_ += length;
+  return Status::OK();
 }
 
 Status LocalIOAdaptor::ReadLine(std::string& line) {
+  if (decompressed_ != nullptr) {
+    return decompressed_->ReadLine(line, true);
+  }
   if (enable_partial_read_ && tell() >= partial_read_offset_[index_ + 1]) {
     return Status::EndOfFile();
   }
-  if (using_std_getline_) {
+  if (mapped_) {
+    arrow::util::string_view view;
+    RETURN_ON_ERROR(ReadLine(view));
+    line.assign(view.data(), view.size());
+    return Status::OK();
+  } else if (using_std_getline_) {
     getline(fs_, line);
     if (line.empty()) {
       return Status::EndOfFile();
@@ -373,7 +709,9 @@ int64_t LocalIOAdaptor::GetFullSize() {
 }
 
 int64_t LocalIOAdaptor::tell() {
-  if (using_std_getline_) {
+  if (mapped_) {
+    return mapped_pos_;
+  } else if (using_std_getline_) {
     return fs_.tellg();
   } else {
     return ftell(file_);
@@ -382,7 +720,22 @@ int64_t LocalIOAdaptor::tell() {
 
 Status LocalIOAdaptor::seek(const int64_t offset,
                             const FileLocation seek_from) {
-  if (using_std_getline_) {
+  if (decompressed_ != nullptr) {
+    return Status::NotImplemented("Seeking in compressed files: " +
+                                  location_);
+  }
+  if (mapped_) {
+    int64_t base = 0;
+    if (seek_from == kFileLocationCurrent) {
+      base = mapped_pos_;
+    } else if (seek_from == kFileLocationEnd) {
+      base = mapped_size_;
+    } else if (seek_from != kFileLocationBegin) {
+      return Status::Invalid();
+    }
+    mapped_pos_ = std::max(static_cast<int64_t>(0),
+                           std::min(base + offset, mapped_size_));
+  } else if (using_std_getline_) {
     fs_.clear();
     if (seek_from == kFileLocationBegin) {
       fs_.seekg(offset, fs_.beg);
@@ -408,7 +761,19 @@ Status LocalIOAdaptor::seek(const int64_t offset,
 }
 
 Status LocalIOAdaptor::Read(void* buffer, size_t size) {
-  if (using_std_getline_) {
+  if (decompressed_ != nullptr) {
+    size_t read_size = 0;
+    return decompressed_->Read(buffer, size, read_size);
+  }
+  if (mapped_) {
+    if (mapped_pos_ >= mapped_size_) {
+      return Status::EndOfFile();
+    }
+    size_t nbytes =
+        std::min(size, static_cast<size_t>(mapped_size_ - mapped_pos_));
+    memcpy(buffer, mapped_data_ + mapped_pos_, nbytes);
+    mapped_pos_ += nbytes;
+  } else if (using_std_getline_) {
     fs_.read(static_cast<char*>(buffer), size);
     if (!fs_) {
       return Status::EndOfFile();
@@ -448,7 +813,12 @@ Status LocalIOAdaptor::Write(void* buffer, size_t size) {
 }
 
 Status LocalIOAdaptor::Close() {
-  if (using_std_getline_) {
+  if (decompressed_ != nullptr) {
+    decompressed_->Stop();
+    decompressed_.reset();
+  } else if (mapped_) {
+    closeMapped();
+  } else if (using_std_getline_) {
     if (fs_.is_open()) {
       fs_.close();
     }
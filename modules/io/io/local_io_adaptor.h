@@ -23,10 +23,13 @@ limitations under the License.
 #include <vector>
 
 #include "arrow/api.h"
+#include "arrow/util/string_view.h"
 
 #include "common/util/functions.h"
 #include "common/util/status.h"
+#include "io/io/decompressed_reader.h"
 #include "io/io/i_io_adaptor.h"
+#include "io/io/split_index.h"
 
 namespace vineyard {
 // FIXME: do not use fixed value, expend to double space when read to a
@@ -56,6 +59,16 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   Status ReadLine(std::string& line) override;
 
+  /** Read a line (including the trailing '\n', if any) as a view of the
+   * mapped file, without copying, only available in the mmap mode. The view
+   * is valid until the file is closed.
+   *
+   * The mmap mode is enabled by `Configure("using_mmap", "true")` before
+   * `Open()`, where the file is mapped for reading, and the lines are found
+   * by scanning the mapped range with `memchr`.
+   * */
+  Status ReadLine(arrow::util::string_view& line);
+
   /** Read the part of file given index and total_parts.
    * first cut the file into several parts with given
    * <total_part>, looking backwards for the nearest
@@ -70,6 +83,43 @@ class LocalIOAdaptor : public IIOAdaptor {
    * */
   Status SetPartialRead(const int index, const int total_parts) override;
 
+  /** Read the part of file like `SetPartialRead(index, total_parts)`, but
+   * cut the part again into <sub_parts> sub-parts, which can be read by
+   * multiple threads concurrently with `ReadSubPartTable`.
+   *
+   * Every reader of the file must use the same <sub_parts>, otherwise the
+   * parts of readers may overlap.
+   *
+   * @param index the index in a part of file
+   * @param total_parts total number of parts in file
+   * @param sub_parts the number of sub-parts of each part
+   * */
+  Status SetPartialRead(const int index, const int total_parts,
+                        const int sub_parts);
+
+  /**
+   * Configure the adaptor before `Open()`:
+   *
+   *  - "using_std_getline", "using_mmap": how the lines are read.
+   *  - "compression": "auto" (by default, detects the codec by the extension
+   *    of the file, i.e., ".gz", ".zst" or ".zstd"), "none", "gzip" or
+   *    "zstd". The compressed files are decompressed transparently when
+   *    reading, see also `DecompressedReader`, which can also be set by the
+   *    "compression" in the location.
+   *  - "decompress_concurrency": the number of decompressing threads.
+   *  - "split_index": "auto" (by default), "build" or "none". The boundaries
+   *    of partial reads, and the header, are looked up in the split index
+   *    (see `SplitIndex`) from the sidecar file ("split_index_path", or
+   *    `<file>.idx` by default) if it's up to date, otherwise only the
+   *    boundaries of this part are located, by probing the file. With
+   *    "build", the index is built once (per process) and saved if it's
+   *    missing.
+   *  - "record_size": the bytes of each record of fixed-size record formats,
+   *    where the boundaries are computed without touching the file.
+   *
+   * The split index, "record_size", and the header row, can also be set in
+   * the location.
+   */
   Status Configure(const std::string& key, const std::string& value) override;
 
   Status WriteLine(const std::string& line) override;
@@ -91,12 +141,26 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   inline const std::string& location() const { return location_; }
 
+  /** Whether the file is read through the decompression, where the partial
+   * read isn't a byte range of the file, i.e., `GetPartialReadDetail` is
+   * unavailable.
+   * */
+  bool compressed() const;
+
   Status GetPartialReadDetail(int64_t& offset, int64_t& nbytes);
 
   Status ReadTable(std::shared_ptr<arrow::Table>* table) override;
 
   Status ReadPartialTable(std::shared_ptr<arrow::Table>* table, int index);
 
+  /** Read the <sub_index>-th sub-part of the part, which is thread-safe after
+   * `Open()`. The table is nullptr if the sub-part is empty.
+   * */
+  Status ReadSubPartTable(std::shared_ptr<arrow::Table>* table,
+                          const int sub_index);
+
+  inline int sub_parts() const { return sub_parts_; }
+
   Status Seek(const int64_t offset);
 
   int64_t GetFullSize();
@@ -109,7 +173,19 @@ class LocalIOAdaptor : public IIOAdaptor {
   int64_t tell();
   Status seek(const int64_t offset, const FileLocation seek_from);
   Status setPartialReadImpl();
-  int64_t getDistanceToLineBreak(const int index);
+  Status readHeaderRow(std::shared_ptr<const SplitIndex> const& index,
+                       int64_t& header_end);
+  Status locatePartialReadOffset(
+      const int index, const int64_t start_pos, const int64_t total_file_size,
+      std::shared_ptr<const SplitIndex> const& split_index);
+  bool isOpen() const;
+  Status openMapped();
+  void closeMapped();
+  std::string codec() const;
+  Status openDecompressed();
+  Status openDecompressedPart(const int index, const int total_parts,
+                              std::unique_ptr<DecompressedReader>& reader,
+                              const bool skip_header = true);
 
   FILE* file_;
   std::fstream fs_;
@@ -117,6 +193,19 @@ class LocalIOAdaptor : public IIOAdaptor {
   bool using_std_getline_;
   char buff[LINESIZE];
 
+  // the mmap mode for reading, see also `ReadLine(string_view&)`
+  bool using_mmap_;
+  bool mapped_;
+  int fd_;
+  const char* mapped_data_;
+  int64_t mapped_size_;
+  int64_t mapped_pos_;
+
+  // the decompression of compressed files
+  std::string compression_ = "auto";
+  size_t decompress_concurrency_ = 4;
+  std::unique_ptr<DecompressedReader> decompressed_;
+
   // for arrow
   std::vector<std::string> columns_;
   char delimiter_ = ',';
@@ -127,8 +216,13 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   bool enable_partial_read_;
   std::vector<int64_t> partial_read_offset_;
+  std::string split_index_ = "auto";
+  std::string split_index_path_;
+  int64_t record_size_ = 0;
   int total_parts_;
   int index_;
+  // the part is [index_, index_ + sub_parts_) of the total_parts_ parts
+  int sub_parts_;
   std::unordered_multimap<std::string, std::string> meta_;
 };
 }  // namespace vineyard
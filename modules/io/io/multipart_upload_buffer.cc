@@ -0,0 +1,230 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/multipart_upload_buffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+namespace {
+
+// the limit of part numbers of OSS and S3
+constexpr int kMaxPartNumber = 10000;
+
+constexpr int kRetryDelayMs = 300;
+
+}  // namespace
+
+MultipartUploadBuffer::MultipartUploadBuffer(
+    std::shared_ptr<IPartUploader> uploader, size_t part_size,
+    size_t concurrency, size_t buffer_num, int retries)
+    : uploader_(uploader),
+      part_size_(std::max(part_size, static_cast<size_t>(1))),
+      concurrency_(std::max(concurrency, static_cast<size_t>(1))),
+      buffer_num_(buffer_num == 0 ? 2 * concurrency_ : buffer_num),
+      retries_(std::max(retries, 0)) {
+  buffer_num_ = std::max(buffer_num_, concurrency_);
+}
+
+MultipartUploadBuffer::~MultipartUploadBuffer() {
+  if (started_ && !finished_) {
+    LOG(WARNING) << "The multipart upload " << upload_id_
+                 << " is not finished, abort it";
+    Abort();
+  }
+}
+
+Status MultipartUploadBuffer::Start() {
+  if (started_) {
+    return Status::Invalid("The multipart upload has already been started");
+  }
+  RETURN_ON_ERROR(uploader_->Initiate(upload_id_));
+  started_ = true;
+  VLOG(2) << "Start multipart upload " << upload_id_
+          << ", part size: " << part_size_ << ", concurrency: " << concurrency_
+          << ", buffers: " << buffer_num_;
+  current_.reserve(part_size_);
+  for (size_t i = 0; i < concurrency_; ++i) {
+    uploaders_.emplace_back(&MultipartUploadBuffer::uploadRoutine, this);
+  }
+  return Status::OK();
+}
+
+Status MultipartUploadBuffer::Write(const void* data, size_t size) {
+  if (!started_ || finished_) {
+    return Status::Invalid("The multipart upload is not in progress");
+  }
+  auto bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    size_t nbytes = std::min(size, part_size_ - current_.size());
+    current_.append(bytes, nbytes);
+    bytes += nbytes;
+    size -= nbytes;
+    if (current_.size() == part_size_) {
+      RETURN_ON_ERROR(flush());
+    }
+  }
+  return Status::OK();
+}
+
+Status MultipartUploadBuffer::Finish() {
+  if (!started_ || finished_) {
+    return Status::Invalid("The multipart upload is not in progress");
+  }
+  // an empty object still needs one (empty) part
+  Status status = Status::OK();
+  if (!current_.empty() || next_part_number_ == 1) {
+    status = flush();
+  }
+  stopUploaders();
+  finished_ = true;
+  if (status.ok()) {
+    status = error_;
+  }
+  if (!status.ok()) {
+    VINEYARD_SUPPRESS(uploader_->Abort(upload_id_));
+    return status;
+  }
+  std::sort(etags_.begin(), etags_.end());
+  status = uploader_->Complete(upload_id_, etags_);
+  if (!status.ok()) {
+    VINEYARD_SUPPRESS(uploader_->Abort(upload_id_));
+  }
+  return status;
+}
+
+void MultipartUploadBuffer::Abort() {
+  if (!started_ || finished_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_.ok()) {
+      error_ = Status::Invalid("The multipart upload has been aborted");
+    }
+  }
+  stopUploaders();
+  finished_ = true;
+  VINEYARD_SUPPRESS(uploader_->Abort(upload_id_));
+}
+
+void MultipartUploadBuffer::uploadRoutine() {
+  while (true) {
+    std::pair<int, std::string> part;
+    bool skip = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      pending_cv_.wait(
+          lock, [this]() { return stopped_ || !pending_parts_.empty(); });
+      if (pending_parts_.empty()) {
+        return;
+      }
+      part = std::move(pending_parts_.front());
+      pending_parts_.pop_front();
+      // don't bother uploading the rest parts of a failed upload
+      skip = !error_.ok();
+    }
+
+    std::string etag;
+    auto status =
+        skip ? Status::OK() : uploadWithRetry(part.first, part.second, etag);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!status.ok()) {
+        if (error_.ok()) {
+          error_ = status;
+        }
+      } else if (!skip) {
+        etags_.emplace_back(part.first, std::move(etag));
+      }
+      --outstanding_;
+      part.second.clear();
+      free_buffers_.emplace_back(std::move(part.second));
+    }
+    released_cv_.notify_all();
+  }
+}
+
+Status MultipartUploadBuffer::uploadWithRetry(const int part_number,
+                                              const std::string& content,
+                                              std::string& etag) {
+  Status status;
+  for (int attempt = 0; attempt <= retries_; ++attempt) {
+    if (attempt > 0) {
+      LOG(WARNING) << "Retry uploading part " << part_number << " of "
+                   << upload_id_ << " (" << attempt << "/" << retries_
+                   << "): " << status.ToString();
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds((1 << (attempt - 1)) * kRetryDelayMs));
+    }
+    status = uploader_->UploadPart(upload_id_, part_number, content, etag);
+    if (status.ok()) {
+      return status;
+    }
+  }
+  LOG(ERROR) << "Failed to upload part " << part_number << " of "
+             << upload_id_ << ": " << status.ToString();
+  return status;
+}
+
+Status MultipartUploadBuffer::flush() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // backpressure: wait until a staging buffer is released by the uploaders
+    released_cv_.wait(
+        lock, [this]() { return !error_.ok() || outstanding_ < buffer_num_; });
+    RETURN_ON_ERROR(error_);
+    if (next_part_number_ > kMaxPartNumber) {
+      return Status::Invalid(
+          "Too many parts in the multipart upload, use a larger part size");
+    }
+    pending_parts_.emplace_back(next_part_number_++, std::move(current_));
+    ++outstanding_;
+    if (!free_buffers_.empty()) {
+      current_ = std::move(free_buffers_.back());
+      free_buffers_.pop_back();
+    } else {
+      current_ = std::string();
+      current_.reserve(part_size_);
+    }
+  }
+  pending_cv_.notify_one();
+  return Status::OK();
+}
+
+void MultipartUploadBuffer::stopUploaders() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  pending_cv_.notify_all();
+  for (auto& thrd : uploaders_) {
+    if (thrd.joinable()) {
+      thrd.join();
+    }
+  }
+  uploaders_.clear();
+  free_buffers_.clear();
+}
+
+}  // namespace vineyard
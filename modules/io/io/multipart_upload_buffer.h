@@ -0,0 +1,128 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_MULTIPART_UPLOAD_BUFFER_H_
+#define MODULES_IO_IO_MULTIPART_UPLOAD_BUFFER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief The backend of `MultipartUploadBuffer`, which drives the multipart
+ * upload of a single object, e.g., to OSS or to other S3-compatible stores.
+ *
+ * `UploadPart` is invoked concurrently from the uploading threads, the part
+ * numbers start from 1.
+ */
+class IPartUploader {
+ public:
+  virtual ~IPartUploader() {}
+
+  virtual Status Initiate(std::string& upload_id) = 0;
+
+  virtual Status UploadPart(const std::string& upload_id,
+                            const int part_number, const std::string& content,
+                            std::string& etag) = 0;
+
+  virtual Status Complete(
+      const std::string& upload_id,
+      const std::vector<std::pair<int, std::string>>& parts) = 0;
+
+  virtual Status Abort(const std::string& upload_id) = 0;
+};
+
+/**
+ * @brief MultipartUploadBuffer cuts the written bytes into parts of
+ * `part_size` bytes and uploads them with `concurrency` threads. The parts
+ * are staged in a pool of at most `buffer_num` buffers, the writer blocks
+ * when all of them are in use, so the memory is bounded no matter how large
+ * the object is.
+ *
+ * A failed part is retried `retries` times with exponential backoff, if it
+ * still fails the upload is aborted and the error is returned by the
+ * following `Write` or `Finish`.
+ */
+class MultipartUploadBuffer {
+ public:
+  MultipartUploadBuffer(std::shared_ptr<IPartUploader> uploader,
+                        size_t part_size, size_t concurrency,
+                        size_t buffer_num = 0, int retries = 3);
+
+  ~MultipartUploadBuffer();
+
+  Status Start();
+
+  Status Write(const void* data, size_t size);
+
+  /**
+   * @brief Upload the rest bytes, wait for all parts and complete the upload.
+   */
+  Status Finish();
+
+  /**
+   * @brief Discard the unfinished parts and abort the upload.
+   */
+  void Abort();
+
+ private:
+  void uploadRoutine();
+
+  Status uploadWithRetry(const int part_number, const std::string& content,
+                         std::string& etag);
+
+  Status flush();
+
+  void stopUploaders();
+
+  std::shared_ptr<IPartUploader> uploader_;
+  size_t part_size_;
+  size_t concurrency_;
+  size_t buffer_num_;
+  int retries_;
+
+  std::string upload_id_;
+  bool started_ = false;
+  bool finished_ = false;
+
+  std::vector<std::thread> uploaders_;
+  std::mutex mutex_;
+  std::condition_variable pending_cv_;
+  std::condition_variable released_cv_;
+  // the parts waiting for upload, and the buffers that can be reused
+  std::deque<std::pair<int, std::string>> pending_parts_;
+  std::vector<std::string> free_buffers_;
+  // the number of parts that are waiting or being uploaded
+  size_t outstanding_ = 0;
+  int next_part_number_ = 1;
+  std::vector<std::pair<int, std::string>> etags_;
+  bool stopped_ = false;
+  Status error_;
+
+  std::string current_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_MULTIPART_UPLOAD_BUFFER_H_
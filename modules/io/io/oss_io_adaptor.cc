@@ -23,6 +23,7 @@ limitations under the License.
 #include <fstream>
 #include <memory>
 #include <random>
+#include <sstream>
 #include <thread>
 
 #include "alibabacloud/oss/OssClient.h"
@@ -37,28 +38,48 @@ limitations under the License.
 
 #include "basic/ds/arrow_utils.h"
 #include "common/util/functions.h"
+#include "io/io/io_factory.h"
 
 DEFINE_string(oss_endpoint, "", "OSS endpoint");
 DEFINE_string(oss_access_key_id, "", "OSS Access Key ID");
 DEFINE_string(oss_access_key_secret, "", "OSS Access Key Secret");
 DEFINE_string(oss_suffix, "", "OSS file filtering suffix");
 DEFINE_int32(oss_concurrency, 4, "concurrency of oss client");
+DEFINE_int64(oss_part_size, 8 * 1024 * 1024,
+             "size in bytes of each ranged GET request and each uploaded part "
+             "of oss client");
 DEFINE_int32(oss_retries, 5, "oss upload/download retry times");
 
+using AlibabaCloud::OSS::AbortMultipartUploadRequest;
 using AlibabaCloud::OSS::ClientConfiguration;
+using AlibabaCloud::OSS::CompleteMultipartUploadRequest;
 using AlibabaCloud::OSS::Error;
 using AlibabaCloud::OSS::ERROR_CURL_BASE;
 using AlibabaCloud::OSS::GetObjectRequest;
 using AlibabaCloud::OSS::InitializeSdk;
+using AlibabaCloud::OSS::InitiateMultipartUploadRequest;
 using AlibabaCloud::OSS::ListObjectOutcome;
 using AlibabaCloud::OSS::ListObjectsRequest;
 using AlibabaCloud::OSS::OssClient;
-using AlibabaCloud::OSS::PutObjectRequest;
+using AlibabaCloud::OSS::Part;
+using AlibabaCloud::OSS::PartList;
 using AlibabaCloud::OSS::RetryStrategy;
 using AlibabaCloud::OSS::ShutdownSdk;
+using AlibabaCloud::OSS::UploadPartRequest;
 
 namespace vineyard {
 
+// except the last one, the parts of a multipart upload can't be smaller
+static constexpr size_t kMinUploadPartSize = 100 * 1024;
+
+template <typename Outcome>
+static Status ossError(const std::string& action, const Outcome& outcome) {
+  LOG(ERROR) << action << " fail, code: " << outcome.error().Code()
+             << ", message: " << outcome.error().Message()
+             << ", requestId: " << outcome.error().RequestId();
+  return Status::IOError(outcome.error().Message());
+}
+
 class UserRetryStrategy : public RetryStrategy {
  public:
   /* maxRetries表示最大重试次数，scaleFactor为重试等待时间的尺度因子。*/
@@ -117,6 +138,103 @@ long UserRetryStrategy::calcDelayTimeMs(  // NOLINT(runtime/int)
   return (1 << attemptedRetries) * m_scaleFactor;
 }
 
+/**
+ * Fetches the byte ranges of objects in the bucket by ranged GET requests,
+ * the client is shared by all fetching threads of the read-ahead buffer.
+ */
+class OSSRangeFetcher : public IRangeFetcher {
+ public:
+  OSSRangeFetcher(const std::shared_ptr<OssClient>& client,
+                  const std::string& bucket_name)
+      : client_(client), bucket_name_(bucket_name) {}
+
+  Status Fetch(const std::string& object, size_t offset, size_t length,
+               std::string& content) override {
+    GetObjectRequest request(bucket_name_, object);
+    request.setRange(offset, offset + length - 1);
+    auto outcome = client_->GetObject(request);
+    if (!outcome.isSuccess()) {
+      return ossError("Get object range", outcome);
+    }
+    content.resize(length);
+    auto stream = outcome.result().Content();
+    stream->read(&content[0], length);
+    content.resize(stream->gcount());
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<OssClient> client_;
+  std::string bucket_name_;
+};
+
+/**
+ * Uploads an object in the bucket by multipart upload, the client is shared
+ * by all uploading threads of the upload buffer.
+ */
+class OSSPartUploader : public IPartUploader {
+ public:
+  OSSPartUploader(const std::shared_ptr<OssClient>& client,
+                  const std::string& bucket_name, const std::string& key)
+      : client_(client), bucket_name_(bucket_name), key_(key) {}
+
+  Status Initiate(std::string& upload_id) override {
+    InitiateMultipartUploadRequest request(bucket_name_, key_);
+    auto outcome = client_->InitiateMultipartUpload(request);
+    if (!outcome.isSuccess()) {
+      return ossError("Initiate multipart upload", outcome);
+    }
+    upload_id = outcome.result().UploadId();
+    return Status::OK();
+  }
+
+  Status UploadPart(const std::string& upload_id, const int part_number,
+                    const std::string& content, std::string& etag) override {
+    auto stream = std::make_shared<std::stringstream>();
+    stream->write(content.data(), content.size());
+    UploadPartRequest request(bucket_name_, key_, part_number, upload_id,
+                              stream);
+    request.setContentLength(content.size());
+    auto outcome = client_->UploadPart(request);
+    if (!outcome.isSuccess()) {
+      return ossError("Upload part", outcome);
+    }
+    etag = outcome.result().ETag();
+    return Status::OK();
+  }
+
+  Status Complete(
+      const std::string& upload_id,
+      const std::vector<std::pair<int, std::string>>& parts) override {
+    PartList part_list;
+    for (auto const& part : parts) {
+      part_list.emplace_back(Part(part.first, part.second));
+    }
+    CompleteMultipartUploadRequest request(bucket_name_, key_);
+    request.setUploadId(upload_id);
+    request.setPartList(part_list);
+    auto outcome = client_->CompleteMultipartUpload(request);
+    if (!outcome.isSuccess()) {
+      return ossError("Complete multipart upload", outcome);
+    }
+    return Status::OK();
+  }
+
+  Status Abort(const std::string& upload_id) override {
+    AbortMultipartUploadRequest request(bucket_name_, key_, upload_id);
+    auto outcome = client_->AbortMultipartUpload(request);
+    if (!outcome.isSuccess()) {
+      return ossError("Abort multipart upload", outcome);
+    }
+    return Status::OK();
+  }
+
+ private:
+  std::shared_ptr<OssClient> client_;
+  std::string bucket_name_;
+  std::string key_;
+};
+
 OSSIOAdaptor::OSSIOAdaptor(const std::string& location) : location_(location) {
   parseOssCredentials(OSS_CREDENTIALS_PATH);
   parseOssEnvironmentVariables();
@@ -125,12 +243,9 @@ OSSIOAdaptor::OSSIOAdaptor(const std::string& location) : location_(location) {
   // There are two kinds of objects. one end with .meta, one end with .tsv,
   // We only want .tsv file
   suffix_ = FLAGS_oss_suffix;
-  current_object_ = 0;
 
-  producer_num_ = FLAGS_oss_concurrency;
-
-  exited_producers_ = 0;
-  buffer_next_ = 0;
+  concurrency_ = std::max(FLAGS_oss_concurrency, 1);
+  part_size_ = std::max(FLAGS_oss_part_size, static_cast<int64_t>(1));
 
   // default connections is 16. Use high value if specified.
   conf_.maxConnections = std::max(FLAGS_oss_concurrency, 16);
@@ -152,16 +267,11 @@ OSSIOAdaptor::OSSIOAdaptor(const std::string& location) : location_(location) {
   VLOG(2) << "bucket_name: " << bucket_name_;
   VLOG(2) << "prefix: " << prefix_;
   VLOG(2) << "suffix: " << suffix_;
-  VLOG(2) << "concurrency: " << producer_num_;
+  VLOG(2) << "concurrency: " << concurrency_;
+  VLOG(2) << "part_size: " << part_size_;
 }
 
-OSSIOAdaptor::~OSSIOAdaptor() {
-  for (auto& thrd : producers_) {
-    if (thrd.joinable()) {
-      thrd.join();
-    }
-  }
-}
+OSSIOAdaptor::~OSSIOAdaptor() { VINEYARD_SUPPRESS(Close()); }
 
 void OSSIOAdaptor::parseOssCredentials(const std::string& file_name) {
   VLOG(2) << "[OSS]: loading credentials from " << file_name;
@@ -265,6 +375,19 @@ void OSSIOAdaptor::parseYamlLocation(const std::string& location) {
   }
 }
 
+std::shared_ptr<OssClient> OSSIOAdaptor::acquireClient() {
+  // the client (and its pool of connections) is shared by the adaptors of
+  // the same endpoint and credentials, thus the handshakes aren't repeated
+  // for every object
+  std::string key = oss_endpoint_ + "|" + access_id_ + "|" + access_key_ +
+                    "|" + std::to_string(conf_.maxConnections) + "|" +
+                    std::to_string(FLAGS_oss_retries);
+  return IOFactory::AcquireConnection<OssClient>(key, [this]() {
+    return std::make_shared<OssClient>(oss_endpoint_, access_id_, access_key_,
+                                       conf_);
+  });
+}
+
 void OSSIOAdaptor::Init() { InitializeSdk(); }
 
 void OSSIOAdaptor::Finalize() { ShutdownSdk(); }
@@ -273,10 +396,25 @@ void OSSIOAdaptor::Finalize() { ShutdownSdk(); }
 // else create download request.
 // I think in practice, we don't need to both read and write a table,
 // so I don't support the rw, to make the performance better.
+//
+// Note that objects can't be appended by multipart upload, the 'a' mode
+// overwrites the object as well.
 Status OSSIOAdaptor::Open(const char* mode) {
   if (strchr(mode, 'w') != NULL || strchr(mode, 'a') != NULL) {
     VLOG(2) << "Open OSS Adaptor, mode: " << mode;
-    return Status::OK();
+    if (upload_ != nullptr) {
+      return Status::Invalid("The OSS adaptor has already been opened");
+    }
+    upload_.reset(new MultipartUploadBuffer(
+        std::make_shared<OSSPartUploader>(acquireClient(), bucket_name_,
+                                          prefix_),
+        std::max(part_size_, kMinUploadPartSize), concurrency_, 0,
+        FLAGS_oss_retries));
+    auto status = upload_->Start();
+    if (!status.ok()) {
+      upload_.reset();
+    }
+    return status;
   } else {
     return Open();
   }
@@ -291,37 +429,99 @@ Status OSSIOAdaptor::Open() {
   if (partial_read_) {
     selectObjects();
   }
-  producer_num_ = std::min(producer_num_, objects_.size());
-  producers_.resize(producer_num_);
-  queue_.SetProducerNum(producer_num_);
-  for (size_t i = 0; i < producer_num_; ++i) {
-    producers_[i] = std::thread(&OSSIOAdaptor::producerRoutine, this);
+  auto fetcher =
+      std::make_shared<OSSRangeFetcher>(acquireClient(), bucket_name_);
+  bool compressed = compression_ != "none" && compression_ != "auto";
+  for (auto const& object : objects_) {
+    if (compression_ == "auto" &&
+        !DecompressedReader::DetectCodec(object.first).empty()) {
+      compressed = true;
+    }
   }
-  return Status::OK();
+  if (compressed) {
+    // the objects are fetched sequentially, thus the frames are only
+    // located by the seek table rather than by walking the headers
+    decompressed_.reset(new DecompressedReader(fetcher, compression_,
+                                               concurrency_, part_size_,
+                                               false));
+    return decompressed_->Start(objects_);
+  }
+  read_ahead_.reset(new ReadAheadBuffer(fetcher, part_size_, concurrency_));
+  return read_ahead_->Start(objects_);
 }
 
-Status OSSIOAdaptor::ReadLine(std::string& line) {
-  while (true) {
-    if (buffer_next_ >= current_buffer_.size()) {
-      if (exited_producers_ == producer_num_ && queue_.Size() == 0) {
-        return Status::EndOfFile();
-      }
-      queue_.Get(current_buffer_);
-      buffer_next_ = 0;
+Status OSSIOAdaptor::Configure(const std::string& key,
+                               const std::string& value) {
+  if (key == "compression") {
+    if (read_ahead_ != nullptr || decompressed_ != nullptr) {
+      return Status::Invalid("Configure " + key +
+                             " after open have no effect.");
+    }
+    if (value != "auto" && value != "none" && value != "gzip" &&
+        value != "zstd") {
+      return Status::Invalid("Unknown compression codec: " + value);
+    }
+    compression_ = value;
+  } else if (key == "concurrency" || key == "part_size") {
+    if (read_ahead_ != nullptr || decompressed_ != nullptr ||
+        upload_ != nullptr) {
+      return Status::Invalid("Configure " + key +
+                             " after open have no effect.");
+    }
+    size_t parsed = 0;
+    try {
+      parsed = std::stoull(value);
+    } catch (std::exception const& e) {
+      return Status::Invalid("Invalid value for " + key + ": " + value);
+    }
+    if (parsed == 0) {
+      return Status::Invalid(key + " must be positive");
+    }
+    if (key == "concurrency") {
+      concurrency_ = parsed;
+      conf_.maxConnections =
+          std::max(static_cast<int>(concurrency_), conf_.maxConnections);
     } else {
-      auto next = current_buffer_.find('\n', buffer_next_);
-      line = current_buffer_.substr(buffer_next_, next - buffer_next_);
-      buffer_next_ = next == std::string::npos ? next : next + 1;
-      return Status::OK();
+      part_size_ = parsed;
     }
   }
+  return Status::OK();
+}
+
+Status OSSIOAdaptor::ReadLine(std::string& line) {
+  if (decompressed_ != nullptr) {
+    return decompressed_->ReadLine(line);
+  }
+  if (read_ahead_ == nullptr) {
+    return Status::Invalid("The OSS adaptor hasn't been opened for read");
+  }
+  return read_ahead_->ReadLine(line);
+}
+
+Status OSSIOAdaptor::Read(void* buffer, size_t size) {
+  size_t read_size = 0;
+  if (decompressed_ != nullptr) {
+    return decompressed_->Read(buffer, size, read_size);
+  }
+  if (read_ahead_ == nullptr) {
+    return Status::Invalid("The OSS adaptor hasn't been opened for read");
+  }
+  return read_ahead_->Read(buffer, size, read_size);
 }
 
 Status OSSIOAdaptor::ReadTable(std::shared_ptr<arrow::Table>* table) {
+  if (read_ahead_ == nullptr && decompressed_ == nullptr) {
+    return Status::Invalid("The OSS adaptor hasn't been opened for read");
+  }
   arrow::BufferBuilder builder;
   std::string buffer;
-  while (!(exited_producers_ == producer_num_ && queue_.Size() == 0)) {
-    queue_.Get(buffer);
+  while (true) {
+    auto status = decompressed_ != nullptr ? decompressed_->ReadPart(buffer)
+                                           : read_ahead_->ReadPart(buffer);
+    if (status.IsEndOfFile()) {
+      break;
+    }
+    RETURN_ON_ERROR(status);
     RETURN_ON_ARROW_ERROR(builder.Append(buffer.c_str(), buffer.size()));
   }
   std::shared_ptr<arrow::Buffer> buf;
@@ -345,27 +545,26 @@ Status OSSIOAdaptor::ReadTable(std::shared_ptr<arrow::Table>* table) {
   return Status::OK();
 }
 
+Status OSSIOAdaptor::WriteLine(const std::string& line) {
+  if (upload_ == nullptr) {
+    return Status::Invalid("The OSS adaptor hasn't been opened for write");
+  }
+  RETURN_ON_ERROR(upload_->Write(line.data(), line.size()));
+  return upload_->Write("\n", 1);
+}
+
 Status OSSIOAdaptor::Write(void* buffer, size_t size) {
-  OssClient client(oss_endpoint_, access_id_, access_key_, conf_);
-  std::shared_ptr<std::iostream> content =
-      std::make_shared<std::stringstream>();
-  *content << static_cast<char*>(buffer);
-  PutObjectRequest request(bucket_name_, prefix_, content);
-  auto outcome = client.PutObject(request);
-  if (!outcome.isSuccess()) {
-    LOG(ERROR) << "Put object failed, code: " << outcome.error().Code()
-               << ", message: " << outcome.error().Message()
-               << ", requestId: " << outcome.error().RequestId();
-    return Status::IOError(outcome.error().Message());
+  if (upload_ == nullptr) {
+    return Status::Invalid("The OSS adaptor hasn't been opened for write");
   }
-  return Status::OK();
+  return upload_->Write(buffer, size);
 }
 
 void OSSIOAdaptor::selectObjects() {
   VLOG(2) << "Using partial read strategy: index = " << part_id_
           << " total = " << part_num_;
   size_t object_num = objects_.size();
-  std::vector<std::string> selected;
+  std::vector<std::pair<std::string, size_t>> selected;
   for (size_t i = 0; i < object_num; ++i) {
     if (i % part_num_ == part_id_) {
       selected.emplace_back(objects_[i]);
@@ -376,7 +575,7 @@ void OSSIOAdaptor::selectObjects() {
 
 Status OSSIOAdaptor::listAllObjects(const std::string& prefix,
                                     const std::string& suffix) {
-  OssClient client(oss_endpoint_, access_id_, access_key_, conf_);
+  auto client = acquireClient();
 
   std::string next_marker;
   bool IsTruncated = false;
@@ -384,7 +583,7 @@ Status OSSIOAdaptor::listAllObjects(const std::string& prefix,
     ListObjectsRequest request(bucket_name_);
     request.setPrefix(prefix);
     request.setMarker(next_marker);
-    auto outcome = client.ListObjects(request);
+    auto outcome = client->ListObjects(request);
     if (!outcome.isSuccess()) {
       LOG(ERROR) << "List object fail, code: " << outcome.error().Code()
                  << ", message: " << outcome.error().Message()
@@ -394,7 +593,7 @@ Status OSSIOAdaptor::listAllObjects(const std::string& prefix,
     for (const auto& object : outcome.result().ObjectSummarys()) {
       auto name = object.Key();
       if (suffix.empty() || boost::ends_with(name, suffix)) {
-        objects_.push_back(name);
+        objects_.emplace_back(name, static_cast<size_t>(object.Size()));
       }
     }
     next_marker = outcome.result().NextMarker();
@@ -408,56 +607,20 @@ Status OSSIOAdaptor::listAllObjects(const std::string& prefix,
   return Status::OK();
 }
 
-Status OSSIOAdaptor::producerRoutine() {
-  while (true) {
-    size_t index = __sync_fetch_and_add(&current_object_, 1);
-    if (index >= objects_.size()) {
-      break;
-    }
-    std::string content;
-    auto st = getObjectToBuffer(objects_[index], content);
-    if (!st.ok()) {
-      LOG(ERROR) << "IOException: OSS Exception: get object failed.";
-      return st;
-    }
-    queue_.Put(std::move(content));
+Status OSSIOAdaptor::Close() {
+  if (read_ahead_ != nullptr) {
+    read_ahead_->Stop();
+    read_ahead_.reset();
   }
-  ++exited_producers_;
-  queue_.DecProducerNum();
-  return Status::OK();
-}
-
-Status OSSIOAdaptor::getObjectToBuffer(const std::string& object_name,
-                                       std::string& content) {
-  OssClient client(oss_endpoint_, access_id_, access_key_, conf_);
-  GetObjectRequest request(bucket_name_, object_name);
-  auto outcome = client.GetObject(request);
-
-  if (outcome.isSuccess()) {
-    int content_length = outcome.result().Metadata().ContentLength();
-    VLOG(2) << "getObjectToBuffer success, Content-Length: " << content_length;
-    content.clear();
-    content.resize(content_length);
-    auto stream = outcome.result().Content();
-    for (int i = 0; i < content_length; ++i) {
-      stream->get(content[i]);
-    }
-  } else {
-    LOG(ERROR) << "getObjectToBuffer fail, code: " << outcome.error().Code()
-               << ", message: " << outcome.error().Message()
-               << ", requestId: " << outcome.error().RequestId();
-    return Status::IOError(outcome.error().Message());
+  if (decompressed_ != nullptr) {
+    decompressed_->Stop();
+    decompressed_.reset();
   }
-  return Status::OK();
-}
-
-Status OSSIOAdaptor::Close() {
-  for (auto& thrd : producers_) {
-    if (thrd.joinable()) {
-      thrd.join();
-    }
+  if (upload_ != nullptr) {
+    auto status = upload_->Finish();
+    upload_.reset();
+    return status;
   }
-  producers_.clear();
   return Status::OK();
 }
 
@@ -474,8 +637,7 @@ Status OSSIOAdaptor::SetPartialRead(int index, int total_parts) {
 }
 
 bool OSSIOAdaptor::IsExist(const std::string& path) {
-  OssClient client(oss_endpoint_, access_id_, access_key_, conf_);
-  return client.DoesObjectExist(bucket_name_, prefix_);
+  return acquireClient()->DoesObjectExist(bucket_name_, prefix_);
 }
 }  // namespace vineyard
 
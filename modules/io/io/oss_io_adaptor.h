@@ -18,25 +18,26 @@ limitations under the License.
 
 #ifdef OSS_ENABLED
 
-#include <atomic>
 #include <iostream>
 #include <memory>
 #include <string>
-#include <thread>
 #include <utility>
 #include <vector>
 
 #include "alibabacloud/oss/OssClient.h"
 #include "gflags/gflags.h"
 
-#include "common/util/blocking_queue.h"
+#include "io/io/decompressed_reader.h"
 #include "io/io/i_io_adaptor.h"
+#include "io/io/multipart_upload_buffer.h"
+#include "io/io/read_ahead_buffer.h"
 
 DECLARE_string(oss_endpoint);
 DECLARE_string(oss_access_key_id);
 DECLARE_string(oss_access_key_secret);
 DECLARE_string(oss_suffix);
 DECLARE_int32(oss_concurrency);
+DECLARE_int64(oss_part_size);
 DECLARE_int32(oss_retries);
 
 namespace vineyard {
@@ -54,19 +55,23 @@ class OSSIOAdaptor : public IIOAdaptor {
 
   Status SetPartialRead(int index, int total_parts) override;
 
-  Status Configure(const std::string& key, const std::string& value) override {
-    return Status::OK();
-  }
+  /**
+   * Configure the read-ahead of objects:
+   *
+   *  - "concurrency": the number of parallel ranged GET requests.
+   *  - "part_size": the size in bytes of each ranged GET request, and of
+   *    each part of the multipart upload.
+   *  - "compression": "auto" (by default, by the extension of objects),
+   *    "none", "gzip" or "zstd", the compressed objects are decompressed when
+   *    reading, see also `DecompressedReader`.
+   */
+  Status Configure(const std::string& key, const std::string& value) override;
 
   Status ReadLine(std::string& line) override;
 
-  Status WriteLine(const std::string& line) override {
-    return Status::NotImplemented();
-  }
+  Status WriteLine(const std::string& line) override;
 
-  Status Read(void* buffer, size_t size) override {
-    return Status::NotImplemented();
-  }
+  Status Read(void* buffer, size_t size) override;
 
   Status Write(void* buffer, size_t size) override;
 
@@ -92,9 +97,7 @@ class OSSIOAdaptor : public IIOAdaptor {
 
   void selectObjects();
 
-  Status producerRoutine();
-
-  Status getObjectToBuffer(const std::string& object_name, std::string& block);
+  std::shared_ptr<AlibabaCloud::OSS::OssClient> acquireClient();
 
   void parseOssCredentials(const std::string& file_name);
   void parseOssEnvironmentVariables();
@@ -108,9 +111,6 @@ class OSSIOAdaptor : public IIOAdaptor {
 
   AlibabaCloud::OSS::ClientConfiguration conf_;
 
-  std::string current_buffer_;
-  size_t buffer_next_;
-
   std::string location_;
 
   std::string oss_endpoint_;
@@ -123,17 +123,19 @@ class OSSIOAdaptor : public IIOAdaptor {
   std::string prefix_;
   std::string suffix_;
 
-  std::vector<std::string> objects_;
-  size_t current_object_;
+  // the name and size of objects
+  std::vector<std::pair<std::string, size_t>> objects_;
 
   bool opened_ = false;
   bool partial_read_ = false;
 
-  size_t producer_num_;
-  std::atomic<size_t> exited_producers_;
-  std::vector<std::thread> producers_;
-
-  PCBlockingQueue<std::string> queue_;
+  size_t concurrency_;
+  size_t part_size_;
+  std::unique_ptr<ReadAheadBuffer> read_ahead_;
+  // replaces the read-ahead buffer when there are compressed objects
+  std::string compression_ = "auto";
+  std::unique_ptr<DecompressedReader> decompressed_;
+  std::unique_ptr<MultipartUploadBuffer> upload_;
 
   size_t part_num_;
   size_t part_id_;
@@ -0,0 +1,221 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/read_ahead_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+ReadAheadBuffer::ReadAheadBuffer(std::shared_ptr<IRangeFetcher> fetcher,
+                                 size_t part_size, size_t concurrency,
+                                 size_t window)
+    : fetcher_(fetcher),
+      part_size_(std::max(part_size, static_cast<size_t>(1))),
+      concurrency_(std::max(concurrency, static_cast<size_t>(1))),
+      window_(window == 0 ? 2 * concurrency_ : window) {
+  window_ = std::max(window_, concurrency_);
+}
+
+ReadAheadBuffer::~ReadAheadBuffer() { Stop(); }
+
+Status ReadAheadBuffer::Start(
+    const std::vector<std::pair<std::string, size_t>>& objects) {
+  if (!fetchers_.empty()) {
+    return Status::Invalid("The read-ahead buffer has already been started");
+  }
+  objects_.clear();
+  ranges_.clear();
+  for (auto const& object : objects) {
+    size_t index = objects_.size();
+    objects_.emplace_back(object.first);
+    for (size_t offset = 0; offset < object.second; offset += part_size_) {
+      ranges_.emplace_back(
+          Range{index, offset, std::min(part_size_, object.second - offset)});
+    }
+  }
+  VLOG(2) << "Read ahead " << objects_.size() << " objects in "
+          << ranges_.size() << " parts, part size: " << part_size_
+          << ", concurrency: " << concurrency_ << ", window: " << window_;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    reorder_buffer_.clear();
+    next_fetch_ = 0;
+    next_consume_ = 0;
+    stopped_ = false;
+    error_ = Status::OK();
+  }
+  current_.clear();
+  current_pos_ = 0;
+
+  size_t fetcher_num = std::min(concurrency_, ranges_.size());
+  for (size_t i = 0; i < fetcher_num; ++i) {
+    fetchers_.emplace_back(&ReadAheadBuffer::fetchRoutine, this);
+  }
+  return Status::OK();
+}
+
+void ReadAheadBuffer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  consumed_cv_.notify_all();
+  fetched_cv_.notify_all();
+  for (auto& thrd : fetchers_) {
+    if (thrd.joinable()) {
+      thrd.join();
+    }
+  }
+  fetchers_.clear();
+  reorder_buffer_.clear();
+}
+
+Status ReadAheadBuffer::ReadLine(std::string& line) {
+  line.clear();
+  bool pending = false;
+  while (true) {
+    if (current_pos_ >= current_.size()) {
+      // the end of an object terminates the line
+      if (pending && nextPartStartsObject()) {
+        return Status::OK();
+      }
+      RETURN_ON_ERROR(nextPart());
+      continue;
+    }
+    const char* begin = current_.data() + current_pos_;
+    size_t remaining = current_.size() - current_pos_;
+    auto end = static_cast<const char*>(memchr(begin, '\n', remaining));
+    if (end != nullptr) {
+      line.append(begin, end - begin);
+      current_pos_ += end - begin + 1;
+      return Status::OK();
+    }
+    line.append(begin, remaining);
+    current_pos_ = current_.size();
+    pending = true;
+  }
+}
+
+Status ReadAheadBuffer::Read(void* buffer, size_t size, size_t& read_size) {
+  read_size = 0;
+  while (read_size < size) {
+    if (current_pos_ >= current_.size()) {
+      auto status = nextPart();
+      if (status.IsEndOfFile() && read_size > 0) {
+        break;
+      }
+      RETURN_ON_ERROR(status);
+      continue;
+    }
+    size_t nbytes =
+        std::min(size - read_size, current_.size() - current_pos_);
+    memcpy(static_cast<char*>(buffer) + read_size,
+           current_.data() + current_pos_, nbytes);
+    current_pos_ += nbytes;
+    read_size += nbytes;
+  }
+  return Status::OK();
+}
+
+Status ReadAheadBuffer::ReadPart(std::string& part) {
+  if (current_pos_ >= current_.size()) {
+    RETURN_ON_ERROR(nextPart());
+  }
+  if (current_pos_ == 0) {
+    part.swap(current_);
+  } else {
+    part = current_.substr(current_pos_);
+  }
+  current_.clear();
+  current_pos_ = 0;
+  return Status::OK();
+}
+
+void ReadAheadBuffer::fetchRoutine() {
+  while (true) {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // at most `window_` parts are in flight or buffered ahead of the reader
+      consumed_cv_.wait(lock, [this]() {
+        return stopped_ || !error_.ok() || next_fetch_ >= ranges_.size() ||
+               next_fetch_ < next_consume_ + window_;
+      });
+      if (stopped_ || !error_.ok() || next_fetch_ >= ranges_.size()) {
+        return;
+      }
+      index = next_fetch_++;
+    }
+
+    const Range& range = ranges_[index];
+    std::string content;
+    auto status = fetcher_->Fetch(objects_[range.object], range.offset,
+                                  range.length, content);
+    if (status.ok() && content.size() != range.length) {
+      status = Status::IOError(
+          "Incomplete range of " + objects_[range.object] + " at " +
+          std::to_string(range.offset) + ": expect " +
+          std::to_string(range.length) + " bytes, but got " +
+          std::to_string(content.size()));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to fetch the range of " << objects_[range.object]
+                   << " at " << range.offset << ": " << status.ToString();
+        if (error_.ok()) {
+          error_ = status;
+        }
+      } else {
+        reorder_buffer_.emplace(index, std::move(content));
+      }
+    }
+    fetched_cv_.notify_all();
+  }
+}
+
+Status ReadAheadBuffer::nextPart() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (next_consume_ >= ranges_.size()) {
+    return Status::EndOfFile();
+  }
+  fetched_cv_.wait(lock, [this]() {
+    return stopped_ || !error_.ok() ||
+           reorder_buffer_.find(next_consume_) != reorder_buffer_.end();
+  });
+  RETURN_ON_ERROR(error_);
+  if (stopped_) {
+    return Status::Invalid("The read-ahead buffer has been stopped");
+  }
+  auto iter = reorder_buffer_.find(next_consume_);
+  current_ = std::move(iter->second);
+  current_pos_ = 0;
+  reorder_buffer_.erase(iter);
+  ++next_consume_;
+  lock.unlock();
+  consumed_cv_.notify_all();
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,128 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_READ_AHEAD_BUFFER_H_
+#define MODULES_IO_IO_READ_AHEAD_BUFFER_H_
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief The backend of `ReadAheadBuffer`, which fetches a byte range of an
+ * object from the object store, e.g., by a ranged GET request to OSS or to
+ * other S3-compatible stores.
+ *
+ * `Fetch` is invoked concurrently from the fetching threads.
+ */
+class IRangeFetcher {
+ public:
+  virtual ~IRangeFetcher() {}
+
+  virtual Status Fetch(const std::string& object, size_t offset,
+                       size_t length, std::string& content) = 0;
+};
+
+/**
+ * @brief ReadAheadBuffer cuts the objects into parts of `part_size` bytes,
+ * and fetches them with `concurrency` threads ahead of the reader. The parts
+ * arrive out of order and are kept in a reorder buffer of at most `window`
+ * parts, the reader consumes them in the original order of objects and
+ * offsets.
+ *
+ * Lines never span two objects: the end of an object terminates the line.
+ */
+class ReadAheadBuffer {
+ public:
+  ReadAheadBuffer(std::shared_ptr<IRangeFetcher> fetcher, size_t part_size,
+                  size_t concurrency, size_t window = 0);
+
+  ~ReadAheadBuffer();
+
+  /**
+   * @brief Start fetching the objects, given as pairs of the object name
+   * and the object size.
+   */
+  Status Start(const std::vector<std::pair<std::string, size_t>>& objects);
+
+  /**
+   * @brief Stop the fetching threads, the buffered parts are discarded.
+   */
+  void Stop();
+
+  Status ReadLine(std::string& line);
+
+  /**
+   * @brief Read at most `size` bytes, `read_size` is the number of bytes
+   * that have been read. Returns EndOfFile if there's nothing left.
+   */
+  Status Read(void* buffer, size_t size, size_t& read_size);
+
+  /**
+   * @brief Take the rest of the current part, or the next part as a whole.
+   */
+  Status ReadPart(std::string& part);
+
+ private:
+  struct Range {
+    size_t object;
+    size_t offset;
+    size_t length;
+  };
+
+  void fetchRoutine();
+
+  Status nextPart();
+
+  bool nextPartStartsObject() const {
+    return next_consume_ >= ranges_.size() ||
+           ranges_[next_consume_].offset == 0;
+  }
+
+  std::shared_ptr<IRangeFetcher> fetcher_;
+  size_t part_size_;
+  size_t concurrency_;
+  size_t window_;
+
+  std::vector<std::string> objects_;
+  std::vector<Range> ranges_;
+
+  std::vector<std::thread> fetchers_;
+  std::mutex mutex_;
+  std::condition_variable fetched_cv_;
+  std::condition_variable consumed_cv_;
+  // the fetched parts that haven't been consumed, indexed by the range
+  std::map<size_t, std::string> reorder_buffer_;
+  size_t next_fetch_ = 0;
+  size_t next_consume_ = 0;
+  bool stopped_ = false;
+  Status error_;
+
+  std::string current_;
+  size_t current_pos_ = 0;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_READ_AHEAD_BUFFER_H_
@@ -0,0 +1,301 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/split_index.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+namespace {
+
+constexpr const char* kSplitIndexMagic = "vineyard-split-index 1";
+
+// the size of reads when looking for the line breaks
+constexpr size_t kLineBreakProbeSize = 64 * 1024;
+
+// the header isn't kept in the index if the first line is too long
+constexpr int64_t kMaxHeaderSize = 1024 * 1024;
+
+std::mutex cache_mutex;
+std::unordered_map<std::string, std::shared_ptr<const SplitIndex>> cache;
+
+Status ioError(const std::string& action, const std::string& path, int err) {
+  return Status::IOError("Failed to " + action + " " + path +
+                         " because: " + std::strerror(err));
+}
+
+Status statFile(const std::string& path, int64_t& size, int64_t& mtime) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    return ioError("stat", path, errno);
+  }
+  size = st.st_size;
+  mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+          st.st_mtim.tv_nsec;
+  return Status::OK();
+}
+
+Status probeLineStart(int fd, const std::string& path, const int64_t size,
+                      const int64_t position, int64_t& line_start) {
+  if (position <= 0) {
+    line_start = 0;
+    return Status::OK();
+  }
+  // the line starts at `position` if the previous byte is '\n'
+  int64_t offset = position - 1;
+  std::vector<char> probe(kLineBreakProbeSize);
+  while (offset < size) {
+    ssize_t nbytes = pread(fd, probe.data(), probe.size(), offset);
+    if (nbytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return ioError("read", path, errno);
+    }
+    if (nbytes == 0) {
+      break;
+    }
+    auto found = static_cast<const char*>(memchr(probe.data(), '\n', nbytes));
+    if (found != nullptr) {
+      line_start = std::min(offset + (found - probe.data()) + 1, size);
+      return Status::OK();
+    }
+    offset += nbytes;
+  }
+  line_start = size;
+  return Status::OK();
+}
+
+}  // namespace
+
+constexpr int64_t SplitIndex::kDefaultGranularity;
+
+Status SplitIndex::Get(const std::string& path, const std::string& index_path,
+                       const bool build,
+                       std::shared_ptr<const SplitIndex>& index) {
+  // the index is built once per file, the readers in the same process wait
+  // for it
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  index = nullptr;
+  auto iter = cache.find(path);
+  if (iter != cache.end() && iter->second->Matches(path)) {
+    index = iter->second;
+    return Status::OK();
+  }
+
+  std::shared_ptr<SplitIndex> loaded;
+  if (access(index_path.c_str(), R_OK) == 0) {
+    auto status = Load(index_path, loaded);
+    if (status.ok() && loaded->Matches(path)) {
+      cache[path] = loaded;
+      index = loaded;
+      return Status::OK();
+    }
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to load the split index " << index_path << ": "
+                   << status.ToString();
+    } else {
+      VLOG(2) << "The split index " << index_path << " is out of date";
+    }
+  }
+  if (!build) {
+    return Status::OK();
+  }
+
+  auto status = Build(path, kDefaultGranularity, loaded);
+  if (!status.ok()) {
+    // the boundaries are probed instead
+    LOG(WARNING) << "Failed to build the split index of " << path << ": "
+                 << status.ToString();
+    return Status::OK();
+  }
+  status = loaded->Save(index_path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to save the split index of " << path << ": "
+                 << status.ToString();
+  }
+  cache[path] = loaded;
+  index = loaded;
+  return Status::OK();
+}
+
+Status SplitIndex::Build(const std::string& path, const int64_t granularity,
+                         std::shared_ptr<SplitIndex>& index) {
+  if (granularity <= 0) {
+    return Status::Invalid("Invalid granularity of the split index: " +
+                           std::to_string(granularity));
+  }
+  std::shared_ptr<SplitIndex> built(new SplitIndex());
+  built->granularity_ = granularity;
+  RETURN_ON_ERROR(statFile(path, built->size_, built->mtime_));
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return ioError("open", path, errno);
+  }
+  auto status = built->build(fd, path);
+  close(fd);
+  RETURN_ON_ERROR(status);
+  VLOG(2) << "Built the split index of " << path << " with "
+          << built->line_starts_.size() << " line starts";
+  index = built;
+  return Status::OK();
+}
+
+Status SplitIndex::build(int fd, const std::string& path) {
+  int64_t header_end = 0;
+  RETURN_ON_ERROR(probeLineStart(fd, path, size_, 1, header_end));
+  if (header_end > kMaxHeaderSize) {
+    return Status::Invalid("The first line of " + path + " is too long");
+  }
+  header_.resize(header_end);
+  int64_t done = 0;
+  while (done < header_end) {
+    ssize_t nbytes = pread(fd, &header_[done], header_end - done, done);
+    if (nbytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      return ioError("read", path, nbytes < 0 ? errno : EIO);
+    }
+    done += nbytes;
+  }
+
+  int64_t line_start = 0;
+  for (int64_t position = 0; position < size_; position += granularity_) {
+    // no line starts in [previous position, line_start), thus the line
+    // start is still the first one at or after the position
+    if (line_start < position) {
+      RETURN_ON_ERROR(probeLineStart(fd, path, size_, position, line_start));
+    }
+    line_starts_.emplace_back(line_start);
+  }
+  return Status::OK();
+}
+
+Status SplitIndex::Load(const std::string& index_path,
+                        std::shared_ptr<SplitIndex>& index) {
+  std::ifstream in(index_path, std::ios::in | std::ios::binary);
+  if (!in) {
+    return ioError("open", index_path, errno);
+  }
+  std::string magic;
+  if (!std::getline(in, magic) || magic != kSplitIndexMagic) {
+    return Status::Invalid("Not a split index: " + index_path);
+  }
+  std::shared_ptr<SplitIndex> loaded(new SplitIndex());
+  int64_t header_size = 0;
+  size_t count = 0;
+  in >> loaded->size_ >> loaded->mtime_ >> loaded->granularity_ >>
+      header_size >> count;
+  if (!in || in.get() != '\n' || header_size < 0 ||
+      header_size > kMaxHeaderSize || loaded->granularity_ <= 0 ||
+      loaded->size_ < 0 ||
+      count > static_cast<size_t>(loaded->size_ / loaded->granularity_ + 1)) {
+    return Status::Invalid("Corrupted split index: " + index_path);
+  }
+  loaded->header_.resize(header_size);
+  in.read(&loaded->header_[0], header_size);
+  loaded->line_starts_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    in >> loaded->line_starts_[i];
+  }
+  if (!in) {
+    return Status::Invalid("Corrupted split index: " + index_path);
+  }
+  index = loaded;
+  return Status::OK();
+}
+
+Status SplitIndex::Save(const std::string& index_path) const {
+  // written aside and renamed, the concurrent readers never see a partial
+  // index
+  std::string temp_path =
+      index_path + ".tmp." + std::to_string(static_cast<int64_t>(getpid()));
+  {
+    std::ofstream out(temp_path,
+                      std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return ioError("create", temp_path, errno);
+    }
+    out << kSplitIndexMagic << "\n"
+        << size_ << " " << mtime_ << " " << granularity_ << " "
+        << header_.size() << " " << line_starts_.size() << "\n";
+    out.write(header_.data(), header_.size());
+    for (auto line_start : line_starts_) {
+      out << line_start << "\n";
+    }
+    out.close();
+    if (!out) {
+      unlink(temp_path.c_str());
+      return Status::IOError("Failed to write the split index " + temp_path);
+    }
+  }
+  if (rename(temp_path.c_str(), index_path.c_str()) != 0) {
+    int err = errno;
+    unlink(temp_path.c_str());
+    return ioError("rename", temp_path, err);
+  }
+  return Status::OK();
+}
+
+Status SplitIndex::ProbeLineStart(const std::string& path,
+                                  const int64_t position,
+                                  int64_t& line_start) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return ioError("open", path, errno);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    close(fd);
+    return ioError("stat", path, err);
+  }
+  auto status = probeLineStart(fd, path, st.st_size, position, line_start);
+  close(fd);
+  return status;
+}
+
+bool SplitIndex::Matches(const std::string& path) const {
+  int64_t size = 0, mtime = 0;
+  return statFile(path, size, mtime).ok() && size == size_ && mtime == mtime_;
+}
+
+int64_t SplitIndex::LineStartAt(const int64_t position) const {
+  size_t index = static_cast<size_t>(position / granularity_);
+  if (position < 0 || index >= line_starts_.size()) {
+    return size_;
+  }
+  return line_starts_[index];
+}
+
+}  // namespace vineyard
@@ -0,0 +1,98 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_SPLIT_INDEX_H_
+#define MODULES_IO_IO_SPLIT_INDEX_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief SplitIndex records the line starts of a local file at the multiples
+ * of the granularity, i.e., the first line start at or after each multiple,
+ * as well as the header line, thus the line-aligned boundaries of partial
+ * reads are looked up without scanning the file.
+ *
+ * The index is built once per file in a process, and can be saved as a
+ * sidecar file (`<file>.idx` by default) for the other readers, which is
+ * valid as long as the size and the modification time of the file are
+ * unchanged.
+ */
+class SplitIndex {
+ public:
+  static constexpr int64_t kDefaultGranularity = 1024 * 1024;
+
+  /**
+   * @brief Get the index of the file: the one cached in this process, or
+   * the one loaded from `index_path`, or when `build` is true, build it by
+   * probing the file (and save it to `index_path`). The index is nullptr if
+   * it's unavailable.
+   */
+  static Status Get(const std::string& path, const std::string& index_path,
+                    const bool build, std::shared_ptr<const SplitIndex>& index);
+
+  static Status Build(const std::string& path, const int64_t granularity,
+                      std::shared_ptr<SplitIndex>& index);
+
+  static Status Load(const std::string& index_path,
+                     std::shared_ptr<SplitIndex>& index);
+
+  /** Save the index, the sidecar file is replaced atomically. */
+  Status Save(const std::string& index_path) const;
+
+  /**
+   * @brief The first line start at or after `position` by probing the file,
+   * i.e., `position` itself if it's the beginning of the file or follows a
+   * '\n', or the next of the first '\n' after it, or the size of the file.
+   */
+  static Status ProbeLineStart(const std::string& path, const int64_t position,
+                               int64_t& line_start);
+
+  /** Whether the index matches the file on disk. */
+  bool Matches(const std::string& path) const;
+
+  /** The first line start at or after `position`, which must be a multiple
+   * of the granularity.
+   */
+  int64_t LineStartAt(const int64_t position) const;
+
+  int64_t size() const { return size_; }
+
+  int64_t granularity() const { return granularity_; }
+
+  /** The end of the first line, including the '\n'. */
+  int64_t header_end() const { return static_cast<int64_t>(header_.size()); }
+
+  /** The first line, including the '\n'. */
+  const std::string& header() const { return header_; }
+
+ private:
+  Status build(int fd, const std::string& path);
+
+  int64_t size_ = 0;
+  int64_t mtime_ = 0;
+  int64_t granularity_ = kDefaultGranularity;
+  std::string header_;
+  std::vector<int64_t> line_starts_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_SPLIT_INDEX_H_
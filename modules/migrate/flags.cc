@@ -18,8 +18,29 @@ limitations under the License.
 namespace vineyard {
 
 DEFINE_uint64(migration_port, 0, "rpc port of migration");
+DEFINE_int32(migration_connections, 8,
+             "number of parallel connections to transfer the blobs");
+DEFINE_string(migration_transport, "tcp",
+              "transport of the blobs, \"tcp\" or \"rdma\" (one-sided reads, "
+              "falls back to tcp if unavailable)");
+DEFINE_bool(migration_zero_copy, true,
+            "send the large blobs over tcp from the store fds by sendfile");
+DEFINE_bool(migration_dedup, false,
+            "skip the blobs whose content already exists on the target "
+            "instance, by the content hashes of blobs");
+DEFINE_string(migration_checkpoint, "",
+              "file that records the blobs and objects landed on the "
+              "receiver, the following runs only transfer the missing ones");
+DEFINE_string(rdma_device, "", "RDMA device to use, the first one if empty");
+DEFINE_int32(rdma_port, 1, "port of the RDMA device");
+DEFINE_int32(rdma_gid_index, 0,
+             "GID index of the RDMA port (required by RoCE), -1 to disable");
 DEFINE_string(object_list, "", "object list");
 DEFINE_string(instance_map, "", "instance_mapping");
 DEFINE_string(ipc_socket, "", "ipc socket of vineyard server");
+DEFINE_string(snapshot_location, "", "location of the object snapshot");
+DEFINE_int32(snapshot_concurrency, 16,
+             "number of threads to write or read the snapshot");
+DEFINE_bool(restore, false, "restore the object from the snapshot");
 
 }  // namespace vineyard
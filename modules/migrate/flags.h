@@ -23,9 +23,20 @@ limitations under the License.
 namespace vineyard {
 
 DECLARE_uint64(migration_port);
+DECLARE_int32(migration_connections);
+DECLARE_string(migration_transport);
+DECLARE_bool(migration_zero_copy);
+DECLARE_bool(migration_dedup);
+DECLARE_string(migration_checkpoint);
+DECLARE_string(rdma_device);
+DECLARE_int32(rdma_port);
+DECLARE_int32(rdma_gid_index);
 DECLARE_string(object_list);
 DECLARE_string(instance_map);
 DECLARE_string(ipc_socket);
+DECLARE_string(snapshot_location);
+DECLARE_int32(snapshot_concurrency);
+DECLARE_bool(restore);
 
 }  // namespace vineyard
 
@@ -15,16 +15,37 @@ limitations under the License.
 
 #include "migrate/object_migration.h"
 
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/sendfile.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "boost/asio.hpp"
 
 #include "basic/ds/object_set.h"
+#include "common/util/typename.h"
 #include "migrate/flags.h"
 #include "migrate/protocols.h"
+#include "migrate/rdma_transport.h"
 
 #define MAX_BUFFER_SIZE 1048576
 
@@ -33,6 +54,137 @@ namespace vineyard {
 namespace asio = boost::asio;
 using boost::asio::ip::tcp;
 
+namespace {
+
+// the buffers of blobs are cut into pieces, which are striped over the
+// connections in a round-robin manner
+constexpr size_t kStripePieceSize = 4 * MAX_BUFFER_SIZE;
+
+constexpr const char* kCheckpointMagic = "vineyard-migration-checkpoint 1";
+
+// the pieces of smaller blobs are copied to the socket, since sendfile(2)
+// doesn't pay off
+constexpr size_t kZeroCopyThreshold = 64 * 1024;
+
+struct Piece {
+  size_t blob;
+  size_t offset;
+  size_t size;
+};
+
+size_t countPieces(const std::vector<std::pair<ObjectID, size_t>>& blobs) {
+  size_t pieces = 0;
+  for (auto const& blob : blobs) {
+    pieces += (blob.second + kStripePieceSize - 1) / kStripePieceSize;
+  }
+  return pieces;
+}
+
+// both ends stripe the pieces in the same way, thus only the index of the
+// stripe is sent on each connection
+std::vector<std::vector<Piece>> stripePieces(
+    const std::vector<std::pair<ObjectID, size_t>>& blobs,
+    const size_t connections) {
+  std::vector<std::vector<Piece>> stripes(connections);
+  size_t stripe = 0;
+  for (size_t blob = 0; blob < blobs.size(); ++blob) {
+    size_t blob_size = blobs[blob].second;
+    for (size_t offset = 0; offset < blob_size; offset += kStripePieceSize) {
+      stripes[stripe].emplace_back(
+          Piece{blob, offset, std::min(kStripePieceSize, blob_size - offset)});
+      stripe = (stripe + 1) % connections;
+    }
+  }
+  return stripes;
+}
+
+Status sendMessage(tcp::socket& socket, const std::string& msg) {
+  boost::system::error_code ec;
+  size_t length = msg.size();
+  asio::write(socket, asio::buffer(&length, sizeof(size_t)), ec);
+  if (!ec) {
+    asio::write(socket, asio::buffer(msg, msg.size()), ec);
+  }
+  if (ec) {
+    return Status::IOError("Failed to send the message: " + ec.message());
+  }
+  return Status::OK();
+}
+
+Status recvMessage(tcp::socket& socket, ptree& root) {
+  boost::system::error_code ec;
+  size_t length = 0;
+  std::string msg;
+  asio::read(socket, asio::buffer(&length, sizeof(size_t)), ec);
+  if (!ec) {
+    msg.resize(length);
+    asio::read(socket, asio::buffer(&msg[0], msg.size()), ec);
+  }
+  if (ec) {
+    return Status::IOError("Failed to receive the message: " + ec.message());
+  }
+  std::istringstream is(msg);
+  bpt::read_json(is, root);
+  return Status::OK();
+}
+
+// sends the piece from the store fd (at `file.second` in the fd), without
+// copying it through the user space. `sent` is less than `size` if the fd
+// doesn't support sendfile(2), e.g., on hugetlbfs, and the rest should be
+// written from the mapped memory.
+Status sendFile(tcp::socket& socket, const std::pair<int, off_t>& file,
+                const size_t offset, const size_t size, size_t& sent) {
+  sent = 0;
+#if defined(__linux__)
+  off_t position = file.second + offset;
+  while (sent < size) {
+    ssize_t nbytes =
+        sendfile(socket.native_handle(), file.first, &position, size - sent);
+    if (nbytes > 0) {
+      sent += nbytes;
+      continue;
+    }
+    if (nbytes == 0) {
+      break;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      pollfd fds{socket.native_handle(), POLLOUT, 0};
+      poll(&fds, 1, -1);
+      continue;
+    }
+    if (errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP) {
+      break;
+    }
+    return Status::IOError(
+        std::string("Failed to send the blob by sendfile: ") +
+        std::strerror(errno));
+  }
+#endif
+  return Status::OK();
+}
+
+// runs the task of every connection on its own thread
+Status forEachConnection(const size_t connections,
+                         const std::function<Status(size_t)>& task) {
+  std::vector<Status> statuses(connections);
+  std::vector<std::thread> threads;
+  for (size_t index = 0; index < connections; ++index) {
+    threads.emplace_back([&, index]() { statuses[index] = task(index); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 Status ObjectMigration::Migrate(
     std::unordered_map<InstanceID, InstanceID>& instance_map,
     std::unordered_map<ObjectID, InstanceID>& object_map, Client& client) {
@@ -55,30 +207,207 @@ Status ObjectMigration::Migrate(
     LOG(INFO) << "Start send object " << object_id;
     RETURN_ON_ERROR(sendObjectMeta(object_id, client, socket));
   }
-  for (auto blob_id : blob_list_) {
-    std::shared_ptr<Blob> target_blob =
-        std::dynamic_pointer_cast<Blob>(client.GetObject(blob_id));
-    size_t remain_size = target_blob->size();
-    std::string message_out;
-    WriteSendBlobBufferRequest(blob_id, remain_size, message_out);
-    size_t length = message_out.size();
-    boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-    boost::asio::write(socket, asio::buffer(message_out, message_out.size()));
-    size_t offset = 0;
-    while (remain_size) {
-      size_t send_size =
-          remain_size < MAX_BUFFER_SIZE ? remain_size : MAX_BUFFER_SIZE;
-      boost::asio::write(socket,
-                         asio::buffer(target_blob->data() + offset, send_size));
-      remain_size -= send_size;
-      offset += send_size;
-    }
+  RETURN_ON_ERROR(skipLandedBlobs(socket));
+  if (FLAGS_migration_dedup) {
+    RETURN_ON_ERROR(dedupBlobs(client, socket));
   }
+  RETURN_ON_ERROR(sendBlobs(client, io_service, endpoint, socket));
   std::string message_exit;
   WriteExitRequest(message_exit);
-  size_t length = message_exit.size();
-  boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-  boost::asio::write(socket, asio::buffer(message_exit, message_exit.size()));
+  return sendMessage(socket, message_exit);
+}
+
+Status ObjectMigration::sendBlobs(Client& client, asio::io_service& io_service,
+                                  const tcp::endpoint& endpoint,
+                                  tcp::socket& socket) {
+  std::vector<ObjectID> blob_ids(blob_list_.begin(), blob_list_.end());
+  std::vector<std::shared_ptr<Blob>> blobs;
+  std::vector<std::pair<ObjectID, size_t>> blob_sizes;
+  for (auto& object : client.GetObjects(blob_ids)) {
+    auto blob = std::dynamic_pointer_cast<Blob>(object);
+    if (blob == nullptr) {
+      return Status::Invalid("Failed to get the blobs to migrate");
+    }
+    blob_sizes.emplace_back(blob->id(), blob->size());
+    blobs.emplace_back(blob);
+  }
+  if (FLAGS_migration_transport == "rdma") {
+    bool sent = false;
+    RETURN_ON_ERROR(sendRemoteBlobs(client, blobs, blob_sizes, socket, sent));
+    if (sent) {
+      return Status::OK();
+    }
+  }
+
+  // the list of blobs is sent up front, the receiver creates the blobs
+  // before accepting the connections
+  size_t pieces = countPieces(blob_sizes);
+  size_t connections = std::min(
+      pieces, static_cast<size_t>(std::max(FLAGS_migration_connections, 1)));
+  std::string message_out;
+  WriteSendBlobListRequest(blob_sizes, connections, message_out);
+  RETURN_ON_ERROR(sendMessage(socket, message_out));
+
+  // the large blobs are sent from the fds of the store segments
+  std::vector<std::pair<int, off_t>> files(blobs.size(), {-1, 0});
+  for (size_t i = 0; FLAGS_migration_zero_copy && i < blobs.size(); ++i) {
+    if (blobs[i]->size() < kZeroCopyThreshold) {
+      continue;
+    }
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    int fd = -1;
+    if (client.GetMappedSegment(blobs[i]->data(), base, size, fd).ok()) {
+      files[i] = std::make_pair(
+          fd, static_cast<off_t>(
+                  reinterpret_cast<const uint8_t*>(blobs[i]->data()) - base));
+    }
+  }
+
+  auto stripes = stripePieces(blob_sizes, connections);
+  RETURN_ON_ERROR(forEachConnection(connections, [&](size_t stripe) -> Status {
+    auto error = [&](const boost::system::error_code& ec) {
+      return Status::IOError("Failed to send the blobs on connection " +
+                             std::to_string(stripe) + ": " + ec.message());
+    };
+    boost::system::error_code ec;
+    tcp::socket connection(io_service);
+    connection.connect(endpoint, ec);
+    if (ec) {
+      return error(ec);
+    }
+    uint64_t index = stripe;
+    asio::write(connection, asio::buffer(&index, sizeof(uint64_t)), ec);
+    if (ec) {
+      return error(ec);
+    }
+    for (auto const& piece : stripes[stripe]) {
+      size_t sent = 0;
+      if (files[piece.blob].first != -1) {
+        RETURN_ON_ERROR(sendFile(connection, files[piece.blob], piece.offset,
+                                 piece.size, sent));
+      }
+      asio::write(connection,
+                  asio::buffer(blobs[piece.blob]->data() + piece.offset + sent,
+                               piece.size - sent),
+                  ec);
+      if (ec) {
+        return error(ec);
+      }
+    }
+    return Status::OK();
+  }));
+  LOG(INFO) << "Sent " << blobs.size() << " blobs on " << connections
+            << " connections";
+  return Status::OK();
+}
+
+Status ObjectMigration::skipLandedBlobs(tcp::socket& socket) {
+  std::vector<ObjectID> blob_ids(blob_list_.begin(), blob_list_.end());
+  std::string message_out;
+  ptree message_in;
+  WriteQueryBlobsRequest(blob_ids, message_out);
+  RETURN_ON_ERROR(sendMessage(socket, message_out));
+  RETURN_ON_ERROR(recvMessage(socket, message_in));
+  std::vector<std::pair<ObjectID, ObjectID>> landed;
+  RETURN_ON_ERROR(ReadQueryBlobsReply(message_in, landed));
+  for (auto const& blob : landed) {
+    blob_list_.erase(blob.first);
+  }
+  if (!landed.empty()) {
+    LOG(INFO) << "Skipped " << landed.size() << " of " << blob_ids.size()
+              << " blobs that have landed in the previous runs";
+  }
+  return Status::OK();
+}
+
+Status ObjectMigration::dedupBlobs(Client& client, tcp::socket& socket) {
+  std::vector<ObjectID> blob_ids(blob_list_.begin(), blob_list_.end());
+  std::vector<BlobHash> hashes;
+  for (auto& object : client.GetObjects(blob_ids)) {
+    auto blob = std::dynamic_pointer_cast<Blob>(object);
+    if (blob == nullptr) {
+      return Status::Invalid("Failed to get the blobs to migrate");
+    }
+    if (blob->size() == 0) {
+      continue;
+    }
+    std::string hash = blob->ContentHash();
+    if (!hash.empty()) {
+      hashes.emplace_back(BlobHash{blob->id(), blob->size(), hash});
+    }
+  }
+
+  std::string message_out;
+  ptree message_in;
+  WriteSendBlobHashesRequest(hashes, message_out);
+  RETURN_ON_ERROR(sendMessage(socket, message_out));
+  RETURN_ON_ERROR(recvMessage(socket, message_in));
+  std::vector<std::pair<ObjectID, ObjectID>> existing;
+  RETURN_ON_ERROR(ReadBlobHashesReply(message_in, existing));
+  // the receiver maps them to the existing blobs
+  for (auto const& blob : existing) {
+    blob_list_.erase(blob.first);
+  }
+  LOG(INFO) << "Skipped " << existing.size() << " of " << hashes.size()
+            << " blobs that already exist on the target instance";
+  return Status::OK();
+}
+
+Status ObjectMigration::sendRemoteBlobs(
+    Client& client, const std::vector<std::shared_ptr<Blob>>& blobs,
+    const std::vector<std::pair<ObjectID, size_t>>& blob_sizes,
+    tcp::socket& socket, bool& sent) {
+  sent = false;
+  std::unique_ptr<RDMAEndpoint> endpoint;
+  auto status = RDMAEndpoint::Open(FLAGS_rdma_device, FLAGS_rdma_port,
+                                   FLAGS_rdma_gid_index, endpoint);
+  // the receiver reads the buffers from the mapped segments of the store,
+  // each segment is registered once
+  std::vector<std::pair<uint64_t, uint32_t>> addresses;
+  for (size_t i = 0; status.ok() && i < blobs.size(); ++i) {
+    uint32_t lkey = 0, rkey = 0;
+    if (blobs[i]->size() > 0) {
+      uint8_t* base = nullptr;
+      size_t size = 0;
+      status = client.GetMappedSegment(blobs[i]->data(), base, size);
+      if (status.ok()) {
+        status = endpoint->Register(base, size, false, lkey, rkey);
+      }
+    }
+    addresses.emplace_back(
+        blobs[i]->size() > 0 ? reinterpret_cast<uint64_t>(blobs[i]->data())
+                             : 0,
+        rkey);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Transfer the blobs over TCP as RDMA is unavailable: "
+                 << status.ToString();
+    return Status::OK();
+  }
+
+  std::string message_out;
+  ptree message_in;
+  WriteSendRemoteBlobListRequest(blob_sizes, addresses, endpoint->LocalInfo(),
+                                 message_out);
+  RETURN_ON_ERROR(sendMessage(socket, message_out));
+  RETURN_ON_ERROR(recvMessage(socket, message_in));
+  RDMAQueueInfo remote;
+  status = ReadRDMAConnectReply(message_in, remote);
+  if (!status.ok()) {
+    LOG(WARNING) << "Transfer the blobs over TCP as RDMA is unavailable on "
+                    "the receiver: "
+                 << status.ToString();
+    return Status::OK();
+  }
+  RETURN_ON_ERROR(endpoint->Connect(remote));
+  WriteRDMAReadyRequest(message_out);
+  RETURN_ON_ERROR(sendMessage(socket, message_out));
+  // the buffers must be kept until the receiver has read them
+  RETURN_ON_ERROR(recvMessage(socket, message_in));
+  RETURN_ON_ERROR(ReadRDMAReadDoneReply(message_in));
+  sent = true;
+  LOG(INFO) << "Sent " << blobs.size() << " blobs by RDMA reads";
   return Status::OK();
 }
 
@@ -106,9 +435,7 @@ Status ObjectMigration::sendObjectMeta(ObjectID object_id, Client& client,
   if (object_list_.find(object_id) == object_list_.end()) {
     std::string msg;
     WriteSendObjectRequest(object_id, meta_tree, msg);
-    size_t length = msg.size();
-    boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-    boost::asio::write(socket, asio::buffer(msg, msg.size()));
+    RETURN_ON_ERROR(sendMessage(socket, msg));
     object_list_.emplace(object_id);
   }
   return Status::OK();
@@ -132,6 +459,7 @@ void ObjectMigration::getBlobList(ptree& meta_tree) {
 }
 
 Status MigrationServer::Start(Client& client) {
+  RETURN_ON_ERROR(openCheckpoint(client));
   asio::io_service io_service;
   tcp::acceptor acceptor(io_service,
                          tcp::endpoint(tcp::v4(), FLAGS_migration_port));
@@ -176,8 +504,51 @@ Status MigrationServer::Start(Client& client) {
         remain_size -= recv_size;
         offset += recv_size;
       }
-      auto buffer = buffer_writer->Seal(client);
-      object_id_map_.emplace(blob_id, buffer->id());
+      sealBlob(blob_id, *buffer_writer, client);
+    } break;
+    case MigrateActionType::SendBlobListRequest: {
+      std::vector<std::pair<ObjectID, size_t>> blobs;
+      size_t connections = 0;
+      RETURN_ON_ERROR(ReadSendBlobListRequest(root, blobs, connections));
+      RETURN_ON_ERROR(
+          receiveBlobs(blobs, connections, io_service, acceptor, client));
+    } break;
+    case MigrateActionType::QueryBlobsRequest: {
+      std::vector<ObjectID> blobs;
+      RETURN_ON_ERROR(ReadQueryBlobsRequest(root, blobs));
+      std::vector<std::pair<ObjectID, ObjectID>> landed;
+      for (auto const& blob : blobs) {
+        auto iter = landed_blobs_.find(blob);
+        if (iter != landed_blobs_.end()) {
+          landed.emplace_back(blob, iter->second);
+        }
+      }
+      std::string message_out;
+      WriteQueryBlobsReply(landed, message_out);
+      RETURN_ON_ERROR(sendMessage(socket, message_out));
+    } break;
+    case MigrateActionType::SendBlobHashesRequest: {
+      std::vector<BlobHash> hashes;
+      std::vector<std::pair<ObjectID, ObjectID>> existing;
+      RETURN_ON_ERROR(ReadSendBlobHashesRequest(root, hashes));
+      std::string message_out;
+      auto status = findBlobs(hashes, client, existing);
+      if (status.ok()) {
+        WriteBlobHashesReply(existing, message_out);
+      } else {
+        WriteErrorReply(status, message_out);
+      }
+      RETURN_ON_ERROR(sendMessage(socket, message_out));
+      RETURN_ON_ERROR(status);
+    } break;
+    case MigrateActionType::SendRemoteBlobListRequest: {
+      std::vector<std::pair<ObjectID, size_t>> blobs;
+      std::vector<std::pair<uint64_t, uint32_t>> addresses;
+      RDMAQueueInfo queue;
+      RETURN_ON_ERROR(
+          ReadSendRemoteBlobListRequest(root, blobs, addresses, queue));
+      RETURN_ON_ERROR(
+          receiveRemoteBlobs(blobs, addresses, queue, socket, client));
     } break;
     case MigrateActionType::ExitRequest: {
       for (auto it = object_map_.begin(); it != object_map_.end(); it++) {
@@ -190,6 +561,9 @@ Status MigrationServer::Start(Client& client) {
             object_id = createObject(it->second, client, false);
           }
           object_id_map_.emplace(it->first, object_id);
+          if (object_id != InvalidObjectID()) {
+            recordCheckpoint("object", it->first, object_id);
+          }
         } else {
           object_id = object_id_map_.find(it->first)->second;
         }
@@ -207,6 +581,304 @@ Status MigrationServer::Start(Client& client) {
   return Status::OK();
 }
 
+Status MigrationServer::receiveBlobs(
+    const std::vector<std::pair<ObjectID, size_t>>& blobs,
+    const size_t connections, asio::io_service& io_service,
+    tcp::acceptor& acceptor, Client& client) {
+  if (connections == 0 && countPieces(blobs) > 0) {
+    return Status::Invalid("No connections to receive the blobs");
+  }
+  // the pieces are received straight into the blobs
+  std::vector<std::unique_ptr<BlobWriter>> writers(blobs.size());
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    RETURN_ON_ERROR(client.CreateBlob(blobs[i].second, writers[i]));
+  }
+  std::vector<std::unique_ptr<tcp::socket>> sockets;
+  for (size_t i = 0; i < connections; ++i) {
+    boost::system::error_code ec;
+    sockets.emplace_back(new tcp::socket(io_service));
+    acceptor.accept(*sockets.back(), ec);
+    if (ec) {
+      return Status::IOError("Failed to accept the connection of blobs: " +
+                             ec.message());
+    }
+  }
+
+  auto stripes = stripePieces(blobs, connections);
+  std::mutex mutex;
+  std::vector<bool> received(connections, false);
+  // the blobs are sealed (and checkpointed) as soon as they have landed
+  std::vector<size_t> remaining(blobs.size());
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    remaining[i] = blobs[i].second;
+    if (remaining[i] == 0) {
+      sealBlob(blobs[i].first, *writers[i], client);
+    }
+  }
+  RETURN_ON_ERROR(forEachConnection(connections, [&](size_t index) -> Status {
+    tcp::socket& socket = *sockets[index];
+    auto error = [&](const boost::system::error_code& ec) {
+      return Status::IOError("Failed to receive the blobs on connection " +
+                             std::to_string(index) + ": " + ec.message());
+    };
+    boost::system::error_code ec;
+    // the connections may be accepted in any order
+    uint64_t stripe = 0;
+    asio::read(socket, asio::buffer(&stripe, sizeof(uint64_t)), ec);
+    if (ec) {
+      return error(ec);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (stripe >= connections || received[stripe]) {
+        return Status::Invalid("Unexpected stripe of blobs: " +
+                               std::to_string(stripe));
+      }
+      received[stripe] = true;
+    }
+    for (auto const& piece : stripes[stripe]) {
+      asio::read(socket,
+                 asio::buffer(writers[piece.blob]->data() + piece.offset,
+                              piece.size),
+                 ec);
+      if (ec) {
+        return error(ec);
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      remaining[piece.blob] -= piece.size;
+      if (remaining[piece.blob] == 0) {
+        sealBlob(blobs[piece.blob].first, *writers[piece.blob], client);
+      }
+    }
+    return Status::OK();
+  }));
+  LOG(INFO) << "Received " << blobs.size() << " blobs on " << connections
+            << " connections";
+  return Status::OK();
+}
+
+Status MigrationServer::receiveRemoteBlobs(
+    const std::vector<std::pair<ObjectID, size_t>>& blobs,
+    const std::vector<std::pair<uint64_t, uint32_t>>& addresses,
+    const RDMAQueueInfo& queue, tcp::socket& socket, Client& client) {
+  RETURN_ON_ASSERT(blobs.size() == addresses.size(),
+                   "The addresses don't match the blobs");
+  std::string message_out;
+  std::unique_ptr<RDMAEndpoint> endpoint;
+  auto status = RDMAEndpoint::Open(FLAGS_rdma_device, FLAGS_rdma_port,
+                                   FLAGS_rdma_gid_index, endpoint);
+  if (status.ok()) {
+    status = endpoint->Connect(queue);
+  }
+  if (!status.ok()) {
+    // the sender falls back to TCP
+    LOG(WARNING) << "Failed to receive the blobs by RDMA: "
+                 << status.ToString();
+    WriteErrorReply(status, message_out);
+    return sendMessage(socket, message_out);
+  }
+
+  // the buffers are read straight into the blobs, each mapped segment of the
+  // store is registered once
+  std::vector<std::unique_ptr<BlobWriter>> writers(blobs.size());
+  std::vector<RDMARead> reads;
+  for (size_t i = 0; status.ok() && i < blobs.size(); ++i) {
+    status = client.CreateBlob(blobs[i].second, writers[i]);
+    if (!status.ok() || blobs[i].second == 0) {
+      continue;
+    }
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    uint32_t lkey = 0, rkey = 0;
+    auto data = reinterpret_cast<uint8_t*>(writers[i]->data());
+    status = client.GetMappedSegment(data, base, size);
+    if (status.ok()) {
+      status = endpoint->Register(base, size, true, lkey, rkey);
+    }
+    reads.emplace_back(RDMARead{data, addresses[i].first, addresses[i].second,
+                                blobs[i].second});
+  }
+  if (!status.ok()) {
+    WriteErrorReply(status, message_out);
+    RETURN_ON_ERROR(sendMessage(socket, message_out));
+    return status;
+  }
+  WriteRDMAConnectReply(endpoint->LocalInfo(), message_out);
+  RETURN_ON_ERROR(sendMessage(socket, message_out));
+
+  // the reads are issued once the queue pair of the sender is ready
+  ptree message_in;
+  RETURN_ON_ERROR(recvMessage(socket, message_in));
+  RETURN_ON_ERROR(ReadRDMAReadyRequest(message_in));
+  status = endpoint->Read(reads);
+  if (!status.ok()) {
+    WriteErrorReply(status, message_out);
+    RETURN_ON_ERROR(sendMessage(socket, message_out));
+    return status;
+  }
+  WriteRDMAReadDoneReply(message_out);
+  RETURN_ON_ERROR(sendMessage(socket, message_out));
+
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    sealBlob(blobs[i].first, *writers[i], client);
+  }
+  LOG(INFO) << "Received " << blobs.size() << " blobs by RDMA reads";
+  return Status::OK();
+}
+
+Status MigrationServer::findBlobs(
+    const std::vector<BlobHash>& hashes, Client& client,
+    std::vector<std::pair<ObjectID, ObjectID>>& existing) {
+  // only the local blobs of the same sizes are candidates
+  std::unordered_set<size_t> sizes;
+  for (auto const& blob : hashes) {
+    blob_hashes_[blob.blob_id] = blob.hash;
+    sizes.emplace(blob.size);
+  }
+  std::unordered_map<std::string, ObjectID> found;
+  std::vector<ObjectID> unhashed;
+  std::string cursor;
+  do {
+    std::unordered_map<ObjectID, ptree> page;
+    RETURN_ON_ERROR(
+        client.ListData(type_name<Blob>(), false, 1000, cursor, page));
+    for (auto const& item : page) {
+      auto const& tree = item.second;
+      if (tree.get<InstanceID>("instance_id", UnspecifiedInstanceID()) !=
+              client.instance_id() ||
+          sizes.find(tree.get<size_t>("length", 0)) == sizes.end()) {
+        continue;
+      }
+      auto hash = tree.get_optional<std::string>("content_hash");
+      if (hash) {
+        found.emplace(hash.get(), item.first);
+      } else {
+        unhashed.emplace_back(item.first);
+      }
+    }
+  } while (!cursor.empty());
+  // the candidates sealed without content hashing are hashed now
+  if (!unhashed.empty()) {
+    for (auto& object : client.GetObjects(unhashed)) {
+      auto blob = std::dynamic_pointer_cast<Blob>(object);
+      if (blob != nullptr) {
+        std::string hash = blob->ContentHash();
+        if (!hash.empty()) {
+          found.emplace(hash, blob->id());
+        }
+      }
+    }
+  }
+
+  existing.clear();
+  for (auto const& blob : hashes) {
+    auto iter = found.find(blob.hash);
+    if (iter != found.end()) {
+      existing.emplace_back(blob.blob_id, iter->second);
+      object_id_map_.emplace(blob.blob_id, iter->second);
+    }
+  }
+  LOG(INFO) << "Found " << existing.size() << " of " << hashes.size()
+            << " blobs on this instance";
+  return Status::OK();
+}
+
+void MigrationServer::sealBlob(const ObjectID blob_id, BlobWriter& writer,
+                               Client& client) {
+  // the content hash exchanged is recorded in the metadata
+  auto iter = blob_hashes_.find(blob_id);
+  if (iter != blob_hashes_.end()) {
+    writer.AddKeyValue("content_hash", iter->second);
+  }
+  auto buffer = writer.Seal(client);
+  object_id_map_.emplace(blob_id, buffer->id());
+  recordCheckpoint("blob", blob_id, buffer->id());
+}
+
+Status MigrationServer::openCheckpoint(Client& client) {
+  if (FLAGS_migration_checkpoint.empty()) {
+    return Status::OK();
+  }
+  // the blobs and objects that have landed in the previous runs, and still
+  // exist
+  std::vector<std::tuple<std::string, ObjectID, ObjectID>> records;
+  std::ifstream in(FLAGS_migration_checkpoint);
+  std::string line;
+  if (in && std::getline(in, line)) {
+    if (line != kCheckpointMagic) {
+      return Status::Invalid("Not a checkpoint of migration: " +
+                             FLAGS_migration_checkpoint);
+    }
+    while (std::getline(in, line)) {
+      std::istringstream record(line);
+      std::string kind, source, target;
+      // a torn record at the end is dropped
+      if (!(record >> kind >> source >> target) ||
+          (kind != "blob" && kind != "object")) {
+        continue;
+      }
+      ObjectID target_id = VYObjectIDFromString(target);
+      ObjectMeta meta;
+      if (!client.GetMetaData(target_id, meta).ok()) {
+        continue;
+      }
+      records.emplace_back(kind, VYObjectIDFromString(source), target_id);
+    }
+  }
+  in.close();
+
+  // compact the checkpoint, then append the new records to it
+  std::string temp_path = FLAGS_migration_checkpoint + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::out | std::ios::trunc);
+    out << kCheckpointMagic << "\n";
+    for (auto const& record : records) {
+      out << std::get<0>(record) << " "
+          << VYObjectIDToString(std::get<1>(record)) << " "
+          << VYObjectIDToString(std::get<2>(record)) << "\n";
+    }
+    out.close();
+    if (!out) {
+      return Status::IOError("Failed to write the checkpoint " + temp_path);
+    }
+  }
+  if (rename(temp_path.c_str(), FLAGS_migration_checkpoint.c_str()) != 0) {
+    return Status::IOError("Failed to replace the checkpoint " +
+                           FLAGS_migration_checkpoint + ": " +
+                           std::strerror(errno));
+  }
+  for (auto const& record : records) {
+    object_id_map_[std::get<1>(record)] = std::get<2>(record);
+    if (std::get<0>(record) == "blob") {
+      landed_blobs_[std::get<1>(record)] = std::get<2>(record);
+    }
+  }
+  checkpoint_.reset(new std::ofstream(FLAGS_migration_checkpoint,
+                                      std::ios::out | std::ios::app));
+  if (!*checkpoint_) {
+    return Status::IOError("Failed to open the checkpoint " +
+                           FLAGS_migration_checkpoint);
+  }
+  LOG(INFO) << "Resumed " << records.size()
+            << " blobs and objects from the checkpoint";
+  return Status::OK();
+}
+
+void MigrationServer::recordCheckpoint(const std::string& kind,
+                                       const ObjectID source,
+                                       const ObjectID target) {
+  if (checkpoint_ == nullptr) {
+    return;
+  }
+  // flushed per record, the record survives when the process is killed
+  *checkpoint_ << kind << " " << VYObjectIDToString(source) << " "
+               << VYObjectIDToString(target) << std::endl;
+  if (!*checkpoint_) {
+    LOG(WARNING) << "Failed to write the checkpoint "
+                 << FLAGS_migration_checkpoint;
+  }
+}
+
 ObjectID MigrationServer::createObject(ptree& meta_tree, Client& client,
                                        bool persist) {
   InstanceID instance_id =
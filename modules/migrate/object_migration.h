@@ -16,11 +16,13 @@ limitations under the License.
 #ifndef MODULES_MIGRATE_OBJECT_MIGRATION_H_
 #define MODULES_MIGRATE_OBJECT_MIGRATION_H_
 
+#include <fstream>
 #include <memory>
 #include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -34,12 +36,40 @@ limitations under the License.
 #include "client/client.h"
 #include "client/ds/object_meta.h"
 #include "migrate/protocols.h"
+#include "migrate/rdma_transport.h"
 
 namespace vineyard {
 
 namespace asio = boost::asio;
 using boost::asio::ip::tcp;
 
+/**
+ * @brief ObjectMigration sends the objects to the `MigrationServer` on the
+ * target instance: the metadata of objects, and the list of blobs, are sent
+ * on the control connection up front, then the buffers of blobs are cut into
+ * pieces and striped over `--migration_connections` parallel connections,
+ * which are received straight into the blob writers created beforehand.
+ * The pieces of large blobs are sent from the fds of the store segments by
+ * `sendfile(2)` (unless `--migration_zero_copy=false`), without copying them
+ * to the socket buffers through the user space.
+ *
+ * With `--migration_transport=rdma` the receiver reads the buffers instead,
+ * by one-sided RDMA reads from the memory of the store on the sender, while
+ * the TCP connection is kept as the control path, e.g., for exchanging the
+ * queue pairs and the addresses of blobs. It falls back to TCP when RDMA is
+ * unavailable on either side.
+ *
+ * With `--migration_dedup` the content hashes of blobs (see also
+ * `Blob::ContentHash`) are sent before the buffers, and the blobs whose
+ * content already exists on the target instance are not transferred but
+ * mapped to the existing blobs.
+ *
+ * The receiver records the blobs and the objects that have landed in the
+ * `--migration_checkpoint` file, the following runs only transfer the blobs
+ * (and create the objects) that are missing on the target instance, thus an
+ * interrupted migration is resumed, and a migration repeated later only
+ * syncs the new objects.
+ */
 class ObjectMigration {
  public:
   explicit ObjectMigration(std::vector<ObjectID> object_ids, Client& client)
@@ -56,6 +86,24 @@ class ObjectMigration {
   Status sendObjectMeta(ObjectID object_id, Client& client,
                         tcp::socket& socket);
 
+  /** Skip the blobs that have landed in the previous runs. */
+  Status skipLandedBlobs(tcp::socket& socket);
+
+  /** Skip the blobs that already exist on the target instance. */
+  Status dedupBlobs(Client& client, tcp::socket& socket);
+
+  Status sendBlobs(Client& client, asio::io_service& io_service,
+                   const tcp::endpoint& endpoint, tcp::socket& socket);
+
+  /**
+   * @brief Let the receiver read the blobs by RDMA, `sent` is false if RDMA
+   * is unavailable and the blobs should be sent over TCP instead.
+   */
+  Status sendRemoteBlobs(
+      Client& client, const std::vector<std::shared_ptr<Blob>>& blobs,
+      const std::vector<std::pair<ObjectID, size_t>>& blob_sizes,
+      tcp::socket& socket, bool& sent);
+
   void getBlobList(ptree& meta_tree);
 
   std::vector<ObjectID> object_ids_;
@@ -76,9 +124,35 @@ class MigrationServer {
  private:
   ObjectID createObject(ptree& meta, Client& client, bool persist);
 
+  Status receiveBlobs(const std::vector<std::pair<ObjectID, size_t>>& blobs,
+                      const size_t connections, asio::io_service& io_service,
+                      tcp::acceptor& acceptor, Client& client);
+
+  /** Find the local blobs that have the same content hashes. */
+  Status findBlobs(const std::vector<BlobHash>& hashes, Client& client,
+                   std::vector<std::pair<ObjectID, ObjectID>>& existing);
+
+  void sealBlob(const ObjectID blob_id, BlobWriter& writer, Client& client);
+
+  /** Load the checkpoint of the previous runs, and open it to append. */
+  Status openCheckpoint(Client& client);
+
+  void recordCheckpoint(const std::string& kind, const ObjectID source,
+                        const ObjectID target);
+
+  Status receiveRemoteBlobs(
+      const std::vector<std::pair<ObjectID, size_t>>& blobs,
+      const std::vector<std::pair<uint64_t, uint32_t>>& addresses,
+      const RDMAQueueInfo& queue, tcp::socket& socket, Client& client);
+
   std::unordered_map<InstanceID, InstanceID> instance_map_;
   std::unordered_map<ObjectID, ptree> object_map_;
   std::unordered_map<ObjectID, ObjectID> object_id_map_;
+  // the content hashes of the blobs to migrate, if exchanged
+  std::unordered_map<ObjectID, std::string> blob_hashes_;
+  // the blobs that have landed in the previous runs
+  std::unordered_map<ObjectID, ObjectID> landed_blobs_;
+  std::unique_ptr<std::ofstream> checkpoint_;
 };
 
 }  // namespace vineyard
@@ -0,0 +1,324 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "migrate/object_snapshot.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+#include "glog/logging.h"
+
+#include "io/io/io_factory.h"
+
+namespace vineyard {
+
+namespace {
+
+constexpr int kSnapshotVersion = 1;
+
+std::string metaLocation(const std::string& location) {
+  return location + "/meta.json";
+}
+
+std::string partLocation(const std::string& location, const int part) {
+  return location + "/blobs-" + std::to_string(part);
+}
+
+// runs the task of every part on at most `concurrency` threads
+Status forEachPart(const int parts, const int concurrency,
+                   const std::function<Status(int)>& task) {
+  int thread_num = std::max(1, std::min(concurrency, parts));
+  std::vector<Status> statuses(thread_num);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < thread_num; ++tid) {
+    threads.emplace_back([&, tid]() {
+      for (int part = tid; part < parts && statuses[tid].ok();
+           part += thread_num) {
+        statuses[tid] = task(part);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ObjectSnapshot::Dump(const ObjectID object_id,
+                            const std::string& location,
+                            const int concurrency) {
+  ObjectMeta meta;
+  RETURN_ON_ERROR(client_.GetMetaData(object_id, meta));
+  ptree meta_tree = meta.MetaData();
+
+  std::vector<ObjectID> blob_ids;
+  collectBlobs(meta_tree, blob_ids);
+  std::vector<std::shared_ptr<Blob>> blobs;
+  size_t total_size = 0;
+  for (auto& object : client_.GetObjects(blob_ids)) {
+    auto blob = std::dynamic_pointer_cast<Blob>(object);
+    if (blob == nullptr) {
+      return Status::Invalid(
+          "Only the objects whose blobs are local to the vineyard server can "
+          "be dumped");
+    }
+    if (blob->device_id() != -1) {
+      return Status::NotImplemented(
+          "The blobs in device memory can't be dumped");
+    }
+    total_size += blob->size();
+    blobs.emplace_back(blob);
+  }
+
+  // cut the blobs into parts of similar sizes, in the order of traversal
+  int parts =
+      std::max(1, std::min(concurrency, static_cast<int>(blobs.size())));
+  std::vector<std::vector<std::shared_ptr<Blob>>> part_blobs(parts);
+  std::vector<size_t> part_sizes(parts, 0);
+  ptree blob_index;
+  size_t accumulated = 0;
+  for (auto& blob : blobs) {
+    int part = std::min(
+        parts - 1, static_cast<int>(accumulated * parts /
+                                    std::max(total_size, size_t(1))));
+    ptree entry;
+    entry.put("part", part);
+    entry.put("offset", part_sizes[part]);
+    entry.put("size", blob->size());
+    blob_index.add_child(VYObjectIDToString(blob->id()), entry);
+    part_blobs[part].emplace_back(blob);
+    part_sizes[part] += blob->size();
+    accumulated += blob->size();
+  }
+
+  RETURN_ON_ERROR(forEachPart(parts, concurrency, [&](int part) -> Status {
+    return writePart(location, part, part_blobs[part]);
+  }));
+
+  // the metadata is written at last, the snapshot without it is incomplete
+  ptree root;
+  root.put("version", kSnapshotVersion);
+  root.put("parts", parts);
+  root.add_child("blobs", blob_index);
+  root.add_child("object", meta_tree);
+  RETURN_ON_ERROR(writeMeta(location, root));
+  LOG(INFO) << "Dumped object " << VYObjectIDToString(object_id) << " ("
+            << total_size << " bytes in " << blobs.size() << " blobs) to "
+            << location;
+  return Status::OK();
+}
+
+Status ObjectSnapshot::Restore(const std::string& location,
+                               ObjectID& object_id, const int concurrency) {
+  ptree root;
+  RETURN_ON_ERROR(readMeta(location, root));
+  if (root.get<int>("version", 0) != kSnapshotVersion) {
+    return Status::Invalid("Unsupported snapshot version at " + location);
+  }
+  int parts = root.get<int>("parts");
+  std::vector<std::vector<std::pair<ObjectID, BlobEntry>>> part_blobs(parts);
+  for (auto const& item : root.get_child("blobs")) {
+    BlobEntry entry;
+    entry.part = item.second.get<int>("part");
+    entry.offset = item.second.get<size_t>("offset");
+    entry.size = item.second.get<size_t>("size");
+    if (entry.part < 0 || entry.part >= parts) {
+      return Status::Invalid("Invalid blob entry in the snapshot: " +
+                             item.first);
+    }
+    part_blobs[entry.part].emplace_back(VYObjectIDFromString(item.first),
+                                        entry);
+  }
+
+  std::vector<std::unordered_map<ObjectID, ObjectID>> blob_id_maps(parts);
+  RETURN_ON_ERROR(forEachPart(parts, concurrency, [&](int part) -> Status {
+    auto& blobs = part_blobs[part];
+    std::sort(blobs.begin(), blobs.end(),
+              [](const std::pair<ObjectID, BlobEntry>& lhs,
+                 const std::pair<ObjectID, BlobEntry>& rhs) {
+                return lhs.second.offset < rhs.second.offset;
+              });
+    return readPart(location, part, blobs, blob_id_maps[part]);
+  }));
+  object_id_map_.clear();
+  for (auto& blob_id_map : blob_id_maps) {
+    object_id_map_.insert(blob_id_map.begin(), blob_id_map.end());
+  }
+
+  ptree& meta_tree = root.get_child("object");
+  RETURN_ON_ERROR(createObject(meta_tree, object_id));
+  LOG(INFO) << "Restored object " << VYObjectIDToString(object_id) << " from "
+            << location;
+  return Status::OK();
+}
+
+void ObjectSnapshot::collectBlobs(const ptree& meta_tree,
+                                  std::vector<ObjectID>& blob_ids) {
+  std::unordered_set<ObjectID> visited;
+  std::function<void(const ptree&)> visit = [&](const ptree& tree) {
+    ObjectID id = VYObjectIDFromString(tree.get<std::string>("id"));
+    if (!visited.emplace(id).second) {
+      return;
+    }
+    if (IsBlob(id)) {
+      if (id != EmptyBlobID()) {
+        blob_ids.emplace_back(id);
+      }
+      return;
+    }
+    for (auto const& item : tree) {
+      if (!item.second.empty()) {
+        visit(item.second);
+      }
+    }
+  };
+  visit(meta_tree);
+}
+
+Status ObjectSnapshot::writeMeta(const std::string& location,
+                                 const ptree& root) {
+  auto adaptor = IOFactory::CreateIOAdaptor(metaLocation(location));
+  if (adaptor == nullptr) {
+    return Status::IOError("Unsupported snapshot location: " + location);
+  }
+  std::ostringstream os;
+  bpt::write_json(os, root, false);
+  RETURN_ON_ERROR(adaptor->Open("w"));
+  RETURN_ON_ERROR(adaptor->WriteLine(os.str()));
+  return adaptor->Close();
+}
+
+Status ObjectSnapshot::readMeta(const std::string& location, ptree& root) {
+  auto adaptor = IOFactory::CreateIOAdaptor(metaLocation(location));
+  if (adaptor == nullptr) {
+    return Status::IOError("Unsupported snapshot location: " + location);
+  }
+  RETURN_ON_ERROR(adaptor->Open("r"));
+  std::string content, line;
+  while (adaptor->ReadLine(line).ok()) {
+    content += line;
+  }
+  RETURN_ON_ERROR(adaptor->Close());
+  std::istringstream is(content);
+  try {
+    bpt::read_json(is, root);
+  } catch (bpt::json_parser_error const& e) {
+    return Status::IOError("Failed to parse the snapshot metadata: " +
+                           std::string(e.what()));
+  }
+  return Status::OK();
+}
+
+Status ObjectSnapshot::writePart(
+    const std::string& location, const int part,
+    const std::vector<std::shared_ptr<Blob>>& blobs) {
+  auto adaptor = IOFactory::CreateIOAdaptor(partLocation(location, part));
+  if (adaptor == nullptr) {
+    return Status::IOError("Unsupported snapshot location: " + location);
+  }
+  RETURN_ON_ERROR(adaptor->Open("wb"));
+  for (auto const& blob : blobs) {
+    if (blob->size() > 0) {
+      RETURN_ON_ERROR(
+          adaptor->Write(const_cast<char*>(blob->data()), blob->size()));
+    }
+  }
+  return adaptor->Close();
+}
+
+Status ObjectSnapshot::readPart(
+    const std::string& location, const int part,
+    const std::vector<std::pair<ObjectID, BlobEntry>>& blobs,
+    std::unordered_map<ObjectID, ObjectID>& blob_id_map) {
+  std::vector<size_t> sizes;
+  for (auto const& item : blobs) {
+    if (item.second.size > 0) {
+      sizes.emplace_back(item.second.size);
+    } else {
+      blob_id_map.emplace(item.first, EmptyBlobID());
+    }
+  }
+  if (sizes.empty()) {
+    return Status::OK();
+  }
+  // the payloads are read into the blobs in the vineyard server directly
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  RETURN_ON_ERROR(client_.CreateBlobs(sizes, writers));
+
+  auto adaptor = IOFactory::CreateIOAdaptor(partLocation(location, part));
+  if (adaptor == nullptr) {
+    return Status::IOError("Unsupported snapshot location: " + location);
+  }
+  RETURN_ON_ERROR(adaptor->Open("rb"));
+  size_t offset = 0, index = 0;
+  for (auto const& item : blobs) {
+    if (item.second.size == 0) {
+      continue;
+    }
+    if (item.second.offset != offset) {
+      return Status::IOError("The blobs of snapshot part " +
+                             std::to_string(part) + " are not contiguous");
+    }
+    auto& writer = writers[index++];
+    RETURN_ON_ERROR(adaptor->Read(writer->data(), item.second.size));
+    offset += item.second.size;
+    auto blob = writer->Seal(client_);
+    blob_id_map.emplace(item.first, blob->id());
+  }
+  return adaptor->Close();
+}
+
+Status ObjectSnapshot::createObject(ptree& meta_tree, ObjectID& object_id) {
+  for (auto& item : meta_tree) {
+    if (item.second.empty()) {
+      continue;
+    }
+    ObjectID member_id =
+        VYObjectIDFromString(item.second.get<std::string>("id"));
+    if (member_id == EmptyBlobID()) {
+      continue;
+    }
+    ObjectID new_member_id;
+    auto iter = object_id_map_.find(member_id);
+    if (iter != object_id_map_.end()) {
+      new_member_id = iter->second;
+    } else if (IsBlob(member_id)) {
+      return Status::IOError("The blob " + VYObjectIDToString(member_id) +
+                             " is missing in the snapshot");
+    } else {
+      RETURN_ON_ERROR(createObject(item.second, new_member_id));
+      object_id_map_.emplace(member_id, new_member_id);
+    }
+    ObjectMeta member_meta;
+    RETURN_ON_ERROR(client_.GetMetaData(new_member_id, member_meta));
+    item.second = member_meta.MetaData();
+  }
+  ObjectMeta meta;
+  meta.SetMetaData(&client_, meta_tree);
+  return client_.CreateMetaData(meta, object_id);
+}
+
+}  // namespace vineyard
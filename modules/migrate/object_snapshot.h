@@ -0,0 +1,96 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_MIGRATE_OBJECT_SNAPSHOT_H_
+#define MODULES_MIGRATE_OBJECT_SNAPSHOT_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/boost.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief ObjectSnapshot dumps a local object (e.g., an `ArrowFragment`),
+ * including the metadata and the payloads of all its blobs, to a location
+ * that is supported by the `IOFactory` (a local directory, or an OSS prefix),
+ * and restores it to a vineyard server later.
+ *
+ * The snapshot under `<location>` consists of
+ *
+ *  - `<location>/meta.json`: the metadata tree of the object, and the index
+ *    of blobs (the part, offset and size of each blob).
+ *  - `<location>/blobs-<i>`: the payloads of blobs, each part is written
+ *    (and read) sequentially by its own thread.
+ *
+ * The blobs are read into the blobs created in the vineyard server directly,
+ * without staging buffers, and the metadata is re-created with the new blob
+ * ids on restore.
+ */
+class ObjectSnapshot {
+ public:
+  explicit ObjectSnapshot(Client& client) : client_(client) {}
+
+  /**
+   * @brief Dump the object to the location with `concurrency` writers, all
+   * blobs of the object must be local to the connected vineyard server.
+   */
+  Status Dump(const ObjectID object_id, const std::string& location,
+              const int concurrency = 1);
+
+  /**
+   * @brief Restore the object from the snapshot with `concurrency` readers,
+   * the id of the restored object is returned by `object_id`.
+   */
+  Status Restore(const std::string& location, ObjectID& object_id,
+                 const int concurrency = 1);
+
+ private:
+  struct BlobEntry {
+    int part;
+    size_t offset;
+    size_t size;
+  };
+
+  void collectBlobs(const ptree& meta_tree, std::vector<ObjectID>& blob_ids);
+
+  Status writeMeta(const std::string& location, const ptree& root);
+
+  Status readMeta(const std::string& location, ptree& root);
+
+  Status writePart(const std::string& location, const int part,
+                   const std::vector<std::shared_ptr<Blob>>& blobs);
+
+  Status readPart(const std::string& location, const int part,
+                  const std::vector<std::pair<ObjectID, BlobEntry>>& blobs,
+                  std::unordered_map<ObjectID, ObjectID>& blob_id_map);
+
+  Status createObject(ptree& meta_tree, ObjectID& object_id);
+
+  Client& client_;
+  // the ids of the recreated objects and blobs, old id -> new id
+  std::unordered_map<ObjectID, ObjectID> object_id_map_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_MIGRATE_OBJECT_SNAPSHOT_H_
@@ -17,6 +17,9 @@ limitations under the License.
 
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "boost/algorithm/string.hpp"
 
@@ -32,11 +35,42 @@ MigrateActionType ParseMigrateAction(const std::string& str_type) {
     return MigrateActionType::SendObjectRequest;
   } else if (str_type == "send_blob_buffer_request") {
     return MigrateActionType::SendBlobBufferRequest;
+  } else if (str_type == "send_blob_list_request") {
+    return MigrateActionType::SendBlobListRequest;
+  } else if (str_type == "send_remote_blob_list_request") {
+    return MigrateActionType::SendRemoteBlobListRequest;
+  } else if (str_type == "rdma_connect_reply") {
+    return MigrateActionType::RDMAConnectReply;
+  } else if (str_type == "rdma_ready_request") {
+    return MigrateActionType::RDMAReadyRequest;
+  } else if (str_type == "rdma_read_done_reply") {
+    return MigrateActionType::RDMAReadDoneReply;
+  } else if (str_type == "send_blob_hashes_request") {
+    return MigrateActionType::SendBlobHashesRequest;
+  } else if (str_type == "blob_hashes_reply") {
+    return MigrateActionType::BlobHashesReply;
+  } else if (str_type == "query_blobs_request") {
+    return MigrateActionType::QueryBlobsRequest;
+  } else if (str_type == "query_blobs_reply") {
+    return MigrateActionType::QueryBlobsReply;
   } else {
     return MigrateActionType::NullAction;
   }
 }
 
+#define CHECK_MIGRATE_ERROR(tree, type)                            \
+  do {                                                             \
+    auto stcode = tree.get_optional<int>("code");                  \
+    if (stcode) {                                                  \
+      Status st = Status(static_cast<StatusCode>(stcode.get()),    \
+                         tree.get<std::string>("message", ""));    \
+      if (!st.ok()) {                                              \
+        return st;                                                 \
+      }                                                            \
+    }                                                              \
+    RETURN_ON_ASSERT(tree.get<std::string>("type", "") == (type)); \
+  } while (0)
+
 static inline void encode_msg(const ptree& root, std::string& msg) {
   std::stringstream ss;
   bpt::write_json(ss, root, false);
@@ -88,4 +122,216 @@ Status ReadSendBlobBufferRequest(const ptree& root, ObjectID& blob_id,
   return Status::OK();
 }
 
+void WriteSendBlobListRequest(
+    const std::vector<std::pair<ObjectID, size_t>>& blobs,
+    const size_t connections, std::string& msg) {
+  ptree root;
+  root.put("type", "send_blob_list_request");
+  root.put("connections", connections);
+  ptree blob_list;
+  for (auto const& blob : blobs) {
+    ptree entry;
+    entry.put("blob_id", blob.first);
+    entry.put("blob_size", blob.second);
+    blob_list.push_back(std::make_pair("", entry));
+  }
+  root.add_child("blobs", blob_list);
+  encode_msg(root, msg);
+}
+
+Status ReadSendBlobListRequest(const ptree& root,
+                               std::vector<std::pair<ObjectID, size_t>>& blobs,
+                               size_t& connections) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "send_blob_list_request");
+  connections = root.get<size_t>("connections");
+  blobs.clear();
+  // an empty array is written as an empty string by write_json
+  for (auto const& item : root.get_child("blobs", ptree())) {
+    blobs.emplace_back(item.second.get<ObjectID>("blob_id"),
+                       item.second.get<size_t>("blob_size"));
+  }
+  return Status::OK();
+}
+
+void WriteSendRemoteBlobListRequest(
+    const std::vector<std::pair<ObjectID, size_t>>& blobs,
+    const std::vector<std::pair<uint64_t, uint32_t>>& addresses,
+    const RDMAQueueInfo& queue, std::string& msg) {
+  ptree root;
+  root.put("type", "send_remote_blob_list_request");
+  ptree queue_tree;
+  queue.ToJSON(queue_tree);
+  root.add_child("queue", queue_tree);
+  ptree blob_list;
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    ptree entry;
+    entry.put("blob_id", blobs[i].first);
+    entry.put("blob_size", blobs[i].second);
+    entry.put("address", addresses[i].first);
+    entry.put("rkey", addresses[i].second);
+    blob_list.push_back(std::make_pair("", entry));
+  }
+  root.add_child("blobs", blob_list);
+  encode_msg(root, msg);
+}
+
+Status ReadSendRemoteBlobListRequest(
+    const ptree& root, std::vector<std::pair<ObjectID, size_t>>& blobs,
+    std::vector<std::pair<uint64_t, uint32_t>>& addresses,
+    RDMAQueueInfo& queue) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "send_remote_blob_list_request");
+  RETURN_ON_ERROR(queue.FromJSON(root.get_child("queue")));
+  blobs.clear();
+  addresses.clear();
+  for (auto const& item : root.get_child("blobs", ptree())) {
+    blobs.emplace_back(item.second.get<ObjectID>("blob_id"),
+                       item.second.get<size_t>("blob_size"));
+    addresses.emplace_back(item.second.get<uint64_t>("address"),
+                           item.second.get<uint32_t>("rkey"));
+  }
+  return Status::OK();
+}
+
+void WriteRDMAConnectReply(const RDMAQueueInfo& queue, std::string& msg) {
+  ptree root;
+  root.put("type", "rdma_connect_reply");
+  ptree queue_tree;
+  queue.ToJSON(queue_tree);
+  root.add_child("queue", queue_tree);
+  encode_msg(root, msg);
+}
+
+Status ReadRDMAConnectReply(const ptree& root, RDMAQueueInfo& queue) {
+  CHECK_MIGRATE_ERROR(root, "rdma_connect_reply");
+  return queue.FromJSON(root.get_child("queue"));
+}
+
+void WriteRDMAReadyRequest(std::string& msg) {
+  ptree root;
+  root.put("type", "rdma_ready_request");
+  encode_msg(root, msg);
+}
+
+Status ReadRDMAReadyRequest(const ptree& root) {
+  CHECK_MIGRATE_ERROR(root, "rdma_ready_request");
+  return Status::OK();
+}
+
+void WriteRDMAReadDoneReply(std::string& msg) {
+  ptree root;
+  root.put("type", "rdma_read_done_reply");
+  encode_msg(root, msg);
+}
+
+Status ReadRDMAReadDoneReply(const ptree& root) {
+  CHECK_MIGRATE_ERROR(root, "rdma_read_done_reply");
+  return Status::OK();
+}
+
+void WriteSendBlobHashesRequest(const std::vector<BlobHash>& blobs,
+                                std::string& msg) {
+  ptree root;
+  root.put("type", "send_blob_hashes_request");
+  ptree blob_list;
+  for (auto const& blob : blobs) {
+    ptree entry;
+    entry.put("blob_id", blob.blob_id);
+    entry.put("blob_size", blob.size);
+    entry.put("hash", blob.hash);
+    blob_list.push_back(std::make_pair("", entry));
+  }
+  root.add_child("blobs", blob_list);
+  encode_msg(root, msg);
+}
+
+Status ReadSendBlobHashesRequest(const ptree& root,
+                                 std::vector<BlobHash>& blobs) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "send_blob_hashes_request");
+  blobs.clear();
+  for (auto const& item : root.get_child("blobs", ptree())) {
+    blobs.emplace_back(BlobHash{item.second.get<ObjectID>("blob_id"),
+                                item.second.get<size_t>("blob_size"),
+                                item.second.get<std::string>("hash")});
+  }
+  return Status::OK();
+}
+
+static inline void put_blob_pairs(
+    const std::vector<std::pair<ObjectID, ObjectID>>& blobs, ptree& root) {
+  ptree blob_list;
+  for (auto const& blob : blobs) {
+    ptree entry;
+    entry.put("blob_id", blob.first);
+    entry.put("target_id", blob.second);
+    blob_list.push_back(std::make_pair("", entry));
+  }
+  root.add_child("blobs", blob_list);
+}
+
+static inline void get_blob_pairs(
+    const ptree& root, std::vector<std::pair<ObjectID, ObjectID>>& blobs) {
+  blobs.clear();
+  for (auto const& item : root.get_child("blobs", ptree())) {
+    blobs.emplace_back(item.second.get<ObjectID>("blob_id"),
+                       item.second.get<ObjectID>("target_id"));
+  }
+}
+
+void WriteBlobHashesReply(
+    const std::vector<std::pair<ObjectID, ObjectID>>& existing,
+    std::string& msg) {
+  ptree root;
+  root.put("type", "blob_hashes_reply");
+  put_blob_pairs(existing, root);
+  encode_msg(root, msg);
+}
+
+Status ReadBlobHashesReply(
+    const ptree& root, std::vector<std::pair<ObjectID, ObjectID>>& existing) {
+  CHECK_MIGRATE_ERROR(root, "blob_hashes_reply");
+  get_blob_pairs(root, existing);
+  return Status::OK();
+}
+
+void WriteQueryBlobsRequest(const std::vector<ObjectID>& blobs,
+                            std::string& msg) {
+  ptree root;
+  root.put("type", "query_blobs_request");
+  ptree blob_list;
+  for (auto const& blob : blobs) {
+    ptree entry;
+    entry.put("", blob);
+    blob_list.push_back(std::make_pair("", entry));
+  }
+  root.add_child("blobs", blob_list);
+  encode_msg(root, msg);
+}
+
+Status ReadQueryBlobsRequest(const ptree& root, std::vector<ObjectID>& blobs) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "query_blobs_request");
+  blobs.clear();
+  for (auto const& item : root.get_child("blobs", ptree())) {
+    blobs.emplace_back(item.second.get_value<ObjectID>());
+  }
+  return Status::OK();
+}
+
+void WriteQueryBlobsReply(
+    const std::vector<std::pair<ObjectID, ObjectID>>& landed,
+    std::string& msg) {
+  ptree root;
+  root.put("type", "query_blobs_reply");
+  put_blob_pairs(landed, root);
+  encode_msg(root, msg);
+}
+
+Status ReadQueryBlobsReply(const ptree& root,
+                           std::vector<std::pair<ObjectID, ObjectID>>& landed) {
+  CHECK_MIGRATE_ERROR(root, "query_blobs_reply");
+  get_blob_pairs(root, landed);
+  return Status::OK();
+}
+
 }  // namespace vineyard
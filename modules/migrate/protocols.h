@@ -17,10 +17,13 @@ limitations under the License.
 #define MODULES_MIGRATE_PROTOCOLS_H_
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/util/boost.h"
 #include "common/util/status.h"
 #include "common/util/uuid.h"
+#include "migrate/rdma_transport.h"
 
 namespace vineyard {
 
@@ -30,6 +33,22 @@ enum class MigrateActionType {
   ExitReply = 2,
   SendObjectRequest = 3,
   SendBlobBufferRequest = 4,
+  SendBlobListRequest = 5,
+  SendRemoteBlobListRequest = 6,
+  RDMAConnectReply = 7,
+  RDMAReadyRequest = 8,
+  RDMAReadDoneReply = 9,
+  SendBlobHashesRequest = 10,
+  BlobHashesReply = 11,
+  QueryBlobsRequest = 12,
+  QueryBlobsReply = 13,
+};
+
+/** The content hash of a blob to migrate, see also `Blob::ContentHash`. */
+struct BlobHash {
+  ObjectID blob_id;
+  size_t size;
+  std::string hash;
 };
 
 MigrateActionType ParseMigrateAction(const std::string& str_type);
@@ -50,6 +69,80 @@ void WriteSendBlobBufferRequest(const ObjectID blob_id, const size_t blob_size,
 Status ReadSendBlobBufferRequest(const ptree& root, ObjectID& blob_id,
                                  size_t& blob_size);
 
+/**
+ * The blobs (and their sizes) to transfer, whose buffers follow on
+ * `connections` parallel connections, see also `ObjectMigration`.
+ */
+void WriteSendBlobListRequest(
+    const std::vector<std::pair<ObjectID, size_t>>& blobs,
+    const size_t connections, std::string& msg);
+
+Status ReadSendBlobListRequest(const ptree& root,
+                               std::vector<std::pair<ObjectID, size_t>>& blobs,
+                               size_t& connections);
+
+/**
+ * The blobs to transfer by one-sided RDMA reads, i.e., their sizes, the
+ * addresses and the rkeys of their buffers, and the queue pair of the sender,
+ * see also `ObjectMigration`.
+ */
+void WriteSendRemoteBlobListRequest(
+    const std::vector<std::pair<ObjectID, size_t>>& blobs,
+    const std::vector<std::pair<uint64_t, uint32_t>>& addresses,
+    const RDMAQueueInfo& queue, std::string& msg);
+
+Status ReadSendRemoteBlobListRequest(
+    const ptree& root, std::vector<std::pair<ObjectID, size_t>>& blobs,
+    std::vector<std::pair<uint64_t, uint32_t>>& addresses,
+    RDMAQueueInfo& queue);
+
+void WriteRDMAConnectReply(const RDMAQueueInfo& queue, std::string& msg);
+
+Status ReadRDMAConnectReply(const ptree& root, RDMAQueueInfo& queue);
+
+void WriteRDMAReadyRequest(std::string& msg);
+
+Status ReadRDMAReadyRequest(const ptree& root);
+
+void WriteRDMAReadDoneReply(std::string& msg);
+
+Status ReadRDMAReadDoneReply(const ptree& root);
+
+/**
+ * The hashes of the blobs to migrate, the receiver replies the blobs that
+ * already exist on the target instance, i.e., pairs of the blob and the
+ * existing blob with the same content.
+ */
+void WriteSendBlobHashesRequest(const std::vector<BlobHash>& blobs,
+                                std::string& msg);
+
+Status ReadSendBlobHashesRequest(const ptree& root,
+                                 std::vector<BlobHash>& blobs);
+
+void WriteBlobHashesReply(
+    const std::vector<std::pair<ObjectID, ObjectID>>& existing,
+    std::string& msg);
+
+Status ReadBlobHashesReply(
+    const ptree& root, std::vector<std::pair<ObjectID, ObjectID>>& existing);
+
+/**
+ * The blobs to migrate, the receiver replies the blobs that have landed in
+ * the previous runs, by the checkpoint of the migration, i.e., pairs of the
+ * blob and the blob on the target instance.
+ */
+void WriteQueryBlobsRequest(const std::vector<ObjectID>& blobs,
+                            std::string& msg);
+
+Status ReadQueryBlobsRequest(const ptree& root, std::vector<ObjectID>& blobs);
+
+void WriteQueryBlobsReply(
+    const std::vector<std::pair<ObjectID, ObjectID>>& landed,
+    std::string& msg);
+
+Status ReadQueryBlobsReply(const ptree& root,
+                           std::vector<std::pair<ObjectID, ObjectID>>& landed);
+
 }  // namespace vineyard
 
 #endif  // MODULES_MIGRATE_PROTOCOLS_H_
@@ -0,0 +1,376 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "migrate/rdma_transport.h"
+
+#if defined(RDMA_ENABLED)
+#include <infiniband/verbs.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace vineyard {
+
+void RDMAQueueInfo::ToJSON(ptree& tree) const {
+  tree.put("lid", lid);
+  tree.put("qpn", qpn);
+  tree.put("psn", psn);
+  tree.put("gid", gid);
+}
+
+Status RDMAQueueInfo::FromJSON(const ptree& tree) {
+  lid = tree.get<uint32_t>("lid");
+  qpn = tree.get<uint32_t>("qpn");
+  psn = tree.get<uint32_t>("psn");
+  gid = tree.get<std::string>("gid", "");
+  RETURN_ON_ASSERT(gid.empty() || gid.size() == 32, "Invalid GID: " + gid);
+  return Status::OK();
+}
+
+#if defined(RDMA_ENABLED)
+
+namespace {
+
+// the depth of the send queue and the completion queue, i.e., the reads in
+// flight
+constexpr uint32_t kMaxOutstandingReads = 64;
+
+// a read larger than the maximum message of the port is split
+constexpr size_t kMaxReadSize = 1024 * 1024 * 1024;
+
+Status verbsError(const std::string& action, int err) {
+  return Status::IOError("Failed to " + action + ": " + std::strerror(err));
+}
+
+std::string encodeGid(const ibv_gid& gid) {
+  char encoded[33] = {0};
+  for (int i = 0; i < 16; ++i) {
+    snprintf(encoded + i * 2, sizeof(encoded) - i * 2, "%02x", gid.raw[i]);
+  }
+  return std::string(encoded, 32);
+}
+
+void decodeGid(const std::string& encoded, ibv_gid& gid) {
+  for (int i = 0; i < 16; ++i) {
+    gid.raw[i] = static_cast<uint8_t>(
+        std::stoul(encoded.substr(i * 2, 2), nullptr, 16));
+  }
+}
+
+}  // namespace
+
+RDMAEndpoint::~RDMAEndpoint() {
+  for (auto& region : regions_) {
+    ibv_dereg_mr(region.second.mr);
+  }
+  if (qp_ != nullptr) {
+    ibv_destroy_qp(qp_);
+  }
+  if (cq_ != nullptr) {
+    ibv_destroy_cq(cq_);
+  }
+  if (pd_ != nullptr) {
+    ibv_dealloc_pd(pd_);
+  }
+  if (context_ != nullptr) {
+    ibv_close_device(context_);
+  }
+}
+
+Status RDMAEndpoint::Open(const std::string& device, const int port,
+                          const int gid_index,
+                          std::unique_ptr<RDMAEndpoint>& endpoint) {
+  int num_devices = 0;
+  ibv_device** devices = ibv_get_device_list(&num_devices);
+  if (devices == nullptr) {
+    return verbsError("list the RDMA devices", errno);
+  }
+  std::unique_ptr<RDMAEndpoint> opened(new RDMAEndpoint());
+  for (int i = 0; i < num_devices; ++i) {
+    if (device.empty() || device == ibv_get_device_name(devices[i])) {
+      opened->context_ = ibv_open_device(devices[i]);
+      break;
+    }
+  }
+  ibv_free_device_list(devices);
+  if (opened->context_ == nullptr) {
+    return Status::IOError("Failed to open the RDMA device '" + device + "'");
+  }
+  opened->port_ = port;
+  opened->gid_index_ = gid_index;
+
+  ibv_device_attr device_attr;
+  ibv_port_attr port_attr;
+  if (ibv_query_device(opened->context_, &device_attr) != 0) {
+    return verbsError("query the RDMA device", errno);
+  }
+  if (ibv_query_port(opened->context_, port, &port_attr) != 0) {
+    return verbsError("query the port " + std::to_string(port), errno);
+  }
+  opened->local_.lid = port_attr.lid;
+  if (gid_index >= 0) {
+    ibv_gid gid;
+    if (ibv_query_gid(opened->context_, port, gid_index, &gid) != 0) {
+      return verbsError("query the GID " + std::to_string(gid_index), errno);
+    }
+    // an all-zero GID means the port is InfiniBand without GRH
+    static const uint8_t zeros[16] = {0};
+    if (memcmp(gid.raw, zeros, sizeof(zeros)) != 0) {
+      opened->local_.gid = encodeGid(gid);
+    }
+  }
+  opened->max_outstanding_ =
+      std::max(1u, std::min(kMaxOutstandingReads,
+                            static_cast<uint32_t>(device_attr.max_qp_wr)));
+
+  opened->pd_ = ibv_alloc_pd(opened->context_);
+  if (opened->pd_ == nullptr) {
+    return verbsError("allocate the protection domain", errno);
+  }
+  opened->cq_ = ibv_create_cq(opened->context_, opened->max_outstanding_,
+                              nullptr, nullptr, 0);
+  if (opened->cq_ == nullptr) {
+    return verbsError("create the completion queue", errno);
+  }
+  ibv_qp_init_attr qp_init_attr;
+  memset(&qp_init_attr, 0, sizeof(qp_init_attr));
+  qp_init_attr.send_cq = opened->cq_;
+  qp_init_attr.recv_cq = opened->cq_;
+  qp_init_attr.qp_type = IBV_QPT_RC;
+  qp_init_attr.sq_sig_all = 1;
+  qp_init_attr.cap.max_send_wr = opened->max_outstanding_;
+  qp_init_attr.cap.max_recv_wr = 1;
+  qp_init_attr.cap.max_send_sge = 1;
+  qp_init_attr.cap.max_recv_sge = 1;
+  opened->qp_ = ibv_create_qp(opened->pd_, &qp_init_attr);
+  if (opened->qp_ == nullptr) {
+    return verbsError("create the queue pair", errno);
+  }
+
+  ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_INIT;
+  attr.pkey_index = 0;
+  attr.port_num = port;
+  attr.qp_access_flags = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ;
+  if (ibv_modify_qp(opened->qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT |
+                        IBV_QP_ACCESS_FLAGS) != 0) {
+    return verbsError("initialize the queue pair", errno);
+  }
+  opened->local_.qpn = opened->qp_->qp_num;
+  opened->local_.psn = std::random_device()() & 0xffffff;
+  endpoint = std::move(opened);
+  return Status::OK();
+}
+
+Status RDMAEndpoint::Connect(const RDMAQueueInfo& remote) {
+  ibv_port_attr port_attr;
+  if (ibv_query_port(context_, port_, &port_attr) != 0) {
+    return verbsError("query the port " + std::to_string(port_), errno);
+  }
+  ibv_device_attr device_attr;
+  if (ibv_query_device(context_, &device_attr) != 0) {
+    return verbsError("query the RDMA device", errno);
+  }
+
+  ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTR;
+  attr.path_mtu = port_attr.active_mtu;
+  attr.dest_qp_num = remote.qpn;
+  attr.rq_psn = remote.psn;
+  attr.max_dest_rd_atomic = std::max(1, device_attr.max_qp_rd_atom);
+  attr.min_rnr_timer = 12;
+  attr.ah_attr.dlid = remote.lid;
+  attr.ah_attr.sl = 0;
+  attr.ah_attr.src_path_bits = 0;
+  attr.ah_attr.port_num = port_;
+  if (!remote.gid.empty()) {
+    // RoCE, or InfiniBand across subnets
+    attr.ah_attr.is_global = 1;
+    decodeGid(remote.gid, attr.ah_attr.grh.dgid);
+    attr.ah_attr.grh.sgid_index = std::max(gid_index_, 0);
+    attr.ah_attr.grh.hop_limit = 1;
+  }
+  if (ibv_modify_qp(qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU |
+                        IBV_QP_DEST_QPN | IBV_QP_RQ_PSN |
+                        IBV_QP_MAX_DEST_RD_ATOMIC | IBV_QP_MIN_RNR_TIMER) !=
+      0) {
+    return verbsError("move the queue pair to RTR", errno);
+  }
+
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTS;
+  attr.timeout = 14;
+  attr.retry_cnt = 7;
+  attr.rnr_retry = 7;
+  attr.sq_psn = local_.psn;
+  attr.max_rd_atomic = std::max(1, device_attr.max_qp_init_rd_atom);
+  if (ibv_modify_qp(qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT |
+                        IBV_QP_RNR_RETRY | IBV_QP_SQ_PSN |
+                        IBV_QP_MAX_QP_RD_ATOMIC) != 0) {
+    return verbsError("move the queue pair to RTS", errno);
+  }
+  return Status::OK();
+}
+
+Status RDMAEndpoint::Register(uint8_t* base, const size_t size,
+                              const bool writable, uint32_t& lkey,
+                              uint32_t& rkey) {
+  auto iter = regions_.find(base);
+  if (iter != regions_.end() && iter->second.size >= size &&
+      (iter->second.writable || !writable)) {
+    lkey = iter->second.mr->lkey;
+    rkey = iter->second.mr->rkey;
+    return Status::OK();
+  }
+  int access = IBV_ACCESS_REMOTE_READ;
+  if (writable || (iter != regions_.end() && iter->second.writable)) {
+    access |= IBV_ACCESS_LOCAL_WRITE;
+  }
+  ibv_mr* mr = ibv_reg_mr(pd_, base, size, access);
+  if (mr == nullptr) {
+    return verbsError("register the memory region of " + std::to_string(size) +
+                          " bytes",
+                      errno);
+  }
+  if (iter != regions_.end()) {
+    ibv_dereg_mr(iter->second.mr);
+  }
+  regions_[base] = Region{size, (access & IBV_ACCESS_LOCAL_WRITE) != 0, mr};
+  VLOG(2) << "Registered the memory region of " << size << " bytes";
+  lkey = mr->lkey;
+  rkey = mr->rkey;
+  return Status::OK();
+}
+
+Status RDMAEndpoint::Read(const std::vector<RDMARead>& reads) {
+  size_t outstanding = 0;
+  for (auto const& read : reads) {
+    uint32_t lkey = 0;
+    RETURN_ON_ERROR(lookup(read.local, read.size, lkey));
+    for (size_t offset = 0; offset < read.size; offset += kMaxReadSize) {
+      if (outstanding == max_outstanding_) {
+        RETURN_ON_ERROR(poll(1));
+        outstanding -= 1;
+      }
+      ibv_sge sge;
+      sge.addr = reinterpret_cast<uint64_t>(read.local + offset);
+      sge.length =
+          static_cast<uint32_t>(std::min(kMaxReadSize, read.size - offset));
+      sge.lkey = lkey;
+      ibv_send_wr wr, *bad_wr = nullptr;
+      memset(&wr, 0, sizeof(wr));
+      wr.sg_list = &sge;
+      wr.num_sge = 1;
+      wr.opcode = IBV_WR_RDMA_READ;
+      wr.send_flags = IBV_SEND_SIGNALED;
+      wr.wr.rdma.remote_addr = read.remote + offset;
+      wr.wr.rdma.rkey = read.rkey;
+      int err = ibv_post_send(qp_, &wr, &bad_wr);
+      if (err != 0) {
+        return verbsError("post the RDMA read", err);
+      }
+      outstanding += 1;
+    }
+  }
+  return poll(outstanding);
+}
+
+Status RDMAEndpoint::lookup(const uint8_t* address, const size_t size,
+                            uint32_t& lkey) {
+  auto iter = regions_.upper_bound(address);
+  if (iter != regions_.begin()) {
+    --iter;
+    if (iter->second.writable &&
+        address + size <= iter->first + iter->second.size) {
+      lkey = iter->second.mr->lkey;
+      return Status::OK();
+    }
+  }
+  return Status::Invalid(
+      "The destination of the RDMA read isn't in a registered region");
+}
+
+Status RDMAEndpoint::poll(const size_t count) {
+  ibv_wc wc[16];
+  size_t done = 0;
+  while (done < count) {
+    int polled = ibv_poll_cq(
+        cq_, static_cast<int>(std::min<size_t>(16, count - done)), wc);
+    if (polled < 0) {
+      return Status::IOError("Failed to poll the completion queue");
+    }
+    for (int i = 0; i < polled; ++i) {
+      if (wc[i].status != IBV_WC_SUCCESS) {
+        return Status::IOError(std::string("The RDMA read failed: ") +
+                               ibv_wc_status_str(wc[i].status));
+      }
+    }
+    done += polled;
+  }
+  return Status::OK();
+}
+
+#else
+
+RDMAEndpoint::~RDMAEndpoint() {}
+
+Status RDMAEndpoint::Open(const std::string& device, const int port,
+                          const int gid_index,
+                          std::unique_ptr<RDMAEndpoint>& endpoint) {
+  return Status::NotImplemented(
+      "vineyard-migrate is built without RDMA support, please rebuild with "
+      "'-DBUILD_VINEYARD_MIGRATE_RDMA=ON'");
+}
+
+Status RDMAEndpoint::Connect(const RDMAQueueInfo& remote) {
+  return Status::NotImplemented("RDMA is not supported");
+}
+
+Status RDMAEndpoint::Register(uint8_t* base, const size_t size,
+                              const bool writable, uint32_t& lkey,
+                              uint32_t& rkey) {
+  return Status::NotImplemented("RDMA is not supported");
+}
+
+Status RDMAEndpoint::Read(const std::vector<RDMARead>& reads) {
+  return Status::NotImplemented("RDMA is not supported");
+}
+
+Status RDMAEndpoint::lookup(const uint8_t* address, const size_t size,
+                            uint32_t& lkey) {
+  return Status::NotImplemented("RDMA is not supported");
+}
+
+Status RDMAEndpoint::poll(const size_t count) {
+  return Status::NotImplemented("RDMA is not supported");
+}
+
+#endif  // RDMA_ENABLED
+
+}  // namespace vineyard
@@ -0,0 +1,130 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_MIGRATE_RDMA_TRANSPORT_H_
+#define MODULES_MIGRATE_RDMA_TRANSPORT_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/util/boost.h"
+#include "common/util/status.h"
+
+struct ibv_context;
+struct ibv_pd;
+struct ibv_cq;
+struct ibv_qp;
+struct ibv_mr;
+
+namespace vineyard {
+
+/**
+ * @brief The address of a reliable connected queue pair, exchanged over the
+ * TCP control connection before the queue pairs are connected.
+ */
+struct RDMAQueueInfo {
+  uint32_t lid = 0;
+  uint32_t qpn = 0;
+  uint32_t psn = 0;
+  // the 16 bytes of the GID in hex, empty if the port has no GID
+  std::string gid;
+
+  void ToJSON(ptree& tree) const;
+
+  Status FromJSON(const ptree& tree);
+};
+
+/** A contiguous one-sided read from the remote memory into the local one. */
+struct RDMARead {
+  uint8_t* local;
+  uint64_t remote;
+  uint32_t rkey;
+  size_t size;
+};
+
+/**
+ * @brief RDMAEndpoint is one end of a reliable connected queue pair on an
+ * ibverbs device, through which the memory of the store is read one-sided.
+ *
+ * The memory is registered per mapped segment of the store, i.e., the whole
+ * memory arena of vineyardd mapped to the client, rather than per blob, and
+ * the registrations are cached in the endpoint, see also
+ * `Client::GetMappedSegment`.
+ *
+ * It is only functional when vineyard-migrate is built with
+ * `BUILD_VINEYARD_MIGRATE_RDMA`, otherwise `Open` returns
+ * `Status::NotImplemented`.
+ */
+class RDMAEndpoint {
+ public:
+  ~RDMAEndpoint();
+
+  /**
+   * @brief Open the device (the first one if `device` is empty) and create
+   * the queue pair on the port.
+   */
+  static Status Open(const std::string& device, const int port,
+                     const int gid_index,
+                     std::unique_ptr<RDMAEndpoint>& endpoint);
+
+  const RDMAQueueInfo& LocalInfo() const { return local_; }
+
+  /** Move the queue pair to RTS, connected to the remote one. */
+  Status Connect(const RDMAQueueInfo& remote);
+
+  /**
+   * @brief Register the segment, `writable` for the destination of reads,
+   * otherwise for remote reads. The segment is registered only once.
+   */
+  Status Register(uint8_t* base, const size_t size, const bool writable,
+                  uint32_t& lkey, uint32_t& rkey);
+
+  /**
+   * @brief Issue the reads and wait for their completion. The local memory
+   * must be within the registered writable segments.
+   */
+  Status Read(const std::vector<RDMARead>& reads);
+
+ private:
+  RDMAEndpoint() = default;
+
+  struct Region {
+    size_t size;
+    bool writable;
+    ibv_mr* mr;
+  };
+
+  Status lookup(const uint8_t* address, const size_t size, uint32_t& lkey);
+
+  Status poll(const size_t count);
+
+  ibv_context* context_ = nullptr;
+  ibv_pd* pd_ = nullptr;
+  ibv_cq* cq_ = nullptr;
+  ibv_qp* qp_ = nullptr;
+  int port_ = 1;
+  int gid_index_ = 0;
+  uint32_t max_outstanding_ = 1;
+  RDMAQueueInfo local_;
+  // the registered segments, by their bases
+  std::map<const uint8_t*, Region> regions_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_MIGRATE_RDMA_TRANSPORT_H_
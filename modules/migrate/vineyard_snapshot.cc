@@ -0,0 +1,57 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <signal.h>
+
+#include <iostream>
+
+#include "client/client.h"
+#include "common/util/flags.h"
+#include "common/util/logging.h"
+#include "io/io/io_factory.h"
+#include "migrate/flags.h"
+#include "migrate/object_snapshot.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char* argv[]) {
+  sigset(SIGINT, SIG_DFL);
+  FLAGS_stderrthreshold = 0;
+  flags::SetUsageMessage(
+      "Usage: vineyard_snapshot --ipc_socket <socket> --snapshot_location "
+      "<location> [--object_list <object id> | --restore]");
+  flags::ParseCommandLineFlags(&argc, &argv, true);
+  logging::InitGoogleLogging("vineyard_snapshot");
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(FLAGS_ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << FLAGS_ipc_socket;
+
+  IOFactory::Init();
+  ObjectSnapshot snapshot(client);
+  if (FLAGS_restore) {
+    ObjectID object_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(snapshot.Restore(FLAGS_snapshot_location, object_id,
+                                       FLAGS_snapshot_concurrency));
+    VINEYARD_CHECK_OK(client.Persist(object_id));
+    std::cout << VYObjectIDToString(object_id) << std::endl;
+  } else {
+    VINEYARD_CHECK_OK(snapshot.Dump(VYObjectIDFromString(FLAGS_object_list),
+                                    FLAGS_snapshot_location,
+                                    FLAGS_snapshot_concurrency));
+  }
+  IOFactory::Finalize();
+  return 0;
+}
@@ -13,7 +13,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
@@ -22,6 +32,7 @@ limitations under the License.
 #include "client/client.h"
 #include "client/ds/blob.h"
 #include "client/rpc_client.h"
+#include "common/util/functions.h"
 #include "common/util/status.h"
 #pragma GCC visibility pop
 
@@ -100,6 +111,270 @@ class ClientManager {
   std::unordered_map<std::string, std::shared_ptr<ClientType>> client_set_;
 };
 
+namespace {
+
+size_t AlignToArena(size_t size) {
+  return (size + BlobArena::kAlignment - 1) / BlobArena::kAlignment *
+         BlobArena::kAlignment;
+}
+
+bool IsCContiguous(py::buffer_info const& info) {
+  ssize_t expected = info.itemsize;
+  for (ssize_t dim = info.ndim - 1; dim >= 0; --dim) {
+    if (info.shape[dim] > 1 && info.strides[dim] != expected) {
+      return false;
+    }
+    expected *= info.shape[dim];
+  }
+  return true;
+}
+
+struct CopyTask {
+  uint8_t* target;
+  const uint8_t* source;
+  size_t rows;
+  size_t itemsize;
+  ssize_t stride;
+};
+
+/**
+ * Run the copy tasks in `concurrency` threads (defaults to the number of
+ * cores), the tasks are taken from a shared counter.
+ */
+void ParallelCopy(std::vector<CopyTask> const& tasks, size_t concurrency) {
+  if (concurrency == 0) {
+    concurrency = std::thread::hardware_concurrency();
+  }
+  concurrency = std::max<size_t>(1, std::min(concurrency, tasks.size()));
+  std::atomic_size_t next{0};
+  auto copy = [&tasks, &next]() {
+    for (size_t idx = next++; idx < tasks.size(); idx = next++) {
+      auto const& task = tasks[idx];
+      if (task.stride == static_cast<ssize_t>(task.itemsize)) {
+        std::memcpy(task.target, task.source, task.rows * task.itemsize);
+      } else {
+        for (size_t row = 0; row < task.rows; ++row) {
+          std::memcpy(task.target + row * task.itemsize,
+                      task.source + row * task.stride, task.itemsize);
+        }
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t idx = 1; idx < concurrency; ++idx) {
+    threads.emplace_back(copy);
+  }
+  copy();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+/**
+ * Copy the contiguous buffers (e.g., numpy arrays) to blobs allocated from a
+ * single arena, i.e., by a single request, rather than a request for each
+ * buffer. The copy runs in `concurrency` threads, invokers must release the
+ * GIL.
+ */
+Status CreateBlobsFromBuffers(Client& client,
+                              std::vector<py::buffer_info> const& buffers,
+                              size_t concurrency,
+                              std::vector<std::shared_ptr<Blob>>& blobs) {
+  size_t capacity = 0;
+  for (auto const& buffer : buffers) {
+    capacity += AlignToArena(buffer.size * buffer.itemsize);
+  }
+  std::unique_ptr<BlobArena> arena;
+  if (capacity > 0) {
+    RETURN_ON_ERROR(client.CreateBlobArena(capacity, arena));
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers(buffers.size());
+  std::vector<CopyTask> tasks;
+  for (size_t index = 0; index < buffers.size(); ++index) {
+    size_t size = buffers[index].size * buffers[index].itemsize;
+    if (size == 0) {
+      continue;
+    }
+    RETURN_ON_ERROR(arena->Allocate(size, writers[index]));
+    tasks.emplace_back(CopyTask{
+        reinterpret_cast<uint8_t*>(writers[index]->data()),
+        static_cast<const uint8_t*>(buffers[index].ptr), 1, size,
+        static_cast<ssize_t>(size)});
+  }
+  ParallelCopy(tasks, concurrency);
+
+  if (arena) {
+    RETURN_ON_ERROR(arena->Seal(client));
+  }
+  std::shared_ptr<Blob> empty_blob;
+  blobs.resize(buffers.size());
+  for (size_t index = 0; index < buffers.size(); ++index) {
+    if (writers[index] == nullptr) {
+      if (empty_blob == nullptr) {
+        empty_blob = Blob::MakeEmpty(client);
+      }
+      blobs[index] = empty_blob;
+    } else {
+      blobs[index] =
+          std::dynamic_pointer_cast<Blob>(writers[index]->Seal(client));
+    }
+  }
+  return Status::OK();
+}
+
+/**
+ * Copy columns of 2-D blocks (in the layout of pandas, i.e., each row of the
+ * block is a column of the dataframe) to blobs allocated from a single arena,
+ * and create a tensor for each column. The copy runs in `concurrency` threads
+ * and the metadata of tensors are created by pipelined requests, invokers
+ * must release the GIL.
+ *
+ * Columns of a block are placed at offsets of the same stride in the arena,
+ * thus the resolver could rebuild the block without copy.
+ */
+Status CreateTensorBlocks(Client& client,
+                          std::vector<py::buffer_info> const& blocks,
+                          std::vector<std::string> const& value_types,
+                          size_t concurrency,
+                          std::vector<std::vector<ObjectID>>& tensors) {
+  if (blocks.size() != value_types.size()) {
+    return Status::Invalid("The number of value types doesn't match blocks");
+  }
+  size_t capacity = 0;
+  for (auto const& block : blocks) {
+    if (block.ndim != 2) {
+      return Status::Invalid("The blocks must be 2-dimensional");
+    }
+    capacity +=
+        block.shape[0] * AlignToArena(block.shape[1] * block.itemsize);
+  }
+
+  std::unique_ptr<BlobArena> arena;
+  if (capacity > 0) {
+    RETURN_ON_ERROR(client.CreateBlobArena(capacity, arena));
+  }
+  std::vector<std::vector<std::unique_ptr<BlobWriter>>> writers(blocks.size());
+  std::vector<CopyTask> tasks;
+  for (size_t index = 0; index < blocks.size(); ++index) {
+    auto const& block = blocks[index];
+    size_t rows = block.shape[1], itemsize = block.itemsize;
+    if (rows == 0) {
+      continue;
+    }
+    for (ssize_t column = 0; column < block.shape[0]; ++column) {
+      std::unique_ptr<BlobWriter> writer;
+      RETURN_ON_ERROR(arena->Allocate(rows * itemsize, writer));
+      tasks.emplace_back(CopyTask{
+          reinterpret_cast<uint8_t*>(writer->data()),
+          static_cast<const uint8_t*>(block.ptr) + column * block.strides[0],
+          rows, itemsize, block.strides[1]});
+      writers[index].emplace_back(std::move(writer));
+    }
+  }
+
+  ParallelCopy(tasks, concurrency);
+
+  if (arena) {
+    RETURN_ON_ERROR(arena->Seal(client));
+  }
+  std::shared_ptr<Blob> empty_blob;
+  tensors.resize(blocks.size());
+  for (size_t index = 0; index < blocks.size(); ++index) {
+    auto const& block = blocks[index];
+    size_t rows = block.shape[1];
+    tensors[index].resize(block.shape[0], InvalidObjectID());
+    for (ssize_t column = 0; column < block.shape[0]; ++column) {
+      std::shared_ptr<Blob> blob;
+      if (rows == 0) {
+        if (empty_blob == nullptr) {
+          empty_blob = Blob::MakeEmpty(client);
+        }
+        blob = empty_blob;
+      } else {
+        blob = std::dynamic_pointer_cast<Blob>(
+            writers[index][column]->Seal(client));
+      }
+      ObjectMeta meta;
+      meta.SetTypeName("vineyard::Tensor<" + value_types[index] + ">");
+      meta.AddKeyValue("value_type_", value_types[index]);
+      meta.AddKeyValue("shape_",
+                       std::vector<int64_t>{static_cast<int64_t>(rows)});
+      meta.AddKeyValue("partition_index_", std::vector<int64_t>{});
+      meta.SetNBytes(blob->size());
+      meta.AddMember("buffer_", blob.get());
+      ptree tree = meta.MetaData();
+      tree.put("instance_id", client.instance_id());
+      tree.put("transient", true);
+      ObjectID& tensor = tensors[index][column];
+      RETURN_ON_ERROR(client.CreateDataAsync(
+          tree, [&tensor](Status const& status, ObjectID const id,
+                          InstanceID const) -> Status {
+            RETURN_ON_ERROR(status);
+            tensor = id;
+            return Status::OK();
+          }));
+    }
+  }
+  return client.WaitAll();
+}
+
+/**
+ * Wrap the python callback of asynchronous requests. The callback receives a
+ * function that returns the result, or raises the error of the request. The
+ * GIL is acquired whenever the callback is invoked or released, since it may
+ * happen in any thread that consumes the replies.
+ */
+class AsyncCallback {
+ public:
+  explicit AsyncCallback(py::function const& callback)
+      : callback_(new py::function(callback), [](py::function* fn) {
+          py::gil_scoped_acquire acquire;
+          delete fn;
+        }) {}
+
+  template <typename T>
+  Status operator()(Status const& status, T const& value) const {
+    py::gil_scoped_acquire acquire;
+    return invoke(py::cpp_function([status, value]() -> T {
+      throw_on_error(status);
+      return value;
+    }));
+  }
+
+  Status operator()(Status const& status) const {
+    py::gil_scoped_acquire acquire;
+    return invoke(py::cpp_function([status]() { throw_on_error(status); }));
+  }
+
+ private:
+  Status invoke(py::cpp_function const& result) const {
+    try {
+      (*callback_)(result);
+    } catch (py::error_already_set const& e) {
+      return Status::Invalid(e.what());
+    }
+    return Status::OK();
+  }
+
+  std::shared_ptr<py::function> callback_;
+};
+
+// (id, size, access count, last access, pin count) of blobs
+using blob_access_t =
+    std::tuple<ObjectIDWrapper, int64_t, uint64_t, int64_t, uint64_t>;
+
+std::vector<blob_access_t> toAccessTuples(
+    std::vector<BlobAccess> const& blobs) {
+  std::vector<blob_access_t> stats;
+  for (auto const& blob : blobs) {
+    stats.emplace_back(blob.object_id, blob.data_size, blob.access_count,
+                       blob.last_access, blob.pin_count);
+  }
+  return stats;
+}
+
+}  // namespace
+
 void bind_client(py::module& mod) {
   // ClientBase
   py::class_<ClientBase, std::shared_ptr<ClientBase>>(mod, "ClientBase")
@@ -110,13 +385,27 @@ void bind_client(py::module& mod) {
             throw_on_error(self->CreateMetaData(metadata, object_id));
             return object_id;
           },
-          "metadata"_a)
+          py::call_guard<py::gil_scoped_release>(), "metadata"_a)
+      .def(
+          "create_metadata",
+          [](ClientBase* self, std::vector<ObjectMeta*> const& metadatas)
+              -> std::vector<ObjectIDWrapper> {
+            std::vector<ObjectIDWrapper> object_ids;
+            for (auto metadata : metadatas) {
+              ObjectID object_id;
+              throw_on_error(self->CreateMetaData(*metadata, object_id));
+              object_ids.emplace_back(object_id);
+            }
+            return object_ids;
+          },
+          py::call_guard<py::gil_scoped_release>(), "metadatas"_a)
       .def(
           "delete",
           [](ClientBase* self, const ObjectIDWrapper object_id,
              const bool force, const bool deep) {
             throw_on_error(self->DelData(object_id, force, deep));
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_id"_a, py::arg("force") = false, py::arg("deep") = true)
       .def(
           "delete",
@@ -128,19 +417,105 @@ void bind_client(py::module& mod) {
             }
             throw_on_error(self->DelData(unwrapped_object_ids, force, deep));
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_ids"_a, py::arg("force") = false, py::arg("deep") = true)
       .def(
           "persist",
           [](ClientBase* self, const ObjectIDWrapper object_id) {
             throw_on_error(self->Persist(object_id));
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "persist",
           [](ClientBase* self, const Object* object) {
             throw_on_error(self->Persist(object->id()));
           },
-          "object"_a)
+          py::call_guard<py::gil_scoped_release>(), "object"_a)
+      .def(
+          "persist",
+          [](ClientBase* self, const std::vector<ObjectIDWrapper>& object_ids) {
+            std::vector<ObjectID> unwrapped_object_ids(object_ids.size());
+            for (size_t idx = 0; idx < object_ids.size(); ++idx) {
+              unwrapped_object_ids[idx] = object_ids[idx];
+            }
+            throw_on_error(self->Persist(unwrapped_object_ids));
+          },
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
+      .def(
+          "persist_write_behind",
+          [](ClientBase* self, const std::vector<ObjectIDWrapper>& object_ids) {
+            std::vector<ObjectID> unwrapped_object_ids(object_ids.size());
+            for (size_t idx = 0; idx < object_ids.size(); ++idx) {
+              unwrapped_object_ids[idx] = object_ids[idx];
+            }
+            throw_on_error(self->PersistWriteBehind(unwrapped_object_ids));
+          },
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
+      .def(
+          "flush", [](ClientBase* self) { throw_on_error(self->Flush()); },
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "set_memory_limit",
+          [](ClientBase* self, const size_t limit) {
+            throw_on_error(self->SetMemoryLimit(limit));
+          },
+          py::call_guard<py::gil_scoped_release>(), "limit"_a)
+      .def(
+          "set_tenant_quota",
+          [](ClientBase* self, std::string const& tenant, const size_t quota) {
+            throw_on_error(self->SetTenantQuota(tenant, quota));
+          },
+          py::call_guard<py::gil_scoped_release>(), "tenant"_a, "quota"_a)
+      .def(
+          "hot_objects",
+          [](ClientBase* self,
+             const size_t limit) -> std::vector<blob_access_t> {
+            std::vector<BlobAccess> blobs;
+            throw_on_error(self->HotObjects(limit, blobs));
+            return toAccessTuples(blobs);
+          },
+          py::call_guard<py::gil_scoped_release>(), "limit"_a = 10)
+      .def(
+          "cold_objects",
+          [](ClientBase* self,
+             const size_t limit) -> std::vector<blob_access_t> {
+            std::vector<BlobAccess> blobs;
+            throw_on_error(self->ColdObjects(limit, blobs));
+            return toAccessTuples(blobs);
+          },
+          py::call_guard<py::gil_scoped_release>(), "limit"_a = 10)
+      .def(
+          "slow_requests",
+          [](ClientBase* self, const size_t limit) -> py::list {
+            std::vector<SlowRequest> requests;
+            {
+              py::gil_scoped_release release;
+              throw_on_error(self->SlowRequests(limit, requests));
+            }
+            py::list slow_requests;
+            for (auto const& request : requests) {
+              py::dict item;
+              item["timestamp"] = request.timestamp;
+              item["command"] = CommandTypeName(request.command);
+              item["connection"] = request.connection;
+              item["bytes_in"] = request.bytes_in;
+              item["bytes_out"] = request.bytes_out;
+              item["queue_us"] = request.queue_us;
+              item["handle_us"] = request.handle_us;
+              item["etcd_us"] = request.etcd_us;
+              slow_requests.append(item);
+            }
+            return slow_requests;
+          },
+          "limit"_a = 100)
+      .def(
+          "if_durable",
+          [](ClientBase* self, const ObjectIDWrapper object_id) -> bool {
+            bool durable;
+            throw_on_error(self->IfDurable(object_id, durable));
+            return durable;
+          },
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "exists",
           [](ClientBase* self, const ObjectIDWrapper object_id) -> bool {
@@ -148,7 +523,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->Exists(object_id, exists));
             return exists;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "shallow_copy",
           [](ClientBase* self, const ObjectIDWrapper object_id) -> bool {
@@ -156,14 +531,25 @@ void bind_client(py::module& mod) {
             throw_on_error(self->ShallowCopy(object_id, target_id));
             return target_id;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "put_name",
           [](ClientBase* self, const ObjectIDWrapper object_id,
              std::string const& name) {
             throw_on_error(self->PutName(object_id, name));
           },
-          "object_id"_a, "name"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a, "name"_a)
+      .def(
+          "put_names",
+          [](ClientBase* self,
+             std::map<std::string, ObjectIDWrapper> const& names) {
+            std::map<std::string, ObjectID> unwrapped_names;
+            for (auto const& item : names) {
+              unwrapped_names.emplace(item.first, item.second);
+            }
+            throw_on_error(self->PutNames(unwrapped_names));
+          },
+          py::call_guard<py::gil_scoped_release>(), "names"_a)
       .def(
           "get_name",
           [](ClientBase* self, std::string const& name,
@@ -172,11 +558,41 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetName(name, object_id));
             return object_id;
           },
+          py::call_guard<py::gil_scoped_release>(),
           "object_id"_a, py::arg("wait") = false)
-      .def("drop_name",
-           [](ClientBase* self, std::string const& name) {
-             throw_on_error(self->DropName(name));
-           })
+      .def(
+          "drop_name",
+          [](ClientBase* self, std::string const& name) {
+            throw_on_error(self->DropName(name));
+          },
+          py::call_guard<py::gil_scoped_release>(), "name"_a)
+      .def(
+          "persist_async",
+          [](ClientBase* self, const ObjectIDWrapper object_id,
+             py::function callback) {
+            AsyncCallback async_callback(callback);
+            py::gil_scoped_release release;
+            throw_on_error(self->PersistAsync(object_id, async_callback));
+          },
+          "object_id"_a, "callback"_a)
+      .def(
+          "put_name_async",
+          [](ClientBase* self, const ObjectIDWrapper object_id,
+             std::string const& name, py::function callback) {
+            AsyncCallback async_callback(callback);
+            py::gil_scoped_release release;
+            throw_on_error(self->PutNameAsync(object_id, name, async_callback));
+          },
+          "object_id"_a, "name"_a, "callback"_a)
+      .def(
+          "poll_replies",
+          [](ClientBase* self) { throw_on_error(self->PollReplies()); },
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "wait_all", [](ClientBase* self) { throw_on_error(self->WaitAll()); },
+          py::call_guard<py::gil_scoped_release>())
+      .def_property_readonly("pending_requests", &ClientBase::PendingRequests)
+      .def_property_readonly("fd", &ClientBase::ConnectionFd)
       .def_property_readonly("connected", &Client::Connected)
       .def_property_readonly("instance_id", &Client::instance_id)
       .def_property_readonly(
@@ -184,7 +600,10 @@ void bind_client(py::module& mod) {
           [](ClientBase* self)
               -> std::map<uint64_t, std::map<std::string, std::string>> {
             std::map<uint64_t, ptree> meta;
-            throw_on_error(self->ClusterInfo(meta));
+            {
+              py::gil_scoped_release release;
+              throw_on_error(self->ClusterInfo(meta));
+            }
             std::map<uint64_t, std::map<std::string, std::string>>
                 meta_to_return;
             for (auto const& kv : meta) {
@@ -202,7 +621,10 @@ void bind_client(py::module& mod) {
           "status",
           [](ClientBase* self) -> std::shared_ptr<InstanceStatus> {
             std::shared_ptr<InstanceStatus> status;
-            throw_on_error(self->InstanceStatus(status));
+            {
+              py::gil_scoped_release release;
+              throw_on_error(self->InstanceStatus(status));
+            }
             return status;
           })
       .def_property_readonly("ipc_socket", &ClientBase::IPCSocket)
@@ -223,15 +645,75 @@ void bind_client(py::module& mod) {
       .def_property_readonly(
           "memory_limit",
           [](InstanceStatus* status) { return status->memory_limit; })
+      .def_property_readonly(
+          "prefault_size",
+          [](InstanceStatus* status) { return status->prefault_size; })
+      .def_property_readonly(
+          "prefaulted_size",
+          [](InstanceStatus* status) { return status->prefaulted_size; })
+      .def_property_readonly(
+          "slab_reserved",
+          [](InstanceStatus* status) { return status->slab_reserved; })
+      .def_property_readonly(
+          "slab_used",
+          [](InstanceStatus* status) { return status->slab_used; })
+      .def_property_readonly(
+          "slab_objects",
+          [](InstanceStatus* status) { return status->slab_objects; })
+      .def_property_readonly(
+          "pinned_objects",
+          [](InstanceStatus* status) { return status->pinned_objects; })
+      .def_property_readonly(
+          "deleting_objects",
+          [](InstanceStatus* status) { return status->deleting_objects; })
+      .def_property_readonly(
+          "deleting_size",
+          [](InstanceStatus* status) { return status->deleting_size; })
+      .def_property_readonly(
+          "device_memory_usage",
+          [](InstanceStatus* status) { return status->device_memory_usage; })
+      .def_property_readonly(
+          "device_memory_limit",
+          [](InstanceStatus* status) { return status->device_memory_limit; })
       .def_property_readonly(
           "deferred_requests",
           [](InstanceStatus* status) { return status->deferred_requests; })
+      .def_property_readonly(
+          "meta_nodes",
+          [](InstanceStatus* status) { return status->meta_nodes; })
+      .def_property_readonly(
+          "meta_memory_usage",
+          [](InstanceStatus* status) { return status->meta_memory_usage; })
       .def_property_readonly(
           "ipc_connections",
           [](InstanceStatus* status) { return status->ipc_connections; })
       .def_property_readonly(
           "rpc_connections",
           [](InstanceStatus* status) { return status->rpc_connections; })
+      .def_property_readonly("tenants",
+                             [](InstanceStatus* status) -> py::object {
+                               std::stringstream ss;
+                               bpt::write_json(ss, status->tenants, false);
+                               return py::module::import("json").attr(
+                                   "loads")(ss.str());
+                             })
+      .def_property_readonly("streams",
+                             [](InstanceStatus* status) -> py::object {
+                               if (status->streams.empty()) {
+                                 return py::dict();
+                               }
+                               std::stringstream ss;
+                               bpt::write_json(ss, status->streams, false);
+                               return py::module::import("json").attr(
+                                   "loads")(ss.str());
+                             })
+      .def_property_readonly("metrics",
+                             [](InstanceStatus* status) -> py::object {
+                               std::stringstream ss;
+                               bpt::write_json(ss, status->metrics, false);
+                               return py::module::import("json").attr(
+                                   "loads")(ss.str());
+                             })
       .def("__repr__", [](InstanceStatus* status) { return "InstanceStatus"; })
       .def("__str__", [](InstanceStatus* status) {
         std::stringstream ss;
@@ -240,8 +722,24 @@ void bind_client(py::module& mod) {
         ss << "    deployment: " << status->deployment << std::endl;
         ss << "    memory_usage: " << status->memory_usage << std::endl;
         ss << "    memory_limit: " << status->memory_limit << std::endl;
+        ss << "    prefault_size: " << status->prefault_size << std::endl;
+        ss << "    prefaulted_size: " << status->prefaulted_size << std::endl;
+        ss << "    slab_reserved: " << status->slab_reserved << std::endl;
+        ss << "    slab_used: " << status->slab_used << std::endl;
+        ss << "    slab_objects: " << status->slab_objects << std::endl;
+        ss << "    pinned_objects: " << status->pinned_objects << std::endl;
+        ss << "    deleting_objects: " << status->deleting_objects
+           << std::endl;
+        ss << "    deleting_size: " << status->deleting_size << std::endl;
+        ss << "    device_memory_usage: " << status->device_memory_usage
+           << std::endl;
+        ss << "    device_memory_limit: " << status->device_memory_limit
+           << std::endl;
         ss << "    deferred_requests: " << status->deferred_requests
            << std::endl;
+        ss << "    meta_nodes: " << status->meta_nodes << std::endl;
+        ss << "    meta_memory_usage: " << status->meta_memory_usage
+           << std::endl;
         ss << "    ipc_connections: " << status->ipc_connections << std::endl;
         ss << "    rpc_connections: " << status->rpc_connections;
         return ss.str();
@@ -251,22 +749,134 @@ void bind_client(py::module& mod) {
   py::class_<Client, std::shared_ptr<Client>, ClientBase>(mod, "IPCClient")
       .def(
           "create_blob",
-          [](Client* self, size_t size) {
+          [](Client* self, size_t size, size_t alignment) {
             std::unique_ptr<BlobWriter> blob;
-            throw_on_error(self->CreateBlob(size, blob));
+            throw_on_error(
+                self->CreateBlob(size, blob, GetCurrentNumaNode(), alignment));
             return std::shared_ptr<BlobWriter>(blob.release());
           },
-          py::return_value_policy::move, "size"_a)
-      .def("create_empty_blob",
-           [](Client* self) -> std::shared_ptr<Blob> {
-             return Blob::MakeEmpty(*self);
-           })
+          py::call_guard<py::gil_scoped_release>(),
+          py::return_value_policy::move, "size"_a, "alignment"_a = 0)
+      .def(
+          "create_blobs",
+          [](Client* self, std::vector<size_t> const& sizes) {
+            std::vector<std::unique_ptr<BlobWriter>> blobs;
+            throw_on_error(self->CreateBlobs(sizes, blobs));
+            std::vector<std::shared_ptr<BlobWriter>> shared_blobs;
+            for (auto& blob : blobs) {
+              shared_blobs.emplace_back(blob.release());
+            }
+            return shared_blobs;
+          },
+          py::call_guard<py::gil_scoped_release>(), "sizes"_a)
+      .def(
+          "release",
+          [](Client* self, std::vector<ObjectIDWrapper> const& ids) {
+            throw_on_error(self->Release(
+                std::vector<ObjectID>(ids.begin(), ids.end())));
+          },
+          py::call_guard<py::gil_scoped_release>(), "ids"_a)
+      .def(
+          "create_empty_blob",
+          [](Client* self) -> std::shared_ptr<Blob> {
+            return Blob::MakeEmpty(*self);
+          },
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "create_blobs_from_buffers",
+          [](Client* self, std::vector<py::buffer> const& buffers,
+             size_t const concurrency) -> std::vector<std::shared_ptr<Blob>> {
+            std::vector<py::buffer_info> infos;
+            for (auto const& buffer : buffers) {
+              infos.emplace_back(buffer.request());
+              if (!IsCContiguous(infos.back())) {
+                throw_on_error(
+                    Status::Invalid("The buffers must be C-contiguous"));
+              }
+            }
+            std::vector<std::shared_ptr<Blob>> blobs;
+            {
+              py::gil_scoped_release release;
+              throw_on_error(
+                  CreateBlobsFromBuffers(*self, infos, concurrency, blobs));
+            }
+            return blobs;
+          },
+          "buffers"_a, "concurrency"_a = 0)
+      .def(
+          "create_tensor_blocks",
+          [](Client* self, std::vector<py::buffer> const& blocks,
+             std::vector<std::string> const& value_types,
+             size_t const concurrency)
+              -> std::vector<std::vector<ObjectIDWrapper>> {
+            std::vector<py::buffer_info> buffers;
+            for (auto const& block : blocks) {
+              buffers.emplace_back(block.request());
+            }
+            std::vector<std::vector<ObjectID>> tensors;
+            {
+              py::gil_scoped_release release;
+              throw_on_error(CreateTensorBlocks(*self, buffers, value_types,
+                                                concurrency, tensors));
+            }
+            std::vector<std::vector<ObjectIDWrapper>> wrapped_tensors;
+            for (auto const& ids : tensors) {
+              wrapped_tensors.emplace_back(ids.begin(), ids.end());
+            }
+            return wrapped_tensors;
+          },
+          "blocks"_a, "value_types"_a, "concurrency"_a = 0)
       .def(
           "get_object",
           [](Client* self, const ObjectIDWrapper object_id) {
             return self->GetObject(object_id);
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
+      .def(
+          "get_object",
+          [](Client* self, const ObjectIDWrapper object_id,
+             py::function projection) -> std::shared_ptr<Object> {
+            // the projection receives and returns the metadata as dict
+            std::shared_ptr<Object> object;
+            py::gil_scoped_release release;
+            throw_on_error(self->GetProjectedObject(
+                object_id,
+                [&projection](ptree& tree) -> Status {
+                  py::gil_scoped_acquire acquire;
+                  py::module json = py::module::import("json");
+                  std::stringstream ss;
+                  bpt::write_json(ss, tree, false);
+                  py::object projected =
+                      projection(json.attr("loads")(ss.str()));
+                  std::istringstream iss(
+                      json.attr("dumps")(projected).cast<std::string>());
+                  tree.clear();
+                  bpt::read_json(iss, tree);
+                  return Status::OK();
+                },
+                object));
+            return object;
+          },
+          "object_id"_a, "projection"_a)
+      .def(
+          "get_object_async",
+          [](Client* self, const ObjectIDWrapper object_id,
+             py::function callback) {
+            AsyncCallback async_callback(callback);
+            py::gil_scoped_release release;
+            throw_on_error(self->GetObjectAsync(object_id, async_callback));
+          },
+          "object_id"_a, "callback"_a)
+      .def(
+          "get_meta_async",
+          [](Client* self, const ObjectIDWrapper object_id,
+             py::function callback, bool const sync_remote) {
+            AsyncCallback async_callback(callback);
+            py::gil_scoped_release release;
+            throw_on_error(
+                self->GetMetaDataAsync(object_id, async_callback, sync_remote));
+          },
+          "object_id"_a, "callback"_a, py::arg("sync_remote") = false)
       .def(
           "get_objects",
           [](Client* self, const std::vector<ObjectIDWrapper>& object_ids) {
@@ -276,7 +886,7 @@ void bind_client(py::module& mod) {
             }
             return self->GetObjects(unwrapped_object_ids);
           },
-          "object_ids"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
       .def(
           "get_meta",
           [](Client* self, ObjectIDWrapper const& object_id) -> ObjectMeta {
@@ -286,7 +896,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetMetaData(object_id, meta, false));
             return meta;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "get_metas",
           [](Client* self, std::vector<ObjectIDWrapper> const& object_ids)
@@ -302,14 +912,17 @@ void bind_client(py::module& mod) {
                 self->GetMetaData(unwrapped_object_ids, metas, false));
             return metas;
           },
-          "object_ids"_a)
-      .def("list_objects", &Client::ListObjects, "pattern"_a,
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
+      .def("list_objects", &Client::ListObjects,
+           py::call_guard<py::gil_scoped_release>(), "pattern"_a,
            py::arg("regex") = false, py::arg("limit") = 5)
-      .def("close",
-           [](Client* self) {
-             return ClientManager<Client>::GetManager()->Disconnect(
-                 self->IPCSocket());
-           })
+      .def(
+          "close",
+          [](Client* self) {
+            return ClientManager<Client>::GetManager()->Disconnect(
+                self->IPCSocket());
+          },
+          py::call_guard<py::gil_scoped_release>())
       .def("__enter__", [](Client* self) { return self; })
       .def("__exit__", [](Client* self, py::object, py::object, py::object) {
         // DO NOTHING
@@ -323,7 +936,16 @@ void bind_client(py::module& mod) {
           [](Client* self, const ObjectIDWrapper object_id) {
             return self->GetObject(object_id);
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
+      .def(
+          "get_object_async",
+          [](RPCClient* self, const ObjectIDWrapper object_id,
+             py::function callback) {
+            AsyncCallback async_callback(callback);
+            py::gil_scoped_release release;
+            throw_on_error(self->GetObjectAsync(object_id, async_callback));
+          },
+          "object_id"_a, "callback"_a)
       .def(
           "get_objects",
           [](RPCClient* self, std::vector<ObjectIDWrapper> const& object_ids) {
@@ -333,7 +955,7 @@ void bind_client(py::module& mod) {
             }
             return self->GetObjects(unwrapped_object_ids);
           },
-          "object_ids"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
       .def(
           "get_meta",
           [](RPCClient* self, ObjectIDWrapper const& object_id) -> ObjectMeta {
@@ -341,7 +963,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetMetaData(object_id, meta, true));
             return meta;
           },
-          "object_id"_a)
+          py::call_guard<py::gil_scoped_release>(), "object_id"_a)
       .def(
           "get_metas",
           [](RPCClient* self, std::vector<ObjectIDWrapper> const& object_ids)
@@ -355,14 +977,17 @@ void bind_client(py::module& mod) {
                 self->GetMetaData(unwrapped_object_ids, metas, true));
             return metas;
           },
-          "object_ids"_a)
-      .def("list_objects", &RPCClient::ListObjects, "pattern"_a,
+          py::call_guard<py::gil_scoped_release>(), "object_ids"_a)
+      .def("list_objects", &RPCClient::ListObjects,
+           py::call_guard<py::gil_scoped_release>(), "pattern"_a,
            py::arg("regex") = false, py::arg("limit") = 5)
-      .def("close",
-           [](RPCClient* self) {
-             return ClientManager<RPCClient>::GetManager()->Disconnect(
-                 self->RPCEndpoint());
-           })
+      .def(
+          "close",
+          [](RPCClient* self) {
+            return ClientManager<RPCClient>::GetManager()->Disconnect(
+                self->RPCEndpoint());
+          },
+          py::call_guard<py::gil_scoped_release>())
       .def("__enter__", [](RPCClient* self) { return self; })
       .def("__exit__", [](RPCClient* self, py::object, py::object, py::object) {
         // DO NOTHING
@@ -222,7 +222,8 @@ void bind_core(py::module& mod) {
   py::class_<ObjectBuilder, std::shared_ptr<ObjectBuilder>>(mod,
                                                             "ObjectBuilder")
       // NB: don't expose the "Build" method to python.
-      .def("seal", &ObjectBuilder::Seal, "client"_a)
+      .def("seal", &ObjectBuilder::Seal,
+           py::call_guard<py::gil_scoped_release>(), "client"_a)
       .def_property_readonly("issealed", &ObjectBuilder::sealed);
 
   // Wrap arrow::Buffer for convenient.
@@ -348,13 +349,15 @@ void bind_core(py::module& mod) {
             std::memcpy(self->data() + offset, reinterpret_cast<void*>(ptr),
                         size);
           },
-          "offset"_a, "address"_a, "size"_a)
+          py::call_guard<py::gil_scoped_release>(), "offset"_a, "address"_a,
+          "size"_a)
       .def(
           "copy",
           [](BlobWriter* self, size_t offset, py::bytes bs) {
             // FIXME: avoid this explicit copy
             std::string ss = static_cast<std::string>(bs);
             VINEYARD_ASSERT(offset + ss.size() <= self->size());
+            py::gil_scoped_release release;
             std::memcpy(self->data() + offset, ss.c_str(), ss.size());
           },
           "offset"_a, "bytes"_a)
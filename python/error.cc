@@ -75,6 +75,7 @@ DEFINE_PYBIND_EXCEPTION(NotEnoughMemory);
 DEFINE_PYBIND_EXCEPTION(StreamDrained);
 DEFINE_PYBIND_EXCEPTION(StreamFailed);
 DEFINE_PYBIND_EXCEPTION(InvalidStreamState);
+DEFINE_PYBIND_EXCEPTION(StreamNotReady);
 DEFINE_PYBIND_EXCEPTION(UserInputError);
 DEFINE_PYBIND_EXCEPTION(UnknownError);
 
@@ -106,6 +107,7 @@ void bind_error(py::module& mod) {
   REGISTER_PYBIND_EXCEPTION(mod, StreamDrained);
   REGISTER_PYBIND_EXCEPTION(mod, StreamFailed);
   REGISTER_PYBIND_EXCEPTION(mod, InvalidStreamState);
+  REGISTER_PYBIND_EXCEPTION(mod, StreamNotReady);
   REGISTER_PYBIND_EXCEPTION(mod, UserInputError);
   REGISTER_PYBIND_EXCEPTION(mod, UnknownError);
 }
@@ -141,6 +143,7 @@ void throw_on_error(Status const& status) {
     THROW_ON_ERROR_OF(StreamDrained);
     THROW_ON_ERROR_OF(StreamFailed);
     THROW_ON_ERROR_OF(InvalidStreamState);
+    THROW_ON_ERROR_OF(StreamNotReady);
     THROW_ON_ERROR_OF(UserInputError);
     THROW_ON_ERROR_OF(UnknownError);
   default:
@@ -0,0 +1,97 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdint>
+#include <memory>
+
+#include "pybind11/pybind11.h"
+
+#pragma GCC visibility push(default)
+#include "basic/ds/arrow.h"
+#include "basic/ds/exchange.h"
+#pragma GCC visibility pop
+
+#include "pybind11_utils.h"  // NOLINT(build/include)
+
+namespace py = pybind11;
+using namespace py::literals;  // NOLINT(build/namespaces)
+
+namespace vineyard {
+
+namespace {
+
+constexpr const char* kDLTensorCapsule = "dltensor";
+
+void deleteDLTensorCapsule(PyObject* capsule) {
+  // consumers rename the capsule to "used_dltensor" after taking the
+  // ownership of the tensor.
+  if (PyCapsule_IsValid(capsule, kDLTensorCapsule)) {
+    auto tensor = static_cast<DLManagedTensor*>(
+        PyCapsule_GetPointer(capsule, kDLTensorCapsule));
+    if (tensor != nullptr && tensor->deleter != nullptr) {
+      tensor->deleter(tensor);
+    }
+  }
+}
+
+}  // namespace
+
+void bind_exchange(py::module& mod) {
+  mod.def(
+      "_to_dlpack",
+      [](std::shared_ptr<Object> const& object) -> py::object {
+        DLManagedTensor* tensor = nullptr;
+        throw_on_error(ExportDLPack(object, &tensor));
+        PyObject* capsule =
+            PyCapsule_New(tensor, kDLTensorCapsule, deleteDLTensorCapsule);
+        if (capsule == nullptr) {
+          tensor->deleter(tensor);
+          throw py::error_already_set();
+        }
+        return py::reinterpret_steal<py::object>(capsule);
+      },
+      "object"_a);
+
+  mod.def(
+      "_to_arrow",
+      [](std::shared_ptr<Object> const& object) -> py::object {
+        auto pa = py::module::import("pyarrow");
+        if (std::dynamic_pointer_cast<Table>(object) != nullptr) {
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 2000000
+          auto stream = std::make_unique<struct ArrowArrayStream>();
+          throw_on_error(ExportArrowArrayStream(object, stream.get()));
+          auto reader = pa.attr("RecordBatchReader")
+                            .attr("_import_from_c")(
+                                reinterpret_cast<uintptr_t>(stream.get()));
+          return reader.attr("read_all")();
+#else
+          throw_on_error(Status::NotImplemented(
+              "Exporting tables requires arrow >= 2.0.0"));
+#endif
+        }
+        auto array = std::make_unique<struct ArrowArray>();
+        auto schema = std::make_unique<struct ArrowSchema>();
+        throw_on_error(ExportArrowArray(object, array.get(), schema.get()));
+        py::object target = std::dynamic_pointer_cast<RecordBatch>(object)
+                                ? pa.attr("RecordBatch")
+                                : pa.attr("Array");
+        return target.attr("_import_from_c")(
+            reinterpret_cast<uintptr_t>(array.get()),
+            reinterpret_cast<uintptr_t>(schema.get()));
+      },
+      "object"_a);
+}
+
+}  // namespace vineyard
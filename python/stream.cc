@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -23,6 +24,8 @@ limitations under the License.
 #include "pybind11/stl.h"
 
 #pragma GCC visibility push(default)
+#include "arrow/c/bridge.h"
+
 #include "basic/stream/byte_stream.h"
 #include "basic/stream/dataframe_stream.h"
 #include "client/client.h"
@@ -35,6 +38,37 @@ using namespace py::literals;  // NOLINT(build/namespaces)
 
 namespace vineyard {
 
+namespace {
+
+/**
+ * Hand the batch over to pyarrow by the C data interface, thus the buffers of
+ * the batch are shared with pyarrow rather than copied.
+ */
+py::object to_pyarrow_batch(std::shared_ptr<arrow::RecordBatch> const& batch) {
+  auto array = std::make_unique<struct ArrowArray>();
+  auto schema = std::make_unique<struct ArrowSchema>();
+  throw_on_error(Status::ArrowError(
+      arrow::ExportRecordBatch(*batch, array.get(), schema.get())));
+  try {
+    auto pa = py::module::import("pyarrow");
+    return pa.attr("RecordBatch")
+        .attr("_import_from_c")(reinterpret_cast<uintptr_t>(array.get()),
+                                reinterpret_cast<uintptr_t>(schema.get()));
+  } catch (...) {
+    // the structs that haven't been moved by pyarrow are still owned here,
+    // release them before the unique_ptrs free the structs
+    if (array->release != nullptr) {
+      array->release(array.get());
+    }
+    if (schema->release != nullptr) {
+      schema->release(schema.get());
+    }
+    throw;
+  }
+}
+
+}  // namespace
+
 void bind_stream(py::module& mod) {
   // ByteStreamWriter
   py::class_<ByteStreamWriter, std::unique_ptr<ByteStreamWriter>>(
@@ -43,29 +77,60 @@ void bind_stream(py::module& mod) {
           "next",
           [](ByteStreamWriter* self, size_t const size) -> py::object {
             std::unique_ptr<arrow::MutableBuffer> chunk = nullptr;
-            throw_on_error(self->GetNext(size, chunk));
+            {
+              py::gil_scoped_release release;
+              throw_on_error(self->GetNext(size, chunk));
+            }
             auto chunk_ptr = chunk.release();
             auto pa = py::module::import("pyarrow");
             return pa.attr("py_buffer")(py::memoryview::from_memory(
                 chunk_ptr->mutable_data(), chunk_ptr->size(), false));
           },
           "size"_a)
-      .def("finish",
-           [](ByteStreamWriter* self) { throw_on_error(self->Finish()); })
-      .def("abort",
-           [](ByteStreamWriter* self) { throw_on_error(self->Abort()); });
+      .def(
+          "finish",
+          [](ByteStreamWriter* self) { throw_on_error(self->Finish()); },
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "abort",
+          [](ByteStreamWriter* self) { throw_on_error(self->Abort()); },
+          py::call_guard<py::gil_scoped_release>());
 
   // ByteStreamReader
   py::class_<ByteStreamReader, std::unique_ptr<ByteStreamReader>>(
       mod, "ByteStreamReader")
-      .def("next", [](ByteStreamReader* self) -> py::object {
-        std::unique_ptr<arrow::Buffer> chunk = nullptr;
-        throw_on_error(self->GetNext(chunk));
-        auto chunk_ptr = chunk.release();
-        auto pa = py::module::import("pyarrow");
-        return pa.attr("py_buffer")(
-            py::memoryview::from_memory(chunk_ptr->data(), chunk_ptr->size()));
-      });
+      .def("next",
+           [](ByteStreamReader* self) -> py::object {
+             std::unique_ptr<arrow::Buffer> chunk = nullptr;
+             {
+               py::gil_scoped_release release;
+               throw_on_error(self->GetNext(chunk));
+             }
+             auto chunk_ptr = chunk.release();
+             auto pa = py::module::import("pyarrow");
+             return pa.attr("py_buffer")(py::memoryview::from_memory(
+                 chunk_ptr->data(), chunk_ptr->size()));
+           })
+      .def("try_next",
+           [](ByteStreamReader* self) -> py::object {
+             std::unique_ptr<arrow::Buffer> chunk = nullptr;
+             {
+               py::gil_scoped_release release;
+               throw_on_error(self->TryGetNext(chunk));
+             }
+             auto chunk_ptr = chunk.release();
+             auto pa = py::module::import("pyarrow");
+             return pa.attr("py_buffer")(py::memoryview::from_memory(
+                 chunk_ptr->data(), chunk_ptr->size()));
+           })
+      .def(
+          "notifier",
+          [](ByteStreamReader* self) -> int {
+            int fd = -1;
+            throw_on_error(self->Notifier(fd));
+            return fd;
+          },
+          py::call_guard<py::gil_scoped_release>());
 
   // ByteStream
   py::class_<ByteStream, std::shared_ptr<ByteStream>, Object>(mod, "ByteStream")
@@ -75,14 +140,14 @@ void bind_stream(py::module& mod) {
              Client& client) -> std::unique_ptr<ByteStreamReader> {
             return self->OpenReader(client);
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(), "client"_a)
       .def(
           "open_writer",
           [](ByteStream* self,
              Client& client) -> std::unique_ptr<ByteStreamWriter> {
             return self->OpenWriter(client);
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(), "client"_a)
       .def("__getitem__",
            [](ByteStream* self, std::string const& key) {
              return self->GetParams().at(key);
@@ -119,7 +184,10 @@ void bind_stream(py::module& mod) {
           "next",
           [](DataframeStreamWriter* self, size_t const size) -> py::object {
             std::unique_ptr<arrow::MutableBuffer> chunk = nullptr;
-            throw_on_error(self->GetNext(size, chunk));
+            {
+              py::gil_scoped_release release;
+              throw_on_error(self->GetNext(size, chunk));
+            }
             auto chunk_ptr = chunk.release();
             auto buffer = py::cast(chunk_ptr);
             auto pa = py::module::import("pyarrow");
@@ -127,22 +195,79 @@ void bind_stream(py::module& mod) {
                 chunk_ptr->mutable_data(), chunk_ptr->size(), false));
           },
           "size"_a)
-      .def("finish",
-           [](DataframeStreamWriter* self) { throw_on_error(self->Finish()); })
-      .def("abort",
-           [](DataframeStreamWriter* self) { throw_on_error(self->Abort()); });
+      .def(
+          "finish",
+          [](DataframeStreamWriter* self) { throw_on_error(self->Finish()); },
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "abort",
+          [](DataframeStreamWriter* self) { throw_on_error(self->Abort()); },
+          py::call_guard<py::gil_scoped_release>());
 
   // DataframeStreamReader
   py::class_<DataframeStreamReader, std::unique_ptr<DataframeStreamReader>>(
       mod, "DataframeStreamReader")
-      .def("next", [](DataframeStreamReader* self) -> py::object {
-        std::unique_ptr<arrow::Buffer> chunk = nullptr;
-        throw_on_error(self->GetNext(chunk));
-        auto chunk_ptr = chunk.release();
-        auto pa = py::module::import("pyarrow");
-        return pa.attr("py_buffer")(
-            py::memoryview::from_memory(chunk_ptr->data(), chunk_ptr->size()));
-      });
+      .def("next",
+           [](DataframeStreamReader* self) -> py::object {
+             std::unique_ptr<arrow::Buffer> chunk = nullptr;
+             {
+               py::gil_scoped_release release;
+               throw_on_error(self->GetNext(chunk));
+             }
+             auto chunk_ptr = chunk.release();
+             auto pa = py::module::import("pyarrow");
+             return pa.attr("py_buffer")(py::memoryview::from_memory(
+                 chunk_ptr->data(), chunk_ptr->size()));
+           })
+      .def("try_next",
+           [](DataframeStreamReader* self) -> py::object {
+             std::unique_ptr<arrow::Buffer> chunk = nullptr;
+             {
+               py::gil_scoped_release release;
+               throw_on_error(self->TryGetNext(chunk));
+             }
+             auto chunk_ptr = chunk.release();
+             auto pa = py::module::import("pyarrow");
+             return pa.attr("py_buffer")(py::memoryview::from_memory(
+                 chunk_ptr->data(), chunk_ptr->size()));
+           })
+      .def(
+          "read_batch",
+          [](DataframeStreamReader* self, bool const copy) -> py::object {
+            std::shared_ptr<arrow::RecordBatch> batch;
+            {
+              py::gil_scoped_release release;
+              throw_on_error(self->ReadBatch(batch, copy));
+            }
+            return to_pyarrow_batch(batch);
+          },
+          "copy"_a = false)
+      .def("__iter__",
+           [](DataframeStreamReader* self) -> DataframeStreamReader* {
+             return self;
+           })
+      .def("__next__",
+           [](DataframeStreamReader* self) -> py::object {
+             std::shared_ptr<arrow::RecordBatch> batch;
+             Status status;
+             {
+               py::gil_scoped_release release;
+               status = self->ReadBatch(batch);
+             }
+             if (status.IsStreamDrained()) {
+               throw py::stop_iteration();
+             }
+             throw_on_error(status);
+             return to_pyarrow_batch(batch);
+           })
+      .def(
+          "notifier",
+          [](DataframeStreamReader* self) -> int {
+            int fd = -1;
+            throw_on_error(self->Notifier(fd));
+            return fd;
+          },
+          py::call_guard<py::gil_scoped_release>());
 
   // DataFrameStream
   py::class_<DataframeStream, std::shared_ptr<DataframeStream>, Object>(
@@ -153,14 +278,14 @@ void bind_stream(py::module& mod) {
              Client& client) -> std::unique_ptr<DataframeStreamReader> {
             return self->OpenReader(client);
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(), "client"_a)
       .def(
           "open_writer",
           [](DataframeStream* self,
              Client& client) -> std::unique_ptr<DataframeStreamWriter> {
             return self->OpenWriter(client);
           },
-          "client"_a)
+          py::call_guard<py::gil_scoped_release>(), "client"_a)
       .def("__getitem__",
            [](DataframeStream* self, std::string const& key) {
              return self->GetParams().at(key);
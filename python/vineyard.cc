@@ -24,6 +24,7 @@ void bind_core(py::module& mod);
 void bind_client(py::module& mod);
 void bind_utils(py::module& mod);
 void bind_stream(py::module& mod);
+void bind_exchange(py::module& mod);
 
 PYBIND11_MODULE(_C, mod) {
   py::options options;
@@ -37,6 +38,7 @@ PYBIND11_MODULE(_C, mod) {
 
 #if defined(BIND_STREAM)
   bind_stream(mod);
+  bind_exchange(mod);
 #endif
 }
 
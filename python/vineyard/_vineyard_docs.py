@@ -328,14 +328,33 @@ Base class for vineyard object builders.
 
 add_doc(
     ClientBase.create_metadata, r'''
-.. method:: create_metadata(metadata: ObjectMeta) -> None
+.. method:: create_metadata(metadata: ObjectMeta or List[ObjectMeta]) -> ObjectID or List[ObjectID]
     :noindex:
 
 Create metadata in vineyardd.
 
 Parameters:
-    metadata: ObjectMeta
-        The metadata that will be created on vineyardd.
+    metadata: ObjectMeta or list of ObjectMeta
+        The metadata that will be created on vineyardd. A list of metadata will be
+        created in a single call without holding the GIL.
+''')
+
+add_doc(
+    ClientBase.poll_replies, r'''
+.. method:: poll_replies() -> None
+    :noindex:
+
+Consume the replies of asynchronous requests that have already arrived without
+blocking, and invoke their callbacks. The connection, i.e., :code:`fd`, becomes
+readable when replies arrive, thus it can be driven by an event loop.
+''')
+
+add_doc(
+    ClientBase.wait_all, r'''
+.. method:: wait_all() -> None
+    :noindex:
+
+Wait until all in-flight asynchronous requests have finished.
 ''')
 
 add_doc(
@@ -500,6 +519,10 @@ The RPC endpoint of the connected vineyard server.
 
 add_doc(IPCClient, r'''
 IPC client that connects to vineyard instance's UNIX domain socket.
+
+The client is thread-safe, and the GIL is released during the blocking requests
+and memory copies, thus a client can be shared by threads of a thread pool to
+overlap fetching objects with computation.
 ''')
 
 add_doc(
@@ -517,6 +540,21 @@ Returns:
     BlobBuilder
 ''')
 
+add_doc(
+    IPCClient.create_blobs, r'''
+.. method:: create_blobs(sizes: List[int]) -> List[BlobBuilder]
+    :noindex:
+
+Allocate a batch of blobs in vineyard server in a single round trip.
+
+Parameters:
+    sizes: list of int
+        The sizes of blobs that will be allocated on vineyardd.
+
+Returns:
+    List of BlobBuilder
+''')
+
 add_doc(
     IPCClient.create_empty_blob, r'''
 .. method:: create_empty_blob() -> Blob
@@ -528,6 +566,62 @@ Returns:
     Blob
 ''')
 
+add_doc(
+    IPCClient.create_blobs_from_buffers, r'''
+.. method:: create_blobs_from_buffers(buffers: List[buffer], concurrency: int = 0) -> List[Blob]
+    :noindex:
+
+Create a blob for each of the given C-contiguous buffers, e.g., numpy arrays. The blobs
+are allocated from a single arena, i.e., by a single request, and the buffers are copied
+by :code:`concurrency` threads (defaults to the number of cores) with the GIL released.
+
+Parameters:
+    buffers: list of buffers
+        The buffers to copy.
+    concurrency: int
+        The number of threads used to copy.
+
+Returns:
+    List of Blob
+''')
+
+add_doc(
+    IPCClient.create_tensor_blocks, r'''
+.. method:: create_tensor_blocks(blocks: List[numpy.ndarray], value_types: List[str], concurrency: int = 0) \
+        -> List[List[ObjectID]]
+    :noindex:
+
+Create a 1-D tensor for each row of the given 2-D blocks, e.g., the consolidated
+blocks of a :class:`pandas.DataFrame`. The blobs are allocated from a single arena,
+and rows are copied by :code:`concurrency` threads (defaults to the number of
+cores) with the GIL released.
+
+Rows of a block are placed at addresses of the same stride, thus the block can
+still be viewed as a 2-D array without copy after been resolved.
+
+Parameters:
+    blocks: list of 2-D buffers
+        The blocks to copy.
+    value_types: list of str
+        The value type of tensors for each block, e.g., :code:`int64`.
+    concurrency: int
+        The number of threads used to copy.
+
+Returns:
+    The object ids of tensors, for each row of each block.
+''')
+
+add_doc(
+    IPCClient.get_object_async, r'''
+.. method:: get_object_async(object_id: ObjectID, callback: Callable) -> None
+    :noindex:
+
+Get object from vineyard asynchronously. The request is sent without waiting for
+the reply, and the :code:`callback` will be invoked with a function that returns
+the object or raises the error, once the reply has been consumed by
+:meth:`poll_replies`, :meth:`wait_all` or other requests, see also :mod:`vineyard.aio`.
+''')
+
 add_doc(
     IPCClient.get_object, r'''
 .. method:: get_object(object_id: ObjectID) -> Object
@@ -763,6 +857,21 @@ add_doc(InstanceStatus.rpc_connections, r'''
 Report number of alive RPC connections on the current vineyardd instance.
 ''')
 
+add_doc(InstanceStatus.streams, r'''
+Report the statistics of each stream on the current vineyardd instance, as a
+dict keyed by the stream id: the chunks and bytes produced and consumed, the
+queue depth, and the time (in microseconds) the producer has been blocked and
+the consumers have waited, which tell which stage of the pipeline is the
+bottleneck.
+''')
+
+add_doc(InstanceStatus.metrics, r'''
+Report the latencies of requests (per command type, in microseconds) and etcd
+commits, and the bytes received and sent by the current vineyardd instance, as
+a dict. The same metrics are exported in the Prometheus format when vineyardd
+is launched with :code:`--metrics_port`.
+''')
+
 add_doc(Blob, r'''
 :class:`Blob` in vineyard is a consecutive readonly shared memory.
 ''')
@@ -0,0 +1,196 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+''' Asyncio-native vineyard clients, whose requests are pipelined on the
+    connection and the replies are consumed by the event loop, without hopping
+    to other threads.
+
+    .. code:: python
+
+        >>> import vineyard.aio
+        >>> client = vineyard.aio.connect('/var/run/vineyard.sock')
+        >>> value = await client.get(object_id)
+        >>> async for chunk in client.read_stream(stream):
+        ...     process(chunk)
+'''
+
+import asyncio
+
+from vineyard._C import connect as _connect, IPCClient, RPCClient, ObjectID, \
+    StreamDrainedException, StreamNotReadyException
+from vineyard.core.resolver import resolve
+
+
+def _wrap(object_id):
+    if isinstance(object_id, (int, str)):
+        return ObjectID(object_id)
+    return object_id
+
+
+def _set_result(future, value):
+    if not future.done():
+        future.set_result(value)
+
+
+def _set_exception(future, error):
+    if not future.done():
+        future.set_exception(error)
+
+
+class _AsyncClient:
+    ''' Base class of the asyncio clients, which drives the asynchronous
+        requests of the underlying client by watching its connection.
+    '''
+    def __init__(self, client, loop=None):
+        self._client = client
+        self._loop = loop or asyncio.get_event_loop()
+        self._watching = False
+
+    @property
+    def client(self):
+        ''' The underlying blocking client.
+        '''
+        return self._client
+
+    def __getattr__(self, name):
+        return getattr(self._client, name)
+
+    def _submit(self, method, *args, **kwargs):
+        future = self._loop.create_future()
+
+        def done(result):
+            # the callback may be invoked in other threads that consume the
+            # replies of the same client by blocking calls
+            try:
+                value = result()
+            except Exception as e:  # pylint: disable=broad-except
+                self._loop.call_soon_threadsafe(_set_exception, future, e)
+            else:
+                self._loop.call_soon_threadsafe(_set_result, future, value)
+
+        method(*args, callback=done, **kwargs)
+        self._watch()
+        return future
+
+    def _watch(self):
+        if not self._watching and self._client.pending_requests > 0:
+            self._loop.add_reader(self._client.fd, self._on_readable)
+            self._watching = True
+
+    def _unwatch(self):
+        if self._watching:
+            self._loop.remove_reader(self._client.fd)
+            self._watching = False
+
+    def _on_readable(self):
+        try:
+            self._client.poll_replies()
+        finally:
+            if self._client.pending_requests == 0:
+                self._unwatch()
+
+    async def get_object(self, object_id):
+        return await self._submit(self._client.get_object_async, _wrap(object_id))
+
+    async def get(self, object_id, resolver=None, **kw):
+        ''' Get vineyard object as python value, see also :meth:`vineyard.IPCClient.get`.
+        '''
+        return resolve(await self.get_object(object_id), resolver, **kw)
+
+    async def persist(self, object_id):
+        return await self._submit(self._client.persist_async, _wrap(object_id))
+
+    async def put_name(self, object_id, name):
+        return await self._submit(self._client.put_name_async, _wrap(object_id), name)
+
+    def close(self):
+        self._unwatch()
+        self._client.close()
+
+
+class AsyncIPCClient(_AsyncClient):
+    ''' The asyncio variant of :class:`vineyard.IPCClient`, the methods that are
+        not coroutines are forwarded to the underlying client.
+    '''
+    def __init__(self, client, loop=None):
+        if not isinstance(client, IPCClient):
+            raise TypeError('Expect an IPCClient, but got %s' % type(client))
+        super().__init__(client, loop)
+
+    async def get_meta(self, object_id, sync_remote=False):
+        return await self._submit(self._client.get_meta_async, _wrap(object_id), sync_remote=sync_remote)
+
+    def read_stream(self, stream):
+        ''' Iterate over the chunks of a :class:`ByteStream`, or a :class:`DataframeStream`.
+        '''
+        return AsyncStreamReader(stream.open_reader(self._client), self._loop)
+
+
+class AsyncRPCClient(_AsyncClient):
+    ''' The asyncio variant of :class:`vineyard.RPCClient`, note that the payloads
+        of blobs are still fetched by blocking requests.
+    '''
+    def __init__(self, client, loop=None):
+        if not isinstance(client, RPCClient):
+            raise TypeError('Expect an RPCClient, but got %s' % type(client))
+        super().__init__(client, loop)
+
+
+class AsyncStreamReader:
+    ''' Iterate over the chunks of a stream asynchronously, the event loop is woken
+        up by the notifier of the stream when new chunks are available.
+    '''
+    def __init__(self, reader, loop=None):
+        self._reader = reader
+        self._loop = loop or asyncio.get_event_loop()
+        self._notifier = reader.notifier()
+
+    def __aiter__(self):
+        return self
+
+    async def __anext__(self):
+        while True:
+            try:
+                return self._reader.try_next()
+            except StreamNotReadyException:
+                await self._wait_notified()
+            except StreamDrainedException:
+                raise StopAsyncIteration  # pylint: disable=raise-missing-from
+
+    def _wait_notified(self):
+        future = self._loop.create_future()
+
+        def notified():
+            self._loop.remove_reader(self._notifier)
+            _set_result(future, None)
+
+        self._loop.add_reader(self._notifier, notified)
+        return future
+
+
+def connect(*args, loop=None, **kwargs):
+    ''' Connect to vineyard like :meth:`vineyard.connect`, and returns an
+        :class:`AsyncIPCClient` or an :class:`AsyncRPCClient`.
+    '''
+    client = _connect(*args, **kwargs)
+    if isinstance(client, IPCClient):
+        return AsyncIPCClient(client, loop)
+    return AsyncRPCClient(client, loop)
+
+
+__all__ = ['AsyncIPCClient', 'AsyncRPCClient', 'AsyncStreamReader', 'connect']
@@ -54,6 +54,10 @@ except ImportError:
 #   __attribute__((annotate("codegen:{Type*}"))): set member type: std::set<std::shared_ptr<Type>> member_
 #   __attribute__((annotate("codegen:{int32_t: Type}"))): dict member type: std::map<int32_t, Type> member_
 #   __attribute__((annotate("codegen:{int32_t: Type*}"))): dict member type: std::map<int32_t, std::shared_ptr<Type>> member_
+#   __attribute__((annotate("codegen:lazy Type*"))): lazy member type: Lazy<Type> member_
+#   __attribute__((annotate("codegen:lazy [Type*]"))): lazy list member type: std::vector<Lazy<Type>> member_
+#
+#   The lazy members are constructed on the first access, see also "client/ds/lazy.h".
 #
 # FIXME(hetao): parse the codegen spec directly from the type signature of the member variable
 #
@@ -62,6 +66,7 @@ except ImportError:
 class CodeGenKind(object):
     def __init__(self, kind='meta', element_type=None):
         self.kind = kind
+        self.lazy = False
         if element_type is None:
             self.element_type = None
             self.star = ''
@@ -147,7 +152,12 @@ def parse_codegen_spec(kind):
         kind = kind[len('codegen'):]
     if kind.startswith(':'):
         kind = kind[1:]
-    return codegen_spec_parser.parse(kind)
+    lazy = kind.startswith('lazy ')
+    if lazy:
+        kind = kind[len('lazy '):]
+    spec = codegen_spec_parser.parse(kind)
+    spec.lazy = lazy
+    return spec
 
 
 ###############################################################################
@@ -399,51 +409,90 @@ construct_plain_tpl = '''
 construct_plain_star_tpl = '''
     this->{name} = {deref}std::dynamic_pointer_cast<{element_type}>(meta.GetMember("{name}"));'''
 
+construct_plain_lazy_tpl = '''
+    this->{name} = meta.GetLazyMember<{element_type}>("{name}");'''
+
 construct_list_tpl = '''
-    this->{name}.resize(meta.GetKeyValue<size_t>("__{name}-size"));
-    for (size_t __idx = 0; __idx < this->{name}.size(); ++__idx) {{
-        this->{name}[__idx].Construct(
-            meta.GetMemberMeta("__{name}-" + std::to_string(__idx)));
+    {{
+        // the keys of members are formatted into a reused buffer
+        IndexedKey __{name}_key("__{name}-");
+        this->{name}.resize(meta.GetKeyValue<size_t>("__{name}-size"));
+        for (size_t __idx = 0; __idx < this->{name}.size(); ++__idx) {{
+            this->{name}[__idx].Construct(meta.GetMemberMeta(__{name}_key(__idx)));
+        }}
     }}'''
 
 construct_list_star_tpl = '''
-    for (size_t __idx = 0; __idx < meta.GetKeyValue<size_t>("__{name}-size"); ++__idx) {{
-        this->{name}.emplace_back({deref}std::dynamic_pointer_cast<{element_type}>(
-                meta.GetMember("__{name}-" + std::to_string(__idx))));
+    {{
+        // lookup the size once, rather than on every iteration
+        const size_t __{name}_size = meta.GetKeyValue<size_t>("__{name}-size");
+        IndexedKey __{name}_key("__{name}-");
+        this->{name}.reserve(__{name}_size);
+        for (size_t __idx = 0; __idx < __{name}_size; ++__idx) {{
+            this->{name}.emplace_back({deref}std::dynamic_pointer_cast<{element_type}>(
+                    meta.GetMember(__{name}_key(__idx))));
+        }}
+    }}'''
+
+construct_list_lazy_tpl = '''
+    {{
+        const size_t __{name}_size = meta.GetKeyValue<size_t>("__{name}-size");
+        IndexedKey __{name}_key("__{name}-");
+        this->{name}.reserve(__{name}_size);
+        for (size_t __idx = 0; __idx < __{name}_size; ++__idx) {{
+            this->{name}.emplace_back(meta.GetLazyMember<{element_type}>(
+                    __{name}_key(__idx)));
+        }}
     }}'''
 
 construct_dlist_tpl = '''
-    this->{name}.resize(meta.GetKeyValue<size_t>("__{name}-size"));
-    for (size_t __idx = 0; __idx < this->{name}.size(); ++__idx) {{
-        this->{name}[__idx].resize(meta.GetKeyValue<size_t>(
-            "__{name}-" + std::to_string(__idx) + "-size"));
-        for (size_t __idy = 0; __idy < this->{name}[__idx].size(); ++__idy) {{
-            this->{name}[__idx][__idy].Construct(
-                meta.GetMemberMeta("__{name}-" + std::to_string(__idx) + "-" + std::to_string(__idy)));
+    {{
+        IndexedKey __{name}_key("__{name}-");
+        this->{name}.resize(meta.GetKeyValue<size_t>("__{name}-size"));
+        for (size_t __idx = 0; __idx < this->{name}.size(); ++__idx) {{
+            this->{name}[__idx].resize(meta.GetKeyValue<size_t>(
+                __{name}_key(__idx, "-size")));
+            for (size_t __idy = 0; __idy < this->{name}[__idx].size(); ++__idy) {{
+                this->{name}[__idx][__idy].Construct(
+                    meta.GetMemberMeta(__{name}_key(__idx, __idy)));
+            }}
         }}
     }}'''
 
 construct_dlist_star_tpl = '''
-    this->{name}.resize(meta.GetKeyValue<size_t>("__{name}-size"));
-    for (size_t __idx = 0; __idx < this->{name}.size(); ++__idx) {{
-        for (size_t __idy = 0; __idy < meta.GetKeyValue<size_t>(
-                "__{name}-" + std::to_string(__idx) + "-size"); ++__idy) {{
-            this->{name}[__idx].emplace_back({deref}std::dynamic_pointer_cast<{element_type}>(
-                meta.GetMember("__{name}-" + std::to_string(__idx) + "-" + std::to_string(__idy))));
+    {{
+        IndexedKey __{name}_key("__{name}-");
+        this->{name}.resize(meta.GetKeyValue<size_t>("__{name}-size"));
+        for (size_t __idx = 0; __idx < this->{name}.size(); ++__idx) {{
+            const size_t __{name}_size = meta.GetKeyValue<size_t>(
+                    __{name}_key(__idx, "-size"));
+            this->{name}[__idx].reserve(__{name}_size);
+            for (size_t __idy = 0; __idy < __{name}_size; ++__idy) {{
+                this->{name}[__idx].emplace_back({deref}std::dynamic_pointer_cast<{element_type}>(
+                    meta.GetMember(__{name}_key(__idx, __idy))));
+            }}
         }}
     }}'''
 
 construct_set_tpl = '''
-    for (size_t __idx = 0; __idx < meta.GetKeyValue<size_t>("__{name}-size"); ++__idx) {{
-        this->{name}.emplace({deref}std::dynamic_pointer_cast<{element_type}>(
-                meta.GetMember("__{name}-" + std::to_string(__idx))));
+    {{
+        const size_t __{name}_size = meta.GetKeyValue<size_t>("__{name}-size");
+        IndexedKey __{name}_key("__{name}-");
+        for (size_t __idx = 0; __idx < __{name}_size; ++__idx) {{
+            this->{name}.emplace({deref}std::dynamic_pointer_cast<{element_type}>(
+                    meta.GetMember(__{name}_key(__idx))));
+        }}
     }}'''
 
 construct_dict_tpl = '''
-    for (size_t __idx = 0; __idx < meta.GetKeyValue<size_t>("__{name}-size"); ++__idx) {{
-        this->{name}.emplace(meta.GetKeyValue<{key_type}>("__{name}-key-" + std::to_string(__idx)),
-                {deref}std::dynamic_pointer_cast<{value_type}>(
-                        meta.GetMember("__{name}-value-" + std::to_string(__idx))));
+    {{
+        const size_t __{name}_size = meta.GetKeyValue<size_t>("__{name}-size");
+        IndexedKey __{name}_key("__{name}-key-"), __{name}_value_key("__{name}-value-");
+        for (size_t __idx = 0; __idx < __{name}_size; ++__idx) {{
+            this->{name}.emplace(meta.GetKeyValue<{key_type}>(__{name}_key(__idx)),
+                    {deref}std::dynamic_pointer_cast<{value_type}>(
+                            meta.GetMember(__{name}_value_key(__idx))));
+        }}
     }}'''
 
 
@@ -473,6 +522,14 @@ def codegen_construct(class_header, class_name, class_name_elaborated, fields, h
             tpl = construct_set_tpl
         if spec.is_dict:
             tpl = construct_dict_tpl
+        if spec.lazy:
+            if spec.is_plain and spec.star:
+                tpl = construct_plain_lazy_tpl
+            elif spec.is_list and spec.star:
+                tpl = construct_list_lazy_tpl
+            else:
+                raise RuntimeError('Lazy member %s must be a shared pointer or a list of shared pointers: %s' %
+                                   (name, spec))
 
         if spec.is_dict:
             key_type = spec.element_type[0]
@@ -601,7 +658,7 @@ field_assign_plain_tpl = '''
         auto __value_{field_name} = std::dynamic_pointer_cast<__{field_name}_value_type>(
             {field_name}->_Seal(client));
         __value->{field_name} = {deref}__value_{field_name};
-        __value->meta_.AddMember("{field_name}", __value->{field_name});
+        __value->meta_.AddMember("{field_name}", __value_{field_name});
         __value_nbytes += __value_{field_name}->nbytes();
 '''
 
@@ -610,11 +667,12 @@ field_assign_list_tpl = '''
         using __{field_name}_value_type = typename decltype(__value->{field_name})::value_type{element_type};
 
         size_t __{field_name}_idx = 0;
+        IndexedKey __{field_name}_key("__{field_name}-");
         for (auto &__{field_name}_value: {field_name}) {{
             auto __value_{field_name} = std::dynamic_pointer_cast<__{field_name}_value_type>(
                 __{field_name}_value->_Seal(client));
             __value->{field_name}.emplace_back({deref}__value_{field_name});
-            __value->meta_.AddMember("__{field_name}-" + std::to_string(__{field_name}_idx),
+            __value->meta_.AddMember(__{field_name}_key(__{field_name}_idx),
                                      __value_{field_name});
             __value_nbytes += __value_{field_name}->nbytes();
             __{field_name}_idx += 1;
@@ -627,6 +685,7 @@ field_assign_dlist_tpl = '''
         using __{field_name}_value_type = typename decltype(__value->{field_name})::value_type::value_type{element_type};
 
         size_t __{field_name}_idx = 0;
+        IndexedKey __{field_name}_key("__{field_name}-");
         __value->{field_name}.resize({field_name}.size());
         for (auto &__{field_name}_value_vec: {field_name}) {{
             size_t __{field_name}_idy = 0;
@@ -634,7 +693,7 @@ field_assign_dlist_tpl = '''
                 auto __value_{field_name} = std::dynamic_pointer_cast<__{field_name}_value_type>(
                     __{field_name}_value->_Seal(client));
                 __value->{field_name}[__{field_name}_idx].emplace_back({deref}__value_{field_name});
-                __value->meta_.AddMember("__{field_name}-" + std::to_string(__{field_name}_idx) + "-" + std::to_string(__{field_name}_idy),
+                __value->meta_.AddMember(__{field_name}_key(__{field_name}_idx, __{field_name}_idy),
                                          __value_{field_name});
                 __value_nbytes += __value_{field_name}->nbytes();
                 __{field_name}_idy += 1;
@@ -649,11 +708,12 @@ field_assign_set_tpl = '''
         using __{field_name}_value_type = typename decltype(__value->{field_name})::value_type{element_type};
 
         size_t __{field_name}_idx = 0;
+        IndexedKey __{field_name}_key("__{field_name}-");
         for (auto &__{field_name}_value: {field_name}) {{
             auto __value_{field_name} = std::dynamic_pointer_cast<__{field_name}_value_type>(
                 __{field_name}_value->_Seal(client));
             __value->{field_name}.emplace({deref}__value_{field_name});
-            __value->meta_.AddMember("__{field_name}-" + std::to_string(__{field_name}_idx),
+            __value->meta_.AddMember(__{field_name}_key(__{field_name}_idx),
                                       __value_{field_name});
             __value_nbytes += __value_{field_name}->nbytes();
             __{field_name}_idx += 1;
@@ -666,13 +726,14 @@ field_assign_dict_tpl = '''
         using __{field_name}_value_type = typename decltype(__value->{field_name})::mapped_type{element_type};
 
         size_t __{field_name}_idx = 0;
+        IndexedKey __{field_name}_key("__{field_name}-key-"), __{field_name}_value_key("__{field_name}-value-");
         for (auto &__{field_name}_kv: {field_name}) {{
             auto __value_{field_name} = std::dynamic_pointer_cast<__{field_name}_value_type>(
                 __{field_name}_kv.second->_Seal(client));
             __value->{field_name}.emplace(__{field_name}_kv.first, {deref}__value_{field_name});
-            __value->meta_.AddKeyValue("__{field_name}-key-" + std::to_string(__{field_name}_idx),
+            __value->meta_.AddKeyValue(__{field_name}_key(__{field_name}_idx),
                                         __{field_name}_kv.first);
-            __value->meta_.AddMember("__{field_name}-value-" + std::to_string(__{field_name}_idx),
+            __value->meta_.AddMember(__{field_name}_value_key(__{field_name}_idx),
                                      __value_{field_name});
             __value_nbytes += __value_{field_name}->nbytes();
             __{field_name}_idx += 1;
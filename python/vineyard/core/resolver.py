@@ -27,10 +27,24 @@ from vineyard.core.driver import default_driver_context
 class ResolverContext():
     def __init__(self):
         self.__factory = SortedDict()
+        self.__projections = SortedDict()
 
     def register(self, typename_prefix, resolver):
         self.__factory[typename_prefix] = resolver
 
+    def register_projection(self, typename_prefix, projection):
+        ''' Register the projection that keeps only the given columns in the
+            metadata of objects, before the blobs are fetched from vineyard.
+        '''
+        self.__projections[typename_prefix] = projection
+
+    def project(self, client, meta, columns):
+        typename = meta['typename']
+        prefix, projection = find_most_precise_match(typename, self.__projections)
+        if prefix:
+            return projection(client, meta, columns)
+        raise RuntimeError('No proper projection found for typename: %s' % typename)
+
     def run(self, obj, **kw):
         typename = obj.meta.typename
         prefix, resolver = find_most_precise_match(typename, self.__factory)
@@ -63,6 +77,9 @@ def get(client, object_id, resolver=None, **kw):
         resolver:
             When retrieving vineyard object, an optional *resolver* can be specified.
             If no resolver given, the default resolver context will be used.
+        columns: list of str, optional
+            Only the given columns are fetched from vineyard and resolved, for
+            dataframes and tables.
         kw:
             User-specific argument that will be passed to the builder.
 
@@ -73,7 +90,19 @@ def get(client, object_id, resolver=None, **kw):
     if isinstance(object_id, (int, str)):
         object_id = ObjectID(object_id)
     # run resolver
-    obj = client.get_object(object_id)
+    columns = kw.pop('columns', None)
+    if columns is not None:
+        obj = client.get_object(object_id,
+                                lambda meta: default_resolver_context.project(client, meta, columns))
+    else:
+        obj = client.get_object(object_id)
+    return resolve(obj, resolver, **kw)
+
+
+def resolve(obj, resolver=None, **kw):
+    ''' Resolve the vineyard object that has been obtained from vineyard as
+        python value, see also :meth:`get`.
+    '''
     # if the obj has been resolved by pybind types, it should by pass the resolvers
     if type(obj) is not Object:
         return obj
@@ -16,10 +16,11 @@
 # limitations under the License.
 #
 
+import json
 import re
 import pyarrow as pa
 
-from vineyard._C import ObjectMeta
+from vineyard._C import ObjectID, ObjectMeta
 from .utils import normalize_dtype
 
 
@@ -208,7 +209,12 @@ def boolean_array_resolver(obj):
 
 def schema_proxy_resolver(obj):
     buffer = as_arrow_buffer(obj.member('buffer_'))
-    return pa.ipc.read_schema(buffer)
+    schema = pa.ipc.read_schema(buffer)
+    if 'projected_fields_' in obj.meta:
+        # the schema of projected tables, see also `table_projection`
+        indices = json.loads(obj.meta['projected_fields_'])
+        schema = pa.schema([schema.field(idx) for idx in indices], metadata=schema.metadata)
+    return schema
 
 
 def record_batch_resolver(obj, resolver):
@@ -230,6 +236,35 @@ def table_resolver(obj, resolver):
     return pa.Table.from_batches(batches)
 
 
+def table_projection(client, meta, columns):
+    ''' Keep only the given columns in the metadata of table, the schema is
+        fetched from vineyard to resolve the indices of columns.
+    '''
+    schema = client.get(ObjectID(meta['schema_']['id']))
+    indices = []
+    for column in columns:
+        index = schema.get_field_index(column)
+        if index == -1:
+            raise KeyError("Column '%s' doesn't exist in the table" % column)
+        indices.append(index)
+
+    meta['schema_']['projected_fields_'] = json.dumps(indices)
+    for key in ['num_columns_', 'column_num_']:
+        if key in meta:
+            meta[key] = len(indices)
+    for idx in range(int(meta['__batches_-size'])):
+        batch = meta['__batches_-%d' % idx]
+        batch_columns = [batch['__columns_-%d' % index] for index in indices]
+        for index in range(int(batch['__columns_-size'])):
+            del batch['__columns_-%d' % index]
+        for index, column in enumerate(batch_columns):
+            batch['__columns_-%d' % index] = column
+        batch['__columns_-size'] = len(indices)
+        batch['column_num_'] = len(indices)
+        batch['schema_']['projected_fields_'] = json.dumps(indices)
+    return meta
+
+
 def register_arrow_types(builder_ctx=None, resolver_ctx=None):
     if builder_ctx is not None:
         builder_ctx.register(pa.Buffer, buffer_builder)
@@ -251,3 +286,4 @@ def register_arrow_types(builder_ctx=None, resolver_ctx=None):
         resolver_ctx.register('vineyard::SchemaProxy', schema_proxy_resolver)
         resolver_ctx.register('vineyard::RecordBatch', record_batch_resolver)
         resolver_ctx.register('vineyard::Table', table_resolver)
+        resolver_ctx.register_projection('vineyard::Table', table_projection)
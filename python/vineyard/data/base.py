@@ -21,7 +21,7 @@ import re
 
 import vineyard
 from vineyard._C import Object, ObjectMeta
-from .utils import normalize_dtype
+from .utils import build_numpy_buffers, normalize_dtype
 
 
 class ObjectSet:
@@ -83,19 +83,31 @@ def string_builder(client, value):
 
 
 def tuple_builder(client, value, builder):
+    # the buffers of the numpy arrays in the tuple are built in batch
+    arrays = [i for i, item in enumerate(value) if isinstance(item, np.ndarray)]
+    buffers = [None] * len(value)
+    if len(arrays) > 1:
+        for i, buffer in zip(arrays, build_numpy_buffers(client, [value[i] for i in arrays])):
+            buffers[i] = buffer
+
+    def build_item(i):
+        if buffers[i] is None:
+            return builder.run(client, value[i])
+        return builder.run(client, value[i], buffer=buffers[i])
+
     if len(value) == 2:
         # use pair
         meta = ObjectMeta()
         meta['typename'] = 'vineyard::Pair'
-        meta.add_member('first_', builder.run(client, value[0]))
-        meta.add_member('second_', builder.run(client, value[1]))
+        meta.add_member('first_', build_item(0))
+        meta.add_member('second_', build_item(1))
         return client.create_metadata(meta)
     else:
         meta = ObjectMeta()
         meta['typename'] = 'vineyard::Tuple'
         meta['size_'] = 3
-        for i, item in enumerate(value):
-            meta.add_member('__elements_-%d' % i, builder.run(client, item))
+        for i in range(len(value)):
+            meta.add_member('__elements_-%d' % i, build_item(i))
         meta['__elements_-size'] = 3
         return client.create_metadata(meta)
 
@@ -25,33 +25,121 @@ from pandas.core.internals.managers import BlockManager
 from vineyard._C import ObjectMeta
 
 
+def _dataframe_blocks(value):
+    manager = getattr(value, '_mgr', None)
+    if manager is None:
+        manager = value._data
+    return manager.blocks
+
+
+def _build_numeric_blocks(client, value):
+    ''' Copy the consolidated numeric blocks of the dataframe in a bulk, returns
+        the tensor object id for each column in these blocks.
+    '''
+    if not hasattr(client, 'create_tensor_blocks'):
+        return {}
+    blocks, value_types, locations = [], [], []
+    for block in _dataframe_blocks(value):
+        values = block.values
+        if isinstance(values, np.ndarray) and values.ndim == 2 and values.dtype.kind in 'biuf':
+            blocks.append(values)
+            value_types.append(values.dtype.name)
+            locations.append(block.mgr_locs.as_array)
+    if not blocks:
+        return {}
+    columns = dict()
+    for location, tensors in zip(locations, client.create_tensor_blocks(blocks, value_types)):
+        columns.update(zip(location, tensors))
+    return columns
+
+
 def pandas_dataframe_builder(client, value, builder, **kw):
     meta = ObjectMeta()
     meta['typename'] = 'vineyard::DataFrame'
     meta['columns_'] = json.dumps([str(x) for x in value.columns])
+    numeric_columns = _build_numeric_blocks(client, value)
     for i, (name, column_value) in enumerate(value.iteritems()):
-        np_value = column_value.to_numpy(copy=False)
         meta['__values_-key-%d' % i] = str(name)
-        meta.add_member('__values_-value-%d' % i, builder.run(client, np_value))
+        if i in numeric_columns:
+            meta.add_member('__values_-value-%d' % i, numeric_columns[i])
+        else:
+            np_value = column_value.to_numpy(copy=False)
+            meta.add_member('__values_-value-%d' % i, builder.run(client, np_value))
     meta['nbytes'] = 0  # FIXME
     meta['partition_index_row_'] = kw.get('partition_index', [0, 0])[0]
     meta['partition_index_column_'] = kw.get('partition_index', [0, 0])[1]
     return client.create_metadata(meta)
 
 
+def _consolidate_columns(values):
+    ''' Group the adjacent columns that have the same dtype and are placed at
+        addresses of the same stride into 2-D blocks, without copy.
+    '''
+    blocks = []
+    begin = 0
+    while begin < len(values):
+        first = values[begin]
+        end, stride = begin + 1, None
+        if isinstance(first, np.ndarray) and first.ndim == 1 and first.flags['C_CONTIGUOUS'] and first.nbytes > 0:
+            address = first.__array_interface__['data'][0]
+            while end < len(values):
+                value = values[end]
+                if not isinstance(value, np.ndarray) or value.dtype != first.dtype or value.shape != first.shape \
+                        or not value.flags['C_CONTIGUOUS']:
+                    break
+                offset = value.__array_interface__['data'][0] - address
+                if stride is None:
+                    if offset < first.nbytes:
+                        break
+                    stride = offset
+                if offset != stride * (end - begin):
+                    break
+                end += 1
+        if end - begin == 1:
+            block = np.expand_dims(first, 0)
+        else:
+            block = np.lib.stride_tricks.as_strided(first,
+                                                    shape=(end - begin, first.shape[0]),
+                                                    strides=(stride, first.itemsize),
+                                                    writeable=False)
+        blocks.append(Block(block, slice(begin, end, 1)))
+        begin = end
+    return blocks
+
+
 def dataframe_resolver(obj, resolver):
     meta = obj.meta
     columns = json.loads(meta['columns_'])
     if not columns:
         return pd.DataFrame()
     # ensure zero-copy
-    blocks = []
-    index_size = 0
+    values = []
     for idx, name in enumerate(columns):
-        np_value = resolver.run(obj.member('__values_-value-%d' % idx))
-        blocks.append(Block(np.expand_dims(np_value, 0), slice(idx, idx + 1, 1)))
-        index_size = len(np_value)
-    return pd.DataFrame(BlockManager(blocks, [columns, np.arange(index_size)]))
+        values.append(resolver.run(obj.member('__values_-value-%d' % idx)))
+    index_size = len(values[-1])
+    return pd.DataFrame(BlockManager(_consolidate_columns(values), [columns, np.arange(index_size)]))
+
+
+def dataframe_projection(client, meta, columns):
+    ''' Keep only the given columns in the metadata of dataframe.
+    '''
+    columns = [str(column) for column in columns]
+    size = int(meta['__values_-size'])
+    indices = {meta['__values_-key-%d' % idx]: idx for idx in range(size)}
+    values = []
+    for column in columns:
+        if column not in indices:
+            raise KeyError("Column '%s' doesn't exist in the dataframe" % column)
+        values.append(meta['__values_-value-%d' % indices[column]])
+    for idx in range(size):
+        del meta['__values_-key-%d' % idx]
+        del meta['__values_-value-%d' % idx]
+    for idx, (column, value) in enumerate(zip(columns, values)):
+        meta['__values_-key-%d' % idx] = column
+        meta['__values_-value-%d' % idx] = value
+    meta['__values_-size'] = len(columns)
+    meta['columns_'] = json.dumps(columns)
+    return meta
 
 
 def register_dataframe_types(builder_ctx, resolver_ctx):
@@ -60,3 +148,4 @@ def register_dataframe_types(builder_ctx, resolver_ctx):
 
     if resolver_ctx is not None:
         resolver_ctx.register('vineyard::DataFrame', dataframe_resolver)
+        resolver_ctx.register_projection('vineyard::DataFrame', dataframe_projection)
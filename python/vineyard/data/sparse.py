@@ -0,0 +1,99 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import json
+import numpy as np
+
+try:
+    import scipy.sparse as sp
+except ImportError:
+    sp = None
+
+from vineyard._C import ObjectMeta
+from .utils import build_numpy_buffers, normalize_dtype
+
+
+def scipy_csr_matrix_builder(client, value, **kw):
+    ''' Build a :code:`vineyard::CSRTensor` from a `scipy.sparse.csr_matrix`,
+        the row offsets and column indices are stored as int64.
+    '''
+    meta = ObjectMeta()
+    meta['typename'] = 'vineyard::CSRTensor<%s>' % value.dtype.name
+    meta['value_type_'] = value.dtype.name
+    meta['shape_'] = json.dumps(value.shape)
+    meta['nnz_'] = value.nnz
+    indptr, indices, values = build_numpy_buffers(
+        client, [value.indptr.astype(np.int64), value.indices.astype(np.int64), value.data])
+    meta.add_member('indptr_', indptr)
+    meta.add_member('indices_', indices)
+    meta.add_member('values_', values)
+    meta['nbytes'] = (value.shape[0] + 1 + value.nnz) * 8 + value.data.nbytes
+    return client.create_metadata(meta)
+
+
+def scipy_coo_matrix_builder(client, value, **kw):
+    ''' Build a :code:`vineyard::COOTensor` from a `scipy.sparse.coo_matrix`,
+        the coordinates are stored as a `nnz x 2` int64 matrix.
+    '''
+    indices = np.stack([value.row, value.col], axis=1).astype(np.int64)
+    meta = ObjectMeta()
+    meta['typename'] = 'vineyard::COOTensor<%s>' % value.dtype.name
+    meta['value_type_'] = value.dtype.name
+    meta['shape_'] = json.dumps(value.shape)
+    meta['nnz_'] = value.nnz
+    indices_buffer, values_buffer = build_numpy_buffers(client, [indices, value.data])
+    meta.add_member('indices_', indices_buffer)
+    meta.add_member('values_', values_buffer)
+    meta['nbytes'] = indices.nbytes + value.data.nbytes
+    return client.create_metadata(meta)
+
+
+def _buffer(obj, name, dtype):
+    return np.frombuffer(memoryview(obj.member(name)), dtype=dtype)
+
+
+def csr_tensor_resolver(obj):
+    meta = obj.meta
+    value_type = normalize_dtype(meta['value_type_'])
+    shape = tuple(json.loads(meta['shape_']))
+    return sp.csr_matrix(
+        (_buffer(obj, 'values_', value_type), _buffer(obj, 'indices_', np.int64), _buffer(obj, 'indptr_', np.int64)),
+        shape=shape,
+        copy=False)
+
+
+def coo_tensor_resolver(obj):
+    meta = obj.meta
+    value_type = normalize_dtype(meta['value_type_'])
+    shape = tuple(json.loads(meta['shape_']))
+    indices = _buffer(obj, 'indices_', np.int64).reshape(-1, len(shape))
+    return sp.coo_matrix((_buffer(obj, 'values_', value_type), (indices[:, 0], indices[:, 1])), shape=shape, copy=False)
+
+
+def register_sparse_types(builder_ctx, resolver_ctx):
+    # the sparse tensors are resolved to scipy.sparse, only when scipy presents
+    if sp is None:
+        return
+
+    if builder_ctx is not None:
+        builder_ctx.register(sp.csr_matrix, scipy_csr_matrix_builder)
+        builder_ctx.register(sp.coo_matrix, scipy_coo_matrix_builder)
+
+    if resolver_ctx is not None:
+        resolver_ctx.register('vineyard::CSRTensor', csr_tensor_resolver)
+        resolver_ctx.register('vineyard::COOTensor', coo_tensor_resolver)
@@ -16,29 +16,138 @@
 # limitations under the License.
 #
 
+import bisect
+import itertools
 import json
 import numpy as np
 
 from vineyard._C import ObjectMeta
-from .utils import build_numpy_buffer, normalize_dtype
+from .base import ObjectSet
+from .utils import build_numpy_buffer, build_numpy_buffers, normalize_dtype
+
+
+class GlobalTensor:
+    ''' The global tensor, whose partitions are placed on a grid of
+        `partition_shape`, and every partition can be stored in different
+        vineyard instances.
+    '''
+    def __init__(self, obj):
+        self.meta = obj.meta
+        self.shape = json.loads(self.meta['shape_'])
+        self.partition_shape = json.loads(self.meta['partition_shape_'])
+        self.partitions = ObjectSet(obj.member('partitions_'))
+
+        # the boundaries of partitions on each axis
+        extents = [[None] * n for n in self.partition_shape]
+        self._grid = {}
+        for i in range(self.partitions.num_of_objects):
+            member = self.partitions.get_member(i)
+            index = tuple(json.loads(member.meta['partition_index_'])) or (0, ) * len(self.shape)
+            for axis, extent in enumerate(json.loads(member.meta['shape_'])):
+                extents[axis][index[axis]] = extent
+            self._grid[index] = member
+        self.partition_offsets = []
+        for axis, n in enumerate(self.partition_shape):
+            chunk_size = -(-self.shape[axis] // n)
+            offsets = [0]
+            for k in range(n):
+                extent = extents[axis][k]
+                if extent is None:
+                    extent = max(0, min(chunk_size, self.shape[axis] - offsets[-1]))
+                offsets.append(offsets[-1] + extent)
+            self.partition_offsets.append(offsets)
+
+    def slice(self, begin, end, instance_id=None):
+        ''' Return the views of partitions that overlap with the region
+            `[begin, end)`, as a list of tuples of the begin of views in the
+            global tensor and the numpy views.
+
+            Only the partitions on the given instance are returned if the
+            :code:`instance_id` is not None, and only the overlapped partitions
+            are visited.
+        '''
+        ranges = []
+        for axis, offsets in enumerate(self.partition_offsets):
+            if begin[axis] >= end[axis]:
+                return []
+            first = bisect.bisect_right(offsets, begin[axis]) - 1
+            last = bisect.bisect_left(offsets, end[axis])
+            ranges.append(range(first, last))
+
+        chunks = []
+        for index in itertools.product(*ranges):
+            member = self._grid.get(index, None)
+            if member is None or (instance_id is not None and member.meta.instance_id != instance_id):
+                continue
+            slices, global_offset = [], []
+            for axis, k in enumerate(index):
+                offsets = self.partition_offsets[axis]
+                lower, upper = max(begin[axis], offsets[k]), min(end[axis], offsets[k + 1])
+                slices.append(slice(lower - offsets[k], upper - offsets[k]))
+                global_offset.append(lower)
+            chunks.append((global_offset, tensor_resolver(member)[tuple(slices)]))
+        return chunks
 
 
 def numpy_ndarray_builder(client, value, **kw):
+    partition_shape = kw.get('partition_shape', None)
+    if partition_shape is not None:
+        return numpy_ndarray_partitioned_builder(client, value, partition_shape)
     meta = ObjectMeta()
     meta['typename'] = 'vineyard::Tensor<%s>' % value.dtype.name
     meta['value_type_'] = value.dtype.name
     meta['shape_'] = json.dumps(value.shape)
     meta['partition_index_'] = json.dumps(kw.get('partition_index', []))
     meta['nbytes'] = value.nbytes
-    meta.add_member('buffer_', build_numpy_buffer(client, value))
+    # the buffer may have been built in batch with other arrays
+    buffer = kw.get('buffer', None)
+    meta.add_member('buffer_', buffer if buffer is not None else build_numpy_buffer(client, value))
+    return client.create_metadata(meta)
+
+
+def numpy_ndarray_partitioned_builder(client, value, partition_shape):
+    ''' Split the ndarray to a grid of `partition_shape`, and build every
+        partition as a tensor, rather than a single blob for the whole array.
+    '''
+    chunk_shape = [-(-s // n) for s, n in zip(value.shape, partition_shape)]
+    partitions = ObjectMeta()
+    partitions['typename'] = 'vineyard::ObjectSet'
+    partitions['num_of_instances'] = 1
+    indices = list(itertools.product(*[range(n) for n in partition_shape]))
+    chunks = []
+    for index in indices:
+        slices = tuple(slice(k * c, (k + 1) * c) for k, c in zip(index, chunk_shape))
+        chunks.append(np.ascontiguousarray(value[slices]))
+    object_index = 0
+    for index, chunk, buffer in zip(indices, chunks, build_numpy_buffers(client, chunks)):
+        chunk_id = numpy_ndarray_builder(client, chunk, partition_index=list(index), buffer=buffer)
+        client.persist(chunk_id)
+        partitions.add_member('object_%d' % object_index, chunk_id)
+        object_index += 1
+    partitions['num_of_objects'] = object_index
+
+    meta = ObjectMeta()
+    meta['typename'] = 'vineyard::GlobalTensor'
+    meta['shape_'] = json.dumps(value.shape)
+    meta['partition_shape_'] = json.dumps(list(partition_shape))
+    meta.add_member('partitions_', client.create_metadata(partitions))
     return client.create_metadata(meta)
 
 
+def global_tensor_resolver(obj):
+    return GlobalTensor(obj)
+
+
 def tensor_resolver(obj):
     meta = obj.meta
     value_type = normalize_dtype(meta['value_type_'])
     shape = json.loads(meta['shape_'])
-    return np.frombuffer(memoryview(obj.member("buffer_")), dtype=value_type).reshape(shape)
+    buffer = memoryview(obj.member("buffer_"))
+    if 'offset_' not in meta:
+        return np.frombuffer(buffer, dtype=value_type).reshape(shape)
+    # views of slices and reshapes share the buffer of the tensor they are made of
+    strides = json.loads(meta['strides_']) if 'strides_' in meta else []
+    return np.ndarray(shape, dtype=value_type, buffer=buffer, offset=int(meta['offset_']), strides=strides or None)
 
 
 def register_tensor_types(builder_ctx, resolver_ctx):
@@ -47,3 +156,4 @@ def register_tensor_types(builder_ctx, resolver_ctx):
 
     if resolver_ctx is not None:
         resolver_ctx.register('vineyard::Tensor', tensor_resolver)
+        resolver_ctx.register('vineyard::GlobalTensor', global_tensor_resolver)
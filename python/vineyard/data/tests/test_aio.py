@@ -0,0 +1,52 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import asyncio
+
+import numpy as np
+import pytest
+
+import vineyard
+import vineyard.aio
+from vineyard.core import default_builder_context, default_resolver_context
+from vineyard.data import register_builtin_types
+
+register_builtin_types(default_builder_context, default_resolver_context)
+
+
+def test_async_get(vineyard_ipc_socket):
+    client = vineyard.connect(vineyard_ipc_socket)
+    values = [np.arange(i + 1) for i in range(16)]
+    object_ids = [client.put(value) for value in values]
+
+    async def get_all():
+        async_client = vineyard.aio.connect(vineyard_ipc_socket)
+        return await asyncio.gather(*[async_client.get(object_id) for object_id in object_ids])
+
+    results = asyncio.get_event_loop().run_until_complete(get_all())
+    for value, result in zip(values, results):
+        np.testing.assert_equal(value, result)
+
+
+def test_async_get_error(vineyard_ipc_socket):
+    async def get_invalid():
+        async_client = vineyard.aio.connect(vineyard_ipc_socket)
+        await async_client.get_meta(vineyard.ObjectID('ffffffffffffffff'))
+
+    with pytest.raises(Exception):
+        asyncio.get_event_loop().run_until_complete(get_invalid())
@@ -71,3 +71,27 @@ def test_table(vineyard_client):
     table = pa.Table.from_batches(batches)
     object_id = vineyard_client.put(table)
     assert table.equals(vineyard_client.get(object_id))
+
+
+def test_table_projection(vineyard_client):
+    arrays = [pa.array([1, 2, 3, 4]), pa.array(['foo', 'bar', 'baz', None]), pa.array([True, None, False, True])]
+    batch = pa.RecordBatch.from_arrays(arrays, ['f0', 'f1', 'f2'])
+    table = pa.Table.from_batches([batch] * 5)
+    object_id = vineyard_client.put(table)
+    assert table.select(['f2', 'f0']).equals(vineyard_client.get(object_id, columns=['f2', 'f0']))
+
+
+def test_export_arrow(vineyard_client):
+    import vineyard.exchange
+
+    arr = pa.array([1, 2, None, 3])
+    obj = vineyard_client.get_object(vineyard_client.put(arr))
+    assert arr.equals(vineyard.exchange.to_arrow(obj))
+
+    batch = pa.RecordBatch.from_arrays([pa.array([1, 2, 3]), pa.array(['a', 'bb', 'ccc'])], ['f0', 'f1'])
+    obj = vineyard_client.get_object(vineyard_client.put(batch))
+    assert batch.equals(vineyard.exchange.to_arrow(obj))
+
+    table = pa.Table.from_batches([batch] * 3)
+    obj = vineyard_client.get_object(vineyard_client.put(table))
+    assert table.equals(vineyard.exchange.to_arrow(obj))
@@ -16,9 +16,13 @@
 # limitations under the License.
 #
 
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
 import pytest
 
 import vineyard
+from vineyard._C import ObjectMeta
 from vineyard.core import default_builder_context, default_resolver_context
 from vineyard.data import register_builtin_types
 
@@ -48,3 +52,42 @@ def test_pair(vineyard_client):
 def test_tuple(vineyard_client):
     object_id = vineyard_client.put((1, "2", 3.456))
     assert vineyard_client.get(object_id) == (1, "2", pytest.approx(3.456))
+
+
+def test_tuple_of_arrays(vineyard_client):
+    arrays = (np.arange(10), np.zeros((0, 3)), np.random.rand(4, 5).T)
+    values = vineyard_client.get(vineyard_client.put(arrays))
+    assert len(values) == len(arrays)
+    for value, array in zip(values, arrays):
+        np.testing.assert_equal(value, array)
+
+
+def test_batch_create_blobs_from_buffers(vineyard_client):
+    arrays = [np.arange(10, dtype=np.int32), np.array([], dtype=np.int64), np.random.rand(16)]
+    blobs = vineyard_client.create_blobs_from_buffers(arrays, concurrency=2)
+    assert [len(blob) for blob in blobs] == [array.nbytes for array in arrays]
+    for blob, array in zip(blobs, arrays):
+        assert memoryview(blob).tobytes() == array.tobytes()
+
+
+def test_concurrent_get(vineyard_client):
+    object_ids = [vineyard_client.put('value-%d' % i) for i in range(64)]
+    with ThreadPoolExecutor(max_workers=8) as executor:
+        values = list(executor.map(vineyard_client.get, object_ids))
+    assert values == ['value-%d' % i for i in range(64)]
+
+
+def test_batch_create_blobs(vineyard_client):
+    blobs = vineyard_client.create_blobs([1, 2, 3])
+    assert [len(blob) for blob in blobs] == [1, 2, 3]
+
+
+def test_batch_create_metadata(vineyard_client):
+    metas = []
+    for i in range(3):
+        meta = ObjectMeta()
+        meta['typename'] = 'vineyard::Test'
+        meta['value'] = i
+        metas.append(meta)
+    object_ids = vineyard_client.create_metadata(metas)
+    assert [int(vineyard_client.get_meta(object_id)['value']) for object_id in object_ids] == [0, 1, 2]
@@ -16,6 +16,7 @@
 # limitations under the License.
 #
 
+import numpy as np
 import pandas as pd
 import pytest
 
@@ -30,3 +31,28 @@ def test_pandas_dataframe(vineyard_client):
     df = pd.DataFrame({'a': [1, 2, 3, 4], 'b': [5, 6, 7, 8]})
     object_id = vineyard_client.put(df)
     pd.testing.assert_frame_equal(df, vineyard_client.get(object_id))
+
+
+def test_pandas_dataframe_projection(vineyard_client):
+    df = pd.DataFrame({'a': [1, 2, 3, 4], 'b': [5, 6, 7, 8], 'c': [9, 10, 11, 12]})
+    object_id = vineyard_client.put(df)
+    pd.testing.assert_frame_equal(df[['c', 'a']], vineyard_client.get(object_id, columns=['c', 'a']))
+    with pytest.raises(KeyError):
+        vineyard_client.get(object_id, columns=['d'])
+
+
+def test_pandas_dataframe_wide(vineyard_client):
+    df = pd.DataFrame(np.random.rand(100, 200), columns=['c%d' % i for i in range(200)])
+    df['int'] = np.arange(100, dtype=np.int64)
+    df['str'] = ['s%d' % i for i in range(100)]
+    object_id = vineyard_client.put(df)
+    result = vineyard_client.get(object_id)
+    pd.testing.assert_frame_equal(df, result)
+    # columns of a consolidated block are resolved as a single 2-D block
+    assert len(result._mgr.blocks if hasattr(result, '_mgr') else result._data.blocks) < 10
+
+
+def test_pandas_dataframe_empty_rows(vineyard_client):
+    df = pd.DataFrame({'a': np.array([], dtype=np.int64), 'b': np.array([], dtype=np.float64)})
+    object_id = vineyard_client.put(df)
+    pd.testing.assert_frame_equal(df, vineyard_client.get(object_id), check_index_type=False)
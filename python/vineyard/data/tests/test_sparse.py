@@ -0,0 +1,47 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+import pytest
+
+from vineyard.core import default_builder_context, default_resolver_context
+from vineyard.data import register_builtin_types
+
+sp = pytest.importorskip('scipy.sparse')
+
+register_builtin_types(default_builder_context, default_resolver_context)
+
+
+def test_scipy_csr_matrix(vineyard_client):
+    mat = sp.random(20, 30, density=0.1, format='csr', dtype=np.float64)
+    result = vineyard_client.get(vineyard_client.put(mat))
+    assert isinstance(result, sp.csr_matrix)
+    assert result.shape == mat.shape
+    assert result.nnz == mat.nnz
+    np.testing.assert_allclose(mat.toarray(), result.toarray())
+
+    # the rows can be sliced without touching the other rows
+    np.testing.assert_allclose(mat[5:9].toarray(), result[5:9].toarray())
+
+
+def test_scipy_coo_matrix(vineyard_client):
+    mat = sp.random(20, 30, density=0.1, format='coo', dtype=np.int64)
+    result = vineyard_client.get(vineyard_client.put(mat))
+    assert isinstance(result, sp.coo_matrix)
+    assert result.nnz == mat.nnz
+    np.testing.assert_array_equal(mat.toarray(), result.toarray())
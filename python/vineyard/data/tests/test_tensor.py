@@ -30,3 +30,27 @@ def test_numpy_ndarray(vineyard_client):
     arr = np.random.rand(4, 5, 6)
     object_id = vineyard_client.put(arr)
     np.testing.assert_allclose(arr, vineyard_client.get(object_id))
+
+
+def test_numpy_ndarray_partitioned(vineyard_client):
+    arr = np.random.rand(5, 7)
+    object_id = vineyard_client.put(arr, partition_shape=[2, 3])
+    tensor = vineyard_client.get(object_id)
+    assert tensor.shape == [5, 7]
+    assert tensor.partition_offsets == [[0, 3, 5], [0, 3, 6, 7]]
+
+    chunks = tensor.slice([2, 1], [4, 4], instance_id=vineyard_client.instance_id)
+    assert len(chunks) == 4
+    for (row, column), view in chunks:
+        np.testing.assert_allclose(arr[row:row + view.shape[0], column:column + view.shape[1]], view)
+    assert sum(view.size for _, view in chunks) == 2 * 3
+
+
+def test_export_dlpack(vineyard_client):
+    torch_dlpack = pytest.importorskip('torch.utils.dlpack')
+    import vineyard.exchange
+
+    arr = np.random.rand(4, 5)
+    obj = vineyard_client.get_object(vineyard_client.put(arr))
+    tensor = torch_dlpack.from_dlpack(vineyard.exchange.to_dlpack(obj))
+    np.testing.assert_allclose(arr, tensor.numpy())
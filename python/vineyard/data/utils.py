@@ -52,3 +52,16 @@ def build_numpy_buffer(client, array):
         array = np.ascontiguousarray(array)
     address, _ = array.__array_interface__['data']
     return build_buffer(client, address, array.nbytes)
+
+
+def build_numpy_buffers(client, arrays):
+    ''' Build the blobs of many arrays at once: the blobs are allocated by a single
+        request, and the arrays are copied by multiple threads without the GIL, see
+        also :meth:`IPCClient.create_blobs_from_buffers`.
+    '''
+    arrays = [array if array.flags['C_CONTIGUOUS'] else np.ascontiguousarray(array) for array in arrays]
+    if not hasattr(client, 'create_blobs_from_buffers'):
+        return [build_numpy_buffer(client, array) for array in arrays]
+    # the blobs are shaped as bytes, as numpy only exports the buffer protocol of
+    # the arrays of some dtypes
+    return client.create_blobs_from_buffers([array.reshape(-1).view(np.uint8) for array in arrays])
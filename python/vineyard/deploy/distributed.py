@@ -17,12 +17,207 @@
 #
 
 import contextlib
+import logging
 import pkg_resources
+import re
 import subprocess
 import textwrap
 import time
 
-from .utils import start_etcd, ssh_base_cmd
+from .utils import start_etcd, start_etcd_cluster, ssh_base_cmd
+
+logger = logging.getLogger('vineyard')
+
+# prints the NUMA nodes (CPUs, free memory and free huge pages), the IPv4
+# addresses of the NICs with their NUMA nodes, and the available memory.
+_TOPOLOGY_SCRIPT = r'''
+for d in /sys/devices/system/node/node[0-9]*; do
+  [ -d "$d" ] || continue
+  n=${d##*node}
+  echo "node $n cpus $(cat $d/cpulist)"
+  echo "node $n memfree $(awk '/MemFree/ {print $4}' $d/meminfo)"
+  for h in $d/hugepages/hugepages-*kB; do
+    [ -d "$h" ] && echo "node $n hugepages ${h##*hugepages-} $(cat $h/free_hugepages)"
+  done
+done
+for i in /sys/class/net/*; do
+  name=${i##*/}
+  [ "$name" = lo ] && continue
+  numa=$(cat $i/device/numa_node 2>/dev/null || echo -1)
+  for a in $(ip -4 -o addr show dev $name 2>/dev/null | awk '{print $4}'); do
+    echo "nic $name $numa ${a%/*}"
+  done
+done
+echo "memavailable $(awk '/MemAvailable/ {print $2}' /proc/meminfo)"
+'''
+
+# the huge page sizes that vineyardd supports, in kB
+_HUGE_PAGE_SIZES = {2048: '2Mi', 1048576: '1Gi'}
+
+
+def parse_topology(output):
+    ''' Parse the output of the topology discovery script of a host.
+
+    Returns a dict of the NUMA nodes (with their CPUs, free memory and free huge pages in
+    bytes per page size), the NICs (with their NUMA node and IPv4 address) and the available
+    memory of the host, in bytes.
+    '''
+    nodes, nics, available = {}, [], 0
+    for line in output.splitlines():
+        fields = line.split()
+        try:
+            if len(fields) >= 4 and fields[0] == 'node':
+                node = nodes.setdefault(int(fields[1]), {'id': int(fields[1]), 'hugepages': {}})
+                if fields[2] == 'cpus':
+                    node['cpus'] = fields[3]
+                elif fields[2] == 'memfree':
+                    node['memfree'] = int(fields[3]) * 1024
+                elif fields[2] == 'hugepages' and len(fields) == 5:
+                    page_size = int(re.sub('kB$', '', fields[3]))
+                    node['hugepages'][page_size] = int(fields[4]) * page_size * 1024
+            elif len(fields) == 4 and fields[0] == 'nic':
+                nics.append({'name': fields[1], 'numa_node': int(fields[2]), 'address': fields[3]})
+            elif len(fields) == 2 and fields[0] == 'memavailable':
+                available = int(fields[1]) * 1024
+        except ValueError:
+            continue
+    return {'numa_nodes': [nodes[k] for k in sorted(nodes)], 'nics': nics, 'memavailable': available}
+
+
+def discover_topology(host):
+    ''' Discover the NUMA nodes, huge pages and NICs of the host, see also :func:`parse_topology`.
+
+    Returns None if the topology cannot be discovered.
+    '''
+    try:
+        output = subprocess.run(ssh_base_cmd(host) + ['sh', '-s'],
+                                input=_TOPOLOGY_SCRIPT,
+                                stdout=subprocess.PIPE,
+                                stderr=subprocess.DEVNULL,
+                                universal_newlines=True,
+                                timeout=30,
+                                check=True).stdout
+    except (OSError, subprocess.SubprocessError) as e:
+        logger.warning('Failed to discover the topology of %s: %s', host, e)
+        return None
+    return parse_topology(output)
+
+
+def _huge_pages(nodes):
+    ''' The supported huge page size that has the most free bytes on the nodes, and the bytes. '''
+    candidates = {}
+    for node in nodes:
+        for page_size, free in node['hugepages'].items():
+            if page_size in _HUGE_PAGE_SIZES:
+                candidates[page_size] = candidates.get(page_size, 0) + free
+    if not candidates or max(candidates.values()) == 0:
+        return None, 0
+    page_size = max(candidates, key=lambda k: candidates[k])
+    return _HUGE_PAGE_SIZES[page_size], candidates[page_size]
+
+
+def plan_instances(topology, size='256M', per_numa_node=True, memory_fraction=0.8):
+    ''' Place the vineyardd instances of a host on its topology.
+
+    Parameters:
+        topology: dict
+            The topology of the host, see :func:`discover_topology`, or None if unknown.
+        size: str or int
+            The shared memory size of every instance, or :code:`'auto'` to size the
+            instances by the free huge pages of their NUMA nodes (then vineyardd is backed by
+            the huge pages), or by :code:`memory_fraction` of the free memory of the nodes.
+        per_numa_node: bool
+            Launch an instance per NUMA node, which is pinned to the node (:code:`--numa_node`),
+            and binds its RPC server to the address of a NIC that is local to the node.
+        memory_fraction: float
+            The fraction of the free memory that the instances take when :code:`size` is
+            :code:`'auto'` and there're no huge pages.
+
+    Returns a list of dicts of the :code:`numa_node`, :code:`size`, :code:`huge_page_size` and
+    :code:`rpc_host` of every instance, where the ones that are not decided are None.
+    '''
+    if topology is None:
+        topology = {'numa_nodes': [], 'nics': [], 'memavailable': 0}
+    nodes = topology['numa_nodes']
+    if per_numa_node and len(nodes) > 1:
+        groups = [[node] for node in nodes]
+    else:
+        groups = [nodes]
+
+    instances = []
+    for group in groups:
+        instance = {'numa_node': None, 'size': size, 'huge_page_size': None, 'rpc_host': None}
+        if len(groups) > 1:
+            node = group[0]['id']
+            instance['numa_node'] = node
+            local_nics = [nic for nic in topology['nics'] if nic['numa_node'] == node]
+            if local_nics:
+                instance['rpc_host'] = local_nics[0]['address']
+        if size == 'auto':
+            huge_page_size, huge_bytes = _huge_pages(group)
+            if huge_page_size is not None:
+                instance['huge_page_size'] = huge_page_size
+                instance['size'] = huge_bytes
+            else:
+                free = sum(node.get('memfree', 0) for node in group)
+                if not group:
+                    free = topology['memavailable']
+                if free > 0:
+                    instance['size'] = int(free * memory_fraction)
+                else:
+                    instance['size'] = '256M'
+        instances.append(instance)
+    return instances
+
+
+def _ping_script(targets):
+    return ''.join('(ping -c 3 -q -W 1 %s 2>/dev/null | tail -n 1 | sed "s/^/%s /") &\n' % (t, t)
+                   for t in targets) + 'wait\n'
+
+
+def measure_latency(hosts):
+    ''' The mean round-trip time (in milliseconds) from every host to each of the others,
+    measured by ping on the hosts. The unreachable pairs are infinite.
+    '''
+    latency = {}
+    for host in hosts:
+        others = [h for h in hosts if h != host]
+        latency[host] = {h: float('inf') for h in others}
+        if not others:
+            continue
+        try:
+            output = subprocess.run(ssh_base_cmd(host) + ['sh', '-s'],
+                                    input=_ping_script(others),
+                                    stdout=subprocess.PIPE,
+                                    stderr=subprocess.DEVNULL,
+                                    universal_newlines=True,
+                                    timeout=30).stdout
+        except (OSError, subprocess.SubprocessError):
+            continue
+        for line in output.splitlines():
+            # e.g., "host rtt min/avg/max/mdev = 0.031/0.042/0.051/0.008 ms"
+            matched = re.match(r'(\S+) .*= [\d.]+/([\d.]+)/', line)
+            if matched and matched.group(1) in latency[host]:
+                latency[host][matched.group(1)] = float(matched.group(2))
+    return latency
+
+
+def choose_etcd_hosts(hosts, members=None):
+    ''' Choose the hosts of the etcd members: the ones that are closest to the other hosts, as
+    every vineyardd talks to etcd. There're 3 members if there're at least 3 hosts, otherwise 1.
+    '''
+    hosts = list(dict.fromkeys(hosts))
+    if members is None:
+        members = 3 if len(hosts) >= 3 else 1
+    if len(hosts) <= members:
+        return hosts
+    latency = measure_latency(hosts)
+
+    def score(host):
+        rtts = sorted(latency[host].values())
+        return rtts[len(rtts) // 2]
+
+    return sorted(hosts, key=lambda host: (score(host), hosts.index(host)))[:members]
 
 
 @contextlib.contextmanager
@@ -32,9 +227,16 @@ def start_vineyardd(hosts=None,
                     size='256M',
                     socket='/var/run/vineyard.sock',
                     rpc_socket_port=9600,
-                    debug=False):
+                    debug=False,
+                    per_numa_node=True,
+                    etcd_members=None):
     ''' Launch a local vineyard cluster in a distributed fashion.
 
+    The instances are placed on the topology of the hosts (see :func:`plan_instances`): a host
+    of multiple NUMA nodes runs an instance per node, which is pinned to the node and serves RPC
+    on a NIC of the node. The instance on the first NUMA node listens on :code:`socket`, and the
+    one on node `n` listens on :code:`socket.n`, with the RPC port :code:`rpc_socket_port + n`.
+
     Parameters:
         hosts: list of str
             A list of machines to launch vineyard server.
@@ -59,12 +261,21 @@ def start_vineyardd(hosts=None,
             .. code::
 
                 128974848, 129k, 129M, 123Mi, 1G, 10Gi, ...
+
+            Or :code:`'auto'` to size every instance by the free huge pages (or the free memory)
+            of its NUMA node.
         socket: str
             The UNIX domain socket socket path that vineyard server will listen on.
         rpc_socket_port: int
             The port that vineyard will use to privode RPC service.
         debug: bool
             Whether print debug logs.
+        per_numa_node: bool
+            Whether to launch an instance per NUMA node on the hosts of multiple NUMA nodes.
+        etcd_members: int
+            The number of the etcd members that are launched if :code:`etcd_endpoints` is not
+            specified, on the hosts that have the lowest latency to the others, 3 by default if
+            there're at least 3 hosts, otherwise 1.
     '''
     if vineyardd_path is None:
         vineyardd_path = pkg_resources.resource_filename('vineyard', 'vineyardd')
@@ -73,7 +284,11 @@ def start_vineyardd(hosts=None,
         hosts = ['localhost']
 
     if etcd_endpoints is None:
-        etcd_ctx = start_etcd(host=hosts[0])
+        etcd_hosts = choose_etcd_hosts(hosts, etcd_members)
+        if len(etcd_hosts) == 1:
+            etcd_ctx = start_etcd(host=etcd_hosts[0])
+        else:
+            etcd_ctx = start_etcd_cluster(etcd_hosts)
         etcd_proc, etcd_endpoints = etcd_ctx.__enter__()  # pylint: disable=no-member
     else:
         etcd_ctx = None
@@ -82,20 +297,36 @@ def start_vineyardd(hosts=None,
     if debug:
         env['GLOG_v'] = 11
 
-    # yapf: disable
-    command = [
-        vineyardd_path,
-        '--deployment', 'distributed',
-        '--size', str(size),
-        '--socket', socket,
-        '--rpc_socket_port', str(rpc_socket_port),
-        '--etcd_endpoint', etcd_endpoints
-    ]
-    # yapf: enable
+    def instance_command(index, instance):
+        # yapf: disable
+        command = [
+            vineyardd_path,
+            '--deployment', 'distributed',
+            '--size', str(instance['size']),
+            '--socket', socket if index == 0 else '%s.%d' % (socket, instance['numa_node']),
+            '--rpc_socket_port', str(rpc_socket_port + (instance['numa_node'] or 0)),
+            '--etcd_endpoint', etcd_endpoints
+        ]
+        # yapf: enable
+        if instance['numa_node'] is not None:
+            command.extend(['--numa_node', str(instance['numa_node'])])
+        if instance['huge_page_size'] is not None:
+            command.extend(['--huge_page_size', instance['huge_page_size']])
+        if instance['rpc_host'] is not None:
+            command.extend(['--rpc_host', instance['rpc_host']])
+        return command
 
     try:
         procs = []
+        commands = []
         for host in hosts:
+            if per_numa_node or size == 'auto':
+                instances = plan_instances(discover_topology(host), size, per_numa_node)
+            else:
+                instances = plan_instances(None, size, per_numa_node)
+            for index, instance in enumerate(instances):
+                commands.append((host, instance_command(index, instance)))
+        for host, command in commands:
             proc = subprocess.Popen(ssh_base_cmd(host) + command,
                                     env=env,
                                     stdout=subprocess.PIPE,
@@ -23,6 +23,7 @@ import socket
 import subprocess
 import textwrap
 import time
+import uuid
 
 
 def ssh_base_cmd(host):
@@ -116,3 +117,55 @@ def start_etcd(host=None, etcd_executable=None):
         print('Etcd being killed...')
         if proc is not None and proc.poll() is None:
             proc.terminate()
+
+
+@contextlib.contextmanager
+def start_etcd_cluster(hosts, etcd_executable=None, client_port=2379, peer_port=2380):
+    ''' Launch an etcd cluster with a member on each of the given hosts.
+
+    Yields the processes of the members and the client endpoints joined by ",",
+    which vineyardd accepts as `--etcd_endpoint`.
+    '''
+    if etcd_executable is None:
+        etcd_executable = '/usr/local/bin/etcd'
+    # every launch starts a new cluster, rather than joining the data
+    # directories that are left by previous runs
+    token = uuid.uuid4().hex[:8]
+    names = ['vineyard-etcd-%d' % index for index in range(len(hosts))]
+    initial_cluster = ','.join('%s=http://%s:%d' % (name, host, peer_port) for name, host in zip(names, hosts))
+
+    procs = []
+    try:
+        for name, host in zip(names, hosts):
+            # yapf: disable
+            prog_args = [
+                etcd_executable,
+                '--name', name,
+                '--data-dir', '/tmp/%s-%s' % (name, token),
+                '--max-txn-ops=102400',
+                '--listen-peer-urls', 'http://0.0.0.0:%d' % peer_port,
+                '--listen-client-urls', 'http://0.0.0.0:%d' % client_port,
+                '--advertise-client-urls', 'http://%s:%d' % (host, client_port),
+                '--initial-advertise-peer-urls', 'http://%s:%d' % (host, peer_port),
+                '--initial-cluster', initial_cluster,
+                '--initial-cluster-token', token,
+                '--initial-cluster-state', 'new'
+            ]
+            # yapf: enable
+            procs.append(
+                subprocess.Popen(ssh_base_cmd(host) + prog_args,
+                                 stdout=subprocess.PIPE,
+                                 stderr=subprocess.STDOUT,
+                                 universal_newlines=True,
+                                 encoding='utf-8'))
+        time.sleep(1)
+        for host, proc in zip(hosts, procs):
+            if proc.poll() is not None:
+                err = textwrap.indent(proc.stdout.read(), ' ' * 4)
+                raise RuntimeError('Failed to launch program etcd on %s, error:\n%s' % (host, err))
+        yield procs, ','.join('http://%s:%d' % (host, client_port) for host in hosts)
+    finally:
+        print('Etcd cluster being killed...')
+        for proc in procs:
+            if proc.poll() is None:
+                proc.terminate()
@@ -0,0 +1,66 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+''' Zero-copy exchange of vineyard objects with other frameworks through the
+    standard Arrow C data interface and DLPack, e.g.,
+
+    .. code:: python
+
+        >>> import torch.utils.dlpack
+        >>> obj = client.get_object(tensor_id)
+        >>> tensor = torch.utils.dlpack.from_dlpack(vineyard.exchange.to_dlpack(obj))
+
+    The exported values reference the memory that has been mapped into the client,
+    thus the client must be kept alive as long as the exported values are in use.
+'''
+
+from vineyard._C import _to_arrow, _to_dlpack
+
+
+def to_arrow(obj):
+    ''' Export a vineyard array, record batch or table to the corresponding
+        :code:`pyarrow` value without copying the payloads.
+
+        Parameters:
+            obj: Object
+                The vineyard object to export.
+
+        Returns:
+            A :code:`pyarrow.Array`, :code:`pyarrow.RecordBatch` or
+            :code:`pyarrow.Table`.
+    '''
+    return _to_arrow(obj)
+
+
+def to_dlpack(obj):
+    ''' Export a vineyard tensor as a DLPack capsule (named :code:`dltensor`)
+        on CPU without copying the payload. The consumer must treat the tensor
+        as read-only.
+
+        Parameters:
+            obj: Object
+                The vineyard tensor to export.
+
+        Returns:
+            A :code:`PyCapsule` that can be consumed by :code:`from_dlpack` of
+            other frameworks.
+    '''
+    return _to_dlpack(obj)
+
+
+__all__ = ['to_arrow', 'to_dlpack']
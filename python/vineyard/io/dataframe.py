@@ -54,6 +54,16 @@
     ----> 1 chunk = reader.next()
 
     StreamDrainedException: Stream drained: no more chunks
+
+    # or read the chunks as record batches, which are read from the mapped
+    # chunks zero-copy, and are valid only until the next chunk is read,
+    # unless `copy=True`
+    >>> reader = stream.open_reader(client)
+    >>> batch = reader.read_batch()
+    >>> batch
+    <pyarrow.lib.RecordBatch at 0x13c8a0130>
+    >>> for batch in reader:
+    ...     process(batch)
 '''
 
 from vineyard._C import DataframeStream, DataframeStreamBuilder, DataframeStreamReader, DataframeStreamWriter
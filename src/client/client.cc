@@ -15,20 +15,241 @@ limitations under the License.
 
 #include "client/client.h"
 
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
+#include <thread>
 #include <utility>
 
 #include "boost/range/combine.hpp"
 
 #include "client/ds/blob.h"
+#include "client/ds/copy_on_write.h"
 #include "client/io.h"
 #include "client/utils.h"
+#include "common/memory/cuda_ipc.h"
 #include "common/memory/fling.h"
 #include "common/util/boost.h"
+#include "common/util/functions.h"
 #include "common/util/protocols.h"
+#include "common/util/trace.h"
 
 namespace vineyard {
 
+namespace {
+
+/**
+ * Hint the kernel to read the pages of the mapped payload in ahead.
+ */
+void adviseWillNeed(const uint8_t* pointer, size_t size) {
+  if (pointer == nullptr || size == 0) {
+    return;
+  }
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(pointer) & ~(page_size - 1);
+  uintptr_t end = reinterpret_cast<uintptr_t>(pointer) + size;
+  // the hint is best-effort, the failures are harmless
+  madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+}
+
+/**
+ * Fault in every page of the range by the threads, each reads a byte of the
+ * pages of its own part.
+ */
+void pretouch(const uint8_t* pointer, size_t size, size_t concurrency) {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t pages = (size + page_size - 1) / page_size;
+  concurrency = std::max<size_t>(1, std::min(concurrency, pages));
+  auto touch = [pointer, size](size_t begin, size_t end) {
+    volatile uint8_t sink = 0;
+    for (size_t offset = begin; offset < end && offset < size;
+         offset += page_size) {
+      sink = sink + pointer[offset];
+    }
+  };
+  size_t pages_per_thread = (pages + concurrency - 1) / concurrency;
+  std::vector<std::thread> threads;
+  for (size_t idx = 1; idx < concurrency; ++idx) {
+    threads.emplace_back(touch, idx * pages_per_thread * page_size,
+                         (idx + 1) * pages_per_thread * page_size);
+  }
+  touch(0, pages_per_thread * page_size);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+/**
+ * The readonly buffer of a blob, which holds the mapped segment, see also
+ * `Client::mapBuffer`.
+ */
+class MappedBuffer : public arrow::Buffer {
+ public:
+  MappedBuffer(const uint8_t* data, int64_t const size,
+               std::shared_ptr<MmapEntry> segment)
+      : arrow::Buffer(data, size), segment_(std::move(segment)) {}
+
+ private:
+  std::shared_ptr<MmapEntry> segment_;
+};
+
+}  // namespace
+
+/**
+ * @brief ConstructPool runs the loops of `Client::constructObjects` on its
+ * persistent workers, together with the calling thread. Items are taken one
+ * by one, as the cost of constructing objects varies a lot.
+ */
+class ConstructPool {
+ public:
+  explicit ConstructPool(size_t const workers) {
+    for (size_t idx = 0; idx < workers; ++idx) {
+      workers_.emplace_back([this]() { workerLoop(); });
+    }
+  }
+
+  ~ConstructPool() {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      stopped_ = true;
+    }
+    cond_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  size_t workers() const { return workers_.size(); }
+
+  /**
+   * Run `fn` on `[0, num)` and block until all are done, the first exception
+   * (if any) is rethrown on the calling thread.
+   */
+  void ParallelFor(size_t const num, std::function<void(size_t)> const& fn) {
+    auto job = std::make_shared<Job>();
+    job->fn = &fn;
+    job->num = num;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      for (size_t idx = 0; idx < std::min(workers_.size(), num - 1); ++idx) {
+        queue_.emplace_back(job);
+      }
+    }
+    cond_.notify_all();
+    run(*job);
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done.wait(lock, [&job]() { return job->finished == job->num; });
+    if (job->error) {
+      std::rethrow_exception(job->error);
+    }
+  }
+
+ private:
+  struct Job {
+    // only accessed before all items are taken
+    std::function<void(size_t)> const* fn = nullptr;
+    size_t num = 0;
+    std::atomic<size_t> next{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t finished = 0;
+    std::exception_ptr error;
+  };
+
+  static void run(Job& job) {
+    size_t finished = 0;
+    std::exception_ptr error;
+    for (size_t idx = job.next.fetch_add(1); idx < job.num;
+         idx = job.next.fetch_add(1)) {
+      if (!error) {
+        try {
+          (*job.fn)(idx);
+        } catch (...) {
+          error = std::current_exception();
+        }
+      }
+      finished += 1;
+    }
+    if (finished == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> guard(job.mutex);
+    job.finished += finished;
+    if (error && !job.error) {
+      job.error = error;
+    }
+    if (job.finished == job.num) {
+      job.done.notify_all();
+    }
+  }
+
+  void workerLoop() {
+    while (true) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this]() { return stopped_ || !queue_.empty(); });
+        if (stopped_) {
+          return;
+        }
+        job = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      run(*job);
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::shared_ptr<Job>> queue_;
+  bool stopped_ = false;
+};
+
+uint8_t* MmapEntry::map_aligned(int prot) {
+  // reserve an address range with slack, map the fd over the aligned part
+  // of it, and unmap the slack
+  size_t reserved = length_ + alignment_;
+  void* reservation = mmap(NULL, reserved, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (reservation == MAP_FAILED) {
+    return reinterpret_cast<uint8_t*>(MAP_FAILED);
+  }
+  uintptr_t begin = reinterpret_cast<uintptr_t>(reservation);
+  uintptr_t aligned = (begin + alignment_ - 1) & ~(alignment_ - 1);
+  void* pointer = mmap(reinterpret_cast<void*>(aligned), length_, prot,
+                       map_flags() | MAP_FIXED, fd_, 0);
+  if (pointer == MAP_FAILED) {
+    munmap(reservation, reserved);
+    return reinterpret_cast<uint8_t*>(MAP_FAILED);
+  }
+  uintptr_t page_size = static_cast<uintptr_t>(getpagesize());
+  uintptr_t end = (aligned + length_ + page_size - 1) & ~(page_size - 1);
+  if (aligned > begin) {
+    munmap(reservation, aligned - begin);
+  }
+  if (begin + reserved > end) {
+    munmap(reinterpret_cast<void*>(end), begin + reserved - end);
+  }
+  return reinterpret_cast<uint8_t*>(pointer);
+}
+
+void MmapEntry::populate(uint8_t* pointer) {
+  if (options_.pretouch_threads > 0) {
+    pretouch(pointer, length_, options_.pretouch_threads);
+  }
+  if (options_.lock && mlock(pointer, length_) != 0) {
+    LOG(WARNING) << "mlock failed: errno = " << errno << ": "
+                 << strerror(errno);
+  }
+}
+
 Status Client::Connect() {
   if (const char* env_p = std::getenv("VINEYARD_IPC_SOCKET")) {
     return Connect(std::string(env_p));
@@ -38,26 +259,54 @@ Status Client::Connect() {
 }
 
 Status Client::Connect(const std::string& ipc_socket) {
-  std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  std::lock_guard<ClientMutex> guard(client_mutex_);
   RETURN_ON_ASSERT(!connected_ || ipc_socket == ipc_socket_);
   if (connected_) {
     return Status::OK();
   }
   ipc_socket_ = ipc_socket;
   RETURN_ON_ERROR(connect_ipc_socket_retry(ipc_socket, vineyard_conn_));
+  // the register request is sent in JSON, since the server may not speak
+  // the binary protocol.
+  binary_protocol_ = false;
+  request_tag_ = false;
   std::string message_out;
-  WriteRegisterRequest(message_out);
+  // the blobs are accounted to the tenant, if given
+  const char* tenant = std::getenv("VINEYARD_TENANT");
+  WriteRegisterRequest(true, tenant == nullptr ? "" : tenant, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::string ipc_socket_value, rpc_endpoint_value;
   RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
-                                    rpc_endpoint_value, instance_id_));
+                                    rpc_endpoint_value, instance_id_,
+                                    binary_protocol_, request_tag_,
+                                    deletion_notification_));
   rpc_endpoint_ = rpc_endpoint_value;
   connected_ = true;
   return Status::OK();
 }
 
+Status Client::OpenRingChannel(size_t const capacity) {
+  ENSURE_CONNECTED(this);
+  if (ring_channel_) {
+    return Status::OK();
+  }
+  std::string message_out;
+  WriteOpenRingChannelRequest(capacity, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  size_t ring_capacity = 0;
+  RETURN_ON_ERROR(ReadOpenRingChannelReply(message_in, ring_capacity));
+  // the ring has been attached once the reply is read, as the following
+  // replies are written to the ring.
+  if (!ring_channel_) {
+    return Status::IOError("Failed to attach the ring channel");
+  }
+  return Status::OK();
+}
+
 Client& Client::Default() {
   static std::once_flag flag;
   static Client* client = new Client();
@@ -68,6 +317,13 @@ Client& Client::Default() {
 Status Client::GetMetaData(const ObjectID id, ObjectMeta& meta,
                            const bool sync_remote) {
   ENSURE_CONNECTED(this);
+  if (metaCacheEnabled()) {
+    // drop the deleted objects first
+    RETURN_ON_ERROR(pollMessages());
+    if (lookupMetaCache(id, meta)) {
+      return Status::OK();
+    }
+  }
   ptree tree;
   RETURN_ON_ERROR(GetData(id, tree, sync_remote));
   meta.SetMetaData(this, tree);
@@ -79,15 +335,11 @@ Status Client::GetMetaData(const ObjectID id, ObjectMeta& meta,
     auto object = buffers.find(id);
     std::shared_ptr<arrow::Buffer> buffer = nullptr;
     if (object != buffers.end()) {
-      uint8_t* mmapped_ptr = nullptr;
-      RETURN_ON_ERROR(mmapToClient(object->second.store_fd,
-                                   object->second.map_size, true,
-                                   &mmapped_ptr));
-      buffer = arrow::Buffer::Wrap(mmapped_ptr + object->second.data_offset,
-                                   object->second.data_size);
+      RETURN_ON_ERROR(mapBuffer(object->second, buffer));
     }
     meta.SetBlob(id, buffer);
   }
+  insertMetaCache(id, meta);
   return Status::OK();
 }
 
@@ -95,14 +347,31 @@ Status Client::GetMetaData(const std::vector<ObjectID>& ids,
                            std::vector<ObjectMeta>& metas,
                            const bool sync_remote) {
   ENSURE_CONNECTED(this);
+  metas.resize(ids.size());
+  // only the objects that are missing in the cache are requested
+  std::vector<ObjectID> missing_ids;
+  std::vector<size_t> missing_indices;
+  if (metaCacheEnabled()) {
+    RETURN_ON_ERROR(pollMessages());
+  }
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    if (!metaCacheEnabled() || !lookupMetaCache(ids[idx], metas[idx])) {
+      missing_ids.emplace_back(ids[idx]);
+      missing_indices.emplace_back(idx);
+    }
+  }
+  if (missing_ids.empty()) {
+    return Status::OK();
+  }
+
   std::vector<ptree> trees;
-  RETURN_ON_ERROR(GetData(ids, trees, sync_remote));
-  metas.resize(trees.size());
+  RETURN_ON_ERROR(GetData(missing_ids, trees, sync_remote));
 
   std::unordered_set<ObjectID> blob_ids;
   for (size_t idx = 0; idx < trees.size(); ++idx) {
-    metas[idx].SetMetaData(this, trees[idx]);
-    for (const auto& id : metas[idx].GetBlobSet()->AllBlobIds()) {
+    auto& meta = metas[missing_indices[idx]];
+    meta.SetMetaData(this, trees[idx]);
+    for (const auto& id : meta.GetBlobSet()->AllBlobIds()) {
       blob_ids.emplace(id);
     }
   }
@@ -110,31 +379,221 @@ Status Client::GetMetaData(const std::vector<ObjectID>& ids,
   std::unordered_map<ObjectID, Payload> buffers;
   RETURN_ON_ERROR(GetBuffers(blob_ids, buffers));
 
-  for (auto& meta : metas) {
+  for (size_t idx = 0; idx < missing_ids.size(); ++idx) {
+    auto& meta = metas[missing_indices[idx]];
     for (auto const id : meta.GetBlobSet()->AllBlobIds()) {
       auto object = buffers.find(id);
       std::shared_ptr<arrow::Buffer> buffer = nullptr;
       if (object != buffers.end()) {
-        uint8_t* mmapped_ptr = nullptr;
-        RETURN_ON_ERROR(mmapToClient(object->second.store_fd,
-                                     object->second.map_size, true,
-                                     &mmapped_ptr));
-        buffer = std::make_shared<arrow::Buffer>(
-            mmapped_ptr + object->second.data_offset, object->second.data_size);
+        RETURN_ON_ERROR(mapBuffer(object->second, buffer));
       }
       meta.SetBlob(id, buffer);
     }
+    insertMetaCache(missing_ids[idx], meta);
   }
 
   return Status::OK();
 }
 
+Status Client::GetProjectedMetaData(const ObjectID id,
+                                    meta_projection_t const& projection,
+                                    ObjectMeta& meta, const bool sync_remote) {
+  ENSURE_CONNECTED(this);
+  ObjectMeta cached;
+  if (metaCacheEnabled()) {
+    RETURN_ON_ERROR(pollMessages());
+    if (lookupMetaCache(id, cached)) {
+      // the blobs have already been mapped
+      ptree tree = cached.MetaData();
+      RETURN_ON_ERROR(projection(tree));
+      meta.SetMetaData(this, tree);
+      auto const& cached_blobs = cached.GetBlobSet()->AllBlobs();
+      for (auto const& id : meta.GetBlobSet()->AllBlobIds()) {
+        auto blob = cached_blobs.find(id);
+        if (blob != cached_blobs.end()) {
+          meta.SetBlob(id, blob->second.BufferUnsafe());
+        }
+      }
+      return Status::OK();
+    }
+  }
+  ptree tree;
+  RETURN_ON_ERROR(GetData(id, tree, sync_remote));
+  RETURN_ON_ERROR(projection(tree));
+  meta.SetMetaData(this, tree);
+
+  std::unordered_map<ObjectID, Payload> buffers;
+  RETURN_ON_ERROR(GetBuffers(meta.GetBlobSet()->AllBlobIds(), buffers));
+
+  for (auto const& id : meta.GetBlobSet()->AllBlobIds()) {
+    auto object = buffers.find(id);
+    std::shared_ptr<arrow::Buffer> buffer = nullptr;
+    if (object != buffers.end()) {
+      RETURN_ON_ERROR(mapBuffer(object->second, buffer));
+    }
+    meta.SetBlob(id, buffer);
+  }
+  // the projected metadata is not cached, as it differs from the object
+  return Status::OK();
+}
+
+Status Client::GetMetaDataAsync(const ObjectID id,
+                                callback_t<const ObjectMeta&> callback,
+                                const bool sync_remote) {
+  return GetDataAsync(
+      id,
+      [this, callback](const Status& status, const ptree& tree) {
+        auto meta = std::make_shared<ObjectMeta>();
+        if (!status.ok()) {
+          return callback(status, *meta);
+        }
+        meta->SetMetaData(this, tree);
+        auto blob_ids = meta->GetBlobSet()->AllBlobIds();
+        auto s = GetBuffersAsync(
+            blob_ids,
+            [this, meta, callback](
+                const Status& status,
+                const std::unordered_map<ObjectID, Payload>& buffers) {
+              auto s = status;
+              for (auto const& id : meta->GetBlobSet()->AllBlobIds()) {
+                if (!s.ok()) {
+                  break;
+                }
+                auto object = buffers.find(id);
+                std::shared_ptr<arrow::Buffer> buffer = nullptr;
+                if (object != buffers.end()) {
+                  s = mapBuffer(object->second, buffer);
+                }
+                meta->SetBlob(id, buffer);
+              }
+              return callback(s, *meta);
+            });
+        if (!s.ok()) {
+          return callback(s, *meta);
+        }
+        return Status::OK();
+      },
+      sync_remote);
+}
+
+Status Client::Prefetch(const std::vector<ObjectID>& ids) {
+  ENSURE_CONNECTED(this);
+  std::vector<ObjectID> missing_ids;
+  if (metaCacheEnabled()) {
+    RETURN_ON_ERROR(pollMessages());
+  }
+  for (auto const& id : ids) {
+    ObjectMeta meta;
+    if (!metaCacheEnabled() || !lookupMetaCache(id, meta)) {
+      missing_ids.emplace_back(id);
+    }
+  }
+  if (missing_ids.empty()) {
+    return Status::OK();
+  }
+  // `sync_remote` makes the server replicate the remote blobs before replying
+  return GetDataAsync(
+      missing_ids,
+      [this, missing_ids](const Status& status,
+                          const std::vector<ptree>& trees) {
+        RETURN_ON_ERROR(status);
+        auto metas = std::make_shared<std::vector<ObjectMeta>>(trees.size());
+        std::unordered_set<ObjectID> blob_ids;
+        for (size_t idx = 0; idx < trees.size(); ++idx) {
+          (*metas)[idx].SetMetaData(this, trees[idx]);
+          // includes the remote blobs, which may have a local replica now
+          for (auto const& item : (*metas)[idx].GetBlobSet()->AllBlobs()) {
+            blob_ids.emplace(item.first);
+          }
+        }
+        // the server reloads the spilled blobs before replying
+        return GetBuffersAsync(
+            blob_ids,
+            [this, missing_ids, metas](
+                const Status& status,
+                const std::unordered_map<ObjectID, Payload>& buffers) {
+              RETURN_ON_ERROR(status);
+              std::unordered_map<ObjectID, std::shared_ptr<arrow::Buffer>>
+                  mapped;
+              for (auto const& item : buffers) {
+                std::shared_ptr<arrow::Buffer> buffer = nullptr;
+                RETURN_ON_ERROR(mapBuffer(item.second, buffer));
+                if (!item.second.IsDevice()) {
+                  adviseWillNeed(buffer->data(), item.second.data_size);
+                }
+                mapped.emplace(item.first, buffer);
+              }
+              for (size_t idx = 0; idx < metas->size(); ++idx) {
+                auto& meta = (*metas)[idx];
+                for (auto const& item : mapped) {
+                  if (meta.GetBlobSet()->Contains(item.first)) {
+                    meta.SetBlob(item.first, item.second);
+                  }
+                }
+                insertMetaCache(missing_ids[idx], meta);
+              }
+              return Status::OK();
+            });
+      },
+      true);
+}
+
+Status Client::Populate(ObjectMeta const& meta, MmapOptions const& options) {
+  for (auto const& item : meta.GetBlobSet()->AllBlobs()) {
+    auto const& buffer = item.second.BufferUnsafe();
+    if (buffer == nullptr || buffer->size() == 0) {
+      continue;
+    }
+    pretouch(buffer->data(), buffer->size(), options.pretouch_threads);
+    if (options.lock && mlock(buffer->data(), buffer->size()) != 0) {
+      return Status::IOError("Failed to lock the blob " +
+                             VYObjectIDToString(item.first) + ": " +
+                             strerror(errno));
+    }
+  }
+  return Status::OK();
+}
+
+Status Client::Unlock(ObjectMeta const& meta) {
+  for (auto const& item : meta.GetBlobSet()->AllBlobs()) {
+    auto const& buffer = item.second.BufferUnsafe();
+    if (buffer == nullptr || buffer->size() == 0) {
+      continue;
+    }
+    if (munlock(buffer->data(), buffer->size()) != 0) {
+      return Status::IOError("Failed to unlock the blob " +
+                             VYObjectIDToString(item.first) + ": " +
+                             strerror(errno));
+    }
+  }
+  return Status::OK();
+}
+
+Status Client::ShallowCopy(const ObjectID id,
+                           std::unique_ptr<CopyOnWriteView>& view) {
+  ENSURE_CONNECTED(this);
+  ObjectMeta meta;
+  RETURN_ON_ERROR(GetMetaData(id, meta));
+  view.reset(new CopyOnWriteView(*this, meta));
+  return Status::OK();
+}
+
 Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob) {
+  return CreateBlob(size, blob, GetCurrentNumaNode());
+}
+
+Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob,
+                          const int numa_node) {
+  return CreateBlob(size, blob, numa_node, 0);
+}
+
+Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob,
+                          const int numa_node, const size_t alignment) {
   ENSURE_CONNECTED(this);
 
   ObjectID object_id;
   Payload object;
-  RETURN_ON_ERROR(CreateBuffer(size, object_id, object));
+  RETURN_ON_ERROR(CreateBuffer(size, numa_node, object_id, object, alignment));
   RETURN_ON_ASSERT((size_t) object.data_size == size);
   uint8_t* mmapped_ptr = nullptr;
   RETURN_ON_ERROR(
@@ -146,14 +605,76 @@ Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob) {
   return Status::OK();
 }
 
-Status Client::CreateStream(const ObjectID& id) {
+Status Client::CreateDeviceBlob(size_t size, std::unique_ptr<BlobWriter>& blob,
+                                const int device_id) {
   ENSURE_CONNECTED(this);
+
   std::string message_out;
-  WriteCreateStreamRequest(id, message_out);
+  WriteCreateDeviceBufferRequest(size, device_id, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadCreateStreamReply(message_in));
+  ObjectID object_id;
+  Payload object;
+  RETURN_ON_ERROR(ReadCreateBufferReply(message_in, object_id, object));
+  RETURN_ON_ASSERT(object.IsDevice() && (size_t) object.data_size == size);
+  uint8_t* device_ptr = nullptr;
+  RETURN_ON_ERROR(mapPayload(object, false, &device_ptr));
+  std::shared_ptr<arrow::MutableBuffer> buffer =
+      std::make_shared<arrow::MutableBuffer>(device_ptr, size);
+  blob.reset(new BlobWriter(object_id, buffer));
+  blob->device_id_ = object.device_id;
+  return Status::OK();
+}
+
+Status Client::CreateBlobs(const std::vector<size_t>& sizes,
+                           std::vector<std::unique_ptr<BlobWriter>>& blobs) {
+  ENSURE_CONNECTED(this);
+
+  std::vector<ObjectID> object_ids;
+  std::vector<Payload> objects;
+  RETURN_ON_ERROR(
+      CreateBuffers(sizes, GetCurrentNumaNode(), object_ids, objects));
+  RETURN_ON_ASSERT(objects.size() == sizes.size());
+  for (size_t i = 0; i < objects.size(); ++i) {
+    auto const& object = objects[i];
+    RETURN_ON_ASSERT((size_t) object.data_size == sizes[i]);
+    uint8_t* mmapped_ptr = nullptr;
+    RETURN_ON_ERROR(
+        mmapToClient(object.store_fd, object.map_size, false, &mmapped_ptr));
+    std::shared_ptr<arrow::MutableBuffer> buffer =
+        std::make_shared<arrow::MutableBuffer>(mmapped_ptr + object.data_offset,
+                                               sizes[i]);
+    blobs.emplace_back(new BlobWriter(object_ids[i], buffer));
+  }
+  return Status::OK();
+}
+
+Status Client::Release(const std::vector<ObjectID>& ids) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteReleaseRequest(ids, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadReleaseReply(message_in));
+  return Status::OK();
+}
+
+Status Client::CreateBlobArena(size_t capacity,
+                               std::unique_ptr<BlobArena>& arena) {
+  ENSURE_CONNECTED(this);
+
+  ObjectID region_id;
+  Payload region;
+  RETURN_ON_ERROR(
+      CreateBuffer(capacity, GetCurrentNumaNode(), region_id, region));
+  RETURN_ON_ASSERT((size_t) region.data_size == capacity);
+  uint8_t* mmapped_ptr = nullptr;
+  RETURN_ON_ERROR(
+      mmapToClient(region.store_fd, region.map_size, false, &mmapped_ptr));
+  arena.reset(
+      new BlobArena(region_id, region, mmapped_ptr + region.data_offset));
   return Status::OK();
 }
 
@@ -176,34 +697,67 @@ Status Client::GetNextStreamChunk(ObjectID const id, size_t const size,
 
 Status Client::PullNextStreamChunk(ObjectID const id,
                                    std::unique_ptr<arrow::Buffer>& blob) {
+  return pullNextStreamChunk(id, true, blob);
+}
+
+Status Client::OpenStreamNotifier(ObjectID const id, int& fd) {
   ENSURE_CONNECTED(this);
+  auto iter = stream_notifiers_.find(id);
+  if (iter != stream_notifiers_.end()) {
+    fd = iter->second;
+    return Status::OK();
+  }
   std::string message_out;
-  WritePullNextStreamChunkRequest(id, message_out);
+  WriteOpenStreamNotifierRequest(id, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  Payload object;
-  RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, object));
-  uint8_t* mmapped_ptr = nullptr;
-  RETURN_ON_ERROR(
-      mmapToClient(object.store_fd, object.map_size, true, &mmapped_ptr));
-  blob.reset(
-      new arrow::Buffer(mmapped_ptr + object.data_offset, object.data_size));
+  RETURN_ON_ERROR(ReadOpenStreamNotifierReply(message_in));
+  // the eventfd has been received with the reply
+  fd = message_in.get<int>("received_fd", -1);
+  if (fd < 0) {
+    return Status::IOError("Failed to receive the eventfd of the stream");
+  }
+  stream_notifiers_.emplace(id, fd);
   return Status::OK();
 }
 
-Status Client::StopStream(ObjectID const id, const bool failed) {
+Status Client::TryPullNextStreamChunk(ObjectID const id,
+                                      std::unique_ptr<arrow::Buffer>& blob) {
+  ENSURE_CONNECTED(this);
+  auto iter = stream_notifiers_.find(id);
+  if (iter != stream_notifiers_.end()) {
+    // reset the counter before pulling, the chunks that are sealed after that
+    // will signal the eventfd again, it is non-blocking.
+    uint64_t value = 0;
+    if (read(iter->second, &value, sizeof(uint64_t)) < 0) {
+      value = 0;
+    }
+  }
+  return pullNextStreamChunk(id, false, blob);
+}
+
+Status Client::pullNextStreamChunk(ObjectID const id, bool const wait,
+                                   std::unique_ptr<arrow::Buffer>& blob) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteStopStreamRequest(id, failed, message_out);
+  WritePullNextStreamChunkRequest(id, false, wait, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadStopStreamReply(message_in));
+  Payload object;
+  RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, object));
+  uint8_t* mmapped_ptr = nullptr;
+  RETURN_ON_ERROR(
+      mmapToClient(object.store_fd, object.map_size, true, &mmapped_ptr));
+  blob.reset(
+      new arrow::Buffer(mmapped_ptr + object.data_offset, object.data_size));
   return Status::OK();
 }
 
 std::shared_ptr<Object> Client::GetObject(const ObjectID id) {
+  trace::Span span = trace::StartSpan("GetObject");
+  trace::Scope scope(span.context());
   ObjectMeta meta;
   VINEYARD_CHECK_OK(this->GetMetaData(id, meta, true));
   VINEYARD_ASSERT(!meta.MetaData().empty());
@@ -216,6 +770,8 @@ std::shared_ptr<Object> Client::GetObject(const ObjectID id) {
 }
 
 Status Client::GetObject(const ObjectID id, std::shared_ptr<Object>& object) {
+  trace::Span span = trace::StartSpan("GetObject");
+  trace::Scope scope(span.context());
   ObjectMeta meta;
   RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
   RETURN_ON_ASSERT(!meta.MetaData().empty());
@@ -227,6 +783,43 @@ Status Client::GetObject(const ObjectID id, std::shared_ptr<Object>& object) {
   return Status::OK();
 }
 
+Status Client::GetObjectAsync(
+    const ObjectID id, callback_t<const std::shared_ptr<Object>&> callback) {
+  return GetMetaDataAsync(
+      id,
+      [callback](const Status& status, const ObjectMeta& meta) {
+        std::shared_ptr<Object> object = nullptr;
+        if (!status.ok()) {
+          return callback(status, object);
+        }
+        if (meta.MetaData().empty()) {
+          return callback(Status::AssertionFailed("!meta.MetaData().empty()"),
+                          object);
+        }
+        object = ObjectFactory::Create(meta.GetTypeName());
+        if (object == nullptr) {
+          object = std::shared_ptr<Object>(new Object());
+        }
+        object->Construct(meta);
+        return callback(Status::OK(), object);
+      },
+      true);
+}
+
+Status Client::GetProjectedObject(const ObjectID id,
+                                  meta_projection_t const& projection,
+                                  std::shared_ptr<Object>& object) {
+  ObjectMeta meta;
+  RETURN_ON_ERROR(this->GetProjectedMetaData(id, projection, meta, true));
+  RETURN_ON_ASSERT(!meta.MetaData().empty());
+  object = ObjectFactory::Create(meta.GetTypeName());
+  if (object == nullptr) {
+    object = std::shared_ptr<Object>(new Object());
+  }
+  object->Construct(meta);
+  return Status::OK();
+}
+
 std::vector<std::shared_ptr<Object>> Client::GetObjects(
     const std::vector<ObjectID>& ids) {
   std::vector<ObjectMeta> metas;
@@ -236,17 +829,7 @@ std::vector<std::shared_ptr<Object>> Client::GetObjects(
       VINEYARD_ASSERT(!meta.MetaData().empty());
     }
   }
-  std::vector<std::shared_ptr<Object>> objects;
-  objects.reserve(ids.size());
-  for (auto const& meta : metas) {
-    auto object = ObjectFactory::Create(meta.GetTypeName());
-    if (object == nullptr) {
-      object = std::shared_ptr<Object>(new Object());
-    }
-    object->Construct(meta);
-    objects.emplace_back(object);
-  }
-  return objects;
+  return constructObjects(metas);
 }
 
 std::vector<std::shared_ptr<Object>> Client::ListObjects(
@@ -271,37 +854,98 @@ std::vector<std::shared_ptr<Object>> Client::ListObjects(
   VINEYARD_CHECK_OK(GetBuffers(blob_ids, buffers));
 
   // construct objects
-  std::vector<std::shared_ptr<Object>> objects;
-  objects.reserve(metas.size());
-  for (auto& meta : metas) {
+  return constructObjects(metas, [this, &buffers](ObjectMeta& meta) {
     for (auto const id : meta.GetBlobSet()->AllBlobIds()) {
       auto object = buffers.find(id);
       std::shared_ptr<arrow::Buffer> buffer = nullptr;
       if (object != buffers.end()) {
-        uint8_t* mmapped_ptr = nullptr;
-        VINEYARD_CHECK_OK(mmapToClient(object->second.store_fd,
-                                       object->second.map_size, true,
-                                       &mmapped_ptr));
-        buffer = std::make_shared<arrow::Buffer>(
-            mmapped_ptr + object->second.data_offset, object->second.data_size);
+        VINEYARD_CHECK_OK(mapBuffer(object->second, buffer));
       }
       meta.SetBlob(id, buffer);
     }
+  });
+}
 
+void Client::SetConstructConcurrency(size_t const concurrency) {
+  std::shared_ptr<ConstructPool> pool = nullptr;
+  if (concurrency > 1) {
+    pool = std::make_shared<ConstructPool>(concurrency - 1);
+  }
+  std::atomic_store(&construct_pool_, pool);
+}
+
+std::vector<std::shared_ptr<Object>> Client::constructObjects(
+    std::vector<ObjectMeta>& metas,
+    std::function<void(ObjectMeta&)> const& prepare) {
+  std::vector<std::shared_ptr<Object>> objects(metas.size());
+  std::function<void(size_t)> construct = [&](size_t const index) {
+    auto& meta = metas[index];
+    if (prepare) {
+      prepare(meta);
+    }
     auto object = ObjectFactory::Create(meta.GetTypeName());
     if (object == nullptr) {
       object = std::shared_ptr<Object>(new Object());
     }
     object->Construct(meta);
-    objects.emplace_back(object);
+    objects[index] = std::move(object);
+  };
+  auto pool = std::atomic_load(&construct_pool_);
+  if (pool == nullptr || metas.size() < 2) {
+    for (size_t index = 0; index < metas.size(); ++index) {
+      construct(index);
+    }
+  } else {
+    pool->ParallelFor(metas.size(), construct);
   }
   return objects;
 }
 
-Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& object) {
+namespace {
+
+inline Payload const& payload_of(Payload const& object) { return object; }
+
+inline Payload const& payload_of(std::pair<const ObjectID, Payload> const& kv) {
+  return kv.second;
+}
+
+}  // namespace
+
+template <typename Payloads>
+Status Client::recvFds(std::vector<int> const& fds, Payloads const& objects) {
+  if (fds.empty()) {
+    return Status::OK();
+  }
+  std::vector<int> client_fds;
+  if (recv_fds(vineyard_conn_, fds.size(), client_fds) < 0) {
+    return Status::IOError(
+        "Failed to receieve file descriptors from the socket");
+  }
+  std::unordered_map<int, int64_t> map_sizes;
+  for (auto const& item : objects) {
+    auto const& object = payload_of(item);
+    map_sizes[object.store_fd] = object.map_size;
+  }
+  for (size_t i = 0; i < fds.size(); ++i) {
+    auto map_size = map_sizes.find(fds[i]);
+    if (map_size == map_sizes.end() ||
+        mmap_table_.find(fds[i]) != mmap_table_.end()) {
+      close(client_fds[i]);
+      continue;
+    }
+    mmap_table_.emplace(fds[i], std::make_shared<MmapEntry>(
+                                    client_fds[i], map_size->second, false,
+                                    mmap_options_));
+  }
+  return Status::OK();
+}
+
+Status Client::CreateBuffer(const size_t size, const int numa_node,
+                            ObjectID& id, Payload& object,
+                            const size_t alignment) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteCreateBufferRequest(size, message_out);
+  WriteCreateBufferRequest(size, numa_node, alignment, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
@@ -309,6 +953,34 @@ Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& object) {
   return Status::OK();
 }
 
+Status Client::CreateBuffers(const std::vector<size_t>& sizes,
+                             const int numa_node, std::vector<ObjectID>& ids,
+                             std::vector<Payload>& objects) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCreateBuffersRequest(sizes, numa_node, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::vector<int> fds;
+  RETURN_ON_ERROR(ReadCreateBuffersReply(message_in, ids, objects, fds));
+  return Status::OK();
+}
+
+Status Client::SplitBuffer(const ObjectID id,
+                           const std::vector<size_t>& offsets,
+                           const std::vector<size_t>& sizes,
+                           std::vector<ObjectID>& ids) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteSplitBufferRequest(id, offsets, sizes, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadSplitBufferReply(message_in, ids));
+  return Status::OK();
+}
+
 Status Client::GetBuffer(const ObjectID id, Payload& object) {
   std::unordered_map<ObjectID, Payload> objects;
   RETURN_ON_ERROR(GetBuffers({id}, objects));
@@ -330,29 +1002,105 @@ Status Client::GetBuffers(const std::unordered_set<ObjectID>& ids,
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, objects));
+  std::vector<int> fds;
+  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, objects, fds));
   return Status::OK();
 }
 
-Status Client::mmapToClient(int fd, int64_t map_size, bool readonly,
-                            uint8_t** ptr) {
-  auto entry = mmap_table_.find(fd);
-  if (entry == mmap_table_.end()) {
+Status Client::GetBuffersAsync(
+    const std::unordered_set<ObjectID>& ids,
+    callback_t<const std::unordered_map<ObjectID, Payload>&> callback) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteGetBuffersRequest(ids, message_out);
+  return doAsyncRequest(
+      message_out, [this, callback](const Status& status, const ptree& reply) {
+        std::unordered_map<ObjectID, Payload> objects;
+        std::vector<int> fds;
+        auto s = status;
+        if (s.ok()) {
+          s = ReadGetBuffersReply(reply, objects, fds);
+        }
+        return callback(s, objects);
+      });
+}
+
+Status Client::receiveFds(ptree& root) {
+  auto code = root.get_optional<int>("code");
+  if (code && code.get() != static_cast<int>(StatusCode::kOK)) {
+    return Status::OK();
+  }
+  std::string const type = root.get<std::string>("type", "");
+  if (type == "get_buffers_reply") {
+    std::unordered_map<ObjectID, Payload> objects;
+    std::vector<int> fds;
+    RETURN_ON_ERROR(ReadGetBuffersReply(root, objects, fds));
+    return recvFds(fds, objects);
+  }
+  if (type == "create_buffers_reply") {
+    std::vector<ObjectID> ids;
+    std::vector<Payload> objects;
+    std::vector<int> fds;
+    RETURN_ON_ERROR(ReadCreateBuffersReply(root, ids, objects, fds));
+    return recvFds(fds, objects);
+  }
+  if (type == "create_buffer_reply" || type == "get_next_stream_chunk_reply" ||
+      type == "pull_next_stream_chunk_reply") {
+    auto tree = root.get_child_optional(
+        type == "create_buffer_reply" ? "created" : "buffer");
+    if (!tree) {
+      // the chunk is inlined in the reply
+      return Status::OK();
+    }
+    Payload object;
+    object.FromJSON(tree.get());
+    // the server sends the fd only if it hasn't been sent before
+    if (object.store_fd < 0 ||
+        mmap_table_.find(object.store_fd) != mmap_table_.end()) {
+      return Status::OK();
+    }
     int client_fd = recv_fd(vineyard_conn_);
-    if (fd <= 0) {
+    if (client_fd < 0) {
       return Status::IOError(
           "Failed to receieve file descriptor from the socket");
     }
-    auto mmap_entry = std::unique_ptr<MmapEntry>(
-        new MmapEntry(client_fd, map_size, readonly));
-    entry = mmap_table_.emplace(fd, std::move(mmap_entry)).first;
+    mmap_table_.emplace(object.store_fd,
+                        std::make_shared<MmapEntry>(client_fd, object.map_size,
+                                                    false, mmap_options_));
+    return Status::OK();
+  }
+  if (type == "open_ring_channel_reply") {
+    size_t capacity = 0;
+    RETURN_ON_ERROR(ReadOpenRingChannelReply(root, capacity));
+    std::vector<int> fds;
+    if (recv_fds(vineyard_conn_, 3, fds) < 0) {
+      return Status::IOError("Failed to receive the fds of the ring channel");
+    }
+    return ShmRingChannel::Attach(fds[0], fds[1], fds[2], capacity,
+                                  ring_channel_);
   }
-  if (readonly) {
-    *ptr = entry->second->map_readonly();
-    if (*ptr == nullptr) {
-      return Status::IOError("Failed to mmap received fd as a readonly buffer");
+  if (type == "open_stream_notifier_reply") {
+    int fd = recv_fd(vineyard_conn_);
+    if (fd < 0) {
+      return Status::IOError("Failed to receive the eventfd of the stream");
     }
+    root.put("received_fd", fd);
+  }
+  return Status::OK();
+}
 
+Status Client::mmapToClient(int fd, int64_t map_size, bool readonly,
+                            uint8_t** ptr) {
+  std::lock_guard<ClientMutex> guard(client_mutex_);
+  auto entry = mmap_table_.find(fd);
+  if (entry == mmap_table_.end()) {
+    return Status::IOError("The file descriptor " + std::to_string(fd) +
+                           " hasn't been received from the socket");
+  }
+  if (readonly) {
+    RETURN_ON_ERROR(mapReadonly(*entry->second, ptr));
+    // the raw pointer cannot be tracked, see also `mapBuffer`
+    entry->second->pin();
   } else {
     *ptr = entry->second->map_readwrite();
     if (*ptr == nullptr) {
@@ -362,6 +1110,149 @@ Status Client::mmapToClient(int fd, int64_t map_size, bool readonly,
   return Status::OK();
 }
 
-Client::~Client() { Disconnect(); }
+Status Client::GetMappedSegment(const void* pointer, uint8_t*& base,
+                                size_t& size) {
+  int fd = -1;
+  return GetMappedSegment(pointer, base, size, fd);
+}
+
+Status Client::GetMappedSegment(const void* pointer, uint8_t*& base,
+                                size_t& size, int& fd) {
+  std::lock_guard<ClientMutex> guard(client_mutex_);
+  for (auto const& entry : mmap_table_) {
+    base = entry.second->base_of(pointer);
+    if (base != nullptr) {
+      // the segment may be registered elsewhere, e.g., to the RDMA device
+      entry.second->pin();
+      size = entry.second->length();
+      fd = entry.second->fd();
+      return Status::OK();
+    }
+  }
+  return Status(StatusCode::kObjectNotExists,
+                "The address isn't in the mapped store memory");
+}
+
+Status Client::mapPayload(Payload const& object, bool readonly,
+                          uint8_t** ptr) {
+  if (!object.IsDevice()) {
+    RETURN_ON_ERROR(
+        mmapToClient(object.store_fd, object.map_size, readonly, ptr));
+    *ptr += object.data_offset;
+    return Status::OK();
+  }
+  // device memory cannot be mapped as readonly
+  std::lock_guard<ClientMutex> guard(client_mutex_);
+  auto entry = device_handles_.find(object.ipc_handle);
+  if (entry != device_handles_.end()) {
+    *ptr = entry->second.second;
+    return Status::OK();
+  }
+  void* device_ptr = nullptr;
+  RETURN_ON_ERROR(
+      CudaOpenIpcHandle(object.device_id, object.ipc_handle, &device_ptr));
+  *ptr = static_cast<uint8_t*>(device_ptr);
+  device_handles_.emplace(object.ipc_handle,
+                          std::make_pair(object.device_id, *ptr));
+  return Status::OK();
+}
+
+Status Client::mapBuffer(Payload const& object,
+                         std::shared_ptr<arrow::Buffer>& buffer) {
+  if (object.IsDevice()) {
+    uint8_t* device_ptr = nullptr;
+    RETURN_ON_ERROR(mapPayload(object, true, &device_ptr));
+    buffer = arrow::Buffer::Wrap(device_ptr, object.data_size);
+    return Status::OK();
+  }
+  std::lock_guard<ClientMutex> guard(client_mutex_);
+  auto entry = mmap_table_.find(object.store_fd);
+  if (entry == mmap_table_.end()) {
+    return Status::IOError("The file descriptor " +
+                           std::to_string(object.store_fd) +
+                           " hasn't been received from the socket");
+  }
+  uint8_t* mmapped_ptr = nullptr;
+  RETURN_ON_ERROR(mapReadonly(*entry->second, &mmapped_ptr));
+  buffer = std::make_shared<MappedBuffer>(mmapped_ptr + object.data_offset,
+                                          object.data_size, entry->second);
+  return Status::OK();
+}
+
+Status Client::mapReadonly(MmapEntry& entry, uint8_t** ptr) {
+  bool const fresh = !entry.mapped_readonly();
+  bool const remap = fresh && entry.unmapped();
+  *ptr = entry.map_readonly();
+  if (*ptr == nullptr) {
+    return Status::IOError("Failed to mmap received fd as a readonly buffer");
+  }
+  entry.last_used() = ++mmap_tick_;
+  if (remap) {
+    remaps_ += 1;
+  }
+  if (fresh && mmap_options_.max_readonly_mappings > 0) {
+    evictMappings(mmap_options_.max_readonly_mappings, &entry);
+  }
+  return Status::OK();
+}
+
+size_t Client::evictMappings(size_t const keep,
+                             MmapEntry const* excluded) {
+  std::lock_guard<ClientMutex> guard(client_mutex_);
+  size_t mapped = 0;
+  std::vector<std::pair<uint64_t, MmapEntry*>> candidates;
+  for (auto const& item : mmap_table_) {
+    if (!item.second->mapped_readonly()) {
+      continue;
+    }
+    mapped += 1;
+    // the others are referenced by the buffers of blobs
+    if (item.second.use_count() == 1 && item.second.get() != excluded) {
+      candidates.emplace_back(item.second->last_used(), item.second.get());
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  size_t unmapped = 0;
+  for (auto const& candidate : candidates) {
+    if (mapped <= keep) {
+      break;
+    }
+    if (candidate.second->unmap_readonly()) {
+      mapped -= 1;
+      unmapped += 1;
+    }
+  }
+  unmaps_ += unmapped;
+  return unmapped;
+}
+
+size_t Client::ReleaseUnusedMappings() { return evictMappings(0); }
+
+MmapStats Client::GetMmapStats() {
+  std::lock_guard<ClientMutex> guard(client_mutex_);
+  MmapStats stats;
+  stats.segments = mmap_table_.size();
+  for (auto const& item : mmap_table_) {
+    size_t mappings = item.second->mappings();
+    size_t readwrite = item.second->mapped_readwrite() ? 1 : 0;
+    stats.readonly_mappings += mappings - readwrite;
+    stats.readwrite_mappings += readwrite;
+    stats.mapped_bytes += mappings * item.second->length();
+  }
+  stats.unmaps = unmaps_;
+  stats.remaps = remaps_;
+  return stats;
+}
+
+Client::~Client() {
+  Disconnect();
+  for (auto const& item : stream_notifiers_) {
+    close(item.second);
+  }
+  for (auto const& item : device_handles_) {
+    VINEYARD_SUPPRESS(
+        CudaCloseIpcHandle(item.second.first, item.second.second));
+  }
+}
 
 }  // namespace vineyard
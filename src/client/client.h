@@ -17,11 +17,17 @@ limitations under the License.
 #define SRC_CLIENT_CLIENT_H_
 
 #include <sys/mman.h>
+#if defined(__linux__)
+#include <sys/vfs.h>
+#endif
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "arrow/buffer.h"
@@ -36,7 +42,55 @@ limitations under the License.
 namespace vineyard {
 
 class Blob;
+class BlobArena;
 class BlobWriter;
+class ConstructPool;
+class CopyOnWriteView;
+
+/**
+ * @brief The projection rewrites the metadata tree of an object before the
+ * blobs are requested, see also `Client::GetProjectedMetaData`.
+ */
+using meta_projection_t = std::function<Status(ptree& tree)>;
+
+/**
+ * @brief MmapOptions controls how the store fds are mapped to the client. The
+ * mappings are lazy by default, i.e., the pages are faulted in on the first
+ * access.
+ */
+struct MmapOptions {
+  /// Populate the page tables of the whole mapping eagerly (`MAP_POPULATE`).
+  bool populate = false;
+  /// Touch every page of the mapping by the given number of threads, after
+  /// mapping, 0 means disabled.
+  size_t pretouch_threads = 0;
+  /// Lock the mapping into memory (`mlock`), this is best-effort and is
+  /// subject to `RLIMIT_MEMLOCK`.
+  bool lock = false;
+  /// Serve the readonly blobs of a segment from its writeable mapping, if
+  /// any, rather than mapping the segment twice.
+  bool share_readwrite = false;
+  /// Keep at most the given number of readonly mappings, the least recently
+  /// used ones that are not referenced by any blob are unmapped (and mapped
+  /// again on the next access), 0 means unlimited.
+  size_t max_readonly_mappings = 0;
+};
+
+/**
+ * @brief The statistics of the mappings of the store fds in the client, see
+ * also `Client::GetMmapStats`.
+ */
+struct MmapStats {
+  /// The number of received store fds.
+  size_t segments = 0;
+  size_t readonly_mappings = 0;
+  size_t readwrite_mappings = 0;
+  /// The bytes of address space of all mappings.
+  size_t mapped_bytes = 0;
+  /// How many times the readonly mappings have been unmapped and mapped again.
+  size_t unmaps = 0;
+  size_t remaps = 0;
+};
 
 /**
  * @brief MmapEntry represents a memory-mapped fd on the client side. The fd
@@ -44,15 +98,31 @@ class BlobWriter;
  */
 class MmapEntry {
  public:
-  MmapEntry(int fd, int64_t map_size, bool readonly)
-      : fd_(fd), ro_pointer_(nullptr), rw_pointer_(nullptr), length_(0) {
+  MmapEntry(int fd, int64_t map_size, bool readonly,
+            MmapOptions const& options = MmapOptions{})
+      : fd_(fd),
+        ro_pointer_(nullptr),
+        rw_pointer_(nullptr),
+        length_(0),
+        options_(options) {
     // fake_mmap in malloc.h leaves a gap between memory segments, to make
     // map_size page-aligned again.
     length_ = map_size - sizeof(size_t);
+#if defined(__linux__)
+    // segments backed by huge pages must be mapped with a length that is a
+    // multiple of the huge page size.
+    struct statfs fs;
+    if (fstatfs(fd_, &fs) == 0 && fs.f_type == kHugetlbfsMagic &&
+        fs.f_bsize > 0) {
+      size_t page_size = static_cast<size_t>(fs.f_bsize);
+      length_ = (length_ + page_size - 1) / page_size * page_size;
+      alignment_ = std::max(alignment_, page_size);
+    }
+#endif
   }
 
   ~MmapEntry() {
-    if (ro_pointer_) {
+    if (ro_pointer_ && ro_pointer_ != rw_pointer_) {
       int r = munmap(ro_pointer_, length_);
       if (r != 0) {
         LOG(ERROR) << "munmap returned " << r << ", errno = " << errno << ": "
@@ -75,13 +145,17 @@ class MmapEntry {
    * @returns A untyped pointer that points to the shared readonly memory.
    */
   uint8_t* map_readonly() {
+    if (!ro_pointer_ && rw_pointer_ && options_.share_readwrite) {
+      ro_pointer_ = rw_pointer_;
+    }
     if (!ro_pointer_) {
-      ro_pointer_ = reinterpret_cast<uint8_t*>(
-          mmap(NULL, length_, PROT_READ, MAP_SHARED, fd_, 0));
+      ro_pointer_ = map_aligned(PROT_READ);
       if (ro_pointer_ == MAP_FAILED) {
         LOG(ERROR) << "mmap failed: errno = " << errno << ": "
                    << strerror(errno);
         ro_pointer_ = nullptr;
+      } else {
+        populate(ro_pointer_);
       }
     }
     return ro_pointer_;
@@ -94,26 +168,117 @@ class MmapEntry {
    */
   uint8_t* map_readwrite() {
     if (!rw_pointer_) {
-      rw_pointer_ = reinterpret_cast<uint8_t*>(
-          mmap(NULL, length_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0));
+      rw_pointer_ = map_aligned(PROT_READ | PROT_WRITE);
       if (rw_pointer_ == MAP_FAILED) {
         LOG(ERROR) << "mmap failed: errno = " << errno << ": "
                    << strerror(errno);
         rw_pointer_ = nullptr;
+      } else {
+        populate(rw_pointer_);
       }
     }
     return rw_pointer_;
   }
 
+  /**
+   * @brief Unmap the readonly mapping, the fd is kept and can be mapped again.
+   * Returns false if there's nothing to unmap.
+   */
+  bool unmap_readonly() {
+    if (!ro_pointer_ || pinned_) {
+      return false;
+    }
+    if (ro_pointer_ != rw_pointer_) {
+      int r = munmap(ro_pointer_, length_);
+      if (r != 0) {
+        LOG(ERROR) << "munmap returned " << r << ", errno = " << errno << ": "
+                   << strerror(errno);
+        return false;
+      }
+    }
+    ro_pointer_ = nullptr;
+    unmapped_ = true;
+    return true;
+  }
+
+  bool mapped_readonly() const { return ro_pointer_ != nullptr; }
+
+  bool mapped_readwrite() const { return rw_pointer_ != nullptr; }
+
+  /** The number of distinct mappings, i.e., VMAs, of the fd. */
+  size_t mappings() const {
+    return (ro_pointer_ != nullptr && ro_pointer_ != rw_pointer_ ? 1 : 0) +
+           (rw_pointer_ != nullptr ? 1 : 0);
+  }
+
+  /** Whether the readonly mapping has ever been unmapped. */
+  bool unmapped() const { return unmapped_; }
+
+  /**
+   * @brief Keep the readonly mapping until the client is destroyed, for the
+   * pointers that cannot be tracked, e.g., the raw stream chunks.
+   */
+  void pin() { pinned_ = true; }
+
+  /** The tick of the last access, for the LRU eviction. */
+  uint64_t& last_used() { return last_used_; }
+
   int fd() { return fd_; }
 
+  size_t length() const { return length_; }
+
+  /**
+   * @brief The base of the mapping (readonly or writeable) that contains
+   * `pointer`, or nullptr if the pointer is out of this fd.
+   */
+  uint8_t* base_of(const void* pointer) const {
+    auto address = reinterpret_cast<const uint8_t*>(pointer);
+    for (uint8_t* base : {ro_pointer_, rw_pointer_}) {
+      if (base != nullptr && address >= base && address < base + length_) {
+        return base;
+      }
+    }
+    return nullptr;
+  }
+
  private:
+  int map_flags() const {
+#if defined(MAP_POPULATE)
+    if (options_.populate) {
+      return MAP_SHARED | MAP_POPULATE;
+    }
+#endif
+    return MAP_SHARED;
+  }
+
+  /**
+   * @brief Map the fd at a multiple of kMaxBlobAlignment, as vineyardd does,
+   * thus the blobs that have been created with an alignment are aligned in
+   * the client as well. Returns MAP_FAILED on failure.
+   */
+  uint8_t* map_aligned(int prot);
+
+  /**
+   * @brief Pre-fault and lock the new mapping, as requested by the options.
+   */
+  void populate(uint8_t* pointer);
+
   /// The associated file descriptor on the client.
   int fd_;
   /// The result of mmap for this file descriptor.
   uint8_t *ro_pointer_, *rw_pointer_;
   /// The length of the memory-mapped file.
   size_t length_;
+  /// Where the fd is mapped at multiples of.
+  size_t alignment_ = kMaxBlobAlignment;
+  /// How the fd is mapped.
+  MmapOptions options_;
+  bool pinned_ = false;
+  bool unmapped_ = false;
+  uint64_t last_used_ = 0;
+
+  /// The magic number of hugetlbfs, see also linux/magic.h.
+  static constexpr int64_t kHugetlbfsMagic = 0x958458f6;
 };
 
 /**
@@ -137,12 +302,29 @@ class Client : public ClientBase {
    * @brief Connect to vineyardd using the given UNIX domain socket
    * `ipc_socket`.
    *
+   * The blobs created by this client are accounted to the tenant given by
+   * the environment variable `VINEYARD_TENANT`, or to the session of the
+   * connection, whose quota is enforced by vineyardd.
+   *
    * @param ipc_socket Location of the UNIX domain socket.
    *
    * @return Status that indicates whether the connect has succeeded.
    */
   Status Connect(const std::string& ipc_socket);
 
+  /**
+   * @brief Exchange the following requests and replies with vineyardd
+   * through a pair of lock-free rings in shared memory, rather than the UNIX
+   * domain socket. The socket is still used to pass file descriptors and
+   * messages that are too large for the rings.
+   *
+   * @param capacity The capacity (in bytes, a power of 2) of each ring.
+   *
+   * @return Status that indicates whether the ring channel has been opened.
+   */
+  Status OpenRingChannel(
+      size_t const capacity = ShmRingChannel::kDefaultCapacity);
+
   /**
    * @brief Get a default client reference, using the UNIX domain socket file
    *        specified by the environment variable `VINEYARD_IPC_SOCKET`.
@@ -179,6 +361,155 @@ class Client : public ClientBase {
   Status GetMetaData(const std::vector<ObjectID>& id, std::vector<ObjectMeta>&,
                      const bool sync_remote = false);
 
+  /**
+   * @brief Asynchronous variant of `GetMetaData`, the metadata request and
+   * the following buffers request are pipelined with other asynchronous
+   * requests, and the callback receives the metadata with blobs mapped, see
+   * also `ClientBase::WaitAll`.
+   *
+   * @param id The object id to get.
+   * @param callback The callback to receive the result metadata.
+   * @param sync_remote Whether to trigger an immediate remote metadata
+   *        synchronization before get specific metadata. Default is false.
+   *
+   * @return Status that indicates whether the request has been sent.
+   */
+  Status GetMetaDataAsync(const ObjectID id,
+                          callback_t<const ObjectMeta&> callback,
+                          const bool sync_remote = false);
+
+  /**
+   * @brief Obtain the metadata of a projection of the object from vineyard
+   * server. The metadata tree is rewritten by the `projection` before the
+   * blobs are requested, e.g., to drop the members that won't be accessed,
+   * and only the blobs of the remaining members are mapped to the client.
+   *
+   * @param id The object id to get.
+   * @param projection The projection that rewrites the metadata tree.
+   * @param meta_data The result projected metadata will be store in
+   * `meta_data` as return value.
+   * @param sync_remote Whether to trigger an immediate remote metadata
+   *        synchronization before get specific metadata. Default is false.
+   *
+   * @return Status that indicates whether the get action has succeeded.
+   */
+  Status GetProjectedMetaData(const ObjectID id,
+                              meta_projection_t const& projection,
+                              ObjectMeta& meta_data,
+                              const bool sync_remote = false);
+
+  /**
+   * @brief Hint that the objects will be accessed soon. The metadata is
+   * resolved asynchronously, the remote blobs are replicated and the spilled
+   * blobs are reloaded by the server, and the local blobs are mapped to the
+   * client and paged in ahead (by `madvise(MADV_WILLNEED)`).
+   *
+   * When the metadata cache is enabled the following `GetObject` of these
+   * objects is served without any round trip to the server. The prefetch is
+   * settled by the following synchronous requests, or `ClientBase::WaitAll`.
+   *
+   * @param ids The object ids that will be accessed.
+   *
+   * @return Status that indicates whether the requests have been sent.
+   */
+  Status Prefetch(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief Set how the store fds are mapped to this client from now on, the
+   * existing mappings are not affected, see also `MmapOptions`.
+   */
+  void SetMmapOptions(MmapOptions const& options) { mmap_options_ = options; }
+
+  /**
+   * @brief The statistics of the mappings of the store fds in this client.
+   */
+  MmapStats GetMmapStats();
+
+  /**
+   * @brief Unmap the readonly mappings that are not referenced by any blob
+   * now, regardless of `MmapOptions::max_readonly_mappings`. The segments are
+   * mapped again on the next access.
+   *
+   * @return The number of the unmapped segments.
+   */
+  size_t ReleaseUnusedMappings();
+
+  /**
+   * @brief Construct the objects of `GetObjects` and `ListObjects` on the
+   * given number of threads (including the calling thread), the workers are
+   * owned by this client. The default 1 constructs them on the calling
+   * thread.
+   *
+   * The `Construct` of the objects in the batch is run concurrently, which is
+   * safe for the types that access only their own metadata and blobs.
+   */
+  void SetConstructConcurrency(size_t const concurrency);
+
+  /**
+   * @brief Record the hash of the payload in the metadata of the blobs sealed
+   * by this client from now on, see also `Blob::ContentHash`. It is disabled
+   * by default, as hashing costs a pass over the payload.
+   */
+  void SetContentHashing(bool const enabled) { content_hashing_ = enabled; }
+
+  bool content_hashing() const { return content_hashing_; }
+
+  /**
+   * @brief Find the memory-mapped store segment that contains the pointer,
+   * e.g., the data of a blob got from or created by this client. The segments
+   * stay mapped as long as the client is alive, thus they can be registered
+   * once for zero-copy transports, e.g., as RDMA memory regions.
+   *
+   * @param pointer The address in the store memory.
+   * @param base The base of the mapped segment.
+   * @param size The size of the mapped segment.
+   *
+   * @return Status::ObjectNotExists if the pointer isn't in a mapped segment.
+   */
+  Status GetMappedSegment(const void* pointer, uint8_t*& base, size_t& size);
+
+  /**
+   * @brief The variant of `GetMappedSegment` that also returns the fd of the
+   * segment, which is mapped from its offset 0 on, thus the memory can be
+   * sent from the fd directly, e.g., by `sendfile(2)`. The fd is owned by the
+   * client.
+   */
+  Status GetMappedSegment(const void* pointer, uint8_t*& base, size_t& size,
+                          int& fd);
+
+  /**
+   * @brief Fault in the pages of the blobs of the object, by
+   * `options.pretouch_threads` threads (at least one), and lock them into
+   * memory if `options.lock` is set. Blobs that are not local are skipped.
+   *
+   * @param meta The metadata of an object got from this client.
+   * @param options The pre-faulting options, `populate` is ignored.
+   *
+   * @return Status that indicates whether the pages have been populated
+   * (and locked).
+   */
+  Status Populate(ObjectMeta const& meta, MmapOptions const& options);
+
+  /**
+   * @brief Unlock the pages of the blobs of the object locked by `Populate`.
+   */
+  Status Unlock(ObjectMeta const& meta);
+
+  using ClientBase::ShallowCopy;
+
+  /**
+   * @brief Make a copy-on-write view of the object, the blobs of the object
+   * are copied only when they are modified through the view, and the new
+   * object is created when the view is sealed, see also `CopyOnWriteView`.
+   *
+   * @param id The object id to copy.
+   * @param view The result writable view.
+   *
+   * @return Status that indicates whether the view has been created.
+   */
+  Status ShallowCopy(const ObjectID id,
+                     std::unique_ptr<CopyOnWriteView>& view);
+
   /**
    * @brief Create a blob in vineyard server. When creating a blob, vineyard
    * server's bulk allocator will prepare a block of memory of the requested
@@ -192,14 +523,95 @@ class Client : public ClientBase {
   Status CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob);
 
   /**
-   * @brief Allocate a stream on vineyard. The metadata of parameter `id` must
-   * has already been created on vineyard.
+   * @brief Create a blob in vineyard server on the given NUMA node. The
+   * placement is a hint and only takes effect when the vineyard server has
+   * NUMA arenas enabled, `CreateBlob` without a NUMA node places the blob on
+   * the NUMA node where the caller is running.
+   *
+   * @param size The size of requested blob.
+   * @param blob The result mutable blob will be set in `blob`.
+   * @param numa_node The NUMA node that the blob will be placed on, -1 means
+   * the default arena of the vineyard server.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob,
+                    const int numa_node);
+
+  /**
+   * @brief Create a blob whose data is aligned to the given alignment, e.g.,
+   * 64 bytes for AVX-512 kernels, 4 KiB for `O_DIRECT` I/O, or 2 MiB for huge
+   * pages. The alignment holds in every process that maps the blob.
+   *
+   * @param size The size of requested blob.
+   * @param blob The result mutable blob will be set in `blob`.
+   * @param numa_node The NUMA node that the blob will be placed on, -1 means
+   * the default arena of the vineyard server.
+   * @param alignment The alignment of the data of the blob, which must be a
+   * power of two and at most `kMaxBlobAlignment`, 0 means the default one.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob,
+                    const int numa_node, const size_t alignment);
+
+  /**
+   * @brief Create a blob in the memory of the given CUDA device, which is
+   * shared by the CUDA IPC handle, thus the producers can share the
+   * preprocessed data on GPUs with other processes without any host round
+   * trip. The vineyard server must be started with `--device_memory_size`.
+   *
+   * The `data()` of the blob writer, and of the blob that been got by
+   * `GetObject`, are device pointers, see also `Blob::device_id()`. The
+   * device memory of a blob is opened once per client and is closed when the
+   * client is destroyed.
+   *
+   * @param size The size of requested blob.
+   * @param blob The result mutable blob will be set in `blob`.
+   * @param device_id The CUDA device that the blob will be placed on.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateDeviceBlob(size_t size, std::unique_ptr<BlobWriter>& blob,
+                          const int device_id = 0);
+
+  /**
+   * @brief Create a batch of blobs in vineyard server in a single round trip,
+   * the blobs are placed on the NUMA node where the caller is running.
+   *
+   * @param sizes The sizes of requested blobs.
+   * @param blobs The result mutable blobs will be set in `blobs`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateBlobs(const std::vector<size_t>& sizes,
+                     std::vector<std::unique_ptr<BlobWriter>>& blobs);
+
+  /**
+   * @brief Release the blobs that have been created or got by this client.
+   * The vineyard server pins the blobs that are mapped by clients, and a
+   * deleted blob isn't freed until all clients that have mapped it release
+   * it, or disconnect.
+   *
+   * The memory of the released blobs must not be accessed by this client
+   * anymore, unless they are got again.
+   *
+   * @param ids The blobs to release.
+   *
+   * @return Status that indicates whether the release action has succeeded.
+   */
+  Status Release(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief Reserve a memory region of the given capacity in vineyard server,
+   * from which many blobs can be allocated locally, see also `BlobArena`.
    *
-   * @param id The id of metadata that will be used to create stream.
+   * @param capacity The size of the reserved region.
+   * @param arena The result blob arena will be set in `arena`.
    *
    * @return Status that indicates whether the create action has succeeded.
    */
-  Status CreateStream(const ObjectID& id);
+  Status CreateBlobArena(size_t capacity, std::unique_ptr<BlobArena>& arena);
 
   /**
    * @brief Allocate a chunk of given size in vineyard for a stream. When the
@@ -231,15 +643,34 @@ class Client : public ClientBase {
                              std::unique_ptr<arrow::Buffer>& blob);
 
   /**
-   * @brief Stop a stream, mark it as finished or aborted.
+   * @brief Open an eventfd for the stream that becomes readable when a chunk
+   * may be available to this client, or the stream has been stoped. A single
+   * thread can `epoll` the eventfds of many streams, and pull the chunks with
+   * `TryPullNextStreamChunk`, rather than being blocked in
+   * `PullNextStreamChunk`.
+   *
+   * The eventfd is owned by the client and will be closed when the client is
+   * destroyed, and it is reset by `TryPullNextStreamChunk`.
    *
    * @param id The id of the stream.
-   * @param failed Whether the stream is stoped at a successful state. True
-   * means the stream has been exited normally, otherwise false.
+   * @param fd The eventfd will be set in `fd`.
    *
-   * @return Status that indicates whether the request has succeeded.
+   * @return Status that indicates whether the notifier has been opened.
    */
-  Status StopStream(ObjectID const id, bool failed);
+  Status OpenStreamNotifier(ObjectID const id, int& fd);
+
+  /**
+   * @brief Non-blocking variant of `PullNextStreamChunk`, a status code
+   * `kStreamNotReady` will be returned at once when there's no chunk available
+   * yet.
+   *
+   * @param id The id of the stream.
+   * @param blob The immutable chunk generated by the writer of the stream.
+   *
+   * @return Status that indicates whether the polling has succeeded.
+   */
+  Status TryPullNextStreamChunk(ObjectID const id,
+                                std::unique_ptr<arrow::Buffer>& blob);
 
   /**
    * @brief Get an object from vineyard. The ObjectFactory will be used to
@@ -265,6 +696,33 @@ class Client : public ClientBase {
    */
   Status GetObject(const ObjectID id, std::shared_ptr<Object>& object);
 
+  /**
+   * @brief Asynchronous variant of `GetObject`, the object is constructed
+   * from the metadata obtained by `GetMetaDataAsync` and passed to the
+   * callback, see also `ClientBase::WaitAll` and `ClientBase::PollReplies`.
+   *
+   * @param id The object id to get.
+   * @param callback The callback to receive the result object.
+   *
+   * @return Status that indicates whether the request has been sent.
+   */
+  Status GetObjectAsync(const ObjectID id,
+                        callback_t<const std::shared_ptr<Object>&> callback);
+
+  /**
+   * @brief Get a projection of an object from vineyard, where the metadata is
+   * rewritten by the `projection`, see also `GetProjectedMetaData`.
+   *
+   * @param id The object id to get.
+   * @param projection The projection that rewrites the metadata tree.
+   * @param object The result object will be set in parameter `object`.
+   *
+   * @return Status that indicates whether the get action has succeeded.
+   */
+  Status GetProjectedObject(const ObjectID id,
+                            meta_projection_t const& projection,
+                            std::shared_ptr<Object>& object);
+
   /**
    * @brief Get an object from vineyard. The type parameter `T` will be used to
    * resolve the constructor of the object.
@@ -337,18 +795,105 @@ class Client : public ClientBase {
                                                    size_t const limit = 5);
 
  private:
-  Status CreateBuffer(const size_t size, ObjectID& id, Payload& object);
+  Status CreateBuffer(const size_t size, const int numa_node, ObjectID& id,
+                      Payload& object, const size_t alignment = 0);
+
+  Status CreateBuffers(const std::vector<size_t>& sizes, const int numa_node,
+                       std::vector<ObjectID>& ids,
+                       std::vector<Payload>& objects);
 
   Status GetBuffer(const ObjectID id, Payload& object);
 
+  Status SplitBuffer(const ObjectID id, const std::vector<size_t>& offsets,
+                     const std::vector<size_t>& sizes,
+                     std::vector<ObjectID>& ids);
+
   Status GetBuffers(const std::unordered_set<ObjectID>& ids,
                     std::unordered_map<ObjectID, Payload>& objects);
 
+  /**
+   * @brief Asynchronous variant of `GetBuffers`, the fds that follow the
+   * reply are received before the callback is invoked.
+   */
+  Status GetBuffersAsync(
+      const std::unordered_set<ObjectID>& ids,
+      callback_t<const std::unordered_map<ObjectID, Payload>&> callback);
+
+  /**
+   * @brief Map the received store fd to the client, the fds are received
+   * along with the replies, see also `receiveFds`.
+   */
   Status mmapToClient(int fd, int64_t map_size, bool readonly, uint8_t** ptr);
 
-  std::unordered_map<int, std::unique_ptr<MmapEntry>> mmap_table_;
+  /**
+   * @brief Map the payload to the client, and returns the pointer to the data
+   * of the payload. Device payloads are opened by their CUDA IPC handles.
+   */
+  Status mapPayload(Payload const& object, bool readonly, uint8_t** ptr);
+
+  /**
+   * @brief Map the payload as a readonly buffer of a blob. The buffer holds
+   * the segment, thus it is unmapped only when no such buffer is alive, see
+   * also `MmapOptions::max_readonly_mappings`.
+   */
+  Status mapBuffer(Payload const& object,
+                   std::shared_ptr<arrow::Buffer>& buffer);
+
+  /**
+   * @brief Unmap the least recently used readonly mappings that are not
+   * referenced, until at most `keep` readonly mappings are left. Returns how
+   * many have been unmapped.
+   *
+   * The `excluded` entry is never unmapped, i.e., the one that is being
+   * mapped, which isn't referenced by any buffer yet.
+   */
+  size_t evictMappings(size_t const keep,
+                       MmapEntry const* excluded = nullptr);
+
+  /**
+   * @brief Map the entry as readonly, and evict the other mappings if it is
+   * newly mapped, see also `MmapOptions::max_readonly_mappings`.
+   */
+  Status mapReadonly(MmapEntry& entry, uint8_t** ptr);
+
+  Status receiveFds(ptree& root) override;
+
+  Status pullNextStreamChunk(ObjectID const id, bool const wait,
+                             std::unique_ptr<arrow::Buffer>& blob);
+
+  /**
+   * @brief Receive the batch of store fds that follows a reply, and register
+   * them to the mmap table.
+   */
+  template <typename Payloads>
+  Status recvFds(std::vector<int> const& fds, Payloads const& objects);
+
+  /**
+   * @brief Construct the objects of the given metadata, see also
+   * `SetConstructConcurrency`. The `prepare` is run on the metadata before
+   * the construction, on the same thread.
+   */
+  std::vector<std::shared_ptr<Object>> constructObjects(
+      std::vector<ObjectMeta>& metas,
+      std::function<void(ObjectMeta&)> const& prepare = nullptr);
+
+  // the entries are shared with the buffers of blobs, see also `mapBuffer`
+  std::unordered_map<int, std::shared_ptr<MmapEntry>> mmap_table_;
+  MmapOptions mmap_options_;
+  uint64_t mmap_tick_ = 0;
+  size_t unmaps_ = 0, remaps_ = 0;
+  // the workers of `constructObjects`, except the calling thread
+  std::shared_ptr<ConstructPool> construct_pool_;
+  bool content_hashing_ = false;
+  // the eventfds of the opened stream notifiers
+  std::unordered_map<ObjectID, int> stream_notifiers_;
+  // the opened CUDA IPC handles, i.e., the device and the device pointer. The
+  // address of a deleted device blob may be reused by the server, thus the
+  // handles (rather than the blob ids) are the keys.
+  std::unordered_map<std::string, std::pair<int, uint8_t*>> device_handles_;
 
   friend class Blob;
+  friend class BlobArena;
   friend class BlobWriter;
 };
 
@@ -21,11 +21,116 @@ limitations under the License.
 
 #include "client/io.h"
 #include "client/utils.h"
+#include "common/util/logging.h"
 #include "common/util/protocols.h"
+#include "common/util/trace.h"
 
 namespace vineyard {
 
-ClientBase::ClientBase() : connected_(false), vineyard_conn_(0) {}
+namespace {
+
+// the span of the request that is in flight on this thread, which is
+// finished when the reply is read
+thread_local trace::Span inflight_span;
+
+Status startRequestSpan(std::string& message_out) {
+  auto& tracer = trace::Tracer::Global();
+  if (!tracer.Enabled()) {
+    return Status::OK();
+  }
+  trace::Context parent = trace::Current();
+  if (!parent.sampled()) {
+    parent = tracer.Sample();
+    if (!parent.sampled()) {
+      return Status::OK();
+    }
+  }
+  ptree root;
+  RETURN_ON_ERROR(DecodeMessage(message_out, root));
+  inflight_span =
+      trace::Span(root.get<std::string>("type", "request"), parent, "CLIENT");
+  return TraceMessage(message_out, inflight_span.context());
+}
+
+}  // namespace
+
+constexpr size_t ClientBase::kDefaultMetaCacheCapacity;
+
+void ClientMutex::lock() {
+  std::unique_lock<std::mutex> guard(mutex_);
+  auto self = std::this_thread::get_id();
+  if (depth_ > 0 && owner_ == self) {
+    ++depth_;
+    return;
+  }
+  released_.wait(guard, [this]() { return depth_ == 0; });
+  owner_ = self;
+  depth_ = 1;
+}
+
+bool ClientMutex::try_lock() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto self = std::this_thread::get_id();
+  if (depth_ > 0 && owner_ != self) {
+    return false;
+  }
+  owner_ = self;
+  ++depth_;
+  return true;
+}
+
+void ClientMutex::unlock() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (--depth_ == 0) {
+    owner_ = std::thread::id();
+    released_.notify_one();
+  }
+}
+
+size_t ClientMutex::release() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t depth = depth_;
+  depth_ = 0;
+  owner_ = std::thread::id();
+  released_.notify_one();
+  return depth;
+}
+
+void ClientMutex::reacquire(size_t const depth) {
+  std::unique_lock<std::mutex> guard(mutex_);
+  released_.wait(guard, [this]() { return depth_ == 0; });
+  owner_ = std::this_thread::get_id();
+  depth_ = depth;
+}
+
+void ClientMutex::wait() {
+  std::unique_lock<std::mutex> guard(mutex_);
+  size_t depth = depth_;
+  depth_ = 0;
+  owner_ = std::thread::id();
+  released_.notify_one();
+  uint64_t generation = generation_;
+  notified_.wait(guard, [&]() { return generation_ != generation; });
+  released_.wait(guard, [this]() { return depth_ == 0; });
+  owner_ = std::this_thread::get_id();
+  depth_ = depth;
+}
+
+void ClientMutex::notify_all() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ++generation_;
+  notified_.notify_all();
+}
+
+ClientBase::ClientBase()
+    : connected_(false),
+      binary_protocol_(false),
+      vineyard_conn_(0),
+      request_tag_(false),
+      next_request_tag_(1),
+      reading_(false),
+      deletion_notification_(false),
+      meta_cache_capacity_(kDefaultMetaCacheCapacity) {}
 
 Status ClientBase::GetData(const ObjectID id, ptree& tree,
                            const bool sync_remote, const bool wait) {
@@ -57,11 +162,75 @@ Status ClientBase::GetData(const std::vector<ObjectID>& ids,
   return Status::OK();
 }
 
+Status ClientBase::GetDataAsync(const ObjectID id,
+                                callback_t<const ptree&> callback,
+                                const bool sync_remote, const bool wait) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteGetDataRequest(id, sync_remote, wait, message_out);
+  return doAsyncRequest(
+      message_out, [callback](const Status& status, const ptree& reply) {
+        ptree tree;
+        auto s = status;
+        if (s.ok()) {
+          s = ReadGetDataReply(reply, tree);
+        }
+        return callback(s, tree);
+      });
+}
+
+Status ClientBase::GetDataAsync(const std::vector<ObjectID>& ids,
+                                callback_t<const std::vector<ptree>&> callback,
+                                const bool sync_remote, const bool wait) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteGetDataRequest(ids, sync_remote, wait, message_out);
+  return doAsyncRequest(
+      message_out, [ids, callback](const Status& status, const ptree& reply) {
+        std::vector<ptree> trees;
+        auto s = status;
+        if (s.ok()) {
+          std::unordered_map<ObjectID, ptree> meta_trees;
+          s = ReadGetDataReply(reply, meta_trees);
+          for (size_t i = 0; s.ok() && i < ids.size(); ++i) {
+            auto iter = meta_trees.find(ids[i]);
+            if (iter == meta_trees.end()) {
+              s = Status::ObjectNotExists();
+            } else {
+              trees.emplace_back(iter->second);
+            }
+          }
+        }
+        if (!s.ok()) {
+          trees.clear();
+        }
+        return callback(s, trees);
+      });
+}
+
+Status ClientBase::CreateDataAsync(
+    const ptree& tree, callback_t<const ObjectID, const InstanceID> callback,
+    const uint64_t ttl) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCreateDataRequest(tree, ttl, message_out);
+  return doAsyncRequest(
+      message_out, [callback](const Status& status, const ptree& reply) {
+        ObjectID id = InvalidObjectID();
+        InstanceID instance_id = UnspecifiedInstanceID();
+        auto s = status;
+        if (s.ok()) {
+          s = ReadCreateDataReply(reply, id, instance_id);
+        }
+        return callback(s, id, instance_id);
+      });
+}
+
 Status ClientBase::CreateData(const ptree& tree, ObjectID& id,
-                              InstanceID& instance_id) {
+                              InstanceID& instance_id, const uint64_t ttl) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteCreateDataRequest(tree, message_out);
+  WriteCreateDataRequest(tree, ttl, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
@@ -117,24 +286,141 @@ Status ClientBase::DelData(const std::vector<ObjectID>& ids, const bool force,
 Status ClientBase::ListData(std::string const& pattern, bool const regex,
                             size_t const limit,
                             std::unordered_map<ObjectID, ptree>& meta_trees) {
+  std::string cursor;
+  return ListData(pattern, regex, limit, cursor, meta_trees);
+}
+
+Status ClientBase::ListData(std::string const& pattern, bool const regex,
+                            size_t const limit, std::string& cursor,
+                            std::unordered_map<ObjectID, ptree>& meta_trees) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteListDataRequest(pattern, regex, limit, message_out);
+  WriteListDataRequest(pattern, regex, limit, cursor, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
-  RETURN_ON_ERROR(ReadGetDataReply(message_in, meta_trees));
+  RETURN_ON_ERROR(ReadListDataReply(message_in, meta_trees, cursor));
   return Status::OK();
 }
 
-Status ClientBase::Persist(const ObjectID id) {
+Status ClientBase::PersistAsync(const ObjectID id, callback_t<> callback,
+                                const uint64_t ttl) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WritePersistRequest(id, message_out);
+  WritePersistRequest(id, ttl, message_out);
+  invalidateMetaCache({id});
+  return doAsyncRequest(
+      message_out, [callback](const Status& status, const ptree& reply) {
+        return callback(status.ok() ? ReadPersistReply(reply) : status);
+      });
+}
+
+Status ClientBase::Persist(const ObjectID id, const uint64_t ttl) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WritePersistRequest(id, ttl, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
   RETURN_ON_ERROR(ReadPersistReply(message_in));
+  // the object is not transient anymore
+  invalidateMetaCache({id});
+  return Status::OK();
+}
+
+Status ClientBase::Persist(const std::vector<ObjectID>& ids,
+                           const uint64_t ttl) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WritePersistRequest(ids, ttl, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPersistReply(message_in));
+  invalidateMetaCache(ids);
+  return Status::OK();
+}
+
+Status ClientBase::PersistWriteBehind(const std::vector<ObjectID>& ids,
+                                      const uint64_t ttl) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WritePersistRequest(ids, ttl, true, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPersistReply(message_in));
+  invalidateMetaCache(ids);
+  return Status::OK();
+}
+
+Status ClientBase::Flush() {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteFlushRequest(message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadFlushReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::SetMemoryLimit(const size_t limit) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteSetMemoryLimitRequest(limit, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadSetMemoryLimitReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::SetTenantQuota(std::string const& tenant,
+                                  const size_t quota) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteSetTenantQuotaRequest(tenant, quota, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadSetTenantQuotaReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::HotObjects(const size_t limit,
+                              std::vector<BlobAccess>& blobs) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteAccessStatsRequest(true, limit, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadAccessStatsReply(message_in, blobs));
+  return Status::OK();
+}
+
+Status ClientBase::ColdObjects(const size_t limit,
+                               std::vector<BlobAccess>& blobs) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteAccessStatsRequest(false, limit, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadAccessStatsReply(message_in, blobs));
+  return Status::OK();
+}
+
+Status ClientBase::SlowRequests(const size_t limit,
+                                std::vector<SlowRequest>& requests) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteSlowRequestsRequest(limit, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadSlowRequestsReply(message_in, requests));
   return Status::OK();
 }
 
@@ -149,6 +435,18 @@ Status ClientBase::IfPersist(const ObjectID id, bool& persist) {
   return Status::OK();
 }
 
+Status ClientBase::IfDurable(const ObjectID id, bool& durable) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteIfPersistRequest(id, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  bool persist = false;
+  RETURN_ON_ERROR(ReadIfPersistReply(message_in, persist, durable));
+  return Status::OK();
+}
+
 Status ClientBase::Exists(const ObjectID id, bool& exists) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -182,6 +480,28 @@ Status ClientBase::PutName(const ObjectID id, std::string const& name) {
   return Status::OK();
 }
 
+Status ClientBase::PutNames(const std::map<std::string, ObjectID>& names) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WritePutNameRequest(names, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPutNameReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::PutNameAsync(const ObjectID id, std::string const& name,
+                                callback_t<> callback) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WritePutNameRequest(id, name, message_out);
+  return doAsyncRequest(
+      message_out, [callback](const Status& status, const ptree& reply) {
+        return callback(status.ok() ? ReadPutNameReply(reply) : status);
+      });
+}
+
 Status ClientBase::GetName(const std::string& name, ObjectID& id,
                            const bool wait) {
   ENSURE_CONNECTED(this);
@@ -205,6 +525,105 @@ Status ClientBase::DropName(const std::string& name) {
   return Status::OK();
 }
 
+Status ClientBase::CreateStream(const ObjectID& id, size_t const depth,
+                                size_t const readers, bool const parallel,
+                                size_t const retain) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCreateStreamRequest(id, depth, readers, parallel, retain, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadCreateStreamReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::StopStream(ObjectID const id, const bool failed) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteStopStreamRequest(id, failed, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadStopStreamReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::SeekStream(ObjectID const id, size_t const offset) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteSeekStreamRequest(id, offset, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadSeekStreamReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::Subscribe(std::string const& pattern, bool const regex,
+                             bool const names, uint64_t& subscription_id) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteSubscribeRequest(pattern, regex, names, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadSubscribeReply(message_in, subscription_id));
+  return Status::OK();
+}
+
+Status ClientBase::Unsubscribe(uint64_t const subscription_id) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteUnsubscribeRequest(subscription_id, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadUnsubscribeReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::GetObjectEvents(std::vector<ObjectEvent>& events,
+                                   bool const wait) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ERROR(pollMessages());
+  while (wait && object_events_.empty()) {
+    RETURN_ON_ASSERT(connected_, "Client is disconnected");
+    if (reading_) {
+      // the events are queued by the thread that is reading
+      client_mutex_.wait();
+      continue;
+    }
+    RETURN_ON_ERROR(readOnce());
+  }
+  events.insert(events.end(), object_events_.begin(), object_events_.end());
+  object_events_.clear();
+  return Status::OK();
+}
+
+Status ClientBase::WaitAll() {
+  ENSURE_CONNECTED(this);
+  while (!pending_replies_.empty()) {
+    if (reading_) {
+      // the replies are dispatched by the thread that is reading
+      client_mutex_.wait();
+      continue;
+    }
+    RETURN_ON_ERROR(readOnce());
+  }
+  auto status = async_status_;
+  async_status_ = Status::OK();
+  return status;
+}
+
+Status ClientBase::PollReplies() {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ERROR(pollMessages());
+  auto status = async_status_;
+  async_status_ = Status::OK();
+  return status;
+}
+
 bool ClientBase::Connected() const {
   if (connected_ &&
       recv(vineyard_conn_, NULL, 1, MSG_PEEK | MSG_DONTWAIT) != -1) {
@@ -214,19 +633,73 @@ bool ClientBase::Connected() const {
 }
 
 void ClientBase::Disconnect() {
-  std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_);
+  std::lock_guard<ClientMutex> __guard(this->client_mutex_);
   if (!this->connected_) {
     return;
   }
   std::string message_out;
   WriteExitRequest(message_out);
-  VINEYARD_SUPPRESS(doWrite(message_out));
+  VINEYARD_SUPPRESS(writeMessage(message_out));
+  ring_channel_.reset();
   close(vineyard_conn_);
   connected_ = false;
+  failPendingReplies(Status::ConnectionError("Client is disconnected"));
+  client_mutex_.notify_all();
+  sync_tags_.clear();
+  async_status_ = Status::OK();
+  meta_cache_.clear();
+  meta_cache_index_.clear();
+  object_events_.clear();
+}
+
+void ClientBase::SetMetaCacheCapacity(size_t const capacity) {
+  std::lock_guard<ClientMutex> __guard(this->client_mutex_);
+  meta_cache_capacity_ = capacity;
+  while (meta_cache_.size() > meta_cache_capacity_) {
+    meta_cache_index_.erase(meta_cache_.back().first);
+    meta_cache_.pop_back();
+  }
 }
 
-Status ClientBase::doWrite(const std::string& message_out) {
-  auto status = send_message(vineyard_conn_, message_out);
+Status ClientBase::doWrite(std::string& message_out) {
+  VINEYARD_SUPPRESS(startRequestSpan(message_out));
+  if (!request_tag_) {
+    return writeMessage(message_out);
+  }
+  // the reply is matched by the tag, other threads can issue their requests
+  // while this one is in flight.
+  uint64_t tag = next_request_tag_++;
+  RETURN_ON_ERROR(TagMessage(message_out, tag));
+  pending_replies_.emplace(tag, [this, tag](const Status& status,
+                                            const ptree& root) {
+    sync_replies_.emplace(tag, std::make_pair(status, root));
+    return Status::OK();
+  });
+  auto status = writeMessage(message_out);
+  if (status.ok()) {
+    sync_tags_[std::this_thread::get_id()] = tag;
+  } else {
+    pending_replies_.erase(tag);
+  }
+  return status;
+}
+
+Status ClientBase::writeMessage(const std::string& message_out) {
+  const std::string* message = &message_out;
+  std::string transcoded;
+  if (!binary_protocol_ && IsBinaryMessage(message_out)) {
+    // the server doesn't understand the binary protocol
+    transcoded = message_out;
+    RETURN_ON_ERROR(TranscodeToJSON(transcoded));
+    message = &transcoded;
+  }
+  if (ring_channel_ &&
+      ring_channel_->Requests().TryPush(message->data(), message->size())) {
+    ring_channel_->Requests().Notify();
+    return Status::OK();
+  }
+  // large requests are sent over the socket
+  auto status = send_message(vineyard_conn_, *message);
   if (!status.ok()) {
     connected_ = false;
   }
@@ -234,25 +707,237 @@ Status ClientBase::doWrite(const std::string& message_out) {
 }
 
 Status ClientBase::doRead(std::string& message_in) {
+  if (ring_channel_) {
+    bool redirected = false;
+    RETURN_ON_ERROR(
+        ring_channel_->Replies().Pop(message_in, redirected, vineyard_conn_));
+    if (!redirected) {
+      return Status::OK();
+    }
+  }
   return recv_message(vineyard_conn_, message_in);
 }
 
 Status ClientBase::doRead(ptree& root) {
+  struct SpanGuard {
+    ~SpanGuard() { inflight_span.Finish(); }
+  } __span_guard;
+  if (request_tag_) {
+    auto iter = sync_tags_.find(std::this_thread::get_id());
+    if (iter == sync_tags_.end()) {
+      return Status::Invalid("No request is waiting for the reply");
+    }
+    uint64_t tag = iter->second;
+    sync_tags_.erase(iter);
+    return waitReply(tag, root);
+  }
+  while (true) {
+    RETURN_ON_ERROR(readReply(root));
+    uint64_t tag = GetMessageTag(root);
+    if (tag == 0) {
+      return Status::OK();
+    }
+    dispatchReply(tag, Status::OK(), root);
+    root.clear();
+  }
+}
+
+Status ClientBase::doAsyncRequest(std::string& message_out,
+                                  callback_t<const ptree&> callback) {
+  if (!request_tag_) {
+    RETURN_ON_ERROR(doWrite(message_out));
+    ptree message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    auto status = callback(Status::OK(), message_in);
+    if (async_status_.ok() && !status.ok()) {
+      async_status_ = status;
+    }
+    return Status::OK();
+  }
+  uint64_t tag = next_request_tag_++;
+  RETURN_ON_ERROR(TagMessage(message_out, tag));
+  RETURN_ON_ERROR(writeMessage(message_out));
+  pending_replies_.emplace(tag, callback);
+  return Status::OK();
+}
+
+Status ClientBase::waitReply(uint64_t const tag, ptree& root) {
+  while (true) {
+    auto reply = sync_replies_.find(tag);
+    if (reply != sync_replies_.end()) {
+      auto status = reply->second.first;
+      root = std::move(reply->second.second);
+      sync_replies_.erase(reply);
+      return status;
+    }
+    if (reading_) {
+      // the reply will be dispatched by the thread that is reading
+      client_mutex_.wait();
+      continue;
+    }
+    auto status = readOnce();
+    if (!status.ok()) {
+      sync_replies_.erase(tag);
+      return status;
+    }
+  }
+}
+
+Status ClientBase::readOnce() {
+  ptree root;
+  reading_ = true;
+  auto status = readMessage(root, request_tag_);
+  reading_ = false;
+  if (status.ok() && !handleNotification(root)) {
+    uint64_t tag = GetMessageTag(root);
+    if (tag == 0) {
+      connected_ = false;
+      status = Status::Invalid("Unexpected reply without request tag");
+      failPendingReplies(status);
+    } else {
+      dispatchReply(tag, Status::OK(), root);
+    }
+  }
+  // wake up the waiting threads, either their replies have been dispatched,
+  // or one of them should take over the reading.
+  client_mutex_.notify_all();
+  return status;
+}
+
+Status ClientBase::readReply(ptree& root) {
+  while (true) {
+    RETURN_ON_ERROR(readMessage(root));
+    if (!handleNotification(root)) {
+      return Status::OK();
+    }
+    root.clear();
+  }
+}
+
+Status ClientBase::readMessage(ptree& root, bool const unlocked) {
   std::string message_in;
-  auto status = recv_message(vineyard_conn_, message_in);
+  Status status;
+  if (unlocked) {
+    // other threads can send requests while this one is blocked on reading
+    size_t depth = client_mutex_.release();
+    status = doRead(message_in);
+    client_mutex_.reacquire(depth);
+  } else {
+    status = doRead(message_in);
+  }
+  if (status.ok()) {
+    status = DecodeMessage(message_in, root);
+  }
+  if (status.ok()) {
+    status = receiveFds(root);
+  }
   if (!status.ok()) {
     connected_ = false;
-    return status;
+    failPendingReplies(status);
+  }
+  return status;
+}
+
+void ClientBase::dispatchReply(uint64_t const tag, const Status& status,
+                               const ptree& root) {
+  auto iter = pending_replies_.find(tag);
+  if (iter == pending_replies_.end()) {
+    LOG(ERROR) << "Unexpected reply with unknown request tag " << tag;
+    return;
+  }
+  // the callback may issue new requests.
+  auto callback = std::move(iter->second);
+  pending_replies_.erase(iter);
+  auto s = callback(status, root);
+  if (async_status_.ok() && !s.ok()) {
+    async_status_ = s;
   }
-  std::istringstream is(message_in);
-  status = CATCH_PTREE_ERROR([&]() -> Status {
-    bpt::read_json(is, root);
+}
+
+void ClientBase::failPendingReplies(const Status& status) {
+  while (!pending_replies_.empty()) {
+    dispatchReply(pending_replies_.begin()->first, status, ptree());
+  }
+}
+
+Status ClientBase::pollMessages() {
+  if (reading_) {
+    // the messages will be consumed by the thread that is reading
     return Status::OK();
-  }());
+  }
+  while (hasIncomingMessages()) {
+    RETURN_ON_ERROR(readOnce());
+  }
+  return Status::OK();
+}
+
+bool ClientBase::hasIncomingMessages() {
+  if (ring_channel_) {
+    // all messages are written to the ring, including the records of the
+    // ones that have been redirected to the socket.
+    return !ring_channel_->Replies().Empty();
+  }
+  char byte = 0;
+  return recv(vineyard_conn_, &byte, 1, MSG_PEEK | MSG_DONTWAIT) > 0;
+}
+
+bool ClientBase::handleNotification(const ptree& root) {
+  CommandType const type =
+      ParseCommandType(root.get<std::string>("type", ""));
+  if (type == CommandType::ObjectNotification) {
+    auto status = ReadObjectNotification(root, object_events_);
+    if (!status.ok()) {
+      LOG(ERROR) << "Invalid object notification: " << status.ToString();
+    }
+    return true;
+  }
+  if (type != CommandType::DeletionNotification) {
+    return false;
+  }
+  std::vector<ObjectID> ids;
+  auto status = ReadDeletionNotification(root, ids);
   if (!status.ok()) {
-    connected_ = false;
+    LOG(ERROR) << "Invalid deletion notification: " << status.ToString();
+  }
+  invalidateMetaCache(ids);
+  return true;
+}
+
+bool ClientBase::lookupMetaCache(const ObjectID id, ObjectMeta& meta) {
+  auto iter = meta_cache_index_.find(id);
+  if (iter == meta_cache_index_.end()) {
+    return false;
+  }
+  meta_cache_.splice(meta_cache_.begin(), meta_cache_, iter->second);
+  meta = iter->second->second;
+  return true;
+}
+
+void ClientBase::insertMetaCache(const ObjectID id, const ObjectMeta& meta) {
+  if (!metaCacheEnabled()) {
+    return;
+  }
+  auto iter = meta_cache_index_.find(id);
+  if (iter != meta_cache_index_.end()) {
+    meta_cache_.erase(iter->second);
+    meta_cache_index_.erase(iter);
+  }
+  meta_cache_.emplace_front(id, meta);
+  meta_cache_index_.emplace(id, meta_cache_.begin());
+  if (meta_cache_.size() > meta_cache_capacity_) {
+    meta_cache_index_.erase(meta_cache_.back().first);
+    meta_cache_.pop_back();
+  }
+}
+
+void ClientBase::invalidateMetaCache(const std::vector<ObjectID>& ids) {
+  for (auto const& id : ids) {
+    auto iter = meta_cache_index_.find(id);
+    if (iter != meta_cache_index_.end()) {
+      meta_cache_.erase(iter->second);
+      meta_cache_index_.erase(iter);
+    }
   }
-  return status;
 }
 
 Status ClientBase::ClusterInfo(std::map<InstanceID, ptree>& meta) {
@@ -308,8 +993,23 @@ InstanceStatus::InstanceStatus(const ptree& tree)
       deployment(tree.get<std::string>("deployment")),
       memory_usage(tree.get<size_t>("memory_usage")),
       memory_limit(tree.get<size_t>("memory_limit")),
+      prefault_size(tree.get<size_t>("prefault_size", 0)),
+      prefaulted_size(tree.get<size_t>("prefaulted_size", 0)),
+      slab_reserved(tree.get<size_t>("slab_reserved", 0)),
+      slab_used(tree.get<size_t>("slab_used", 0)),
+      slab_objects(tree.get<size_t>("slab_objects", 0)),
+      pinned_objects(tree.get<size_t>("pinned_objects", 0)),
+      deleting_objects(tree.get<size_t>("deleting_objects", 0)),
+      deleting_size(tree.get<size_t>("deleting_size", 0)),
+      device_memory_usage(tree.get<size_t>("device_memory_usage", 0)),
+      device_memory_limit(tree.get<size_t>("device_memory_limit", 0)),
       deferred_requests(tree.get<size_t>("deferred_requests")),
+      meta_nodes(tree.get<size_t>("meta_nodes", 0)),
+      meta_memory_usage(tree.get<size_t>("meta_memory_usage", 0)),
       ipc_connections(tree.get<size_t>("ipc_connections")),
-      rpc_connections(tree.get<size_t>("rpc_connections")) {}
+      rpc_connections(tree.get<size_t>("rpc_connections")),
+      tenants(tree.get_child("tenants", ptree())),
+      streams(tree.get_child("streams", ptree())),
+      metrics(tree.get_child("metrics", ptree())) {}
 
 }  // namespace vineyard
@@ -17,15 +17,22 @@ limitations under the License.
 #define SRC_CLIENT_CLIENT_BASE_H_
 
 #include <sys/mman.h>
+#include <condition_variable>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "client/ds/object_meta.h"
+#include "common/memory/shm_ring.h"
 #include "common/util/boost.h"
+#include "common/util/callback.h"
+#include "common/util/protocols.h"
 #include "common/util/status.h"
 #include "common/util/uuid.h"
 
@@ -33,13 +40,56 @@ namespace vineyard {
 
 struct InstanceStatus;
 
+/**
+ * @brief ClientMutex is the recursive mutex that protects the client, which
+ * can be released completely (whatever how many times the owner has locked
+ * it) by the thread that is waiting for the reply of its request, so that
+ * other threads can issue their requests meanwhile.
+ */
+class ClientMutex {
+ public:
+  void lock();
+
+  bool try_lock();
+
+  void unlock();
+
+  /**
+   * Release the mutex completely, returns how many times it has been locked.
+   */
+  size_t release();
+
+  /**
+   * Lock the mutex for the given times again, after `release`.
+   */
+  void reacquire(size_t const depth);
+
+  /**
+   * Release the mutex completely until the following `notify_all`, then
+   * lock it again.
+   */
+  void wait();
+
+  void notify_all();
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable released_, notified_;
+  std::thread::id owner_;
+  size_t depth_ = 0;
+  uint64_t generation_ = 0;
+};
+
 /**
  * @brief ClientBase is the base class for vineyard IPC and RPC client.
  *
  * ClientBase implements common communication stuffs, and leave the IPC and RPC
  * specific functionalities to Client and RPCClient.
  *
- * Vineyard's Client and RPCClient is non-copyable.
+ * Vineyard's Client and RPCClient is non-copyable, and is safe to be used by
+ * multiple threads: when the server echoes the request tags, the blocking
+ * requests of different threads are in flight concurrently, and the replies
+ * are demultiplexed by their tags by whichever thread is reading.
  */
 class ClientBase {
  public:
@@ -88,10 +138,13 @@ class ClientBase {
    * @param id The returned object ID of the created data.
    * @param instance_id The vineyard instance ID where this object is created.
    * at.
+   * @param ttl The object (and its members) will be deleted by the vineyard
+   * server after `ttl` seconds, 0 means never.
    *
    * @return Status that indicates whether the create action has succeeded.
    */
-  Status CreateData(const ptree& tree, ObjectID& id, InstanceID& instance_id);
+  Status CreateData(const ptree& tree, ObjectID& id, InstanceID& instance_id,
+                    const uint64_t ttl = 0);
 
   /**
    * @brief Create the metadata in the vineyard server, after created, the
@@ -162,15 +215,137 @@ class ClientBase {
                   size_t const limit,
                   std::unordered_map<ObjectID, ptree>& meta_trees);
 
+  /**
+   * @brief List object metadatas page by page, which avoids building a giant
+   * reply when there are lots of matched objects.
+   *
+   * The objects are listed in the order of (typename, object id). An empty
+   * cursor starts the listing from the beginning, and the cursor is then
+   * updated to the position for the next page, which becomes empty when all
+   * matched objects have been returned, e.g.,
+   *
+   * \code{.cpp}
+   *   std::string cursor;
+   *   do {
+   *     std::unordered_map<ObjectID, ptree> page;
+   *     RETURN_ON_ERROR(client.ListData("vineyard::*", false, 1000, cursor,
+   *                                     page));
+   *     // process the page
+   *   } while (!cursor.empty());
+   * \endcode
+   *
+   * @param pattern The pattern of typename.
+   * @param regex Whether the pattern is a regular expression pattern.
+   * @param limit The number limit of objects in a page.
+   * @param cursor The position to start listing, and the position for the
+   * next page on return.
+   * @param meta_trees An map that contains the returned object metadatas.
+   *
+   * @return Status that indicates whether the list action has succeeded.
+   */
+  Status ListData(std::string const& pattern, bool const regex,
+                  size_t const limit, std::string& cursor,
+                  std::unordered_map<ObjectID, ptree>& meta_trees);
+
   /**
    * @brief Persist the given object to etcd to make it visible to clients that
    * been connected to vineyard servers in the cluster.
    *
    * @param id The object id of object that will be persisted.
+   * @param ttl The object (and its members) will be deleted by the vineyard
+   * server after `ttl` seconds, 0 means keeping the expiry time of the
+   * object unchanged.
+   *
+   * @return Status that indicates whether the persist action has succeeded.
+   */
+  Status Persist(const ObjectID id, const uint64_t ttl = 0);
+
+  /**
+   * @brief Persist the given objects with one request, the changes of all
+   * these objects are committed to etcd at once, rather than one transaction
+   * per object.
+   *
+   * @param ids The object ids of objects that will be persisted.
+   * @param ttl See `Persist(id, ttl)`.
    *
    * @return Status that indicates whether the persist action has succeeded.
    */
-  Status Persist(const ObjectID id);
+  Status Persist(const std::vector<ObjectID>& ids, const uint64_t ttl = 0);
+
+  /**
+   * @brief Persist the given objects in write-behind mode: returns once the
+   * objects are persisted in the metadata of the connected vineyard server,
+   * i.e., visible to the clients of the same server, and the changes are
+   * committed to etcd in background, in batches.
+   *
+   * The write-behind changes are lost if the vineyard server exits before
+   * they are committed, use `Flush()` to wait for them.
+   *
+   * @param ids The object ids of objects that will be persisted.
+   * @param ttl See `Persist(id, ttl)`.
+   *
+   * @return Status that indicates whether the persist action has succeeded.
+   */
+  Status PersistWriteBehind(const std::vector<ObjectID>& ids,
+                            const uint64_t ttl = 0);
+
+  /**
+   * @brief Wait until the write-behind persists that are issued (by all
+   * clients of the connected vineyard server) before have been committed to
+   * etcd.
+   *
+   * @return Status that indicates whether the commits have succeeded.
+   */
+  Status Flush();
+
+  /**
+   * @brief Change the limit of the shared memory of the connected vineyard
+   * server at runtime, the limit can't be raised beyond the arena file when
+   * the shared memory is persistent.
+   *
+   * @param limit The new limit in bytes.
+   */
+  Status SetMemoryLimit(const size_t limit);
+
+  /**
+   * @brief Change the quota of the tenant on the connected vineyard server
+   * at runtime, the requests that would exceed the quota are rejected with
+   * `NotEnoughMemory`.
+   *
+   * @param tenant The tenant, "*" for the default quota of the tenants that
+   * haven't got their own.
+   * @param quota The quota in bytes, 0 means unlimited.
+   */
+  Status SetTenantQuota(std::string const& tenant, const size_t quota);
+
+  /**
+   * @brief Get the access statistics of the blobs on the connected vineyard
+   * server that have been got the most times, the most recently accessed
+   * ones first among the ties.
+   *
+   * @param limit The max number of blobs to return.
+   * @param blobs The statistics of blobs, from the hottest one.
+   */
+  Status HotObjects(const size_t limit, std::vector<BlobAccess>& blobs);
+
+  /**
+   * @brief Get the access statistics of the blobs on the connected vineyard
+   * server that haven't been got (or created) for the longest time.
+   *
+   * @param limit The max number of blobs to return.
+   * @param blobs The statistics of blobs, from the coldest one.
+   */
+  Status ColdObjects(const size_t limit, std::vector<BlobAccess>& blobs);
+
+  /**
+   * @brief Get the most recent requests that the connected vineyard server
+   * took longer than `--slow_request_threshold` to handle, along with where
+   * the time went.
+   *
+   * @param limit The max number of requests to return.
+   * @param requests The slow requests, from the most recent one.
+   */
+  Status SlowRequests(const size_t limit, std::vector<SlowRequest>& requests);
 
   /**
    * @brief Check if the given object has been persist to etcd.
@@ -184,6 +359,19 @@ class ClientBase {
    */
   Status IfPersist(const ObjectID id, bool& persist);
 
+  /**
+   * @brief Check if the persist of the given object has been committed to
+   * etcd, i.e., the object is persisted and not waiting for the write-behind
+   * committer, see also `PersistWriteBehind`.
+   *
+   * @param id The object id to check.
+   * @param durable The result variable will be stored in `durable` as return
+   * value.
+   *
+   * @return Status that indicates whether the check has succeeded.
+   */
+  Status IfDurable(const ObjectID id, bool& durable);
+
   /**
    * @brief Check if the given object exists in vineyard server.
    *
@@ -221,6 +409,16 @@ class ClientBase {
    */
   Status PutName(const ObjectID id, std::string const& name);
 
+  /**
+   * @brief Register multiple name entries with one request, which are
+   * committed at once.
+   *
+   * @param names The names and the objects that they are associated with.
+   *
+   * @return Status that indicates whether the request has succeeded.
+   */
+  Status PutNames(const std::map<std::string, ObjectID>& names);
+
   /**
    * @brief Retrieve the object ID by assoicated name.
    *
@@ -244,6 +442,208 @@ class ClientBase {
    */
   Status DropName(const std::string& name);
 
+  /**
+   * @brief Allocate a stream on vineyard. The metadata of parameter `id` must
+   * has already been created on vineyard.
+   *
+   * @param id The id of metadata that will be used to create stream.
+   * @param depth The max number of chunks that the producer can write ahead
+   * of the consumer, the producer will be blocked in `GetNextStreamChunk`
+   * until the consumer pulls a chunk. 0 means using the default depth of
+   * the vineyard server.
+   * @param readers The number of consumers of a broadcast stream, every chunk
+   * is delivered to each of them, and is freed after the last one pulls the
+   * next chunk.
+   * @param parallel Whether the chunks are load-balanced across the consumers,
+   * i.e., every chunk is delivered to exactly one of them, rather than
+   * broadcast. Parallel streams accept any number of consumers.
+   *
+   * The consumers of a multi-consumer stream are distinguished by their
+   * connections to vineyard.
+   *
+   * @param retain The number of consumed chunks that are retained for
+   * replaying. The consumers of a retaining stream may reattach from new
+   * connections at where they left, and replay from a chunk by `SeekStream`.
+   * Parallel streams cannot retain chunks.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateStream(const ObjectID& id, size_t const depth = 0,
+                      size_t const readers = 1, bool const parallel = false,
+                      size_t const retain = 0);
+
+  /**
+   * @brief Move the reader of a retaining stream to the `offset`-th chunk,
+   * the next pulled chunk will be that chunk.
+   *
+   * @param id The id of the stream.
+   * @param offset The sequence number of the chunk, which must be retained or
+   * not yet pulled.
+   *
+   * @return Status that indicates whether the request has succeeded.
+   */
+  Status SeekStream(ObjectID const id, size_t const offset);
+
+  /**
+   * @brief Subscribe the objects whose typenames match the pattern, the
+   * server pushes the objects once they are created (sealed by this instance,
+   * or persisted by other instances), see also `GetObjectEvents`.
+   *
+   * @param pattern The glob (or regex) pattern of typenames, or names if
+   * `names` is set.
+   * @param regex Whether the pattern is a regex.
+   * @param names Subscribe the names that match the pattern instead, the
+   * server pushes the object that the name refers to once the name is put.
+   * @param subscription_id The id of the subscription, to unsubscribe and to
+   * tell the events of different subscriptions apart.
+   *
+   * @return Status that indicates whether the subscription has succeeded.
+   */
+  Status Subscribe(std::string const& pattern, bool const regex,
+                   bool const names, uint64_t& subscription_id);
+
+  /**
+   * @brief Stop the subscription, the events that have already arrived are
+   * still returned by `GetObjectEvents`.
+   */
+  Status Unsubscribe(uint64_t const subscription_id);
+
+  /**
+   * @brief Get the objects pushed for the subscriptions since the last call.
+   *
+   * @param events The arrived events, appended in the order of arrival.
+   * @param wait Block until at least one event has arrived. Other threads
+   * can still issue their requests while this one is waiting.
+   *
+   * @return Status that indicates whether the events have been received.
+   */
+  Status GetObjectEvents(std::vector<ObjectEvent>& events,
+                         bool const wait = false);
+
+  /**
+   * @brief Stop a stream, mark it as finished or aborted.
+   *
+   * @param id The id of the stream.
+   * @param failed Whether the stream is stoped at a successful state. True
+   * means the stream has been exited normally, otherwise false.
+   *
+   * @return Status that indicates whether the request has succeeded.
+   */
+  Status StopStream(ObjectID const id, bool failed);
+
+  /**
+   * @brief Asynchronous variant of `GetData`, the request is sent without
+   * waiting for the reply, and the callback will be invoked with the metadata
+   * once the reply arrives, see also `WaitAll`.
+   *
+   * Requests issued asynchronously are tagged, thus many of them can be in
+   * flight on the same connection at the same time, and their replies, which
+   * may arrive out of order, are matched with the requests by the tag.
+   * Callbacks are invoked in the thread that is consuming replies, i.e.,
+   * inside `WaitAll` or a blocking call on the same client.
+   *
+   * @param id The ID of the requested object.
+   * @param callback The callback to receive the requested metadata.
+   * @param sync_remote Whether to trigger an immediate remote metadata
+   *        synchronization before get specific metadata. Default is false.
+   * @param wait The request could be blocked util the object with given id has
+   *        been created on vineyard by other clients. Default is false.
+   *
+   * @return Status that indicates whether the request has been sent.
+   */
+  Status GetDataAsync(const ObjectID id, callback_t<const ptree&> callback,
+                      const bool sync_remote = false, const bool wait = false);
+
+  /**
+   * @brief Asynchronous variant of `GetData` for multiple objects, the
+   * metadatas are passed to the callback in the same order of `ids`.
+   *
+   * @return Status that indicates whether the request has been sent.
+   */
+  Status GetDataAsync(const std::vector<ObjectID>& ids,
+                      callback_t<const std::vector<ptree>&> callback,
+                      const bool sync_remote = false, const bool wait = false);
+
+  /**
+   * @brief Asynchronous variant of `CreateData`, the callback receives the
+   * object ID of the created data and the instance ID where it is created at.
+   *
+   * @return Status that indicates whether the request has been sent.
+   */
+  Status CreateDataAsync(const ptree& tree,
+                         callback_t<const ObjectID, const InstanceID> callback,
+                         const uint64_t ttl = 0);
+
+  /**
+   * @brief Asynchronous variant of `Persist`.
+   *
+   * @return Status that indicates whether the request has been sent.
+   */
+  Status PersistAsync(const ObjectID id, callback_t<> callback,
+                      const uint64_t ttl = 0);
+
+  /**
+   * @brief Asynchronous variant of `PutName`.
+   *
+   * @return Status that indicates whether the request has been sent.
+   */
+  Status PutNameAsync(const ObjectID id, std::string const& name,
+                      callback_t<> callback);
+
+  /**
+   * @brief Wait until the replies of all in-flight asynchronous requests
+   * have arrived and their callbacks have been invoked, including requests
+   * issued by these callbacks.
+   *
+   * @return Status that indicates whether all replies have been received,
+   * or the first error returned by the callbacks.
+   */
+  Status WaitAll();
+
+  /**
+   * @brief The number of asynchronous requests whose replies haven't been
+   * received yet.
+   */
+  size_t PendingRequests() const { return pending_replies_.size(); }
+
+  /**
+   * @brief Consume the replies that have already arrived without blocking,
+   * and invoke the callbacks of the corresponding asynchronous requests.
+   *
+   * Together with `ConnectionFd`, it allows driving the asynchronous requests
+   * from an event loop, rather than blocking in `WaitAll`.
+   *
+   * @return Status that indicates whether the replies have been consumed,
+   * or the first error returned by the callbacks.
+   */
+  Status PollReplies();
+
+  /**
+   * @brief The file descriptor of the connection to the vineyard server, it
+   * becomes readable when replies or notifications arrive.
+   *
+   * Note that replies are delivered through the shared memory rings rather
+   * than the socket once the ring channel has been opened.
+   */
+  int ConnectionFd() const { return vineyard_conn_; }
+
+  static constexpr size_t kDefaultMetaCacheCapacity = 1024;
+
+  /**
+   * @brief Set how many object metadatas can be cached by `GetMetaData` at
+   * most, 0 disables the cache. The least recently used ones are evicted.
+   *
+   * The metadata of sealed objects is immutable: the server notifies the
+   * client once the objects that it has got are deleted, thus repeated gets
+   * of cached objects are served locally without any request.
+   */
+  void SetMetaCacheCapacity(size_t const capacity);
+
+  /**
+   * @brief How many object metadatas are in the cache now.
+   */
+  size_t MetaCacheSize() const { return meta_cache_.size(); }
+
   /**
    * @brief Check if the client still connects to the vineyard server.
    *
@@ -312,20 +712,145 @@ class ClientBase {
   Status Instances(std::vector<InstanceID>& instances);
 
  protected:
-  Status doWrite(const std::string& message_out);
+  /**
+   * Send the blocking request, which is tagged if the server supports tagged
+   * requests, the reply is read by the following `doRead` of the thread.
+   */
+  Status doWrite(std::string& message_out);
 
   Status doRead(std::string& message_in);
 
+  /**
+   * Read the reply of the blocking request, replies of asynchronous requests
+   * that arrive before it are dispatched to their callbacks.
+   *
+   * For tagged requests the client is released while waiting, the replies
+   * of other threads are dispatched to them if this thread is the one that
+   * is reading.
+   */
   Status doRead(ptree& root);
 
+  /**
+   * Send the message as is.
+   */
+  Status writeMessage(const std::string& message_out);
+
+  /**
+   * Send the request with a new tag, the callback will be invoked with the
+   * reply once it arrives. Falls back to a blocking round trip if the server
+   * doesn't support tagged requests.
+   */
+  Status doAsyncRequest(std::string& message_out,
+                        callback_t<const ptree&> callback);
+
+  /**
+   * Read the next reply from the server, the deletion notifications that
+   * arrive before it are consumed on the way.
+   */
+  Status readReply(ptree& root);
+
+  /**
+   * Read and decode the next message from the server, and receive the fds
+   * that follow it. If `unlocked`, the client is released during reading.
+   */
+  Status readMessage(ptree& root, bool const unlocked = false);
+
+  /**
+   * Read the next message as the only reading thread, and dispatch it.
+   */
+  Status readOnce();
+
+  /**
+   * Wait until the reply of the tagged blocking request arrives.
+   */
+  Status waitReply(uint64_t const tag, ptree& root);
+
+  /**
+   * Receive the fds that follow the reply on the socket, before reading the
+   * next message, as the reply may be read by another thread than the one
+   * that has sent the request.
+   */
+  virtual Status receiveFds(ptree& root) { return Status::OK(); }
+
+  /**
+   * Consume the messages that have already arrived without blocking, i.e.,
+   * the deletion notifications and the replies of asynchronous requests.
+   */
+  Status pollMessages();
+
+  /**
+   * Whether there are messages from the server that haven't been read yet.
+   */
+  bool hasIncomingMessages();
+
+  /**
+   * Returns true if the message is pushed by the server: deletion
+   * notifications (the deleted objects are dropped from the metadata cache),
+   * or object notifications (the events are queued).
+   */
+  bool handleNotification(const ptree& root);
+
+  /**
+   * The metadata cache is only used when the server keeps it up to date by
+   * the deletion notifications.
+   */
+  bool metaCacheEnabled() const {
+    return deletion_notification_ && meta_cache_capacity_ > 0;
+  }
+
+  bool lookupMetaCache(const ObjectID id, ObjectMeta& meta);
+
+  void insertMetaCache(const ObjectID id, const ObjectMeta& meta);
+
+  void invalidateMetaCache(const std::vector<ObjectID>& ids);
+
+  void dispatchReply(uint64_t const tag, const Status& status,
+                     const ptree& root);
+
+  /**
+   * Invoke the callbacks of all in-flight requests with the error, e.g.,
+   * when the connection has been lost.
+   */
+  void failPendingReplies(const Status& status);
+
   mutable bool connected_;
+  // whether the server has agreed to use the binary protocol during register
+  bool binary_protocol_;
   std::string ipc_socket_;
   std::string rpc_endpoint_;
   int vineyard_conn_;
   InstanceID instance_id_;
+  // requests and replies go through the shared memory rings once opened.
+  std::unique_ptr<ShmRingChannel> ring_channel_;
+  // whether the server echoes the tags of requests in replies
+  bool request_tag_;
+  uint64_t next_request_tag_;
+  // callbacks of in-flight asynchronous requests, indexed by tag
+  std::unordered_map<uint64_t, callback_t<const ptree&>> pending_replies_;
+  // the first error returned by the callbacks, reported by `WaitAll`
+  Status async_status_;
+  // whether a thread is reading from the server with the client released
+  bool reading_;
+  // the tag of the blocking request of each thread that is waiting for the
+  // reply, and the arrived replies.
+  std::unordered_map<std::thread::id, uint64_t> sync_tags_;
+  std::unordered_map<uint64_t, std::pair<Status, ptree>> sync_replies_;
+  // whether the server pushes the deletion notifications of the objects that
+  // this client has got
+  bool deletion_notification_;
+  // the pushed objects of the subscriptions, see also `GetObjectEvents`
+  std::vector<ObjectEvent> object_events_;
+  // the LRU cache of the metadata of objects, the most recently used comes
+  // first. Sealed objects are immutable, thus the entries are only dropped
+  // when the objects are deleted, or been evicted.
+  size_t meta_cache_capacity_;
+  std::list<std::pair<ObjectID, ObjectMeta>> meta_cache_;
+  std::unordered_map<ObjectID,
+                     std::list<std::pair<ObjectID, ObjectMeta>>::iterator>
+      meta_cache_index_;
 
   // A mutex which protects the client.
-  std::recursive_mutex client_mutex_;
+  ClientMutex client_mutex_;
 };
 
 struct InstanceStatus {
@@ -337,12 +862,47 @@ struct InstanceStatus {
   const size_t memory_usage;
   /// The memory upper bound of this vineyard server, in bytes.
   const size_t memory_limit;
+  /// The memory to pre-fault at startup, in bytes, 0 if pre-faulting is
+  /// disabled.
+  const size_t prefault_size;
+  /// The memory that has been pre-faulted so far, in bytes.
+  const size_t prefaulted_size;
+  /// The memory reserved by slabs for small blobs, in bytes.
+  const size_t slab_reserved;
+  /// The memory occupied by small blobs in slabs, in bytes.
+  const size_t slab_used;
+  /// How many small blobs live in slabs.
+  const size_t slab_objects;
+  /// How many blobs are mapped by clients.
+  const size_t pinned_objects;
+  /// How many blobs have been deleted but are still mapped by clients, and
+  /// their memory in bytes, which is freed once the clients release them.
+  const size_t deleting_objects;
+  const size_t deleting_size;
+  /// The current usage of device memory, in bytes.
+  const size_t device_memory_usage;
+  /// The device memory upper bound of this vineyard server, in bytes, 0 means
+  /// device blobs are disabled.
+  const size_t device_memory_limit;
   /// How many requests are deferred in the queue.
   const size_t deferred_requests;
+  /// How many nodes are in the metadata of this vineyard server, and their
+  /// estimated memory footprint in bytes.
+  const size_t meta_nodes;
+  const size_t meta_memory_usage;
   /// How many Client connects to this vineyard server.
   const size_t ipc_connections;
   /// How many RPCClient connects to this vineyard server.
   const size_t rpc_connections;
+  /// The usage, quota, blobs and rejected requests of each tenant.
+  const ptree tenants;
+  /// The chunks and bytes produced and consumed, the queue depth, and the
+  /// time the producer has been blocked and the consumers have waited, of
+  /// each stream.
+  const ptree streams;
+  /// The latency histograms of requests (per command type) and etcd commits,
+  /// and the traffic of connections.
+  const ptree metrics;
 
   /**
    * @brief Initialize the status value using a ptree returned from the vineyard
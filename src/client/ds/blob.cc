@@ -15,7 +15,14 @@ limitations under the License.
 
 #include "client/ds/blob.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
 #include <limits>
+#include <string>
+
+#define XXH_INLINE_ALL
+#include "arrow/vendored/xxhash.h"
 
 #include "client/client.h"
 
@@ -66,7 +73,16 @@ void Blob::Construct(ObjectMeta const& meta) {
   this->meta_ = meta;
   this->id_ = meta.GetId();
   meta.GetKeyValue("length", this->size_);
-  if (auto client = dynamic_cast<Client*>(meta.GetClient())) {
+  if (meta.Haskey("device_id")) {
+    meta.GetKeyValue("device_id", this->device_id_);
+  }
+  // the payload may have been mapped (or copied, e.g., by the RPCClient)
+  // together with the metadata
+  auto const& blobs = meta.GetBlobSet()->AllBlobs();
+  auto iter = blobs.find(meta.GetId());
+  if (iter != blobs.end() && iter->second.BufferUnsafe() != nullptr) {
+    buffer_ = iter->second.BufferUnsafe();
+  } else if (auto client = dynamic_cast<Client*>(meta.GetClient())) {
     Payload object;
     if (this->size_ == 0) {
       // dummy blob
@@ -74,11 +90,7 @@ void Blob::Construct(ObjectMeta const& meta) {
     } else {
       auto status = client->GetBuffer(meta.GetId(), object);
       if (status.ok()) {
-        uint8_t* mmapped_ptr = nullptr;
-        VINEYARD_CHECK_OK(client->mmapToClient(object.store_fd, object.map_size,
-                                               true, &mmapped_ptr));
-        buffer_ = arrow::Buffer::Wrap(mmapped_ptr + object.data_offset,
-                                      object.data_size);
+        VINEYARD_CHECK_OK(client->mapBuffer(object, buffer_));
       } else {
         throw std::runtime_error("Failed to construct blob: " +
                                  VYObjectIDToString(meta.GetId()));
@@ -87,6 +99,23 @@ void Blob::Construct(ObjectMeta const& meta) {
   }
 }
 
+std::string Blob::ContentHash() const {
+  if (meta_.Haskey("content_hash")) {
+    return meta_.GetKeyValue("content_hash");
+  }
+  if (device_id_ >= 0 || (size_ > 0 && buffer_ == nullptr)) {
+    return std::string();
+  }
+  return HashContent(size_ > 0 ? buffer_->data() : nullptr, size_);
+}
+
+std::string Blob::HashContent(const void* data, const size_t size) {
+  char hash[24] = {0};
+  std::snprintf(hash, sizeof(hash), "xxh3:%016" PRIx64,
+                static_cast<uint64_t>(XXH3_64bits(data, size)));
+  return std::string(hash);
+}
+
 std::shared_ptr<Blob> Blob::MakeEmpty(Client& client) {
   std::shared_ptr<Blob> empty_blob(new Blob(EmptyBlobID(), 0, nullptr));
   empty_blob->meta_.SetId(EmptyBlobID());
@@ -129,22 +158,46 @@ void BlobWriter::AddKeyValue(std::string const& key, std::string&& value) {
 }
 
 std::shared_ptr<Object> BlobWriter::_Seal(Client& client) {
-  // get blob and re-map
-  Payload object;
-  VINEYARD_CHECK_OK(client.GetBuffer(object_id_, object));
-  uint8_t* mmapped_ptr = nullptr;
-  VINEYARD_CHECK_OK(client.mmapToClient(object.store_fd, object.map_size, false,
-                                        &mmapped_ptr));
-  auto ro_buffer =
-      arrow::Buffer::Wrap(mmapped_ptr + object.data_offset, object.data_size);
+  std::shared_ptr<arrow::Buffer> ro_buffer = nullptr;
+  if (arena_) {
+    // the region of the arena has already been mapped to the client
+    if (!arena_->sealed) {
+      VINEYARD_CHECK_OK(Status::Invalid(
+          "The blob arena must be sealed before sealing its blobs"));
+    }
+    object_id_ = arena_->ids[arena_index_];
+    uint8_t* mmapped_ptr = nullptr;
+    VINEYARD_CHECK_OK(client.mmapToClient(arena_->region.store_fd,
+                                          arena_->region.map_size, false,
+                                          &mmapped_ptr));
+    ro_buffer = arrow::Buffer::Wrap(
+        mmapped_ptr + arena_->region.data_offset + arena_offset_, size());
+  } else {
+    // get blob and re-map
+    Payload object;
+    VINEYARD_CHECK_OK(client.GetBuffer(object_id_, object));
+    uint8_t* mmapped_ptr = nullptr;
+    VINEYARD_CHECK_OK(client.mapPayload(object, false, &mmapped_ptr));
+    ro_buffer = arrow::Buffer::Wrap(mmapped_ptr, object.data_size);
+  }
 
   std::shared_ptr<Blob> blob(new Blob(object_id_, size(), ro_buffer));
+  blob->device_id_ = device_id_;
 
   blob->meta_.SetId(object_id_);  // blob's id is the address
   // create meta in vineyardd
   blob->meta_.SetTypeName(type_name<Blob>());
   blob->meta_.AddKeyValue("length", size());
   blob->meta_.SetNBytes(size());
+  if (device_id_ >= 0) {
+    blob->meta_.AddKeyValue("device_id", device_id_);
+  }
+
+  if (client.content_hashing() && device_id_ < 0 &&
+      metadata_.find("content_hash") == metadata_.end()) {
+    blob->meta_.AddKeyValue("content_hash",
+                            Blob::HashContent(ro_buffer->data(), size()));
+  }
 
   // assoicate extra key-value metadata
   for (auto const& kv : metadata_) {
@@ -155,6 +208,61 @@ std::shared_ptr<Object> BlobWriter::_Seal(Client& client) {
   return blob;
 }
 
+constexpr size_t BlobArena::kAlignment;
+
+BlobArena::BlobArena(ObjectID const region_id, Payload const& region,
+                     uint8_t* pointer)
+    : state_(std::make_shared<BlobWriter::ArenaState>()),
+      pointer_(pointer),
+      allocated_(0) {
+  state_->region_id = region_id;
+  state_->region = region;
+}
+
+size_t BlobArena::Capacity() const {
+  return static_cast<size_t>(state_->region.data_size);
+}
+
+size_t BlobArena::Allocated() const { return allocated_; }
+
+uint8_t* BlobArena::Unallocated() const { return pointer_ + allocated_; }
+
+Status BlobArena::Allocate(size_t size, std::unique_ptr<BlobWriter>& blob) {
+  if (state_->sealed) {
+    return Status::Invalid("The blob arena has already been sealed");
+  }
+  if (size == 0) {
+    return Status::Invalid("Cannot allocate empty blob from the arena");
+  }
+  if (allocated_ + size > Capacity()) {
+    return Status::NotEnoughMemory(
+        "Blob arena: capacity = " + std::to_string(Capacity()) +
+        ", allocated = " + std::to_string(allocated_) +
+        ", requested = " + std::to_string(size));
+  }
+  size_t offset = allocated_;
+  allocated_ = std::min(Capacity(),
+                        (offset + size + kAlignment - 1) / kAlignment *
+                            kAlignment);
+  auto buffer =
+      std::make_shared<arrow::MutableBuffer>(pointer_ + offset, size);
+  blob.reset(new BlobWriter(state_, state_->offsets.size(), offset, buffer));
+  state_->offsets.emplace_back(offset);
+  state_->sizes.emplace_back(size);
+  return Status::OK();
+}
+
+Status BlobArena::Seal(Client& client) {
+  if (state_->sealed) {
+    return Status::Invalid("The blob arena has already been sealed");
+  }
+  RETURN_ON_ERROR(client.SplitBuffer(state_->region_id, state_->offsets,
+                                     state_->sizes, state_->ids));
+  RETURN_ON_ASSERT(state_->ids.size() == state_->offsets.size());
+  state_->sealed = true;
+  return Status::OK();
+}
+
 void BlobSet::EmplaceId(ObjectID const id, size_t const size, bool local) {
   if (local) {
     ids_.emplace(id);
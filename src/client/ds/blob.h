@@ -21,14 +21,17 @@ limitations under the License.
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "arrow/buffer.h"
 
 #include "client/ds/i_object.h"
+#include "common/memory/payload.h"
 #include "common/util/uuid.h"
 
 namespace vineyard {
 
+class BlobArena;
 class BlobWriter;
 class BlobSet;
 class Client;
@@ -65,6 +68,14 @@ class Blob : public Registered<Blob> {
    */
   const std::shared_ptr<arrow::Buffer>& Buffer() const;
 
+  /**
+   * @brief Get the CUDA device where the payload resides, the data pointer
+   * is a device pointer if it is not -1.
+   *
+   * @return The CUDA device, or -1 for blobs in the shared memory.
+   */
+  int device_id() const { return device_id_; }
+
   static std::shared_ptr<Object> Create() __attribute__((used)) {
     return std::static_pointer_cast<Object>(std::shared_ptr<Blob>{new Blob()});
   }
@@ -83,6 +94,22 @@ class Blob : public Registered<Blob> {
    */
   static std::shared_ptr<Blob> MakeEmpty(Client& client);
 
+  /**
+   * @brief The hash of the payload, i.e., "xxh3:<the 64-bit XXH3 in hex>",
+   * which is recorded in the metadata as "content_hash" when the blob is
+   * sealed by a client with content hashing enabled, see also
+   * `Client::SetContentHashing`, otherwise it is computed from the payload.
+   *
+   * @return The hash, or an empty string if the payload isn't available
+   * locally, e.g., remote blobs or blobs on devices.
+   */
+  std::string ContentHash() const;
+
+  /**
+   * @brief Hash the payload in the same way as `ContentHash`.
+   */
+  static std::string HashContent(const void* data, const size_t size);
+
  private:
   /** The default constructor is only used in BlobWriter.
    */
@@ -95,11 +122,13 @@ class Blob : public Registered<Blob> {
 
   size_t size_;
   std::shared_ptr<arrow::Buffer> buffer_;
+  int device_id_ = -1;
 
   friend class Client;
   friend class RPCClient;
   friend class BlobWriter;
   friend class BlobSet;
+  friend class CopyOnWriteView;
   friend class ObjectMeta;
 };
 
@@ -140,6 +169,14 @@ class BlobWriter : public ObjectBuilder {
    */
   const std::shared_ptr<arrow::MutableBuffer>& Buffer() const;
 
+  /**
+   * @brief Get the CUDA device where the payload resides, see also
+   * `Client::CreateDeviceBlob`.
+   *
+   * @return The CUDA device, or -1 for blobs in the shared memory.
+   */
+  int device_id() const { return device_id_; }
+
   /**
    * @brief Build a blob in vineyard server.
    *
@@ -167,17 +204,121 @@ class BlobWriter : public ObjectBuilder {
   std::shared_ptr<Object> _Seal(Client& client) override;
 
  private:
+  struct ArenaState;
+
   BlobWriter(ObjectID const object_id,
              std::shared_ptr<arrow::MutableBuffer> const& buffer)
       : object_id_(object_id), buffer_(buffer) {}
 
+  BlobWriter(std::shared_ptr<ArenaState> const& arena, size_t const index,
+             size_t const offset,
+             std::shared_ptr<arrow::MutableBuffer> const& buffer)
+      : object_id_(InvalidObjectID()),
+        buffer_(buffer),
+        arena_(arena),
+        arena_index_(index),
+        arena_offset_(offset) {}
+
   ObjectID object_id_;
   std::shared_ptr<arrow::MutableBuffer> buffer_;
+  int device_id_ = -1;
   // Allowing blobs have extra key-value metadata
   std::unordered_map<std::string, std::string> metadata_;
 
+  // The arena that the blob is allocated from, nullptr if the blob is
+  // created by `Client::CreateBlob`.
+  std::shared_ptr<ArenaState> arena_;
+  size_t arena_index_ = 0;
+  size_t arena_offset_ = 0;
+
   friend class Client;
   friend class RPCClient;
+  friend class BlobArena;
+};
+
+/**
+ * @brief The state of a blob arena that shared with the blob writers that
+ * allocated from it.
+ */
+struct BlobWriter::ArenaState {
+  // the reserved region
+  ObjectID region_id;
+  Payload region;
+  // sub-blobs that have been allocated
+  std::vector<size_t> offsets;
+  std::vector<size_t> sizes;
+  // ids of sub-blobs, available after the arena has been sealed
+  std::vector<ObjectID> ids;
+  bool sealed = false;
+};
+
+/**
+ * @brief BlobArena reserves a large memory region from the vineyard server,
+ * and sub-allocates blob writers from the region locally without any IPC.
+ *
+ * All sub-blobs will be registered to the vineyard server by one request when
+ * the arena is sealed, and blob writers allocated from the arena can only
+ * be sealed after that.
+ */
+class BlobArena {
+ public:
+  /**
+   * @brief The alignment of the blob writers that allocated from the arena.
+   */
+  static constexpr size_t kAlignment = 64;
+
+  /**
+   * @brief Get the capacity of the arena, in bytes.
+   */
+  size_t Capacity() const;
+
+  /**
+   * @brief Get the number of bytes that has been allocated from the arena,
+   * including the padding for alignment.
+   */
+  size_t Allocated() const;
+
+  /**
+   * @brief Get the pointer to the unallocated space of the arena, where the
+   * next blob writer will be allocated from.
+   *
+   * The space can be written before the allocation, e.g., by a producer that
+   * doesn't know the final size of the blob in advance.
+   */
+  uint8_t* Unallocated() const;
+
+  /**
+   * @brief Allocate a blob writer of the given size from the arena. The
+   * allocation is local, and fails when the arena doesn't have enough space
+   * or has been sealed.
+   *
+   * @param size The size of the blob, must be greater than zero.
+   * @param blob The result mutable blob will be set in `blob`.
+   *
+   * @return Status that indicates whether the allocation has succeeded.
+   */
+  Status Allocate(size_t size, std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Register all allocated blobs to the vineyard server in a single
+   * request. The unused space of the arena will be released after all the
+   * blobs have been deleted.
+   *
+   * @param client The client connected to the vineyard server.
+   *
+   * @return Status that indicates whether the seal action has succeeded.
+   */
+  Status Seal(Client& client);
+
+ private:
+  BlobArena(ObjectID const region_id, Payload const& region,
+            uint8_t* pointer);
+
+  std::shared_ptr<BlobWriter::ArenaState> state_;
+  uint8_t* pointer_;
+  size_t allocated_;
+
+  friend class Client;
 };
 
 /**
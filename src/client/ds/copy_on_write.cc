@@ -0,0 +1,146 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "client/ds/copy_on_write.h"
+
+#include <cstring>
+#include <string>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+namespace vineyard {
+
+CopyOnWriteView::CopyOnWriteView(Client& client, const ObjectMeta& meta)
+    : client_(client), meta_(meta), tree_(meta.MetaData()) {}
+
+// the copies that have not been sealed are left to the server, the same as
+// the dropped `BlobWriter`s.
+CopyOnWriteView::~CopyOnWriteView() {}
+
+Status CopyOnWriteView::Mutable(const ObjectID blob_id, BlobWriter*& writer) {
+  RETURN_ON_ASSERT(!sealed_, "The copy-on-write view has been sealed");
+  auto iter = copies_.find(blob_id);
+  if (iter != copies_.end()) {
+    writer = iter->second.get();
+    return Status::OK();
+  }
+  auto const& blobs = meta_.GetBlobSet()->AllBlobs();
+  auto blob = blobs.find(blob_id);
+  RETURN_ON_ASSERT(blob != blobs.end(), "The blob " +
+                                            VYObjectIDToString(blob_id) +
+                                            " is not a member of the object");
+  auto const& buffer = blob->second.BufferUnsafe();
+  RETURN_ON_ASSERT(buffer != nullptr, "The blob " +
+                                          VYObjectIDToString(blob_id) +
+                                          " is not a local blob");
+  std::unique_ptr<BlobWriter> copy;
+  RETURN_ON_ERROR(client_.CreateBlob(buffer->size(), copy));
+  if (buffer->size() > 0) {
+    memcpy(copy->data(), buffer->data(), buffer->size());
+  }
+  writer = copy.get();
+  copies_.emplace(blob_id, std::move(copy));
+  return Status::OK();
+}
+
+bool CopyOnWriteView::Touched(const ObjectID blob_id) const {
+  return copies_.find(blob_id) != copies_.end();
+}
+
+Status CopyOnWriteView::SetMember(const std::string& member,
+                                  const std::string& name,
+                                  const ObjectMeta& value) {
+  RETURN_ON_ASSERT(value.MetaData().find("id") != value.MetaData().not_found(),
+                   "The member must be created in vineyard");
+  ptree* tree = nullptr;
+  RETURN_ON_ERROR(getMemberTree(member, tree));
+  tree->put_child(name, value.MetaData());
+  dirty_.emplace(member);
+  return Status::OK();
+}
+
+Status CopyOnWriteView::Seal(ObjectID& target_id) {
+  RETURN_ON_ASSERT(!sealed_, "The copy-on-write view has been sealed");
+  sealed_ = true;
+  if (copies_.empty() && dirty_.empty()) {
+    return client_.ShallowCopy(meta_.GetId(), target_id);
+  }
+  bool changed = false;
+  RETURN_ON_ERROR(rebuild(tree_, "", changed));
+  if (!changed) {
+    // the touched blobs are not referred by the object
+    return client_.ShallowCopy(meta_.GetId(), target_id);
+  }
+  target_id = VYObjectIDFromString(tree_.get<std::string>("id"));
+  return Status::OK();
+}
+
+Status CopyOnWriteView::getMemberTree(const std::string& member,
+                                      ptree*& tree) {
+  RETURN_ON_ASSERT(!sealed_, "The copy-on-write view has been sealed");
+  if (member.empty()) {
+    tree = &tree_;
+    return Status::OK();
+  }
+  auto child = tree_.get_child_optional(member);
+  RETURN_ON_ASSERT(child && child->find("typename") != child->not_found(),
+                   "Failed to get member " + member);
+  tree = &child.get();
+  return Status::OK();
+}
+
+Status CopyOnWriteView::rebuild(ptree& tree, const std::string& path,
+                                bool& changed) {
+  changed = dirty_.find(path) != dirty_.end();
+  if (tree.get<std::string>("typename", "") == "vineyard::Blob") {
+    ObjectID blob_id = VYObjectIDFromString(tree.get<std::string>("id"));
+    auto sealed = sealed_copies_.find(blob_id);
+    if (sealed == sealed_copies_.end()) {
+      auto copy = copies_.find(blob_id);
+      if (copy == copies_.end()) {
+        return Status::OK();
+      }
+      auto blob = copy->second->Seal(client_);
+      RETURN_ON_ASSERT(blob != nullptr, "Failed to seal the copied blob");
+      sealed = sealed_copies_.emplace(blob_id, blob).first;
+    }
+    tree = sealed->second->meta().MetaData();
+    changed = true;
+    return Status::OK();
+  }
+  for (auto& kv : tree) {
+    if (kv.second.empty() /* plain value */) {
+      continue;
+    }
+    bool member_changed = false;
+    RETURN_ON_ERROR(rebuild(kv.second,
+                            path.empty() ? kv.first : path + "." + kv.first,
+                            member_changed));
+    changed = changed || member_changed;
+  }
+  if (changed) {
+    // the server generates a new id for the object, and the untouched
+    // members still refer to the existing objects.
+    ObjectMeta meta;
+    meta.SetMetaData(&client_, tree);
+    ObjectID id = InvalidObjectID();
+    RETURN_ON_ERROR(client_.CreateMetaData(meta, id));
+    tree = meta.MetaData();
+  }
+  return Status::OK();
+}
+
+}  // namespace vineyard
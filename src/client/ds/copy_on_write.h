@@ -0,0 +1,140 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_DS_COPY_ON_WRITE_H_
+#define SRC_CLIENT_DS_COPY_ON_WRITE_H_
+
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "client/ds/object_meta.h"
+#include "common/util/ptree.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+class BlobWriter;
+class Client;
+class Object;
+
+/**
+ * @brief CopyOnWriteView is a writable view over an existing object, created
+ * by `Client::ShallowCopy(id, view)`. The blobs and members of the object are
+ * shared with the original object until they are touched: a blob is copied on
+ * the first `Mutable` call, and only the objects that (transitively) contain
+ * the touched blobs or the modified metadata are re-created when sealing, the
+ * untouched members are referred by the new object as they are.
+ *
+ * For example, patching a few rows of a column of a dataframe only copies the
+ * blob of that column, and re-creates the column and the dataframe object.
+ * The original object is never modified.
+ */
+class CopyOnWriteView {
+ public:
+  ~CopyOnWriteView();
+
+  /**
+   * @brief The metadata of the original object.
+   */
+  const ObjectMeta& meta() const { return meta_; }
+
+  /**
+   * @brief Get a writable copy of the blob, the blob is copied on the first
+   * call, and the following calls return the same copy. The blob must be a
+   * local blob of the object.
+   *
+   * @param blob_id The id of the blob in the original object.
+   * @param writer The writable copy, owned by the view.
+   *
+   * @return Status that indicates whether the blob has been copied.
+   */
+  Status Mutable(const ObjectID blob_id, BlobWriter*& writer);
+
+  /**
+   * @brief Whether the blob has been copied by `Mutable`.
+   */
+  bool Touched(const ObjectID blob_id) const;
+
+  /**
+   * @brief Add (or update) a key-value entry of a member object.
+   *
+   * @param member The path of the member object, separated by '.', the empty
+   * path refers to the object itself.
+   * @param key The key of the metadata entry.
+   * @param value The value of the metadata entry.
+   */
+  template <typename T>
+  Status AddKeyValue(const std::string& member, const std::string& key,
+                     T const& value) {
+    ptree* tree = nullptr;
+    RETURN_ON_ERROR(getMemberTree(member, tree));
+    tree->put(key, value);
+    dirty_.emplace(member);
+    return Status::OK();
+  }
+
+  /**
+   * @brief Add (or replace) a member of a member object, e.g., adding an
+   * extra column.
+   *
+   * @param member The path of the member object, separated by '.', the empty
+   * path refers to the object itself.
+   * @param name The name of the (new) member.
+   * @param value The metadata of the member, which must have been created in
+   * vineyard.
+   */
+  Status SetMember(const std::string& member, const std::string& name,
+                   const ObjectMeta& value);
+
+  /**
+   * @brief Seal the copied blobs, and create the modified objects in
+   * vineyard. If nothing has been touched, a plain shallow copy of the
+   * original object is created. The view cannot be modified after sealing.
+   *
+   * @param target_id The id of the new object.
+   *
+   * @return Status that indicates whether the new object has been created.
+   */
+  Status Seal(ObjectID& target_id);
+
+ private:
+  CopyOnWriteView(Client& client, const ObjectMeta& meta);
+
+  Status getMemberTree(const std::string& member, ptree*& tree);
+
+  /**
+   * Re-create the objects in the subtree that have been touched, bottom-up.
+   */
+  Status rebuild(ptree& tree, const std::string& path, bool& changed);
+
+  Client& client_;
+  ObjectMeta meta_;
+  // the working copy of the metadata
+  ptree tree_;
+  // the paths of the members whose metadata are modified
+  std::set<std::string> dirty_;
+  std::unordered_map<ObjectID, std::unique_ptr<BlobWriter>> copies_;
+  std::unordered_map<ObjectID, std::shared_ptr<Object>> sealed_copies_;
+  bool sealed_ = false;
+
+  friend class Client;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_DS_COPY_ON_WRITE_H_
@@ -168,6 +168,7 @@ class Object : public ObjectBase, public std::enable_shared_from_this<Object> {
   friend class Client;
   friend class RPCClient;
   friend class ObjectMeta;
+  friend class ObjectFactory;
 };
 
 class ObjectBuilder : public ObjectBase {
@@ -0,0 +1,123 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_DS_LAZY_H_
+#define SRC_CLIENT_DS_LAZY_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "client/ds/i_object.h"
+#include "client/ds/object_factory.h"
+#include "client/ds/object_meta.h"
+
+namespace vineyard {
+
+/**
+ * @brief Lazy holds the metadata of a member object, and constructs the
+ * member on the first access. Composite objects with many members (e.g.,
+ * the per-label tables of a fragment) can be opened without constructing
+ * the members that are never touched.
+ *
+ * Copies of a Lazy share the constructed object, and the construction is
+ * thread-safe. A Lazy converts to `std::shared_ptr` implicitly, which
+ * materializes the member as well.
+ */
+template <typename T>
+class Lazy {
+ public:
+  using element_type = T;
+
+  Lazy() {}
+
+  explicit Lazy(ObjectMeta const& meta) : state_(std::make_shared<State>()) {
+    state_->meta = meta;
+  }
+
+  Lazy(std::shared_ptr<T> const& object) {  // NOLINT(runtime/explicit)
+    if (object == nullptr) {
+      return;
+    }
+    state_ = std::make_shared<State>();
+    state_->meta = object->meta();
+    std::call_once(state_->flag, [&]() {
+      state_->object = object;
+      state_->materialized = true;
+    });
+  }
+
+  /**
+   * @brief The metadata of the member, which is available without the
+   * member being constructed.
+   */
+  ObjectMeta const& meta() const { return state_->meta; }
+
+  ObjectID id() const { return state_->meta.GetId(); }
+
+  /**
+   * @brief Whether the member has been constructed.
+   */
+  bool materialized() const {
+    return state_ != nullptr && state_->materialized;
+  }
+
+  /**
+   * @brief Get the member, construct it if it hasn't been constructed.
+   */
+  std::shared_ptr<T> const& get() const {
+    static const std::shared_ptr<T> null = nullptr;
+    if (state_ == nullptr) {
+      return null;
+    }
+    std::call_once(state_->flag, [this]() {
+      state_->object =
+          std::dynamic_pointer_cast<T>(ObjectFactory::Create(state_->meta));
+      state_->materialized = true;
+    });
+    return state_->object;
+  }
+
+  T* operator->() const { return get().get(); }
+
+  T& operator*() const { return *get(); }
+
+  template <typename U>
+  operator std::shared_ptr<U>() const {  // NOLINT(runtime/explicit)
+    return get();
+  }
+
+  explicit operator bool() const { return state_ != nullptr; }
+
+ private:
+  struct State {
+    ObjectMeta meta;
+    std::once_flag flag;
+    std::shared_ptr<T> object;
+    std::atomic<bool> materialized{false};
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+template <typename T>
+Lazy<T> ObjectMeta::GetLazyMember(const std::string& name) const {
+  return Lazy<T>(this->GetMemberMeta(name));
+}
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_DS_LAZY_H_
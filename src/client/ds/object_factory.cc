@@ -31,6 +31,15 @@ std::shared_ptr<Object> ObjectFactory::Create(std::string const& type_name) {
   }
 }
 
+std::shared_ptr<Object> ObjectFactory::Create(ObjectMeta const& meta) {
+  auto object = Create(meta.GetTypeName());
+  if (object == nullptr) {
+    object = std::shared_ptr<Object>(new Object());
+  }
+  object->Construct(meta);
+  return object;
+}
+
 const std::unordered_map<std::string, ObjectFactory::object_initializer_t>&
 ObjectFactory::FactoryRef() {
   return getKnownTypes();
@@ -27,6 +27,7 @@ namespace vineyard {
 
 class Client;
 class Object;
+class ObjectMeta;
 
 /**
  * @brief FORCE_INSTANTIATE is a tool to guarantee the argument not be optimized
@@ -68,6 +69,14 @@ class ObjectFactory {
    */
   static std::shared_ptr<Object> Create(std::string const& type_name);
 
+  /**
+   * @brief Initialize an instance of the type of the metadata, and construct
+   * it from the metadata. Unknown types are constructed as plain `Object`.
+   *
+   * @param meta The metadata of the object to be constructed.
+   */
+  static std::shared_ptr<Object> Create(ObjectMeta const& meta);
+
   /**
    * @brief Expose the internal registered types.
    *
@@ -68,7 +68,7 @@ bool const ObjectMeta::IsLocal() const {
 }
 
 bool const ObjectMeta::Haskey(std::string const& key) const {
-  return meta_.find(key) != meta_.not_found();
+  return findChild(key) != nullptr;
 }
 
 void ObjectMeta::AddKeyValue(const std::string& key, const std::string& value) {
@@ -117,23 +117,25 @@ void ObjectMeta::AddMember(const std::string& name, const ObjectID member_id) {
 }
 
 std::shared_ptr<Object> ObjectMeta::GetMember(const std::string& name) const {
-  ObjectMeta meta = this->GetMemberMeta(name);
-  auto object = ObjectFactory::Create(meta.GetTypeName());
-  if (object == nullptr) {
-    object = std::shared_ptr<Object>(new Object());
-  }
-  object->Construct(meta);
-  return object;
+  return ObjectFactory::Create(this->GetMemberMeta(name));
 }
 
 ObjectMeta ObjectMeta::GetMemberMeta(const std::string& name) const {
   ObjectMeta ret;
-  auto const& child_meta = meta_.get_child_optional(name);
-  VINEYARD_ASSERT(child_meta, "Failed to get member " + name);
+  const ptree* child_meta = nullptr;
+  if (name.find('.') == std::string::npos) {
+    child_meta = findChild(name);
+  } else {
+    auto const& child = meta_.get_child_optional(name);
+    if (child) {
+      child_meta = &child.get();
+    }
+  }
+  VINEYARD_ASSERT(child_meta != nullptr, "Failed to get member " + name);
   ret.SetClient(client_);
 
 #if !defined(NDEBUG)  // slow path, but accurate
-  ret.SetMetaData(this->client_, child_meta.get());
+  ret.SetMetaData(this->client_, *child_meta);
   auto const& all_blobs = blob_set_->AllBlobs();
   for (auto const& id : ret.blob_set_->AllBlobIds()) {
     auto iter = all_blobs.find(id);
@@ -142,8 +144,17 @@ ObjectMeta ObjectMeta::GetMemberMeta(const std::string& name) const {
       ret.SetBlob(id, iter->second.BufferUnsafe());
     }
   }
+  // the remote blobs that have been copied to the client
+  auto const& member_blobs = ret.blob_set_->AllBlobs();
+  for (auto const& item : all_blobs) {
+    if (item.second.BufferUnsafe() != nullptr &&
+        !ret.blob_set_->Contains(item.first) &&
+        member_blobs.find(item.first) != member_blobs.end()) {
+      ret.blob_set_->EmplaceBlob(item.first, item.second.BufferUnsafe());
+    }
+  }
 #else  // fast path
-  ret.meta_ = child_meta.get();
+  ret.meta_ = *child_meta;
   ret.blob_set_ = this->blob_set_;
 #endif
   return ret;
@@ -161,11 +172,15 @@ const bool ObjectMeta::incomplete() const { return incomplete_; }
 
 const ptree& ObjectMeta::MetaData() const { return meta_; }
 
-ptree& ObjectMeta::MutMetaData() { return meta_; }
+ptree& ObjectMeta::MutMetaData() {
+  resetIndex();
+  return meta_;
+}
 
 void ObjectMeta::SetMetaData(ClientBase* client, const ptree& meta) {
   this->client_ = client;
   this->meta_ = meta;
+  resetIndex();
   findAllBlobs(meta_, this->client_->instance_id());
 }
 
@@ -181,6 +196,36 @@ void ObjectMeta::SetBlob(const ObjectID& id,
   blob_set_->EmplaceBlob(id, buffer);
 }
 
+const ptree* ObjectMeta::findChild(const std::string& key) const {
+  if (meta_.size() < kIndexThreshold) {
+    auto iter = meta_.find(key);
+    return iter == meta_.not_found() ? nullptr : &iter->second;
+  }
+  // the index is rebuilt when the metadata is copied (the root differs) or
+  // new entries are added (the size differs), as the nodes of `boost::ptree`
+  // are stable when assigning values to existing entries.
+  auto index = std::atomic_load(&index_);
+  if (index == nullptr || index->root != &meta_ ||
+      index->size != meta_.size()) {
+    auto fresh = std::make_shared<MetaIndex>();
+    fresh->root = &meta_;
+    fresh->size = meta_.size();
+    fresh->children.reserve(meta_.size());
+    for (auto const& kv : meta_) {
+      // keeps the first one for duplicated keys, the same as `ptree::find`
+      fresh->children.emplace(kv.first, &kv.second);
+    }
+    index = fresh;
+    std::atomic_store(&index_, index);
+  }
+  auto iter = index->children.find(key);
+  return iter == index->children.end() ? nullptr : iter->second;
+}
+
+void ObjectMeta::resetIndex() {
+  std::atomic_store(&index_, std::shared_ptr<const MetaIndex>(nullptr));
+}
+
 void ObjectMeta::findAllBlobs(const ptree& tree, InstanceID const instance_id) {
   if (tree.empty()) {
     return;
@@ -16,12 +16,17 @@ limitations under the License.
 #ifndef SRC_CLIENT_DS_OBJECT_META_H_
 #define SRC_CLIENT_DS_OBJECT_META_H_
 
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "arrow/buffer.h"
@@ -39,6 +44,173 @@ class RPCClient;
 class Blob;
 class BlobSet;
 class Object;
+template <typename T>
+class Lazy;
+
+namespace detail {
+
+/**
+ * @brief Parse the textual metadata value without going through the
+ * `std::istringstream` based translator of `boost::ptree`. Returns false when
+ * the text cannot be parsed exactly, and the caller should fallback to the
+ * translator of `boost::ptree`, which reports the error as well.
+ *
+ * Character types are excluded as the translator reads them as characters
+ * rather than numbers.
+ */
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value &&
+                                   std::is_signed<T>::value && sizeof(T) != 1,
+                               bool>::type
+parse_meta_value(std::string const& data, T& value) {
+  if (data.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  long long parsed = std::strtoll(data.c_str(), &end, 10);
+  if (errno != 0 || *end != '\0' ||
+      parsed < static_cast<long long>(std::numeric_limits<T>::min()) ||
+      parsed > static_cast<long long>(std::numeric_limits<T>::max())) {
+    return false;
+  }
+  value = static_cast<T>(parsed);
+  return true;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value &&
+                                   std::is_unsigned<T>::value &&
+                                   !std::is_same<T, bool>::value &&
+                                   sizeof(T) != 1,
+                               bool>::type
+parse_meta_value(std::string const& data, T& value) {
+  // `strtoull` accepts (and negates) a leading '-'
+  if (data.empty() || data[0] == '-') {
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  unsigned long long parsed = std::strtoull(data.c_str(), &end, 10);
+  if (errno != 0 || *end != '\0' ||
+      parsed > static_cast<unsigned long long>(std::numeric_limits<T>::max())) {
+    return false;
+  }
+  value = static_cast<T>(parsed);
+  return true;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+parse_meta_value(std::string const& data, T& value) {
+  if (data.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  errno = 0;
+  long double parsed = std::strtold(data.c_str(), &end);
+  if (errno != 0 || *end != '\0') {
+    return false;
+  }
+  value = static_cast<T>(parsed);
+  return true;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_same<T, bool>::value, bool>::type
+parse_meta_value(std::string const& data, T& value) {
+  if (data == "true" || data == "1") {
+    value = true;
+    return true;
+  }
+  if (data == "false" || data == "0") {
+    value = false;
+    return true;
+  }
+  return false;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_same<T, std::string>::value, bool>::type
+parse_meta_value(std::string const& data, T& value) {
+  value = data;
+  return true;
+}
+
+template <typename T>
+inline typename std::enable_if<!std::is_arithmetic<T>::value &&
+                                   !std::is_same<T, std::string>::value,
+                               bool>::type
+parse_meta_value(std::string const&, T&) {
+  return false;
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_arithmetic<T>::value && sizeof(T) == 1 &&
+                                   !std::is_same<T, bool>::value,
+                               bool>::type
+parse_meta_value(std::string const&, T&) {
+  return false;
+}
+
+}  // namespace detail
+
+/**
+ * @brief The keys of an indexed family of members, e.g., "__chunks-0",
+ * "__chunks-1", ..., or "o2g_0_1", which are formatted into a reused buffer
+ * rather than concatenating temporary strings for every member, see also the
+ * code generated for the list and dict members of `.vineyard-mod` types.
+ *
+ * The returned reference is valid until the next call.
+ */
+class IndexedKey {
+ public:
+  explicit IndexedKey(std::string prefix, char const separator = '-')
+      : key_(std::move(prefix)),
+        prefix_size_(key_.size()),
+        separator_(separator) {}
+
+  /** "<prefix><index>" */
+  std::string const& operator()(size_t const index) {
+    key_.resize(prefix_size_);
+    append(index);
+    return key_;
+  }
+
+  /** "<prefix><index><separator><subindex>" */
+  std::string const& operator()(size_t const index, size_t const subindex) {
+    key_.resize(prefix_size_);
+    append(index);
+    key_.push_back(separator_);
+    append(subindex);
+    return key_;
+  }
+
+  /** "<prefix><index><suffix>" */
+  std::string const& operator()(size_t const index, char const* suffix) {
+    key_.resize(prefix_size_);
+    append(index);
+    key_.append(suffix);
+    return key_;
+  }
+
+ private:
+  void append(size_t value) {
+    char digits[20];
+    size_t length = 0;
+    do {
+      digits[length++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    while (length > 0) {
+      key_.push_back(digits[--length]);
+    }
+  }
+
+  std::string key_;
+  size_t const prefix_size_;
+  char const separator_;
+};
 
 /**
  * @brief ObjectMeta is the type for metadata of an Object. The ObjectMeta can
@@ -210,7 +382,9 @@ class ObjectMeta {
    * @param key The key of metadata.
    */
   const std::string GetKeyValue(const std::string& key) const {
-    return meta_.get<std::string>(key);
+    std::string value;
+    getTypedValue(key, value);
+    return value;
   }
 
   /**
@@ -221,7 +395,9 @@ class ObjectMeta {
    */
   template <typename T>
   const T GetKeyValue(const std::string& key) const {
-    return meta_.get<typename std::remove_cv<T>::type>(key);
+    typename std::remove_cv<T>::type value;
+    getTypedValue(key, value);
+    return value;
   }
 
   /**
@@ -234,7 +410,7 @@ class ObjectMeta {
    */
   template <typename T>
   void GetKeyValue(const std::string& key, T& value) const {
-    value = meta_.get<typename std::remove_cv<T>::type>(key);
+    getTypedValue(key, value);
   }
 
   /**
@@ -369,6 +545,15 @@ class ObjectMeta {
    */
   ObjectMeta GetMemberMeta(const std::string& name) const;
 
+  /**
+   * @brief Get the member object that will be constructed on the first
+   * access, see also `Lazy`, which is defined in "client/ds/lazy.h".
+   *
+   * @param name The name of member object.
+   */
+  template <typename T>
+  Lazy<T> GetLazyMember(const std::string& name) const;
+
   void PrintMeta() const;
 
   const bool incomplete() const;
@@ -376,6 +561,11 @@ class ObjectMeta {
   // FIXME: the following three methods should be `protected`
   const ptree& MetaData() const;
 
+  /**
+   * Note that the returned tree shouldn't be kept and modified after accessing
+   * values of this metadata, as the index over the top-level entries is
+   * dropped only inside this method.
+   */
   ptree& MutMetaData();
 
   void SetMetaData(ClientBase* client, const ptree& meta);
@@ -390,6 +580,44 @@ class ObjectMeta {
                const std::shared_ptr<arrow::Buffer>& buffer);
 
  private:
+  // the top-level entries of `meta_`, hashed by key, to avoid walking the
+  // ordered index of `boost::ptree` when looking up attributes of objects
+  // with lots of members (e.g., chunked arrays and fragments).
+  struct MetaIndex {
+    const ptree* root = nullptr;
+    size_t size = 0;
+    std::unordered_map<std::string, const ptree*> children;
+  };
+
+  // metadata of less entries are looked up directly
+  static constexpr size_t kIndexThreshold = 16;
+
+  /**
+   * Find the top-level entry with the given (non-path) key, returns nullptr
+   * if not found.
+   */
+  const ptree* findChild(const std::string& key) const;
+
+  /**
+   * Lookup the value of given key and parse it, keys with '.' are treated as
+   * paths, the same as `boost::ptree::get`.
+   */
+  template <typename T>
+  void getTypedValue(const std::string& key, T& value) const {
+    const ptree* node = nullptr;
+    if (key.find('.') == std::string::npos) {
+      node = findChild(key);
+    }
+    if (node == nullptr) {
+      // raise the same error as before
+      value = meta_.get<T>(key);
+    } else if (!detail::parse_meta_value(node->data(), value)) {
+      value = node->get_value<T>();
+    }
+  }
+
+  void resetIndex();
+
   void findAllBlobs(const ptree& tree, InstanceID const instance_id);
 
   void SetInstanceId(const InstanceID instance_id);
@@ -405,7 +633,12 @@ class ObjectMeta {
   // `AddMember(name, member_id)`.
   bool incomplete_ = false;
 
+  // validated against `meta_` on every use, see also `findChild`.
+  mutable std::shared_ptr<const MetaIndex> index_;
+
+  friend class Blob;
   friend class ClientBase;
+  friend class CopyOnWriteView;
   friend class Client;
   friend class RPCClient;
 };
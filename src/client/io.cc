@@ -14,6 +14,9 @@ limitations under the License.
 */
 
 #include "client/io.h"
+
+#include <netinet/tcp.h>
+
 #include "common/util/logging.h"
 
 namespace vineyard {
@@ -21,6 +24,29 @@ namespace vineyard {
 static const int kNumConnectAttempts = 10;
 static const int64_t kConnectTimeoutMs = 1000;
 
+// a broken RPC connection is detected in about a minute rather than the
+// hours of the system default, see also `RPCClientPool`.
+static const int kKeepAliveIdleSeconds = 30;
+static const int kKeepAliveIntervalSeconds = 10;
+static const int kKeepAliveProbes = 3;
+
+static void enable_keepalive(int socket_fd) {
+  int enabled = 1;
+  setsockopt(socket_fd, SOL_SOCKET, SO_KEEPALIVE, &enabled, sizeof(enabled));
+#if defined(TCP_KEEPIDLE)
+  setsockopt(socket_fd, IPPROTO_TCP, TCP_KEEPIDLE, &kKeepAliveIdleSeconds,
+             sizeof(kKeepAliveIdleSeconds));
+#endif
+#if defined(TCP_KEEPINTVL)
+  setsockopt(socket_fd, IPPROTO_TCP, TCP_KEEPINTVL, &kKeepAliveIntervalSeconds,
+             sizeof(kKeepAliveIntervalSeconds));
+#endif
+#if defined(TCP_KEEPCNT)
+  setsockopt(socket_fd, IPPROTO_TCP, TCP_KEEPCNT, &kKeepAliveProbes,
+             sizeof(kKeepAliveProbes));
+#endif
+}
+
 Status connect_ipc_socket(const std::string& pathname, int& socket_fd) {
   struct sockaddr_un socket_address;
 
@@ -73,6 +99,8 @@ Status connect_rpc_socket(const std::string& host, uint32_t port,
       continue;
     }
     if (connect(socket_fd, addr->ai_addr, addr->ai_addrlen) != 0) {
+      close(socket_fd);
+      socket_fd = -1;
       continue;
     }
     break;
@@ -82,6 +110,7 @@ Status connect_rpc_socket(const std::string& host, uint32_t port,
     return Status::IOError("socket/connect failed for endpoint " + host + ":" +
                            std::to_string(port));
   }
+  enable_keepalive(socket_fd);
 
   return Status::OK();
 }
@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "client/rpc_client.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "client/ds/blob.h"
@@ -25,10 +29,14 @@ limitations under the License.
 #include "client/io.h"
 #include "client/utils.h"
 #include "common/util/boost.h"
+#include "common/util/compression.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
 
+constexpr size_t RPCClient::kRemoteBlobChunkSize;
+constexpr size_t RPCClient::kRemoteBlobWindow;
+
 Status RPCClient::Connect() {
   if (const char* env_p = std::getenv("VINEYARD_RPC_ENDPOINT")) {
     return Connect(std::string(env_p));
@@ -51,7 +59,7 @@ Status RPCClient::Connect(const std::string& rpc_endpoint) {
 }
 
 Status RPCClient::Connect(const std::string& host, uint32_t port) {
-  std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  std::lock_guard<ClientMutex> guard(client_mutex_);
   std::string rpc_endpoint = host + ":" + std::to_string(port);
   RETURN_ON_ASSERT(!connected_ || rpc_endpoint == rpc_endpoint_);
   if (connected_) {
@@ -59,14 +67,24 @@ Status RPCClient::Connect(const std::string& host, uint32_t port) {
   }
   rpc_endpoint_ = rpc_endpoint;
   RETURN_ON_ERROR(connect_rpc_socket_retry(host, port, vineyard_conn_));
+  // the register request is sent in JSON, since the server may not speak
+  // the binary protocol.
+  binary_protocol_ = false;
+  request_tag_ = false;
   std::string message_out;
-  WriteRegisterRequest(message_out);
+  // the blobs are accounted to the tenant, if given
+  const char* tenant = std::getenv("VINEYARD_TENANT");
+  WriteRegisterRequest(false, tenant == nullptr ? "" : tenant, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   ptree message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::string ipc_socket_value, rpc_endpoint_value;
+  // the metadata cache is not used by the RPC client.
+  bool deletion_notification = false;
   RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
-                                    rpc_endpoint_value, instance_id_));
+                                    rpc_endpoint_value, instance_id_,
+                                    binary_protocol_, request_tag_,
+                                    deletion_notification));
   ipc_socket_ = ipc_socket_value;
   connected_ = true;
 
@@ -109,11 +127,8 @@ std::shared_ptr<Object> RPCClient::GetObject(const ObjectID id) {
   ObjectMeta meta;
   VINEYARD_CHECK_OK(this->GetMetaData(id, meta, true));
   VINEYARD_ASSERT(!meta.MetaData().empty());
-  auto object = ObjectFactory::Create(meta.GetTypeName());
-  if (object == nullptr) {
-    object = std::shared_ptr<Object>(new Object());
-  }
-  object->Construct(meta);
+  std::shared_ptr<Object> object;
+  VINEYARD_CHECK_OK(this->constructObject(meta, object));
   return object;
 }
 
@@ -122,12 +137,31 @@ Status RPCClient::GetObject(const ObjectID id,
   ObjectMeta meta;
   RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
   RETURN_ON_ASSERT(!meta.MetaData().empty());
-  object = ObjectFactory::Create(meta.GetTypeName());
-  if (object == nullptr) {
-    object = std::shared_ptr<Object>(new Object());
-  }
-  object->Construct(meta);
-  return Status::OK();
+  return this->constructObject(meta, object);
+}
+
+Status RPCClient::GetObjectAsync(
+    const ObjectID id, callback_t<const std::shared_ptr<Object>&> callback) {
+  return GetDataAsync(
+      id,
+      [this, callback](const Status& status, const ptree& tree) {
+        std::shared_ptr<Object> object = nullptr;
+        if (!status.ok()) {
+          return callback(status, object);
+        }
+        ObjectMeta meta;
+        meta.SetMetaData(this, tree);
+        for (const auto& id : meta.GetBlobSet()->AllBlobIds()) {
+          meta.SetBlob(id, nullptr);
+        }
+        if (meta.MetaData().empty()) {
+          return callback(Status::AssertionFailed("!meta.MetaData().empty()"),
+                          object);
+        }
+        auto s = constructObject(meta, object);
+        return callback(s, object);
+      },
+      true);
 }
 
 std::vector<std::shared_ptr<Object>> RPCClient::GetObjects(
@@ -138,17 +172,87 @@ std::vector<std::shared_ptr<Object>> RPCClient::GetObjects(
     VINEYARD_ASSERT(!meta.MetaData().empty());
   }
   std::vector<std::shared_ptr<Object>> objects;
-  for (auto const& meta : metas) {
-    auto object = ObjectFactory::Create(meta.GetTypeName());
-    if (object == nullptr) {
-      object = std::shared_ptr<Object>(new Object());
-    }
-    object->Construct(meta);
+  for (auto& meta : metas) {
+    std::shared_ptr<Object> object;
+    VINEYARD_CHECK_OK(this->constructObject(meta, object));
     objects.emplace_back(object);
   }
   return objects;
 }
 
+Status RPCClient::GetRemoteBlobs(ObjectMeta& meta) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(binary_protocol_,
+                   "Getting blobs remotely requires the binary protocol");
+  struct RemoteBlob {
+    ObjectID id;
+    std::string payload;
+    bool missing = false;
+  };
+  std::vector<std::shared_ptr<RemoteBlob>> blobs;
+  auto const& blob_set = meta.GetBlobSet();
+  for (auto const& item : blob_set->AllBlobs()) {
+    if (item.second.size() == 0 || item.second.BufferUnsafe() != nullptr) {
+      continue;
+    }
+    auto blob = std::make_shared<RemoteBlob>();
+    blob->id = item.first;
+    blob->payload.resize(item.second.size());
+    blobs.emplace_back(blob);
+  }
+
+  size_t inflight = 0;
+  std::string const compression = compression_;
+  for (auto const& blob : blobs) {
+    for (size_t offset = 0; offset < blob->payload.size();
+         offset += kRemoteBlobChunkSize) {
+      size_t const size =
+          std::min(kRemoteBlobChunkSize, blob->payload.size() - offset);
+      std::string message_out;
+      WriteGetRemoteBlobRequest(blob->id, offset, size, compression,
+                                message_out);
+      RETURN_ON_ERROR(doAsyncRequest(
+          message_out, [blob, offset, size, compression](const Status& status,
+                                                         const ptree& reply) {
+            std::string chunk;
+            auto s = status;
+            if (s.ok()) {
+              s = ReadGetRemoteBlobReply(reply, chunk);
+            }
+            if (s.IsObjectNotExists()) {
+              // the blob resides on other instances
+              blob->missing = true;
+              return Status::OK();
+            }
+            RETURN_ON_ERROR(s);
+            auto data = reinterpret_cast<uint8_t*>(&blob->payload[offset]);
+            if (!compression.empty()) {
+              return Decompress(compression,
+                                reinterpret_cast<const uint8_t*>(chunk.data()),
+                                chunk.size(), data, size);
+            }
+            RETURN_ON_ASSERT(chunk.size() == size,
+                             "Unexpected size of the blob chunk");
+            memcpy(data, chunk.data(), size);
+            return Status::OK();
+          }));
+      if (++inflight == kRemoteBlobWindow) {
+        RETURN_ON_ERROR(WaitAll());
+        inflight = 0;
+      }
+    }
+  }
+  RETURN_ON_ERROR(WaitAll());
+
+  for (auto const& blob : blobs) {
+    if (!blob->missing) {
+      blob_set->EmplaceBlob(
+          blob->id, arrow::Buffer::FromString(std::move(blob->payload)));
+    }
+  }
+  return Status::OK();
+}
+
 std::vector<std::shared_ptr<Object>> RPCClient::ListObjects(
     std::string const& pattern, const bool regex, size_t const limit) {
   std::unordered_map<ObjectID, ptree> meta_trees;
@@ -173,6 +277,135 @@ std::vector<std::shared_ptr<Object>> RPCClient::ListObjects(
   return objects;
 }
 
+Status RPCClient::PushNextStreamChunk(ObjectID const id, const uint8_t* data,
+                                      size_t const size) {
+  ENSURE_CONNECTED(this);
+  // the chunk cannot be carried by a JSON message
+  RETURN_ON_ASSERT(binary_protocol_,
+                   "Streaming remotely requires the binary protocol");
+  std::string message_out;
+  WritePushNextStreamChunkRequest(id, data, size, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPushNextStreamChunkReply(message_in));
+  return Status::OK();
+}
+
+Status RPCClient::PullNextStreamChunk(ObjectID const id, std::string& chunk) {
+  ENSURE_CONNECTED(this);
+  RETURN_ON_ASSERT(binary_protocol_,
+                   "Streaming remotely requires the binary protocol");
+  std::string message_out;
+  WritePullNextStreamChunkRequest(id, true, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, chunk));
+  return Status::OK();
+}
+
+Status RPCClient::constructObject(ObjectMeta& meta,
+                                  std::shared_ptr<Object>& object) {
+  // the objects are still available without blobs, like the JSON protocol
+  if (binary_protocol_) {
+    RETURN_ON_ERROR(GetRemoteBlobs(meta));
+  }
+  object = ObjectFactory::Create(meta.GetTypeName());
+  if (object == nullptr) {
+    object = std::shared_ptr<Object>(new Object());
+  }
+  object->Construct(meta);
+  return Status::OK();
+}
+
 RPCClient::~RPCClient() { Disconnect(); }
 
+RPCClientPool::RPCClientPool(size_t const connections_per_endpoint)
+    : connections_per_endpoint_(std::max<size_t>(connections_per_endpoint, 1)) {
+}
+
+RPCClientPool::~RPCClientPool() { Clear(); }
+
+RPCClientPool& RPCClientPool::Default() {
+  static RPCClientPool pool([]() -> size_t {
+    const char* size = std::getenv("VINEYARD_RPC_POOL_SIZE");
+    return size == nullptr ? 2 : std::strtoull(size, nullptr, 10);
+  }());
+  return pool;
+}
+
+Status RPCClientPool::Get(std::string const& rpc_endpoint,
+                          std::shared_ptr<RPCClient>& client) {
+  std::shared_ptr<RPCClient> stale;
+  size_t slot = 0;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto& endpoint = endpoints_[rpc_endpoint];
+    if (endpoint.clients.size() < connections_per_endpoint_) {
+      endpoint.clients.resize(connections_per_endpoint_);
+    }
+    slot = endpoint.next++ % connections_per_endpoint_;
+    auto& pooled = endpoint.clients[slot];
+    if (pooled != nullptr && pooled->alive()) {
+      client = pooled;
+      return Status::OK();
+    }
+    stale = pooled;
+  }
+  // connect without holding the pool, as connecting retries for a while if
+  // the endpoint is unreachable
+  auto connected = std::make_shared<RPCClient>();
+  RETURN_ON_ERROR(connected->Connect(rpc_endpoint));
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& endpoint = endpoints_[rpc_endpoint];
+  if (slot < endpoint.clients.size()) {
+    auto& pooled = endpoint.clients[slot];
+    if (pooled != stale && pooled != nullptr && pooled->alive()) {
+      // another thread has reconnected it in the meantime
+      client = pooled;
+      return Status::OK();
+    }
+    if (stale != nullptr) {
+      reconnects_ += 1;
+    }
+    pooled = connected;
+  }
+  client = connected;
+  return Status::OK();
+}
+
+void RPCClientPool::SetConnectionsPerEndpoint(
+    size_t const connections_per_endpoint) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  connections_per_endpoint_ = std::max<size_t>(connections_per_endpoint, 1);
+  for (auto& item : endpoints_) {
+    auto& clients = item.second.clients;
+    if (clients.size() > connections_per_endpoint_) {
+      clients.resize(connections_per_endpoint_);
+    }
+  }
+}
+
+size_t RPCClientPool::Size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t size = 0;
+  for (auto const& item : endpoints_) {
+    for (auto const& client : item.second.clients) {
+      size += client != nullptr;
+    }
+  }
+  return size;
+}
+
+size_t RPCClientPool::Reconnects() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return reconnects_;
+}
+
+void RPCClientPool::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  endpoints_.clear();
+}
+
 }  // namespace vineyard
@@ -17,7 +17,9 @@ limitations under the License.
 #define SRC_CLIENT_RPC_CLIENT_H_
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "client/client_base.h"
@@ -58,6 +60,9 @@ class RPCClient : public ClientBase {
    * @param host The host of vineyard server.
    * @param port The TCP port of vineayrd server's RPC service.
    *
+   * Like `Client::Connect`, the blobs are accounted to the tenant given by
+   * `VINEYARD_TENANT`.
+   *
    * @return Status that indicates whether the connect has succeeded.
    */
   Status Connect(const std::string& host, uint32_t port);
@@ -96,8 +101,10 @@ class RPCClient : public ClientBase {
    * @brief Get an object from vineyard. The ObjectFactory will be used to
    * resolve the constructor of the object.
    *
-   * In RPCClient, all blob fields in the result object is unaccessible, access
-   * those fields will trigger an `std::runtime_error`.
+   * The payloads of the blobs that reside on the connected vineyard server
+   * are copied to the client, see also `GetRemoteBlobs`. The blobs on other
+   * instances are unaccessible, access those fields will trigger an
+   * `std::runtime_error`.
    *
    * @param id The object id to get.
    *
@@ -119,6 +126,22 @@ class RPCClient : public ClientBase {
    */
   Status GetObject(const ObjectID id, std::shared_ptr<Object>& object);
 
+  /**
+   * @brief Asynchronous variant of `GetObject`, the metadata request is
+   * pipelined with other asynchronous requests, see also
+   * `ClientBase::WaitAll` and `ClientBase::PollReplies`.
+   *
+   * Note that the payloads of blobs are still copied to the client in the
+   * callback by blocking requests.
+   *
+   * @param id The object id to get.
+   * @param callback The callback to receive the result object.
+   *
+   * @return Status that indicates whether the request has been sent.
+   */
+  Status GetObjectAsync(const ObjectID id,
+                        callback_t<const std::shared_ptr<Object>&> callback);
+
   /**
    * @brief Get multiple objects from vineayrd.
    *
@@ -129,6 +152,29 @@ class RPCClient : public ClientBase {
   std::vector<std::shared_ptr<Object>> GetObjects(
       const std::vector<ObjectID>& ids);
 
+  /**
+   * @brief Copy the payloads of the blobs in the metadata from the connected
+   * vineyard server to the client's memory. The blobs are transferred in
+   * chunks, and many chunks are requested at the same time. The blobs that
+   * do not reside on the connected server are skipped.
+   *
+   * Requires the binary protocol.
+   *
+   * @param meta The metadata, the fetched blobs are associated with it.
+   *
+   * @return Status that indicates whether the blobs have been fetched.
+   */
+  Status GetRemoteBlobs(ObjectMeta& meta);
+
+  /**
+   * @brief Compress the chunks of the blobs that transferred by
+   * `GetRemoteBlobs`, with the codec "lz4", "zstd", "snappy" or "gzip", or
+   * the empty string for no compression (the default).
+   */
+  void SetRemoteBlobCompression(std::string const& codec) {
+    compression_ = codec;
+  }
+
   /**
    * @brief Get an object from vineyard. The type parameter `T` will be used to
    * resolve the constructor of the object.
@@ -189,6 +235,112 @@ class RPCClient : public ClientBase {
   std::vector<std::shared_ptr<Object>> ListObjects(std::string const& pattern,
                                                    const bool regex = false,
                                                    size_t const limit = 5);
+
+  /**
+   * @brief Write a chunk to a stream on the remote vineyard server. The chunk
+   * is copied into the stream store of the server, and is available to the
+   * consumers once this method returns. Like `Client::GetNextStreamChunk`,
+   * the request is blocked when the stream has accumulated too many chunks.
+   *
+   * @param id The id of the stream.
+   * @param data The content of the chunk.
+   * @param size The size of the chunk.
+   *
+   * @return Status that indicates whether the push has succeeded.
+   */
+  Status PushNextStreamChunk(ObjectID const id, const uint8_t* data,
+                             size_t const size);
+
+  /**
+   * @brief Pull a chunk from a stream on the remote vineyard server, the
+   * content of the chunk is copied into `chunk`. The semantic is the same
+   * as `Client::PullNextStreamChunk`.
+   *
+   * @param id The id of the stream.
+   * @param chunk The content of the chunk generated by the writer.
+   *
+   * @return Status that indicates whether the polling has succeeded.
+   */
+  Status PullNextStreamChunk(ObjectID const id, std::string& chunk);
+
+ private:
+  /**
+   * Construct the object from the metadata, after fetching its blobs.
+   */
+  Status constructObject(ObjectMeta& meta, std::shared_ptr<Object>& object);
+
+  /**
+   * Whether the connection hasn't been found broken, without probing the
+   * socket, which may have replies to other threads pending.
+   */
+  bool alive() const { return connected_; }
+
+  static constexpr size_t kRemoteBlobChunkSize = 4 * 1024 * 1024;
+  // the max number of chunks that are requested at the same time
+  static constexpr size_t kRemoteBlobWindow = 8;
+
+  std::string compression_;
+
+  friend class RPCClientPool;
+};
+
+/**
+ * @brief RPCClientPool shares a few persistent connections to each endpoint
+ * among the threads of this process, rather than connecting an RPC client
+ * per task. Requests of the threads that share a client are multiplexed over
+ * its connection by the request tags, thus a handful connections per
+ * endpoint are enough for many concurrent callers.
+ *
+ * A pooled client whose connection has been lost is replaced on the next
+ * `Get`, i.e., the in-flight requests fail with a connection error and the
+ * callers can retry with a client from the pool. The pooled clients must not
+ * be disconnected by the callers.
+ */
+class RPCClientPool {
+ public:
+  explicit RPCClientPool(size_t const connections_per_endpoint = 2);
+
+  ~RPCClientPool();
+
+  /**
+   * @brief The pool of this process, the number of connections per endpoint
+   * is given by the environment variable `VINEYARD_RPC_POOL_SIZE`.
+   */
+  static RPCClientPool& Default();
+
+  /**
+   * @brief Get a connected client to the endpoint (in the form of
+   * "<host>:<port>"), the connections of the endpoint are handed out in
+   * turns.
+   */
+  Status Get(std::string const& rpc_endpoint,
+             std::shared_ptr<RPCClient>& client);
+
+  /**
+   * @brief How many connections are kept for each endpoint, the extra
+   * connections are dropped once their users have released them.
+   */
+  void SetConnectionsPerEndpoint(size_t const connections_per_endpoint);
+
+  /** How many connections are kept by the pool. */
+  size_t Size() const;
+
+  /** How many connections have been made to replace the lost ones. */
+  size_t Reconnects() const;
+
+  /** Drop the connections, which are closed once their users finish. */
+  void Clear();
+
+ private:
+  struct Endpoint {
+    std::vector<std::shared_ptr<RPCClient>> clients;
+    size_t next = 0;
+  };
+
+  mutable std::mutex mutex_;
+  size_t connections_per_endpoint_;
+  size_t reconnects_ = 0;
+  std::unordered_map<std::string, Endpoint> endpoints_;
 };
 
 }  // namespace vineyard
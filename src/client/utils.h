@@ -27,7 +27,7 @@ namespace vineyard {
   if (!this->connected_) {                                     \
     return Status::ConnectionError("Client is not connected"); \
   }                                                            \
-  std::lock_guard<std::recursive_mutex> __guard(this->client_mutex_)
+  std::lock_guard<ClientMutex> __guard(this->client_mutex_)
 #endif  // ENSURE_CONNECTED
 
 }  // namespace vineyard
@@ -0,0 +1,110 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/memory/cuda_ipc.h"
+
+#if defined(WITH_CUDA)
+#include <cuda_runtime_api.h>
+#endif
+
+#include <cstring>
+#include <string>
+
+namespace vineyard {
+
+#if defined(WITH_CUDA)
+
+static_assert(sizeof(cudaIpcMemHandle_t) == kCudaIpcHandleSize,
+              "Unexpected size of cudaIpcMemHandle_t");
+
+#ifndef RETURN_ON_CUDA_ERROR
+#define RETURN_ON_CUDA_ERROR(expr)                                      \
+  do {                                                                  \
+    auto _ret = (expr);                                                 \
+    if (_ret != cudaSuccess) {                                          \
+      return Status::IOError("CUDA error at " + std::string(__FILE__) + \
+                             ":" + std::to_string(__LINE__) + ": " +    \
+                             std::string(cudaGetErrorString(_ret)));    \
+    }                                                                   \
+  } while (0)
+#endif  // RETURN_ON_CUDA_ERROR
+
+bool CudaEnabled() { return true; }
+
+Status CudaAllocate(int const device_id, size_t const size, void** pointer,
+                    std::string& handle) {
+  RETURN_ON_CUDA_ERROR(cudaSetDevice(device_id));
+  RETURN_ON_CUDA_ERROR(cudaMalloc(pointer, size));
+  cudaIpcMemHandle_t ipc_handle;
+  auto status = cudaIpcGetMemHandle(&ipc_handle, *pointer);
+  if (status != cudaSuccess) {
+    cudaFree(*pointer);
+    *pointer = nullptr;
+    RETURN_ON_CUDA_ERROR(status);
+  }
+  handle.assign(reinterpret_cast<const char*>(&ipc_handle),
+                sizeof(cudaIpcMemHandle_t));
+  return Status::OK();
+}
+
+Status CudaFree(int const device_id, void* pointer) {
+  RETURN_ON_CUDA_ERROR(cudaSetDevice(device_id));
+  RETURN_ON_CUDA_ERROR(cudaFree(pointer));
+  return Status::OK();
+}
+
+Status CudaOpenIpcHandle(int const device_id, std::string const& handle,
+                         void** pointer) {
+  if (handle.size() != sizeof(cudaIpcMemHandle_t)) {
+    return Status::Invalid("Invalid CUDA IPC handle of size " +
+                           std::to_string(handle.size()));
+  }
+  cudaIpcMemHandle_t ipc_handle;
+  memcpy(&ipc_handle, handle.data(), sizeof(cudaIpcMemHandle_t));
+  RETURN_ON_CUDA_ERROR(cudaSetDevice(device_id));
+  RETURN_ON_CUDA_ERROR(cudaIpcOpenMemHandle(pointer, ipc_handle,
+                                            cudaIpcMemLazyEnablePeerAccess));
+  return Status::OK();
+}
+
+Status CudaCloseIpcHandle(int const device_id, void* pointer) {
+  RETURN_ON_CUDA_ERROR(cudaSetDevice(device_id));
+  RETURN_ON_CUDA_ERROR(cudaIpcCloseMemHandle(pointer));
+  return Status::OK();
+}
+
+#else
+
+bool CudaEnabled() { return false; }
+
+Status CudaAllocate(int const, size_t const, void**, std::string&) {
+  return Status::NotImplemented("Vineyard is built without CUDA support");
+}
+
+Status CudaFree(int const, void*) {
+  return Status::NotImplemented("Vineyard is built without CUDA support");
+}
+
+Status CudaOpenIpcHandle(int const, std::string const&, void**) {
+  return Status::NotImplemented("Vineyard is built without CUDA support");
+}
+
+Status CudaCloseIpcHandle(int const, void*) {
+  return Status::NotImplemented("Vineyard is built without CUDA support");
+}
+
+#endif  // WITH_CUDA
+
+}  // namespace vineyard
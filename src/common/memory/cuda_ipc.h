@@ -0,0 +1,56 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_MEMORY_CUDA_IPC_H_
+#define SRC_COMMON_MEMORY_CUDA_IPC_H_
+
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * The size of `cudaIpcMemHandle_t`, the handles are carried in the payloads
+ * as opaque bytes, thus the protocol does not depend on CUDA.
+ */
+constexpr size_t kCudaIpcHandleSize = 64;
+
+/**
+ * Whether vineyard is built with CUDA, i.e., with `-DBUILD_VINEYARD_CUDA=ON`.
+ */
+bool CudaEnabled();
+
+/**
+ * Allocate device memory on the given device, and export the IPC handle of
+ * the allocation.
+ */
+Status CudaAllocate(int const device_id, size_t const size, void** pointer,
+                    std::string& handle);
+
+Status CudaFree(int const device_id, void* pointer);
+
+/**
+ * Open the IPC handle that exported by another process, the memory must be
+ * closed by `CudaCloseIpcHandle` (rather than `CudaFree`).
+ */
+Status CudaOpenIpcHandle(int const device_id, std::string const& handle,
+                         void** pointer);
+
+Status CudaCloseIpcHandle(int const device_id, void* pointer);
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_CUDA_IPC_H_
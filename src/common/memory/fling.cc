@@ -29,6 +29,10 @@
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
 
 #include "common/util/logging.h"
 
@@ -148,3 +152,93 @@ int recv_fd(int conn) {
 
   return found_fd;
 }
+
+int send_fds(int conn, const std::vector<int>& fds) {
+  for (size_t begin = 0; begin < fds.size(); begin += kMaxFdsPerMessage) {
+    size_t count = std::min(kMaxFdsPerMessage, fds.size() - begin);
+    struct msghdr msg;
+    struct iovec iov;
+    char buf[CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage)];
+    memset(&buf, 0, sizeof(buf));
+
+    init_msg(&msg, &iov, buf, CMSG_SPACE(sizeof(int) * count));
+
+    struct cmsghdr* header = CMSG_FIRSTHDR(&msg);
+    if (header == nullptr) {
+      LOG(ERROR) << "Error in init_msg: header is NULL";
+      return -1;
+    }
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    memcpy(CMSG_DATA(header), fds.data() + begin, sizeof(int) * count);
+
+    while (true) {
+      ssize_t r = sendmsg(conn, &msg, 0);
+      if (r < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          continue;
+        }
+        LOG(ERROR) << "Error in send_fds (errno = " << errno << ": "
+                   << strerror(errno) << ")";
+        return static_cast<int>(r);
+      } else if (r == 0) {
+        LOG(ERROR) << "Encountered unexpected EOF";
+        return 0;
+      }
+      break;
+    }
+  }
+  return static_cast<int>(fds.size());
+}
+
+int recv_fds(int conn, size_t count, std::vector<int>& fds) {
+  while (fds.size() < count) {
+    struct msghdr msg;
+    struct iovec iov;
+    char buf[CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage)];
+    init_msg(&msg, &iov, buf, sizeof(buf));
+
+    while (true) {
+      ssize_t r = recvmsg(conn, &msg, 0);
+      if (r == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          continue;
+        }
+        LOG(ERROR) << "Error in recv_fds (errno = " << errno << ")";
+        return -1;
+      }
+      break;
+    }
+
+    size_t received = fds.size();
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&msg); header != NULL;
+         header = CMSG_NXTHDR(&msg, header)) {
+      if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+        size_t n =
+            (header->cmsg_len -
+             (CMSG_DATA(header) - reinterpret_cast<unsigned char*>(header))) /
+            sizeof(int);
+        for (size_t i = 0; i < n; ++i) {
+          fds.push_back((reinterpret_cast<int*>(CMSG_DATA(header)))[i]);
+        }
+      }
+    }
+    if (fds.size() == received) {
+      LOG(ERROR) << "Error in recv_fds: no fd received in message";
+      return -1;
+    }
+  }
+  if (fds.size() > count) {
+    // The sender sent us more file descriptors than expected, close them to
+    // prevent fd leaks.
+    for (size_t i = count; i < fds.size(); ++i) {
+      close(fds[i]);
+    }
+    fds.resize(count);
+    errno = EBADMSG;
+    LOG(ERROR) << "Error in recv_fds: more fds than expected received";
+    return -1;
+  }
+  return static_cast<int>(fds.size());
+}
@@ -39,6 +39,8 @@
 #include <sys/socket.h>
 #include <sys/uio.h>
 
+#include <vector>
+
 // This is necessary for Mac OS X, see http://www.apuebook.com/faqs2e.html
 // (10).
 #if !defined(CMSG_SPACE) && !defined(CMSG_LEN)
@@ -62,4 +64,22 @@ int send_fd(int conn, int fd);
 // @return File descriptor or a value < 0 on failure.
 int recv_fd(int conn);
 
+// Send a batch of file descriptors over a unix domain socket, using as few
+// messages as possible (at most kMaxFdsPerMessage fds per message).
+//
+// @param conn Unix domain socket to send the file descriptors over.
+// @param fds File descriptors to send over.
+// @return Status code which is < 0 on failure.
+int send_fds(int conn, const std::vector<int>& fds);
+
+// Receive a batch of file descriptors that were sent by send_fds.
+//
+// @param conn Unix domain socket to receive the file descriptors from.
+// @param count The number of file descriptors to receive.
+// @param fds The received file descriptors, in the order they were sent.
+// @return Status code which is < 0 on failure.
+int recv_fds(int conn, size_t count, std::vector<int>& fds);
+
+constexpr size_t kMaxFdsPerMessage = 64;
+
 #endif  // SRC_COMMON_MEMORY_FLING_H_
@@ -15,14 +15,50 @@ limitations under the License.
 
 #include "common/memory/payload.h"
 
+#include <string>
+
 namespace vineyard {
 
+namespace {
+
+std::string toHex(std::string const& bytes) {
+  static const char digits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(bytes.size() * 2);
+  for (unsigned char c : bytes) {
+    hex.push_back(digits[c >> 4]);
+    hex.push_back(digits[c & 0x0f]);
+  }
+  return hex;
+}
+
+std::string fromHex(std::string const& hex) {
+  auto value = [](char c) -> int {
+    return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+  };
+  std::string bytes;
+  bytes.reserve(hex.size() / 2);
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    bytes.push_back(
+        static_cast<char>((value(hex[i]) << 4) | value(hex[i + 1])));
+  }
+  return bytes;
+}
+
+}  // namespace
+
 void Payload::ToJSON(ptree& tree) const {
   tree.put("object_id", object_id);
   tree.put("store_fd", store_fd);
   tree.put("data_offset", data_offset);
   tree.put("data_size", data_size);
   tree.put("map_size", map_size);
+  tree.put("numa_node", numa_node);
+  if (IsDevice()) {
+    // the handle is carried in hex, as the JSON protocol requires text
+    tree.put("device_id", device_id);
+    tree.put("ipc_handle", toHex(ipc_handle));
+  }
 }
 
 void Payload::FromJSON(const ptree& tree) {
@@ -31,7 +67,26 @@ void Payload::FromJSON(const ptree& tree) {
   data_offset = tree.get<ptrdiff_t>("data_offset");
   data_size = tree.get<int64_t>("data_size");
   map_size = tree.get<int64_t>("map_size");
+  numa_node = tree.get<int>("numa_node", -1);
+  device_id = tree.get<int>("device_id", -1);
+  ipc_handle = fromHex(tree.get<std::string>("ipc_handle", ""));
   pointer = nullptr;
 }
 
+void BlobAccess::ToJSON(ptree& tree) const {
+  tree.put("object_id", object_id);
+  tree.put("data_size", data_size);
+  tree.put("access_count", access_count);
+  tree.put("last_access", last_access);
+  tree.put("pin_count", pin_count);
+}
+
+void BlobAccess::FromJSON(const ptree& tree) {
+  object_id = tree.get<ObjectID>("object_id");
+  data_size = tree.get<int64_t>("data_size");
+  access_count = tree.get<uint64_t>("access_count");
+  last_access = tree.get<int64_t>("last_access");
+  pin_count = tree.get<uint64_t>("pin_count", 0);
+}
+
 }  // namespace vineyard
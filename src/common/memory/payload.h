@@ -16,11 +16,20 @@ limitations under the License.
 #ifndef SRC_COMMON_MEMORY_PAYLOAD_H_
 #define SRC_COMMON_MEMORY_PAYLOAD_H_
 
+#include <cstddef>
+#include <string>
+
 #include "common/util/boost.h"
 #include "common/util/uuid.h"
 
 namespace vineyard {
 
+/// The largest alignment that can be requested for blobs. The segments of
+/// the shared memory are mapped at multiples of it, in vineyardd as well as
+/// in clients, thus a blob whose offset is aligned is aligned in every
+/// process that maps it.
+constexpr size_t kMaxBlobAlignment = 2 * 1024 * 1024;
+
 struct Payload {
   ObjectID object_id;
   int store_fd;
@@ -28,6 +37,26 @@ struct Payload {
   int64_t data_size;
   int64_t map_size;
   uint8_t* pointer;
+  // number of alive connections that have the blob mapped, a blob is
+  // pinned (and can't be spilled) as long as it is cited by some client.
+  int64_t ref_cnt = 0;
+  // whether the payload has been spilled to disk by the bulk store.
+  bool is_spilled = false;
+  // the NUMA node where the blob lives, -1 means the default arena.
+  int numa_node = -1;
+  // the alignment that the blob is created with, 0 means the default one,
+  // which is kept when the bulk store moves the memory of the blob, e.g.,
+  // reloading, decompressing or deduplicating it.
+  size_t alignment = 0;
+  // the CUDA device where the blob lives, -1 means the shared memory. The
+  // device blobs are shared by the CUDA IPC handle, rather than the store_fd.
+  int device_id = -1;
+  std::string ipc_handle;
+  // how many times the blob has been got, and when it has been got the last
+  // time (or created), in milliseconds since the epoch, which are maintained
+  // by the bulk store, see also `BlobAccess`.
+  uint64_t access_count = 0;
+  int64_t last_access = 0;
 
   Payload() {}
 
@@ -40,6 +69,8 @@ struct Payload {
         map_size(msize),
         pointer(ptr) {}
 
+  bool IsDevice() const { return device_id >= 0; }
+
   bool operator==(const Payload& other) const {
     return ((object_id == other.object_id) && (store_fd == other.store_fd) &&
             (data_offset == other.data_offset) &&
@@ -51,6 +82,25 @@ struct Payload {
   void FromJSON(const ptree& tree);
 };
 
+/**
+ * @brief The access statistics of a blob, for the decisions of tiering, e.g.,
+ * by the external schedulers.
+ */
+struct BlobAccess {
+  ObjectID object_id;
+  int64_t data_size;
+  uint64_t access_count;
+  // in milliseconds since the epoch
+  int64_t last_access;
+  // the number of clients that have the blob mapped, pinned blobs can't be
+  // spilled or freed
+  uint64_t pin_count;
+
+  void ToJSON(ptree& tree) const;
+
+  void FromJSON(const ptree& tree);
+};
+
 }  // namespace vineyard
 
 #endif  // SRC_COMMON_MEMORY_PAYLOAD_H_
@@ -0,0 +1,304 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/memory/shm_ring.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#include "common/util/logging.h"
+
+#if defined(__linux__) && !defined(MFD_CLOEXEC)
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+namespace vineyard {
+
+constexpr uint64_t ShmRing::kRedirected;
+constexpr size_t ShmRingChannel::kDefaultCapacity;
+
+namespace {
+
+// Spin before sleeping on the eventfd, to avoid the syscalls when the peer
+// replies fast.
+constexpr auto kSpinDuration = std::chrono::microseconds(50);
+
+// the length header, followed by the message padded to 8 bytes.
+inline uint64_t record_size(size_t const size) {
+  constexpr uint64_t alignment = sizeof(uint64_t);
+  return alignment + ((size + alignment - 1) & ~(alignment - 1));
+}
+
+}  // namespace
+
+void ShmRing::Initialize(void* base, size_t const capacity) {
+  Header* header = new (base) Header();
+  header->head.store(0);
+  header->tail.store(0);
+  header->consumer_waiting.store(0);
+  header->capacity = capacity;
+}
+
+ShmRing::ShmRing(void* base, int event_fd)
+    : header_(reinterpret_cast<Header*>(base)),
+      data_(reinterpret_cast<char*>(base) + sizeof(Header)),
+      event_fd_(event_fd) {}
+
+bool ShmRing::TryPush(const char* data, size_t const size) {
+  uint64_t head = header_->head.load(std::memory_order_acquire);
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  uint64_t required = record_size(size);
+  if (header_->capacity - (tail - head) < required) {
+    return false;
+  }
+  uint64_t length = size;
+  copyIn(tail, &length, sizeof(uint64_t));
+  copyIn(tail + sizeof(uint64_t), data, size);
+  header_->tail.store(tail + required, std::memory_order_release);
+  return true;
+}
+
+bool ShmRing::TryPushRedirected() {
+  uint64_t head = header_->head.load(std::memory_order_acquire);
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  if (header_->capacity - (tail - head) < sizeof(uint64_t)) {
+    return false;
+  }
+  uint64_t length = kRedirected;
+  copyIn(tail, &length, sizeof(uint64_t));
+  header_->tail.store(tail + sizeof(uint64_t), std::memory_order_release);
+  return true;
+}
+
+bool ShmRing::TryPop(std::string& message, bool& redirected) {
+  uint64_t tail = header_->tail.load(std::memory_order_acquire);
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  if (head == tail) {
+    return false;
+  }
+  uint64_t length = 0;
+  copyOut(head, &length, sizeof(uint64_t));
+  if (length == kRedirected) {
+    redirected = true;
+    message.clear();
+    header_->head.store(head + sizeof(uint64_t), std::memory_order_release);
+    return true;
+  }
+  if (length > tail - head - sizeof(uint64_t)) {
+    // DON'T crash when the peer is malicious, drop everything instead.
+    LOG(ERROR) << "Corrupted message in the shared memory ring";
+    header_->head.store(tail, std::memory_order_release);
+    return false;
+  }
+  redirected = false;
+  message.resize(length);
+  copyOut(head + sizeof(uint64_t), &message[0], length);
+  header_->head.store(head + record_size(length), std::memory_order_release);
+  return true;
+}
+
+bool ShmRing::Empty() const {
+  return header_->head.load(std::memory_order_acquire) ==
+         header_->tail.load(std::memory_order_acquire);
+}
+
+void ShmRing::Notify() {
+  // pairs with the fence in PrepareWait: either the consumer sees the new
+  // message, or we see it is waiting.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (header_->consumer_waiting.load(std::memory_order_relaxed)) {
+    uint64_t value = 1;
+    while (write(event_fd_, &value, sizeof(uint64_t)) < 0 && errno == EINTR) {
+    }
+  }
+}
+
+Status ShmRing::Pop(std::string& message, bool& redirected, int peer_fd) {
+  auto deadline = std::chrono::steady_clock::now() + kSpinDuration;
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (TryPop(message, redirected)) {
+      return Status::OK();
+    }
+  }
+  while (true) {
+    PrepareWait();
+    if (TryPop(message, redirected)) {
+      CancelWait();
+      return Status::OK();
+    }
+    struct pollfd fds[2];
+    fds[0].fd = event_fd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = peer_fd;
+#if defined(POLLRDHUP)
+    fds[1].events = POLLRDHUP;
+#else
+    fds[1].events = 0;
+#endif
+    int r = poll(fds, peer_fd >= 0 ? 2 : 1, -1);
+    CancelWait();
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return Status::IOError("Failed to wait on the ring: " +
+                             std::string(strerror(errno)));
+    }
+    if (fds[0].revents & POLLIN) {
+      uint64_t value = 0;
+      // reset the counter of the eventfd
+      if (read(event_fd_, &value, sizeof(uint64_t)) < 0) {
+        value = 0;
+      }
+    }
+    if (TryPop(message, redirected)) {
+      return Status::OK();
+    }
+    if (peer_fd >= 0 && (fds[1].revents & ~POLLIN)) {
+      return Status::ConnectionError("The peer of the ring has gone");
+    }
+  }
+}
+
+void ShmRing::PrepareWait() {
+  header_->consumer_waiting.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void ShmRing::CancelWait() {
+  header_->consumer_waiting.store(0, std::memory_order_relaxed);
+}
+
+void ShmRing::copyIn(uint64_t position, const void* data, size_t size) {
+  size_t offset = position & (header_->capacity - 1);
+  size_t first = std::min(size, header_->capacity - offset);
+  memcpy(data_ + offset, data, first);
+  memcpy(data_, reinterpret_cast<const char*>(data) + first, size - first);
+}
+
+void ShmRing::copyOut(uint64_t position, void* data, size_t size) const {
+  size_t offset = position & (header_->capacity - 1);
+  size_t first = std::min(size, header_->capacity - offset);
+  memcpy(data, data_ + offset, first);
+  memcpy(reinterpret_cast<char*>(data) + first, data_, size - first);
+}
+
+ShmRingChannel::~ShmRingChannel() {
+  requests_.reset();
+  replies_.reset();
+  if (pointer_ != nullptr) {
+    munmap(pointer_, mapped_size_);
+  }
+  CloseMemoryFd();
+  if (request_event_fd_ >= 0) {
+    close(request_event_fd_);
+  }
+  if (reply_event_fd_ >= 0) {
+    close(reply_event_fd_);
+  }
+}
+
+Status ShmRingChannel::Create(size_t const capacity,
+                              std::unique_ptr<ShmRingChannel>& channel) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+  if (capacity < 4096 || (capacity & (capacity - 1)) != 0) {
+    return Status::Invalid("The capacity of the ring must be a power of 2");
+  }
+  std::unique_ptr<ShmRingChannel> created(new ShmRingChannel());
+  created->capacity_ = capacity;
+  created->memory_fd_ = static_cast<int>(
+      syscall(SYS_memfd_create, "vineyard-ring", MFD_CLOEXEC));
+  if (created->memory_fd_ < 0) {
+    return Status::IOError("Failed to create the shared memory of ring: " +
+                           std::string(strerror(errno)));
+  }
+  if (ftruncate(created->memory_fd_, 2 * ShmRing::RegionSize(capacity)) != 0) {
+    return Status::IOError("Failed to resize the shared memory of ring: " +
+                           std::string(strerror(errno)));
+  }
+  // the server waits on the requests asynchronously, while the client blocks
+  // on the replies.
+  created->request_event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  created->reply_event_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (created->request_event_fd_ < 0 || created->reply_event_fd_ < 0) {
+    return Status::IOError("Failed to create the eventfd of ring: " +
+                           std::string(strerror(errno)));
+  }
+  RETURN_ON_ERROR(created->mapRings(true));
+  channel = std::move(created);
+  return Status::OK();
+#else
+  return Status::NotImplemented(
+      "Shared memory ring channel is only supported on Linux");
+#endif
+}
+
+Status ShmRingChannel::Attach(int memory_fd, int request_event_fd,
+                              int reply_event_fd, size_t const capacity,
+                              std::unique_ptr<ShmRingChannel>& channel) {
+  std::unique_ptr<ShmRingChannel> attached(new ShmRingChannel());
+  attached->capacity_ = capacity;
+  attached->memory_fd_ = memory_fd;
+  attached->request_event_fd_ = request_event_fd;
+  attached->reply_event_fd_ = reply_event_fd;
+  RETURN_ON_ERROR(attached->mapRings(false));
+  attached->CloseMemoryFd();
+  channel = std::move(attached);
+  return Status::OK();
+}
+
+void ShmRingChannel::CloseMemoryFd() {
+  if (memory_fd_ >= 0) {
+    close(memory_fd_);
+    memory_fd_ = -1;
+  }
+}
+
+Status ShmRingChannel::mapRings(bool const initialize) {
+  size_t region_size = ShmRing::RegionSize(capacity_);
+  mapped_size_ = 2 * region_size;
+  pointer_ = mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  memory_fd_, 0);
+  if (pointer_ == MAP_FAILED) {
+    pointer_ = nullptr;
+    return Status::IOError("Failed to map the shared memory of ring: " +
+                           std::string(strerror(errno)));
+  }
+  char* base = reinterpret_cast<char*>(pointer_);
+  if (initialize) {
+    ShmRing::Initialize(base, capacity_);
+    ShmRing::Initialize(base + region_size, capacity_);
+  }
+  auto header = reinterpret_cast<ShmRing::Header*>(base);
+  if (header->capacity != capacity_) {
+    return Status::Invalid("Mismatched capacity of the shared memory ring");
+  }
+  requests_.reset(new ShmRing(base, request_event_fd_));
+  replies_.reset(new ShmRing(base + region_size, reply_event_fd_));
+  return Status::OK();
+}
+
+}  // namespace vineyard
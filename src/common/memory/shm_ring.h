@@ -0,0 +1,165 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_MEMORY_SHM_RING_H_
+#define SRC_COMMON_MEMORY_SHM_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief ShmRing is a lock-free single-producer single-consumer queue of
+ * length-prefixed messages that lives in shared memory.
+ *
+ * The consumer raises a flag before going to sleep on the eventfd, and the
+ * producer only signals the eventfd when the flag is set, thus no syscall is
+ * needed as long as the consumer keeps polling.
+ */
+class ShmRing {
+ public:
+  /**
+   * @brief The record that tells the consumer the message has been sent over
+   * the socket, as it doesn't fit into the ring.
+   */
+  static constexpr uint64_t kRedirected = UINT64_MAX;
+
+  struct Header {
+    alignas(64) std::atomic<uint64_t> head;  // advanced by the consumer
+    alignas(64) std::atomic<uint64_t> tail;  // advanced by the producer
+    alignas(64) std::atomic<uint32_t> consumer_waiting;
+    uint64_t capacity;
+  };
+
+  static size_t RegionSize(size_t const capacity) {
+    return sizeof(Header) + capacity;
+  }
+
+  /**
+   * @brief Initialize an empty ring in the given memory, the capacity must be
+   * a power of 2.
+   */
+  static void Initialize(void* base, size_t const capacity);
+
+  ShmRing(void* base, int event_fd);
+
+  /**
+   * @brief Append a message, returns false if there's no enough space.
+   */
+  bool TryPush(const char* data, size_t const size);
+
+  /**
+   * @brief Append a record that marks the next message is redirected to the
+   * socket, returns false if there's no enough space.
+   */
+  bool TryPushRedirected();
+
+  /**
+   * @brief Pop a message if there is, redirected will be set to true when the
+   * message should be received from the socket.
+   */
+  bool TryPop(std::string& message, bool& redirected);
+
+  bool Empty() const;
+
+  /**
+   * @brief Wake up the consumer if it is waiting on the eventfd.
+   */
+  void Notify();
+
+  /**
+   * @brief Pop a message, spin for a while before sleeping on the eventfd.
+   * Fails if peer_fd (the socket to the peer) has been hung up during
+   * waiting.
+   */
+  Status Pop(std::string& message, bool& redirected, int peer_fd = -1);
+
+  /**
+   * @brief Mark the consumer as going to sleep, the caller must check the
+   * ring again before waiting on the eventfd to avoid missing wakeups.
+   */
+  void PrepareWait();
+
+  void CancelWait();
+
+  size_t Capacity() const { return header_->capacity; }
+
+ private:
+  void copyIn(uint64_t position, const void* data, size_t size);
+  void copyOut(uint64_t position, void* data, size_t size) const;
+
+  Header* header_;
+  char* data_;
+  int event_fd_;
+};
+
+/**
+ * @brief ShmRingChannel holds the request ring (client to server) and the
+ * reply ring (server to client) of a connection, and the eventfds that wake
+ * up the consumers of them.
+ *
+ * The shared memory and eventfds are created by the server, sent to the
+ * client over the socket, and then attached by the client.
+ */
+class ShmRingChannel {
+ public:
+  static constexpr size_t kDefaultCapacity = 1024 * 1024;
+
+  ~ShmRingChannel();
+
+  static Status Create(size_t const capacity,
+                       std::unique_ptr<ShmRingChannel>& channel);
+
+  static Status Attach(int memory_fd, int request_event_fd,
+                       int reply_event_fd, size_t const capacity,
+                       std::unique_ptr<ShmRingChannel>& channel);
+
+  ShmRing& Requests() { return *requests_; }
+  ShmRing& Replies() { return *replies_; }
+
+  int MemoryFd() const { return memory_fd_; }
+  int RequestEventFd() const { return request_event_fd_; }
+  int ReplyEventFd() const { return reply_event_fd_; }
+  size_t Capacity() const { return capacity_; }
+
+  /**
+   * @brief Close the shared memory fd once it has been sent or mapped, the
+   * mapping is still valid.
+   */
+  void CloseMemoryFd();
+
+ private:
+  ShmRingChannel() = default;
+
+  Status mapRings(bool const initialize);
+
+  size_t capacity_ = 0;
+  int memory_fd_ = -1;
+  int request_event_fd_ = -1;
+  int reply_event_fd_ = -1;
+  void* pointer_ = nullptr;
+  size_t mapped_size_ = 0;
+  std::unique_ptr<ShmRing> requests_, replies_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_SHM_RING_H_
@@ -16,11 +16,21 @@ limitations under the License.
 #ifndef SRC_COMMON_UTIL_BLOCKING_QUEUE_H_
 #define SRC_COMMON_UTIL_BLOCKING_QUEUE_H_
 
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include <atomic>
+#include <climits>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <utility>
 
 namespace vineyard {
@@ -214,6 +224,243 @@ class SpinBlockingQueue {
   std::deque<T> queue_;
   SpinLock lock;
 };
+
+namespace detail {
+
+/**
+ * Block while `*word == expected`, or return spuriously, see also
+ * `futex(2)`. Other platforms just yield.
+ */
+inline void futex_wait(std::atomic<uint32_t>* word, uint32_t const expected) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE,
+          expected, nullptr, nullptr, 0);
+#else
+  if (word->load() == expected) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+inline void futex_wake(std::atomic<uint32_t>* word, int const count) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE,
+          count, nullptr, nullptr, 0);
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * @brief A bounded lock-free multi-producer multi-consumer queue, which is a
+ * ring of sequenced cells after Dmitry Vyukov's design, the capacity is
+ * rounded up to a power of two.
+ *
+ * `TryPush` and `TryPop` (and the batch variants, which claim a range of
+ * cells with a single CAS) never block. `Put` and `Get` wait on a futex
+ * when the queue is full or empty, the waking side issues the syscall only
+ * if there are waiters.
+ *
+ * As `PCBlockingQueue`, `Get` returns false once the queue is drained after
+ * all producers have left, see `SetProducerNum` and `DecProducerNum`.
+ */
+template <typename T>
+class MPMCQueue {
+ public:
+  explicit MPMCQueue(size_t const capacity = 1024) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (size_t index = 0; index < size; ++index) {
+      cells_[index].sequence.store(index, std::memory_order_relaxed);
+    }
+  }
+
+  MPMCQueue(const MPMCQueue&) = delete;
+  MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+  size_t Capacity() const { return mask_ + 1; }
+
+  bool TryPush(const T& item) {
+    T value(item);
+    return TryPush(std::move(value));
+  }
+
+  bool TryPush(T&& item) { return TryPushBatch(&item, 1) == 1; }
+
+  bool TryPop(T& item) { return TryPopBatch(&item, 1) == 1; }
+
+  /**
+   * @brief Move at most `count` items into the queue, returns how many have
+   * been pushed, which is 0 only when the queue is full.
+   */
+  size_t TryPushBatch(T* items, size_t const count) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    size_t claimed = 0;
+    while (true) {
+      claimed = 0;
+      while (claimed < count) {
+        Cell& cell = cells_[(pos + claimed) & mask_];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) -
+                        static_cast<intptr_t>(pos + claimed);
+        if (diff != 0) {
+          break;
+        }
+        claimed += 1;
+      }
+      if (claimed == 0) {
+        size_t current = enqueue_pos_.load(std::memory_order_relaxed);
+        if (current == pos) {
+          return 0;  // full
+        }
+        pos = current;
+        continue;
+      }
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + claimed,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    for (size_t index = 0; index < claimed; ++index) {
+      Cell& cell = cells_[(pos + index) & mask_];
+      cell.value = std::move(items[index]);
+      cell.sequence.store(pos + index + 1, std::memory_order_release);
+    }
+    pushes_.fetch_add(1);
+    if (pop_waiters_.load() > 0) {
+      detail::futex_wake(&pushes_, claimed == 1 ? 1 : INT_MAX);
+    }
+    return claimed;
+  }
+
+  /**
+   * @brief Move at most `count` items out of the queue, returns how many have
+   * been popped, which is 0 only when the queue is empty.
+   */
+  size_t TryPopBatch(T* items, size_t const count) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    size_t claimed = 0;
+    while (true) {
+      claimed = 0;
+      while (claimed < count) {
+        Cell& cell = cells_[(pos + claimed) & mask_];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) -
+                        static_cast<intptr_t>(pos + claimed + 1);
+        if (diff != 0) {
+          break;
+        }
+        claimed += 1;
+      }
+      if (claimed == 0) {
+        size_t current = dequeue_pos_.load(std::memory_order_relaxed);
+        if (current == pos) {
+          return 0;  // empty
+        }
+        pos = current;
+        continue;
+      }
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + claimed,
+                                             std::memory_order_relaxed)) {
+        break;
+      }
+    }
+    for (size_t index = 0; index < claimed; ++index) {
+      Cell& cell = cells_[(pos + index) & mask_];
+      items[index] = std::move(cell.value);
+      cell.sequence.store(pos + index + mask_ + 1, std::memory_order_release);
+    }
+    pops_.fetch_add(1);
+    if (push_waiters_.load() > 0) {
+      detail::futex_wake(&pops_, claimed == 1 ? 1 : INT_MAX);
+    }
+    return claimed;
+  }
+
+  void Put(const T& item) {
+    T value(item);
+    Put(std::move(value));
+  }
+
+  /** Push the item, and block while the queue is full. */
+  void Put(T&& item) {
+    while (true) {
+      uint32_t epoch = pops_.load();
+      if (TryPush(std::move(item))) {
+        return;
+      }
+      push_waiters_.fetch_add(1);
+      detail::futex_wait(&pops_, epoch);
+      push_waiters_.fetch_sub(1);
+    }
+  }
+
+  /**
+   * @brief Pop an item, and block while the queue is empty. Returns false if
+   * the queue is empty and all producers have left.
+   */
+  bool Get(T& item) {
+    while (true) {
+      uint32_t epoch = pushes_.load();
+      if (TryPop(item)) {
+        return true;
+      }
+      if (producer_num_.load() <= 0) {
+        // the items pushed before the last producer left
+        return TryPop(item);
+      }
+      pop_waiters_.fetch_add(1);
+      detail::futex_wait(&pushes_, epoch);
+      pop_waiters_.fetch_sub(1);
+    }
+  }
+
+  void SetProducerNum(int const producer_num) {
+    producer_num_.store(producer_num);
+  }
+
+  void DecProducerNum() {
+    if (producer_num_.fetch_sub(1) == 1) {
+      pushes_.fetch_add(1);
+      detail::futex_wake(&pushes_, INT_MAX);
+    }
+  }
+
+  /** The number of items, which is approximate under concurrent access. */
+  size_t Size() const {
+    size_t enqueued = enqueue_pos_.load(std::memory_order_relaxed);
+    size_t dequeued = dequeue_pos_.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  bool End() const { return Empty() && producer_num_.load() <= 0; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static constexpr size_t kCacheLineSize = 64;
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_{0};
+  // the epochs that the blocked consumers and producers wait on
+  alignas(kCacheLineSize) std::atomic<uint32_t> pushes_{0};
+  std::atomic<uint32_t> pop_waiters_{0};
+  alignas(kCacheLineSize) std::atomic<uint32_t> pops_{0};
+  std::atomic<uint32_t> push_waiters_{0};
+  std::atomic<int> producer_num_{1};
+};
+
 }  // namespace vineyard
 
 #endif  // SRC_COMMON_UTIL_BLOCKING_QUEUE_H_
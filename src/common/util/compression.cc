@@ -0,0 +1,98 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/util/compression.h"
+
+#include <memory>
+#include <string>
+
+#include "arrow/util/compression.h"
+#include "arrow/util/config.h"
+
+namespace vineyard {
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 17000
+
+static Status CreateCodec(std::string const& codec,
+                          std::unique_ptr<arrow::util::Codec>& result) {
+  arrow::Compression::type type;
+  if (codec == "lz4") {
+    type = arrow::Compression::LZ4_FRAME;
+  } else if (codec == "zstd") {
+    type = arrow::Compression::ZSTD;
+  } else if (codec == "snappy") {
+    type = arrow::Compression::SNAPPY;
+  } else if (codec == "gzip") {
+    type = arrow::Compression::GZIP;
+  } else {
+    return Status::Invalid("Unknown compression codec: " + codec);
+  }
+  auto maybe_codec = arrow::util::Codec::Create(type);
+  if (!maybe_codec.ok()) {
+    return Status::ArrowError(maybe_codec.status());
+  }
+  result = std::move(maybe_codec).ValueOrDie();
+  return Status::OK();
+}
+
+Status Compress(std::string const& codec, const uint8_t* data,
+                size_t const size, std::string& compressed) {
+  std::unique_ptr<arrow::util::Codec> compressor;
+  RETURN_ON_ERROR(CreateCodec(codec, compressor));
+  compressed.resize(compressor->MaxCompressedLen(size, data));
+  auto maybe_size = compressor->Compress(
+      size, data, compressed.size(),
+      reinterpret_cast<uint8_t*>(&compressed[0]));
+  if (!maybe_size.ok()) {
+    return Status::ArrowError(maybe_size.status());
+  }
+  compressed.resize(maybe_size.ValueOrDie());
+  return Status::OK();
+}
+
+Status Decompress(std::string const& codec, const uint8_t* data,
+                  size_t const size, uint8_t* decompressed,
+                  size_t const decompressed_size) {
+  std::unique_ptr<arrow::util::Codec> decompressor;
+  RETURN_ON_ERROR(CreateCodec(codec, decompressor));
+  auto maybe_size =
+      decompressor->Decompress(size, data, decompressed_size, decompressed);
+  if (!maybe_size.ok()) {
+    return Status::ArrowError(maybe_size.status());
+  }
+  if (static_cast<size_t>(maybe_size.ValueOrDie()) != decompressed_size) {
+    return Status::Invalid("Unexpected size of the decompressed data: " +
+                           std::to_string(maybe_size.ValueOrDie()) +
+                           ", expected " + std::to_string(decompressed_size));
+  }
+  return Status::OK();
+}
+
+#else
+
+Status Compress(std::string const& codec, const uint8_t* data,
+                size_t const size, std::string& compressed) {
+  return Status::NotImplemented("Compression requires arrow >= 0.17");
+}
+
+Status Decompress(std::string const& codec, const uint8_t* data,
+                  size_t const size, uint8_t* decompressed,
+                  size_t const decompressed_size) {
+  return Status::NotImplemented("Compression requires arrow >= 0.17");
+}
+
+#endif
+
+}  // namespace vineyard
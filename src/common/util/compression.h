@@ -0,0 +1,43 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_UTIL_COMPRESSION_H_
+#define SRC_COMMON_UTIL_COMPRESSION_H_
+
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief Compress the data with the given codec, i.e., "lz4", "zstd",
+ * "snappy" or "gzip". The codecs are provided by arrow, thus which of them
+ * are available depends on how arrow is built.
+ */
+Status Compress(std::string const& codec, const uint8_t* data,
+                size_t const size, std::string& compressed);
+
+/**
+ * @brief Decompress the data into the `decompressed` buffer, the size of
+ * the decompressed data must be exactly `decompressed_size`.
+ */
+Status Decompress(std::string const& codec, const uint8_t* data,
+                  size_t const size, uint8_t* decompressed,
+                  size_t const decompressed_size);
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_UTIL_COMPRESSION_H_
@@ -16,7 +16,9 @@ limitations under the License.
 #ifndef SRC_COMMON_UTIL_FUNCTIONS_H_
 #define SRC_COMMON_UTIL_FUNCTIONS_H_
 
+#include <sys/syscall.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #include <regex>
 #include <string>
@@ -57,6 +59,30 @@ inline int64_t GetTimestamp() {
   gettimeofday(&t, 0);
   return ((int64_t) t.tv_sec << sizeof(int32_t) * 8) + (int64_t) t.tv_usec;
 }
+
+// Get the NUMA node that the calling thread is running on, -1 if unknown.
+inline int GetCurrentNumaNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu = 0, node = 0;
+  if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+    return static_cast<int>(node);
+  }
+#endif
+  return -1;
+}
+
+// Get the number of NUMA nodes on this host, 0 if NUMA is not available.
+inline int GetNumaNodeCount() {
+  int nodes = 0;
+#if defined(__linux__)
+  while (access(("/sys/devices/system/node/node" + std::to_string(nodes))
+                    .c_str(),
+                F_OK) == 0) {
+    nodes += 1;
+  }
+#endif
+  return nodes;
+}
 }  // namespace vineyard
 
 #endif  // SRC_COMMON_UTIL_FUNCTIONS_H_
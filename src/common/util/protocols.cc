@@ -87,30 +87,352 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::InstanceStatusRequest;
   } else if (str_type == "shallow_copy_request") {
     return CommandType::ShallowCopyRequest;
+  } else if (str_type == "split_buffer_request") {
+    return CommandType::SplitBufferRequest;
+  } else if (str_type == "create_buffers_request") {
+    return CommandType::CreateBuffersRequest;
+  } else if (str_type == "open_ring_channel_request") {
+    return CommandType::OpenRingChannelRequest;
+  } else if (str_type == "deletion_notification") {
+    return CommandType::DeletionNotification;
+  } else if (str_type == "push_next_stream_chunk_request") {
+    return CommandType::PushNextStreamChunkRequest;
+  } else if (str_type == "open_stream_notifier_request") {
+    return CommandType::OpenStreamNotifierRequest;
+  } else if (str_type == "seek_stream_request") {
+    return CommandType::SeekStreamRequest;
+  } else if (str_type == "get_remote_blob_request") {
+    return CommandType::GetRemoteBlobRequest;
+  } else if (str_type == "subscribe_request") {
+    return CommandType::SubscribeRequest;
+  } else if (str_type == "unsubscribe_request") {
+    return CommandType::UnsubscribeRequest;
+  } else if (str_type == "object_notification") {
+    return CommandType::ObjectNotification;
+  } else if (str_type == "flush_request") {
+    return CommandType::FlushRequest;
+  } else if (str_type == "create_device_buffer_request") {
+    return CommandType::CreateDeviceBufferRequest;
+  } else if (str_type == "set_memory_limit_request") {
+    return CommandType::SetMemoryLimitRequest;
+  } else if (str_type == "set_tenant_quota_request") {
+    return CommandType::SetTenantQuotaRequest;
+  } else if (str_type == "access_stats_request") {
+    return CommandType::AccessStatsRequest;
+  } else if (str_type == "release_request") {
+    return CommandType::ReleaseRequest;
+  } else if (str_type == "slow_requests_request") {
+    return CommandType::SlowRequestsRequest;
   } else {
     return CommandType::NullCommand;
   }
 }
 
+const char* CommandTypeName(CommandType const type) {
+  switch (type) {
+  case CommandType::ExitRequest:
+    return "exit_request";
+  case CommandType::ExitReply:
+    return "exit_reply";
+  case CommandType::RegisterRequest:
+    return "register_request";
+  case CommandType::RegisterReply:
+    return "register_reply";
+  case CommandType::GetDataRequest:
+    return "get_data_request";
+  case CommandType::GetDataReply:
+    return "get_data_reply";
+  case CommandType::CreateDataRequest:
+    return "create_data_request";
+  case CommandType::PersistRequest:
+    return "persist_request";
+  case CommandType::ExistsRequest:
+    return "exists_request";
+  case CommandType::DelDataRequest:
+    return "del_data_request";
+  case CommandType::ClusterMetaRequest:
+    return "cluster_meta";
+  case CommandType::ListDataRequest:
+    return "list_data_request";
+  case CommandType::CreateBufferRequest:
+    return "create_buffer_request";
+  case CommandType::GetBuffersRequest:
+    return "get_buffers_request";
+  case CommandType::CreateStreamRequest:
+    return "create_stream_request";
+  case CommandType::GetNextStreamChunkRequest:
+    return "get_next_stream_chunk_request";
+  case CommandType::PullNextStreamChunkRequest:
+    return "pull_next_stream_chunk_request";
+  case CommandType::StopStreamRequest:
+    return "stop_stream_request";
+  case CommandType::PutNameRequest:
+    return "put_name_request";
+  case CommandType::GetNameRequest:
+    return "get_name_request";
+  case CommandType::DropNameRequest:
+    return "drop_name_request";
+  case CommandType::IfPersistRequest:
+    return "if_persist_request";
+  case CommandType::InstanceStatusRequest:
+    return "instance_status_request";
+  case CommandType::ShallowCopyRequest:
+    return "shallow_copy_request";
+  case CommandType::SplitBufferRequest:
+    return "split_buffer_request";
+  case CommandType::CreateBuffersRequest:
+    return "create_buffers_request";
+  case CommandType::OpenRingChannelRequest:
+    return "open_ring_channel_request";
+  case CommandType::DeletionNotification:
+    return "deletion_notification";
+  case CommandType::PushNextStreamChunkRequest:
+    return "push_next_stream_chunk_request";
+  case CommandType::OpenStreamNotifierRequest:
+    return "open_stream_notifier_request";
+  case CommandType::SeekStreamRequest:
+    return "seek_stream_request";
+  case CommandType::GetRemoteBlobRequest:
+    return "get_remote_blob_request";
+  case CommandType::SubscribeRequest:
+    return "subscribe_request";
+  case CommandType::UnsubscribeRequest:
+    return "unsubscribe_request";
+  case CommandType::ObjectNotification:
+    return "object_notification";
+  case CommandType::FlushRequest:
+    return "flush_request";
+  case CommandType::CreateDeviceBufferRequest:
+    return "create_device_buffer_request";
+  case CommandType::SetMemoryLimitRequest:
+    return "set_memory_limit_request";
+  case CommandType::SetTenantQuotaRequest:
+    return "set_tenant_quota_request";
+  case CommandType::AccessStatsRequest:
+    return "access_stats_request";
+  case CommandType::ReleaseRequest:
+    return "release_request";
+  case CommandType::SlowRequestsRequest:
+    return "slow_requests_request";
+  default:
+    return "null_command";
+  }
+}
+
+void SlowRequest::ToJSON(ptree& tree) const {
+  tree.put("timestamp", timestamp);
+  tree.put("command", CommandTypeName(command));
+  tree.put("connection", connection);
+  tree.put("bytes_in", bytes_in);
+  tree.put("bytes_out", bytes_out);
+  tree.put("queue_us", queue_us);
+  tree.put("handle_us", handle_us);
+  tree.put("etcd_us", etcd_us);
+}
+
+void SlowRequest::FromJSON(const ptree& tree) {
+  timestamp = tree.get<int64_t>("timestamp");
+  command = ParseCommandType(tree.get<std::string>("command"));
+  connection = tree.get<int64_t>("connection");
+  bytes_in = tree.get<uint64_t>("bytes_in");
+  bytes_out = tree.get<uint64_t>("bytes_out");
+  queue_us = tree.get<uint64_t>("queue_us");
+  handle_us = tree.get<uint64_t>("handle_us");
+  etcd_us = tree.get<uint64_t>("etcd_us", 0);
+}
+
+static inline void put_varint(std::string& msg, size_t value) {
+  while (value >= 0x80) {
+    msg.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  msg.push_back(static_cast<char>(value));
+}
+
+static inline bool get_varint(const std::string& msg, size_t& pos,
+                              size_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < msg.size(); shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(msg[pos++]);
+    value |= static_cast<size_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static inline void put_string(std::string& msg, const std::string& value) {
+  put_varint(msg, value.size());
+  msg.append(value);
+}
+
+static inline bool get_string(const std::string& msg, size_t& pos,
+                              std::string& value) {
+  size_t length = 0;
+  if (!get_varint(msg, pos, length) || length > msg.size() - pos) {
+    return false;
+  }
+  value.assign(msg, pos, length);
+  pos += length;
+  return true;
+}
+
+static void encode_binary(const ptree& tree, std::string& msg) {
+  put_string(msg, tree.data());
+  put_varint(msg, tree.size());
+  for (auto const& kv : tree) {
+    put_string(msg, kv.first);
+    encode_binary(kv.second, msg);
+  }
+}
+
+static bool decode_binary(const std::string& msg, size_t& pos, ptree& tree,
+                          size_t depth) {
+  // bound the recursion, don't let a malicious client crash vineyardd
+  if (depth > 512 || !get_string(msg, pos, tree.data())) {
+    return false;
+  }
+  size_t children = 0;
+  if (!get_varint(msg, pos, children)) {
+    return false;
+  }
+  for (size_t i = 0; i < children; ++i) {
+    std::string key;
+    if (!get_string(msg, pos, key)) {
+      return false;
+    }
+    auto& child = tree.push_back(std::make_pair(key, ptree()))->second;
+    if (!decode_binary(msg, pos, child, depth + 1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 static inline void encode_msg(const ptree& root, std::string& msg) {
+  msg.clear();
+  msg.push_back(kBinaryMessageMagic);
+  encode_binary(root, msg);
+}
+
+Status DecodeMessage(const std::string& msg, ptree& root) {
+  if (IsBinaryMessage(msg)) {
+    size_t pos = 1;
+    if (!decode_binary(msg, pos, root, 0) || pos != msg.size()) {
+      return Status::Invalid("Malformed binary message");
+    }
+    return Status::OK();
+  }
+  std::istringstream is(msg);
+  try {
+    bpt::read_json(is, root);
+  } catch (bpt::ptree_error const& err) {
+    return Status::Invalid(std::string("ptree: ") + err.what());
+  }
+  return Status::OK();
+}
+
+Status TranscodeToJSON(std::string& msg) {
+  if (!IsBinaryMessage(msg)) {
+    return Status::OK();
+  }
+  ptree root;
+  RETURN_ON_ERROR(DecodeMessage(msg, root));
   std::stringstream ss;
   bpt::write_json(ss, root, false);
   msg = ss.str();
+  return Status::OK();
+}
+
+// append a field to the root of the encoded message, the binary messages
+// are appended without re-encoding the whole message.
+static Status append_field(std::string& msg, std::string const& key,
+                           std::string const& value) {
+  if (!IsBinaryMessage(msg)) {
+    ptree root;
+    RETURN_ON_ERROR(DecodeMessage(msg, root));
+    root.put(key, value);
+    std::stringstream ss;
+    bpt::write_json(ss, root, false);
+    msg = ss.str();
+    return Status::OK();
+  }
+  // as the last child of the root
+  size_t pos = 1, children = 0;
+  std::string data;
+  if (!get_string(msg, pos, data)) {
+    return Status::Invalid("Malformed binary message");
+  }
+  size_t data_end = pos;
+  if (!get_varint(msg, pos, children)) {
+    return Status::Invalid("Malformed binary message");
+  }
+  std::string appended;
+  appended.reserve(msg.size() + key.size() + value.size() + 16);
+  appended.append(msg, 0, data_end);
+  put_varint(appended, children + 1);
+  appended.append(msg, pos, std::string::npos);
+  put_string(appended, key);
+  put_string(appended, value);
+  put_varint(appended, 0);
+  msg.swap(appended);
+  return Status::OK();
+}
+
+Status TagMessage(std::string& msg, uint64_t const tag) {
+  if (tag == 0) {
+    return Status::OK();
+  }
+  return append_field(msg, "request_tag", std::to_string(tag));
+}
+
+uint64_t GetMessageTag(const ptree& root) {
+  return root.get<uint64_t>("request_tag", 0);
+}
+
+Status TraceMessage(std::string& msg, trace::Context const& context) {
+  if (!context.sampled()) {
+    return Status::OK();
+  }
+  return append_field(msg, "trace", context.ToString());
+}
+
+trace::Context GetMessageTrace(const ptree& root) {
+  auto value = root.get_optional<std::string>("trace");
+  if (!value) {
+    return trace::Context();
+  }
+  return trace::Context::FromString(*value);
 }
 
 void WriteErrorReply(Status const& status, std::string& msg) {
   encode_msg(status.ToJSON(), msg);
 }
 
-void WriteRegisterRequest(std::string& msg) {
+void WriteRegisterRequest(bool const deletion_notification, std::string& msg) {
+  WriteRegisterRequest(deletion_notification, "", msg);
+}
+
+void WriteRegisterRequest(bool const deletion_notification,
+                          std::string const& tenant, std::string& msg) {
   ptree root;
   root.put("type", "register_request");
+  root.put("binary_protocol", true);
+  root.put("deletion_notification", deletion_notification);
+  if (!tenant.empty()) {
+    root.put("tenant", tenant);
+  }
 
   encode_msg(root, msg);
 }
 
-Status ReadRegisterRequest(const ptree& root) {
+Status ReadRegisterRequest(const ptree& root, bool& binary_protocol,
+                           bool& deletion_notification, std::string& tenant) {
   RETURN_ON_ASSERT(root.get<std::string>("type") == "register_request");
+  binary_protocol = root.get<bool>("binary_protocol", false);
+  deletion_notification = root.get<bool>("deletion_notification", false);
+  tenant = root.get<std::string>("tenant", "");
   return Status::OK();
 }
 
@@ -122,16 +444,24 @@ void WriteRegisterReply(const std::string& ipc_socket,
   root.put("ipc_socket", ipc_socket);
   root.put("rpc_endpoint", rpc_endpoint);
   root.put("instance_id", instance_id);
+  root.put("binary_protocol", true);
+  root.put("request_tag", true);
+  root.put("deletion_notification", true);
 
   encode_msg(root, msg);
 }
 
 Status ReadRegisterReply(const ptree& root, std::string& ipc_socket,
-                         std::string& rpc_endpoint, uint64_t& instance_id) {
+                         std::string& rpc_endpoint, uint64_t& instance_id,
+                         bool& binary_protocol, bool& request_tag,
+                         bool& deletion_notification) {
   CHECK_IPC_ERROR(root, "register_reply");
   ipc_socket = root.get<std::string>("ipc_socket");
   rpc_endpoint = root.get<std::string>("rpc_endpoint");
   instance_id = root.get<uint64_t>("instance_id");
+  binary_protocol = root.get<bool>("binary_protocol", false);
+  request_tag = root.get<bool>("request_tag", false);
+  deletion_notification = root.get<bool>("deletion_notification", false);
   return Status::OK();
 }
 
@@ -215,35 +545,72 @@ Status ReadGetDataReply(const ptree& root,
 
 void WriteListDataRequest(std::string const& pattern, bool const regex,
                           size_t const limit, std::string& msg) {
+  WriteListDataRequest(pattern, regex, limit, "", msg);
+}
+
+void WriteListDataRequest(std::string const& pattern, bool const regex,
+                          size_t const limit, std::string const& cursor,
+                          std::string& msg) {
   ptree root;
   root.put("type", "list_data_request");
   root.put("pattern", pattern);
   root.put("regex", regex);
   root.put("limit", limit);
+  if (!cursor.empty()) {
+    root.put("cursor", cursor);
+  }
 
   encode_msg(root, msg);
 }
 
 Status ReadListDataRequest(const ptree& root, std::string& pattern, bool& regex,
-                           size_t& limit) {
+                           size_t& limit, std::string& cursor) {
   RETURN_ON_ASSERT(root.get<std::string>("type") == "list_data_request");
   pattern = root.get<std::string>("pattern");
   regex = root.get<bool>("regex");
   limit = root.get<size_t>("limit");
+  cursor = root.get<std::string>("cursor", "");
   return Status::OK();
 }
 
-void WriteCreateBufferRequest(const size_t size, std::string& msg) {
+void WriteListDataReply(const ptree& content, std::string const& cursor,
+                        std::string& msg) {
+  // keeps the same type with the reply of get data, for old clients.
+  ptree root;
+  root.put("type", "get_data_reply");
+  root.add_child("content", content);
+  if (!cursor.empty()) {
+    root.put("cursor", cursor);
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadListDataReply(const ptree& root,
+                         std::unordered_map<ObjectID, ptree>& content,
+                         std::string& cursor) {
+  RETURN_ON_ERROR(ReadGetDataReply(root, content));
+  cursor = root.get<std::string>("cursor", "");
+  return Status::OK();
+}
+
+void WriteCreateBufferRequest(const size_t size, const int numa_node,
+                              const size_t alignment, std::string& msg) {
   ptree root;
   root.put("type", "create_buffer_request");
   root.put("size", size);
+  root.put("numa_node", numa_node);
+  root.put("alignment", alignment);
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateBufferRequest(const ptree& root, size_t& size) {
+Status ReadCreateBufferRequest(const ptree& root, size_t& size,
+                               int& numa_node, size_t& alignment) {
   RETURN_ON_ASSERT(root.get<std::string>("type") == "create_buffer_request");
   size = root.get<size_t>("size");
+  numa_node = root.get<int>("numa_node", -1);
+  alignment = root.get<size_t>("alignment", 0);
   return Status::OK();
 }
 
@@ -268,6 +635,82 @@ Status ReadCreateBufferReply(const ptree& root, ObjectID& id, Payload& object) {
   return Status::OK();
 }
 
+void WriteCreateDeviceBufferRequest(const size_t size, const int device_id,
+                                    std::string& msg) {
+  ptree root;
+  root.put("type", "create_device_buffer_request");
+  root.put("size", size);
+  root.put("device_id", device_id);
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateDeviceBufferRequest(const ptree& root, size_t& size,
+                                     int& device_id) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "create_device_buffer_request");
+  size = root.get<size_t>("size");
+  device_id = root.get<int>("device_id", 0);
+  return Status::OK();
+}
+
+void WriteSplitBufferRequest(const ObjectID id,
+                             const std::vector<size_t>& offsets,
+                             const std::vector<size_t>& sizes,
+                             std::string& msg) {
+  ptree root;
+  root.put("type", "split_buffer_request");
+  root.put("id", id);
+  ptree blobs;
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    ptree blob;
+    blob.put("offset", offsets[i]);
+    blob.put("size", sizes[i]);
+    blobs.add_child(std::to_string(i), blob);
+  }
+  root.add_child("blobs", blobs);
+  root.put("num", offsets.size());
+
+  encode_msg(root, msg);
+}
+
+Status ReadSplitBufferRequest(const ptree& root, ObjectID& id,
+                              std::vector<size_t>& offsets,
+                              std::vector<size_t>& sizes) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "split_buffer_request");
+  id = root.get<ObjectID>("id");
+  size_t num = root.get<size_t>("num");
+  if (num > 0) {
+    const ptree& blobs = root.get_child("blobs");
+    for (size_t i = 0; i < num; ++i) {
+      const ptree& blob = blobs.get_child(std::to_string(i));
+      offsets.push_back(blob.get<size_t>("offset"));
+      sizes.push_back(blob.get<size_t>("size"));
+    }
+  }
+  return Status::OK();
+}
+
+void WriteSplitBufferReply(const std::vector<ObjectID>& ids, std::string& msg) {
+  ptree root;
+  root.put("type", "split_buffer_reply");
+  for (size_t i = 0; i < ids.size(); ++i) {
+    root.put(std::to_string(i), ids[i]);
+  }
+  root.put("num", ids.size());
+
+  encode_msg(root, msg);
+}
+
+Status ReadSplitBufferReply(const ptree& root, std::vector<ObjectID>& ids) {
+  CHECK_IPC_ERROR(root, "split_buffer_reply");
+  size_t num = root.get<size_t>("num");
+  for (size_t i = 0; i < num; ++i) {
+    ids.push_back(root.get<ObjectID>(std::to_string(i)));
+  }
+  return Status::OK();
+}
+
 void WriteGetBuffersRequest(const std::unordered_set<ObjectID>& ids,
                             std::string& msg) {
   ptree root;
@@ -290,115 +733,523 @@ Status ReadGetBuffersRequest(const ptree& root, std::vector<ObjectID>& ids) {
   return Status::OK();
 }
 
-void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
-                          std::string& msg) {
+static void put_fds(ptree& root, const std::vector<int>& fds) {
+  ptree tree;
+  for (size_t i = 0; i < fds.size(); ++i) {
+    tree.put(std::to_string(i), fds[i]);
+  }
+  root.add_child("fds", tree);
+  root.put("fds_num", fds.size());
+}
+
+static void get_fds(const ptree& root, std::vector<int>& fds) {
+  size_t num = root.get<size_t>("fds_num", 0);
+  if (num > 0) {
+    const ptree& tree = root.get_child("fds");
+    for (size_t i = 0; i < num; ++i) {
+      fds.push_back(tree.get<int>(std::to_string(i)));
+    }
+  }
+}
+
+void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
+                          const std::vector<int>& fds, std::string& msg) {
+  ptree root;
+  root.put("type", "get_buffers_reply");
+  for (size_t i = 0; i < objects.size(); ++i) {
+    ptree tree;
+    objects[i]->ToJSON(tree);
+    root.add_child(std::to_string(i), tree);
+  }
+  root.put("num", objects.size());
+  put_fds(root, fds);
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetBuffersReply(const ptree& root,
+                           std::unordered_map<ObjectID, Payload>& objects,
+                           std::vector<int>& fds) {
+  CHECK_IPC_ERROR(root, "get_buffers_reply");
+  for (size_t i = 0; i < root.get<size_t>("num"); ++i) {
+    ptree tree = root.get_child(std::to_string(i));
+    Payload object;
+    object.FromJSON(tree);
+    objects.emplace(object.object_id, object);
+  }
+  get_fds(root, fds);
+  return Status::OK();
+}
+
+void WriteCreateBuffersRequest(const std::vector<size_t>& sizes,
+                               const int numa_node, std::string& msg) {
+  ptree root;
+  root.put("type", "create_buffers_request");
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    root.put(std::to_string(i), sizes[i]);
+  }
+  root.put("num", sizes.size());
+  root.put("numa_node", numa_node);
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBuffersRequest(const ptree& root, std::vector<size_t>& sizes,
+                                int& numa_node) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "create_buffers_request");
+  size_t num = root.get<size_t>("num");
+  for (size_t i = 0; i < num; ++i) {
+    sizes.push_back(root.get<size_t>(std::to_string(i)));
+  }
+  numa_node = root.get<int>("numa_node", -1);
+  return Status::OK();
+}
+
+void WriteCreateBuffersReply(
+    const std::vector<std::shared_ptr<Payload>>& objects,
+    const std::vector<int>& fds, std::string& msg) {
+  ptree root;
+  root.put("type", "create_buffers_reply");
+  for (size_t i = 0; i < objects.size(); ++i) {
+    ptree tree;
+    objects[i]->ToJSON(tree);
+    root.add_child(std::to_string(i), tree);
+  }
+  root.put("num", objects.size());
+  put_fds(root, fds);
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBuffersReply(const ptree& root, std::vector<ObjectID>& ids,
+                              std::vector<Payload>& objects,
+                              std::vector<int>& fds) {
+  CHECK_IPC_ERROR(root, "create_buffers_reply");
+  for (size_t i = 0; i < root.get<size_t>("num"); ++i) {
+    ptree tree = root.get_child(std::to_string(i));
+    Payload object;
+    object.FromJSON(tree);
+    ids.emplace_back(object.object_id);
+    objects.emplace_back(object);
+  }
+  get_fds(root, fds);
+  return Status::OK();
+}
+
+void WriteOpenRingChannelRequest(const size_t capacity, std::string& msg) {
+  ptree root;
+  root.put("type", "open_ring_channel_request");
+  root.put("capacity", capacity);
+
+  encode_msg(root, msg);
+}
+
+Status ReadOpenRingChannelRequest(const ptree& root, size_t& capacity) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "open_ring_channel_request");
+  capacity = root.get<size_t>("capacity");
+  return Status::OK();
+}
+
+void WriteOpenRingChannelReply(const size_t capacity, std::string& msg) {
+  ptree root;
+  root.put("type", "open_ring_channel_reply");
+  root.put("capacity", capacity);
+
+  encode_msg(root, msg);
+}
+
+Status ReadOpenRingChannelReply(const ptree& root, size_t& capacity) {
+  CHECK_IPC_ERROR(root, "open_ring_channel_reply");
+  capacity = root.get<size_t>("capacity");
+  return Status::OK();
+}
+
+void WriteDeletionNotification(const std::vector<ObjectID>& ids,
+                               std::string& msg) {
+  ptree root;
+  root.put("type", "deletion_notification");
+
+  std::vector<std::string> ids_string;
+  ids_string.reserve(ids.size());
+  for (ObjectID const& id : ids) {
+    ids_string.emplace_back(VYObjectIDToString(id));
+  }
+  root.put("id", boost::algorithm::join(ids_string, ";"));
+
+  encode_msg(root, msg);
+}
+
+Status ReadDeletionNotification(const ptree& root, std::vector<ObjectID>& ids) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "deletion_notification");
+  std::vector<std::string> id_strings;
+  std::string id_string = root.get<std::string>("id");
+  boost::algorithm::split(id_strings, id_string, boost::is_any_of(";"));
+  for (auto const& s : id_strings) {
+    if (!s.empty()) {
+      ids.emplace_back(VYObjectIDFromString(s));
+    }
+  }
+  return Status::OK();
+}
+
+void WriteCreateDataRequest(const ptree& content, std::string& msg) {
+  WriteCreateDataRequest(content, 0, msg);
+}
+
+void WriteCreateDataRequest(const ptree& content, uint64_t const ttl,
+                            std::string& msg) {
+  ptree root;
+  root.put("type", "create_data_request");
+  root.add_child("content", content);
+  if (ttl > 0) {
+    root.put("ttl", ttl);
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateDataRequest(const ptree& root, ptree& content,
+                             uint64_t& ttl) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "create_data_request");
+  content = root.get_child("content");
+  ttl = root.get<uint64_t>("ttl", 0);
+  return Status::OK();
+}
+
+void WriteCreateDataReply(const ObjectID& id, const InstanceID& instance_id,
+                          std::string& msg) {
+  ptree root;
+  root.put("type", "create_data_reply");
+  root.put("id", id);
+  root.put("instance_id", instance_id);
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateDataReply(const ptree& root, ObjectID& id,
+                           InstanceID& instance_id) {
+  CHECK_IPC_ERROR(root, "create_data_reply");
+  id = root.get<ObjectID>("id");
+  instance_id = root.get<ObjectID>("instance_id");
+  return Status::OK();
+}
+
+void WritePersistRequest(const ObjectID id, std::string& msg) {
+  WritePersistRequest(id, 0, msg);
+}
+
+void WritePersistRequest(const ObjectID id, uint64_t const ttl,
+                         std::string& msg) {
+  ptree root;
+  root.put("type", "persist_request");
+  root.put("id", id);
+  if (ttl > 0) {
+    root.put("ttl", ttl);
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadPersistRequest(const ptree& root, ObjectID& id, uint64_t& ttl) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "persist_request");
+  id = root.get<ObjectID>("id");
+  ttl = root.get<uint64_t>("ttl", 0);
+  return Status::OK();
+}
+
+void WritePersistRequest(const std::vector<ObjectID>& ids, uint64_t const ttl,
+                         std::string& msg) {
+  WritePersistRequest(ids, ttl, false, msg);
+}
+
+void WritePersistRequest(const std::vector<ObjectID>& ids, uint64_t const ttl,
+                         bool const write_behind, std::string& msg) {
+  ptree root;
+  root.put("type", "persist_request");
+
+  std::vector<std::string> ids_string;
+  ids_string.reserve(ids.size());
+  for (ObjectID const& id : ids) {
+    ids_string.emplace_back(VYObjectIDToString(id));
+  }
+  root.put("ids", boost::algorithm::join(ids_string, ";"));
+  if (ttl > 0) {
+    root.put("ttl", ttl);
+  }
+  if (write_behind) {
+    root.put("write_behind", true);
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadPersistRequest(const ptree& root, std::vector<ObjectID>& ids,
+                          uint64_t& ttl, bool& write_behind) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "persist_request");
+  auto ids_string = root.get_optional<std::string>("ids");
+  if (ids_string) {
+    std::vector<std::string> id_strings;
+    boost::algorithm::split(id_strings, ids_string.get(),
+                            boost::is_any_of(";"));
+    for (auto const& s : id_strings) {
+      if (!s.empty()) {
+        ids.emplace_back(VYObjectIDFromString(s));
+      }
+    }
+  } else {
+    ids.emplace_back(root.get<ObjectID>("id"));
+  }
+  ttl = root.get<uint64_t>("ttl", 0);
+  write_behind = root.get<bool>("write_behind", false);
+  return Status::OK();
+}
+
+void WritePersistReply(std::string& msg) {
+  ptree root;
+  root.put("type", "persist_reply");
+
+  encode_msg(root, msg);
+}
+
+Status ReadPersistReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "persist_reply");
+  return Status::OK();
+}
+
+void WriteIfPersistRequest(const ObjectID id, std::string& msg) {
+  ptree root;
+  root.put("type", "if_persist_request");
+  root.put("id", id);
+
+  encode_msg(root, msg);
+}
+
+Status ReadIfPersistRequest(const ptree& root, ObjectID& id) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "if_persist_request");
+  id = root.get<ObjectID>("id");
+  return Status::OK();
+}
+
+void WriteIfPersistReply(bool persist, std::string& msg) {
+  WriteIfPersistReply(persist, persist, msg);
+}
+
+void WriteIfPersistReply(bool persist, bool durable, std::string& msg) {
+  ptree root;
+  root.put("type", "if_persist_reply");
+  root.put("persist", persist);
+  root.put("durable", durable);
+
+  encode_msg(root, msg);
+}
+
+Status ReadIfPersistReply(const ptree& root, bool& persist) {
+  CHECK_IPC_ERROR(root, "if_persist_reply");
+  persist = root.get<bool>("persist");
+  return Status::OK();
+}
+
+Status ReadIfPersistReply(const ptree& root, bool& persist, bool& durable) {
+  CHECK_IPC_ERROR(root, "if_persist_reply");
+  persist = root.get<bool>("persist");
+  durable = root.get<bool>("durable", persist);
+  return Status::OK();
+}
+
+void WriteFlushRequest(std::string& msg) {
+  ptree root;
+  root.put("type", "flush_request");
+
+  encode_msg(root, msg);
+}
+
+Status ReadFlushRequest(const ptree& root) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "flush_request");
+  return Status::OK();
+}
+
+void WriteFlushReply(std::string& msg) {
+  ptree root;
+  root.put("type", "flush_reply");
+
+  encode_msg(root, msg);
+}
+
+Status ReadFlushReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "flush_reply");
+  return Status::OK();
+}
+
+void WriteSetMemoryLimitRequest(const size_t limit, std::string& msg) {
+  ptree root;
+  root.put("type", "set_memory_limit_request");
+  root.put("limit", limit);
+
+  encode_msg(root, msg);
+}
+
+Status ReadSetMemoryLimitRequest(const ptree& root, size_t& limit) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "set_memory_limit_request");
+  limit = root.get<size_t>("limit");
+  return Status::OK();
+}
+
+void WriteSetMemoryLimitReply(std::string& msg) {
+  ptree root;
+  root.put("type", "set_memory_limit_reply");
+
+  encode_msg(root, msg);
+}
+
+Status ReadSetMemoryLimitReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "set_memory_limit_reply");
+  return Status::OK();
+}
+
+void WriteSetTenantQuotaRequest(std::string const& tenant, const size_t quota,
+                                std::string& msg) {
+  ptree root;
+  root.put("type", "set_tenant_quota_request");
+  root.put("tenant", tenant);
+  root.put("quota", quota);
+
+  encode_msg(root, msg);
+}
+
+Status ReadSetTenantQuotaRequest(const ptree& root, std::string& tenant,
+                                 size_t& quota) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "set_tenant_quota_request");
+  tenant = root.get<std::string>("tenant");
+  quota = root.get<size_t>("quota");
+  return Status::OK();
+}
+
+void WriteSetTenantQuotaReply(std::string& msg) {
   ptree root;
-  root.put("type", "get_buffers_reply");
-  for (size_t i = 0; i < objects.size(); ++i) {
-    ptree tree;
-    objects[i]->ToJSON(tree);
-    root.add_child(std::to_string(i), tree);
-  }
-  root.put("num", objects.size());
+  root.put("type", "set_tenant_quota_reply");
 
   encode_msg(root, msg);
 }
 
-Status ReadGetBuffersReply(const ptree& root,
-                           std::unordered_map<ObjectID, Payload>& objects) {
-  CHECK_IPC_ERROR(root, "get_buffers_reply");
-  for (size_t i = 0; i < root.get<size_t>("num"); ++i) {
-    ptree tree = root.get_child(std::to_string(i));
-    Payload object;
-    object.FromJSON(tree);
-    objects.emplace(object.object_id, object);
-  }
+Status ReadSetTenantQuotaReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "set_tenant_quota_reply");
   return Status::OK();
 }
 
-void WriteCreateDataRequest(const ptree& content, std::string& msg) {
+void WriteAccessStatsRequest(const bool hot, const size_t limit,
+                             std::string& msg) {
   ptree root;
-  root.put("type", "create_data_request");
-  root.add_child("content", content);
+  root.put("type", "access_stats_request");
+  root.put("hot", hot);
+  root.put("limit", limit);
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateDataRequest(const ptree& root, ptree& content) {
-  RETURN_ON_ASSERT(root.get<std::string>("type") == "create_data_request");
-  content = root.get_child("content");
+Status ReadAccessStatsRequest(const ptree& root, bool& hot, size_t& limit) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "access_stats_request");
+  hot = root.get<bool>("hot");
+  limit = root.get<size_t>("limit");
   return Status::OK();
 }
 
-void WriteCreateDataReply(const ObjectID& id, const InstanceID& instance_id,
-                          std::string& msg) {
+void WriteAccessStatsReply(const std::vector<BlobAccess>& blobs,
+                           std::string& msg) {
   ptree root;
-  root.put("type", "create_data_reply");
-  root.put("id", id);
-  root.put("instance_id", instance_id);
+  root.put("type", "access_stats_reply");
+  root.put("num", blobs.size());
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    ptree tree;
+    blobs[i].ToJSON(tree);
+    root.add_child(std::to_string(i), tree);
+  }
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateDataReply(const ptree& root, ObjectID& id,
-                           InstanceID& instance_id) {
-  CHECK_IPC_ERROR(root, "create_data_reply");
-  id = root.get<ObjectID>("id");
-  instance_id = root.get<ObjectID>("instance_id");
+Status ReadAccessStatsReply(const ptree& root, std::vector<BlobAccess>& blobs) {
+  CHECK_IPC_ERROR(root, "access_stats_reply");
+  size_t num = root.get<size_t>("num");
+  for (size_t i = 0; i < num; ++i) {
+    BlobAccess blob;
+    blob.FromJSON(root.get_child(std::to_string(i)));
+    blobs.emplace_back(blob);
+  }
   return Status::OK();
 }
 
-void WritePersistRequest(const ObjectID id, std::string& msg) {
+void WriteReleaseRequest(const std::vector<ObjectID>& ids, std::string& msg) {
   ptree root;
-  root.put("type", "persist_request");
-  root.put("id", id);
+  root.put("type", "release_request");
+  root.put("num", ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    root.put(std::to_string(i), ids[i]);
+  }
 
   encode_msg(root, msg);
 }
 
-Status ReadPersistRequest(const ptree& root, ObjectID& id) {
-  RETURN_ON_ASSERT(root.get<std::string>("type") == "persist_request");
-  id = root.get<ObjectID>("id");
+Status ReadReleaseRequest(const ptree& root, std::vector<ObjectID>& ids) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "release_request");
+  size_t num = root.get<size_t>("num");
+  for (size_t i = 0; i < num; ++i) {
+    ids.push_back(root.get<ObjectID>(std::to_string(i)));
+  }
   return Status::OK();
 }
 
-void WritePersistReply(std::string& msg) {
+void WriteReleaseReply(std::string& msg) {
   ptree root;
-  root.put("type", "persist_reply");
+  root.put("type", "release_reply");
 
   encode_msg(root, msg);
 }
 
-Status ReadPersistReply(const ptree& root) {
-  CHECK_IPC_ERROR(root, "persist_reply");
+Status ReadReleaseReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "release_reply");
   return Status::OK();
 }
 
-void WriteIfPersistRequest(const ObjectID id, std::string& msg) {
+void WriteSlowRequestsRequest(const size_t limit, std::string& msg) {
   ptree root;
-  root.put("type", "if_persist_request");
-  root.put("id", id);
+  root.put("type", "slow_requests_request");
+  root.put("limit", limit);
 
   encode_msg(root, msg);
 }
 
-Status ReadIfPersistRequest(const ptree& root, ObjectID& id) {
-  RETURN_ON_ASSERT(root.get<std::string>("type") == "if_persist_request");
-  id = root.get<ObjectID>("id");
+Status ReadSlowRequestsRequest(const ptree& root, size_t& limit) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "slow_requests_request");
+  limit = root.get<size_t>("limit");
   return Status::OK();
 }
 
-void WriteIfPersistReply(bool persist, std::string& msg) {
+void WriteSlowRequestsReply(const std::vector<SlowRequest>& requests,
+                            std::string& msg) {
   ptree root;
-  root.put("type", "if_persist_reply");
-  root.put("persist", persist);
+  root.put("type", "slow_requests_reply");
+  root.put("num", requests.size());
+  for (size_t i = 0; i < requests.size(); ++i) {
+    ptree tree;
+    requests[i].ToJSON(tree);
+    root.add_child(std::to_string(i), tree);
+  }
 
   encode_msg(root, msg);
 }
 
-Status ReadIfPersistReply(const ptree& root, bool& persist) {
-  CHECK_IPC_ERROR(root, "if_persist_reply");
-  persist = root.get<bool>("persist");
+Status ReadSlowRequestsReply(const ptree& root,
+                             std::vector<SlowRequest>& requests) {
+  CHECK_IPC_ERROR(root, "slow_requests_reply");
+  size_t num = root.get<size_t>("num");
+  for (size_t i = 0; i < num; ++i) {
+    SlowRequest request;
+    request.FromJSON(root.get_child(std::to_string(i)));
+    requests.emplace_back(request);
+  }
   return Status::OK();
 }
 
@@ -555,6 +1406,36 @@ Status ReadPutNameRequest(const ptree& root, ObjectID& object_id,
   return Status::OK();
 }
 
+void WritePutNameRequest(const std::map<std::string, ObjectID>& names,
+                         std::string& msg) {
+  ptree root;
+  root.put("type", "put_name_request");
+  ptree entries;
+  for (auto const& item : names) {
+    // names may contain '.', which is not a path here
+    entries.push_back(
+        std::make_pair(item.first, ptree(std::to_string(item.second))));
+  }
+  root.add_child("names", entries);
+
+  encode_msg(root, msg);
+}
+
+Status ReadPutNameRequest(const ptree& root,
+                          std::map<std::string, ObjectID>& names) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "put_name_request");
+  auto entries = root.get_child_optional("names");
+  if (entries) {
+    for (auto const& kv : entries.get()) {
+      names.emplace(kv.first, kv.second.get_value<ObjectID>());
+    }
+  } else {
+    names.emplace(root.get<std::string>("name"),
+                  root.get<ObjectID>("object_id"));
+  }
+  return Status::OK();
+}
+
 void WritePutNameReply(std::string& msg) {
   ptree root;
   root.put("type", "put_name_reply");
@@ -625,16 +1506,65 @@ Status ReadDropNameReply(const ptree& root) {
 }
 
 void WriteCreateStreamRequest(const ObjectID& object_id, std::string& msg) {
+  WriteCreateStreamRequest(object_id, 0, msg);
+}
+
+void WriteCreateStreamRequest(const ObjectID& object_id, size_t const depth,
+                              std::string& msg) {
+  WriteCreateStreamRequest(object_id, depth, 1, false, msg);
+}
+
+void WriteCreateStreamRequest(const ObjectID& object_id, size_t const depth,
+                              size_t const readers, bool const parallel,
+                              std::string& msg) {
+  WriteCreateStreamRequest(object_id, depth, readers, parallel, 0, msg);
+}
+
+void WriteCreateStreamRequest(const ObjectID& object_id, size_t const depth,
+                              size_t const readers, bool const parallel,
+                              size_t const retain, std::string& msg) {
   ptree root;
   root.put("type", "create_stream_request");
   root.put("object_id", object_id);
+  if (depth > 0) {
+    root.put("depth", depth);
+  }
+  if (readers > 1) {
+    root.put("readers", readers);
+  }
+  if (parallel) {
+    root.put("parallel", parallel);
+  }
+  if (retain > 0) {
+    root.put("retain", retain);
+  }
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateStreamRequest(const ptree& root, ObjectID& object_id) {
+Status ReadCreateStreamRequest(const ptree& root, ObjectID& object_id,
+                               size_t& depth) {
+  size_t readers;
+  bool parallel;
+  return ReadCreateStreamRequest(root, object_id, depth, readers, parallel);
+}
+
+Status ReadCreateStreamRequest(const ptree& root, ObjectID& object_id,
+                               size_t& depth, size_t& readers, bool& parallel) {
+  size_t retain;
+  return ReadCreateStreamRequest(root, object_id, depth, readers, parallel,
+                                 retain);
+}
+
+Status ReadCreateStreamRequest(const ptree& root, ObjectID& object_id,
+                               size_t& depth, size_t& readers, bool& parallel,
+                               size_t& retain) {
   RETURN_ON_ASSERT(root.get<std::string>("type") == "create_stream_request");
   object_id = root.get<ObjectID>("object_id");
+  depth = root.get<size_t>("depth", 0);
+  readers = root.get<size_t>("readers", 1);
+  parallel = root.get<bool>("parallel", false);
+  retain = root.get<size_t>("retain", 0);
   return Status::OK();
 }
 
@@ -688,17 +1618,48 @@ Status ReadGetNextStreamChunkReply(const ptree& root, Payload& object) {
 
 void WritePullNextStreamChunkRequest(const ObjectID stream_id,
                                      std::string& msg) {
+  WritePullNextStreamChunkRequest(stream_id, false, msg);
+}
+
+void WritePullNextStreamChunkRequest(const ObjectID stream_id,
+                                     const bool inlined, std::string& msg) {
+  WritePullNextStreamChunkRequest(stream_id, inlined, true, msg);
+}
+
+void WritePullNextStreamChunkRequest(const ObjectID stream_id,
+                                     const bool inlined, const bool wait,
+                                     std::string& msg) {
   ptree root;
   root.put("type", "pull_next_stream_chunk_request");
   root.put("id", stream_id);
+  if (inlined) {
+    root.put("inlined", inlined);
+  }
+  if (!wait) {
+    root.put("wait", wait);
+  }
 
   encode_msg(root, msg);
 }
 
 Status ReadPullNextStreamChunkRequest(const ptree& root, ObjectID& stream_id) {
+  bool inlined;
+  return ReadPullNextStreamChunkRequest(root, stream_id, inlined);
+}
+
+Status ReadPullNextStreamChunkRequest(const ptree& root, ObjectID& stream_id,
+                                      bool& inlined) {
+  bool wait;
+  return ReadPullNextStreamChunkRequest(root, stream_id, inlined, wait);
+}
+
+Status ReadPullNextStreamChunkRequest(const ptree& root, ObjectID& stream_id,
+                                      bool& inlined, bool& wait) {
   RETURN_ON_ASSERT(root.get<std::string>("type") ==
                    "pull_next_stream_chunk_request");
   stream_id = root.get<ObjectID>("id");
+  inlined = root.get<bool>("inlined", false);
+  wait = root.get<bool>("wait", true);
   return Status::OK();
 }
 
@@ -713,12 +1674,260 @@ void WritePullNextStreamChunkReply(std::shared_ptr<Payload>& object,
   encode_msg(root, msg);
 }
 
+void WritePullNextStreamChunkReply(const uint8_t* data, size_t const size,
+                                   std::string& msg) {
+  ptree root;
+  root.put("type", "pull_next_stream_chunk_reply");
+  root.put("chunk", std::string(reinterpret_cast<const char*>(data), size));
+
+  encode_msg(root, msg);
+}
+
 Status ReadPullNextStreamChunkReply(const ptree& root, Payload& object) {
   CHECK_IPC_ERROR(root, "pull_next_stream_chunk_reply");
   object.FromJSON(root.get_child("buffer"));
   return Status::OK();
 }
 
+Status ReadPullNextStreamChunkReply(const ptree& root, std::string& chunk) {
+  CHECK_IPC_ERROR(root, "pull_next_stream_chunk_reply");
+  chunk = root.get<std::string>("chunk");
+  return Status::OK();
+}
+
+void WritePushNextStreamChunkRequest(const ObjectID stream_id,
+                                     const uint8_t* data, size_t const size,
+                                     std::string& msg) {
+  ptree root;
+  root.put("type", "push_next_stream_chunk_request");
+  root.put("id", stream_id);
+  root.put("chunk", std::string(reinterpret_cast<const char*>(data), size));
+
+  encode_msg(root, msg);
+}
+
+Status ReadPushNextStreamChunkRequest(const ptree& root, ObjectID& stream_id,
+                                      std::string& chunk) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "push_next_stream_chunk_request");
+  stream_id = root.get<ObjectID>("id");
+  chunk = root.get<std::string>("chunk");
+  return Status::OK();
+}
+
+void WritePushNextStreamChunkReply(std::string& msg) {
+  ptree root;
+  root.put("type", "push_next_stream_chunk_reply");
+
+  encode_msg(root, msg);
+}
+
+Status ReadPushNextStreamChunkReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "push_next_stream_chunk_reply");
+  return Status::OK();
+}
+
+void WriteOpenStreamNotifierRequest(const ObjectID stream_id,
+                                    std::string& msg) {
+  ptree root;
+  root.put("type", "open_stream_notifier_request");
+  root.put("id", stream_id);
+
+  encode_msg(root, msg);
+}
+
+Status ReadOpenStreamNotifierRequest(const ptree& root, ObjectID& stream_id) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "open_stream_notifier_request");
+  stream_id = root.get<ObjectID>("id");
+  return Status::OK();
+}
+
+void WriteOpenStreamNotifierReply(std::string& msg) {
+  ptree root;
+  root.put("type", "open_stream_notifier_reply");
+
+  encode_msg(root, msg);
+}
+
+Status ReadOpenStreamNotifierReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "open_stream_notifier_reply");
+  return Status::OK();
+}
+
+void WriteSeekStreamRequest(const ObjectID stream_id, const size_t offset,
+                            std::string& msg) {
+  ptree root;
+  root.put("type", "seek_stream_request");
+  root.put("id", stream_id);
+  root.put("offset", offset);
+
+  encode_msg(root, msg);
+}
+
+Status ReadSeekStreamRequest(const ptree& root, ObjectID& stream_id,
+                             size_t& offset) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "seek_stream_request");
+  stream_id = root.get<ObjectID>("id");
+  offset = root.get<size_t>("offset");
+  return Status::OK();
+}
+
+void WriteSeekStreamReply(std::string& msg) {
+  ptree root;
+  root.put("type", "seek_stream_reply");
+
+  encode_msg(root, msg);
+}
+
+Status ReadSeekStreamReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "seek_stream_reply");
+  return Status::OK();
+}
+
+void WriteGetRemoteBlobRequest(const ObjectID id, const size_t offset,
+                               const size_t size,
+                               std::string const& compression,
+                               std::string& msg) {
+  ptree root;
+  root.put("type", "get_remote_blob_request");
+  root.put("id", id);
+  root.put("offset", offset);
+  root.put("size", size);
+  if (!compression.empty()) {
+    root.put("compression", compression);
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetRemoteBlobRequest(const ptree& root, ObjectID& id,
+                                size_t& offset, size_t& size,
+                                std::string& compression) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") ==
+                   "get_remote_blob_request");
+  id = root.get<ObjectID>("id");
+  offset = root.get<size_t>("offset");
+  size = root.get<size_t>("size");
+  compression = root.get<std::string>("compression", "");
+  return Status::OK();
+}
+
+void WriteGetRemoteBlobReply(const uint8_t* data, size_t const size,
+                             std::string& msg) {
+  ptree root;
+  root.put("type", "get_remote_blob_reply");
+  root.put("chunk", std::string(reinterpret_cast<const char*>(data), size));
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetRemoteBlobReply(const ptree& root, std::string& chunk) {
+  CHECK_IPC_ERROR(root, "get_remote_blob_reply");
+  chunk = root.get<std::string>("chunk");
+  return Status::OK();
+}
+
+void WriteSubscribeRequest(std::string const& pattern, bool const regex,
+                           bool const names, std::string& msg) {
+  ptree root;
+  root.put("type", "subscribe_request");
+  root.put("pattern", pattern);
+  root.put("regex", regex);
+  root.put("names", names);
+
+  encode_msg(root, msg);
+}
+
+Status ReadSubscribeRequest(const ptree& root, std::string& pattern,
+                            bool& regex, bool& names) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "subscribe_request");
+  pattern = root.get<std::string>("pattern");
+  regex = root.get<bool>("regex");
+  names = root.get<bool>("names", false);
+  return Status::OK();
+}
+
+void WriteSubscribeReply(uint64_t const subscription_id, std::string& msg) {
+  ptree root;
+  root.put("type", "subscribe_reply");
+  root.put("subscription_id", subscription_id);
+
+  encode_msg(root, msg);
+}
+
+Status ReadSubscribeReply(const ptree& root, uint64_t& subscription_id) {
+  CHECK_IPC_ERROR(root, "subscribe_reply");
+  subscription_id = root.get<uint64_t>("subscription_id");
+  return Status::OK();
+}
+
+void WriteUnsubscribeRequest(uint64_t const subscription_id, std::string& msg) {
+  ptree root;
+  root.put("type", "unsubscribe_request");
+  root.put("subscription_id", subscription_id);
+
+  encode_msg(root, msg);
+}
+
+Status ReadUnsubscribeRequest(const ptree& root, uint64_t& subscription_id) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "unsubscribe_request");
+  subscription_id = root.get<uint64_t>("subscription_id");
+  return Status::OK();
+}
+
+void WriteUnsubscribeReply(std::string& msg) {
+  ptree root;
+  root.put("type", "unsubscribe_reply");
+
+  encode_msg(root, msg);
+}
+
+Status ReadUnsubscribeReply(const ptree& root) {
+  CHECK_IPC_ERROR(root, "unsubscribe_reply");
+  return Status::OK();
+}
+
+void WriteObjectNotification(uint64_t const subscription_id,
+                             const std::vector<ObjectEvent>& events,
+                             std::string& msg) {
+  ptree root;
+  root.put("type", "object_notification");
+  root.put("subscription_id", subscription_id);
+  ptree objects;
+  for (size_t idx = 0; idx < events.size(); ++idx) {
+    ptree object;
+    object.put("id", VYObjectIDToString(events[idx].id));
+    object.put("typename", events[idx].type_name);
+    if (!events[idx].name.empty()) {
+      object.put("name", events[idx].name);
+    }
+    objects.add_child(std::to_string(idx), object);
+  }
+  root.add_child("objects", objects);
+
+  encode_msg(root, msg);
+}
+
+Status ReadObjectNotification(const ptree& root,
+                              std::vector<ObjectEvent>& events) {
+  RETURN_ON_ASSERT(root.get<std::string>("type") == "object_notification");
+  uint64_t subscription_id = root.get<uint64_t>("subscription_id");
+  auto objects = root.get_child_optional("objects");
+  if (!objects) {
+    return Status::OK();
+  }
+  for (auto const& kv : objects.get()) {
+    ObjectEvent event;
+    event.subscription_id = subscription_id;
+    event.id = VYObjectIDFromString(kv.second.get<std::string>("id"));
+    event.type_name = kv.second.get<std::string>("typename", "");
+    event.name = kv.second.get<std::string>("name", "");
+    events.emplace_back(std::move(event));
+  }
+  return Status::OK();
+}
+
 void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
                             std::string& msg) {
   ptree root;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef SRC_COMMON_UTIL_PROTOCOLS_H_
 #define SRC_COMMON_UTIL_PROTOCOLS_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -25,6 +26,7 @@ limitations under the License.
 #include "common/memory/payload.h"
 #include "common/util/boost.h"
 #include "common/util/status.h"
+#include "common/util/trace.h"
 #include "common/util/uuid.h"
 
 namespace vineyard {
@@ -55,22 +57,139 @@ enum class CommandType {
   IfPersistRequest = 25,
   InstanceStatusRequest = 26,
   ShallowCopyRequest = 27,
+  SplitBufferRequest = 28,
+  CreateBuffersRequest = 29,
+  OpenRingChannelRequest = 30,
+  DeletionNotification = 31,
+  PushNextStreamChunkRequest = 32,
+  OpenStreamNotifierRequest = 33,
+  SeekStreamRequest = 34,
+  GetRemoteBlobRequest = 35,
+  SubscribeRequest = 36,
+  UnsubscribeRequest = 37,
+  ObjectNotification = 38,
+  FlushRequest = 39,
+  CreateDeviceBufferRequest = 40,
+  SetMemoryLimitRequest = 41,
+  SetTenantQuotaRequest = 42,
+  AccessStatsRequest = 43,
+  ReleaseRequest = 44,
+  SlowRequestsRequest = 45,
 };
 
 CommandType ParseCommandType(const std::string& str_type);
 
+/**
+ * The inverse of `ParseCommandType`.
+ */
+const char* CommandTypeName(CommandType const type);
+
+/**
+ * A request that vineyardd took longer than the threshold to handle, see
+ * also `--slow_request_threshold`. The times are in microseconds, and
+ * `queue_us + handle_us` is the latency from receiving the request until
+ * the reply being written.
+ */
+struct SlowRequest {
+  // when the request was received, since the epoch
+  int64_t timestamp;
+  CommandType command;
+  int64_t connection;
+  uint64_t bytes_in;
+  uint64_t bytes_out;
+  // waiting before being handled, including the wait for the meta strand
+  uint64_t queue_us;
+  uint64_t handle_us;
+  // waiting for etcd during the handling
+  uint64_t etcd_us;
+
+  void ToJSON(ptree& tree) const;
+
+  void FromJSON(const ptree& tree);
+};
+
+/**
+ * Messages are encoded in a compact binary format: a magic byte (which never
+ * starts a JSON document), followed by the ptree, where every node is the
+ * length-prefixed data, the number of children and the length-prefixed
+ * key of each child before the child itself. Lengths are varints.
+ *
+ * The binary format is negotiated in the register request/reply, and
+ * messages are transcoded to JSON for peers that don't understand it.
+ *
+ * It is a generic transcoding of the ptree rather than a schema per command:
+ * writing and parsing the JSON text is saved, but every message is still
+ * built and read as a ptree of string keys and values, since the handlers
+ * of both formats share the same `Write*`/`Read*` functions and the two
+ * formats must stay interchangeable on a connection.
+ */
+constexpr char kBinaryMessageMagic = '\x01';
+
+inline bool IsBinaryMessage(const std::string& msg) {
+  return !msg.empty() && msg[0] == kBinaryMessageMagic;
+}
+
+/**
+ * Decode the message, which could be in either the binary format or JSON.
+ */
+Status DecodeMessage(const std::string& msg, ptree& root);
+
+/**
+ * Transcode the message to JSON in place if it is in the binary format.
+ */
+Status TranscodeToJSON(std::string& msg);
+
+/**
+ * Attach a tag to the encoded request, the server replies with the same tag
+ * thus several requests can be in flight on the same connection and the
+ * replies can be matched with them. Tag 0 means untagged.
+ */
+Status TagMessage(std::string& msg, uint64_t const tag);
+
+/**
+ * Get the tag of the request or reply, returns 0 if it is untagged.
+ */
+uint64_t GetMessageTag(const ptree& root);
+
+/**
+ * Attach the trace context to the encoded request, thus the spans in
+ * vineyardd are children of the span of the client, see also
+ * `trace::Tracer`. It's a no-op when the context isn't sampled.
+ */
+Status TraceMessage(std::string& msg, trace::Context const& context);
+
+/**
+ * Get the trace context of the request, which is empty if it isn't traced.
+ */
+trace::Context GetMessageTrace(const ptree& root);
+
 void WriteErrorReply(Status const& status, std::string& msg);
 
-void WriteRegisterRequest(std::string& msg);
+/**
+ * The client may subscribe the deletion notifications (see also
+ * `WriteDeletionNotification`) of the objects it has got, to keep its
+ * metadata cache up to date.
+ */
+void WriteRegisterRequest(bool const deletion_notification, std::string& msg);
+
+/**
+ * The blobs created by the client are accounted to the tenant, whose quota
+ * is enforced by the server, see also `WriteSetTenantQuotaRequest`.
+ */
+void WriteRegisterRequest(bool const deletion_notification,
+                          std::string const& tenant, std::string& msg);
 
-Status ReadRegisterRequest(const ptree& msg);
+Status ReadRegisterRequest(const ptree& msg, bool& binary_protocol,
+                           bool& deletion_notification, std::string& tenant);
 
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
                         const InstanceID instance_id, std::string& msg);
 
 Status ReadRegisterReply(const ptree& msg, std::string& ipc_socket,
-                         std::string& rpc_endpoint, InstanceID& instance_id);
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         bool& binary_protocol, bool& request_tag,
+                         bool& deletion_notification);
 
 void WriteExitRequest(std::string& msg);
 
@@ -94,12 +213,26 @@ Status ReadGetDataReply(const ptree& root,
 void WriteListDataRequest(std::string const& pattern, bool const regex,
                           size_t const limit, std::string& msg);
 
+void WriteListDataRequest(std::string const& pattern, bool const regex,
+                          size_t const limit, std::string const& cursor,
+                          std::string& msg);
+
 Status ReadListDataRequest(const ptree& root, std::string& pattern, bool& regex,
-                           size_t& limit);
+                           size_t& limit, std::string& cursor);
+
+void WriteListDataReply(const ptree& content, std::string const& cursor,
+                        std::string& msg);
+
+Status ReadListDataReply(const ptree& root,
+                         std::unordered_map<ObjectID, ptree>& content,
+                         std::string& cursor);
 
 void WriteCreateDataRequest(const ptree& content, std::string& msg);
 
-Status ReadCreateDataRequest(const ptree& root, ptree& content);
+void WriteCreateDataRequest(const ptree& content, uint64_t const ttl,
+                            std::string& msg);
+
+Status ReadCreateDataRequest(const ptree& root, ptree& content, uint64_t& ttl);
 
 void WriteCreateDataReply(const ObjectID& id, const InstanceID& instance_id,
                           std::string& msg);
@@ -109,7 +242,31 @@ Status ReadCreateDataReply(const ptree& root, ObjectID& id,
 
 void WritePersistRequest(const ObjectID id, std::string& msg);
 
-Status ReadPersistRequest(const ptree& root, ObjectID& id);
+void WritePersistRequest(const ObjectID id, uint64_t const ttl,
+                         std::string& msg);
+
+Status ReadPersistRequest(const ptree& root, ObjectID& id, uint64_t& ttl);
+
+/**
+ * Persist the objects (and their members) in one commit.
+ */
+void WritePersistRequest(const std::vector<ObjectID>& ids, uint64_t const ttl,
+                         std::string& msg);
+
+/**
+ * Persist the objects in write-behind mode if `write_behind` is true, i.e.,
+ * the reply is sent once the objects are persisted in the local metadata,
+ * and the changes are committed to the backend later, see also
+ * `WriteFlushRequest`.
+ */
+void WritePersistRequest(const std::vector<ObjectID>& ids, uint64_t const ttl,
+                         bool const write_behind, std::string& msg);
+
+/**
+ * Accepts the requests of both a single object and multiple objects.
+ */
+Status ReadPersistRequest(const ptree& root, std::vector<ObjectID>& ids,
+                          uint64_t& ttl, bool& write_behind);
 
 void WritePersistReply(std::string& msg);
 
@@ -121,8 +278,93 @@ Status ReadIfPersistRequest(const ptree& root, ObjectID& id);
 
 void WriteIfPersistReply(bool exists, std::string& msg);
 
+/**
+ * The object is durable if it has been persisted and the changes have been
+ * committed to the backend, i.e., not waiting for the write-behind committer.
+ */
+void WriteIfPersistReply(bool persist, bool durable, std::string& msg);
+
 Status ReadIfPersistReply(const ptree& root, bool& persist);
 
+Status ReadIfPersistReply(const ptree& root, bool& persist, bool& durable);
+
+/**
+ * Wait until the write-behind persists that are issued before have been
+ * committed to the backend.
+ */
+void WriteFlushRequest(std::string& msg);
+
+Status ReadFlushRequest(const ptree& root);
+
+void WriteFlushReply(std::string& msg);
+
+Status ReadFlushReply(const ptree& root);
+
+/**
+ * Change the limit of the shared memory of the instance at runtime.
+ */
+void WriteSetMemoryLimitRequest(const size_t limit, std::string& msg);
+
+Status ReadSetMemoryLimitRequest(const ptree& root, size_t& limit);
+
+void WriteSetMemoryLimitReply(std::string& msg);
+
+Status ReadSetMemoryLimitReply(const ptree& root);
+
+/**
+ * Change the quota of the tenant at runtime, 0 means unlimited, and "*" is
+ * the default quota of the tenants that haven't got their own.
+ */
+void WriteSetTenantQuotaRequest(std::string const& tenant, const size_t quota,
+                                std::string& msg);
+
+Status ReadSetTenantQuotaRequest(const ptree& root, std::string& tenant,
+                                 size_t& quota);
+
+void WriteSetTenantQuotaReply(std::string& msg);
+
+Status ReadSetTenantQuotaReply(const ptree& root);
+
+/**
+ * Query the access statistics of the hottest blobs, or the coldest ones if
+ * `hot` is false, at most `limit` of them.
+ */
+void WriteAccessStatsRequest(const bool hot, const size_t limit,
+                             std::string& msg);
+
+Status ReadAccessStatsRequest(const ptree& root, bool& hot, size_t& limit);
+
+void WriteAccessStatsReply(const std::vector<BlobAccess>& blobs,
+                           std::string& msg);
+
+Status ReadAccessStatsReply(const ptree& root, std::vector<BlobAccess>& blobs);
+
+/**
+ * Release the blobs that have been mapped by the client, see also
+ * `Client::Release`.
+ */
+void WriteReleaseRequest(const std::vector<ObjectID>& ids, std::string& msg);
+
+Status ReadReleaseRequest(const ptree& root, std::vector<ObjectID>& ids);
+
+void WriteReleaseReply(std::string& msg);
+
+Status ReadReleaseReply(const ptree& root);
+
+/**
+ * Query the most recent slow requests that are kept by vineyardd, at most
+ * `limit` of them.
+ */
+void WriteSlowRequestsRequest(const size_t limit, std::string& msg);
+
+Status ReadSlowRequestsRequest(const ptree& root, size_t& limit);
+
+void WriteSlowRequestsReply(const std::vector<SlowRequest>& requests,
+                            std::string& msg);
+
+Status ReadSlowRequestsReply(const ptree& root,
+                             std::vector<SlowRequest>& requests);
+
 void WriteExistsRequest(const ObjectID id, std::string& msg);
 
 Status ReadExistsRequest(const ptree& root, ObjectID& id);
@@ -160,9 +402,15 @@ void WriteInstanceStatusReply(const ptree& content, std::string& msg);
 
 Status ReadInstanceStatusReply(const ptree& root, ptree& content);
 
-void WriteCreateBufferRequest(const size_t size, std::string& msg);
+/**
+ * The `alignment` of the blob, 0 means the default alignment of the bulk
+ * store.
+ */
+void WriteCreateBufferRequest(const size_t size, const int numa_node,
+                              const size_t alignment, std::string& msg);
 
-Status ReadCreateBufferRequest(const ptree& root, size_t& size);
+Status ReadCreateBufferRequest(const ptree& root, size_t& size,
+                               int& numa_node, size_t& alignment);
 
 void WriteCreateBufferReply(const ObjectID id,
                             const std::shared_ptr<Payload>& object,
@@ -170,16 +418,80 @@ void WriteCreateBufferReply(const ObjectID id,
 
 Status ReadCreateBufferReply(const ptree& root, ObjectID& id, Payload& object);
 
+/**
+ * Create a blob in the memory of the given CUDA device, the reply is the
+ * same as `WriteCreateBufferReply`.
+ */
+void WriteCreateDeviceBufferRequest(const size_t size, const int device_id,
+                                    std::string& msg);
+
+Status ReadCreateDeviceBufferRequest(const ptree& root, size_t& size,
+                                     int& device_id);
+
+void WriteSplitBufferRequest(const ObjectID id,
+                             const std::vector<size_t>& offsets,
+                             const std::vector<size_t>& sizes,
+                             std::string& msg);
+
+Status ReadSplitBufferRequest(const ptree& root, ObjectID& id,
+                              std::vector<size_t>& offsets,
+                              std::vector<size_t>& sizes);
+
+void WriteSplitBufferReply(const std::vector<ObjectID>& ids, std::string& msg);
+
+Status ReadSplitBufferReply(const ptree& root, std::vector<ObjectID>& ids);
+
 void WriteGetBuffersRequest(const std::unordered_set<ObjectID>& ids,
                             std::string& msg);
 
 Status ReadGetBuffersRequest(const ptree& root, std::vector<ObjectID>& ids);
 
+/**
+ * The `fds` are the store fds that haven't been sent to the client before,
+ * they will be sent after the reply in a single batch, in the given order.
+ */
 void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
-                          std::string& msg);
+                          const std::vector<int>& fds, std::string& msg);
 
 Status ReadGetBuffersReply(const ptree& root,
-                           std::unordered_map<ObjectID, Payload>& objects);
+                           std::unordered_map<ObjectID, Payload>& objects,
+                           std::vector<int>& fds);
+
+void WriteCreateBuffersRequest(const std::vector<size_t>& sizes,
+                               const int numa_node, std::string& msg);
+
+Status ReadCreateBuffersRequest(const ptree& root, std::vector<size_t>& sizes,
+                                int& numa_node);
+
+void WriteCreateBuffersReply(
+    const std::vector<std::shared_ptr<Payload>>& objects,
+    const std::vector<int>& fds, std::string& msg);
+
+Status ReadCreateBuffersReply(const ptree& root, std::vector<ObjectID>& ids,
+                              std::vector<Payload>& objects,
+                              std::vector<int>& fds);
+
+void WriteOpenRingChannelRequest(const size_t capacity, std::string& msg);
+
+Status ReadOpenRingChannelRequest(const ptree& root, size_t& capacity);
+
+/**
+ * The shared memory fd of the rings and the eventfds of the requests and
+ * replies are sent after the reply, in order.
+ */
+void WriteOpenRingChannelReply(const size_t capacity, std::string& msg);
+
+Status ReadOpenRingChannelReply(const ptree& root, size_t& capacity);
+
+/**
+ * Pushed by the server without being requested, to tell the clients that
+ * subscribed during register that the objects have been deleted, thus their
+ * cached metadata should be dropped.
+ */
+void WriteDeletionNotification(const std::vector<ObjectID>& ids,
+                               std::string& msg);
+
+Status ReadDeletionNotification(const ptree& root, std::vector<ObjectID>& ids);
 
 void WritePutNameRequest(const ObjectID object_id, const std::string& name,
                          std::string& msg);
@@ -187,6 +499,18 @@ void WritePutNameRequest(const ObjectID object_id, const std::string& name,
 Status ReadPutNameRequest(const ptree& root, ObjectID& object_id,
                           std::string& name);
 
+/**
+ * Put the names (to objects) in one commit.
+ */
+void WritePutNameRequest(const std::map<std::string, ObjectID>& names,
+                         std::string& msg);
+
+/**
+ * Accepts the requests of both a single name and multiple names.
+ */
+Status ReadPutNameRequest(const ptree& root,
+                          std::map<std::string, ObjectID>& names);
+
 void WritePutNameReply(std::string& msg);
 
 Status ReadPutNameReply(const ptree& root);
@@ -210,7 +534,26 @@ Status ReadDropNameReply(const ptree& root);
 
 void WriteCreateStreamRequest(const ObjectID& object_id, std::string& msg);
 
-Status ReadCreateStreamRequest(const ptree& root, ObjectID& object_id);
+void WriteCreateStreamRequest(const ObjectID& object_id, size_t const depth,
+                              std::string& msg);
+
+void WriteCreateStreamRequest(const ObjectID& object_id, size_t const depth,
+                              size_t const readers, bool const parallel,
+                              std::string& msg);
+
+void WriteCreateStreamRequest(const ObjectID& object_id, size_t const depth,
+                              size_t const readers, bool const parallel,
+                              size_t const retain, std::string& msg);
+
+Status ReadCreateStreamRequest(const ptree& root, ObjectID& object_id,
+                               size_t& depth);
+
+Status ReadCreateStreamRequest(const ptree& root, ObjectID& object_id,
+                               size_t& depth, size_t& readers, bool& parallel);
+
+Status ReadCreateStreamRequest(const ptree& root, ObjectID& object_id,
+                               size_t& depth, size_t& readers, bool& parallel,
+                               size_t& retain);
 
 void WriteCreateStreamReply(std::string& msg);
 
@@ -230,13 +573,135 @@ Status ReadGetNextStreamChunkReply(const ptree& root, Payload& object);
 void WritePullNextStreamChunkRequest(const ObjectID stream_id,
                                      std::string& msg);
 
+void WritePullNextStreamChunkRequest(const ObjectID stream_id,
+                                     const bool inlined, std::string& msg);
+
+/**
+ * The request is replied with `StreamNotReady` at once if there's no chunk
+ * available when `wait` is false.
+ */
+void WritePullNextStreamChunkRequest(const ObjectID stream_id,
+                                     const bool inlined, const bool wait,
+                                     std::string& msg);
+
 Status ReadPullNextStreamChunkRequest(const ptree& root, ObjectID& stream_id);
 
+Status ReadPullNextStreamChunkRequest(const ptree& root, ObjectID& stream_id,
+                                      bool& inlined);
+
+Status ReadPullNextStreamChunkRequest(const ptree& root, ObjectID& stream_id,
+                                      bool& inlined, bool& wait);
+
 void WritePullNextStreamChunkReply(std::shared_ptr<Payload>& object,
                                    std::string& msg);
 
+/**
+ * The chunk is carried by the reply, for the consumers that cannot map the
+ * shared memory, e.g., the RPC clients.
+ */
+void WritePullNextStreamChunkReply(const uint8_t* data, size_t const size,
+                                   std::string& msg);
+
 Status ReadPullNextStreamChunkReply(const ptree& root, Payload& object);
 
+Status ReadPullNextStreamChunkReply(const ptree& root, std::string& chunk);
+
+void WritePushNextStreamChunkRequest(const ObjectID stream_id,
+                                     const uint8_t* data, size_t const size,
+                                     std::string& msg);
+
+Status ReadPushNextStreamChunkRequest(const ptree& root, ObjectID& stream_id,
+                                      std::string& chunk);
+
+void WritePushNextStreamChunkReply(std::string& msg);
+
+Status ReadPushNextStreamChunkReply(const ptree& root);
+
+void WriteOpenStreamNotifierRequest(const ObjectID stream_id,
+                                    std::string& msg);
+
+Status ReadOpenStreamNotifierRequest(const ptree& root, ObjectID& stream_id);
+
+/**
+ * The eventfd of the notifier is sent after the reply.
+ */
+void WriteOpenStreamNotifierReply(std::string& msg);
+
+Status ReadOpenStreamNotifierReply(const ptree& root);
+
+void WriteSeekStreamRequest(const ObjectID stream_id, const size_t offset,
+                            std::string& msg);
+
+Status ReadSeekStreamRequest(const ptree& root, ObjectID& stream_id,
+                             size_t& offset);
+
+void WriteSeekStreamReply(std::string& msg);
+
+Status ReadSeekStreamReply(const ptree& root);
+
+/**
+ * Request the bytes [offset, offset + size) of the blob, which are carried
+ * in the reply, and compressed if the `compression` codec is not empty.
+ */
+void WriteGetRemoteBlobRequest(const ObjectID id, const size_t offset,
+                               const size_t size,
+                               std::string const& compression,
+                               std::string& msg);
+
+Status ReadGetRemoteBlobRequest(const ptree& root, ObjectID& id,
+                                size_t& offset, size_t& size,
+                                std::string& compression);
+
+void WriteGetRemoteBlobReply(const uint8_t* data, size_t const size,
+                             std::string& msg);
+
+Status ReadGetRemoteBlobReply(const ptree& root, std::string& chunk);
+
+/**
+ * Subscribe the objects whose typenames (or names, if `names` is set) match
+ * the glob (or regex) pattern, see also `WriteObjectNotification`.
+ */
+void WriteSubscribeRequest(std::string const& pattern, bool const regex,
+                           bool const names, std::string& msg);
+
+Status ReadSubscribeRequest(const ptree& root, std::string& pattern,
+                            bool& regex, bool& names);
+
+void WriteSubscribeReply(uint64_t const subscription_id, std::string& msg);
+
+Status ReadSubscribeReply(const ptree& root, uint64_t& subscription_id);
+
+void WriteUnsubscribeRequest(uint64_t const subscription_id, std::string& msg);
+
+Status ReadUnsubscribeRequest(const ptree& root, uint64_t& subscription_id);
+
+void WriteUnsubscribeReply(std::string& msg);
+
+Status ReadUnsubscribeReply(const ptree& root);
+
+/**
+ * An object that matches a subscription.
+ */
+struct ObjectEvent {
+  uint64_t subscription_id = 0;
+  ObjectID id = InvalidObjectID();
+  std::string type_name;
+  // the name that has been put, for the subscriptions of names
+  std::string name;
+};
+
+/**
+ * Pushed by the server without being requested, when the objects that match
+ * the subscription have been created (sealed locally, or persisted by other
+ * instances), or the names that match have been put.
+ */
+void WriteObjectNotification(uint64_t const subscription_id,
+                             const std::vector<ObjectEvent>& events,
+                             std::string& msg);
+
+Status ReadObjectNotification(const ptree& root,
+                              std::vector<ObjectEvent>& events);
+
 void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
                             std::string& msg);
 
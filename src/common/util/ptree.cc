@@ -15,24 +15,186 @@ limitations under the License.
 
 #include "common/util/ptree.h"
 
+#include <cctype>
+#include <cstdio>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace vineyard {
 
 template <>
 void print_json_value(std::stringstream& ss, std::string const& value) {
-  ss << "\"" << value << "\"";
+  ss << '"';
+  for (char c : value) {
+    switch (c) {
+    case '"':
+      ss << "\\\"";
+      break;
+    case '\\':
+      ss << "\\\\";
+      break;
+    case '\n':
+      ss << "\\n";
+      break;
+    case '\r':
+      ss << "\\r";
+      break;
+    case '\t':
+      ss << "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char buffer[8];
+        snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+        ss << buffer;
+      } else {
+        ss << c;
+      }
+    }
+  }
+  ss << '"';
 }
 
 template <>
 void print_json_value(std::stringstream& ss, char const& value) {
   ss << '\'';
-  if (value == '\'') {
+  if (value == '\'' || value == '\\') {
     ss << '\\';
   }
   ss << value;
   ss << '\'';
 }
 
+namespace {
+
+void skipSpaces(std::string const& body, size_t& pos) {
+  while (pos < body.size() &&
+         std::isspace(static_cast<unsigned char>(body[pos]))) {
+    ++pos;
+  }
+}
+
+void appendUTF8(std::string& value, unsigned code) {
+  if (code < 0x80) {
+    value.push_back(static_cast<char>(code));
+  } else if (code < 0x800) {
+    value.push_back(static_cast<char>(0xc0 | (code >> 6)));
+    value.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+  } else {
+    value.push_back(static_cast<char>(0xe0 | (code >> 12)));
+    value.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+    value.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+  }
+}
+
+// the strings are quoted by '"', and the chars by '\''
+bool parseQuoted(std::string const& body, size_t& pos, std::string& value) {
+  char const quote = body[pos++];
+  while (pos < body.size()) {
+    char c = body[pos++];
+    if (c == quote) {
+      return true;
+    }
+    if (c != '\\') {
+      value.push_back(c);
+      continue;
+    }
+    if (pos == body.size()) {
+      return false;
+    }
+    c = body[pos++];
+    switch (c) {
+    case 'b':
+      value.push_back('\b');
+      break;
+    case 'f':
+      value.push_back('\f');
+      break;
+    case 'n':
+      value.push_back('\n');
+      break;
+    case 'r':
+      value.push_back('\r');
+      break;
+    case 't':
+      value.push_back('\t');
+      break;
+    case 'u': {
+      if (pos + 4 > body.size()) {
+        return false;
+      }
+      unsigned code = 0;
+      for (size_t end = pos + 4; pos < end; ++pos) {
+        char h = body[pos];
+        if (!std::isxdigit(static_cast<unsigned char>(h))) {
+          return false;
+        }
+        code = code * 16 +
+               (std::isdigit(static_cast<unsigned char>(h))
+                    ? h - '0'
+                    : std::tolower(static_cast<unsigned char>(h)) - 'a' + 10);
+      }
+      appendUTF8(value, code);
+      break;
+    }
+    default:
+      // '"', '\\', '/' and '\''
+      value.push_back(c);
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+bool split_json_array(std::string const& body,
+                      std::vector<std::string>& elements) {
+  size_t pos = 0;
+  skipSpaces(body, pos);
+  if (pos == body.size() || body[pos++] != '[') {
+    return false;
+  }
+  skipSpaces(body, pos);
+  if (pos < body.size() && body[pos] == ']') {
+    ++pos;
+    skipSpaces(body, pos);
+    return pos == body.size();
+  }
+  while (pos < body.size()) {
+    std::string value;
+    if (body[pos] == '"' || body[pos] == '\'') {
+      if (!parseQuoted(body, pos, value)) {
+        return false;
+      }
+    } else {
+      size_t begin = pos;
+      while (pos < body.size() && body[pos] != ',' && body[pos] != ']' &&
+             !std::isspace(static_cast<unsigned char>(body[pos]))) {
+        ++pos;
+      }
+      // nested arrays and objects are left to `read_json`
+      if (pos == begin || body[begin] == '[' || body[begin] == '{') {
+        return false;
+      }
+      value = body.substr(begin, pos - begin);
+    }
+    elements.emplace_back(std::move(value));
+    skipSpaces(body, pos);
+    if (pos == body.size()) {
+      return false;
+    }
+    if (body[pos] == ']') {
+      ++pos;
+      skipSpaces(body, pos);
+      return pos == body.size();
+    }
+    if (body[pos++] != ',') {
+      return false;
+    }
+    skipSpaces(body, pos);
+  }
+  return false;
+}
+
 }  // namespace vineyard
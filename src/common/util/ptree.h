@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "boost/exception/diagnostic_information.hpp"
 
@@ -55,15 +56,35 @@ void put_container(ptree& tree, std::string const& path,
   tree.put(path, ss.str());
 }
 
+/**
+ * @brief Split the JSON array that is written by `put_container` into its
+ * elements in a single pass, the quoted strings are unescaped and the other
+ * elements are kept as is.
+ *
+ * Returns false if the body isn't a flat JSON array.
+ */
+bool split_json_array(std::string const& body,
+                      std::vector<std::string>& elements);
+
 template <typename Container>
 void get_container(ptree const& tree, std::string const& path,
                    Container& container) {
-  // FIXME: parse the JSON array directly
-  ptree body;
-  std::istringstream body_iss(tree.get<std::string>(path));
-  bpt::read_json(body_iss, body);
   using T = typename Container::value_type;
-  for (auto const& kv : body) {
+  std::string const& body = tree.get_child(path).data();
+  std::vector<std::string> elements;
+  if (split_json_array(body, elements)) {
+    // translate the elements in the same way as `ptree::get_value`
+    ptree element;
+    for (auto& item : elements) {
+      element.data() = std::move(item);
+      container.insert(std::end(container), element.get_value<T>());
+    }
+    return;
+  }
+  ptree parsed;
+  std::istringstream body_iss(body);
+  bpt::read_json(body_iss, parsed);
+  for (auto const& kv : parsed) {
     container.insert(std::end(container), kv.second.get_value<T>());
   }
 }
@@ -137,6 +137,9 @@ std::string Status::CodeAsString() const {
   case StatusCode::kInvalidStreamState:
     type = "Invalid stream state";
     break;
+  case StatusCode::kStreamNotReady:
+    type = "Stream not ready";
+    break;
   case StatusCode::kUserInputError:
     type = "User input error";
     break;
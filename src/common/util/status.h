@@ -166,6 +166,7 @@ enum class StatusCode : unsigned char {
   kStreamDrained = 42,
   kStreamFailed = 43,
   kInvalidStreamState = 44,
+  kStreamNotReady = 45,
 
   kUserInputError = 51,
 
@@ -382,6 +383,13 @@ class VINEYARD_MUST_USE_TYPE Status {
     return Status(StatusCode::kInvalidStreamState, error_message);
   }
 
+  /// Return a status code that indicates there's no chunk available yet in
+  /// the stream, for the readers that don't wait for the chunks.
+  static Status StreamNotReady() {
+    return Status(StatusCode::kStreamNotReady,
+                  "Stream not ready: no chunk available yet");
+  }
+
   /// Return a status code indicates invalid user input.
   static Status UserInputError(std::string const& message = "") {
     return Status(StatusCode::kUserInputError, message);
@@ -466,6 +474,10 @@ class VINEYARD_MUST_USE_TYPE Status {
   bool IsInvalidStreamState() const {
     return code() == StatusCode::kInvalidStreamState;
   }
+  /// Return true iff there's no chunk available yet in the stream.
+  bool IsStreamNotReady() const {
+    return code() == StatusCode::kStreamNotReady;
+  }
   /// Return true iff there's some problems in user's input.
   bool IsUserInputError() const {
     return code() == StatusCode::kUserInputError;
@@ -0,0 +1,290 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/util/trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace vineyard {
+
+namespace trace {
+
+namespace {
+
+thread_local Context current_context;
+
+std::string toHex(uint64_t const value) {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx",
+           static_cast<unsigned long long>(value));  // NOLINT(runtime/int)
+  return std::string(buffer, 16);
+}
+
+void writeEscaped(std::ostream& os, std::string const& value) {
+  os << '"';
+  for (char c : value) {
+    switch (c) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    case '\n':
+      os << "\\n";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char buffer[8];
+        snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+        os << buffer;
+      } else {
+        os << c;
+      }
+    }
+  }
+  os << '"';
+}
+
+int64_t nowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+std::string Context::ToString() const {
+  return toHex(trace_id) + "-" + toHex(span_id);
+}
+
+Context Context::FromString(std::string const& value) {
+  Context context;
+  auto pos = value.find('-');
+  if (pos == std::string::npos) {
+    return context;
+  }
+  try {
+    context.trace_id = std::stoull(value.substr(0, pos), nullptr, 16);
+    context.span_id = std::stoull(value.substr(pos + 1), nullptr, 16);
+  } catch (std::exception const&) {
+    return Context();
+  }
+  return context;
+}
+
+Tracer::Tracer() {
+  // the clients are configured by the environment variables
+  const char* rate = std::getenv("VINEYARD_TRACE_SAMPLE_RATE");
+  const char* capacity = std::getenv("VINEYARD_TRACE_BUFFER_SIZE");
+  if (rate != nullptr) {
+    Configure("vineyard-client", std::atof(rate),
+              capacity == nullptr ? 8192
+                                  : std::strtoull(capacity, nullptr, 10));
+  }
+}
+
+Tracer& Tracer::Global() {
+  static Tracer tracer;
+  return tracer;
+}
+
+void Tracer::Configure(std::string const& service, double const sample_rate,
+                       size_t const capacity) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  service_ = service;
+  capacity_ = capacity;
+  spans_.clear();
+  spans_.shrink_to_fit();
+  next_ = 0;
+  double rate = std::min(std::max(sample_rate, 0.0), 1.0);
+  threshold_.store(
+      rate >= 1.0 ? std::numeric_limits<uint64_t>::max()
+                  : static_cast<uint64_t>(
+                        rate * std::numeric_limits<uint64_t>::max()),
+      std::memory_order_relaxed);
+  enabled_.store(capacity > 0, std::memory_order_relaxed);
+}
+
+Context Tracer::Sample() {
+  Context context;
+  uint64_t threshold = threshold_.load(std::memory_order_relaxed);
+  if (!Enabled() || threshold == 0) {
+    return context;
+  }
+  uint64_t id = NewID();
+  if (id <= threshold) {
+    context.trace_id = id;
+  }
+  return context;
+}
+
+void Tracer::Record(SpanRecord&& span) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (capacity_ == 0) {
+    return;
+  }
+  if (spans_.size() < capacity_) {
+    spans_.emplace_back(std::move(span));
+  } else {
+    spans_[next_] = std::move(span);
+    next_ = (next_ + 1) % capacity_;
+  }
+}
+
+void Tracer::Dump(std::ostream& os) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  os << "[";
+  for (size_t index = 0; index < spans_.size(); ++index) {
+    // from the oldest one
+    auto const& span = spans_[(next_ + index) % spans_.size()];
+    os << (index == 0 ? "" : ",") << "{\"traceId\":\"" << toHex(span.trace_id)
+       << "\",\"id\":\"" << toHex(span.span_id) << "\"";
+    if (span.parent_id != 0) {
+      os << ",\"parentId\":\"" << toHex(span.parent_id) << "\"";
+    }
+    os << ",\"name\":";
+    writeEscaped(os, span.name);
+    if (!span.kind.empty()) {
+      os << ",\"kind\":\"" << span.kind << "\"";
+    }
+    os << ",\"timestamp\":" << span.timestamp
+       << ",\"duration\":" << std::max<int64_t>(span.duration, 1)
+       << ",\"localEndpoint\":{\"serviceName\":";
+    writeEscaped(os, service_);
+    os << "}";
+    if (!span.tags.empty()) {
+      os << ",\"tags\":{";
+      for (size_t tag = 0; tag < span.tags.size(); ++tag) {
+        os << (tag == 0 ? "" : ",");
+        writeEscaped(os, span.tags[tag].first);
+        os << ":";
+        writeEscaped(os, span.tags[tag].second);
+      }
+      os << "}";
+    }
+    os << "}";
+  }
+  os << "]";
+}
+
+size_t Tracer::Size() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return spans_.size();
+}
+
+void Tracer::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  spans_.clear();
+  next_ = 0;
+}
+
+uint64_t Tracer::NewID() {
+  thread_local std::mt19937_64 engine(
+      std::random_device{}() ^
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+  uint64_t id = 0;
+  while (id == 0) {
+    id = engine();
+  }
+  return id;
+}
+
+Context Current() { return current_context; }
+
+Span::Span(std::string const& name, Context const& parent,
+           std::string const& kind)
+    : Span(name, parent, kind, std::chrono::steady_clock::now()) {}
+
+Span::Span(std::string const& name, Context const& parent,
+           std::string const& kind,
+           std::chrono::steady_clock::time_point const start) {
+  if (!parent.sampled() || !Tracer::Global().Enabled()) {
+    return;
+  }
+  context_.trace_id = parent.trace_id;
+  context_.span_id = Tracer::NewID();
+  parent_id_ = parent.span_id;
+  name_ = name;
+  kind_ = kind;
+  start_ = start;
+}
+
+Span& Span::operator=(Span&& other) {
+  if (this != &other) {
+    Finish();
+    context_ = other.context_;
+    parent_id_ = other.parent_id_;
+    name_ = std::move(other.name_);
+    kind_ = std::move(other.kind_);
+    start_ = other.start_;
+    tags_ = std::move(other.tags_);
+    other.context_ = Context();
+  }
+  return *this;
+}
+
+void Span::Tag(std::string const& key, std::string const& value) {
+  if (active()) {
+    tags_.emplace_back(key, value);
+  }
+}
+
+void Span::Finish() {
+  if (!active()) {
+    return;
+  }
+  SpanRecord span;
+  span.trace_id = context_.trace_id;
+  span.span_id = context_.span_id;
+  span.parent_id = parent_id_;
+  span.name = std::move(name_);
+  span.kind = std::move(kind_);
+  span.duration = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - start_)
+                      .count();
+  span.timestamp = nowMicros() - span.duration;
+  span.tags = std::move(tags_);
+  Tracer::Global().Record(std::move(span));
+  context_ = Context();
+}
+
+Span StartSpan(std::string const& name, std::string const& kind) {
+  auto& tracer = Tracer::Global();
+  if (!tracer.Enabled()) {
+    return Span();
+  }
+  Context parent = Current();
+  if (!parent.sampled()) {
+    parent = tracer.Sample();
+  }
+  return Span(name, parent, kind);
+}
+
+Scope::Scope(Context const& context) : previous_(current_context) {
+  current_context = context;
+}
+
+Scope::~Scope() { current_context = previous_; }
+
+}  // namespace trace
+
+}  // namespace vineyard
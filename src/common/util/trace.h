@@ -0,0 +1,196 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_UTIL_TRACE_H_
+#define SRC_COMMON_UTIL_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vineyard {
+
+namespace trace {
+
+/**
+ * @brief The context of a span that is propagated to its children, e.g.,
+ * from the client to vineyardd within the request messages, see also
+ * `TraceMessage`. An empty context (trace id 0) is not sampled.
+ */
+struct Context {
+  uint64_t trace_id = 0;
+  uint64_t span_id = 0;
+
+  bool sampled() const { return trace_id != 0; }
+
+  /** In the form of "<trace id>-<span id>", both are 16 hex digits. */
+  std::string ToString() const;
+
+  static Context FromString(std::string const& value);
+};
+
+/** A finished span. */
+struct SpanRecord {
+  uint64_t trace_id;
+  uint64_t span_id;
+  uint64_t parent_id;
+  std::string name;
+  // "CLIENT", "SERVER" or empty for local spans
+  std::string kind;
+  // since the epoch, in microseconds
+  int64_t timestamp;
+  int64_t duration;
+  std::vector<std::pair<std::string, std::string>> tags;
+};
+
+/**
+ * @brief Tracer keeps the finished spans of this process in a ring buffer,
+ * the oldest spans are overwritten when it is full.
+ *
+ * Tracing is disabled until the tracer is configured with a non-zero
+ * capacity, and new traces are started at the rate of `sample_rate`, thus
+ * the cost on the hot path is a single relaxed load when it's disabled or
+ * the request isn't sampled.
+ *
+ * The client side is configured by the environment variables
+ * `VINEYARD_TRACE_SAMPLE_RATE` and `VINEYARD_TRACE_BUFFER_SIZE`, and
+ * vineyardd by the `--trace_sample_rate` and `--trace_buffer_size` flags.
+ */
+class Tracer {
+ public:
+  static Tracer& Global();
+
+  void Configure(std::string const& service, double const sample_rate,
+                 size_t const capacity);
+
+  bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Start a new trace with the sample rate, the returned context is
+   * empty if it isn't sampled.
+   */
+  Context Sample();
+
+  void Record(SpanRecord&& span);
+
+  /**
+   * @brief The finished spans in the Zipkin v2 JSON format, which can be
+   * posted to Jaeger (or Zipkin) at `/api/v2/spans` as is.
+   */
+  void Dump(std::ostream& os) const;
+
+  /** How many spans are kept in the buffer. */
+  size_t Size() const;
+
+  void Clear();
+
+  static uint64_t NewID();
+
+ private:
+  Tracer();
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> threshold_{0};
+  std::string service_;
+  mutable std::mutex mutex_;
+  std::vector<SpanRecord> spans_;
+  size_t capacity_ = 0;
+  // the next slot to write when the buffer is full
+  size_t next_ = 0;
+};
+
+/**
+ * @brief The context of the current thread, which is set by `Scope`.
+ */
+Context Current();
+
+/**
+ * @brief Span is started on construction and finished (and recorded) on
+ * `Finish` or destruction, it's a no-op unless the parent is sampled.
+ */
+class Span {
+ public:
+  Span() = default;
+
+  Span(std::string const& name, Context const& parent,
+       std::string const& kind = "");
+
+  /**
+   * @brief A span with the given start time, for the operations that are
+   * known to be sampled only after they have begun, e.g., a request that
+   * carries the context.
+   */
+  Span(std::string const& name, Context const& parent, std::string const& kind,
+       std::chrono::steady_clock::time_point const start);
+
+  ~Span() { Finish(); }
+
+  Span(Span&& other) { *this = std::move(other); }
+
+  Span& operator=(Span&& other);
+
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  bool active() const { return context_.sampled(); }
+
+  /** The context for the children of this span. */
+  Context const& context() const { return context_; }
+
+  void Tag(std::string const& key, std::string const& value);
+
+  void Finish();
+
+ private:
+  Context context_;
+  uint64_t parent_id_ = 0;
+  std::string name_, kind_;
+  std::chrono::steady_clock::time_point start_;
+  std::vector<std::pair<std::string, std::string>> tags_;
+};
+
+/**
+ * @brief Start a span as a child of the current context, or as the root of
+ * a new trace if it's sampled.
+ */
+Span StartSpan(std::string const& name, std::string const& kind = "");
+
+/**
+ * @brief Scope sets the context of the current thread during its lifetime,
+ * the spans of the (synchronous) callees are children of it.
+ */
+class Scope {
+ public:
+  explicit Scope(Context const& context);
+
+  ~Scope();
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  Context previous_;
+};
+
+}  // namespace trace
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_UTIL_TRACE_H_
@@ -20,11 +20,63 @@ limitations under the License.
 
 #include "common/util/uuid.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 
 namespace vineyard {
 
+namespace {
+
+constexpr uint64_t kObjectIDTag = 0x4000000000000000UL;
+constexpr int kObjectIDInstanceShift = 52;
+constexpr uint64_t kObjectIDMaxInstance = 0x3FFUL;
+constexpr uint64_t kObjectIDSequenceMask = (1UL << kObjectIDInstanceShift) - 1;
+// the sequence numbers that a thread takes from the counter at a time
+constexpr uint64_t kObjectIDSequenceBlock = 256;
+
+std::atomic<InstanceID> object_id_instance{UnspecifiedInstanceID()};
+
+std::atomic<uint64_t>& objectIDSequence() {
+  // 2020-01-01T00:00:00Z
+  static constexpr int64_t kEpoch = 1577836800;
+  static std::atomic<uint64_t> sequence{static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count() -
+      kEpoch * 1000000)};
+  return sequence;
+}
+
+}  // namespace
+
+void SetObjectIDInstance(InstanceID const instance_id) {
+  object_id_instance.store(instance_id, std::memory_order_relaxed);
+}
+
+ObjectID GenerateObjectID() {
+  InstanceID instance = object_id_instance.load(std::memory_order_relaxed);
+  if (instance > kObjectIDMaxInstance) {
+    return 0x7FFFFFFFFFFFFFFFUL & static_cast<uint64_t>(__rdtsc());
+  }
+  thread_local uint64_t next = 0, end = 0;
+  if (next == end) {
+    next = objectIDSequence().fetch_add(kObjectIDSequenceBlock,
+                                        std::memory_order_relaxed);
+    end = next + kObjectIDSequenceBlock;
+  }
+  uint64_t sequence = (next++) & kObjectIDSequenceMask;
+  return kObjectIDTag | (instance << kObjectIDInstanceShift) | sequence;
+}
+
+InstanceID ObjectIDInstance(ObjectID const id) {
+  if (IsBlob(id) || !(id & kObjectIDTag)) {
+    return UnspecifiedInstanceID();
+  }
+  return (id >> kObjectIDInstanceShift) & kObjectIDMaxInstance;
+}
+
 const std::string VYObjectIDToString(const ObjectID id) {
   char buffer[17] = {'\0'};
   std::snprintf(buffer, sizeof(buffer), "%016" PRIx64, id);
@@ -38,7 +38,8 @@ using ObjectID = uint64_t;
 using InstanceID = uint64_t;
 
 // blob id: 1 + memory address (in vineyardd)
-// non-blob id: 0 + random (rdstc)
+// non-blob id: 0 + 1 + instance (10 bits) + sequence (52 bits)
+// non-blob id (legacy, and for the instances beyond 10 bits): 0 + rdtsc
 
 inline void* GetBlobAddr(ObjectID const id) {
   return (id & 0x8000000000000000UL)
@@ -52,12 +53,35 @@ inline ObjectID GenerateBlobID(const void* ptr) {
 
 constexpr inline ObjectID EmptyBlobID() { return 0x8000000000000000UL; }
 
-inline ObjectID GenerateObjectID() {
-  return 0x7FFFFFFFFFFFFFFFUL & static_cast<uint64_t>(__rdtsc());
-}
-
 inline bool IsBlob(ObjectID id) { return id & 0x8000000000000000UL; }
 
+/**
+ * @brief Set the instance that is embedded into the object IDs generated by
+ * this process from now on, see also `GenerateObjectID`.
+ */
+void SetObjectIDInstance(InstanceID const instance_id);
+
+/**
+ * @brief Generate a non-blob object ID, which embeds the instance that is
+ * set by `SetObjectIDInstance` and a sequence number. The sequence is
+ * allocated in blocks from a process-wide counter, thus the IDs never
+ * collide within the process, and the counter starts from the microseconds
+ * since 2020, thus a restarted instance doesn't reuse the IDs of its former
+ * run, unless that run has allocated more than a million IDs per second on
+ * average.
+ *
+ * Before the instance is set, or if it doesn't fit in 10 bits, the ID is
+ * generated from `__rdtsc()` as before.
+ */
+ObjectID GenerateObjectID();
+
+/**
+ * @brief The instance that generated the (non-blob) object ID, or
+ * `UnspecifiedInstanceID()` if it is unknown, e.g., for blobs and the legacy
+ * IDs.
+ */
+InstanceID ObjectIDInstance(ObjectID const id);
+
 const std::string VYObjectIDToString(const ObjectID id);
 
 ObjectID VYObjectIDFromString(const std::string& s);
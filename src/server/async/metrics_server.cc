@@ -0,0 +1,146 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/async/metrics_server.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "common/util/boost.h"
+#include "common/util/logging.h"
+#include "common/util/trace.h"
+
+namespace vineyard {
+
+namespace {
+
+class MetricsSession : public std::enable_shared_from_this<MetricsSession> {
+ public:
+  MetricsSession(asio::ip::tcp::socket socket, vs_ptr_t vs_ptr)
+      : socket_(std::move(socket)), vs_ptr_(vs_ptr) {}
+
+  void Start() {
+    auto self(shared_from_this());
+    asio::async_read_until(
+        socket_, request_, "\r\n\r\n",
+        [this, self](boost::system::error_code ec, std::size_t) {
+          if (ec) {
+            return;
+          }
+          std::istream is(&request_);
+          std::string method, path;
+          is >> method >> path;
+          if (method == "GET" &&
+              (path == "/traces" || path.find("/traces?") == 0)) {
+            // the finished spans, in the Zipkin v2 JSON format
+            std::ostringstream os;
+            trace::Tracer::Global().Dump(os);
+            doReply("200 OK", os.str(), "application/json");
+            return;
+          }
+          if (method != "GET" ||
+              (path != "/metrics" && path.find("/metrics?") != 0)) {
+            doReply("404 Not Found", "not found\n");
+            return;
+          }
+          auto status = vs_ptr_->InstanceStatus(
+              [self](const Status& status, const ptree& instance_status) {
+                std::ostringstream os;
+                self->vs_ptr_->GetMetrics().DumpPrometheus(instance_status,
+                                                           os);
+                self->doReply("200 OK", os.str());
+                return Status::OK();
+              });
+          if (!status.ok()) {
+            doReply("503 Service Unavailable", status.ToString() + "\n");
+          }
+        });
+  }
+
+ private:
+  void doReply(std::string const& code, std::string const& body,
+               std::string const& content_type =
+                   "text/plain; version=0.0.4") {
+    std::ostringstream os;
+    os << "HTTP/1.1 " << code << "\r\n"
+       << "Content-Type: " << content_type << "\r\n"
+       << "Content-Length: " << body.size() << "\r\n"
+       << "Connection: close\r\n\r\n"
+       << body;
+    reply_ = os.str();
+    auto self(shared_from_this());
+    asio::async_write(socket_, asio::buffer(reply_),
+                      [this, self](boost::system::error_code, std::size_t) {
+                        boost::system::error_code ec;
+                        socket_.shutdown(asio::ip::tcp::socket::shutdown_both,
+                                         ec);
+                        socket_.close(ec);
+                      });
+  }
+
+  asio::ip::tcp::socket socket_;
+  vs_ptr_t vs_ptr_;
+  asio::streambuf request_;
+  std::string reply_;
+};
+
+}  // namespace
+
+MetricsServer::MetricsServer(vs_ptr_t vs_ptr)
+    : vs_ptr_(vs_ptr),
+      port_(vs_ptr_->GetSpec().get<uint32_t>("metrics_port", 0)),
+      acceptor_(vs_ptr_->GetIOContext()) {
+  auto endpoint = asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port_);
+  acceptor_.open(endpoint.protocol());
+  acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+  acceptor_.bind(endpoint);
+  acceptor_.listen();
+}
+
+MetricsServer::~MetricsServer() { Stop(); }
+
+void MetricsServer::Start() {
+  doAccept();
+  LOG(INFO) << "Vineyard will export metrics on 0.0.0.0:" << port_
+            << "/metrics (and the traces on /traces)";
+}
+
+void MetricsServer::Stop() {
+  if (acceptor_.is_open()) {
+    boost::system::error_code ec;
+    acceptor_.close(ec);
+  }
+}
+
+void MetricsServer::doAccept() {
+  if (!acceptor_.is_open()) {
+    return;
+  }
+  acceptor_.async_accept(
+      [this](boost::system::error_code ec, asio::ip::tcp::socket socket) {
+        if (ec == asio::error::operation_aborted) {
+          return;
+        }
+        if (!ec) {
+          std::make_shared<MetricsSession>(std::move(socket), vs_ptr_)
+              ->Start();
+        }
+        doAccept();
+      });
+}
+
+}  // namespace vineyard
@@ -0,0 +1,56 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_ASYNC_METRICS_SERVER_H_
+#define SRC_SERVER_ASYNC_METRICS_SERVER_H_
+
+#include <memory>
+#include <string>
+
+#include "boost/asio.hpp"
+
+#include "server/server/vineyard_server.h"
+
+namespace vineyard {
+
+namespace asio = boost::asio;
+
+/**
+ * @brief MetricsServer serves the metrics of vineyardd over HTTP, in the
+ * Prometheus text exposition format, at "/metrics".
+ *
+ * Every connection serves a single request and then be closed.
+ */
+class MetricsServer {
+ public:
+  explicit MetricsServer(vs_ptr_t vs_ptr);
+
+  ~MetricsServer();
+
+  void Start();
+
+  void Stop();
+
+ private:
+  void doAccept();
+
+  vs_ptr_t vs_ptr_;
+  uint32_t port_;
+  asio::ip::tcp::acceptor acceptor_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_ASYNC_METRICS_SERVER_H_
@@ -47,14 +47,23 @@ RPCServer::~RPCServer() {
 
 void RPCServer::Start() {
   SocketServer::Start();
-  LOG(INFO) << "Vineyard will listen on 0.0.0.0:"
-            << rpc_spec_.get<uint32_t>("port") << " for RPC";
+  std::string host = rpc_spec_.get<std::string>("host", "");
+  LOG(INFO) << "Vineyard will listen on " << (host.empty() ? "0.0.0.0" : host)
+            << ":" << rpc_spec_.get<uint32_t>("port") << " for RPC";
   vs_ptr_->RPCReady();
 }
 
 asio::ip::tcp::endpoint RPCServer::getEndpoint(asio::io_context&) {
   uint32_t port = rpc_spec_.get<uint32_t>("port");
-  return asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port);
+  std::string host = rpc_spec_.get<std::string>("host", "");
+  if (host.empty()) {
+    return asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port);
+  }
+#if BOOST_VERSION >= 106600
+  return asio::ip::tcp::endpoint(asio::ip::make_address(host), port);
+#else
+  return asio::ip::tcp::endpoint(asio::ip::address::from_string(host), port);
+#endif
 }
 
 void RPCServer::doAccept() {
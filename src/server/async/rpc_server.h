@@ -40,9 +40,13 @@ class RPCServer : public SocketServer {
   void Start() override;
 
   std::string Endpoint() {
-    char hostname[MAXHOSTNAMELEN];
-    gethostname(hostname, MAXHOSTNAMELEN);
-    return std::string(hostname) + ":" + rpc_spec_.get<std::string>("port");
+    std::string host = rpc_spec_.get<std::string>("host", "");
+    if (host.empty()) {
+      char hostname[MAXHOSTNAMELEN];
+      gethostname(hostname, MAXHOSTNAMELEN);
+      host = hostname;
+    }
+    return host + ":" + rpc_spec_.get<std::string>("port");
   }
 
  private:
@@ -15,6 +15,13 @@ limitations under the License.
 
 #include "server/async/socket_server.h"
 
+#include <fnmatch.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -23,9 +30,21 @@ limitations under the License.
 #include "common/memory/fling.h"
 #include "common/util/boost.h"
 #include "common/util/callback.h"
+#include "common/util/compression.h"
 
 namespace vineyard {
 
+namespace {
+
+// the sessions of the connections that don't tell their tenants, which are
+// unique across the IPC and RPC servers.
+std::atomic<uint64_t> next_session{0};
+
+}  // namespace
+
+constexpr size_t SocketConnection::kReadBufferSize;
+constexpr size_t SocketConnection::kMaxGatheredWrites;
+
 SocketConnection::SocketConnection(stream_protocol::socket socket,
                                    vs_ptr_t server_ptr,
                                    SocketServer* socket_server_ptr, int conn_id)
@@ -33,11 +52,19 @@ SocketConnection::SocketConnection(stream_protocol::socket socket,
       server_ptr_(server_ptr),
       socket_server_ptr_(socket_server_ptr),
       conn_id_(conn_id),
-      running_(false) {}
+      strand_(server_ptr->GetIOContext().get_executor()),
+      running_(false),
+      binary_protocol_(false),
+      deletion_notification_(false),
+      tenant_("session-" + std::to_string(next_session++)),
+      writing_msgs_(0),
+      read_buffer_(kReadBufferSize),
+      read_begin_(0),
+      read_end_(0) {}
 
 void SocketConnection::Start() {
   running_ = true;
-  doReadHeader();
+  doRead();
 }
 
 void SocketConnection::Stop() {
@@ -45,40 +72,130 @@ void SocketConnection::Stop() {
   running_ = false;
 }
 
-void SocketConnection::doReadHeader() {
-  auto self(this->shared_from_this());
-  asio::async_read(socket_, asio::buffer(&read_msg_header_, sizeof(size_t)),
-                   [this, self](boost::system::error_code ec, std::size_t) {
-                     if (!ec && running_) {
-                       doReadBody();
-                     } else {
-                       doStop();
-                       socket_server_ptr_->RemoveConnection(conn_id_);
-                       return;
-                     }
-                   });
-}
-
-void SocketConnection::doReadBody() {
-  read_msg_body_.resize(read_msg_header_);
+void SocketConnection::NotifyDeletion(std::vector<ObjectID> const& ids) {
   auto self(shared_from_this());
-  asio::async_read(socket_, asio::buffer(&read_msg_body_[0], read_msg_header_),
-                   [this, self](boost::system::error_code ec, std::size_t) {
-                     if ((!ec || ec == asio::error::eof) && running_) {
-                       bool exit = processMessage(read_msg_body_);
-                       if (exit || ec == asio::error::eof) {
-                         doStop();
-                         socket_server_ptr_->RemoveConnection(conn_id_);
-                         return;
-                       }
-                     } else {
-                       doStop();
-                       socket_server_ptr_->RemoveConnection(conn_id_);
-                       return;
-                     }
-                     // start next-round read
-                     doReadHeader();
-                   });
+  asio::post(strand_, [this, self, ids]() {
+    if (!deletion_notification_ || !running_) {
+      return;
+    }
+    std::vector<ObjectID> deleted;
+    for (auto const& id : ids) {
+      if (tracked_objects_.erase(id)) {
+        deleted.emplace_back(id);
+      }
+    }
+    if (!deleted.empty()) {
+      std::string message_out;
+      WriteDeletionNotification(deleted, message_out);
+      writeMessage(std::move(message_out), nullptr);
+    }
+  });
+}
+
+void SocketConnection::NotifySubscribers(
+    std::vector<ObjectEvent> const& events) {
+  auto self(shared_from_this());
+  asio::post(strand_, [this, self, events]() {
+    if (subscriptions_.empty() || !running_) {
+      return;
+    }
+    for (auto const& item : subscriptions_) {
+      auto const& subscription = item.second;
+      std::vector<ObjectEvent> matched;
+      for (auto const& event : events) {
+        if (subscription.names) {
+          if (!event.name.empty() && subscription.Match(event.name)) {
+            matched.emplace_back(event);
+          }
+        } else if (event.name.empty() && subscription.Match(event.type_name)) {
+          matched.emplace_back(event);
+        }
+      }
+      if (!matched.empty()) {
+        std::string message_out;
+        WriteObjectNotification(item.first, matched, message_out);
+        writeMessage(std::move(message_out), nullptr);
+      }
+    }
+  });
+}
+
+bool SocketConnection::Subscription::Match(std::string const& value) const {
+  if (regex) {
+    return std::regex_match(value, compiled);
+  }
+  return fnmatch(pattern.c_str(), value.c_str(), 0) == 0;
+}
+
+void SocketConnection::trackObjects(std::vector<ObjectID> const& ids) {
+  auto self(shared_from_this());
+  asio::dispatch(strand_, [this, self, ids]() {
+    if (deletion_notification_) {
+      tracked_objects_.insert(ids.begin(), ids.end());
+    }
+  });
+}
+
+void SocketConnection::doRead() {
+  auto self(this->shared_from_this());
+  socket_.async_read_some(
+      asio::buffer(read_buffer_.data() + read_end_,
+                   read_buffer_.size() - read_end_),
+      asio::bind_executor(strand_, [this, self](boost::system::error_code ec,
+                                                std::size_t size) {
+        if ((!ec || ec == asio::error::eof) && running_) {
+          read_at_ = std::chrono::steady_clock::now();
+          read_end_ += size;
+          if (!processReadBuffer() || ec == asio::error::eof) {
+            doStop();
+            socket_server_ptr_->RemoveConnection(conn_id_);
+            return;
+          }
+        } else {
+          doStop();
+          socket_server_ptr_->RemoveConnection(conn_id_);
+          return;
+        }
+        // start next-round read
+        doRead();
+      }));
+}
+
+bool SocketConnection::processReadBuffer() {
+  while (running_ && read_end_ - read_begin_ >= sizeof(size_t)) {
+    size_t length = 0;
+    memcpy(&length, read_buffer_.data() + read_begin_, sizeof(size_t));
+    if (read_end_ - read_begin_ - sizeof(size_t) < length) {
+      break;
+    }
+    const char* body = read_buffer_.data() + read_begin_ + sizeof(size_t);
+    read_begin_ += sizeof(size_t) + length;
+    if (processMessage(std::string(body, length))) {
+      return false;
+    }
+  }
+  if (!running_) {
+    return false;
+  }
+  // move the incomplete message to the front, and make sure it fits.
+  size_t remaining = read_end_ - read_begin_;
+  if (read_begin_ > 0) {
+    memmove(read_buffer_.data(), read_buffer_.data() + read_begin_, remaining);
+    read_begin_ = 0;
+    read_end_ = remaining;
+  }
+  size_t required = kReadBufferSize;
+  if (remaining >= sizeof(size_t)) {
+    size_t length = 0;
+    memcpy(&length, read_buffer_.data(), sizeof(size_t));
+    required = std::max(required, sizeof(size_t) + length);
+  }
+  if (read_buffer_.size() != required) {
+    // shrink the buffer once the large message has been consumed
+    read_buffer_.resize(std::max(required, remaining));
+    read_buffer_.shrink_to_fit();
+  }
+  return true;
 }
 
 #ifndef TRY_READ_REQUEST
@@ -88,7 +205,7 @@ void SocketConnection::doReadBody() {
     if (!read_status.ok()) {                           \
       std::string error_message_out;                   \
       WriteErrorReply(read_status, error_message_out); \
-      self->doWrite(error_message_out);                \
+      self->doWrite(error_message_out, request);       \
       return false;                                    \
     }                                                  \
   } while (0)
@@ -103,37 +220,69 @@ void SocketConnection::doReadBody() {
                  << exec_status.ToString();                             \
       std::string error_message_out;                                    \
       WriteErrorReply(exec_status, error_message_out);                  \
-      self->doWrite(error_message_out);                                 \
+      self->doWrite(error_message_out, request);                        \
       return false;                                                     \
     }                                                                   \
   } while (0)
 #endif  // RESPONSE_ON_ERROR
 
 bool SocketConnection::processMessage(const std::string& message_in) {
+  auto received = std::chrono::steady_clock::now();
+  server_ptr_->GetMetrics().AddBytesIn(message_in.size());
   ptree root;
-  std::istringstream is(message_in);
 
   // DON'T let vineyardd crash when the client is malicious.
-  try {
-    bpt::read_json(is, root);
-  } catch (bpt::ptree_error const& err) {
-    LOG(ERROR) << "ptree: " << err.what();
+  auto decode_status = DecodeMessage(message_in, root);
+  if (!decode_status.ok()) {
+    LOG(ERROR) << decode_status.ToString();
     std::string message_out;
-    WriteErrorReply(Status::Invalid(err.what()), message_out);
+    WriteErrorReply(decode_status, message_out);
     this->doWrite(message_out);
     return false;
   }
 
   std::string type = root.get<std::string>("type");
   CommandType cmd = ParseCommandType(type);
+  // the tag of pipelined requests is echoed in replies
+  RequestContext request{GetMessageTag(root), cmd, received, nullptr,
+                         message_in.size(), nullptr,
+                         server_ptr_->GetMetrics().TrackRequest()};
+  auto& tracer = trace::Tracer::Global();
+  if (tracer.Enabled()) {
+    trace::Context parent = GetMessageTrace(root);
+    if (!parent.sampled()) {
+      parent = tracer.Sample();
+    }
+    if (parent.sampled()) {
+      request.span =
+          std::make_shared<trace::Span>(type, parent, "SERVER", received);
+    }
+  }
+  // the spans of the (synchronous) handling are children of the request
+  trace::Scope scope(request.span ? request.span->context()
+                                  : trace::Context());
+  if (server_ptr_->GetSlowRequests().Enabled()) {
+    request.stats = std::make_shared<RequestStats>();
+    if (read_at_ < received) {
+      request.stats->read_us =
+          std::chrono::duration_cast<std::chrono::microseconds>(received -
+                                                                read_at_)
+              .count();
+    }
+  }
+  RequestStats::Scope stats_scope(request.stats);
   auto self(shared_from_this());
   switch (cmd) {
   case CommandType::RegisterRequest: {
-    std::string message_out;
-    TRY_READ_REQUEST(ReadRegisterRequest(root));
+    std::string message_out, tenant;
+    TRY_READ_REQUEST(ReadRegisterRequest(root, binary_protocol_,
+                                         deletion_notification_, tenant));
+    if (!tenant.empty()) {
+      tenant_ = tenant;
+    }
     WriteRegisterReply(server_ptr_->IPCSocket(), server_ptr_->RPCEndpoint(),
                        server_ptr_->instance_id(), message_out);
-    doWrite(message_out);
+    doWrite(message_out, request);
   } break;
   case CommandType::GetBuffersRequest: {
     std::vector<ObjectID> ids;
@@ -143,7 +292,15 @@ bool SocketConnection::processMessage(const std::string& message_in) {
     TRY_READ_REQUEST(ReadGetBuffersRequest(root, ids));
     RESPONSE_ON_ERROR(
         server_ptr_->GetBulkStore()->ProcessGetRequest(ids, objects));
-    WriteGetBuffersReply(objects, message_out);
+    if (server_ptr_->GetDeviceStore()->Enabled()) {
+      RESPONSE_ON_ERROR(
+          server_ptr_->GetDeviceStore()->ProcessGetRequest(ids, objects));
+    }
+    for (auto const& object : objects) {
+      citeBlob(object->object_id);
+    }
+    std::vector<int> fds = collectNewFds(objects);
+    WriteGetBuffersReply(objects, fds, message_out);
 
     /* NOTE: Here we send the file descriptor after the objects.
      *       We are using sendmsg to send the file descriptor
@@ -156,80 +313,199 @@ bool SocketConnection::processMessage(const std::string& message_in) {
      *       explicit file descritors.
      */
     auto self(shared_from_this());
-    this->doWrite(message_out, [self, objects](const Status& status) {
-      for (auto object : objects) {
-        int store_fd = object->store_fd;
-        if (self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-          self->used_fds_.emplace(store_fd);
-          send_fd(self->nativeHandle(), store_fd);
-        }
-      }
+    this->doWrite(message_out, request, [self, fds](const Status& status) {
+      self->sendFds(fds);
       return Status::OK();
     });
   } break;
+  case CommandType::GetRemoteBlobRequest: {
+    ObjectID id;
+    size_t offset, size;
+    std::string compression;
+    TRY_READ_REQUEST(
+        ReadGetRemoteBlobRequest(root, id, offset, size, compression));
+    if (!binary_protocol_) {
+      // the bytes cannot be carried by a JSON message
+      RESPONSE_ON_ERROR(Status::Invalid(
+          "Getting blobs remotely requires the binary protocol"));
+    }
+    // the blob is pinned while its memory is read outside the lock of the
+    // store, otherwise it may be spilled, compressed, deduplicated or freed
+    // by the other threads meanwhile
+    auto bulk_store = server_ptr_->GetBulkStore();
+    RESPONSE_ON_ERROR(bulk_store->IncreaseReferenceCount(id));
+    std::string message_out;
+    auto status = [&]() -> Status {
+      std::shared_ptr<Payload> object;
+      RETURN_ON_ERROR(bulk_store->ProcessGetRequest(id, object));
+      if (offset > static_cast<size_t>(object->data_size)) {
+        return Status::Invalid("The offset " + std::to_string(offset) +
+                               " exceeds the blob size " +
+                               std::to_string(object->data_size));
+      }
+      size = std::min(size, object->data_size - offset);
+      if (compression.empty()) {
+        WriteGetRemoteBlobReply(object->pointer + offset, size, message_out);
+      } else {
+        std::string compressed;
+        RETURN_ON_ERROR(Compress(compression, object->pointer + offset, size,
+                                 compressed));
+        WriteGetRemoteBlobReply(
+            reinterpret_cast<const uint8_t*>(compressed.data()),
+            compressed.size(), message_out);
+      }
+      return Status::OK();
+    }();
+    VINEYARD_SUPPRESS(bulk_store->DecreaseReferenceCount(id));
+    RESPONSE_ON_ERROR(status);
+    this->doWrite(message_out, request);
+  } break;
   case CommandType::CreateBufferRequest: {
-    size_t size;
+    size_t size, alignment;
+    int numa_node;
     std::shared_ptr<Payload> object;
     std::string message_out;
 
-    TRY_READ_REQUEST(ReadCreateBufferRequest(root, size));
+    TRY_READ_REQUEST(ReadCreateBufferRequest(root, size, numa_node, alignment));
     ObjectID object_id;
     RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->ProcessCreateRequest(
-        size, object_id, object));
+        tenant_, size, object_id, object, numa_node, alignment));
+    citeBlob(object_id);
     WriteCreateBufferReply(object_id, object, message_out);
 
-    int store_fd = object->store_fd;
-    this->doWrite(message_out, [self, store_fd](const Status& status) {
-      if (self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-        self->used_fds_.emplace(store_fd);
-        send_fd(self->nativeHandle(), store_fd);
-      }
+    std::vector<int> fds = collectNewFds({object});
+    this->doWrite(message_out, request, [self, fds](const Status& status) {
+      self->sendFds(fds);
       return Status::OK();
     });
   } break;
+  case CommandType::CreateDeviceBufferRequest: {
+    size_t size;
+    int device_id;
+    std::shared_ptr<Payload> object;
+    std::string message_out;
+
+    TRY_READ_REQUEST(ReadCreateDeviceBufferRequest(root, size, device_id));
+    ObjectID object_id;
+    RESPONSE_ON_ERROR(server_ptr_->GetDeviceStore()->ProcessCreateRequest(
+        size, device_id, object_id, object));
+    // no fd to send, the payload carries the CUDA IPC handle
+    WriteCreateBufferReply(object_id, object, message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::CreateBuffersRequest: {
+    std::vector<size_t> sizes;
+    int numa_node;
+    std::vector<std::shared_ptr<Payload>> objects;
+    std::string message_out;
+
+    TRY_READ_REQUEST(ReadCreateBuffersRequest(root, sizes, numa_node));
+    RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->ProcessCreateRequest(
+        tenant_, sizes, objects, numa_node));
+    for (auto const& object : objects) {
+      citeBlob(object->object_id);
+    }
+    std::vector<int> fds = collectNewFds(objects);
+    WriteCreateBuffersReply(objects, fds, message_out);
+
+    this->doWrite(message_out, request, [self, fds](const Status& status) {
+      self->sendFds(fds);
+      return Status::OK();
+    });
+  } break;
+  case CommandType::SplitBufferRequest: {
+    ObjectID id;
+    std::vector<size_t> offsets, sizes;
+    std::vector<ObjectID> sub_ids;
+    std::string message_out;
+
+    TRY_READ_REQUEST(ReadSplitBufferRequest(root, id, offsets, sizes));
+    RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->ProcessSplitRequest(
+        id, offsets, sizes, sub_ids));
+    for (auto const& sub_id : sub_ids) {
+      citeBlob(sub_id);
+    }
+    WriteSplitBufferReply(sub_ids, message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::OpenRingChannelRequest: {
+    size_t capacity;
+    TRY_READ_REQUEST(ReadOpenRingChannelRequest(root, capacity));
+    if (ring_channel_) {
+      RESPONSE_ON_ERROR(
+          Status::Invalid("The ring channel has already been opened"));
+    }
+    std::unique_ptr<ShmRingChannel> channel;
+    RESPONSE_ON_ERROR(ShmRingChannel::Create(capacity, channel));
+    int event_fd = dup(channel->RequestEventFd());
+    if (event_fd < 0) {
+      RESPONSE_ON_ERROR(Status::IOError("Failed to dup the eventfd"));
+    }
+    ring_event_.reset(new asio::posix::stream_descriptor(
+        server_ptr_->GetIOContext(), event_fd));
+    std::vector<int> fds{channel->MemoryFd(), channel->RequestEventFd(),
+                         channel->ReplyEventFd()};
+    std::string message_out;
+    WriteOpenRingChannelReply(capacity, message_out);
+    // the reply goes through the socket, and the following replies will be
+    // written to the reply ring.
+    this->doWrite(message_out, request, [self, fds](const Status& status) {
+      self->sendFds(fds);
+      self->ring_channel_->CloseMemoryFd();
+      self->doWaitRing();
+      return Status::OK();
+    });
+    ring_channel_ = std::move(channel);
+  } break;
   case CommandType::GetDataRequest: {
     std::vector<ObjectID> ids;
     bool sync_remote = false, wait = false;
     TRY_READ_REQUEST(ReadGetDataRequest(root, ids, sync_remote, wait));
     ptree tree;
     RESPONSE_ON_ERROR(server_ptr_->GetData(
-        ids, sync_remote, wait, [self]() { return self->running_; },
-        [self](const Status& status, const ptree& tree) {
+        ids, sync_remote, wait, [self]() { return self->running_.load(); },
+        [self, request, ids](const Status& status, const ptree& tree) {
           std::string message_out;
           if (status.ok()) {
+            // tracked before the reply, thus the deletions after the reply
+            // won't be missed
+            self->trackObjects(ids);
             WriteGetDataReply(tree, message_out);
           } else {
             LOG(ERROR) << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(std::move(message_out), request);
           return Status::OK();
         }));
   } break;
   case CommandType::ListDataRequest: {
-    std::string pattern;
+    std::string pattern, cursor;
     bool regex;
     size_t limit;
-    TRY_READ_REQUEST(ReadListDataRequest(root, pattern, regex, limit));
+    TRY_READ_REQUEST(ReadListDataRequest(root, pattern, regex, limit, cursor));
     RESPONSE_ON_ERROR(server_ptr_->ListData(
-        pattern, regex, limit, [self](const Status& status, const ptree& tree) {
+        pattern, regex, limit, cursor,
+        [self, request](const Status& status, const ptree& tree,
+                        const std::string& next_cursor) {
           std::string message_out;
           if (status.ok()) {
-            WriteGetDataReply(tree, message_out);
+            WriteListDataReply(tree, next_cursor, message_out);
           } else {
             LOG(ERROR) << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(std::move(message_out), request);
           return Status::OK();
         }));
   } break;
   case CommandType::CreateDataRequest: {
     ptree tree;
-    TRY_READ_REQUEST(ReadCreateDataRequest(root, tree));
+    uint64_t ttl = 0;
+    TRY_READ_REQUEST(ReadCreateDataRequest(root, tree, ttl));
     RESPONSE_ON_ERROR(server_ptr_->CreateData(
-        tree, [self](const Status& status, const ObjectID id,
-                     const InstanceID instance_id) {
+        tree, ttl, [self, request](const Status& status, const ObjectID id,
+                          const InstanceID instance_id) {
           std::string message_out;
           if (status.ok()) {
             WriteCreateDataReply(id, instance_id, message_out);
@@ -237,38 +513,113 @@ bool SocketConnection::processMessage(const std::string& message_in) {
             LOG(ERROR) << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(message_out, request);
           return Status::OK();
         }));
   } break;
   case CommandType::PersistRequest: {
-    ObjectID id;
-    TRY_READ_REQUEST(ReadPersistRequest(root, id));
-    RESPONSE_ON_ERROR(server_ptr_->Persist(id, [self](const Status& status) {
-      std::string message_out;
-      if (status.ok()) {
-        WritePersistReply(message_out);
-      } else {
-        LOG(ERROR) << status.ToString();
-        WriteErrorReply(status, message_out);
-      }
-      self->doWrite(message_out);
-      return Status::OK();
-    }));
+    std::vector<ObjectID> ids;
+    uint64_t ttl = 0;
+    bool write_behind = false;
+    TRY_READ_REQUEST(ReadPersistRequest(root, ids, ttl, write_behind));
+    RESPONSE_ON_ERROR(server_ptr_->Persist(
+        ids, ttl, write_behind, [self, request](const Status& status) {
+          std::string message_out;
+          if (status.ok()) {
+            WritePersistReply(message_out);
+          } else {
+            LOG(ERROR) << status.ToString();
+            WriteErrorReply(status, message_out);
+          }
+          self->doWrite(message_out, request);
+          return Status::OK();
+        }));
+  } break;
+  case CommandType::FlushRequest: {
+    TRY_READ_REQUEST(ReadFlushRequest(root));
+    RESPONSE_ON_ERROR(
+        server_ptr_->Flush([self, request](const Status& status) {
+          std::string message_out;
+          if (status.ok()) {
+            WriteFlushReply(message_out);
+          } else {
+            LOG(ERROR) << status.ToString();
+            WriteErrorReply(status, message_out);
+          }
+          self->doWrite(message_out, request);
+          return Status::OK();
+        }));
+  } break;
+  case CommandType::AccessStatsRequest: {
+    bool hot;
+    size_t limit;
+    std::vector<BlobAccess> blobs;
+    std::string message_out;
+
+    TRY_READ_REQUEST(ReadAccessStatsRequest(root, hot, limit));
+    if (hot) {
+      server_ptr_->GetBulkStore()->HotObjects(limit, blobs);
+    } else {
+      server_ptr_->GetBulkStore()->ColdObjects(limit, blobs);
+    }
+    WriteAccessStatsReply(blobs, message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::SlowRequestsRequest: {
+    size_t limit;
+    std::vector<SlowRequest> requests;
+    std::string message_out;
+
+    TRY_READ_REQUEST(ReadSlowRequestsRequest(root, limit));
+    server_ptr_->GetSlowRequests().Dump(limit, requests);
+    WriteSlowRequestsReply(requests, message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::ReleaseRequest: {
+    std::vector<ObjectID> ids;
+    std::string message_out;
+
+    TRY_READ_REQUEST(ReadReleaseRequest(root, ids));
+    for (auto const& id : ids) {
+      releaseBlob(id);
+    }
+    WriteReleaseReply(message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::SetTenantQuotaRequest: {
+    std::string tenant;
+    size_t quota;
+    std::string message_out;
+
+    TRY_READ_REQUEST(ReadSetTenantQuotaRequest(root, tenant, quota));
+    RESPONSE_ON_ERROR(
+        server_ptr_->GetBulkStore()->SetTenantQuota(tenant, quota));
+    WriteSetTenantQuotaReply(message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::SetMemoryLimitRequest: {
+    size_t limit;
+    std::string message_out;
+
+    TRY_READ_REQUEST(ReadSetMemoryLimitRequest(root, limit));
+    RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->SetMemoryLimit(limit));
+    WriteSetMemoryLimitReply(message_out);
+    this->doWrite(message_out, request);
   } break;
   case CommandType::IfPersistRequest: {
     ObjectID id;
     TRY_READ_REQUEST(ReadIfPersistRequest(root, id));
     RESPONSE_ON_ERROR(server_ptr_->IfPersist(
-        id, [self](const Status& status, bool const persist) {
+        id, [self, request](const Status& status, bool const persist,
+                            bool const durable) {
           std::string message_out;
           if (status.ok()) {
-            WriteIfPersistReply(persist, message_out);
+            WriteIfPersistReply(persist, durable, message_out);
           } else {
             LOG(ERROR) << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(message_out, request);
           return Status::OK();
         }));
   } break;
@@ -276,7 +627,7 @@ bool SocketConnection::processMessage(const std::string& message_in) {
     ObjectID id;
     TRY_READ_REQUEST(ReadExistsRequest(root, id));
     RESPONSE_ON_ERROR(server_ptr_->Exists(
-        id, [self](const Status& status, bool const exists) {
+        id, [self, request](const Status& status, bool const exists) {
           std::string message_out;
           if (status.ok()) {
             WriteExistsReply(exists, message_out);
@@ -284,7 +635,7 @@ bool SocketConnection::processMessage(const std::string& message_in) {
             LOG(ERROR) << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(message_out, request);
           return Status::OK();
         }));
   } break;
@@ -292,7 +643,7 @@ bool SocketConnection::processMessage(const std::string& message_in) {
     ObjectID id;
     TRY_READ_REQUEST(ReadShallowCopyRequest(root, id));
     RESPONSE_ON_ERROR(server_ptr_->ShallowCopy(
-        id, [self](const Status& status, const ObjectID target) {
+        id, [self, request](const Status& status, const ObjectID target) {
           std::string message_out;
           if (status.ok()) {
             WriteShallowCopyReply(target, message_out);
@@ -300,7 +651,7 @@ bool SocketConnection::processMessage(const std::string& message_in) {
             LOG(ERROR) << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(message_out, request);
           return Status::OK();
         }));
   } break;
@@ -309,22 +660,30 @@ bool SocketConnection::processMessage(const std::string& message_in) {
     bool force, deep;
     TRY_READ_REQUEST(ReadDelDataRequest(root, ids, force, deep));
     RESPONSE_ON_ERROR(
-        server_ptr_->DelData(ids, force, deep, [self](const Status& status) {
-          std::string message_out;
-          if (status.ok()) {
-            WriteDelDataReply(message_out);
-          } else {
-            LOG(ERROR) << status.ToString();
-            WriteErrorReply(status, message_out);
-          }
-          self->doWrite(message_out);
-          return Status::OK();
-        }));
+        server_ptr_->DelData(
+            ids, force, deep, [self, request](const Status& status) {
+              std::string message_out;
+              if (status.ok()) {
+                // the deleting client doesn't hold the memory of the blobs
+                // it deletes
+                self->releaseDeletedBlobs();
+                WriteDelDataReply(message_out);
+              } else {
+                LOG(ERROR) << status.ToString();
+                WriteErrorReply(status, message_out);
+              }
+              self->doWrite(message_out, request);
+              return Status::OK();
+            }));
   } break;
   case CommandType::CreateStreamRequest: {
     ObjectID stream_id;
-    TRY_READ_REQUEST(ReadCreateStreamRequest(root, stream_id));
-    auto status = server_ptr_->GetStreamStore()->Create(stream_id);
+    size_t depth = 0, readers = 1, retain = 0;
+    bool parallel = false;
+    TRY_READ_REQUEST(ReadCreateStreamRequest(root, stream_id, depth, readers,
+                                             parallel, retain));
+    auto status = server_ptr_->GetStreamStore()->Create(
+        stream_id, depth, readers, parallel, retain);
     std::string message_out;
     if (status.ok()) {
       WriteCreateStreamReply(message_out);
@@ -332,64 +691,201 @@ bool SocketConnection::processMessage(const std::string& message_in) {
       LOG(ERROR) << status.ToString();
       WriteErrorReply(status, message_out);
     }
-    this->doWrite(message_out);
+    this->doWrite(message_out, request);
   } break;
   case CommandType::GetNextStreamChunkRequest: {
     ObjectID stream_id;
     size_t size;
     TRY_READ_REQUEST(ReadGetNextStreamChunkRequest(root, stream_id, size));
     RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Get(
-        stream_id, size, [self](const Status& status, const ObjectID chunk) {
-          std::string message_out;
-          if (status.ok()) {
+        stream_id, size, tenant_,
+        [self, request](const Status& status, const ObjectID chunk) {
+          // the chunk may be delivered by the producer's connection, switch
+          // to the strand of this connection before touching its states.
+          asio::dispatch(self->strand_, [self, request, status, chunk]() {
+            std::string message_out;
             std::shared_ptr<Payload> object;
-            RETURN_ON_ERROR(
-                self->server_ptr_->GetBulkStore()->ProcessGetRequest(chunk,
-                                                                     object));
-            WriteGetNextStreamChunkReply(object, message_out);
-            int store_fd = object->store_fd;
-            self->doWrite(message_out, [self, store_fd](const Status& status) {
-              if (self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-                self->used_fds_.emplace(store_fd);
-                send_fd(self->nativeHandle(), store_fd);
-              }
-              return Status::OK();
-            });
-          } else {
-            LOG(ERROR) << status.ToString();
-            WriteErrorReply(status, message_out);
-            self->doWrite(message_out);
-          }
+            auto s = status;
+            if (s.ok()) {
+              s = self->server_ptr_->GetBulkStore()->ProcessGetRequest(chunk,
+                                                                       object);
+            }
+            if (s.ok()) {
+              self->citeBlob(chunk);
+              WriteGetNextStreamChunkReply(object, message_out);
+              std::vector<int> fds = self->collectNewFds({object});
+              self->doWrite(message_out, request,
+                            [self, fds](const Status& status) {
+                              self->sendFds(fds);
+                              return Status::OK();
+                            });
+            } else {
+              LOG(ERROR) << s.ToString();
+              WriteErrorReply(s, message_out);
+              self->doWrite(message_out, request);
+            }
+          });
           return Status::OK();
         }));
   } break;
   case CommandType::PullNextStreamChunkRequest: {
     ObjectID stream_id;
-    TRY_READ_REQUEST(ReadPullNextStreamChunkRequest(root, stream_id));
+    bool inlined = false, wait = true;
+    TRY_READ_REQUEST(
+        ReadPullNextStreamChunkRequest(root, stream_id, inlined, wait));
+    if (inlined && !binary_protocol_) {
+      // the chunk cannot be carried by a JSON message
+      RESPONSE_ON_ERROR(Status::Invalid(
+          "Pulling chunks remotely requires the binary protocol"));
+    }
     this->associated_streams_.emplace(stream_id);
     RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Pull(
-        stream_id, [self](const Status& status, const ObjectID chunk) {
-          std::string message_out;
-          if (status.ok()) {
+        stream_id, conn_id_,
+        [self, request, inlined](const Status& status, const ObjectID chunk) {
+          // the chunk may be delivered by the producer's connection, switch
+          // to the strand of this connection before touching its states.
+          asio::dispatch(self->strand_, [self, request, inlined, status,
+                                         chunk]() {
+            std::string message_out;
             std::shared_ptr<Payload> object;
-            RETURN_ON_ERROR(
-                self->server_ptr_->GetBulkStore()->ProcessGetRequest(chunk,
-                                                                     object));
-            WritePullNextStreamChunkReply(object, message_out);
-            int store_fd = object->store_fd;
-            self->doWrite(message_out, [self, store_fd](const Status& status) {
-              if (self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-                self->used_fds_.emplace(store_fd);
-                send_fd(self->nativeHandle(), store_fd);
+            auto s = status;
+            if (s.ok()) {
+              s = self->server_ptr_->GetBulkStore()->ProcessGetRequest(chunk,
+                                                                       object);
+            }
+            if (s.ok() && inlined) {
+              // the chunk is kept until this reader pulls the next one
+              WritePullNextStreamChunkReply(object->pointer,
+                                            object->data_size, message_out);
+              self->doWrite(message_out, request);
+            } else if (s.ok()) {
+              self->citeBlob(chunk);
+              WritePullNextStreamChunkReply(object, message_out);
+              std::vector<int> fds = self->collectNewFds({object});
+              self->doWrite(message_out, request,
+                            [self, fds](const Status& status) {
+                              self->sendFds(fds);
+                              return Status::OK();
+                            });
+            } else {
+              if (!s.IsStreamNotReady()) {
+                LOG(ERROR) << s.ToString();
               }
-              return Status::OK();
-            });
-          } else {
-            LOG(ERROR) << status.ToString();
-            WriteErrorReply(status, message_out);
-            self->doWrite(message_out);
-          }
+              WriteErrorReply(s, message_out);
+              self->doWrite(message_out, request);
+            }
+          });
           return Status::OK();
+        },
+        wait));
+  } break;
+  case CommandType::OpenStreamNotifierRequest: {
+    ObjectID stream_id;
+    TRY_READ_REQUEST(ReadOpenStreamNotifierRequest(root, stream_id));
+    if (stream_notifiers_.find(stream_id) != stream_notifiers_.end()) {
+      RESPONSE_ON_ERROR(
+          Status::Invalid("The stream notifier has already been opened"));
+    }
+    int event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd < 0) {
+      RESPONSE_ON_ERROR(Status::IOError("Failed to create the eventfd"));
+    }
+    auto status = server_ptr_->GetStreamStore()->Subscribe(
+        stream_id, conn_id_, [event_fd]() {
+          uint64_t value = 1;
+          if (write(event_fd, &value, sizeof(uint64_t)) < 0) {
+            // the counter is saturated, and the reader has been signaled
+          }
+        });
+    if (!status.ok()) {
+      close(event_fd);
+      RESPONSE_ON_ERROR(status);
+    }
+    this->associated_streams_.emplace(stream_id);
+    stream_notifiers_.emplace(stream_id, event_fd);
+    std::string message_out;
+    WriteOpenStreamNotifierReply(message_out);
+    this->doWrite(message_out, request, [self, event_fd](const Status& status) {
+      self->sendFds({event_fd});
+      return Status::OK();
+    });
+  } break;
+  case CommandType::SubscribeRequest: {
+    Subscription subscription;
+    TRY_READ_REQUEST(ReadSubscribeRequest(root, subscription.pattern,
+                                          subscription.regex,
+                                          subscription.names));
+    if (subscription.regex) {
+      try {
+        subscription.compiled = std::regex(subscription.pattern);
+      } catch (std::regex_error const& e) {
+        RESPONSE_ON_ERROR(Status::Invalid("Invalid regex pattern '" +
+                                          subscription.pattern +
+                                          "': " + e.what()));
+      }
+    }
+    uint64_t subscription_id = next_subscription_id_++;
+    subscriptions_.emplace(subscription_id, std::move(subscription));
+    socket_server_ptr_->AddSubscriptions(1);
+    std::string message_out;
+    WriteSubscribeReply(subscription_id, message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::UnsubscribeRequest: {
+    uint64_t subscription_id = 0;
+    TRY_READ_REQUEST(ReadUnsubscribeRequest(root, subscription_id));
+    if (subscriptions_.erase(subscription_id) == 0) {
+      RESPONSE_ON_ERROR(Status::Invalid("No such subscription: " +
+                                        std::to_string(subscription_id)));
+    }
+    socket_server_ptr_->RemoveSubscriptions(1);
+    std::string message_out;
+    WriteUnsubscribeReply(message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::SeekStreamRequest: {
+    ObjectID stream_id;
+    size_t offset;
+    TRY_READ_REQUEST(ReadSeekStreamRequest(root, stream_id, offset));
+    RESPONSE_ON_ERROR(
+        server_ptr_->GetStreamStore()->Seek(stream_id, conn_id_, offset));
+    this->associated_streams_.emplace(stream_id);
+    std::string message_out;
+    WriteSeekStreamReply(message_out);
+    this->doWrite(message_out, request);
+  } break;
+  case CommandType::PushNextStreamChunkRequest: {
+    ObjectID stream_id;
+    auto chunk_data = std::make_shared<std::string>();
+    TRY_READ_REQUEST(
+        ReadPushNextStreamChunkRequest(root, stream_id, *chunk_data));
+    RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Push(
+        stream_id, chunk_data->size(), tenant_,
+        [self, request, chunk_data](const Status& status,
+                                    const ObjectID chunk) {
+          // fill the chunk before it's sealed by the stream store
+          std::shared_ptr<Payload> object;
+          auto s = status;
+          if (s.ok()) {
+            s = self->server_ptr_->GetBulkStore()->ProcessGetRequest(chunk,
+                                                                     object);
+          }
+          if (s.ok()) {
+            memcpy(object->pointer, chunk_data->data(), chunk_data->size());
+          }
+          // the chunk may be requested by a consumer's connection, switch to
+          // the strand of this connection before replying.
+          asio::dispatch(self->strand_, [self, request, s]() {
+            std::string message_out;
+            if (s.ok()) {
+              WritePushNextStreamChunkReply(message_out);
+            } else {
+              LOG(ERROR) << s.ToString();
+              WriteErrorReply(s, message_out);
+            }
+            self->doWrite(message_out, request);
+          });
+          return s;
         }));
   } break;
   case CommandType::StopStreamRequest: {
@@ -401,14 +897,13 @@ bool SocketConnection::processMessage(const std::string& message_in) {
     RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Stop(stream_id, failed));
     std::string message_out;
     WriteStopStreamReply(message_out);
-    this->doWrite(message_out);
+    this->doWrite(message_out, request);
   } break;
   case CommandType::PutNameRequest: {
-    ObjectID object_id;
-    std::string name;
-    TRY_READ_REQUEST(ReadPutNameRequest(root, object_id, name));
+    std::map<std::string, ObjectID> names;
+    TRY_READ_REQUEST(ReadPutNameRequest(root, names));
     RESPONSE_ON_ERROR(
-        server_ptr_->PutName(object_id, name, [self](const Status& status) {
+        server_ptr_->PutName(names, [self, request](const Status& status) {
           std::string message_out;
           if (status.ok()) {
             WritePutNameReply(message_out);
@@ -416,7 +911,7 @@ bool SocketConnection::processMessage(const std::string& message_in) {
             LOG(ERROR) << "Failed to put name: " << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(message_out, request);
           return Status::OK();
         }));
   } break;
@@ -425,8 +920,8 @@ bool SocketConnection::processMessage(const std::string& message_in) {
     bool wait;
     TRY_READ_REQUEST(ReadGetNameRequest(root, name, wait));
     RESPONSE_ON_ERROR(server_ptr_->GetName(
-        name, wait, [self]() { return self->running_; },
-        [self](const Status& status, const ObjectID& object_id) {
+        name, wait, [self]() { return self->running_.load(); },
+        [self, request](const Status& status, const ObjectID& object_id) {
           std::string message_out;
           if (status.ok()) {
             WriteGetNameReply(object_id, message_out);
@@ -434,30 +929,31 @@ bool SocketConnection::processMessage(const std::string& message_in) {
             LOG(ERROR) << "Failed to get name: " << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(message_out, request);
           return Status::OK();
         }));
   } break;
   case CommandType::DropNameRequest: {
     std::string name;
     TRY_READ_REQUEST(ReadDropNameRequest(root, name));
-    RESPONSE_ON_ERROR(server_ptr_->DropName(name, [self](const Status& status) {
-      std::string message_out;
-      LOG(INFO) << "drop name callback: " << status;
-      if (status.ok()) {
-        WriteDropNameReply(message_out);
-      } else {
-        LOG(ERROR) << "Failed to drop name: " << status.ToString();
-        WriteErrorReply(status, message_out);
-      }
-      self->doWrite(message_out);
-      return Status::OK();
-    }));
+    RESPONSE_ON_ERROR(
+        server_ptr_->DropName(name, [self, request](const Status& status) {
+          std::string message_out;
+          LOG(INFO) << "drop name callback: " << status;
+          if (status.ok()) {
+            WriteDropNameReply(message_out);
+          } else {
+            LOG(ERROR) << "Failed to drop name: " << status.ToString();
+            WriteErrorReply(status, message_out);
+          }
+          self->doWrite(message_out, request);
+          return Status::OK();
+        }));
   } break;
   case CommandType::ClusterMetaRequest: {
     TRY_READ_REQUEST(ReadClusterMetaRequest(root));
     RESPONSE_ON_ERROR(server_ptr_->ClusterInfo(
-        [self](const Status& status, const ptree& tree) {
+        [self, request](const Status& status, const ptree& tree) {
           std::string message_out;
           if (status.ok()) {
             WriteClusterMetaReply(tree, message_out);
@@ -465,14 +961,14 @@ bool SocketConnection::processMessage(const std::string& message_in) {
             LOG(ERROR) << "Check cluster meta: " << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(message_out, request);
           return Status::OK();
         }));
   } break;
   case CommandType::InstanceStatusRequest: {
     TRY_READ_REQUEST(ReadInstanceStatusRequest(root));
     RESPONSE_ON_ERROR(server_ptr_->InstanceStatus(
-        [self](const Status& status, const ptree& tree) {
+        [self, request](const Status& status, const ptree& tree) {
           std::string message_out;
           if (status.ok()) {
             WriteInstanceStatusReply(tree, message_out);
@@ -480,7 +976,7 @@ bool SocketConnection::processMessage(const std::string& message_in) {
             LOG(ERROR) << "Check instance status: " << status.ToString();
             WriteErrorReply(status, message_out);
           }
-          self->doWrite(message_out);
+          self->doWrite(message_out, request);
           return Status::OK();
         }));
   } break;
@@ -493,41 +989,176 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   return false;
 }
 
-void SocketConnection::doWrite(const std::string& buf) {
-  std::string to_send;
-  size_t length = buf.size();
-  to_send.resize(length + sizeof(size_t));
-  char* ptr = &to_send[0];
-  memcpy(ptr, &length, sizeof(size_t));
-  ptr += sizeof(size_t);
-  memcpy(ptr, buf.data(), length);
-  bool write_in_progress = !write_msgs_.empty();
-  write_msgs_.push_back(std::move(to_send));
-  if (!write_in_progress) {
-    doAsyncWrite();
+size_t SocketConnection::frameMessage(std::string& buf) {
+  if (!binary_protocol_ && IsBinaryMessage(buf)) {
+    // the client doesn't understand the binary protocol
+    VINEYARD_SUPPRESS(TranscodeToJSON(buf));
   }
+  return buf.size();
+}
+
+void SocketConnection::doWrite(const std::string& buf) {
+  doWrite(std::string(buf), nullptr);
+}
+
+void SocketConnection::doWrite(std::string&& buf) {
+  doWrite(std::move(buf), nullptr);
 }
 
 void SocketConnection::doWrite(const std::string& buf, callback_t<> callback) {
-  std::string to_send;
-  size_t length = buf.size();
-  to_send.resize(length + sizeof(size_t));
-  char* ptr = &to_send[0];
-  memcpy(ptr, &length, sizeof(size_t));
-  ptr += sizeof(size_t);
-  memcpy(ptr, buf.data(), length);
-  bool write_in_progress = !write_msgs_.empty();
-  write_msgs_.push_back(std::move(to_send));
-  if (!write_in_progress) {
-    doAsyncWrite(callback);
+  doWrite(std::string(buf), callback);
+}
+
+void SocketConnection::doWrite(std::string&& buf, callback_t<> callback) {
+  if (strand_.running_in_this_thread()) {
+    writeMessage(std::move(buf), callback);
+    return;
   }
+  // replies may be produced outside the strand of this connection, e.g., in
+  // the meta strand.
+  auto self(shared_from_this());
+  auto message = std::make_shared<std::string>(std::move(buf));
+  asio::post(strand_, [this, self, message, callback]() {
+    writeMessage(std::move(*message), callback);
+  });
 }
 
-void SocketConnection::doWrite(std::string&& buf) {
-  bool write_in_progress = !write_msgs_.empty();
-  write_msgs_.push_back(std::move(buf));
-  if (!write_in_progress) {
-    doAsyncWrite();
+void SocketConnection::doWrite(const std::string& buf,
+                               RequestContext const& request) {
+  doWrite(std::string(buf), request, nullptr);
+}
+
+void SocketConnection::doWrite(const std::string& buf,
+                               RequestContext const& request,
+                               callback_t<> callback) {
+  doWrite(std::string(buf), request, callback);
+}
+
+void SocketConnection::doWrite(std::string&& buf,
+                               RequestContext const& request) {
+  doWrite(std::move(buf), request, nullptr);
+}
+
+void SocketConnection::doWrite(std::string&& buf,
+                               RequestContext const& request,
+                               callback_t<> callback) {
+  recordRequest(request, buf.size());
+  if (request.tag != 0) {
+    VINEYARD_SUPPRESS(TagMessage(buf, request.tag));
+  }
+  doWrite(std::move(buf), callback);
+}
+
+void SocketConnection::recordRequest(RequestContext const& request,
+                                     size_t const bytes_out) {
+  uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - request.start)
+                         .count();
+  server_ptr_->GetMetrics().RecordRequest(request.command, elapsed);
+  if (request.span) {
+    request.span->Finish();
+  }
+  if (!request.stats) {
+    return;
+  }
+  // including the time behind the requests that were read before it
+  uint64_t total = elapsed + request.stats->read_us;
+  auto& slow_requests = server_ptr_->GetSlowRequests();
+  if (slow_requests.IsSlow(total)) {
+    SlowRequest slow;
+    slow.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count() -
+                     total;
+    slow.command = request.command;
+    slow.connection = conn_id_;
+    slow.bytes_in = request.bytes_in;
+    slow.bytes_out = bytes_out;
+    slow.queue_us =
+        request.stats->read_us +
+        std::min<uint64_t>(request.stats->queue_us.load(), elapsed);
+    slow.handle_us = total - slow.queue_us;
+    slow.etcd_us = request.stats->etcd_us.load();
+    slow_requests.Record(slow);
+  }
+}
+
+void SocketConnection::writeMessage(std::string&& buf,
+                                    callback_t<> callback) {
+  server_ptr_->GetMetrics().AddBytesOut(buf.size());
+  if (ring_channel_ && writeToRing(buf)) {
+    if (callback) {
+      // the callback may send fds over the socket, which must follow the
+      // messages that have been redirected to the socket before.
+      enqueueCallback(callback);
+    }
+    return;
+  }
+  enqueueWrite(std::move(buf), callback);
+}
+
+bool SocketConnection::writeToRing(const std::string& buf) {
+  const std::string* message = &buf;
+  std::string transcoded;
+  if (!binary_protocol_ && IsBinaryMessage(buf)) {
+    transcoded = buf;
+    VINEYARD_SUPPRESS(TranscodeToJSON(transcoded));
+    message = &transcoded;
+  }
+  auto& replies = ring_channel_->Replies();
+  if (replies.TryPush(message->data(), message->size())) {
+    replies.Notify();
+    return true;
+  }
+  // too large for the ring, tell the client to receive it from the socket.
+  if (!replies.TryPushRedirected()) {
+    LOG(ERROR) << "The reply ring is full, the client seems not consuming";
+  }
+  replies.Notify();
+  return false;
+}
+
+void SocketConnection::doWaitRing() {
+  auto self(shared_from_this());
+  auto& requests = ring_channel_->Requests();
+  requests.PrepareWait();
+  if (!requests.Empty()) {
+    asio::post(strand_, [this, self]() { processRing(); });
+    return;
+  }
+  ring_event_->async_wait(
+      asio::posix::stream_descriptor::wait_read,
+      asio::bind_executor(strand_, [this, self](boost::system::error_code ec) {
+        if (!ec && running_) {
+          processRing();
+        }
+      }));
+}
+
+void SocketConnection::processRing() {
+  read_at_ = std::chrono::steady_clock::now();
+  auto& requests = ring_channel_->Requests();
+  requests.CancelWait();
+  uint64_t value = 0;
+  // reset the counter of the eventfd, it is non-blocking.
+  if (read(ring_channel_->RequestEventFd(), &value, sizeof(uint64_t)) < 0) {
+    value = 0;
+  }
+  std::string message;
+  bool redirected = false;
+  while (running_ && requests.TryPop(message, redirected)) {
+    if (redirected) {
+      // large requests are sent over the socket directly.
+      continue;
+    }
+    if (processMessage(message)) {
+      doStop();
+      socket_server_ptr_->RemoveConnection(conn_id_);
+      return;
+    }
+  }
+  if (running_) {
+    doWaitRing();
   }
 }
 
@@ -537,53 +1168,152 @@ void SocketConnection::doStop() {
   boost::system::error_code ec;
   socket_.shutdown(stream_protocol::socket::shutdown_both, ec);
   socket_.close();
+  if (ring_event_) {
+    ring_event_->close(ec);
+  }
   // do cleanup: clean up streams associated with this client
   for (auto stream_id : associated_streams_) {
-    VINEYARD_SUPPRESS(server_ptr_->GetStreamStore()->Drop(stream_id));
+    VINEYARD_SUPPRESS(
+        server_ptr_->GetStreamStore()->Drop(stream_id, conn_id_));
+  }
+  // the notifiers must be detached before closing the eventfds
+  for (auto const& item : stream_notifiers_) {
+    VINEYARD_SUPPRESS(
+        server_ptr_->GetStreamStore()->Unsubscribe(item.first, conn_id_));
+    close(item.second);
+  }
+  stream_notifiers_.clear();
+  // release the blobs that used by this connection
+  for (auto blob_id : cited_blobs_) {
+    VINEYARD_SUPPRESS(
+        server_ptr_->GetBulkStore()->DecreaseReferenceCount(blob_id));
+  }
+  cited_blobs_.clear();
+  socket_server_ptr_->RemoveSubscriptions(subscriptions_.size());
+  subscriptions_.clear();
+}
+
+std::vector<int> SocketConnection::collectNewFds(
+    std::vector<std::shared_ptr<Payload>> const& objects) {
+  std::vector<int> fds;
+  for (auto const& object : objects) {
+    if (object->store_fd >= 0 && used_fds_.emplace(object->store_fd).second) {
+      fds.emplace_back(object->store_fd);
+    }
+  }
+  return fds;
+}
+
+void SocketConnection::sendFds(std::vector<int> const& fds) {
+  if (!fds.empty() && send_fds(nativeHandle(), fds) < 0) {
+    LOG(ERROR) << "Failed to send " << fds.size() << " fds to the client";
+  }
+}
+
+void SocketConnection::citeBlob(ObjectID const id) {
+  if (cited_blobs_.emplace(id).second) {
+    VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->IncreaseReferenceCount(id));
+  }
+}
+
+void SocketConnection::releaseBlob(ObjectID const id) {
+  if (cited_blobs_.erase(id) > 0) {
+    VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->DecreaseReferenceCount(id));
+  }
+}
+
+void SocketConnection::releaseDeletedBlobs() {
+  auto bulk_store = server_ptr_->GetBulkStore();
+  for (auto iter = cited_blobs_.begin(); iter != cited_blobs_.end();) {
+    if (bulk_store->Exists(*iter)) {
+      ++iter;
+      continue;
+    }
+    VINEYARD_SUPPRESS(bulk_store->DecreaseReferenceCount(*iter));
+    iter = cited_blobs_.erase(iter);
+  }
+}
+
+void SocketConnection::enqueueWrite(std::string&& buf,
+                                    callback_t<> callback) {
+  bool write_in_progress = !write_msgs_.empty();
+  size_t length = frameMessage(buf);
+  write_msgs_.emplace_back(
+      SocketMessage{length, std::move(buf), callback, true});
+  if (!write_in_progress) {
+    doAsyncWrite();
+  }
+}
+
+void SocketConnection::enqueueCallback(callback_t<> callback) {
+  bool write_in_progress = !write_msgs_.empty();
+  write_msgs_.emplace_back(SocketMessage{0, std::string(), callback, false});
+  if (!write_in_progress) {
+    doAsyncWrite();
   }
 }
 
 void SocketConnection::doAsyncWrite() {
-  auto self(shared_from_this());
-  asio::async_write(socket_,
-                    boost::asio::buffer(write_msgs_.front().data(),
-                                        write_msgs_.front().length()),
-                    [this, self](boost::system::error_code ec, std::size_t) {
-                      if (!ec) {
-                        write_msgs_.pop_front();
-                        if (!write_msgs_.empty()) {
-                          doAsyncWrite();
-                        }
-                      } else {
-                        doStop();
-                        socket_server_ptr_->RemoveConnection(conn_id_);
-                      }
-                    });
-}
-
-void SocketConnection::doAsyncWrite(callback_t<> callback) {
+  // run the deferred callbacks that have nothing to write
+  while (!write_msgs_.empty() && !write_msgs_.front().framed) {
+    auto callback = std::move(write_msgs_.front().callback);
+    write_msgs_.pop_front();
+    if (callback && !callback(Status::OK()).ok()) {
+      doStop();
+      socket_server_ptr_->RemoveConnection(conn_id_);
+      return;
+    }
+  }
+  if (write_msgs_.empty()) {
+    return;
+  }
+  // gather the replies, but stop at the one that has a callback, as the
+  // callback (e.g., sending fds) must happen before the following messages.
+  //
+  // the header and body of each message are referenced in place: elements of
+  // the deque are not moved by pushing back new messages during the write.
+  std::vector<asio::const_buffer> buffers;
+  size_t gathered = 0;
+  for (auto const& message : write_msgs_) {
+    if (!message.framed || gathered >= kMaxGatheredWrites) {
+      break;
+    }
+    buffers.emplace_back(asio::buffer(&message.length, sizeof(size_t)));
+    if (message.length > 0) {
+      buffers.emplace_back(asio::buffer(message.body));
+    }
+    gathered += 1;
+    if (message.callback) {
+      break;
+    }
+  }
+  writing_msgs_ = gathered;
   auto self(shared_from_this());
   asio::async_write(
-      socket_,
-      boost::asio::buffer(write_msgs_.front().data(),
-                          write_msgs_.front().length()),
-      [this, self, callback](boost::system::error_code ec, std::size_t) {
+      socket_, buffers,
+      asio::bind_executor(strand_, [this, self](boost::system::error_code ec,
+                                                std::size_t) {
         if (!ec) {
-          write_msgs_.pop_front();
+          callback_t<> callback = nullptr;
+          for (size_t i = 0; i < writing_msgs_; ++i) {
+            callback = std::move(write_msgs_.front().callback);
+            write_msgs_.pop_front();
+          }
+          writing_msgs_ = 0;
+          // e.g., sending the fds, before the following messages
+          if (callback && !callback(Status::OK()).ok()) {
+            doStop();
+            socket_server_ptr_->RemoveConnection(conn_id_);
+            return;
+          }
           if (!write_msgs_.empty()) {
-            doAsyncWrite(callback);
-          } else {
-            auto status = callback(Status::OK());
-            if (!status.ok()) {
-              doStop();
-              socket_server_ptr_->RemoveConnection(conn_id_);
-            }
+            doAsyncWrite();
           }
         } else {
           doStop();
           socket_server_ptr_->RemoveConnection(conn_id_);
         }
-      });
+      }));
 }
 
 SocketServer::SocketServer(vs_ptr_t vs_ptr)
@@ -620,4 +1350,18 @@ size_t SocketServer::AliveConnections() const {
   return connections_.size();
 }
 
+void SocketServer::NotifyDeletion(std::vector<ObjectID> const& ids) {
+  std::lock_guard<std::mutex> scope_lock(this->connections_mutx_);
+  for (auto& pair : connections_) {
+    pair.second->NotifyDeletion(ids);
+  }
+}
+
+void SocketServer::NotifySubscribers(std::vector<ObjectEvent> const& events) {
+  std::lock_guard<std::mutex> scope_lock(this->connections_mutx_);
+  for (auto& pair : connections_) {
+    pair.second->NotifySubscribers(events);
+  }
+}
+
 }  // namespace vineyard
@@ -16,18 +16,28 @@ limitations under the License.
 #ifndef SRC_SERVER_ASYNC_SOCKET_SERVER_H_
 #define SRC_SERVER_ASYNC_SOCKET_SERVER_H_
 
+#include <atomic>
+#include <chrono>
 #include <deque>
 #include <memory>
+#include <map>
 #include <mutex>
+#include <regex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "boost/asio.hpp"
 
+#include "common/memory/shm_ring.h"
+#include "common/util/callback.h"
 #include "common/util/protocols.h"
+#include "common/util/trace.h"
 #include "server/async/socket_server.h"
 #include "server/server/vineyard_server.h"
+#include "server/util/slow_requests.h"
 
 namespace vineyard {
 
@@ -36,7 +46,18 @@ using boost::asio::generic::stream_protocol;
 
 class SocketServer;
 
-using socket_message_queue_t = std::deque<std::string>;
+// a message to write, with an optional callback that will be invoked once
+// the message has been written. The length header and the body are written
+// as separate buffers, thus the (possibly large) body is never copied for
+// framing. A message that is not framed only defers the callback.
+struct SocketMessage {
+  size_t length;
+  std::string body;
+  callback_t<> callback;
+  bool framed;
+};
+
+using socket_message_queue_t = std::deque<SocketMessage>;
 
 /**
  * @brief SocketConnection handles the socket connection in vineyard
@@ -54,24 +75,115 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   void Stop();
 
+  /**
+   * Tell the client that the objects have been deleted, if it has subscribed
+   * the deletion notifications and has got some of these objects.
+   */
+  void NotifyDeletion(std::vector<ObjectID> const& ids);
+
+  /**
+   * Push the objects that match the subscriptions of the client.
+   */
+  void NotifySubscribers(std::vector<ObjectEvent> const& events);
+
  private:
   int nativeHandle() { return socket_.native_handle(); }
 
-  void doReadHeader();
+  // the initial size of the read buffer, larger messages grow it
+  static constexpr size_t kReadBufferSize = 64 * 1024;
 
-  void doReadBody();
+  // how many queued messages can be gathered into a single write
+  static constexpr size_t kMaxGatheredWrites = 64;
+
+  /**
+   * Read from the socket as much as available into the read buffer, every
+   * complete message in the buffer will be processed after a read, thus
+   * pipelined requests are served with a single syscall.
+   */
+  void doRead();
+
+  /**
+   * Process the complete messages in the read buffer, returns false if the
+   * connection should be closed.
+   */
+  bool processReadBuffer();
 
   /**
    * Return should be exit after this message.
    */
   bool processMessage(const std::string& message_in);
 
+  /**
+   * Transcode the message to JSON (in place) if the client doesn't speak the
+   * binary protocol, returns the length of the framed body.
+   */
+  size_t frameMessage(std::string& buf);
+
   void doWrite(const std::string& buf);
 
   void doWrite(std::string&& buf);
 
   void doWrite(const std::string& buf, callback_t<> callback);
 
+  /**
+   * The reply is moved through the strand into the write queue, large replies
+   * (e.g., of `GetData` for many objects) are not copied on the way.
+   */
+  void doWrite(std::string&& buf, callback_t<> callback);
+
+  /**
+   * What the reply needs to know about the request: the tag if the request
+   * is pipelined (0 means untagged, see also `TagMessage`), the command
+   * and arrival time for the latency metrics, the span of the request if
+   * it is traced (see also `TraceMessage`), and what the handling has waited
+   * for (for the slow request recorder).
+   */
+  struct RequestContext {
+    uint64_t tag;
+    CommandType command;
+    std::chrono::steady_clock::time_point start;
+    std::shared_ptr<trace::Span> span;
+    size_t bytes_in;
+    std::shared_ptr<RequestStats> stats;
+    // counts the request as in flight while being alive
+    std::shared_ptr<void> inflight;
+  };
+
+  /**
+   * Write the reply of the request, the reply carries the tag of the request
+   * and the latency of the request is recorded.
+   */
+  void doWrite(const std::string& buf, RequestContext const& request);
+
+  void doWrite(const std::string& buf, RequestContext const& request,
+               callback_t<> callback);
+
+  void doWrite(std::string&& buf, RequestContext const& request);
+
+  void doWrite(std::string&& buf, RequestContext const& request,
+               callback_t<> callback);
+
+  void recordRequest(RequestContext const& request, size_t const bytes_out);
+
+  /**
+   * Write the message to the reply ring if the ring channel has been opened,
+   * otherwise to the socket. Must be invoked in the strand.
+   */
+  void writeMessage(std::string&& buf, callback_t<> callback);
+
+  /**
+   * Returns false if the message doesn't fit into the reply ring, then it
+   * should be sent over the socket.
+   */
+  bool writeToRing(const std::string& buf);
+
+  /**
+   * Wait for requests from the ring channel, then process them in the strand.
+   */
+  void doWaitRing();
+
+  void processRing();
+
   /**
    * Being called when the encounter a socket error (in read/write), or by
    * external "conn->Stop()".
@@ -80,25 +192,115 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   void doStop();
 
+  /**
+   * Append the message to the write queue, the callback (if any) will be
+   * invoked after the message has been written.
+   */
+  void enqueueWrite(std::string&& buf, callback_t<> callback);
+
+  /**
+   * Defer the callback after the pending writes.
+   */
+  void enqueueCallback(callback_t<> callback);
+
+  /**
+   * Write the queued messages, the headers and bodies of consecutive
+   * messages are gathered into one write (as a buffer sequence, without
+   * concatenation) until a message that has a callback.
+   */
   void doAsyncWrite();
 
-  void doAsyncWrite(callback_t<> callback);
+  /**
+   * Remember the objects that have been got by the client, whose deletions
+   * will be notified.
+   */
+  void trackObjects(std::vector<ObjectID> const& ids);
+
+  /**
+   * Mark the blob as being used by this connection, the blob won't be spilled
+   * out from the bulk store, nor be freed after deleted, until the connection
+   * releases it or is closed.
+   */
+  void citeBlob(ObjectID const id);
+
+  void releaseBlob(ObjectID const id);
+
+  /**
+   * Release the blobs that have been deleted, thus the bulk store can free
+   * them unless they are used by other connections.
+   */
+  void releaseDeletedBlobs();
+
+  /**
+   * Collect the store fds of the blobs that haven't been sent to the client
+   * of this connection yet, and mark them as sent.
+   */
+  std::vector<int> collectNewFds(
+      std::vector<std::shared_ptr<Payload>> const& objects);
+
+  /**
+   * Send the collected fds to the client in a single batch, must be invoked
+   * after the reply that carries these fds has been written.
+   */
+  void sendFds(std::vector<int> const& fds);
 
   stream_protocol::socket socket_;
   vs_ptr_t server_ptr_;
   SocketServer* socket_server_ptr_;
   int conn_id_;
-  bool running_;
+  // handlers of this connection are serialized by the strand, since the io
+  // context may be run on multiple threads.
+  VineyardServer::strand_t strand_;
+  std::atomic<bool> running_;
+  // when the messages that are being processed were read, the requests
+  // that are behind others in the same read are queueing
+  std::chrono::steady_clock::time_point read_at_;
+  // whether the client has negotiated the binary protocol during register
+  bool binary_protocol_;
+  // whether the client has subscribed the deletion notifications during
+  // register
+  bool deletion_notification_;
+  // the blobs created by this connection are accounted to the tenant, which
+  // is given by the client during register, or is the session of this
+  // connection.
+  std::string tenant_;
 
-  asio::streambuf buf_;
   socket_message_queue_t write_msgs_;
+  // how many messages at the front of `write_msgs_` are being written
+  size_t writing_msgs_;
 
+  // store fds that have been sent to the client of this connection
   std::unordered_set<int> used_fds_;
+  // blobs that have been mapped by the client of this connection
+  std::unordered_set<ObjectID> cited_blobs_;
   // the associated reader of the stream
   std::unordered_set<ObjectID> associated_streams_;
-
-  size_t read_msg_header_;
-  std::string read_msg_body_;
+  // the eventfds that signal the readiness of the streams to the reader
+  std::unordered_map<ObjectID, int> stream_notifiers_;
+  // objects that have been got by the client, see also `NotifyDeletion`
+  std::unordered_set<ObjectID> tracked_objects_;
+
+  // the patterns of typenames (or names) subscribed by the client, see also
+  // `NotifySubscribers`.
+  struct Subscription {
+    std::string pattern;
+    bool regex;
+    bool names;
+    std::regex compiled;
+
+    bool Match(std::string const& value) const;
+  };
+  std::map<uint64_t, Subscription> subscriptions_;
+  uint64_t next_subscription_id_ = 1;
+
+  // the shared memory ring channel, once opened, all replies are written to
+  // the reply ring while fds are still sent over the socket.
+  std::unique_ptr<ShmRingChannel> ring_channel_;
+  std::unique_ptr<asio::posix::stream_descriptor> ring_event_;
+
+  // received bytes in [read_begin_, read_end_) haven't been processed yet
+  std::vector<char> read_buffer_;
+  size_t read_begin_, read_end_;
 };
 
 /**
@@ -139,11 +341,33 @@ class SocketServer {
    */
   size_t AliveConnections() const;
 
+  /**
+   * Notify the deletion of objects to all connections.
+   */
+  void NotifyDeletion(std::vector<ObjectID> const& ids);
+
+  /**
+   * Notify the created objects (and the updated names) to the connections
+   * that have subscriptions.
+   */
+  void NotifySubscribers(std::vector<ObjectEvent> const& events);
+
+  /**
+   * How many subscriptions are there on all connections, the server skips
+   * collecting the events when there's no subscription.
+   */
+  size_t Subscriptions() const { return subscriptions_.load(); }
+
+  void AddSubscriptions(size_t const count) { subscriptions_ += count; }
+
+  void RemoveSubscriptions(size_t const count) { subscriptions_ -= count; }
+
  protected:
   vs_ptr_t vs_ptr_;
   int next_conn_id_;
   std::unordered_map<int, std::shared_ptr<SocketConnection>> connections_;
   mutable std::mutex connections_mutx_;  // protect connections_ in removing
+  std::atomic<size_t> subscriptions_{0};
 
  private:
   virtual void doAccept() = 0;
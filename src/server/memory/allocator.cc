@@ -32,28 +32,29 @@ https://github.com/apache/arrow/blob/master/cpp/src/plasma/plasma_allocator.cc
 
 namespace plasma {
 
-extern "C" {
-void* dlmemalign(size_t alignment, size_t bytes);
-void dlfree(void* mem);
-}
-
 int64_t BulkAllocator::footprint_limit_ = 0;
 int64_t BulkAllocator::allocated_ = 0;
 
-void* BulkAllocator::Memalign(size_t alignment, size_t bytes) {
+void* BulkAllocator::Memalign(size_t alignment, size_t bytes, int numa_node) {
   if (allocated_ + static_cast<int64_t>(bytes) > footprint_limit_) {
     return nullptr;
   }
-  void* mem = dlmemalign(alignment, bytes);
-  allocated_ += bytes;
+  void* mem = NumaMemalign(numa_node, alignment, bytes);
+  if (mem != nullptr) {
+    allocated_ += bytes;
+  }
   return mem;
 }
 
-void BulkAllocator::Free(void* mem, size_t bytes) {
-  dlfree(mem);
+void BulkAllocator::Free(void* mem, size_t bytes, int numa_node) {
+  NumaFree(numa_node, mem);
   allocated_ -= bytes;
 }
 
+void BulkAllocator::Adopt(size_t bytes) {
+  allocated_ += static_cast<int64_t>(bytes);
+}
+
 void BulkAllocator::SetFootprintLimit(size_t bytes) {
   footprint_limit_ = static_cast<int64_t>(bytes);
 }
@@ -42,15 +42,24 @@ class BulkAllocator {
   ///
   /// \param alignment Memory alignment.
   /// \param bytes Number of bytes.
+  /// \param numa_node The NUMA node to allocate from, -1 means the default
+  /// arena.
   /// \return Pointer to allocated memory.
-  static void* Memalign(size_t alignment, size_t bytes);
+  static void* Memalign(size_t alignment, size_t bytes, int numa_node = -1);
 
   /// Frees the memory space pointed to by mem, which must have been returned by
   /// a previous call to Memalign()
   ///
   /// \param mem Pointer to memory to free.
   /// \param bytes Number of bytes to be freed.
-  static void Free(void* mem, size_t bytes);
+  /// \param numa_node The NUMA node that the memory was allocated from.
+  static void Free(void* mem, size_t bytes, int numa_node = -1);
+
+  /// Account the memory that has been allocated by a previous process from
+  /// the persistent arena.
+  ///
+  /// \param bytes Number of bytes.
+  static void Adopt(size_t bytes);
 
   /// Sets the memory footprint limit for Plasma.
   ///
@@ -0,0 +1,93 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/device_store.h"
+
+#include <string>
+#include <utility>
+
+#include "common/memory/cuda_ipc.h"
+
+namespace vineyard {
+
+DeviceStore::DeviceStore(size_t const limit) : limit_(limit) {}
+
+DeviceStore::~DeviceStore() {
+  for (auto const& item : objects_) {
+    VINEYARD_SUPPRESS(CudaFree(item.second->device_id, item.second->pointer));
+  }
+}
+
+Status DeviceStore::ProcessCreateRequest(const size_t size,
+                                         const int device_id,
+                                         ObjectID& object_id,
+                                         std::shared_ptr<Payload>& object) {
+  if (!Enabled()) {
+    return Status::Invalid(
+        "Device blobs are disabled, please start vineyardd with "
+        "--device_memory_size");
+  }
+  if (device_id < 0) {
+    return Status::Invalid("Invalid CUDA device " + std::to_string(device_id));
+  }
+  if (size == 0) {
+    return Status::Invalid("Cannot create empty device blob");
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (footprint_ + size > limit_) {
+    return Status::NotEnoughMemory("device memory: size = " +
+                                   std::to_string(size));
+  }
+  void* pointer = nullptr;
+  std::string handle;
+  RETURN_ON_ERROR(CudaAllocate(device_id, size, &pointer, handle));
+  // device pointers live in the unified virtual address space, which never
+  // overlaps with the host memory of the bulk store.
+  object_id = GenerateBlobID(pointer);
+  object = std::make_shared<Payload>(object_id, size,
+                                     static_cast<uint8_t*>(pointer), -1, 0, 0);
+  object->device_id = device_id;
+  object->ipc_handle = std::move(handle);
+  objects_.emplace(object_id, object);
+  footprint_ += size;
+  return Status::OK();
+}
+
+Status DeviceStore::ProcessGetRequest(
+    const std::vector<ObjectID>& ids,
+    std::vector<std::shared_ptr<Payload>>& objects) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto object_id : ids) {
+    auto iter = objects_.find(object_id);
+    if (iter != objects_.end()) {
+      objects.emplace_back(iter->second);
+    }
+  }
+  return Status::OK();
+}
+
+Status DeviceStore::ProcessDeleteRequest(const ObjectID& id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = objects_.find(id);
+  if (iter == objects_.end()) {
+    return Status::ObjectNotExists();
+  }
+  auto object = iter->second;
+  objects_.erase(iter);
+  footprint_ -= object->data_size;
+  return CudaFree(object->device_id, object->pointer);
+}
+
+}  // namespace vineyard
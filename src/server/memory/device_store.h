@@ -0,0 +1,85 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_DEVICE_STORE_H_
+#define SRC_SERVER_MEMORY_DEVICE_STORE_H_
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/memory/payload.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief DeviceStore manages the blobs in the memory of CUDA devices, next to
+ * the `BulkStore` that manages the blobs in the shared memory.
+ *
+ * Every device blob is a separate device allocation, which is shared with the
+ * clients by its CUDA IPC handle. Device blobs are neither spilled nor
+ * replicated to other instances.
+ */
+class DeviceStore {
+ public:
+  /**
+   * @brief The device store holds at most `limit` bytes of device memory
+   * (over all devices), 0 means device blobs are disabled.
+   */
+  explicit DeviceStore(size_t const limit);
+
+  ~DeviceStore();
+
+  bool Enabled() const { return limit_ > 0; }
+
+  Status ProcessCreateRequest(const size_t size, const int device_id,
+                              ObjectID& object_id,
+                              std::shared_ptr<Payload>& object);
+
+  /**
+   * This methods only return available objects, and doesn't fail when object
+   * does not exists.
+   */
+  Status ProcessGetRequest(const std::vector<ObjectID>& ids,
+                           std::vector<std::shared_ptr<Payload>>& objects);
+
+  Status ProcessDeleteRequest(const ObjectID& id);
+
+  bool Exists(const ObjectID id) const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return objects_.find(id) != objects_.end();
+  }
+
+  size_t Footprint() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return footprint_;
+  }
+
+  size_t FootprintLimit() const { return limit_; }
+
+ private:
+  mutable std::mutex mutex_;
+
+  std::unordered_map<ObjectID, std::shared_ptr<Payload>> objects_;
+
+  size_t const limit_;
+  size_t footprint_ = 0;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_DEVICE_STORE_H_
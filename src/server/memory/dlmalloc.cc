@@ -26,11 +26,18 @@
 // under the License.
  */
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stddef.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include <string>
 #include <vector>
 
+#include "common/memory/payload.h"
 #include "common/util/logging.h"
 #include "server/memory/malloc.h"
 
@@ -44,9 +51,11 @@ int fake_munmap(void*, int64_t);
 #define DIRECT_MMAP(s) fake_mmap(s)
 #define DIRECT_MUNMAP(a, s) fake_munmap(a, s)
 #define USE_DL_PREFIX
+#define MSPACES 1
 #define HAVE_MORECORE 0
 #define DEFAULT_MMAP_THRESHOLD MAX_SIZE_T
 #define DEFAULT_GRANULARITY ((size_t) 128U * 1024U)
+#define MALLOC_INSPECT_ALL 1
 
 #include "dlmalloc/dlmalloc.c"  // NOLINT
 
@@ -55,8 +64,10 @@ int fake_munmap(void*, int64_t);
 #undef DIRECT_MMAP
 #undef DIRECT_MUNMAP
 #undef USE_DL_PREFIX
+#undef MSPACES
 #undef HAVE_MORECORE
 #undef DEFAULT_GRANULARITY
+#undef MALLOC_INSPECT_ALL
 
 // dlmalloc.c defined DEBUG which will conflict with ARROW_LOG(DEBUG).
 #ifdef DEBUG
@@ -67,10 +78,78 @@ int fake_munmap(void*, int64_t);
 /// This ensures that the segments of memory returned by
 /// fake_mmap are never contiguous and dlmalloc does not coalesce it
 /// (in the client we cannot guarantee that these mmaps are contiguous).
-constexpr int64_t kMmapRegionsGap = sizeof(size_t);
+///
+/// The gap is a multiple of the chunk alignment, otherwise the first chunk
+/// of a segment is shifted and never covers the whole segment, and dlmalloc
+/// can't release the segment when it becomes empty.
+constexpr int64_t kMmapRegionsGap = MALLOC_ALIGNMENT;
 
 constexpr int GRANULARITY_MULTIPLIER = 2;
 
+/// Size of the huge pages that back the memory segments, 0 means huge pages
+/// are not used.
+static int64_t huge_page_size = 0;
+
+/// The NUMA node that the segments being mapped will be bound to, -1 means
+/// the segments are not bound.
+static int mmap_numa_node = -1;
+
+/// The NUMA node that the segments of the default arena are bound to.
+static int default_numa_node = -1;
+
+/// The dlmalloc arenas that are bound to NUMA nodes, indexed by the node.
+static std::vector<mspace> numa_arenas;
+
+/// The files of the released segments, which are truncated to free the
+/// memory, and are kept open to be reused rather than closed, since closing
+/// them makes the fds be reused by other files while clients have mapped
+/// them.
+struct ReleasedBuffer {
+  int fd;
+  int64_t capacity;
+  bool huge;
+};
+static std::vector<ReleasedBuffer> released_buffers;
+
+/// The header at the beginning of the file of the persistent arena.
+struct PersistentArenaHeader {
+  char magic[24];
+  uint64_t size;
+  /// Where the file is mapped, the blobs (and their ids) are located by the
+  /// addresses, thus it must be mapped at the same address after restarts.
+  uint64_t base;
+  /// The dlmalloc state, which lives in the file as well.
+  uint64_t arena;
+  /// Whether the last process has closed the arena.
+  uint64_t clean;
+};
+
+constexpr char kPersistentArenaMagic[] = "vineyard-arena 1";
+
+/// The dlmalloc state starts after the header page.
+constexpr int64_t kPersistentArenaHeaderSize = 4096;
+
+/// New arenas are mapped around this address, which is away from where the
+/// kernel places the mappings by default, to make it likely to get the same
+/// address after restarts.
+constexpr uintptr_t kPersistentArenaAddress = 0x600000000000UL;
+
+#if defined(__linux__) && !defined(MAP_FIXED_NOREPLACE)
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+/// The arena on a file that replaces the default arena, nullptr if the
+/// shared memory is not persistent.
+static mspace persistent_arena = nullptr;
+static PersistentArenaHeader* persistent_header = nullptr;
+
+#if defined(__linux__) && !defined(MFD_HUGETLB)
+#define MFD_HUGETLB 0x0004U
+#endif
+#if defined(__linux__) && !defined(MFD_HUGE_SHIFT)
+#define MFD_HUGE_SHIFT 26
+#endif
+
 static void* pointer_advance(void* p, ptrdiff_t n) {
   return (unsigned char*) p + n;
 }
@@ -121,23 +200,196 @@ int create_buffer(int64_t size) {
   return fd;
 }
 
+// Create a buffer that is backed by huge pages, using an anonymous file on
+// the kernel's internal hugetlbfs mount, the size must be a multiple of the
+// huge page size. Returns -1 if huge pages are not available.
+int create_huge_page_buffer(int64_t size) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+  int page_shift = __builtin_ctzll(static_cast<uint64_t>(huge_page_size));
+  unsigned int flags = MFD_HUGETLB | (page_shift << MFD_HUGE_SHIFT);
+  int fd = static_cast<int>(
+      syscall(SYS_memfd_create, "vineyard-bulk-hugepage", flags));
+  if (fd < 0) {
+    LOG(WARNING) << "Failed to create huge page backed file: errno = "
+                 << errno << ": " << strerror(errno);
+    return -1;
+  }
+  if (ftruncate(fd, (off_t) size) != 0) {
+    LOG(WARNING) << "Failed to ftruncate huge page backed file: errno = "
+                 << errno << ": " << strerror(errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+#else
+  LOG(WARNING) << "Huge pages are not supported on this platform";
+  return -1;
+#endif
+}
+
+// Reuse the file of a released segment that is large enough, the smallest
+// one is picked. Returns -1 if there's no such file.
+static int reuse_buffer(int64_t size, bool huge, int64_t* capacity) {
+  auto best = released_buffers.end();
+  for (auto iter = released_buffers.begin(); iter != released_buffers.end();
+       ++iter) {
+    if (iter->huge == huge && iter->capacity >= size &&
+        (best == released_buffers.end() || iter->capacity < best->capacity)) {
+      best = iter;
+    }
+  }
+  if (best == released_buffers.end()) {
+    return -1;
+  }
+  int fd = best->fd;
+  *capacity = best->capacity;
+  released_buffers.erase(best);
+  // the pages are allocated lazily, thus the part beyond the segment costs
+  // nothing
+  if (ftruncate(fd, (off_t) *capacity) != 0) {
+    LOG(WARNING) << "Failed to ftruncate the released buffer: errno = "
+                 << errno << ": " << strerror(errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Free the memory of the file of an unmapped segment, and keep it for
+// reusing.
+static void release_buffer(int fd, int64_t capacity, bool huge) {
+  if (ftruncate(fd, 0) != 0) {
+    LOG(WARNING) << "Failed to truncate the released buffer, close it: "
+                 << "errno = " << errno << ": " << strerror(errno);
+    close(fd);
+    return;
+  }
+  released_buffers.push_back(ReleasedBuffer{fd, capacity, huge});
+}
+
+// Map a segment that is backed by huge pages, the mapped size is rounded up
+// to the huge page size. Returns MAP_FAILED when huge pages cannot be
+// reserved, e.g., the huge page pool has been exhausted.
+static void* huge_page_mmap(size_t size, int* fd, int64_t* mapped_size,
+                            int64_t* capacity) {
+  *mapped_size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+  *fd = reuse_buffer(*mapped_size, true, capacity);
+  if (*fd < 0) {
+    *fd = create_huge_page_buffer(*mapped_size);
+    *capacity = *mapped_size;
+  }
+  if (*fd < 0) {
+    return MAP_FAILED;
+  }
+  // The huge pages are reserved during mmap for shared mappings, thus mmap
+  // fails rather than the process gets a SIGBUS later when the huge page pool
+  // runs out.
+  void* pointer =
+      mmap(NULL, *mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+  if (pointer == MAP_FAILED) {
+    LOG(WARNING) << "Failed to mmap " << *mapped_size
+                 << " bytes of huge pages: errno = " << errno << ": "
+                 << strerror(errno);
+    release_buffer(*fd, *capacity, true);
+    *fd = -1;
+  }
+  return pointer;
+}
+
+// Map the file at a multiple of kMaxBlobAlignment, thus the offsets of the
+// blobs in the segment are aligned as their addresses are. An address range
+// with slack is reserved first, the file is mapped over the aligned part of
+// it, and the slack is unmapped.
+static void* aligned_mmap(size_t size, int fd) {
+  size_t reserved = size + vineyard::kMaxBlobAlignment;
+  void* reservation = mmap(NULL, reserved, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (reservation == MAP_FAILED) {
+    return MAP_FAILED;
+  }
+  uintptr_t begin = reinterpret_cast<uintptr_t>(reservation);
+  uintptr_t aligned = (begin + vineyard::kMaxBlobAlignment - 1) &
+                      ~(vineyard::kMaxBlobAlignment - 1);
+  void* pointer = mmap(reinterpret_cast<void*>(aligned), size,
+                       PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+  if (pointer == MAP_FAILED) {
+    munmap(reservation, reserved);
+    return MAP_FAILED;
+  }
+  uintptr_t page_size = static_cast<uintptr_t>(getpagesize());
+  uintptr_t end = (aligned + size + page_size - 1) & ~(page_size - 1);
+  if (aligned > begin) {
+    munmap(reservation, aligned - begin);
+  }
+  if (begin + reserved > end) {
+    munmap(reinterpret_cast<void*>(end), begin + reserved - end);
+  }
+  return pointer;
+}
+
+// Set the memory policy of the segment to prefer the given NUMA node. The
+// policy is recorded in the shared memory file, so pages will be placed on
+// the node no matter which process (the server or clients) touches them
+// first.
+static void bind_numa_node(void* pointer, int64_t size, int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  // MPOL_PREFERRED rather than MPOL_BIND: pages fallback to other nodes
+  // rather than the process gets a SIGBUS when the node runs out of memory.
+  constexpr int kMpolPreferred = 1;
+  constexpr int kBitsPerMask = sizeof(unsigned long) * 8;  // NOLINT
+  std::vector<unsigned long> mask(node / kBitsPerMask + 1, 0);  // NOLINT
+  mask[node / kBitsPerMask] |= 1UL << (node % kBitsPerMask);
+  if (syscall(SYS_mbind, pointer, size, kMpolPreferred, mask.data(),
+              mask.size() * kBitsPerMask + 1, 0) != 0) {
+    LOG(WARNING) << "Failed to bind memory to NUMA node " << node
+                 << ": errno = " << errno << ": " << strerror(errno);
+  }
+#endif
+}
+
 void* fake_mmap(size_t size) {
   // Add kMmapRegionsGap so that the returned pointer is deliberately not
   // page-aligned. This ensures that the segments of memory returned by
   // fake_mmap are never contiguous.
   size += kMmapRegionsGap;
 
-  int fd = create_buffer(size);
-  CHECK_GE(fd, 0) << "Failed to create buffer during mmap";
-  // MAP_POPULATE can be used to pre-populate the page tables for this memory
-  // region
-  // which avoids work when accessing the pages later. However it causes long
-  // pauses
-  // when mmapping the files. Only supported on Linux.
-  void* pointer = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int fd = -1;
+  int64_t mapped_size = size;
+  int64_t capacity = size;
+  bool huge = false;
+  void* pointer = MAP_FAILED;
+  if (huge_page_size > 0) {
+    pointer = huge_page_mmap(size, &fd, &mapped_size, &capacity);
+    if (pointer == MAP_FAILED) {
+      LOG(WARNING) << "Huge pages are not available, fallback to normal pages";
+      mapped_size = size;
+    } else {
+      huge = true;
+    }
+  }
+
   if (pointer == MAP_FAILED) {
-    LOG(ERROR) << "mmap failed with error: ";
-    return pointer;
+    fd = reuse_buffer(size, false, &capacity);
+    if (fd < 0) {
+      fd = create_buffer(size);
+      capacity = size;
+    }
+    CHECK_GE(fd, 0) << "Failed to create buffer during mmap";
+    // MAP_POPULATE can be used to pre-populate the page tables for this memory
+    // region
+    // which avoids work when accessing the pages later. However it causes long
+    // pauses
+    // when mmapping the files. Only supported on Linux.
+    pointer = aligned_mmap(size, fd);
+    if (pointer == MAP_FAILED) {
+      LOG(ERROR) << "mmap failed with error: ";
+      return pointer;
+    }
+  }
+
+  int numa_node = mmap_numa_node >= 0 ? mmap_numa_node : default_numa_node;
+  if (numa_node >= 0) {
+    bind_numa_node(pointer, mapped_size, numa_node);
   }
 
   // Increase dlmalloc's allocation granularity directly.
@@ -146,6 +398,9 @@ void* fake_mmap(size_t size) {
   MmapRecord& record = mmap_records[pointer];
   record.fd = fd;
   record.size = size;
+  record.mapped_size = mapped_size;
+  record.capacity = capacity;
+  record.huge = huge;
 
   // We lie to dlmalloc about where mapped memory actually lives.
   pointer = pointer_advance(pointer, kMmapRegionsGap);
@@ -164,9 +419,11 @@ int fake_munmap(void* addr, int64_t size) {
     return -1;
   }
 
-  int r = munmap(addr, size);
+  // segments backed by huge pages must be unmapped as a whole.
+  int r = munmap(addr, entry->second.mapped_size);
   if (r == 0) {
-    close(entry->second.fd);
+    release_buffer(entry->second.fd, entry->second.capacity,
+                   entry->second.huge);
   }
 
   mmap_records.erase(entry);
@@ -175,4 +432,185 @@ int fake_munmap(void* addr, int64_t size) {
 
 void SetMallocGranularity(int value) { change_mparam(M_GRANULARITY, value); }
 
+void* NumaMemalign(int numa_node, size_t alignment, size_t bytes) {
+  if (numa_node < 0) {
+    if (persistent_arena != nullptr) {
+      return mspace_memalign(persistent_arena, alignment, bytes);
+    }
+    return dlmemalign(alignment, bytes);
+  }
+  if (numa_arenas.size() <= static_cast<size_t>(numa_node)) {
+    numa_arenas.resize(numa_node + 1, nullptr);
+  }
+  // segments that mapped during the allocation will be bound to the node.
+  mmap_numa_node = numa_node;
+  if (numa_arenas[numa_node] == nullptr) {
+    numa_arenas[numa_node] = create_mspace(0, 0);
+  }
+  void* mem = nullptr;
+  if (numa_arenas[numa_node] != nullptr) {
+    mem = mspace_memalign(numa_arenas[numa_node], alignment, bytes);
+  }
+  mmap_numa_node = -1;
+  return mem;
+}
+
+void NumaFree(int numa_node, void* mem) {
+  if (numa_node < 0) {
+    if (persistent_arena != nullptr) {
+      mspace_free(persistent_arena, mem);
+      return;
+    }
+    dlfree(mem);
+  } else {
+    mspace_free(numa_arenas[numa_node], mem);
+  }
+}
+
+void SetDefaultNumaNode(int numa_node) { default_numa_node = numa_node; }
+
+void SetHugePageSize(int64_t page_size) {
+  huge_page_size = page_size;
+  if (page_size > 0) {
+    // avoid wasting the tail of huge pages for small segments
+    SetMallocGranularity(static_cast<int>(page_size));
+  }
+}
+
+void* OpenPersistentArena(const std::string& path, int64_t size, int* fd,
+                          int64_t* mapped_size, bool* recovered,
+                          std::string* error) {
+  auto fail = [&](std::string const& message) -> void* {
+    *error = message + ": errno = " + std::to_string(errno) + ": " +
+             strerror(errno);
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+    return nullptr;
+  };
+  *fd = open(path.c_str(), O_RDWR | O_CREAT, 0600);
+  if (*fd < 0) {
+    return fail("Failed to open the arena file " + path);
+  }
+  struct stat st;
+  if (fstat(*fd, &st) != 0) {
+    return fail("Failed to stat the arena file " + path);
+  }
+  if (st.st_size == 0) {
+    if (ftruncate(*fd, (off_t) size) != 0) {
+      return fail("Failed to ftruncate the arena file " + path);
+    }
+  } else if (st.st_size != size) {
+    LOG(WARNING) << "The size of the existing arena file " << path << " ("
+                 << st.st_size << ") is used rather than " << size;
+    size = st.st_size;
+  }
+  if (size <= kPersistentArenaHeaderSize) {
+    errno = EINVAL;
+    return fail("The arena file " + path + " is too small");
+  }
+
+  void* pointer = mmap(reinterpret_cast<void*>(kPersistentArenaAddress), size,
+                       PROT_READ | PROT_WRITE, MAP_SHARED, *fd, 0);
+  if (pointer == MAP_FAILED) {
+    return fail("Failed to mmap the arena file " + path);
+  }
+  auto header = reinterpret_cast<PersistentArenaHeader*>(pointer);
+  *recovered =
+      memcmp(header->magic, kPersistentArenaMagic,
+             sizeof(kPersistentArenaMagic)) == 0 &&
+      header->size == static_cast<uint64_t>(size);
+  if (*recovered && header->base != reinterpret_cast<uintptr_t>(pointer)) {
+    void* base = reinterpret_cast<void*>(header->base);
+    munmap(pointer, size);
+    pointer = mmap(base, size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_FIXED_NOREPLACE, *fd, 0);
+    if (pointer != base) {
+      if (pointer != MAP_FAILED) {
+        munmap(pointer, size);
+        errno = EEXIST;
+      }
+      return fail("Failed to mmap the arena file " + path +
+                  " at the address of the blobs on it");
+    }
+    header = reinterpret_cast<PersistentArenaHeader*>(pointer);
+  }
+
+  ensure_initialization();
+  if (*recovered) {
+    if (!header->clean) {
+      LOG(WARNING) << "The arena file " << path
+                   << " was not closed cleanly by the last vineyardd";
+    }
+    persistent_arena = reinterpret_cast<mspace>(header->arena);
+    // the magic is randomized per process
+    reinterpret_cast<mstate>(persistent_arena)->magic = mparams.magic;
+  } else {
+    memset(header, 0, sizeof(PersistentArenaHeader));
+    persistent_arena = create_mspace_with_base(
+        pointer_advance(pointer, kPersistentArenaHeaderSize),
+        size - kPersistentArenaHeaderSize, 0);
+    if (persistent_arena == nullptr) {
+      munmap(pointer, size);
+      errno = ENOMEM;
+      return fail("Failed to create the arena on " + path);
+    }
+    header->size = size;
+    header->base = reinterpret_cast<uintptr_t>(pointer);
+    header->arena = reinterpret_cast<uintptr_t>(persistent_arena);
+    memcpy(header->magic, kPersistentArenaMagic, sizeof(kPersistentArenaMagic));
+  }
+  header->clean = 0;
+  persistent_header = header;
+  // the arena never grows out of the file
+  mspace_set_footprint_limit(persistent_arena,
+                             mspace_footprint(persistent_arena));
+
+  MmapRecord& record = mmap_records[pointer];
+  record.fd = *fd;
+  record.size = size;
+  record.mapped_size = size;
+  record.capacity = size;
+  record.huge = false;
+  *mapped_size = size;
+  return pointer;
+}
+
+void InspectPersistentArena(
+    std::function<void(void* pointer, size_t size)> const& visitor) {
+  if (persistent_arena == nullptr) {
+    return;
+  }
+  auto handler = [](void* start, void* end, size_t used, void* arg) {
+    // the dlmalloc state itself is also an in-use chunk
+    if (used > 0 && start != persistent_arena) {
+      (*static_cast<std::function<void(void*, size_t)> const*>(arg))(start,
+                                                                      used);
+    }
+  };
+  mspace_inspect_all(persistent_arena, handler,
+                     const_cast<std::function<void(void*, size_t)>*>(&visitor));
+}
+
+void ClosePersistentArena() {
+  if (persistent_header != nullptr) {
+    persistent_header->clean = 1;
+  }
+}
+
+size_t ReleaseUnusedSegments() {
+  size_t footprint = dlmalloc_footprint();
+  dlmalloc_trim(0);
+  size_t released = footprint - dlmalloc_footprint();
+  for (mspace arena : numa_arenas) {
+    if (arena != nullptr) {
+      footprint = mspace_footprint(arena);
+      mspace_trim(arena, 0);
+      released += footprint - mspace_footprint(arena);
+    }
+  }
+  return released;
+}
+
 }  // namespace plasma
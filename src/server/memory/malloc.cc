@@ -51,7 +51,7 @@ void GetMallocMapinfo(void* addr, int* fd, int64_t* map_size,
     if (addr >= entry.first &&
         addr < pointer_advance(entry.first, entry.second.size)) {
       *fd = entry.second.fd;
-      *map_size = entry.second.size;
+      *map_size = entry.second.capacity;
       *offset = pointer_distance(entry.first, addr);
       return;
     }
@@ -32,6 +32,8 @@
 #include <inttypes.h>
 #include <stddef.h>
 
+#include <functional>
+#include <string>
 #include <unordered_map>
 
 namespace plasma {
@@ -39,9 +41,64 @@ namespace plasma {
 void GetMallocMapinfo(void* addr, int* fd, int64_t* map_length,
                       ptrdiff_t* offset);
 
+/// Allocate memory from the arena that is bound to the given NUMA node, the
+/// arena will be created on the first allocation. A numa_node of -1 means
+/// using the default arena.
+void* NumaMemalign(int numa_node, size_t alignment, size_t bytes);
+
+/// Free the memory that allocated by NumaMemalign from the same NUMA node.
+void NumaFree(int numa_node, void* mem);
+
+/// Bind the segments of the default arena that are mapped later to the
+/// given NUMA node, -1 means the segments are not bound.
+void SetDefaultNumaNode(int numa_node);
+
+/// Back the memory segments with huge pages of the given size. Segments fall
+/// back to normal pages when huge pages cannot be reserved, 0 disables huge
+/// pages.
+void SetHugePageSize(int64_t page_size);
+
+/// Replace the default arena by one on the file at `path`, e.g., on a DAX
+/// filesystem, a tmpfs or a hugetlbfs, which is created with the given size
+/// if it's empty. If the file has been used by a previous process,
+/// `recovered` is set and the allocations on it are still alive. The file is
+/// mapped at the same address as before, since the blobs are located by
+/// their addresses.
+///
+/// Returns the base of the mapping, or nullptr with the error.
+void* OpenPersistentArena(const std::string& path, int64_t size, int* fd,
+                          int64_t* mapped_size, bool* recovered,
+                          std::string* error);
+
+/// Visit the in-use allocations of the persistent arena, with their usable
+/// sizes.
+void InspectPersistentArena(
+    std::function<void(void* pointer, size_t size)> const& visitor);
+
+/// Mark the persistent arena as closed cleanly.
+void ClosePersistentArena();
+
+/// Return the segments that hold no allocation to the OS. The files of the
+/// released segments are truncated but kept open and are reused by later
+/// segments, thus the fds that clients have mapped always refer to the same
+/// files, and clients never see a stale mapping under a reused fd.
+///
+/// \return The bytes that have been released.
+size_t ReleaseUnusedSegments();
+
 struct MmapRecord {
   int fd;
+  /// The size that dlmalloc knows, including the gap.
   int64_t size;
+  /// The size that has actually been mapped, which will be rounded up to the
+  /// page size when the segment is backed by huge pages.
+  int64_t mapped_size;
+  /// The size of the file that clients map, which may exceed the segment
+  /// since the files of released segments are reused, see also
+  /// `ReleaseUnusedSegments`.
+  int64_t capacity;
+  /// Whether the file is on hugetlbfs.
+  bool huge;
 };
 
 /// Hashtable that contains one entry per segment that we got from the OS
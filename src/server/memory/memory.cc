@@ -28,11 +28,30 @@
 
 #include "server/memory/memory.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
+#define XXH_INLINE_ALL
+#include "arrow/vendored/xxhash.h"
+
+#include "common/util/compression.h"
+#include "common/util/functions.h"
+#include "common/util/logging.h"
 #include "server/memory/allocator.h"
 #include "server/memory/malloc.h"
+#include "server/util/cpu_affinity.h"
 
 namespace vineyard {
 
@@ -40,50 +59,472 @@ using plasma::BulkAllocator;
 using plasma::GetMallocMapinfo;
 using plasma::kBlockSize;
 
-Status BulkStore::PreAllocate(const size_t size) {
+namespace {
+
+// smaller blobs are not worth compressing.
+constexpr int64_t kMinCompressSize = 64 * 1024;
+
+// the compressed blobs are kept only if they shrink to at most 3/4.
+constexpr int64_t kCompressRatioNumerator = 3;
+constexpr int64_t kCompressRatioDenominator = 4;
+
+constexpr const char* kJournalMagic = "vineyard-arena-journal 1";
+
+// the unit of pre-faulting that a thread takes at a time.
+constexpr int64_t kPrefaultChunkSize = 64L * 1024 * 1024;
+
+std::string blobRecord(const bool replica, ObjectID const id,
+                       ptrdiff_t const offset, int64_t const size,
+                       size_t const alignment) {
+  std::string record = std::string(replica ? "r " : "b ") +
+                       VYObjectIDToString(id) + " " + std::to_string(offset) +
+                       " " + std::to_string(size);
+  // omitted for the default alignment, as in the journals of older versions
+  if (alignment > 0) {
+    record += " " + std::to_string(alignment);
+  }
+  return record + "\n";
+}
+
+void appendRecord(int fd, std::string const& record) {
+  size_t written = 0;
+  while (written < record.size()) {
+    ssize_t nbytes =
+        write(fd, record.data() + written, record.size() - written);
+    if (nbytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      LOG(WARNING) << "Failed to write the journal of the persistent arena: "
+                   << strerror(errno);
+      return;
+    }
+    written += nbytes;
+  }
+}
+
+int64_t currentMillis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+BulkStore::~BulkStore() {
+  {
+    std::lock_guard<std::mutex> lock(dedup_mutex_);
+    dedup_stopped_ = true;
+  }
+  dedup_cv_.notify_all();
+  if (dedup_thread_.joinable()) {
+    dedup_thread_.join();
+  }
+  {
+    std::lock_guard<std::mutex> lock(compress_mutex_);
+    compress_stopped_ = true;
+  }
+  compress_cv_.notify_all();
+  if (compress_thread_.joinable()) {
+    compress_thread_.join();
+  }
+  prefault_stopped_ = true;
+  if (prefault_thread_.joinable()) {
+    prefault_thread_.join();
+  }
+  if (journal_fd_ >= 0) {
+    close(journal_fd_);
+  }
+  if (persistent_) {
+    plasma::ClosePersistentArena();
+  }
+}
+
+Status BulkStore::PreAllocate(const size_t size, const size_t huge_page_size,
+                              const size_t reserve_size) {
+  if (huge_page_size != 0 && huge_page_size != (1UL << 21) &&
+      huge_page_size != (1UL << 30)) {
+    return Status::Invalid("Unsupported huge page size: " +
+                           std::to_string(huge_page_size) +
+                           ", only 2Mi and 1Gi are supported");
+  }
+  if (huge_page_size != 0) {
+    LOG(INFO) << "Backing the shared memory with huge pages of size "
+              << huge_page_size;
+  }
+  plasma::SetHugePageSize(static_cast<int64_t>(huge_page_size));
   BulkAllocator::SetFootprintLimit(size);
   // We are using a single memory-mapped file by mallocing and freeing a single
-  // large amount of space up front.
+  // large amount of space up front, or only the reserved part of it, then
+  // dlmalloc maps more segments when it runs out.
+  size_t initial_size = size;
+  if (reserve_size != 0 && reserve_size < size) {
+    LOG(INFO) << "Reserving " << reserve_size << " bytes of the shared memory"
+              << ", growing on demand until " << size;
+    initial_size = reserve_size;
+  }
   void* pointer =
-      BulkAllocator::Memalign(kBlockSize, size - 256 * sizeof(size_t));
+      BulkAllocator::Memalign(kBlockSize, initial_size - 256 * sizeof(size_t));
   if (pointer == nullptr) {
-    return Status::NotEnoughMemory("size = " + std::to_string(size));
+    return Status::NotEnoughMemory("size = " + std::to_string(initial_size));
   }
   // This will unmap the file, but the next one created will be as large
   // as this one (this is an implementation detail of dlmalloc).
-  BulkAllocator::Free(pointer, size - 256 * sizeof(size_t));
+  BulkAllocator::Free(pointer, initial_size - 256 * sizeof(size_t));
+  return Status::OK();
+}
+
+Status BulkStore::SetMemoryLimit(const size_t limit) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (limit == 0) {
+    return Status::Invalid("The memory limit must be positive");
+  }
+  if (persistent_ && limit > arena_size_) {
+    return Status::Invalid(
+        "The memory limit can't exceed the size of the persistent arena: " +
+        std::to_string(arena_size_));
+  }
+  BulkAllocator::SetFootprintLimit(limit);
+  size_t released = persistent_ ? 0 : plasma::ReleaseUnusedSegments();
+  LOG(INFO) << "Set the memory limit to " << limit << ", " << Footprint()
+            << " bytes in use, " << released << " bytes released to the OS";
   return Status::OK();
 }
 
+Status BulkStore::OpenPersistentArena(std::string const& path,
+                                     const size_t size) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  int fd = -1;
+  int64_t mapped_size = 0;
+  bool recovered = false;
+  std::string error;
+  void* base =
+      plasma::OpenPersistentArena(path, static_cast<int64_t>(size), &fd,
+                                  &mapped_size, &recovered, &error);
+  if (base == nullptr) {
+    return Status::IOError(error);
+  }
+  persistent_ = true;
+  arena_base_ = static_cast<uint8_t*>(base);
+  arena_size_ = static_cast<size_t>(mapped_size);
+  BulkAllocator::SetFootprintLimit(mapped_size);
+  LOG(INFO) << (recovered ? "Reopen" : "Create") << " the persistent arena "
+            << path << " of size " << mapped_size;
+  std::string journal_path = path + ".blobs";
+  if (!recovered) {
+    // left by another arena
+    unlink(journal_path.c_str());
+  }
+  return RecoverBlobs(journal_path);
+}
+
+Status BulkStore::Prefault(const int threads, std::vector<int> const& cpus) {
+  if (threads <= 0) {
+    return Status::Invalid("Invalid number of pre-faulting threads: " +
+                           std::to_string(threads));
+  }
+  if (prefault_thread_.joinable()) {
+    return Status::Invalid("The pre-faulting has been started");
+  }
+  // The pages are allocated in the files via fallocate rather than by
+  // touching the mappings: it races neither with the blobs that are written
+  // meanwhile nor with the segments that are released meanwhile.
+  struct Range {
+    int fd;
+    int64_t offset;
+    int64_t size;
+  };
+  std::vector<Range> ranges;
+  size_t total = 0;
+  {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    for (auto const& item : plasma::mmap_records) {
+      struct stat st;
+      if (fstat(item.second.fd, &st) != 0) {
+        continue;
+      }
+      for (int64_t offset = 0; offset < st.st_size;
+           offset += kPrefaultChunkSize) {
+        ranges.emplace_back(Range{
+            item.second.fd, offset,
+            std::min<int64_t>(kPrefaultChunkSize, st.st_size - offset)});
+        total += ranges.back().size;
+      }
+    }
+  }
+  prefault_size_ = total;
+  prefaulted_size_ = 0;
+  LOG(INFO) << "Pre-faulting " << prefault_size_ << " bytes of the shared "
+            << "memory with " << threads << " threads";
+  prefault_thread_ = std::thread([this, threads, ranges, cpus]() {
+    auto start = std::chrono::steady_clock::now();
+    int nodes = GetNumaNodeCount();
+    std::atomic<size_t> next{0};
+    std::atomic<bool> unsupported{false};
+    std::vector<std::thread> workers;
+    for (int index = 0; index < threads; ++index) {
+      workers.emplace_back([&, index]() {
+        // the pages that a thread faults are placed on its node unless the
+        // segment has been bound
+        if (!cpus.empty()) {
+          PinCurrentThread(cpus);
+        } else if (nodes > 1) {
+          PinCurrentThread(NumaNodeCpus(index % nodes));
+        }
+        for (size_t i = next++; i < ranges.size(); i = next++) {
+          if (prefault_stopped_ || unsupported) {
+            return;
+          }
+          auto const& range = ranges[i];
+          // FALLOC_FL_KEEP_SIZE: a segment released meanwhile isn't grown
+          // back.
+          if (fallocate(range.fd, FALLOC_FL_KEEP_SIZE, range.offset,
+                        range.size) != 0 &&
+              (errno == EOPNOTSUPP || errno == ENOSYS)) {
+            unsupported = true;
+            return;
+          }
+          prefaulted_size_ += range.size;
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    if (unsupported) {
+      LOG(WARNING) << "Stop pre-faulting as the shared memory doesn't support "
+                   << "fallocate";
+    } else if (!prefault_stopped_) {
+      LOG(INFO) << "Pre-faulted " << prefaulted_size_ << " bytes in "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count()
+                << " ms";
+    }
+  });
+  return Status::OK();
+}
+
+Status BulkStore::SetSpillPath(std::string const& spill_path) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (spill_path.empty()) {
+    spill_path_.clear();
+    return Status::OK();
+  }
+  if (mkdir(spill_path.c_str(), 0755) != 0 && errno != EEXIST) {
+    return Status::IOError("Failed to create the spill directory '" +
+                           spill_path + "': " + strerror(errno));
+  }
+  if (access(spill_path.c_str(), R_OK | W_OK) != 0) {
+    return Status::IOError("The spill directory '" + spill_path +
+                           "' is not accessible: " + strerror(errno));
+  }
+  spill_path_ = spill_path;
+  if (spill_path_.back() != '/') {
+    spill_path_ += '/';
+  }
+  // avoids conflicts between vineyardd instances that share the spill path.
+  spill_path_ += "vineyard-spill-" + std::to_string(getpid()) + "-";
+  LOG(INFO) << "Cold blobs will be spilled to " << spill_path_;
+  return Status::OK();
+}
+
+Status BulkStore::SetDefaultNumaNode(const int node) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (node < 0) {
+    return Status::OK();
+  }
+  int nodes = GetNumaNodeCount();
+  if (node >= std::max(nodes, 1)) {
+    return Status::Invalid("NUMA node " + std::to_string(node) +
+                           " doesn't exist, there are only " +
+                           std::to_string(nodes) + " NUMA node(s)");
+  }
+  plasma::SetDefaultNumaNode(node);
+  LOG(INFO) << "The default arena is placed on NUMA node " << node;
+  return Status::OK();
+}
+
+Status BulkStore::EnableNumaArenas() {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (persistent_) {
+    LOG(WARNING) << "NUMA arenas are not supported on the persistent arena";
+    return Status::OK();
+  }
+  int nodes = GetNumaNodeCount();
+  if (nodes <= 1) {
+    LOG(INFO) << "NUMA arenas are not enabled since there's only " << nodes
+              << " NUMA node(s) on this host";
+    numa_nodes_ = 0;
+    return Status::OK();
+  }
+  numa_nodes_ = nodes;
+  LOG(INFO) << "Enable NUMA arenas for " << numa_nodes_ << " NUMA nodes";
+  return Status::OK();
+}
+
+Status BulkStore::EnableDedup() {
+  std::lock_guard<std::mutex> lock(dedup_mutex_);
+  if (dedup_enabled_) {
+    return Status::OK();
+  }
+  dedup_enabled_ = true;
+  dedup_thread_ = std::thread(&BulkStore::DedupLoop, this);
+  LOG(INFO) << "Enable the deduplication of sealed blobs";
+  return Status::OK();
+}
+
+Status BulkStore::EnableCompression(std::string const& codec,
+                                    const int cold_seconds) {
+  std::lock_guard<std::mutex> lock(compress_mutex_);
+  if (compress_thread_.joinable()) {
+    return Status::Invalid("The compression of cold blobs has been enabled");
+  }
+  if (cold_seconds <= 0) {
+    return Status::Invalid("Invalid period for the cold blobs: " +
+                           std::to_string(cold_seconds));
+  }
+  // fails early if the codec is unavailable
+  const uint8_t probe[] = "vineyard";
+  std::string compressed;
+  RETURN_ON_ERROR(Compress(codec, probe, sizeof(probe), compressed));
+  compress_codec_ = codec;
+  compress_after_ = std::chrono::seconds(cold_seconds);
+  compress_thread_ = std::thread(&BulkStore::CompressLoop, this);
+  LOG(INFO) << "Blobs that are not accessed in " << cold_seconds
+            << " seconds will be compressed with " << codec;
+  return Status::OK();
+}
+
+void BulkStore::Seal(const ObjectID id) {
+  {
+    std::lock_guard<std::mutex> lock(dedup_mutex_);
+    if (!dedup_enabled_) {
+      return;
+    }
+    dedup_queue_.emplace_back(id);
+  }
+  dedup_cv_.notify_one();
+}
+
 // Allocate memory
-uint8_t* BulkStore::AllocateMemory(size_t size, int* fd, int64_t* map_size,
-                                   ptrdiff_t* offset) {
-  // Try to evict objects until there is enough space.
+uint8_t* BulkStore::AllocateMemory(size_t size, int numa_node, int* fd,
+                                   int64_t* map_size, ptrdiff_t* offset,
+                                   size_t alignment) {
   uint8_t* pointer = nullptr;
-  pointer =
-      reinterpret_cast<uint8_t*>(BulkAllocator::Memalign(kBlockSize, size));
+  // the slabs don't survive restarts
+  if (!persistent_ && SlabAllocator::Accepts(size, alignment)) {
+    pointer = slab_allocator_.Allocate(size, numa_node);
+  } else {
+    pointer = reinterpret_cast<uint8_t*>(BulkAllocator::Memalign(
+        std::max(alignment, static_cast<size_t>(kBlockSize)), size,
+        numa_node));
+  }
   if (pointer) {
     GetMallocMapinfo(pointer, fd, map_size, offset);
   }
   return pointer;
 }
 
+void BulkStore::FreeMemory(uint8_t* pointer, size_t size, int numa_node) {
+  // small blobs that have asked for a larger alignment are not in slabs
+  if (!persistent_ && slab_allocator_.Owns(pointer)) {
+    slab_allocator_.Free(pointer, size);
+  } else {
+    BulkAllocator::Free(pointer, size, numa_node);
+    if (!persistent_) {
+      plasma::ReleaseUnusedSegments();
+    }
+  }
+}
+
+uint8_t* BulkStore::AllocateMemoryWithSpill(size_t size, int numa_node,
+                                            int* fd, int64_t* map_size,
+                                            ptrdiff_t* offset,
+                                            size_t alignment) {
+  uint8_t* pointer =
+      AllocateMemory(size, numa_node, fd, map_size, offset, alignment);
+  // The replicas can be fetched again, thus are dropped before spilling.
+  while (pointer == nullptr && !replicas_.empty()) {
+    if (!EvictReplicas(size).ok()) {
+      break;
+    }
+    pointer =
+        AllocateMemory(size, numa_node, fd, map_size, offset, alignment);
+  }
+  // Try to spill objects until there is enough space, every round at least
+  // one blob will be spilled out, otherwise we stop trying.
+  while (pointer == nullptr && !spill_path_.empty()) {
+    auto status = SpillColdObjects(size);
+    if (!status.ok()) {
+      VLOG(10) << "Failed to spill cold objects: " << status.ToString();
+      break;
+    }
+    pointer =
+        AllocateMemory(size, numa_node, fd, map_size, offset, alignment);
+  }
+  return pointer;
+}
+
 Status BulkStore::ProcessCreateRequest(const size_t data_size,
                                        ObjectID& object_id,
-                                       std::shared_ptr<Payload>& object) {
+                                       std::shared_ptr<Payload>& object,
+                                       const int numa_node,
+                                       const size_t alignment) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if ((alignment & (alignment - 1)) != 0 || alignment > kMaxBlobAlignment) {
+    return Status::Invalid("The alignment must be a power of two and at most " +
+                           std::to_string(kMaxBlobAlignment) +
+                           ", but got " + std::to_string(alignment));
+  }
+  // fallback to the default arena if the node is unknown
+  int node = (numa_node >= 0 && numa_node < numa_nodes_) ? numa_node : -1;
   int fd = -1;
   int64_t map_size = 0;
   ptrdiff_t offset = 0;
   uint8_t* pointer = nullptr;
-  pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
+  pointer = AllocateMemoryWithSpill(data_size, node, &fd, &map_size, &offset,
+                                    alignment);
   if (pointer == nullptr) {
     return Status::NotEnoughMemory("size = " + std::to_string(data_size));
   }
   object_id = GenerateBlobID(pointer);
+  // The address may still be used as the id of a spilled blob, we hold the
+  // conflict memory until we find an unused one.
+  std::vector<uint8_t*> conflicts;
+  while (objects_.find(object_id) != objects_.end()) {
+    conflicts.emplace_back(pointer);
+    pointer = AllocateMemoryWithSpill(data_size, node, &fd, &map_size,
+                                      &offset, alignment);
+    if (pointer == nullptr) {
+      break;
+    }
+    object_id = GenerateBlobID(pointer);
+  }
+  for (auto conflict : conflicts) {
+    FreeMemory(conflict, data_size, node);
+  }
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory("size = " + std::to_string(data_size));
+  }
+  // the clients map the segments at multiples of kMaxBlobAlignment, the
+  // offset must be aligned as well, which doesn't hold only when the
+  // persistent arena can't be mapped at an aligned address
+  if (alignment > 0 && offset % alignment != 0) {
+    FreeMemory(pointer, data_size, node);
+    return Status::Invalid("The blob can't be aligned to " +
+                           std::to_string(alignment) +
+                           " bytes in the shared memory");
+  }
   objects_.emplace(object_id,
                    std::make_shared<Payload>(object_id, data_size, pointer, fd,
                                              map_size, offset));
   object = objects_[object_id];
+  object->numa_node = node;
+  object->alignment = alignment;
+  object->last_access = currentMillis();
+  TouchObject(object_id);
+  JournalCreate(object);
 #ifndef NDEBUG
   VLOG(10) << "after allocate: " << Footprint() << "(" << FootprintLimit()
            << ")";
@@ -91,12 +532,109 @@ Status BulkStore::ProcessCreateRequest(const size_t data_size,
   return Status::OK();
 }
 
+Status BulkStore::ProcessCreateRequest(
+    const std::vector<size_t>& sizes,
+    std::vector<std::shared_ptr<Payload>>& objects, const int numa_node) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  for (size_t const size : sizes) {
+    ObjectID object_id;
+    std::shared_ptr<Payload> object;
+    auto status = ProcessCreateRequest(size, object_id, object, numa_node);
+    if (!status.ok()) {
+      for (auto const& created : objects) {
+        VINEYARD_SUPPRESS(ProcessDeleteRequest(created->object_id));
+      }
+      objects.clear();
+      return status;
+    }
+    // pin the created blobs to avoid spilling them during this request
+    object->ref_cnt += 1;
+    objects.emplace_back(object);
+  }
+  for (auto const& object : objects) {
+    object->ref_cnt -= 1;
+  }
+  return Status::OK();
+}
+
+Status BulkStore::ProcessCreateRequest(std::string const& tenant,
+                                       const size_t size, ObjectID& object_id,
+                                       std::shared_ptr<Payload>& object,
+                                       const int numa_node,
+                                       const size_t alignment) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  RETURN_ON_ERROR(AdmitTenant(tenant, size));
+  RETURN_ON_ERROR(
+      ProcessCreateRequest(size, object_id, object, numa_node, alignment));
+  ChargeTenant(tenant, object_id, size);
+  return Status::OK();
+}
+
+Status BulkStore::ProcessCreateRequest(
+    std::string const& tenant, const std::vector<size_t>& sizes,
+    std::vector<std::shared_ptr<Payload>>& objects, const int numa_node) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  size_t total = 0;
+  for (size_t const size : sizes) {
+    total += size;
+  }
+  RETURN_ON_ERROR(AdmitTenant(tenant, total));
+  RETURN_ON_ERROR(ProcessCreateRequest(sizes, objects, numa_node));
+  for (auto const& object : objects) {
+    ChargeTenant(tenant, object->object_id, object->data_size);
+  }
+  return Status::OK();
+}
+
+Status BulkStore::SetTenantQuota(std::string const& tenant,
+                                 const size_t quota) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (tenant.empty()) {
+    return Status::Invalid("The tenant must not be empty");
+  }
+  if (tenant == "*") {
+    default_quota_ = quota;
+  } else if (quota != 0) {
+    tenants_[tenant].quota = quota;
+  } else {
+    auto iter = tenants_.find(tenant);
+    if (iter != tenants_.end()) {
+      iter->second.quota = 0;
+      if (iter->second.objects == 0) {
+        tenants_.erase(iter);
+      }
+    }
+  }
+  LOG(INFO) << "Set the quota of tenant '" << tenant << "' to " << quota;
+  return Status::OK();
+}
+
+ptree BulkStore::TenantUsage() const {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  ptree usage;
+  for (auto const& item : tenants_) {
+    ptree tenant;
+    tenant.put("usage", item.second.usage);
+    tenant.put("quota",
+               item.second.quota != 0 ? item.second.quota : default_quota_);
+    tenant.put("objects", item.second.objects);
+    tenant.put("rejected", item.second.rejected);
+    // the names of tenants may contain '.', which `put_child` would split
+    usage.push_back(std::make_pair(item.first, tenant));
+  }
+  return usage;
+}
+
 Status BulkStore::ProcessGetRequest(const ObjectID id,
                                     std::shared_ptr<Payload>& object) {
-  if (objects_.find(id) == objects_.end()) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (objects_.find(id) == objects_.end() ||
+      deleting_.find(id) != deleting_.end()) {
     return Status::ObjectNotExists();
   } else {
     object = objects_[id];
+    RETURN_ON_ERROR(ReloadIfSpilled(object));
+    RecordAccess(object);
     return Status::OK();
   }
 }
@@ -104,21 +642,79 @@ Status BulkStore::ProcessGetRequest(const ObjectID id,
 Status BulkStore::ProcessGetRequest(
     const std::vector<ObjectID>& ids,
     std::vector<std::shared_ptr<Payload>>& objects) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  // Pin the resolved blobs during the request to avoid evicting them when
+  // loading other spilled blobs of the same request, only the blobs that are
+  // resolved by this call are unpinned, rather than the ones the caller has
+  // put in `objects` before.
+  size_t const pinned_from = objects.size();
+  auto status = Status::OK();
   for (auto object_id : ids) {
-    if (objects_.find(object_id) != objects_.end()) {
-      objects.push_back(objects_[object_id]);
+    if (objects_.find(object_id) != objects_.end() &&
+        deleting_.find(object_id) == deleting_.end()) {
+      auto& object = objects_[object_id];
+      status = ReloadIfSpilled(object);
+      if (!status.ok()) {
+        break;
+      }
+      RecordAccess(object);
+      object->ref_cnt += 1;
+      objects.push_back(object);
     }
   }
-  return Status::OK();
+  for (size_t i = pinned_from; i < objects.size(); ++i) {
+    objects[i]->ref_cnt -= 1;
+  }
+  return status;
 }
 
 Status BulkStore::ProcessDeleteRequest(const ObjectID& object_id) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   if (objects_.find(object_id) == objects_.end()) {
     return Status::ObjectNotExists();
   }
   auto& object = objects_[object_id];
   auto buff_size = object->data_size;
-  BulkAllocator::Free(object->pointer, buff_size);
+  auto content_iter = content_of_.find(object_id);
+  auto region_iter = region_of_.find(object_id);
+  auto compressed_iter = compressed_.find(object_id);
+  if (content_iter != content_of_.end() &&
+      contents_.at(content_iter->second).alive_blobs > 1) {
+    // the memory is still used by other blobs of the same content
+    contents_.at(content_iter->second).alive_blobs -= 1;
+    content_of_.erase(content_iter);
+    deduped_objects_ -= 1;
+    deduped_size_ -= buff_size;
+  } else if (region_iter != region_of_.end()) {
+    auto& region = regions_.at(region_iter->second);
+    region.alive_blobs -= 1;
+    if (region.alive_blobs == 0) {
+      FreeMemory(region.pointer, region.size, region.numa_node);
+      regions_.erase(region_iter->second);
+    }
+    region_of_.erase(region_iter);
+  } else if (compressed_iter != compressed_.end()) {
+    FreeMemory(compressed_iter->second.pointer, compressed_iter->second.size,
+               object->numa_node);
+    compressed_size_ -= compressed_iter->second.size;
+    compressed_.erase(compressed_iter);
+  } else if (object->is_spilled) {
+    unlink(SpillFilePath(object_id).c_str());
+    spilled_objects_ -= 1;
+    spilled_size_ -= buff_size;
+  } else {
+    DropContent(object_id);
+    FreeMemory(object->pointer, buff_size, object->numa_node);
+  }
+  UnchargeTenant(object_id);
+  ForgetObject(object_id);
+  JournalDelete(object_id);
+  if (deleting_.erase(object_id) > 0) {
+    deleting_size_ -= buff_size;
+  }
+  dedup_deferred_.erase(object_id);
+  incompressible_.erase(object_id);
+  replicas_.erase(object_id);
   objects_.erase(object_id);
 #ifndef NDEBUG
   VLOG(10) << "after free: " << Footprint() << "(" << FootprintLimit() << ")";
@@ -126,10 +722,895 @@ Status BulkStore::ProcessDeleteRequest(const ObjectID& object_id) {
   return Status::OK();
 }
 
+Status BulkStore::ProcessDeferredDeleteRequest(const ObjectID& object_id) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  auto object = objects_.find(object_id);
+  if (object == objects_.end() ||
+      deleting_.find(object_id) != deleting_.end()) {
+    return Status::ObjectNotExists();
+  }
+  if (object->second->ref_cnt == 0) {
+    return ProcessDeleteRequest(object_id);
+  }
+  // still mapped by clients, which may read or write it until they release
+  // it, the memory is freed in `DecreaseReferenceCount`
+  deleting_.emplace(object_id);
+  deleting_size_ += object->second->data_size;
+  dedup_deferred_.erase(object_id);
+  return Status::OK();
+}
+
+size_t BulkStore::PinnedObjects() const {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  size_t pinned = 0;
+  for (auto const& object : objects_) {
+    if (object.second->ref_cnt > 0) {
+      pinned += 1;
+    }
+  }
+  return pinned;
+}
+
+template <typename Compare>
+void BulkStore::RankObjects(const size_t limit, Compare before,
+                            std::vector<BlobAccess>& blobs) const {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  std::vector<Payload const*> ranked;
+  ranked.reserve(objects_.size());
+  for (auto const& item : objects_) {
+    if (deleting_.find(item.first) == deleting_.end()) {
+      ranked.emplace_back(item.second.get());
+    }
+  }
+  size_t count = std::min(limit, ranked.size());
+  std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                    [&before](Payload const* lhs, Payload const* rhs) {
+                      return before(*lhs, *rhs);
+                    });
+  for (size_t i = 0; i < count; ++i) {
+    blobs.emplace_back(BlobAccess{
+        ranked[i]->object_id, ranked[i]->data_size, ranked[i]->access_count,
+        ranked[i]->last_access, static_cast<uint64_t>(ranked[i]->ref_cnt)});
+  }
+}
+
+void BulkStore::HotObjects(const size_t limit,
+                           std::vector<BlobAccess>& blobs) const {
+  RankObjects(
+      limit,
+      [](Payload const& lhs, Payload const& rhs) {
+        return lhs.access_count > rhs.access_count ||
+               (lhs.access_count == rhs.access_count &&
+                lhs.last_access > rhs.last_access);
+      },
+      blobs);
+}
+
+void BulkStore::ColdObjects(const size_t limit,
+                            std::vector<BlobAccess>& blobs) const {
+  RankObjects(
+      limit,
+      [](Payload const& lhs, Payload const& rhs) {
+        return lhs.last_access < rhs.last_access;
+      },
+      blobs);
+}
+
+Status BulkStore::ProcessPromoteReplicaRequest(const ObjectID id,
+                                               const ObjectID origin_id) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  auto iter = objects_.find(id);
+  if (iter == objects_.end()) {
+    return Status::ObjectNotExists();
+  }
+  if (objects_.find(origin_id) != objects_.end()) {
+    return Status::ObjectExists();
+  }
+  // sub-blobs and spilled blobs are located by their own ids
+  RETURN_ON_ASSERT(region_of_.find(id) == region_of_.end() &&
+                   compressed_.find(id) == compressed_.end() &&
+                   !iter->second->is_spilled);
+  auto content = content_of_.find(id);
+  RETURN_ON_ASSERT(content == content_of_.end() ||
+                   contents_.at(content->second).alive_blobs == 1);
+  DropContent(id);
+  auto object = iter->second;
+  std::string tenant = UnchargeTenant(id);
+  ForgetObject(id);
+  objects_.erase(iter);
+  object->object_id = origin_id;
+  objects_.emplace(origin_id, object);
+  replicas_.emplace(origin_id);
+  ChargeTenant(tenant, origin_id, object->data_size);
+  TouchObject(origin_id);
+  JournalDelete(id);
+  JournalCreate(object);
+  return Status::OK();
+}
+
+Status BulkStore::ProcessSplitRequest(const ObjectID id,
+                                      std::vector<size_t> const& offsets,
+                                      std::vector<size_t> const& sizes,
+                                      std::vector<ObjectID>& sub_ids) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (objects_.find(id) == objects_.end()) {
+    return Status::ObjectNotExists();
+  }
+  if (region_of_.find(id) != region_of_.end()) {
+    return Status::Invalid("The blob " + VYObjectIDToString(id) +
+                           " has already been split");
+  }
+  auto content = content_of_.find(id);
+  if (content != content_of_.end() &&
+      contents_.at(content->second).alive_blobs > 1) {
+    return Status::Invalid("The blob " + VYObjectIDToString(id) +
+                           " shares the memory with other blobs");
+  }
+  RETURN_ON_ASSERT(offsets.size() == sizes.size());
+  auto region_object = objects_[id];
+  RETURN_ON_ERROR(ReloadIfSpilled(region_object));
+  size_t end = 0;
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    if (offsets[i] < end || offsets[i] % sizeof(size_t) != 0 ||
+        sizes[i] == 0 ||
+        offsets[i] + sizes[i] >
+            static_cast<size_t>(region_object->data_size)) {
+      return Status::Invalid("Invalid sub-blob at offset " +
+                             std::to_string(offsets[i]) + " of size " +
+                             std::to_string(sizes[i]));
+    }
+    end = offsets[i] + sizes[i];
+  }
+
+  DropContent(id);
+  JournalDelete(id);
+  // the sub-blobs are accounted to the tenant of the blob instead
+  std::string tenant = UnchargeTenant(id);
+  objects_.erase(id);
+  ForgetObject(id);
+  if (offsets.empty()) {
+    FreeMemory(region_object->pointer, region_object->data_size,
+               region_object->numa_node);
+    return Status::OK();
+  }
+  uintptr_t region_key = reinterpret_cast<uintptr_t>(region_object->pointer);
+  regions_.emplace(region_key,
+                   Region{region_object->pointer,
+                          static_cast<size_t>(region_object->data_size),
+                          region_object->numa_node, offsets.size()});
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    uint8_t* pointer = region_object->pointer + offsets[i];
+    ObjectID sub_id = GenerateBlobID(pointer);
+    // The address may still be used as the id of a spilled blob, since the
+    // offsets are aligned, ids in the gap never conflict with addresses.
+    while (objects_.find(sub_id) != objects_.end()) {
+      sub_id += 1;
+    }
+    auto object = std::make_shared<Payload>(
+        sub_id, sizes[i], pointer, region_object->store_fd,
+        region_object->map_size, region_object->data_offset + offsets[i]);
+    object->numa_node = region_object->numa_node;
+    objects_.emplace(sub_id, object);
+    region_of_.emplace(sub_id, region_key);
+    ChargeTenant(tenant, sub_id, sizes[i]);
+    TouchObject(sub_id);
+    sub_ids.emplace_back(sub_id);
+  }
+  return Status::OK();
+}
+
+Status BulkStore::IncreaseReferenceCount(const ObjectID& id) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  auto object = objects_.find(id);
+  if (object == objects_.end()) {
+    return Status::ObjectNotExists();
+  }
+  object->second->ref_cnt += 1;
+  return Status::OK();
+}
+
+Status BulkStore::DecreaseReferenceCount(const ObjectID& id) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  auto object = objects_.find(id);
+  if (object == objects_.end()) {
+    return Status::ObjectNotExists();
+  }
+  if (object->second->ref_cnt > 0) {
+    object->second->ref_cnt -= 1;
+  }
+  if (object->second->ref_cnt == 0 &&
+      deleting_.find(id) != deleting_.end()) {
+    // the last client that mapped the deleted blob has released it
+    return ProcessDeleteRequest(id);
+  }
+  if (object->second->ref_cnt == 0 &&
+      dedup_deferred_.find(id) != dedup_deferred_.end()) {
+    Seal(id);
+  }
+  return Status::OK();
+}
+
+void BulkStore::ListUnreferenced(std::vector<ObjectID>& ids) const {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  for (auto const& object : objects_) {
+    if (object.second->ref_cnt == 0) {
+      ids.emplace_back(object.first);
+    }
+  }
+}
+
+Status BulkStore::DeleteUnreferenced(const std::vector<ObjectID>& ids,
+                                     size_t& deleted) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  deleted = 0;
+  for (auto const& id : ids) {
+    auto object = objects_.find(id);
+    if (object == objects_.end() || object->second->ref_cnt > 0) {
+      continue;
+    }
+    RETURN_ON_ERROR(ProcessDeleteRequest(id));
+    deleted += 1;
+  }
+  return Status::OK();
+}
+
 size_t BulkStore::Footprint() const { return BulkAllocator::Allocated(); }
 
 size_t BulkStore::FootprintLimit() const {
   return BulkAllocator::GetFootprintLimit();
 }
 
+Status BulkStore::AdmitTenant(std::string const& tenant, size_t const size) {
+  if (tenant.empty()) {
+    return Status::OK();
+  }
+  auto iter = tenants_.find(tenant);
+  size_t usage = iter == tenants_.end() ? 0 : iter->second.usage;
+  size_t quota = (iter == tenants_.end() || iter->second.quota == 0)
+                     ? default_quota_
+                     : iter->second.quota;
+  if (quota == 0 || usage + size <= quota) {
+    return Status::OK();
+  }
+  tenants_[tenant].rejected += 1;
+  return Status::NotEnoughMemory("The tenant '" + tenant + "' uses " +
+                                 std::to_string(usage) + " bytes of its " +
+                                 "quota " + std::to_string(quota) +
+                                 ", can't create another " +
+                                 std::to_string(size) + " bytes");
+}
+
+void BulkStore::ChargeTenant(std::string const& tenant, ObjectID const id,
+                             size_t const size) {
+  if (tenant.empty()) {
+    return;
+  }
+  auto& state = tenants_[tenant];
+  state.usage += size;
+  state.objects += 1;
+  tenant_of_[id] = tenant;
+}
+
+std::string BulkStore::UnchargeTenant(ObjectID const id) {
+  auto iter = tenant_of_.find(id);
+  if (iter == tenant_of_.end()) {
+    return std::string();
+  }
+  std::string tenant = std::move(iter->second);
+  tenant_of_.erase(iter);
+  auto state = tenants_.find(tenant);
+  if (state != tenants_.end()) {
+    auto object = objects_.find(id);
+    if (object != objects_.end()) {
+      state->second.usage -= object->second->data_size;
+    }
+    state->second.objects -= 1;
+    if (state->second.objects == 0 && state->second.quota == 0 &&
+        state->second.rejected == 0) {
+      tenants_.erase(state);
+    }
+  }
+  return tenant;
+}
+
+Status BulkStore::SpillColdObjects(size_t const required_size) {
+  size_t spilled = 0;
+  auto iter = lru_.begin();
+  while (iter != lru_.end() && spilled < required_size) {
+    auto& object = objects_.at(*iter);
+    // advance before spilling, since spilling removes the entry from lru_.
+    ++iter;
+    // sub-blobs share the memory region, as well as the deduplicated blobs,
+    // thus cannot be released alone.
+    auto content = content_of_.find(object->object_id);
+    if (object->ref_cnt > 0 ||
+        region_of_.find(object->object_id) != region_of_.end() ||
+        (content != content_of_.end() &&
+         contents_.at(content->second).alive_blobs > 1)) {
+      continue;
+    }
+    RETURN_ON_ERROR(Spill(object));
+    spilled += object->data_size;
+  }
+  if (spilled == 0) {
+    return Status::NotEnoughMemory("No blob can be spilled to release " +
+                                   std::to_string(required_size) + " bytes");
+  }
+  return Status::OK();
+}
+
+Status BulkStore::EvictReplicas(size_t const required_size) {
+  size_t evicted = 0;
+  auto iter = lru_.begin();
+  while (iter != lru_.end() && evicted < required_size) {
+    ObjectID const id = *iter;
+    // advance before deleting, since deleting removes the entry from lru_.
+    ++iter;
+    if (replicas_.find(id) == replicas_.end()) {
+      continue;
+    }
+    auto const& object = objects_.at(id);
+    if (object->ref_cnt > 0) {
+      continue;
+    }
+    size_t const size = object->data_size;
+    RETURN_ON_ERROR(ProcessDeleteRequest(id));
+    evicted += size;
+  }
+  if (evicted == 0) {
+    return Status::NotEnoughMemory("No replica can be evicted to release " +
+                                   std::to_string(required_size) + " bytes");
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Spill(std::shared_ptr<Payload> const& object) {
+  std::string path = SpillFilePath(object->object_id);
+  int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  if (fd < 0) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  int64_t written = 0;
+  while (written < object->data_size) {
+    ssize_t nbytes = write(fd, object->pointer + written,
+                           object->data_size - written);
+    if (nbytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      auto status = Status::IOError("Failed to spill blob to '" + path +
+                                    "': " + strerror(errno));
+      close(fd);
+      unlink(path.c_str());
+      return status;
+    }
+    written += nbytes;
+  }
+  close(fd);
+
+  DropContent(object->object_id);
+  FreeMemory(object->pointer, object->data_size, object->numa_node);
+  object->pointer = nullptr;
+  object->store_fd = -1;
+  object->map_size = 0;
+  object->data_offset = 0;
+  object->is_spilled = true;
+  spilled_objects_ += 1;
+  spilled_size_ += object->data_size;
+  ForgetObject(object->object_id);
+  JournalDelete(object->object_id);
+  VLOG(10) << "spill blob " << VYObjectIDToString(object->object_id) << " ("
+           << object->data_size << " bytes) to " << path;
+  return Status::OK();
+}
+
+Status BulkStore::ReloadIfSpilled(std::shared_ptr<Payload> const& object) {
+  if (compressed_.find(object->object_id) != compressed_.end()) {
+    return DecompressObject(object);
+  }
+  if (!object->is_spilled) {
+    TouchObject(object->object_id);
+    return Status::OK();
+  }
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer =
+      AllocateMemoryWithSpill(object->data_size, object->numa_node, &fd,
+                              &map_size, &offset, object->alignment);
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory("Failed to reload spilled blob, size = " +
+                                   std::to_string(object->data_size));
+  }
+  std::string path = SpillFilePath(object->object_id);
+  int spill_fd = open(path.c_str(), O_RDONLY);
+  if (spill_fd < 0) {
+    FreeMemory(pointer, object->data_size, object->numa_node);
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  int64_t loaded = 0;
+  while (loaded < object->data_size) {
+    ssize_t nbytes =
+        read(spill_fd, pointer + loaded, object->data_size - loaded);
+    if (nbytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      auto status = Status::IOError("Failed to reload blob from '" + path +
+                                    "': " + strerror(errno));
+      close(spill_fd);
+      FreeMemory(pointer, object->data_size, object->numa_node);
+      return status;
+    }
+    loaded += nbytes;
+  }
+  close(spill_fd);
+  unlink(path.c_str());
+
+  object->pointer = pointer;
+  object->store_fd = fd;
+  object->map_size = map_size;
+  object->data_offset = offset;
+  object->is_spilled = false;
+  spilled_objects_ -= 1;
+  spilled_size_ -= object->data_size;
+  TouchObject(object->object_id);
+  JournalCreate(object);
+  // the content is deduplicated again
+  Seal(object->object_id);
+  VLOG(10) << "reload blob " << VYObjectIDToString(object->object_id) << " ("
+           << object->data_size << " bytes) from " << path;
+  return Status::OK();
+}
+
+std::string BulkStore::SpillFilePath(ObjectID const id) const {
+  return spill_path_ + VYObjectIDToString(id);
+}
+
+Status BulkStore::RecoverBlobs(std::string const& journal_path) {
+  struct Entry {
+    ptrdiff_t offset;
+    int64_t size;
+    bool replica;
+    size_t alignment;
+  };
+  std::unordered_map<ObjectID, Entry> entries;
+  {
+    std::ifstream in(journal_path);
+    std::string line;
+    if (in && std::getline(in, line) && line != kJournalMagic) {
+      return Status::Invalid("Not a journal of the persistent arena: " +
+                             journal_path);
+    }
+    while (std::getline(in, line)) {
+      std::istringstream record(line);
+      std::string kind, id;
+      Entry entry{0, 0, false, 0};
+      record >> kind >> id;
+      if (record && kind == "d") {
+        entries.erase(VYObjectIDFromString(id));
+        continue;
+      }
+      record >> entry.offset >> entry.size;
+      if (!record || (kind != "b" && kind != "r")) {
+        // the last record may have been partially written
+        LOG(WARNING) << "Skip the malformed record in " << journal_path
+                     << ": " << line;
+        continue;
+      }
+      entry.replica = kind == "r";
+      if (!(record >> entry.alignment)) {
+        entry.alignment = 0;
+      }
+      entries[VYObjectIDFromString(id)] = entry;
+    }
+  }
+
+  std::unordered_map<uint8_t*, size_t> chunks;
+  plasma::InspectPersistentArena([&chunks](void* pointer, size_t size) {
+    chunks.emplace(static_cast<uint8_t*>(pointer), size);
+  });
+  size_t recovered = 0, recovered_size = 0;
+  for (auto const& item : entries) {
+    auto chunk = chunks.find(arena_base_ + item.second.offset);
+    if (chunk == chunks.end() ||
+        chunk->second < static_cast<size_t>(item.second.size)) {
+      LOG(WARNING) << "The memory of blob " << VYObjectIDToString(item.first)
+                   << " has been lost";
+      continue;
+    }
+    int fd = -1;
+    int64_t map_size = 0;
+    ptrdiff_t offset = 0;
+    GetMallocMapinfo(chunk->first, &fd, &map_size, &offset);
+    auto object = std::make_shared<Payload>(
+        item.first, item.second.size, chunk->first, fd, map_size, offset);
+    object->numa_node = -1;
+    object->alignment = item.second.alignment;
+    objects_.emplace(item.first, object);
+    if (item.second.replica) {
+      replicas_.emplace(item.first);
+    }
+    TouchObject(item.first);
+    BulkAllocator::Adopt(item.second.size);
+    chunks.erase(chunk);
+    recovered += 1;
+    recovered_size += item.second.size;
+  }
+  // e.g., the blobs that were being created, or the memory of split blobs
+  for (auto const& chunk : chunks) {
+    plasma::NumaFree(-1, chunk.first);
+  }
+
+  // compact the journal, aside and renamed
+  std::string temp_path = journal_path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::out | std::ios::trunc);
+    if (!out) {
+      return Status::IOError("Failed to create '" + temp_path +
+                             "': " + strerror(errno));
+    }
+    out << kJournalMagic << "\n";
+    for (auto const& object : objects_) {
+      out << blobRecord(replicas_.find(object.first) != replicas_.end(),
+                        object.first, object.second->data_offset,
+                        object.second->data_size, object.second->alignment);
+    }
+    out.close();
+    if (!out) {
+      return Status::IOError("Failed to write '" + temp_path + "'");
+    }
+  }
+  if (rename(temp_path.c_str(), journal_path.c_str()) != 0) {
+    return Status::IOError("Failed to rename '" + temp_path +
+                           "': " + strerror(errno));
+  }
+  journal_fd_ = open(journal_path.c_str(), O_WRONLY | O_APPEND);
+  if (journal_fd_ < 0) {
+    return Status::IOError("Failed to open '" + journal_path +
+                           "': " + strerror(errno));
+  }
+  if (recovered > 0 || !chunks.empty()) {
+    LOG(INFO) << "Recovered " << recovered << " blobs (" << recovered_size
+              << " bytes) from the persistent arena, and released "
+              << chunks.size() << " allocations that no blob owns";
+  }
+  return Status::OK();
+}
+
+void BulkStore::JournalCreate(std::shared_ptr<Payload> const& object) {
+  if (journal_fd_ < 0) {
+    return;
+  }
+  appendRecord(journal_fd_,
+               blobRecord(replicas_.find(object->object_id) != replicas_.end(),
+                          object->object_id, object->data_offset,
+                          object->data_size, object->alignment));
+}
+
+void BulkStore::JournalDelete(ObjectID const id) {
+  if (journal_fd_ < 0) {
+    return;
+  }
+  appendRecord(journal_fd_, "d " + VYObjectIDToString(id) + "\n");
+}
+
+void BulkStore::TouchObject(ObjectID const id) {
+  auto iter = lru_index_.find(id);
+  if (iter != lru_index_.end()) {
+    lru_.splice(lru_.end(), lru_, iter->second);
+  } else {
+    lru_index_.emplace(id, lru_.insert(lru_.end(), id));
+  }
+  touched_at_[id] = std::chrono::steady_clock::now();
+}
+
+void BulkStore::RecordAccess(std::shared_ptr<Payload> const& object) {
+  object->access_count += 1;
+  object->last_access = currentMillis();
+}
+
+void BulkStore::ReleaseTemporaryPin(std::shared_ptr<Payload> const& object) {
+  object->ref_cnt -= 1;
+  ObjectID const id = object->object_id;
+  auto iter = objects_.find(id);
+  if (object->ref_cnt == 0 && iter != objects_.end() &&
+      iter->second == object && deleting_.find(id) != deleting_.end()) {
+    VINEYARD_SUPPRESS(ProcessDeleteRequest(id));
+  }
+}
+
+void BulkStore::ForgetObject(ObjectID const id) {
+  auto iter = lru_index_.find(id);
+  if (iter != lru_index_.end()) {
+    lru_.erase(iter->second);
+    lru_index_.erase(iter);
+  }
+  touched_at_.erase(id);
+}
+
+void BulkStore::DedupLoop() {
+  while (true) {
+    ObjectID id;
+    {
+      std::unique_lock<std::mutex> lock(dedup_mutex_);
+      dedup_cv_.wait(lock, [this]() {
+        return dedup_stopped_ || !dedup_queue_.empty();
+      });
+      if (dedup_stopped_) {
+        return;
+      }
+      id = dedup_queue_.front();
+      dedup_queue_.pop_front();
+    }
+    auto status = Dedup(id);
+    if (!status.ok()) {
+      VLOG(10) << "Failed to deduplicate blob " << VYObjectIDToString(id)
+               << ": " << status.ToString();
+    }
+  }
+}
+
+Status BulkStore::Dedup(ObjectID const id) {
+  std::shared_ptr<Payload> object;
+  uint64_t hash = 0;
+  bool hashed = false;
+  {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    auto iter = objects_.find(id);
+    if (iter == objects_.end()) {
+      return Status::ObjectNotExists();
+    }
+    object = iter->second;
+    // spilled blobs are queued again once being reloaded, replicas are
+    // evicted alone.
+    if (object->data_size == 0 || object->is_spilled ||
+        deleting_.find(id) != deleting_.end() ||
+        compressed_.find(id) != compressed_.end() ||
+        region_of_.find(id) != region_of_.end() ||
+        replicas_.find(id) != replicas_.end() ||
+        content_of_.find(id) != content_of_.end()) {
+      return Status::OK();
+    }
+    auto deferred = dedup_deferred_.find(id);
+    if (deferred != dedup_deferred_.end()) {
+      hash = deferred->second;
+      hashed = true;
+      dedup_deferred_.erase(deferred);
+    }
+    // pin the blob to avoid spilling it during hashing
+    object->ref_cnt += 1;
+  }
+  if (!hashed) {
+    hash = XXH3_64bits(object->pointer, object->data_size);
+  }
+
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  ReleaseTemporaryPin(object);
+  auto iter = objects_.find(id);
+  if (iter == objects_.end() || iter->second != object ||
+      deleting_.find(id) != deleting_.end()) {
+    // deleted during hashing
+    return Status::OK();
+  }
+  size_t const size = object->data_size;
+  auto candidates = content_index_.equal_range(hash);
+  for (auto candidate = candidates.first; candidate != candidates.second;
+       ++candidate) {
+    auto& content = contents_.at(candidate->second);
+    // the memory merged into must be at least as aligned as the blob
+    if (content.size != size ||
+        (object->alignment > 0 &&
+         content.data_offset % object->alignment != 0) ||
+        memcmp(content.pointer, object->pointer, size) != 0) {
+      continue;
+    }
+    if (object->ref_cnt > 0) {
+      // the memory may still be mapped by clients
+      dedup_deferred_.emplace(id, hash);
+      return Status::OK();
+    }
+    FreeMemory(object->pointer, size, object->numa_node);
+    object->pointer = content.pointer;
+    object->store_fd = content.store_fd;
+    object->map_size = content.map_size;
+    object->data_offset = content.data_offset;
+    object->numa_node = content.numa_node;
+    content.alive_blobs += 1;
+    content_of_.emplace(id, candidate->second);
+    JournalDelete(id);
+    deduped_objects_ += 1;
+    deduped_size_ += size;
+    VLOG(10) << "deduplicate blob " << VYObjectIDToString(id) << " ("
+             << size << " bytes)";
+    return Status::OK();
+  }
+  uintptr_t key = reinterpret_cast<uintptr_t>(object->pointer);
+  contents_.emplace(key, Content{object->pointer, size, object->numa_node,
+                                 object->store_fd, object->map_size,
+                                 object->data_offset, hash, 1});
+  content_index_.emplace(hash, key);
+  content_of_.emplace(id, key);
+  return Status::OK();
+}
+
+void BulkStore::DropContent(ObjectID const id) {
+  auto iter = content_of_.find(id);
+  if (iter == content_of_.end()) {
+    return;
+  }
+  uintptr_t const key = iter->second;
+  auto candidates = content_index_.equal_range(contents_.at(key).hash);
+  for (auto candidate = candidates.first; candidate != candidates.second;
+       ++candidate) {
+    if (candidate->second == key) {
+      content_index_.erase(candidate);
+      break;
+    }
+  }
+  contents_.erase(key);
+  content_of_.erase(iter);
+}
+
+void BulkStore::CompressLoop() {
+  auto const interval = std::max(
+      std::chrono::duration_cast<std::chrono::seconds>(compress_after_ / 4),
+      std::chrono::seconds(1));
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(compress_mutex_);
+      if (compress_cv_.wait_for(lock, interval,
+                                [this]() { return compress_stopped_; })) {
+        return;
+      }
+    }
+    CompressColdObjects();
+  }
+}
+
+void BulkStore::CompressColdObjects() {
+  std::vector<ObjectID> cold;
+  {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    auto const deadline = std::chrono::steady_clock::now() - compress_after_;
+    for (auto const id : lru_) {
+      // the rest of the LRU list are accessed later
+      if (touched_at_.at(id) > deadline) {
+        break;
+      }
+      cold.emplace_back(id);
+    }
+  }
+  for (auto const id : cold) {
+    if (background_ != nullptr) {
+      background_->Yield(BackgroundScheduler::Priority::kLow);
+    }
+    auto status = CompressObject(id);
+    if (!status.ok()) {
+      VLOG(10) << "Failed to compress blob " << VYObjectIDToString(id) << ": "
+               << status.ToString();
+    }
+  }
+}
+
+Status BulkStore::CompressObject(ObjectID const id) {
+  std::shared_ptr<Payload> object;
+  std::chrono::steady_clock::time_point touched_at;
+  {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    auto iter = objects_.find(id);
+    auto touched = touched_at_.find(id);
+    if (iter == objects_.end() || touched == touched_at_.end()) {
+      return Status::OK();
+    }
+    object = iter->second;
+    touched_at = touched->second;
+    // the blob may have been got since the cold ones were collected, and the
+    // get may still be reading it on another thread, thus the coldness is
+    // checked again under the lock, and the unchanged `touched_at` after
+    // compressing tells no get has happened since then.
+    if (touched_at > std::chrono::steady_clock::now() - compress_after_) {
+      return Status::OK();
+    }
+    // only the blobs that own their memory alone are compressed, replicas
+    // are evicted instead.
+    auto content = content_of_.find(id);
+    if (object->ref_cnt > 0 || object->data_size < kMinCompressSize ||
+        deleting_.find(id) != deleting_.end() ||
+        region_of_.find(id) != region_of_.end() ||
+        replicas_.find(id) != replicas_.end() ||
+        incompressible_.find(id) != incompressible_.end() ||
+        (content != content_of_.end() &&
+         contents_.at(content->second).alive_blobs > 1)) {
+      return Status::OK();
+    }
+    // pin the blob to avoid spilling it during compressing
+    object->ref_cnt += 1;
+  }
+  std::string compressed;
+  auto status = Compress(compress_codec_, object->pointer, object->data_size,
+                         compressed);
+
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  ReleaseTemporaryPin(object);
+  RETURN_ON_ERROR(status);
+  auto iter = objects_.find(id);
+  auto touched = touched_at_.find(id);
+  if (iter == objects_.end() || iter->second != object ||
+      object->ref_cnt > 0 || deleting_.find(id) != deleting_.end() ||
+      touched == touched_at_.end() ||
+      touched->second != touched_at) {
+    // deleted or accessed during compressing
+    return Status::OK();
+  }
+  if (static_cast<int64_t>(compressed.size()) * kCompressRatioDenominator >
+      object->data_size * kCompressRatioNumerator) {
+    incompressible_.emplace(id);
+    return Status::OK();
+  }
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer = AllocateMemory(compressed.size(), object->numa_node, &fd,
+                                    &map_size, &offset);
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory("Failed to hold the compressed blob, "
+                                   "size = " +
+                                   std::to_string(compressed.size()));
+  }
+  memcpy(pointer, compressed.data(), compressed.size());
+  DropContent(id);
+  FreeMemory(object->pointer, object->data_size, object->numa_node);
+  object->pointer = nullptr;
+  object->store_fd = -1;
+  object->map_size = 0;
+  object->data_offset = 0;
+  compressed_.emplace(id, Compressed{pointer, compressed.size()});
+  compressed_size_ += compressed.size();
+  ForgetObject(id);
+  JournalDelete(id);
+  VLOG(10) << "compress blob " << VYObjectIDToString(id) << " ("
+           << object->data_size << " bytes) to " << compressed.size()
+           << " bytes";
+  return Status::OK();
+}
+
+Status BulkStore::DecompressObject(std::shared_ptr<Payload> const& object) {
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer =
+      AllocateMemoryWithSpill(object->data_size, object->numa_node, &fd,
+                              &map_size, &offset, object->alignment);
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory(
+        "Failed to decompress compressed blob, size = " +
+        std::to_string(object->data_size));
+  }
+  auto iter = compressed_.find(object->object_id);
+  auto status = Decompress(compress_codec_, iter->second.pointer,
+                           iter->second.size, pointer, object->data_size);
+  if (!status.ok()) {
+    FreeMemory(pointer, object->data_size, object->numa_node);
+    return status;
+  }
+  FreeMemory(iter->second.pointer, iter->second.size, object->numa_node);
+  compressed_size_ -= iter->second.size;
+  compressed_.erase(iter);
+
+  object->pointer = pointer;
+  object->store_fd = fd;
+  object->map_size = map_size;
+  object->data_offset = offset;
+  TouchObject(object->object_id);
+  JournalCreate(object);
+  // the content is deduplicated again
+  Seal(object->object_id);
+  VLOG(10) << "decompress blob " << VYObjectIDToString(object->object_id)
+           << " (" << object->data_size << " bytes)";
+  return Status::OK();
+}
+
 }  // namespace vineyard
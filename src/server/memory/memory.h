@@ -29,21 +29,200 @@
 #ifndef SRC_SERVER_MEMORY_MEMORY_H_
 #define SRC_SERVER_MEMORY_MEMORY_H_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "common/memory/payload.h"
+#include "common/util/boost.h"
 #include "common/util/status.h"
+#include "server/memory/slab_allocator.h"
+#include "server/util/background_scheduler.h"
 
 namespace vineyard {
 
+/**
+ * @brief BulkStore manages the blobs in the shared memory arena.
+ *
+ * When a spill path is configured, cold blobs that are not referenced by any
+ * alive client will be spilled to the disk in LRU order when the shared memory
+ * is exhausted, and be loaded back on the next access.
+ *
+ * The bulk store may also cache the replicas of the blobs on other instances,
+ * under the ids of the origin blobs. The replicas that are not referenced are
+ * evicted, in LRU order, before spilling any blob.
+ *
+ * When dedup is enabled, the sealed blobs are hashed in the background and
+ * the blobs of the same content collapse to one allocation, which is shared
+ * by their ids and released once the last of them has been deleted.
+ *
+ * When compression is enabled, the blobs that haven't been accessed for a
+ * while are compressed inside the shared memory in the background, and are
+ * decompressed on the next access, which is cheaper than spilling them.
+ *
+ * The shared memory can be put on a file, e.g., on a DAX filesystem, then
+ * the blobs survive the restarts of vineyardd.
+ *
+ * The blobs created on behalf of a tenant, e.g., the tag of a client or a
+ * client connection, are accounted to it, and the requests that would exceed
+ * the quota of the tenant are rejected, thus a runaway tenant can't exhaust
+ * the shared memory for the others.
+ */
 class BulkStore {
  public:
-  Status PreAllocate(const size_t size);
+  ~BulkStore();
+
+  /**
+   * @brief Pre-allocate the shared memory, backs it with huge pages of the
+   * given size (2MiB or 1GiB) if huge_page_size is not 0.
+   *
+   * Only `reserve_size` bytes are mapped up front if it is not 0 and less
+   * than `size`, the store grows in more segments on demand until `size`,
+   * and the segments that become empty are returned to the OS.
+   */
+  Status PreAllocate(const size_t size, const size_t huge_page_size = 0,
+                     const size_t reserve_size = 0);
+
+  /**
+   * @brief Change the limit of the shared memory at runtime. Lowering the
+   * limit doesn't evict blobs, but the blobs can't be created until the
+   * usage drops below it.
+   */
+  Status SetMemoryLimit(const size_t limit);
+
+  /**
+   * @brief Put the shared memory on the file instead, e.g., on a DAX
+   * filesystem or PMEM, a tmpfs or a hugetlbfs, which is created with the
+   * given size if it doesn't exist, and re-register the blobs that have been
+   * left on it by the previous vineyardd. It replaces `PreAllocate`.
+   *
+   * Small blobs are not placed in slabs then, NUMA arenas are not
+   * supported, and the blobs that have been split, deduplicated, compressed
+   * or spilled don't survive restarts.
+   */
+  Status OpenPersistentArena(std::string const& path, const size_t size);
+
+  /**
+   * @brief Enable spilling cold blobs to the given directory when the shared
+   * memory runs out. Spilling is disabled if the path is empty.
+   */
+  Status SetSpillPath(std::string const& spill_path);
+
+  /**
+   * @brief Place the default arena on the NUMA node, i.e., the blobs that
+   * aren't placed on a given node. It must be set before `PreAllocate`, and
+   * it doesn't apply to the persistent arena.
+   */
+  Status SetDefaultNumaNode(const int node);
+
+  /**
+   * @brief Hold one arena per NUMA node, blobs can then be placed on a given
+   * node when being created.
+   */
+  Status EnableNumaArenas();
+
+  /**
+   * @brief Start the background deduplication of the sealed blobs, see also
+   * `Seal`.
+   */
+  Status EnableDedup();
+
+  /**
+   * @brief Notify that the blob has been sealed, i.e., its content won't
+   * change anymore, and queue it for deduplication. It's a no-op if dedup
+   * is disabled.
+   *
+   * A blob whose memory is still used by any client is merged only after
+   * all of them have released it.
+   */
+  void Seal(const ObjectID id);
+
+  /**
+   * @brief Compress the blobs that are not referenced by any client and
+   * haven't been accessed in the last `cold_seconds` seconds with the codec,
+   * see also `Compress` in "common/util/compression.h".
+   */
+  Status EnableCompression(std::string const& codec, const int cold_seconds);
+
+  /**
+   * @brief The background threads of the store (e.g., the compression of
+   * cold blobs) yield to the foreground through the scheduler, which must
+   * outlive the store.
+   */
+  void SetBackgroundScheduler(BackgroundScheduler* background) {
+    background_ = background;
+  }
+
+  /**
+   * @brief Pre-fault the segments that have been mapped in background with
+   * the given number of threads, thus the first blobs don't pay for the
+   * page faults and the zeroing of pages. The threads are pinned to the
+   * given CPUs, or are spread across the NUMA nodes if no CPU is given, and
+   * the content of the memory is never changed.
+   *
+   * The progress is reported by `PrefaultSize` and `PrefaultedSize`.
+   */
+  Status Prefault(const int threads, std::vector<int> const& cpus = {});
 
+  /**
+   * @brief Create a blob, which will be allocated from the arena of
+   * numa_node when NUMA arenas are enabled, or from the default arena if
+   * numa_node is -1.
+   *
+   * The data of the blob is aligned to `alignment`, which must be a power
+   * of two and at most kMaxBlobAlignment, 0 means kBlockSize (or the size
+   * class of slabs for small blobs).
+   */
   Status ProcessCreateRequest(const size_t size, ObjectID& object_id,
-                              std::shared_ptr<Payload>& object);
+                              std::shared_ptr<Payload>& object,
+                              const int numa_node = -1,
+                              const size_t alignment = 0);
+
+  /**
+   * @brief Create a batch of blobs. Either all blobs are created, or none of
+   * them is created when the bulk store runs out of memory.
+   */
+  Status ProcessCreateRequest(const std::vector<size_t>& sizes,
+                              std::vector<std::shared_ptr<Payload>>& objects,
+                              const int numa_node = -1);
+
+  /**
+   * @brief Like `ProcessCreateRequest` above, but the blobs are accounted to
+   * the tenant, and are rejected if they would exceed the quota of the
+   * tenant. The blobs are not accounted if the tenant is empty.
+   */
+  Status ProcessCreateRequest(std::string const& tenant, const size_t size,
+                              ObjectID& object_id,
+                              std::shared_ptr<Payload>& object,
+                              const int numa_node = -1,
+                              const size_t alignment = 0);
+
+  Status ProcessCreateRequest(std::string const& tenant,
+                              const std::vector<size_t>& sizes,
+                              std::vector<std::shared_ptr<Payload>>& objects,
+                              const int numa_node = -1);
+
+  /**
+   * @brief Set the quota of the tenant in bytes, 0 means unlimited. The
+   * quota of "*" is the default one of the tenants that haven't got their
+   * own.
+   */
+  Status SetTenantQuota(std::string const& tenant, const size_t quota);
+
+  /**
+   * @brief The usage, quota, blobs and rejected requests of each tenant.
+   */
+  ptree TenantUsage() const;
 
   Status ProcessGetRequest(const ObjectID id, std::shared_ptr<Payload>& object);
 
@@ -56,13 +235,361 @@ class BulkStore {
 
   Status ProcessDeleteRequest(const ObjectID& id);
 
+  /**
+   * @brief Delete the blob once no client has it mapped. The blob is freed
+   * immediately if it isn't pinned, otherwise it vanishes from gets at once,
+   * and its memory is freed at the last `DecreaseReferenceCount`.
+   */
+  Status ProcessDeferredDeleteRequest(const ObjectID& id);
+
+  /**
+   * @brief The blobs that have been got the most times, the most recently
+   * accessed ones first among the ties, at most `limit` of them.
+   */
+  void HotObjects(const size_t limit, std::vector<BlobAccess>& blobs) const;
+
+  /**
+   * @brief The blobs that haven't been got (or created) for the longest
+   * time, at most `limit` of them.
+   */
+  void ColdObjects(const size_t limit, std::vector<BlobAccess>& blobs) const;
+
+  /**
+   * @brief Turn the blob, which has been filled with the payload of the
+   * remote blob `origin_id`, into the replica of it, the references of the
+   * blob are carried to the replica. Returns `ObjectExists` if the origin
+   * blob is already present.
+   */
+  Status ProcessPromoteReplicaRequest(const ObjectID id,
+                                      const ObjectID origin_id);
+
+  bool IsReplica(const ObjectID id) const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return replicas_.find(id) != replicas_.end();
+  }
+
+  bool Exists(const ObjectID id) const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return objects_.find(id) != objects_.end() &&
+           deleting_.find(id) == deleting_.end();
+  }
+
+  /**
+   * @brief Split a blob into sub-blobs at the given offsets and sizes, the
+   * original blob vanishes and the memory will be released once all its
+   * sub-blobs have been deleted (the gaps between sub-blobs are held until
+   * then as well). Offsets must be sorted, 8-bytes aligned and the sub-blobs
+   * must not overlap.
+   */
+  Status ProcessSplitRequest(const ObjectID id,
+                             std::vector<size_t> const& offsets,
+                             std::vector<size_t> const& sizes,
+                             std::vector<ObjectID>& sub_ids);
+
+  /**
+   * @brief Mark the blob as being used by a client, a blob that is referenced
+   * won't be spilled, nor freed when it is deleted, see also
+   * `ProcessDeferredDeleteRequest`.
+   */
+  Status IncreaseReferenceCount(const ObjectID& id);
+
+  Status DecreaseReferenceCount(const ObjectID& id);
+
+  /**
+   * @brief The blobs that are not cited by any client, i.e., the candidates
+   * of the garbage collection.
+   */
+  void ListUnreferenced(std::vector<ObjectID>& ids) const;
+
+  /**
+   * @brief Delete the given blobs that are (still) not cited by any client,
+   * blobs that have been cited in the meantime are kept.
+   */
+  Status DeleteUnreferenced(const std::vector<ObjectID>& ids,
+                            size_t& deleted);
+
   size_t Footprint() const;
   size_t FootprintLimit() const;
 
+  size_t SpilledObjects() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return spilled_objects_;
+  }
+  size_t SpilledSize() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return spilled_size_;
+  }
+
+  size_t DedupedObjects() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return deduped_objects_;
+  }
+  size_t DedupedSize() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return deduped_size_;
+  }
+
+  size_t CompressedObjects() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return compressed_.size();
+  }
+  size_t CompressedSize() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return compressed_size_;
+  }
+
+  /**
+   * @brief The number of blobs that are mapped by some client.
+   */
+  size_t PinnedObjects() const;
+
+  /**
+   * @brief The blobs that have been deleted but are still mapped by some
+   * client, and the bytes of them.
+   */
+  size_t DeletingObjects() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return deleting_.size();
+  }
+  size_t DeletingSize() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return deleting_size_;
+  }
+
+  size_t PrefaultSize() const { return prefault_size_; }
+  size_t PrefaultedSize() const { return prefaulted_size_; }
+
+  size_t SlabReserved() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return slab_allocator_.Reserved();
+  }
+  size_t SlabUsed() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return slab_allocator_.Used();
+  }
+  size_t SlabObjects() const {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
+    return slab_allocator_.Objects();
+  }
+
  private:
-  uint8_t* AllocateMemory(size_t size, int* fd, int64_t* map_size,
-                          ptrdiff_t* offset);
+  /**
+   * @brief Allocate memory for a blob, small blobs will be allocated from
+   * slabs.
+   */
+  uint8_t* AllocateMemory(size_t size, int numa_node, int* fd,
+                          int64_t* map_size, ptrdiff_t* offset,
+                          size_t alignment = 0);
+
+  void FreeMemory(uint8_t* pointer, size_t size, int numa_node);
+
+  /**
+   * @brief Check whether the tenant can create another `size` bytes, and
+   * count the rejection if it can't.
+   */
+  Status AdmitTenant(std::string const& tenant, size_t const size);
+
+  void ChargeTenant(std::string const& tenant, ObjectID const id,
+                    size_t const size);
+
+  /**
+   * @brief Release the accounting of the blob, returns the tenant that it
+   * has been accounted to, or an empty string.
+   */
+  std::string UnchargeTenant(ObjectID const id);
+
+  /**
+   * @brief Count a get of the blob, see also `HotObjects`.
+   */
+  void RecordAccess(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Release the pin that the store takes on the blob when working on
+   * it without the lock, e.g., hashing or compressing. A deferred delete
+   * that has happened meanwhile is finished once the last pin is released,
+   * as in `DecreaseReferenceCount`.
+   */
+  void ReleaseTemporaryPin(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief The first `limit` blobs in the order of `before`.
+   */
+  template <typename Compare>
+  void RankObjects(const size_t limit, Compare before,
+                   std::vector<BlobAccess>& blobs) const;
+
+  /**
+   * @brief Allocate memory and spill cold blobs out when there's no enough
+   * space in the shared memory.
+   */
+  uint8_t* AllocateMemoryWithSpill(size_t size, int numa_node, int* fd,
+                                   int64_t* map_size, ptrdiff_t* offset,
+                                   size_t alignment = 0);
+
+  Status SpillColdObjects(size_t const required_size);
+
+  Status EvictReplicas(size_t const required_size);
+
+  Status Spill(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Load the spilled blob back into the memory, or decompress the
+   * compressed blob.
+   */
+  Status ReloadIfSpilled(std::shared_ptr<Payload> const& object);
+
+  void CompressLoop();
+
+  void CompressColdObjects();
+
+  Status CompressObject(ObjectID const id);
+
+  Status DecompressObject(std::shared_ptr<Payload> const& object);
+
+  std::string SpillFilePath(ObjectID const id) const;
+
+  /**
+   * @brief Re-register the blobs in the journal whose memory is still
+   * allocated, release the allocations that no blob owns, and compact the
+   * journal.
+   */
+  Status RecoverBlobs(std::string const& journal_path);
+
+  /**
+   * @brief Log that the blob owns its memory in the persistent arena, it's a
+   * no-op if the shared memory is not persistent.
+   */
+  void JournalCreate(std::shared_ptr<Payload> const& object);
+
+  void JournalDelete(ObjectID const id);
+
+  void TouchObject(ObjectID const id);
+
+  void ForgetObject(ObjectID const id);
+
+  void DedupLoop();
+
+  /**
+   * @brief Hash the blob and merge it into an allocation of the same
+   * content, or record its allocation as the one that later blobs merge
+   * into.
+   */
+  Status Dedup(ObjectID const id);
+
+  /**
+   * @brief Drop the content record of the blob that is the only one using
+   * its allocation, before the memory is released by other means.
+   */
+  void DropContent(ObjectID const id);
+
+  // recursive, since batch requests are composed by single requests.
+  mutable std::recursive_mutex mutex_;
+
   std::unordered_map<ObjectID, std::shared_ptr<Payload>> objects_;
+
+  SlabAllocator slab_allocator_;
+
+  // A memory region that has been split into sub-blobs.
+  struct Region {
+    uint8_t* pointer;
+    size_t size;
+    int numa_node;
+    size_t alive_blobs;
+  };
+  std::unordered_map<uintptr_t, Region> regions_;
+  // maps sub-blobs to the region that they belong to.
+  std::unordered_map<ObjectID, uintptr_t> region_of_;
+
+  struct Tenant {
+    size_t usage = 0;
+    size_t objects = 0;
+    // 0 means the default quota
+    size_t quota = 0;
+    size_t rejected = 0;
+  };
+  std::map<std::string, Tenant> tenants_;
+  std::unordered_map<ObjectID, std::string> tenant_of_;
+  size_t default_quota_ = 0;
+
+  // number of NUMA arenas, 0 means NUMA arenas are disabled.
+  int numa_nodes_ = 0;
+
+  std::string spill_path_;
+  size_t spilled_objects_ = 0;
+  size_t spilled_size_ = 0;
+  // LRU list of in-memory blobs, the most recently used ones are at the back.
+  std::list<ObjectID> lru_;
+  std::unordered_map<ObjectID, std::list<ObjectID>::iterator> lru_index_;
+  // when the blobs in the LRU list were accessed the last time.
+  std::unordered_map<ObjectID, std::chrono::steady_clock::time_point>
+      touched_at_;
+
+  // the cached replicas of remote blobs
+  std::unordered_set<ObjectID> replicas_;
+
+  // the shared memory is on a file, the blobs that own memory on it are
+  // logged in the journal.
+  bool persistent_ = false;
+  uint8_t* arena_base_ = nullptr;
+  size_t arena_size_ = 0;
+  int journal_fd_ = -1;
+
+  // A hashed allocation, which may be shared by blobs of the same content.
+  struct Content {
+    uint8_t* pointer;
+    size_t size;
+    int numa_node;
+    int store_fd;
+    int64_t map_size;
+    ptrdiff_t data_offset;
+    uint64_t hash;
+    size_t alive_blobs;
+  };
+  std::unordered_map<uintptr_t, Content> contents_;
+  std::unordered_multimap<uint64_t, uintptr_t> content_index_;
+  // maps the hashed blobs to their allocations.
+  std::unordered_map<ObjectID, uintptr_t> content_of_;
+  // the blobs that wait for being released by clients before merging, with
+  // their hashes.
+  std::unordered_map<ObjectID, uint64_t> dedup_deferred_;
+
+  // the blobs that have been deleted while being pinned, which are freed at
+  // the last unpin.
+  std::unordered_set<ObjectID> deleting_;
+  size_t deleting_size_ = 0;
+  size_t deduped_objects_ = 0;
+  size_t deduped_size_ = 0;
+
+  bool dedup_enabled_ = false;
+  bool dedup_stopped_ = false;
+  std::mutex dedup_mutex_;
+  std::condition_variable dedup_cv_;
+  std::deque<ObjectID> dedup_queue_;
+  std::thread dedup_thread_;
+
+  // The compressed payload of a cold blob.
+  struct Compressed {
+    uint8_t* pointer;
+    size_t size;
+  };
+  std::unordered_map<ObjectID, Compressed> compressed_;
+  size_t compressed_size_ = 0;
+  // the blobs that have been found not worth compressing.
+  std::unordered_set<ObjectID> incompressible_;
+  std::string compress_codec_;
+  std::chrono::seconds compress_after_{0};
+
+  std::atomic<size_t> prefault_size_{0};
+  std::atomic<size_t> prefaulted_size_{0};
+  std::atomic<bool> prefault_stopped_{false};
+  std::thread prefault_thread_;
+
+  bool compress_stopped_ = false;
+  std::mutex compress_mutex_;
+  std::condition_variable compress_cv_;
+  std::thread compress_thread_;
+
+  BackgroundScheduler* background_ = nullptr;
 };
 
 }  // namespace vineyard
@@ -0,0 +1,104 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/slab_allocator.h"
+
+#include "common/util/logging.h"
+#include "server/memory/allocator.h"
+
+namespace vineyard {
+
+using plasma::BulkAllocator;
+
+constexpr size_t SlabAllocator::kSlabSize;
+constexpr size_t SlabAllocator::kMinSlotSize;
+constexpr size_t SlabAllocator::kMaxSlotSize;
+
+uint8_t* SlabAllocator::Allocate(size_t const size, int const numa_node) {
+  size_t slot_size = SlotSize(size);
+  auto& partial = partial_slabs_[std::make_pair(slot_size, numa_node)];
+  Slab* slab = nullptr;
+  if (partial.empty()) {
+    slab = NewSlab(slot_size, numa_node);
+    if (slab == nullptr) {
+      return nullptr;
+    }
+    partial.emplace(reinterpret_cast<uintptr_t>(slab->base));
+  } else {
+    slab = &slabs_.at(*partial.begin());
+  }
+  uint16_t slot = slab->free_slots.back();
+  slab->free_slots.pop_back();
+  if (slab->free_slots.empty()) {
+    partial.erase(reinterpret_cast<uintptr_t>(slab->base));
+  }
+  used_ += slot_size;
+  objects_ += 1;
+  return slab->base + slot * slot_size;
+}
+
+void SlabAllocator::Free(uint8_t* pointer, size_t const size) {
+  uintptr_t base = reinterpret_cast<uintptr_t>(pointer) & ~(kSlabSize - 1);
+  auto iter = slabs_.find(base);
+  CHECK(iter != slabs_.end()) << "The blob is not allocated from slabs";
+  Slab& slab = iter->second;
+  CHECK_EQ(slab.slot_size, SlotSize(size));
+  auto& partial =
+      partial_slabs_[std::make_pair(slab.slot_size, slab.numa_node)];
+  slab.free_slots.emplace_back(
+      static_cast<uint16_t>((pointer - slab.base) / slab.slot_size));
+  used_ -= slab.slot_size;
+  objects_ -= 1;
+  if (slab.free_slots.size() == kSlabSize / slab.slot_size) {
+    // the whole slab is free, return it to the bulk allocator.
+    partial.erase(base);
+    BulkAllocator::Free(slab.base, kSlabSize, slab.numa_node);
+    slabs_.erase(iter);
+  } else {
+    partial.emplace(base);
+  }
+}
+
+size_t SlabAllocator::SlotSize(size_t const size) {
+  size_t slot_size = kMinSlotSize;
+  while (slot_size < size) {
+    slot_size <<= 1;
+  }
+  return slot_size;
+}
+
+SlabAllocator::Slab* SlabAllocator::NewSlab(size_t const slot_size,
+                                            int const numa_node) {
+  uint8_t* base = reinterpret_cast<uint8_t*>(
+      BulkAllocator::Memalign(kSlabSize, kSlabSize, numa_node));
+  if (base == nullptr) {
+    return nullptr;
+  }
+  Slab& slab = slabs_[reinterpret_cast<uintptr_t>(base)];
+  slab.base = base;
+  slab.slot_size = slot_size;
+  slab.numa_node = numa_node;
+  size_t slots = kSlabSize / slot_size;
+  slab.free_slots.reserve(slots);
+  // reversed, so that the slots are handed out in address order.
+  for (size_t slot = slots; slot > 0; --slot) {
+    slab.free_slots.emplace_back(static_cast<uint16_t>(slot - 1));
+  }
+  VLOG(10) << "new slab for blobs of size " << slot_size << " at "
+           << reinterpret_cast<void*>(base);
+  return &slab;
+}
+
+}  // namespace vineyard
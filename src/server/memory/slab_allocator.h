@@ -0,0 +1,113 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_SLAB_ALLOCATOR_H_
+#define SRC_SERVER_MEMORY_SLAB_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vineyard {
+
+/**
+ * @brief SlabAllocator serves small blobs from fixed-size slabs that are
+ * allocated from the bulk allocator, to avoid padding every tiny blob to the
+ * block alignment of dlmalloc.
+ *
+ * Blobs are rounded up to power-of-two size classes, from kMinSlotSize to
+ * kMaxSlotSize. Every slab is aligned to kSlabSize, thus the slab of a slot
+ * can be found by masking the address. A slab will be returned to the bulk
+ * allocator once all its slots are freed.
+ */
+class SlabAllocator {
+ public:
+  static constexpr size_t kSlabSize = 64 * 1024;
+  static constexpr size_t kMinSlotSize = 8;
+  static constexpr size_t kMaxSlotSize = 2048;
+
+  /**
+   * @brief Whether blobs of the given size should be allocated from slabs.
+   */
+  static bool Accepts(size_t const size) { return size <= kMaxSlotSize; }
+
+  /**
+   * @brief Like `Accepts` above, but the slots of the size class must also
+   * satisfy the alignment, the slots are aligned to their sizes.
+   */
+  static bool Accepts(size_t const size, size_t const alignment) {
+    return Accepts(size) && alignment <= SlotSize(size);
+  }
+
+  /**
+   * @brief Allocate a slot for a blob of the given size, a new slab will be
+   * allocated from the arena of numa_node if there's no free slot. Returns
+   * nullptr when the bulk allocator runs out of memory.
+   */
+  uint8_t* Allocate(size_t const size, int const numa_node);
+
+  void Free(uint8_t* pointer, size_t const size);
+
+  /**
+   * @brief Whether the blob at pointer has been allocated from slabs.
+   */
+  bool Owns(const uint8_t* pointer) const {
+    return slabs_.find(reinterpret_cast<uintptr_t>(pointer) &
+                       ~(kSlabSize - 1)) != slabs_.end();
+  }
+
+  /**
+   * @brief Bytes of slabs that have been allocated from the bulk allocator.
+   */
+  size_t Reserved() const { return slabs_.size() * kSlabSize; }
+
+  /**
+   * @brief Bytes of slots that are occupied by blobs, including the padding
+   * to size classes.
+   */
+  size_t Used() const { return used_; }
+
+  /**
+   * @brief Number of blobs that live in slabs.
+   */
+  size_t Objects() const { return objects_; }
+
+ private:
+  struct Slab {
+    uint8_t* base;
+    size_t slot_size;
+    int numa_node;
+    std::vector<uint16_t> free_slots;
+  };
+
+  static size_t SlotSize(size_t const size);
+
+  Slab* NewSlab(size_t const slot_size, int const numa_node);
+
+  std::unordered_map<uintptr_t, Slab> slabs_;
+  // slabs that have free slots, indexed by (slot size, numa node).
+  std::map<std::pair<size_t, int>, std::set<uintptr_t>> partial_slabs_;
+
+  size_t used_ = 0;
+  size_t objects_ = 0;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_SLAB_ALLOCATOR_H_
@@ -15,8 +15,13 @@ limitations under the License.
 
 #include "server/memory/stream_store.h"
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "common/util/callback.h"
 #include "common/util/logging.h"
@@ -36,19 +41,48 @@ namespace vineyard {
   } while (0)
 #endif  // CHECK_STREAM_STATE
 
+// the max number of consumed chunks that are kept for reusing in a stream
+#define STREAM_FREE_CHUNKS 8
+
+namespace {
+
+uint64_t microsSince(std::chrono::steady_clock::time_point const since) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+}  // namespace
+
 // manage a pool of streams.
-Status StreamStore::Create(ObjectID const stream_id) {
+Status StreamStore::Create(ObjectID const stream_id, size_t const depth,
+                           size_t const readers, bool const parallel,
+                           size_t const retain) {
+  std::lock_guard<std::mutex> guard(mutex_);
   if (streams_.find(stream_id) != streams_.end()) {
     return Status::ObjectExists();
   }
-  streams_.emplace(stream_id, std::make_shared<StreamHolder>());
+  if (readers == 0) {
+    return Status::Invalid("A stream requires at least one reader");
+  }
+  if (parallel && retain > 0) {
+    return Status::Invalid("Parallel streams cannot retain chunks");
+  }
+  auto stream = std::make_shared<StreamHolder>();
+  stream->depth = depth == 0 ? depth_ : depth;
+  stream->readers = readers;
+  stream->parallel = parallel;
+  stream->retain = retain;
+  streams_.emplace(stream_id, stream);
   return Status::OK();
 }
 
 // for producer: return the next chunk to write, and make current chunk
 // available for consumer to read
 Status StreamStore::Get(ObjectID const stream_id, size_t const size,
+                        std::string const& tenant,
                         callback_t<const ObjectID> callback) {
+  std::lock_guard<std::mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return callback(Status::ObjectNotExists(), InvalidObjectID());
   }
@@ -57,63 +91,82 @@ Status StreamStore::Get(ObjectID const stream_id, size_t const size,
   // precondition: there's no unsatistified writer, and still running
   CHECK_STREAM_STATE(!stream->writer_);
   CHECK_STREAM_STATE(!stream->drained && !stream->failed);
+  stream->tenant = tenant;
 
-  // seal current chunk
-  if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
-    stream->current_writing_ = boost::none;
-  }
-  // weak up the pending reader
-  if (stream->reader_) {
-    // should be no reading chunk
-    CHECK_STREAM_STATE(!stream->current_reading_);
-    if (!stream->ready_chunks_.empty()) {
-      stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
-      stream->reader_ = boost::none;
-    }
-  }
+  // seal current chunk, and weak up the pending readers
+  seal(stream);
 
   // if (true /* FIXME: allocatable */) {
   if (allocatable(stream, size)) {
     // do allocation
     ObjectID chunk;
-    std::shared_ptr<Payload> object;
-    auto status = store_->ProcessCreateRequest(size, chunk, object);
+    auto status = allocate(stream, size, chunk);
     if (!status.ok()) {
       return callback(status, InvalidObjectID());
     } else {
       stream->current_writing_ = chunk;
+      stream->writing_size_ = size;
       return callback(Status::OK(), stream->current_writing_.get());
     }
   } else {
     // pending the writer
     stream->writer_ = std::make_pair(size, callback);
+    stream->blocked_since_ = std::chrono::steady_clock::now();
     return Status::OK();
   }
 }
 
-// for consumer: read current chunk
-Status StreamStore::Pull(ObjectID const stream_id,
+// for remote producer: fill the next chunk and make it available for consumer
+// to read at once
+Status StreamStore::Push(ObjectID const stream_id, size_t const size,
+                         std::string const& tenant,
                          callback_t<const ObjectID> callback) {
+  // the callback is invoked with the lock held
+  return Get(stream_id, size, tenant,
+             [this, stream_id, callback](const Status& status,
+                                         const ObjectID chunk) {
+               auto s = callback(status, chunk);
+               if (status.ok()) {
+                 auto stream = streams_.at(stream_id);
+                 if (s.ok()) {
+                   seal(stream);
+                 } else {
+                   VINEYARD_SUPPRESS(store_->ProcessDeleteRequest(chunk));
+                   stream->current_writing_ = boost::none;
+                 }
+               }
+               return s;
+             });
+}
+
+// for consumer: read current chunk
+Status StreamStore::Pull(ObjectID const stream_id, int64_t const reader,
+                         callback_t<const ObjectID> callback,
+                         bool const wait) {
+  std::lock_guard<std::mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return callback(Status::ObjectNotExists(), InvalidObjectID());
   }
   auto stream = streams_.at(stream_id);
+  auto reader_state = getReader(stream, reader);
+  if (reader_state == nullptr) {
+    return callback(Status::InvalidStreamState(
+                        "Stream has already got " +
+                        std::to_string(stream->readers) + " readers"),
+                    InvalidObjectID());
+  }
+  auto& state = *reader_state;
 
   // precondition: there's no unsatistified reader
-  CHECK_STREAM_STATE(!stream->reader_);
+  CHECK_STREAM_STATE(!state.reader_);
 
   // drop current reading
-  if (stream->current_reading_) {
-    auto status = store_->ProcessDeleteRequest(stream->current_reading_.get());
-    if (!status.ok()) {
-      return callback(status, InvalidObjectID());
-    }
-    stream->current_reading_ = boost::none;
+  auto status = untake(stream, state);
+  if (!status.ok()) {
+    return callback(status, InvalidObjectID());
   }
+  // take the next chunk before waking up the writer, to return the credit
+  bool taken = take(stream, state);
   // wake up the pending writer
   if (stream->writer_) {
     // should be no writing chunk
@@ -121,38 +174,124 @@ Status StreamStore::Pull(ObjectID const stream_id,
     auto writer = stream->writer_.get();
     if (allocatable(stream, writer.first)) {
       ObjectID chunk;
-      std::shared_ptr<Payload> object;
-      auto status = store_->ProcessCreateRequest(writer.first, chunk, object);
+      auto status = allocate(stream, writer.first, chunk);
       if (!status.ok()) {
         VINEYARD_SUPPRESS(writer.second(status, InvalidObjectID()));
       } else {
         stream->current_writing_ = chunk;
+        stream->writing_size_ = writer.first;
+        unblockWriter(stream);
         VINEYARD_SUPPRESS(
             writer.second(Status::OK(), stream->current_writing_.get()));
         stream->writer_ = boost::none;
       }
     }
   }
+  // the woken writer may have pushed a chunk
+  if (!taken) {
+    taken = take(stream, state);
+  }
 
-  if (!stream->ready_chunks_.empty()) {
-    stream->current_reading_ = stream->ready_chunks_.front();
-    stream->ready_chunks_.pop();
-    return callback(Status::OK(), stream->current_reading_.get());
+  if (taken) {
+    return callback(
+        Status::OK(),
+        stream->chunks_[state.current_reading_.get() - stream->base_]);
   } else {
     // if stream has been stoped, return a proper status.
     if (stream->drained) {
       return callback(Status::StreamDrained(), InvalidObjectID());
     } else if (stream->failed) {
       return callback(Status::StreamFailed(), InvalidObjectID());
+    } else if (!wait) {
+      return callback(Status::StreamNotReady(), InvalidObjectID());
     } else {
       // pending the reader
-      stream->reader_ = callback;
+      state.reader_ = callback;
+      state.waiting_since_ = std::chrono::steady_clock::now();
       return Status::OK();
     }
   }
 }
 
+Status StreamStore::Subscribe(ObjectID const stream_id, int64_t const reader,
+                              std::function<void()> notify) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (streams_.find(stream_id) == streams_.end()) {
+    return Status::ObjectNotExists();
+  }
+  auto stream = streams_.at(stream_id);
+  auto state = getReader(stream, reader);
+  if (state == nullptr) {
+    return Status::InvalidStreamState("Stream has already got " +
+                                      std::to_string(stream->readers) +
+                                      " readers");
+  }
+  state->notify_ = notify;
+  // the chunks may have been sealed before subscribing
+  notify();
+  return Status::OK();
+}
+
+Status StreamStore::Unsubscribe(ObjectID const stream_id,
+                                int64_t const reader) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (streams_.find(stream_id) == streams_.end()) {
+    return Status::ObjectNotExists();
+  }
+  auto stream = streams_.at(stream_id);
+  auto iter = stream->readers_.find(readerKey(stream, reader));
+  if (iter != stream->readers_.end()) {
+    iter->second.notify_ = nullptr;
+  }
+  return Status::OK();
+}
+
+Status StreamStore::Seek(ObjectID const stream_id, int64_t const reader,
+                         size_t const offset) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (streams_.find(stream_id) == streams_.end()) {
+    return Status::ObjectNotExists();
+  }
+  auto stream = streams_.at(stream_id);
+  if (stream->retain == 0) {
+    return Status::Invalid("Only the streams that retain chunks can be seeked");
+  }
+  size_t const end = stream->base_ + stream->chunks_.size();
+  if (offset < stream->base_ || offset > end) {
+    return Status::Invalid("The chunk " + std::to_string(offset) +
+                           " is out of the retained range [" +
+                           std::to_string(stream->base_) + ", " +
+                           std::to_string(end) + "]");
+  }
+  auto state = getReader(stream, reader);
+  if (state == nullptr) {
+    return Status::InvalidStreamState("Stream has already got " +
+                                      std::to_string(stream->readers) +
+                                      " readers");
+  }
+  if (state->reader_) {
+    return Status::InvalidStreamState("Still pending reader on stream");
+  }
+  // the chunk being read is still pending on the reader, as the unread ones
+  size_t const cursor =
+      state->current_reading_ ? state->current_reading_.get() : state->next;
+  state->current_reading_ = boost::none;
+  state->next = offset;
+  // the reader reads (or skips) the chunks between the offset and its cursor
+  for (size_t seq = offset; seq < cursor; ++seq) {
+    repend(stream, seq);
+  }
+  for (size_t seq = cursor; seq < offset; ++seq) {
+    RETURN_ON_ERROR(unpend(stream, seq));
+  }
+  if (state->notify_) {
+    state->notify_();
+  }
+  return Status::OK();
+}
+
 Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
+  std::lock_guard<std::mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists();
   }
@@ -165,76 +304,155 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   if (stream->writer_) {
     return Status::InvalidStreamState("Still pending writer on stream");
   }
-  // seal current writing chunk
-  if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
-    stream->current_writing_ = boost::none;
-  }
+  // seal current writing chunk, and weak up the pending readers
+  seal(stream);
   // stop
   if (failed) {
     stream->failed = true;
   } else {
     stream->drained = true;
   }
-  // weak up the pending reader
-  if (stream->reader_) {
-    // should be no reading chunk
-    if (stream->current_reading_) {
-      auto err =
-          Status::InvalidStreamState("Shouldn't exists a being read chunk");
-      VINEYARD_SUPPRESS(stream->reader_.get()(err, InvalidObjectID()));
-      stream->reader_ = boost::none;
-      return err;
-    }
-    if (stream->failed) {
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-      stream->reader_ = boost::none;
-    } else if (!stream->ready_chunks_.empty()) {
-      stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
-      stream->reader_ = boost::none;
-    } else if (stream->drained) {
-      VINEYARD_SUPPRESS(
-          stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-      stream->reader_ = boost::none;
-    } else {
-      RETURN_ON_ASSERT(false, "Impossible!");
+  notifyReaders(stream);
+  // the writer won't reuse them anymore
+  RETURN_ON_ERROR(dropFreeChunks(stream));
+  // weak up the readers that are still pending, i.e., no more chunks
+  for (auto& item : stream->readers_) {
+    auto& state = item.second;
+    if (state.reader_) {
+      unblockReader(stream, state);
+      VINEYARD_SUPPRESS(state.reader_.get()(
+          stream->failed ? Status::StreamFailed() : Status::StreamDrained(),
+          InvalidObjectID()));
+      state.reader_ = boost::none;
     }
   }
   return Status::OK();
 }
 
-Status StreamStore::Drop(ObjectID const stream_id) {
+void StreamStore::CollectChunks(std::set<ObjectID>& chunks) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto const& item : streams_) {
+    auto const& stream = item.second;
+    if (stream->current_writing_) {
+      chunks.emplace(stream->current_writing_.get());
+    }
+    for (size_t index = 0; index < stream->chunks_.size(); ++index) {
+      if (stream->pending_[index] > 0 || stream->retain > 0) {
+        chunks.emplace(stream->chunks_[index]);
+      }
+    }
+    for (auto const& chunk : stream->free_chunks_) {
+      chunks.emplace(chunk.second);
+    }
+  }
+}
+
+void StreamStore::Dump(ptree& tree) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto const& item : streams_) {
+    auto const& stream = item.second;
+    uint64_t blocked = stream->producer_blocked_us;
+    if (stream->writer_) {
+      blocked += microsSince(stream->blocked_since_);
+    }
+    uint64_t waited = stream->consumer_waited_us;
+    size_t waiting = 0;
+    for (auto const& reader : stream->readers_) {
+      if (reader.second.reader_) {
+        waited += microsSince(reader.second.waiting_since_);
+        waiting += 1;
+      }
+    }
+    ptree stats;
+    stats.put("state", stream->failed
+                           ? "failed"
+                           : (stream->drained ? "drained" : "running"));
+    stats.put("chunks_produced", stream->chunks_produced);
+    stats.put("bytes_produced", stream->bytes_produced);
+    stats.put("chunks_consumed", stream->chunks_consumed);
+    stats.put("bytes_consumed", stream->bytes_consumed);
+    stats.put("queue_depth", backlog(stream));
+    stats.put("depth", stream->depth);
+    stats.put("readers", stream->readers_.size());
+    stats.put("producer_blocked", static_cast<bool>(stream->writer_));
+    stats.put("producer_blocked_us", blocked);
+    stats.put("consumers_waiting", waiting);
+    stats.put("consumer_waited_us", waited);
+    tree.add_child(VYObjectIDToString(item.first), stats);
+  }
+}
+
+Status StreamStore::Drop(ObjectID const stream_id, int64_t const reader) {
+  std::lock_guard<std::mutex> guard(mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists();
   }
   auto stream = streams_.at(stream_id);
+  if (stream->retain > 0 && !stream->failed) {
+    auto iter = stream->readers_.find(readerKey(stream, reader));
+    if (iter != stream->readers_.end()) {
+      // the chunk being read will be read again by the reattached reader
+      auto const& state = iter->second;
+      stream->vacant_.push_back(state.current_reading_
+                                    ? state.current_reading_.get()
+                                    : state.next);
+      stream->readers_.erase(iter);
+      return Status::OK();
+    }
+  }
   stream->failed = true;
-  // weakup pending reader
-  if (stream->reader_) {
-    // should be no reading chunk
-    if (stream->current_reading_) {
-      return Status::InvalidStreamState("Shouldn't exists a being read chunk");
-    }
-    VINEYARD_SUPPRESS(
-        stream->reader_.get()(Status::StreamFailed(), InvalidObjectID()));
-    stream->reader_ = boost::none;
-  }
-  // drop all memory chunks in ready queue, but still keep the reading chunk
-  // to avoid crash the reader
-  while (!stream->ready_chunks_.empty()) {
-    RETURN_ON_ERROR(
-        store_->ProcessDeleteRequest(stream->ready_chunks_.front()));
-    stream->ready_chunks_.pop();
+  notifyReaders(stream);
+  // weakup pending readers
+  std::vector<size_t> holders(stream->chunks_.size(), 0);
+  for (auto& item : stream->readers_) {
+    auto& state = item.second;
+    if (state.reader_) {
+      unblockReader(stream, state);
+      VINEYARD_SUPPRESS(
+          state.reader_.get()(Status::StreamFailed(), InvalidObjectID()));
+      state.reader_ = boost::none;
+    }
+    if (state.current_reading_) {
+      holders[state.current_reading_.get() - stream->base_] += 1;
+    }
   }
-  return Status::OK();
+  // weakup pending writer, which may be waiting for credits from the reader
+  if (stream->writer_) {
+    unblockWriter(stream);
+    VINEYARD_SUPPRESS(stream->writer_.get().second(Status::StreamFailed(),
+                                                   InvalidObjectID()));
+    stream->writer_ = boost::none;
+  }
+  // drop all memory chunks in ready queue, but still keep the reading chunks
+  // to avoid crash the readers
+  for (size_t index = 0; index < stream->chunks_.size(); ++index) {
+    // the consumed chunks of retained streams haven't been released yet
+    if ((stream->pending_[index] > 0 || stream->retain > 0) &&
+        holders[index] == 0) {
+      RETURN_ON_ERROR(store_->ProcessDeleteRequest(stream->chunks_[index]));
+    }
+    stream->pending_[index] = holders[index];
+  }
+  stream->released_ = 0;
+  while (!stream->pending_.empty() && stream->pending_.front() == 0) {
+    stream->chunks_.pop_front();
+    stream->pending_.pop_front();
+    stream->sizes_.pop_front();
+    stream->base_ += 1;
+  }
+  return dropFreeChunks(stream);
 }
 
 bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
                               size_t size) {
+  if (stream->depth != 0 && backlog(stream) >= stream->depth) {
+    // no credit
+    return false;
+  }
+  if (stream->free_chunks_.find(size) != stream->free_chunks_.end()) {
+    // no extra memory is required
+    return true;
+  }
   if (store_->Footprint() + size <
       store_->FootprintLimit() * threshold_ / 100.0) {
     return true;
@@ -243,4 +461,186 @@ bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
   }
 }
 
+Status StreamStore::allocate(std::shared_ptr<StreamHolder> stream, size_t size,
+                             ObjectID& chunk) {
+  auto free_chunk = stream->free_chunks_.find(size);
+  if (free_chunk != stream->free_chunks_.end()) {
+    chunk = free_chunk->second;
+    stream->free_chunks_.erase(free_chunk);
+    return Status::OK();
+  }
+  std::shared_ptr<Payload> object;
+  return store_->ProcessCreateRequest(stream->tenant, size, chunk, object);
+}
+
+Status StreamStore::release(std::shared_ptr<StreamHolder> stream,
+                            ObjectID const chunk) {
+  if (stream->drained || stream->failed ||
+      stream->free_chunks_.size() >= STREAM_FREE_CHUNKS) {
+    return store_->ProcessDeleteRequest(chunk);
+  }
+  std::shared_ptr<Payload> object;
+  RETURN_ON_ERROR(store_->ProcessGetRequest(chunk, object));
+  stream->free_chunks_.emplace(static_cast<size_t>(object->data_size), chunk);
+  return Status::OK();
+}
+
+Status StreamStore::dropFreeChunks(std::shared_ptr<StreamHolder> stream) {
+  for (auto const& chunk : stream->free_chunks_) {
+    RETURN_ON_ERROR(store_->ProcessDeleteRequest(chunk.second));
+  }
+  stream->free_chunks_.clear();
+  return Status::OK();
+}
+
+StreamReader* StreamStore::getReader(std::shared_ptr<StreamHolder> stream,
+                                     int64_t const reader) {
+  int64_t const key = readerKey(stream, reader);
+  auto iter = stream->readers_.find(key);
+  if (iter == stream->readers_.end()) {
+    StreamReader state;
+    if (!stream->parallel && !stream->vacant_.empty()) {
+      // resume from the position of the reader that has left
+      state.next = stream->vacant_.front();
+      stream->vacant_.pop_front();
+    } else if (!stream->parallel &&
+               stream->readers_.size() + stream->vacant_.size() >=
+                   stream->readers) {
+      return nullptr;
+    }
+    iter = stream->readers_.emplace(key, state).first;
+  }
+  return &iter->second;
+}
+
+int64_t StreamStore::readerKey(std::shared_ptr<StreamHolder> stream,
+                               int64_t const reader) {
+  // the single consumer may pull from any connection, unless the stream
+  // retains chunks for the reattached consumers
+  bool const keyed =
+      stream->parallel || stream->readers > 1 || stream->retain > 0;
+  return keyed ? reader : 0;
+}
+
+void StreamStore::notifyReaders(std::shared_ptr<StreamHolder> stream) {
+  for (auto const& item : stream->readers_) {
+    if (item.second.notify_) {
+      item.second.notify_();
+    }
+  }
+}
+
+size_t StreamStore::backlog(std::shared_ptr<StreamHolder> stream) {
+  size_t const end = stream->base_ + stream->chunks_.size();
+  if (stream->parallel) {
+    return end - stream->next_;
+  }
+  // the chunks are kept for the readers that haven't connected yet
+  if (stream->readers_.size() + stream->vacant_.size() < stream->readers) {
+    return end - stream->base_;
+  }
+  size_t next = end;
+  for (auto const& item : stream->readers_) {
+    next = std::min(next, item.second.next);
+  }
+  for (auto const& vacant : stream->vacant_) {
+    next = std::min(next, vacant);
+  }
+  return end - next;
+}
+
+void StreamStore::unblockWriter(std::shared_ptr<StreamHolder> stream) {
+  stream->producer_blocked_us += microsSince(stream->blocked_since_);
+}
+
+void StreamStore::unblockReader(std::shared_ptr<StreamHolder> stream,
+                                StreamReader& reader) {
+  stream->consumer_waited_us += microsSince(reader.waiting_since_);
+}
+
+void StreamStore::seal(std::shared_ptr<StreamHolder> stream) {
+  if (!stream->current_writing_) {
+    return;
+  }
+  stream->chunks_.push_back(stream->current_writing_.get());
+  stream->pending_.push_back(stream->parallel ? 1 : stream->readers);
+  stream->sizes_.push_back(stream->writing_size_);
+  stream->current_writing_ = boost::none;
+  stream->chunks_produced += 1;
+  stream->bytes_produced += stream->writing_size_;
+  for (auto& item : stream->readers_) {
+    auto& state = item.second;
+    if (state.reader_ && take(stream, state)) {
+      unblockReader(stream, state);
+      VINEYARD_SUPPRESS(state.reader_.get()(
+          Status::OK(),
+          stream->chunks_[state.current_reading_.get() - stream->base_]));
+      state.reader_ = boost::none;
+    }
+  }
+  notifyReaders(stream);
+}
+
+bool StreamStore::take(std::shared_ptr<StreamHolder> stream,
+                       StreamReader& reader) {
+  size_t const end = stream->base_ + stream->chunks_.size();
+  size_t& next = stream->parallel ? stream->next_ : reader.next;
+  if (next < end) {
+    stream->chunks_consumed += 1;
+    stream->bytes_consumed += stream->sizes_[next - stream->base_];
+    reader.current_reading_ = next++;
+    return true;
+  }
+  return false;
+}
+
+Status StreamStore::untake(std::shared_ptr<StreamHolder> stream,
+                           StreamReader& reader) {
+  if (!reader.current_reading_) {
+    return Status::OK();
+  }
+  size_t const seq = reader.current_reading_.get();
+  reader.current_reading_ = boost::none;
+  return unpend(stream, seq);
+}
+
+Status StreamStore::unpend(std::shared_ptr<StreamHolder> stream,
+                           size_t const seq) {
+  size_t const index = seq - stream->base_;
+  if (stream->pending_[index] > 0 && --stream->pending_[index] == 0) {
+    if (stream->retain > 0) {
+      stream->released_ += 1;
+    } else {
+      RETURN_ON_ERROR(release(stream, stream->chunks_[index]));
+    }
+  }
+  return settle(stream);
+}
+
+void StreamStore::repend(std::shared_ptr<StreamHolder> stream,
+                         size_t const seq) {
+  size_t const index = seq - stream->base_;
+  if (stream->pending_[index]++ == 0) {
+    stream->released_ -= 1;
+  }
+}
+
+Status StreamStore::settle(std::shared_ptr<StreamHolder> stream) {
+  // the chunks of parallel streams may be released out of order
+  while (!stream->pending_.empty() && stream->pending_.front() == 0) {
+    if (stream->retain > 0) {
+      if (stream->released_ <= stream->retain) {
+        break;
+      }
+      stream->released_ -= 1;
+      RETURN_ON_ERROR(release(stream, stream->chunks_.front()));
+    }
+    stream->chunks_.pop_front();
+    stream->pending_.pop_front();
+    stream->sizes_.pop_front();
+    stream->base_ += 1;
+  }
+  return Status::OK();
+}
+
 }  // namespace vineyard
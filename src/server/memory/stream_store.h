@@ -16,56 +16,169 @@ limitations under the License.
 #ifndef SRC_SERVER_MEMORY_STREAM_STORE_H_
 #define SRC_SERVER_MEMORY_STREAM_STORE_H_
 
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <memory>
-#include <queue>
+#include <mutex>
+#include <set>
+#include <string>
 #include <unordered_map>
 #include <utility>
 
+#include "common/util/boost.h"
 #include "common/util/callback.h"
 #include "server/memory/memory.h"
 
 namespace vineyard {
 
+/**
+ * @brief StreamReader is the state of a consumer of the stream.
+ */
+struct StreamReader {
+  // the sequence number of the next chunk to read, of broadcast streams
+  size_t next{0};
+  // the sequence number of the chunk being read
+  boost::optional<size_t> current_reading_;
+  boost::optional<callback_t<ObjectID>> reader_;
+  // since when the reader has been pending in `reader_`
+  std::chrono::steady_clock::time_point waiting_since_;
+  // signaled when a chunk may be available or the stream stops, for the
+  // readers that don't wait in `Pull`
+  std::function<void()> notify_;
+};
+
 /**
  * @brief StreamHolder aims to maintain all chunks for a single stream.
  * "Stream" is a special kind of "Object" in vineyard, which represents
  * a stream (especially for I/O) that connects two drivers and avoids
  * the overhead of immediate temporary data structures and objects.
  *
+ * A stream may have multiple consumers: every chunk of a broadcast stream is
+ * delivered to each of the `readers` consumers, and every chunk of a parallel
+ * stream is delivered to one of the consumers.
+ *
  */
 struct StreamHolder {
-  boost::optional<ObjectID> current_writing_, current_reading_;
-  std::queue<ObjectID> ready_chunks_;
-  boost::optional<callback_t<ObjectID>> reader_;
+  boost::optional<ObjectID> current_writing_;
+  // the sealed chunks that haven't been released by all their readers, the
+  // first one is the `base_`-th chunk of the stream, and `pending_` is the
+  // number of readers that haven't released each chunk.
+  std::deque<ObjectID> chunks_;
+  std::deque<size_t> pending_;
+  // the sizes of `chunks_`, and of the writing chunk
+  std::deque<size_t> sizes_;
+  size_t writing_size_{0};
+  size_t base_{0};
+  // the sequence number of the next chunk to read, of parallel streams
+  size_t next_{0};
+  std::unordered_map<int64_t, StreamReader> readers_;
   boost::optional<std::pair<size_t, callback_t<ObjectID>>> writer_;
+  // since when the writer has been pending in `writer_`
+  std::chrono::steady_clock::time_point blocked_since_;
   bool drained{false}, failed{false};
+  // the max number of ready chunks, i.e., the credits of the producer. The
+  // writer is pending when all credits are in use, and every pulled chunk
+  // returns one credit. 0 means unlimited.
+  size_t depth{0};
+  // the number of consumers of broadcast streams
+  size_t readers{1};
+  bool parallel{false};
+  // the max number of consumed chunks that are retained for replaying, of
+  // broadcast streams, and `released_` is the number of retained chunks.
+  size_t retain{0}, released_{0};
+  // the cursors of the readers that have left, which will be resumed by the
+  // readers that reattach to the retained stream.
+  std::deque<size_t> vacant_;
+  // the chunks that have been consumed by the reader, indexed by size, which
+  // are reused by the writer rather than allocating new chunks.
+  std::unordered_multimap<size_t, ObjectID> free_chunks_;
+  // the tenant of the producer
+  std::string tenant;
+
+  // the statistics of the stream, see also `StreamStore::Dump`: the chunks
+  // sealed by the producer and taken by the consumers (every consumer of
+  // broadcast streams counts), and the time (in microseconds) that the
+  // producer has been pending for credits or memory, and that the
+  // consumers have been pending for chunks.
+  size_t chunks_produced{0}, bytes_produced{0};
+  size_t chunks_consumed{0}, bytes_consumed{0};
+  uint64_t producer_blocked_us{0}, consumer_waited_us{0};
 };
 
 /**
  * @brief StreamStore manages a pool of streams.
  *
+ * The pending reader and writer callbacks are invoked with the internal lock
+ * held, thus they must not call back into the stream store.
  */
 class StreamStore {
  public:
-  StreamStore(std::shared_ptr<BulkStore> store, size_t const stream_threshold)
-      : store_(store), threshold_(stream_threshold) {}
+  StreamStore(std::shared_ptr<BulkStore> store, size_t const stream_threshold,
+              size_t const stream_depth = 0)
+      : store_(store), threshold_(stream_threshold), depth_(stream_depth) {}
 
-  Status Create(ObjectID const stream_id);
+  /**
+   * @brief Create a stream, with at most `depth` chunks that are written but
+   * haven't been pulled, 0 means using the default depth.
+   *
+   * A broadcast stream waits for `readers` consumers, and a parallel stream
+   * accepts any number of consumers.
+   *
+   * A broadcast stream retains at most `retain` chunks after they have been
+   * consumed, the readers that lose connections leave their positions to the
+   * reattached readers, rather than failing the stream, and readers can
+   * replay the retained chunks by `Seek`.
+   */
+  Status Create(ObjectID const stream_id, size_t const depth = 0,
+                size_t const readers = 1, bool const parallel = false,
+                size_t const retain = 0);
 
   /**
    * @brief This is called by the producer of the steram and it makes current
    * chunk available for the consumer to read
    *
+   * The new chunks are accounted to the tenant of the producer, see also
+   * `BulkStore::ProcessCreateRequest`.
+   *
    * @return the next chunk to write
    */
   Status Get(ObjectID const stream_id, size_t const size,
-             callback_t<const ObjectID> callback);
+             std::string const& tenant, callback_t<const ObjectID> callback);
 
   /**
-   * @brief The consumer invokes this function to read current chunk
+   * @brief Like `Get`, but the chunk is filled by the callback and sealed
+   * once the callback returns, for the producers that cannot map the chunks,
+   * e.g., the RPC clients.
+   */
+  Status Push(ObjectID const stream_id, size_t const size,
+              std::string const& tenant, callback_t<const ObjectID> callback);
+
+  /**
+   * @brief The consumer invokes this function to read current chunk, and
+   * the consumers of multi-consumer streams are distinguished by `reader`.
    *
    */
-  Status Pull(ObjectID const stream_id, callback_t<const ObjectID> callback);
+  Status Pull(ObjectID const stream_id, int64_t const reader,
+              callback_t<const ObjectID> callback, bool const wait = true);
+
+  /**
+   * @brief Register `notify` for the reader, which is invoked (with the
+   * internal lock held) when a chunk may be available to the reader or the
+   * stream stops, thus the reader can poll the stream with `wait = false`
+   * rather than being pending in `Pull`.
+   */
+  Status Subscribe(ObjectID const stream_id, int64_t const reader,
+                   std::function<void()> notify);
+
+  Status Unsubscribe(ObjectID const stream_id, int64_t const reader);
+
+  /**
+   * @brief Move the reader to the `offset`-th chunk of the stream, which
+   * must be retained, and the chunk being read is released.
+   */
+  Status Seek(ObjectID const stream_id, int64_t const reader,
+              size_t const offset);
 
   /**
    * @brief Function stop is called by the vineyard clients.
@@ -75,17 +188,111 @@ class StreamStore {
 
   /**
    * @brief Function Drop is called by vineyard when the clients loose
-   * connections
+   * connections, the reader leaves the retained streams, and other streams
+   * will fail.
    *
    */
-  Status Drop(ObjectID const stream_id);
+  Status Drop(ObjectID const stream_id, int64_t const reader);
+
+  /**
+   * @brief The chunks that are being held by streams, which are not
+   * referenced by any metadata.
+   */
+  void CollectChunks(std::set<ObjectID>& chunks);
+
+  /**
+   * @brief The statistics of every stream, keyed by the stream id, which are
+   * reported in the instance status: the chunks and bytes produced and
+   * consumed, the queue depth (the chunks that haven't been taken by the
+   * slowest consumer), and the time the producer has been blocked and the
+   * consumers have waited, including the ongoing ones.
+   */
+  void Dump(ptree& tree);
 
  private:
+  /**
+   * Whether the writer can get a chunk of the given size without waiting for
+   * credits or memory.
+   */
   bool allocatable(std::shared_ptr<StreamHolder> stream, size_t size);
 
+  /**
+   * Reuse a consumed chunk of the same size, or allocate a new one.
+   */
+  Status allocate(std::shared_ptr<StreamHolder> stream, size_t size,
+                  ObjectID& chunk);
+
+  /**
+   * Keep the consumed chunk for reusing, or delete it when the stream has
+   * stopped or enough chunks are kept.
+   */
+  Status release(std::shared_ptr<StreamHolder> stream, ObjectID const chunk);
+
+  Status dropFreeChunks(std::shared_ptr<StreamHolder> stream);
+
+  /**
+   * Find or register the reader, returns nullptr if the stream has enough
+   * readers.
+   */
+  StreamReader* getReader(std::shared_ptr<StreamHolder> stream,
+                          int64_t const reader);
+
+  int64_t readerKey(std::shared_ptr<StreamHolder> stream,
+                    int64_t const reader);
+
+  void notifyReaders(std::shared_ptr<StreamHolder> stream);
+
+  /**
+   * The number of sealed chunks that haven't been taken by the slowest
+   * reader, i.e., the credits in use.
+   */
+  size_t backlog(std::shared_ptr<StreamHolder> stream);
+
+  /**
+   * Account the time the writer (or the reader) has been pending, before it
+   * is woken up.
+   */
+  void unblockWriter(std::shared_ptr<StreamHolder> stream);
+
+  void unblockReader(std::shared_ptr<StreamHolder> stream,
+                     StreamReader& reader);
+
+  /**
+   * Seal the writing chunk, and deliver it to the pending readers.
+   */
+  void seal(std::shared_ptr<StreamHolder> stream);
+
+  /**
+   * Take the next chunk for the reader, returns false if there's none.
+   */
+  bool take(std::shared_ptr<StreamHolder> stream, StreamReader& reader);
+
+  /**
+   * The reader has done with the chunk it's reading, the chunk is released
+   * after all its readers have done with it.
+   */
+  Status untake(std::shared_ptr<StreamHolder> stream, StreamReader& reader);
+
+  /**
+   * A reader has done with the chunk, or skips it.
+   */
+  Status unpend(std::shared_ptr<StreamHolder> stream, size_t const seq);
+
+  /**
+   * A reader will read the chunk again.
+   */
+  void repend(std::shared_ptr<StreamHolder> stream, size_t const seq);
+
+  /**
+   * Release the consumed chunks at the front, except the retained ones.
+   */
+  Status settle(std::shared_ptr<StreamHolder> stream);
+
   std::shared_ptr<BulkStore> store_;
   size_t threshold_;
+  size_t depth_;
   std::unordered_map<ObjectID, std::shared_ptr<StreamHolder>> streams_;
+  std::mutex mutex_;
 };
 
 }  // namespace vineyard
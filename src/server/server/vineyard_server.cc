@@ -15,19 +15,28 @@ limitations under the License.
 
 #include "server/server/vineyard_server.h"
 
+#include <algorithm>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
 #include "common/util/boost.h"
 #include "common/util/callback.h"
 #include "common/util/logging.h"
 #include "common/util/ptree.h"
+#include "common/util/trace.h"
 #include "server/async/ipc_server.h"
+#include "server/async/metrics_server.h"
 #include "server/async/rpc_server.h"
 #include "server/services/meta_service.h"
+#include "server/util/cpu_affinity.h"
 #include "server/util/meta_tree.h"
+#include "server/util/remote_client.h"
 
 namespace vineyard {
 
@@ -47,10 +56,42 @@ namespace vineyard {
   } while (0)
 #endif  // ENSURE_VINEYARDD_READY
 
+// the number of deferred requests that are checked for liveness on each
+// metadata update
+#define DEFERRED_SWEEP_BATCH 16
+
+// the max time (in microseconds) that a garbage collection slice takes, and
+// the number of blobs checked between two clock readings.
+#define GC_SLICE_MICROSECONDS 1000
+#define GC_CLOCK_GRANULARITY 64
+
+// the max number of expired objects that are deleted in one transaction
+#define EXPIRY_BATCH_SIZE 1024
+
+namespace {
+
+// the CPUs that a kind of threads is pinned to, which fallback to the CPUs of
+// the NUMA node of vineyardd.
+Status resolveCpus(const ptree& spec, const std::string& key,
+                   const int numa_node, std::vector<int>& cpus) {
+  RETURN_ON_ERROR(ParseCpuSet(spec.get<std::string>(key, ""), cpus));
+  if (cpus.empty() && numa_node >= 0) {
+    cpus = NumaNodeCpus(numa_node);
+    if (cpus.empty()) {
+      return Status::Invalid("NUMA node " + std::to_string(numa_node) +
+                             " doesn't exist on this host");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 bool DeferredReq::Alive() const { return alive_fn_(); }
 
-bool DeferredReq::TestThenCall(const ptree& meta) const {
-  if (test_fn_(meta)) {
+bool DeferredReq::TestThenCall(const CompactMetaTree& meta) {
+  waiting_ = test_fn_(meta);
+  if (waiting_.empty()) {
     VINEYARD_SUPPRESS(call_fn_(meta));
     return true;
   }
@@ -58,25 +99,121 @@ bool DeferredReq::TestThenCall(const ptree& meta) const {
 }
 
 VineyardServer::VineyardServer(const ptree& spec)
-    : spec_(spec),
+#if BOOST_VERSION >= 106600
+    : meta_strand_(context_.get_executor()),
+#else
+    : meta_strand_(context_),
+#endif
+      spec_(spec),
       guard_(asio::make_work_guard(context_)),
       ready_(0),
-      stopped_(false) {}
+      stopped_(false) {
+  deferred_sweep_ = deferred_.end();
+}
 
 Status VineyardServer::Serve() {
+  // the requests from the traced clients are traced even if the sample rate
+  // is 0, i.e., vineyardd doesn't start new traces.
+  trace::Tracer::Global().Configure(
+      "vineyardd", spec_.get<double>("trace_sample_rate", 0),
+      spec_.get<size_t>("trace_buffer_size", 8192));
+  slow_requests_.SetThreshold(
+      spec_.get<uint64_t>("slow_request_threshold", 100000));
+
+  // pinned first, thus the threads that are created later (e.g., by the meta
+  // service) inherit the CPUs of the server threads.
+  const int numa_node = spec_.get<int>("numa_node", -1);
+  std::vector<int> server_cpus, background_cpus, prefault_cpus;
+  RETURN_ON_ERROR(resolveCpus(spec_, "server_cpus", numa_node, server_cpus));
+  RETURN_ON_ERROR(
+      resolveCpus(spec_, "background_cpus", numa_node, background_cpus));
+  RETURN_ON_ERROR(resolveCpus(spec_.get_child("bulkstore_spec"),
+                              "prefault_cpus", numa_node, prefault_cpus));
+  if (!server_cpus.empty()) {
+    LOG(INFO) << "Pinning the server threads to CPUs "
+              << CpuSetToString(server_cpus);
+    PinCurrentThread(server_cpus);
+  }
   this->meta_service_ptr_ = IMetaService::Get(shared_from_this());
   RETURN_ON_ERROR(this->meta_service_ptr_->Start());
 
+  BackgroundScheduler::Options background_options;
+  background_options.threads = spec_.get<size_t>("background_threads", 2);
+  background_options.busy_threshold =
+      spec_.get<size_t>("background_busy_requests", 8);
+  background_options.io_bytes_per_second =
+      spec_.get<size_t>("background_io_rate", 0);
+  background_options.cpus = background_cpus;
+  background_.reset(new BackgroundScheduler(
+      background_options, [this]() { return metrics_.InflightRequests(); }));
+  background_->Start();
+
   bulk_store_ = std::make_shared<BulkStore>();
-  RETURN_ON_ERROR(bulk_store_->PreAllocate(
-      spec_.get_child("bulkstore_spec").get<size_t>("memory_size")));
+  bulk_store_->SetBackgroundScheduler(background_.get());
+  RETURN_ON_ERROR(bulk_store_->SetDefaultNumaNode(numa_node));
+  const std::string arena_file =
+      spec_.get_child("bulkstore_spec").get<std::string>("arena_file", "");
+  if (arena_file.empty()) {
+    RETURN_ON_ERROR(bulk_store_->PreAllocate(
+        spec_.get_child("bulkstore_spec").get<size_t>("memory_size"),
+        spec_.get_child("bulkstore_spec").get<size_t>("huge_page_size", 0),
+        spec_.get_child("bulkstore_spec").get<size_t>("reserve_size", 0)));
+  } else {
+    RETURN_ON_ERROR(bulk_store_->OpenPersistentArena(
+        arena_file,
+        spec_.get_child("bulkstore_spec").get<size_t>("memory_size")));
+  }
+  if (spec_.get_child("bulkstore_spec").get<bool>("numa_arenas", false)) {
+    RETURN_ON_ERROR(bulk_store_->EnableNumaArenas());
+  }
+  RETURN_ON_ERROR(bulk_store_->SetSpillPath(
+      spec_.get_child("bulkstore_spec").get<std::string>("spill_path", "")));
+  if (spec_.get_child("bulkstore_spec").get<bool>("dedup_blobs", false)) {
+    RETURN_ON_ERROR(bulk_store_->EnableDedup());
+  }
+  if (spec_.get_child("bulkstore_spec").get<int>("compress_after", 0) > 0) {
+    RETURN_ON_ERROR(bulk_store_->EnableCompression(
+        spec_.get_child("bulkstore_spec")
+            .get<std::string>("compress_codec", "lz4"),
+        spec_.get_child("bulkstore_spec").get<int>("compress_after")));
+  }
+  for (auto const& quota :
+       spec_.get_child("bulkstore_spec").get_child("tenant_quotas", ptree())) {
+    RETURN_ON_ERROR(bulk_store_->SetTenantQuota(
+        quota.first, quota.second.get_value<size_t>()));
+  }
+  if (spec_.get_child("bulkstore_spec").get<int>("prefault_threads", 0) > 0) {
+    RETURN_ON_ERROR(bulk_store_->Prefault(
+        spec_.get_child("bulkstore_spec").get<int>("prefault_threads"),
+        prefault_cpus));
+  }
+  device_store_ = std::make_shared<DeviceStore>(
+      spec_.get_child("bulkstore_spec").get<size_t>("device_memory_size", 0));
   stream_store_ = std::make_shared<StreamStore>(
       bulk_store_,
-      spec_.get_child("bulkstore_spec").get<size_t>("stream_threshold"));
+      spec_.get_child("bulkstore_spec").get<size_t>("stream_threshold"),
+      spec_.get_child("bulkstore_spec").get<size_t>("stream_depth", 0));
   BulkReady();
 
   serve_status_ = Status::OK();
+  int concurrency = spec_.get<int>("server_threads", 1);
+  if (concurrency <= 0) {
+    concurrency = std::max(1u, std::thread::hardware_concurrency());
+  }
+#if defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+  LOG(INFO) << "Serving requests with " << concurrency
+            << " threads, using the io_uring backend";
+#else
+  LOG(INFO) << "Serving requests with " << concurrency << " threads";
+#endif
+  for (int i = 1; i < concurrency; ++i) {
+    workers_.emplace_back([this]() { context_.run(); });
+  }
   context_.run();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
   return serve_status_;
 }
 
@@ -111,6 +248,103 @@ void VineyardServer::BackendReady() {
     context_.stop();
     return;
   }
+  if (spec_.get<uint32_t>("metrics_port", 0) > 0) {
+    try {
+      metrics_server_ptr_ = std::unique_ptr<MetricsServer>(
+          new MetricsServer(shared_from_this()));
+      metrics_server_ptr_->Start();
+    } catch (std::exception const& ex) {
+      // metrics are optional, don't fail the whole server.
+      LOG(ERROR) << "Failed to start vineyard metrics server: " << ex.what();
+      metrics_server_ptr_.reset();
+    }
+  }
+  scheduleGC();
+}
+
+void VineyardServer::scheduleGC() {
+  int interval = spec_.get_child("bulkstore_spec").get<int>("gc_interval", 0);
+  if (interval <= 0 || stopped_) {
+    return;
+  }
+  gc_timer_.reset(
+      new asio::steady_timer(context_, asio::chrono::seconds(interval)));
+  gc_timer_->async_wait([this](const boost::system::error_code& error) {
+    if (error || stopped_) {
+      // cancelled
+      return;
+    }
+    auto pass = std::make_shared<gc_pass_t>();
+    bulk_store_->ListUnreferenced(pass->blobs);
+    std::set<ObjectID> chunks;
+    stream_store_->CollectChunks(chunks);
+    if (!chunks.empty()) {
+      pass->blobs.erase(
+          std::remove_if(pass->blobs.begin(), pass->blobs.end(),
+                         [&chunks](ObjectID const id) {
+                           return chunks.find(id) != chunks.end();
+                         }),
+          pass->blobs.end());
+    }
+    collectGarbage(pass);
+  });
+}
+
+void VineyardServer::collectGarbage(std::shared_ptr<gc_pass_t> pass) {
+  meta_service_ptr_->RequestToGetData(
+      false, [this, pass](const Status& status, const CompactMetaTree& meta) {
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds(GC_SLICE_MICROSECONDS);
+        std::vector<ObjectID> garbage;
+        size_t index = pass->offset;
+        for (; index < pass->blobs.size(); ++index) {
+          if ((index - pass->offset) % GC_CLOCK_GRANULARITY == 0 &&
+              index != pass->offset &&
+              std::chrono::steady_clock::now() > deadline) {
+            break;
+          }
+          ObjectID const blob = pass->blobs[index];
+          bool exists = false;
+          VINEYARD_SUPPRESS(
+              CATCH_PTREE_ERROR(meta_tree::Exists(meta, blob, exists)));
+          if (exists) {
+            continue;
+          }
+          if (gc_candidates_.find(blob) != gc_candidates_.end()) {
+            garbage.emplace_back(blob);
+          } else {
+            pass->unreferenced.emplace_back(blob);
+          }
+        }
+        if (!garbage.empty()) {
+          size_t freed = 0;
+          VINEYARD_SUPPRESS(bulk_store_->DeleteUnreferenced(garbage, freed));
+          pass->freed += freed;
+        }
+        pass->offset = index;
+
+        if (pass->offset < pass->blobs.size()) {
+          // yield to the requests before the next slice, the slice runs in
+          // the context as it accesses the metadata
+          background_->Submit("gc", BackgroundScheduler::Priority::kLow,
+                              BackgroundScheduler::Resource::kCPU,
+                              [this, pass]() {
+                                asio::post(context_, [this, pass]() {
+                                  collectGarbage(pass);
+                                });
+                                return false;
+                              });
+        } else {
+          if (pass->freed > 0) {
+            LOG(INFO) << "Garbage collection freed " << pass->freed
+                      << " unreferenced blobs";
+          }
+          gc_candidates_ = std::set<ObjectID>(pass->unreferenced.begin(),
+                                              pass->unreferenced.end());
+          scheduleGC();
+        }
+        return Status::OK();
+      });
 }
 
 void VineyardServer::MetaReady() {
@@ -156,33 +390,41 @@ Status VineyardServer::GetData(const std::vector<ObjectID>& ids,
                                std::function<bool()> alive,
                                callback_t<const ptree&> callback) {
   ENSURE_VINEYARDD_READY();
+  // the objects created by this instance are synchronized as well, since
+  // other instances may have deleted them, e.g., the cleanup of failed
+  // instances or the force/deep deletes, see `RequestToGetData` for what
+  // the synchronization reads.
   meta_service_ptr_->RequestToGetData(
-      sync_remote, [this, ids, wait, alive, callback](const Status& status,
-                                                      const ptree& meta) {
+      ids, sync_remote,
+      [this, ids, sync_remote, wait, alive, callback](
+          const Status& status, const CompactMetaTree& meta) {
         if (status.ok()) {
       // When object not exists, we return an empty ptree, rather than
       // the status to indicate the error.
 #if !defined(NDEBUG)
           if (VLOG_IS_ON(10)) {
             std::stringstream ss;
-            bpt::write_json(ss, meta, true);
+            ptree tree;
+            meta.ToPtree(CompactMetaTree::kRoot, tree);
+            bpt::write_json(ss, tree, true);
             VLOG(10) << "Got request from client to get data, dump ptree:";
             VLOG(10) << ss.str();
             VLOG(10) << "=========================================";
           }
 #endif
-          auto test_task = [ids](const ptree& meta) -> bool {
+          auto test_task = [ids](const CompactMetaTree& meta) -> std::string {
             for (auto const& id : ids) {
               bool exists = false;
               VINEYARD_SUPPRESS(
                   CATCH_PTREE_ERROR(meta_tree::Exists(meta, id, exists)));
               if (!exists) {
-                return exists;
+                return "data." + VYObjectIDToString(id);
               }
             }
-            return true;
+            return std::string();
           };
-          auto eval_task = [ids, callback](const ptree& meta) -> Status {
+          auto eval_task = [this, ids, sync_remote, callback](
+                               const CompactMetaTree& meta) -> Status {
             ptree sub_tree_group;
             for (auto const& id : ids) {
               ptree sub_tree;
@@ -192,14 +434,19 @@ Status VineyardServer::GetData(const std::vector<ObjectID>& ids,
                 sub_tree_group.add_child(VYObjectIDToString(id), sub_tree);
               }
             }
+            if (sync_remote) {
+              return cacheRemoteBlobs(meta, sub_tree_group, callback);
+            }
             return callback(Status::OK(), sub_tree_group);
           };
-          if (!wait || test_task(meta)) {
+          if (!wait) {
             return eval_task(meta);
-          } else {
-            this->deferred_.emplace_back(alive, test_task, eval_task);
-            return Status::OK();
           }
+          DeferredReq request(alive, test_task, eval_task);
+          if (!request.TestThenCall(meta)) {
+            this->deferRequest(std::move(request));
+          }
+          return Status::OK();
         } else {
           LOG(ERROR) << status.ToString();
           return status;
@@ -208,19 +455,22 @@ Status VineyardServer::GetData(const std::vector<ObjectID>& ids,
   return Status::OK();
 }
 
-Status VineyardServer::ListData(std::string const& pattern, bool const regex,
-                                size_t const limit,
-                                callback_t<const ptree&> callback) {
+Status VineyardServer::ListData(
+    std::string const& pattern, bool const regex, size_t const limit,
+    std::string const& cursor,
+    callback_t<const ptree&, const std::string&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(
-      false,  // no need for sync from etcd
-      [pattern, regex, limit, callback](const Status& status,
-                                        const ptree& meta) {
+  meta_service_ptr_->RequestToGetIndexedData(
+      // no need for sync from etcd
+      [pattern, regex, limit, cursor, callback](const Status& status,
+                                                const CompactMetaTree& meta,
+                                                const MetaIndex& index) {
         if (status.ok()) {
           ptree sub_tree_group;
-          VINEYARD_CHECK_OK(CATCH_PTREE_ERROR(meta_tree::ListData(
-              meta, pattern, regex, limit, sub_tree_group)));
-          return callback(status, sub_tree_group);
+          std::string next_cursor = cursor;
+          auto s = CATCH_PTREE_ERROR(meta_tree::ListData(
+              meta, index, pattern, regex, limit, next_cursor, sub_tree_group));
+          return callback(s, sub_tree_group, next_cursor);
         } else {
           LOG(ERROR) << status.ToString();
           return status;
@@ -230,7 +480,8 @@ Status VineyardServer::ListData(std::string const& pattern, bool const regex,
 }
 
 Status VineyardServer::CreateData(
-    const ptree& tree, callback_t<const ObjectID, const InstanceID> callback) {
+    const ptree& tree, const uint64_t ttl,
+    callback_t<const ObjectID, const InstanceID> callback) {
   ENSURE_VINEYARDD_READY();
 #if !defined(NDEBUG)
   if (VLOG_IS_ON(10)) {
@@ -265,7 +516,7 @@ Status VineyardServer::CreateData(
 
   // update meta into ptree
   meta_service_ptr_->RequestToBulkUpdate(
-      [id, tree](const Status& status, const ptree& meta,
+      [id, tree](const Status& status, const CompactMetaTree& meta,
                  std::vector<IMetaService::op_t>& ops,
                  InstanceID& computed_instance_id) {
         if (status.ok()) {
@@ -276,28 +527,97 @@ Status VineyardServer::CreateData(
           return status;
         }
       },
-      boost::bind(callback, _1, id, _2));
+      [this, id, ttl, type, callback](const Status& status,
+                                      const InstanceID instance_id) {
+        if (status.ok()) {
+          this->scheduleExpiry(id, ttl);
+          if (type == "vineyard::Blob") {
+            // the content of the blob is immutable once sealed
+            bulk_store_->Seal(id);
+          }
+        }
+        return callback(status, id, instance_id);
+      });
   return Status::OK();
 }
 
-Status VineyardServer::Persist(const ObjectID id, callback_t<> callback) {
+Status VineyardServer::Persist(const ObjectID id, const uint64_t ttl,
+                               callback_t<> callback) {
   ENSURE_VINEYARDD_READY();
+  bool const compact = meta_service_ptr_->CompactValues();
   meta_service_ptr_->RequestToPersist(
-      [id](const Status& status, const ptree& meta,
-           std::vector<IMetaService::op_t>& ops) {
+      [id, compact](const Status& status, const CompactMetaTree& meta,
+                    std::vector<IMetaService::op_t>& ops) {
         if (status.ok()) {
-          return CATCH_PTREE_ERROR(meta_tree::PersistOps(meta, id, ops));
+          return CATCH_PTREE_ERROR(
+              meta_tree::PersistOps(meta, id, ops, compact));
         } else {
           LOG(ERROR) << status.ToString();
           return status;
         }
       },
-      callback);
+      [this, id, ttl, callback](const Status& status) {
+        if (status.ok()) {
+          this->scheduleExpiry(id, ttl);
+        }
+        return callback(status);
+      });
+  return Status::OK();
+}
+
+Status VineyardServer::Persist(const std::vector<ObjectID>& ids,
+                               const uint64_t ttl, const bool write_behind,
+                               callback_t<> callback) {
+  ENSURE_VINEYARDD_READY();
+  bool const compact = meta_service_ptr_->CompactValues();
+  auto generate = [ids, compact](const Status& status,
+                                 const CompactMetaTree& meta,
+                                 std::vector<IMetaService::op_t>& ops) {
+    if (status.ok()) {
+      // objects may share members, whose changes are generated for each
+      // of these objects, as the diffs are computed against the same tree.
+      std::unordered_set<std::string> keys;
+      std::vector<IMetaService::op_t> object_ops;
+      for (auto const& id : ids) {
+        object_ops.clear();
+        RETURN_ON_ERROR(CATCH_PTREE_ERROR(
+            meta_tree::PersistOps(meta, id, object_ops, compact)));
+        for (auto& op : object_ops) {
+          if (keys.emplace(op.kv.key).second) {
+            ops.emplace_back(std::move(op));
+          }
+        }
+      }
+      return Status::OK();
+    } else {
+      LOG(ERROR) << status.ToString();
+      return status;
+    }
+  };
+  auto finish = [this, ids, ttl, callback](const Status& status) {
+    if (status.ok()) {
+      for (auto const& id : ids) {
+        this->scheduleExpiry(id, ttl);
+      }
+    }
+    return callback(status);
+  };
+  if (write_behind) {
+    meta_service_ptr_->RequestToPersistWriteBehind(generate, finish);
+  } else {
+    meta_service_ptr_->RequestToPersist(generate, finish);
+  }
+  return Status::OK();
+}
+
+Status VineyardServer::Flush(callback_t<> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToFlush(callback);
   return Status::OK();
 }
 
 Status VineyardServer::IfPersist(const ObjectID id,
-                                 callback_t<const bool> callback) {
+                                 callback_t<const bool, const bool> callback) {
   ENSURE_VINEYARDD_READY();
   // How to decide if an object (an id) is persist:
   //
@@ -310,11 +630,16 @@ Status VineyardServer::IfPersist(const ObjectID id,
   // Thus we just need to read from the metadata in vineyardd, without
   // touching etcd.
   meta_service_ptr_->RequestToGetData(
-      false, [id, callback](const Status& status, const ptree& meta) {
+      false,
+      [this, id, callback](const Status& status,
+                           const CompactMetaTree& meta) {
         if (status.ok()) {
           bool persist = false;
           auto s = CATCH_PTREE_ERROR(meta_tree::IfPersist(meta, id, persist));
-          return callback(s, persist);
+          // invoked inside the meta strand
+          bool durable =
+              persist && !meta_service_ptr_->IsWriteBehindPending(id);
+          return callback(s, persist, durable);
         } else {
           LOG(ERROR) << status.ToString();
           return status;
@@ -327,7 +652,7 @@ Status VineyardServer::Exists(const ObjectID id,
                               callback_t<const bool> callback) {
   ENSURE_VINEYARDD_READY();
   meta_service_ptr_->RequestToGetData(
-      true, [id, callback](const Status& status, const ptree& meta) {
+      true, [id, callback](const Status& status, const CompactMetaTree& meta) {
         if (status.ok()) {
           bool exists = false;
           auto s = CATCH_PTREE_ERROR(meta_tree::Exists(meta, id, exists));
@@ -346,7 +671,7 @@ Status VineyardServer::ShallowCopy(const ObjectID id,
   RETURN_ON_ASSERT(!IsBlob(id), "The blobs cannot be shallow copied");
   ObjectID target_id = GenerateObjectID();
   meta_service_ptr_->RequestToShallowCopy(
-      [id, target_id](const Status& status, const ptree& meta,
+      [id, target_id](const Status& status, const CompactMetaTree& meta,
                       std::vector<IMetaService::op_t>& ops, bool& transient) {
         if (status.ok()) {
           return CATCH_PTREE_ERROR(
@@ -368,7 +693,7 @@ Status VineyardServer::DelData(const std::vector<ObjectID>& ids,
   ENSURE_VINEYARDD_READY();
   meta_service_ptr_->RequestToDelete(
       ids, force, deep,
-      [](const Status& status, const ptree& meta,
+      [](const Status& status, const CompactMetaTree& meta,
          std::set<ObjectID> const& ids_to_delete,
          std::vector<IMetaService::op_t>& ops) {
         if (status.ok()) {
@@ -389,31 +714,117 @@ Status VineyardServer::DelData(const std::vector<ObjectID>& ids,
 
 Status VineyardServer::DeleteBlobBatch(const std::set<ObjectID>& ids) {
   for (auto object_id : ids) {
-    VINEYARD_SUPPRESS(this->bulk_store_->ProcessDeleteRequest(object_id));
+    if (this->device_store_->Exists(object_id)) {
+      VINEYARD_SUPPRESS(this->device_store_->ProcessDeleteRequest(object_id));
+    } else {
+      // the blob is freed once the clients that have mapped it release it
+      VINEYARD_SUPPRESS(
+          this->bulk_store_->ProcessDeferredDeleteRequest(object_id));
+    }
   }
   return Status::OK();
 }
 
-Status VineyardServer::DeleteAllAt(const ptree& meta,
+void VineyardServer::NotifyDeletion(const std::set<ObjectID>& objects) {
+  if (objects.empty()) {
+    return;
+  }
+  if (!expiry_wheel_.Empty()) {
+    for (auto const& id : objects) {
+      expiry_wheel_.Cancel(id);
+    }
+  }
+  std::vector<ObjectID> ids(objects.begin(), objects.end());
+  if (ipc_server_ptr_) {
+    ipc_server_ptr_->NotifyDeletion(ids);
+  }
+  if (rpc_server_ptr_) {
+    rpc_server_ptr_->NotifyDeletion(ids);
+  }
+}
+
+void VineyardServer::NotifySubscribers(const CompactMetaTree& meta,
+                                       const MetaIndex& index,
+                                       const std::vector<ObjectID>& objects,
+                                       const std::vector<std::string>& names) {
+  if (objects.empty() && names.empty()) {
+    return;
+  }
+  if (!(ipc_server_ptr_ && ipc_server_ptr_->Subscriptions() > 0) &&
+      !(rpc_server_ptr_ && rpc_server_ptr_->Subscriptions() > 0)) {
+    return;
+  }
+  std::vector<ObjectEvent> events;
+  for (auto const& id : objects) {
+    ObjectEvent event;
+    event.id = id;
+    index.TypeOf(id, event.type_name);
+    events.emplace_back(std::move(event));
+  }
+  auto names_node = meta.Child(CompactMetaTree::kRoot, "names");
+  if (names_node != CompactMetaTree::kNotFound) {
+    for (auto const& name : names) {
+      auto entry = meta.GetOptional<ObjectID>(names_node, name);
+      if (entry) {
+        ObjectEvent event;
+        event.id = entry.get();
+        event.name = name;
+        index.TypeOf(event.id, event.type_name);
+        events.emplace_back(std::move(event));
+      }
+    }
+  }
+  if (events.empty()) {
+    return;
+  }
+  if (ipc_server_ptr_) {
+    ipc_server_ptr_->NotifySubscribers(events);
+  }
+  if (rpc_server_ptr_) {
+    rpc_server_ptr_->NotifySubscribers(events);
+  }
+}
+
+Status VineyardServer::DeleteAllAt(const MetaIndex& index,
                                    InstanceID const instance_id) {
+  ENSURE_VINEYARDD_READY();
   std::vector<ObjectID> objects_to_cleanup;
-  auto status = CATCH_PTREE_ERROR(
-      meta_tree::FilterAtInstance(meta, instance_id, objects_to_cleanup));
-  RETURN_ON_ERROR(status);
-  return this->DelData(
-      objects_to_cleanup, true, true, [](Status const& status) -> Status {
+  index.FilterAtInstance(instance_id, objects_to_cleanup);
+  if (objects_to_cleanup.empty()) {
+    return Status::OK();
+  }
+  size_t const count = objects_to_cleanup.size();
+  // the objects (and the members that are only referenced by them) are
+  // deleted in one transaction (or in one chunked commit, which the other
+  // instances apply at once), by a range deletion per object rather than a
+  // deletion per field.
+  meta_service_ptr_->RequestToDelete(
+      objects_to_cleanup, true, true,
+      [](const Status& status, const CompactMetaTree& meta,
+         std::set<ObjectID> const& ids_to_delete,
+         std::vector<IMetaService::op_t>& ops) {
+        if (status.ok()) {
+          meta_tree::DelDataPrefixOps(meta, ids_to_delete, ops);
+        }
+        return status;
+      },
+      [instance_id, count](Status const& status) -> Status {
         if (!status.ok()) {
           LOG(ERROR) << "Error happens on cleanup: " << status.ToString();
+        } else {
+          LOG(INFO) << "Cleaned up " << count
+                    << " objects of the failed instance " << instance_id;
         }
         return Status::OK();
       });
+  return Status::OK();
 }
 
 Status VineyardServer::PutName(const ObjectID object_id,
                                const std::string& name, callback_t<> callback) {
   ENSURE_VINEYARDD_READY();
   meta_service_ptr_->RequestToPersist(
-      [object_id, name](const Status& status, const ptree& meta,
+      [object_id, name](const Status& status, const CompactMetaTree& meta,
                         std::vector<IMetaService::op_t>& ops) {
         if (status.ok()) {
           // TODO: do proper validation:
@@ -431,38 +842,62 @@ Status VineyardServer::PutName(const ObjectID object_id,
   return Status::OK();
 }
 
+Status VineyardServer::PutName(const std::map<std::string, ObjectID>& names,
+                               callback_t<> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToPersist(
+      [names](const Status& status, const CompactMetaTree& meta,
+              std::vector<IMetaService::op_t>& ops) {
+        if (status.ok()) {
+          for (auto const& item : names) {
+            ops.emplace_back(IMetaService::op_t::Put(
+                "names." + item.first, std::to_string(item.second)));
+          }
+          return Status::OK();
+        } else {
+          LOG(ERROR) << status.ToString();
+          return status;
+        }
+      },
+      callback);
+  return Status::OK();
+}
+
 Status VineyardServer::GetName(const std::string& name, const bool wait,
                                DeferredReq::alive_t alive,
                                callback_t<const ObjectID&> callback) {
   ENSURE_VINEYARDD_READY();
   meta_service_ptr_->RequestToGetData(
-      true, [this, name, wait, alive, callback](const Status& status,
-                                                const ptree& meta) {
+      true, [this, name, wait, alive, callback](
+                const Status& status, const CompactMetaTree& meta) {
         if (status.ok()) {
-          auto test_task = [name](const ptree& meta) -> bool {
-            auto names = meta.get_child_optional("names");
-            if (names) {
-              auto entry = names.get().get_optional<ObjectID>(name);
-              return static_cast<bool>(entry);
+          auto test_task = [name](const CompactMetaTree& meta) -> std::string {
+            auto names = meta.Child(CompactMetaTree::kRoot, "names");
+            if (names != CompactMetaTree::kNotFound &&
+                meta.GetOptional<ObjectID>(names, name)) {
+              return std::string();
             }
-            return false;
+            return "names." + name;
           };
-          auto eval_task = [name, callback](const ptree& meta) -> Status {
-            auto names = meta.get_child_optional("names");
-            if (names) {
-              auto entry = names.get().get_optional<ObjectID>(name);
+          auto eval_task = [name,
+                            callback](const CompactMetaTree& meta) -> Status {
+            auto names = meta.Child(CompactMetaTree::kRoot, "names");
+            if (names != CompactMetaTree::kNotFound) {
+              auto entry = meta.GetOptional<ObjectID>(names, name);
               if (entry) {
                 return callback(Status::OK(), entry.get());
               }
             }
             return callback(Status::ObjectNotExists(), InvalidObjectID());
           };
-          if (!wait || test_task(meta)) {
+          if (!wait) {
             return eval_task(meta);
-          } else {
-            deferred_.emplace_back(alive, test_task, eval_task);
-            return Status::OK();
           }
+          DeferredReq request(alive, test_task, eval_task);
+          if (!request.TestThenCall(meta)) {
+            this->deferRequest(std::move(request));
+          }
+          return Status::OK();
         } else {
           LOG(ERROR) << status.ToString();
           return status;
@@ -475,12 +910,12 @@ Status VineyardServer::DropName(const std::string& name,
                                 callback_t<> callback) {
   ENSURE_VINEYARDD_READY();
   meta_service_ptr_->RequestToPersist(
-      [name](const Status& status, const ptree& meta,
+      [name](const Status& status, const CompactMetaTree& meta,
              std::vector<IMetaService::op_t>& ops) {
         if (status.ok()) {
-          auto names = meta.get_child_optional("names");
-          if (names) {
-            auto entry = names.get().get_optional<ObjectID>(name);
+          auto names = meta.Child(CompactMetaTree::kRoot, "names");
+          if (names != CompactMetaTree::kNotFound) {
+            auto entry = meta.GetOptional<ObjectID>(names, name);
             if (entry) {
               ops.emplace_back(IMetaService::op_t::Del("names." + name));
             }
@@ -498,9 +933,14 @@ Status VineyardServer::DropName(const std::string& name,
 Status VineyardServer::ClusterInfo(callback_t<const ptree&> callback) {
   ENSURE_VINEYARDD_READY();
   meta_service_ptr_->RequestToGetData(
-      true, [callback](const Status& status, const ptree& meta) {
+      true, [callback](const Status& status, const CompactMetaTree& meta) {
         if (status.ok()) {
-          return callback(status, meta.get_child("instances"));
+          ptree instances;
+          auto node = meta.Child(CompactMetaTree::kRoot, "instances");
+          if (node != CompactMetaTree::kNotFound) {
+            meta.ToPtree(node, instances);
+          }
+          return callback(status, instances);
         } else {
           LOG(ERROR) << status.ToString();
           return status;
@@ -512,33 +952,283 @@ Status VineyardServer::ClusterInfo(callback_t<const ptree&> callback) {
 Status VineyardServer::InstanceStatus(callback_t<const ptree&> callback) {
   ENSURE_VINEYARDD_READY();
 
-  ptree status;
-  status.put("instance_id", instance_id_);
-  status.put("deployment", GetDeployment());
-  status.put("memory_usage", bulk_store_->Footprint());
-  status.put("memory_limit", bulk_store_->FootprintLimit());
-  status.put("deferred_requests", deferred_.size());
-  if (ipc_server_ptr_) {
-    status.put("ipc_connections", ipc_server_ptr_->AliveConnections());
-  } else {
-    status.put("ipc_connections", 0);
+  // the deferred requests are only accessed inside the meta strand.
+  asio::post(meta_strand_, [this, callback]() {
+    ptree status;
+    status.put("instance_id", instance_id_);
+    status.put("deployment", GetDeployment());
+    status.put("memory_usage", bulk_store_->Footprint());
+    status.put("memory_limit", bulk_store_->FootprintLimit());
+    status.put("spilled_objects", bulk_store_->SpilledObjects());
+    status.put("spilled_size", bulk_store_->SpilledSize());
+    status.put("deduped_objects", bulk_store_->DedupedObjects());
+    status.put("deduped_size", bulk_store_->DedupedSize());
+    status.put("compressed_objects", bulk_store_->CompressedObjects());
+    status.put("compressed_size", bulk_store_->CompressedSize());
+    status.put("prefault_size", bulk_store_->PrefaultSize());
+    status.put("prefaulted_size", bulk_store_->PrefaultedSize());
+    status.add_child("tenants", bulk_store_->TenantUsage());
+    status.put("slab_reserved", bulk_store_->SlabReserved());
+    status.put("slab_used", bulk_store_->SlabUsed());
+    status.put("slab_objects", bulk_store_->SlabObjects());
+    status.put("pinned_objects", bulk_store_->PinnedObjects());
+    status.put("deleting_objects", bulk_store_->DeletingObjects());
+    status.put("deleting_size", bulk_store_->DeletingSize());
+    status.put("device_memory_usage", device_store_->Footprint());
+    status.put("device_memory_limit", device_store_->FootprintLimit());
+    status.put("deferred_requests", deferred_.size());
+    status.put("meta_nodes", meta_service_ptr_->MetaNodes());
+    status.put("meta_memory_usage", meta_service_ptr_->MetaMemoryUsage());
+    if (ipc_server_ptr_) {
+      status.put("ipc_connections", ipc_server_ptr_->AliveConnections());
+    } else {
+      status.put("ipc_connections", 0);
+    }
+    if (rpc_server_ptr_) {
+      status.put("rpc_connections", rpc_server_ptr_->AliveConnections());
+    } else {
+      status.put("rpc_connections", 0);
+    }
+    ptree streams;
+    stream_store_->Dump(streams);
+    status.add_child("streams", streams);
+    ptree metrics;
+    metrics_.Dump(metrics);
+    status.add_child("metrics", metrics);
+    ptree background;
+    if (background_) {
+      background_->Dump(background);
+    }
+    status.add_child("background_tasks", background);
+    VINEYARD_SUPPRESS(callback(Status::OK(), status));
+  });
+  return Status::OK();
+}
+
+Status VineyardServer::ProcessDeferred(
+    const CompactMetaTree& meta, const std::set<std::string>& updated_keys) {
+  for (auto const& key : updated_keys) {
+    auto bucket = deferred_index_.find(key);
+    if (bucket == deferred_index_.end()) {
+      continue;
+    }
+    auto requests = std::move(bucket->second);
+    deferred_index_.erase(bucket);
+    for (auto request : requests) {
+      if (!request->Alive() || request->TestThenCall(meta)) {
+        eraseDeferred(request);
+      } else {
+        // still waiting, on another key
+        deferred_index_[request->Waiting()].emplace_back(request);
+      }
+    }
   }
-  if (rpc_server_ptr_) {
-    status.put("rpc_connections", rpc_server_ptr_->AliveConnections());
-  } else {
-    status.put("rpc_connections", 0);
+  sweepDeferred();
+  return Status::OK();
+}
+
+void VineyardServer::deferRequest(DeferredReq&& request) {
+  auto iter = deferred_.emplace(deferred_.end(), std::move(request));
+  deferred_index_[iter->Waiting()].emplace_back(iter);
+}
+
+void VineyardServer::eraseDeferred(deferred_t::iterator request) {
+  if (deferred_sweep_ == request) {
+    ++deferred_sweep_;
+  }
+  deferred_.erase(request);
+}
+
+void VineyardServer::sweepDeferred() {
+  for (size_t i = 0; i < DEFERRED_SWEEP_BATCH && !deferred_.empty(); ++i) {
+    if (deferred_sweep_ == deferred_.end()) {
+      deferred_sweep_ = deferred_.begin();
+    }
+    auto request = deferred_sweep_++;
+    if (request->Alive()) {
+      continue;
+    }
+    auto bucket = deferred_index_.find(request->Waiting());
+    if (bucket != deferred_index_.end()) {
+      auto& requests = bucket->second;
+      requests.erase(std::remove(requests.begin(), requests.end(), request),
+                     requests.end());
+      if (requests.empty()) {
+        deferred_index_.erase(bucket);
+      }
+    }
+    eraseDeferred(request);
   }
+}
 
-  return callback(Status::OK(), status);
+namespace {
+
+int64_t expiry_tick() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
 }
 
-Status VineyardServer::ProcessDeferred(const ptree& meta) {
-  auto iter = deferred_.begin();
-  while (iter != deferred_.end()) {
-    if (!iter->Alive() || iter->TestThenCall(meta)) {
-      deferred_.erase(iter++);
-    } else {
-      ++iter;
+}  // namespace
+
+void VineyardServer::scheduleExpiry(const ObjectID id, const uint64_t ttl) {
+  if (ttl == 0) {
+    return;
+  }
+  expiry_wheel_.Schedule(id, expiry_tick(), ttl);
+  if (!expiry_ticking_) {
+    expiry_ticking_ = true;
+    startExpiryTimer();
+  }
+}
+
+void VineyardServer::startExpiryTimer() {
+  expiry_timer_.reset(
+      new asio::steady_timer(context_, asio::chrono::seconds(1)));
+  expiry_timer_->async_wait(asio::bind_executor(
+      meta_strand_, [this](const boost::system::error_code& error) {
+        if (error || stopped_) {
+          expiry_ticking_ = false;
+          return;
+        }
+        expireObjects();
+      }));
+}
+
+void VineyardServer::expireObjects() {
+  expiry_wheel_.Advance(expiry_tick(), expired_);
+  if (expired_.empty()) {
+    expiry_ticking_ = !expiry_wheel_.Empty();
+    if (expiry_ticking_) {
+      startExpiryTimer();
+    }
+    return;
+  }
+  // the expiry storms are spread over ticks, in batches
+  size_t batch_size = std::min<size_t>(expired_.size(), EXPIRY_BATCH_SIZE);
+  auto batch = std::make_shared<std::vector<ObjectID>>(
+      expired_.begin(), expired_.begin() + batch_size);
+  expired_.erase(expired_.begin(), expired_.begin() + batch_size);
+  meta_service_ptr_->RequestToGetData(
+      false, [this, batch](const Status& status, const CompactMetaTree& meta) {
+        // the objects may have been deleted by others
+        std::vector<ObjectID> ids;
+        for (auto const& id : *batch) {
+          bool exists = false;
+          VINEYARD_SUPPRESS(
+              CATCH_PTREE_ERROR(meta_tree::Exists(meta, id, exists)));
+          if (exists) {
+            ids.emplace_back(id);
+          }
+        }
+        auto next_tick = [this](const Status& status) {
+          this->startExpiryTimer();
+          return status;
+        };
+        if (ids.empty()) {
+          return next_tick(Status::OK());
+        }
+        VLOG(2) << "Deleting " << ids.size() << " expired objects";
+        auto s = DelData(ids, false, true, [this, ids, next_tick](
+                                               const Status& status) {
+          if (!status.ok()) {
+            LOG(WARNING) << "Failed to delete expired objects, will retry: "
+                         << status.ToString();
+            // they will be re-checked in the next tick
+            expired_.insert(expired_.end(), ids.begin(), ids.end());
+          }
+          return next_tick(Status::OK());
+        });
+        if (!s.ok()) {
+          expired_.insert(expired_.end(), ids.begin(), ids.end());
+          return next_tick(s);
+        }
+        return Status::OK();
+      });
+}
+
+Status VineyardServer::cacheRemoteBlobs(const CompactMetaTree& meta,
+                                        const ptree& tree,
+                                        callback_t<const ptree&> callback) {
+  std::map<std::string, std::map<ObjectID, size_t>> remote_blobs;
+  collectRemoteBlobs(meta, tree, remote_blobs);
+  if (remote_blobs.empty()) {
+    return callback(Status::OK(), tree);
+  }
+  // the blobs are fetched by blocking requests, outside the IO threads
+  auto self(shared_from_this());
+  std::thread([self, tree, callback, remote_blobs]() {
+    for (auto const& item : remote_blobs) {
+      auto status = self->fetchRemoteBlobs(item.first, item.second);
+      if (!status.ok()) {
+        // the replicas are only a cache, the metadata is still available
+        LOG(WARNING) << "Failed to cache the blobs from " << item.first
+                     << ": " << status.ToString();
+      }
+    }
+    VINEYARD_SUPPRESS(callback(Status::OK(), tree));
+  }).detach();
+  return Status::OK();
+}
+
+void VineyardServer::collectRemoteBlobs(
+    const CompactMetaTree& meta, const ptree& tree,
+    std::map<std::string, std::map<ObjectID, size_t>>& remote_blobs) {
+  auto id = tree.get_optional<std::string>("id");
+  if (id && IsBlob(VYObjectIDFromString(id.get()))) {
+    ObjectID const blob_id = VYObjectIDFromString(id.get());
+    auto instance_id = tree.get_optional<InstanceID>("instance_id");
+    size_t const size = tree.get<size_t>("length", 0);
+    if (!instance_id || instance_id.get() == instance_id_ || size == 0 ||
+        bulk_store_->Exists(blob_id)) {
+      return;
+    }
+    auto instance =
+        meta.Find("instances." + std::to_string(instance_id.get()));
+    if (instance == CompactMetaTree::kNotFound) {
+      return;
+    }
+    auto endpoint = meta.GetOptional<std::string>(instance, "rpc_endpoint");
+    if (endpoint) {
+      remote_blobs[endpoint.get()].emplace(blob_id, size);
+    }
+    return;
+  }
+  for (auto const& item : tree) {
+    if (!item.second.empty()) {
+      collectRemoteBlobs(meta, item.second, remote_blobs);
+    }
+  }
+}
+
+Status VineyardServer::fetchRemoteBlobs(
+    const std::string& rpc_endpoint,
+    const std::map<ObjectID, size_t>& blobs) {
+  RemoteClient client;
+  RETURN_ON_ERROR(client.Connect(rpc_endpoint));
+  for (auto const& blob : blobs) {
+    if (bulk_store_->Exists(blob.first)) {
+      continue;
+    }
+    ObjectID id = InvalidObjectID();
+    std::shared_ptr<Payload> object;
+    RETURN_ON_ERROR(bulk_store_->ProcessCreateRequest(blob.second, id, object));
+    // pinned, to be neither collected nor spilled while being filled
+    VINEYARD_SUPPRESS(bulk_store_->IncreaseReferenceCount(id));
+    auto status =
+        client.GetRemoteBlob(blob.first, object->pointer, blob.second);
+    if (status.ok()) {
+      status = bulk_store_->ProcessPromoteReplicaRequest(id, blob.first);
+    }
+    if (status.ok()) {
+      VINEYARD_SUPPRESS(bulk_store_->DecreaseReferenceCount(blob.first));
+      continue;
+    }
+    VINEYARD_SUPPRESS(bulk_store_->DecreaseReferenceCount(id));
+    VINEYARD_SUPPRESS(bulk_store_->ProcessDeleteRequest(id));
+    // the blob has been cached by another request meanwhile
+    if (!status.IsObjectExists()) {
+      return status;
     }
   }
   return Status::OK();
@@ -569,6 +1259,23 @@ void VineyardServer::Stop() {
     this->rpc_server_ptr_->Stop();
     this->rpc_server_ptr_.reset(nullptr);
   }
+  if (this->metrics_server_ptr_) {
+    this->metrics_server_ptr_->Stop();
+    this->metrics_server_ptr_.reset(nullptr);
+  }
+
+  if (this->gc_timer_) {
+    boost::system::error_code ec;
+    this->gc_timer_->cancel(ec);
+  }
+  if (this->expiry_timer_) {
+    boost::system::error_code ec;
+    this->expiry_timer_->cancel(ec);
+  }
+
+  if (this->background_) {
+    this->background_->Stop();
+  }
 
   meta_service_ptr_->Stop();
 
@@ -17,9 +17,12 @@ limitations under the License.
 #define SRC_SERVER_SERVER_VINEYARD_SERVER_H_
 
 #include <list>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -27,9 +30,17 @@ limitations under the License.
 #include "common/util/boost.h"
 #include "common/util/callback.h"
 #include "common/util/status.h"
+#include "common/util/uuid.h"
 
+#include "server/memory/device_store.h"
 #include "server/memory/memory.h"
 #include "server/memory/stream_store.h"
+#include "server/util/background_scheduler.h"
+#include "server/util/compact_meta_tree.h"
+#include "server/util/meta_index.h"
+#include "server/util/metrics.h"
+#include "server/util/slow_requests.h"
+#include "server/util/timer_wheel.h"
 
 namespace vineyard {
 
@@ -39,29 +50,41 @@ class IMetaService;
 
 class IPCServer;
 class RPCServer;
+class MetricsServer;
 
 /**
  * @brief DeferredReq aims to defer a socket request such that the request
  * is executed only when the metadata satisfies some specific condition.
  *
+ * The condition is expressed as the metadata key that the request is still
+ * waiting on, e.g., "names.<name>" or "data.<object id>", or an empty string
+ * if the request is ready, thus the server only wakes up the requests whose
+ * keys have been updated.
  */
 class DeferredReq {
  public:
   using alive_t = std::function<bool()>;
-  using test_t = std::function<bool(const ptree& meta)>;
-  using call_t = std::function<Status(const ptree& meta)>;
+  using test_t = std::function<std::string(const CompactMetaTree& meta)>;
+  using call_t = std::function<Status(const CompactMetaTree& meta)>;
 
   DeferredReq(alive_t alive_fn, test_t test_fn, call_t call_fn)
       : alive_fn_(alive_fn), test_fn_(test_fn), call_fn_(call_fn) {}
 
   bool Alive() const;
 
-  bool TestThenCall(const ptree& meta) const;
+  /**
+   * Returns true if the request has been executed, otherwise updates the key
+   * that the request waits on.
+   */
+  bool TestThenCall(const CompactMetaTree& meta);
+
+  const std::string& Waiting() const { return waiting_; }
 
  private:
   alive_t alive_fn_;
   test_t test_fn_;
   call_t call_fn_;
+  std::string waiting_;
 };
 
 /**
@@ -70,6 +93,12 @@ class DeferredReq {
  */
 class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
  public:
+#if BOOST_VERSION >= 106600
+  using strand_t = asio::strand<asio::io_context::executor_type>;
+#else
+  using strand_t = asio::io_service::strand;
+#endif
+
   Status Serve();
   Status Finalize();
   inline const ptree& GetSpec() { return spec_; }
@@ -81,8 +110,17 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 #else
   inline asio::io_service& GetIOContext() { return context_; }
 #endif
+  /**
+   * @brief The io context may be run on multiple threads, handlers that
+   * access the metadata must be dispatched through the meta strand to
+   * guarantee they are never executed concurrently.
+   */
+  inline strand_t& GetMetaStrand() { return meta_strand_; }
   inline std::shared_ptr<BulkStore> GetBulkStore() { return bulk_store_; }
+  inline std::shared_ptr<DeviceStore> GetDeviceStore() { return device_store_; }
   inline std::shared_ptr<StreamStore> GetStreamStore() { return stream_store_; }
+  inline Metrics& GetMetrics() { return metrics_; }
+  inline SlowRequestRecorder& GetSlowRequests() { return slow_requests_; }
   static std::shared_ptr<VineyardServer> Get(const ptree& spec);
 
   void MetaReady();
@@ -97,15 +135,50 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
                  DeferredReq::alive_t alive,  // if connection is still alive
                  callback_t<const ptree&> callback);
 
+  /**
+   * List objects whose typename matches the pattern, the listing starts after
+   * the cursor and the cursor for the next page is passed to the callback,
+   * which is empty when the listing has been exhausted.
+   */
   Status ListData(std::string const& pattern, bool const regex,
-                  size_t const limit, callback_t<const ptree&> callback);
-
-  Status CreateData(const ptree& tree,
+                  size_t const limit, std::string const& cursor,
+                  callback_t<const ptree&, const std::string&> callback);
+
+  /**
+   * Create the metadata, the object will be deleted after `ttl` seconds if
+   * `ttl` is not 0.
+   */
+  Status CreateData(const ptree& tree, const uint64_t ttl,
                     callback_t<const ObjectID, const InstanceID> callback);
 
-  Status Persist(const ObjectID id, callback_t<> callback);
-
-  Status IfPersist(const ObjectID id, callback_t<const bool> callback);
+  /**
+   * Persist the object, and (re-)schedule its expiry if `ttl` is not 0.
+   */
+  Status Persist(const ObjectID id, const uint64_t ttl, callback_t<> callback);
+
+  /**
+   * Persist the objects with one combined set of changes, which is committed
+   * at once (in chunks if it exceeds the transaction limit of the backend).
+   *
+   * If `write_behind` is true, the callback is invoked once the objects are
+   * persisted in the local metadata, and the changes are committed to the
+   * backend in background, see also `Flush`.
+   */
+  Status Persist(const std::vector<ObjectID>& ids, const uint64_t ttl,
+                 const bool write_behind, callback_t<> callback);
+
+  /**
+   * Wait until the write-behind persists that are issued before have been
+   * committed to the backend.
+   */
+  Status Flush(callback_t<> callback);
+
+  /**
+   * Whether the object has been persisted, and whether the persist has been
+   * committed to the backend (i.e., is durable).
+   */
+  Status IfPersist(const ObjectID id,
+                   callback_t<const bool, const bool> callback);
 
   Status Exists(const ObjectID id, callback_t<const bool> callback);
 
@@ -116,11 +189,31 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status DeleteBlobBatch(const std::set<ObjectID>& blobs);
 
-  Status DeleteAllAt(const ptree& meta, InstanceID const instance_id);
+  /**
+   * Push the deletion notifications to the clients that have got these
+   * objects, thus they can drop them from their metadata caches.
+   */
+  void NotifyDeletion(const std::set<ObjectID>& objects);
+
+  /**
+   * Push the objects that have just been created, and the names that have
+   * just been put, to the clients that have subscribed them.
+   */
+  void NotifySubscribers(const CompactMetaTree& meta, const MetaIndex& index,
+                         const std::vector<ObjectID>& objects,
+                         const std::vector<std::string>& names);
+
+  Status DeleteAllAt(const MetaIndex& index, InstanceID const instance_id);
 
   Status PutName(const ObjectID object_id, const std::string& name,
                  callback_t<> callback);
 
+  /**
+   * Put the names with one commit, see also `Persist(ids, ...)`.
+   */
+  Status PutName(const std::map<std::string, ObjectID>& names,
+                 callback_t<> callback);
+
   Status GetName(const std::string& name, const bool wait,
                  DeferredReq::alive_t alive,  // if connection is still alive
                  callback_t<const ObjectID&> callback);
@@ -131,10 +224,18 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status InstanceStatus(callback_t<const ptree&> callback);
 
-  Status ProcessDeferred(const ptree& meta);
+  /**
+   * Wake up the deferred requests that are waiting on the updated keys.
+   */
+  Status ProcessDeferred(const CompactMetaTree& meta,
+                         const std::set<std::string>& updated_keys);
 
   inline InstanceID instance_id() { return instance_id_; }
-  inline void set_instance_id(InstanceID id) { instance_id_ = id; }
+  inline void set_instance_id(InstanceID id) {
+    instance_id_ = id;
+    // the object ids generated by this instance embed it
+    SetObjectIDInstance(id);
+  }
 
   const std::string IPCSocket();
 
@@ -152,16 +253,98 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 #else
   asio::io_service context_;
 #endif
+  strand_t meta_strand_;
+  std::vector<std::thread> workers_;
   ptree spec_;
   std::shared_ptr<IMetaService> meta_service_ptr_;
   std::unique_ptr<IPCServer> ipc_server_ptr_;
   std::unique_ptr<RPCServer> rpc_server_ptr_;
+  std::unique_ptr<MetricsServer> metrics_server_ptr_;
+
+  using deferred_t = std::list<DeferredReq>;
+
+  void deferRequest(DeferredReq&& request);
+
+  void eraseDeferred(deferred_t::iterator request);
+
+  // drop the requests of closed connections, a few at a time.
+  void sweepDeferred();
+
+  deferred_t deferred_;
+  // waiting key -> requests
+  std::unordered_map<std::string, std::vector<deferred_t::iterator>>
+      deferred_index_;
+  deferred_t::iterator deferred_sweep_;
+
+  /**
+   * Cache the replicas of the remote blobs of the objects in the local bulk
+   * store, then reply the metadata. The replicas are served to the local
+   * clients as the origin blobs, and evicted under memory pressure.
+   */
+  Status cacheRemoteBlobs(const CompactMetaTree& meta, const ptree& tree,
+                          callback_t<const ptree&> callback);
+
+  /**
+   * Find the remote blobs that haven't been cached, grouped by the RPC
+   * endpoints of the instances where they live.
+   */
+  void collectRemoteBlobs(
+      const CompactMetaTree& meta, const ptree& tree,
+      std::map<std::string, std::map<ObjectID, size_t>>& remote_blobs);
+
+  Status fetchRemoteBlobs(const std::string& rpc_endpoint,
+                          const std::map<ObjectID, size_t>& blobs);
+
+  /**
+   * Periodically free the blobs that are neither referenced by the metadata
+   * nor cited by any connection, e.g., the blobs of crashed producers. A blob
+   * is freed when it has been found unreferenced in two successive passes.
+   */
+  void scheduleGC();
+
+  struct gc_pass_t {
+    std::vector<ObjectID> blobs;
+    size_t offset = 0;
+    std::vector<ObjectID> unreferenced;
+    size_t freed = 0;
+  };
+
+  /**
+   * Check the blobs of the pass in time slices, to not stall other tasks.
+   */
+  void collectGarbage(std::shared_ptr<gc_pass_t> pass);
+
+  std::unique_ptr<asio::steady_timer> gc_timer_;
+  std::set<ObjectID> gc_candidates_;
 
-  std::list<DeferredReq> deferred_;
+  /**
+   * Objects with a TTL are tracked by the timer wheel (inside the meta
+   * strand), the expired objects are deleted in batches once per second.
+   */
+  void scheduleExpiry(const ObjectID id, const uint64_t ttl);
+
+  void startExpiryTimer();
+
+  void expireObjects();
+
+  TimerWheel expiry_wheel_;
+  // expired objects that haven't been deleted yet
+  std::vector<ObjectID> expired_;
+  bool expiry_ticking_ = false;
+  std::unique_ptr<asio::steady_timer> expiry_timer_;
+
+  // the maintenance work (e.g., the slices of garbage collection) runs on
+  // the scheduler, which yields to the requests in flight. It outlives the
+  // stores, as the store threads yield through it as well.
+  std::unique_ptr<BackgroundScheduler> background_;
 
   std::shared_ptr<BulkStore> bulk_store_;
+  std::shared_ptr<DeviceStore> device_store_;
   std::shared_ptr<StreamStore> stream_store_;
 
+  Metrics metrics_;
+  SlowRequestRecorder slow_requests_;
+
   Status serve_status_;
   using ctx_guard = asio::executor_work_guard<asio::io_context::executor_type>;
   ctx_guard guard_;
@@ -15,18 +15,75 @@ limitations under the License.
 
 #include "server/services/etcd_meta_service.h"
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "etcd/v3/Transaction.hpp"
+#include "etcd/v3/action_constants.hpp"
 
 #include "common/util/boost.h"
 #include "common/util/logging.h"
+#include "common/util/trace.h"
 
 #define BACKOFF_RETRY_TIME 10
 
 namespace vineyard {
 
+namespace {
+
+/**
+ * The span of the etcd request when the caller is traced, which is finished
+ * when etcd replies.
+ */
+std::shared_ptr<trace::Span> etcdSpan(std::string const& name) {
+  trace::Context context = trace::Current();
+  if (!context.sampled()) {
+    return nullptr;
+  }
+  return std::make_shared<trace::Span>(name, context, "CLIENT");
+}
+
+/**
+ * Account the wait for etcd to the request that is being handled, if any.
+ */
+void addEtcdWait(std::shared_ptr<RequestStats> const& stats,
+                 std::chrono::steady_clock::time_point const start) {
+  if (stats) {
+    stats->etcd_us.fetch_add(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count(),
+        std::memory_order_relaxed);
+  }
+}
+
+/**
+ * Delete the key (i.e., the compact value of an object) and every key under
+ * "<key>.", the range ends at the prefix with its last byte incremented.
+ */
+void setupDeletePrefix(etcdv3::Transaction& tx, std::string const& key) {
+  tx.setup_delete(key);
+  std::string prefix = key + ".";
+  std::string range_end = prefix;
+  range_end.back() += 1;
+  auto request = tx.txn_request.add_success()->mutable_request_delete_range();
+  request->set_key(prefix);
+  request->set_range_end(range_end);
+}
+
+bool hasRanges(std::vector<IMetaService::op_t> const& ops) {
+  return std::any_of(ops.begin(), ops.end(), [](IMetaService::op_t const& op) {
+    return op.op == IMetaService::op_t::kDelPrefix;
+  });
+}
+
+}  // namespace
+
 void EtcdWatchHandler::operator()(pplx::task<etcd::Response> const& resp_task) {
   this->operator()(resp_task.get());
 }
@@ -90,7 +147,7 @@ void EtcdMetaService::requestLock(
             resp.index());
         auto status =
             Status::EtcdError(resp.error_code(), resp.error_message());
-        boost::asio::post(server_ptr_->GetIOContext(),
+        boost::asio::post(server_ptr_->GetMetaStrand(),
                           boost::bind(callback_after_locked, status, lock_ptr));
       });
 }
@@ -98,36 +155,244 @@ void EtcdMetaService::requestLock(
 void EtcdMetaService::commitUpdates(
     const std::vector<op_t>& changes,
     callback_t<unsigned> callback_after_updated) {
+  enqueueCommit(commit_t{
+      changes, false, 0,
+      [callback_after_updated](const Status& status, const bool committed,
+                               unsigned rev) {
+        return callback_after_updated(status, rev);
+      }});
+}
+
+void EtcdMetaService::commitUpdatesIfUnchanged(
+    const std::vector<op_t>& changes, unsigned const since_rev,
+    callback_t<const bool, unsigned> callback_after_updated) {
+  enqueueCommit(commit_t{changes, true, since_rev, callback_after_updated});
+}
+
+void EtcdMetaService::enqueueCommit(commit_t&& commit) {
+  // the commits are flushed later, thus the request that issues the commit
+  // waits for etcd from now on
+  auto span = etcdSpan("etcd commit");
+  auto stats = RequestStats::Current();
+  if (span || stats) {
+    if (span) {
+      span->Tag("ops", std::to_string(commit.ops.size()));
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto callback = std::move(commit.callback);
+    commit.callback = [span, stats, start, callback](
+                          const Status& status, const bool committed,
+                          unsigned rev) {
+      if (span) {
+        span->Tag("committed", committed ? "true" : "false");
+        span->Finish();
+      }
+      addEtcdWait(stats, start);
+      return callback(status, committed, rev);
+    };
+  }
+  pending_commits_.emplace_back(std::move(commit));
+  if (commit_scheduled_) {
+    return;
+  }
+  commit_scheduled_ = true;
+  if (commit_window_ <= 0) {
+    // still coalesces the commits that are issued in the same round
+    asio::post(server_ptr_->GetMetaStrand(), [this]() { flushCommits(); });
+    return;
+  }
+  commit_timer_.reset(
+      new asio::steady_timer(server_ptr_->GetIOContext(),
+                             asio::chrono::microseconds(commit_window_)));
+  commit_timer_->async_wait(asio::bind_executor(
+      server_ptr_->GetMetaStrand(),
+      [this](const boost::system::error_code& error) { flushCommits(); }));
+}
+
+void EtcdMetaService::flushCommits() {
+  commit_scheduled_ = false;
+  std::vector<commit_t> batch;
+  std::set<std::string> batch_keys;
+  size_t batch_ops = 0;
+  while (!pending_commits_.empty()) {
+    commit_t commit = std::move(pending_commits_.front());
+    pending_commits_.pop_front();
+    if (max_txn_ops_ != 0 && commit.ops.size() > max_txn_ops_) {
+      if (commit.conditional) {
+        VINEYARD_SUPPRESS(commit.callback(
+            Status::Invalid("Too many changes for a conditional commit"), false,
+            rev_));
+      } else {
+        std::string marker = CHUNKED_COMMIT_PREFIX +
+                             std::to_string(server_ptr_->instance_id()) + "_" +
+                             std::to_string(chunked_commit_seq_++);
+        commitChunks(std::make_shared<commit_t>(std::move(commit)), marker, 0);
+      }
+      continue;
+    }
+    // a key cannot be changed twice in one transaction, and the range
+    // deletions are committed alone rather than being checked for overlaps
+    bool const ranged = hasRanges(commit.ops);
+    bool overlapped = ranged;
+    for (auto const& op : commit.ops) {
+      if (batch_keys.find(op.kv.key) != batch_keys.end()) {
+        overlapped = true;
+        break;
+      }
+    }
+    if (!batch.empty() &&
+        (overlapped || (max_txn_ops_ != 0 &&
+                        batch_ops + commit.ops.size() > max_txn_ops_))) {
+      commitBatch(std::move(batch));
+      batch.clear();
+      batch_keys.clear();
+      batch_ops = 0;
+    }
+    if (ranged) {
+      commitBatch(std::vector<commit_t>{std::move(commit)});
+      continue;
+    }
+    for (auto const& op : commit.ops) {
+      batch_keys.emplace(op.kv.key);
+    }
+    batch_ops += commit.ops.size();
+    batch.emplace_back(std::move(commit));
+  }
+  if (!batch.empty()) {
+    commitBatch(std::move(batch));
+  }
+}
+
+void EtcdMetaService::commitBatch(std::vector<commit_t>&& batch) {
+  etcdv3::Transaction tx;
+  size_t txn_ops = 0, txn_bytes = 0;
+  for (auto const& commit : batch) {
+    std::set<std::string> compared_keys;
+    for (auto const& op : commit.ops) {
+      std::string key = prefix_ + op.kv.key;
+      txn_ops += 1;
+      txn_bytes += key.size() + op.kv.value.size();
+      if (commit.conditional && op.op != op_t::kDelPrefix &&
+          compared_keys.emplace(key).second) {
+        // the key must not have been modified after `since_rev`
+        auto compare = tx.txn_request.add_compare();
+        compare->set_result(etcdserverpb::Compare::LESS);
+        compare->set_target(etcdserverpb::Compare::MOD);
+        compare->set_key(key);
+        compare->set_mod_revision(commit.since_rev + 1);
+      }
+      if (op.op == op_t::kPut) {
+        tx.setup_put(key, op.kv.value);
+      } else if (op.op == op_t::kDel) {
+        tx.setup_delete(key);
+      } else if (op.op == op_t::kDelPrefix) {
+        setupDeletePrefix(tx, key);
+      }
+    }
+  }
+  server_ptr_->GetMetrics().RecordEtcdTxn(txn_ops, txn_bytes);
+  auto commits = std::make_shared<std::vector<commit_t>>(std::move(batch));
+  etcd_->txn(tx).then([this, commits](
+                          pplx::task<etcd::Response> const& resp_task) {
+    auto resp = resp_task.get();
+    VLOG(10) << "etcd txn use " << resp.duration().count()
+             << " microseconds for " << commits->size() << " commits";
+    server_ptr_->GetMetrics().RecordEtcdCommit(resp.duration().count());
+    int error_code = resp.error_code();
+    std::string error_message = resp.error_message();
+    unsigned rev = resp.index();
+    asio::post(server_ptr_->GetMetaStrand(), [this, commits, error_code,
+                                              error_message, rev]() {
+      if (error_code == etcdv3::ERROR_COMPARE_FAILED) {
+        if (commits->size() == 1) {
+          auto& commit = commits->front();
+          VINEYARD_SUPPRESS(commit.callback(Status::OK(), false, rev));
+        } else {
+          // don't let the conflicting commit fail the others
+          for (auto const& commit : *commits) {
+            commitBatch(std::vector<commit_t>{commit});
+          }
+        }
+        return;
+      }
+      auto status = Status::EtcdError(error_code, error_message);
+      for (auto const& commit : *commits) {
+        VINEYARD_SUPPRESS(commit.callback(status, status.ok(), rev));
+      }
+    });
+  });
+}
+
+void EtcdMetaService::commitChunks(std::shared_ptr<commit_t> commit,
+                                   std::string const& marker,
+                                   size_t const offset) {
+  size_t end = std::min(commit->ops.size(), offset + max_txn_ops_ - 1);
   etcdv3::Transaction tx;
-  for (auto const& op : changes) {
+  size_t txn_bytes = 0;
+  for (size_t index = offset; index < end; ++index) {
+    auto const& op = commit->ops[index];
+    txn_bytes += prefix_.size() + op.kv.key.size() + op.kv.value.size();
     if (op.op == op_t::kPut) {
       tx.setup_put(prefix_ + op.kv.key, op.kv.value);
     } else if (op.op == op_t::kDel) {
       tx.setup_delete(prefix_ + op.kv.key);
+    } else if (op.op == op_t::kDelPrefix) {
+      setupDeletePrefix(tx, prefix_ + op.kv.key);
     }
   }
-  etcd_->txn(tx).then([this, callback_after_updated](
+  bool const last = end == commit->ops.size();
+  if (last) {
+    tx.setup_delete(prefix_ + marker);
+  } else {
+    tx.setup_put(prefix_ + marker, std::to_string(end));
+  }
+  server_ptr_->GetMetrics().RecordEtcdTxn(end - offset + 1, txn_bytes);
+  etcd_->txn(tx).then([this, commit, marker, end, last](
                           pplx::task<etcd::Response> const& resp_task) {
     auto resp = resp_task.get();
-    VLOG(10) << "etcd txn use " << resp.duration().count() << " microseconds";
+    VLOG(10) << "etcd txn use " << resp.duration().count()
+             << " microseconds for the chunk ending at " << end;
+    server_ptr_->GetMetrics().RecordEtcdCommit(resp.duration().count());
     auto status = Status::EtcdError(resp.error_code(), resp.error_message());
-    boost::asio::post(
-        server_ptr_->GetIOContext(),
-        boost::bind(callback_after_updated, status, resp.index()));
+    unsigned rev = resp.index();
+    asio::post(server_ptr_->GetMetaStrand(),
+               [this, commit, marker, end, last, status, rev]() {
+                 if (!status.ok() || last) {
+                   if (!status.ok()) {
+                     LOG(ERROR) << "Failed to commit the chunked updates "
+                                << marker << ": " << status.ToString();
+                   }
+                   VINEYARD_SUPPRESS(
+                       commit->callback(status, status.ok(), rev));
+                   return;
+                 }
+                 commitChunks(commit, marker, end);
+               });
   });
 }
 
 void EtcdMetaService::requestAll(
     const std::string& prefix, unsigned base_rev,
     callback_t<const std::vector<kv_t>&, unsigned> callback) {
+  auto span = etcdSpan("etcd ls");
+  auto stats = RequestStats::Current();
+  auto start = std::chrono::steady_clock::now();
   etcd_->ls(prefix_ + prefix)
-      .then([this, callback](pplx::task<etcd::Response> resp_task) {
+      .then([this, callback, span, stats,
+             start](pplx::task<etcd::Response> resp_task) {
         auto resp = resp_task.get();
+        addEtcdWait(stats, start);
+        if (span) {
+          span->Tag("keys", std::to_string(resp.keys().size()));
+          span->Finish();
+        }
         VLOG(10) << "etcd ls use " << resp.duration().count()
                  << " microseconds for " << resp.keys().size() << " keys";
-        std::vector<IMetaService::kv_t> kvs(resp.keys().size());
+        std::vector<IMetaService::kv_t> kvs;
+        kvs.reserve(resp.keys().size());
         for (size_t i = 0; i < resp.keys().size(); ++i) {
           IMetaService::kv_t kv;
+          kv.rev = 0;
           kv.key =
               boost::algorithm::erase_head_copy(resp.key(i), prefix_.size());
           kv.value = resp.value(i).as_string();
@@ -135,17 +400,103 @@ void EtcdMetaService::requestAll(
         }
         auto status =
             Status::EtcdError(resp.error_code(), resp.error_message());
-        boost::asio::post(server_ptr_->GetIOContext(),
+        boost::asio::post(server_ptr_->GetMetaStrand(),
                           boost::bind(callback, status, kvs, resp.index()));
       });
 }
 
+void EtcdMetaService::requestObjects(
+    const std::vector<ObjectID>& ids,
+    callback_t<const std::vector<kv_t>&, unsigned> callback) {
+  // the objects are read by the range requests in a few transactions, at
+  // most `max_txn_ops_` ranges per transaction, and gathered before invoking
+  // the callback
+  struct gathered_t {
+    std::mutex mutex;
+    size_t pending;
+    Status status;
+    std::vector<IMetaService::kv_t> kvs;
+    unsigned rev = 0;
+  };
+  if (ids.empty()) {
+    boost::asio::post(server_ptr_->GetMetaStrand(),
+                      boost::bind(callback, Status::OK(),
+                                  std::vector<IMetaService::kv_t>{}, 0));
+    return;
+  }
+  size_t batch_size = max_txn_ops_ == 0 ? ids.size() : max_txn_ops_;
+  auto gathered = std::make_shared<gathered_t>();
+  gathered->pending = (ids.size() + batch_size - 1) / batch_size;
+  auto span = etcdSpan("etcd get objects");
+  auto stats = RequestStats::Current();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t offset = 0; offset < ids.size(); offset += batch_size) {
+    etcdv3::Transaction tx;
+    size_t end = std::min(ids.size(), offset + batch_size);
+    for (size_t i = offset; i < end; ++i) {
+      // the object ids are of the same length, thus the range matches
+      // exactly the keys of the object
+      std::string key = prefix_ + "data." + VYObjectIDToString(ids[i]);
+      std::string range_end = key;
+      range_end.back() += 1;
+      auto request = tx.txn_request.add_success()->mutable_request_range();
+      request->set_key(key);
+      request->set_range_end(range_end);
+    }
+    etcd_->txn(tx).then([this, callback, gathered, span, stats,
+                         start](pplx::task<etcd::Response> resp_task) {
+      auto resp = resp_task.get();
+      std::lock_guard<std::mutex> lock(gathered->mutex);
+      auto status = Status::EtcdError(resp.error_code(), resp.error_message());
+      if (!status.ok()) {
+        gathered->status = status;
+      }
+      for (auto const& value : resp.values()) {
+        IMetaService::kv_t kv;
+        kv.rev = 0;
+        kv.key = boost::algorithm::erase_head_copy(value.key(), prefix_.size());
+        kv.value = value.as_string();
+        gathered->kvs.emplace_back(kv);
+      }
+      gathered->rev =
+          std::max(gathered->rev, static_cast<unsigned>(resp.index()));
+      if (--gathered->pending != 0) {
+        return;
+      }
+      addEtcdWait(stats, start);
+      if (span) {
+        span->Tag("keys", std::to_string(gathered->kvs.size()));
+        span->Finish();
+      }
+      boost::asio::post(
+          server_ptr_->GetMetaStrand(),
+          boost::bind(callback, gathered->status, std::move(gathered->kvs),
+                      gathered->rev));
+    });
+  }
+}
+
 void EtcdMetaService::requestUpdates(
     const std::string& prefix, unsigned since_rev,
     callback_t<const std::vector<op_t>&, unsigned> callback) {
+  auto span = etcdSpan("etcd watch");
+  auto stats = RequestStats::Current();
+  if (span || stats) {
+    auto start = std::chrono::steady_clock::now();
+    callback = [span, stats, start, callback](
+                   const Status& status, const std::vector<op_t>& ops,
+                   unsigned rev) {
+      if (span) {
+        span->Tag("ops", std::to_string(ops.size()));
+        span->Finish();
+      }
+      addEtcdWait(stats, start);
+      return callback(status, ops, rev);
+    };
+  }
   // NB: watching from latest version (since_rev) + 1
   etcd_->watch(prefix_ + prefix, since_rev + 1, true)
-      .then(EtcdWatchHandler(server_ptr_->GetIOContext(), callback, prefix_,
+      .then(EtcdWatchHandler(server_ptr_->GetMetaStrand(), callback, prefix_,
                              prefix_ + meta_sync_lock_));
 }
 
@@ -155,35 +506,41 @@ void EtcdMetaService::startDaemonWatch(
   try {
     this->watcher_.reset(new etcd::Watcher(
         *etcd_, prefix_ + prefix, since_rev + 1,
-        EtcdWatchHandler(server_ptr_->GetIOContext(), callback, prefix_,
+        EtcdWatchHandler(server_ptr_->GetMetaStrand(), callback, prefix_,
                          prefix_ + meta_sync_lock_),
         true));
+    this->daemonWatchStateChanged(true);
     this->watcher_->Wait([this, prefix, callback](bool cancalled) {
+      asio::post(server_ptr_->GetMetaStrand(),
+                 [this]() { this->daemonWatchStateChanged(false); });
       if (cancalled) {
         return;
       }
-      this->retryDaeminWatch(prefix, this->rev_, callback);
+      this->retryDaeminWatch(prefix, callback);
     });
   } catch (std::runtime_error& e) {
     LOG(ERROR) << "Failed to create daemon etcd watcher: " << e.what();
-    this->retryDaeminWatch(prefix, since_rev, callback);
+    this->retryDaeminWatch(prefix, callback);
   }
 }
 
 void EtcdMetaService::retryDaeminWatch(
-    const std::string& prefix, unsigned since_rev,
+    const std::string& prefix,
     callback_t<const std::vector<op_t>&, unsigned> callback) {
   backoff_timer_.reset(new asio::steady_timer(
       server_ptr_->GetIOContext(), asio::chrono::seconds(BACKOFF_RETRY_TIME)));
-  backoff_timer_->async_wait([this, prefix, since_rev, callback](
-                                 const boost::system::error_code& error) {
-    if (error) {
-      LOG(ERROR) << "backoff timer error: " << error << ", " << error.message();
-    }
-    // retry
-    LOG(INFO) << "retrying to connect etcd...";
-    this->startDaemonWatch(prefix, since_rev, callback);
-  });
+  backoff_timer_->async_wait(asio::bind_executor(
+      server_ptr_->GetMetaStrand(),
+      [this, prefix, callback](const boost::system::error_code& error) {
+        if (error) {
+          LOG(ERROR) << "backoff timer error: " << error << ", "
+                     << error.message();
+        }
+        // retry from the latest revision that has been applied, which may
+        // have been advanced by a resync.
+        LOG(INFO) << "retrying to connect etcd...";
+        this->startDaemonWatch(prefix, this->rev_, callback);
+      }));
 }
 
 }  // namespace vineyard
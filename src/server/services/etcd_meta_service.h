@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef SRC_SERVER_SERVICES_ETCD_META_SERVICE_H_
 #define SRC_SERVER_SERVICES_ETCD_META_SERVICE_H_
 
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -35,11 +36,7 @@ namespace vineyard {
 class EtcdWatchHandler {
  public:
   EtcdWatchHandler(
-#if BOOST_VERSION >= 106600
-      asio::io_context& ctx,
-#else
-      asio::io_service& ctx,
-#endif
+      VineyardServer::strand_t& ctx,
       callback_t<const std::vector<IMetaService::op_t>&, unsigned> callback,
       std::string const& prefix, std::string const& filter_prefix)
       : ctx_(ctx),
@@ -52,11 +49,8 @@ class EtcdWatchHandler {
   void operator()(etcd::Response const& task);
 
  private:
-#if BOOST_VERSION >= 106600
-  asio::io_context& ctx_;
-#else
-  asio::io_service& ctx_;
-#endif
+  // the meta strand of the vineyard server
+  VineyardServer::strand_t& ctx_;
   const callback_t<const std::vector<IMetaService::op_t>&, unsigned> callback_;
   std::string const prefix_, filter_prefix_;
 };
@@ -103,7 +97,10 @@ class EtcdMetaService : public IMetaService {
   explicit EtcdMetaService(vs_ptr_t& server_ptr)
       : IMetaService(server_ptr),
         etcd_spec_(server_ptr_->GetSpec().get_child("metastore_spec")),
-        prefix_(etcd_spec_.get<std::string>("prefix")) {
+        prefix_(etcd_spec_.get<std::string>("prefix")),
+        commit_window_(etcd_spec_.get<int>("commit_window", 0)) {
+    max_txn_ops_ = etcd_spec_.get<size_t>("max_txn_ops", 128);
+    compact_values_ = etcd_spec_.get<bool>("compact_values", false);
     auto launcher = EtcdLauncher(etcd_spec_);
     VINEYARD_CHECK_OK(
         launcher.LaunchEtcdServer(etcd_, meta_sync_lock_, etcd_proc_));
@@ -121,15 +118,23 @@ class EtcdMetaService : public IMetaService {
       const std::string& prefix, unsigned since_rev,
       callback_t<const std::vector<op_t>&, unsigned> callback) override;
 
+  void requestObjects(
+      const std::vector<ObjectID>& ids,
+      callback_t<const std::vector<kv_t>&, unsigned> callback) override;
+
   void commitUpdates(const std::vector<op_t>&,
                      callback_t<unsigned> callback_after_updated) override;
 
+  void commitUpdatesIfUnchanged(
+      const std::vector<op_t>& changes, unsigned const since_rev,
+      callback_t<const bool, unsigned> callback_after_updated) override;
+
   void startDaemonWatch(
       const std::string& prefix, unsigned since_rev,
       callback_t<const std::vector<op_t>&, unsigned> callback) override;
 
   void retryDaeminWatch(
-      const std::string& prefix, unsigned since_rev,
+      const std::string& prefix,
       callback_t<const std::vector<op_t>&, unsigned> callback);
 
   Status probe() override {
@@ -145,6 +150,36 @@ class EtcdMetaService : public IMetaService {
   const std::string prefix_;
 
  private:
+  struct commit_t {
+    std::vector<op_t> ops;
+    bool conditional;
+    unsigned since_rev;
+    callback_t<const bool, unsigned> callback;
+  };
+
+  /**
+   * Commits are queued and flushed together after the commit window, updates
+   * on disjoint keys are coalesced into one transaction.
+   */
+  void enqueueCommit(commit_t&& commit);
+
+  void flushCommits();
+
+  void commitBatch(std::vector<commit_t>&& batch);
+
+  /**
+   * Commit the oversized update in ordered transactions, with a marker that
+   * tells the watchers to apply them at once when the last chunk arrives.
+   */
+  void commitChunks(std::shared_ptr<commit_t> commit, std::string const& marker,
+                    size_t const offset);
+
+  const int commit_window_;  // in microseconds
+  std::deque<commit_t> pending_commits_;
+  bool commit_scheduled_ = false;
+  std::unique_ptr<asio::steady_timer> commit_timer_;
+  size_t chunked_commit_seq_ = 0;
+
   std::unique_ptr<etcd::Client> etcd_;
   std::shared_ptr<etcd::Watcher> watcher_;
   std::unique_ptr<asio::steady_timer> backoff_timer_;
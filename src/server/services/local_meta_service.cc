@@ -0,0 +1,406 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/services/local_meta_service.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "common/util/boost.h"
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+/**
+ * Layout of the write-ahead log, every commit is a length-prefixed record:
+ *
+ *    record := <u32 size> <u32 revision> <u32 number of ops> op*
+ *    op     := <u8 type> <u32 key size> key <u32 value size> value
+ *
+ * A truncated record at the tail (e.g., crashed during writing) is dropped
+ * when replaying.
+ */
+namespace {
+
+void put_u32(std::string& buffer, uint32_t const value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(uint32_t));
+}
+
+void put_string(std::string& buffer, std::string const& value) {
+  put_u32(buffer, static_cast<uint32_t>(value.size()));
+  buffer.append(value);
+}
+
+bool get_u32(std::string const& buffer, size_t& offset, uint32_t& value) {
+  if (offset + sizeof(uint32_t) > buffer.size()) {
+    return false;
+  }
+  memcpy(&value, buffer.data() + offset, sizeof(uint32_t));
+  offset += sizeof(uint32_t);
+  return true;
+}
+
+bool get_string(std::string const& buffer, size_t& offset,
+                std::string& value) {
+  uint32_t size = 0;
+  if (!get_u32(buffer, offset, size) || offset + size > buffer.size()) {
+    return false;
+  }
+  value.assign(buffer.data() + offset, size);
+  offset += size;
+  return true;
+}
+
+void encode_record(std::vector<IMetaService::op_t> const& ops,
+                   unsigned const rev, std::string& record) {
+  std::string payload;
+  put_u32(payload, rev);
+  put_u32(payload, static_cast<uint32_t>(ops.size()));
+  for (auto const& op : ops) {
+    payload.push_back(static_cast<char>(op.op));
+    put_string(payload, op.kv.key);
+    put_string(payload, op.kv.value);
+  }
+  put_u32(record, static_cast<uint32_t>(payload.size()));
+  record.append(payload);
+}
+
+Status write_fully(int const fd, std::string const& content) {
+  size_t offset = 0;
+  while (offset < content.size()) {
+    ssize_t n = write(fd, content.data() + offset, content.size() - offset);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return Status::IOError("Failed to write the metadata log: " +
+                             std::string(strerror(errno)));
+    }
+    offset += n;
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+LocalMetaService::LocalMetaService(vs_ptr_t& server_ptr)
+    : IMetaService(server_ptr),
+      local_spec_(server_ptr_->GetSpec().get_child("metastore_spec")),
+      wal_path_(local_spec_.get<std::string>("wal_path", "")),
+      wal_sync_(local_spec_.get<bool>("wal_sync", false)) {
+  // the revision 0 means "nothing has been loaded" for the meta service
+  revision_ = 1;
+  wal_status_ = recoverFromWAL();
+}
+
+void LocalMetaService::requestLock(
+    std::string lock_name,
+    callback_t<std::shared_ptr<ILock>> callback_after_locked) {
+  if (locked_.find(lock_name) != locked_.end()) {
+    lock_waiters_[lock_name].emplace_back(callback_after_locked);
+    return;
+  }
+  locked_.emplace(lock_name);
+  grantLock(lock_name, callback_after_locked);
+}
+
+void LocalMetaService::grantLock(
+    std::string const& lock_name,
+    callback_t<std::shared_ptr<ILock>> callback_after_locked) {
+  auto lock_ptr = std::make_shared<LocalLock>(
+      [this, lock_name](const Status& status, unsigned& rev) {
+        rev = this->revision_;
+        this->releaseLock(lock_name);
+        return Status::OK();
+      },
+      revision_);
+  boost::asio::post(
+      server_ptr_->GetMetaStrand(),
+      boost::bind(callback_after_locked, Status::OK(), lock_ptr));
+}
+
+void LocalMetaService::releaseLock(std::string const& lock_name) {
+  auto waiters = lock_waiters_.find(lock_name);
+  if (waiters == lock_waiters_.end()) {
+    locked_.erase(lock_name);
+    return;
+  }
+  // hand over the lock to the next waiter
+  auto callback = waiters->second.front();
+  waiters->second.pop_front();
+  if (waiters->second.empty()) {
+    lock_waiters_.erase(waiters);
+  }
+  grantLock(lock_name, callback);
+}
+
+void LocalMetaService::requestAll(
+    const std::string& prefix, unsigned base_rev,
+    callback_t<const std::vector<kv_t>&, unsigned> callback) {
+  std::vector<kv_t> kvs;
+  if (!recovered_consumed_) {
+    kvs.reserve(recovered_.size());
+    for (auto const& item : recovered_) {
+      if (boost::algorithm::starts_with(item.first, prefix)) {
+        kvs.emplace_back(kv_t{item.first, item.second, 0});
+      }
+    }
+    recovered_.clear();
+    recovered_consumed_ = true;
+  } else {
+    // the local metadata tree is the only copy of the metadata
+    std::vector<std::string> keys;
+    collectKeys(CompactMetaTree::kRoot, "", keys);
+    kvs.reserve(keys.size());
+    for (auto const& key : keys) {
+      if (boost::algorithm::starts_with(key, prefix)) {
+        kvs.emplace_back(kv_t{key, meta_.Data(meta_.Find(key)), 0});
+      }
+    }
+  }
+  boost::asio::post(server_ptr_->GetMetaStrand(),
+                    boost::bind(callback, Status::OK(), kvs, revision_));
+}
+
+void LocalMetaService::requestUpdates(
+    const std::string& prefix, unsigned since_rev,
+    callback_t<const std::vector<op_t>&, unsigned> callback) {
+  // every committed change has been applied to the local metadata tree
+  // by the committer
+  boost::asio::post(server_ptr_->GetMetaStrand(),
+                    boost::bind(callback, Status::OK(), std::vector<op_t>{},
+                                revision_));
+}
+
+void LocalMetaService::requestObjects(
+    const std::vector<ObjectID>& ids,
+    callback_t<const std::vector<kv_t>&, unsigned> callback) {
+  // the objects that aren't in the local metadata tree don't exist at all
+  boost::asio::post(server_ptr_->GetMetaStrand(),
+                    boost::bind(callback, Status::OK(), std::vector<kv_t>{},
+                                revision_));
+}
+
+void LocalMetaService::commitUpdates(
+    const std::vector<op_t>& changes,
+    callback_t<unsigned> callback_after_updated) {
+  unsigned rev = revision_;
+  auto status = commit(changes, rev);
+  boost::asio::post(server_ptr_->GetMetaStrand(),
+                    boost::bind(callback_after_updated, status, rev));
+  if (status.ok() && daemon_callback_) {
+    // let the daemon watch catch up with the revision
+    boost::asio::post(server_ptr_->GetMetaStrand(),
+                      boost::bind(daemon_callback_, Status::OK(),
+                                  std::vector<op_t>{}, rev));
+  }
+}
+
+void LocalMetaService::commitUpdatesIfUnchanged(
+    const std::vector<op_t>& changes, unsigned const since_rev,
+    callback_t<const bool, unsigned> callback_after_updated) {
+  bool conflicted = false;
+  for (auto const& change : recent_changes_) {
+    if (change.first <= since_rev) {
+      continue;
+    }
+    for (auto const& op : changes) {
+      if (change.second.find(op.kv.key) != change.second.end()) {
+        conflicted = true;
+        break;
+      }
+    }
+    if (conflicted) {
+      break;
+    }
+  }
+  if (conflicted) {
+    boost::asio::post(server_ptr_->GetMetaStrand(),
+                      boost::bind(callback_after_updated, Status::OK(), false,
+                                  revision_));
+    return;
+  }
+  commitUpdates(changes,
+                [callback_after_updated](const Status& status, unsigned rev) {
+                  return callback_after_updated(status, status.ok(), rev);
+                });
+}
+
+void LocalMetaService::startDaemonWatch(
+    const std::string& prefix, unsigned since_rev,
+    callback_t<const std::vector<op_t>&, unsigned> callback) {
+  daemon_callback_ = callback;
+  this->daemonWatchStateChanged(true);
+  if (since_rev < revision_) {
+    boost::asio::post(server_ptr_->GetMetaStrand(),
+                      boost::bind(callback, Status::OK(), std::vector<op_t>{},
+                                  revision_));
+  }
+}
+
+Status LocalMetaService::commit(const std::vector<op_t>& changes,
+                                unsigned& rev) {
+  RETURN_ON_ERROR(appendToWAL(changes, revision_ + 1));
+  rev = ++revision_;
+
+  // the changes that have been observed by the meta tree won't be compared
+  // again
+  while (!recent_changes_.empty() && recent_changes_.front().first <= rev_) {
+    recent_changes_.pop_front();
+  }
+  std::set<std::string> keys;
+  for (auto const& op : changes) {
+    keys.emplace(op.kv.key);
+  }
+  recent_changes_.emplace_back(rev, std::move(keys));
+  return Status::OK();
+}
+
+Status LocalMetaService::recoverFromWAL() {
+  if (wal_path_.empty()) {
+    return Status::OK();
+  }
+  std::ifstream in(wal_path_, std::ios::in | std::ios::binary);
+  if (in.is_open()) {
+    std::string content((std::istreambuf_iterator<char>(in)),
+                        std::istreambuf_iterator<char>());
+    size_t offset = 0, records = 0;
+    while (offset < content.size()) {
+      uint32_t size = 0, rev = 0, nops = 0;
+      size_t begin = offset;
+      if (!get_u32(content, offset, size) || offset + size > content.size()) {
+        LOG(WARNING) << "Dropping the truncated tail of the metadata log at "
+                     << begin << ", " << (content.size() - begin) << " bytes";
+        break;
+      }
+      std::vector<std::pair<char, kv_t>> ops;
+      bool valid = get_u32(content, offset, rev) &&
+                   get_u32(content, offset, nops);
+      for (uint32_t i = 0; valid && i < nops; ++i) {
+        kv_t kv;
+        valid = offset < content.size();
+        if (valid) {
+          char op = content[offset++];
+          valid = get_string(content, offset, kv.key) &&
+                  get_string(content, offset, kv.value);
+          ops.emplace_back(op, kv);
+        }
+      }
+      if (!valid || offset != begin + sizeof(uint32_t) + size) {
+        return Status::IOError("Corrupted metadata log '" + wal_path_ +
+                               "' at offset " + std::to_string(begin));
+      }
+      for (auto const& op : ops) {
+        if (op.first == op_t::kPut) {
+          recovered_[op.second.key] = op.second.value;
+        } else if (op.first == op_t::kDelPrefix) {
+          // the key itself may be the compact value of an object
+          recovered_.erase(op.second.key);
+          const std::string prefix = op.second.key + ".";
+          auto iter = recovered_.lower_bound(prefix);
+          while (iter != recovered_.end() &&
+                 iter->first.compare(0, prefix.size(), prefix) == 0) {
+            iter = recovered_.erase(iter);
+          }
+        } else {
+          recovered_.erase(op.second.key);
+        }
+      }
+      revision_ = std::max(revision_, static_cast<unsigned>(rev));
+      records += 1;
+    }
+    LOG(INFO) << "Recovered " << recovered_.size() << " keys from " << records
+              << " records of the metadata log '" << wal_path_
+              << "', revision = " << revision_;
+  }
+  in.close();
+
+  // instances of the previous run have gone, the local metastore is not
+  // shared with other vineyardd
+  for (auto iter = recovered_.begin(); iter != recovered_.end();) {
+    if (boost::algorithm::starts_with(iter->first, "instances.")) {
+      iter = recovered_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  // rewrite the log as a snapshot to bound its size
+  std::vector<op_t> snapshot;
+  snapshot.reserve(recovered_.size());
+  for (auto const& item : recovered_) {
+    snapshot.emplace_back(op_t::Put(item.first, item.second));
+  }
+  std::string record;
+  encode_record(snapshot, revision_, record);
+  std::string snapshot_path = wal_path_ + ".snapshot";
+  int fd = open(snapshot_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    return Status::IOError("Failed to open the metadata log '" +
+                           snapshot_path + "': " + strerror(errno));
+  }
+  auto status = write_fully(fd, record);
+  if (status.ok() && fsync(fd) != 0) {
+    status = Status::IOError("Failed to sync the metadata log: " +
+                             std::string(strerror(errno)));
+  }
+  close(fd);
+  RETURN_ON_ERROR(status);
+  if (rename(snapshot_path.c_str(), wal_path_.c_str()) != 0) {
+    return Status::IOError("Failed to replace the metadata log '" + wal_path_ +
+                           "': " + strerror(errno));
+  }
+
+  wal_fd_ = open(wal_path_.c_str(), O_WRONLY | O_APPEND);
+  if (wal_fd_ == -1) {
+    return Status::IOError("Failed to open the metadata log '" + wal_path_ +
+                           "': " + strerror(errno));
+  }
+  LOG(INFO) << "Appending metadata changes to '" << wal_path_ << "'";
+  return Status::OK();
+}
+
+Status LocalMetaService::appendToWAL(const std::vector<op_t>& changes,
+                                     unsigned const rev) {
+  if (wal_fd_ == -1) {
+    return Status::OK();
+  }
+  std::string record;
+  encode_record(changes, rev, record);
+  off_t end = lseek(wal_fd_, 0, SEEK_END);
+  auto status = write_fully(wal_fd_, record);
+  if (!status.ok()) {
+    // drop the partially written record, to keep the log replayable
+    if (end != -1 && ftruncate(wal_fd_, end) != 0) {
+      LOG(ERROR) << "Failed to truncate the metadata log: " << strerror(errno);
+    }
+    return status;
+  }
+  if (wal_sync_ && fdatasync(wal_fd_) != 0) {
+    return Status::IOError("Failed to sync the metadata log: " +
+                           std::string(strerror(errno)));
+  }
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,147 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
+#define SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
+
+#include <unistd.h>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "server/services/meta_service.h"
+
+namespace vineyard {
+
+/**
+ * @brief LocalLock is the lock of the in-process meta service, the waiters
+ * are granted in order when the lock is released.
+ *
+ */
+class LocalLock : public ILock {
+ public:
+  Status Release(unsigned& rev) override {
+    return callback_(Status::OK(), rev);
+  }
+  ~LocalLock() override {}
+
+  explicit LocalLock(const callback_t<unsigned&>& callback, unsigned rev)
+      : ILock(rev), callback_(callback) {}
+
+ protected:
+  const callback_t<unsigned&> callback_;
+};
+
+/**
+ * @brief LocalMetaService keeps the metadata inside the vineyardd process for
+ * single-node deployments, without launching or connecting to etcd.
+ *
+ * The metadata tree of `IMetaService` is the only copy of the metadata, and
+ * every commit is appended to a write-ahead log (if `--meta_wal` is given),
+ * which is replayed at startup.
+ */
+class LocalMetaService : public IMetaService {
+ public:
+  inline void Stop() override {
+    if (wal_fd_ != -1) {
+      close(wal_fd_);
+      wal_fd_ = -1;
+    }
+  }
+
+ protected:
+  explicit LocalMetaService(vs_ptr_t& server_ptr);
+
+  void requestLock(
+      std::string lock_name,
+      callback_t<std::shared_ptr<ILock>> callback_after_locked) override;
+
+  void requestAll(
+      const std::string& prefix, unsigned base_rev,
+      callback_t<const std::vector<kv_t>&, unsigned> callback) override;
+
+  void requestUpdates(
+      const std::string& prefix, unsigned since_rev,
+      callback_t<const std::vector<op_t>&, unsigned> callback) override;
+
+  void requestObjects(
+      const std::vector<ObjectID>& ids,
+      callback_t<const std::vector<kv_t>&, unsigned> callback) override;
+
+  void commitUpdates(const std::vector<op_t>&,
+                     callback_t<unsigned> callback_after_updated) override;
+
+  void commitUpdatesIfUnchanged(
+      const std::vector<op_t>& changes, unsigned const since_rev,
+      callback_t<const bool, unsigned> callback_after_updated) override;
+
+  void startDaemonWatch(
+      const std::string& prefix, unsigned since_rev,
+      callback_t<const std::vector<op_t>&, unsigned> callback) override;
+
+  Status probe() override { return wal_status_; }
+
+  const ptree local_spec_;
+
+ private:
+  /**
+   * Bump the revision and append the changes to the write-ahead log.
+   */
+  Status commit(const std::vector<op_t>& changes, unsigned& rev);
+
+  void grantLock(std::string const& lock_name,
+                 callback_t<std::shared_ptr<ILock>> callback_after_locked);
+
+  void releaseLock(std::string const& lock_name);
+
+  /**
+   * Replay the write-ahead log, and rewrite it to a compacted snapshot.
+   */
+  Status recoverFromWAL();
+
+  Status appendToWAL(const std::vector<op_t>& changes, unsigned const rev);
+
+  const std::string wal_path_;
+  const bool wal_sync_;
+  int wal_fd_ = -1;
+  Status wal_status_;
+
+  unsigned revision_ = 0;
+  // the metadata replayed from the write-ahead log, consumed by the initial
+  // `requestAll`.
+  std::map<std::string, std::string> recovered_;
+  bool recovered_consumed_ = false;
+
+  // the keys that changed in the revisions the meta tree may not have
+  // observed yet, to validate the conditional commits.
+  std::deque<std::pair<unsigned, std::set<std::string>>> recent_changes_;
+
+  // the held locks, and the waiters of each lock
+  std::set<std::string> locked_;
+  std::map<std::string, std::deque<callback_t<std::shared_ptr<ILock>>>>
+      lock_waiters_;
+
+  callback_t<const std::vector<op_t>&, unsigned> daemon_callback_;
+
+  friend class IMetaService;
+};
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_SERVICES_LOCAL_META_SERVICE_H_
@@ -20,10 +20,19 @@ limitations under the License.
 #include "glog/logging.h"
 
 #include "server/services/etcd_meta_service.h"
+#include "server/services/local_meta_service.h"
 #include "server/util/meta_tree.h"
 
 namespace vineyard {
 std::shared_ptr<IMetaService> IMetaService::Get(vs_ptr_t ptr) {
+  std::string meta = ptr->GetSpec().get<std::string>("metastore_spec.meta");
+  if (meta == "local") {
+    if (ptr->GetDeployment() == "distributed") {
+      LOG(WARNING) << "The local metastore cannot be shared between vineyardd "
+                      "instances, use etcd for distributed deployments";
+    }
+    return std::shared_ptr<IMetaService>(new LocalMetaService(ptr));
+  }
   return std::shared_ptr<IMetaService>(new EtcdMetaService(ptr));
 }
 
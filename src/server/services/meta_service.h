@@ -18,10 +18,15 @@ limitations under the License.
 
 #include <sys/param.h>
 
+#include <algorithm>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -32,10 +37,18 @@ limitations under the License.
 #include "common/util/functions.h"
 #include "common/util/logging.h"
 #include "common/util/status.h"
+#include "common/util/trace.h"
 #include "server/server/vineyard_server.h"
+#include "server/util/compact_meta_tree.h"
+#include "server/util/compact_value.h"
+#include "server/util/meta_index.h"
+#include "server/util/slow_requests.h"
 
 #define HEARTBEAT_TIME 20
 #define MAX_TIMEOUT_COUNT 3
+#define MAX_OPTIMISTIC_ATTEMPTS 8
+// the marker key of the updates that are committed in chunks
+#define CHUNKED_COMMIT_PREFIX "chunked_commits."
 
 namespace vineyard {
 
@@ -70,13 +83,15 @@ class IMetaService {
   };
 
   struct op_t {
-    enum op_type_t : unsigned { kPut = 0, kDel = 1 } op;
+    // kDelPrefix deletes the subtree at the key, i.e., every key under
+    // "<key>.", with a single range deletion.
+    enum op_type_t : unsigned { kPut = 0, kDel = 1, kDelPrefix = 2 } op;
     kv_t kv;
     std::string ToString() const {
       std::stringstream ss;
       ss.str("");
       ss.clear();
-      ss << ((op == kPut) ? "put " : "del ");
+      ss << ((op == kPut) ? "put " : (op == kDel ? "del " : "delprefix "));
       ss << "[" << kv.rev << "] " << kv.key << " -> " << kv.value;
       return ss.str();
     }
@@ -89,6 +104,10 @@ class IMetaService {
       return op_t{.op = op_type_t::kDel,
                   .kv = kv_t{.key = key, .value = "", .rev = rev}};
     }
+    static op_t DelPrefix(std::string const& key) {
+      return op_t{.op = op_type_t::kDelPrefix,
+                  .kv = kv_t{.key = key, .value = "", .rev = 0}};
+    }
     template <typename T>
     static op_t Put(std::string const& key, T const& value) {
       return op_t{
@@ -107,10 +126,10 @@ class IMetaService {
   };
 
   struct watcher_t {
-    watcher_t(callback_t<const ptree&, const std::string&> w,
+    watcher_t(callback_t<const CompactMetaTree&, const std::string&> w,
               const std::string& t)
         : watcher(w), tag(t) {}
-    callback_t<const ptree&, const std::string&> watcher;
+    callback_t<const CompactMetaTree&, const std::string&> watcher;
     std::string tag;
   };
   virtual ~IMetaService() {}
@@ -124,7 +143,8 @@ class IMetaService {
     RETURN_ON_ERROR(this->probe());
     rev_ = 0;
     requestValues(
-        "", [this](const Status& status, const ptree& meta, unsigned rev) {
+        "", [this](const Status& status, const CompactMetaTree& meta,
+                   unsigned rev) {
           if (status.ok()) {
             this->registerToEtcd();
           } else {
@@ -143,11 +163,11 @@ class IMetaService {
 
  public:
   inline void RequestToBulkUpdate(
-      callback_t<const ptree&, std::vector<op_t>&, InstanceID&>
+      callback_t<const CompactMetaTree&, std::vector<op_t>&, InstanceID&>
           callback_after_ready,
       callback_t<const InstanceID> callback_after_finish) {
-    boost::asio::post(server_ptr_->GetIOContext(), [this, callback_after_ready,
-                                                    callback_after_finish]() {
+    boost::asio::post(server_ptr_->GetMetaStrand(), [this, callback_after_ready,
+                                                     callback_after_finish]() {
       std::vector<op_t> ops;
       InstanceID computed_instance_id;
       auto status =
@@ -167,27 +187,323 @@ class IMetaService {
     });
   }
 
+  /**
+   * Persist the changes that are generated from the local metadata.
+   *
+   * The changes are committed optimistically: the transaction succeeds only
+   * if none of the changed keys has been modified since the revision of the
+   * local metadata, otherwise the local metadata catches up with the backend
+   * and the changes are re-generated. Thus persisting of unrelated keys from
+   * different instances proceeds in parallel, and the meta_sync_lock_ is only
+   * used when the optimistic commits keep conflicting.
+   */
   inline void RequestToPersist(
-      callback_t<const ptree&, std::vector<op_t>&> callback_after_ready,
+      callback_t<const CompactMetaTree&, std::vector<op_t>&>
+          callback_after_ready,
       callback_t<> callback_after_finish) {
-    // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
-    // avoid contention between other vineyard instances.
+    if (deferToMetaStrand(
+            [this, callback_after_ready, callback_after_finish]() {
+              RequestToPersist(callback_after_ready, callback_after_finish);
+            })) {
+      return;
+    }
+    if (writeBehindPending()) {
+      // the changes may refer to the objects that are persisted locally but
+      // haven't been committed yet, keep the order in the backend.
+      RequestToFlush([this, callback_after_ready,
+                      callback_after_finish](const Status& status) {
+        persistOptimistically(callback_after_ready, callback_after_finish, 0);
+        return Status::OK();
+      });
+      return;
+    }
+    persistOptimistically(callback_after_ready, callback_after_finish, 0);
+  }
+
+  /**
+   * Persist the changes in write-behind mode: the changes are applied to the
+   * local metadata at once, and `callback_after_applied` is invoked without
+   * waiting for the backend. The changes are committed by the background
+   * committer later, and the changes that are issued while a commit is in
+   * flight are committed in the next batch.
+   *
+   * The changes that are not committed yet are lost if the vineyardd exits,
+   * use `RequestToFlush` as a barrier.
+   */
+  inline void RequestToPersistWriteBehind(
+      callback_t<const CompactMetaTree&, std::vector<op_t>&>
+          callback_after_ready,
+      callback_t<> callback_after_applied) {
+    if (deferToMetaStrand([this, callback_after_ready,
+                           callback_after_applied]() {
+          RequestToPersistWriteBehind(callback_after_ready,
+                                      callback_after_applied);
+        })) {
+      return;
+    }
+    std::vector<op_t> ops;
+    auto s = callback_after_ready(Status::OK(), meta_, ops);
+    if (s.ok() && !ops.empty()) {
+      this->metaUpdate(ops);
+      enqueueWriteBehind(std::move(ops));
+      write_behind_seq_ += 1;
+      scheduleWriteBehind();
+    }
+    VINEYARD_SUPPRESS(callback_after_applied(s));
+  }
+
+  /**
+   * Wait until the write-behind changes that are issued before have been
+   * committed to the backend. The error of the failed commit is propagated
+   * to the callback, and the failed changes are retried by the next flush.
+   */
+  inline void RequestToFlush(callback_t<> callback) {
+    if (deferToMetaStrand(
+            [this, callback]() { RequestToFlush(callback); })) {
+      return;
+    }
+    if (!writeBehindPending()) {
+      VINEYARD_SUPPRESS(callback(Status::OK()));
+      return;
+    }
+    flush_waiters_.emplace(write_behind_seq_, callback);
+    scheduleWriteBehind();
+  }
+
+  /**
+   * Whether the changes of the object are waiting for the write-behind
+   * committer, must be called inside the meta strand.
+   */
+  inline bool IsWriteBehindPending(const ObjectID id) const {
+    return write_behind_objects_.find(id) != write_behind_objects_.end() ||
+           write_behind_committing_.find(id) != write_behind_committing_.end();
+  }
+
+  /**
+   * Whether persisted objects are put as one compact value per object, see
+   * also `EncodeCompactValue`.
+   */
+  inline bool CompactValues() const { return compact_values_; }
+
+  /**
+   * The number of nodes in the local metadata and its (estimated) memory
+   * footprint in bytes, must be called inside the meta strand.
+   */
+  inline size_t MetaNodes() const { return meta_.Nodes(); }
+
+  inline size_t MetaMemoryUsage() const { return meta_.MemoryUsage(); }
+
+  inline void RequestToGetData(const bool sync_remote,
+                               callback_t<const CompactMetaTree&> callback) {
+    if (deferToMetaStrand([this, sync_remote, callback]() {
+          RequestToGetData(sync_remote, callback);
+        })) {
+      return;
+    }
+    if (sync_remote) {
+      requestValues(
+          "", [callback](const Status& status, const CompactMetaTree& meta,
+                         unsigned rev) { return callback(status, meta); });
+    } else {
+      // post the task to asio queue as well for well-defined processing order.
+      boost::asio::post(server_ptr_->GetMetaStrand(), [this, callback]() {
+        VINEYARD_SUPPRESS(callback(Status::OK(), meta_));
+      });
+    }
+  }
+
+  /**
+   * Get the metadata for the given objects, optimistically from the local
+   * metadata: with `sync_remote`, only the objects (and their members) that
+   * are missing locally are read from the backend, by a targeted read of
+   * each of them rather than catching up with all changes.
+   *
+   * The other changes are left to the daemon watch, thus the local copies of
+   * the objects that are present may lag behind the backend slightly.
+   */
+  inline void RequestToGetData(const std::vector<ObjectID>& ids,
+                               const bool sync_remote,
+                               callback_t<const CompactMetaTree&> callback) {
+    if (deferToMetaStrand([this, ids, sync_remote, callback]() {
+          RequestToGetData(ids, sync_remote, callback);
+        })) {
+      return;
+    }
+    if (!sync_remote || rev_ == 0) {
+      // nothing has been loaded from the backend yet
+      RequestToGetData(sync_remote, callback);
+      return;
+    }
+    std::vector<ObjectID> missing;
+    for (auto const& id : ids) {
+      if (!hasObject(id)) {
+        missing.emplace_back(id);
+      }
+    }
+    if (missing.empty()) {
+      boost::asio::post(server_ptr_->GetMetaStrand(), [this, callback]() {
+        VINEYARD_SUPPRESS(callback(Status::OK(), meta_));
+      });
+      return;
+    }
+    requestMissingObjects(missing, callback);
+  }
+
+  /**
+   * Query the local metadata together with the secondary indexes of it, the
+   * callback is invoked inside the meta strand.
+   */
+  inline void RequestToGetIndexedData(
+      callback_t<const CompactMetaTree&, const MetaIndex&> callback) {
+    boost::asio::post(server_ptr_->GetMetaStrand(), [this, callback]() {
+      VINEYARD_SUPPRESS(callback(Status::OK(), meta_, index_));
+    });
+  }
+
+  inline void RequestToDelete(
+      const std::vector<ObjectID>& ids, const bool force, const bool deep,
+      callback_t<const CompactMetaTree&, std::set<ObjectID> const&,
+                 std::vector<op_t>&>
+          callback_after_ready,
+      callback_t<> callback_after_finish) {
+    if (deferToMetaStrand([this, ids, force, deep, callback_after_ready,
+                           callback_after_finish]() {
+          RequestToDelete(ids, force, deep, callback_after_ready,
+                          callback_after_finish);
+        })) {
+      return;
+    }
+    if (writeBehindPending()) {
+      // the objects may be persisted in write-behind mode, delete them from
+      // the backend after they are committed.
+      RequestToFlush([this, ids, force, deep, callback_after_ready,
+                      callback_after_finish](const Status& status) {
+        deleteWithLock(ids, force, deep, callback_after_ready,
+                       callback_after_finish);
+        return Status::OK();
+      });
+      return;
+    }
+    deleteWithLock(ids, force, deep, callback_after_ready,
+                   callback_after_finish);
+  }
+
+  inline void RequestToShallowCopy(
+      callback_t<const CompactMetaTree&, std::vector<op_t>&, bool&>
+          callback_after_ready,
+      callback_t<> callback_after_finish) {
+    if (deferToMetaStrand(
+            [this, callback_after_ready, callback_after_finish]() {
+              RequestToShallowCopy(callback_after_ready, callback_after_finish);
+            })) {
+      return;
+    }
+    requestValues("", [this, callback_after_ready, callback_after_finish](
+                          const Status& status, const CompactMetaTree& meta,
+                          unsigned rev) {
+      if (status.ok()) {
+        std::vector<op_t> ops;
+        bool transient = true;
+        auto status = callback_after_ready(Status::OK(), meta, ops, transient);
+        if (status.ok()) {
+          if (transient) {
+            this->metaUpdate(ops);
+            return callback_after_finish(Status::OK());
+          } else {
+            this->RequestToPersist(
+                [ops](const Status& status, const CompactMetaTree& meta,
+                      std::vector<IMetaService::op_t>& persist_ops) {
+                  persist_ops.insert(persist_ops.end(), ops.begin(), ops.end());
+                  return Status::OK();
+                },
+                callback_after_finish);
+            return Status::OK();
+          }
+        } else {
+          LOG(ERROR) << status.ToString();
+          return callback_after_finish(status);
+        }
+      } else {
+        LOG(ERROR) << "request values failed: " << status.ToString();
+        return callback_after_finish(status);
+      }
+    });
+  }
+
+ private:
+  void persistOptimistically(
+      callback_t<const CompactMetaTree&, std::vector<op_t>&>
+          callback_after_ready,
+      callback_t<> callback_after_finish, size_t const attempt) {
+    std::vector<op_t> ops;
+    auto s = callback_after_ready(Status::OK(), meta_, ops);
+    if (!s.ok() || ops.empty()) {
+      VINEYARD_SUPPRESS(callback_after_finish(s));
+      return;
+    }
+    if (max_txn_ops_ != 0 && ops.size() > max_txn_ops_) {
+      // cannot be committed in one conditional transaction
+      persistWithLock(callback_after_ready, callback_after_finish);
+      return;
+    }
+    this->commitUpdatesIfUnchanged(
+        ops, rev_,
+        [this, ops, callback_after_ready, callback_after_finish, attempt](
+            const Status& status, const bool committed, unsigned rev) {
+          if (!status.ok()) {
+            LOG(ERROR) << status.ToString();
+            return callback_after_finish(status);
+          }
+          if (committed) {
+            // apply the changes locally once they have been committed.
+            this->metaUpdate(ops);
+            this->recordLocalRevision(rev);
+            return callback_after_finish(Status::OK());
+          }
+          if (attempt + 1 >= MAX_OPTIMISTIC_ATTEMPTS) {
+            VLOG(10) << "Too many conflicts, persist with the meta lock";
+            persistWithLock(callback_after_ready, callback_after_finish);
+            return Status::OK();
+          }
+          // catch up with the conflicting changes, then retry
+          requestValues(
+              "", rev,
+              [this, callback_after_ready, callback_after_finish, attempt](
+                  const Status& status, const CompactMetaTree& meta,
+                  unsigned rev) {
+                if (!status.ok()) {
+                  return callback_after_finish(status);
+                }
+                persistOptimistically(callback_after_ready,
+                                      callback_after_finish, attempt + 1);
+                return Status::OK();
+              });
+          return Status::OK();
+        });
+  }
+
+  void persistWithLock(
+      callback_t<const CompactMetaTree&, std::vector<op_t>&>
+          callback_after_ready,
+      callback_t<> callback_after_finish) {
+    // NB: when the optimistic commits keep conflicting, we needs the
+    // meta_sync_lock_ to avoid contention between other vineyard instances.
     this->requestLock(
         meta_sync_lock_,
         [this, callback_after_ready, callback_after_finish](
             const Status& status, std::shared_ptr<ILock> lock) {
           if (status.ok()) {
             requestValues(
-                "", [this, callback_after_ready, callback_after_finish, lock](
-                        const Status& status, const ptree& meta, unsigned rev) {
+                "", lock->GetRev(),
+                [this, callback_after_ready, callback_after_finish, lock](
+                        const Status& status, const CompactMetaTree& meta,
+                        unsigned rev) {
                   std::vector<op_t> ops;
                   auto s = callback_after_ready(status, meta, ops);
                   if (s.ok()) {
                     if (ops.empty()) {
                       unsigned rev_after_unlock = 0;
-                      if (lock->Release(rev_after_unlock).ok()) {
-                        rev_ = rev_after_unlock;
-                      }
+                      VINEYARD_SUPPRESS(lock->Release(rev_after_unlock));
                       return callback_after_finish(Status::OK());
                     }
                     // apply changes locally before committing to etcd
@@ -196,19 +512,17 @@ class IMetaService {
                     this->commitUpdates(
                         ops, [this, callback_after_finish, lock](
                                  const Status& status, unsigned rev) {
-                          // update rev_ to the revision after unlock.
-                          unsigned rev_after_unlock = 0;
-                          if (lock->Release(rev_after_unlock).ok()) {
-                            rev_ = rev_after_unlock;
+                          if (status.ok()) {
+                            this->recordLocalRevision(rev);
                           }
+                          unsigned rev_after_unlock = 0;
+                          VINEYARD_SUPPRESS(lock->Release(rev_after_unlock));
                           return callback_after_finish(status);
                         });
                     return Status::OK();
                   } else {
                     unsigned rev_after_unlock = 0;
-                    if (lock->Release(rev_after_unlock).ok()) {
-                      rev_ = rev_after_unlock;
-                    }
+                    VINEYARD_SUPPRESS(lock->Release(rev_after_unlock));
                     return callback_after_finish(s);  // propogate the error
                   }
                 });
@@ -220,22 +534,10 @@ class IMetaService {
         });
   }
 
-  inline void RequestToGetData(const bool sync_remote,
-                               callback_t<const ptree&> callback) {
-    if (sync_remote) {
-      requestValues(
-          "", [callback](const Status& status, const ptree& meta,
-                         unsigned rev) { return callback(status, meta); });
-    } else {
-      // post the task to asio queue as well for well-defined processing order.
-      boost::asio::post(server_ptr_->GetIOContext(),
-                        boost::bind(callback, Status::OK(), meta_));
-    }
-  }
-
-  inline void RequestToDelete(
+  void deleteWithLock(
       const std::vector<ObjectID>& ids, const bool force, const bool deep,
-      callback_t<const ptree&, std::set<ObjectID> const&, std::vector<op_t>&>
+      callback_t<const CompactMetaTree&, std::set<ObjectID> const&,
+                 std::vector<op_t>&>
           callback_after_ready,
       callback_t<> callback_after_finish) {
     // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
@@ -245,11 +547,12 @@ class IMetaService {
         [this, ids, force, deep, callback_after_ready, callback_after_finish](
             const Status& status, std::shared_ptr<ILock> lock) {
           if (status.ok()) {
-            rev_ = lock->GetRev();
             requestValues(
-                "", [this, ids, force, deep, callback_after_ready,
-                     callback_after_finish, lock](
-                        const Status& status, const ptree& meta, unsigned rev) {
+                "", lock->GetRev(),
+                [this, ids, force, deep, callback_after_ready,
+                 callback_after_finish, lock](
+                        const Status& status, const CompactMetaTree& meta,
+                        unsigned rev) {
                   // Implements dependent-based (usage-based) lifecycle.
                   std::set<ObjectID> initial_delete_set{ids.begin(), ids.end()};
                   std::set<ObjectID> delete_set;
@@ -266,19 +569,17 @@ class IMetaService {
                     this->commitUpdates(
                         ops, [this, callback_after_finish, lock](
                                  const Status& status, unsigned rev) {
-                          // update rev_ to the revision after unlock.
-                          unsigned rev_after_unlock = 0;
-                          if (lock->Release(rev_after_unlock).ok()) {
-                            rev_ = rev_after_unlock;
+                          if (status.ok()) {
+                            this->recordLocalRevision(rev);
                           }
+                          unsigned rev_after_unlock = 0;
+                          VINEYARD_SUPPRESS(lock->Release(rev_after_unlock));
                           return callback_after_finish(status);
                         });
                     return Status::OK();
                   } else {
                     unsigned rev_after_unlock = 0;
-                    if (lock->Release(rev_after_unlock).ok()) {
-                      rev_ = rev_after_unlock;
-                    }
+                    VINEYARD_SUPPRESS(lock->Release(rev_after_unlock));
                     return callback_after_finish(s);  // propogate the error.
                   }
                 });
@@ -290,45 +591,127 @@ class IMetaService {
         });
   }
 
-  inline void RequestToShallowCopy(
-      callback_t<const ptree&, std::vector<op_t>&, bool&> callback_after_ready,
-      callback_t<> callback_after_finish) {
-    requestValues("", [this, callback_after_ready, callback_after_finish](
-                          const Status& status, const ptree& meta,
-                          unsigned rev) {
+  inline bool writeBehindPending() const {
+    return write_behind_committed_ != write_behind_seq_;
+  }
+
+  /**
+   * Merge the changes into the write-behind queue, a key is changed at most
+   * once in a transaction thus the latter change wins.
+   */
+  void enqueueWriteBehind(std::vector<op_t>&& ops) {
+    for (auto& op : ops) {
+      if (boost::algorithm::starts_with(op.kv.key, "data.")) {
+        size_t end = op.kv.key.find('.', sizeof("data.") - 1);
+        write_behind_objects_.emplace(VYObjectIDFromString(op.kv.key.substr(
+            sizeof("data.") - 1, end - (sizeof("data.") - 1))));
+      }
+      auto loc = write_behind_keys_.find(op.kv.key);
+      if (loc == write_behind_keys_.end()) {
+        write_behind_keys_.emplace(op.kv.key, write_behind_ops_.size());
+        write_behind_ops_.emplace_back(std::move(op));
+      } else {
+        write_behind_ops_[loc->second] = std::move(op);
+      }
+    }
+  }
+
+  void scheduleWriteBehind() {
+    if (write_behind_inflight_ || write_behind_ops_.empty()) {
+      return;
+    }
+    write_behind_inflight_ = true;
+    boost::asio::post(server_ptr_->GetMetaStrand(),
+                      [this]() { commitWriteBehind(); });
+  }
+
+  void commitWriteBehind() {
+    std::vector<op_t> ops;
+    ops.swap(write_behind_ops_);
+    write_behind_keys_.clear();
+    write_behind_committing_.swap(write_behind_objects_);
+    uint64_t const seq = write_behind_seq_;
+    this->commitUpdates(ops, [this, ops, seq](const Status& status,
+                                              unsigned rev) mutable {
+      write_behind_inflight_ = false;
       if (status.ok()) {
-        std::vector<op_t> ops;
-        bool transient = true;
-        auto status = callback_after_ready(Status::OK(), meta, ops, transient);
-        if (status.ok()) {
-          if (transient) {
-            this->metaUpdate(ops);
-            return callback_after_finish(Status::OK());
-          } else {
-            this->RequestToPersist(
-                [ops](const Status& status, const ptree& meta,
-                      std::vector<IMetaService::op_t>& persist_ops) {
-                  persist_ops.insert(persist_ops.end(), ops.begin(), ops.end());
-                  return Status::OK();
-                },
-                callback_after_finish);
-            return Status::OK();
-          }
-        } else {
-          LOG(ERROR) << status.ToString();
-          return callback_after_finish(status);
-        }
+        // the changes have been applied locally
+        this->recordLocalRevision(rev);
+        write_behind_committed_ = seq;
+        write_behind_committing_.clear();
       } else {
-        LOG(ERROR) << "request values failed: " << status.ToString();
-        return callback_after_finish(status);
+        LOG(ERROR) << "Failed to commit the write-behind changes: "
+                   << status.ToString();
+        // put the changes back before the newer changes, to retry them when
+        // flushing.
+        std::vector<op_t> newer;
+        newer.swap(write_behind_ops_);
+        write_behind_keys_.clear();
+        write_behind_objects_.insert(write_behind_committing_.begin(),
+                                     write_behind_committing_.end());
+        write_behind_committing_.clear();
+        enqueueWriteBehind(std::move(ops));
+        enqueueWriteBehind(std::move(newer));
+      }
+      auto waiters_end = flush_waiters_.upper_bound(seq);
+      for (auto iter = flush_waiters_.begin(); iter != waiters_end; ++iter) {
+        VINEYARD_SUPPRESS(iter->second(status));
       }
+      flush_waiters_.erase(flush_waiters_.begin(), waiters_end);
+      if (status.ok()) {
+        scheduleWriteBehind();
+      }
+      return Status::OK();
     });
   }
 
- private:
+  /**
+   * The meta tree is only accessed inside the meta strand, requests that
+   * come from other threads are re-posted to it. Returns true if the function
+   * has been posted.
+   */
+  template <typename F>
+  bool deferToMetaStrand(F&& fn) {
+    auto& strand = server_ptr_->GetMetaStrand();
+    if (strand.running_in_this_thread()) {
+      return false;
+    }
+    trace::Context context = trace::Current();
+    auto const& stats = RequestStats::Current();
+    if (!context.sampled() && !stats) {
+      boost::asio::post(strand, std::forward<F>(fn));
+      return true;
+    }
+    // the time spent in the queue of the meta strand is accounted to the
+    // request, and the deferred function runs within the trace of it.
+    std::shared_ptr<trace::Span> wait;
+    if (context.sampled()) {
+      wait = std::make_shared<trace::Span>("meta strand wait", context);
+    }
+    auto posted = std::chrono::steady_clock::now();
+    typename std::decay<F>::type task(std::forward<F>(fn));
+    boost::asio::post(strand, [context, wait, stats, posted, task]() {
+      if (wait) {
+        wait->Finish();
+      }
+      if (stats) {
+        stats->queue_us.fetch_add(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - posted)
+                .count(),
+            std::memory_order_relaxed);
+      }
+      trace::Scope scope(context);
+      RequestStats::Scope stats_scope(stats);
+      task();
+    });
+    return true;
+  }
+
   inline void registerToEtcd() {
     RequestToPersist(
-        [&](const Status& status, const ptree& tree, std::vector<op_t>& ops) {
+        [&](const Status& status, const CompactMetaTree& tree,
+            std::vector<op_t>& ops) {
           if (status.ok()) {
             char hostname_value[MAXHOSTNAMELEN];
             gethostname(&hostname_value[0], MAXHOSTNAMELEN);
@@ -336,18 +719,19 @@ class IMetaService {
             int64_t timestamp = GetTimestamp();
 
             instances_list_.clear();
-            auto instances = tree.get_child_optional("instances");
+            auto instances = tree.Child(CompactMetaTree::kRoot, "instances");
             uint64_t self_host_id = static_cast<uint64_t>(gethostid()) |
                                     static_cast<uint64_t>(__rdtsc());
-            if (instances) {
-              for (auto& instance : instances.get()) {
-                auto id = static_cast<InstanceID>(std::stoul(instance.first));
+            if (instances != CompactMetaTree::kNotFound) {
+              for (auto instance : tree.ChildrenOf(instances)) {
+                auto id = static_cast<InstanceID>(
+                    std::stoul(tree.Key(instance)));
                 instances_list_.emplace(id);
               }
             }
             InstanceID rank = 0;
-            auto next_instance_id =
-                tree.get_optional<InstanceID>("next_instance_id");
+            auto next_instance_id = tree.GetOptional<InstanceID>(
+                CompactMetaTree::kRoot, "next_instance_id");
             if (next_instance_id) {
               rank = next_instance_id.get();
             }
@@ -358,6 +742,20 @@ class IMetaService {
                 "instances." + std::to_string(rank) + ".hostname", hostname));
             ops.emplace_back(op_t::Put(
                 "instances." + std::to_string(rank) + ".timestamp", timestamp));
+            // the topology and the memory for placing data, see also
+            // `checkInstanceStatus()`
+            ops.emplace_back(op_t::Put(
+                "instances." + std::to_string(rank) + ".zone",
+                server_ptr_->GetSpec().get<std::string>("zone", "")));
+            ops.emplace_back(
+                op_t::Put("instances." + std::to_string(rank) + ".numa_nodes",
+                          std::to_string(GetNumaNodeCount())));
+            putMemoryStatus(rank, ops);
+            // the peers fetch the blobs of this instance from its RPC server
+            ops.emplace_back(op_t::Put(
+                "instances." + std::to_string(rank) + ".rpc_endpoint",
+                hostname + ":" +
+                    server_ptr_->GetSpec().get<std::string>("rpc_spec.port")));
             ops.emplace_back(
                 op_t::Put("next_instance_id", std::to_string(rank + 1)));
             this->server_ptr_->set_instance_id(rank);
@@ -397,12 +795,14 @@ class IMetaService {
    */
   void checkInstanceStatus() {
     RequestToPersist(
-        [&](const Status& status, const ptree& tree, std::vector<op_t>& ops) {
+        [&](const Status& status, const CompactMetaTree& tree,
+            std::vector<op_t>& ops) {
           if (status.ok()) {
             ops.emplace_back(op_t::Put(
                 "instances." + std::to_string(server_ptr_->instance_id()) +
                     ".timestamp",
                 std::to_string(GetTimestamp())));
+            putMemoryStatus(server_ptr_->instance_id(), ops);
             return status;
           } else {
             LOG(ERROR) << status.ToString();
@@ -425,14 +825,13 @@ class IMetaService {
           }
           VLOG(10) << "Instance size " << instances_list_.size()
                    << ", target instance is " << target_inst;
-          auto mb_target = meta_.get_child("instances")
-                               .get_child_optional(std::to_string(target_inst));
+          auto target =
+              meta_.Find("instances." + std::to_string(target_inst));
           // The subtree might be empty, when the etcd been resumed with another
           // data directory but the same endpoint. that leads to a crash here
           // but we just let it crash to help us diagnosis the error.
-          if (mb_target /* && !mb_target.get().empty() */) {
-            auto target = mb_target.get();
-            int64_t ts = target.get<int64_t>("timestamp");
+          if (target != CompactMetaTree::kNotFound) {
+            int64_t ts = meta_.GetOptional<int64_t>(target, "timestamp").get();
             if (ts == target_latest_time_) {
               ++timeout_count_;
             } else {
@@ -444,7 +843,8 @@ class IMetaService {
               timeout_count_ = 0;
               target_latest_time_ = 0;
               RequestToPersist(
-                  [&, target_inst](const Status& status, const ptree& tree,
+                  [&, target_inst](const Status& status,
+                                   const CompactMetaTree& tree,
                                    std::vector<op_t>& ops) {
                     if (status.ok()) {
                       std::string key =
@@ -452,32 +852,48 @@ class IMetaService {
                       ops.emplace_back(op_t::Del(key + ".hostid"));
                       ops.emplace_back(op_t::Del(key + ".timestamp"));
                       ops.emplace_back(op_t::Del(key + ".hostname"));
+                      ops.emplace_back(op_t::Del(key + ".rpc_endpoint"));
                     } else {
                       LOG(ERROR) << status.ToString();
                     }
                     return status;
                   },
                   [&](const Status& status) { return status; });
-              VINEYARD_SUPPRESS(server_ptr_->DeleteAllAt(meta_, target_inst));
+              VINEYARD_SUPPRESS(server_ptr_->DeleteAllAt(index_, target_inst));
             }
           }
           return status;
         });
   }
 
+  // the memory usage is refreshed along with the heartbeat
+  void putMemoryStatus(InstanceID const instance_id, std::vector<op_t>& ops) {
+    auto bulk_store = server_ptr_->GetBulkStore();
+    if (bulk_store == nullptr) {
+      return;
+    }
+    std::string prefix = "instances." + std::to_string(instance_id);
+    ops.emplace_back(op_t::Put(prefix + ".memory_usage",
+                               std::to_string(bulk_store->Footprint())));
+    ops.emplace_back(op_t::Put(prefix + ".memory_limit",
+                               std::to_string(bulk_store->FootprintLimit())));
+  }
+
   void startHeartbeat() {
     heartbeat_timer_.reset(new asio::steady_timer(
         server_ptr_->GetIOContext(), asio::chrono::seconds(HEARTBEAT_TIME)));
-    heartbeat_timer_->async_wait([&](const boost::system::error_code& error) {
-      if (error) {
-        LOG(ERROR) << "heartbeat timer error: " << error << ", "
-                   << error.message();
-      }
-      // run check
-      checkInstanceStatus();
-      // run the next round
-      startHeartbeat();
-    });
+    heartbeat_timer_->async_wait(asio::bind_executor(
+        server_ptr_->GetMetaStrand(),
+        [&](const boost::system::error_code& error) {
+          if (error) {
+            LOG(ERROR) << "heartbeat timer error: " << error << ", "
+                       << error.message();
+          }
+          // run check
+          checkInstanceStatus();
+          // run the next round
+          startHeartbeat();
+        }));
   }
 
  protected:
@@ -489,8 +905,68 @@ class IMetaService {
   virtual void commitUpdates(const std::vector<op_t>&,
                              callback_t<unsigned> callback_after_updated) = 0;
 
+  /**
+   * Commit the changes only if none of the changed keys has been modified
+   * after `since_rev`, the callback receives whether the changes have been
+   * committed, and the revision of the backend.
+   */
+  virtual void commitUpdatesIfUnchanged(
+      const std::vector<op_t>& changes, unsigned const since_rev,
+      callback_t<const bool, unsigned> callback_after_updated) = 0;
+
+  /**
+   * The changes of the revision have been applied locally, thus they will be
+   * skipped when coming back from the watch.
+   */
+  void recordLocalRevision(unsigned const rev) {
+    if (rev > rev_) {
+      local_revisions_.emplace(rev);
+    }
+  }
+
   void requestValues(const std::string& prefix,
-                     callback_t<const ptree&, unsigned> callback) {
+                     callback_t<const CompactMetaTree&, unsigned> callback) {
+    requestValues(prefix, 0, callback);
+  }
+
+  /**
+   * Make the local metadata up-to-date with (at least) the given revision of
+   * the backend, where 0 means the latest revision.
+   *
+   * The daemon watch keeps applying the deltas to the local metadata, thus
+   * when the revision has been reached, or will be reached by the daemon
+   * watch, no extra round-trip to the backend is required.
+   */
+  void requestValues(const std::string& prefix, unsigned const target_rev,
+                     callback_t<const CompactMetaTree&, unsigned> request) {
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<trace::Span> span;
+    if (trace::Current().sampled()) {
+      span = std::make_shared<trace::Span>("requestValues", trace::Current());
+      // how the local metadata is brought up-to-date
+      if (rev_ == 0) {
+        span->Tag("source", "all");
+      } else if (target_rev != 0 && rev_ >= target_rev) {
+        span->Tag("source", "local");
+      } else if (target_rev != 0 && daemon_watching_) {
+        span->Tag("source", "watch");
+      } else {
+        span->Tag("source", "updates");
+      }
+    }
+    callback_t<const CompactMetaTree&, unsigned> callback =
+        [this, start, span, request](const Status& status,
+                                     const CompactMetaTree& meta,
+                                     unsigned rev) {
+          server_ptr_->GetMetrics().RecordMetaRequest(
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count());
+          if (span) {
+            span->Finish();
+          }
+          return request(status, meta, rev);
+        };
     // We still need to run a `etcdctl get` for the first time. With a
     // long-running and no compact Etcd, watching from revision 0 may
     // lead to a super huge amount of events, which is unacceptable.
@@ -503,7 +979,8 @@ class IMetaService {
                      // call metaUpdate to make sure the instance list correct.
                      std::vector<op_t> ops;
                      for (auto const& kv : kvs) {
-                       if (boost::algorithm::trim_copy(kv.key).empty()) {
+                       if (boost::algorithm::trim_copy(kv.key).empty() ||
+                           isChunkedCommitMarker(kv.key)) {
                          // skip unprintable keys
                          continue;
                        }
@@ -514,20 +991,177 @@ class IMetaService {
                    }
                    return callback(status, meta_, rev_);
                  });
+    } else if (target_rev != 0 && rev_ >= target_rev) {
+      VINEYARD_SUPPRESS(callback(Status::OK(), meta_, rev_));
+    } else if (target_rev != 0 && daemon_watching_) {
+      pending_requests_.emplace(target_rev, callback);
     } else {
       requestUpdates(
           prefix, rev_,
-          [this, callback](const Status& status, const std::vector<op_t>& ops,
-                           unsigned rev) {
+          [this, prefix, callback](const Status& status,
+                                   const std::vector<op_t>& ops, unsigned rev) {
+            if (isCompacted(status)) {
+              LOG(WARNING) << "The revision " << rev_ << " has been compacted, "
+                           << "resync all metadata";
+              requestResync(prefix, callback);
+              return Status::OK();
+            }
             if (status.ok()) {
-              this->metaUpdate(ops);
-              rev_ = rev;
+              this->applyRevisions(ops);
+              rev_ = std::max(rev_, rev);
             }
             return callback(status, meta_, rev_);
           });
     }
   }
 
+  inline bool hasObject(ObjectID const id) const {
+    return meta_.Find("data." + VYObjectIDToString(id)) !=
+           CompactMetaTree::kNotFound;
+  }
+
+  /**
+   * Read the missing objects from the backend, and then the members of them
+   * that are still missing, until all of them have been read.
+   */
+  void requestMissingObjects(const std::vector<ObjectID>& ids,
+                             callback_t<const CompactMetaTree&> callback) {
+    auto start = std::chrono::steady_clock::now();
+    requestObjects(ids, [this, ids, start, callback](
+                            const Status& status,
+                            const std::vector<kv_t>& kvs, unsigned) {
+      server_ptr_->GetMetrics().RecordMetaRequest(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count());
+      if (!status.ok()) {
+        return callback(status, meta_);
+      }
+      std::vector<op_t> ops;
+      for (auto const& kv : kvs) {
+        if (!boost::algorithm::trim_copy(kv.key).empty()) {
+          ops.emplace_back(op_t::Put(kv.key, kv.value));
+        }
+      }
+      this->metaUpdate(ops);
+
+      // blobs are never in the backend, see also `cacheRemoteBlobs`
+      std::set<ObjectID> members;
+      for (auto const& id : ids) {
+        auto node = meta_.Find("data." + VYObjectIDToString(id));
+        if (node == CompactMetaTree::kNotFound) {
+          continue;
+        }
+        for (auto field : meta_.ChildrenOf(node)) {
+          if (meta_.GetKind(field) != CompactMetaTree::Kind::Link) {
+            continue;
+          }
+          ObjectID member = VYObjectIDFromString(meta_.Value(field));
+          if (!IsBlob(member) && !hasObject(member)) {
+            members.emplace(member);
+          }
+        }
+      }
+      if (members.empty()) {
+        return callback(Status::OK(), meta_);
+      }
+      requestMissingObjects(
+          std::vector<ObjectID>(members.begin(), members.end()), callback);
+      return Status::OK();
+    });
+  }
+
+  /**
+   * Reload all metadata from the backend, used when the revisions that are
+   * required to catch up has been compacted. Only the changes (against the
+   * local metadata) are applied.
+   */
+  void requestResync(const std::string& prefix,
+                     callback_t<const CompactMetaTree&, unsigned> callback) {
+    requestAll(prefix, rev_,
+               [this, callback](const Status& status,
+                                const std::vector<kv_t>& kvs, unsigned rev) {
+                 if (status.ok()) {
+                   std::vector<op_t> ops;
+                   std::set<std::string> keys;
+                   for (auto const& kv : kvs) {
+                     if (boost::algorithm::trim_copy(kv.key).empty() ||
+                         isChunkedCommitMarker(kv.key)) {
+                       continue;
+                     }
+                     keys.emplace(kv.key);
+                     auto node = meta_.Find(kv.key);
+                     if (node == CompactMetaTree::kNotFound ||
+                         meta_.Data(node) != kv.value) {
+                       ops.emplace_back(op_t::Put(kv.key, kv.value));
+                     }
+                   }
+                   // the keys that have been deleted during the gap
+                   std::vector<std::string> local_keys;
+                   collectKeys(CompactMetaTree::kRoot, "", local_keys);
+                   for (auto const& key : local_keys) {
+                     if (keys.find(key) == keys.end()) {
+                       ops.emplace_back(op_t::Del(key));
+                     }
+                   }
+                   this->metaUpdate(ops);
+                   rev_ = rev;
+                   resolvePendingRequests();
+                 }
+                 return callback(status, meta_, rev_);
+               });
+  }
+
+  void collectKeys(CompactMetaTree::node_t const node,
+                   std::string const& prefix, std::vector<std::string>& keys) {
+    for (auto child : meta_.ChildrenOf(node)) {
+      std::string key = prefix.empty() ? meta_.Key(child)
+                                       : prefix + "." + meta_.Key(child);
+      if (meta_.Empty(child)) {
+        keys.emplace_back(key);
+      } else {
+        collectKeys(child, key, keys);
+      }
+    }
+  }
+
+  /**
+   * Finish the requests that are waiting for the daemon watch to reach the
+   * required revision.
+   */
+  void resolvePendingRequests() {
+    while (!pending_requests_.empty() &&
+           pending_requests_.begin()->first <= rev_) {
+      auto callback = pending_requests_.begin()->second;
+      pending_requests_.erase(pending_requests_.begin());
+      VINEYARD_SUPPRESS(callback(Status::OK(), meta_, rev_));
+    }
+  }
+
+  /**
+   * Invoked (inside the meta strand) when the daemon watch starts or stops,
+   * the waiting requests will catch up by themselves if the watch has gone.
+   */
+  void daemonWatchStateChanged(bool const watching) {
+    daemon_watching_ = watching;
+    if (!watching) {
+      auto requests = std::move(pending_requests_);
+      pending_requests_.clear();
+      for (auto const& request : requests) {
+        requestValues("", 0, request.second);
+      }
+    }
+  }
+
+  static bool isChunkedCommitMarker(const std::string& key) {
+    return boost::algorithm::starts_with(key, CHUNKED_COMMIT_PREFIX);
+  }
+
+  static bool isCompacted(const Status& status) {
+    return status.IsEtcdError() &&
+           status.message().find("compacted") != std::string::npos;
+  }
+
   virtual void requestLock(
       std::string lock_name,
       callback_t<std::shared_ptr<ILock>> callback_after_locked) = 0;
@@ -540,6 +1174,15 @@ class IMetaService {
       const std::string& prefix, unsigned since_rev,
       callback_t<const std::vector<op_t>&, unsigned> callback) = 0;
 
+  /**
+   * Read the keys of the objects, i.e., "data.<object id>" and the keys
+   * under it, from the backend, the callback is invoked inside the meta
+   * strand.
+   */
+  virtual void requestObjects(
+      const std::vector<ObjectID>& ids,
+      callback_t<const std::vector<kv_t>&, unsigned> callback) = 0;
+
   virtual void startDaemonWatch(
       const std::string& prefix, unsigned since_rev,
       callback_t<const std::vector<op_t>&, unsigned> callback) = 0;
@@ -550,12 +1193,43 @@ class IMetaService {
   void incRef(std::string const& key, std::string const& value);
   void printDepsGraph();
 
-  ptree meta_;
+  CompactMetaTree meta_;
+  MetaIndex index_;
   vs_ptr_t server_ptr_;
 
   unsigned rev_;
   bool backend_retrying_;
 
+  // whether the daemon watch is applying the deltas, and the requests that
+  // are waiting for it to reach given revisions.
+  bool daemon_watching_ = false;
+  // revisions that have been committed by this instance and have been
+  // applied locally.
+  std::set<unsigned> local_revisions_;
+  // the buffered chunks of chunked commits, keyed by the marker
+  std::map<std::string, std::vector<op_t>> chunked_commits_;
+  // the max number of operations in one transaction of the backend, 0 means
+  // unlimited.
+  size_t max_txn_ops_ = 0;
+  // put the persisted objects as compact values, the compact values are
+  // always readable.
+  bool compact_values_ = false;
+  std::multimap<unsigned, callback_t<const CompactMetaTree&, unsigned>>
+      pending_requests_;
+
+  // the write-behind changes that haven't been committed, the objects of
+  // them, and the objects of the commit in flight.
+  std::vector<op_t> write_behind_ops_;
+  std::unordered_map<std::string, size_t> write_behind_keys_;
+  std::set<ObjectID> write_behind_objects_;
+  std::set<ObjectID> write_behind_committing_;
+  bool write_behind_inflight_ = false;
+  // the sequence number of the last write-behind persist, and of the last
+  // one that has been committed.
+  uint64_t write_behind_seq_ = 0;
+  uint64_t write_behind_committed_ = 0;
+  std::multimap<uint64_t, callback_t<>> flush_waiters_;
+
   std::string meta_sync_lock_;
 
  private:
@@ -566,12 +1240,17 @@ class IMetaService {
                         const ObjectID object_id, const bool force,
                         const bool deep);
 
-  inline void putVal(const kv_t& kv) {
+  inline void putVal(const kv_t& kv, std::vector<ObjectID>& created) {
     incRef(kv.key, kv.value);
-    meta_.put(kv.key, kv.value);
+    meta_.Put(kv.key, kv.value);
+    ObjectID id = index_.Put(kv.key, kv.value);
+    if (id != InvalidObjectID()) {
+      created.emplace_back(id);
+    }
   }
 
-  inline void delVal(const kv_t& kv, std::set<ObjectID>& blobs) {
+  inline void delVal(const kv_t& kv, std::set<ObjectID>& blobs,
+                     std::set<ObjectID>& objects) {
     size_t last_dot = kv.key.find_last_of('.');
     size_t parent_end = last_dot;
     size_t child_start = last_dot + 1;
@@ -593,15 +1272,20 @@ class IMetaService {
 
     if (vs[0] != "data" || deleteable(id_in_key)) {
       // delete metadata: a delete operation might be applied multiple times
-      auto parent_node = meta_.get_child_optional(parent_path);
-      if (!parent_node) {
+      auto parent_node = meta_.Find(parent_path);
+      if (parent_node == CompactMetaTree::kNotFound) {
         return;
       }
-      parent_node.get().erase(child_name);
-      if (parent_node.get().empty()) {
-        size_t last_dot_in_path = parent_path.find_last_of('.');
-        meta_.get_child(parent_path.substr(0, last_dot_in_path))
-            .erase(parent_path.substr(last_dot_in_path + 1));
+      auto child_node = meta_.Child(parent_node, child_name);
+      if (child_node != CompactMetaTree::kNotFound) {
+        meta_.Erase(child_node);
+      }
+      if (parent_node != CompactMetaTree::kRoot && meta_.Empty(parent_node)) {
+        meta_.Erase(parent_node);
+        // the last key of the object has gone
+        if (vs.size() == 2 && id_in_key != InvalidObjectID()) {
+          objects.emplace(id_in_key);
+        }
       }
 
       // if deletable blob: delete blob
@@ -612,15 +1296,66 @@ class IMetaService {
       if (vs[0] == "data" && id_in_key != InvalidObjectID()) {
         // mark as transient
         if ("transient" == child_name) {
-          meta_.get_child(parent_path).put("transient", true);
+          meta_.Put(parent_path + ".transient", "true");
         }
       }
     }
   }
 
+  // "data.<object id>", the key of compact values
+  static bool isObjectKey(std::string const& key) {
+    return boost::algorithm::starts_with(key, "data.") &&
+           key.find('.', sizeof("data.") - 1) == std::string::npos;
+  }
+
+  // puts the fields of a compact value, as if they were put one by one
+  inline void putCompactVal(const kv_t& kv, std::vector<ObjectID>& created) {
+    compact_fields_t fields;
+    auto status = DecodeCompactValue(kv.value, fields);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to decode the metadata of '" << kv.key
+                 << "': " << status.ToString();
+      return;
+    }
+    for (auto& field : fields) {
+      kv_t field_kv;
+      field_kv.key = kv.key + "." + field.first;
+      field_kv.value = std::move(field.second);
+      field_kv.rev = kv.rev;
+      putVal(field_kv, created);
+    }
+  }
+
+  // deletes the subtree of a kDelPrefix op, which is an object in most cases
+  inline void delPrefix(const kv_t& kv, std::set<ObjectID>& blobs,
+                        std::set<ObjectID>& objects) {
+    auto node = meta_.Find(kv.key);
+    if (node == CompactMetaTree::kNotFound || node == CompactMetaTree::kRoot) {
+      return;
+    }
+    ObjectID id_in_key = InvalidObjectID();
+    if (boost::algorithm::starts_with(kv.key, "data.") &&
+        kv.key.find('.', sizeof("data.") - 1) == std::string::npos) {
+      id_in_key = VYObjectIDFromString(kv.key.substr(sizeof("data.") - 1));
+      if (!deleteable(id_in_key)) {
+        return;
+      }
+    }
+    meta_.Erase(node);
+    if (id_in_key != InvalidObjectID()) {
+      objects.emplace(id_in_key);
+      if (IsBlob(id_in_key)) {
+        blobs.emplace(id_in_key);
+      }
+    }
+  }
+
   template <class RangeT>
   void metaUpdate(const RangeT& ops) {
-    std::set<ObjectID> blobs_to_delete;
+    std::set<ObjectID> blobs_to_delete, objects_deleted;
+    std::set<std::string> updated_keys;
+    std::vector<ObjectID> objects_created;
+    std::vector<std::string> names_updated;
     for (const op_t& op : ops) {
       if (op.kv.rev != 0 && op.kv.rev <= rev_) {
         // revision resolution: means this revision has already been updated
@@ -631,21 +1366,54 @@ class IMetaService {
         // skip unprintable keys
         continue;
       }
-      if (boost::algorithm::starts_with(op.kv.key, "instances.")) {
+      if (op.op != op_t::op_type_t::kDelPrefix &&
+          boost::algorithm::starts_with(op.kv.key, "instances.")) {
         instanceUpdate(op);
       }
 #ifndef NDEBUG
       VLOG(10) << "update op in meta tree: " << op.ToString();
 #endif
       const kv_t& kv = op.kv;
-      if (op.op == op_t::op_type_t::kPut) {
-        putVal(kv);
-      } else if (op.op == op_t::op_type_t::kDel) {
-        delVal(kv, blobs_to_delete);
+      if (op.op == op_t::op_type_t::kPut && isObjectKey(kv.key) &&
+          IsCompactValue(kv.value)) {
+        putCompactVal(kv, objects_created);
+        collectDeferredKey(kv.key, updated_keys);
+      } else if (op.op == op_t::op_type_t::kPut) {
+        putVal(kv, objects_created);
+        collectDeferredKey(kv.key, updated_keys);
+        if (boost::algorithm::starts_with(kv.key, "names.")) {
+          names_updated.emplace_back(kv.key.substr(sizeof("names.") - 1));
+        }
+      } else if (op.op == op_t::op_type_t::kDel && !isObjectKey(kv.key)) {
+        delVal(kv, blobs_to_delete, objects_deleted);
+      } else if (op.op == op_t::op_type_t::kDel ||
+                 op.op == op_t::op_type_t::kDelPrefix) {
+        // the object may have been put as a compact value, whose fields
+        // aren't deleted one by one.
+        delPrefix(kv, blobs_to_delete, objects_deleted);
       }
     }
+    for (auto const& id : objects_deleted) {
+      index_.EraseObject(id);
+    }
     VINEYARD_SUPPRESS(server_ptr_->DeleteBlobBatch(blobs_to_delete));
-    VINEYARD_SUPPRESS(server_ptr_->ProcessDeferred(meta_));
+    server_ptr_->NotifyDeletion(objects_deleted);
+    server_ptr_->NotifySubscribers(meta_, index_, objects_created,
+                                   names_updated);
+    VINEYARD_SUPPRESS(server_ptr_->ProcessDeferred(meta_, updated_keys));
+  }
+
+  /**
+   * The keys that deferred requests wait on, i.e., "names.<name>" and
+   * "data.<object id>", see also `DeferredReq`.
+   */
+  static void collectDeferredKey(std::string const& key,
+                                 std::set<std::string>& keys) {
+    if (boost::algorithm::starts_with(key, "names.")) {
+      keys.emplace(key);
+    } else if (boost::algorithm::starts_with(key, "data.")) {
+      keys.emplace(key.substr(0, key.find('.', sizeof("data.") - 1)));
+    }
   }
 
   void instanceUpdate(const op_t& op) {
@@ -665,6 +1433,53 @@ class IMetaService {
     }
   }
 
+  /**
+   * Apply the events grouped by revision, the revisions that have been
+   * applied locally are skipped.
+   */
+  void applyRevisions(const std::vector<op_t>& ops) {
+    size_t idx = 0;
+    std::vector<op_t> op_batch;
+    while (idx < ops.size()) {
+      unsigned index = ops[idx].kv.rev;
+      while (idx < ops.size() && ops[idx].kv.rev == index) {
+        op_batch.emplace_back(ops[idx]);
+        idx += 1;
+      }
+      bool const local = local_revisions_.erase(index) != 0;
+      if (collectChunkedCommit(op_batch) && !local) {
+        metaUpdate(op_batch);
+      }
+      op_batch.clear();
+    }
+  }
+
+  /**
+   * Returns false if the batch is a chunk of an unfinished chunked commit,
+   * which is buffered. When the last chunk arrives, the batch is replaced by
+   * all changes of the chunked commit, to make them visible at once.
+   */
+  bool collectChunkedCommit(std::vector<op_t>& op_batch) {
+    auto marker = std::find_if(
+        op_batch.begin(), op_batch.end(),
+        [](const op_t& op) { return isChunkedCommitMarker(op.kv.key); });
+    if (marker == op_batch.end()) {
+      return true;
+    }
+    const std::string key = marker->kv.key;
+    const bool finished = marker->op == op_t::op_type_t::kDel;
+    op_batch.erase(marker);
+    auto& chunks = chunked_commits_[key];
+    chunks.insert(chunks.end(), op_batch.begin(), op_batch.end());
+    if (!finished) {
+      op_batch.clear();
+      return false;
+    }
+    op_batch = std::move(chunks);
+    chunked_commits_.erase(key);
+    return true;
+  }
+
   Status daemonWatchHandler(const Status& status, const std::vector<op_t>& ops,
                             unsigned rev) {
     // Guarantee: all kvs inside a txn reaches the client at the same time,
@@ -672,25 +1487,29 @@ class IMetaService {
     //
     // That means, every time this handler is called, we just need to reponse
     // for one type of change.
+    if (isCompacted(status)) {
+      LOG(WARNING) << "The daemon watch falls behind the compaction, resync "
+                   << "all metadata";
+      requestResync("", [](const Status& status, const CompactMetaTree& meta,
+                           unsigned rev) { return status; });
+      return status;
+    }
     if (!status.ok()) {
       LOG(ERROR) << "Error in daemon watching: " << status.ToString();
       return status;
     }
-    if (ops.empty()) {
-      return Status::OK();
-    }
-    // process events grouped by revision
-    size_t idx = 0;
-    std::vector<op_t> op_batch;
-    while (idx < ops.size()) {
-      unsigned index = ops[idx].kv.rev;
-      while (idx < ops.size() && ops[idx].kv.rev == index) {
-        op_batch.emplace_back(ops[idx]);
-        idx += 1;
-      }
-      metaUpdate(op_batch);
-      op_batch.clear();
-    }
+    auto start = std::chrono::steady_clock::now();
+    applyRevisions(ops);
+    server_ptr_->GetMetrics().RecordMetaWatch(
+        ops.size(), std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count());
+    // `rev` is the revision of backend when the events are sent, which covers
+    // the events that have been filtered out as well, e.g., the locks.
+    rev_ = std::max(rev_, rev);
+    local_revisions_.erase(local_revisions_.begin(),
+                           local_revisions_.upper_bound(rev_));
+    resolvePendingRequests();
     return Status::OK();
   }
 
@@ -0,0 +1,252 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/background_scheduler.h"
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <utility>
+
+#include "common/util/logging.h"
+#include "server/util/cpu_affinity.h"
+
+namespace vineyard {
+
+constexpr size_t BackgroundScheduler::kPriorities;
+
+BackgroundScheduler::BackgroundScheduler(Options const& options, load_t load)
+    : options_(options), load_(std::move(load)) {
+  options_.threads = std::max<size_t>(options_.threads, 1);
+  options_.cpu_slots = std::max<size_t>(options_.cpu_slots, 1);
+  options_.io_slots = std::max<size_t>(options_.io_slots, 1);
+  for (size_t priority = 0; priority < kPriorities; ++priority) {
+    slices_[priority] = 0;
+    yields_[priority] = 0;
+  }
+}
+
+BackgroundScheduler::~BackgroundScheduler() { Stop(); }
+
+void BackgroundScheduler::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!workers_.empty() || stopped_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> io_lock(io_mutex_);
+    io_tokens_ = static_cast<double>(options_.io_bytes_per_second);
+    io_refilled_at_ = clock_t::now();
+  }
+  for (size_t index = 0; index < options_.threads; ++index) {
+    workers_.emplace_back(&BackgroundScheduler::workerLoop, this);
+  }
+  LOG(INFO) << "Running background tasks with " << options_.threads
+            << " threads, which yield when more than "
+            << options_.busy_threshold << " requests are in flight";
+}
+
+void BackgroundScheduler::Stop() {
+  std::vector<std::thread> workers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    for (auto& queue : queues_) {
+      queue.clear();
+    }
+    delayed_.clear();
+    workers.swap(workers_);
+  }
+  cv_.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void BackgroundScheduler::Submit(std::string const& name,
+                                 Priority const priority,
+                                 Resource const resource, task_t task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    queues_[static_cast<size_t>(priority)].emplace_back(
+        Task{name, priority, resource, std::move(task),
+             std::chrono::milliseconds(0), clock_t::now()});
+  }
+  cv_.notify_one();
+}
+
+void BackgroundScheduler::SubmitPeriodic(
+    std::string const& name, std::chrono::milliseconds const period,
+    Priority const priority, Resource const resource, task_t task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    auto const interval = std::max(period, std::chrono::milliseconds(1));
+    delay(Task{name, priority, resource, std::move(task), interval,
+               clock_t::now() + interval});
+  }
+  cv_.notify_one();
+}
+
+void BackgroundScheduler::Yield(Priority const priority) {
+  if (priority == Priority::kHigh) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_ && Busy()) {
+    yields_[static_cast<size_t>(priority)] += 1;
+    cv_.wait_for(lock, options_.backoff);
+  }
+}
+
+void BackgroundScheduler::ChargeIO(size_t const bytes) {
+  if (options_.io_bytes_per_second == 0) {
+    return;
+  }
+  double const rate = static_cast<double>(options_.io_bytes_per_second);
+  double deficit = 0;
+  {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    auto now = clock_t::now();
+    // bursts up to the budget of a second
+    io_tokens_ = std::min(
+        rate, io_tokens_ + std::chrono::duration<double>(now - io_refilled_at_)
+                                   .count() *
+                               rate);
+    io_refilled_at_ = now;
+    io_tokens_ -= static_cast<double>(bytes);
+    deficit = -io_tokens_;
+  }
+  if (deficit > 0) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(deficit / rate));
+  }
+}
+
+void BackgroundScheduler::Dump(ptree& tree) const {
+  static const char* names[kPriorities] = {"high", "normal", "low"};
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t priority = 0; priority < kPriorities; ++priority) {
+    size_t queued = queues_[priority].size();
+    for (auto const& task : delayed_) {
+      queued += static_cast<size_t>(task.priority) == priority;
+    }
+    ptree item;
+    item.put("queued", queued);
+    item.put("slices", slices_[priority].load());
+    item.put("yields", yields_[priority].load());
+    tree.add_child(names[priority], item);
+  }
+  tree.put("running_cpu", running_[static_cast<size_t>(Resource::kCPU)]);
+  tree.put("running_io", running_[static_cast<size_t>(Resource::kIO)]);
+}
+
+void BackgroundScheduler::workerLoop() {
+  PinCurrentThread(options_.cpus);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    Task task;
+    clock_t::time_point wake_at;
+    if (!nextTask(task, wake_at)) {
+      if (wake_at == clock_t::time_point::max()) {
+        cv_.wait(lock);
+      } else {
+        cv_.wait_until(lock, wake_at);
+      }
+      continue;
+    }
+    size_t const resource = static_cast<size_t>(task.resource);
+    size_t const priority = static_cast<size_t>(task.priority);
+    running_[resource] += 1;
+    lock.unlock();
+    bool more = false;
+    try {
+      more = task.fn();
+    } catch (std::exception const& ex) {
+      LOG(ERROR) << "Background task '" << task.name
+                 << "' failed: " << ex.what();
+    }
+    slices_[priority] += 1;
+    lock.lock();
+    running_[resource] -= 1;
+    if (stopped_) {
+      break;
+    }
+    if (more) {
+      queues_[priority].emplace_back(std::move(task));
+    } else if (task.period.count() > 0) {
+      task.due = clock_t::now() + task.period;
+      delay(std::move(task));
+    }
+    // the budget that is released may fit the tasks of other workers
+    cv_.notify_all();
+  }
+}
+
+bool BackgroundScheduler::nextTask(Task& task, clock_t::time_point& wake_at) {
+  auto const now = clock_t::now();
+  while (!delayed_.empty() && delayed_.front().due <= now) {
+    auto& queue = queues_[static_cast<size_t>(delayed_.front().priority)];
+    queue.emplace_back(std::move(delayed_.front()));
+    delayed_.pop_front();
+  }
+  wake_at =
+      delayed_.empty() ? clock_t::time_point::max() : delayed_.front().due;
+
+  size_t const slots[2] = {options_.cpu_slots, options_.io_slots};
+  bool busy_checked = false, busy = false;
+  for (size_t priority = 0; priority < kPriorities; ++priority) {
+    auto& queue = queues_[priority];
+    for (auto iter = queue.begin(); iter != queue.end(); ++iter) {
+      if (running_[static_cast<size_t>(iter->resource)] >=
+          slots[static_cast<size_t>(iter->resource)]) {
+        continue;
+      }
+      if (iter->priority != Priority::kHigh) {
+        if (!busy_checked) {
+          busy = Busy();
+          busy_checked = true;
+        }
+        if (busy) {
+          // the lower priorities yield as well, check the load again later
+          for (size_t lower = priority; lower < kPriorities; ++lower) {
+            yields_[lower] += !queues_[lower].empty();
+          }
+          wake_at = std::min(wake_at, now + options_.backoff);
+          return false;
+        }
+      }
+      task = std::move(*iter);
+      queue.erase(iter);
+      return true;
+    }
+  }
+  return false;
+}
+
+void BackgroundScheduler::delay(Task&& task) {
+  auto iter = std::upper_bound(
+      delayed_.begin(), delayed_.end(), task.due,
+      [](clock_t::time_point const& due, Task const& item) {
+        return due < item.due;
+      });
+  delayed_.insert(iter, std::move(task));
+}
+
+}  // namespace vineyard
@@ -0,0 +1,169 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_BACKGROUND_SCHEDULER_H_
+#define SRC_SERVER_UTIL_BACKGROUND_SCHEDULER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/util/boost.h"
+
+namespace vineyard {
+
+/**
+ * @brief BackgroundScheduler runs the maintenance work of vineyardd (e.g.,
+ * garbage collection and the compression of cold blobs) on a thread pool of
+ * its own, rather than on the io context that serves the requests.
+ *
+ * Tasks are cooperative: a task does a slice of its work per run and returns
+ * whether there's more, then it is queued again behind the other tasks of
+ * the same priority. The slices are bounded by budgets:
+ *
+ *  - At most `cpu_slots` (`io_slots`) slices of CPU (IO) tasks run at the
+ *    same time, and IO tasks are paced by `io_bytes_per_second` through
+ *    `ChargeIO()`.
+ *  - The slices of `kNormal` and `kLow` tasks yield to the foreground, i.e.,
+ *    they wait while the load (the number of the requests in flight) is
+ *    above `busy_threshold`, and tasks on threads of their own can yield
+ *    between units of work by `Yield()`. `kHigh` tasks never yield.
+ */
+class BackgroundScheduler {
+ public:
+  enum class Priority : int { kHigh = 0, kNormal = 1, kLow = 2 };
+  enum class Resource : int { kCPU = 0, kIO = 1 };
+
+  // runs a slice of the work, returns true if there's more
+  using task_t = std::function<bool()>;
+  using load_t = std::function<size_t()>;
+
+  struct Options {
+    size_t threads = 2;
+    size_t cpu_slots = 1;
+    size_t io_slots = 1;
+    // 0 means unlimited
+    size_t io_bytes_per_second = 0;
+    size_t busy_threshold = 8;
+    // how long the yielding tasks wait before checking the load again
+    std::chrono::milliseconds backoff{10};
+    // the CPUs that the workers are pinned to, empty means floating
+    std::vector<int> cpus;
+  };
+
+  BackgroundScheduler(Options const& options, load_t load);
+
+  ~BackgroundScheduler();
+
+  BackgroundScheduler(const BackgroundScheduler&) = delete;
+  BackgroundScheduler& operator=(const BackgroundScheduler&) = delete;
+
+  void Start();
+
+  /**
+   * @brief Stop the workers after the running slices finish, the queued
+   * tasks are dropped.
+   */
+  void Stop();
+
+  void Submit(std::string const& name, Priority const priority,
+              Resource const resource, task_t task);
+
+  /**
+   * @brief Run the task every `period`, its slices run back to back until it
+   * returns false, then the next run starts after the period.
+   */
+  void SubmitPeriodic(std::string const& name,
+                      std::chrono::milliseconds const period,
+                      Priority const priority, Resource const resource,
+                      task_t task);
+
+  /**
+   * @brief Whether the foreground load is above the threshold.
+   */
+  bool Busy() const { return load_ && load_() > options_.busy_threshold; }
+
+  /**
+   * @brief Block while the foreground is busy, unless the priority is
+   * `kHigh` or the scheduler has been stopped.
+   */
+  void Yield(Priority const priority);
+
+  /**
+   * @brief Charge the bytes that an IO task has read or written, blocks
+   * until the IO budget allows.
+   */
+  void ChargeIO(size_t const bytes);
+
+  /**
+   * @brief Dump the number of the queued and running tasks, the slices that
+   * have run and the times that they have yielded, per priority.
+   */
+  void Dump(ptree& tree) const;
+
+ private:
+  using clock_t = std::chrono::steady_clock;
+
+  struct Task {
+    std::string name;
+    Priority priority;
+    Resource resource;
+    task_t fn;
+    // zero for one-shot tasks
+    std::chrono::milliseconds period{0};
+    clock_t::time_point due;
+  };
+
+  static constexpr size_t kPriorities = 3;
+
+  void workerLoop();
+
+  // with the mutex held, pops the next task that fits the budgets, and
+  // moves the due delayed tasks to the queues.
+  bool nextTask(Task& task, clock_t::time_point& wake_at);
+
+  void delay(Task&& task);
+
+  Options options_;
+  load_t load_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::array<std::deque<Task>, kPriorities> queues_;
+  // sorted by the due time
+  std::deque<Task> delayed_;
+  std::array<size_t, 2> running_{{0, 0}};
+  bool stopped_ = false;
+  std::vector<std::thread> workers_;
+
+  std::array<std::atomic<uint64_t>, kPriorities> slices_;
+  std::array<std::atomic<uint64_t>, kPriorities> yields_;
+
+  std::mutex io_mutex_;
+  double io_tokens_ = 0;
+  clock_t::time_point io_refilled_at_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_BACKGROUND_SCHEDULER_H_
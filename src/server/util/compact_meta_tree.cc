@@ -0,0 +1,318 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/compact_meta_tree.h"
+
+#include <cstring>
+
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+constexpr StringPool::id_t StringPool::kInvalid;
+constexpr CompactMetaTree::node_t CompactMetaTree::kRoot;
+constexpr CompactMetaTree::node_t CompactMetaTree::kNotFound;
+
+bool StringPool::view_t::operator==(const view_t& other) const {
+  return size == other.size && memcmp(data, other.data, size) == 0;
+}
+
+size_t StringPool::view_hash_t::operator()(const view_t& view) const {
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t index = 0; index < view.size; ++index) {
+    hash ^= static_cast<unsigned char>(view.data[index]);
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+StringPool::id_t StringPool::Intern(const char* data, size_t const size) {
+  auto iter = index_.find(view_t{data, size});
+  if (iter != index_.end()) {
+    entries_[iter->second].refs += 1;
+    return iter->second;
+  }
+  id_t id;
+  if (free_entries_.empty()) {
+    id = static_cast<id_t>(entries_.size());
+    entries_.emplace_back(entry_t{std::string(data, size), 1});
+  } else {
+    id = free_entries_.back();
+    free_entries_.pop_back();
+    entries_[id].value.assign(data, size);
+    entries_[id].refs = 1;
+  }
+  const std::string& value = entries_[id].value;
+  index_.emplace(view_t{value.data(), value.size()}, id);
+  bytes_ += size;
+  return id;
+}
+
+StringPool::id_t StringPool::Find(const char* data, size_t const size) const {
+  auto iter = index_.find(view_t{data, size});
+  if (iter == index_.end()) {
+    return kInvalid;
+  }
+  return iter->second;
+}
+
+void StringPool::Release(id_t const id) {
+  entry_t& entry = entries_[id];
+  if (--entry.refs > 0) {
+    return;
+  }
+  index_.erase(view_t{entry.value.data(), entry.value.size()});
+  bytes_ -= entry.value.size();
+  std::string().swap(entry.value);
+  free_entries_.emplace_back(id);
+}
+
+size_t StringPool::MemoryUsage() const {
+  // a node of the hash table holds the key, the value and the next pointer
+  constexpr size_t index_node = sizeof(view_t) + sizeof(id_t) + sizeof(void*);
+  return entries_.size() * sizeof(entry_t) + bytes_ +
+         free_entries_.capacity() * sizeof(id_t) +
+         index_.size() * index_node + index_.bucket_count() * sizeof(void*);
+}
+
+CompactMetaTree::CompactMetaTree() {
+  empty_ = strings_.Intern(std::string());
+  data_key_ = strings_.Intern("data");
+  nodes_.emplace_back(node_data_t{kNotFound, kNotFound, kNotFound, kNotFound,
+                                  kNotFound, 0, empty_, empty_, empty_,
+                                  Kind::Tree});
+}
+
+CompactMetaTree::node_t CompactMetaTree::Find(node_t const node,
+                                              const std::string& path) const {
+  node_t current = node;
+  size_t begin = 0;
+  while (current != kNotFound && begin <= path.size()) {
+    if (path.empty()) {
+      break;
+    }
+    size_t end = path.find('.', begin);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+    StringPool::id_t key = strings_.Find(path.data() + begin, end - begin);
+    if (key == StringPool::kInvalid) {
+      return kNotFound;
+    }
+    auto iter = children_.find(edgeOf(current, key));
+    current = iter == children_.end() ? kNotFound : iter->second;
+    begin = end + 1;
+  }
+  return current;
+}
+
+CompactMetaTree::node_t CompactMetaTree::Child(node_t const node,
+                                               const std::string& key) const {
+  StringPool::id_t key_id = strings_.Find(key);
+  if (key_id == StringPool::kInvalid) {
+    return kNotFound;
+  }
+  auto iter = children_.find(edgeOf(node, key_id));
+  return iter == children_.end() ? kNotFound : iter->second;
+}
+
+CompactMetaTree::node_t CompactMetaTree::Put(const std::string& path,
+                                             const std::string& data) {
+  node_t current = kRoot;
+  size_t begin = 0;
+  while (!path.empty() && begin <= path.size()) {
+    size_t end = path.find('.', begin);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+    current = child(current, path.data() + begin, end - begin);
+    begin = end + 1;
+  }
+  setData(current, data);
+  return current;
+}
+
+void CompactMetaTree::Erase(node_t const node) {
+  CHECK_NE(node, kRoot) << "The root of meta tree cannot be erased";
+  // unlink from the parent
+  node_data_t& target = nodes_[node];
+  node_data_t& parent = nodes_[target.parent];
+  if (target.prev_sibling == kNotFound) {
+    parent.first_child = target.next_sibling;
+  } else {
+    nodes_[target.prev_sibling].next_sibling = target.next_sibling;
+  }
+  if (target.next_sibling == kNotFound) {
+    parent.last_child = target.prev_sibling;
+  } else {
+    nodes_[target.next_sibling].prev_sibling = target.prev_sibling;
+  }
+  parent.size -= 1;
+
+  std::vector<node_t> nodes_to_free{node};
+  while (!nodes_to_free.empty()) {
+    node_t current = nodes_to_free.back();
+    nodes_to_free.pop_back();
+    for (node_t child : ChildrenOf(current)) {
+      nodes_to_free.emplace_back(child);
+    }
+    node_data_t& data = nodes_[current];
+    children_.erase(edgeOf(data.parent, data.key));
+    releaseData(current);
+    release(data.key);
+    data.parent = kNotFound;
+    data.first_child = data.last_child = kNotFound;
+    data.prev_sibling = data.next_sibling = kNotFound;
+    data.size = 0;
+    data.key = empty_;
+    free_nodes_.emplace_back(current);
+  }
+}
+
+std::string CompactMetaTree::Data(node_t const node) const {
+  const node_data_t& data = nodes_[node];
+  switch (data.kind) {
+  case Kind::String:
+    return strings_.Get(data.value);
+  case Kind::Value:
+    return "v" + strings_.Get(data.value);
+  case Kind::Link:
+    if (data.extra == empty_) {
+      return "l" + strings_.Get(data.value);
+    }
+    return "l" + strings_.Get(data.value) + "." + strings_.Get(data.extra);
+  default:
+    return std::string();
+  }
+}
+
+void CompactMetaTree::ToPtree(node_t const node, ptree& tree) const {
+  tree.data() = Data(node);
+  for (node_t child : ChildrenOf(node)) {
+    tree.push_back(ptree::value_type(Key(child), ptree()));
+    ToPtree(child, tree.back().second);
+  }
+}
+
+size_t CompactMetaTree::MemoryUsage() const {
+  constexpr size_t children_node =
+      sizeof(uint64_t) + sizeof(node_t) + sizeof(void*);
+  return nodes_.capacity() * sizeof(node_data_t) +
+         free_nodes_.capacity() * sizeof(node_t) +
+         children_.size() * children_node +
+         children_.bucket_count() * sizeof(void*) + strings_.MemoryUsage();
+}
+
+CompactMetaTree::node_t CompactMetaTree::child(node_t const node,
+                                               const char* key,
+                                               size_t const size) {
+  StringPool::id_t key_id = strings_.Find(key, size);
+  if (key_id != StringPool::kInvalid) {
+    auto iter = children_.find(edgeOf(node, key_id));
+    if (iter != children_.end()) {
+      return iter->second;
+    }
+  }
+  return newNode(node, intern(key, size));
+}
+
+CompactMetaTree::node_t CompactMetaTree::newNode(node_t const parent,
+                                                 StringPool::id_t const key) {
+  node_t node;
+  node_data_t data{parent,    kNotFound, kNotFound, nodes_[parent].last_child,
+                   kNotFound, 0,         key,       empty_,
+                   empty_,    Kind::Tree};
+  if (free_nodes_.empty()) {
+    node = static_cast<node_t>(nodes_.size());
+    nodes_.emplace_back(data);
+  } else {
+    node = free_nodes_.back();
+    free_nodes_.pop_back();
+    nodes_[node] = data;
+  }
+  node_data_t& parent_data = nodes_[parent];
+  if (parent_data.last_child == kNotFound) {
+    parent_data.first_child = node;
+  } else {
+    nodes_[parent_data.last_child].next_sibling = node;
+  }
+  parent_data.last_child = node;
+  parent_data.size += 1;
+  children_.emplace(edgeOf(parent, key), node);
+  return node;
+}
+
+void CompactMetaTree::setData(node_t const node, const std::string& data) {
+  releaseData(node);
+  node_data_t& target = nodes_[node];
+  if (!data.empty() && isObjectField(node)) {
+    if (data[0] == 'v') {
+      target.kind = Kind::Value;
+      target.value = intern(data.data() + 1, data.size() - 1);
+      return;
+    }
+    if (data[0] == 'l') {
+      // "l<name>.<typename>", see also `meta_tree::generate_link`.
+      target.kind = Kind::Link;
+      size_t l1 = data.find('.');
+      size_t l2 = data.rfind('.');
+      if (l1 != std::string::npos && l1 == l2 && l1 > 1 &&
+          l1 + 1 < data.size()) {
+        target.value = intern(data.data() + 1, l1 - 1);
+        target.extra = intern(data.data() + l1 + 1, data.size() - l1 - 1);
+      } else {
+        // malformed, keep it as is
+        target.value = intern(data.data() + 1, data.size() - 1);
+      }
+      return;
+    }
+  }
+  target.kind = Kind::String;
+  target.value = intern(data.data(), data.size());
+}
+
+void CompactMetaTree::releaseData(node_t const node) {
+  node_data_t& target = nodes_[node];
+  release(target.value);
+  release(target.extra);
+  target.value = target.extra = empty_;
+  target.kind = Kind::Tree;
+}
+
+StringPool::id_t CompactMetaTree::intern(const char* data, size_t const size) {
+  if (size == 0) {
+    return empty_;
+  }
+  return strings_.Intern(data, size);
+}
+
+void CompactMetaTree::release(StringPool::id_t const id) {
+  if (id != empty_) {
+    strings_.Release(id);
+  }
+}
+
+bool CompactMetaTree::isObjectField(node_t const node) const {
+  size_t depth = 0;
+  node_t current = node;
+  while (current != kRoot && nodes_[current].parent != kRoot) {
+    current = nodes_[current].parent;
+    depth += 1;
+  }
+  return current != kRoot && depth >= 2 && nodes_[current].key == data_key_;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,317 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_COMPACT_META_TREE_H_
+#define SRC_SERVER_UTIL_COMPACT_META_TREE_H_
+
+#include <cstdint>
+#include <deque>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/util/boost.h"
+
+namespace vineyard {
+
+/**
+ * @brief StringPool interns strings, every distinct string is stored once
+ * and is referred by a small integer id. Entries are reference counted and
+ * the slots of released entries are reused.
+ */
+class StringPool {
+ public:
+  using id_t = uint32_t;
+
+  static constexpr id_t kInvalid = UINT32_MAX;
+
+  StringPool() = default;
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+
+  /**
+   * @brief Returns the id of the string, and increases its reference count.
+   */
+  id_t Intern(const char* data, size_t const size);
+
+  id_t Intern(const std::string& value) {
+    return Intern(value.data(), value.size());
+  }
+
+  /**
+   * @brief Lookup the id of the string without interning it, returns
+   * kInvalid if not found.
+   */
+  id_t Find(const char* data, size_t const size) const;
+
+  id_t Find(const std::string& value) const {
+    return Find(value.data(), value.size());
+  }
+
+  void Release(id_t const id);
+
+  const std::string& Get(id_t const id) const { return entries_[id].value; }
+
+  size_t Size() const { return index_.size(); }
+
+  /** The estimated memory footprint of the pool, in bytes. */
+  size_t MemoryUsage() const;
+
+ private:
+  // refers to the bytes of an entry, the entries are stored in a deque, thus
+  // they won't be moved when new entries are appended.
+  struct view_t {
+    const char* data;
+    size_t size;
+    bool operator==(const view_t& other) const;
+  };
+
+  struct view_hash_t {
+    size_t operator()(const view_t& view) const;
+  };
+
+  struct entry_t {
+    std::string value;
+    uint32_t refs;
+  };
+
+  std::deque<entry_t> entries_;
+  std::vector<id_t> free_entries_;
+  std::unordered_map<view_t, id_t, view_hash_t> index_;
+  // the bytes of the interned strings
+  size_t bytes_ = 0;
+};
+
+/**
+ * @brief CompactMetaTree is the in-memory representation of the metadata in
+ * vineyardd, which has the same layout of the `ptree` it replaces (the keys
+ * in etcd, e.g., "data.<object id>.<field>", are paths in the tree), but is
+ * much more compact and faster to lookup:
+ *
+ *  - nodes live in a single arena and refer to each other by indices, freed
+ *    nodes are reused, thus there's no allocation per node;
+ *  - keys and values are interned in a `StringPool`, the typename, the
+ *    instance id and the field names are shared by millions of objects;
+ *  - children are indexed by a hash table on (parent, key), thus lookups
+ *    don't scan the siblings, while children are still iterated in the order
+ *    of insertion, as ptree does;
+ *  - the fields of objects (the nodes under "data.<object id>") are typed:
+ *    the 'v' (value) and 'l' (link) prefixes are decoded when the field is
+ *    put, and links are kept as the interned name and typename of the
+ *    member.
+ *
+ * Only the meta strand accesses the tree, conversions to `ptree` happen at
+ * the boundary of the protocol, see also `ToPtree`.
+ */
+class CompactMetaTree {
+ public:
+  using node_t = uint32_t;
+
+  static constexpr node_t kRoot = 0;
+  static constexpr node_t kNotFound = UINT32_MAX;
+
+  enum class Kind : uint8_t {
+    Tree = 0,    // the node has children, or is an empty leaf
+    String = 1,  // a plain string, e.g., the "names" and "instances"
+    Value = 2,   // a field of object that is a value, the 'v' prefix
+    Link = 3,    // a field of object that refers a member, the 'l' prefix
+  };
+
+  CompactMetaTree();
+  CompactMetaTree(const CompactMetaTree&) = delete;
+  CompactMetaTree& operator=(const CompactMetaTree&) = delete;
+
+  /**
+   * @brief Find the node of the dot-separated path relative to `node`,
+   * returns kNotFound if not exists.
+   */
+  node_t Find(node_t const node, const std::string& path) const;
+
+  node_t Find(const std::string& path) const { return Find(kRoot, path); }
+
+  /**
+   * @brief Find the direct child of the node, the key won't be split on
+   * dots.
+   */
+  node_t Child(node_t const node, const std::string& key) const;
+
+  /**
+   * @brief Put the value to the dot-separated path, the intermediate nodes
+   * are created if not exist, as `ptree::put` does.
+   */
+  node_t Put(const std::string& path, const std::string& data);
+
+  /**
+   * @brief Erase the node with its subtree, the root cannot be erased.
+   */
+  void Erase(node_t const node);
+
+  node_t Parent(node_t const node) const { return nodes_[node].parent; }
+
+  /**
+   * @brief Whether the node has no children, the same as `ptree::empty`.
+   */
+  bool Empty(node_t const node) const {
+    return nodes_[node].first_child == kNotFound;
+  }
+
+  size_t Size(node_t const node) const { return nodes_[node].size; }
+
+  const std::string& Key(node_t const node) const {
+    return strings_.Get(nodes_[node].key);
+  }
+
+  Kind GetKind(node_t const node) const { return nodes_[node].kind; }
+
+  /**
+   * @brief The decoded value of String or Value nodes, or the name of the
+   * member of Link nodes.
+   */
+  const std::string& Value(node_t const node) const {
+    return strings_.Get(nodes_[node].value);
+  }
+
+  /**
+   * @brief The shortened typename of member of Link nodes, empty if the link
+   * is malformed.
+   */
+  const std::string& LinkType(node_t const node) const {
+    return strings_.Get(nodes_[node].extra);
+  }
+
+  /**
+   * @brief The data of the node as it has been put, i.e., with the prefix of
+   * typed values.
+   */
+  std::string Data(node_t const node) const;
+
+  /**
+   * @brief Get the data of the node at the path as T, as `ptree::get_optional`
+   * does.
+   */
+  template <typename T>
+  boost::optional<T> GetOptional(node_t const node,
+                                 const std::string& path) const {
+    node_t target = Find(node, path);
+    if (target == kNotFound) {
+      return boost::none;
+    }
+    std::istringstream stream(Data(target));
+    T value;
+    stream >> value;
+    if (stream.fail()) {
+      return boost::none;
+    }
+    return value;
+  }
+
+  /**
+   * @brief Convert the subtree to a ptree, where the values are in the form
+   * of `Data`.
+   */
+  void ToPtree(node_t const node, ptree& tree) const;
+
+  size_t Nodes() const { return nodes_.size() - free_nodes_.size(); }
+
+  size_t Strings() const { return strings_.Size(); }
+
+  /**
+   * @brief The estimated memory footprint of the tree, including the nodes,
+   * the index of children and the interned strings, in bytes.
+   */
+  size_t MemoryUsage() const;
+
+  /**
+   * @brief Iterates the children of a node in the order of insertion.
+   */
+  class ChildIterator {
+   public:
+    ChildIterator(const CompactMetaTree* tree, node_t const node)
+        : tree_(tree), node_(node) {}
+    node_t operator*() const { return node_; }
+    ChildIterator& operator++() {
+      node_ = tree_->nodes_[node_].next_sibling;
+      return *this;
+    }
+    bool operator!=(const ChildIterator& other) const {
+      return node_ != other.node_;
+    }
+
+   private:
+    const CompactMetaTree* tree_;
+    node_t node_;
+  };
+
+  struct Children {
+    ChildIterator begin() const {
+      return ChildIterator(tree, tree->nodes_[node].first_child);
+    }
+    ChildIterator end() const { return ChildIterator(tree, kNotFound); }
+    const CompactMetaTree* tree;
+    node_t node;
+  };
+
+  Children ChildrenOf(node_t const node) const { return Children{this, node}; }
+
+ private:
+  struct node_data_t {
+    node_t parent;
+    node_t first_child, last_child;
+    node_t prev_sibling, next_sibling;
+    uint32_t size;
+    StringPool::id_t key;
+    StringPool::id_t value;
+    StringPool::id_t extra;
+    Kind kind;
+  };
+
+  static uint64_t edgeOf(node_t const parent, StringPool::id_t const key) {
+    return (static_cast<uint64_t>(parent) << 32) | key;
+  }
+
+  /**
+   * The child of the node, which will be created if not exists.
+   */
+  node_t child(node_t const node, const char* key, size_t const size);
+
+  node_t newNode(node_t const parent, StringPool::id_t const key);
+
+  void setData(node_t const node, const std::string& data);
+
+  void releaseData(node_t const node);
+
+  // the empty string is shared by all nodes without references counted
+  StringPool::id_t intern(const char* data, size_t const size);
+
+  void release(StringPool::id_t const id);
+
+  /**
+   * The fields of objects are the nodes under "data.<object id>".
+   */
+  bool isObjectField(node_t const node) const;
+
+  std::vector<node_data_t> nodes_;
+  std::vector<node_t> free_nodes_;
+  std::unordered_map<uint64_t, node_t> children_;
+  StringPool strings_;
+  StringPool::id_t empty_;
+  // the key of the "data" subtree
+  StringPool::id_t data_key_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_COMPACT_META_TREE_H_
@@ -0,0 +1,129 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/compact_value.h"
+
+#include <string>
+#include <utility>
+
+#include "common/util/compression.h"
+
+namespace vineyard {
+
+namespace {
+
+constexpr char kCompactMarker = 'c';
+constexpr char kCodecRaw = 'r';
+constexpr char kCodecZstd = 'z';
+
+// compressing small bodies doesn't pay for the frame of zstd
+constexpr size_t kMinCompressSize = 256;
+
+void put_varint(std::string& buffer, uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+bool get_varint(std::string const& buffer, size_t& offset, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && offset < buffer.size(); shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(buffer[offset++]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool get_string(std::string const& buffer, size_t& offset,
+                std::string& value) {
+  uint64_t size = 0;
+  if (!get_varint(buffer, offset, size) || size > buffer.size() - offset) {
+    return false;
+  }
+  value.assign(buffer, offset, size);
+  offset += size;
+  return true;
+}
+
+}  // namespace
+
+bool IsCompactValue(std::string const& value) {
+  return !value.empty() && value[0] == kCompactMarker;
+}
+
+void EncodeCompactValue(compact_fields_t const& fields, std::string& value) {
+  std::string body;
+  for (auto const& field : fields) {
+    put_varint(body, field.first.size());
+    body.append(field.first);
+    put_varint(body, field.second.size());
+    body.append(field.second);
+  }
+  std::string compressed;
+  bool compress =
+      body.size() >= kMinCompressSize &&
+      Compress("zstd", reinterpret_cast<const uint8_t*>(body.data()),
+               body.size(), compressed)
+          .ok() &&
+      compressed.size() < body.size();
+
+  value.clear();
+  value.push_back(kCompactMarker);
+  value.push_back(compress ? kCodecZstd : kCodecRaw);
+  put_varint(value, body.size());
+  value.append(compress ? compressed : body);
+}
+
+Status DecodeCompactValue(std::string const& value, compact_fields_t& fields) {
+  size_t offset = 2;
+  uint64_t size = 0;
+  if (value.size() < 2 || value[0] != kCompactMarker ||
+      !get_varint(value, offset, size)) {
+    return Status::Invalid("Invalid compact metadata value");
+  }
+  std::string body;
+  if (value[1] == kCodecRaw) {
+    body = value.substr(offset);
+  } else if (value[1] == kCodecZstd) {
+    body.resize(size);
+    RETURN_ON_ERROR(Decompress(
+        "zstd", reinterpret_cast<const uint8_t*>(value.data()) + offset,
+        value.size() - offset, reinterpret_cast<uint8_t*>(&body[0]), size));
+  } else {
+    return Status::Invalid("Unknown codec of compact metadata value: " +
+                           std::string(1, value[1]));
+  }
+  if (body.size() != size) {
+    return Status::Invalid("Corrupted compact metadata value");
+  }
+
+  fields.clear();
+  offset = 0;
+  while (offset < body.size()) {
+    std::string key, field;
+    if (!get_string(body, offset, key) || !get_string(body, offset, field)) {
+      return Status::Invalid("Corrupted compact metadata value");
+    }
+    fields.emplace_back(std::move(key), std::move(field));
+  }
+  return Status::OK();
+}
+
+}  // namespace vineyard
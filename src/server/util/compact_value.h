@@ -0,0 +1,55 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_COMPACT_VALUE_H_
+#define SRC_SERVER_UTIL_COMPACT_VALUE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief The compact value of an object carries all of its (encoded) fields
+ * in one value of the key "data.<object id>", instead of one key per field,
+ * i.e.,
+ *
+ *     'c' <codec> <varint size> <body>
+ *
+ * where the body is a sequence of `<varint length> <field name> <varint
+ * length> <encoded value>`, and the codec is 'z' if the body is compressed
+ * by zstd, or 'r' for the raw body, whose size is `<size>`.
+ *
+ * The encoded values of fields start with 'v' or 'l', thus compact values can
+ * be told apart from them.
+ */
+using compact_fields_t = std::vector<std::pair<std::string, std::string>>;
+
+bool IsCompactValue(std::string const& value);
+
+/**
+ * @brief Encode the fields, the body is compressed only if it is large enough
+ * and compression pays off, or kept raw if zstd is not available.
+ */
+void EncodeCompactValue(compact_fields_t const& fields, std::string& value);
+
+Status DecodeCompactValue(std::string const& value, compact_fields_t& fields);
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_COMPACT_VALUE_H_
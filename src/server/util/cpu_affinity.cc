@@ -0,0 +1,150 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/cpu_affinity.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace {
+
+Status parseCpuList(std::string const& cpulist, std::vector<int>& cpus) {
+  std::stringstream ss(cpulist);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    int first = 0, last = 0;
+    char tail = 0;
+    int matched = sscanf(range.c_str(), "%d-%d%c", &first, &last, &tail);
+    if (range.find_first_not_of("0123456789-") != std::string::npos) {
+      matched = 0;
+    }
+    if (matched == 1) {
+      last = first;
+    } else if (matched != 2) {
+      return Status::Invalid("Invalid CPU range '" + range + "' in '" +
+                             cpulist + "'");
+    }
+    if (first < 0 || last < first) {
+      return Status::Invalid("Invalid CPU range '" + range + "' in '" +
+                             cpulist + "'");
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.emplace_back(cpu);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ParseCpuSet(std::string const& spec, std::vector<int>& cpus) {
+  cpus.clear();
+  if (spec.empty()) {
+    return Status::OK();
+  }
+  const std::string numa_prefix = "numa:";
+  if (spec.compare(0, numa_prefix.size(), numa_prefix) == 0) {
+    std::vector<int> nodes;
+    RETURN_ON_ERROR(parseCpuList(spec.substr(numa_prefix.size()), nodes));
+    for (int const node : nodes) {
+      auto node_cpus = NumaNodeCpus(node);
+      if (node_cpus.empty()) {
+        return Status::Invalid("NUMA node " + std::to_string(node) +
+                               " doesn't exist on this host");
+      }
+      cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+    }
+  } else {
+    RETURN_ON_ERROR(parseCpuList(spec, cpus));
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  if (cpus.empty()) {
+    return Status::Invalid("No CPU is given by '" + spec + "'");
+  }
+  return Status::OK();
+}
+
+std::vector<int> NumaNodeCpus(const int node) {
+  std::vector<int> cpus;
+  if (node < 0) {
+    return cpus;
+  }
+  std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) +
+                   "/cpulist");
+  std::string cpulist;
+  if (!std::getline(in, cpulist) || !parseCpuList(cpulist, cpus).ok()) {
+    cpus.clear();
+  }
+  return cpus;
+}
+
+void PinCurrentThread(std::vector<int> const& cpus) {
+  if (cpus.empty()) {
+    return;
+  }
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int const cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpu_set);
+    }
+  }
+  if (CPU_COUNT(&cpu_set) > 0 &&
+      sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    LOG(WARNING) << "Failed to pin the thread to CPUs "
+                 << CpuSetToString(cpus) << ": " << strerror(errno);
+  }
+#else
+  LOG(WARNING) << "Pinning threads to CPUs is not supported on this platform";
+#endif
+}
+
+std::string CpuSetToString(std::vector<int> const& cpus) {
+  std::string result;
+  for (size_t index = 0; index < cpus.size();) {
+    size_t end = index + 1;
+    while (end < cpus.size() && cpus[end] == cpus[end - 1] + 1) {
+      end += 1;
+    }
+    if (!result.empty()) {
+      result += ",";
+    }
+    result += std::to_string(cpus[index]);
+    if (end - index > 1) {
+      result += "-" + std::to_string(cpus[end - 1]);
+    }
+    index = end;
+  }
+  return result;
+}
+
+}  // namespace vineyard
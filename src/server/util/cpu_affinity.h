@@ -0,0 +1,52 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_CPU_AFFINITY_H_
+#define SRC_SERVER_UTIL_CPU_AFFINITY_H_
+
+#include <string>
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief Parse the CPUs that a kind of threads of vineyardd is pinned to,
+ * which are either a CPU list in the format of `taskset -c` (e.g.,
+ * "0-3,8"), or the CPUs of the NUMA nodes (e.g., "numa:0" or "numa:0,1").
+ * The CPUs are empty if the spec is empty, i.e., the threads float.
+ */
+Status ParseCpuSet(std::string const& spec, std::vector<int>& cpus);
+
+/**
+ * @brief The CPUs of the NUMA node, empty if the node is unknown.
+ */
+std::vector<int> NumaNodeCpus(const int node);
+
+/**
+ * @brief Pin the calling thread to the CPUs, threads that it creates later
+ * inherit the affinity. No-op if the CPUs are empty.
+ */
+void PinCurrentThread(std::vector<int> const& cpus);
+
+/**
+ * @brief Format the CPUs as a CPU list, e.g., "0-3,8".
+ */
+std::string CpuSetToString(std::vector<int> const& cpus);
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_CPU_AFFINITY_H_
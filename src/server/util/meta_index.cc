@@ -0,0 +1,252 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/meta_index.h"
+
+#include <fnmatch.h>
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "boost/algorithm/string/predicate.hpp"
+
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace {
+
+constexpr char kDataPrefix[] = "data.";
+
+/**
+ * The longest literal prefix that every string matched by the pattern must
+ * start with.
+ */
+std::string literal_prefix(std::string const& pattern, bool const regex) {
+  if (!regex) {
+    return pattern.substr(0, pattern.find_first_of("*?[\\"));
+  }
+  if (pattern.find('|') != std::string::npos) {
+    return std::string();
+  }
+  size_t end = pattern.find_first_of(".[]()*+?{}^$\\");
+  if (end == std::string::npos) {
+    return pattern;
+  }
+  // the quantifier applies to the last literal character
+  if (end > 0 && (pattern[end] == '*' || pattern[end] == '?' ||
+                  pattern[end] == '{')) {
+    end -= 1;
+  }
+  return pattern.substr(0, end);
+}
+
+/**
+ * Split "data.<id>.<field>" into the object id and the field.
+ */
+bool parse_data_key(std::string const& key, ObjectID& id, std::string& field) {
+  if (!boost::algorithm::starts_with(key, kDataPrefix)) {
+    return false;
+  }
+  size_t begin = sizeof(kDataPrefix) - 1;
+  size_t end = key.find('.', begin);
+  if (end == std::string::npos) {
+    return false;
+  }
+  id = VYObjectIDFromString(key.substr(begin, end - begin));
+  field = key.substr(end + 1);
+  return true;
+}
+
+/**
+ * Values of object fields are prefixed with 'v', see also
+ * `meta_tree::encode_value`.
+ */
+bool decode_plain_value(std::string const& value, std::string& decoded) {
+  if (value.empty() || value[0] != 'v') {
+    return false;
+  }
+  decoded = value.substr(1);
+  return true;
+}
+
+}  // namespace
+
+ObjectID MetaIndex::Put(const std::string& key, const std::string& value) {
+  ObjectID id = InvalidObjectID();
+  std::string field, decoded;
+  if (!parse_data_key(key, id, field) || !decode_plain_value(value, decoded)) {
+    return InvalidObjectID();
+  }
+  if (field == "typename") {
+    if (setType(id, decoded)) {
+      return id;
+    }
+  } else if (field == "instance_id") {
+    try {
+      setInstance(id, std::stoull(decoded));
+    } catch (std::exception const&) {
+      LOG(WARNING) << "Invalid instance id for '" << key << "': " << decoded;
+    }
+  }
+  return InvalidObjectID();
+}
+
+void MetaIndex::EraseObject(ObjectID const id) {
+  auto iter = objects_.find(id);
+  if (iter == objects_.end()) {
+    return;
+  }
+  auto& object = iter->second;
+  if (object.type != types_.end()) {
+    object.type->second.erase(id);
+    if (object.type->second.empty()) {
+      types_.erase(object.type);
+    }
+  }
+  if (object.instance != instances_.end()) {
+    object.instance->second.erase(id);
+    if (object.instance->second.empty()) {
+      instances_.erase(object.instance);
+    }
+  }
+  objects_.erase(iter);
+}
+
+Status MetaIndex::List(std::string const& pattern, bool const regex,
+                       size_t const limit, std::string& cursor,
+                       std::vector<ObjectID>& objects) const {
+  if (limit == 0) {
+    return Status::OK();
+  }
+  std::regex regex_pattern;
+  if (regex) {
+    // pre-compile regex pattern, and for invalid regex pattern, return nothing.
+    try {
+      regex_pattern = std::regex(pattern);
+    } catch (std::regex_error const&) {
+      cursor.clear();
+      return Status::OK();
+    }
+  }
+
+  const std::string prefix = literal_prefix(pattern, regex);
+  auto begin = types_.lower_bound(prefix);
+  bool resume = false;
+  ObjectID resume_after = InvalidObjectID();
+  std::string resume_type;
+  if (!cursor.empty()) {
+    size_t sep = cursor.find(':');
+    RETURN_ON_ASSERT(sep != std::string::npos,
+                     "Invalid cursor for listing objects: " + cursor);
+    resume = true;
+    resume_after = VYObjectIDFromString(cursor.substr(0, sep));
+    resume_type = cursor.substr(sep + 1);
+    if (resume_type > prefix) {
+      begin = types_.lower_bound(resume_type);
+    }
+  }
+  cursor.clear();
+
+  for (auto type = begin; type != types_.end() &&
+                          boost::algorithm::starts_with(type->first, prefix);
+       ++type) {
+    // match once per typename, rather than once per object
+    bool matched = false;
+    if (regex) /* regex match */ {
+      matched = std::regex_match(type->first, regex_pattern);
+    } else /* wildcard match */ {
+      // https://www.man7.org/linux/man-pages/man3/fnmatch.3.html
+      matched = fnmatch(pattern.c_str(), type->first.c_str(), 0) == 0;
+    }
+    if (!matched) {
+      continue;
+    }
+    auto object = (resume && type->first == resume_type)
+                      ? type->second.upper_bound(resume_after)
+                      : type->second.begin();
+    for (; object != type->second.end(); ++object) {
+      if (objects.size() >= limit) {
+        cursor = VYObjectIDToString(objects.back()) + ":" +
+                 objects_.at(objects.back()).type->first;
+        return Status::OK();
+      }
+      objects.emplace_back(*object);
+    }
+  }
+  return Status::OK();
+}
+
+bool MetaIndex::TypeOf(ObjectID const id, std::string& type) const {
+  auto iter = objects_.find(id);
+  if (iter == objects_.end() || iter->second.type == types_.end()) {
+    return false;
+  }
+  type = iter->second.type->first;
+  return true;
+}
+
+void MetaIndex::FilterAtInstance(InstanceID const instance_id,
+                                 std::vector<ObjectID>& objects) const {
+  auto iter = instances_.find(instance_id);
+  if (iter != instances_.end()) {
+    objects.insert(objects.end(), iter->second.begin(), iter->second.end());
+  }
+}
+
+MetaIndex::object_t& MetaIndex::object(ObjectID const id) {
+  auto iter = objects_.find(id);
+  if (iter == objects_.end()) {
+    iter =
+        objects_.emplace(id, object_t{types_.end(), instances_.end()}).first;
+  }
+  return iter->second;
+}
+
+bool MetaIndex::setType(ObjectID const id, std::string const& type) {
+  object_t& target = object(id);
+  bool const created = target.type == types_.end();
+  if (!created) {
+    if (target.type->first == type) {
+      return false;
+    }
+    target.type->second.erase(id);
+    if (target.type->second.empty()) {
+      types_.erase(target.type);
+    }
+  }
+  target.type = types_.emplace(type, std::set<ObjectID>{}).first;
+  target.type->second.emplace(id);
+  return created;
+}
+
+void MetaIndex::setInstance(ObjectID const id, InstanceID const instance_id) {
+  object_t& target = object(id);
+  if (target.instance != instances_.end()) {
+    if (target.instance->first == instance_id) {
+      return;
+    }
+    target.instance->second.erase(id);
+    if (target.instance->second.empty()) {
+      instances_.erase(target.instance);
+    }
+  }
+  target.instance =
+      instances_.emplace(instance_id, std::set<ObjectID>{}).first;
+  target.instance->second.emplace(id);
+}
+
+}  // namespace vineyard
@@ -0,0 +1,111 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_META_INDEX_H_
+#define SRC_SERVER_UTIL_META_INDEX_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief MetaIndex maintains secondary indexes of the metadata tree, i.e.,
+ * objects by typename and objects by instance id, to answer `ListData`
+ * queries and instance cleanups without scanning every object.
+ *
+ * The index is updated incrementally with the key-value operations that are
+ * applied to the metadata tree in `IMetaService::metaUpdate`.
+ */
+class MetaIndex {
+ public:
+  MetaIndex() = default;
+  MetaIndex(const MetaIndex&) = delete;
+  MetaIndex& operator=(const MetaIndex&) = delete;
+
+  /**
+   * @brief Index the key of a put operation, keys other than
+   * "data.<id>.typename" and "data.<id>.instance_id" are ignored.
+   *
+   * @return The object id if the key is the first typename of the object,
+   * i.e., the object has just been created, otherwise `InvalidObjectID()`.
+   */
+  ObjectID Put(const std::string& key, const std::string& value);
+
+  /**
+   * @brief Drop the object when the last key of it has been deleted.
+   */
+  void EraseObject(ObjectID const id);
+
+  /**
+   * @brief List objects whose typename matches the glob (or regex) pattern,
+   * in the order of (typename, object id).
+   *
+   * The listing starts after the cursor (or from the beginning when the
+   * cursor is empty), and at most `limit` objects are returned. The cursor
+   * is updated to the position of the last returned object if there are more
+   * matched objects, otherwise it is cleared.
+   */
+  Status List(std::string const& pattern, bool const regex, size_t const limit,
+              std::string& cursor, std::vector<ObjectID>& objects) const;
+
+  /**
+   * @brief The objects that are located at the given instance.
+   */
+  void FilterAtInstance(InstanceID const instance_id,
+                        std::vector<ObjectID>& objects) const;
+
+  /**
+   * @brief The typename of the object, returns false if the object hasn't
+   * been indexed with a typename.
+   */
+  bool TypeOf(ObjectID const id, std::string& type) const;
+
+  size_t Objects() const { return objects_.size(); }
+
+  size_t Types() const { return types_.size(); }
+
+ private:
+  // the sorted map acts as the trie of typenames: objects of types that
+  // share the literal prefix of a pattern are adjacent.
+  using types_t = std::map<std::string, std::set<ObjectID>>;
+  using instances_t = std::map<InstanceID, std::set<ObjectID>>;
+
+  struct object_t {
+    types_t::iterator type;
+    instances_t::iterator instance;
+  };
+
+  object_t& object(ObjectID const id);
+
+  // returns true if the object didn't have a typename
+  bool setType(ObjectID const id, std::string const& type);
+
+  void setInstance(ObjectID const id, InstanceID const instance_id);
+
+  types_t types_;
+  instances_t instances_;
+  std::unordered_map<ObjectID, object_t> objects_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_META_INDEX_H_
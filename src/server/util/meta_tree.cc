@@ -15,14 +15,14 @@ limitations under the License.
 
 #include "server/util/meta_tree.h"
 
-#include <fnmatch.h>
-
-#include <regex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "boost/lexical_cast.hpp"
 
+#include "server/util/compact_value.h"
+
 namespace boost {
 // Makes the behaviour of lexical_cast compatibile with boost::property_tree.
 template <>
@@ -106,58 +106,94 @@ static void generate_link(const std::string& type, const std::string& name,
   link = name + "." + type.substr(0, type.find_first_of('<'));
 }
 
-static Status get_sub_tree(const ptree& tree, const std::string& prefix,
-                           const std::string& name, ptree& sub_tree) {
+using node_t = CompactMetaTree::node_t;
+
+/**
+ * Find the metadata of the object in the "data" subtree.
+ */
+static Status get_object(const CompactMetaTree& tree, const std::string& name,
+                         node_t& node) {
   if (name.find('.') != std::string::npos) {
     LOG(ERROR) << "meta tree name invalid. " << name;
     return Status::MetaTreeNameInvalid();
   }
-  std::string path = prefix;
-  if (!name.empty()) {
-    path += "." + name;
-  }
-  boost::optional<const ptree&> tmp_tree_op = tree.get_child_optional(path);
-  if (tmp_tree_op && !tmp_tree_op->empty()) {
-    sub_tree = *tmp_tree_op;
-    return Status::OK();
-  } else {
-    return Status::MetaTreeSubtreeNotExists();
+  node_t data = tree.Child(CompactMetaTree::kRoot, "data");
+  if (data != CompactMetaTree::kNotFound) {
+    node = tree.Child(data, name);
+    if (node != CompactMetaTree::kNotFound && !tree.Empty(node)) {
+      return Status::OK();
+    }
   }
+  node = CompactMetaTree::kNotFound;
+  return Status::MetaTreeSubtreeNotExists();
 }
 
-static bool has_sub_tree(const ptree& tree, const std::string& prefix,
-                         const std::string& name) {
+static bool has_object(const CompactMetaTree& tree, const std::string& name) {
   if (name.find('.') != std::string::npos) {
     return false;
   }
-  std::string path = prefix;
-  if (!name.empty()) {
-    path += "." + name;
-  }
-  return static_cast<bool>(tree.get_child_optional(path));
+  node_t data = tree.Child(CompactMetaTree::kRoot, "data");
+  return data != CompactMetaTree::kNotFound &&
+         tree.Child(data, name) != CompactMetaTree::kNotFound;
 }
 
-static Status del_sub_tree(ptree& tree, const std::string& prefix,
-                           const std::string& name) {
+static Status del_object(CompactMetaTree& tree, const std::string& name) {
   if (name.find('.') != std::string::npos) {
     LOG(ERROR) << "meta tree name invalid. " << name;
     return Status::MetaTreeNameInvalid();
   }
-  std::string path = prefix;
-  boost::optional<ptree&> tmp_tree_op = tree.get_child_optional(path);
-  if (tmp_tree_op) {
-    boost::optional<ptree&> node_op = tmp_tree_op->get_child_optional(name);
-    if (node_op) {
-      tmp_tree_op->erase(name);
-      return Status::OK();
-    } else {
-      LOG(ERROR) << "meta tree name doesn't exist: " << name;
-      return Status::MetaTreeNameNotExists();
-    }
-  } else {
-    LOG(ERROR) << "meta tree subtree doesn't exist." << path;
+  node_t data = tree.Child(CompactMetaTree::kRoot, "data");
+  if (data == CompactMetaTree::kNotFound) {
+    LOG(ERROR) << "meta tree subtree doesn't exist: data";
     return Status::MetaTreeSubtreeNotExists();
   }
+  node_t node = tree.Child(data, name);
+  if (node == CompactMetaTree::kNotFound) {
+    LOG(ERROR) << "meta tree name doesn't exist: " << name;
+    return Status::MetaTreeNameNotExists();
+  }
+  tree.Erase(node);
+  return Status::OK();
+}
+
+/**
+ * The same as `decode_value`, but on the typed field of the compact tree.
+ */
+static void decode_field(const CompactMetaTree& tree, node_t const node,
+                         NodeType& type, std::string& value) {
+  switch (tree.GetKind(node)) {
+  case CompactMetaTree::Kind::Value:
+    type = NodeType::Value;
+    value = tree.Value(node);
+    break;
+  case CompactMetaTree::Kind::Link:
+    type = NodeType::Link;
+    value = tree.Data(node).substr(1);
+    break;
+  default:
+    type = NodeType::InvalidType;
+    value.clear();
+  }
+}
+
+/**
+ * Get the plain value of the field of object, fails if the field doesn't
+ * exist or isn't a plain value.
+ */
+static Status get_field_value(const CompactMetaTree& tree, node_t const node,
+                              const std::string& field, std::string& value) {
+  node_t field_node = tree.Child(node, field);
+  if (field_node == CompactMetaTree::kNotFound) {
+    return Status::MetaTreeNameNotExists();
+  }
+  if (!tree.Empty(field_node) ||
+      tree.GetKind(field_node) != CompactMetaTree::Kind::Value) {
+    LOG(ERROR) << "meta tree " << field
+               << " invalid: " << tree.Data(field_node);
+    return Status::MetaTreeTypeInvalid();
+  }
+  value = tree.Value(field_node);
+  return Status::OK();
 }
 
 static Status get_name(const ptree& tree, std::string& name) {
@@ -215,41 +251,40 @@ static bool is_meta_placeholder(const ptree& tree) {
 /**
  * Get metadata for an object "recursively".
  */
-Status GetData(const ptree& tree, const ObjectID id, ptree& sub_tree) {
+Status GetData(const CompactMetaTree& tree, const ObjectID id,
+               ptree& sub_tree) {
   return GetData(tree, VYObjectIDToString(id), sub_tree);
 }
 
 /**
  * Get metadata for an object "recursively".
  */
-Status GetData(const ptree& tree, const std::string& name, ptree& sub_tree) {
-  ptree tmp_tree;
+Status GetData(const CompactMetaTree& tree, const std::string& name,
+               ptree& sub_tree) {
+  node_t node = CompactMetaTree::kNotFound;
   sub_tree.clear();
-  Status status = get_sub_tree(tree, "data", name, tmp_tree);
+  Status status = get_object(tree, name, node);
   if (!status.ok()) {
     return status;
   }
-  for (ptree::iterator it = tmp_tree.begin(); it != tmp_tree.end(); ++it) {
-    NodeType type;
-    std::string value;
-    decode_value(it->second.data(), type, value);
-    if (type == NodeType::Value) {
-      sub_tree.put(it->first, value);
-    } else if (type == NodeType::Link) {
-      std::string sub_sub_tree_type, sub_sub_tree_name;
-      status = parse_link(value, sub_sub_tree_type, sub_sub_tree_name);
-      if (!status.ok()) {
+  for (node_t field : tree.ChildrenOf(node)) {
+    auto kind = tree.GetKind(field);
+    if (kind == CompactMetaTree::Kind::Value) {
+      sub_tree.put(tree.Key(field), tree.Value(field));
+    } else if (kind == CompactMetaTree::Kind::Link) {
+      if (tree.LinkType(field).empty()) {
+        LOG(ERROR) << "meta tree link invalid: " << tree.Value(field);
         sub_tree.clear();
-        return status;
+        return Status::MetaTreeLinkInvalid();
       }
       ptree sub_sub_tree;
-      status =
-          GetData(tree, VYObjectIDFromString(sub_sub_tree_name), sub_sub_tree);
+      status = GetData(tree, VYObjectIDFromString(tree.Value(field)),
+                       sub_sub_tree);
       if (!status.ok()) {
         sub_tree.clear();
         return status;
       }
-      sub_tree.add_child(it->first, sub_sub_tree);
+      sub_tree.add_child(tree.Key(field), sub_sub_tree);
     } else {
       return Status::MetaTreeTypeInvalid();
     }
@@ -258,61 +293,25 @@ Status GetData(const ptree& tree, const std::string& name, ptree& sub_tree) {
   return Status::OK();
 }
 
-Status ListData(const ptree& tree, std::string const& pattern, bool const regex,
-                size_t const limit, ptree& tree_group) {
-  auto metas = tree.get_child_optional("data");
-  if (!metas) {
-    return Status::OK();
-  }
-
-  size_t found = 0;
-
-  std::regex regex_pattern;
-  if (regex) {
-    // pre-compile regex pattern, and for invalid regex pattern, return nothing.
-    try {
-      regex_pattern = std::regex(pattern);
-    } catch (std::regex_error const&) { return Status::OK(); }
-  }
-
-  for (auto iter = metas->begin(); iter != metas->end(); ++iter) {
-    if (found >= limit) {
-      break;
-    }
-
-    if (iter->second.empty()) {
-      LOG(INFO) << "Object meta shouldn't be empty";
-      return Status::MetaTreeInvalid();
-    }
-    std::string type;
-    RETURN_ON_ERROR(get_type(iter->second, type, true));
-
-    // match type on pattern
-    bool matched = false;
-    if (regex) /* regex match */ {
-      std::cmatch __m;
-      matched = std::regex_match(type.c_str(), __m, regex_pattern);
-    } else /* wildcard match */ {
-      // https://www.man7.org/linux/man-pages/man3/fnmatch.3.html
-      matched = fnmatch(pattern.c_str(), type.c_str(), 0) == 0;
-    }
-
-    if (matched) {
-      found += 1;
-      ptree object_meta_tree;
-      RETURN_ON_ERROR(GetData(tree, iter->first, object_meta_tree));
-      tree_group.add_child(iter->first, object_meta_tree);
-    }
+Status ListData(const CompactMetaTree& tree, const MetaIndex& index,
+                std::string const& pattern, bool const regex,
+                size_t const limit, std::string& cursor, ptree& tree_group) {
+  std::vector<ObjectID> objects;
+  RETURN_ON_ERROR(index.List(pattern, regex, limit, cursor, objects));
+  for (auto const& id : objects) {
+    ptree object_meta_tree;
+    RETURN_ON_ERROR(GetData(tree, id, object_meta_tree));
+    tree_group.add_child(VYObjectIDToString(id), object_meta_tree);
   }
   return Status::OK();
 }
 
-Status DelData(ptree& tree, const ObjectID id) {
+Status DelData(CompactMetaTree& tree, const ObjectID id) {
   std::string name = VYObjectIDToString(id);
-  return del_sub_tree(tree, "data", name);
+  return del_object(tree, name);
 }
 
-Status DelData(ptree& tree, const std::vector<ObjectID>& ids) {
+Status DelData(CompactMetaTree& tree, const std::vector<ObjectID>& ids) {
   // FIXME: use a more efficient implmentation.
   for (auto const& id : ids) {
     auto s = DelData(tree, id);
@@ -323,12 +322,12 @@ Status DelData(ptree& tree, const std::vector<ObjectID>& ids) {
   return Status::OK();
 }
 
-Status DelDataOps(const ptree& tree, const ObjectID id,
+Status DelDataOps(const CompactMetaTree& tree, const ObjectID id,
                   std::vector<IMetaService::op_t>& ops) {
   return DelDataOps(tree, VYObjectIDToString(id), ops);
 }
 
-Status DelDataOps(const ptree& tree, const std::set<ObjectID>& ids,
+Status DelDataOps(const CompactMetaTree& tree, const std::set<ObjectID>& ids,
                   std::vector<IMetaService::op_t>& ops) {
   // FIXME: use a more efficient implmentation.
   for (auto const& id : ids) {
@@ -340,19 +339,17 @@ Status DelDataOps(const ptree& tree, const std::set<ObjectID>& ids,
   return Status::OK();
 }
 
-Status DelDataOps(const ptree& tree, const std::string& name,
+Status DelDataOps(const CompactMetaTree& tree, const std::string& name,
                   std::vector<IMetaService::op_t>& ops) {
   std::string data_prefix = "data";
-  boost::optional<const ptree&> data_tree_optional =
-      tree.get_child_optional(data_prefix);
-  if (data_tree_optional) {
-    boost::optional<const ptree&> node_op =
-        data_tree_optional->get_child_optional(name);
-    if (node_op) {
+  node_t data_tree = tree.Child(CompactMetaTree::kRoot, data_prefix);
+  if (data_tree != CompactMetaTree::kNotFound) {
+    node_t node = tree.Child(data_tree, name);
+    if (node != CompactMetaTree::kNotFound) {
       // erase from etcd
       std::string key_prefix = data_prefix + "." + name + ".";
-      for (auto it = node_op->begin(); it != node_op->end(); ++it) {
-        ops.emplace_back(IMetaService::op_t::Del(key_prefix + it->first));
+      for (node_t field : tree.ChildrenOf(node)) {
+        ops.emplace_back(IMetaService::op_t::Del(key_prefix + tree.Key(field)));
       }
       // ensure the node will be erased from in-server ptree correctly.
       ops.emplace_back(IMetaService::op_t::Del(data_prefix + "." + name));
@@ -362,7 +359,22 @@ Status DelDataOps(const ptree& tree, const std::string& name,
   return Status::MetaTreeSubtreeNotExists();
 }
 
-static void generate_put_ops(const ptree& meta, const ptree& diff,
+void DelDataPrefixOps(const CompactMetaTree& tree,
+                      const std::set<ObjectID>& ids,
+                      std::vector<IMetaService::op_t>& ops) {
+  node_t data_tree = tree.Child(CompactMetaTree::kRoot, "data");
+  if (data_tree == CompactMetaTree::kNotFound) {
+    return;
+  }
+  for (auto const& id : ids) {
+    std::string name = VYObjectIDToString(id);
+    if (tree.Child(data_tree, name) != CompactMetaTree::kNotFound) {
+      ops.emplace_back(IMetaService::op_t::DelPrefix("data." + name));
+    }
+  }
+}
+
+static void generate_put_ops(const CompactMetaTree& meta, const ptree& diff,
                              const std::string& name,
                              std::vector<IMetaService::op_t>& ops) {
   std::string key_prefix = "data." + name + ".";
@@ -370,7 +382,7 @@ static void generate_put_ops(const ptree& meta, const ptree& diff,
     if (!it->second.empty()) {
       std::string sub_type, sub_name;
       VINEYARD_SUPPRESS(get_type_name(it->second, sub_type, sub_name));
-      if (!has_sub_tree(meta, "data", name)) {
+      if (!has_object(meta, name)) {
         generate_put_ops(meta, it->second, sub_name, ops);
       }
       std::string link;
@@ -392,20 +404,34 @@ static void generate_put_ops(const ptree& meta, const ptree& diff,
   }
 }
 
+/**
+ * The diff of persisting is made up of whole (transient) objects, thus with
+ * `compact`, the fields of every object are put as one compact value of the
+ * key "data.<name>", see also `EncodeCompactValue`.
+ */
 static void generate_persist_ops(const ptree& diff, const std::string& name,
-                                 std::vector<IMetaService::op_t>& ops) {
+                                 std::vector<IMetaService::op_t>& ops,
+                                 bool const compact) {
   std::string key_prefix = "data." + name + ".";
+  compact_fields_t fields;
+  auto put_field = [&](std::string const& field, std::string& encoded_value) {
+    if (compact) {
+      fields.emplace_back(field, std::move(encoded_value));
+    } else {
+      ops.emplace_back(
+          IMetaService::op_t::Put(key_prefix + field, encoded_value));
+    }
+  };
   for (ptree::const_iterator it = diff.begin(); it != diff.end(); ++it) {
     if (!it->second.empty()) {
       std::string sub_type, sub_name;
       VINEYARD_SUPPRESS(get_type_name(it->second, sub_type, sub_name));
-      generate_persist_ops(it->second, sub_name, ops);
+      generate_persist_ops(it->second, sub_name, ops, compact);
       std::string link;
       generate_link(sub_type, sub_name, link);
       std::string encoded_value;
       encode_value(NodeType::Link, link, encoded_value);
-      ops.emplace_back(
-          IMetaService::op_t::Put(key_prefix + it->first, encoded_value));
+      put_field(it->first, encoded_value);
     } else {
       // don't repeat "id" in the etcd kvs.
       if (it->first == "id") {
@@ -413,10 +439,14 @@ static void generate_persist_ops(const ptree& diff, const std::string& name,
       }
       std::string encoded_value;
       encode_value(NodeType::Value, it->second.data(), encoded_value);
-      ops.emplace_back(
-          IMetaService::op_t::Put(key_prefix + it->first, encoded_value));
+      put_field(it->first, encoded_value);
     }
   }
+  if (compact && !fields.empty()) {
+    std::string value;
+    EncodeCompactValue(fields, value);
+    ops.emplace_back(IMetaService::op_t::Put("data." + name, value));
+  }
 }
 
 /**
@@ -426,12 +456,12 @@ static void generate_persist_ops(const ptree& diff, const std::string& name,
  *  instance_id: instance_id of members and the object itself, can represents
  *               the final instance_id of the object.
  */
-static Status diff_data_meta_tree(const ptree& meta,
+static Status diff_data_meta_tree(const CompactMetaTree& meta,
                                   const std::string& sub_tree_name,
                                   const ptree& sub_tree, ptree& diff,
                                   InstanceID& instance_id) {
-  ptree old_sub_tree;
-  Status status = get_sub_tree(meta, "data", sub_tree_name, old_sub_tree);
+  node_t old_sub_tree = CompactMetaTree::kNotFound;
+  Status status = get_object(meta, sub_tree_name, old_sub_tree);
 
   if (!status.ok()) {
     if (status.IsMetaTreeSubtreeNotExists()) {
@@ -446,16 +476,14 @@ static Status diff_data_meta_tree(const ptree& meta,
   if (is_meta_placeholder(sub_tree)) {
     if (status.ok()) {
       std::string sub_tree_type;
-      RETURN_ON_ERROR(get_type(old_sub_tree, sub_tree_type, true));
+      RETURN_ON_ERROR(
+          get_field_value(meta, old_sub_tree, "typename", sub_tree_type));
       diff.put("id", sub_tree_name);
       diff.put("typename", sub_tree_type);
       {
-        const std::string& instance_id_string =
-            old_sub_tree.get<std::string>("instance_id");
-        NodeType instance_id_value_type;
         std::string instance_id_decoded;
-        decode_value(instance_id_string, instance_id_value_type,
-                     instance_id_decoded);
+        RETURN_ON_ERROR(get_field_value(meta, old_sub_tree, "instance_id",
+                                        instance_id_decoded));
         instance_id = boost::lexical_cast<InstanceID>(instance_id_decoded);
       }
     }
@@ -478,12 +506,11 @@ static Status diff_data_meta_tree(const ptree& meta,
     if (it->second.empty() /* plain value */) {
       std::string new_value = it->second.data();
       if (status.ok() /* old meta exists */) {
-        boost::optional<std::string> old_value =
-            old_sub_tree.get_optional<std::string>(it->first);
-        if (old_value) {
+        node_t old_value = meta.Find(old_sub_tree, it->first);
+        if (old_value != CompactMetaTree::kNotFound) {
           NodeType old_value_type;
           std::string old_value_decoded;
-          decode_value(*old_value, old_value_type, old_value_decoded);
+          decode_field(meta, old_value, old_value_type, old_value_decoded);
 
           bool require_update = false;
           if (it->first == "transient") {
@@ -514,10 +541,10 @@ static Status diff_data_meta_tree(const ptree& meta,
       const ptree& sub_sub_tree = it->second;
 
       // original corresponding field must be a member not a key-value
-      auto mb_old_sub_sub_tree = old_sub_tree.find(it->first);
       if (status.ok() /* old meta exists */) {
-        if (mb_old_sub_sub_tree != old_sub_tree.not_found() &&
-            !is_link_node(mb_old_sub_sub_tree->second.data())) {
+        node_t old_sub_sub_tree = meta.Child(old_sub_tree, it->first);
+        if (old_sub_sub_tree != CompactMetaTree::kNotFound &&
+            meta.GetKind(old_sub_sub_tree) != CompactMetaTree::Kind::Link) {
           return Status::MetaTreeInvalid();
         }
       }
@@ -595,8 +622,8 @@ static void persist_meta_tree(const ptree& sub_tree, ptree& diff) {
   }
 }
 
-Status PutDataOps(const ptree& tree, const ObjectID id, const ptree& sub_tree,
-                  std::vector<IMetaService::op_t>& ops,
+Status PutDataOps(const CompactMetaTree& tree, const ObjectID id,
+                  const ptree& sub_tree, std::vector<IMetaService::op_t>& ops,
                   InstanceID& computed_instance_id) {
   ptree diff;
   std::string name = VYObjectIDToString(id);
@@ -616,8 +643,8 @@ Status PutDataOps(const ptree& tree, const ObjectID id, const ptree& sub_tree,
   return Status::OK();
 }
 
-Status PersistOps(const ptree& tree, const ObjectID id,
-                  std::vector<IMetaService::op_t>& ops) {
+Status PersistOps(const CompactMetaTree& tree, const ObjectID id,
+                  std::vector<IMetaService::op_t>& ops, bool const compact) {
   ptree sub_tree, diff;
   Status status = GetData(tree, id, sub_tree);
   if (!status.ok()) {
@@ -630,72 +657,52 @@ Status PersistOps(const ptree& tree, const ObjectID id,
   }
 
   std::string name = VYObjectIDToString(id);
-  generate_persist_ops(diff, name, ops);
+  generate_persist_ops(diff, name, ops, compact);
   return Status::OK();
 }
 
-Status Exists(const ptree& tree, const ObjectID id, bool& exists) {
+Status Exists(const CompactMetaTree& tree, const ObjectID id, bool& exists) {
   std::string name = VYObjectIDToString(id);
-  exists = has_sub_tree(tree, "data", name);
+  exists = has_object(tree, name);
   return Status::OK();
 }
 
-Status ShallowCopyOps(const ptree& tree, const ObjectID id,
+Status ShallowCopyOps(const CompactMetaTree& tree, const ObjectID id,
                       const ObjectID target,
                       std::vector<IMetaService::op_t>& ops, bool& transient) {
   std::string name = VYObjectIDToString(id);
-  ptree tmp_tree;
-  RETURN_ON_ERROR(get_sub_tree(tree, "data", name, tmp_tree));
-  NodeType field_type;
-  std::string field_value;
-  decode_value(tmp_tree.get<std::string>("transient"), field_type, field_value);
-  RETURN_ON_ASSERT(field_type == NodeType::Value,
+  node_t node = CompactMetaTree::kNotFound;
+  RETURN_ON_ERROR(get_object(tree, name, node));
+  node_t transient_node = tree.Child(node, "transient");
+  RETURN_ON_ASSERT(transient_node != CompactMetaTree::kNotFound &&
+                       tree.GetKind(transient_node) ==
+                           CompactMetaTree::Kind::Value,
                    "The 'transient' should a plain value");
-  transient = boost::lexical_cast<bool>(field_value);
+  transient = boost::lexical_cast<bool>(tree.Value(transient_node));
   std::string key_prefix = "data." + VYObjectIDToString(target) + ".";
-  for (auto const& kv : tmp_tree) {
-    ops.emplace_back(
-        IMetaService::op_t::Put(key_prefix + kv.first, kv.second.data()));
+  for (node_t field : tree.ChildrenOf(node)) {
+    ops.emplace_back(IMetaService::op_t::Put(key_prefix + tree.Key(field),
+                                             tree.Data(field)));
   }
   return Status::OK();
 }
 
-Status IfPersist(const ptree& tree, const ObjectID id, bool& persist) {
+Status IfPersist(const CompactMetaTree& tree, const ObjectID id,
+                 bool& persist) {
   std::string name = VYObjectIDToString(id);
-  ptree tmp_tree;
-  Status status = get_sub_tree(tree, "data", name, tmp_tree);
+  node_t node = CompactMetaTree::kNotFound;
+  Status status = get_object(tree, name, node);
   if (status.ok()) {
-    NodeType field_type;
-    std::string field_value;
-    decode_value(tmp_tree.get<std::string>("transient"), field_type,
-                 field_value);
-    RETURN_ON_ASSERT(field_type == NodeType::Value,
+    node_t transient_node = tree.Child(node, "transient");
+    RETURN_ON_ASSERT(transient_node != CompactMetaTree::kNotFound &&
+                         tree.GetKind(transient_node) ==
+                             CompactMetaTree::Kind::Value,
                      "The 'transient' should a plain value");
-    persist = !boost::lexical_cast<bool>(field_value);
+    persist = !boost::lexical_cast<bool>(tree.Value(transient_node));
   }
   return status;
 }
 
-Status FilterAtInstance(const ptree& tree, const InstanceID& instance_id,
-                        std::vector<ObjectID>& objects) {
-  std::string instance_id_value;
-  encode_value(NodeType::Value, std::to_string(instance_id), instance_id_value);
-  auto mb_datatree = tree.get_child_optional("data");
-  if (mb_datatree) {
-    auto& datatree = mb_datatree.get();
-    for (auto it = datatree.begin(); it != datatree.end(); ++it) {
-      if (!it->second.empty()) {
-        auto mb_instance_id =
-            it->second.get_optional<std::string>("instance_id");
-        if (mb_instance_id && mb_instance_id.get() == instance_id_value) {
-          objects.emplace_back(VYObjectIDFromString(it->first));
-        }
-      }
-    }
-  }
-  return Status::OK();
-}
-
 Status DecodeObjectID(const std::string& value, ObjectID& object_id) {
   meta_tree::NodeType type;
   std::string link_value;
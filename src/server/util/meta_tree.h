@@ -21,6 +21,8 @@ limitations under the License.
 #include <vector>
 
 #include "server/services/meta_service.h"
+#include "server/util/compact_meta_tree.h"
+#include "server/util/meta_index.h"
 
 namespace vineyard {
 
@@ -32,38 +34,53 @@ enum class NodeType {
   InvalidType = 15,
 };
 
-Status GetData(const ptree& tree, const ObjectID id, ptree& sub_tree);
-Status GetData(const ptree& tree, const std::string& name, ptree& sub_tree);
-Status ListData(const ptree& tree, const std::string& pattern, bool const regex,
-                size_t const limit, ptree& tree_group);
-Status DelData(ptree& tree, const ObjectID id);
-Status DelData(ptree& tree, const std::vector<ObjectID>& ids);
-Status IfPersist(const ptree& tree, const ObjectID id, bool& persist);
-Status Exists(const ptree& tree, const ObjectID id, bool& exists);
+Status GetData(const CompactMetaTree& tree, const ObjectID id,
+               ptree& sub_tree);
+Status GetData(const CompactMetaTree& tree, const std::string& name,
+               ptree& sub_tree);
+Status ListData(const CompactMetaTree& tree, const MetaIndex& index,
+                std::string const& pattern, bool const regex,
+                size_t const limit, std::string& cursor, ptree& tree_group);
+Status DelData(CompactMetaTree& tree, const ObjectID id);
+Status DelData(CompactMetaTree& tree, const std::vector<ObjectID>& ids);
+Status IfPersist(const CompactMetaTree& tree, const ObjectID id,
+                 bool& persist);
+Status Exists(const CompactMetaTree& tree, const ObjectID id, bool& exists);
+
+Status PutDataOps(const CompactMetaTree& tree, const ObjectID id,
+                  const ptree& sub_tree, std::vector<IMetaService::op_t>& ops,
+                  InstanceID& computed_instance_id);
 
-Status PutDataOps(const ptree& tree, const ObjectID id, const ptree& sub_tree,
+/**
+ * With `compact`, every object is put as one compact value rather than one
+ * key per field, see also `EncodeCompactValue`.
+ */
+Status PersistOps(const CompactMetaTree& tree, const ObjectID id,
                   std::vector<IMetaService::op_t>& ops,
-                  InstanceID& computed_instance_id);
+                  bool const compact = false);
 
-Status PersistOps(const ptree& tree, const ObjectID id,
+Status DelDataOps(const CompactMetaTree& tree, const ObjectID id,
                   std::vector<IMetaService::op_t>& ops);
 
-Status DelDataOps(const ptree& tree, const ObjectID id,
+Status DelDataOps(const CompactMetaTree& tree, const std::set<ObjectID>& ids,
                   std::vector<IMetaService::op_t>& ops);
 
-Status DelDataOps(const ptree& tree, const std::set<ObjectID>& ids,
+Status DelDataOps(const CompactMetaTree& tree, const std::string& name,
                   std::vector<IMetaService::op_t>& ops);
 
-Status DelDataOps(const ptree& tree, const std::string& name,
-                  std::vector<IMetaService::op_t>& ops);
+/**
+ * @brief Delete the objects that exist in the tree by a range deletion per
+ * object, rather than a deletion per field, the objects that don't exist
+ * are skipped.
+ */
+void DelDataPrefixOps(const CompactMetaTree& tree,
+                      const std::set<ObjectID>& ids,
+                      std::vector<IMetaService::op_t>& ops);
 
-Status ShallowCopyOps(const ptree& tree, const ObjectID id,
+Status ShallowCopyOps(const CompactMetaTree& tree, const ObjectID id,
                       const ObjectID target,
                       std::vector<IMetaService::op_t>& ops, bool& transient);
 
-Status FilterAtInstance(const ptree& tree, const InstanceID& instance_id,
-                        std::vector<ObjectID>& objects);
-
 Status DecodeObjectID(const std::string& value, ObjectID& object_id);
 
 }  // namespace meta_tree
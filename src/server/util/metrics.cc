@@ -0,0 +1,264 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+
+namespace vineyard {
+
+constexpr int LatencyHistogram::kSubBucketBits;
+constexpr size_t LatencyHistogram::kBuckets;
+constexpr size_t Metrics::kCommandSlots;
+
+namespace {
+
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+void dump_histogram(const LatencyHistogram& histogram, ptree& tree) {
+  tree.put("count", histogram.Count());
+  tree.put("sum", histogram.Sum());
+  tree.put("max", histogram.Max());
+  tree.put("p50", histogram.Percentile(0.5));
+  tree.put("p99", histogram.Percentile(0.99));
+  tree.put("p999", histogram.Percentile(0.999));
+}
+
+void dump_summary(const LatencyHistogram& histogram, std::string const& name,
+                  std::string const& labels, std::ostream& os) {
+  std::string separator = labels.empty() ? "" : ",";
+  for (double quantile : kQuantiles) {
+    os << name << "{" << labels << separator << "quantile=\"" << quantile
+       << "\"} " << histogram.Percentile(quantile) << "\n";
+  }
+  std::string braced = labels.empty() ? "" : "{" + labels + "}";
+  os << name << "_sum" << braced << " " << histogram.Sum() << "\n";
+  os << name << "_count" << braced << " " << histogram.Count() << "\n";
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : count_(0), sum_(0), max_(0) {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::Record(uint64_t const value) {
+  buckets_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max &&
+         !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::Percentile(double const percentile) const {
+  uint64_t count = Count();
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t target = static_cast<uint64_t>(
+      std::ceil(std::min(std::max(percentile, 0.0), 1.0) * count));
+  target = std::max<uint64_t>(target, 1);
+  uint64_t accumulated = 0;
+  for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+    accumulated += buckets_[bucket].load(std::memory_order_relaxed);
+    if (accumulated >= target) {
+      return std::min(upperBoundOf(bucket), Max());
+    }
+  }
+  return Max();
+}
+
+size_t LatencyHistogram::bucketOf(uint64_t const value) {
+  constexpr uint64_t sub_buckets = 1 << kSubBucketBits;
+  if (value < sub_buckets) {
+    return value;
+  }
+  int msb = 63 - __builtin_clzll(value);
+  int shift = msb - kSubBucketBits;
+  return ((shift + 1) << kSubBucketBits) +
+         ((value >> shift) & (sub_buckets - 1));
+}
+
+uint64_t LatencyHistogram::upperBoundOf(size_t const bucket) {
+  constexpr uint64_t sub_buckets = 1 << kSubBucketBits;
+  if (bucket < sub_buckets) {
+    return bucket;
+  }
+  int shift = static_cast<int>(bucket >> kSubBucketBits) - 1;
+  uint64_t lower = (sub_buckets + (bucket & (sub_buckets - 1))) << shift;
+  return lower + ((1ULL << shift) - 1);
+}
+
+std::shared_ptr<void> Metrics::TrackRequest() {
+  inflight_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic<size_t>* inflight = &inflight_;
+  return std::shared_ptr<void>(nullptr, [inflight](void*) {
+    inflight->fetch_sub(1, std::memory_order_relaxed);
+  });
+}
+
+void Metrics::RecordRequest(CommandType const command, uint64_t const micros) {
+  size_t slot = static_cast<size_t>(command);
+  if (slot < kCommandSlots) {
+    requests_[slot].Record(micros);
+  }
+}
+
+void Metrics::RecordEtcdCommit(uint64_t const micros) {
+  etcd_commits_.Record(micros);
+}
+
+void Metrics::RecordEtcdTxn(size_t const ops, size_t const bytes) {
+  etcd_txn_ops_.Record(ops);
+  etcd_txn_bytes_.Record(bytes);
+}
+
+void Metrics::RecordMetaRequest(uint64_t const micros) {
+  meta_requests_.Record(micros);
+}
+
+void Metrics::RecordMetaWatch(size_t const ops, uint64_t const micros) {
+  meta_watch_ops_.Record(ops);
+  meta_watch_applies_.Record(micros);
+}
+
+void Metrics::Dump(ptree& tree) const {
+  ptree requests;
+  for (size_t slot = 0; slot < kCommandSlots; ++slot) {
+    if (requests_[slot].Count() == 0) {
+      continue;
+    }
+    ptree histogram;
+    dump_histogram(requests_[slot], histogram);
+    requests.add_child(CommandTypeName(static_cast<CommandType>(slot)),
+                       histogram);
+  }
+  tree.add_child("requests", requests);
+  ptree etcd_commits;
+  dump_histogram(etcd_commits_, etcd_commits);
+  tree.add_child("etcd_commits", etcd_commits);
+  std::pair<const char*, const LatencyHistogram*> const histograms[] = {
+      {"etcd_txn_ops", &etcd_txn_ops_},
+      {"etcd_txn_bytes", &etcd_txn_bytes_},
+      {"meta_requests", &meta_requests_},
+      {"meta_watch_ops", &meta_watch_ops_},
+      {"meta_watch_applies", &meta_watch_applies_}};
+  for (auto const& item : histograms) {
+    ptree histogram;
+    dump_histogram(*item.second, histogram);
+    tree.add_child(item.first, histogram);
+  }
+  tree.put("bytes_in", bytes_in_.load(std::memory_order_relaxed));
+  tree.put("bytes_out", bytes_out_.load(std::memory_order_relaxed));
+}
+
+void Metrics::DumpPrometheus(const ptree& instance_status,
+                             std::ostream& os) const {
+  std::string const requests = "vineyard_request_duration_microseconds";
+  os << "# HELP " << requests
+     << " Latency of requests, from receiving the request to writing the "
+        "reply.\n";
+  os << "# TYPE " << requests << " summary\n";
+  for (size_t slot = 0; slot < kCommandSlots; ++slot) {
+    if (requests_[slot].Count() == 0) {
+      continue;
+    }
+    dump_summary(
+        requests_[slot], requests,
+        std::string("command=\"") +
+            CommandTypeName(static_cast<CommandType>(slot)) + "\"",
+        os);
+  }
+
+  std::string const etcd_commits = "vineyard_etcd_commit_duration_microseconds";
+  os << "# HELP " << etcd_commits << " Latency of transactions to etcd.\n";
+  os << "# TYPE " << etcd_commits << " summary\n";
+  dump_summary(etcd_commits_, etcd_commits, "", os);
+
+  std::string const etcd_txn_ops = "vineyard_etcd_txn_ops";
+  os << "# HELP " << etcd_txn_ops << " Operations of transactions to etcd.\n";
+  os << "# TYPE " << etcd_txn_ops << " summary\n";
+  dump_summary(etcd_txn_ops_, etcd_txn_ops, "", os);
+
+  std::string const etcd_txn_bytes = "vineyard_etcd_txn_bytes";
+  os << "# HELP " << etcd_txn_bytes
+     << " Bytes of keys and values of transactions to etcd.\n";
+  os << "# TYPE " << etcd_txn_bytes << " summary\n";
+  dump_summary(etcd_txn_bytes_, etcd_txn_bytes, "", os);
+
+  std::string const meta_requests =
+      "vineyard_meta_request_duration_microseconds";
+  os << "# HELP " << meta_requests
+     << " Latency of bringing the local metadata up-to-date.\n";
+  os << "# TYPE " << meta_requests << " summary\n";
+  dump_summary(meta_requests_, meta_requests, "", os);
+
+  std::string const meta_watch_applies =
+      "vineyard_meta_watch_apply_duration_microseconds";
+  os << "# HELP " << meta_watch_applies
+     << " Latency of applying the changes of the daemon watch.\n";
+  os << "# TYPE " << meta_watch_applies << " summary\n";
+  dump_summary(meta_watch_applies_, meta_watch_applies, "", os);
+
+  os << "# HELP vineyard_received_bytes_total Bytes of requests received.\n";
+  os << "# TYPE vineyard_received_bytes_total counter\n";
+  os << "vineyard_received_bytes_total "
+     << bytes_in_.load(std::memory_order_relaxed) << "\n";
+  os << "# HELP vineyard_sent_bytes_total Bytes of replies sent.\n";
+  os << "# TYPE vineyard_sent_bytes_total counter\n";
+  os << "vineyard_sent_bytes_total "
+     << bytes_out_.load(std::memory_order_relaxed) << "\n";
+
+  // numeric fields of the instance status, e.g., the memory footprint.
+  for (auto const& kv : instance_status) {
+    if (!kv.second.empty() || kv.first == "instance_id") {
+      continue;
+    }
+    if (!kv.second.get_value_optional<double>()) {
+      continue;
+    }
+    os << "# TYPE vineyard_" << kv.first << " gauge\n";
+    os << "vineyard_" << kv.first << " " << kv.second.data() << "\n";
+  }
+
+  // the statistics of streams, labeled by the stream id
+  static const std::pair<const char*, const char*> stream_metrics[] = {
+      {"chunks_produced", "counter"},     {"bytes_produced", "counter"},
+      {"chunks_consumed", "counter"},     {"bytes_consumed", "counter"},
+      {"queue_depth", "gauge"},           {"producer_blocked_us", "counter"},
+      {"consumer_waited_us", "counter"},  {"consumers_waiting", "gauge"}};
+  auto const& streams = instance_status.get_child("streams", ptree());
+  if (streams.empty()) {
+    return;
+  }
+  for (auto const& metric : stream_metrics) {
+    os << "# TYPE vineyard_stream_" << metric.first << " " << metric.second
+       << "\n";
+    for (auto const& stream : streams) {
+      os << "vineyard_stream_" << metric.first << "{stream=\"" << stream.first
+         << "\"} " << stream.second.get<std::string>(metric.first, "0")
+         << "\n";
+    }
+  }
+}
+
+}  // namespace vineyard
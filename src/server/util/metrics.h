@@ -0,0 +1,140 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_METRICS_H_
+#define SRC_SERVER_UTIL_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "common/util/boost.h"
+#include "common/util/protocols.h"
+
+namespace vineyard {
+
+/**
+ * @brief LatencyHistogram is a lock-free histogram with log-linear buckets
+ * (in the HDR histogram manner): every power of 2 is split into 8 buckets,
+ * thus the relative error of the percentiles is bounded by 12.5%.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr size_t kBuckets = 64 << kSubBucketBits;
+
+  LatencyHistogram();
+
+  void Record(uint64_t const value);
+
+  uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+
+  uint64_t Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+  uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief The upper bound of the bucket where the given percentile (in
+   * [0, 1]) falls in.
+   */
+  uint64_t Percentile(double const percentile) const;
+
+ private:
+  static size_t bucketOf(uint64_t const value);
+
+  static uint64_t upperBoundOf(size_t const bucket);
+
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_;
+  std::atomic<uint64_t> count_, sum_, max_;
+};
+
+/**
+ * @brief Metrics collects the latencies of requests (in microseconds, from
+ * receiving the request until the reply being written) per command type,
+ * the traffic of connections and the latency of etcd commits.
+ *
+ * The metadata service is measured as well: the number of operations and
+ * the bytes of every etcd transaction, the latency of bringing the local
+ * metadata up-to-date with the backend (`requestValues`), and the time of
+ * applying the changes received by the daemon watch.
+ *
+ * Recording is lock-free and can be done from any thread.
+ */
+class Metrics {
+ public:
+  static constexpr size_t kCommandSlots = 64;
+
+  void RecordRequest(CommandType const command, uint64_t const micros);
+
+  void RecordEtcdCommit(uint64_t const micros);
+
+  void RecordEtcdTxn(size_t const ops, size_t const bytes);
+
+  void RecordMetaRequest(uint64_t const micros);
+
+  void RecordMetaWatch(size_t const ops, uint64_t const micros);
+
+  void AddBytesIn(size_t const bytes) {
+    bytes_in_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  void AddBytesOut(size_t const bytes) {
+    bytes_out_.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Count the request as in flight until the returned handle is
+   * released, which is held by the request until the reply is written (or
+   * the request is dropped).
+   */
+  std::shared_ptr<void> TrackRequest();
+
+  /**
+   * @brief The number of the requests in flight, which is the load that the
+   * background tasks yield to.
+   */
+  size_t InflightRequests() const {
+    return inflight_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Dump the metrics to a ptree, which is included in the reply of
+   * `InstanceStatusRequest`.
+   */
+  void Dump(ptree& tree) const;
+
+  /**
+   * @brief Dump the metrics in the Prometheus text exposition format, the
+   * instance status (e.g., the memory footprint) are exported as gauges.
+   */
+  void DumpPrometheus(const ptree& instance_status, std::ostream& os) const;
+
+ private:
+  std::array<LatencyHistogram, kCommandSlots> requests_;
+  LatencyHistogram etcd_commits_;
+  LatencyHistogram etcd_txn_ops_, etcd_txn_bytes_;
+  LatencyHistogram meta_requests_;
+  LatencyHistogram meta_watch_ops_, meta_watch_applies_;
+  std::atomic<uint64_t> bytes_in_{0}, bytes_out_{0};
+  std::atomic<size_t> inflight_{0};
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_METRICS_H_
@@ -0,0 +1,118 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/remote_client.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "common/util/protocols.h"
+
+namespace vineyard {
+
+constexpr size_t RemoteClient::kChunkSize;
+
+RemoteClient::~RemoteClient() {
+  boost::system::error_code ec;
+  if (socket_.is_open()) {
+    std::string message_out;
+    WriteExitRequest(message_out);
+    VINEYARD_SUPPRESS(doWrite(message_out));
+    socket_.close(ec);
+  }
+}
+
+Status RemoteClient::Connect(const std::string& rpc_endpoint) {
+  size_t pos = rpc_endpoint.rfind(":");
+  if (pos == std::string::npos) {
+    return Status::Invalid("Invalid RPC endpoint: " + rpc_endpoint);
+  }
+  boost::system::error_code ec;
+  asio::ip::tcp::resolver resolver(context_);
+  auto endpoints = resolver.resolve(rpc_endpoint.substr(0, pos),
+                                    rpc_endpoint.substr(pos + 1), ec);
+  if (!ec) {
+    asio::connect(socket_, endpoints, ec);
+  }
+  if (ec) {
+    return Status::ConnectionFailed("Failed to connect to " + rpc_endpoint +
+                                    ": " + ec.message());
+  }
+  std::string message_out;
+  WriteRegisterRequest(false, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  ptree message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::string ipc_socket, endpoint;
+  InstanceID instance_id;
+  bool binary_protocol = false, request_tag = false,
+       deletion_notification = false;
+  RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket, endpoint,
+                                    instance_id, binary_protocol, request_tag,
+                                    deletion_notification));
+  // the payloads are carried in the binary messages
+  RETURN_ON_ASSERT(binary_protocol,
+                   "The remote vineyardd doesn't speak the binary protocol");
+  return Status::OK();
+}
+
+Status RemoteClient::GetRemoteBlob(const ObjectID id, uint8_t* data,
+                                   const size_t size) {
+  for (size_t offset = 0; offset < size; offset += kChunkSize) {
+    size_t const chunk_size = std::min(kChunkSize, size - offset);
+    std::string message_out;
+    WriteGetRemoteBlobRequest(id, offset, chunk_size, "", message_out);
+    RETURN_ON_ERROR(doWrite(message_out));
+    ptree message_in;
+    RETURN_ON_ERROR(doRead(message_in));
+    std::string chunk;
+    RETURN_ON_ERROR(ReadGetRemoteBlobReply(message_in, chunk));
+    RETURN_ON_ASSERT(chunk.size() == chunk_size,
+                     "Unexpected size of the blob chunk");
+    memcpy(data + offset, chunk.data(), chunk_size);
+  }
+  return Status::OK();
+}
+
+Status RemoteClient::doWrite(const std::string& message_out) {
+  boost::system::error_code ec;
+  size_t length = message_out.size();
+  std::vector<asio::const_buffer> buffers{
+      asio::buffer(&length, sizeof(size_t)), asio::buffer(message_out)};
+  asio::write(socket_, buffers, ec);
+  if (ec) {
+    return Status::IOError("Failed to send the request: " + ec.message());
+  }
+  return Status::OK();
+}
+
+Status RemoteClient::doRead(ptree& message_in) {
+  boost::system::error_code ec;
+  size_t length = 0;
+  asio::read(socket_, asio::buffer(&length, sizeof(size_t)), ec);
+  std::string message;
+  if (!ec) {
+    message.resize(length);
+    asio::read(socket_, asio::buffer(&message[0], length), ec);
+  }
+  if (ec) {
+    return Status::IOError("Failed to receive the reply: " + ec.message());
+  }
+  return DecodeMessage(message, message_in);
+}
+
+}  // namespace vineyard
@@ -0,0 +1,63 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_REMOTE_CLIENT_H_
+#define SRC_SERVER_UTIL_REMOTE_CLIENT_H_
+
+#include <string>
+
+#include "boost/asio.hpp"
+
+#include "common/util/boost.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+namespace asio = boost::asio;
+
+/**
+ * @brief RemoteClient connects to the RPC server of another vineyardd, to
+ * copy the payloads of the blobs on that instance. The requests are blocking,
+ * thus it shouldn't be used inside the IO threads.
+ */
+class RemoteClient {
+ public:
+  RemoteClient() : socket_(context_) {}
+
+  ~RemoteClient();
+
+  Status Connect(const std::string& rpc_endpoint);
+
+  /**
+   * @brief Copy the payload of the blob into `data`, which must be at least
+   * `size` bytes.
+   */
+  Status GetRemoteBlob(const ObjectID id, uint8_t* data, const size_t size);
+
+ private:
+  Status doWrite(const std::string& message_out);
+
+  Status doRead(ptree& message_in);
+
+  static constexpr size_t kChunkSize = 4 * 1024 * 1024;
+
+  asio::io_context context_;
+  asio::ip::tcp::socket socket_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_REMOTE_CLIENT_H_
@@ -0,0 +1,95 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/slow_requests.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace vineyard {
+
+constexpr size_t SlowRequestRecorder::kCapacity;
+constexpr size_t SlowRequestRecorder::kFields;
+
+namespace {
+
+thread_local std::shared_ptr<RequestStats> current_stats;
+
+}  // namespace
+
+std::shared_ptr<RequestStats> const& RequestStats::Current() {
+  return current_stats;
+}
+
+RequestStats::Scope::Scope(std::shared_ptr<RequestStats> const& stats)
+    : previous_(std::move(current_stats)) {
+  current_stats = stats;
+}
+
+RequestStats::Scope::~Scope() { current_stats = std::move(previous_); }
+
+void SlowRequestRecorder::Record(SlowRequest const& request) {
+  uint64_t position = next_.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots_[position % kCapacity];
+  slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  uint64_t const fields[kFields] = {
+      static_cast<uint64_t>(request.timestamp),
+      static_cast<uint64_t>(request.command),
+      static_cast<uint64_t>(request.connection),
+      request.bytes_in,
+      request.bytes_out,
+      request.queue_us,
+      request.handle_us,
+      request.etcd_us};
+  for (size_t index = 0; index < kFields; ++index) {
+    slot.fields[index].store(fields[index], std::memory_order_relaxed);
+  }
+  slot.sequence.store(2 * position + 2, std::memory_order_release);
+}
+
+void SlowRequestRecorder::Dump(size_t const limit,
+                               std::vector<SlowRequest>& requests) const {
+  uint64_t next = next_.load(std::memory_order_acquire);
+  uint64_t count = std::min<uint64_t>({next, kCapacity, limit});
+  for (uint64_t index = 0; index < count; ++index) {
+    uint64_t position = next - 1 - index;
+    auto const& slot = slots_[position % kCapacity];
+    if (slot.sequence.load(std::memory_order_acquire) != 2 * position + 2) {
+      // being overwritten by a newer one
+      continue;
+    }
+    uint64_t fields[kFields];
+    for (size_t field = 0; field < kFields; ++field) {
+      fields[field] = slot.fields[field].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != 2 * position + 2) {
+      continue;
+    }
+    SlowRequest request;
+    request.timestamp = static_cast<int64_t>(fields[0]);
+    request.command = static_cast<CommandType>(fields[1]);
+    request.connection = static_cast<int64_t>(fields[2]);
+    request.bytes_in = fields[3];
+    request.bytes_out = fields[4];
+    request.queue_us = fields[5];
+    request.handle_us = fields[6];
+    request.etcd_us = fields[7];
+    requests.emplace_back(request);
+  }
+}
+
+}  // namespace vineyard
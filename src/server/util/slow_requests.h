@@ -0,0 +1,108 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_SLOW_REQUESTS_H_
+#define SRC_SERVER_UTIL_SLOW_REQUESTS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/util/protocols.h"
+
+namespace vineyard {
+
+/**
+ * @brief What the handling of a request has waited for, which is collected
+ * along with the request: the request sets it as the current one of the
+ * thread (see `Scope`), and the deferred tasks and etcd callbacks carry it
+ * over.
+ */
+struct RequestStats {
+  // waiting behind the requests that were read before it, in microseconds
+  uint64_t read_us = 0;
+  // waiting for the meta strand
+  std::atomic<uint64_t> queue_us{0};
+  std::atomic<uint64_t> etcd_us{0};
+
+  static std::shared_ptr<RequestStats> const& Current();
+
+  class Scope {
+   public:
+    explicit Scope(std::shared_ptr<RequestStats> const& stats);
+
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    std::shared_ptr<RequestStats> previous_;
+  };
+};
+
+/**
+ * @brief SlowRequestRecorder is the flight recorder of the requests that
+ * take longer than the threshold, the most recent `kCapacity` ones are kept.
+ *
+ * Recording is lock-free: the writer claims a slot by bumping the position,
+ * and every slot is guarded by a sequence number (in the seqlock manner),
+ * thus the readers skip the slots that are being overwritten.
+ */
+class SlowRequestRecorder {
+ public:
+  static constexpr size_t kCapacity = 1024;
+
+  /** In microseconds, 0 disables the recorder. */
+  void SetThreshold(uint64_t const micros) {
+    threshold_.store(micros, std::memory_order_relaxed);
+  }
+
+  bool Enabled() const {
+    return threshold_.load(std::memory_order_relaxed) != 0;
+  }
+
+  bool IsSlow(uint64_t const micros) const {
+    uint64_t threshold = threshold_.load(std::memory_order_relaxed);
+    return threshold != 0 && micros >= threshold;
+  }
+
+  void Record(SlowRequest const& request);
+
+  /**
+   * @brief The recorded requests, the most recent one first, at most `limit`
+   * of them.
+   */
+  void Dump(size_t const limit, std::vector<SlowRequest>& requests) const;
+
+ private:
+  static constexpr size_t kFields = 8;
+
+  struct Slot {
+    // 2 * position + 1 while being written, 2 * position + 2 when done
+    std::atomic<uint64_t> sequence{0};
+    std::array<std::atomic<uint64_t>, kFields> fields;
+  };
+
+  std::atomic<uint64_t> threshold_{0};
+  std::atomic<uint64_t> next_{0};
+  std::array<Slot, kCapacity> slots_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_SLOW_REQUESTS_H_
@@ -15,6 +15,8 @@ limitations under the License.
 
 // #include <cstdlib>
 #include <exception>
+#include <sstream>
+#include <utility>
 
 #include "gflags/gflags.h"
 
@@ -23,19 +25,139 @@ limitations under the License.
 
 // meta data
 DEFINE_string(deployment, "local", "deployment mode: local, distributed");
+DEFINE_string(meta, "etcd",
+              "metadata backend: etcd, or local for single-node deployments "
+              "without launching etcd");
+DEFINE_string(meta_wal, "",
+              "write-ahead log file of the local metadata backend, the "
+              "metadata is kept in memory only if it is empty");
+DEFINE_bool(meta_wal_sync, false,
+            "sync the write-ahead log of the local metadata backend to disk "
+            "after every commit");
 DEFINE_string(etcd_endpoint, "http://127.0.0.1:2379", "endpoint of etcd");
 DEFINE_string(etcd_prefix, "vineyard", "path prefix in etcd");
 DEFINE_string(etcd_cmd, "", "path of etcd executable");
+DEFINE_int32(etcd_commit_window, 0,
+             "microseconds to wait for coalescing concurrent metadata updates "
+             "into one etcd transaction, 0 means only coalescing the updates "
+             "that are already pending");
+DEFINE_int32(etcd_max_txn_ops, 128,
+             "max number of operations in one etcd transaction, larger "
+             "updates are split into chunks, should not exceed the "
+             "--max-txn-ops of etcd");
+DEFINE_bool(etcd_compact_values, false,
+            "put every persisted object as one (zstd-compressed) value in "
+            "etcd, rather than one key per field, the compact values can be "
+            "read regardless, but not by the older versions of vineyardd");
+// server
+DEFINE_int32(server_threads, 1,
+             "number of threads that process the IPC and RPC requests, 0 "
+             "means the number of hardware threads");
+DEFINE_int32(metrics_port, 0,
+             "port of the HTTP endpoint that exports metrics in the "
+             "Prometheus format, disabled if it is 0");
+DEFINE_double(trace_sample_rate, 0,
+              "the fraction of requests that start a new trace, the requests "
+              "from traced clients are always traced, the spans are served "
+              "on the metrics port at /traces in the Zipkin v2 format");
+DEFINE_int32(trace_buffer_size, 8192,
+             "max number of the finished spans that are kept in memory, "
+             "tracing is disabled if it is 0");
+DEFINE_int64(slow_request_threshold, 100000,
+             "microseconds, the requests that take longer are kept in the "
+             "flight recorder and can be queried by the clients (see "
+             "Client::SlowRequests), 0 to disable");
+DEFINE_int32(background_threads, 2,
+             "number of threads that run the background tasks, e.g., the "
+             "garbage collection");
+DEFINE_int32(background_busy_requests, 8,
+             "the background tasks yield while more requests than this are "
+             "in flight");
+DEFINE_int64(background_io_rate, 0,
+             "bytes per second, the budget of the IO of the background "
+             "tasks, 0 means unlimited");
+DEFINE_int32(numa_node, -1,
+             "the NUMA node of vineyardd: the threads are pinned to its CPUs "
+             "unless the CPUs of the kind of threads are given, and the "
+             "shared memory is placed on it by default, -1 to disable");
+DEFINE_string(server_cpus, "",
+              "pin the threads that serve the IPC and RPC requests to the "
+              "CPUs, e.g., \"0-3,8\", or to the CPUs of the NUMA nodes, "
+              "e.g., \"numa:0\"");
+DEFINE_string(background_cpus, "",
+              "pin the threads of the background tasks to the CPUs, in the "
+              "same format as --server_cpus");
+DEFINE_string(prefault_cpus, "",
+              "pin the pre-faulting threads to the CPUs, in the same format "
+              "as --server_cpus, they are spread across the NUMA nodes if "
+              "neither this nor --numa_node is given");
+DEFINE_string(zone, "",
+              "the network zone (e.g., the rack) of this vineyardd, which is "
+              "published in the cluster info for placing data close to the "
+              "computation");
 // share memory
 DEFINE_string(size, "256Mi",
               "shared memory size for vineyardd, the format could be 1024M, "
               "1024000, 1G, or 1Gi");
+DEFINE_string(reserve_size, "",
+              "map only this much of the shared memory up front and grow in "
+              "more segments on demand until --size, the segments that "
+              "become empty are returned to the OS, the whole --size is "
+              "mapped up front if it is empty");
+DEFINE_int32(prefault_threads, 0,
+             "pre-fault the shared memory with this many threads in "
+             "background at startup, spread across the NUMA nodes, the "
+             "progress is reported in the instance status, 0 to disable");
+DEFINE_string(tenant_quotas, "",
+              "quotas of the shared memory per tenant, e.g., "
+              "\"etl=64Gi,*=16Gi\", where \"*\" is the quota of every other "
+              "tenant, the tenant of a client is given by VINEYARD_TENANT or "
+              "is its connection, no quota if it is empty");
 DEFINE_int64(stream_threshold, 80,
              "memory threshold of streams (percentage of total memory)");
+DEFINE_string(huge_page_size, "",
+              "back the shared memory with huge pages, the size could be 2Mi "
+              "or 1Gi, fallback to normal pages when huge pages run out");
+DEFINE_bool(numa_arenas, false,
+            "hold one shared memory arena per NUMA node, blobs are placed on "
+            "the NUMA node of the client by default");
+DEFINE_string(arena_file, "",
+              "put the shared memory on the file, e.g., on a DAX filesystem, "
+              "PMEM, a tmpfs or a hugetlbfs, which is created with --size, "
+              "the blobs on it survive restarts if the metadata is persisted "
+              "as well, e.g., by --meta_wal");
+DEFINE_string(device_memory_size, "",
+              "upper bound of the CUDA device memory for device blobs, the "
+              "format is the same as --size, device blobs are disabled if it "
+              "is empty");
+DEFINE_string(spill_path, "",
+              "directory to spill cold blobs to when the shared memory is "
+              "exhausted, spilling is disabled if it is empty");
+DEFINE_bool(dedup_blobs, false,
+            "hash the sealed blobs in the background and keep one copy of "
+            "the blobs of the same content in the shared memory");
+DEFINE_int32(compress_after, 0,
+             "seconds that a blob stays unaccessed before being compressed in "
+             "the shared memory, it's decompressed on the next access, 0 "
+             "disables it");
+DEFINE_string(compress_codec, "lz4",
+              "codec for compressing the cold blobs, e.g., lz4 or zstd");
+DEFINE_int32(gc_interval, 0,
+             "seconds between two passes of freeing the blobs that are neither "
+             "referenced by metadata nor used by any client, a blob is freed "
+             "after being found unreferenced in two passes, 0 disables it");
+DEFINE_int64(stream_depth, 0,
+             "default max number of chunks that the producer of a stream can "
+             "write ahead of the consumer, 0 means only bounded by the "
+             "stream_threshold");
 // ipc
 DEFINE_string(socket, "/var/run/vineyard.sock", "IPC socket file location");
 // rpc
 DEFINE_int32(rpc_socket_port, 9600, "port to listen in rpc server");
+DEFINE_string(rpc_host, "",
+              "the address that the rpc server listens on and advertises, "
+              "e.g., of the NIC that is local to --numa_node, all addresses "
+              "and the hostname if it is empty");
 
 namespace vineyard {
 
@@ -43,6 +165,7 @@ const Resolver& Resolver::get(std::string name) {
   static auto server_resolver = ServerSpecResolver();
   static auto bulkstore_resolver = BulkstoreSpecResolver();
   static auto etcd_resolver = EtcdSpecResolver();
+  static auto local_meta_resolver = LocalMetaSpecResolver();
   static auto ipc_server_resolver = IpcSpecResolver();
   static auto rpc_server_resolver = RpcSpecResolver();
 
@@ -52,6 +175,8 @@ const Resolver& Resolver::get(std::string name) {
     return bulkstore_resolver;
   } else if (name == "etcd") {
     return etcd_resolver;
+  } else if (name == "local") {
+    return local_meta_resolver;
   } else if (name == "ipcserver") {
     return ipc_server_resolver;
   } else if (name == "rpcserver") {
@@ -64,9 +189,21 @@ const Resolver& Resolver::get(std::string name) {
 ptree EtcdSpecResolver::resolve() const {
   ptree spec;
   // FIXME: get from flags or env
+  spec.put("meta", "etcd");
   spec.put("prefix", FLAGS_etcd_prefix + ".");
   spec.put("etcd_endpoint", FLAGS_etcd_endpoint);
   spec.put("etcd_cmd", FLAGS_etcd_cmd);
+  spec.put("commit_window", FLAGS_etcd_commit_window);
+  spec.put("max_txn_ops", FLAGS_etcd_max_txn_ops);
+  spec.put("compact_values", FLAGS_etcd_compact_values);
+  return spec;
+}
+
+ptree LocalMetaSpecResolver::resolve() const {
+  ptree spec;
+  spec.put("meta", "local");
+  spec.put("wal_path", FLAGS_meta_wal);
+  spec.put("wal_sync", FLAGS_meta_wal_sync);
   return spec;
 }
 
@@ -74,7 +211,42 @@ ptree BulkstoreSpecResolver::resolve() const {
   ptree spec;
   size_t bulkstore_limit = parseMemoryLimit(FLAGS_size);
   spec.put("memory_size", bulkstore_limit);
+  spec.put("reserve_size", FLAGS_reserve_size.empty()
+                               ? 0
+                               : parseMemoryLimit(FLAGS_reserve_size));
   spec.put("stream_threshold", std::to_string(FLAGS_stream_threshold));
+  spec.put("stream_depth", FLAGS_stream_depth);
+  spec.put("huge_page_size", FLAGS_huge_page_size.empty()
+                                 ? 0
+                                 : parseMemoryLimit(FLAGS_huge_page_size));
+  spec.put("numa_arenas", FLAGS_numa_arenas);
+  spec.put("prefault_threads", FLAGS_prefault_threads);
+  spec.put("prefault_cpus", FLAGS_prefault_cpus);
+  spec.put("spill_path", FLAGS_spill_path);
+  spec.put("arena_file", FLAGS_arena_file);
+  spec.put("dedup_blobs", FLAGS_dedup_blobs);
+  spec.put("compress_after", FLAGS_compress_after);
+  spec.put("compress_codec", FLAGS_compress_codec);
+  spec.put("device_memory_size",
+           FLAGS_device_memory_size.empty()
+               ? 0
+               : parseMemoryLimit(FLAGS_device_memory_size));
+  spec.put("gc_interval", FLAGS_gc_interval);
+  ptree quotas;
+  std::stringstream ss(FLAGS_tenant_quotas);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    auto separator = item.rfind('=');
+    if (separator == std::string::npos || separator == 0) {
+      LOG(ERROR) << "Invalid tenant quota: '" << item << "', ignored";
+      continue;
+    }
+    // the names of tenants may contain '.', which `put` would split
+    quotas.push_back(std::make_pair(
+        item.substr(0, separator),
+        ptree(std::to_string(parseMemoryLimit(item.substr(separator + 1))))));
+  }
+  spec.add_child("tenant_quotas", quotas);
   return spec;
 }
 
@@ -130,13 +302,30 @@ ptree IpcSpecResolver::resolve() const {
 ptree RpcSpecResolver::resolve() const {
   ptree spec;
   spec.put("port", FLAGS_rpc_socket_port);
+  spec.put("host", FLAGS_rpc_host);
   return spec;
 }
 
 ptree ServerSpecResolver::resolve() const {
   ptree spec;
   spec.put("deployment", FLAGS_deployment);
-  spec.add_child("metastore_spec", Resolver::get("etcd").resolve());
+  spec.put("server_threads", FLAGS_server_threads);
+  spec.put("metrics_port", FLAGS_metrics_port);
+  spec.put("trace_sample_rate", FLAGS_trace_sample_rate);
+  spec.put("trace_buffer_size", FLAGS_trace_buffer_size);
+  spec.put("slow_request_threshold", FLAGS_slow_request_threshold);
+  spec.put("background_threads", FLAGS_background_threads);
+  spec.put("background_busy_requests", FLAGS_background_busy_requests);
+  spec.put("background_io_rate", FLAGS_background_io_rate);
+  spec.put("numa_node", FLAGS_numa_node);
+  spec.put("server_cpus", FLAGS_server_cpus);
+  spec.put("background_cpus", FLAGS_background_cpus);
+  spec.put("zone", FLAGS_zone);
+  if (FLAGS_meta == "local") {
+    spec.add_child("metastore_spec", Resolver::get("local").resolve());
+  } else {
+    spec.add_child("metastore_spec", Resolver::get("etcd").resolve());
+  }
   spec.add_child("bulkstore_spec", Resolver::get("bulkstore").resolve());
   spec.add_child("ipc_spec", Resolver::get("ipcserver").resolve());
   spec.add_child("rpc_spec", Resolver::get("rpcserver").resolve());
@@ -42,6 +42,16 @@ class EtcdSpecResolver : public Resolver {
   ptree resolve() const;
 };
 
+/**
+ * @brief LocalMetaSpecResolver resolves the specification of the in-process
+ * metadata backend
+ *
+ */
+class LocalMetaSpecResolver : public Resolver {
+ public:
+  ptree resolve() const;
+};
+
 /**
  * @brief BulkstoreSpecResolver resolves the bulkstore specification
  *
@@ -0,0 +1,72 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/timer_wheel.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace vineyard {
+
+void TimerWheel::Schedule(ObjectID const id, int64_t const now,
+                          uint64_t const ttl) {
+  if (current_ < 0) {
+    current_ = now;
+  }
+  // expire at the next advance at the earliest
+  int64_t tick = std::max(now + static_cast<int64_t>(ttl), current_ + 1);
+  expiry_[id] = tick;
+  slots_[slotOf(tick)].emplace_back(id);
+}
+
+void TimerWheel::Advance(int64_t const now, std::vector<ObjectID>& expired) {
+  if (current_ < 0 || now <= current_) {
+    return;
+  }
+  if (now - current_ >= static_cast<int64_t>(slots_.size())) {
+    // a full round has elapsed
+    for (size_t slot = 0; slot < slots_.size(); ++slot) {
+      advanceSlot(slot, now, expired);
+    }
+  } else {
+    for (int64_t tick = current_ + 1; tick <= now; ++tick) {
+      advanceSlot(slotOf(tick), now, expired);
+    }
+  }
+  current_ = now;
+}
+
+void TimerWheel::advanceSlot(size_t const slot, int64_t const now,
+                             std::vector<ObjectID>& expired) {
+  auto& entries = slots_[slot];
+  size_t kept = 0;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    auto iter = expiry_.find(entries[i]);
+    if (iter == expiry_.end() || slotOf(iter->second) != slot) {
+      // stale entry
+      continue;
+    }
+    if (iter->second <= now) {
+      expired.emplace_back(iter->first);
+      expiry_.erase(iter);
+    } else {
+      // expires in later rounds
+      entries[kept++] = entries[i];
+    }
+  }
+  entries.resize(kept);
+}
+
+}  // namespace vineyard
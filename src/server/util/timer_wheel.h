@@ -0,0 +1,80 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_TIMER_WHEEL_H_
+#define SRC_SERVER_UTIL_TIMER_WHEEL_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief TimerWheel tracks the expiry ticks of objects with a hashed timing
+ * wheel, scheduling and cancelling are O(1), and advancing the wheel only
+ * visits the slots of the elapsed ticks.
+ *
+ * Ticks are in an arbitrary (but monotonic) unit, e.g., seconds of the
+ * steady clock.
+ */
+class TimerWheel {
+ public:
+  explicit TimerWheel(size_t const slots = 4096) : slots_(slots) {}
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /**
+   * @brief Expire the object after `ttl` ticks since `now`, re-scheduling an
+   * object overrides its previous expiry tick.
+   */
+  void Schedule(ObjectID const id, int64_t const now, uint64_t const ttl);
+
+  /**
+   * @brief Forget the object, e.g., it has been deleted by others.
+   */
+  void Cancel(ObjectID const id) { expiry_.erase(id); }
+
+  /**
+   * @brief Advance the wheel to the given tick, and append the objects that
+   * have expired to `expired`.
+   */
+  void Advance(int64_t const now, std::vector<ObjectID>& expired);
+
+  size_t Size() const { return expiry_.size(); }
+
+  bool Empty() const { return expiry_.empty(); }
+
+ private:
+  size_t slotOf(int64_t const tick) const {
+    return static_cast<size_t>(tick) % slots_.size();
+  }
+
+  void advanceSlot(size_t const slot, int64_t const now,
+                   std::vector<ObjectID>& expired);
+
+  // entries in slots may be stale (cancelled or re-scheduled), the expiry_
+  // map is the source of truth.
+  std::vector<std::vector<ObjectID>> slots_;
+  std::unordered_map<ObjectID, int64_t> expiry_;
+  // the latest tick that has been advanced to, -1 means not started.
+  int64_t current_ = -1;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_TIMER_WHEEL_H_
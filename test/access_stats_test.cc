@@ -0,0 +1,82 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./access_stats_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(1024, writer));
+  ObjectID cold_id = writer->Seal(client)->id();
+  VINEYARD_CHECK_OK(client.CreateBlob(1024, writer));
+  ObjectID hot_id = writer->Seal(client)->id();
+
+  // the blobs are got through new connections, which don't cache them
+  for (int i = 0; i < 3; ++i) {
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    CHECK(reader.GetObject<Blob>(hot_id) != nullptr);
+    reader.Disconnect();
+  }
+
+  std::vector<BlobAccess> hot;
+  VINEYARD_CHECK_OK(client.HotObjects(1024, hot));
+  auto hot_iter =
+      std::find_if(hot.begin(), hot.end(), [&](BlobAccess const& blob) {
+        return blob.object_id == hot_id;
+      });
+  CHECK(hot_iter != hot.end());
+  CHECK_GE(hot_iter->access_count, 3);
+  CHECK_GT(hot_iter->last_access, 0);
+
+  std::vector<BlobAccess> cold;
+  VINEYARD_CHECK_OK(client.ColdObjects(1024, cold));
+  auto cold_rank =
+      std::find_if(cold.begin(), cold.end(), [&](BlobAccess const& blob) {
+        return blob.object_id == cold_id;
+      });
+  auto hot_rank =
+      std::find_if(cold.begin(), cold.end(), [&](BlobAccess const& blob) {
+        return blob.object_id == hot_id;
+      });
+  CHECK(cold_rank != cold.end() && hot_rank != cold.end());
+  CHECK_LE(cold_rank->last_access, hot_rank->last_access);
+
+  VINEYARD_CHECK_OK(client.DelData({cold_id, hot_id}, true, true));
+  LOG(INFO) << "Passed access stats tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./aligned_blob_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<ObjectID> ids;
+  // small blobs that would live in slabs, and large ones
+  for (size_t size : {100, 5000, 3 * 1024 * 1024}) {
+    for (size_t alignment : {64, 4096, 2 * 1024 * 1024}) {
+      std::unique_ptr<BlobWriter> writer;
+      VINEYARD_CHECK_OK(client.CreateBlob(size, writer, -1, alignment));
+      CHECK_EQ(reinterpret_cast<uintptr_t>(writer->data()) % alignment, 0U);
+      writer->data()[0] = 'x';
+      ids.emplace_back(writer->Seal(client)->id());
+
+      // aligned in another client as well
+      Client reader;
+      VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+      auto blob = reader.GetObject<Blob>(ids.back());
+      CHECK_EQ(reinterpret_cast<uintptr_t>(blob->data()) % alignment, 0U);
+      CHECK_EQ(blob->data()[0], 'x');
+      reader.Disconnect();
+    }
+  }
+
+  std::unique_ptr<BlobWriter> writer;
+  CHECK(client.CreateBlob(1024, writer, -1, 100).IsInvalid());
+  CHECK(client.CreateBlob(1024, writer, -1, 4 * kMaxBlobAlignment)
+            .IsInvalid());
+
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+  LOG(INFO) << "Passed aligned blob tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
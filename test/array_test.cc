@@ -62,6 +62,31 @@ int main(int argc, char** argv) {
   }
   LOG(INFO) << "Passed double array tests...";
 
+  {
+    // grows across several regions, and seals in place
+    GrowableArrayBuilder<int64_t> growable_builder(client);
+    for (int64_t i = 0; i < 10000; ++i) {
+      growable_builder.push_back(i);
+    }
+    CHECK_EQ(growable_builder.size(), 10000);
+    CHECK_GE(growable_builder.capacity(), 10000);
+    const int64_t* data = growable_builder.data();
+    auto sealed = std::dynamic_pointer_cast<Array<int64_t>>(
+        growable_builder.Seal(client));
+    CHECK_EQ(sealed->size(), 10000);
+    CHECK_EQ(sealed->data(), data);
+    for (int64_t i = 0; i < 10000; ++i) {
+      CHECK_EQ((*sealed)[i], i);
+    }
+    VINEYARD_CHECK_OK(client.DelData(sealed->id()));
+
+    GrowableArrayBuilder<double> empty_builder(client);
+    auto empty = std::dynamic_pointer_cast<Array<double>>(
+        empty_builder.Seal(client));
+    CHECK_EQ(empty->size(), 0);
+  }
+  LOG(INFO) << "Passed growable array tests...";
+
   client.Disconnect();
 
   return 0;
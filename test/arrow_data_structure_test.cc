@@ -325,8 +325,54 @@ int main(int argc, char** argv) {
     auto r4 = std::dynamic_pointer_cast<Table>(client.GetObject(id3));
     CHECK(r4->GetTable()->Equals(*table));
 
+    LOG(INFO) << "#########  Table Projection Test #############";
+    std::shared_ptr<Table> r5;
+    VINEYARD_CHECK_OK(Table::Project(client, id3, {"f8", "f1"}, r5));
+    CHECK_EQ(r5->num_columns(), 2);
+    auto projected_table = arrow::Table::Make(
+        arrow::schema({table->schema()->field(3), table->schema()->field(0)}),
+        {table->column(3), table->column(0)});
+    CHECK(r5->GetTable()->Equals(*projected_table));
+    CHECK(Table::Project(client, id3, {"f9"}, r5).IsInvalid());
+
     LOG(INFO) << "Passed Table wrapper tests...";
   }
+
+  {
+    LOG(INFO) << "#########  Dictionary Test #############";
+    arrow::StringDictionaryBuilder b1;
+    for (int64_t i = 0; i < 1000; ++i) {
+      if (i % 11 == 0) {
+        CHECK_ARROW_ERROR(b1.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(b1.Append("category-" + std::to_string(i % 7)));
+      }
+    }
+    std::shared_ptr<arrow::Array> a1;
+    CHECK_ARROW_ERROR(b1.Finish(&a1));
+    auto dict_array = std::dynamic_pointer_cast<arrow::DictionaryArray>(a1);
+    CHECK_EQ(dict_array->dictionary()->length(), 7);
+
+    DictionaryArrayBuilder array_builder(client, dict_array);
+    auto r1 = std::dynamic_pointer_cast<DictionaryArray>(
+        array_builder.Seal(client));
+    CHECK(r1->GetArray()->Equals(*a1));
+    CHECK_EQ(r1->dictionary()->length(), 7);
+
+    auto schema = arrow::schema({arrow::field("f1", a1->type())});
+    auto table = arrow::Table::Make(schema, {a1});
+    TableBuilder builder(client, table);
+    auto r2 = std::dynamic_pointer_cast<Table>(builder.Seal(client));
+    VINEYARD_CHECK_OK(client.Persist(r2->id()));
+
+    auto r3 = std::dynamic_pointer_cast<Table>(client.GetObject(r2->id()));
+    auto internal_table = r3->GetTable();
+    // the column keeps dictionary-encoded
+    CHECK_EQ(internal_table->column(0)->type()->id(), arrow::Type::DICTIONARY);
+    CHECK(internal_table->Equals(*table));
+
+    LOG(INFO) << "Passed dictionary array wrapper tests...";
+  }
   client.Disconnect();
 
   return 0;
@@ -0,0 +1,126 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+#include "arrow/util/config.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_memory_pool.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "glog/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./arrow_memory_pool_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  VineyardMemoryPool pool(client);
+
+  {
+    // the buffers freed by arrow are released
+    arrow::Int64Builder builder(&pool);
+    for (int64_t i = 0; i < 100000; ++i) {
+      CHECK_ARROW_ERROR(builder.Append(i));
+    }
+    std::shared_ptr<arrow::Array> array;
+    CHECK_ARROW_ERROR(builder.Finish(&array));
+    CHECK_GE(pool.bytes_allocated(),
+             static_cast<int64_t>(100000 * sizeof(int64_t)));
+  }
+  CHECK_EQ(pool.bytes_allocated(), 0);
+  CHECK_GT(pool.num_allocations(), 0);
+  LOG(INFO) << "Passed memory pool allocation tests...";
+
+  {
+    arrow::Int64Builder int_builder(&pool);
+    arrow::StringBuilder string_builder(&pool);
+    for (int64_t i = 0; i < 10000; ++i) {
+      if (i % 7 == 0) {
+        CHECK_ARROW_ERROR(int_builder.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(int_builder.Append(i));
+      }
+      CHECK_ARROW_ERROR(string_builder.Append(std::to_string(i)));
+    }
+    std::shared_ptr<arrow::Array> a1, a2;
+    CHECK_ARROW_ERROR(int_builder.Finish(&a1));
+    CHECK_ARROW_ERROR(string_builder.Finish(&a2));
+    auto schema = arrow::schema({arrow::field("f1", arrow::int64()),
+                                 arrow::field("f2", arrow::utf8())});
+    auto table = arrow::Table::Make(schema, {a1, a2});
+    int64_t allocated = pool.bytes_allocated();
+    CHECK_GT(allocated, 0);
+
+    TableBuilder builder(client, table);
+    auto r1 = std::dynamic_pointer_cast<Table>(builder.Seal(client));
+    // all buffers are taken over by the sealed table
+    CHECK_EQ(pool.bytes_allocated(), 0);
+    VINEYARD_CHECK_OK(client.Persist(r1->id()));
+
+    auto r2 = std::dynamic_pointer_cast<Table>(client.GetObject(r1->id()));
+    CHECK(r2->GetTable()->Equals(*table));
+
+    // the buffers that have already been adopted are copied
+    auto a3 = std::dynamic_pointer_cast<arrow::Int64Array>(a1->Slice(3, 100));
+    NumericArrayBuilder<int64_t> array_builder(client, a3);
+    auto r3 = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+        array_builder.Seal(client));
+    CHECK(r3->GetArray()->Equals(*a3));
+
+    // the sealed blobs of the table are referred to inside the scope
+    auto values = std::dynamic_pointer_cast<arrow::Int64Array>(
+        r2->GetTable()->column(0)->chunk(0));
+    {
+      SealedBlobScope scope(client, r2->meta());
+      CHECK_GT(scope.size(), 0);
+      NumericArrayBuilder<int64_t> sliced_builder(
+          client, std::dynamic_pointer_cast<arrow::Int64Array>(
+                      values->Slice(5, 1000)));
+      auto r4 = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+          sliced_builder.Seal(client));
+      CHECK(r4->GetArray()->Equals(*values->Slice(5, 1000)));
+      CHECK_EQ(r4->GetArray()->values()->data(), values->values()->data());
+    }
+    NumericArrayBuilder<int64_t> copied_builder(client, values);
+    auto r5 = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+        copied_builder.Seal(client));
+    CHECK(r5->GetArray()->Equals(*values));
+    CHECK_NE(r5->GetArray()->values()->data(), values->values()->data());
+
+    VINEYARD_CHECK_OK(client.DelData(r1->id(), true, true));
+  }
+  CHECK_EQ(pool.bytes_allocated(), 0);
+  LOG(INFO) << "Passed zero-copy table builder tests...";
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed arrow memory pool tests...";
+
+  return 0;
+}
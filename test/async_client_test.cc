@@ -0,0 +1,178 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <poll.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./async_client_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t blob_count = 100;
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < blob_count; ++i) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(i + 1, writer));
+    memset(writer->data(), static_cast<int>(i), i + 1);
+    ids.emplace_back(writer->Seal(client)->id());
+  }
+
+  // all requests are in flight before any reply is consumed
+  std::vector<ptree> trees(blob_count);
+  std::vector<ObjectMeta> metas(blob_count);
+  size_t finished = 0;
+  for (size_t i = 0; i < blob_count; ++i) {
+    VINEYARD_CHECK_OK(client.GetDataAsync(
+        ids[i],
+        [&trees, &finished, i](const Status& status, const ptree& tree) {
+          VINEYARD_CHECK_OK(status);
+          trees[i] = tree;
+          finished += 1;
+          return Status::OK();
+        }));
+    VINEYARD_CHECK_OK(client.GetMetaDataAsync(
+        ids[i],
+        [&metas, &finished, i](const Status& status, const ObjectMeta& meta) {
+          VINEYARD_CHECK_OK(status);
+          metas[i] = meta;
+          finished += 1;
+          return Status::OK();
+        }));
+    VINEYARD_CHECK_OK(client.PutNameAsync(
+        ids[i], "async_client_test_" + std::to_string(i),
+        [&finished](const Status& status) {
+          VINEYARD_CHECK_OK(status);
+          finished += 1;
+          return Status::OK();
+        }));
+  }
+
+  // a blocking request in between, the replies before it are dispatched
+  bool exists = false;
+  VINEYARD_CHECK_OK(client.Exists(ids[0], exists));
+  CHECK(exists);
+
+  VINEYARD_CHECK_OK(client.WaitAll());
+  CHECK_EQ(client.PendingRequests(), 0);
+  CHECK_EQ(finished, blob_count * 3);
+
+  for (size_t i = 0; i < blob_count; ++i) {
+    CHECK_EQ(VYObjectIDFromString(trees[i].get<std::string>("id")), ids[i]);
+    CHECK_EQ(metas[i].GetId(), ids[i]);
+    auto blob = std::dynamic_pointer_cast<Blob>(client.GetObject(ids[i]));
+    CHECK_EQ(blob->size(), i + 1);
+    CHECK_EQ(blob->data()[i], static_cast<char>(i));
+    ObjectID named = InvalidObjectID();
+    VINEYARD_CHECK_OK(
+        client.GetName("async_client_test_" + std::to_string(i), named));
+    CHECK_EQ(named, ids[i]);
+    VINEYARD_CHECK_OK(
+        client.DropName("async_client_test_" + std::to_string(i)));
+  }
+
+  // create and persist metadata asynchronously
+  ObjectID created = InvalidObjectID();
+  {
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::AsyncClientTestObject");
+    meta.SetNBytes(0);
+    meta.AddKeyValue("transient", true);
+    meta.AddKeyValue("instance_id", client.instance_id());
+    VINEYARD_CHECK_OK(client.CreateDataAsync(
+        meta.MetaData(),
+        [&client, &created](const Status& status, const ObjectID id,
+                            const InstanceID instance_id) {
+          VINEYARD_CHECK_OK(status);
+          created = id;
+          // chained requests are waited by WaitAll as well
+          return client.PersistAsync(id, [](const Status& status) {
+            VINEYARD_CHECK_OK(status);
+            return Status::OK();
+          });
+        }));
+  }
+  VINEYARD_CHECK_OK(client.WaitAll());
+  CHECK(created != InvalidObjectID());
+  bool persist = false;
+  VINEYARD_CHECK_OK(client.IfPersist(created, persist));
+  CHECK(persist);
+
+  // errors are passed to the callbacks
+  bool failed = false;
+  VINEYARD_CHECK_OK(client.GetDataAsync(
+      InvalidObjectID(), [&failed](const Status& status, const ptree& tree) {
+        failed = !status.ok();
+        return Status::OK();
+      }));
+  VINEYARD_CHECK_OK(client.WaitAll());
+  CHECK(failed);
+
+  // drive the requests by polling the connection, rather than WaitAll
+  {
+    std::vector<std::shared_ptr<Object>> objects(blob_count);
+    for (size_t i = 0; i < blob_count; ++i) {
+      VINEYARD_CHECK_OK(client.GetObjectAsync(
+          ids[i], [&objects, i](const Status& status,
+                                const std::shared_ptr<Object>& object) {
+            VINEYARD_CHECK_OK(status);
+            objects[i] = object;
+            return Status::OK();
+          }));
+    }
+    while (client.PendingRequests() > 0) {
+      struct pollfd fds = {client.ConnectionFd(), POLLIN, 0};
+      CHECK_GE(poll(&fds, 1, -1), 0);
+      VINEYARD_CHECK_OK(client.PollReplies());
+    }
+    for (size_t i = 0; i < blob_count; ++i) {
+      auto blob = std::dynamic_pointer_cast<Blob>(objects[i]);
+      CHECK(blob != nullptr);
+      CHECK_EQ(blob->size(), i + 1);
+      CHECK_EQ(blob->data()[i], static_cast<char>(i));
+    }
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(created, true, true));
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+
+  LOG(INFO) << "Passed async client tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
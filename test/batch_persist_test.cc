@@ -0,0 +1,107 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "basic/ds/pair.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./batch_persist_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  std::vector<ObjectID> ids;
+  for (int i = 0; i < 16; ++i) {
+    ArrayBuilder<double> builder(client, double_array);
+    ids.emplace_back(builder.Seal(client)->id());
+  }
+  // pairs that share the same member
+  std::shared_ptr<Object> shared;
+  {
+    ArrayBuilder<double> builder(client, double_array);
+    shared = builder.Seal(client);
+  }
+  for (int i = 0; i < 2; ++i) {
+    PairBuilder pair_builder(client);
+    pair_builder.SetFirst(shared);
+    pair_builder.SetSecond(
+        std::make_shared<ArrayBuilder<double>>(client, double_array));
+    ids.emplace_back(pair_builder.Seal(client)->id());
+  }
+
+  for (auto const& id : ids) {
+    bool persist = true;
+    VINEYARD_CHECK_OK(client.IfPersist(id, persist));
+    CHECK(!persist);
+  }
+  VINEYARD_CHECK_OK(client.Persist(ids));
+  for (auto const& id : ids) {
+    bool persist = false;
+    VINEYARD_CHECK_OK(client.IfPersist(id, persist));
+    CHECK(persist);
+  }
+  {
+    bool persist = false;
+    VINEYARD_CHECK_OK(client.IfPersist(shared->id(), persist));
+    CHECK(persist);
+  }
+  // persisting persisted objects is a no-op
+  VINEYARD_CHECK_OK(client.Persist(ids));
+  CHECK(!client.Persist(std::vector<ObjectID>{GenerateObjectID()}).ok());
+  LOG(INFO) << "Passed batch persist tests...";
+
+  std::map<std::string, ObjectID> names;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    names.emplace("batch_name_" + std::to_string(i), ids[i]);
+  }
+  VINEYARD_CHECK_OK(client.PutNames(names));
+  for (auto const& item : names) {
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.GetName(item.first, id));
+    CHECK_EQ(id, item.second);
+  }
+  for (auto const& item : names) {
+    VINEYARD_CHECK_OK(client.DropName(item.first));
+  }
+  LOG(INFO) << "Passed batch put name tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+
+  LOG(INFO) << "Passed batch persist tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./blob_arena_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::shared_ptr<InstanceStatus> status_before;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_before));
+
+  const size_t blob_count = 200;
+  std::unique_ptr<BlobArena> arena;
+  VINEYARD_CHECK_OK(client.CreateBlobArena(1024 * 1024, arena));
+  CHECK_EQ(arena->Capacity(), 1024 * 1024);
+
+  std::vector<std::unique_ptr<BlobWriter>> writers(blob_count);
+  for (size_t i = 0; i < blob_count; ++i) {
+    VINEYARD_CHECK_OK(arena->Allocate(i + 1, writers[i]));
+    CHECK_EQ(writers[i]->size(), i + 1);
+    CHECK_EQ(reinterpret_cast<uintptr_t>(writers[i]->data()) %
+                 BlobArena::kAlignment,
+             0);
+    memset(writers[i]->data(), static_cast<int>(i % 128), i + 1);
+  }
+  CHECK_LE(arena->Allocated(), arena->Capacity());
+
+  // exceeds the capacity
+  std::unique_ptr<BlobWriter> oversized;
+  CHECK(arena->Allocate(arena->Capacity(), oversized).IsNotEnoughMemory());
+
+  VINEYARD_CHECK_OK(arena->Seal(client));
+  std::unique_ptr<BlobWriter> after_sealed;
+  CHECK(!arena->Allocate(1, after_sealed).ok());
+
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < blob_count; ++i) {
+    ids.emplace_back(writers[i]->Seal(client)->id());
+  }
+
+  for (size_t i = 0; i < blob_count; ++i) {
+    auto blob = std::dynamic_pointer_cast<Blob>(client.GetObject(ids[i]));
+    CHECK_EQ(blob->size(), i + 1);
+    for (size_t j = 0; j < blob->size(); ++j) {
+      CHECK_EQ(blob->data()[j], static_cast<char>(i % 128));
+    }
+  }
+
+  // the region is released once all sub-blobs are deleted
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+  std::shared_ptr<InstanceStatus> status_after;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+  CHECK_EQ(status_before->memory_usage, status_after->memory_usage);
+
+  LOG(INFO) << "Passed blob arena tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/bloom_filter.h"
+
+#include <memory>
+#include <string>
+
+#include "glog/logging.h"
+
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./bloom_filter_test <ipc_socket_name>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    BloomFilterBuilder<int64_t> builder(client, 100000);
+    for (int64_t i = 0; i < 100000; ++i) {
+      builder.insert(i * 2);
+    }
+    CHECK_EQ(builder.size(), 100000);
+    CHECK(builder.contains(0));
+
+    auto sealed_filter = std::dynamic_pointer_cast<BloomFilter<int64_t>>(
+        builder.Seal(client));
+    VINEYARD_CHECK_OK(sealed_filter->Persist(client));
+    auto filter = std::dynamic_pointer_cast<BloomFilter<int64_t>>(
+        client.GetObject(sealed_filter->id()));
+    CHECK_EQ(filter->size(), 100000);
+    CHECK_GE(filter->num_bits(), 100000 * 10);
+
+    // no false negatives
+    for (int64_t i = 0; i < 100000; ++i) {
+      CHECK(filter->contains(i * 2));
+      CHECK(filter->contains_hash(std::hash<int64_t>()(i * 2)));
+    }
+    // about 1% false positives with 10 bits per key
+    size_t false_positives = 0;
+    for (int64_t i = 0; i < 100000; ++i) {
+      false_positives += filter->contains(i * 2 + 1);
+    }
+    LOG(INFO) << "false positives: " << false_positives;
+    CHECK_LT(false_positives, 100000 * 3 / 100);
+  }
+  LOG(INFO) << "Passed int64 bloom filter tests...";
+
+  {
+    BloomFilterBuilder<std::string> builder(client, 0);
+    auto filter = std::dynamic_pointer_cast<BloomFilter<std::string>>(
+        builder.Seal(client));
+    CHECK(filter->empty());
+    CHECK(!filter->contains("vineyard"));
+  }
+  LOG(INFO) << "Passed empty bloom filter tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
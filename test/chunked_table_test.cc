@@ -0,0 +1,110 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/chunked_table.h"
+#include "client/client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./chunked_table_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::string name = "chunked_table_test_" + std::to_string(getpid());
+  auto schema = arrow::schema({arrow::field("f1", arrow::int64())});
+
+  Client reader_client;
+  VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+  std::thread reader_thread([&reader_client, &name]() {
+    ChunkedTableReader reader(reader_client, name);
+    int64_t expected = 0;
+    while (true) {
+      std::shared_ptr<arrow::RecordBatch> batch;
+      auto status = reader.ReadBatch(batch);
+      if (status.IsStreamDrained()) {
+        break;
+      }
+      VINEYARD_CHECK_OK(status);
+      auto values =
+          std::dynamic_pointer_cast<arrow::Int64Array>(batch->column(0));
+      for (int64_t i = 0; i < values->length(); ++i) {
+        CHECK_EQ(values->Value(i), expected++);
+      }
+    }
+    CHECK_EQ(expected, 300);
+    CHECK_EQ(reader.rows_read(), 300);
+  });
+
+  ObjectID table_id = InvalidObjectID();
+  {
+    ChunkedTableWriter writer(client, name, schema, 100);
+    int64_t value = 0;
+    for (int round = 0; round < 10; ++round) {
+      arrow::Int64Builder builder;
+      for (int64_t i = 0; i < 30; ++i) {
+        CHECK_ARROW_ERROR(builder.Append(value++));
+      }
+      std::shared_ptr<arrow::Array> array;
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+      VINEYARD_CHECK_OK(
+          writer.Append(arrow::RecordBatch::Make(schema, 30, {array})));
+      // the flushed chunks are small, thus merged later
+      VINEYARD_CHECK_OK(writer.Flush());
+    }
+    VINEYARD_CHECK_OK(writer.Finish(table_id));
+    CHECK_GE(writer.version(), 11);
+    CHECK(writer.Flush().ok());
+    CHECK(writer.Finish(table_id).IsInvalid());
+  }
+  reader_thread.join();
+
+  ObjectID named_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.GetName(name, named_id));
+  CHECK_EQ(named_id, table_id);
+  auto table = client.GetObject<Table>(table_id);
+  CHECK_EQ(table->num_rows(), 300);
+  // the chunks of 30 rows are merged
+  CHECK_LT(table->batches().size(), 10);
+  auto values = std::dynamic_pointer_cast<arrow::Int64Array>(
+      table->GetTable()->column(0)->chunk(0));
+  CHECK_EQ(values->Value(0), 0);
+
+  LOG(INFO) << "Passed chunked table tests...";
+
+  reader_client.Disconnect();
+  client.Disconnect();
+
+  return 0;
+}
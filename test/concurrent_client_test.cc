@@ -0,0 +1,92 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./concurrent_client_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the blocking get of the name doesn't block the requests of other threads
+  ObjectID named_id = InvalidObjectID();
+  std::thread waiter([&client, &named_id]() {
+    VINEYARD_CHECK_OK(
+        client.GetName("concurrent_client_test_name", named_id, true));
+  });
+
+  const size_t thread_count = 8, blob_count = 64;
+  std::vector<std::vector<ObjectID>> ids(thread_count);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&client, &ids, t, blob_count]() {
+      for (size_t i = 0; i < blob_count; ++i) {
+        std::unique_ptr<BlobWriter> writer;
+        VINEYARD_CHECK_OK(client.CreateBlob(i + 1, writer));
+        memset(writer->data(), static_cast<int>(t + i), i + 1);
+        ids[t].emplace_back(writer->Seal(client)->id());
+      }
+      for (size_t i = 0; i < blob_count; ++i) {
+        std::shared_ptr<Object> object;
+        VINEYARD_CHECK_OK(client.GetObject(ids[t][i], object));
+        auto blob = std::dynamic_pointer_cast<Blob>(object);
+        CHECK(blob != nullptr);
+        CHECK_EQ(blob->size(), i + 1);
+        for (size_t j = 0; j < blob->size(); ++j) {
+          CHECK_EQ(blob->data()[j], static_cast<char>(t + i));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  LOG(INFO) << "Passed concurrent create and get tests...";
+
+  VINEYARD_CHECK_OK(client.PutName(ids[0][0], "concurrent_client_test_name"));
+  waiter.join();
+  CHECK_EQ(named_id, ids[0][0]);
+  VINEYARD_CHECK_OK(client.DropName("concurrent_client_test_name"));
+  LOG(INFO) << "Passed concurrent blocking get name tests...";
+
+  for (auto const& blobs : ids) {
+    VINEYARD_CHECK_OK(client.DelData(blobs));
+  }
+
+  client.Disconnect();
+
+  return 0;
+}
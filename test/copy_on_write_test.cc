@@ -0,0 +1,134 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "basic/ds/pair.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/copy_on_write.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./copy_on_write_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<double> first_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  std::vector<double> second_array = {5.0, 6.0};
+  PairBuilder pair_builder(client);
+  pair_builder.SetFirst(
+      std::make_shared<ArrayBuilder<double>>(client, first_array));
+  pair_builder.SetSecond(
+      std::make_shared<ArrayBuilder<double>>(client, second_array));
+  auto pair = std::dynamic_pointer_cast<Pair>(pair_builder.Seal(client));
+  auto first = std::dynamic_pointer_cast<Array<double>>(pair->First());
+  auto second = std::dynamic_pointer_cast<Array<double>>(pair->Second());
+
+  // untouched views are plain shallow copies
+  {
+    std::unique_ptr<CopyOnWriteView> view;
+    VINEYARD_CHECK_OK(client.ShallowCopy(pair->id(), view));
+    ObjectID target_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(view->Seal(target_id));
+    CHECK(target_id != InvalidObjectID() && target_id != pair->id());
+    auto copied = std::dynamic_pointer_cast<Pair>(client.GetObject(target_id));
+    CHECK_EQ(copied->First()->id(), first->id());
+    CHECK_EQ(copied->Second()->id(), second->id());
+    VINEYARD_CHECK_OK(client.DelData(target_id));
+  }
+  LOG(INFO) << "Passed untouched copy-on-write view tests...";
+
+  {
+    std::unique_ptr<CopyOnWriteView> view;
+    VINEYARD_CHECK_OK(client.ShallowCopy(pair->id(), view));
+    BlobWriter* writer = nullptr;
+    // not a blob
+    CHECK(!view->Mutable(first->id(), writer).ok());
+
+    ObjectID blob_id = first->meta().GetMemberMeta("buffer_").GetId();
+    CHECK(!view->Touched(blob_id));
+    VINEYARD_CHECK_OK(view->Mutable(blob_id, writer));
+    CHECK(view->Touched(blob_id));
+    CHECK_EQ(writer->size(), first_array.size() * sizeof(double));
+    reinterpret_cast<double*>(writer->data())[1] = 70.0;
+    {
+      BlobWriter* same_writer = nullptr;
+      VINEYARD_CHECK_OK(view->Mutable(blob_id, same_writer));
+      CHECK_EQ(same_writer, writer);
+    }
+    VINEYARD_CHECK_OK(view->AddKeyValue("", "patched", true));
+
+    ObjectID target_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(view->Seal(target_id));
+    CHECK(!view->Mutable(blob_id, writer).ok());
+
+    auto copied = std::dynamic_pointer_cast<Pair>(client.GetObject(target_id));
+    CHECK(copied->meta().GetKeyValue<bool>("patched"));
+    auto copied_first =
+        std::dynamic_pointer_cast<Array<double>>(copied->First());
+    CHECK(copied_first->id() != first->id());
+    // the untouched member is shared
+    CHECK_EQ(copied->Second()->id(), second->id());
+    for (size_t i = 0; i < first_array.size(); ++i) {
+      CHECK_EQ((*copied_first)[i], i == 1 ? 70.0 : first_array[i]);
+      // the original object is not modified
+      CHECK_EQ((*first)[i], first_array[i]);
+    }
+    VINEYARD_CHECK_OK(client.DelData(target_id));
+  }
+  LOG(INFO) << "Passed copy-on-write blob tests...";
+
+  // add a member
+  {
+    std::unique_ptr<CopyOnWriteView> view;
+    VINEYARD_CHECK_OK(client.ShallowCopy(first->id(), view));
+    VINEYARD_CHECK_OK(view->SetMember("", "extra_", second->meta()));
+    CHECK(!view->SetMember("no_such_member", "extra_", second->meta()).ok());
+    ObjectID target_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(view->Seal(target_id));
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(target_id, meta));
+    CHECK_EQ(meta.GetMemberMeta("extra_").GetId(), second->id());
+    CHECK_EQ(meta.GetMemberMeta("buffer_").GetId(),
+             first->meta().GetMemberMeta("buffer_").GetId());
+    VINEYARD_CHECK_OK(client.DelData(target_id));
+  }
+  LOG(INFO) << "Passed copy-on-write member tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(pair->id(), true, true));
+
+  LOG(INFO) << "Passed copy-on-write tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
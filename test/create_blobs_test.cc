@@ -0,0 +1,88 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./create_blobs_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::shared_ptr<InstanceStatus> status_before;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_before));
+
+  std::vector<size_t> sizes;
+  for (size_t i = 0; i < 100; ++i) {
+    sizes.emplace_back((i + 1) * 1024);
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  VINEYARD_CHECK_OK(client.CreateBlobs(sizes, writers));
+  CHECK_EQ(writers.size(), sizes.size());
+
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < writers.size(); ++i) {
+    CHECK_EQ(writers[i]->size(), sizes[i]);
+    memset(writers[i]->data(), static_cast<int>(i), sizes[i]);
+    ids.emplace_back(writers[i]->Seal(client)->id());
+  }
+  CHECK_EQ(std::unordered_set<ObjectID>(ids.begin(), ids.end()).size(),
+           ids.size());
+
+  // read back through a new connection, all fds come in one batch
+  Client reader;
+  VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+  auto blobs = reader.GetObjects(ids);
+  CHECK_EQ(blobs.size(), ids.size());
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    auto blob = std::dynamic_pointer_cast<Blob>(blobs[i]);
+    CHECK_EQ(blob->size(), sizes[i]);
+    CHECK_EQ(blob->data()[0], static_cast<char>(i));
+    CHECK_EQ(blob->data()[sizes[i] - 1], static_cast<char>(i));
+  }
+  reader.Disconnect();
+
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+  std::shared_ptr<InstanceStatus> status_after;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+  CHECK_EQ(status_before->memory_usage, status_after->memory_usage);
+
+  LOG(INFO) << "Passed create blobs tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -102,6 +103,27 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed dataframe tests...";
 
+  {
+    std::shared_ptr<DataFrame> projected;
+    VINEYARD_CHECK_OK(
+        DataFrame::Project(client, seal_df->id(), {"b"}, projected));
+    CHECK_EQ(projected->Columns().size(), 1);
+    CHECK_EQ(projected->Columns()[0], "b");
+    CHECK_EQ(projected->shape().second, 1);
+    // only the blob of column 'b' is fetched
+    CHECK_EQ(projected->meta().GetBlobSet()->AllBlobIds().size(), 1);
+    auto column_b =
+        std::dynamic_pointer_cast<Tensor<int>>(projected->Column("b"));
+    auto data = column_b->data();
+    for (size_t i = 0; i < 100; ++i) {
+      CHECK_EQ(data[i], i * i * i);
+    }
+    CHECK(DataFrame::Project(client, seal_df->id(), {"c"}, projected)
+              .IsInvalid());
+  }
+
+  LOG(INFO) << "Passed dataframe projection tests...";
+
   client.Disconnect();
 
   return 0;
@@ -0,0 +1,98 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./deferred_delete_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::shared_ptr<InstanceStatus> status_before;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_before));
+
+  const size_t size = 1024 * 1024;
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(size, writer));
+  writer->data()[size - 1] = 'x';
+  ObjectID id = writer->Seal(client)->id();
+
+  Client reader;
+  VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+  auto blob = reader.GetObject<Blob>(id);
+  CHECK(blob != nullptr);
+
+  // the reader still has the blob mapped, the memory isn't freed
+  VINEYARD_CHECK_OK(client.DelData(id, true, true));
+  std::shared_ptr<InstanceStatus> status_deleting;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_deleting));
+  CHECK_EQ(status_deleting->deleting_objects,
+           status_before->deleting_objects + 1);
+  CHECK_GE(status_deleting->deleting_size,
+           status_before->deleting_size + size);
+  CHECK_GT(status_deleting->memory_usage, status_before->memory_usage);
+  CHECK_EQ(blob->data()[size - 1], 'x');
+
+  // but the blob is gone
+  std::shared_ptr<Object> object;
+  CHECK(!reader.GetObject(id, object).ok());
+
+  // freed at the last release
+  VINEYARD_CHECK_OK(reader.Release({id}));
+  std::shared_ptr<InstanceStatus> status_after;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+  CHECK_EQ(status_after->deleting_objects, status_before->deleting_objects);
+  CHECK_EQ(status_after->deleting_size, status_before->deleting_size);
+  CHECK_EQ(status_after->memory_usage, status_before->memory_usage);
+
+  // released when disconnecting as well
+  VINEYARD_CHECK_OK(client.CreateBlob(size, writer));
+  id = writer->Seal(client)->id();
+  CHECK(reader.GetObject<Blob>(id) != nullptr);
+  VINEYARD_CHECK_OK(client.DelData(id, true, true));
+  reader.Disconnect();
+  // the server notices the disconnection asynchronously
+  for (int retries = 0; retries < 100; ++retries) {
+    VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+    if (status_after->memory_usage == status_before->memory_usage) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  CHECK_EQ(status_after->memory_usage, status_before->memory_usage);
+
+  LOG(INFO) << "Passed deferred delete tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#if defined(WITH_CUDA)
+#include <cuda_runtime_api.h>
+#endif
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./device_blob_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  if (status->device_memory_limit == 0) {
+    // the server rejects device blobs, without touching the bulk store
+    std::unique_ptr<BlobWriter> writer;
+    auto s = client.CreateDeviceBlob(1024, writer);
+    CHECK(!s.ok());
+    CHECK(s.IsInvalid() || s.IsNotImplemented());
+    std::shared_ptr<InstanceStatus> status_after;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+    CHECK_EQ(status->memory_usage, status_after->memory_usage);
+    LOG(INFO) << "Device blobs are disabled, skip the device blob tests";
+    client.Disconnect();
+    return 0;
+  }
+
+#if defined(WITH_CUDA)
+  size_t const size = 1024 * 1024;
+  std::vector<uint8_t> expected(size);
+  for (size_t i = 0; i < size; ++i) {
+    expected[i] = static_cast<uint8_t>(i % 251);
+  }
+
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateDeviceBlob(size, writer, 0));
+  CHECK_EQ(writer->size(), size);
+  CHECK_EQ(writer->device_id(), 0);
+  CHECK_EQ(cudaMemcpy(writer->data(), expected.data(), size,
+                      cudaMemcpyHostToDevice),
+           cudaSuccess);
+  auto id = writer->Seal(client)->id();
+
+  {
+    std::shared_ptr<InstanceStatus> status_after;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+    CHECK_EQ(status_after->device_memory_usage,
+             status->device_memory_usage + size);
+    // device blobs don't occupy the shared memory
+    CHECK_EQ(status_after->memory_usage, status->memory_usage);
+  }
+
+  // read back through a new connection by the CUDA IPC handle
+  Client reader;
+  VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+  auto blob = std::dynamic_pointer_cast<Blob>(reader.GetObject(id));
+  CHECK(blob != nullptr);
+  CHECK_EQ(blob->size(), size);
+  CHECK_EQ(blob->device_id(), 0);
+  std::vector<uint8_t> actual(size);
+  CHECK_EQ(cudaMemcpy(actual.data(), blob->data(), size,
+                      cudaMemcpyDeviceToHost),
+           cudaSuccess);
+  CHECK(actual == expected);
+  reader.Disconnect();
+
+  VINEYARD_CHECK_OK(client.DelData(id));
+  {
+    std::shared_ptr<InstanceStatus> status_after;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+    CHECK_EQ(status_after->device_memory_usage, status->device_memory_usage);
+  }
+  LOG(INFO) << "Passed device blob tests...";
+#endif
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+#include "arrow/util/config.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/encoded_array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "glog/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+template <typename T>
+void CheckEncodedArray(Client& client,
+                       std::shared_ptr<arrow::Array> const& source,
+                       ArrayEncoding const encoding) {
+  using array_t = typename ConvertToArrowType<T>::ArrayType;
+  auto array = std::dynamic_pointer_cast<array_t>(source);
+  EncodedArrayBuilder<T> builder(client, array, encoding);
+  auto sealed =
+      std::dynamic_pointer_cast<EncodedArray<T>>(builder.Seal(client));
+  VINEYARD_CHECK_OK(client.Persist(sealed->id()));
+
+  auto encoded = std::dynamic_pointer_cast<EncodedArray<T>>(
+      client.GetObject(sealed->id()));
+  CHECK_EQ(encoded->length(), static_cast<size_t>(array->length()));
+  CHECK_EQ(encoded->null_count(), array->null_count());
+  for (int64_t i = 0; i < array->length(); ++i) {
+    CHECK_EQ(encoded->IsNull(i), array->IsNull(i));
+    if (!array->IsNull(i)) {
+      CHECK_EQ(encoded->Value(i), array->Value(i));
+    }
+  }
+  std::vector<T> values(array->length() / 2);
+  encoded->Decode(array->length() / 4, array->length() / 4 + values.size(),
+                  values.data());
+  for (size_t i = 0; i < values.size(); ++i) {
+    CHECK_EQ(values[i], array->Value(array->length() / 4 + i));
+  }
+  CHECK(encoded->GetArray()->Equals(*array));
+  VINEYARD_CHECK_OK(client.DelData(sealed->id()));
+}
+
+template <typename T>
+void CheckEncodings(Client& client, std::shared_ptr<arrow::Array> const& array,
+                    std::string const& name) {
+  for (auto encoding : {ArrayEncoding::kPlain, ArrayEncoding::kRLE,
+                        ArrayEncoding::kFOR, ArrayEncoding::kDelta,
+                        ArrayEncoding::kAuto}) {
+    CheckEncodedArray<T>(client, array, encoding);
+    CheckEncodedArray<T>(client, array->Slice(1500, 3000), encoding);
+  }
+  LOG(INFO) << "Passed encoded array tests for " << name << "...";
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./encoded_array_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::mt19937_64 random(2021);
+  size_t const length = 10007;
+
+  {
+    // sorted offsets, suits for delta encoding
+    arrow::Int64Builder builder;
+    int64_t value = 0;
+    for (size_t i = 0; i < length; ++i) {
+      value += random() % 20;
+      CHECK_ARROW_ERROR(builder.Append(value));
+    }
+    std::shared_ptr<arrow::Array> array;
+    CHECK_ARROW_ERROR(builder.Finish(&array));
+    CheckEncodings<int64_t>(client, array, "sorted int64");
+  }
+
+  {
+    // long runs with nulls, suits for run-length encoding
+    arrow::Int32Builder builder;
+    for (size_t i = 0; i < length; ++i) {
+      if (i % 13 == 0) {
+        CHECK_ARROW_ERROR(builder.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(builder.Append((i / 700) % 5 - 2));
+      }
+    }
+    std::shared_ptr<arrow::Array> array;
+    CHECK_ARROW_ERROR(builder.Finish(&array));
+    CheckEncodings<int32_t>(client, array, "runs int32");
+  }
+
+  {
+    // small signed values, suits for frame-of-reference
+    arrow::Int16Builder builder;
+    for (size_t i = 0; i < length; ++i) {
+      CHECK_ARROW_ERROR(builder.Append(static_cast<int16_t>(
+          static_cast<int>(random() % 1000) - 500)));
+    }
+    std::shared_ptr<arrow::Array> array;
+    CHECK_ARROW_ERROR(builder.Finish(&array));
+    CheckEncodings<int16_t>(client, array, "small int16");
+  }
+
+  {
+    // full range values, can't be compressed
+    arrow::UInt64Builder builder;
+    for (size_t i = 0; i < length; ++i) {
+      CHECK_ARROW_ERROR(builder.Append(random()));
+    }
+    std::shared_ptr<arrow::Array> array;
+    CHECK_ARROW_ERROR(builder.Finish(&array));
+    CheckEncodings<uint64_t>(client, array, "random uint64");
+  }
+
+  {
+    // encodings of columns in table builder
+    arrow::Int64Builder b1;
+    arrow::DoubleBuilder b2;
+    arrow::StringBuilder b3;
+    for (size_t i = 0; i < length; ++i) {
+      CHECK_ARROW_ERROR(b1.Append(static_cast<int64_t>(i * 3)));
+      CHECK_ARROW_ERROR(b2.Append(static_cast<double>(i) / 3));
+      CHECK_ARROW_ERROR(b3.Append(std::to_string(i)));
+    }
+    std::shared_ptr<arrow::Array> a1, a2, a3;
+    CHECK_ARROW_ERROR(b1.Finish(&a1));
+    CHECK_ARROW_ERROR(b2.Finish(&a2));
+    CHECK_ARROW_ERROR(b3.Finish(&a3));
+    auto schema = arrow::schema({arrow::field("f1", arrow::int64()),
+                                 arrow::field("f2", arrow::float64()),
+                                 arrow::field("f3", arrow::utf8())});
+    auto table = arrow::Table::Make(schema, {a1, a2, a3});
+
+    TableBuilder builder(client, table);
+    VINEYARD_CHECK_OK(builder.SetColumnEncoding("f1", ArrayEncoding::kAuto));
+    // the encodings of non-integer columns are ignored
+    VINEYARD_CHECK_OK(builder.SetColumnEncoding(2, ArrayEncoding::kFOR));
+    CHECK(builder.SetColumnEncoding("f4", ArrayEncoding::kFOR).IsInvalid());
+    auto sealed = std::dynamic_pointer_cast<Table>(builder.Seal(client));
+    VINEYARD_CHECK_OK(client.Persist(sealed->id()));
+
+    auto result =
+        std::dynamic_pointer_cast<Table>(client.GetObject(sealed->id()));
+    CHECK(result->GetTable()->Equals(*table));
+    auto column = std::dynamic_pointer_cast<EncodedArray<int64_t>>(
+        result->batches()[0]->columns()[0]);
+    CHECK(column != nullptr);
+    CHECK_LT(column->encoded_size(), length * sizeof(int64_t) / 4);
+    CHECK(std::dynamic_pointer_cast<StringArray>(
+              result->batches()[0]->columns()[2]) != nullptr);
+    VINEYARD_CHECK_OK(client.DelData(sealed->id(), true, true));
+    LOG(INFO) << "Passed table builder encoding tests...";
+  }
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed encoded array tests...";
+
+  return 0;
+}
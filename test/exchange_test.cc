@@ -0,0 +1,161 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/c/bridge.h"
+#include "arrow/util/config.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/exchange.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./exchange_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    arrow::Int64Builder builder;
+    CHECK_ARROW_ERROR(builder.AppendValues({1, 2, 3, 4}));
+    CHECK_ARROW_ERROR(builder.AppendNull());
+    std::shared_ptr<arrow::Int64Array> expected;
+    CHECK_ARROW_ERROR(builder.Finish(&expected));
+    NumericArrayBuilder<int64_t> array_builder(client, expected);
+    auto array = array_builder.Seal(client);
+    auto internal_array =
+        std::dynamic_pointer_cast<NumericArray<int64_t>>(array)->GetArray();
+
+    struct ArrowArray c_array;
+    struct ArrowSchema c_schema;
+    VINEYARD_CHECK_OK(ExportArrowArray(array, &c_array, &c_schema));
+    // the exported array keeps the object alive
+    array.reset();
+    std::shared_ptr<arrow::Array> imported;
+    CHECK_ARROW_ERROR_AND_ASSIGN(imported,
+                                 arrow::ImportArray(&c_array, &c_schema));
+    CHECK(imported->Equals(*expected));
+    // zero-copy
+    CHECK_EQ(imported->data()->buffers[1]->data(),
+             internal_array->data()->buffers[1]->data());
+    LOG(INFO) << "Passed array export tests...";
+  }
+
+  {
+    arrow::StringBuilder key_builder;
+    arrow::DoubleBuilder value_builder;
+    for (int64_t i = 0; i < 100; ++i) {
+      CHECK_ARROW_ERROR(key_builder.Append(std::to_string(i)));
+      CHECK_ARROW_ERROR(value_builder.Append(i * 0.5));
+    }
+    std::shared_ptr<arrow::Array> keys, values;
+    CHECK_ARROW_ERROR(key_builder.Finish(&keys));
+    CHECK_ARROW_ERROR(value_builder.Finish(&values));
+    auto schema = arrow::schema({arrow::field("key", arrow::utf8()),
+                                 arrow::field("value", arrow::float64())});
+    auto expected = arrow::RecordBatch::Make(schema, 100, {keys, values});
+    RecordBatchBuilder batch_builder(client, expected);
+    auto batch = batch_builder.Seal(client);
+
+    struct ArrowArray c_array;
+    struct ArrowSchema c_schema;
+    VINEYARD_CHECK_OK(ExportArrowArray(batch, &c_array, &c_schema));
+    std::shared_ptr<arrow::RecordBatch> imported;
+    CHECK_ARROW_ERROR_AND_ASSIGN(
+        imported, arrow::ImportRecordBatch(&c_array, &c_schema));
+    CHECK(imported->Equals(*expected));
+
+    VINEYARD_CHECK_OK(ExportArrowSchema(batch, &c_schema));
+    std::shared_ptr<arrow::Schema> imported_schema;
+    CHECK_ARROW_ERROR_AND_ASSIGN(imported_schema,
+                                 arrow::ImportSchema(&c_schema));
+    CHECK(imported_schema->Equals(*schema));
+
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 2000000
+    std::shared_ptr<arrow::Table> table;
+    CHECK_ARROW_ERROR_AND_ASSIGN(
+        table, arrow::Table::FromRecordBatches({expected, expected}));
+    TableBuilder table_builder(client, table);
+    auto sealed_table = table_builder.Seal(client);
+    struct ArrowArrayStream c_stream;
+    VINEYARD_CHECK_OK(ExportArrowArrayStream(sealed_table, &c_stream));
+    std::shared_ptr<arrow::RecordBatchReader> reader;
+    CHECK_ARROW_ERROR_AND_ASSIGN(reader,
+                                 arrow::ImportRecordBatchReader(&c_stream));
+    size_t batches = 0;
+    while (true) {
+      std::shared_ptr<arrow::RecordBatch> next;
+      CHECK_ARROW_ERROR(reader->ReadNext(&next));
+      if (next == nullptr) {
+        break;
+      }
+      CHECK(next->Equals(*expected));
+      batches += 1;
+    }
+    CHECK_EQ(batches, 2);
+#endif
+    LOG(INFO) << "Passed record batch export tests...";
+  }
+
+  {
+    TensorBuilder<double> builder(client, {2, 3});
+    for (int i = 0; i < 6; ++i) {
+      builder.data()[i] = i;
+    }
+    auto tensor = builder.Seal(client);
+    auto data = std::dynamic_pointer_cast<Tensor<double>>(tensor)->data();
+
+    DLManagedTensor* managed = nullptr;
+    VINEYARD_CHECK_OK(ExportDLPack(tensor, &managed));
+    tensor.reset();
+    DLTensor const& dl_tensor = managed->dl_tensor;
+    CHECK_EQ(dl_tensor.data, data);
+    CHECK_EQ(dl_tensor.ndim, 2);
+    CHECK_EQ(dl_tensor.shape[0], 2);
+    CHECK_EQ(dl_tensor.shape[1], 3);
+    CHECK_EQ(dl_tensor.strides[0], 3);
+    CHECK_EQ(dl_tensor.strides[1], 1);
+    CHECK_EQ(dl_tensor.dtype.code, kDLFloat);
+    CHECK_EQ(dl_tensor.dtype.bits, 64);
+    CHECK_EQ(static_cast<double*>(dl_tensor.data)[5], 5);
+    managed->deleter(managed);
+
+    // arrays are not tensors
+    arrow::Int64Builder array_builder;
+    CHECK_ARROW_ERROR(array_builder.Append(1));
+    std::shared_ptr<arrow::Int64Array> array;
+    CHECK_ARROW_ERROR(array_builder.Finish(&array));
+    NumericArrayBuilder<int64_t> numeric_builder(client, array);
+    CHECK(!ExportDLPack(numeric_builder.Seal(client), &managed).ok());
+    LOG(INFO) << "Passed DLPack export tests...";
+  }
+
+  client.Disconnect();
+
+  return 0;
+}
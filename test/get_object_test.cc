@@ -86,6 +86,28 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed various ways to get object tests...";
 
+  {
+    std::vector<ObjectID> ids;
+    for (size_t index = 0; index < 64; ++index) {
+      std::vector<double> values(index + 1, static_cast<double>(index));
+      ArrayBuilder<double> array_builder(client, values);
+      ids.emplace_back(array_builder.Seal(client)->id());
+    }
+    client.SetConstructConcurrency(4);
+    auto objects = client.GetObjects(ids);
+    CHECK_EQ(objects.size(), ids.size());
+    for (size_t index = 0; index < ids.size(); ++index) {
+      auto array = std::dynamic_pointer_cast<Array<double>>(objects[index]);
+      CHECK(array != nullptr);
+      CHECK_EQ(array->id(), ids[index]);
+      CHECK_EQ(array->size(), index + 1);
+      CHECK_EQ(array->data()[index], static_cast<double>(index));
+    }
+    client.SetConstructConcurrency(1);
+  }
+
+  LOG(INFO) << "Passed parallel construction tests...";
+
   client.Disconnect();
 
   return 0;
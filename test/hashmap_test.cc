@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "flat_hash_map/flat_hash_map.hpp"
 #include "glog/logging.h"
@@ -73,6 +74,62 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed double hashmap tests...";
 
+  {
+    HashmapBuilder<int64_t, int64_t> builder(client);
+    for (int64_t i = 0; i < 10000; ++i) {
+      builder[i * 2] = i;
+    }
+    auto hashmap = std::dynamic_pointer_cast<Hashmap<int64_t, int64_t>>(
+        builder.Seal(client));
+    // both existing and missing keys, with a partial block at the end
+    std::vector<int64_t> keys;
+    for (int64_t i = 0; i < 19999; ++i) {
+      keys.emplace_back(i);
+    }
+    std::vector<Hashmap<int64_t, int64_t>::iterator> iters(keys.size());
+    CHECK_EQ(hashmap->find_batch(keys.data(), keys.size(), iters.data()),
+             10000);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (keys[i] % 2 == 0) {
+        CHECK(iters[i] != hashmap->end());
+        CHECK_EQ(iters[i]->second, keys[i] / 2);
+      } else {
+        CHECK(iters[i] == hashmap->end());
+      }
+    }
+  }
+
+  LOG(INFO) << "Passed batch lookup hashmap tests...";
+
+  {
+    // enough items for multiple threads, with duplicated keys
+    std::vector<std::pair<int64_t, int64_t>> entries;
+    for (int64_t i = 0; i < 400000; ++i) {
+      entries.emplace_back(i % 300000 * 7, i);
+    }
+    ParallelHashmapBuilder<int64_t, int64_t> builder(client,
+                                                     std::move(entries), 4);
+    auto hashmap = std::dynamic_pointer_cast<Hashmap<int64_t, int64_t>>(
+        builder.Seal(client));
+    CHECK_EQ(hashmap->size(), 300000);
+    for (int64_t i = 0; i < 300000; ++i) {
+      CHECK_EQ(hashmap->at(i * 7), i);
+      CHECK(hashmap->find(i * 7 + 1) == hashmap->end());
+    }
+    size_t count = 0;
+    for (auto iter = hashmap->begin(); iter != hashmap->end(); ++iter) {
+      CHECK_EQ(iter->first, iter->second * 7);
+      count += 1;
+    }
+    CHECK_EQ(count, 300000);
+
+    auto vy_hashmap = std::dynamic_pointer_cast<Hashmap<int64_t, int64_t>>(
+        client.GetObject(hashmap->id()));
+    CHECK_EQ(vy_hashmap->at(299999 * 7), 299999);
+  }
+
+  LOG(INFO) << "Passed parallel hashmap builder tests...";
+
   client.Disconnect();
 
   return 0;
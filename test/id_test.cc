@@ -15,6 +15,9 @@ limitations under the License.
 
 #include <bitset>
 #include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
 
 #include "glog/logging.h"
 
@@ -30,4 +33,42 @@ int main() {
   ObjectID id2 = vineyard::GenerateObjectID();
   LOG(INFO) << id2 << "\n";
   CHECK(!vineyard::IsBlob(id2));
+  CHECK(vineyard::ObjectIDInstance(id2) ==
+        vineyard::UnspecifiedInstanceID());
+  CHECK(vineyard::ObjectIDInstance(id1) ==
+        vineyard::UnspecifiedInstanceID());
+
+  // the ids embed the instance, and never collide across threads
+  vineyard::SetObjectIDInstance(7);
+  std::vector<std::vector<ObjectID>> ids(4);
+  std::vector<std::thread> threads;
+  for (auto& thread_ids : ids) {
+    threads.emplace_back([&thread_ids]() {
+      for (int index = 0; index < 10000; ++index) {
+        thread_ids.emplace_back(vineyard::GenerateObjectID());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::set<ObjectID> unique_ids;
+  for (auto const& thread_ids : ids) {
+    for (auto const id : thread_ids) {
+      CHECK(!vineyard::IsBlob(id));
+      CHECK(vineyard::ObjectIDInstance(id) == 7);
+      unique_ids.emplace(id);
+    }
+    // monotonic in every thread
+    for (size_t index = 1; index < thread_ids.size(); ++index) {
+      CHECK(thread_ids[index - 1] < thread_ids[index]);
+    }
+  }
+  CHECK(unique_ids.size() == 4 * 10000);
+
+  // the instances beyond 10 bits fallback to the legacy ids
+  vineyard::SetObjectIDInstance(4096);
+  CHECK(vineyard::ObjectIDInstance(vineyard::GenerateObjectID()) ==
+        vineyard::UnspecifiedInstanceID());
+  vineyard::SetObjectIDInstance(vineyard::UnspecifiedInstanceID());
 }
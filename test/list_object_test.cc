@@ -14,8 +14,10 @@ limitations under the License.
 */
 
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
+#include <unordered_map>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -51,6 +53,40 @@ int main(int argc, char** argv) {
   auto targets = client.ListObjects("vineyard::Tensor*");
   CHECK(!targets.empty());
 
+  // list by pages
+  {
+    for (int i = 0; i < 4; ++i) {
+      TensorBuilder<double> builder(client, {2, 3});
+      builder.Seal(client);
+    }
+    std::unordered_map<ObjectID, ptree> all;
+    VINEYARD_CHECK_OK(
+        client.ListData("vineyard::Tensor<*", false, SIZE_MAX, all));
+    CHECK_GE(all.size(), 5);
+
+    std::set<ObjectID> paged;
+    std::string cursor;
+    size_t pages = 0;
+    do {
+      std::unordered_map<ObjectID, ptree> page;
+      VINEYARD_CHECK_OK(
+          client.ListData("vineyard::Tensor<*", false, 2, cursor, page));
+      CHECK_LE(page.size(), 2);
+      for (auto const& kv : page) {
+        CHECK(paged.emplace(kv.first).second);
+        CHECK(all.find(kv.first) != all.end());
+      }
+      pages += 1;
+    } while (!cursor.empty());
+    CHECK_EQ(paged.size(), all.size());
+    CHECK_EQ(pages, (all.size() + 1) / 2);
+
+    std::unordered_map<ObjectID, ptree> matched;
+    VINEYARD_CHECK_OK(
+        client.ListData("vineyard::Tensor<.*>", true, SIZE_MAX, matched));
+    CHECK_EQ(matched.size(), all.size());
+  }
+
   LOG(INFO) << "Passed list objects tests...";
 
   client.Disconnect();
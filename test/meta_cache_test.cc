@@ -0,0 +1,101 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+size_t get_data_requests(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status->metrics.get<size_t>("requests.get_data_request.count", 0);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./meta_cache_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client, other_client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(other_client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<int64_t> values = {1, 2, 3, 4, 5, 6, 7, 8};
+  ArrayBuilder<int64_t> builder(client, values);
+  auto sealed = builder.Seal(client);
+  ObjectID id = sealed->id();
+
+  // repeated gets are served from the cache
+  auto array = client.GetObject<Array<int64_t>>(id);
+  CHECK_EQ(array->size(), values.size());
+  CHECK_EQ(client.MetaCacheSize(), 1);
+  size_t requests_before = get_data_requests(client);
+  for (int i = 0; i < 16; ++i) {
+    auto cached = client.GetObject<Array<int64_t>>(id);
+    CHECK_EQ(cached->size(), values.size());
+    for (size_t j = 0; j < values.size(); ++j) {
+      CHECK_EQ(cached->data()[j], values[j]);
+    }
+  }
+  std::vector<ObjectMeta> metas;
+  VINEYARD_CHECK_OK(client.GetMetaData({id}, metas));
+  CHECK_EQ(metas[0].GetId(), id);
+  CHECK_EQ(get_data_requests(client), requests_before);
+
+  // deleted by another client, the cached entry is dropped once the
+  // notification arrives, which precedes the following reply.
+  VINEYARD_CHECK_OK(other_client.DelData(id, true, true));
+  bool exists = true;
+  VINEYARD_CHECK_OK(client.Exists(id, exists));
+  CHECK(!exists);
+  CHECK_EQ(client.MetaCacheSize(), 0);
+  ObjectMeta meta;
+  CHECK(!client.GetMetaData(id, meta).ok());
+
+  // the least recently used entries are evicted
+  client.SetMetaCacheCapacity(2);
+  std::vector<ObjectID> ids;
+  for (int i = 0; i < 4; ++i) {
+    ArrayBuilder<int64_t> builder(client, values);
+    ids.emplace_back(builder.Seal(client)->id());
+    VINEYARD_CHECK_OK(client.GetMetaData(ids.back(), meta));
+  }
+  CHECK_EQ(client.MetaCacheSize(), 2);
+  client.SetMetaCacheCapacity(0);
+  CHECK_EQ(client.MetaCacheSize(), 0);
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+
+  LOG(INFO) << "Passed metadata cache tests...";
+
+  client.Disconnect();
+  other_client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./metrics_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t request_count = 16;
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < request_count; ++i) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(1024, writer));
+    ids.emplace_back(writer->Seal(client)->id());
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(ids.back(), meta));
+  }
+
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  auto const& requests = status->metrics.get_child("requests");
+  CHECK_GE(requests.get<size_t>("create_buffer_request.count"),
+           request_count);
+  CHECK_GE(requests.get<size_t>("get_data_request.count"), request_count);
+  CHECK_GE(requests.get<size_t>("get_data_request.p99"),
+           requests.get<size_t>("get_data_request.p50"));
+  CHECK_GE(requests.get<size_t>("get_data_request.max"),
+           requests.get<size_t>("get_data_request.p99"));
+  CHECK_GT(status->metrics.get<size_t>("bytes_in"), 0);
+  CHECK_GT(status->metrics.get<size_t>("bytes_out"), 0);
+  CHECK_GT(status->meta_nodes, 0);
+  CHECK_GT(status->meta_memory_usage, 0);
+
+  // the metadata service
+  std::vector<ObjectID> persisted;
+  for (size_t i = 0; i < request_count; ++i) {
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::MetricsTest");
+    meta.SetNBytes(0);
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+    persisted.emplace_back(id);
+  }
+  VINEYARD_CHECK_OK(client.Persist(persisted));
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  CHECK_GT(status->metrics.get<size_t>("etcd_txn_ops.count"), 0);
+  CHECK_GT(status->metrics.get<size_t>("etcd_txn_ops.max"), 0);
+  CHECK_GT(status->metrics.get<size_t>("etcd_txn_bytes.max"), 0);
+  CHECK_GT(status->metrics.get<size_t>("meta_requests.count"), 0);
+  VINEYARD_CHECK_OK(client.DelData(persisted, true, true));
+
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+
+  LOG(INFO) << "Passed metrics tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
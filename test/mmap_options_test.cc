@@ -0,0 +1,163 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./mmap_options_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the mappings are populated and pre-touched eagerly
+  MmapOptions options;
+  options.populate = true;
+  options.pretouch_threads = 4;
+  client.SetMmapOptions(options);
+
+  std::vector<int64_t> values(1024 * 1024);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = i;
+  }
+  ArrayBuilder<int64_t> builder(client, values);
+  ObjectID id = builder.Seal(client)->id();
+
+  Client other_client;
+  VINEYARD_CHECK_OK(other_client.Connect(ipc_socket));
+  other_client.SetMmapOptions(options);
+  ObjectMeta meta;
+  VINEYARD_CHECK_OK(other_client.GetMetaData(id, meta));
+  auto array = std::dynamic_pointer_cast<Array<int64_t>>(
+      other_client.GetObject(id));
+  for (size_t i = 0; i < values.size(); ++i) {
+    CHECK_EQ(array->data()[i], values[i]);
+  }
+
+  // pre-faulting per object
+  MmapOptions populate_options;
+  populate_options.pretouch_threads = 2;
+  VINEYARD_CHECK_OK(other_client.Populate(meta, populate_options));
+
+  // locking is subject to RLIMIT_MEMLOCK
+  populate_options.lock = true;
+  auto status = other_client.Populate(meta, populate_options);
+  if (status.ok()) {
+    VINEYARD_CHECK_OK(other_client.Unlock(meta));
+  } else {
+    LOG(INFO) << "Locking is not permitted: " << status.ToString();
+  }
+
+  {
+    // the readonly mappings are unmapped once no blob references them
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    reader.SetMetaCacheCapacity(0);
+    MmapOptions bounded_options;
+    bounded_options.max_readonly_mappings = 1;
+    reader.SetMmapOptions(bounded_options);
+
+    auto object = reader.GetObject<Array<int64_t>>(id);
+    CHECK(object != nullptr);
+    MmapStats stats = reader.GetMmapStats();
+    CHECK_GE(stats.segments, 1);
+    CHECK_EQ(stats.readonly_mappings, 1);
+    CHECK_EQ(stats.readwrite_mappings, 0);
+    CHECK_GT(stats.mapped_bytes, 0);
+
+    // referenced by the array
+    CHECK_EQ(reader.ReleaseUnusedMappings(), 0);
+    object.reset();
+    CHECK_EQ(reader.ReleaseUnusedMappings(), 1);
+    stats = reader.GetMmapStats();
+    CHECK_EQ(stats.readonly_mappings, 0);
+    CHECK_EQ(stats.unmaps, 1);
+
+    // mapped again on the next access
+    object = reader.GetObject<Array<int64_t>>(id);
+    CHECK_EQ(object->data()[values.size() - 1], values.back());
+    stats = reader.GetMmapStats();
+    CHECK_EQ(stats.readonly_mappings, 1);
+    CHECK_EQ(stats.remaps, 1);
+    reader.Disconnect();
+  }
+
+  {
+    // the segment that is being mapped is never evicted, even if the others
+    // are all referenced
+    std::vector<int64_t> large_values(8 * values.size());
+    for (size_t i = 0; i < large_values.size(); ++i) {
+      large_values[i] = i * 2;
+    }
+    ArrayBuilder<int64_t> large_builder(client, large_values);
+    ObjectID large_id = large_builder.Seal(client)->id();
+
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    reader.SetMetaCacheCapacity(0);
+    MmapOptions bounded_options;
+    bounded_options.max_readonly_mappings = 1;
+    reader.SetMmapOptions(bounded_options);
+
+    auto object = reader.GetObject<Array<int64_t>>(id);
+    CHECK(object != nullptr);
+    size_t segments = reader.GetMmapStats().segments;
+    auto large_object = reader.GetObject<Array<int64_t>>(large_id);
+    CHECK(large_object != nullptr);
+    MmapStats stats = reader.GetMmapStats();
+    if (stats.segments > segments) {
+      // both segments are referenced, thus both are kept
+      CHECK_EQ(stats.readonly_mappings, 2);
+      CHECK_EQ(stats.unmaps, 0);
+    } else {
+      LOG(INFO) << "The two arrays are allocated in the same segment";
+    }
+    CHECK_EQ(large_object->data()[large_values.size() - 1],
+             large_values.back());
+    CHECK_EQ(object->data()[values.size() - 1], values.back());
+
+    object.reset();
+    large_object.reset();
+    reader.Disconnect();
+    VINEYARD_CHECK_OK(client.DelData(large_id, true, true));
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(id, true, true));
+
+  LOG(INFO) << "Passed mmap options tests...";
+
+  other_client.Disconnect();
+  client.Disconnect();
+
+  return 0;
+}
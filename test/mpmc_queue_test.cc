@@ -0,0 +1,100 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "common/util/blocking_queue.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  {
+    MPMCQueue<std::string> queue(3);
+    CHECK_EQ(queue.Capacity(), 4);
+    for (size_t index = 0; index < queue.Capacity(); ++index) {
+      CHECK(queue.TryPush(std::to_string(index)));
+    }
+    CHECK(!queue.TryPush("full"));
+    std::string item;
+    CHECK(queue.TryPop(item));
+    CHECK_EQ(item, "0");
+    std::vector<std::string> items(8);
+    CHECK_EQ(queue.TryPopBatch(items.data(), items.size()), 3);
+    CHECK_EQ(items[2], "3");
+    CHECK(!queue.TryPop(item));
+    CHECK_EQ(queue.TryPushBatch(items.data(), items.size()), 4);
+    CHECK_EQ(queue.Size(), 4);
+  }
+
+  LOG(INFO) << "Passed MPMC queue basic tests...";
+
+  {
+    const int producers = 4, consumers = 4;
+    const int64_t items_per_producer = 200000;
+    MPMCQueue<int64_t> queue(64);
+    queue.SetProducerNum(producers);
+    std::atomic<int64_t> sum{0}, count{0};
+    std::vector<std::thread> threads;
+    for (int producer = 0; producer < producers; ++producer) {
+      threads.emplace_back([&, producer]() {
+        int64_t batch[16];
+        int64_t next = 0;
+        while (next < items_per_producer) {
+          if (producer % 2 == 0) {
+            queue.Put(next + 1);
+            next += 1;
+            continue;
+          }
+          size_t size = std::min<int64_t>(16, items_per_producer - next);
+          for (size_t index = 0; index < size; ++index) {
+            batch[index] = next + index + 1;
+          }
+          size_t pushed = 0;
+          while (pushed < size) {
+            pushed += queue.TryPushBatch(batch + pushed, size - pushed);
+          }
+          next += size;
+        }
+        queue.DecProducerNum();
+      });
+    }
+    for (int consumer = 0; consumer < consumers; ++consumer) {
+      threads.emplace_back([&]() {
+        int64_t item = 0;
+        while (queue.Get(item)) {
+          sum += item;
+          count += 1;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    CHECK_EQ(count.load(), producers * items_per_producer);
+    CHECK_EQ(sum.load(),
+             producers * items_per_producer * (items_per_producer + 1) / 2);
+    CHECK(queue.End());
+  }
+
+  LOG(INFO) << "Passed MPMC queue concurrent tests...";
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kChunks = 16;
+constexpr size_t kReaders = 2;
+
+ObjectID create_stream(Client& client, size_t const readers,
+                       bool const parallel) {
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::ByteStream");
+  meta.SetNBytes(0);
+  ObjectID stream_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, stream_id));
+  VINEYARD_CHECK_OK(client.CreateStream(stream_id, 2, readers, parallel));
+  return stream_id;
+}
+
+// returns the first byte of every chunk that is received by the reader
+std::vector<uint8_t> read_stream(std::string const& ipc_socket,
+                                 ObjectID const stream_id) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  std::vector<uint8_t> received;
+  while (true) {
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    auto status = client.PullNextStreamChunk(stream_id, buffer);
+    if (!status.ok()) {
+      CHECK(status.IsStreamDrained());
+      break;
+    }
+    CHECK(buffer != nullptr);
+    received.emplace_back(buffer->data()[0]);
+  }
+  client.Disconnect();
+  return received;
+}
+
+void write_stream(std::string const& ipc_socket, ObjectID const stream_id) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  for (size_t idx = 0; idx < kChunks; ++idx) {
+    std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+    VINEYARD_CHECK_OK(client.GetNextStreamChunk(stream_id, 1024, buffer));
+    CHECK(buffer != nullptr);
+    buffer->mutable_data()[0] = static_cast<uint8_t>(idx);
+  }
+  VINEYARD_CHECK_OK(client.StopStream(stream_id, false));
+  client.Disconnect();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./multi_consumer_stream_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // broadcast: every reader receives all chunks in order
+  {
+    ObjectID stream_id = create_stream(client, kReaders, false);
+    std::vector<std::vector<uint8_t>> received(kReaders);
+    std::vector<std::thread> readers;
+    for (size_t index = 0; index < kReaders; ++index) {
+      readers.emplace_back([&, index]() {
+        received[index] = read_stream(ipc_socket, stream_id);
+      });
+    }
+    std::thread writer([&]() { write_stream(ipc_socket, stream_id); });
+    writer.join();
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    for (auto const& chunks : received) {
+      CHECK_EQ(chunks.size(), kChunks);
+      for (size_t idx = 0; idx < kChunks; ++idx) {
+        CHECK_EQ(chunks[idx], idx);
+      }
+    }
+    LOG(INFO) << "Passed broadcast stream tests...";
+  }
+
+  // parallel: every chunk is received by exactly one reader
+  {
+    ObjectID stream_id = create_stream(client, 1, true);
+    std::vector<std::vector<uint8_t>> received(kReaders);
+    std::vector<std::thread> readers;
+    for (size_t index = 0; index < kReaders; ++index) {
+      readers.emplace_back([&, index]() {
+        received[index] = read_stream(ipc_socket, stream_id);
+      });
+    }
+    std::thread writer([&]() { write_stream(ipc_socket, stream_id); });
+    writer.join();
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    std::vector<size_t> counts(kChunks, 0);
+    for (auto const& chunks : received) {
+      for (auto chunk : chunks) {
+        CHECK_LT(chunk, kChunks);
+        counts[chunk] += 1;
+      }
+    }
+    for (size_t idx = 0; idx < kChunks; ++idx) {
+      CHECK_EQ(counts[idx], 1);
+    }
+    LOG(INFO) << "Passed parallel stream tests...";
+  }
+
+  LOG(INFO) << "Passed multi-consumer stream tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+
+#include "glog/logging.h"
+
+#include "client/ds/object_meta.h"
+#include "common/util/ptree.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  ObjectMeta meta;
+  meta.AddKeyValue("int_value", -42);
+  meta.AddKeyValue("size_value", static_cast<size_t>(1) << 40);
+  meta.AddKeyValue("uint8_value", static_cast<uint8_t>(7));
+  meta.AddKeyValue("double_value", 0.1);
+  meta.AddKeyValue("bool_value", true);
+  meta.AddKeyValue("string_value", std::string("vineyard"));
+  meta.AddKeyValue("bad_value", std::string("4x2"));
+
+  auto check_values = [](ObjectMeta const& meta) {
+    CHECK_EQ(meta.GetKeyValue<int>("int_value"), -42);
+    CHECK_EQ(meta.GetKeyValue<size_t>("size_value"), static_cast<size_t>(1)
+                                                         << 40);
+    CHECK_EQ(meta.GetKeyValue<uint8_t>("uint8_value"), 7);
+    CHECK_EQ(meta.GetKeyValue<double>("double_value"), 0.1);
+    CHECK(meta.GetKeyValue<bool>("bool_value"));
+    CHECK_EQ(meta.GetKeyValue("string_value"), "vineyard");
+    bool failed = false;
+    try {
+      meta.GetKeyValue<int>("bad_value");
+    } catch (...) { failed = true; }
+    CHECK(failed);
+    failed = false;
+    try {
+      meta.GetKeyValue<int>("no_such_value");
+    } catch (...) { failed = true; }
+    CHECK(failed);
+    CHECK(meta.Haskey("int_value"));
+    CHECK(!meta.Haskey("no_such_value"));
+  };
+
+  check_values(meta);
+  LOG(INFO) << "Passed typed values of small metadata tests...";
+
+  // enough entries to be indexed
+  for (int i = 0; i < 64; ++i) {
+    meta.AddKeyValue("__field-" + std::to_string(i), i);
+  }
+  check_values(meta);
+  for (int i = 0; i < 64; ++i) {
+    CHECK_EQ(meta.GetKeyValue<int>("__field-" + std::to_string(i)), i);
+  }
+
+  // updates and new entries after lookups
+  meta.AddKeyValue("int_value", 1024);
+  CHECK_EQ(meta.GetKeyValue<int>("int_value"), 1024);
+  meta.AddKeyValue("new_value", 2048);
+  CHECK_EQ(meta.GetKeyValue<int>("new_value"), 2048);
+  meta.AddKeyValue("int_value", -42);
+
+  // the copy shouldn't refer to the tree of the original metadata
+  {
+    ObjectMeta copied = meta;
+    check_values(copied);
+    copied.AddKeyValue("int_value", 1);
+    CHECK_EQ(copied.GetKeyValue<int>("int_value"), 1);
+    CHECK_EQ(meta.GetKeyValue<int>("int_value"), -42);
+  }
+  check_values(meta);
+
+  // replace the whole tree
+  {
+    ptree tree = meta.MetaData();
+    tree.put("int_value", 7);
+    meta.MutMetaData() = tree;
+    CHECK_EQ(meta.GetKeyValue<int>("int_value"), 7);
+  }
+
+  // keys with '.' are paths
+  {
+    ptree member;
+    member.put("value", 1);
+    meta.MutMetaData().add_child("member", member);
+    CHECK_EQ(meta.GetKeyValue<int>("member.value"), 1);
+  }
+  LOG(INFO) << "Passed typed values of indexed metadata tests...";
+
+  LOG(INFO) << "Passed object meta tests...";
+  return 0;
+}
@@ -0,0 +1,105 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/perfect_hashmap.h"
+
+#include <memory>
+#include <string>
+
+#include "glog/logging.h"
+
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "basic/ds/hashmap.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./perfect_hashmap_test <ipc_socket_name>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    HashmapBuilder<int, double> builder(client);
+    builder[1] = 100.0;
+    builder[2] = 50.0;
+    builder[3] = 25.0;
+    builder[4] = 12.5;
+    builder[5] = 6.25;
+
+    PerfectHashmapBuilder<int, double> perfect_builder(client, builder);
+    auto sealed_hashmap =
+        std::dynamic_pointer_cast<PerfectHashmap<int, double>>(
+            perfect_builder.Seal(client));
+    VINEYARD_CHECK_OK(sealed_hashmap->Persist(client));
+    auto vy_hashmap = std::dynamic_pointer_cast<PerfectHashmap<int, double>>(
+        client.GetObject(sealed_hashmap->id()));
+
+    CHECK_EQ(builder.size(), sealed_hashmap->size());
+    CHECK_EQ(builder.size(), vy_hashmap->size());
+    for (const auto& pair : builder) {
+      CHECK_DOUBLE_EQ(pair.second, sealed_hashmap->at(pair.first));
+      CHECK_DOUBLE_EQ(pair.second, vy_hashmap->at(pair.first));
+    }
+    CHECK_EQ(vy_hashmap->count(6), 0);
+    CHECK(vy_hashmap->find(0) == vy_hashmap->end());
+  }
+  LOG(INFO) << "Passed double perfect hashmap tests...";
+
+  {
+    HashmapBuilder<int64_t, int64_t> builder(client);
+    for (int64_t i = 0; i < 100000; ++i) {
+      builder[i * 3] = i;
+    }
+    PerfectHashmapBuilder<int64_t, int64_t> perfect_builder(client, builder);
+    auto hashmap = std::dynamic_pointer_cast<PerfectHashmap<int64_t, int64_t>>(
+        perfect_builder.Seal(client));
+    CHECK_EQ(hashmap->size(), builder.size());
+    for (int64_t i = 0; i < 100000; ++i) {
+      CHECK_EQ(hashmap->at(i * 3), i);
+      CHECK_EQ(hashmap->count(i * 3 + 1), 0);
+    }
+    size_t visited = 0;
+    for (auto const& kv : *hashmap) {
+      CHECK_EQ(kv.first, kv.second * 3);
+      visited += 1;
+    }
+    CHECK_EQ(visited, hashmap->size());
+  }
+  LOG(INFO) << "Passed large perfect hashmap tests...";
+
+  {
+    HashmapBuilder<int, int> builder(client);
+    PerfectHashmapBuilder<int, int> perfect_builder(client, builder);
+    auto hashmap = std::dynamic_pointer_cast<PerfectHashmap<int, int>>(
+        perfect_builder.Seal(client));
+    CHECK(hashmap->empty());
+    CHECK(hashmap->begin() == hashmap->end());
+    CHECK_EQ(hashmap->count(0), 0);
+  }
+  LOG(INFO) << "Passed empty perfect hashmap tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
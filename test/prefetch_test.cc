@@ -0,0 +1,88 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+size_t get_requests(Client& client, std::string const& type) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status->metrics.get<size_t>("requests." + type + ".count", 0);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./prefetch_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<int64_t> values = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<ObjectID> ids;
+  for (int i = 0; i < 4; ++i) {
+    ArrayBuilder<int64_t> builder(client, values);
+    ids.emplace_back(builder.Seal(client)->id());
+  }
+
+  VINEYARD_CHECK_OK(client.Prefetch(ids));
+  VINEYARD_CHECK_OK(client.WaitAll());
+  CHECK_EQ(client.MetaCacheSize(), ids.size());
+
+  // the following gets are served without any request to the server
+  size_t data_requests = get_requests(client, "get_data_request");
+  size_t buffers_requests = get_requests(client, "get_buffers_request");
+  for (auto const& id : ids) {
+    auto array = client.GetObject<Array<int64_t>>(id);
+    CHECK_EQ(array->size(), values.size());
+    for (size_t j = 0; j < values.size(); ++j) {
+      CHECK_EQ(array->data()[j], values[j]);
+    }
+  }
+  CHECK_EQ(get_requests(client, "get_data_request"), data_requests);
+  CHECK_EQ(get_requests(client, "get_buffers_request"), buffers_requests);
+
+  // prefetching the cached objects is a no-op
+  VINEYARD_CHECK_OK(client.Prefetch(ids));
+  CHECK_EQ(get_requests(client, "get_data_request"), data_requests);
+
+  // prefetching a missing object fails when settled
+  VINEYARD_CHECK_OK(client.Prefetch({InvalidObjectID()}));
+  CHECK(!client.WaitAll().ok());
+
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+
+  LOG(INFO) << "Passed prefetch tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
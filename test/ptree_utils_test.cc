@@ -45,6 +45,33 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed plain type in ptree tests...";
 
+  auto value6 = std::vector<std::string>{"", "a, b", "[c]", "\"d\"", "e\\f",
+                                         "g\nh"};
+  auto value7 = std::vector<char>{'a', ',', '\'', '\\'};
+  auto value8 = std::vector<int64_t>{};
+  put_container(tree, "value6", value6);
+  put_container(tree, "value7", value7);
+  put_container(tree, "value8", value8);
+
+  std::vector<std::string> value6_get;
+  std::vector<char> value7_get;
+  std::vector<int64_t> value8_get{-1};
+  get_container(tree, "value6", value6_get);
+  get_container(tree, "value7", value7_get);
+  value8_get.clear();
+  get_container(tree, "value8", value8_get);
+  CHECK(value6 == value6_get);
+  CHECK(value7 == value7_get);
+  CHECK(value8_get.empty());
+
+  // the arrays that are written by other clients, e.g., `json.dumps`
+  tree.put("value9", " [ \"\\u00e9\\/x\" ,\"y\"]  ");
+  std::vector<std::string> value9_get;
+  get_container(tree, "value9", value9_get);
+  CHECK(value9_get == (std::vector<std::string>{"\xc3\xa9/x", "y"}));
+
+  LOG(INFO) << "Passed escaped values in ptree tests...";
+
   auto value4 =
       std::vector<AnyType>{AnyType::Int32, AnyType::UInt32, AnyType::Double};
   put_container(tree, "value4", value4);
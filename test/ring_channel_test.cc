@@ -0,0 +1,88 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./ring_channel_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // a small ring, so that large messages are redirected to the socket
+  CHECK(client.OpenRingChannel(1000).IsInvalid());
+  VINEYARD_CHECK_OK(client.OpenRingChannel(4096));
+  // opening again is a no-op
+  VINEYARD_CHECK_OK(client.OpenRingChannel(4096));
+
+  const size_t blob_count = 64;
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < blob_count; ++i) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(1024, writer));
+    memset(writer->data(), static_cast<int>(i), 1024);
+    ids.emplace_back(writer->Seal(client)->id());
+  }
+
+  ObjectID named = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.PutName(ids[0], "ring_channel_test_blob"));
+  VINEYARD_CHECK_OK(client.GetName("ring_channel_test_blob", named));
+  CHECK_EQ(named, ids[0]);
+  VINEYARD_CHECK_OK(client.DropName("ring_channel_test_blob"));
+
+  // the reply carries the metadata of all blobs, doesn't fit into the ring
+  auto blobs = client.GetObjects(ids);
+  CHECK_EQ(blobs.size(), ids.size());
+  for (size_t i = 0; i < blobs.size(); ++i) {
+    auto blob = std::dynamic_pointer_cast<Blob>(blobs[i]);
+    CHECK_EQ(blob->size(), 1024);
+    CHECK_EQ(blob->data()[0], static_cast<char>(i));
+    CHECK_EQ(blob->data()[1023], static_cast<char>(i));
+  }
+
+  // small requests and replies through the ring again after redirecting
+  for (size_t i = 0; i < blob_count; ++i) {
+    auto blob = std::dynamic_pointer_cast<Blob>(client.GetObject(ids[i]));
+    CHECK_EQ(blob->data()[512], static_cast<char>(i));
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+
+  LOG(INFO) << "Passed ring channel tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
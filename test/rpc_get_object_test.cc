@@ -104,6 +104,31 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed various ways to get object with rpc tests...";
 
+  // the blobs are copied to the rpc client
+  {
+    auto array = rpc_client.GetObject<Array<double>>(id);
+    CHECK(array != nullptr);
+    CHECK_EQ(array->size(), double_array.size());
+    for (size_t idx = 0; idx < double_array.size(); ++idx) {
+      CHECK_EQ((*array)[idx], double_array[idx]);
+    }
+
+    rpc_client.SetRemoteBlobCompression("zstd");
+    std::shared_ptr<Object> object;
+    auto status = rpc_client.GetObject(id, object);
+    // the codec may not be built into arrow
+    if (status.ok()) {
+      auto compressed = std::dynamic_pointer_cast<Array<double>>(object);
+      CHECK(compressed != nullptr);
+      for (size_t idx = 0; idx < double_array.size(); ++idx) {
+        CHECK_EQ((*compressed)[idx], double_array[idx]);
+      }
+    }
+    rpc_client.SetRemoteBlobCompression("");
+  }
+
+  LOG(INFO) << "Passed get remote blobs with rpc tests...";
+
   client.Disconnect();
 
   return 0;
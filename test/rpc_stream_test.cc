@@ -0,0 +1,125 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "client/rpc_client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kChunks = 8;
+
+ObjectID create_stream(ClientBase& client) {
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::ByteStream");
+  meta.SetNBytes(0);
+  ObjectID stream_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, stream_id));
+  VINEYARD_CHECK_OK(client.CreateStream(stream_id, 2));
+  return stream_id;
+}
+
+std::string make_chunk(size_t const idx) {
+  return std::string(1024 * (idx + 1), static_cast<char>('a' + idx));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./rpc_stream_test <ipc_socket> <rpc_endpoint>");
+    return 1;
+  }
+  std::string ipc_socket(argv[1]);
+  std::string rpc_endpoint(argv[2]);
+
+  // remote producer, local consumer
+  {
+    RPCClient rpc_client;
+    VINEYARD_CHECK_OK(rpc_client.Connect(rpc_endpoint));
+    ObjectID stream_id = create_stream(rpc_client);
+
+    std::thread reader([&]() {
+      Client ipc_client;
+      VINEYARD_CHECK_OK(ipc_client.Connect(ipc_socket));
+      for (size_t idx = 0; idx < kChunks; ++idx) {
+        std::unique_ptr<arrow::Buffer> buffer = nullptr;
+        VINEYARD_CHECK_OK(ipc_client.PullNextStreamChunk(stream_id, buffer));
+        CHECK(buffer->ToString() == make_chunk(idx));
+      }
+      std::unique_ptr<arrow::Buffer> buffer = nullptr;
+      CHECK(ipc_client.PullNextStreamChunk(stream_id, buffer)
+                .IsStreamDrained());
+      ipc_client.Disconnect();
+    });
+
+    for (size_t idx = 0; idx < kChunks; ++idx) {
+      auto chunk = make_chunk(idx);
+      VINEYARD_CHECK_OK(rpc_client.PushNextStreamChunk(
+          stream_id, reinterpret_cast<const uint8_t*>(chunk.data()),
+          chunk.size()));
+    }
+    VINEYARD_CHECK_OK(rpc_client.StopStream(stream_id, false));
+    reader.join();
+    rpc_client.Disconnect();
+    LOG(INFO) << "Passed RPC producer tests...";
+  }
+
+  // local producer, remote consumer
+  {
+    Client ipc_client;
+    VINEYARD_CHECK_OK(ipc_client.Connect(ipc_socket));
+    ObjectID stream_id = create_stream(ipc_client);
+
+    std::thread reader([&]() {
+      RPCClient rpc_client;
+      VINEYARD_CHECK_OK(rpc_client.Connect(rpc_endpoint));
+      for (size_t idx = 0; idx < kChunks; ++idx) {
+        std::string chunk;
+        VINEYARD_CHECK_OK(rpc_client.PullNextStreamChunk(stream_id, chunk));
+        CHECK(chunk == make_chunk(idx));
+      }
+      std::string chunk;
+      CHECK(rpc_client.PullNextStreamChunk(stream_id, chunk).IsStreamDrained());
+      rpc_client.Disconnect();
+    });
+
+    for (size_t idx = 0; idx < kChunks; ++idx) {
+      auto chunk = make_chunk(idx);
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(
+          ipc_client.GetNextStreamChunk(stream_id, chunk.size(), buffer));
+      memcpy(buffer->mutable_data(), chunk.data(), chunk.size());
+    }
+    VINEYARD_CHECK_OK(ipc_client.StopStream(stream_id, false));
+    reader.join();
+    ipc_client.Disconnect();
+    LOG(INFO) << "Passed RPC consumer tests...";
+  }
+
+  LOG(INFO) << "Passed RPC stream tests...";
+
+  return 0;
+}
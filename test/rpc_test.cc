@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -62,6 +63,38 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed rpc client tests...";
 
+  {
+    RPCClientPool pool(2);
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < 8; ++index) {
+      threads.emplace_back([&pool, &rpc_endpoint, id]() {
+        std::shared_ptr<RPCClient> client;
+        VINEYARD_CHECK_OK(pool.Get(rpc_endpoint, client));
+        for (size_t round = 0; round < 16; ++round) {
+          ObjectMeta meta;
+          VINEYARD_CHECK_OK(client->GetMetaData(id, meta));
+          CHECK_EQ(meta.GetId(), id);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    CHECK_EQ(pool.Size(), 2);
+
+    // the lost connection is replaced on the next get
+    std::shared_ptr<RPCClient> client;
+    VINEYARD_CHECK_OK(pool.Get(rpc_endpoint, client));
+    client->Disconnect();
+    VINEYARD_CHECK_OK(pool.Get(rpc_endpoint, client));
+    VINEYARD_CHECK_OK(pool.Get(rpc_endpoint, client));
+    CHECK(client->Connected());
+    CHECK_EQ(pool.Reconnects(), 1);
+    CHECK_EQ(pool.Size(), 2);
+  }
+
+  LOG(INFO) << "Passed rpc client pool tests...";
+
   ipc_client.Disconnect();
   rpc_client.Disconnect();
 
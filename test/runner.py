@@ -188,27 +188,81 @@ def run_single_vineyardd_tests(etcd_endpoints):
     with start_vineyardd(etcd_endpoints,
                          'vineyard_test_%s' % time.time(),
                          default_ipc_socket=VINEYARD_CI_IPC_SOCKET) as (_, rpc_socket_port):
+        run_test('access_stats_test')
+        run_test('aligned_blob_test')
         run_test('array_test')
         run_test('arrow_data_structure_test')
+        run_test('arrow_memory_pool_test')
+        run_test('async_client_test')
+        run_test('batch_persist_test')
+        run_test('blob_arena_test')
+        run_test('bloom_filter_test')
+        run_test('chunked_table_test')
+        run_test('concurrent_client_test')
+        run_test('copy_on_write_test')
+        run_test('create_blobs_test')
         run_test('dataframe_test')
+        run_test('deferred_delete_test')
         run_test('delete_test')
+        run_test('device_blob_test')
+        run_test('encoded_array_test')
+        run_test('exchange_test')
         run_test('get_wait_test')
         run_test('get_object_test')
         run_test('hashmap_test')
         run_test('id_test')
         run_test('list_object_test')
+        run_test('meta_cache_test')
+        run_test('metrics_test')
+        run_test('mmap_options_test')
+        run_test('mpmc_queue_test')
+        run_test('multi_consumer_stream_test')
         run_test('name_test')
+        run_test('object_meta_test')
         run_test('pair_test')
+        run_test('perfect_hashmap_test')
+        run_test('prefetch_test')
         run_test('ptree_utils_test')
+        run_test('ring_channel_test')
         run_test('rpc_delete_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_get_object_test', '127.0.0.1:%d' % rpc_socket_port)
+        run_test('rpc_stream_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('scalar_test')
         run_test('server_status_test')
         run_test('shallow_copy_test')
+        run_test('slab_allocator_test')
+        run_test('slow_requests_test')
+        run_test('sorted_index_test')
+        run_test('sparse_tensor_test')
+        run_test('stream_notifier_test')
+        run_test('stream_replay_test')
         run_test('stream_test')
+        run_test('string_hashmap_test')
+        run_test('subscribe_test')
+        run_test('swiss_hashmap_test')
+        run_test('table_appender_test')
+        run_test('table_compute_test')
+        run_test('tenant_quota_test')
         run_test('tensor_test')
+        run_test('trace_test')
+        run_test('ttl_test')
         run_test('tuple_test')
+        run_test('write_behind_test')
+
+
+def run_wal_recovery_tests():
+    wal_path = '/tmp/vineyard.ci.%s.wal' % time.time()
+    try:
+        run_test('wal_recovery_test', 'prepare', wal_path)
+        with start_vineyardd('http://localhost:%d' % find_port(),
+                             'vineyard_test_%s' % time.time(),
+                             default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+                             meta='local', meta_wal=wal_path):
+            run_test('wal_recovery_test', 'check', wal_path)
+    finally:
+        if os.path.exists(wal_path):
+            os.remove(wal_path)
 
 
 def run_scale_in_out_tests(etcd_endpoints, instance_size=4):
@@ -236,6 +290,7 @@ def run_scale_in_out_tests(etcd_endpoints, instance_size=4):
 
 def main():
     run_single_vineyardd_tests('http://localhost:%d' % find_port())
+    run_wal_recovery_tests()
     with start_etcd() as (_, etcd_endpoints):
         run_scale_in_out_tests(etcd_endpoints, instance_size=2)
 
@@ -0,0 +1,86 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./slab_allocator_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::shared_ptr<InstanceStatus> status_before;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_before));
+
+  const size_t array_count = 1024;
+  std::vector<ObjectID> ids;
+  for (size_t i = 0; i < array_count; ++i) {
+    std::vector<int64_t> values(i % 32 + 1, static_cast<int64_t>(i));
+    ArrayBuilder<int64_t> builder(client, values);
+    ids.emplace_back(builder.Seal(client)->id());
+  }
+
+  std::shared_ptr<InstanceStatus> status_allocated;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_allocated));
+  CHECK_EQ(status_allocated->slab_objects,
+           status_before->slab_objects + array_count);
+  CHECK_GT(status_allocated->slab_used, status_before->slab_used);
+  CHECK_GE(status_allocated->slab_reserved, status_allocated->slab_used);
+
+  // small blobs must not overlap with each other
+  for (size_t i = 0; i < array_count; ++i) {
+    auto array = std::dynamic_pointer_cast<Array<int64_t>>(
+        client.GetObject(ids[i]));
+    CHECK_EQ(array->size(), i % 32 + 1);
+    for (size_t j = 0; j < array->size(); ++j) {
+      CHECK_EQ(array->data()[j], static_cast<int64_t>(i));
+    }
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+
+  // empty slabs are returned to the bulk allocator
+  std::shared_ptr<InstanceStatus> status_after;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+  CHECK_EQ(status_before->slab_objects, status_after->slab_objects);
+  CHECK_EQ(status_before->slab_used, status_after->slab_used);
+  CHECK_EQ(status_before->slab_reserved, status_after->slab_reserved);
+  CHECK_EQ(status_before->memory_usage, status_after->memory_usage);
+
+  LOG(INFO) << "Passed slab allocator tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./slow_requests_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  using namespace std::literals::chrono_literals;  // NOLINT
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the get name request waits for the name, thus is slower than the
+  // default threshold (100ms)
+  ObjectID id = GenerateObjectID();
+  std::thread putter([&ipc_socket, id]() {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    std::this_thread::sleep_for(500ms);
+    VINEYARD_CHECK_OK(client.PutName(id, "slow_requests_test_name"));
+    client.Disconnect();
+  });
+  ObjectID got = InvalidObjectID();
+  auto start = std::chrono::steady_clock::now();
+  VINEYARD_CHECK_OK(client.GetName("slow_requests_test_name", got, true));
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  CHECK_EQ(got, id);
+  putter.join();
+
+  std::vector<SlowRequest> requests;
+  VINEYARD_CHECK_OK(client.SlowRequests(10, requests));
+  CHECK(!requests.empty());
+  CHECK_LE(requests.size(), 10);
+  auto const& slow = requests.front();
+  LOG(INFO) << "slow request: " << CommandTypeName(slow.command) << ", "
+            << slow.queue_us << " us queueing, " << slow.handle_us
+            << " us handling, " << slow.etcd_us << " us on etcd";
+  CHECK(slow.command == CommandType::GetNameRequest);
+  CHECK_GE(slow.queue_us + slow.handle_us, 100000);
+  CHECK_LE(slow.queue_us + slow.handle_us, elapsed);
+  CHECK_GT(slow.bytes_in, 0);
+  CHECK_GT(slow.bytes_out, 0);
+  CHECK_GT(slow.timestamp, 0);
+
+  VINEYARD_CHECK_OK(client.DropName("slow_requests_test_name"));
+  client.Disconnect();
+
+  LOG(INFO) << "Passed slow requests tests...";
+  return 0;
+}
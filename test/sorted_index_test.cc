@@ -0,0 +1,123 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/sorted_index.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "basic/ds/arrow.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./sorted_index_test <ipc_socket_name>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    // the value of position i is (i * 7) % 1000, with duplicates
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < 10000; ++i) {
+      values.emplace_back((i * 7) % 1000);
+    }
+    SortedIndexBuilder<int64_t> builder(client, values);
+    auto sealed_index =
+        std::dynamic_pointer_cast<SortedIndex<int64_t>>(builder.Seal(client));
+    VINEYARD_CHECK_OK(sealed_index->Persist(client));
+    auto index = std::dynamic_pointer_cast<SortedIndex<int64_t>>(
+        client.GetObject(sealed_index->id()));
+
+    CHECK_EQ(index->size(), values.size());
+    for (size_t rank = 1; rank < index->size(); ++rank) {
+      CHECK_LE(index->key_at(rank - 1), index->key_at(rank));
+    }
+    for (size_t rank = 0; rank < index->size(); ++rank) {
+      CHECK_EQ(values[index->position_at(rank)], index->key_at(rank));
+    }
+
+    CHECK_EQ(index->lower_bound(-1), 0);
+    CHECK_EQ(index->lower_bound(0), 0);
+    CHECK_EQ(index->upper_bound(0), 10);
+    CHECK_EQ(index->lower_bound(500), 5000);
+    CHECK_EQ(index->upper_bound(999), 10000);
+    CHECK_EQ(index->lower_bound(1000), 10000);
+
+    auto ranks = index->range(100, 200);
+    CHECK_EQ(ranks.first, 1000);
+    CHECK_EQ(ranks.second, 2000);
+    CHECK_EQ(index->range(200, 100).second, index->range(200, 100).first);
+
+    size_t visited = index->range_scan(
+        990, 2000, [&](int64_t key, int64_t position) {
+          CHECK_GE(key, 990);
+          CHECK_EQ(values[position], key);
+        });
+    CHECK_EQ(visited, 100);
+  }
+  LOG(INFO) << "Passed int64 sorted index tests...";
+
+  {
+    // skips the nulls
+    arrow::DoubleBuilder builder;
+    CHECK(builder.Append(3.0).ok());
+    CHECK(builder.AppendNull().ok());
+    CHECK(builder.Append(1.0).ok());
+    CHECK(builder.Append(2.0).ok());
+    std::shared_ptr<arrow::DoubleArray> array;
+    CHECK(builder.Finish(&array).ok());
+
+    NumericArrayBuilder<double> array_builder(client, array);
+    auto numeric_array = std::dynamic_pointer_cast<NumericArray<double>>(
+        array_builder.Seal(client));
+    SortedIndexBuilder<double> index_builder(client, *numeric_array);
+    auto index = std::dynamic_pointer_cast<SortedIndex<double>>(
+        index_builder.Seal(client));
+    CHECK_EQ(index->size(), 3);
+    CHECK_EQ(index->position_at(0), 2);
+    CHECK_EQ(index->position_at(1), 3);
+    CHECK_EQ(index->position_at(2), 0);
+    CHECK_EQ(index->lower_bound(1.5), 1);
+  }
+  LOG(INFO) << "Passed numeric array sorted index tests...";
+
+  {
+    SortedIndexBuilder<int32_t> builder(client, std::vector<int32_t>{});
+    auto index =
+        std::dynamic_pointer_cast<SortedIndex<int32_t>>(builder.Seal(client));
+    CHECK(index->empty());
+    CHECK_EQ(index->lower_bound(0), 0);
+    CHECK_EQ(index->upper_bound(0), 0);
+  }
+  LOG(INFO) << "Passed empty sorted index tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/sparse_tensor.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./sparse_tensor_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    // the 4 x 5 matrix
+    //
+    //   [[0, 1, 0, 2, 0],
+    //    [0, 0, 0, 0, 0],
+    //    [3, 0, 0, 0, 4],
+    //    [0, 5, 0, 0, 0]]
+    //
+    // from the unordered coordinates
+    std::vector<int64_t> rows = {2, 0, 3, 0, 2};
+    std::vector<int64_t> columns = {0, 1, 1, 3, 4};
+    std::vector<double> values = {3, 1, 5, 2, 4};
+    CSRTensorBuilder<double> builder(client, {4, 5}, rows, columns, values);
+    auto tensor =
+        std::dynamic_pointer_cast<CSRTensor<double>>(builder.Seal(client));
+    VINEYARD_CHECK_OK(client.Persist(tensor->id()));
+
+    auto csr = std::dynamic_pointer_cast<CSRTensor<double>>(
+        client.GetObject(tensor->id()));
+    CHECK(csr != nullptr);
+    CHECK(csr->shape() == std::vector<int64_t>({4, 5}));
+    CHECK_EQ(csr->nnz(), 5);
+    CHECK(csr->value_type() == AnyType::Double);
+
+    std::vector<int64_t> const expected_indptr = {0, 2, 2, 4, 5};
+    for (size_t i = 0; i < expected_indptr.size(); ++i) {
+      CHECK_EQ(csr->indptr()[i], expected_indptr[i]);
+    }
+    CHECK_EQ(csr->RowLength(0), 2);
+    CHECK_EQ(csr->RowLength(1), 0);
+    CHECK_EQ(csr->RowIndices(0)[0], 1);
+    CHECK_EQ(csr->RowIndices(0)[1], 3);
+    CHECK_EQ(csr->RowValues(0)[1], 2);
+    CHECK_EQ(csr->RowIndices(2)[1], 4);
+    CHECK_EQ(csr->RowValues(2)[1], 4);
+
+    CSRTensorRows<double> view;
+    VINEYARD_CHECK_OK(csr->SliceRows(1, 4, view));
+    CHECK_EQ(view.num_rows, 3);
+    CHECK_EQ(view.nnz(), 3);
+    CHECK_EQ(view.indices[view.indptr[2]], 1);
+    CHECK_EQ(view.values[view.indptr[2]], 5);
+    // the view doesn't copy the buffers
+    CHECK_EQ(view.values, csr->values());
+
+    VINEYARD_CHECK_OK(csr->SliceRows(4, 4, view));
+    CHECK_EQ(view.nnz(), 0);
+    CHECK(!csr->SliceRows(2, 5, view).ok());
+    VINEYARD_CHECK_OK(client.DelData(csr->id(), true, true));
+  }
+
+  LOG(INFO) << "Passed CSR tensor tests...";
+
+  {
+    COOTensorBuilder<int64_t> builder(client, {2, 3, 4}, 2);
+    int64_t coordinates[] = {0, 1, 2, 1, 2, 3};
+    std::copy(coordinates, coordinates + 6, builder.indices());
+    builder.values()[0] = 7;
+    builder.values()[1] = 8;
+    auto sealed = builder.Seal(client);
+
+    auto coo = std::dynamic_pointer_cast<COOTensor<int64_t>>(
+        client.GetObject(sealed->id()));
+    CHECK(coo != nullptr);
+    CHECK(coo->shape() == std::vector<int64_t>({2, 3, 4}));
+    CHECK_EQ(coo->nnz(), 2);
+    for (int i = 0; i < 6; ++i) {
+      CHECK_EQ(coo->indices()[i], coordinates[i]);
+    }
+    CHECK_EQ(coo->values()[1], 8);
+    VINEYARD_CHECK_OK(client.DelData(coo->id(), true, true));
+  }
+
+  LOG(INFO) << "Passed COO tensor tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
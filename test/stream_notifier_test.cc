@@ -0,0 +1,136 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kStreams = 4;
+constexpr size_t kChunks = 8;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./stream_notifier_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<ObjectID> streams;
+  for (size_t index = 0; index < kStreams; ++index) {
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::ByteStream");
+    meta.SetNBytes(0);
+    ObjectID stream_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(meta, stream_id));
+    VINEYARD_CHECK_OK(client.CreateStream(stream_id));
+    streams.emplace_back(stream_id);
+  }
+
+  // nothing has been written yet
+  {
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    CHECK(client.TryPullNextStreamChunk(streams[0], buffer).IsStreamNotReady());
+  }
+
+  int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  CHECK_GE(epoll_fd, 0);
+  for (size_t index = 0; index < kStreams; ++index) {
+    int fd = -1;
+    VINEYARD_CHECK_OK(client.OpenStreamNotifier(streams[index], fd));
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = index;
+    CHECK_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event), 0);
+  }
+
+  std::vector<std::thread> writers;
+  for (size_t index = 0; index < kStreams; ++index) {
+    writers.emplace_back([&, index]() {
+      Client writer_client;
+      VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+      for (size_t idx = 0; idx < kChunks; ++idx) {
+        std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+        VINEYARD_CHECK_OK(
+            writer_client.GetNextStreamChunk(streams[index], 128, buffer));
+        buffer->mutable_data()[0] = static_cast<uint8_t>(idx);
+      }
+      VINEYARD_CHECK_OK(writer_client.StopStream(streams[index], false));
+      writer_client.Disconnect();
+    });
+  }
+
+  // a single thread consumes all streams
+  std::vector<size_t> received(kStreams, 0);
+  size_t drained = 0;
+  while (drained < kStreams) {
+    struct epoll_event events[kStreams];
+    int ready = epoll_wait(epoll_fd, events, kStreams, -1);
+    CHECK_GE(ready, 0);
+    for (int i = 0; i < ready; ++i) {
+      size_t index = events[i].data.u64;
+      while (true) {
+        std::unique_ptr<arrow::Buffer> buffer = nullptr;
+        auto status = client.TryPullNextStreamChunk(streams[index], buffer);
+        if (status.ok()) {
+          CHECK_EQ(buffer->data()[0], received[index]);
+          received[index] += 1;
+          continue;
+        }
+        if (status.IsStreamDrained()) {
+          drained += 1;
+          int fd = -1;
+          VINEYARD_CHECK_OK(client.OpenStreamNotifier(streams[index], fd));
+          CHECK_EQ(epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr), 0);
+        } else {
+          CHECK(status.IsStreamNotReady());
+        }
+        break;
+      }
+    }
+  }
+  close(epoll_fd);
+
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  for (size_t index = 0; index < kStreams; ++index) {
+    CHECK_EQ(received[index], kChunks);
+  }
+
+  LOG(INFO) << "Passed stream notifier tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "arrow/buffer.h"
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr size_t kChunks = 8;
+
+uint8_t pull_chunk(Client& client, ObjectID const stream_id) {
+  std::unique_ptr<arrow::Buffer> buffer = nullptr;
+  VINEYARD_CHECK_OK(client.PullNextStreamChunk(stream_id, buffer));
+  CHECK(buffer != nullptr);
+  return buffer->data()[0];
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./stream_replay_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::ByteStream");
+  meta.SetNBytes(0);
+  ObjectID stream_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, stream_id));
+  VINEYARD_CHECK_OK(client.CreateStream(stream_id, 0, 1, false, kChunks));
+
+  for (size_t idx = 0; idx < kChunks; ++idx) {
+    std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+    VINEYARD_CHECK_OK(client.GetNextStreamChunk(stream_id, 1024, buffer));
+    CHECK(buffer != nullptr);
+    buffer->mutable_data()[0] = static_cast<uint8_t>(idx);
+  }
+  VINEYARD_CHECK_OK(client.StopStream(stream_id, false));
+
+  // the consumer crashes while reading the second chunk
+  {
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    CHECK_EQ(pull_chunk(reader, stream_id), 0);
+    CHECK_EQ(pull_chunk(reader, stream_id), 1);
+    reader.Disconnect();
+  }
+
+  // the reattached consumer resumes from the chunk that hasn't been done
+  {
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    auto status = reader.PullNextStreamChunk(stream_id, buffer);
+    // the previous connection may not have been cleaned up yet
+    while (status.IsInvalidStreamState()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      status = reader.PullNextStreamChunk(stream_id, buffer);
+    }
+    VINEYARD_CHECK_OK(status);
+    CHECK_EQ(buffer->data()[0], 1);
+    for (size_t idx = 2; idx < kChunks; ++idx) {
+      CHECK_EQ(pull_chunk(reader, stream_id), idx);
+    }
+    CHECK(reader.PullNextStreamChunk(stream_id, buffer).IsStreamDrained());
+    LOG(INFO) << "Passed stream reattaching tests...";
+
+    // replay the retained chunks
+    VINEYARD_CHECK_OK(reader.SeekStream(stream_id, 3));
+    for (size_t idx = 3; idx < kChunks; ++idx) {
+      CHECK_EQ(pull_chunk(reader, stream_id), idx);
+    }
+    VINEYARD_CHECK_OK(reader.SeekStream(stream_id, 0));
+    CHECK_EQ(pull_chunk(reader, stream_id), 0);
+    CHECK(reader.SeekStream(stream_id, kChunks + 1).IsInvalid());
+    LOG(INFO) << "Passed stream replaying tests...";
+    reader.Disconnect();
+  }
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed stream replay tests...";
+
+  return 0;
+}
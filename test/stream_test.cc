@@ -104,6 +104,26 @@ int main(int argc, char** argv) {
     CHECK_EQ(send_chunks_size[idx], recv_chunks_size[idx]);
   }
 
+  // the statistics of the stream
+  {
+    std::shared_ptr<InstanceStatus> status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status));
+    auto const& stats =
+        status->streams.get_child(VYObjectIDToString(stream_id));
+    size_t bytes = 0;
+    for (auto size : send_chunks_size) {
+      bytes += size;
+    }
+    CHECK_EQ(stats.get<std::string>("state"), "drained");
+    CHECK_EQ(stats.get<size_t>("chunks_produced"), send_chunks);
+    CHECK_EQ(stats.get<size_t>("bytes_produced"), bytes);
+    CHECK_EQ(stats.get<size_t>("chunks_consumed"), recv_chunks);
+    CHECK_EQ(stats.get<size_t>("bytes_consumed"), bytes);
+    CHECK_EQ(stats.get<size_t>("queue_depth"), 0);
+    // the reader keeps waiting for the slow writer
+    CHECK_GT(stats.get<uint64_t>("consumer_waited_us"), 0);
+  }
+
   // when stream fail
   {
     ByteStreamBuilder builder(client);
@@ -0,0 +1,101 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/string_hashmap.h"
+
+#include <memory>
+#include <string>
+
+#include "glog/logging.h"
+
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "arrow/util/string_view.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./string_hashmap_test <ipc_socket_name>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    StringHashmapBuilder<double> builder(client);
+    CHECK(builder.emplace(std::string("a"), 100.0));
+    CHECK(builder.emplace(std::string("bb"), 50.0));
+    CHECK(builder.emplace(std::string(""), 25.0));
+    // the first value is kept for the duplicated keys
+    CHECK(!builder.emplace(std::string("a"), 12.5));
+    CHECK_EQ(builder.size(), 3);
+    CHECK_DOUBLE_EQ(*builder.find(std::string("a")), 100.0);
+
+    auto sealed_hashmap = std::dynamic_pointer_cast<StringHashmap<double>>(
+        builder.Seal(client));
+    VINEYARD_CHECK_OK(sealed_hashmap->Persist(client));
+    auto vy_hashmap = std::dynamic_pointer_cast<StringHashmap<double>>(
+        client.GetObject(sealed_hashmap->id()));
+
+    CHECK_EQ(vy_hashmap->size(), 3);
+    CHECK_DOUBLE_EQ(vy_hashmap->at(std::string("a")), 100.0);
+    CHECK_DOUBLE_EQ(vy_hashmap->at(arrow::util::string_view("bb")), 50.0);
+    CHECK_DOUBLE_EQ(vy_hashmap->at(std::string("")), 25.0);
+    CHECK_EQ(vy_hashmap->count(std::string("b")), 0);
+    CHECK(vy_hashmap->find(std::string("aa")) == nullptr);
+    CHECK_EQ(vy_hashmap->key_at(1), "bb");
+    CHECK_EQ(vy_hashmap->index_of(std::string("")), 2);
+  }
+  LOG(INFO) << "Passed double string hashmap tests...";
+
+  {
+    // grows many times
+    StringHashmapBuilder<int64_t> builder(client);
+    for (int64_t i = 0; i < 100000; ++i) {
+      CHECK(builder.emplace("key_" + std::to_string(i), i));
+    }
+    auto hashmap = std::dynamic_pointer_cast<StringHashmap<int64_t>>(
+        builder.Seal(client));
+    CHECK_EQ(hashmap->size(), 100000);
+    CHECK_GE(hashmap->capacity() * 3 / 4, hashmap->size());
+    for (int64_t i = 0; i < 100000; ++i) {
+      CHECK_EQ(hashmap->at("key_" + std::to_string(i)), i);
+      CHECK_EQ(hashmap->count("key_" + std::to_string(i) + "_"), 0);
+    }
+    for (size_t i = 0; i < hashmap->size(); ++i) {
+      CHECK_EQ(hashmap->at(hashmap->key_at(i)), hashmap->value_at(i));
+    }
+  }
+  LOG(INFO) << "Passed large string hashmap tests...";
+
+  {
+    StringHashmapBuilder<int> builder(client);
+    auto hashmap =
+        std::dynamic_pointer_cast<StringHashmap<int>>(builder.Seal(client));
+    CHECK(hashmap->empty());
+    CHECK_EQ(hashmap->count(std::string("")), 0);
+  }
+  LOG(INFO) << "Passed empty string hashmap tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
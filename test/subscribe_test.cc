@@ -0,0 +1,115 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/typename.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./subscribe_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client consumer, producer;
+  VINEYARD_CHECK_OK(consumer.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(producer.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  uint64_t types_subscription = 0, names_subscription = 0,
+           regex_subscription = 0;
+  VINEYARD_CHECK_OK(consumer.Subscribe("vineyard::Array<*>", false, false,
+                                       types_subscription));
+  VINEYARD_CHECK_OK(consumer.Subscribe("^subscribed_[0-9]+$", true, true,
+                                       names_subscription));
+  VINEYARD_CHECK_OK(consumer.Subscribe("vineyard::Hashmap.*", true, false,
+                                       regex_subscription));
+  CHECK(types_subscription != names_subscription);
+  {
+    uint64_t invalid = 0;
+    CHECK(!consumer.Subscribe("(", true, false, invalid).ok());
+    CHECK(!consumer.Unsubscribe(1024 * 1024).ok());
+  }
+
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  ObjectID id = InvalidObjectID();
+  std::thread producer_thread([&]() {
+    ArrayBuilder<double> builder(producer, double_array);
+    id = builder.Seal(producer)->id();
+    VINEYARD_CHECK_OK(producer.PutName(id, "subscribed_1"));
+  });
+
+  // the array, and its name
+  std::vector<ObjectEvent> events;
+  while (events.size() < 2) {
+    VINEYARD_CHECK_OK(consumer.GetObjectEvents(events, true));
+  }
+  producer_thread.join();
+  CHECK_EQ(events.size(), 2);
+  CHECK_EQ(events[0].subscription_id, types_subscription);
+  CHECK_EQ(events[0].id, id);
+  CHECK_EQ(events[0].type_name, type_name<Array<double>>());
+  CHECK(events[0].name.empty());
+  CHECK_EQ(events[1].subscription_id, names_subscription);
+  CHECK_EQ(events[1].id, id);
+  CHECK_EQ(events[1].type_name, type_name<Array<double>>());
+  CHECK_EQ(events[1].name, "subscribed_1");
+  LOG(INFO) << "Passed subscription tests...";
+
+  // names that don't match the pattern
+  VINEYARD_CHECK_OK(producer.PutName(id, "unsubscribed_1"));
+  VINEYARD_CHECK_OK(consumer.Unsubscribe(types_subscription));
+  {
+    ArrayBuilder<double> builder(producer, double_array);
+    auto array = builder.Seal(producer);
+    VINEYARD_CHECK_OK(producer.PutName(array->id(), "subscribed_2"));
+    events.clear();
+    while (events.empty()) {
+      VINEYARD_CHECK_OK(consumer.GetObjectEvents(events, true));
+    }
+    CHECK_EQ(events.size(), 1);
+    CHECK_EQ(events[0].subscription_id, names_subscription);
+    CHECK_EQ(events[0].id, array->id());
+    CHECK_EQ(events[0].name, "subscribed_2");
+    VINEYARD_CHECK_OK(producer.DropName("subscribed_2"));
+    VINEYARD_CHECK_OK(producer.DelData(array->id()));
+  }
+  LOG(INFO) << "Passed unsubscription tests...";
+
+  VINEYARD_CHECK_OK(producer.DropName("subscribed_1"));
+  VINEYARD_CHECK_OK(producer.DropName("unsubscribed_1"));
+  VINEYARD_CHECK_OK(producer.DelData(id));
+
+  LOG(INFO) << "Passed subscribe tests...";
+
+  consumer.Disconnect();
+  producer.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,214 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+#include "arrow/util/config.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "common/util/status.h"
+#include "glog/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+std::shared_ptr<arrow::Table> MakeTable(
+    std::shared_ptr<arrow::Schema> const& schema,
+    std::vector<std::shared_ptr<arrow::RecordBatch>> const& batches) {
+  std::shared_ptr<arrow::Table> table;
+  VINEYARD_CHECK_OK(RecordBatchesToTable(batches, &table));
+  std::shared_ptr<arrow::Table> combined;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  CHECK_ARROW_ERROR(
+      table->CombineChunks(arrow::default_memory_pool(), &combined));
+#else
+  CHECK_ARROW_ERROR_AND_ASSIGN(
+      combined, table->CombineChunks(arrow::default_memory_pool()));
+#endif
+  return combined;
+}
+
+int main(int argc, char** argv) {
+  auto schema = arrow::schema({arrow::field("f1", arrow::int64()),
+                               arrow::field("f2", arrow::float64()),
+                               arrow::field("f3", arrow::utf8()),
+                               arrow::field("f4", arrow::null())});
+
+  int64_t row_num = 10000;
+  arrow::Int64Builder b1;
+  arrow::DoubleBuilder b2;
+  arrow::StringBuilder b3;
+  arrow::NullBuilder b4;
+  for (int64_t i = 0; i < row_num; ++i) {
+    if (i % 5 == 0) {
+      CHECK_ARROW_ERROR(b1.AppendNull());
+    } else {
+      CHECK_ARROW_ERROR(b1.Append(i));
+    }
+    CHECK_ARROW_ERROR(b2.Append(i * 0.5));
+    if (i % 7 == 0) {
+      CHECK_ARROW_ERROR(b3.AppendNull());
+    } else {
+      CHECK_ARROW_ERROR(b3.Append("value-" + std::to_string(i)));
+    }
+    CHECK_ARROW_ERROR(b4.AppendNull());
+  }
+  std::shared_ptr<arrow::Array> a1, a2, a3, a4;
+  CHECK_ARROW_ERROR(b1.Finish(&a1));
+  CHECK_ARROW_ERROR(b2.Finish(&a2));
+  CHECK_ARROW_ERROR(b3.Finish(&a3));
+  CHECK_ARROW_ERROR(b4.Finish(&a4));
+  // use a sliced batch to cover the offsets of arrays
+  auto batch = arrow::RecordBatch::Make(schema, row_num, {a1, a2, a3, a4})
+                   ->Slice(3, row_num - 3);
+
+  ColumnarTableAppender appender(schema);
+
+  {
+    // select rows
+    std::unique_ptr<arrow::RecordBatchBuilder> builder;
+    CHECK_ARROW_ERROR(arrow::RecordBatchBuilder::Make(
+        schema, arrow::default_memory_pool(), 1024, &builder));
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    std::vector<int64_t> selected, indices;
+    for (int64_t i = batch->num_rows() - 1; i >= 0; --i) {
+      if (i % 3 != 1) {
+        selected.push_back(i);
+        indices.push_back(i);
+      }
+      if (indices.size() == 500) {
+        VINEYARD_CHECK_OK(appender.Apply(builder, batch, indices, batches));
+        indices.clear();
+      }
+    }
+    VINEYARD_CHECK_OK(appender.Apply(builder, batch, indices, batches));
+    VINEYARD_CHECK_OK(appender.Flush(builder, batches));
+
+    auto table = MakeTable(schema, batches);
+    CHECK_EQ(table->num_rows(), static_cast<int64_t>(selected.size()));
+    auto c1 = std::dynamic_pointer_cast<arrow::Int64Array>(
+        table->column(0)->chunk(0));
+    auto c2 = std::dynamic_pointer_cast<arrow::DoubleArray>(
+        table->column(1)->chunk(0));
+    auto c3 = std::dynamic_pointer_cast<arrow::StringArray>(
+        table->column(2)->chunk(0));
+    auto e1 = std::dynamic_pointer_cast<arrow::Int64Array>(batch->column(0));
+    auto e2 = std::dynamic_pointer_cast<arrow::DoubleArray>(batch->column(1));
+    auto e3 = std::dynamic_pointer_cast<arrow::StringArray>(batch->column(2));
+    CHECK_EQ(table->column(3)->null_count(),
+             static_cast<int64_t>(selected.size()));
+    for (size_t i = 0; i < selected.size(); ++i) {
+      int64_t index = selected[i];
+      CHECK_EQ(c1->IsNull(i), e1->IsNull(index));
+      if (!c1->IsNull(i)) {
+        CHECK_EQ(c1->Value(i), e1->Value(index));
+      }
+      CHECK_EQ(c2->Value(i), e2->Value(index));
+      CHECK_EQ(c3->IsNull(i), e3->IsNull(index));
+      if (!c3->IsNull(i)) {
+        CHECK_EQ(c3->GetString(i), e3->GetString(index));
+      }
+    }
+    LOG(INFO) << "Passed the selected rows tests...";
+  }
+
+  {
+    // append ranges
+    std::unique_ptr<arrow::RecordBatchBuilder> builder;
+    CHECK_ARROW_ERROR(arrow::RecordBatchBuilder::Make(
+        schema, arrow::default_memory_pool(), 1024, &builder));
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    int64_t offset = 0;
+    while (offset < batch->num_rows()) {
+      int64_t length = std::min<int64_t>(777, batch->num_rows() - offset);
+      VINEYARD_CHECK_OK(
+          appender.Apply(builder, batch, offset, length, batches));
+      offset += length;
+    }
+    VINEYARD_CHECK_OK(appender.Flush(builder, batches));
+
+    auto table = MakeTable(schema, batches);
+    auto expected = arrow::Table::Make(
+        schema, std::vector<std::shared_ptr<arrow::Array>>{
+                    batch->column(0), batch->column(1), batch->column(2),
+                    batch->column(3)});
+    CHECK(table->Equals(*expected));
+    LOG(INFO) << "Passed the row ranges tests...";
+  }
+
+  {
+    // dictionary-encoded columns
+    auto dict_type = arrow::dictionary(arrow::int32(), arrow::utf8());
+    auto dict_schema = arrow::schema({arrow::field("f1", dict_type)});
+    arrow::StringBuilder dictionary_builder;
+    arrow::Int32Builder indices_builder;
+    CHECK_ARROW_ERROR(dictionary_builder.AppendValues({"x", "y", "z"}));
+    for (int64_t i = 0; i < row_num; ++i) {
+      if (i % 13 == 0) {
+        CHECK_ARROW_ERROR(indices_builder.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(indices_builder.Append(i % 3));
+      }
+    }
+    std::shared_ptr<arrow::Array> dictionary, indices;
+    CHECK_ARROW_ERROR(dictionary_builder.Finish(&dictionary));
+    CHECK_ARROW_ERROR(indices_builder.Finish(&indices));
+    auto dict_array = std::make_shared<arrow::DictionaryArray>(
+        dict_type, indices, dictionary);
+    auto dict_batch =
+        arrow::RecordBatch::Make(dict_schema, row_num, {dict_array});
+
+    ColumnarTableAppender dict_appender(dict_schema);
+    std::unique_ptr<arrow::RecordBatchBuilder> builder;
+    CHECK_ARROW_ERROR(arrow::RecordBatchBuilder::Make(
+        dict_schema, arrow::default_memory_pool(), 1024, &builder));
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    std::vector<int64_t> selected;
+    for (int64_t i = 0; i < row_num; i += 2) {
+      selected.push_back(i);
+    }
+    VINEYARD_CHECK_OK(
+        dict_appender.Apply(builder, dict_batch, selected, batches));
+    VINEYARD_CHECK_OK(dict_appender.Flush(builder, batches));
+
+    int64_t row = 0;
+    for (auto const& flushed : batches) {
+      // keeps the dictionary type of the schema
+      CHECK(flushed->schema()->Equals(*dict_schema));
+      auto column =
+          std::dynamic_pointer_cast<arrow::DictionaryArray>(flushed->column(0));
+      auto values =
+          std::dynamic_pointer_cast<arrow::StringArray>(column->dictionary());
+      for (int64_t i = 0; i < column->length(); ++i, ++row) {
+        int64_t index = selected[row];
+        CHECK_EQ(column->IsNull(i), dict_array->IsNull(index));
+        if (!column->IsNull(i)) {
+          CHECK_EQ(values->GetString(GetDictionaryIndex(*column->indices(), i)),
+                   std::string(1, static_cast<char>('x' + index % 3)));
+        }
+      }
+    }
+    CHECK_EQ(row, static_cast<int64_t>(selected.size()));
+    LOG(INFO) << "Passed the dictionary columns tests...";
+  }
+
+  LOG(INFO) << "Passed table appender tests...";
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/status.h"
+#include "arrow/util/config.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/table_compute.h"
+#include "client/client.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./table_compute_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  int64_t row_num = 1000;
+  arrow::Int64Builder b1;
+  arrow::DoubleBuilder b2;
+  arrow::StringBuilder b3;
+  for (int64_t i = 0; i < row_num; ++i) {
+    CHECK_ARROW_ERROR(b1.Append(i));
+    CHECK_ARROW_ERROR(b2.Append(i * 0.5));
+    CHECK_ARROW_ERROR(b3.Append("value-" + std::to_string(i)));
+  }
+  std::shared_ptr<arrow::Array> a1, a2, a3;
+  CHECK_ARROW_ERROR(b1.Finish(&a1));
+  CHECK_ARROW_ERROR(b2.Finish(&a2));
+  CHECK_ARROW_ERROR(b3.Finish(&a3));
+  auto schema = arrow::schema({arrow::field("f1", arrow::int64()),
+                               arrow::field("f2", arrow::float64()),
+                               arrow::field("f3", arrow::utf8())});
+  auto table = arrow::Table::Make(schema, {a1, a2, a3});
+
+  std::vector<TablePredicate> predicates = {{"f1", "greater_equal", "100"},
+                                            {"f2", "less", "60"}};
+  {
+    // locally
+    std::shared_ptr<arrow::Table> result;
+    VINEYARD_CHECK_OK(ProjectTable(table, {"f3", "f1"}, predicates, result));
+    CHECK_EQ(result->num_rows(), 20);
+    CHECK_EQ(result->num_columns(), 2);
+    CHECK_EQ(result->schema()->field(0)->name(), "f3");
+
+    auto status = ProjectTable(table, {"f4"}, {}, result);
+    CHECK(status.IsInvalid());
+  }
+
+  TableBuilder builder(client, table);
+  auto sealed = builder.Seal(client);
+  ObjectID table_id = sealed->id();
+
+  Client worker_client;
+  VINEYARD_CHECK_OK(worker_client.Connect(ipc_socket));
+  TableComputeWorker worker(worker_client);
+  VINEYARD_CHECK_OK(worker.Start());
+  std::thread worker_thread([&worker]() {
+    size_t total = 0;
+    while (total < 2) {
+      size_t served = 0;
+      VINEYARD_CHECK_OK(worker.Poll(true, served));
+      total += served;
+    }
+  });
+
+  ObjectID result_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(
+      SubmitTableCompute(client, table_id, {"f1"}, predicates, result_id));
+  auto result = client.GetObject<Table>(result_id);
+  CHECK(result != nullptr);
+  CHECK_EQ(result->num_rows(), 20);
+  CHECK_EQ(result->num_columns(), 1);
+  auto values = std::dynamic_pointer_cast<arrow::Int64Array>(
+      result->GetTable()->column(0)->chunk(0));
+  CHECK_EQ(values->Value(0), 100);
+
+  // the errors are reported to the submitter
+  auto status = SubmitTableCompute(client, table_id, {},
+                                   {{"f1", "between", "1"}}, result_id);
+  CHECK(status.IsInvalid());
+
+  worker_thread.join();
+  VINEYARD_CHECK_OK(worker.Stop());
+
+  LOG(INFO) << "Passed table compute tests...";
+
+  worker_client.Disconnect();
+  client.Disconnect();
+
+  return 0;
+}
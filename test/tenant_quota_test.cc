@@ -0,0 +1,77 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./tenant_quota_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  const std::string tenant = "tenant_quota_test";
+  setenv("VINEYARD_TENANT", tenant.c_str(), 1);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  VINEYARD_CHECK_OK(client.SetTenantQuota(tenant, 4 * 1024 * 1024));
+
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(3 * 1024 * 1024, writer));
+  ObjectID id = writer->Seal(client)->id();
+
+  // exceeds the quota of the tenant, rather than the shared memory
+  std::unique_ptr<BlobWriter> rejected;
+  auto status = client.CreateBlob(2 * 1024 * 1024, rejected);
+  CHECK(status.IsNotEnoughMemory());
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  status = client.CreateBlobs({512 * 1024, 1024 * 1024}, writers);
+  CHECK(status.IsNotEnoughMemory());
+  CHECK(writers.empty());
+
+  {
+    std::shared_ptr<InstanceStatus> instance_status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(instance_status));
+    auto const& usage = instance_status->tenants.get_child(
+        ptree::path_type(tenant, '\0'));
+    CHECK_EQ(usage.get<size_t>("usage"), 3 * 1024 * 1024);
+    CHECK_EQ(usage.get<size_t>("quota"), 4 * 1024 * 1024);
+    CHECK_EQ(usage.get<size_t>("objects"), 1);
+    CHECK_EQ(usage.get<size_t>("rejected"), 2);
+  }
+
+  // the quota is released with the blob
+  VINEYARD_CHECK_OK(client.DelData(id, true, true));
+  VINEYARD_CHECK_OK(client.CreateBlob(2 * 1024 * 1024, writer));
+  VINEYARD_CHECK_OK(client.DelData(writer->Seal(client)->id(), true, true));
+
+  VINEYARD_CHECK_OK(client.SetTenantQuota(tenant, 0));
+  LOG(INFO) << "Passed tenant quota tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
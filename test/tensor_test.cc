@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -58,6 +59,108 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed tensor tests...";
 
+  {
+    // the views share the buffer of the sealed tensor
+    std::shared_ptr<Tensor<double>> column, reshaped, flattened;
+    VINEYARD_CHECK_OK(sealed->Slice(client, {0, 1}, {2, 3}, {1, 2}, column));
+    CHECK(column->shape() == std::vector<int64_t>({2, 1}));
+    CHECK(!column->is_contiguous());
+    CHECK_EQ(column->strides()[0], 3 * sizeof(double));
+    CHECK_EQ(column->data()[0], 1);
+    CHECK_EQ(column->data()[3], 4);
+    CHECK_EQ(column->buffer()->data(),
+             reinterpret_cast<const uint8_t*>(sealed_data + 1));
+    CHECK(column->Reshape(client, {2}, flattened).IsInvalid());
+
+    VINEYARD_CHECK_OK(sealed->Reshape(client, {3, -1}, reshaped));
+    CHECK(reshaped->shape() == std::vector<int64_t>({3, 2}));
+    CHECK(reshaped->is_contiguous());
+    CHECK_EQ(reshaped->data(), sealed_data);
+
+    std::shared_ptr<Tensor<double>> row;
+    VINEYARD_CHECK_OK(reshaped->Slice(client, {2, 0}, {3, 2}, row));
+    VINEYARD_CHECK_OK(row->Reshape(client, {2}, flattened));
+    CHECK_EQ(flattened->data()[0], 4);
+    CHECK_EQ(flattened->data()[1], 5);
+    CHECK_EQ(flattened->buffer()->size(), 2 * sizeof(double));
+    CHECK(sealed->Slice(client, {0, 0}, {3, 3}, row).IsInvalid());
+
+    // the views are resolved from the metadata as well
+    auto resolved = client.GetObject<Tensor<double>>(column->id());
+    CHECK(resolved->strides() == column->strides());
+    CHECK_EQ(resolved->data()[3], 4);
+    for (auto const& view : {column, reshaped, row, flattened}) {
+      VINEYARD_CHECK_OK(client.DelData(view->id(), false, false));
+    }
+  }
+
+  LOG(INFO) << "Passed tensor view tests...";
+
+  {
+    // a 5 x 7 global tensor on a 2 x 3 partition grid, the partitions on the
+    // borders are smaller
+    std::vector<int64_t> const shape = {5, 7};
+    std::vector<int64_t> const rows = {0, 3, 5}, columns = {0, 3, 6, 7};
+    GlobalTensorBuilder global_builder(client);
+    global_builder.set_shape(shape);
+    global_builder.set_partition_shape({2, 3});
+    for (int64_t i = 0; i < 2; ++i) {
+      for (int64_t j = 0; j < 3; ++j) {
+        TensorBuilder<int64_t> partition_builder(
+            client, {rows[i + 1] - rows[i], columns[j + 1] - columns[j]},
+            {i, j});
+        int64_t* partition_data = partition_builder.data();
+        for (int64_t r = rows[i]; r < rows[i + 1]; ++r) {
+          for (int64_t c = columns[j]; c < columns[j + 1]; ++c) {
+            *partition_data++ = r * shape[1] + c;
+          }
+        }
+        auto partition = partition_builder.Seal(client);
+        VINEYARD_CHECK_OK(client.Persist(partition->id()));
+        global_builder.AddPartition(client.instance_id(), partition->id());
+      }
+    }
+    auto global_id = global_builder.Seal(client)->id();
+    auto global_tensor =
+        std::dynamic_pointer_cast<GlobalTensor>(client.GetObject(global_id));
+    CHECK(global_tensor->partition_offsets(0) == rows);
+    CHECK(global_tensor->partition_offsets(1) == columns);
+    CHECK(global_tensor->PartitionAt({1, 2}) != nullptr);
+    CHECK(global_tensor->PartitionAt({2, 0}) == nullptr);
+
+    std::vector<GlobalTensorChunk> chunks;
+    VINEYARD_CHECK_OK(
+        global_tensor->LocalSlice(client, {2, 1}, {4, 4}, chunks));
+    // overlaps with the partitions (0, 0), (0, 1), (1, 0) and (1, 1)
+    CHECK_EQ(chunks.size(), 4);
+    int64_t covered = 0;
+    for (auto const& chunk : chunks) {
+      CHECK(chunk.data != nullptr);
+      for (int64_t r = 0; r < chunk.shape[0]; ++r) {
+        for (int64_t c = 0; c < chunk.shape[1]; ++c) {
+          int64_t value = *reinterpret_cast<const int64_t*>(
+              chunk.data + r * chunk.strides[0] + c * chunk.strides[1]);
+          CHECK_EQ(value, (chunk.global_offset[0] + r) * shape[1] +
+                              chunk.global_offset[1] + c);
+          covered += 1;
+        }
+      }
+    }
+    CHECK_EQ(covered, 2 * 3);
+
+    chunks.clear();
+    VINEYARD_CHECK_OK(global_tensor->Slice(UnspecifiedInstanceID(), {4, 6},
+                                           {5, 7}, chunks));
+    CHECK_EQ(chunks.size(), 1);
+    CHECK(chunks[0].partition->partition_index() ==
+          std::vector<int64_t>({1, 2}));
+    CHECK(global_tensor->LocalSlice(client, {0, 0}, {6, 7}, chunks)
+              .IsInvalid());
+    VINEYARD_CHECK_OK(client.DelData(global_id, true, true));
+  }
+
+  LOG(INFO) << "Passed global tensor tests...";
+
   client.Disconnect();
 
   return 0;
@@ -0,0 +1,100 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/trace.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./trace_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // the context is propagated in the form of "<trace id>-<span id>"
+  trace::Context context;
+  context.trace_id = 0x1234;
+  context.span_id = 0xabcd;
+  CHECK_EQ(context.ToString(), "0000000000001234-000000000000abcd");
+  auto parsed = trace::Context::FromString(context.ToString());
+  CHECK_EQ(parsed.trace_id, context.trace_id);
+  CHECK_EQ(parsed.span_id, context.span_id);
+  CHECK(!trace::Context::FromString("invalid").sampled());
+
+  auto& tracer = trace::Tracer::Global();
+  // nothing is traced with the sample rate 0
+  tracer.Configure("vineyard-client", 0, 64);
+  CHECK(!trace::StartSpan("unsampled").active());
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(1024, writer));
+  ObjectID id = writer->Seal(client)->id();
+  CHECK_EQ(tracer.Size(), 0);
+
+  // every request is traced with the sample rate 1
+  tracer.Configure("vineyard-client", 1, 64);
+  std::shared_ptr<Object> object;
+  VINEYARD_CHECK_OK(client.GetObject(id, object));
+  CHECK_GE(tracer.Size(), 1);
+  std::ostringstream os;
+  tracer.Dump(os);
+  std::string spans = os.str();
+  LOG(INFO) << "spans: " << spans;
+  CHECK_NE(spans.find("\"name\":\"GetObject\""), std::string::npos);
+  if (tracer.Size() > 1) {
+    // the requests are children of GetObject
+    CHECK_NE(spans.find("\"kind\":\"CLIENT\""), std::string::npos);
+    CHECK_NE(spans.find("\"parentId\""), std::string::npos);
+  }
+  CHECK_NE(spans.find("\"serviceName\":\"vineyard-client\""),
+           std::string::npos);
+
+  // the oldest spans are dropped when the buffer is full
+  tracer.Configure("vineyard-client", 1, 4);
+  for (int i = 0; i < 16; ++i) {
+    VINEYARD_CHECK_OK(client.GetObject(id, object));
+  }
+  CHECK_EQ(tracer.Size(), 4);
+  tracer.Clear();
+  CHECK_EQ(tracer.Size(), 0);
+
+  // disable it again
+  tracer.Configure("vineyard-client", 0, 0);
+  CHECK(!tracer.Enabled());
+  VINEYARD_CHECK_OK(client.GetObject(id, object));
+  CHECK_EQ(tracer.Size(), 0);
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed trace tests...";
+  return 0;
+}
@@ -0,0 +1,87 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./ttl_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto make_array = [&client](ObjectID& id, ObjectID& blob_id) {
+    std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+    ArrayBuilder<double> builder(client, double_array);
+    auto sealed_double_array =
+        std::dynamic_pointer_cast<Array<double>>(builder.Seal(client));
+    id = sealed_double_array->id();
+    blob_id = VYObjectIDFromString(sealed_double_array->meta()
+                                       .MetaData()
+                                       .get_child("buffer_")
+                                       .get<std::string>("id"));
+  };
+
+  ObjectID expiring = InvalidObjectID(), expiring_blob = InvalidObjectID();
+  ObjectID kept = InvalidObjectID(), kept_blob = InvalidObjectID();
+  make_array(expiring, expiring_blob);
+  make_array(kept, kept_blob);
+
+  VINEYARD_CHECK_OK(client.Persist(expiring, 2));
+  VINEYARD_CHECK_OK(client.Persist(kept));
+
+  bool exists = false;
+  VINEYARD_CHECK_OK(client.Exists(expiring, exists));
+  CHECK(exists);
+
+  std::this_thread::sleep_for(std::chrono::seconds(5));
+
+  // the expired object is deleted together with its member blob
+  VINEYARD_CHECK_OK(client.Exists(expiring, exists));
+  CHECK(!exists);
+  VINEYARD_CHECK_OK(client.Exists(expiring_blob, exists));
+  CHECK(!exists);
+
+  VINEYARD_CHECK_OK(client.Exists(kept, exists));
+  CHECK(exists);
+  VINEYARD_CHECK_OK(client.Exists(kept_blob, exists));
+  CHECK(exists);
+  VINEYARD_CHECK_OK(client.DelData(kept, false, true));
+
+  LOG(INFO) << "Passed TTL tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
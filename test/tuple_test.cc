@@ -26,6 +26,7 @@ limitations under the License.
 #include "basic/ds/hashmap.h"
 #include "basic/ds/tuple.h"
 #include "client/client.h"
+#include "client/ds/lazy.h"
 #include "client/ds/object_meta.h"
 #include "common/util/typename.h"
 
@@ -78,6 +79,22 @@ int main(int argc, char** argv) {
   }
   CHECK_EQ(third->meta().GetTypeName(), type_name<Array<double>>());
 
+  // the members are constructed on the first access
+  {
+    auto object = client.GetObject(tup->id());
+    auto lazy = object->meta().GetLazyMember<Array<double>>("__elements_-2");
+    CHECK(!lazy.materialized());
+    CHECK_EQ(lazy.id(), third->id());
+    CHECK_EQ(lazy->size(), static_cast<size_t>(5));
+    CHECK_EQ(lazy->data()[0], 9.0);
+    CHECK(lazy.materialized());
+    auto copied = lazy;
+    CHECK_EQ(copied.get(), lazy.get());
+
+    auto tuple = std::dynamic_pointer_cast<Tuple>(object);
+    CHECK_EQ(tuple->At(2)->id(), third->id());
+  }
+
   LOG(INFO) << "Passed tuple tests...";
 
   client.Disconnect();
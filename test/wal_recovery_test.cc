@@ -0,0 +1,129 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/uuid.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+namespace {
+
+// the op types of `IMetaService::op_t`
+constexpr char kPut = 0;
+constexpr char kDelPrefix = 2;
+
+constexpr ObjectID kDeletedID = 0x0000000000001000ull;
+constexpr ObjectID kKeptID = 0x0000000000001001ull;
+
+void put_u32(std::string& buffer, uint32_t const value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(uint32_t));
+}
+
+void put_string(std::string& buffer, std::string const& value) {
+  put_u32(buffer, static_cast<uint32_t>(value.size()));
+  buffer.append(value);
+}
+
+/**
+ * Encode a record of the metadata log in the layout of LocalMetaService.
+ */
+std::string encode_record(
+    uint32_t const rev,
+    std::vector<std::pair<char, std::pair<std::string, std::string>>> const&
+        ops) {
+  std::string payload, record;
+  put_u32(payload, rev);
+  put_u32(payload, static_cast<uint32_t>(ops.size()));
+  for (auto const& op : ops) {
+    payload.push_back(op.first);
+    put_string(payload, op.second.first);
+    put_string(payload, op.second.second);
+  }
+  put_u32(record, static_cast<uint32_t>(payload.size()));
+  record.append(payload);
+  return record;
+}
+
+std::vector<std::pair<char, std::pair<std::string, std::string>>> put_object(
+    ObjectID const id) {
+  std::string prefix = "data." + VYObjectIDToString(id) + ".";
+  return {
+      {kPut, {prefix + "typename", "vvineyard::WALRecoveryTestObject"}},
+      {kPut, {prefix + "instance_id", "v0"}},
+      {kPut, {prefix + "transient", "vfalse"}},
+      {kPut, {prefix + "nbytes", "v0"}},
+      {kPut, {prefix + "signature", "v" + std::to_string(id)}},
+  };
+}
+
+void prepare(std::string const& wal_path) {
+  std::ofstream out(wal_path, std::ios::out | std::ios::binary);
+  CHECK(out.is_open());
+  out << encode_record(1, put_object(kDeletedID));
+  out << encode_record(2, put_object(kKeptID));
+  // the range deletion of the failed instance's cleanup
+  out << encode_record(
+      3, {{kDelPrefix, {"data." + VYObjectIDToString(kDeletedID), ""}}});
+  out.close();
+  LOG(INFO) << "Prepared the metadata log '" << wal_path << "'";
+}
+
+void check(std::string const& ipc_socket) {
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  bool exists = true;
+  VINEYARD_CHECK_OK(client.Exists(kDeletedID, exists));
+  CHECK(!exists);
+  VINEYARD_CHECK_OK(client.Exists(kKeptID, exists));
+  CHECK(exists);
+
+  ObjectMeta meta;
+  VINEYARD_CHECK_OK(client.GetMeta(kKeptID, meta));
+  CHECK_EQ(meta.GetTypeName(), "vineyard::WALRecoveryTestObject");
+
+  client.Disconnect();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    printf("usage ./wal_recovery_test <ipc_socket> <prepare|check> <wal>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string phase = std::string(argv[2]);
+  std::string wal_path = std::string(argv[3]);
+
+  if (phase == "prepare") {
+    prepare(wal_path);
+  } else {
+    check(ipc_socket);
+  }
+
+  LOG(INFO) << "Passed wal recovery tests...";
+  return 0;
+}
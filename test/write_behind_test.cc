@@ -0,0 +1,101 @@
+/** Copyright 2020 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+#include "glog/logging.h"
+
+#include "basic/ds/array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./write_behind_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+  std::vector<ObjectID> ids;
+  for (int i = 0; i < 8; ++i) {
+    ArrayBuilder<double> builder(client, double_array);
+    ids.emplace_back(builder.Seal(client)->id());
+  }
+
+  for (auto const& id : ids) {
+    bool durable = true;
+    VINEYARD_CHECK_OK(client.IfDurable(id, durable));
+    CHECK(!durable);
+  }
+  VINEYARD_CHECK_OK(client.PersistWriteBehind(ids));
+  // visible locally once the request returns
+  for (auto const& id : ids) {
+    bool persist = false;
+    VINEYARD_CHECK_OK(client.IfPersist(id, persist));
+    CHECK(persist);
+  }
+  VINEYARD_CHECK_OK(client.Flush());
+  for (auto const& id : ids) {
+    bool durable = false;
+    VINEYARD_CHECK_OK(client.IfDurable(id, durable));
+    CHECK(durable);
+  }
+  // flushing without pending changes returns at once
+  VINEYARD_CHECK_OK(client.Flush());
+  LOG(INFO) << "Passed write-behind persist tests...";
+
+  // the synchronous persists and deletions are ordered after the pending
+  // write-behind changes
+  {
+    ArrayBuilder<double> builder(client, double_array);
+    auto array = builder.Seal(client);
+    VINEYARD_CHECK_OK(client.PersistWriteBehind({array->id()}));
+    VINEYARD_CHECK_OK(client.Persist(ids));
+    bool durable = false;
+    VINEYARD_CHECK_OK(client.IfDurable(array->id(), durable));
+    CHECK(durable);
+    ids.emplace_back(array->id());
+  }
+  {
+    ArrayBuilder<double> builder(client, double_array);
+    auto array = builder.Seal(client);
+    VINEYARD_CHECK_OK(client.PersistWriteBehind({array->id()}));
+    VINEYARD_CHECK_OK(client.DelData(array->id()));
+    bool exists = true;
+    VINEYARD_CHECK_OK(client.Exists(array->id(), exists));
+    CHECK(!exists);
+  }
+  LOG(INFO) << "Passed write-behind ordering tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+
+  LOG(INFO) << "Passed write-behind tests...";
+
+  client.Disconnect();
+
+  return 0;
+}